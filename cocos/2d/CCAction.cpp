@@ -41,6 +41,8 @@ Action::Action()
 ,_target(nullptr)
 ,_tag(Action::INVALID_TAG)
 ,_flags(0)
+,_tweenKind(-1)
+,_tweenIndex(-1)
 {
 }
 
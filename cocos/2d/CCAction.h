@@ -177,6 +177,12 @@ protected:
     /** The action flag field. To categorize action into certain groups.*/
     unsigned int _flags;
 
+    // where the ActionManager runs the action as a tween, see CC_ENABLE_FAST_ACTIONS. -1 when it's stepped.
+    int     _tweenKind;
+    int     _tweenIndex;
+
+    friend class ActionManager;
+
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(Action);
 };
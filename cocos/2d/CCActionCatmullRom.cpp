@@ -33,6 +33,8 @@
 #include "2d/CCActionCatmullRom.h"
 #include "2d/CCNode.h"
 
+#include <algorithm>
+
 using namespace std;
 
 NS_CC_BEGIN;
@@ -212,6 +214,108 @@ Vec2 ccCardinalSplineAt(Vec2 &p0, Vec2 &p1, Vec2 &p2, Vec2 &p3, float tension, f
 /* Implementation of CardinalSplineTo
  */
 
+/* SplinePath
+ */
+
+SplinePath* SplinePath::create(PointArray* points, float tension, int samplesPerSegment)
+{
+    SplinePath *ret = new (std::nothrow) SplinePath();
+    if (ret && ret->init(points, tension, samplesPerSegment))
+    {
+        ret->autorelease();
+        return ret;
+    }
+
+    delete ret;
+    return nullptr;
+}
+
+SplinePath::SplinePath()
+: _points(nullptr)
+, _tension(0.f)
+, _samplesPerSegment(0)
+{
+}
+
+SplinePath::~SplinePath()
+{
+    CC_SAFE_RELEASE(_points);
+}
+
+bool SplinePath::init(PointArray* points, float tension, int samplesPerSegment)
+{
+    CCASSERT(points && points->count() > 0, "Invalid configuration. It must at least have one control point");
+    CCASSERT(samplesPerSegment > 0, "A segment needs a sample at least");
+    if (!points || points->count() == 0 || samplesPerSegment <= 0)
+        return false;
+
+    _points = points->clone();
+    _tension = tension;
+    _samplesPerSegment = samplesPerSegment;
+
+    // the polynomials of ccCardinalSplineAt(), with the same clamped control points as CardinalSplineTo::update()
+    const float s = (1 - tension) / 2;
+    const ssize_t count = _points->count();
+    const ssize_t segmentCount = std::max((ssize_t)1, count - 1);
+    _segments.resize(segmentCount);
+    for (ssize_t i = 0; i < segmentCount; ++i)
+    {
+        Vec2 p0 = _points->getControlPointAtIndex(i - 1);
+        Vec2 p1 = _points->getControlPointAtIndex(i);
+        Vec2 p2 = _points->getControlPointAtIndex(i + 1);
+        Vec2 p3 = _points->getControlPointAtIndex(i + 2);
+
+        Segment& segment = _segments[i];
+        segment.a = p0 * -s + p1 * (2 - s) + p2 * (s - 2) + p3 * s;
+        segment.b = p0 * (2 * s) + p1 * (s - 3) + p2 * (3 - 2 * s) - p3 * s;
+        segment.c = (p2 - p0) * s;
+        segment.d = p1;
+    }
+
+    // the chords between the samples
+    const int sampleCount = (int)segmentCount * samplesPerSegment;
+    _lengths.resize(sampleCount + 1);
+    _lengths[0] = 0;
+    Vec2 previous = evaluate(0);
+    for (int i = 1; i <= sampleCount; ++i)
+    {
+        Vec2 current = evaluate((float)i / samplesPerSegment);
+        _lengths[i] = _lengths[i - 1] + current.distance(previous);
+        previous = current;
+    }
+
+    return true;
+}
+
+Vec2 SplinePath::evaluate(float parameter) const
+{
+    int index = std::min(std::max((int)parameter, 0), (int)_segments.size() - 1);
+    float t = parameter - index;
+    const Segment& segment = _segments[index];
+    return ((segment.a * t + segment.b) * t + segment.c) * t + segment.d;
+}
+
+Vec2 SplinePath::getPointAtTime(float time) const
+{
+    return evaluate(time * _segments.size());
+}
+
+Vec2 SplinePath::getPointAtDistance(float distance) const
+{
+    const float length = getLength();
+    if (length <= 0 || distance <= 0)
+        return evaluate(0);
+    if (distance >= length)
+        return evaluate((float)_segments.size());
+
+    // the sample before the distance, and the parameter between it and the next one
+    auto next = std::upper_bound(_lengths.begin(), _lengths.end(), distance);
+    int sample = (int)(next - _lengths.begin()) - 1;
+    float chord = _lengths[sample + 1] - _lengths[sample];
+    float fraction = chord > 0 ? (distance - _lengths[sample]) / chord : 0;
+    return evaluate((sample + fraction) / _samplesPerSegment);
+}
+
 CardinalSplineTo* CardinalSplineTo::create(float duration, cocos2d::PointArray *points, float tension)
 {
     CardinalSplineTo *ret = new (std::nothrow) CardinalSplineTo();
@@ -245,13 +349,48 @@ bool CardinalSplineTo::initWithDuration(float duration, cocos2d::PointArray *poi
     return false;
 }
 
+CardinalSplineTo* CardinalSplineTo::create(float duration, SplinePath* path)
+{
+    CardinalSplineTo *ret = new (std::nothrow) CardinalSplineTo();
+    if (ret)
+    {
+        if (ret->initWithDuration(duration, path))
+        {
+            ret->autorelease();
+        }
+        else
+        {
+            CC_SAFE_RELEASE_NULL(ret);
+        }
+    }
+
+    return ret;
+}
+
+bool CardinalSplineTo::initWithDuration(float duration, SplinePath* path)
+{
+    CCASSERT(path, "Invalid configuration. It must have a path");
+
+    if (path && initWithDuration(duration, path->getPoints(), path->getTension()))
+    {
+        CC_SAFE_RETAIN(path);
+        CC_SAFE_RELEASE(_path);
+        _path = path;
+        return true;
+    }
+
+    return false;
+}
+
 CardinalSplineTo::~CardinalSplineTo()
 {
     CC_SAFE_RELEASE_NULL(_points);
+    CC_SAFE_RELEASE_NULL(_path);
 }
 
 CardinalSplineTo::CardinalSplineTo()
 : _points(nullptr)
+, _path(nullptr)
 , _deltaT(0.f)
 , _tension(0.f)
 {
@@ -274,13 +413,32 @@ CardinalSplineTo* CardinalSplineTo::clone() const
 {
     // no copy constructor
     auto a = new (std::nothrow) CardinalSplineTo();
-    a->initWithDuration(this->_duration, this->_points->clone(), this->_tension);
+    if (_path)
+        a->initWithDuration(this->_duration, _path);
+    else
+        a->initWithDuration(this->_duration, this->_points->clone(), this->_tension);
     a->autorelease();
     return a;
 }
 
 void CardinalSplineTo::update(float time)
 {
+    if (_path)
+    {
+        // a constant speed along the shared path
+        Vec2 newPos = _path->getPointAtProgress(time);
+#if CC_ENABLE_STACKABLE_ACTIONS
+        Vec2 diff = _target->getPosition() - _previousPosition;
+        if( diff.x !=0 || diff.y != 0 )
+        {
+            _accumulatedDiff = _accumulatedDiff + diff;
+        }
+        newPos = newPos + _accumulatedDiff;
+#endif
+        this->updatePosition(newPos);
+        return;
+    }
+
     ssize_t p;
     float lt;
 
@@ -331,6 +489,10 @@ CardinalSplineTo* CardinalSplineTo::reverse() const
 {
     PointArray *pReverse = _points->reverse();
 
+    if (_path)
+    {
+        return CardinalSplineTo::create(_duration, SplinePath::create(pReverse, _tension, _path->getSamplesPerSegment()));
+    }
     return CardinalSplineTo::create(_duration, pReverse, _tension);
 }
 
@@ -355,6 +517,24 @@ CardinalSplineBy* CardinalSplineBy::create(float duration, cocos2d::PointArray *
     return ret;
 }
 
+CardinalSplineBy* CardinalSplineBy::create(float duration, SplinePath* path)
+{
+    CardinalSplineBy *ret = new (std::nothrow) CardinalSplineBy();
+    if (ret)
+    {
+        if (ret->initWithDuration(duration, path))
+        {
+            ret->autorelease();
+        }
+        else
+        {
+            CC_SAFE_RELEASE_NULL(ret);
+        }
+    }
+
+    return ret;
+}
+
 CardinalSplineBy::CardinalSplineBy() : _startPosition(0,0)
 {
 }
@@ -404,6 +584,10 @@ CardinalSplineBy* CardinalSplineBy::reverse() const
         p = abs;
     }
 
+    if (_path)
+    {
+        return CardinalSplineBy::create(_duration, SplinePath::create(pReverse, _tension, _path->getSamplesPerSegment()));
+    }
     return CardinalSplineBy::create(_duration, pReverse, _tension);
 }
 
@@ -417,7 +601,10 @@ CardinalSplineBy* CardinalSplineBy::clone() const
 {
     // no copy constructor
     auto a = new (std::nothrow) CardinalSplineBy();
-    a->initWithDuration(this->_duration, this->_points->clone(), this->_tension);
+    if (_path)
+        a->initWithDuration(this->_duration, _path);
+    else
+        a->initWithDuration(this->_duration, this->_points->clone(), this->_tension);
     a->autorelease();
     return a;
 }
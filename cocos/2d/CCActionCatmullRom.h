@@ -157,6 +157,67 @@ private:
     std::vector<Vec2*> *_controlPoints;
 };
 
+/** @class SplinePath
+ * A Cardinal Spline precomputed for constant speed: the polynomials of its segments and a table of its arc length.
+ * It can't be changed once created, so the actions of all the nodes that follow the same path can share it.
+ * A Catmull Rom path is a Cardinal Spline path with a tension of 0.5.
+ * @since v3.11
+ * @ingroup Actions
+ * @js NA
+ * @lua NA
+ */
+class CC_DLL SplinePath : public Ref
+{
+public:
+    /** Creates a path through a copy of the control points.
+     * @param points The control points, at least one.
+     * @param tension Goodness of fit.
+     * @param samplesPerSegment The samples of the arc length table between two control points, more is closer to a
+     * constant speed on the tight curves.
+     */
+    static SplinePath* create(PointArray* points, float tension, int samplesPerSegment = 16);
+
+    /** Gets the length of the path, in points. */
+    float getLength() const { return _lengths.empty() ? 0 : _lengths.back(); }
+
+    /** Gets the position at a distance from the start of the path, clamped to the length. */
+    Vec2 getPointAtDistance(float distance) const;
+
+    /** Gets the position at a part of the length of the path, from 0 to 1: the position of a constant speed. */
+    Vec2 getPointAtProgress(float progress) const { return getPointAtDistance(progress * getLength()); }
+
+    /** Gets the position at a time of the segments, from 0 to 1, each segment takes the same time like in
+     * CardinalSplineTo::update(): the speed isn't constant. */
+    Vec2 getPointAtTime(float time) const;
+
+    /** Gets a copy of the control points. */
+    PointArray* getPoints() const { return _points; }
+    float getTension() const { return _tension; }
+    int getSamplesPerSegment() const { return _samplesPerSegment; }
+
+CC_CONSTRUCTOR_ACCESS:
+    SplinePath();
+    virtual ~SplinePath();
+
+    bool init(PointArray* points, float tension, int samplesPerSegment);
+
+protected:
+    // the position at a parameter of the segments, from 0 to the number of segments
+    Vec2 evaluate(float parameter) const;
+
+    PointArray* _points;
+    float _tension;
+    int _samplesPerSegment;
+    // the coefficients of each segment, the position at t is ((a t + b) t + c) t + d
+    struct Segment
+    {
+        Vec2 a, b, c, d;
+    };
+    std::vector<Segment> _segments;
+    // the length of the path at each sample, sample i is at the parameter i / _samplesPerSegment
+    std::vector<float> _lengths;
+};
+
 /** @class CardinalSplineTo
  * Cardinal Spline path.
  * http://en.wikipedia.org/wiki/Cubic_Hermite_spline#Cardinal_spline
@@ -177,6 +238,16 @@ public:
      * @endcode
      */
     static CardinalSplineTo* create(float duration, PointArray* points, float tension);
+
+    /** Creates an action that follows a precomputed path at a constant speed, the path may be shared with other
+     * actions.
+     * @param duration In seconds.
+     * @param path The path, retained.
+     * @since v3.11
+     * @js NA
+     * @lua NA
+     */
+    static CardinalSplineTo* create(float duration, SplinePath* path);
     /**
      * @js NA
      * @lua NA
@@ -196,6 +267,24 @@ public:
      * @param tension Goodness of fit.
      */
     bool initWithDuration(float duration, PointArray* points, float tension);
+
+    /**
+     * Initializes the action with a duration and a precomputed path.
+     * @param duration In seconds.
+     * @param path The path, retained.
+     * @since v3.11
+     * @js NA
+     * @lua NA
+     */
+    bool initWithDuration(float duration, SplinePath* path);
+
+    /** Gets the precomputed path, nullptr when the action evaluates its points.
+     * @since v3.11
+     * @js NA
+     * @lua NA
+     */
+    SplinePath* getPath() const { return _path; }
+
     /** It will update the target position and change the _previousPosition to newPos
      *
      * @param newPos The new position.
@@ -230,6 +319,8 @@ public:
 protected:
     /** Array of control points */
     PointArray *_points;
+    /** The precomputed path, if any */
+    SplinePath *_path;
     float _deltaT;
     float _tension;
     Vec2 _previousPosition;
@@ -257,6 +348,16 @@ public:
      */
     static CardinalSplineBy* create(float duration, PointArray* points, float tension);
 
+    /** Creates an action that follows a precomputed path from the position of its target at a constant speed, the
+     * control points of the path are relative to that position.
+     * @param duration In seconds.
+     * @param path The path, retained.
+     * @since v3.11
+     * @js NA
+     * @lua NA
+     */
+    static CardinalSplineBy* create(float duration, SplinePath* path);
+
     CardinalSplineBy();
 
     // Overrides
@@ -31,6 +31,16 @@
 
 
 NS_CC_BEGIN
+
+CC_ACTION_POOL_DEFINE(Show);
+CC_ACTION_POOL_DEFINE(Hide);
+CC_ACTION_POOL_DEFINE(ToggleVisibility);
+CC_ACTION_POOL_DEFINE(RemoveSelf);
+CC_ACTION_POOL_DEFINE(FlipX);
+CC_ACTION_POOL_DEFINE(FlipY);
+CC_ACTION_POOL_DEFINE(Place);
+CC_ACTION_POOL_DEFINE(CallFunc);
+CC_ACTION_POOL_DEFINE(CallFuncN);
 //
 // InstantAction
 //
@@ -30,6 +30,7 @@ THE SOFTWARE.
 
 #include <functional>
 #include "2d/CCAction.h"
+#include "2d/CCActionPool.h"
 
 NS_CC_BEGIN
 
@@ -75,6 +76,7 @@ public:
 **/
 class CC_DLL Show : public ActionInstant
 {
+    CC_ACTION_POOL(Show)
 public:
     /** Allocates and initializes the action.
      *
@@ -105,6 +107,7 @@ private:
 */
 class CC_DLL Hide : public ActionInstant
 {
+    CC_ACTION_POOL(Hide)
 public:
     /** Allocates and initializes the action.
      *
@@ -135,6 +138,7 @@ private:
 */
 class CC_DLL ToggleVisibility : public ActionInstant
 {
+    CC_ACTION_POOL(ToggleVisibility)
 public:
     /** Allocates and initializes the action.
      *
@@ -165,6 +169,7 @@ private:
 */
 class CC_DLL RemoveSelf : public ActionInstant
 {
+    CC_ACTION_POOL(RemoveSelf)
 public:
     /** Create the action.
      *
@@ -203,6 +208,7 @@ private:
 */
 class CC_DLL FlipX : public ActionInstant
 {
+    CC_ACTION_POOL(FlipX)
 public:
     /** Create the action.
      *
@@ -241,6 +247,7 @@ private:
 */
 class CC_DLL FlipY : public ActionInstant
 {
+    CC_ACTION_POOL(FlipY)
 public:
     /** Create the action.
      *
@@ -278,6 +285,7 @@ private:
 */
 class CC_DLL Place : public ActionInstant //<NSCopying>
 {
+    CC_ACTION_POOL(Place)
 public:
 
     /** Creates a Place action with a position.
@@ -317,6 +325,7 @@ private:
 */
 class CC_DLL CallFunc : public ActionInstant //<NSCopying>
 {
+    CC_ACTION_POOL(CallFunc)
 public:
     /** Creates the action with the callback of type std::function<void()>.
      This is the preferred way to create the callback.
@@ -377,6 +386,7 @@ private:
 */
 class CC_DLL CallFuncN : public CallFunc
 {
+    CC_ACTION_POOL(CallFuncN)
 public:
     /** Creates the action with the callback of type std::function<void()>.
      This is the preferred way to create the callback.
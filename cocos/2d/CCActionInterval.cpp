@@ -40,6 +40,34 @@ THE SOFTWARE.
 
 NS_CC_BEGIN
 
+CC_ACTION_POOL_DEFINE(Sequence);
+CC_ACTION_POOL_DEFINE(Repeat);
+CC_ACTION_POOL_DEFINE(RepeatForever);
+CC_ACTION_POOL_DEFINE(Spawn);
+CC_ACTION_POOL_DEFINE(RotateTo);
+CC_ACTION_POOL_DEFINE(RotateBy);
+CC_ACTION_POOL_DEFINE(MoveBy);
+CC_ACTION_POOL_DEFINE(MoveTo);
+CC_ACTION_POOL_DEFINE(SkewTo);
+CC_ACTION_POOL_DEFINE(SkewBy);
+CC_ACTION_POOL_DEFINE(JumpBy);
+CC_ACTION_POOL_DEFINE(JumpTo);
+CC_ACTION_POOL_DEFINE(BezierBy);
+CC_ACTION_POOL_DEFINE(BezierTo);
+CC_ACTION_POOL_DEFINE(ScaleTo);
+CC_ACTION_POOL_DEFINE(ScaleBy);
+CC_ACTION_POOL_DEFINE(Blink);
+CC_ACTION_POOL_DEFINE(FadeTo);
+CC_ACTION_POOL_DEFINE(FadeIn);
+CC_ACTION_POOL_DEFINE(FadeOut);
+CC_ACTION_POOL_DEFINE(TintTo);
+CC_ACTION_POOL_DEFINE(TintBy);
+CC_ACTION_POOL_DEFINE(DelayTime);
+CC_ACTION_POOL_DEFINE(ReverseTime);
+CC_ACTION_POOL_DEFINE(Animate);
+CC_ACTION_POOL_DEFINE(TargetedAction);
+CC_ACTION_POOL_DEFINE(ActionFloat);
+
 // Extra action for making a Sequence or Spawn when only adding one action to it.
 class ExtraAction : public FiniteTimeAction
 {
@@ -31,6 +31,7 @@ THE SOFTWARE.
 #include <vector>
 
 #include "2d/CCAction.h"
+#include "2d/CCActionPool.h"
 #include "2d/CCAnimation.h"
 #include "base/CCProtocols.h"
 #include "base/CCVector.h"
@@ -116,6 +117,8 @@ protected:
     float _elapsed;
     bool   _firstTick;
 
+    friend class ActionManager;
+
 protected:
     bool sendUpdateEventToScript(float dt, Action *actionObject);
 };
@@ -125,6 +128,7 @@ protected:
  */
 class CC_DLL Sequence : public ActionInterval
 {
+    CC_ACTION_POOL(Sequence)
 public:
     /** Helper constructor to create an array of sequenceable actions.
      *
@@ -212,6 +216,7 @@ private:
  */
 class CC_DLL Repeat : public ActionInterval
 {
+    CC_ACTION_POOL(Repeat)
 public:
     /** Creates a Repeat action. Times is an unsigned integer between 1 and pow(2,30).
      *
@@ -283,6 +288,7 @@ private:
  */
 class CC_DLL RepeatForever : public ActionInterval
 {
+    CC_ACTION_POOL(RepeatForever)
 public:
     /** Creates the action.
      *
@@ -348,6 +354,7 @@ private:
  */
 class CC_DLL Spawn : public ActionInterval
 {
+    CC_ACTION_POOL(Spawn)
 public:
     /** Helper constructor to create an array of spawned actions.
      * @code
@@ -437,6 +444,7 @@ private:
 */
 class CC_DLL RotateTo : public ActionInterval
 {
+    CC_ACTION_POOL(RotateTo)
 public:
     /**
      * Creates the action with separate rotation angles.
@@ -504,6 +512,8 @@ protected:
     Vec3 _startAngle;
     Vec3 _diffAngle;
 
+    friend class ActionManager;
+
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(RotateTo);
 };
@@ -513,6 +523,7 @@ private:
 */
 class CC_DLL RotateBy : public ActionInterval
 {
+    CC_ACTION_POOL(RotateBy)
 public:
     /**
      * Creates the action.
@@ -567,6 +578,8 @@ protected:
     Vec3 _deltaAngle;
     Vec3 _startAngle;
 
+    friend class ActionManager;
+
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(RotateBy);
 };
@@ -580,6 +593,7 @@ private:
  */
 class CC_DLL MoveBy : public ActionInterval
 {
+    CC_ACTION_POOL(MoveBy)
 public:
     /**
      * Creates the action.
@@ -622,6 +636,8 @@ protected:
     Vec2 _startPosition;
     Vec2 _previousPosition;
 
+    friend class ActionManager;
+
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(MoveBy);
 };
@@ -634,6 +650,7 @@ private:
  */
 class CC_DLL MoveTo : public MoveBy
 {
+    CC_ACTION_POOL(MoveTo)
 public:
     /**
      * Creates the action.
@@ -685,6 +702,7 @@ private:
 */
 class CC_DLL SkewTo : public ActionInterval
 {
+    CC_ACTION_POOL(SkewTo)
 public:
     /**
      * Creates the action.
@@ -734,6 +752,7 @@ private:
 */
 class CC_DLL SkewBy : public SkewTo
 {
+    CC_ACTION_POOL(SkewBy)
 public:
     /**
      * Creates the action.
@@ -768,6 +787,7 @@ private:
 */
 class CC_DLL JumpBy : public ActionInterval
 {
+    CC_ACTION_POOL(JumpBy)
 public:
     /**
      * Creates the action.
@@ -816,6 +836,7 @@ private:
 */
 class CC_DLL JumpTo : public JumpBy
 {
+    CC_ACTION_POOL(JumpTo)
 public:
     /**
      * Creates the action.
@@ -867,6 +888,7 @@ typedef struct _ccBezierConfig {
  */
 class CC_DLL BezierBy : public ActionInterval
 {
+    CC_ACTION_POOL(BezierBy)
 public:
     /** Creates the action with a duration and a bezier configuration.
      * @param t Duration time, in seconds.
@@ -916,6 +938,7 @@ private:
  */
 class CC_DLL BezierTo : public BezierBy
 {
+    CC_ACTION_POOL(BezierTo)
 public:
     /** Creates the action with a duration and a bezier configuration.
      * @param t Duration time, in seconds.
@@ -957,6 +980,7 @@ private:
  */
 class CC_DLL ScaleTo : public ActionInterval
 {
+    CC_ACTION_POOL(ScaleTo)
 public:
     /**
      * Creates the action with the same scale factor for X and Y.
@@ -1030,6 +1054,8 @@ protected:
     float _deltaY;
     float _deltaZ;
 
+    friend class ActionManager;
+
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(ScaleTo);
 };
@@ -1039,6 +1065,7 @@ private:
 */
 class CC_DLL ScaleBy : public ScaleTo
 {
+    CC_ACTION_POOL(ScaleBy)
 public:
     /**
      * Creates the action with the same scale factor for X and Y.
@@ -1087,6 +1114,7 @@ private:
 */
 class CC_DLL Blink : public ActionInterval
 {
+    CC_ACTION_POOL(Blink)
 public:
     /**
      * Creates the action.
@@ -1133,6 +1161,7 @@ private:
  */
 class CC_DLL FadeTo : public ActionInterval
 {
+    CC_ACTION_POOL(FadeTo)
 public:
     /**
      * Creates an action with duration and opacity.
@@ -1168,6 +1197,7 @@ protected:
     GLubyte _fromOpacity;
     friend class FadeOut;
     friend class FadeIn;
+    friend class ActionManager;
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(FadeTo);
 };
@@ -1178,6 +1208,7 @@ private:
  */
 class CC_DLL FadeIn : public FadeTo
 {
+    CC_ACTION_POOL(FadeIn)
 public:
     /**
      * Creates the action.
@@ -1213,6 +1244,7 @@ private:
 */
 class CC_DLL FadeOut : public FadeTo
 {
+    CC_ACTION_POOL(FadeOut)
 public:
     /**
      * Creates the action.
@@ -1247,6 +1279,7 @@ private:
 */
 class CC_DLL TintTo : public ActionInterval
 {
+    CC_ACTION_POOL(TintTo)
 public:
     /**
      * Creates an action with duration and color.
@@ -1297,6 +1330,7 @@ private:
  */
 class CC_DLL TintBy : public ActionInterval
 {
+    CC_ACTION_POOL(TintBy)
 public:
     /**
      * Creates an action with duration and color.
@@ -1344,6 +1378,7 @@ private:
 */
 class CC_DLL DelayTime : public ActionInterval
 {
+    CC_ACTION_POOL(DelayTime)
 public:
     /**
      * Creates the action.
@@ -1380,6 +1415,7 @@ private:
 */
 class CC_DLL ReverseTime : public ActionInterval
 {
+    CC_ACTION_POOL(ReverseTime)
 public:
     /** Creates the action.
      *
@@ -1420,6 +1456,7 @@ class Texture2D;
  */
 class CC_DLL Animate : public ActionInterval
 {
+    CC_ACTION_POOL(Animate)
 public:
     /** Creates the action with an Animation and will restore the original frame when the animation is over.
      *
@@ -1484,6 +1521,7 @@ private:
  */
 class CC_DLL TargetedAction : public ActionInterval
 {
+    CC_ACTION_POOL(TargetedAction)
 public:
     /** Create an action with the specified action and forced target.
      *
@@ -1538,6 +1576,7 @@ private:
  */
 class CC_DLL ActionFloat : public ActionInterval
 {
+    CC_ACTION_POOL(ActionFloat)
 public:
     /**
      *  Callback function used to report back result
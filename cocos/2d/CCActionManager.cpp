@@ -27,9 +27,17 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "2d/CCActionManager.h"
+
+#include <typeinfo>
+#include <vector>
+
 #include "2d/CCNode.h"
 #include "2d/CCAction.h"
+#include "2d/CCActionInterval.h"
+#include "2d/CCActionEase.h"
+#include "2d/CCTweenFunction.h"
 #include "base/CCScheduler.h"
+#include "base/CCFrameTimings.h"
 #include "base/ccMacros.h"
 #include "base/ccCArray.h"
 #include "base/uthash.h"
@@ -46,15 +54,237 @@ typedef struct _hashElement
     Action              *currentAction;
     bool                currentActionSalvaged;
     bool                paused;
+    // added to the dt of the next update, see resumeTarget()
+    float               missedTime;
+    // the number of actions run as tweens
+    int                 tweenCount;
     UT_hash_handle      hh;
 } tHashElement;
 
+//
+// tweens
+//
+
+// the easings of the tweens, tweenfunc::tweenTo() computes the TWEEN_FUNC ones
+enum class TweenEasing
+{
+    LINEAR,
+    TWEEN_FUNC,
+    RATE_IN,
+    RATE_OUT,
+    RATE_IN_OUT,
+    QUADRATIC_IN,
+    QUADRATIC_OUT,
+    QUADRATIC_IN_OUT,
+};
+
+enum TweenKind
+{
+    TWEEN_POSITION,
+    TWEEN_SCALE,
+    TWEEN_OPACITY,
+    TWEEN_ROTATION,
+};
+
+// `action` is the action added to the manager, the ease action if there is one. nullptr once the tween was removed.
+struct TweenBase
+{
+    ActionInterval          *action;
+    Node                    *target;
+    tHashElement            *element;
+    TweenEasing             easing;
+    tweenfunc::TweenType    tweenType;
+    float                   easingParam;
+};
+
+// MoveBy::update()
+struct PositionTween : TweenBase
+{
+    Vec2    startPosition;
+    Vec2    previousPosition;
+    Vec2    positionDelta;
+};
+
+// ScaleTo::update()
+struct ScaleTween : TweenBase
+{
+    Vec3    startScale;
+    Vec3    deltaScale;
+};
+
+// FadeTo::update()
+struct OpacityTween : TweenBase
+{
+    float   fromOpacity;
+    float   deltaOpacity;
+};
+
+// RotateTo::update() and RotateBy::update()
+struct RotationTween : TweenBase
+{
+    Vec2    startAngle;
+    Vec2    deltaAngle;
+};
+
+typedef struct _tweenArrays
+{
+    std::vector<PositionTween>  positions;
+    std::vector<ScaleTween>     scales;
+    std::vector<OpacityTween>   opacities;
+    std::vector<RotationTween>  rotations;
+    // the actions that finished during updateTweens()
+    std::vector<Action*>        finished;
+    // the eased times of the tweens of an array, negative for the ones that didn't step
+    std::vector<float>          times;
+    // the number of tweens removed since the arrays were compacted
+    int                         removed;
+} tTweenArrays;
+
+// Gets the easing of `action` if it's an ease action the tweens can compute, and returns the action it eases.
+// Returns `action` itself if it isn't an ease action, nullptr if it's an ease the tweens can't compute.
+static Action* findTweenEasing(Action *action, TweenBase &tween)
+{
+    static const struct
+    {
+        const std::type_info    &type;
+        tweenfunc::TweenType    tweenType;
+    } tweenFuncEasings[] = {
+        { typeid(EaseSineIn), tweenfunc::Sine_EaseIn },
+        { typeid(EaseSineOut), tweenfunc::Sine_EaseOut },
+        { typeid(EaseSineInOut), tweenfunc::Sine_EaseInOut },
+        { typeid(EaseCubicActionIn), tweenfunc::Cubic_EaseIn },
+        { typeid(EaseCubicActionOut), tweenfunc::Cubic_EaseOut },
+        { typeid(EaseCubicActionInOut), tweenfunc::Cubic_EaseInOut },
+        { typeid(EaseQuarticActionIn), tweenfunc::Quart_EaseIn },
+        { typeid(EaseQuarticActionOut), tweenfunc::Quart_EaseOut },
+        { typeid(EaseQuarticActionInOut), tweenfunc::Quart_EaseInOut },
+        { typeid(EaseQuinticActionIn), tweenfunc::Quint_EaseIn },
+        { typeid(EaseQuinticActionOut), tweenfunc::Quint_EaseOut },
+        { typeid(EaseQuinticActionInOut), tweenfunc::Quint_EaseInOut },
+        { typeid(EaseExponentialIn), tweenfunc::Expo_EaseIn },
+        { typeid(EaseExponentialOut), tweenfunc::Expo_EaseOut },
+        { typeid(EaseExponentialInOut), tweenfunc::Expo_EaseInOut },
+        { typeid(EaseCircleActionIn), tweenfunc::Circ_EaseIn },
+        { typeid(EaseCircleActionOut), tweenfunc::Circ_EaseOut },
+        { typeid(EaseCircleActionInOut), tweenfunc::Circ_EaseInOut },
+        { typeid(EaseElasticIn), tweenfunc::Elastic_EaseIn },
+        { typeid(EaseElasticOut), tweenfunc::Elastic_EaseOut },
+        { typeid(EaseElasticInOut), tweenfunc::Elastic_EaseInOut },
+        { typeid(EaseBackIn), tweenfunc::Back_EaseIn },
+        { typeid(EaseBackOut), tweenfunc::Back_EaseOut },
+        { typeid(EaseBackInOut), tweenfunc::Back_EaseInOut },
+        { typeid(EaseBounceIn), tweenfunc::Bounce_EaseIn },
+        { typeid(EaseBounceOut), tweenfunc::Bounce_EaseOut },
+        { typeid(EaseBounceInOut), tweenfunc::Bounce_EaseInOut },
+    };
+
+    tween.easing = TweenEasing::LINEAR;
+    tween.tweenType = tweenfunc::Linear;
+    tween.easingParam = 0;
+
+    const std::type_info &type = typeid(*action);
+    if (type == typeid(EaseIn) || type == typeid(EaseOut) || type == typeid(EaseInOut))
+    {
+        tween.easing = type == typeid(EaseIn) ? TweenEasing::RATE_IN : (type == typeid(EaseOut) ? TweenEasing::RATE_OUT : TweenEasing::RATE_IN_OUT);
+        tween.easingParam = static_cast<EaseRateAction*>(action)->getRate();
+        return static_cast<ActionEase*>(action)->getInnerAction();
+    }
+    if (type == typeid(EaseQuadraticActionIn) || type == typeid(EaseQuadraticActionOut) || type == typeid(EaseQuadraticActionInOut))
+    {
+        // they don't use the Quad_ functions of tweenTo()
+        tween.easing = type == typeid(EaseQuadraticActionIn) ? TweenEasing::QUADRATIC_IN : (type == typeid(EaseQuadraticActionOut) ? TweenEasing::QUADRATIC_OUT : TweenEasing::QUADRATIC_IN_OUT);
+        return static_cast<ActionEase*>(action)->getInnerAction();
+    }
+    for (const auto &easing : tweenFuncEasings)
+    {
+        if (type == easing.type)
+        {
+            tween.easing = TweenEasing::TWEEN_FUNC;
+            tween.tweenType = easing.tweenType;
+            if (easing.tweenType == tweenfunc::Elastic_EaseIn || easing.tweenType == tweenfunc::Elastic_EaseOut || easing.tweenType == tweenfunc::Elastic_EaseInOut)
+            {
+                tween.easingParam = static_cast<EaseElastic*>(action)->getPeriod();
+            }
+            return static_cast<ActionEase*>(action)->getInnerAction();
+        }
+    }
+
+    return dynamic_cast<ActionEase*>(action) ? nullptr : action;
+}
+
+static inline float easeTween(const TweenBase &tween, float time)
+{
+    switch (tween.easing)
+    {
+        case TweenEasing::LINEAR:
+            return time;
+        case TweenEasing::RATE_IN:
+            return tweenfunc::easeIn(time, tween.easingParam);
+        case TweenEasing::RATE_OUT:
+            return tweenfunc::easeOut(time, tween.easingParam);
+        case TweenEasing::RATE_IN_OUT:
+            return tweenfunc::easeInOut(time, tween.easingParam);
+        case TweenEasing::QUADRATIC_IN:
+            return tweenfunc::quadraticIn(time);
+        case TweenEasing::QUADRATIC_OUT:
+            return tweenfunc::quadraticOut(time);
+        case TweenEasing::QUADRATIC_IN_OUT:
+            return tweenfunc::quadraticInOut(time);
+        default:
+        {
+            float param = tween.easingParam;
+            return tweenfunc::tweenTo(time, tween.tweenType, &param);
+        }
+    }
+}
+
+static inline bool isSameEasing(const TweenBase &a, const TweenBase &b)
+{
+    return a.easing == b.easing && a.tweenType == b.tweenType && a.easingParam == b.easingParam;
+}
+
+// Eases the stepped times of an array. The runs of tweens with the same tweenfunc easing, like the ones of actions
+// created together, are eased by one tweenfunc::tweenToBatch() call.
+template <typename T>
+static void easeTweens(const std::vector<T> &tweens, std::vector<float> &times)
+{
+    const size_t count = times.size();
+    size_t i = 0;
+    while (i < count)
+    {
+        const TweenBase &tween = tweens[i];
+        if (times[i] < 0)
+        {
+            ++i;
+            continue;
+        }
+        if (tween.easing != TweenEasing::TWEEN_FUNC)
+        {
+            times[i] = easeTween(tween, times[i]);
+            ++i;
+            continue;
+        }
+
+        size_t end = i + 1;
+        while (end < count && times[end] >= 0 && isSameEasing(tweens[end], tween))
+        {
+            ++end;
+        }
+        float param = tween.easingParam;
+        tweenfunc::tweenToBatch(&times[i], &times[i], (int)(end - i), tween.tweenType, &param);
+        i = end;
+    }
+}
+
 ActionManager::ActionManager()
 : _targets(nullptr),
   _currentTarget(nullptr),
-  _currentTargetSalvaged(false)
+  _currentTargetSalvaged(false),
+  _lastUpdateTime(0),
+  _lastStepCount(0),
+  _tweens(new tTweenArrays())
 {
-
+    _tweens->removed = 0;
 }
 
 ActionManager::~ActionManager()
@@ -62,6 +292,7 @@ ActionManager::~ActionManager()
     CCLOGINFO("deallocing ActionManager: %p", this);
 
     removeAllActions();
+    delete _tweens;
 }
 
 // private
@@ -70,6 +301,7 @@ void ActionManager::deleteHashElement(tHashElement *element)
 {
     ccArrayFree(element->actions);
     HASH_DEL(_targets, element);
+    element->target->_actionTargetCount--;
     element->target->release();
     free(element);
 }
@@ -92,6 +324,11 @@ void ActionManager::removeActionAtIndex(ssize_t index, tHashElement *element)
 {
     Action *action = (Action*)element->actions->arr[index];
 
+    if (action->_tweenIndex >= 0)
+    {
+        removeTween(action);
+    }
+
     if (action == element->currentAction && (! element->currentActionSalvaged))
     {
         element->currentAction->retain();
@@ -132,11 +369,20 @@ void ActionManager::pauseTarget(Node *target)
 }
 
 void ActionManager::resumeTarget(Node *target)
+{
+    resumeTarget(target, 0);
+}
+
+void ActionManager::resumeTarget(Node *target, float missedTime)
 {
     tHashElement *element = nullptr;
     HASH_FIND_PTR(_targets, &target, element);
     if (element)
     {
+        if (element->paused)
+        {
+            element->missedTime += missedTime;
+        }
         element->paused = false;
     }
 }
@@ -183,6 +429,7 @@ void ActionManager::addAction(Action *action, Node *target, bool paused)
         element = (tHashElement*)calloc(sizeof(*element), 1);
         element->paused = paused;
         target->retain();
+        target->_actionTargetCount++;
         element->target = target;
         HASH_ADD_PTR(_targets, target, element);
     }
@@ -193,6 +440,10 @@ void ActionManager::addAction(Action *action, Node *target, bool paused)
      ccArrayAppendObject(element->actions, action);
 
      action->startWithTarget(target);
+
+#if CC_ENABLE_FAST_ACTIONS
+     addTween(action, element);
+#endif
 }
 
 // remove
@@ -225,6 +476,15 @@ void ActionManager::removeAllActionsFromTarget(Node *target)
             element->currentActionSalvaged = true;
         }
 
+        for (ssize_t i = 0; element->tweenCount > 0 && i < element->actions->num; ++i)
+        {
+            Action *action = (Action*)element->actions->arr[i];
+            if (action->_tweenIndex >= 0)
+            {
+                removeTween(action);
+            }
+        }
+
         ccArrayRemoveAllObjects(element->actions);
         if (_currentTarget == element)
         {
@@ -395,12 +655,26 @@ ssize_t ActionManager::getNumberOfRunningActionsInTarget(const Node *target) con
 // main loop
 void ActionManager::update(float dt)
 {
+    auto start = FrameTimings::Clock::now();
+    _lastStepCount = 0;
+
+    updateTweens(dt);
+
     for (tHashElement *elt = _targets; elt != nullptr; )
     {
         _currentTarget = elt;
         _currentTargetSalvaged = false;
 
+        // updateTweens() has stepped the tweens by the missed time already
+        float targetDt = dt;
         if (! _currentTarget->paused)
+        {
+            targetDt += _currentTarget->missedTime;
+            _currentTarget->missedTime = 0;
+        }
+
+        // the targets that only run tweens are done
+        if (! _currentTarget->paused && _currentTarget->actions->num > _currentTarget->tweenCount)
         {
             // The 'actions' MutableArray may change while inside this loop.
             for (_currentTarget->actionIndex = 0; _currentTarget->actionIndex < _currentTarget->actions->num;
@@ -411,10 +685,17 @@ void ActionManager::update(float dt)
                 {
                     continue;
                 }
+                if (_currentTarget->currentAction->_tweenIndex >= 0)
+                {
+                    // updateTweens() has run it
+                    _currentTarget->currentAction = nullptr;
+                    continue;
+                }
 
                 _currentTarget->currentActionSalvaged = false;
 
-                _currentTarget->currentAction->step(dt);
+                _lastStepCount++;
+                _currentTarget->currentAction->step(targetDt);
 
                 if (_currentTarget->currentActionSalvaged)
                 {
@@ -450,6 +731,290 @@ void ActionManager::update(float dt)
 
     // issue #635
     _currentTarget = nullptr;
+
+    _lastUpdateTime = FrameTimings::elapsed(start);
+}
+
+// tweens
+
+void ActionManager::addTween(Action *action, tHashElement *element)
+{
+    TweenBase tween;
+    Action *inner = findTweenEasing(action, tween);
+    if (inner == nullptr)
+    {
+        return;
+    }
+
+    tween.action = static_cast<ActionInterval*>(action);
+    tween.target = element->target;
+    tween.element = element;
+
+    // the subclasses may override update(), only the actions themselves are run as tweens
+    const std::type_info &type = typeid(*inner);
+    if (type == typeid(MoveBy) || type == typeid(MoveTo))
+    {
+        auto move = static_cast<MoveBy*>(inner);
+        PositionTween position;
+        static_cast<TweenBase&>(position) = tween;
+        position.startPosition = move->_startPosition;
+        position.previousPosition = move->_previousPosition;
+        position.positionDelta = move->_positionDelta;
+
+        action->_tweenKind = TWEEN_POSITION;
+        action->_tweenIndex = (int)_tweens->positions.size();
+        _tweens->positions.push_back(position);
+    }
+    else if (type == typeid(ScaleTo) || type == typeid(ScaleBy))
+    {
+        auto scaleTo = static_cast<ScaleTo*>(inner);
+        ScaleTween scale;
+        static_cast<TweenBase&>(scale) = tween;
+        scale.startScale.set(scaleTo->_startScaleX, scaleTo->_startScaleY, scaleTo->_startScaleZ);
+        scale.deltaScale.set(scaleTo->_deltaX, scaleTo->_deltaY, scaleTo->_deltaZ);
+
+        action->_tweenKind = TWEEN_SCALE;
+        action->_tweenIndex = (int)_tweens->scales.size();
+        _tweens->scales.push_back(scale);
+    }
+    else if (type == typeid(FadeTo) || type == typeid(FadeIn) || type == typeid(FadeOut))
+    {
+        auto fadeTo = static_cast<FadeTo*>(inner);
+        OpacityTween opacity;
+        static_cast<TweenBase&>(opacity) = tween;
+        opacity.fromOpacity = fadeTo->_fromOpacity;
+        opacity.deltaOpacity = (float)(fadeTo->_toOpacity - fadeTo->_fromOpacity);
+
+        action->_tweenKind = TWEEN_OPACITY;
+        action->_tweenIndex = (int)_tweens->opacities.size();
+        _tweens->opacities.push_back(opacity);
+    }
+    else if (type == typeid(RotateTo) || type == typeid(RotateBy))
+    {
+        RotationTween rotation;
+        static_cast<TweenBase&>(rotation) = tween;
+        if (type == typeid(RotateTo))
+        {
+            auto rotateTo = static_cast<RotateTo*>(inner);
+            rotation.startAngle.set(rotateTo->_startAngle.x, rotateTo->_startAngle.y);
+            rotation.deltaAngle.set(rotateTo->_diffAngle.x, rotateTo->_diffAngle.y);
+        }
+        else
+        {
+            auto rotateBy = static_cast<RotateBy*>(inner);
+            rotation.startAngle.set(rotateBy->_startAngle.x, rotateBy->_startAngle.y);
+            rotation.deltaAngle.set(rotateBy->_deltaAngle.x, rotateBy->_deltaAngle.y);
+        }
+
+        action->_tweenKind = TWEEN_ROTATION;
+        action->_tweenIndex = (int)_tweens->rotations.size();
+        _tweens->rotations.push_back(rotation);
+    }
+    else
+    {
+        return;
+    }
+
+    element->tweenCount++;
+}
+
+void ActionManager::removeTween(Action *action)
+{
+    // the arrays may be iterated, the tween is dropped by compactTweens()
+    TweenBase *tween = nullptr;
+    switch (action->_tweenKind)
+    {
+        case TWEEN_POSITION:
+            tween = &_tweens->positions[action->_tweenIndex];
+            break;
+        case TWEEN_SCALE:
+            tween = &_tweens->scales[action->_tweenIndex];
+            break;
+        case TWEEN_OPACITY:
+            tween = &_tweens->opacities[action->_tweenIndex];
+            break;
+        default:
+            tween = &_tweens->rotations[action->_tweenIndex];
+            break;
+    }
+
+    tween->element->tweenCount--;
+    tween->action = nullptr;
+    action->_tweenKind = -1;
+    action->_tweenIndex = -1;
+    _tweens->removed++;
+}
+
+template <typename T>
+void ActionManager::compactTweens(std::vector<T> &tweens)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < tweens.size(); ++i)
+    {
+        if (tweens[i].action != nullptr)
+        {
+            if (count != i)
+            {
+                tweens[count] = tweens[i];
+                tweens[count].action->_tweenIndex = (int)count;
+            }
+            count++;
+        }
+    }
+    tweens.resize(count);
+}
+
+void ActionManager::updateTweens(float dt)
+{
+    if (_tweens->removed > 0)
+    {
+        compactTweens(_tweens->positions);
+        compactTweens(_tweens->scales);
+        compactTweens(_tweens->opacities);
+        compactTweens(_tweens->rotations);
+        _tweens->removed = 0;
+    }
+
+    auto& finished = _tweens->finished;
+
+    auto& times = _tweens->times;
+
+    // ActionInterval::step(), the finished actions are stopped after the arrays were updated.
+    // The times of an array are stepped, then eased, then set: the setters may be overridden and add or remove
+    // actions, the tweens are looked up again by index and skipped once removed.
+    auto step = [this, dt, &finished, &times](const TweenBase &tween)
+    {
+        auto action = tween.action;
+        if (action == nullptr || tween.element->paused)
+        {
+            times.push_back(-1);
+            return;
+        }
+
+        _lastStepCount++;
+        if (action->_firstTick)
+        {
+            action->_firstTick = false;
+            action->_elapsed = 0;
+        }
+        else
+        {
+            action->_elapsed += dt + tween.element->missedTime;
+        }
+
+        if (action->_elapsed >= action->_duration)
+        {
+            action->retain();
+            finished.push_back(action);
+        }
+
+        times.push_back(MAX(0, MIN(1, action->_elapsed / action->_duration)));
+    };
+
+    times.clear();
+    for (const auto &tween : _tweens->positions)
+    {
+        step(tween);
+    }
+    easeTweens(_tweens->positions, times);
+    for (size_t i = 0, count = times.size(); i < count; ++i)
+    {
+        auto &tween = _tweens->positions[i];
+        if (times[i] < 0 || tween.action == nullptr)
+        {
+            continue;
+        }
+
+        float time = times[i];
+        auto target = tween.target;
+#if CC_ENABLE_STACKABLE_ACTIONS
+        tween.startPosition = tween.startPosition + (target->getPosition() - tween.previousPosition);
+        Vec2 position = tween.startPosition + (tween.positionDelta * time);
+        tween.previousPosition = position;
+#else
+        Vec2 position = tween.startPosition + tween.positionDelta * time;
+#endif
+        target->setPosition(position);
+    }
+
+    times.clear();
+    for (const auto &tween : _tweens->scales)
+    {
+        step(tween);
+    }
+    easeTweens(_tweens->scales, times);
+    for (size_t i = 0, count = times.size(); i < count; ++i)
+    {
+        auto &tween = _tweens->scales[i];
+        if (times[i] < 0 || tween.action == nullptr)
+        {
+            continue;
+        }
+
+        auto target = tween.target;
+        Vec3 scale = tween.startScale + tween.deltaScale * times[i];
+        target->setScaleX(scale.x);
+        target->setScaleY(scale.y);
+        target->setScaleZ(scale.z);
+    }
+
+    times.clear();
+    for (const auto &tween : _tweens->opacities)
+    {
+        step(tween);
+    }
+    easeTweens(_tweens->opacities, times);
+    for (size_t i = 0, count = times.size(); i < count; ++i)
+    {
+        auto &tween = _tweens->opacities[i];
+        if (times[i] < 0 || tween.action == nullptr)
+        {
+            continue;
+        }
+
+        tween.target->setOpacity((GLubyte)(tween.fromOpacity + tween.deltaOpacity * times[i]));
+    }
+
+    times.clear();
+    for (const auto &tween : _tweens->rotations)
+    {
+        step(tween);
+    }
+    easeTweens(_tweens->rotations, times);
+    for (size_t i = 0, count = times.size(); i < count; ++i)
+    {
+        auto &tween = _tweens->rotations[i];
+        if (times[i] < 0 || tween.action == nullptr)
+        {
+            continue;
+        }
+
+        auto target = tween.target;
+        Vec2 angle = tween.startAngle + tween.deltaAngle * times[i];
+        target->setRotationSkewX(angle.x);
+        target->setRotationSkewY(angle.y);
+    }
+
+    if (! finished.empty())
+    {
+        // like the other actions, unless something removed them in the meantime
+        std::vector<Action*> actions;
+        actions.swap(finished);
+        for (auto action : actions)
+        {
+            if (action->_tweenIndex >= 0)
+            {
+                action->stop();
+                removeAction(action);
+            }
+            action->release();
+        }
+        if (finished.empty())
+        {
+            actions.clear();
+            finished.swap(actions);
+        }
+    }
 }
 
 NS_CC_END
@@ -38,6 +38,7 @@ NS_CC_BEGIN
 class Action;
 
 struct _hashElement;
+struct _tweenArrays;
 
 /**
  * @addtogroup actions
@@ -53,6 +54,10 @@ struct _hashElement;
     - When you want to run an action where the target is different from a Node.
     - When you want to pause / resume the actions.
 
+ With CC_ENABLE_FAST_ACTIONS, the moves, scales, fades and rotations, alone or eased by a tweenfunc ease action,
+ are run as tweens: their state is copied into one contiguous array per property when they are added,
+ and each frame updates the arrays in a loop before the other actions are stepped.
+
  @since v0.8
  */
 class CC_DLL ActionManager : public Ref
@@ -153,6 +158,14 @@ public:
      */
     void resumeTarget(Node *target);
 
+    /** Resumes the target as if it had run while paused: its actions are stepped by missedTime more on the next update.
+     *
+     * @param target    A certain target.
+     * @param missedTime    The time the target missed while paused, in seconds.
+     * @since v3.11
+     */
+    void resumeTarget(Node *target, float missedTime);
+
     /** Pauses all running actions, returning a list of targets whose actions were paused.
      *
      * @return  A list of targets whose actions were paused.
@@ -170,6 +183,12 @@ public:
      */
     void update(float dt);
 
+    /** Gets the time spent in the last update(), in milliseconds, see Director::getFrameTimings(). */
+    float getLastUpdateTime() const { return _lastUpdateTime; }
+
+    /** Returns the number of actions stepped by the last update(), 0 when no action ran. */
+    unsigned int getLastStepCount() const { return _lastStepCount; }
+
 protected:
     // declared in ActionManager.m
 
@@ -177,10 +196,19 @@ protected:
     void deleteHashElement(struct _hashElement *element);
     void actionAllocWithHashElement(struct _hashElement *element);
 
+    void addTween(Action *action, struct _hashElement *element);
+    void removeTween(Action *action);
+    void updateTweens(float dt);
+    template <typename T>
+    void compactTweens(std::vector<T> &tweens);
+
 protected:
     struct _hashElement    *_targets;
     struct _hashElement    *_currentTarget;
     bool            _currentTargetSalvaged;
+    float           _lastUpdateTime;
+    unsigned int    _lastStepCount;
+    struct _tweenArrays    *_tweens;
 };
 
 // end of actions group
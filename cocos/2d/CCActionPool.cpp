@@ -0,0 +1,75 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "2d/CCActionPool.h"
+
+NS_CC_BEGIN
+
+ActionPool* ActionPool::s_pools = nullptr;
+
+ActionPool::ActionPool(const char* className, size_t objectSize)
+: _className(className)
+, _objectSize(objectSize)
+, _freeList(nullptr)
+, _freeCount(0)
+, _hits(0)
+, _misses(0)
+, _next(s_pools)
+{
+    // the pools are statics, they register themselves before main()
+    s_pools = this;
+}
+
+std::vector<ActionPool::Stats> ActionPool::getStats()
+{
+    std::vector<Stats> stats;
+    for (auto pool = s_pools; pool; pool = pool->_next)
+    {
+        Stats poolStats;
+        poolStats.className = pool->_className;
+        poolStats.objectSize = pool->_objectSize;
+        poolStats.hits = pool->_hits;
+        poolStats.misses = pool->_misses;
+        poolStats.freeCount = pool->_freeCount;
+        stats.push_back(poolStats);
+    }
+    return stats;
+}
+
+void ActionPool::purge()
+{
+    for (auto pool = s_pools; pool; pool = pool->_next)
+    {
+        while (pool->_freeList)
+        {
+            auto object = pool->_freeList;
+            pool->_freeList = object->next;
+            ::operator delete(object);
+        }
+        pool->_freeCount = 0;
+    }
+}
+
+NS_CC_END
@@ -0,0 +1,178 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __ACTION_CCACTION_POOL_H__
+#define __ACTION_CCACTION_POOL_H__
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#include "platform/CCPlatformMacros.h"
+#include "base/ccConfig.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup actions
+ * @{
+ */
+
+/** @class ActionPool
+ @brief The free list of the released objects of one action class, see CC_ACTION_POOL().
+ When the reference count of a pooled action reaches 0 its memory goes back to the free list of its class,
+ the next create() of the class takes it instead of allocating. The subclasses of a pooled class are allocated as usual.
+ Up to CC_ACTION_POOL_CAPACITY objects are kept per class.
+ Like the other Refs, the pooled actions must be created and released on the main thread.
+ @since v3.11
+ @js NA
+ @lua NA
+ */
+class CC_DLL ActionPool
+{
+public:
+    /** The counters of the pool of one action class. */
+    struct Stats
+    {
+        /** The name of the action class. */
+        const char*     className;
+        /** The size of the objects of the class, in bytes. */
+        size_t          objectSize;
+        /** The number of objects taken from the free list. */
+        unsigned int    hits;
+        /** The number of objects allocated because the free list was empty. */
+        unsigned int    misses;
+        /** The number of objects in the free list. */
+        unsigned int    freeCount;
+    };
+
+    /** Gets the counters of the pools of all the pooled action classes. */
+    static std::vector<Stats> getStats();
+
+    /** Frees the objects of the free lists, Director::purgeCachedData() calls it. */
+    static void purge();
+
+    /// @cond DO_NOT_SHOW
+    ActionPool(const char* className, size_t objectSize);
+
+    void* allocate(size_t size)
+    {
+        if (size == _objectSize && _freeList)
+        {
+            return take();
+        }
+        countMiss(size);
+        return ::operator new(size);
+    }
+
+    void* allocate(size_t size, const std::nothrow_t& nothrow)
+    {
+        if (size == _objectSize && _freeList)
+        {
+            return take();
+        }
+        countMiss(size);
+        return ::operator new(size, nothrow);
+    }
+
+    void deallocate(void* ptr, size_t size)
+    {
+        if (ptr == nullptr)
+        {
+            return;
+        }
+        if (size == _objectSize && _freeCount < CC_ACTION_POOL_CAPACITY)
+        {
+            auto object = static_cast<FreeObject*>(ptr);
+            object->next = _freeList;
+            _freeList = object;
+            _freeCount++;
+            return;
+        }
+        ::operator delete(ptr);
+    }
+    /// @endcond
+
+protected:
+    struct FreeObject
+    {
+        FreeObject* next;
+    };
+
+    void* take()
+    {
+        auto object = _freeList;
+        _freeList = object->next;
+        _freeCount--;
+        _hits++;
+        return object;
+    }
+
+    void countMiss(size_t size)
+    {
+        // the subclasses aren't pooled
+        if (size == _objectSize)
+        {
+            _misses++;
+        }
+    }
+
+    // no destructor, the actions released while the statics are destroyed can still use their pool
+    const char*     _className;
+    size_t          _objectSize;
+    FreeObject*     _freeList;
+    unsigned int    _freeCount;
+    unsigned int    _hits;
+    unsigned int    _misses;
+    ActionPool*     _next;
+
+    static ActionPool* s_pools;
+};
+
+// end of actions group
+/// @}
+
+NS_CC_END
+
+#if CC_ENABLE_ACTION_POOL
+/**
+ Pools the objects of an action class, it goes first in the class declaration.
+ CC_ACTION_POOL_DEFINE() defines the pool in the source file of the class.
+ */
+#define CC_ACTION_POOL(__TYPE__) \
+public: \
+    static void* operator new(size_t size) { return s_actionPool.allocate(size); } \
+    static void* operator new(size_t size, const std::nothrow_t& nothrow) throw() { return s_actionPool.allocate(size, nothrow); } \
+    static void operator delete(void* ptr, size_t size) { s_actionPool.deallocate(ptr, size); } \
+private: \
+    static NS_CC::ActionPool s_actionPool;
+
+#define CC_ACTION_POOL_DEFINE(__TYPE__) NS_CC::ActionPool __TYPE__::s_actionPool(#__TYPE__, sizeof(__TYPE__))
+#else
+#define CC_ACTION_POOL(__TYPE__)
+#define CC_ACTION_POOL_DEFINE(__TYPE__)
+#endif
+
+#endif // __ACTION_CCACTION_POOL_H__
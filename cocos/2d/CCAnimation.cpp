@@ -25,6 +25,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 ****************************************************************************/
 #include "2d/CCAnimation.h"
+#include "2d/CCSpriteFrameCache.h"
 #include "renderer/CCTextureCache.h"
 #include "renderer/CCTexture2D.h"
 #include "base/CCDirector.h"
@@ -95,6 +96,21 @@ Animation* Animation::createWithSpriteFrames(const Vector<SpriteFrame*>& frames,
     return animation;
 }
 
+Animation* Animation::createWithSpriteFrameHandles(const std::vector<unsigned int>& spriteFrameHandles, float delay/* = 0.0f*/, unsigned int loops/* = 1*/)
+{
+    Animation *animation = new (std::nothrow) Animation();
+    animation->init();
+    animation->setDelayPerUnit(delay);
+    animation->setLoops(loops);
+    for (auto handle : spriteFrameHandles)
+    {
+        animation->addSpriteFrameWithHandle(handle);
+    }
+    animation->autorelease();
+
+    return animation;
+}
+
 Animation* Animation::create(const Vector<AnimationFrame*>& arrayOfAnimationFrameNames, float delayPerUnit, unsigned int loops /* = 1 */)
 {
     Animation *animation = new (std::nothrow) Animation();
@@ -173,6 +189,17 @@ void Animation::addSpriteFrameWithFile(const std::string& filename)
     addSpriteFrame(frame);
 }
 
+void Animation::addSpriteFrameWithHandle(unsigned int spriteFrameHandle)
+{
+    SpriteFrame *frame = SpriteFrameCache::getInstance()->getSpriteFrameByHandle(spriteFrameHandle);
+    if (frame == nullptr)
+    {
+        CCLOG("cocos2d: Animation: sprite frame '%s' not found", SpriteFrameCache::getSpriteFrameHandleName(spriteFrameHandle).c_str());
+        return;
+    }
+    addSpriteFrame(frame);
+}
+
 void Animation::addSpriteFrameWithTexture(Texture2D *pobTexture, const Rect& rect)
 {
     SpriteFrame *frame = SpriteFrame::createWithTexture(pobTexture, rect);
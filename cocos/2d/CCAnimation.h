@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "2d/CCSpriteFrame.h"
 
 #include <string>
+#include <vector>
 
 NS_CC_BEGIN
 
@@ -180,6 +181,17 @@ public:
      */
     static Animation* createWithSpriteFrames(const Vector<SpriteFrame*>& arrayOfSpriteFrameNames, float delay = 0.0f, unsigned int loops = 1);
 
+    /* Creates an animation with the sprite frames of handles and a delay between frames in seconds, see
+     * SpriteFrameCache::getSpriteFrameHandle(). The frames are looked up once, the missing ones are left out.
+     * @since v3.11
+     * @param spriteFrameHandles The handles of the sprite frames.
+     * @param delay A delay between frames in seconds.
+     * @param loops The times the animation is going to loop.
+     * @js NA
+     * @lua NA
+     */
+    static Animation* createWithSpriteFrameHandles(const std::vector<unsigned int>& spriteFrameHandles, float delay = 0.0f, unsigned int loops = 1);
+
     /* Creates an animation with an array of AnimationFrame, the delay per units in seconds and and how many times it should be executed.
      * @since v2.0
      * @param arrayOfAnimationFrameNames An animation with an array of AnimationFrame.
@@ -194,6 +206,15 @@ public:
      */
     void addSpriteFrame(SpriteFrame *frame);
 
+    /** Adds the SpriteFrame of a handle of the SpriteFrameCache, see SpriteFrameCache::getSpriteFrameHandle().
+     *
+     * @param spriteFrameHandle The handle of the frame, it will be added with one "delay unit".
+     * @since v3.11
+     * @js NA
+     * @lua NA
+     */
+    void addSpriteFrameWithHandle(unsigned int spriteFrameHandle);
+
     /** Adds a frame with an image filename. Internally it will create a SpriteFrame and it will add it.
      * The frame will be added with one "delay unit".
      * Added to facilitate the migration from v0.8 to v0.9.
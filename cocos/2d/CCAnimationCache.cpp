@@ -67,6 +67,7 @@ AnimationCache::~AnimationCache()
 void AnimationCache::addAnimation(Animation *animation, const std::string& name)
 {
     _animations.insert(name, animation);
+    _timelines.erase(name);
 }
 
 void AnimationCache::removeAnimation(const std::string& name)
@@ -75,6 +76,7 @@ void AnimationCache::removeAnimation(const std::string& name)
         return;
 
     _animations.erase(name);
+    _timelines.erase(name);
 }
 
 Animation* AnimationCache::getAnimation(const std::string& name)
@@ -82,6 +84,24 @@ Animation* AnimationCache::getAnimation(const std::string& name)
     return _animations.at(name);
 }
 
+SpriteAnimationTimeline* AnimationCache::getTimeline(const std::string& name)
+{
+    SpriteAnimationTimeline* timeline = _timelines.at(name);
+    if (timeline == nullptr)
+    {
+        Animation* animation = _animations.at(name);
+        if (animation == nullptr)
+            return nullptr;
+
+        timeline = SpriteAnimationTimeline::create(animation);
+        if (timeline)
+        {
+            _timelines.insert(name, timeline);
+        }
+    }
+    return timeline;
+}
+
 void AnimationCache::parseVersion1(const ValueMap& animations)
 {
     SpriteFrameCache *frameCache = SpriteFrameCache::getInstance();
@@ -31,6 +31,7 @@ THE SOFTWARE.
 #include "base/CCMap.h"
 #include "base/CCValue.h"
 #include "2d/CCAnimation.h"
+#include "2d/CCSpriteAnimation.h"
 
 #include <string>
 
@@ -97,6 +98,17 @@ public:
      */
     Animation* getAnimation(const std::string& name);
 
+    /** Returns the timeline of an animation that was previously added, for Sprite::playAnimation().
+     * It's created the first time and shared by all the sprites playing the animation.
+     * Adding or removing the animation drops it, the animation must not be changed otherwise.
+     *
+     * @return The timeline of the animation. If the name is not found it will return nil.
+     * @since v3.11
+     * @js NA
+     * @lua NA
+     */
+    SpriteAnimationTimeline* getTimeline(const std::string& name);
+
     /** Adds an animation from an NSDictionary.
      * Make sure that the frames were previously loaded in the SpriteFrameCache.
      * @param dictionary An NSDictionary.
@@ -121,6 +133,7 @@ private:
 
 private:
     Map<std::string, Animation*> _animations;
+    Map<std::string, SpriteAnimationTimeline*> _timelines;
     static AnimationCache* s_sharedAnimationCache;
 };
 
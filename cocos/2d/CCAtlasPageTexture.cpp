@@ -0,0 +1,129 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "2d/CCAtlasPageTexture.h"
+
+#include "base/CCDirector.h"
+#include "base/CCEventDispatcher.h"
+#include "base/CCEventListenerCustom.h"
+#include "base/CCEventType.h"
+#include "renderer/ccGLStateCache.h"
+#include "renderer/CCTextureCache.h"
+
+NS_CC_BEGIN
+
+AtlasPageTexture::AtlasPageTexture()
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+: _rendererRecreatedListener(nullptr)
+#endif
+{
+}
+
+AtlasPageTexture::~AtlasPageTexture()
+{
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    if (_rendererRecreatedListener)
+    {
+        Director::getInstance()->getEventDispatcher()->removeEventListener(_rendererRecreatedListener);
+    }
+#endif
+}
+
+bool AtlasPageTexture::initWithPixels(const unsigned char* pixels, int width, int height, bool hasPremultipliedAlpha)
+{
+    ssize_t dataLen = width * height * 4;
+    Size size((float)width, (float)height);
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    // VolatileTextureMgr uploads this copy again when the GL context is recreated
+    _pixels.resize(dataLen);
+    if (pixels)
+    {
+        memcpy(_pixels.data(), pixels, dataLen);
+    }
+    pixels = _pixels.data();
+    VolatileTextureMgr::addDataTexture(this, _pixels.data(), (int)dataLen, PixelFormat::RGBA8888, size);
+
+    // initWithData clears the premultiplied alpha when the texture is reloaded
+    _rendererRecreatedListener = Director::getInstance()->getEventDispatcher()->addCustomEventListener(EVENT_RENDERER_RECREATED, [this, hasPremultipliedAlpha](EventCustom* /*event*/) {
+        _hasPremultipliedAlpha = hasPremultipliedAlpha;
+    });
+#else
+    std::vector<unsigned char> cleared;
+    if (nullptr == pixels)
+    {
+        cleared.resize(dataLen);
+        pixels = cleared.data();
+    }
+#endif
+    if (!initWithData(pixels, dataLen, PixelFormat::RGBA8888, width, height, size))
+    {
+        return false;
+    }
+    _hasPremultipliedAlpha = hasPremultipliedAlpha;
+    return true;
+}
+
+void AtlasPageTexture::updatePixels(const unsigned char* pixels, int x, int y, int width, int height)
+{
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    for (int row = 0; row < height; ++row)
+    {
+        memcpy(&_pixels[((y + row) * _pixelsWide + x) * 4], pixels + row * width * 4, width * 4);
+    }
+#endif
+    updateWithData(pixels, x, y, width, height);
+}
+
+void AtlasPageTexture::copyPixels(AtlasPageTexture* source, int sourceX, int sourceY, int width, int height, int x, int y)
+{
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    // the copy of the source has the pixels already
+    std::vector<unsigned char> pixels(width * height * 4);
+    for (int row = 0; row < height; ++row)
+    {
+        memcpy(&pixels[row * width * 4], &source->_pixels[((sourceY + row) * source->_pixelsWide + sourceX) * 4], width * 4);
+    }
+    updatePixels(pixels.data(), x, y, width, height);
+#else
+    // GLES2 can't read a texture, the source is attached to a framebuffer and copied from there on the GPU
+    GLint oldFramebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &oldFramebuffer);
+
+    GLuint framebuffer = 0;
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, source->getName(), 0);
+
+    GL::bindTexture2D(_name);
+    glCopyTexSubImage2D(GL_TEXTURE_2D, 0, x, y, sourceX, sourceY, width, height);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, oldFramebuffer);
+    glDeleteFramebuffers(1, &framebuffer);
+
+    CHECK_GL_ERROR_DEBUG();
+#endif
+}
+
+NS_CC_END
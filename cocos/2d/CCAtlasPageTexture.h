@@ -0,0 +1,68 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef _CCAtlasPageTexture_h_
+#define _CCAtlasPageTexture_h_
+
+/// @cond DO_NOT_SHOW
+
+#include <vector>
+#include "renderer/CCTexture2D.h"
+
+NS_CC_BEGIN
+
+class EventListenerCustom;
+
+/**
+ An RGBA8888 texture that images are packed into, see SystemFontTextureCache and DynamicAtlas.
+ With CC_ENABLE_CACHE_TEXTURE_DATA it keeps a copy of its pixels, which VolatileTextureMgr uploads again
+ when the GL context is recreated.
+ */
+class AtlasPageTexture : public Texture2D
+{
+public:
+    AtlasPageTexture();
+    virtual ~AtlasPageTexture();
+
+    /** pixels is nullptr for a cleared texture. */
+    bool initWithPixels(const unsigned char* pixels, int width, int height, bool hasPremultipliedAlpha);
+
+    /** Replaces the pixels of a rect, pixels has width * height RGBA8888 pixels. */
+    void updatePixels(const unsigned char* pixels, int x, int y, int width, int height);
+
+    /** Copies a rect of source into this texture at x, y. */
+    void copyPixels(AtlasPageTexture* source, int sourceX, int sourceY, int width, int height, int x, int y);
+
+private:
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    std::vector<unsigned char> _pixels;
+    EventListenerCustom* _rendererRecreatedListener;
+#endif
+};
+
+NS_CC_END
+
+/// @endcond
+#endif
@@ -26,7 +26,13 @@
  */
 
 #include "2d/CCClippingNode.h"
+
+#include <cfloat>
+
 #include "2d/CCDrawingPrimitives.h"
+#include "2d/CCDrawNode.h"
+#include "2d/CCLayer.h"
+#include "2d/CCSprite.h"
 #include "renderer/CCGLProgramCache.h"
 #include "renderer/ccGLStateCache.h"
 #include "renderer/CCRenderer.h"
@@ -54,9 +60,67 @@ static void setProgram(Node *n, GLProgram *p)
 }
 #endif
 
+// Returns whether the triangles fill an axis-aligned rect: all their vertices are corners of their bounds,
+// and each edge of the bounds belongs to a triangle of three distinct corners. Such a triangle covers the
+// quarters of the rect along its two edges, so the rect is filled when the four quarters are.
+template <typename VertexAt>
+static bool trianglesFillRect(int triangleCount, const VertexAt& vertexAt, Rect* rect)
+{
+    static const float EPSILON = 1e-3f;
+
+    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+    for (int i = 0; i < triangleCount * 3; ++i)
+    {
+        const Vec2 vertex = vertexAt(i);
+        minX = std::min(minX, vertex.x);
+        minY = std::min(minY, vertex.y);
+        maxX = std::max(maxX, vertex.x);
+        maxY = std::max(maxY, vertex.y);
+    }
+    if (maxX - minX <= EPSILON || maxY - minY <= EPSILON)
+    {
+        return false;
+    }
+
+    // the corners are 1 bottom left, 2 bottom right, 4 top right and 8 top left
+    unsigned int edges = 0;
+    for (int i = 0; i < triangleCount; ++i)
+    {
+        unsigned int corners = 0;
+        for (int j = 0; j < 3; ++j)
+        {
+            const Vec2 vertex = vertexAt(i * 3 + j);
+            bool left = std::abs(vertex.x - minX) <= EPSILON;
+            bool right = std::abs(vertex.x - maxX) <= EPSILON;
+            bool bottom = std::abs(vertex.y - minY) <= EPSILON;
+            bool top = std::abs(vertex.y - maxY) <= EPSILON;
+            if (!(left || right) || !(bottom || top))
+            {
+                return false;
+            }
+            corners |= bottom ? (left ? 1 : 2) : (right ? 4 : 8);
+        }
+        if (corners != 7 && corners != 11 && corners != 13 && corners != 14)
+        {
+            // degenerate
+            continue;
+        }
+        edges |= ((corners & 3) == 3 ? 1 : 0) | ((corners & 6) == 6 ? 2 : 0) |
+                 ((corners & 12) == 12 ? 4 : 0) | ((corners & 9) == 9 ? 8 : 0);
+    }
+    if (edges != 15)
+    {
+        return false;
+    }
+
+    rect->setRect(minX, minY, maxX - minX, maxY - minY);
+    return true;
+}
+
 ClippingNode::ClippingNode()
 : _stencil(nullptr)
 ,_stencilStateManager(new StencilStateManager())
+,_scissorClippingEnabled(true)
 {
 }
 
@@ -179,33 +243,44 @@ void ClippingNode::visit(Renderer *renderer, const Mat4 &parentTransform, uint32
 
     renderer->pushGroup(_groupCommand.getRenderQueueID());
 
-    _beforeVisitCmd.init(_globalZOrder);
-    _beforeVisitCmd.func = CC_CALLBACK_0(StencilStateManager::onBeforeVisit, _stencilStateManager);
-    renderer->addCommand(&_beforeVisitCmd);
-
-    auto alphaThreshold = this->getAlphaThreshold();
-    if (alphaThreshold < 1)
+    // a rectangular stencil clips with the scissor box, without drawing it
+    bool scissor = _scissorClippingEnabled && getScissorRect(&_scissorRect);
+    if (scissor)
     {
+        _beforeVisitCmd.init(_globalZOrder);
+        _beforeVisitCmd.func = CC_CALLBACK_0(ClippingNode::onBeforeVisitScissor, this);
+        renderer->addCommand(&_beforeVisitCmd);
+    }
+    else
+    {
+        _beforeVisitCmd.init(_globalZOrder);
+        _beforeVisitCmd.func = CC_CALLBACK_0(StencilStateManager::onBeforeVisit, _stencilStateManager);
+        renderer->addCommand(&_beforeVisitCmd);
+
+        auto alphaThreshold = this->getAlphaThreshold();
+        if (alphaThreshold < 1)
+        {
 #if CC_CLIPPING_NODE_OPENGLES
-        // since glAlphaTest do not exists in OES, use a shader that writes
-        // pixel only if greater than an alpha threshold
-        GLProgram *program = GLProgramCache::getInstance()->getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST_NO_MV);
-        GLint alphaValueLocation = glGetUniformLocation(program->getProgram(), GLProgram::UNIFORM_NAME_ALPHA_TEST_VALUE);
-        // set our alphaThreshold
-        program->use();
-        program->setUniformLocationWith1f(alphaValueLocation, alphaThreshold);
-        // we need to recursively apply this shader to all the nodes in the stencil node
-        // FIXME: we should have a way to apply shader to all nodes without having to do this
-        setProgram(_stencil, program);
+            // since glAlphaTest do not exists in OES, use a shader that writes
+            // pixel only if greater than an alpha threshold
+            GLProgram *program = GLProgramCache::getInstance()->getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST_NO_MV);
+            GLint alphaValueLocation = glGetUniformLocation(program->getProgram(), GLProgram::UNIFORM_NAME_ALPHA_TEST_VALUE);
+            // set our alphaThreshold
+            program->use();
+            program->setUniformLocationWith1f(alphaValueLocation, alphaThreshold);
+            // we need to recursively apply this shader to all the nodes in the stencil node
+            // FIXME: we should have a way to apply shader to all nodes without having to do this
+            setProgram(_stencil, program);
 
 #endif
 
-    }
-    _stencil->visit(renderer, _modelViewTransform, flags);
+        }
+        _stencil->visit(renderer, _modelViewTransform, flags);
 
-    _afterDrawStencilCmd.init(_globalZOrder);
-    _afterDrawStencilCmd.func = CC_CALLBACK_0(StencilStateManager::onAfterDrawStencil, _stencilStateManager);
-    renderer->addCommand(&_afterDrawStencilCmd);
+        _afterDrawStencilCmd.init(_globalZOrder);
+        _afterDrawStencilCmd.func = CC_CALLBACK_0(StencilStateManager::onAfterDrawStencil, _stencilStateManager);
+        renderer->addCommand(&_afterDrawStencilCmd);
+    }
 
     int i = 0;
 
@@ -224,6 +299,7 @@ void ClippingNode::visit(Renderer *renderer, const Mat4 &parentTransform, uint32
         }
 
         // self draw
+        Renderer::setDebugOwner(this);
         draw(renderer, _modelViewTransform, flags);
 
         for(auto it=_children.cbegin()+i; it != _children.cend(); ++it)
@@ -231,11 +307,19 @@ void ClippingNode::visit(Renderer *renderer, const Mat4 &parentTransform, uint32
     }
     else
     {
+        Renderer::setDebugOwner(this);
         draw(renderer, _modelViewTransform, flags);
     }
 
     _afterVisitCmd.init(_globalZOrder);
-    _afterVisitCmd.func = CC_CALLBACK_0(StencilStateManager::onAfterVisit, _stencilStateManager);
+    if (scissor)
+    {
+        _afterVisitCmd.func = CC_CALLBACK_0(ClippingNode::onAfterVisitScissor, this);
+    }
+    else
+    {
+        _afterVisitCmd.func = CC_CALLBACK_0(StencilStateManager::onAfterVisit, _stencilStateManager);
+    }
     renderer->addCommand(&_afterVisitCmd);
 
     renderer->popGroup();
@@ -243,6 +327,83 @@ void ClippingNode::visit(Renderer *renderer, const Mat4 &parentTransform, uint32
     _director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
 }
 
+bool ClippingNode::getScissorRect(Rect* ndcRect)
+{
+    // an inverted rect isn't a rect, the children of the stencil are drawn in the stencil buffer too
+    if (_stencil == nullptr || !_stencil->isVisible() || isInverted() || _stencil->getChildrenCount() > 0)
+    {
+        return false;
+    }
+
+    Rect rect;
+    auto alphaThreshold = getAlphaThreshold();
+    if (auto drawNode = dynamic_cast<DrawNode*>(_stencil))
+    {
+        if (alphaThreshold < 1 || drawNode->_bufferCountGLLine > 0 || drawNode->_bufferCountGLPoint > 0)
+        {
+            return false;
+        }
+        auto buffer = drawNode->_buffer;
+        auto vertexAt = [buffer](int i) { return Vec2(buffer[i].vertices.x, buffer[i].vertices.y); };
+        if (!trianglesFillRect(drawNode->_bufferCount / 3, vertexAt, &rect))
+        {
+            return false;
+        }
+    }
+    else if (auto sprite = dynamic_cast<Sprite*>(_stencil))
+    {
+        // with the alpha test, only a texture without alpha is drawn on the whole quad
+        if (alphaThreshold < 1)
+        {
+            auto texture = sprite->getTexture();
+            if (texture == nullptr || sprite->getDisplayedOpacity() / 255.0f <= alphaThreshold)
+            {
+                return false;
+            }
+            const auto& formats = Texture2D::getPixelFormatInfoMap();
+            auto format = formats.find(texture->getPixelFormat());
+            if (format == formats.end() || format->second.alpha)
+            {
+                return false;
+            }
+        }
+        const auto& triangles = sprite->getPolygonInfo().triangles;
+        auto vertexAt = [&triangles](int i) {
+            const auto& vertex = triangles.verts[triangles.indices[i]].vertices;
+            return Vec2(vertex.x, vertex.y);
+        };
+        if (!trianglesFillRect(triangles.indexCount / 3, vertexAt, &rect))
+        {
+            return false;
+        }
+    }
+    else if (dynamic_cast<LayerColor*>(_stencil))
+    {
+        rect.size = _stencil->getContentSize();
+        if (alphaThreshold < 1 || rect.size.width <= 0 || rect.size.height <= 0)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        return false;
+    }
+
+    bool axisAligned = false;
+    return Renderer::projectScissorRect(rect, _modelViewTransform * _stencil->getNodeToParentTransform(), ndcRect, &axisAligned) && axisAligned;
+}
+
+void ClippingNode::onBeforeVisitScissor()
+{
+    _director->getRenderer()->pushScissor(_scissorRect);
+}
+
+void ClippingNode::onAfterVisitScissor()
+{
+    _director->getRenderer()->popScissor();
+}
+
 Node* ClippingNode::getStencil() const
 {
     return _stencil;
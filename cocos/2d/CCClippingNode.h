@@ -44,6 +44,10 @@ class StencilStateManager;
  * It draws its content (children) clipped using a stencil.
  * The stencil is an other Node that will not be drawn.
  * The clipping is done using the alpha part of the stencil (adjusted with an alphaThreshold).
+ *
+ * When the stencil is a LayerColor, a quad Sprite or a DrawNode filling a rect, without children, and its rect stays
+ * axis-aligned on the screen, the content is clipped with the scissor box instead: no stencil buffer is needed, and the
+ * stencil isn't drawn. The nested rects are intersected. See setScissorClippingEnabled().
  */
 class CC_DLL ClippingNode : public Node
 {
@@ -115,6 +119,20 @@ public:
      */
     void setInverted(bool inverted);
 
+    /** Whether a rectangular stencil clips with the scissor box, see the class description.
+     * This default to true.
+     *
+     * @return If a rectangular stencil clips with the scissor box.
+     */
+    bool isScissorClippingEnabled() const { return _scissorClippingEnabled; }
+
+    /** Sets whether a rectangular stencil clips with the scissor box.
+     * Disable it if the stencil uses a shader that discards pixels.
+     *
+     * @param enabled Pass false to always clip with the stencil buffer.
+     */
+    void setScissorClippingEnabled(bool enabled) { _scissorClippingEnabled = enabled; }
+
     // Overrides
     /**
      * @lua NA
@@ -153,9 +171,16 @@ CC_CONSTRUCTOR_ACCESS:
     virtual bool init(Node *stencil);
 
 protected:
+    /** Returns whether the stencil is a rect that stays axis-aligned, in normalized device coordinates. */
+    bool getScissorRect(Rect* ndcRect);
+    void onBeforeVisitScissor();
+    void onAfterVisitScissor();
+
     Node* _stencil;
 
     StencilStateManager* _stencilStateManager;
+    bool _scissorClippingEnabled;
+    Rect _scissorRect;
 
     GroupCommand _groupCommand;
     CustomCommand _beforeVisitCmd;
@@ -2,6 +2,7 @@
 #include "CCClippingRectangleNode.h"
 #include "base/CCDirector.h"
 #include "renderer/CCRenderer.h"
+#include "renderer/ccGLStateCache.h"
 #include "math/Vec2.h"
 #include "CCGLView.h"
 
@@ -39,46 +40,35 @@ void ClippingRectangleNode::setClippingRegion(const Rect &clippingRegion)
 
 void ClippingRectangleNode::onBeforeVisitScissor()
 {
-    if (_clippingEnabled) {
-        glEnable(GL_SCISSOR_TEST);
-
-        float scaleX = _scaleX;
-        float scaleY = _scaleY;
-        Node *parent = this->getParent();
-        while (parent) {
-            scaleX *= parent->getScaleX();
-            scaleY *= parent->getScaleY();
-            parent = parent->getParent();
-        }
-
-        const Point pos = convertToWorldSpace(Point(_clippingRegion.origin.x, _clippingRegion.origin.y));
-        GLView* glView = _director->getOpenGLView();
-        glView->setScissorInPoints(pos.x,
-                                   pos.y,
-                                   _clippingRegion.size.width * scaleX,
-                                   _clippingRegion.size.height * scaleY);
-    }
+    _director->getRenderer()->pushScissor(_scissorRect);
 }
 
 void ClippingRectangleNode::onAfterVisitScissor()
 {
-    if (_clippingEnabled)
-    {
-        glDisable(GL_SCISSOR_TEST);
-    }
+    _director->getRenderer()->popScissor();
 }
 
 void ClippingRectangleNode::visit(Renderer *renderer, const Mat4 &parentTransform, uint32_t parentFlags)
 {
-    _beforeVisitCmdScissor.init(_globalZOrder);
-    _beforeVisitCmdScissor.func = CC_CALLBACK_0(ClippingRectangleNode::onBeforeVisitScissor, this);
-    renderer->addCommand(&_beforeVisitCmdScissor);
+    // the region is projected with the current projection, so the clipping works in a RenderTexture, and it is
+    // intersected with the scissor box of the enclosing clipping nodes
+    bool clipping = _clippingEnabled && _visible &&
+        Renderer::projectScissorRect(_clippingRegion, parentTransform * getNodeToParentTransform(), &_scissorRect);
+    if (clipping)
+    {
+        _beforeVisitCmdScissor.init(_globalZOrder);
+        _beforeVisitCmdScissor.func = CC_CALLBACK_0(ClippingRectangleNode::onBeforeVisitScissor, this);
+        renderer->addCommand(&_beforeVisitCmdScissor);
+    }
 
     Node::visit(renderer, parentTransform, parentFlags);
 
-    _afterVisitCmdScissor.init(_globalZOrder);
-    _afterVisitCmdScissor.func = CC_CALLBACK_0(ClippingRectangleNode::onAfterVisitScissor, this);
-    renderer->addCommand(&_afterVisitCmdScissor);
+    if (clipping)
+    {
+        _afterVisitCmdScissor.init(_globalZOrder);
+        _afterVisitCmdScissor.func = CC_CALLBACK_0(ClippingRectangleNode::onAfterVisitScissor, this);
+        renderer->addCommand(&_afterVisitCmdScissor);
+    }
 }
 
 NS_CC_END
@@ -103,6 +103,8 @@ protected:
 
     Rect _clippingRegion;
     bool _clippingEnabled;
+    // the clipping region in normalized device coordinates
+    Rect _scissorRect;
 
     CustomCommand _beforeVisitCmdScissor;
     CustomCommand _afterVisitCmdScissor;
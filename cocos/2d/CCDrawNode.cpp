@@ -102,6 +102,42 @@ static inline Tex2F __t(const Vec2 &v)
     return *(Tex2F*)&v;
 }
 
+// the vertices are only appended until clear(), so only the ones appended since the last upload are uploaded,
+// unless the buffer grew
+static void uploadBuffer(GLuint vbo, const V2F_C4B_T2F *buffer, int capacity, GLsizei count, int *vboCapacity, GLsizei *vboCount)
+{
+    GL::bindBuffer(GL_ARRAY_BUFFER, vbo);
+    if (*vboCapacity != capacity)
+    {
+        GL::bufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*capacity, nullptr, GL_DYNAMIC_DRAW);
+        *vboCapacity = capacity;
+        *vboCount = 0;
+    }
+    if (count > *vboCount)
+    {
+        glBufferSubData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*(*vboCount), sizeof(V2F_C4B_T2F)*(count - *vboCount), buffer + *vboCount);
+    }
+    *vboCount = count;
+}
+
+// the vertices of a batched TrianglesCommand, a multiple of 3 that fits the indices
+static const GLsizei BATCH_COMMAND_VERTICES = 65535;
+
+static unsigned short* batchIndices()
+{
+    // every command draws its vertices in order
+    static std::vector<unsigned short> indices;
+    if (indices.empty())
+    {
+        indices.resize(BATCH_COMMAND_VERTICES);
+        for (GLsizei i = 0; i < BATCH_COMMAND_VERTICES; ++i)
+        {
+            indices[i] = (unsigned short)i;
+        }
+    }
+    return indices.data();
+}
+
 // implementation of DrawNode
 
 DrawNode::DrawNode(int lineWidth)
@@ -125,8 +161,17 @@ DrawNode::DrawNode(int lineWidth)
 , _dirtyGLLine(false)
 , _lineWidth(lineWidth)
 , _defaultLineWidth(lineWidth)
+, _vboCapacity(0)
+, _vboCount(0)
+, _vboCapacityGLPoint(0)
+, _vboCountGLPoint(0)
+, _vboCapacityGLLine(0)
+, _vboCountGLLine(0)
+, _batchingEnabled(false)
 {
     _blendFunc = BlendFunc::ALPHA_PREMULTIPLIED;
+    // the primitives aren't bounded by the content size
+    _isCullingEnabled = false;
 }
 
 DrawNode::~DrawNode()
@@ -138,9 +183,9 @@ DrawNode::~DrawNode()
     free(_bufferGLLine);
     _bufferGLLine = nullptr;
 
-    glDeleteBuffers(1, &_vbo);
-    glDeleteBuffers(1, &_vboGLLine);
-    glDeleteBuffers(1, &_vboGLPoint);
+    GL::deleteBuffers(1, &_vbo);
+    GL::deleteBuffers(1, &_vboGLLine);
+    GL::deleteBuffers(1, &_vboGLPoint);
     _vbo = 0;
     _vboGLPoint = 0;
     _vboGLLine = 0;
@@ -148,9 +193,9 @@ DrawNode::~DrawNode()
     if (Configuration::getInstance()->supportsShareableVAO())
     {
         GL::bindVAO(0);
-        glDeleteVertexArrays(1, &_vao);
-        glDeleteVertexArrays(1, &_vaoGLLine);
-        glDeleteVertexArrays(1, &_vaoGLPoint);
+        GL::deleteVAO(_vao);
+        GL::deleteVAO(_vaoGLLine);
+        GL::deleteVAO(_vaoGLPoint);
         _vao = _vaoGLLine = _vaoGLPoint = 0;
     }
 }
@@ -218,71 +263,78 @@ bool DrawNode::init()
         glGenVertexArrays(1, &_vao);
         GL::bindVAO(_vao);
         glGenBuffers(1, &_vbo);
-        glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)* _bufferCapacity, _buffer, GL_STREAM_DRAW);
+        GL::bindBuffer(GL_ARRAY_BUFFER, _vbo);
+        GL::bufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)* _bufferCapacity, _buffer, GL_STREAM_DRAW);
         // vertex
         glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_POSITION);
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, vertices));
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, vertices));
         // color
         glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_COLOR);
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, colors));
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, colors));
         // texcood
         glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_TEX_COORD);
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, texCoords));
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, texCoords));
 
         glGenVertexArrays(1, &_vaoGLLine);
         GL::bindVAO(_vaoGLLine);
         glGenBuffers(1, &_vboGLLine);
-        glBindBuffer(GL_ARRAY_BUFFER, _vboGLLine);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacityGLLine, _bufferGLLine, GL_STREAM_DRAW);
+        GL::bindBuffer(GL_ARRAY_BUFFER, _vboGLLine);
+        GL::bufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacityGLLine, _bufferGLLine, GL_STREAM_DRAW);
         // vertex
         glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_POSITION);
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, vertices));
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, vertices));
         // color
         glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_COLOR);
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, colors));
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, colors));
         // texcood
         glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_TEX_COORD);
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, texCoords));
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, texCoords));
 
         glGenVertexArrays(1, &_vaoGLPoint);
         GL::bindVAO(_vaoGLPoint);
         glGenBuffers(1, &_vboGLPoint);
-        glBindBuffer(GL_ARRAY_BUFFER, _vboGLPoint);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacityGLPoint, _bufferGLPoint, GL_STREAM_DRAW);
+        GL::bindBuffer(GL_ARRAY_BUFFER, _vboGLPoint);
+        GL::bufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacityGLPoint, _bufferGLPoint, GL_STREAM_DRAW);
         // vertex
         glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_POSITION);
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, vertices));
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, vertices));
         // color
         glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_COLOR);
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, colors));
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, colors));
         // Texture coord as pointsize
         glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_TEX_COORD);
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, texCoords));
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, texCoords));
 
         GL::bindVAO(0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        GL::bindBuffer(GL_ARRAY_BUFFER, 0);
 
     }
     else
     {
         glGenBuffers(1, &_vbo);
-        glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)* _bufferCapacity, _buffer, GL_STREAM_DRAW);
+        GL::bindBuffer(GL_ARRAY_BUFFER, _vbo);
+        GL::bufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)* _bufferCapacity, _buffer, GL_STREAM_DRAW);
 
         glGenBuffers(1, &_vboGLLine);
-        glBindBuffer(GL_ARRAY_BUFFER, _vboGLLine);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacityGLLine, _bufferGLLine, GL_STREAM_DRAW);
+        GL::bindBuffer(GL_ARRAY_BUFFER, _vboGLLine);
+        GL::bufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacityGLLine, _bufferGLLine, GL_STREAM_DRAW);
 
         glGenBuffers(1, &_vboGLPoint);
-        glBindBuffer(GL_ARRAY_BUFFER, _vboGLPoint);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacityGLPoint, _bufferGLPoint, GL_STREAM_DRAW);
+        GL::bindBuffer(GL_ARRAY_BUFFER, _vboGLPoint);
+        GL::bufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacityGLPoint, _bufferGLPoint, GL_STREAM_DRAW);
 
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        GL::bindBuffer(GL_ARRAY_BUFFER, 0);
     }
 
     CHECK_GL_ERROR_DEBUG();
 
+    _vboCapacity = _bufferCapacity;
+    _vboCount = _bufferCount;
+    _vboCapacityGLLine = _bufferCapacityGLLine;
+    _vboCountGLLine = _bufferCountGLLine;
+    _vboCapacityGLPoint = _bufferCapacityGLPoint;
+    _vboCountGLPoint = _bufferCountGLPoint;
+
     _dirty = true;
     _dirtyGLLine = true;
     _dirtyGLPoint = true;
@@ -304,9 +356,16 @@ void DrawNode::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
 {
     if(_bufferCount)
     {
-        _customCommand.init(_globalZOrder, transform, flags);
-        _customCommand.func = CC_CALLBACK_0(DrawNode::onDraw, this, transform, flags);
-        renderer->addCommand(&_customCommand);
+        if (_batchingEnabled && getGLProgram() == GLProgramCache::getInstance()->getGLProgram(GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR))
+        {
+            drawBatched(renderer, transform, flags);
+        }
+        else
+        {
+            _customCommand.init(_globalZOrder, transform, flags);
+            _customCommand.func = CC_CALLBACK_0(DrawNode::onDraw, this, transform, flags);
+            renderer->addCommand(&_customCommand);
+        }
     }
 
     if(_bufferCountGLPoint)
@@ -324,6 +383,39 @@ void DrawNode::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
     }
 }
 
+void DrawNode::drawBatched(Renderer *renderer, const Mat4 &transform, uint32_t flags)
+{
+    // converts the triangles appended since the last frame
+    _batchVerts.reserve(_bufferCapacity);
+    for (GLsizei i = (GLsizei)_batchVerts.size(); i < _bufferCount; ++i)
+    {
+        const V2F_C4B_T2F& vertex = _buffer[i];
+        V3F_C4B_T2F batchVertex = {Vec3(vertex.vertices.x, vertex.vertices.y, 0), vertex.colors, vertex.texCoords};
+        _batchVerts.push_back(batchVertex);
+    }
+
+    auto glProgramState = GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR_NO_MVP);
+    size_t commandCount = (_bufferCount + BATCH_COMMAND_VERTICES - 1) / BATCH_COMMAND_VERTICES;
+    if (_batchCommands.size() < commandCount)
+    {
+        _batchCommands.resize(commandCount);
+    }
+
+    for (size_t i = 0; i < commandCount; ++i)
+    {
+        GLsizei first = (GLsizei)i * BATCH_COMMAND_VERTICES;
+        GLsizei count = std::min(_bufferCount - first, BATCH_COMMAND_VERTICES);
+
+        TrianglesCommand::Triangles triangles;
+        triangles.verts = &_batchVerts[first];
+        triangles.vertCount = count;
+        triangles.indices = batchIndices();
+        triangles.indexCount = count;
+        _batchCommands[i].init(_globalZOrder, 0, glProgramState, _blendFunc, triangles, transform, flags);
+        renderer->addCommand(&_batchCommands[i]);
+    }
+}
+
 void DrawNode::onDraw(const Mat4 &transform, uint32_t flags)
 {
     auto glProgram = getGLProgram();
@@ -334,9 +426,7 @@ void DrawNode::onDraw(const Mat4 &transform, uint32_t flags)
 
     if (_dirty)
     {
-        glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacity, _buffer, GL_STREAM_DRAW);
-
+        uploadBuffer(_vbo, _buffer, _bufferCapacity, _bufferCount, &_vboCapacity, &_vboCount);
         _dirty = false;
     }
     if (Configuration::getInstance()->supportsShareableVAO())
@@ -347,17 +437,17 @@ void DrawNode::onDraw(const Mat4 &transform, uint32_t flags)
     {
         GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX);
 
-        glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+        GL::bindBuffer(GL_ARRAY_BUFFER, _vbo);
         // vertex
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, vertices));
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, vertices));
         // color
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, colors));
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, colors));
         // texcood
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, texCoords));
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, texCoords));
     }
 
     glDrawArrays(GL_TRIANGLES, 0, _bufferCount);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
 
     if (Configuration::getInstance()->supportsShareableVAO())
     {
@@ -378,8 +468,7 @@ void DrawNode::onDrawGLLine(const Mat4 &transform, uint32_t flags)
 
     if (_dirtyGLLine)
     {
-        glBindBuffer(GL_ARRAY_BUFFER, _vboGLLine);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacityGLLine, _bufferGLLine, GL_STREAM_DRAW);
+        uploadBuffer(_vboGLLine, _bufferGLLine, _bufferCapacityGLLine, _bufferCountGLLine, &_vboCapacityGLLine, &_vboCountGLLine);
         _dirtyGLLine = false;
     }
     if (Configuration::getInstance()->supportsShareableVAO())
@@ -388,14 +477,14 @@ void DrawNode::onDrawGLLine(const Mat4 &transform, uint32_t flags)
     }
     else
     {
-        glBindBuffer(GL_ARRAY_BUFFER, _vboGLLine);
+        GL::bindBuffer(GL_ARRAY_BUFFER, _vboGLLine);
         GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX);
         // vertex
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, vertices));
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, vertices));
         // color
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, colors));
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, colors));
         // texcood
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, texCoords));
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, texCoords));
     }
     glLineWidth(_lineWidth);
     glDrawArrays(GL_LINES, 0, _bufferCountGLLine);
@@ -405,7 +494,7 @@ void DrawNode::onDrawGLLine(const Mat4 &transform, uint32_t flags)
         GL::bindVAO(0);
     }
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
 
     CC_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(1,_bufferCountGLLine);
     CHECK_GL_ERROR_DEBUG();
@@ -421,9 +510,7 @@ void DrawNode::onDrawGLPoint(const Mat4 &transform, uint32_t flags)
 
     if (_dirtyGLPoint)
     {
-        glBindBuffer(GL_ARRAY_BUFFER, _vboGLPoint);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacityGLPoint, _bufferGLPoint, GL_STREAM_DRAW);
-
+        uploadBuffer(_vboGLPoint, _bufferGLPoint, _bufferCapacityGLPoint, _bufferCountGLPoint, &_vboCapacityGLPoint, &_vboCountGLPoint);
         _dirtyGLPoint = false;
     }
 
@@ -433,11 +520,11 @@ void DrawNode::onDrawGLPoint(const Mat4 &transform, uint32_t flags)
     }
     else
     {
-        glBindBuffer(GL_ARRAY_BUFFER, _vboGLPoint);
+        GL::bindBuffer(GL_ARRAY_BUFFER, _vboGLPoint);
         GL::enableVertexAttribs( GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX);
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, vertices));
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, colors));
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, texCoords));
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, vertices));
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, colors));
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, texCoords));
     }
 
     glDrawArrays(GL_POINTS, 0, _bufferCountGLPoint);
@@ -447,7 +534,7 @@ void DrawNode::onDrawGLPoint(const Mat4 &transform, uint32_t flags)
         GL::bindVAO(0);
     }
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
 
     CC_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(1,_bufferCountGLPoint);
     CHECK_GL_ERROR_DEBUG();
@@ -463,6 +550,7 @@ void DrawNode::drawPoint(const Vec2& position, const float pointSize, const Colo
 
     _bufferCountGLPoint += 1;
     _dirtyGLPoint = true;
+    invalidateCachedTexture();
 }
 
 void DrawNode::drawPoints(const Vec2 *position, unsigned int numberOfPoints, const Color4F &color)
@@ -484,6 +572,7 @@ void DrawNode::drawPoints(const Vec2 *position, unsigned int numberOfPoints, con
 
     _bufferCountGLPoint += numberOfPoints;
     _dirtyGLPoint = true;
+    invalidateCachedTexture();
 }
 
 void DrawNode::drawLine(const Vec2 &origin, const Vec2 &destination, const Color4F &color)
@@ -500,6 +589,7 @@ void DrawNode::drawLine(const Vec2 &origin, const Vec2 &destination, const Color
 
     _bufferCountGLLine += 2;
     _dirtyGLLine = true;
+    invalidateCachedTexture();
 }
 
 void DrawNode::drawRect(const Vec2 &origin, const Vec2 &destination, const Color4F &color)
@@ -685,6 +775,7 @@ void DrawNode::drawDot(const Vec2 &pos, float radius, const Color4F &color)
     _bufferCount += vertex_count;
 
     _dirty = true;
+    invalidateCachedTexture();
 }
 
 void DrawNode::drawRect(const Vec2 &p1, const Vec2 &p2, const Vec2 &p3, const Vec2& p4, const Color4F &color)
@@ -766,6 +857,7 @@ void DrawNode::drawSegment(const Vec2 &from, const Vec2 &to, float radius, const
     _bufferCount += vertex_count;
 
     _dirty = true;
+    invalidateCachedTexture();
 }
 
 void DrawNode::drawPolygon(const Vec2 *verts, int count, const Color4F &fillColor, float borderWidth, const Color4F &borderColor)
@@ -852,6 +944,7 @@ void DrawNode::drawPolygon(const Vec2 *verts, int count, const Color4F &fillColo
     _bufferCount += vertex_count;
 
     _dirty = true;
+    invalidateCachedTexture();
 }
 
 void DrawNode::drawSolidRect(const Vec2 &origin, const Vec2 &destination, const Color4F &color)
@@ -915,16 +1008,23 @@ void DrawNode::drawTriangle(const Vec2 &p1, const Vec2 &p2, const Vec2 &p3, cons
 
     _bufferCount += vertex_count;
     _dirty = true;
+    invalidateCachedTexture();
 }
 
 void DrawNode::clear()
 {
+    // the GPU buffers are kept, the next vertices are uploaded over the previous ones
     _bufferCount = 0;
+    _vboCount = 0;
     _dirty = true;
     _bufferCountGLLine = 0;
+    _vboCountGLLine = 0;
     _dirtyGLLine = true;
     _bufferCountGLPoint = 0;
+    _vboCountGLPoint = 0;
     _dirtyGLPoint = true;
+    _batchVerts.clear();
+    invalidateCachedTexture();
     _lineWidth = _defaultLineWidth;
 }
 
@@ -938,6 +1038,16 @@ void DrawNode::setBlendFunc(const BlendFunc &blendFunc)
     _blendFunc = blendFunc;
 }
 
+void DrawNode::setBatchingEnabled(bool enabled)
+{
+    _batchingEnabled = enabled;
+    if (!enabled)
+    {
+        _batchVerts.clear();
+        _batchVerts.shrink_to_fit();
+    }
+}
+
 void DrawNode::setLineWidth(int lineWidth)
 {
     _lineWidth = lineWidth;
@@ -34,6 +34,7 @@
 #include "2d/CCNode.h"
 #include "base/ccTypes.h"
 #include "renderer/CCCustomCommand.h"
+#include "renderer/CCTrianglesCommand.h"
 #include "math/CCMath.h"
 
 NS_CC_BEGIN
@@ -307,15 +308,27 @@ public:
     // Get CocosStudio guide lines width.
     float getLineWidth();
 
+    /** Draws the triangles in the TrianglesCommand batches of the renderer rather than with a CustomCommand of their
+     * own, so that the DrawNodes drawn one after the other take one draw call. The renderer transforms the vertices
+     * every frame, it suits many small DrawNodes better than a big static one. The lines and the points are still
+     * drawn on their own, and a custom GLProgramState disables it. Disabled by default.
+     */
+    void setBatchingEnabled(bool enabled);
+    bool isBatchingEnabled() const { return _batchingEnabled; }
+
 CC_CONSTRUCTOR_ACCESS:
     DrawNode(int lineWidth = DEFAULT_LINE_WIDTH);
     virtual ~DrawNode();
     virtual bool init() override;
 
 protected:
+    // reads the triangles to clip with the scissor when they fill a rect
+    friend class ClippingNode;
+
     void ensureCapacity(int count);
     void ensureCapacityGLPoint(int count);
     void ensureCapacityGLLine(int count);
+    void drawBatched(Renderer *renderer, const Mat4 &transform, uint32_t flags);
 
     GLuint      _vao;
     GLuint      _vbo;
@@ -350,6 +363,19 @@ protected:
     int         _lineWidth;
 
     int  _defaultLineWidth;
+
+    // the sizes of the GPU buffers and the vertices uploaded, only the ones appended since are uploaded
+    int         _vboCapacity;
+    GLsizei     _vboCount;
+    int         _vboCapacityGLPoint;
+    GLsizei     _vboCountGLPoint;
+    int         _vboCapacityGLLine;
+    GLsizei     _vboCountGLLine;
+
+    bool        _batchingEnabled;
+    // the triangles in the vertex format of the renderer, converted as they are appended
+    std::vector<V3F_C4B_T2F> _batchVerts;
+    std::vector<TrianglesCommand> _batchCommands;
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(DrawNode);
 };
@@ -0,0 +1,408 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "2d/CCDynamicAtlas.h"
+
+#include <algorithm>
+#include "2d/CCAtlasPageTexture.h"
+#include "2d/CCSpriteFrame.h"
+#include "base/CCDirector.h"
+#include "platform/CCFileUtils.h"
+#include "platform/CCImage.h"
+#include "renderer/CCTextureCache.h"
+
+NS_CC_BEGIN
+
+namespace {
+
+const int PAGE_SIZE = CC_DYNAMIC_ATLAS_PAGE_SIZE;
+// left between the images of a page, the linear filtering would pick the neighbours up
+const int PADDING = 2;
+
+}
+
+std::unordered_map<std::string, DynamicAtlas::Entry> DynamicAtlas::_entries;
+std::vector<DynamicAtlas::Page> DynamicAtlas::_pages;
+int DynamicAtlas::_maxImageSize = CC_DYNAMIC_ATLAS_PAGE_SIZE / 4;
+
+SpriteFrame* DynamicAtlas::addImage(const std::string& filename)
+{
+    std::string fullpath = FileUtils::getInstance()->fullPathForTextureFilename(filename);
+    if (fullpath.empty())
+    {
+        return nullptr;
+    }
+
+    auto it = _entries.find(fullpath);
+    if (it != _entries.end())
+    {
+        it->second.lastUsedFrame = Director::DirectorInstance->getTotalFrames();
+        return it->second.frame;
+    }
+
+    SpriteFrame* frame = nullptr;
+    Image* image = new (std::nothrow) Image();
+    if (image && image->initWithImageFile(fullpath))
+    {
+        frame = addImage(image, fullpath);
+    }
+    else
+    {
+        CCLOG("cocos2d: DynamicAtlas: can not load %s", filename.c_str());
+    }
+    CC_SAFE_RELEASE(image);
+    return frame;
+}
+
+SpriteFrame* DynamicAtlas::addImage(Image* image, const std::string& key)
+{
+    const unsigned int frame = Director::DirectorInstance->getTotalFrames();
+    auto it = _entries.find(key);
+    if (it != _entries.end())
+    {
+        it->second.lastUsedFrame = frame;
+        return it->second.frame;
+    }
+
+    Entry entry = { nullptr, nullptr, 0, 0, image->getWidth(), image->getHeight(), frame };
+    auto format = image->getRenderFormat();
+    if (entry.width <= _maxImageSize && entry.height <= _maxImageSize
+        && (format == Texture2D::PixelFormat::RGBA8888 || format == Texture2D::PixelFormat::RGB888))
+    {
+        entry.frame = pack(image, entry);
+    }
+
+    if (nullptr == entry.frame)
+    {
+        auto texture = Director::DirectorInstance->getTextureCache()->addImage(image, key);
+        if (nullptr == texture)
+        {
+            return nullptr;
+        }
+        entry.frame = SpriteFrame::createWithTexture(texture, Rect(Vec2::ZERO, texture->getContentSize()));
+    }
+
+    entry.frame->retain();
+    _entries[key] = entry;
+    return entry.frame;
+}
+
+SpriteFrame* DynamicAtlas::pack(Image* image, Entry& entry)
+{
+    const unsigned char* pixels = image->getData();
+    bool hasPremultipliedAlpha = image->hasPremultipliedAlpha();
+
+    std::vector<unsigned char> rgba;
+    if (image->getRenderFormat() == Texture2D::PixelFormat::RGB888)
+    {
+        rgba.resize(entry.width * entry.height * 4);
+        for (int i = 0; i < entry.width * entry.height; ++i)
+        {
+            rgba[i * 4] = pixels[i * 3];
+            rgba[i * 4 + 1] = pixels[i * 3 + 1];
+            rgba[i * 4 + 2] = pixels[i * 3 + 2];
+            rgba[i * 4 + 3] = 255;
+        }
+        pixels = rgba.data();
+        // opaque, the same either way, it goes with the premultiplied images of the decoded png files
+        hasPremultipliedAlpha = true;
+    }
+
+    int x = 0;
+    int y = 0;
+    Page* page = allocate(entry.width, entry.height, hasPremultipliedAlpha, _pages.size() < CC_DYNAMIC_ATLAS_MAX_PAGES, x, y);
+    if (nullptr == page && removeUnusedImages(entry.lastUsedFrame) > 0)
+    {
+        defragment();
+        page = allocate(entry.width, entry.height, hasPremultipliedAlpha, _pages.size() < CC_DYNAMIC_ATLAS_MAX_PAGES, x, y);
+    }
+    if (nullptr == page)
+    {
+        return nullptr;
+    }
+
+    page->texture->updatePixels(pixels, x, y, entry.width, entry.height);
+    page->usedArea += (entry.width + PADDING) * (entry.height + PADDING);
+    entry.page = page->texture;
+    entry.x = x;
+    entry.y = y;
+    return SpriteFrame::createWithTexture(page->texture, CC_RECT_PIXELS_TO_POINTS(Rect((float)x, (float)y, (float)entry.width, (float)entry.height)));
+}
+
+DynamicAtlas::Page* DynamicAtlas::allocate(int width, int height, bool hasPremultipliedAlpha, bool canCreatePage, int& x, int& y)
+{
+    for (auto& page : _pages)
+    {
+        if (page.hasPremultipliedAlpha == hasPremultipliedAlpha && insert(page, width, height, x, y))
+        {
+            return &page;
+        }
+    }
+
+    if (!canCreatePage)
+    {
+        return nullptr;
+    }
+
+    auto texture = new (std::nothrow) AtlasPageTexture();
+    if (nullptr == texture || !texture->initWithPixels(nullptr, PAGE_SIZE, PAGE_SIZE, hasPremultipliedAlpha))
+    {
+        CC_SAFE_RELEASE(texture);
+        return nullptr;
+    }
+
+    Page page;
+    page.texture = texture;
+    page.hasPremultipliedAlpha = hasPremultipliedAlpha;
+    page.skyline.push_back({ 0, 0, PAGE_SIZE });
+    page.usedArea = 0;
+    _pages.push_back(page);
+    insert(_pages.back(), width, height, x, y);
+    return &_pages.back();
+}
+
+bool DynamicAtlas::insert(Page& page, int width, int height, int& x, int& y)
+{
+    width += PADDING;
+    height += PADDING;
+
+    // the lowest top, then the narrowest node, the bottom left rule
+    auto& skyline = page.skyline;
+    size_t bestIndex = skyline.size();
+    int bestTop = PAGE_SIZE + 1;
+    int bestWidth = PAGE_SIZE + 1;
+    for (size_t i = 0; i < skyline.size() && skyline[i].x + width <= PAGE_SIZE + PADDING; ++i)
+    {
+        // the image rests on the highest of the nodes under it
+        int top = 0;
+        int covered = 0;
+        for (size_t j = i; j < skyline.size() && covered < width; ++j)
+        {
+            top = std::max(top, skyline[j].y);
+            covered += skyline[j].width;
+        }
+        if (top + height > PAGE_SIZE + PADDING)
+        {
+            continue;
+        }
+        if (top + height < bestTop || (top + height == bestTop && skyline[i].width < bestWidth))
+        {
+            bestIndex = i;
+            bestTop = top + height;
+            bestWidth = skyline[i].width;
+        }
+    }
+    if (bestIndex == skyline.size())
+    {
+        return false;
+    }
+
+    x = skyline[bestIndex].x;
+    y = bestTop - height;
+
+    // the new node covers the ones under the image
+    SkylineNode node = { x, bestTop, width };
+    skyline.insert(skyline.begin() + bestIndex, node);
+    const int right = x + width;
+    for (size_t i = bestIndex + 1; i < skyline.size() && skyline[i].x < right;)
+    {
+        if (skyline[i].x + skyline[i].width <= right)
+        {
+            skyline.erase(skyline.begin() + i);
+        }
+        else
+        {
+            skyline[i].width -= right - skyline[i].x;
+            skyline[i].x = right;
+            break;
+        }
+    }
+
+    for (size_t i = 0; i + 1 < skyline.size();)
+    {
+        if (skyline[i].y == skyline[i + 1].y)
+        {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+    return true;
+}
+
+SpriteFrame* DynamicAtlas::getSpriteFrame(const std::string& key)
+{
+    auto it = _entries.find(key);
+    if (it == _entries.end())
+    {
+        // an image file is named after its full path
+        it = _entries.find(FileUtils::getInstance()->fullPathForTextureFilename(key));
+    }
+    if (it == _entries.end())
+    {
+        return nullptr;
+    }
+    it->second.lastUsedFrame = Director::DirectorInstance->getTotalFrames();
+    return it->second.frame;
+}
+
+void DynamicAtlas::removeImage(const std::string& key)
+{
+    auto it = _entries.find(key);
+    if (it == _entries.end())
+    {
+        it = _entries.find(FileUtils::getInstance()->fullPathForTextureFilename(key));
+    }
+    if (it != _entries.end())
+    {
+        removeEntry(it->second);
+        _entries.erase(it);
+    }
+}
+
+size_t DynamicAtlas::removeUnusedImages()
+{
+    return removeUnusedImages(Director::DirectorInstance->getTotalFrames() + 1);
+}
+
+size_t DynamicAtlas::removeUnusedImages(unsigned int frame)
+{
+    size_t count = 0;
+    for (auto it = _entries.begin(); it != _entries.end();)
+    {
+        if (it->second.frame->getReferenceCount() == 1 && it->second.lastUsedFrame < frame)
+        {
+            removeEntry(it->second);
+            it = _entries.erase(it);
+            ++count;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    return count;
+}
+
+void DynamicAtlas::removeEntry(Entry& entry)
+{
+    if (entry.page)
+    {
+        auto page = std::find_if(_pages.begin(), _pages.end(), [&entry](const Page& p) { return p.texture == entry.page; });
+        if (page != _pages.end())
+        {
+            page->usedArea -= (entry.width + PADDING) * (entry.height + PADDING);
+            if (page->usedArea <= 0)
+            {
+                // the sprites still showing the page keep it
+                page->texture->release();
+                _pages.erase(page);
+            }
+        }
+    }
+    entry.frame->release();
+}
+
+void DynamicAtlas::defragment()
+{
+    std::vector<Entry*> packed;
+    for (auto& entry : _entries)
+    {
+        if (entry.second.page)
+        {
+            packed.push_back(&entry.second);
+        }
+    }
+    std::sort(packed.begin(), packed.end(), [](const Entry* a, const Entry* b) {
+        return a->height != b->height ? a->height > b->height : a->width > b->width;
+    });
+
+    std::vector<Page> oldPages;
+    oldPages.swap(_pages);
+    for (auto entry : packed)
+    {
+        auto oldPage = std::find_if(oldPages.begin(), oldPages.end(), [entry](const Page& p) { return p.texture == entry->page; });
+
+        // packed tallest first, they take fewer pages than they did
+        int x = 0;
+        int y = 0;
+        Page* page = allocate(entry->width, entry->height, oldPage->hasPremultipliedAlpha, true, x, y);
+        if (nullptr == page)
+        {
+            // out of memory, the image stays in its page, which takes no other image
+            auto keptPage = std::find_if(_pages.begin(), _pages.end(), [entry](const Page& p) { return p.texture == entry->page; });
+            if (keptPage == _pages.end())
+            {
+                Page kept = *oldPage;
+                kept.skyline.assign(1, SkylineNode{ 0, PAGE_SIZE, PAGE_SIZE });
+                kept.usedArea = 0;
+                kept.texture->retain();
+                _pages.push_back(kept);
+                keptPage = _pages.end() - 1;
+            }
+            keptPage->usedArea += (entry->width + PADDING) * (entry->height + PADDING);
+            continue;
+        }
+
+        page->texture->copyPixels(entry->page, entry->x, entry->y, entry->width, entry->height, x, y);
+        page->usedArea += (entry->width + PADDING) * (entry->height + PADDING);
+        entry->frame->setTexture(page->texture);
+        entry->frame->setRectInPixels(Rect((float)x, (float)y, (float)entry->width, (float)entry->height));
+        entry->page = page->texture;
+        entry->x = x;
+        entry->y = y;
+    }
+
+    // the sprites still showing the old pages keep them
+    for (auto& page : oldPages)
+    {
+        page.texture->release();
+    }
+}
+
+void DynamicAtlas::purge()
+{
+    for (auto& entry : _entries)
+    {
+        entry.second.frame->release();
+    }
+    _entries.clear();
+
+    for (auto& page : _pages)
+    {
+        page.texture->release();
+    }
+    _pages.clear();
+}
+
+void DynamicAtlas::setMaxImageSize(int size)
+{
+    _maxImageSize = std::min(size, PAGE_SIZE - PADDING);
+}
+
+NS_CC_END
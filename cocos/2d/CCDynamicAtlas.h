@@ -0,0 +1,143 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef _CCDynamicAtlas_h_
+#define _CCDynamicAtlas_h_
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+
+class AtlasPageTexture;
+class Image;
+class SpriteFrame;
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/**
+ DynamicAtlas packs the small images loaded at runtime, e.g. avatars, icons or downloaded images, into shared
+ atlas pages of CC_DYNAMIC_ATLAS_PAGE_SIZE pixels, so the sprites showing them are batched together instead of
+ each drawing its own texture. The images larger than getMaxImageSize(), or of a pixel format other than RGBA8888
+ and RGB888, get a texture of their own from the TextureCache.
+
+ The images are packed with a skyline, at most CC_DYNAMIC_ATLAS_MAX_PAGES pages are created.
+ When they are full, the images no sprite uses any more are removed and the pages are defragmented.
+ The space of a removed image is reused once defragment() packs the pages again.
+ @since v3.11
+ */
+class CC_DLL DynamicAtlas
+{
+public:
+    /** Returns the frame of an image file, packing it when it isn't in the atlas yet. nullptr if it can't be loaded.
+     The atlas retains the frame until the image is removed, the sprites showing it retain it too.
+     */
+    static SpriteFrame* addImage(const std::string& filename);
+
+    /** Returns the frame of image, named key, packing it when there is no image of that name yet. */
+    static SpriteFrame* addImage(Image* image, const std::string& key);
+
+    /** Returns the frame of an image file or key added before, nullptr if there is none. */
+    static SpriteFrame* getSpriteFrame(const std::string& key);
+
+    /** Removes an image file or key, the sprites showing it keep its frame. */
+    static void removeImage(const std::string& key);
+
+    /** Removes the images whose frame is only retained by the atlas, returns how many were removed.
+     The pages left without an image are released. When the pages are full, the atlas does it for the images
+     not returned in the current frame.
+     */
+    static size_t removeUnusedImages();
+
+    /**
+     Packs the images into new pages, the tallest first, which reclaims the space of the removed images.
+     Their frames move to the new pages. The sprites showing them keep drawing the old pages, which they retain,
+     until their frame is set again, so it is best called between scenes.
+     */
+    static void defragment();
+
+    /** Removes all the images and the pages. */
+    static void purge();
+
+    /** Sets the width and height in pixels of the largest images packed, CC_DYNAMIC_ATLAS_PAGE_SIZE / 4 by default. */
+    static void setMaxImageSize(int size);
+    static int getMaxImageSize() { return _maxImageSize; }
+
+    static size_t getImageCount() { return _entries.size(); }
+    static size_t getPageCount() { return _pages.size(); }
+
+private:
+    // the top of the images packed into a page, from left to right
+    struct SkylineNode
+    {
+        int x;
+        int y;
+        int width;
+    };
+    struct Page
+    {
+        AtlasPageTexture* texture;
+        bool hasPremultipliedAlpha;
+        std::vector<SkylineNode> skyline;
+        // of the images still in the page, with their padding
+        int usedArea;
+    };
+    struct Entry
+    {
+        SpriteFrame* frame;
+        // nullptr for an image with its own texture
+        AtlasPageTexture* page;
+        int x;
+        int y;
+        int width;
+        int height;
+        // the frame it was last returned by addImage() or getSpriteFrame()
+        unsigned int lastUsedFrame;
+    };
+
+    static SpriteFrame* pack(Image* image, Entry& entry);
+    // finds the space of an image in a page of the same alpha, creating a page if allowed
+    static Page* allocate(int width, int height, bool hasPremultipliedAlpha, bool canCreatePage, int& x, int& y);
+    static bool insert(Page& page, int width, int height, int& x, int& y);
+    // the images returned since frame are kept, their sprites may not be created yet
+    static size_t removeUnusedImages(unsigned int frame);
+    static void removeEntry(Entry& entry);
+
+    static std::unordered_map<std::string, Entry> _entries;
+    static std::vector<Page> _pages;
+    static int _maxImageSize;
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif
@@ -110,6 +110,10 @@ TMXLayer::TMXLayer()
 , _tileSet(nullptr)
 , _layerOrientation(FAST_TMX_ORIENTATION_ORTHO)
 , _texture(nullptr)
+, _visibleXBegin(0)
+, _visibleXEnd(-1)
+, _visibleYBegin(0)
+, _visibleYEnd(-1)
 , _vertexZvalue(0)
 , _useAutomaticVertexZ(false)
 , _quadsDirty(true)
@@ -117,6 +121,10 @@ TMXLayer::TMXLayer()
 , _vertexBuffer(nullptr)
 , _vData(nullptr)
 , _indexBuffer(nullptr)
+, _animationTime(0)
+, _animatedQuadStart(0)
+, _chunkSize(0)
+, _chunkIndexBuffer(nullptr)
 {
 }
 
@@ -128,11 +136,22 @@ TMXLayer::~TMXLayer()
     CC_SAFE_RELEASE(_vData);
     CC_SAFE_RELEASE(_vertexBuffer);
     CC_SAFE_RELEASE(_indexBuffer);
-
+    releaseChunks();
 }
 
 void TMXLayer::draw(Renderer *renderer, const Mat4& transform, uint32_t flags)
 {
+    if (_chunkSize > 0)
+    {
+        // the visible chunks are found every frame, the chunks themselves are only rebuilt when their tiles change
+        Size s = _director->getWinSize();
+        Mat4 inv = transform;
+        inv.inverse();
+        drawChunks(renderer, RectApplyTransform(Rect(0, 0, s.width, s.height), inv), flags);
+        _dirty = false;
+        return;
+    }
+
     updateTotalQuads();
 
     if( flags != 0 || _dirty || _quadsDirty )
@@ -144,9 +163,12 @@ void TMXLayer::draw(Renderer *renderer, const Mat4& transform, uint32_t flags)
         inv.inverse();
         rect = RectApplyTransform(rect, inv);
 
-        updateTiles(rect);
-        updateIndexBuffer();
-        updatePrimitives();
+        // the quads are in node space, moving the layer only changes the indices when other tiles become visible
+        if (updateTiles(rect))
+        {
+            updateIndexBuffer();
+            updatePrimitives();
+        }
         _dirty = false;
     }
 
@@ -175,12 +197,12 @@ void TMXLayer::onDraw(Primitive *primitive)
 
     GL::bindVAO(0);
     primitive->draw();
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     CC_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(1, primitive->getCount() * 4);
 }
 
-void TMXLayer::updateTiles(const Rect& culledRect)
+void TMXLayer::getVisibleTileRange(const Rect& culledRect, int& xBegin, int& xEnd, int& yBegin, int& yEnd)
 {
     Rect visibleTiles = culledRect;
     Size mapTileSize = CC_SIZE_PIXELS_TO_POINTS(_mapTileSize);
@@ -221,6 +243,26 @@ void TMXLayer::updateTiles(const Rect& culledRect)
         tilesOverY = ceil(overTileRect.origin.y + overTileRect.size.height) - floor(overTileRect.origin.y);
     }
 
+    yBegin = std::max(0.f,visibleTiles.origin.y - tilesOverY);
+    yEnd = std::min(_layerSize.height,visibleTiles.origin.y + visibleTiles.size.height + tilesOverY);
+    xBegin = std::max(0.f,visibleTiles.origin.x - tilesOverX);
+    xEnd = std::min(_layerSize.width,visibleTiles.origin.x + visibleTiles.size.width + tilesOverX);
+}
+
+bool TMXLayer::updateTiles(const Rect& culledRect)
+{
+    int xBegin, xEnd, yBegin, yEnd;
+    getVisibleTileRange(culledRect, xBegin, xEnd, yBegin, yEnd);
+
+    if (!_dirty && xBegin == _visibleXBegin && xEnd == _visibleXEnd && yBegin == _visibleYBegin && yEnd == _visibleYEnd)
+    {
+        return false;
+    }
+    _visibleXBegin = xBegin;
+    _visibleXEnd = xEnd;
+    _visibleYBegin = yBegin;
+    _visibleYEnd = yEnd;
+
     _indicesVertexZNumber.clear();
 
     for(const auto& iter : _indicesVertexZOffsets)
@@ -228,11 +270,6 @@ void TMXLayer::updateTiles(const Rect& culledRect)
         _indicesVertexZNumber[iter.first] = iter.second;
     }
 
-    int yBegin = std::max(0.f,visibleTiles.origin.y - tilesOverY);
-    int yEnd = std::min(_layerSize.height,visibleTiles.origin.y + visibleTiles.size.height + tilesOverY);
-    int xBegin = std::max(0.f,visibleTiles.origin.x - tilesOverX);
-    int xEnd = std::min(_layerSize.width,visibleTiles.origin.x + visibleTiles.size.width + tilesOverX);
-
     for (int y =  yBegin; y < yEnd; ++y)
     {
         for (int x = xBegin; x < xEnd; ++x)
@@ -266,6 +303,7 @@ void TMXLayer::updateTiles(const Rect& culledRect)
         }
     }
 
+    return true;
 }
 
 void TMXLayer::updateVertexBuffer()
@@ -295,7 +333,13 @@ void TMXLayer::updateIndexBuffer()
         _indexBuffer = IndexBuffer::create(IndexBuffer::IndexType::INDEX_TYPE_SHORT_16, (int)_indices.size());
         CC_SAFE_RETAIN(_indexBuffer);
     }
-    _indexBuffer->updateIndices(&_indices[0], (int)_indices.size(), 0);
+
+    // every vertexZ has room for all of its tiles, only the visible ones at its start are drawn and uploaded
+    for(const auto& iter : _indicesVertexZNumber)
+    {
+        int start = _indicesVertexZOffsets.at(iter.first) * 6;
+        _indexBuffer->updateIndices(&_indices[start], iter.second * 6, start);
+    }
 
 }
 
@@ -315,6 +359,22 @@ void TMXLayer::setupTiles()
     // Parse cocos2d properties
     this->parseInternalProperties();
 
+    setChunkSize(getProperty("cc_chunk_size").asInt());
+
+    // the animated tiles of Tiled, their quads are rewritten when one of them changes of frame
+    _animationFrames.clear();
+    for (const auto& iter : _tileSet->_animations)
+    {
+        if (!iter.second.empty())
+        {
+            _animationFrames[iter.first] = iter.second.front().gid;
+        }
+    }
+    if (!_animationFrames.empty())
+    {
+        scheduleUpdate();
+    }
+
     Size screenSize = _director->getWinSize();
 
     switch (_layerOrientation)
@@ -394,6 +454,15 @@ Mat4 TMXLayer::tileToNodeTransform()
 
 void TMXLayer::updatePrimitives()
 {
+    // the vertexZ without visible tiles aren't in _indicesVertexZNumber anymore
+    for(const auto& iter : _primitives)
+    {
+        if(_indicesVertexZNumber.find(iter.first) == _indicesVertexZNumber.end())
+        {
+            iter.second->setCount(0);
+        }
+    }
+
     for(const auto& iter : _indicesVertexZNumber)
     {
         int start = _indicesVertexZOffsets.at(iter.first);
@@ -419,15 +488,31 @@ void TMXLayer::updateTotalQuads()
 {
     if(_quadsDirty)
     {
-        Size tileSize = CC_SIZE_PIXELS_TO_POINTS(_tileSet->_tileSize);
-        Size texSize = _tileSet->_imageSize;
         _tileToQuadIndex.clear();
         _totalQuads.resize(int(_layerSize.width * _layerSize.height));
         _indices.resize(6 * int(_layerSize.width * _layerSize.height));
         _tileToQuadIndex.resize(int(_layerSize.width * _layerSize.height),-1);
         _indicesVertexZOffsets.clear();
+        _animatedTileIndices.clear();
+
+        int quadCount = 0;
+        if (!_animationFrames.empty())
+        {
+            for(int i = 0, count = int(_layerSize.width * _layerSize.height); i < count; ++i)
+            {
+                if(_tiles[i] == 0) continue;
+
+                if(isAnimatedGID(_tiles[i]))
+                {
+                    _animatedTileIndices.push_back(i);
+                }
+                ++quadCount;
+            }
+        }
+        _animatedQuadStart = quadCount - (int)_animatedTileIndices.size();
 
         int quadIndex = 0;
+        int animatedQuadIndex = _animatedQuadStart;
         for(int y = 0; y < _layerSize.height; ++y)
         {
             for(int x =0; x < _layerSize.width; ++x)
@@ -437,16 +522,13 @@ void TMXLayer::updateTotalQuads()
 
                 if(tileGID == 0) continue;
 
-                _tileToQuadIndex[tileIndex] = quadIndex;
-
-                auto& quad = _totalQuads[quadIndex];
-
-                Vec3 nodePos(float(x), float(y), 0);
-                _tileToNodeTransform.transformPoint(&nodePos);
+                bool animated = !_animatedTileIndices.empty() && isAnimatedGID(tileGID);
+                int index = animated ? animatedQuadIndex++ : quadIndex++;
+                _tileToQuadIndex[tileIndex] = index;
 
-                float left, right, top, bottom, z;
+                auto& quad = _totalQuads[index];
 
-                z = getVertexZForPos(Vec2(x, y));
+                int z = getVertexZForPos(Vec2(x, y));
                 auto iter = _indicesVertexZOffsets.find(z);
                 if(iter == _indicesVertexZOffsets.end())
                 {
@@ -456,81 +538,8 @@ void TMXLayer::updateTotalQuads()
                 {
                     iter->second++;
                 }
-                // vertices
-                if (tileGID & kTMXTileDiagonalFlag)
-                {
-                    left = nodePos.x;
-                    right = nodePos.x + tileSize.height;
-                    bottom = nodePos.y + tileSize.width;
-                    top = nodePos.y;
-                }
-                else
-                {
-                    left = nodePos.x;
-                    right = nodePos.x + tileSize.width;
-                    bottom = nodePos.y + tileSize.height;
-                    top = nodePos.y;
-                }
-
-                if(tileGID & kTMXTileVerticalFlag)
-                    std::swap(top, bottom);
-                if(tileGID & kTMXTileHorizontalFlag)
-                    std::swap(left, right);
-
-                if(tileGID & kTMXTileDiagonalFlag)
-                {
-                    // FIXME: not working correctly
-                    quad.bl.vertices.x = left;
-                    quad.bl.vertices.y = bottom;
-                    quad.bl.vertices.z = z;
-                    quad.br.vertices.x = left;
-                    quad.br.vertices.y = top;
-                    quad.br.vertices.z = z;
-                    quad.tl.vertices.x = right;
-                    quad.tl.vertices.y = bottom;
-                    quad.tl.vertices.z = z;
-                    quad.tr.vertices.x = right;
-                    quad.tr.vertices.y = top;
-                    quad.tr.vertices.z = z;
-                }
-                else
-                {
-                    quad.bl.vertices.x = left;
-                    quad.bl.vertices.y = bottom;
-                    quad.bl.vertices.z = z;
-                    quad.br.vertices.x = right;
-                    quad.br.vertices.y = bottom;
-                    quad.br.vertices.z = z;
-                    quad.tl.vertices.x = left;
-                    quad.tl.vertices.y = top;
-                    quad.tl.vertices.z = z;
-                    quad.tr.vertices.x = right;
-                    quad.tr.vertices.y = top;
-                    quad.tr.vertices.z = z;
-                }
 
-                // texcoords
-                Rect tileTexture = _tileSet->getRectForGID(tileGID);
-                left   = (tileTexture.origin.x / texSize.width);
-                right  = left + (tileTexture.size.width / texSize.width);
-                bottom = (tileTexture.origin.y / texSize.height);
-                top    = bottom + (tileTexture.size.height / texSize.height);
-
-                quad.bl.texCoords.u = left;
-                quad.bl.texCoords.v = bottom;
-                quad.br.texCoords.u = right;
-                quad.br.texCoords.v = bottom;
-                quad.tl.texCoords.u = left;
-                quad.tl.texCoords.v = top;
-                quad.tr.texCoords.u = right;
-                quad.tr.texCoords.v = top;
-
-                quad.bl.colors = Color4B::WHITE;
-                quad.br.colors = Color4B::WHITE;
-                quad.tl.colors = Color4B::WHITE;
-                quad.tr.colors = Color4B::WHITE;
-
-                ++quadIndex;
+                fillTileQuad(quad, x, y, animated ? getDisplayedGID(tileGID) : tileGID, z);
             }
         }
 
@@ -542,10 +551,426 @@ void TMXLayer::updateTotalQuads()
         }
         updateVertexBuffer();
 
+        // the quad of a tile may have moved, all the indices are rewritten
+        _dirty = true;
         _quadsDirty = false;
     }
 }
 
+void TMXLayer::fillTileQuad(V3F_C4B_T2F_Quad& quad, int x, int y, int tileGID, int z)
+{
+    Size tileSize = CC_SIZE_PIXELS_TO_POINTS(_tileSet->_tileSize);
+    Size texSize = _tileSet->_imageSize;
+
+    Vec3 nodePos(float(x), float(y), 0);
+    _tileToNodeTransform.transformPoint(&nodePos);
+
+    float left, right, top, bottom;
+
+    // vertices
+    if (tileGID & kTMXTileDiagonalFlag)
+    {
+        left = nodePos.x;
+        right = nodePos.x + tileSize.height;
+        bottom = nodePos.y + tileSize.width;
+        top = nodePos.y;
+    }
+    else
+    {
+        left = nodePos.x;
+        right = nodePos.x + tileSize.width;
+        bottom = nodePos.y + tileSize.height;
+        top = nodePos.y;
+    }
+
+    if(tileGID & kTMXTileVerticalFlag)
+        std::swap(top, bottom);
+    if(tileGID & kTMXTileHorizontalFlag)
+        std::swap(left, right);
+
+    if(tileGID & kTMXTileDiagonalFlag)
+    {
+        // FIXME: not working correctly
+        quad.bl.vertices.x = left;
+        quad.bl.vertices.y = bottom;
+        quad.bl.vertices.z = z;
+        quad.br.vertices.x = left;
+        quad.br.vertices.y = top;
+        quad.br.vertices.z = z;
+        quad.tl.vertices.x = right;
+        quad.tl.vertices.y = bottom;
+        quad.tl.vertices.z = z;
+        quad.tr.vertices.x = right;
+        quad.tr.vertices.y = top;
+        quad.tr.vertices.z = z;
+    }
+    else
+    {
+        quad.bl.vertices.x = left;
+        quad.bl.vertices.y = bottom;
+        quad.bl.vertices.z = z;
+        quad.br.vertices.x = right;
+        quad.br.vertices.y = bottom;
+        quad.br.vertices.z = z;
+        quad.tl.vertices.x = left;
+        quad.tl.vertices.y = top;
+        quad.tl.vertices.z = z;
+        quad.tr.vertices.x = right;
+        quad.tr.vertices.y = top;
+        quad.tr.vertices.z = z;
+    }
+
+    // texcoords
+    Rect tileTexture = _tileSet->getRectForGID(tileGID);
+    left   = (tileTexture.origin.x / texSize.width);
+    right  = left + (tileTexture.size.width / texSize.width);
+    bottom = (tileTexture.origin.y / texSize.height);
+    top    = bottom + (tileTexture.size.height / texSize.height);
+
+    quad.bl.texCoords.u = left;
+    quad.bl.texCoords.v = bottom;
+    quad.br.texCoords.u = right;
+    quad.br.texCoords.v = bottom;
+    quad.tl.texCoords.u = left;
+    quad.tl.texCoords.v = top;
+    quad.tr.texCoords.u = right;
+    quad.tr.texCoords.v = top;
+
+    quad.bl.colors = Color4B::WHITE;
+    quad.br.colors = Color4B::WHITE;
+    quad.tl.colors = Color4B::WHITE;
+    quad.tr.colors = Color4B::WHITE;
+}
+
+// TMXLayer - chunks
+TMXLayer::Chunk::Chunk()
+: dirty(true)
+, animated(false)
+, vertexBuffer(nullptr)
+, vertexData(nullptr)
+{
+}
+
+TMXLayer::Chunk::~Chunk()
+{
+    for (auto& iter : primitives)
+    {
+        iter.second->release();
+    }
+    CC_SAFE_RELEASE(vertexData);
+    CC_SAFE_RELEASE(vertexBuffer);
+}
+
+void TMXLayer::setChunkSize(int chunkSize)
+{
+    CCASSERT(chunkSize >= 0 && chunkSize <= MAX_CHUNK_SIZE, "TMXLayer: invalid chunk size");
+    chunkSize = std::min(std::max(chunkSize, 0), MAX_CHUNK_SIZE);
+
+    // the whole layer can't be indexed with GLushort
+    if (chunkSize == 0 && _layerSize.width * _layerSize.height > 65536 / 4)
+    {
+        chunkSize = DEFAULT_CHUNK_SIZE;
+    }
+
+    if (chunkSize == _chunkSize)
+    {
+        return;
+    }
+
+    releaseChunks();
+    releaseTotalQuads();
+    _chunkSize = chunkSize;
+    _quadsDirty = true;
+    _dirty = true;
+}
+
+void TMXLayer::releaseChunks()
+{
+    for (auto& iter : _chunks)
+    {
+        delete iter.second;
+    }
+    _chunks.clear();
+    CC_SAFE_RELEASE_NULL(_chunkIndexBuffer);
+}
+
+void TMXLayer::releaseTotalQuads()
+{
+    std::vector<int>().swap(_tileToQuadIndex);
+    std::vector<V3F_C4B_T2F_Quad>().swap(_totalQuads);
+    std::vector<GLushort>().swap(_indices);
+    _indicesVertexZOffsets.clear();
+    _indicesVertexZNumber.clear();
+    _primitives.clear();
+    CC_SAFE_RELEASE_NULL(_vData);
+    CC_SAFE_RELEASE_NULL(_vertexBuffer);
+    CC_SAFE_RELEASE_NULL(_indexBuffer);
+}
+
+void TMXLayer::drawChunks(Renderer *renderer, const Rect& culledRect, uint32_t flags)
+{
+    int xBegin, xEnd, yBegin, yEnd;
+    getVisibleTileRange(culledRect, xBegin, xEnd, yBegin, yEnd);
+
+    const int chunksX = ((int)_layerSize.width + _chunkSize - 1) / _chunkSize;
+    int chunkXBegin = 0, chunkXEnd = -1, chunkYBegin = 0, chunkYEnd = -1;
+    if (xBegin < xEnd && yBegin < yEnd)
+    {
+        chunkXBegin = xBegin / _chunkSize;
+        chunkXEnd = (xEnd - 1) / _chunkSize;
+        chunkYBegin = yBegin / _chunkSize;
+        chunkYEnd = (yEnd - 1) / _chunkSize;
+    }
+
+    // the chunks next to the visible ones are kept, so scrolling back and forth doesn't rebuild them
+    for (auto iter = _chunks.begin(); iter != _chunks.end();)
+    {
+        int chunkX = iter->first % chunksX;
+        int chunkY = iter->first / chunksX;
+        if (chunkX < chunkXBegin - 1 || chunkX > chunkXEnd + 1 || chunkY < chunkYBegin - 1 || chunkY > chunkYEnd + 1)
+        {
+            delete iter->second;
+            iter = _chunks.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+
+    if (nullptr == _chunkIndexBuffer)
+    {
+        const int quadCount = _chunkSize * _chunkSize;
+        std::vector<GLushort> indices(quadCount * 6);
+        for (int i = 0; i < quadCount; ++i)
+        {
+            indices[i * 6 + 0] = (GLushort)(i * 4 + 0);
+            indices[i * 6 + 1] = (GLushort)(i * 4 + 1);
+            indices[i * 6 + 2] = (GLushort)(i * 4 + 2);
+            indices[i * 6 + 3] = (GLushort)(i * 4 + 3);
+            indices[i * 6 + 4] = (GLushort)(i * 4 + 2);
+            indices[i * 6 + 5] = (GLushort)(i * 4 + 1);
+        }
+        _chunkIndexBuffer = IndexBuffer::create(IndexBuffer::IndexType::INDEX_TYPE_SHORT_16, (int)indices.size());
+        CC_SAFE_RETAIN(_chunkIndexBuffer);
+        _chunkIndexBuffer->updateIndices(indices.data(), (int)indices.size(), 0);
+    }
+
+    size_t commandCount = 0;
+    for (int chunkY = chunkYBegin; chunkY <= chunkYEnd; ++chunkY)
+    {
+        for (int chunkX = chunkXBegin; chunkX <= chunkXEnd; ++chunkX)
+        {
+            Chunk*& chunk = _chunks[chunkX + chunkY * chunksX];
+            if (nullptr == chunk)
+            {
+                chunk = new (std::nothrow) Chunk();
+            }
+            if (chunk->dirty)
+            {
+                updateChunk(chunk, chunkX, chunkY);
+            }
+            commandCount += chunk->primitives.size();
+        }
+    }
+
+    // the commands are referenced by the renderer, they are all in place before the first one is added
+    if (_renderCommands.size() < commandCount)
+    {
+        _renderCommands.resize(commandCount);
+    }
+
+    auto blendfunc = _texture->hasPremultipliedAlpha() ? BlendFunc::ALPHA_PREMULTIPLIED : BlendFunc::ALPHA_NON_PREMULTIPLIED;
+    int index = 0;
+    for (int chunkY = chunkYBegin; chunkY <= chunkYEnd; ++chunkY)
+    {
+        for (int chunkX = chunkXBegin; chunkX <= chunkXEnd; ++chunkX)
+        {
+            for (const auto& iter : _chunks[chunkX + chunkY * chunksX]->primitives)
+            {
+                auto& cmd = _renderCommands[index++];
+                cmd.init(iter.first, _texture->getName(), getGLProgramState(), blendfunc, iter.second, _modelViewTransform, flags);
+                renderer->addCommand(&cmd);
+            }
+        }
+    }
+}
+
+void TMXLayer::updateChunk(Chunk* chunk, int chunkX, int chunkY)
+{
+    const int xBegin = chunkX * _chunkSize;
+    const int yBegin = chunkY * _chunkSize;
+    const int xEnd = std::min(xBegin + _chunkSize, (int)_layerSize.width);
+    const int yEnd = std::min(yBegin + _chunkSize, (int)_layerSize.height);
+
+    // the quads are sorted by vertexZ, so every vertexZ is one range of the shared indices
+    std::map<int/*vertexZ*/, int/*offset by quads*/> vertexZOffsets;
+    for (int y = yBegin; y < yEnd; ++y)
+    {
+        for (int x = xBegin; x < xEnd; ++x)
+        {
+            if (_tiles[getTileIndexByPos(x, y)] != 0)
+            {
+                vertexZOffsets[getVertexZForPos(Vec2(x, y))]++;
+            }
+        }
+    }
+
+    int quadCount = 0;
+    for (auto& iter : vertexZOffsets)
+    {
+        std::swap(quadCount, iter.second);
+        quadCount += iter.second;
+    }
+
+    for (auto& iter : chunk->primitives)
+    {
+        iter.second->release();
+    }
+    chunk->primitives.clear();
+    chunk->dirty = false;
+    chunk->animated = false;
+
+    if (quadCount == 0)
+    {
+        CC_SAFE_RELEASE_NULL(chunk->vertexData);
+        CC_SAFE_RELEASE_NULL(chunk->vertexBuffer);
+        return;
+    }
+
+    std::vector<V3F_C4B_T2F_Quad> quads(quadCount);
+    auto offsets = vertexZOffsets;
+    for (int y = yBegin; y < yEnd; ++y)
+    {
+        for (int x = xBegin; x < xEnd; ++x)
+        {
+            int tileGID = _tiles[getTileIndexByPos(x, y)];
+            if (tileGID == 0) continue;
+
+            int z = getVertexZForPos(Vec2(x, y));
+            if (!_animationFrames.empty() && isAnimatedGID(tileGID))
+            {
+                chunk->animated = true;
+                tileGID = getDisplayedGID(tileGID);
+            }
+            fillTileQuad(quads[offsets[z]++], x, y, tileGID, z);
+        }
+    }
+
+    GL::bindVAO(0);
+    if (chunk->vertexBuffer && chunk->vertexBuffer->getVertexNumber() < quadCount * 4)
+    {
+        CC_SAFE_RELEASE_NULL(chunk->vertexData);
+        CC_SAFE_RELEASE_NULL(chunk->vertexBuffer);
+    }
+    if (nullptr == chunk->vertexBuffer)
+    {
+        chunk->vertexBuffer = VertexBuffer::create(sizeof(V3F_C4B_T2F), quadCount * 4);
+        chunk->vertexData = VertexData::create();
+        chunk->vertexData->setStream(chunk->vertexBuffer, VertexStreamAttribute(0, GLProgram::VERTEX_ATTRIB_POSITION, GL_FLOAT, 3));
+        chunk->vertexData->setStream(chunk->vertexBuffer, VertexStreamAttribute(offsetof(V3F_C4B_T2F, colors), GLProgram::VERTEX_ATTRIB_COLOR, GL_UNSIGNED_BYTE, 4, true));
+        chunk->vertexData->setStream(chunk->vertexBuffer, VertexStreamAttribute(offsetof(V3F_C4B_T2F, texCoords), GLProgram::VERTEX_ATTRIB_TEX_COORD, GL_FLOAT, 2));
+        CC_SAFE_RETAIN(chunk->vertexData);
+        CC_SAFE_RETAIN(chunk->vertexBuffer);
+    }
+    chunk->vertexBuffer->updateVertices(quads.data(), quadCount * 4, 0);
+
+    for (const auto& iter : vertexZOffsets)
+    {
+        auto next = vertexZOffsets.upper_bound(iter.first);
+        int end = (next == vertexZOffsets.end()) ? quadCount : next->second;
+
+        auto primitive = Primitive::create(chunk->vertexData, _chunkIndexBuffer, GL_TRIANGLES);
+        primitive->setStart(iter.second * 6);
+        primitive->setCount((end - iter.second) * 6);
+        primitive->retain();
+        chunk->primitives.push_back(std::make_pair(iter.first, primitive));
+    }
+}
+
+// TMXLayer - animated tiles
+int TMXLayer::getDisplayedGID(int tileGID) const
+{
+    auto iter = _animationFrames.find(tileGID & kTMXFlippedMask);
+    if (iter == _animationFrames.end())
+    {
+        return tileGID;
+    }
+    return iter->second | (tileGID & kTMXFlipedAll);
+}
+
+void TMXLayer::update(float delta)
+{
+    _animationTime += delta;
+
+    bool changed = false;
+    for (const auto& iter : _tileSet->_animations)
+    {
+        const auto& frames = iter.second;
+        if (frames.empty()) continue;
+
+        float duration = 0;
+        for (const auto& frame : frames)
+        {
+            duration += frame.duration;
+        }
+
+        uint32_t gid = frames.front().gid;
+        if (duration > 0)
+        {
+            float time = fmodf(_animationTime, duration);
+            for (const auto& frame : frames)
+            {
+                gid = frame.gid;
+                if (time < frame.duration) break;
+                time -= frame.duration;
+            }
+        }
+
+        uint32_t& current = _animationFrames[iter.first];
+        if (current != gid)
+        {
+            current = gid;
+            changed = true;
+        }
+    }
+
+    if (changed)
+    {
+        updateAnimatedQuads();
+    }
+}
+
+void TMXLayer::updateAnimatedQuads()
+{
+    if (_chunkSize > 0)
+    {
+        for (auto& iter : _chunks)
+        {
+            if (iter.second->animated)
+            {
+                iter.second->dirty = true;
+            }
+        }
+        return;
+    }
+
+    // rebuilt with the current frames anyway
+    if (_quadsDirty || _animatedTileIndices.empty() || nullptr == _vertexBuffer)
+    {
+        return;
+    }
+
+    for (int i = 0, count = (int)_animatedTileIndices.size(); i < count; ++i)
+    {
+        int tileIndex = _animatedTileIndices[i];
+        int x = tileIndex % (int)_layerSize.width;
+        int y = tileIndex / (int)_layerSize.width;
+        fillTileQuad(_totalQuads[_animatedQuadStart + i], x, y, getDisplayedGID(_tiles[tileIndex]), getVertexZForPos(Vec2(x, y)));
+    }
+    _vertexBuffer->updateVertices(&_totalQuads[_animatedQuadStart], (int)_animatedTileIndices.size() * 4, _animatedQuadStart * 4);
+}
+
 // removing / getting tiles
 Sprite* TMXLayer::getTileAt(const Vec2& tileCoordinate)
 {
@@ -676,6 +1101,18 @@ void TMXLayer::setFlaggedTileGIDByIndex(int index, int gid)
 {
     if(gid == _tiles[index]) return;
     _tiles[index] = gid;
+    if (_chunkSize > 0)
+    {
+        const int chunksX = ((int)_layerSize.width + _chunkSize - 1) / _chunkSize;
+        const int x = index % (int)_layerSize.width;
+        const int y = index / (int)_layerSize.width;
+        auto iter = _chunks.find(x / _chunkSize + (y / _chunkSize) * chunksX);
+        if (iter != _chunks.end())
+        {
+            iter->second->dirty = true;
+        }
+        return;
+    }
     _quadsDirty = true;
     _dirty = true;
 }
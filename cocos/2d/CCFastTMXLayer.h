@@ -266,15 +266,56 @@ public:
     //
     virtual std::string getDescription() const override;
     virtual void draw(Renderer *renderer, const Mat4& transform, uint32_t flags) override;
+    virtual void update(float delta) override;
     void removeChild(Node* child, bool cleanup = true) override;
 
     Texture2D* getTexture() const { return _texture; }
 
+    /** The largest chunk side, the vertices of a chunk must be addressable with 16 bit indices. */
+    static const int MAX_CHUNK_SIZE = 128;
+    /** The chunk side of the layers that have too many tiles to be drawn at once. */
+    static const int DEFAULT_CHUNK_SIZE = 64;
+
+    /** Sets the side, in tiles, of the square chunks the layer is drawn by.
+     * With 0 the quads of the whole layer are built at once and kept, which is the fastest for small layers.
+     * With chunks, the quads of a chunk are built and uploaded the first time it is visible, and its buffers
+     * are released once it is more than one chunk away from the visible tiles, so the memory follows the
+     * visible area instead of the layer size.
+     * Layers with more tiles than 16 bit indices can address always use chunks, of DEFAULT_CHUNK_SIZE when 0 is set.
+     * The "cc_chunk_size" property of the layer sets it from Tiled.
+     *
+     * @param chunkSize The side of the chunks in tiles, up to MAX_CHUNK_SIZE, or 0.
+     * @since v3.11
+     */
+    void setChunkSize(int chunkSize);
+    /** Gets the side of the chunks in tiles, 0 when the layer is drawn at once.
+     * @since v3.11
+     */
+    int getChunkSize() const { return _chunkSize; }
+    /** Gets the number of chunks the layer keeps buffers for.
+     * @since v3.11
+     */
+    ssize_t getResidentChunkCount() const { return (ssize_t)_chunks.size(); }
+
 CC_CONSTRUCTOR_ACCESS:
     bool initWithTilesetInfo(TMXTilesetInfo *tilesetInfo, TMXLayerInfo *layerInfo, TMXMapInfo *mapInfo);
 
 protected:
-    void updateTiles(const Rect& culledRect);
+    /* The buffers of one chunk of a chunked layer, with a primitive per vertexZ */
+    struct Chunk
+    {
+        Chunk();
+        ~Chunk();
+
+        bool dirty;
+        bool animated;
+        VertexBuffer* vertexBuffer;
+        VertexData* vertexData;
+        std::vector<std::pair<int/*vertexZ*/, Primitive*>> primitives;
+    };
+
+    bool updateTiles(const Rect& culledRect);
+    void getVisibleTileRange(const Rect& culledRect, int& xBegin, int& xEnd, int& yBegin, int& yEnd);
     Vec2 calculateLayerOffset(const Vec2& offset);
 
     /* The layer recognizes some special properties, like cc_vertez */
@@ -297,6 +338,16 @@ protected:
     void updateVertexBuffer();
     void updateIndexBuffer();
     void updatePrimitives();
+
+    void fillTileQuad(V3F_C4B_T2F_Quad& quad, int x, int y, int tileGID, int z);
+    inline bool isAnimatedGID(int tileGID) const { return _animationFrames.find(tileGID & kTMXFlippedMask) != _animationFrames.end(); }
+    //the gid of the animation frame shown for the tile, with the flags of the tile
+    int getDisplayedGID(int tileGID) const;
+    void updateAnimatedQuads();
+    void drawChunks(Renderer *renderer, const Rect& culledRect, uint32_t flags);
+    void updateChunk(Chunk* chunk, int chunkX, int chunkY);
+    void releaseChunks();
+    void releaseTotalQuads();
 protected:
 
     //! name of the layer
@@ -322,6 +373,12 @@ protected:
 
     //GLuint _buffersVBO; //0: vertex, 1: indices
 
+    //the tiles the indices were written for, the indices only change when these or the tiles do
+    int _visibleXBegin;
+    int _visibleXEnd;
+    int _visibleYBegin;
+    int _visibleYEnd;
+
     Size _screenGridSize;
     Rect _screenGridRect;
     int _screenTileCount;
@@ -349,6 +406,18 @@ protected:
 
     Map<int , Primitive*> _primitives;
 
+    //the gid of the frame each animated tile of the tileset shows
+    std::unordered_map<uint32_t, uint32_t> _animationFrames;
+    float _animationTime;
+    //the animated tiles have the last quads, in this order, so a frame change uploads one range
+    std::vector<int> _animatedTileIndices;
+    int _animatedQuadStart;
+
+    int _chunkSize;
+    std::unordered_map<int/*chunk index*/, Chunk*> _chunks;
+    //the indices of _chunkSize * _chunkSize quads, shared by the chunks
+    IndexBuffer* _chunkIndexBuffer;
+
 public:
     /** Possible orientations of the TMX map */
     static const int FAST_TMX_ORIENTATION_ORTHO;
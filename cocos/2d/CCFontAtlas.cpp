@@ -29,9 +29,13 @@
 #elif CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID
 #include "android/jni/Java_org_cocos2dx_lib_Cocos2dxHelper.h"
 #endif
+#include <memory>
+#include <zlib.h>
 #include "2d/CCFontFreeType.h"
+#include "platform/CCFileUtils.h"
 #include "base/ccUTF8.h"
 #include "base/CCDirector.h"
+#include "base/CCAsyncTaskPool.h"
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventType.h"
@@ -42,6 +46,128 @@ const int FontAtlas::CacheTextureWidth = 512;
 const int FontAtlas::CacheTextureHeight = 512;
 const char* FontAtlas::CMD_PURGE_FONTATLAS = "__cc_PURGE_FONTATLAS";
 const char* FontAtlas::CMD_RESET_FONTATLAS = "__cc_RESET_FONTATLAS";
+const char* FontAtlas::CMD_UPDATE_FONTATLAS = "__cc_UPDATE_FONTATLAS";
+
+bool FontAtlas::s_isAsyncRasterizationEnabled = CC_FONT_ATLAS_ASYNC_RASTERIZATION != 0;
+
+namespace
+{
+    /*
+     The glyph cache file, little-endian:
+       "CCFA", u32 version, string signature, u32 page data size,
+       i32 current page, f32 page origin x, f32 page origin y, i32 line height,
+       u32 letter count, letters: u16 char, f32 U, V, width, height, offsetX, offsetY, i32 texture id, u8 valid, i32 xAdvance,
+       u32 page count, pages: u32 size, zlib data of the page.
+     Strings are a u32 length followed by the bytes.
+     */
+    // the multi-channel distance fields are RGB, the outline and the glyph are in the two channels of AI88
+    Texture2D::PixelFormat getPagePixelFormat(FontFreeType* font)
+    {
+        if (font->isMSDFEnabled())
+        {
+            return Texture2D::PixelFormat::RGB888;
+        }
+        return font->getOutlineSize() > 0 ? Texture2D::PixelFormat::AI88 : Texture2D::PixelFormat::A8;
+    }
+
+    int getPageBytesPerPixel(Texture2D::PixelFormat pixelFormat)
+    {
+        switch (pixelFormat)
+        {
+        case Texture2D::PixelFormat::RGB888:
+            return 3;
+        case Texture2D::PixelFormat::AI88:
+            return 2;
+        default:
+            return 1;
+        }
+    }
+
+    const char GLYPH_CACHE_MAGIC[4] = { 'C', 'C', 'F', 'A' };
+    const unsigned int GLYPH_CACHE_VERSION = 1;
+
+    class GlyphCacheWriter
+    {
+    public:
+        void writeU8(unsigned char v) { bytes.push_back(v); }
+        void writeU16(unsigned short v) { writeU8(v & 0xff); writeU8(v >> 8); }
+        void writeU32(unsigned int v) { writeU16(v & 0xffff); writeU16(v >> 16); }
+        void writeInt(int v) { writeU32((unsigned int)v); }
+        void writeFloat(float v)
+        {
+            unsigned int bits;
+            memcpy(&bits, &v, sizeof(bits));
+            writeU32(bits);
+        }
+        void writeBytes(const void* data, size_t size)
+        {
+            auto begin = static_cast<const unsigned char*>(data);
+            bytes.insert(bytes.end(), begin, begin + size);
+        }
+        void writeString(const std::string& str)
+        {
+            writeU32((unsigned int)str.length());
+            writeBytes(str.data(), str.length());
+        }
+
+        std::vector<unsigned char> bytes;
+    };
+
+    class GlyphCacheReader
+    {
+    public:
+        GlyphCacheReader(const unsigned char* data, ssize_t size) : _data(data), _size(size), _offset(0), _ok(true) {}
+
+        bool ok() const { return _ok; }
+
+        const unsigned char* readBytes(size_t size)
+        {
+            if (!_ok || size > (size_t)(_size - _offset))
+            {
+                _ok = false;
+                return nullptr;
+            }
+            auto bytes = _data + _offset;
+            _offset += size;
+            return bytes;
+        }
+        unsigned char readU8()
+        {
+            auto p = readBytes(1);
+            return p ? p[0] : 0;
+        }
+        unsigned short readU16()
+        {
+            auto p = readBytes(2);
+            return p ? (unsigned short)(p[0] | (p[1] << 8)) : 0;
+        }
+        unsigned int readU32()
+        {
+            auto p = readBytes(4);
+            return p ? (unsigned int)p[0] | ((unsigned int)p[1] << 8) | ((unsigned int)p[2] << 16) | ((unsigned int)p[3] << 24) : 0;
+        }
+        int readInt() { return (int)readU32(); }
+        float readFloat()
+        {
+            unsigned int bits = readU32();
+            float v;
+            memcpy(&v, &bits, sizeof(v));
+            return v;
+        }
+        std::string readString()
+        {
+            unsigned int length = readU32();
+            auto p = readBytes(length);
+            return p ? std::string(reinterpret_cast<const char*>(p), length) : std::string();
+        }
+
+    private:
+        const unsigned char* _data;
+        ssize_t _size;
+        ssize_t _offset;
+        bool _ok;
+    };
+}
 
 FontAtlas::FontAtlas(Font &theFont)
 : _font(&theFont)
@@ -52,6 +178,10 @@ FontAtlas::FontAtlas(Font &theFont)
 , _rendererRecreatedListener(nullptr)
 , _antialiasEnabled(true)
 , _currLineHeight(0)
+, _pageDataRetained(false)
+, _savedLetterCount(0)
+, _pendingLetterCount(0)
+, _resetCount(0)
 {
     _font->retain();
 
@@ -71,18 +201,21 @@ FontAtlas::FontAtlas(Font &theFont)
         {
             _letterPadding += 2 * FontFreeType::DistanceMapSpread;
         }
-        _currentPageDataSize = CacheTextureWidth * CacheTextureHeight;
+        else if (_fontFreeType->isMSDFEnabled())
+        {
+            _letterPadding += 2 * FontFreeType::MSDFSpread;
+        }
         auto outlineSize = _fontFreeType->getOutlineSize();
         if(outlineSize > 0)
         {
             _lineHeight += 2 * outlineSize;
-            _currentPageDataSize *= 2;
         }
+        auto pixelFormat = getPagePixelFormat(_fontFreeType);
+        _currentPageDataSize = CacheTextureWidth * CacheTextureHeight * getPageBytesPerPixel(pixelFormat);
 
         _currentPageData = new (std::nothrow) unsigned char[_currentPageDataSize];
         memset(_currentPageData, 0, _currentPageDataSize);
 
-        auto  pixelFormat = outlineSize > 0 ? Texture2D::PixelFormat::AI88 : Texture2D::PixelFormat::A8;
         texture->initWithData(_currentPageData, _currentPageDataSize,
             pixelFormat, CacheTextureWidth, CacheTextureHeight, Size(CacheTextureWidth,CacheTextureHeight) );
 
@@ -111,6 +244,7 @@ FontAtlas::~FontAtlas()
 
     _font->release();
     releaseTextures();
+    releasePagesData();
 
     delete []_currentPageData;
 
@@ -126,12 +260,18 @@ FontAtlas::~FontAtlas()
 void FontAtlas::reset()
 {
     releaseTextures();
+    releasePagesData();
+
+    // the glyphs being rasterized belong to the old pages
+    _pendingLetterCount = 0;
+    ++_resetCount;
 
     _currLineHeight = 0;
     _currentPage = 0;
     _currentPageOrigX = 0;
     _currentPageOrigY = 0;
     _letterDefinitions.clear();
+    _savedLetterCount = 0;
 }
 
 void FontAtlas::releaseTextures()
@@ -143,6 +283,15 @@ void FontAtlas::releaseTextures()
     _atlasTextures.clear();
 }
 
+void FontAtlas::releasePagesData()
+{
+    for (auto data : _pagesData)
+    {
+        delete [] data;
+    }
+    _pagesData.clear();
+}
+
 void FontAtlas::purgeTexturesAtlas()
 {
     if (_fontFreeType)
@@ -306,6 +455,16 @@ void FontAtlas::findNewCharacters(const std::u16string& u16Text, std::unordered_
     }
 }
 
+void FontAtlas::setAsyncRasterizationEnabled(bool enabled)
+{
+    s_isAsyncRasterizationEnabled = enabled;
+}
+
+bool FontAtlas::isAsyncRasterizationEnabled()
+{
+    return s_isAsyncRasterizationEnabled;
+}
+
 bool FontAtlas::prepareLetterDefinitions(const std::u16string& utf16Text)
 {
     if (_fontFreeType == nullptr)
@@ -320,29 +479,106 @@ bool FontAtlas::prepareLetterDefinitions(const std::u16string& utf16Text)
         return false;
     }
 
-    int adjustForDistanceMap = _letterPadding / 2;
-    int adjustForExtend = _letterEdgeExtend / 2;
+    if (s_isAsyncRasterizationEnabled)
+    {
+        prepareLetterDefinitionsAsync(codeMapOfNewChar);
+        return true;
+    }
+
+    std::vector<RasterizedGlyph> glyphs(codeMapOfNewChar.size());
+    size_t index = 0;
+    for (auto&& it : codeMapOfNewChar)
+    {
+        glyphs[index].utf16Char = it.first;
+        glyphs[index].charCode = it.second;
+        ++index;
+    }
+    rasterizeGlyphs(_fontFreeType, glyphs);
+    addGlyphs(glyphs);
+    for (auto&& glyph : glyphs)
+    {
+        delete [] glyph.tile;
+    }
+
+    return true;
+}
+
+void FontAtlas::prepareLetterDefinitionsAsync(const std::unordered_map<unsigned short, unsigned short>& codeMapOfNewChar)
+{
+    auto glyphs = std::make_shared<std::vector<RasterizedGlyph>>(codeMapOfNewChar.size());
+    size_t index = 0;
+    for (auto&& it : codeMapOfNewChar)
+    {
+        (*glyphs)[index].utf16Char = it.first;
+        (*glyphs)[index].charCode = it.second;
+        ++index;
+
+        // the layout skips the letter until it's added, and it isn't queued again meanwhile
+        FontLetterDefinition placeholder;
+        memset(&placeholder, 0, sizeof(placeholder));
+        placeholder.validDefinition = false;
+        _letterDefinitions[it.first] = placeholder;
+    }
+    _pendingLetterCount += (int)glyphs->size();
+
+    // the atlas and its font are kept alive by the task
+    retain();
+    auto font = _fontFreeType;
+    auto resetCount = _resetCount;
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_OTHER, [this, glyphs, resetCount](void*) {
+        if (resetCount == _resetCount)
+        {
+            _pendingLetterCount -= (int)glyphs->size();
+            addGlyphs(*glyphs);
+            Director::getInstance()->getEventDispatcher()->dispatchCustomEvent(CMD_UPDATE_FONTATLAS, this);
+        }
+        for (auto&& glyph : *glyphs)
+        {
+            delete [] glyph.tile;
+        }
+        release();
+    }, nullptr, [font, glyphs]() {
+        rasterizeGlyphs(font, *glyphs);
+    });
+}
+
+void FontAtlas::rasterizeGlyphs(FontFreeType* font, std::vector<RasterizedGlyph>& glyphs)
+{
     long bitmapWidth;
-    long bitmapHeight;
     Rect tempRect;
+    for (auto&& glyph : glyphs)
+    {
+        glyph.tile = font->renderGlyph(glyph.charCode, bitmapWidth, glyph.bitmapHeight, tempRect, glyph.xAdvance,
+            glyph.tileWidth, glyph.tileHeight);
+        glyph.rectX = tempRect.origin.x;
+        glyph.rectY = tempRect.origin.y;
+        glyph.rectWidth = tempRect.size.width;
+        glyph.rectHeight = tempRect.size.height;
+    }
+}
+
+void FontAtlas::addGlyphs(const std::vector<RasterizedGlyph>& glyphs)
+{
+    int adjustForDistanceMap = _letterPadding / 2;
+    int adjustForExtend = _letterEdgeExtend / 2;
     FontLetterDefinition tempDef;
 
     auto scaleFactor = CC_CONTENT_SCALE_FACTOR();
-    auto  pixelFormat = _fontFreeType->getOutlineSize() > 0 ? Texture2D::PixelFormat::AI88 : Texture2D::PixelFormat::A8;
+    int bytesPerPixel = getPageBytesPerPixel(getPagePixelFormat(_fontFreeType));
 
     float startY = _currentPageOrigY;
     int newLineHeight;
     auto maxLineHeight = _lineHeight + _letterPadding + _letterEdgeExtend;
-    for (auto&& it : codeMapOfNewChar)
+    for (auto&& glyph : glyphs)
     {
-        auto bitmap = _fontFreeType->getGlyphBitmap(it.second, bitmapWidth, bitmapHeight, tempRect, tempDef.xAdvance);
-        if (bitmap && bitmapWidth > 0 && bitmapHeight > 0)
+        tempDef.xAdvance = glyph.xAdvance;
+        if (glyph.tile)
         {
             tempDef.validDefinition = true;
-            tempDef.width = tempRect.size.width + _letterPadding + _letterEdgeExtend;
-            tempDef.height = tempRect.size.height + _letterPadding + _letterEdgeExtend;
-            tempDef.offsetX = tempRect.origin.x + adjustForDistanceMap + adjustForExtend;
-            tempDef.offsetY = _fontAscender + tempRect.origin.y - adjustForDistanceMap - adjustForExtend;
+            tempDef.width = glyph.rectWidth + _letterPadding + _letterEdgeExtend;
+            tempDef.height = glyph.rectHeight + _letterPadding + _letterEdgeExtend;
+            tempDef.offsetX = glyph.rectX + adjustForDistanceMap + adjustForExtend;
+            tempDef.offsetY = _fontAscender + glyph.rectY - adjustForDistanceMap - adjustForExtend;
 
             if (_currentPageOrigX + tempDef.width > CacheTextureWidth)
             {
@@ -351,44 +587,42 @@ bool FontAtlas::prepareLetterDefinitions(const std::u16string& utf16Text)
                 _currentPageOrigX = 0;
                 if (_currentPageOrigY + maxLineHeight >= CacheTextureHeight)
                 {
-                    unsigned char *data = nullptr;
-                    if (pixelFormat == Texture2D::PixelFormat::AI88)
-                    {
-                        data = _currentPageData + CacheTextureWidth * (int)startY * 2;
-                    }
-                    else
-                    {
-                        data = _currentPageData + CacheTextureWidth * (int)startY;
-                    }
+                    unsigned char *data = _currentPageData + CacheTextureWidth * (int)startY * bytesPerPixel;
                     _atlasTextures[_currentPage]->updateWithData(data, 0, startY,
                         CacheTextureWidth, CacheTextureHeight - startY);
 
                     startY = 0.0f;
 
+                    if (_pageDataRetained)
+                    {
+                        auto pageData = new (std::nothrow) unsigned char[_currentPageDataSize];
+                        memcpy(pageData, _currentPageData, _currentPageDataSize);
+                        _pagesData.push_back(pageData);
+                    }
+
                     _currentPageOrigY = 0;
                     memset(_currentPageData, 0, _currentPageDataSize);
                     _currentPage++;
-                    auto tex = new (std::nothrow) Texture2D;
-                    if (_antialiasEnabled)
-                    {
-                        tex->setAntiAliasTexParameters();
-                    }
-                    else
-                    {
-                        tex->setAliasTexParameters();
-                    }
-                    tex->initWithData(_currentPageData, _currentPageDataSize,
-                        pixelFormat, CacheTextureWidth, CacheTextureHeight, Size(CacheTextureWidth, CacheTextureHeight));
+                    auto tex = createPageTexture(_currentPageData);
                     addTexture(tex, _currentPage);
                     tex->release();
                 }
             }
-            newLineHeight = static_cast<int>(bitmapHeight) + _letterPadding + _letterEdgeExtend;
+            newLineHeight = static_cast<int>(glyph.bitmapHeight) + _letterPadding + _letterEdgeExtend;
             if (newLineHeight > _currLineHeight)
             {
                 _currLineHeight = newLineHeight;
             }
-            _fontFreeType->renderCharAt(_currentPageData, _currentPageOrigX + adjustForExtend, _currentPageOrigY + adjustForExtend, bitmap, bitmapWidth, bitmapHeight);
+
+            // the tile is already in the pixel format of the page
+            int tileX = (int)_currentPageOrigX + adjustForExtend;
+            int tileY = (int)_currentPageOrigY + adjustForExtend;
+            size_t rowSize = glyph.tileWidth * bytesPerPixel;
+            for (long y = 0; y < glyph.tileHeight; ++y)
+            {
+                memcpy(_currentPageData + ((tileY + y) * CacheTextureWidth + tileX) * bytesPerPixel,
+                    glyph.tile + y * rowSize, rowSize);
+            }
 
             tempDef.U = _currentPageOrigX;
             tempDef.V = _currentPageOrigY;
@@ -416,26 +650,190 @@ bool FontAtlas::prepareLetterDefinitions(const std::u16string& utf16Text)
             _currentPageOrigX += 1;
         }
 
-        _letterDefinitions[it.first] = tempDef;
+        _letterDefinitions[glyph.utf16Char] = tempDef;
     }
 
-    unsigned char *data = nullptr;
-    if (pixelFormat == Texture2D::PixelFormat::AI88)
+    unsigned char *data = _currentPageData + CacheTextureWidth * (int)startY * bytesPerPixel;
+    _atlasTextures[_currentPage]->updateWithData(data, 0, startY, CacheTextureWidth, _currentPageOrigY - startY + _currLineHeight);
+}
+
+Texture2D* FontAtlas::createPageTexture(const unsigned char* data)
+{
+    auto pixelFormat = getPagePixelFormat(_fontFreeType);
+    auto tex = new (std::nothrow) Texture2D;
+    if (_antialiasEnabled)
     {
-        data = _currentPageData + CacheTextureWidth * (int)startY * 2;
+        tex->setAntiAliasTexParameters();
     }
     else
     {
-        data = _currentPageData + CacheTextureWidth * (int)startY;
+        tex->setAliasTexParameters();
+    }
+    tex->initWithData(data, _currentPageDataSize,
+        pixelFormat, CacheTextureWidth, CacheTextureHeight, Size(CacheTextureWidth, CacheTextureHeight));
+    return tex;
+}
+
+bool FontAtlas::saveToFile(const std::string& filename, const std::string& signature)
+{
+    if (_fontFreeType == nullptr)
+    {
+        return false;
+    }
+    if (_pendingLetterCount > 0)
+    {
+        // the letters being rasterized are only placeholders
+        return false;
+    }
+    if ((int)_pagesData.size() != _currentPage)
+    {
+        CCLOG("FontAtlas: the filled pages weren't retained, see setPageDataRetained()");
+        return false;
+    }
+
+    GlyphCacheWriter writer;
+    writer.writeBytes(GLYPH_CACHE_MAGIC, sizeof(GLYPH_CACHE_MAGIC));
+    writer.writeU32(GLYPH_CACHE_VERSION);
+    writer.writeString(signature);
+    writer.writeU32((unsigned int)_currentPageDataSize);
+    writer.writeInt(_currentPage);
+    writer.writeFloat(_currentPageOrigX);
+    writer.writeFloat(_currentPageOrigY);
+    writer.writeInt(_currLineHeight);
+
+    writer.writeU32((unsigned int)_letterDefinitions.size());
+    for (auto&& item : _letterDefinitions)
+    {
+        const FontLetterDefinition& def = item.second;
+        writer.writeU16(item.first);
+        writer.writeFloat(def.U);
+        writer.writeFloat(def.V);
+        writer.writeFloat(def.width);
+        writer.writeFloat(def.height);
+        writer.writeFloat(def.offsetX);
+        writer.writeFloat(def.offsetY);
+        writer.writeInt(def.textureID);
+        writer.writeU8(def.validDefinition ? 1 : 0);
+        writer.writeInt(def.xAdvance);
+    }
+
+    // the pages are mostly empty, they shrink a lot
+    std::vector<unsigned char> compressed(compressBound(_currentPageDataSize));
+    writer.writeU32(_currentPage + 1);
+    for (int page = 0; page <= _currentPage; ++page)
+    {
+        const unsigned char* pageData = page < _currentPage ? _pagesData[page] : _currentPageData;
+        uLongf compressedSize = (uLongf)compressed.size();
+        if (compress2(compressed.data(), &compressedSize, pageData, _currentPageDataSize, Z_DEFAULT_COMPRESSION) != Z_OK)
+        {
+            return false;
+        }
+        writer.writeU32((unsigned int)compressedSize);
+        writer.writeBytes(compressed.data(), compressedSize);
+    }
+
+    Data data;
+    data.copy(writer.bytes.data(), writer.bytes.size());
+    if (!FileUtils::getInstance()->writeDataToFile(data, filename))
+    {
+        return false;
+    }
+
+    _savedLetterCount = _letterDefinitions.size();
+    return true;
+}
+
+bool FontAtlas::initWithFile(const std::string& filename, const std::string& signature)
+{
+    if (_fontFreeType == nullptr)
+    {
+        return false;
+    }
+
+    FileView view = FileUtils::getInstance()->getFileView(filename);
+    GlyphCacheReader reader(view.getBytes(), view.getSize());
+    auto magic = reader.readBytes(sizeof(GLYPH_CACHE_MAGIC));
+    if (!magic || memcmp(magic, GLYPH_CACHE_MAGIC, sizeof(GLYPH_CACHE_MAGIC)) != 0
+        || reader.readU32() != GLYPH_CACHE_VERSION || reader.readString() != signature
+        || reader.readU32() != (unsigned int)_currentPageDataSize)
+    {
+        return false;
+    }
+
+    int currentPage = reader.readInt();
+    float origX = reader.readFloat();
+    float origY = reader.readFloat();
+    int lineHeight = reader.readInt();
+
+    std::unordered_map<char16_t, FontLetterDefinition> letterDefinitions;
+    unsigned int letterCount = reader.readU32();
+    for (unsigned int i = 0; i < letterCount && reader.ok(); ++i)
+    {
+        char16_t utf16Char = reader.readU16();
+        FontLetterDefinition def;
+        def.U = reader.readFloat();
+        def.V = reader.readFloat();
+        def.width = reader.readFloat();
+        def.height = reader.readFloat();
+        def.offsetX = reader.readFloat();
+        def.offsetY = reader.readFloat();
+        def.textureID = reader.readInt();
+        def.validDefinition = reader.readU8() != 0;
+        def.xAdvance = reader.readInt();
+        letterDefinitions[utf16Char] = def;
+    }
+
+    unsigned int pageCount = reader.readU32();
+    if (!reader.ok() || currentPage < 0 || pageCount != (unsigned int)currentPage + 1)
+    {
+        return false;
+    }
+
+    std::vector<std::vector<unsigned char>> pages(pageCount);
+    for (auto& page : pages)
+    {
+        uLongf compressedSize = reader.readU32();
+        auto compressed = reader.readBytes(compressedSize);
+        page.resize(_currentPageDataSize);
+        uLongf size = (uLongf)page.size();
+        if (!compressed || uncompress(page.data(), &size, compressed, compressedSize) != Z_OK || size != page.size())
+        {
+            return false;
+        }
+    }
+
+    reset();
+    for (unsigned int i = 0; i < pageCount; ++i)
+    {
+        auto tex = createPageTexture(pages[i].data());
+        addTexture(tex, i);
+        tex->release();
+
+        if (i == (unsigned int)currentPage)
+        {
+            memcpy(_currentPageData, pages[i].data(), _currentPageDataSize);
+        }
+        else if (_pageDataRetained)
+        {
+            auto pageData = new (std::nothrow) unsigned char[_currentPageDataSize];
+            memcpy(pageData, pages[i].data(), _currentPageDataSize);
+            _pagesData.push_back(pageData);
+        }
     }
-    _atlasTextures[_currentPage]->updateWithData(data, 0, startY, CacheTextureWidth, _currentPageOrigY - startY + _currLineHeight);
 
+    _currentPage = currentPage;
+    _currentPageOrigX = origX;
+    _currentPageOrigY = origY;
+    _currLineHeight = lineHeight;
+    _letterDefinitions.swap(letterDefinitions);
+    _savedLetterCount = _letterDefinitions.size();
     return true;
 }
 
 void FontAtlas::addTexture(Texture2D *texture, int slot)
 {
     texture->retain();
+    texture->setOwner("FontAtlas");
     _atlasTextures[slot] = texture;
 }
 
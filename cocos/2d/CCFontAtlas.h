@@ -30,6 +30,7 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "platform/CCPlatformMacros.h"
 #include "base/CCRef.h"
@@ -63,6 +64,8 @@ public:
     static const int CacheTextureHeight;
     static const char* CMD_PURGE_FONTATLAS;
     static const char* CMD_RESET_FONTATLAS;
+    /** Dispatched with the atlas as user data when the glyphs rasterized in the background were added. */
+    static const char* CMD_UPDATE_FONTATLAS;
     /**
      * @js ctor
      */
@@ -78,6 +81,17 @@ public:
 
     bool prepareLetterDefinitions(const std::u16string& utf16String);
 
+    /** Rasterizes the new glyphs of prepareLetterDefinitions() on the AsyncTaskPool instead of the main thread.
+     They are skipped by the layout until they are added to the pages on the main thread, which dispatches CMD_UPDATE_FONTATLAS.
+     The default is CC_FONT_ATLAS_ASYNC_RASTERIZATION.
+     @since v3.11
+     */
+    static void setAsyncRasterizationEnabled(bool enabled);
+    static bool isAsyncRasterizationEnabled();
+
+    /** Whether glyphs are being rasterized in the background. */
+    bool hasPendingLetters() const { return _pendingLetterCount > 0; }
+
     inline const std::unordered_map<ssize_t, Texture2D*>& getTextures() const{ return _atlasTextures;}
     void  addTexture(Texture2D *texture, int slot);
     float getLineHeight() const { return _lineHeight; }
@@ -108,11 +122,54 @@ public:
      */
      void setAliasTexParameters();
 
+    /** Keeps a copy of the filled pages, so saveToFile() can write them. The current page is always kept.
+     It must be set before the first page is filled. FontAtlasCache sets it when its glyph cache is enabled.
+     */
+    void setPageDataRetained(bool retained) { _pageDataRetained = retained; }
+    bool isPageDataRetained() const { return _pageDataRetained; }
+
+    /** Writes the pages and the letter definitions of a FreeType atlas to `filename`, a full path.
+     `signature` identifies the font, the size and the effects, initWithFile() only accepts the same one.
+     */
+    bool saveToFile(const std::string& filename, const std::string& signature);
+
+    /** Restores the pages and the letter definitions written by saveToFile(), without rasterizing them.
+     The atlas keeps growing on demand from the restored state. It is left as it was when the file doesn't match.
+     */
+    bool initWithFile(const std::string& filename, const std::string& signature);
+
+    /** Whether letters were added since the last saveToFile() or initWithFile(). */
+    bool hasUnsavedLetters() const { return _letterDefinitions.size() != _savedLetterCount; }
+
 protected:
     void reset();
 
     void releaseTextures();
 
+    void releasePagesData();
+
+    Texture2D* createPageTexture(const unsigned char* data);
+
+    // a glyph rendered to its own tile, see FontFreeType::renderGlyph()
+    struct RasterizedGlyph
+    {
+        char16_t utf16Char;
+        unsigned short charCode;
+        unsigned char* tile;
+        long tileWidth;
+        long tileHeight;
+        long bitmapHeight;
+        float rectX;
+        float rectY;
+        float rectWidth;
+        float rectHeight;
+        int xAdvance;
+    };
+
+    static void rasterizeGlyphs(FontFreeType* font, std::vector<RasterizedGlyph>& glyphs);
+    void addGlyphs(const std::vector<RasterizedGlyph>& glyphs);
+    void prepareLetterDefinitionsAsync(const std::unordered_map<unsigned short, unsigned short>& codeMapOfNewChar);
+
     void findNewCharacters(const std::u16string& u16Text, std::unordered_map<unsigned short, unsigned short>& charCodeMap);
 
     void conversionU16TOGB2312(const std::u16string& u16Text, std::unordered_map<unsigned short, unsigned short>& charCodeMap);
@@ -145,6 +202,17 @@ protected:
     bool _antialiasEnabled;
     int _currLineHeight;
 
+    // the copies of the filled pages, see setPageDataRetained()
+    std::vector<unsigned char*> _pagesData;
+    bool _pageDataRetained;
+    size_t _savedLetterCount;
+
+    // the letters rasterized in the background, and the reset() count that discards them
+    int _pendingLetterCount;
+    unsigned int _resetCount;
+
+    static bool s_isAsyncRasterizationEnabled;
+
     friend class Label;
 };
 
@@ -25,27 +25,40 @@
 #include "2d/CCFontAtlasCache.h"
 
 #include "base/CCDirector.h"
+#include "base/CCEventDispatcher.h"
+#include "base/CCAssetPack.h"
+#include "platform/CCFileUtils.h"
 #include "2d/CCFontFNT.h"
 #include "2d/CCFontFreeType.h"
 #include "2d/CCFontAtlas.h"
 #include "2d/CCFontCharMap.h"
 #include "2d/CCLabel.h"
+#include "2d/CCLabelLayoutCache.h"
 
 NS_CC_BEGIN
 
 std::unordered_map<std::string, FontAtlas *> FontAtlasCache::_atlasMap;
+std::unordered_map<std::string, std::string> FontAtlasCache::_atlasFiles;
+std::unordered_map<std::string, std::string> FontAtlasCache::_glyphCacheSignatures;
+bool FontAtlasCache::_glyphCacheEnabled = false;
+
+static const char* GLYPH_CACHE_DIRECTORY = "fontcache/";
 
 void FontAtlasCache::purgeCachedData()
 {
+    saveGlyphCaches();
     auto atlasMapCopy = _atlasMap;
     for (auto&& atlas : atlasMapCopy)
     {
         atlas.second->purgeTexturesAtlas();
     }
     _atlasMap.clear();
+    _atlasFiles.clear();
+    _glyphCacheSignatures.clear();
+    LabelLayoutCache::purge();
 }
 
-FontAtlas* FontAtlasCache::getFontAtlasTTF(const _ttfConfig* config)
+std::string FontAtlasCache::getAtlasNameTTF(const _ttfConfig* config)
 {
     bool useDistanceField = config->distanceFieldEnabled;
     if(config->outlineSize > 0)
@@ -54,25 +67,115 @@ FontAtlas* FontAtlasCache::getFontAtlasTTF(const _ttfConfig* config)
     }
 
     char tmp[300];
-    if (useDistanceField) {
-        sprintf(tmp, "%s distance field %f %d",config->fontFilePath.c_str(), config->fontSize, config->outlineSize);
+    if (config->msdfEnabled) {
+        // one atlas serves all the sizes and outlines
+        snprintf(tmp, sizeof(tmp), "%s msdf", config->fontFilePath.c_str());
+    } else if (useDistanceField) {
+        snprintf(tmp, sizeof(tmp), "%s distance field %f %d",config->fontFilePath.c_str(), config->fontSize, config->outlineSize);
     } else {
-        sprintf(tmp, "%s %f %d",config->fontFilePath.c_str(), config->fontSize, config->outlineSize);
+        snprintf(tmp, sizeof(tmp), "%s %f %d",config->fontFilePath.c_str(), config->fontSize, config->outlineSize);
+    }
+    return tmp;
+}
+
+std::string FontAtlasCache::getGlyphCacheFileName(const _ttfConfig* config)
+{
+    return getGlyphCacheFileName(getAtlasNameTTF(config));
+}
+
+std::string FontAtlasCache::getGlyphCacheFileName(const std::string& atlasName)
+{
+    char fileName[16];
+    snprintf(fileName, sizeof(fileName), "%08x.ccfa", AssetPack::hash(atlasName.c_str(), atlasName.length()));
+    return fileName;
+}
+
+void FontAtlasCache::saveGlyphCache(const std::string& atlasName, FontAtlas* atlas)
+{
+    auto it = _glyphCacheSignatures.find(atlasName);
+    if (it == _glyphCacheSignatures.end() || !atlas->hasUnsavedLetters() || atlas->hasPendingLetters())
+    {
+        return;
+    }
+
+    auto fileUtils = FileUtils::getInstance();
+    std::string directory = fileUtils->getWritablePath() + GLYPH_CACHE_DIRECTORY;
+    char fileName[16];
+    snprintf(fileName, sizeof(fileName), "%08x.ccfa", AssetPack::hash(atlasName.c_str(), atlasName.length()));
+    if (!fileUtils->createDirectory(directory) || !atlas->saveToFile(directory + fileName, it->second))
+    {
+        CCLOG("FontAtlasCache: can't write the glyph cache of %s", atlasName.c_str());
+    }
+}
+
+void FontAtlasCache::saveGlyphCaches()
+{
+    for (auto&& item : _atlasMap)
+    {
+        saveGlyphCache(item.first, item.second);
+    }
+}
+
+FontAtlas* FontAtlasCache::getFontAtlasTTF(const _ttfConfig* config)
+{
+    bool useDistanceField = config->distanceFieldEnabled;
+    if(config->outlineSize > 0)
+    {
+        useDistanceField = false;
     }
-    std::string atlasName = tmp;
+
+    std::string atlasName = getAtlasNameTTF(config);
 
     auto it = _atlasMap.find(atlasName);
 
     if ( it == _atlasMap.end() )
     {
-        auto font = FontFreeType::create(config->fontFilePath, config->fontSize, config->glyphs,
-            config->customGlyphs, useDistanceField, config->outlineSize);
+        FontFreeType* font = nullptr;
+        if (config->msdfEnabled)
+        {
+            font = FontFreeType::create(config->fontFilePath, FontFreeType::MSDFFontSize, config->glyphs,
+                config->customGlyphs, false, 0, true);
+        }
+        else
+        {
+            font = FontFreeType::create(config->fontFilePath, config->fontSize, config->glyphs,
+                config->customGlyphs, useDistanceField, config->outlineSize);
+        }
         if (font)
         {
-            auto tempAtlas = font->createFontAtlas();
+            FontAtlas* tempAtlas = nullptr;
+            if (_glyphCacheEnabled)
+            {
+                // a new font file or scale factor must not reuse the glyphs of the old one
+                auto fileUtils = FileUtils::getInstance();
+                char signature[64];
+                snprintf(signature, sizeof(signature), " %ld %f",
+                    fileUtils->getFileSize(fileUtils->fullPathForFilename(config->fontFilePath)), CC_CONTENT_SCALE_FACTOR());
+                std::string glyphCacheSignature = atlasName + signature;
+
+                std::string fileName = getGlyphCacheFileName(config);
+                std::string glyphCacheFile = fileUtils->getWritablePath() + GLYPH_CACHE_DIRECTORY + fileName;
+                if (!fileUtils->isFileExist(glyphCacheFile))
+                {
+                    // a pre-baked one, if the game ships it
+                    std::string bundledFile = GLYPH_CACHE_DIRECTORY + fileName;
+                    glyphCacheFile = fileUtils->isFileExist(bundledFile) ? fileUtils->fullPathForFilename(bundledFile) : "";
+                }
+
+                tempAtlas = font->createFontAtlas(glyphCacheFile, glyphCacheSignature);
+                if (tempAtlas)
+                {
+                    _glyphCacheSignatures[atlasName] = glyphCacheSignature;
+                }
+            }
+            else
+            {
+                tempAtlas = font->createFontAtlas();
+            }
             if (tempAtlas)
             {
                 _atlasMap[atlasName] = tempAtlas;
+                _atlasFiles[atlasName] = config->fontFilePath;
                 return _atlasMap[atlasName];
             }
         }
@@ -103,6 +206,7 @@ FontAtlas* FontAtlasCache::getFontAtlasFNT(const std::string& fontFileName, cons
             if (tempAtlas)
             {
                 _atlasMap[atlasName] = tempAtlas;
+                _atlasFiles[atlasName] = fontFileName;
                 return _atlasMap[atlasName];
             }
         }
@@ -204,6 +308,56 @@ FontAtlas* FontAtlasCache::getFontAtlasCharMap(const std::string& charMapFile, i
     return nullptr;
 }
 
+bool FontAtlasCache::reloadFontFile(const std::string& fontFile)
+{
+    auto fileUtils = FileUtils::getInstance();
+    const std::string fullPath = fileUtils->fullPathForFilename(fontFile);
+
+    std::vector<std::string> atlasNames;
+    for (auto&& item : _atlasFiles)
+    {
+        if (item.second == fontFile || fileUtils->fullPathForFilename(item.second) == fullPath)
+        {
+            atlasNames.push_back(item.first);
+        }
+    }
+
+    static unsigned int s_reloadCount = 0;
+    auto eventDispatcher = Director::DirectorInstance->getEventDispatcher();
+    for (auto&& atlasName : atlasNames)
+    {
+        FontAtlas* atlas = _atlasMap[atlasName];
+        FontFNT::removeCachedConfiguration(_atlasFiles[atlasName]);
+
+        // the glyphs of the old font must not be restored
+        _glyphCacheSignatures.erase(atlasName);
+        fileUtils->removeFile(fileUtils->getWritablePath() + GLYPH_CACHE_DIRECTORY + getGlyphCacheFileName(atlasName));
+
+        // moved aside until the labels release it, they get a new atlas under its name
+        char detachedName[32];
+        snprintf(detachedName, sizeof(detachedName), " reloaded %u", ++s_reloadCount);
+        _atlasMap.erase(atlasName);
+        _atlasFiles.erase(atlasName);
+        _atlasMap[atlasName + detachedName] = atlas;
+
+        atlas->retain();
+        eventDispatcher->dispatchCustomEvent(FontAtlas::CMD_PURGE_FONTATLAS, atlas);
+        if (atlas->getReferenceCount() > 1)
+        {
+            // the font data is shared by name, a new font would read the old one
+            CCLOG("FontAtlasCache: %s is still used, its labels keep the old font", atlasName.c_str());
+        }
+        releaseFontAtlas(atlas);
+        eventDispatcher->dispatchCustomEvent(FontAtlas::CMD_RESET_FONTATLAS, atlas);
+    }
+
+    if (!atlasNames.empty())
+    {
+        LabelLayoutCache::purge();
+    }
+    return !atlasNames.empty();
+}
+
 bool FontAtlasCache::releaseFontAtlas(FontAtlas *atlas)
 {
     if (nullptr != atlas)
@@ -214,6 +368,10 @@ bool FontAtlasCache::releaseFontAtlas(FontAtlas *atlas)
             {
                 if (atlas->getReferenceCount() == 1)
                 {
+                  saveGlyphCache(item.first, atlas);
+                  _glyphCacheSignatures.erase(item.first);
+                  LabelLayoutCache::removeLayoutsForFontAtlas(atlas);
+                  _atlasFiles.erase(item.first);
                   _atlasMap.erase(item.first);
                 }
 
@@ -54,8 +54,44 @@ public:
      */
     static void purgeCachedData();
 
+    /** Enables the glyph cache of the TTF atlases, false by default.
+     The glyphs of an atlas are written to the writable path when it's released, purged or by saveGlyphCaches(),
+     and restored the next time the atlas is created instead of being rasterized again.
+     A pre-baked file named getGlyphCacheFileName() found in "fontcache/" of the search paths is used when the writable path has none.
+     @since v3.11
+     */
+    static void setGlyphCacheEnabled(bool enabled) { _glyphCacheEnabled = enabled; }
+    static bool isGlyphCacheEnabled() { return _glyphCacheEnabled; }
+
+    /** Writes the glyphs added since the last save of the cached TTF atlases.
+     @since v3.11
+     */
+    static void saveGlyphCaches();
+
+    /** The name of the glyph cache file of a TTF config.
+     @since v3.11
+     */
+    static std::string getGlyphCacheFileName(const _ttfConfig* config);
+
+    /** Reloads the TTF and FNT atlases of a font file that changed. The atlases are replaced, the labels using them
+     get new ones read from the file, see FileWatcher.
+     @param fontFile The name or the full path of the font file.
+     @return Whether the file backs any atlas.
+     @since v3.11
+     */
+    static bool reloadFontFile(const std::string& fontFile);
+
 private:
+    static std::string getAtlasNameTTF(const _ttfConfig* config);
+    static std::string getGlyphCacheFileName(const std::string& atlasName);
+    static void saveGlyphCache(const std::string& atlasName, FontAtlas* atlas);
+
     static std::unordered_map<std::string, FontAtlas *> _atlasMap;
+    // the font file of the TTF and FNT atlases, by atlas name
+    static std::unordered_map<std::string, std::string> _atlasFiles;
+    // the signature of the glyph cache of the TTF atlases, by atlas name
+    static std::unordered_map<std::string, std::string> _glyphCacheSignatures;
+    static bool _glyphCacheEnabled;
 };
 
 NS_CC_END
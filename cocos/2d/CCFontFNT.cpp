@@ -24,8 +24,8 @@
  ****************************************************************************/
 
 #include "2d/CCFontFNT.h"
-#include <set>
-#include "base/uthash.h"
+#include <algorithm>
+#include <vector>
 #include "2d/CCFontAtlas.h"
 #include "platform/CCFileUtils.h"
 #include "base/CCConfiguration.h"
@@ -48,54 +48,75 @@ enum {
     kLabelAutomaticWidth = -1,
 };
 
-struct _FontDefHashElement;
-
 /**
 @struct BMFontDef
-BMFont definition
+BMFont definition, it's also the layout of the characters in the compact files, see FontFNT::saveCompactFile()
 */
 typedef struct _BMFontDef {
     //! ID of the character
-    unsigned int charID;
-    //! origin and size of the font
-    Rect rect;
+    uint32_t charID;
+    //! origin and size of the font (in pixels)
+    uint16_t x, y, width, height;
     //! The X amount the image should be offset when drawing the image (in pixels)
-    short xOffset;
+    int16_t xOffset;
     //! The Y amount the image should be offset when drawing the image (in pixels)
-    short yOffset;
+    int16_t yOffset;
     //! The amount to move the current position after drawing the character (in pixels)
-    short xAdvance;
+    int16_t xAdvance;
+    uint16_t reserved;
 } BMFontDef;
 
+static_assert(sizeof(BMFontDef) == 20, "the compact files depend on the layout of BMFontDef");
+
 /** @struct BMFontPadding
 BMFont padding
 @since v0.8.2
 */
 typedef struct _BMFontPadding {
-    /// padding left
-    int    left;
     /// padding top
-    int top;
+    int32_t top;
     /// padding right
-    int right;
+    int32_t right;
     /// padding bottom
-    int bottom;
+    int32_t bottom;
+    /// padding left
+    int32_t left;
 } BMFontPadding;
 
-typedef struct _FontDefHashElement
+// An entry of the kerning table, an open addressing hash table whose size is a power of two
+typedef struct _BMFontKerning {
+    uint32_t key;       // 16-bit for 1st element, 16-bit for 2nd element, KERNING_EMPTY_KEY for a free entry
+    int32_t amount;
+} BMFontKerning;
+
+static const uint32_t KERNING_EMPTY_KEY = 0xffffffff;
+
+// The header of the compact files, followed by the name of the atlas padded to 4 bytes, the characters sorted by ID
+// and the kerning table. They are read in place, little endian like all the targets.
+typedef struct _BMFontCompactHeader {
+    char magic[4];
+    uint32_t version;
+    int32_t fontSize;
+    int32_t commonHeight;
+    BMFontPadding padding;
+    uint32_t charCount;
+    uint32_t kerningCapacity;
+    uint32_t atlasNameLength;
+} BMFontCompactHeader;
+
+static const char COMPACT_MAGIC[4] = { 'C', 'F', 'N', 'T' };
+static const uint32_t COMPACT_VERSION = 1;
+
+static inline uint32_t kerningSlot(uint32_t key, uint32_t mask)
 {
-    unsigned int    key;        // key. Font Unicode value
-    BMFontDef       fontDef;    // font definition
-    UT_hash_handle  hh;
-} tFontDefHashElement;
+    uint32_t hash = key * 2654435761u;
+    return (hash ^ (hash >> 16)) & mask;
+}
 
-// Equal function for targetSet.
-typedef struct _KerningHashElement
+static inline uint32_t alignTo4(uint32_t size)
 {
-    int                key;        // key for the hash. 16-bit for 1st element, 16-bit for 2nd element
-    int                amount;
-    UT_hash_handle    hh;
-} tKerningHashElement;
+    return (size + 3) & ~3u;
+}
 
 /** @brief BMFontConfiguration has parsed configuration of the .fnt file
 @since v0.8
@@ -104,8 +125,9 @@ class CC_DLL BMFontConfiguration : public Ref
 {
     // FIXME: Creating a public interface so that the bitmapFontArray[] is accessible
 public://@public
-    // BMFont definitions
-    tFontDefHashElement *_fontDefDictionary;
+    // BMFont definitions, sorted by ID
+    const BMFontDef* _fontDefs;
+    size_t _fontDefCount;
 
     //! FNTConfig: Common Height Should be signed (issue #1343)
     int _commonHeight;
@@ -113,11 +135,12 @@ public://@public
     BMFontPadding    _padding;
     //! atlas name
     std::string _atlasName;
-    //! values for kerning
-    tKerningHashElement *_kerningDictionary;
+    //! the atlas name as written in the file, relative to it
+    std::string _atlasFile;
+    //! values for kerning, _kerningMask + 1 entries, null when there are none
+    const BMFontKerning* _kernings;
+    uint32_t _kerningMask;
 
-    // Character Set defines the letters that actually exist in the font
-    std::set<unsigned int> *_characterSet;
     //! Font Size
     int _fontSize;
 public:
@@ -145,17 +168,29 @@ public:
     inline const std::string& getAtlasName(){ return _atlasName; }
     inline void setAtlasName(const std::string& atlasName) { _atlasName = atlasName; }
 
-    std::set<unsigned int>* getCharacterSet() const;
+    const BMFontDef* getFontDef(uint32_t charID) const;
+    int getKerning(unsigned short first, unsigned short second) const;
+
+    /** Writes the configuration in the compact format. */
+    bool saveCompactFile(const std::string& path) const;
 private:
-    std::set<unsigned int>* parseConfigFile(const std::string& controlFile);
-    std::set<unsigned int>* parseBinaryConfigFile(unsigned char* pData, unsigned long size, const std::string& controlFile);
-    void parseCharacterDefinition(const char* line, BMFontDef *characterDefinition);
-    void parseInfoArguments(const char* line);
-    void parseCommonArguments(const char* line);
-    void parseImageFileName(const char* line, const std::string& fntFile);
-    void parseKerningEntry(const char* line);
-    void purgeKerningDictionary();
-    void purgeFontDefDictionary();
+    bool parseConfigFile(const std::string& controlFile);
+    bool parseTextConfigFile(const char* data, size_t size, const std::string& controlFile);
+    bool parseBinaryConfigFile(const unsigned char* pData, size_t size, const std::string& controlFile);
+    bool parseCompactConfigFile(FileView&& file, const std::string& controlFile);
+    void parseCharacterDefinition(const char* line, const char* end, BMFontDef *characterDefinition);
+    void parseInfoArguments(const char* line, const char* end);
+    void parseCommonArguments(const char* line, const char* end);
+    void parseImageFileName(const char* line, const char* end, const std::string& fntFile);
+    void parseKerningEntry(const char* line, const char* end);
+    // sorts the parsed characters and hashes the parsed kernings
+    void finishParsing();
+
+    // what the text and binary files are parsed into
+    std::vector<BMFontDef> _fontDefStorage;
+    std::vector<BMFontKerning> _kerningStorage;
+    // the mapped compact file, which _fontDefs and _kernings point into
+    FileView _compactFile;
 };
 
 //
@@ -185,6 +220,106 @@ BMFontConfiguration* FNTConfigLoadFile(const std::string& fntFile)
     return ret;
 }
 
+//
+// The key=value pairs of a line of a text .fnt file, read in place.
+//
+namespace {
+
+class FNTLineReader
+{
+public:
+    FNTLineReader(const char* begin, const char* end)
+    : _cursor(begin), _end(end), _key(nullptr), _keyLength(0), _value(nullptr), _valueEnd(nullptr)
+    {
+    }
+
+    // moves to the next pair, the words without a value like the tag of the line are skipped
+    bool next()
+    {
+        while (_cursor < _end)
+        {
+            while (_cursor < _end && (*_cursor == ' ' || *_cursor == '\t' || *_cursor == '\r'))
+                ++_cursor;
+            const char* key = _cursor;
+            while (_cursor < _end && *_cursor != '=' && *_cursor != ' ' && *_cursor != '\t' && *_cursor != '\r')
+                ++_cursor;
+            if (_cursor >= _end || *_cursor != '=')
+                continue;
+
+            _key = key;
+            _keyLength = _cursor - key;
+            ++_cursor;
+            if (_cursor < _end && *_cursor == '"')
+            {
+                _value = ++_cursor;
+                while (_cursor < _end && *_cursor != '"')
+                    ++_cursor;
+                _valueEnd = _cursor;
+                if (_cursor < _end)
+                    ++_cursor;
+            }
+            else
+            {
+                _value = _cursor;
+                while (_cursor < _end && *_cursor != ' ' && *_cursor != '\t' && *_cursor != '\r')
+                    ++_cursor;
+                _valueEnd = _cursor;
+            }
+            return true;
+        }
+        return false;
+    }
+
+    bool is(const char* key, size_t length) const
+    {
+        return _keyLength == length && memcmp(_key, key, length) == 0;
+    }
+
+    // the value as integers separated by commas, returns how many were read
+    int getInts(int* values, int count) const
+    {
+        const char* p = _value;
+        int read = 0;
+        while (read < count && p < _valueEnd)
+        {
+            bool negative = (*p == '-');
+            if (negative)
+                ++p;
+            int value = 0;
+            while (p < _valueEnd && *p >= '0' && *p <= '9')
+                value = value * 10 + (*p++ - '0');
+            values[read++] = negative ? -value : value;
+            // the fractional part of the old editors
+            while (p < _valueEnd && *p != ',')
+                ++p;
+            if (p < _valueEnd)
+                ++p;
+        }
+        return read;
+    }
+
+    int getInt() const
+    {
+        int value = 0;
+        getInts(&value, 1);
+        return value;
+    }
+
+    std::string getString() const { return std::string(_value, _valueEnd - _value); }
+
+private:
+    const char* _cursor;
+    const char* _end;
+    const char* _key;
+    size_t _keyLength;
+    const char* _value;
+    const char* _valueEnd;
+};
+
+}
+
+#define FNT_KEY(literal) literal, sizeof(literal) - 1
+
 //
 //BitmapFontConfiguration
 //
@@ -203,196 +338,217 @@ BMFontConfiguration * BMFontConfiguration::create(const std::string& FNTfile)
 
 bool BMFontConfiguration::initWithFNTfile(const std::string& FNTfile)
 {
-    _kerningDictionary = nullptr;
-    _fontDefDictionary = nullptr;
-
-    _characterSet = this->parseConfigFile(FNTfile);
-
-    if (! _characterSet)
-    {
-        return false;
-    }
-
-    return true;
-}
-
-std::set<unsigned int>* BMFontConfiguration::getCharacterSet() const
-{
-    return _characterSet;
+    return parseConfigFile(FNTfile);
 }
 
 BMFontConfiguration::BMFontConfiguration()
-: _fontDefDictionary(nullptr)
+: _fontDefs(nullptr)
+, _fontDefCount(0)
 , _commonHeight(0)
-, _kerningDictionary(nullptr)
-, _characterSet(nullptr)
+, _kernings(nullptr)
+, _kerningMask(0)
 , _fontSize(0)
 {
-
+    memset(&_padding, 0, sizeof(_padding));
 }
 
 BMFontConfiguration::~BMFontConfiguration()
 {
     CCLOGINFO( "deallocing BMFontConfiguration: %p", this );
-    this->purgeFontDefDictionary();
-    this->purgeKerningDictionary();
-    _atlasName.clear();
-    CC_SAFE_DELETE(_characterSet);
 }
 
 std::string BMFontConfiguration::description() const
 {
+    size_t kerningCount = 0;
+    if (_kernings)
+    {
+        for (uint32_t i = 0; i <= _kerningMask; ++i)
+        {
+            if (_kernings[i].key != KERNING_EMPTY_KEY)
+                ++kerningCount;
+        }
+    }
     return StringUtils::format(
         "<BMFontConfiguration = " CC_FORMAT_PRINTF_SIZE_T " | Glphys:%d Kernings:%d | Image = %s>",
         (size_t)this,
-        HASH_COUNT(_fontDefDictionary),
-        HASH_COUNT(_kerningDictionary),
+        (int)_fontDefCount,
+        (int)kerningCount,
         _atlasName.c_str()
     );
 }
 
-void BMFontConfiguration::purgeKerningDictionary()
+const BMFontDef* BMFontConfiguration::getFontDef(uint32_t charID) const
+{
+    auto end = _fontDefs + _fontDefCount;
+    auto it = std::lower_bound(_fontDefs, end, charID, [](const BMFontDef& def, uint32_t id) {
+        return def.charID < id;
+    });
+    return (it != end && it->charID == charID) ? it : nullptr;
+}
+
+int BMFontConfiguration::getKerning(unsigned short first, unsigned short second) const
 {
-    tKerningHashElement *current;
-    while(_kerningDictionary)
+    if (!_kernings)
+        return 0;
+
+    uint32_t key = ((uint32_t)first << 16) | second;
+    for (uint32_t slot = kerningSlot(key, _kerningMask); ; slot = (slot + 1) & _kerningMask)
     {
-        current = _kerningDictionary;
-        HASH_DEL(_kerningDictionary,current);
-        free(current);
+        const BMFontKerning& entry = _kernings[slot];
+        if (entry.key == key)
+            return entry.amount;
+        if (entry.key == KERNING_EMPTY_KEY)
+            return 0;
     }
 }
 
-void BMFontConfiguration::purgeFontDefDictionary()
+void BMFontConfiguration::finishParsing()
 {
-    tFontDefHashElement *current, *tmp;
+    // the last definition of a character wins
+    std::stable_sort(_fontDefStorage.begin(), _fontDefStorage.end(), [](const BMFontDef& a, const BMFontDef& b) {
+        return a.charID < b.charID;
+    });
+    auto last = std::unique(_fontDefStorage.rbegin(), _fontDefStorage.rend(), [](const BMFontDef& a, const BMFontDef& b) {
+        return a.charID == b.charID;
+    });
+    _fontDefStorage.erase(_fontDefStorage.begin(), last.base());
+    _fontDefs = _fontDefStorage.data();
+    _fontDefCount = _fontDefStorage.size();
+
+    // the parsed pairs are in _kerningStorage, they are hashed into a table at most half full
+    std::vector<BMFontKerning> pairs;
+    pairs.swap(_kerningStorage);
+    if (pairs.empty())
+    {
+        _kernings = nullptr;
+        _kerningMask = 0;
+        return;
+    }
 
-    HASH_ITER(hh, _fontDefDictionary, current, tmp) {
-        HASH_DEL(_fontDefDictionary, current);
-        free(current);
+    uint32_t capacity = 4;
+    while (capacity < pairs.size() * 2)
+        capacity <<= 1;
+    BMFontKerning empty = { KERNING_EMPTY_KEY, 0 };
+    _kerningStorage.assign(capacity, empty);
+    _kerningMask = capacity - 1;
+    for (auto& pair : pairs)
+    {
+        uint32_t slot = kerningSlot(pair.key, _kerningMask);
+        while (_kerningStorage[slot].key != KERNING_EMPTY_KEY && _kerningStorage[slot].key != pair.key)
+            slot = (slot + 1) & _kerningMask;
+        _kerningStorage[slot] = pair;
     }
+    _kernings = _kerningStorage.data();
 }
 
-std::set<unsigned int>* BMFontConfiguration::parseConfigFile(const std::string& controlFile)
+bool BMFontConfiguration::parseConfigFile(const std::string& controlFile)
 {
-    Data data = FileUtils::getInstance()->getDataFromFile(controlFile);
+    FileView data = FileUtils::getInstance()->getFileView(controlFile);
     CCASSERT((!data.isNull()), "BMFontConfiguration::parseConfigFile | Open file error.");
     if (data.isNull()) {
-        return nullptr;
+        return false;
+    }
+
+    if (data.getSize() >= (ssize_t)sizeof(BMFontCompactHeader) && memcmp(COMPACT_MAGIC, data.getBytes(), 4) == 0) {
+        return parseCompactConfigFile(std::move(data), controlFile);
     }
 
-    if (memcmp("BMF", data.getBytes(), 3) == 0) {
+    if (data.getSize() >= 4 && memcmp("BMF", data.getBytes(), 3) == 0) {
         // Handle fnt file of binary format
-        std::set<unsigned int>* ret = parseBinaryConfigFile(data.getBytes(), data.getSize(), controlFile);
-        return ret;
+        return parseBinaryConfigFile(data.getBytes(), data.getSize(), controlFile);
     }
 
-    if (data.getBytes()[0] == 0)
+    if (data.getSize() == 0 || data.getBytes()[0] == 0)
     {
         CCLOG("cocos2d: Error parsing FNTfile %s", controlFile.c_str());
-        return nullptr;
+        return false;
     }
 
-    // Handle fnt file of string format, allocate one extra byte '\0' at the end since c string needs it.
-    // 'strchr' finds a char until it gets a '\0', if 'contents' self doesn't end with '\0',
-    // 'strchr' will search '\n' out of 'contents' 's buffer size, it will trigger potential and random crashes since
-    // lineLength may bigger than 512 and 'memcpy(line, contents + parseCount, lineLength);' will cause stack buffer overflow.
-    // Please note that 'contents' needs to be freed before this function returns.
-    auto contents = (char*)malloc(data.getSize() + 1);
-    if (contents == nullptr)
-    {
-        CCLOGERROR("BMFontConfiguration::parseConfigFile, out of memory!");
-        return nullptr;
-    }
-    memcpy(contents, data.getBytes(), data.getSize());
-    // Ensure the last byte is '\0'
-    contents[data.getSize()] = '\0';
-    auto contentsLen = strlen(contents);
-
-    std::set<unsigned int> *validCharsString = new (std::nothrow) std::set<unsigned int>();
-    char line[300];
-    auto next = strchr(contents, '\n');
-    auto base = contents;
-    int lineLength = 0;
-    int parseCount = 0;
-    while (next)
-    {
-        lineLength = ((int)(next - base));
-        memcpy(line, contents + parseCount, lineLength);
-        line[lineLength] = 0;
+    return parseTextConfigFile((const char*)data.getBytes(), data.getSize(), controlFile);
+}
 
-        parseCount += lineLength + 1;
-        if (parseCount < contentsLen)
-        {
-            base = next + 1;
-            next = strchr(base, '\n');
-        }
-        else
-        {
-            next = nullptr;
-        }
+bool BMFontConfiguration::parseTextConfigFile(const char* data, size_t size, const std::string& controlFile)
+{
+    // the lines are parsed in place, they aren't null terminated
+    const char* end = data + size;
+    const char* line = data;
+    while (line < end)
+    {
+        const char* lineEnd = (const char*)memchr(line, '\n', end - line);
+        if (!lineEnd)
+            lineEnd = end;
+        size_t lineLength = lineEnd - line;
 
-        if (memcmp(line, "info face", 9) == 0)
+        if (lineLength >= 9 && memcmp(line, "info face", 9) == 0)
         {
             // FIXME: info parsing is incomplete
             // Not needed for the Hiero editors, but needed for the AngelCode editor
-            //            [self parseInfoArguments:line];
-            this->parseInfoArguments(line);
+            this->parseInfoArguments(line, lineEnd);
         }
         // Check to see if the start of the line is something we are interested in
-        else if (memcmp(line, "common lineHeight", 17) == 0)
+        else if (lineLength >= 17 && memcmp(line, "common lineHeight", 17) == 0)
         {
-            this->parseCommonArguments(line);
+            this->parseCommonArguments(line, lineEnd);
         }
-        else if (memcmp(line, "page id", 7) == 0)
+        else if (lineLength >= 7 && memcmp(line, "page id", 7) == 0)
         {
-            this->parseImageFileName(line, controlFile);
+            this->parseImageFileName(line, lineEnd, controlFile);
         }
-        else if (memcmp(line, "chars c", 7) == 0)
+        else if (lineLength >= 7 && memcmp(line, "chars c", 7) == 0)
         {
-            // Ignore this line
+            // the number of characters
+            FNTLineReader reader(line, lineEnd);
+            while (reader.next())
+            {
+                if (reader.is(FNT_KEY("count")) && reader.getInt() > 0)
+                    _fontDefStorage.reserve(reader.getInt());
+            }
         }
-        else if (memcmp(line, "char", 4) == 0)
+        else if (lineLength >= 5 && memcmp(line, "char ", 5) == 0)
         {
             // Parse the current line and create a new CharDef
-            tFontDefHashElement* element = (tFontDefHashElement*)malloc( sizeof(*element) );
-            this->parseCharacterDefinition(line, &element->fontDef);
-
-            element->key = element->fontDef.charID;
-            HASH_ADD_INT(_fontDefDictionary, key, element);
-
-            validCharsString->insert(element->fontDef.charID);
+            BMFontDef fontDef;
+            this->parseCharacterDefinition(line, lineEnd, &fontDef);
+            _fontDefStorage.push_back(fontDef);
         }
-        else if (memcmp(line, "kerning first", 13) == 0)
+        else if (lineLength >= 13 && memcmp(line, "kerning first", 13) == 0)
         {
-            this->parseKerningEntry(line);
+            this->parseKerningEntry(line, lineEnd);
         }
-    }
 
-    free(contents);
+        line = lineEnd + 1;
+    }
 
-    return validCharsString;
+    finishParsing();
+    return true;
 }
 
-std::set<unsigned int>* BMFontConfiguration::parseBinaryConfigFile(unsigned char* pData, unsigned long size, const std::string& controlFile)
+bool BMFontConfiguration::parseBinaryConfigFile(const unsigned char* pData, size_t size, const std::string& controlFile)
 {
     /* based on http://www.angelcode.com/products/bmfont/doc/file_format.html file format */
 
-    set<unsigned int> *validCharsString = new (std::nothrow) set<unsigned int>();
-
-    unsigned long remains = size;
-
-    CCASSERT(pData[3] == 3, "Only version 3 is supported");
+    if (pData[3] != 3)
+    {
+        CCLOG("cocos2d: Error parsing FNTfile %s, only version 3 of the binary format is supported", controlFile.c_str());
+        return false;
+    }
 
-    pData += 4; remains -= 4;
+    const unsigned char* end = pData + size;
+    pData += 4;
 
-    while (remains > 0)
+    while (end - pData >= 5)
     {
-        unsigned char blockId = pData[0]; pData += 1; remains -= 1;
+        unsigned char blockId = pData[0]; pData += 1;
         uint32_t blockSize = 0; memcpy(&blockSize, pData, 4);
+        pData += 4;
 
-        pData += 4; remains -= 4;
+        if (blockSize > (size_t)(end - pData))
+        {
+            CCLOG("cocos2d: Error parsing FNTfile %s, truncated block %d", controlFile.c_str(), (int)blockId);
+            return false;
+        }
 
-        if (blockId == 1)
+        if (blockId == 1 && blockSize >= 11)
         {
             /*
              fontSize       2   int      0
@@ -410,13 +566,15 @@ std::set<unsigned int>* BMFontConfiguration::parseBinaryConfigFile(unsigned char
              fontName       n+1 string   14 null terminated string with length n
              */
 
-            memcpy(&_fontSize, pData, 2);
+            // negative when it matches the height of the characters rather than of the cells
+            int16_t fontSize = 0; memcpy(&fontSize, pData, 2);
+            _fontSize = std::abs(fontSize);
             _padding.top = (unsigned char)pData[7];
             _padding.right = (unsigned char)pData[8];
             _padding.bottom = (unsigned char)pData[9];
             _padding.left = (unsigned char)pData[10];
         }
-        else if (blockId == 2)
+        else if (blockId == 2 && blockSize >= 10)
         {
             /*
              lineHeight 2   uint    0
@@ -449,9 +607,11 @@ std::set<unsigned int>* BMFontConfiguration::parseBinaryConfigFile(unsigned char
              */
 
             const char *value = (const char *)pData;
-            CCASSERT(strlen(value) < blockSize, "Block size should be less then string");
+            size_t length = strnlen(value, blockSize);
+            CCASSERT(length < blockSize, "Block size should be less then string");
 
-            _atlasName = FileUtils::getInstance()->fullPathFromRelativeFile(value, controlFile);
+            _atlasFile.assign(value, length);
+            _atlasName = FileUtils::getInstance()->fullPathFromRelativeFile(_atlasFile, controlFile);
         }
         else if (blockId == 4)
         {
@@ -468,40 +628,14 @@ std::set<unsigned int>* BMFontConfiguration::parseBinaryConfigFile(unsigned char
              chnl       1   uint    19+c*20
              */
 
-            unsigned long count = blockSize / 20;
-
-            for (unsigned long i = 0; i < count; i++)
+            // the same layout as BMFontDef, with the page and channel in the reserved field
+            size_t count = blockSize / 20;
+            size_t first = _fontDefStorage.size();
+            _fontDefStorage.resize(first + count);
+            memcpy(&_fontDefStorage[first], pData, count * 20);
+            for (size_t i = first; i < first + count; i++)
             {
-                tFontDefHashElement* element = (tFontDefHashElement*)malloc( sizeof(*element) );
-
-                uint32_t charId = 0; memcpy(&charId, pData + (i * 20), 4);
-                element->fontDef.charID = charId;
-
-                uint16_t charX = 0; memcpy(&charX, pData + (i * 20) + 4, 2);
-                element->fontDef.rect.origin.x = charX;
-
-                uint16_t charY = 0; memcpy(&charY, pData + (i * 20) + 6, 2);
-                element->fontDef.rect.origin.y = charY;
-
-                uint16_t charWidth = 0; memcpy(&charWidth, pData + (i * 20) + 8, 2);
-                element->fontDef.rect.size.width = charWidth;
-
-                uint16_t charHeight = 0; memcpy(&charHeight, pData + (i * 20) + 10, 2);
-                element->fontDef.rect.size.height = charHeight;
-
-                int16_t xoffset = 0; memcpy(&xoffset, pData + (i * 20) + 12, 2);
-                element->fontDef.xOffset = xoffset;
-
-                int16_t yoffset = 0; memcpy(&yoffset, pData + (i * 20) + 14, 2);
-                element->fontDef.yOffset = yoffset;
-
-                int16_t xadvance = 0; memcpy(&xadvance, pData + (i * 20) + 16, 2);
-                element->fontDef.xAdvance = xadvance;
-
-                element->key = element->fontDef.charID;
-                HASH_ADD_INT(_fontDefDictionary, key, element);
-
-                validCharsString->insert(element->fontDef.charID);
+                _fontDefStorage[i].reserved = 0;
             }
         }
         else if (blockId == 5) {
@@ -511,145 +645,238 @@ std::set<unsigned int>* BMFontConfiguration::parseBinaryConfigFile(unsigned char
              amount 2   int     8+c*10
              */
 
-            unsigned long count = blockSize / 20;
+            size_t count = blockSize / 10;
+            _kerningStorage.reserve(_kerningStorage.size() + count);
 
-            for (unsigned long i = 0; i < count; i++)
+            for (size_t i = 0; i < count; i++)
             {
                 uint32_t first = 0; memcpy(&first, pData + (i * 10), 4);
                 uint32_t second = 0; memcpy(&second, pData + (i * 10) + 4, 4);
                 int16_t amount = 0; memcpy(&amount, pData + (i * 10) + 8, 2);
 
-                tKerningHashElement *element = (tKerningHashElement *)calloc( sizeof( *element ), 1 );
-                element->amount = amount;
-                element->key = (first<<16) | (second&0xffff);
-                HASH_ADD_INT(_kerningDictionary,key, element);
+                BMFontKerning kerning = { (first << 16) | (second & 0xffff), amount };
+                _kerningStorage.push_back(kerning);
             }
         }
 
-        pData += blockSize; remains -= blockSize;
+        pData += blockSize;
     }
 
-    return validCharsString;
+    finishParsing();
+    return true;
 }
 
-void BMFontConfiguration::parseImageFileName(const char* line, const std::string& fntFile)
+bool BMFontConfiguration::parseCompactConfigFile(FileView&& file, const std::string& controlFile)
+{
+    BMFontCompactHeader header;
+    memcpy(&header, file.getBytes(), sizeof(header));
+    size_t size = file.getSize();
+
+    size_t nameOffset = sizeof(header);
+    size_t charsOffset = nameOffset + alignTo4(header.atlasNameLength);
+    size_t kerningsOffset = charsOffset + (size_t)header.charCount * sizeof(BMFontDef);
+    size_t totalSize = kerningsOffset + (size_t)header.kerningCapacity * sizeof(BMFontKerning);
+    bool validCapacity = (header.kerningCapacity & (header.kerningCapacity - 1)) == 0;
+    if (header.version != COMPACT_VERSION || totalSize > size || !validCapacity)
+    {
+        CCLOG("cocos2d: Error parsing FNTfile %s, invalid compact file", controlFile.c_str());
+        return false;
+    }
+
+    _fontSize = header.fontSize;
+    _commonHeight = header.commonHeight;
+    _padding = header.padding;
+    _atlasFile.assign((const char*)file.getBytes() + nameOffset, header.atlasNameLength);
+    _atlasName = FileUtils::getInstance()->fullPathFromRelativeFile(_atlasFile, controlFile);
+
+    const unsigned char* chars = file.getBytes() + charsOffset;
+    const unsigned char* kernings = file.getBytes() + kerningsOffset;
+    _fontDefCount = header.charCount;
+    _kerningMask = header.kerningCapacity ? header.kerningCapacity - 1 : 0;
+
+    if (((uintptr_t)file.getBytes() & 3) == 0)
+    {
+        // the tables are used where they are mapped
+        _fontDefs = (const BMFontDef*)chars;
+        _kernings = header.kerningCapacity ? (const BMFontKerning*)kernings : nullptr;
+        _compactFile = std::move(file);
+    }
+    else
+    {
+        _fontDefStorage.resize(header.charCount);
+        memcpy(_fontDefStorage.data(), chars, header.charCount * sizeof(BMFontDef));
+        _kerningStorage.resize(header.kerningCapacity);
+        memcpy(_kerningStorage.data(), kernings, header.kerningCapacity * sizeof(BMFontKerning));
+        _fontDefs = _fontDefStorage.data();
+        _kernings = header.kerningCapacity ? _kerningStorage.data() : nullptr;
+    }
+    return true;
+}
+
+bool BMFontConfiguration::saveCompactFile(const std::string& path) const
+{
+    BMFontCompactHeader header;
+    memcpy(header.magic, COMPACT_MAGIC, 4);
+    header.version = COMPACT_VERSION;
+    header.fontSize = _fontSize;
+    header.commonHeight = _commonHeight;
+    header.padding = _padding;
+    header.charCount = (uint32_t)_fontDefCount;
+    header.kerningCapacity = _kernings ? _kerningMask + 1 : 0;
+    header.atlasNameLength = (uint32_t)_atlasFile.size();
+
+    size_t charsOffset = sizeof(header) + alignTo4(header.atlasNameLength);
+    size_t kerningsOffset = charsOffset + _fontDefCount * sizeof(BMFontDef);
+    size_t size = kerningsOffset + header.kerningCapacity * sizeof(BMFontKerning);
+
+    unsigned char* bytes = (unsigned char*)calloc(size, 1);
+    if (!bytes)
+        return false;
+    memcpy(bytes, &header, sizeof(header));
+    memcpy(bytes + sizeof(header), _atlasFile.data(), _atlasFile.size());
+    if (_fontDefCount)
+        memcpy(bytes + charsOffset, _fontDefs, _fontDefCount * sizeof(BMFontDef));
+    if (header.kerningCapacity)
+        memcpy(bytes + kerningsOffset, _kernings, header.kerningCapacity * sizeof(BMFontKerning));
+
+    Data data;
+    data.fastSet(bytes, size);
+    return FileUtils::getInstance()->writeDataToFile(data, path);
+}
+
+void BMFontConfiguration::parseImageFileName(const char* line, const char* end, const std::string& fntFile)
 {
     //////////////////////////////////////////////////////////////////////////
     // line to parse:
     // page id=0 file="bitmapFontTest.png"
     //////////////////////////////////////////////////////////////////////////
 
-    // page ID. Sanity check
-    int pageId;
-    sscanf(line, "page id=%d", &pageId);
-    CCASSERT(pageId == 0, "LabelBMFont file could not be found");
-    // file
-    char fileName[255];
-    sscanf(strchr(line,'"') + 1, "%[^\"]", fileName);
-    _atlasName = FileUtils::getInstance()->fullPathFromRelativeFile(fileName, fntFile);
+    FNTLineReader reader(line, end);
+    while (reader.next())
+    {
+        if (reader.is(FNT_KEY("id")))
+        {
+            // page ID. Sanity check
+            CCASSERT(reader.getInt() == 0, "LabelBMFont file could not be found");
+        }
+        else if (reader.is(FNT_KEY("file")))
+        {
+            _atlasFile = reader.getString();
+            _atlasName = FileUtils::getInstance()->fullPathFromRelativeFile(_atlasFile, fntFile);
+        }
+    }
 }
 
-void BMFontConfiguration::parseInfoArguments(const char* line)
+void BMFontConfiguration::parseInfoArguments(const char* line, const char* end)
 {
     //////////////////////////////////////////////////////////////////////////
     // possible lines to parse:
     // info face="Script" size=32 bold=0 italic=0 charset="" unicode=1 stretchH=100 smooth=1 aa=1 padding=1,4,3,2 spacing=0,0 outline=0
     // info face="Cracked" size=36 bold=0 italic=0 charset="" unicode=0 stretchH=100 smooth=1 aa=1 padding=0,0,0,0 spacing=1,1
     //////////////////////////////////////////////////////////////////////////
-    sscanf(strstr(line, "size=") + 5, "%d", &_fontSize);
-    // padding
-    sscanf(strstr(line,"padding=") + 8, "%d,%d,%d,%d", &_padding.top, &_padding.right, &_padding.bottom, &_padding.left);
-    //CCLOG("cocos2d: padding: %d,%d,%d,%d", _padding.left, _padding.top, _padding.right, _padding.bottom);
+    FNTLineReader reader(line, end);
+    while (reader.next())
+    {
+        if (reader.is(FNT_KEY("size")))
+        {
+            _fontSize = reader.getInt();
+        }
+        else if (reader.is(FNT_KEY("padding")))
+        {
+            int padding[4] = { 0, 0, 0, 0 };
+            reader.getInts(padding, 4);
+            _padding.top = padding[0];
+            _padding.right = padding[1];
+            _padding.bottom = padding[2];
+            _padding.left = padding[3];
+        }
+    }
 }
 
-void BMFontConfiguration::parseCommonArguments(const char* line)
+void BMFontConfiguration::parseCommonArguments(const char* line, const char* end)
 {
     //////////////////////////////////////////////////////////////////////////
     // line to parse:
     // common lineHeight=104 base=26 scaleW=1024 scaleH=512 pages=1 packed=0
     //////////////////////////////////////////////////////////////////////////
 
-    // Height
-    auto tmp = strstr(line, "lineHeight=") + 11;
-    sscanf(tmp, "%d", &_commonHeight);
-
+    FNTLineReader reader(line, end);
+    while (reader.next())
+    {
+        // Height
+        if (reader.is(FNT_KEY("lineHeight")))
+        {
+            _commonHeight = reader.getInt();
+        }
 #if COCOS2D_DEBUG > 0
-    // scaleW. sanity check
-    int value;
-    tmp = strstr(tmp, "scaleW=") + 7;
-    sscanf(tmp, "%d", &value);
-
-    int maxTextureSize = Configuration::getInstance()->getMaxTextureSize();
-    CCASSERT(value <= maxTextureSize, "CCLabelBMFont: page can't be larger than supported");
-
-    // scaleH. sanity check
-    tmp = strstr(tmp, "scaleH=") + 7;
-    sscanf(tmp, "%d", &value);
-    CCASSERT(value <= maxTextureSize, "CCLabelBMFont: page can't be larger than supported");
-
-    // pages. sanity check
-    tmp = strstr(tmp, "pages=") + 6;
-    sscanf(tmp, "%d", &value);
-    CCASSERT(value == 1, "CCBitfontAtlas: only supports 1 page");
+        // scaleW and scaleH. sanity check
+        else if (reader.is(FNT_KEY("scaleW")) || reader.is(FNT_KEY("scaleH")))
+        {
+            int maxTextureSize = Configuration::getInstance()->getMaxTextureSize();
+            CCASSERT(reader.getInt() <= maxTextureSize, "CCLabelBMFont: page can't be larger than supported");
+        }
+        // pages. sanity check
+        else if (reader.is(FNT_KEY("pages")))
+        {
+            CCASSERT(reader.getInt() == 1, "CCBitfontAtlas: only supports 1 page");
+        }
 #endif
-    // packed (ignore) What does this mean ??
+        // packed (ignore) What does this mean ??
+    }
 }
 
-void BMFontConfiguration::parseCharacterDefinition(const char* line, BMFontDef *characterDefinition)
+void BMFontConfiguration::parseCharacterDefinition(const char* line, const char* end, BMFontDef *characterDefinition)
 {
     //////////////////////////////////////////////////////////////////////////
     // line to parse:
     // char id=32   x=0     y=0     width=0     height=0     xoffset=0     yoffset=44    xadvance=14     page=0  chnl=0
     //////////////////////////////////////////////////////////////////////////
 
-    // Character ID
-    auto tmp = strstr(line, "id=") + 3;
-    sscanf(tmp, "%u", &characterDefinition->charID);
-
-    // Character x
-    tmp = strstr(tmp, "x=") + 2;
-    sscanf(tmp, "%f", &characterDefinition->rect.origin.x);
-    // Character y
-    tmp = strstr(tmp, "y=") + 2;
-    sscanf(tmp, "%f", &characterDefinition->rect.origin.y);
-    // Character width
-    tmp = strstr(tmp, "width=") + 6;
-    sscanf(tmp, "%f", &characterDefinition->rect.size.width);
-    // Character height
-    tmp = strstr(tmp, "height=") + 7;
-    sscanf(tmp, "%f", &characterDefinition->rect.size.height);
-    // Character xoffset
-    tmp = strstr(tmp, "xoffset=") + 8;
-    sscanf(tmp, "%hd", &characterDefinition->xOffset);
-    // Character yoffset
-    tmp = strstr(tmp, "yoffset=") + 8;
-    sscanf(tmp, "%hd", &characterDefinition->yOffset);
-    // Character xadvance
-    tmp = strstr(tmp, "xadvance=") + 9;
-    sscanf(tmp, "%hd", &characterDefinition->xAdvance);
-}
-
-void BMFontConfiguration::parseKerningEntry(const char* line)
+    memset(characterDefinition, 0, sizeof(*characterDefinition));
+
+    FNTLineReader reader(line, end);
+    while (reader.next())
+    {
+        if (reader.is(FNT_KEY("id")))
+            characterDefinition->charID = (uint32_t)reader.getInt();
+        else if (reader.is(FNT_KEY("x")))
+            characterDefinition->x = (uint16_t)reader.getInt();
+        else if (reader.is(FNT_KEY("y")))
+            characterDefinition->y = (uint16_t)reader.getInt();
+        else if (reader.is(FNT_KEY("width")))
+            characterDefinition->width = (uint16_t)reader.getInt();
+        else if (reader.is(FNT_KEY("height")))
+            characterDefinition->height = (uint16_t)reader.getInt();
+        else if (reader.is(FNT_KEY("xoffset")))
+            characterDefinition->xOffset = (int16_t)reader.getInt();
+        else if (reader.is(FNT_KEY("yoffset")))
+            characterDefinition->yOffset = (int16_t)reader.getInt();
+        else if (reader.is(FNT_KEY("xadvance")))
+            characterDefinition->xAdvance = (int16_t)reader.getInt();
+    }
+}
+
+void BMFontConfiguration::parseKerningEntry(const char* line, const char* end)
 {
     //////////////////////////////////////////////////////////////////////////
     // line to parse:
     // kerning first=121  second=44  amount=-7
     //////////////////////////////////////////////////////////////////////////
 
-    int first, second, amount;
-    auto tmp = strstr(line, "first=") + 6;
-    sscanf(tmp, "%d", &first);
-
-    tmp = strstr(tmp, "second=") + 7;
-    sscanf(tmp, "%d", &second);
-
-    tmp = strstr(tmp, "amount=") + 7;
-    sscanf(tmp, "%d", &amount);
+    int first = 0, second = 0, amount = 0;
+    FNTLineReader reader(line, end);
+    while (reader.next())
+    {
+        if (reader.is(FNT_KEY("first")))
+            first = reader.getInt();
+        else if (reader.is(FNT_KEY("second")))
+            second = reader.getInt();
+        else if (reader.is(FNT_KEY("amount")))
+            amount = reader.getInt();
+    }
 
-    tKerningHashElement *element = (tKerningHashElement *)calloc( sizeof( *element ), 1 );
-    element->amount = amount;
-    element->key = (first<<16) | (second&0xffff);
-    HASH_ADD_INT(_kerningDictionary,key, element);
+    BMFontKerning kerning = { ((uint32_t)first << 16) | ((uint32_t)second & 0xffff), amount };
+    _kerningStorage.push_back(kerning);
 }
 
 FontFNT * FontFNT::create(const std::string& fntFilePath, const Vec2& imageOffset /* = Vec2::ZERO */)
@@ -696,6 +923,20 @@ void FontFNT::purgeCachedData()
     }
 }
 
+bool FontFNT::saveCompactFile(const std::string& fntFilePath, const std::string& outputPath)
+{
+    BMFontConfiguration *configuration = FNTConfigLoadFile(fntFilePath);
+    return configuration && configuration->saveCompactFile(outputPath);
+}
+
+void FontFNT::removeCachedConfiguration(const std::string& fntFilePath)
+{
+    if (s_configurations)
+    {
+        s_configurations->erase(fntFilePath);
+    }
+}
+
 int * FontFNT::getHorizontalKerningForTextUTF16(const std::u16string& text, int &outNumLetters) const
 {
     outNumLetters = static_cast<int>(text.length());
@@ -720,19 +961,7 @@ int * FontFNT::getHorizontalKerningForTextUTF16(const std::u16string& text, int
 
 int  FontFNT::getHorizontalKerningForChars(unsigned short firstChar, unsigned short secondChar) const
 {
-    int ret = 0;
-    unsigned int key = (firstChar << 16) | (secondChar & 0xffff);
-
-    if (_configuration->_kerningDictionary)
-    {
-        tKerningHashElement *element = nullptr;
-        HASH_FIND_INT(_configuration->_kerningDictionary, &key, element);
-
-        if (element)
-            ret = element->amount;
-    }
-
-    return ret;
+    return _configuration->getKerning(firstChar, secondChar);
 }
 
 void FontFNT::setFontSize(float fontSize)
@@ -748,10 +977,7 @@ int FontFNT::getOriginalFontSize()const
 FontAtlas * FontFNT::createFontAtlas()
 {
     // check that everything is fine with the BMFontCofniguration
-    if (!_configuration->_fontDefDictionary)
-        return nullptr;
-
-    size_t numGlyphs = _configuration->_characterSet->size();
+    size_t numGlyphs = _configuration->_fontDefCount;
     if (numGlyphs == 0)
         return nullptr;
 
@@ -774,18 +1000,12 @@ FontAtlas * FontFNT::createFontAtlas()
 
     tempAtlas->setLineHeight(originalLineHeight * factor);
 
-    BMFontDef fontDef;
-    tFontDefHashElement *currentElement, *tmp;
-    // Purge uniform hash
-    HASH_ITER(hh, _configuration->_fontDefDictionary, currentElement, tmp)
+    for (size_t i = 0; i < numGlyphs; ++i)
     {
-
+        const BMFontDef& fontDef = _configuration->_fontDefs[i];
         FontLetterDefinition tempDefinition;
 
-        fontDef = currentElement->fontDef;
-        Rect tempRect;
-
-        tempRect = fontDef.rect;
+        Rect tempRect(fontDef.x, fontDef.y, fontDef.width, fontDef.height);
         tempRect = CC_RECT_PIXELS_TO_POINTS(tempRect);
 
         tempDefinition.offsetX  = fontDef.xOffset;
@@ -44,6 +44,17 @@ public:
     Removes from memory the cached configurations and the atlas name dictionary.
     */
     static void purgeCachedData();
+    /** Removes the cached configuration of a file, the next fonts of the file read it again.
+     @since v3.11
+     */
+    static void removeCachedConfiguration(const std::string& fntFilePath);
+    /** Writes the configuration of a text or binary .fnt file in the compact format, returns false when it can't.
+     The compact files are read in place, without parsing: the characters are sorted by ID for a binary search and the
+     kernings are a hash table. They are found by their content, so they can replace the .fnt files under any name.
+     Run it when the assets are built, the format depends on the version of the engine.
+     @since v3.11
+     */
+    static bool saveCompactFile(const std::string& fntFilePath, const std::string& outputPath);
     virtual int* getHorizontalKerningForTextUTF16(const std::u16string& text, int &outNumLetters) const override;
     virtual FontAtlas *createFontAtlas() override;
     void setFontSize(float fontSize);
@@ -25,8 +25,10 @@ THE SOFTWARE.
 
 #include "2d/CCFontFreeType.h"
 #include FT_BBOX_H
+#include FT_OUTLINE_H
 #include "edtaa3func/edtaa3func.h"
 #include "CCFontAtlas.h"
+#include "2d/CCFontMSDF.h"
 #include "base/CCDirector.h"
 #include "base/ccUTF8.h"
 #include "platform/CCFileUtils.h"
@@ -37,21 +39,23 @@ NS_CC_BEGIN
 FT_Library FontFreeType::_FTlibrary;
 bool       FontFreeType::_FTInitialized = false;
 const int  FontFreeType::DistanceMapSpread = 3;
+const int  FontFreeType::MSDFFontSize = 32;
+const int  FontFreeType::MSDFSpread = 4;
 
 const char* FontFreeType::_glyphASCII = "\"!#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~¡¢£¤¥¦§¨©ª«¬­®¯°±²³´µ¶·¸¹º»¼½¾¿ÀÁÂÃÄÅÆÇÈÉÊËÌÍÎÏÐÑÒÓÔÕÖ×ØÙÚÛÜÝÞßàáâãäåæçèéêëìíîïðñòóôõö÷øùúûüýþ ";
 const char* FontFreeType::_glyphNEHE = "!\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~ ";
 
 typedef struct _DataRef
 {
-    Data data;
+    FileView data;
     unsigned int referenceCount;
 }DataRef;
 
 static std::unordered_map<std::string, DataRef> s_cacheFontData;
 
-FontFreeType * FontFreeType::create(const std::string &fontName, float fontSize, GlyphCollection glyphs, const char *customGlyphs,bool distanceFieldEnabled /* = false */,int outline /* = 0 */)
+FontFreeType * FontFreeType::create(const std::string &fontName, float fontSize, GlyphCollection glyphs, const char *customGlyphs,bool distanceFieldEnabled /* = false */,int outline /* = 0 */, bool msdfEnabled /* = false */)
 {
-    FontFreeType *tempFont =  new FontFreeType(distanceFieldEnabled,outline);
+    FontFreeType *tempFont =  new FontFreeType(distanceFieldEnabled,outline,msdfEnabled);
 
     if (!tempFont)
         return nullptr;
@@ -96,10 +100,11 @@ FT_Library FontFreeType::getFTLibrary()
     return _FTlibrary;
 }
 
-FontFreeType::FontFreeType(bool distanceFieldEnabled /* = false */,int outline /* = 0 */)
+FontFreeType::FontFreeType(bool distanceFieldEnabled /* = false */,int outline /* = 0 */, bool msdfEnabled /* = false */)
 : _fontRef(nullptr)
 , _stroker(nullptr)
 , _distanceFieldEnabled(distanceFieldEnabled)
+, _msdfEnabled(msdfEnabled)
 , _outlineSize(0.0f)
 , _lineHeight(0)
 , _fontAtlas(nullptr)
@@ -132,7 +137,8 @@ bool FontFreeType::createFontObject(const std::string &fontName, float fontSize)
     else
     {
         s_cacheFontData[fontName].referenceCount = 1;
-        s_cacheFontData[fontName].data = FileUtils::getInstance()->getDataFromFile(fontName);
+        // the face reads the font for as long as it lives, a mapping keeps it out of the heap
+        s_cacheFontData[fontName].data = FileUtils::getInstance()->getFileView(fontName);
 
         if (s_cacheFontData[fontName].data.isNull())
         {
@@ -221,6 +227,32 @@ FontAtlas * FontFreeType::createFontAtlas()
     return _fontAtlas;
 }
 
+FontAtlas * FontFreeType::createFontAtlas(const std::string& glyphCacheFile, const std::string& signature)
+{
+    if (_fontAtlas == nullptr)
+    {
+        _fontAtlas = new (std::nothrow) FontAtlas(*this);
+        if (_fontAtlas)
+        {
+            _fontAtlas->setPageDataRetained(true);
+            if (!glyphCacheFile.empty())
+            {
+                _fontAtlas->initWithFile(glyphCacheFile, signature);
+            }
+
+            // the letters restored from the file are skipped
+            std::u16string utf16;
+            if (_usedGlyphs != GlyphCollection::DYNAMIC && StringUtils::UTF8ToUTF16(getGlyphCollection(), utf16))
+            {
+                _fontAtlas->prepareLetterDefinitions(utf16);
+            }
+        }
+        this->release();
+    }
+
+    return _fontAtlas;
+}
+
 int * FontFreeType::getHorizontalKerningForTextUTF16(const std::u16string& text, int &outNumLetters) const
 {
     if (!_fontRef)
@@ -239,6 +271,7 @@ int * FontFreeType::getHorizontalKerningForTextUTF16(const std::u16string& text,
     bool hasKerning = FT_HAS_KERNING( _fontRef ) != 0;
     if (hasKerning)
     {
+        std::lock_guard<std::mutex> lock(_faceMutex);
         for (int c = 1; c < outNumLetters; ++c)
         {
             sizes[c] = getHorizontalKerningForChars(text[c-1], text[c]);
@@ -405,6 +438,103 @@ unsigned char* FontFreeType::getGlyphBitmap(unsigned short theChar, long &outWid
     }
 }
 
+unsigned char* FontFreeType::renderGlyph(unsigned short theChar, long &outWidth, long &outHeight, Rect &outRect, int &xAdvance,
+    long &outTileWidth, long &outTileHeight)
+{
+    if (_msdfEnabled)
+    {
+        return renderMSDFGlyph(theChar, outWidth, outHeight, outRect, xAdvance, outTileWidth, outTileHeight);
+    }
+
+    std::unique_lock<std::mutex> lock(_faceMutex);
+    auto bitmap = getGlyphBitmap(theChar, outWidth, outHeight, outRect, xAdvance);
+    bool rendersOutline = !_distanceFieldEnabled && _outlineSize > 0;
+    if (bitmap == nullptr || outWidth <= 0 || outHeight <= 0)
+    {
+        // an outline glyph is a new[] blend image
+        if (_outlineSize > 0)
+        {
+            delete [] bitmap;
+        }
+        return nullptr;
+    }
+    if (_outlineSize <= 0)
+    {
+        // it's in the glyph slot of the face, which the next load overwrites
+        auto copyBitmap = new (std::nothrow) unsigned char[outWidth * outHeight];
+        memcpy(copyBitmap, bitmap, outWidth * outHeight);
+        bitmap = copyBitmap;
+    }
+    lock.unlock();
+
+    int bytesPerPixel = rendersOutline ? 2 : 1;
+    int spread = _distanceFieldEnabled ? 2 * DistanceMapSpread : 0;
+    outTileWidth = outWidth + spread;
+    outTileHeight = outHeight + spread;
+    auto tile = new (std::nothrow) unsigned char[outTileWidth * outTileHeight * bytesPerPixel];
+
+    // the outline bitmap is deleted by renderCharAt()
+    renderCharAt(tile, 0, 0, bitmap, outWidth, outHeight, outTileWidth);
+    if (!rendersOutline)
+    {
+        delete [] bitmap;
+    }
+    return tile;
+}
+
+unsigned char* FontFreeType::renderMSDFGlyph(unsigned short theChar, long &outWidth, long &outHeight, Rect &outRect, int &xAdvance,
+    long &outTileWidth, long &outTileHeight)
+{
+    outWidth = outHeight = 0;
+    outRect.size.width = outRect.size.height = 0;
+    xAdvance = 0;
+
+    // the outline is copied, the field is computed without the face
+    FT_Outline outline;
+    {
+        std::lock_guard<std::mutex> lock(_faceMutex);
+        if (_fontRef == nullptr || FT_Load_Char(_fontRef, theChar, FT_LOAD_NO_BITMAP | FT_LOAD_NO_HINTING)
+            || _fontRef->glyph->format != FT_GLYPH_FORMAT_OUTLINE)
+        {
+            return nullptr;
+        }
+
+        xAdvance = (static_cast<int>(_fontRef->glyph->metrics.horiAdvance >> 6));
+        auto& glyphOutline = _fontRef->glyph->outline;
+        if (glyphOutline.n_points == 0
+            || FT_Outline_New(getFTLibrary(), glyphOutline.n_points, glyphOutline.n_contours, &outline))
+        {
+            return nullptr;
+        }
+        FT_Outline_Copy(&glyphOutline, &outline);
+    }
+
+    FT_BBox bbox;
+    FT_Outline_Get_CBox(&outline, &bbox);
+    long xMin = bbox.xMin >> 6;
+    long yMin = bbox.yMin >> 6;
+    long xMax = (bbox.xMax + 63) >> 6;
+    long yMax = (bbox.yMax + 63) >> 6;
+
+    unsigned char* tile = nullptr;
+    if (xMax > xMin && yMax > yMin)
+    {
+        outRect.origin.x = xMin;
+        outRect.origin.y = -yMax;
+        outRect.size.width = outWidth = xMax - xMin;
+        outRect.size.height = outHeight = yMax - yMin;
+
+        outTileWidth = outWidth + 2 * MSDFSpread;
+        outTileHeight = outHeight + 2 * MSDFSpread;
+        tile = new (std::nothrow) unsigned char[outTileWidth * outTileHeight * 3];
+        msdf::renderOutline(&outline, (int)outTileWidth, (int)outTileHeight,
+            (float)(xMin - MSDFSpread), (float)(yMax + MSDFSpread), (float)MSDFSpread, tile);
+    }
+
+    FT_Outline_Done(getFTLibrary(), &outline);
+    return tile;
+}
+
 unsigned char * FontFreeType::getGlyphBitmapWithOutline(unsigned short theChar, FT_BBox &bbox)
 {
     unsigned char* ret = nullptr;
@@ -532,6 +662,11 @@ unsigned char * makeDistanceMap( unsigned char *img, long width, long height)
 }
 
 void FontFreeType::renderCharAt(unsigned char *dest,int posX, int posY, unsigned char* bitmap,long bitmapWidth,long bitmapHeight)
+{
+    renderCharAt(dest, posX, posY, bitmap, bitmapWidth, bitmapHeight, FontAtlas::CacheTextureWidth);
+}
+
+void FontFreeType::renderCharAt(unsigned char *dest,int posX, int posY, unsigned char* bitmap,long bitmapWidth,long bitmapHeight, long destWidth)
 {
     int iX = posX;
     int iY = posY;
@@ -557,7 +692,7 @@ void FontFreeType::renderCharAt(unsigned char *dest,int posX, int posY, unsigned
                 dest[index + 2] = out[index2 + 2];*/
 
                 //Single channel 8-bit output
-                dest[iX + ( iY * FontAtlas::CacheTextureWidth )] = distanceMap[bitmap_y + x];
+                dest[iX + ( iY * destWidth )] = distanceMap[bitmap_y + x];
 
                 iX += 1;
             }
@@ -577,9 +712,9 @@ void FontFreeType::renderCharAt(unsigned char *dest,int posX, int posY, unsigned
             for (int x = 0; x < bitmapWidth; ++x)
             {
                 tempChar = bitmap[(bitmap_y + x) * 2];
-                dest[(iX + ( iY * FontAtlas::CacheTextureWidth ) ) * 2] = tempChar;
+                dest[(iX + ( iY * destWidth ) ) * 2] = tempChar;
                 tempChar = bitmap[(bitmap_y + x) * 2 + 1];
-                dest[(iX + ( iY * FontAtlas::CacheTextureWidth ) ) * 2 + 1] = tempChar;
+                dest[(iX + ( iY * destWidth ) ) * 2 + 1] = tempChar;
 
                 iX += 1;
             }
@@ -600,7 +735,7 @@ void FontFreeType::renderCharAt(unsigned char *dest,int posX, int posY, unsigned
                 unsigned char cTemp = bitmap[bitmap_y + x];
 
                 // the final pixel
-                dest[(iX + ( iY * FontAtlas::CacheTextureWidth ) )] = cTemp;
+                dest[(iX + ( iY * destWidth ) )] = cTemp;
 
                 iX += 1;
             }
@@ -31,6 +31,7 @@
 #include "CCFont.h"
 
 #include <string>
+#include <mutex>
 #include "freetype/ft2build.h"
 
 #include "freetype/freetype.h"
@@ -42,17 +43,27 @@ class CC_DLL FontFreeType : public Font
 {
 public:
     static const int DistanceMapSpread;
+    /** The size the glyphs of the multi-channel distance field fonts are rasterized at, and their distance range each side of the edges, in pixels.
+     @since v3.11
+     */
+    static const int MSDFFontSize;
+    static const int MSDFSpread;
 
     static FontFreeType* create(const std::string &fontName, float fontSize, GlyphCollection glyphs,
-        const char *customGlyphs,bool distanceFieldEnabled = false,int outline = 0);
+        const char *customGlyphs,bool distanceFieldEnabled = false,int outline = 0, bool msdfEnabled = false);
 
     static void shutdownFreeType();
 
     bool isDistanceFieldEnabled() const { return _distanceFieldEnabled;}
 
+    /** Whether the glyphs are multi-channel signed distance fields, in RGB888 pages. */
+    bool isMSDFEnabled() const { return _msdfEnabled; }
+
     float getOutlineSize() const { return _outlineSize; }
 
     void renderCharAt(unsigned char *dest,int posX, int posY, unsigned char* bitmap,long bitmapWidth,long bitmapHeight);
+    /** renderCharAt() to a destination of `destWidth` pixels per row. */
+    void renderCharAt(unsigned char *dest,int posX, int posY, unsigned char* bitmap,long bitmapWidth,long bitmapHeight, long destWidth);
 
     FT_Encoding getEncoding() const { return _encoding; }
 
@@ -60,11 +71,24 @@ public:
 
     unsigned char* getGlyphBitmap(unsigned short theChar, long &outWidth, long &outHeight, Rect &outRect,int &xAdvance);
 
+    /** Renders a glyph like getGlyphBitmap() and renderCharAt() to a new[] buffer of `outTileWidth` x `outTileHeight` pixels,
+     in the pixel format of the atlas pages. It can be called from another thread, the face is locked while it's used.
+     @since v3.11
+     */
+    unsigned char* renderGlyph(unsigned short theChar, long &outWidth, long &outHeight, Rect &outRect, int &xAdvance,
+        long &outTileWidth, long &outTileHeight);
+
     int getFontAscender() const;
 
     const char* getFontFamily() const;
 
     virtual FontAtlas* createFontAtlas() override;
+
+    /** Creates the atlas with its page data retained, restoring the glyphs saved in `glyphCacheFile` by FontAtlas::saveToFile().
+     Only the glyphs of the collection missing from the file are rasterized, the others still come on demand.
+     @since v3.11
+     */
+    FontAtlas* createFontAtlas(const std::string& glyphCacheFile, const std::string& signature);
     virtual int getFontMaxHeight() const override { return _lineHeight; }
 private:
     static const char* _glyphASCII;
@@ -72,7 +96,7 @@ private:
     static FT_Library _FTlibrary;
     static bool _FTInitialized;
 
-    FontFreeType(bool distanceFieldEnabled = false, int outline = 0);
+    FontFreeType(bool distanceFieldEnabled = false, int outline = 0, bool msdfEnabled = false);
     virtual ~FontFreeType();
 
     bool createFontObject(const std::string &fontName, float fontSize);
@@ -82,6 +106,8 @@ private:
 
     int getHorizontalKerningForChars(unsigned short firstChar, unsigned short secondChar) const;
     unsigned char* getGlyphBitmapWithOutline(unsigned short code, FT_BBox &bbox);
+    unsigned char* renderMSDFGlyph(unsigned short theChar, long &outWidth, long &outHeight, Rect &outRect, int &xAdvance,
+        long &outTileWidth, long &outTileHeight);
 
     void setGlyphCollection(GlyphCollection glyphs, const char* customGlyphs = nullptr);
     const char* getGlyphCollection() const;
@@ -92,12 +118,16 @@ private:
 
     std::string _fontName;
     bool _distanceFieldEnabled;
+    bool _msdfEnabled;
     float _outlineSize;
     int _lineHeight;
     FontAtlas* _fontAtlas;
 
     GlyphCollection _usedGlyphs;
     std::string _customGlyphs;
+
+    // guards the face between renderGlyph() and the kerning of the main thread
+    mutable std::mutex _faceMutex;
 };
 
 /// @endcond
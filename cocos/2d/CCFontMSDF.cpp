@@ -0,0 +1,590 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "2d/CCFontMSDF.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "freetype/ftoutln.h"
+#include "math/Vec2.h"
+
+NS_CC_BEGIN
+
+namespace msdf
+{
+    namespace
+    {
+        // the channels of an edge
+        enum EdgeColor
+        {
+            BLACK = 0,
+            RED = 1,
+            GREEN = 2,
+            YELLOW = 3,
+            BLUE = 4,
+            MAGENTA = 5,
+            CYAN = 6,
+            WHITE = 7
+        };
+
+        // two edges meet at a corner when the angle between them is sharper than this, its sine
+        const float CORNER_CROSS_THRESHOLD = 0.14112f; // sinf(3.0f)
+
+        // the largest length in pixels of the segments a curve is flattened to
+        const float FLATTEN_SEGMENT_LENGTH = 2.0f;
+        const int FLATTEN_MAX_SEGMENTS = 16;
+
+        // a line, or a quadratic or cubic Bézier curve
+        struct Edge
+        {
+            int degree;
+            Vec2 p[4];
+            int color;
+
+            Vec2 point(float t) const
+            {
+                Vec2 q[4];
+                for (int i = 0; i <= degree; ++i)
+                {
+                    q[i] = p[i];
+                }
+                for (int k = degree; k > 0; --k)
+                {
+                    for (int i = 0; i < k; ++i)
+                    {
+                        q[i] = q[i].lerp(q[i + 1], t);
+                    }
+                }
+                return q[0];
+            }
+
+            // the tangent at the start or the end, skipping the control points that coincide
+            Vec2 startDirection() const
+            {
+                for (int i = 1; i <= degree; ++i)
+                {
+                    if (p[i] != p[0])
+                    {
+                        return p[i] - p[0];
+                    }
+                }
+                return Vec2::ZERO;
+            }
+
+            Vec2 endDirection() const
+            {
+                for (int i = degree - 1; i >= 0; --i)
+                {
+                    if (p[i] != p[degree])
+                    {
+                        return p[degree] - p[i];
+                    }
+                }
+                return Vec2::ZERO;
+            }
+
+            // de Casteljau
+            void splitAt(float t, Edge& first, Edge& second) const
+            {
+                Vec2 q[4];
+                for (int i = 0; i <= degree; ++i)
+                {
+                    q[i] = p[i];
+                }
+                first.degree = second.degree = degree;
+                first.color = second.color = color;
+                for (int k = 0; k <= degree; ++k)
+                {
+                    first.p[k] = q[0];
+                    second.p[degree - k] = q[degree - k];
+                    for (int i = 0; i < degree - k; ++i)
+                    {
+                        q[i] = q[i].lerp(q[i + 1], t);
+                    }
+                }
+            }
+
+            void splitInThirds(Edge parts[3]) const
+            {
+                Edge rest;
+                splitAt(1.0f / 3, parts[0], rest);
+                rest.splitAt(0.5f, parts[1], parts[2]);
+            }
+        };
+
+        typedef std::vector<Edge> Contour;
+
+        // the edges are flattened to segments before the distances are computed
+        struct Segment
+        {
+            Vec2 a;
+            Vec2 b;
+            Vec2 direction;
+            float length;
+            int color;
+            // the segment starts or ends an edge, its pseudo-distance extends past that end
+            bool startsEdge;
+            bool endsEdge;
+        };
+
+        struct OutlineBuilder
+        {
+            std::vector<Contour> contours;
+            Vec2 position;
+
+            void addEdge(int degree, const Vec2& p1, const Vec2& p2, const Vec2& p3)
+            {
+                Edge edge;
+                edge.degree = degree;
+                edge.p[0] = position;
+                edge.p[1] = p1;
+                edge.p[2] = p2;
+                edge.p[3] = p3;
+                edge.color = WHITE;
+                position = edge.p[degree];
+                if (!contours.empty() && position != edge.p[0])
+                {
+                    contours.back().push_back(edge);
+                }
+            }
+        };
+
+        inline Vec2 toVec2(const FT_Vector* v)
+        {
+            return Vec2(v->x / 64.0f, v->y / 64.0f);
+        }
+
+        int moveTo(const FT_Vector* to, void* user)
+        {
+            auto builder = static_cast<OutlineBuilder*>(user);
+            builder->contours.push_back(Contour());
+            builder->position = toVec2(to);
+            return 0;
+        }
+
+        int lineTo(const FT_Vector* to, void* user)
+        {
+            static_cast<OutlineBuilder*>(user)->addEdge(1, toVec2(to), Vec2::ZERO, Vec2::ZERO);
+            return 0;
+        }
+
+        int conicTo(const FT_Vector* control, const FT_Vector* to, void* user)
+        {
+            static_cast<OutlineBuilder*>(user)->addEdge(2, toVec2(control), toVec2(to), Vec2::ZERO);
+            return 0;
+        }
+
+        int cubicTo(const FT_Vector* control1, const FT_Vector* control2, const FT_Vector* to, void* user)
+        {
+            static_cast<OutlineBuilder*>(user)->addEdge(3, toVec2(control1), toVec2(control2), toVec2(to));
+            return 0;
+        }
+
+        bool isCorner(Vec2 a, Vec2 b)
+        {
+            a.normalize();
+            b.normalize();
+            return a.dot(b) <= 0 || fabsf(a.cross(b)) > CORNER_CROSS_THRESHOLD;
+        }
+
+        // the next of the cyan, magenta and yellow colors, never `banned`
+        void switchColor(int& color, unsigned int& seed, int banned = BLACK)
+        {
+            int combined = color & banned;
+            if (combined == RED || combined == GREEN || combined == BLUE)
+            {
+                color = combined ^ WHITE;
+                return;
+            }
+            if (color == BLACK || color == WHITE)
+            {
+                static const int start[3] = { CYAN, MAGENTA, YELLOW };
+                color = start[seed % 3];
+                seed /= 3;
+                return;
+            }
+            int shifted = color << (1 + (seed & 1));
+            color = (shifted | (shifted >> 3)) & WHITE;
+            seed >>= 1;
+        }
+
+        int symmetricalTrichotomy(int position, int n)
+        {
+            return (int)(3 + 2.875f * position / (n - 1) - 1.4375f + 0.5f) - 3;
+        }
+
+        // colors the edges so that the two edges of a corner never share more than one channel
+        void colorEdges(std::vector<Contour>& contours)
+        {
+            unsigned int seed = 0;
+            for (auto& contour : contours)
+            {
+                if (contour.empty())
+                {
+                    continue;
+                }
+
+                std::vector<int> corners;
+                Vec2 previousDirection = contour.back().endDirection();
+                for (int i = 0; i < (int)contour.size(); ++i)
+                {
+                    if (isCorner(previousDirection, contour[i].startDirection()))
+                    {
+                        corners.push_back(i);
+                    }
+                    previousDirection = contour[i].endDirection();
+                }
+
+                if (corners.empty())
+                {
+                    // smooth, all the channels agree
+                    for (auto& edge : contour)
+                    {
+                        edge.color = WHITE;
+                    }
+                }
+                else if (corners.size() == 1)
+                {
+                    // a teardrop, it's split in three colors around the corner
+                    int colors[3] = { WHITE, WHITE, WHITE };
+                    switchColor(colors[0], seed);
+                    colors[2] = colors[0];
+                    switchColor(colors[2], seed);
+
+                    int corner = corners[0];
+                    int edgeCount = (int)contour.size();
+                    if (edgeCount >= 3)
+                    {
+                        for (int i = 0; i < edgeCount; ++i)
+                        {
+                            contour[(corner + i) % edgeCount].color = colors[1 + symmetricalTrichotomy(i, edgeCount)];
+                        }
+                    }
+                    else
+                    {
+                        // too few edges for three colors, they are split in thirds
+                        Edge parts[6];
+                        contour[0].splitInThirds(parts + 3 * corner);
+                        if (edgeCount >= 2)
+                        {
+                            contour[1].splitInThirds(parts + 3 - 3 * corner);
+                            parts[0].color = parts[1].color = colors[0];
+                            parts[2].color = parts[3].color = colors[1];
+                            parts[4].color = parts[5].color = colors[2];
+                        }
+                        else
+                        {
+                            parts[0].color = colors[0];
+                            parts[1].color = colors[1];
+                            parts[2].color = colors[2];
+                        }
+                        contour.assign(parts, parts + 3 * edgeCount);
+                    }
+                }
+                else
+                {
+                    // the color changes at every corner, and the last spline differs from the first
+                    int cornerCount = (int)corners.size();
+                    int spline = 0;
+                    int start = corners[0];
+                    int edgeCount = (int)contour.size();
+                    int color = WHITE;
+                    switchColor(color, seed);
+                    int initialColor = color;
+                    for (int i = 0; i < edgeCount; ++i)
+                    {
+                        int index = (start + i) % edgeCount;
+                        if (spline + 1 < cornerCount && corners[spline + 1] == index)
+                        {
+                            ++spline;
+                            switchColor(color, seed, spline == cornerCount - 1 ? initialColor : BLACK);
+                        }
+                        contour[index].color = color;
+                    }
+                }
+            }
+        }
+
+        void addSegment(std::vector<Segment>& segments, const Vec2& a, const Vec2& b, int color, bool startsEdge, bool endsEdge)
+        {
+            Segment segment;
+            segment.a = a;
+            segment.b = b;
+            segment.direction = b - a;
+            segment.length = segment.direction.length();
+            if (segment.length <= 0)
+            {
+                return;
+            }
+            segment.direction = segment.direction / segment.length;
+            segment.color = color;
+            segment.startsEdge = startsEdge;
+            segment.endsEdge = endsEdge;
+            segments.push_back(segment);
+        }
+
+        void flattenEdges(const std::vector<Contour>& contours, std::vector<Segment>& segments)
+        {
+            for (auto& contour : contours)
+            {
+                for (auto& edge : contour)
+                {
+                    int count = 1;
+                    if (edge.degree > 1)
+                    {
+                        float length = 0;
+                        for (int i = 0; i < edge.degree; ++i)
+                        {
+                            length += edge.p[i].distance(edge.p[i + 1]);
+                        }
+                        count = std::max(2, std::min(FLATTEN_MAX_SEGMENTS, (int)ceilf(length / FLATTEN_SEGMENT_LENGTH)));
+                    }
+
+                    Vec2 a = edge.p[0];
+                    for (int i = 1; i <= count; ++i)
+                    {
+                        Vec2 b = i == count ? edge.p[edge.degree] : edge.point((float)i / count);
+                        addSegment(segments, a, b, edge.color, i == 1, i == count);
+                        a = b;
+                    }
+                }
+            }
+        }
+
+        // the distance to the nearest segment of a channel, the sign is negative on the left of the segment
+        struct SignedDistance
+        {
+            float distance;
+            // the orthogonality of the nearest segment breaks the ties at the shared end points
+            float dot;
+            const Segment* segment;
+            float param;
+
+            bool isCloserThan(const SignedDistance& other) const
+            {
+                float a = fabsf(distance);
+                float b = fabsf(other.distance);
+                return a < b || (a == b && dot < other.dot);
+            }
+        };
+
+        // the distance to the line of the segment, when the point is past an end of an edge
+        float pseudoDistance(const SignedDistance& nearest, const Vec2& point)
+        {
+            auto segment = nearest.segment;
+            if (nearest.param < 0 && segment->startsEdge)
+            {
+                Vec2 aq = point - segment->a;
+                if (aq.dot(segment->direction) < 0)
+                {
+                    float pseudo = aq.cross(segment->direction);
+                    if (fabsf(pseudo) <= fabsf(nearest.distance))
+                    {
+                        return pseudo;
+                    }
+                }
+            }
+            else if (nearest.param > 1 && segment->endsEdge)
+            {
+                Vec2 bq = point - segment->b;
+                if (bq.dot(segment->direction) > 0)
+                {
+                    float pseudo = bq.cross(segment->direction);
+                    if (fabsf(pseudo) <= fabsf(nearest.distance))
+                    {
+                        return pseudo;
+                    }
+                }
+            }
+            return nearest.distance;
+        }
+
+        inline float median(float a, float b, float c)
+        {
+            return std::max(std::min(a, b), std::min(std::max(a, b), c));
+        }
+
+        // two neighbours clash when the two channels that cross the edge between them don't change smoothly
+        bool pixelClash(const float* a, const float* b, float threshold)
+        {
+            int aInside = (a[0] > 0.5f) + (a[1] > 0.5f) + (a[2] > 0.5f);
+            int bInside = (b[0] > 0.5f) + (b[1] > 0.5f) + (b[2] > 0.5f);
+            if ((aInside >= 2) != (bInside >= 2))
+            {
+                return false;
+            }
+            // all three channels on the same side isn't a clash either
+            if (aInside == 0 || aInside == 3 || bInside == 0 || bInside == 3)
+            {
+                return false;
+            }
+
+            int changing[3];
+            int changingCount = 0;
+            int remaining = -1;
+            for (int i = 0; i < 3; ++i)
+            {
+                if ((a[i] > 0.5f) != (b[i] > 0.5f) && (a[i] < 0.5f) != (b[i] < 0.5f))
+                {
+                    changing[changingCount++] = i;
+                }
+                else
+                {
+                    remaining = i;
+                }
+            }
+            if (changingCount != 2 || remaining < 0)
+            {
+                return false;
+            }
+
+            // only the one of the pair farther from the edge is flagged
+            return fabsf(a[changing[0]] - b[changing[0]]) >= threshold && fabsf(a[changing[1]] - b[changing[1]]) >= threshold
+                && fabsf(a[remaining] - 0.5f) >= fabsf(b[remaining] - 0.5f);
+        }
+
+        void correctErrors(std::vector<float>& field, int width, int height, float threshold)
+        {
+            std::vector<int> clashes;
+            for (int y = 0; y < height; ++y)
+            {
+                for (int x = 0; x < width; ++x)
+                {
+                    const float* pixel = &field[(y * width + x) * 3];
+                    if ((x > 0 && pixelClash(pixel, pixel - 3, threshold))
+                        || (x < width - 1 && pixelClash(pixel, pixel + 3, threshold))
+                        || (y > 0 && pixelClash(pixel, pixel - width * 3, threshold))
+                        || (y < height - 1 && pixelClash(pixel, pixel + width * 3, threshold)))
+                    {
+                        clashes.push_back(y * width + x);
+                    }
+                }
+            }
+            for (auto index : clashes)
+            {
+                float* pixel = &field[index * 3];
+                pixel[0] = pixel[1] = pixel[2] = median(pixel[0], pixel[1], pixel[2]);
+            }
+        }
+    }
+
+    void renderOutline(const FT_Outline* outline, int width, int height, float left, float top, float range, unsigned char* out)
+    {
+        OutlineBuilder builder;
+        FT_Outline_Funcs funcs;
+        funcs.move_to = moveTo;
+        funcs.line_to = lineTo;
+        funcs.conic_to = conicTo;
+        funcs.cubic_to = cubicTo;
+        funcs.shift = 0;
+        funcs.delta = 0;
+        FT_Outline_Decompose(const_cast<FT_Outline*>(outline), &funcs, &builder);
+
+        colorEdges(builder.contours);
+        std::vector<Segment> segments;
+        flattenEdges(builder.contours, segments);
+        if (segments.empty())
+        {
+            memset(out, 0, width * height * 3);
+            return;
+        }
+
+        // the distances are negative on the left of the edges, the inside of a TrueType outline is on the right
+        float sign = FT_Outline_Get_Orientation(const_cast<FT_Outline*>(outline)) == FT_ORIENTATION_TRUETYPE ? 1.0f : -1.0f;
+        float scale = sign / (2 * range);
+
+        std::vector<float> field(width * height * 3);
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                Vec2 point(left + x + 0.5f, top - y - 0.5f);
+
+                // the nearest segment of each channel, and of any color for the channels without segments
+                SignedDistance nearest[4];
+                for (auto& channel : nearest)
+                {
+                    channel.distance = -FLT_MAX;
+                    channel.dot = 1;
+                    channel.segment = nullptr;
+                    channel.param = 0;
+                }
+
+                for (auto& segment : segments)
+                {
+                    SignedDistance candidate;
+                    Vec2 aq = point - segment.a;
+                    candidate.segment = &segment;
+                    candidate.param = aq.dot(segment.direction) / segment.length;
+
+                    Vec2 eq = (candidate.param > 0.5f ? segment.b : segment.a) - point;
+                    float endpointDistance = eq.length();
+                    float orthoDistance = aq.cross(segment.direction);
+                    if (candidate.param > 0 && candidate.param < 1 && fabsf(orthoDistance) < endpointDistance)
+                    {
+                        candidate.distance = orthoDistance;
+                        candidate.dot = 0;
+                    }
+                    else
+                    {
+                        candidate.distance = orthoDistance < 0 ? -endpointDistance : endpointDistance;
+                        candidate.dot = endpointDistance > 0 ? fabsf(segment.direction.dot(eq) / endpointDistance) : 0;
+                    }
+
+                    int color = segment.color | (1 << 3);
+                    for (int channel = 0; channel < 4; ++channel)
+                    {
+                        if ((color & (1 << channel)) && candidate.isCloserThan(nearest[channel]))
+                        {
+                            nearest[channel] = candidate;
+                        }
+                    }
+                }
+
+                float* pixel = &field[(y * width + x) * 3];
+                for (int channel = 0; channel < 3; ++channel)
+                {
+                    auto& channelNearest = nearest[channel].segment ? nearest[channel] : nearest[3];
+                    pixel[channel] = 0.5f + pseudoDistance(channelNearest, point) * scale;
+                }
+            }
+        }
+
+        // a field value changes by one pixel at most from one pixel to the next
+        correctErrors(field, width, height, 1.001f / (2 * range));
+
+        for (size_t i = 0; i < field.size(); ++i)
+        {
+            float value = std::max(0.0f, std::min(1.0f, field[i]));
+            out[i] = (unsigned char)(value * 255 + 0.5f);
+        }
+    }
+}
+
+NS_CC_END
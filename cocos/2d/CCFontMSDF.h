@@ -0,0 +1,55 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef _CCFontMSDF_h_
+#define _CCFontMSDF_h_
+
+/// @cond DO_NOT_SHOW
+
+#include "platform/CCPlatformMacros.h"
+#include "freetype/ft2build.h"
+#include "freetype/freetype.h"
+
+NS_CC_BEGIN
+
+/**
+ The multi-channel signed distance fields of the MSDF font atlases.
+ The edges of a glyph are split between the red, green and blue channels so that the corners,
+ where two channels meet, stay sharp when the median of the three channels is thresholded at any scale.
+ */
+namespace msdf
+{
+    /**
+     Renders the field of `outline` to `width` x `height` RGB888 pixels, the inside of the glyph is above 128.
+     `left` and `top` are the outline coordinates, in pixels with y up, of the top left corner of the bitmap.
+     `range` is the distance in pixels from the edge to 0 or 255.
+     */
+    void CC_DLL renderOutline(const FT_Outline* outline, int width, int height, float left, float top, float range, unsigned char* out);
+}
+
+NS_CC_END
+
+/// @endcond
+#endif
@@ -31,16 +31,31 @@ NS_CC_BEGIN
 
 Grabber::Grabber()
     : _FBO(0)
+    , _ownsFBO(false)
     , _oldFBO(0)
 {
     memset(_oldClearColor, 0, sizeof(_oldClearColor));
+}
 
-    // generate FBO
-    glGenFramebuffers(1, &_FBO);
+void Grabber::setFramebuffer(GLuint framebuffer)
+{
+    if (_ownsFBO)
+    {
+        glDeleteFramebuffers(1, &_FBO);
+        _ownsFBO = false;
+    }
+    _FBO = framebuffer;
 }
 
 void Grabber::grab(Texture2D *texture)
 {
+    // the FBO is generated when it's grabbing, the pooled grids render to a borrowed one
+    if (!_ownsFBO)
+    {
+        glGenFramebuffers(1, &_FBO);
+        _ownsFBO = true;
+    }
+
     glGetIntegerv(GL_FRAMEBUFFER_BINDING, &_oldFBO);
 
     // bind
@@ -95,7 +110,10 @@ void Grabber::afterRender(cocos2d::Texture2D *texture)
 Grabber::~Grabber()
 {
     CCLOGINFO("deallocing Grabber: %p", this);
-    glDeleteFramebuffers(1, &_FBO);
+    if (_ownsFBO)
+    {
+        glDeleteFramebuffers(1, &_FBO);
+    }
 }
 
 NS_CC_END
@@ -55,6 +55,8 @@ public:
     ~Grabber();
     /**Init the grab structure, will set the texture as the FBO color attachment.*/
     void grab(Texture2D *texture);
+    /**Renders to a framebuffer owned by the caller, such as a target of RenderTargetPool, instead of its own.*/
+    void setFramebuffer(GLuint framebuffer);
     /**Begin capture the screen, which will save the old FBO, clear color, and set the new FBO, clear the background.*/
     void beforeRender(Texture2D *texture);
     /**After capture, will reset the old FBO and clear color.*/
@@ -62,6 +64,7 @@ public:
 
 protected:
     GLuint _FBO;
+    bool _ownsFBO;
     GLint _oldFBO;
     GLfloat _oldClearColor[4];
 };
@@ -29,6 +29,7 @@ THE SOFTWARE.
 #include "base/ccUtils.h"
 #include "2d/CCNode.h"
 #include "2d/CCGrabber.h"
+#include "renderer/CCRenderTargetPool.h"
 #include "renderer/CCGLProgram.h"
 #include "renderer/CCGLProgramCache.h"
 #include "renderer/ccGLStateCache.h"
@@ -88,37 +89,16 @@ bool GridBase::initWithSize(const cocos2d::Size &gridSize, const cocos2d::Rect &
     Director *director = Director::DirectorInstance;
     Size s = director->getWinSizeInPixels();
 
-    auto POTWide = ccNextPOT((unsigned int)s.width);
-    auto POTHigh = ccNextPOT((unsigned int)s.height);
+    // the texture is borrowed from the RenderTargetPool while the grid draws
+    _texture = nullptr;
+    _target = nullptr;
+    _texturePixelsWide = ccNextPOT((unsigned int)s.width);
+    _texturePixelsHigh = ccNextPOT((unsigned int)s.height);
+    _textureContentSizeInPixels = s;
 
-    // we only use rgba8888
-    Texture2D::PixelFormat format = Texture2D::PixelFormat::RGBA8888;
-
-    auto dataLen = POTWide * POTHigh * 4;
-    void *data = calloc(dataLen, 1);
-    if (data == nullptr)
-    {
-        CCLOG("cocos2d: Grid: not enough memory.");
-        this->release();
-        return false;
-    }
-
-    Texture2D *texture = new (std::nothrow) Texture2D();
-    if (texture == nullptr)
-    {
-        CCLOG("cocos2d: Grid: error creating texture");
-        free(data);
-        return false;
-    }
-    
-    texture->initWithData(data, dataLen,  format, POTWide, POTHigh, s);
-    free(data);
-
-    initWithSize(gridSize, texture, false, rect);
-
-    texture->release();
+    _grabber = new (std::nothrow) Grabber();
 
-    return true;
+    return initGrid(gridSize, false, rect) && _grabber != nullptr;
 }
 
 bool GridBase::initWithSize(const Size& gridSize, Texture2D *texture, bool flipped)
@@ -130,16 +110,35 @@ bool GridBase::initWithSize(const Size& gridSize, Texture2D *texture, bool flipp
 {
     bool ret = true;
 
+    _texture = texture;
+    CC_SAFE_RETAIN(_texture);
+    _target = nullptr;
+    _texturePixelsWide = _texture->getPixelsWide();
+    _texturePixelsHigh = _texture->getPixelsHigh();
+    _textureContentSizeInPixels = _texture->getContentSizeInPixels();
+
+    _grabber = new (std::nothrow) Grabber();
+    if (_grabber)
+    {
+        _grabber->grab(_texture);
+    }
+    else
+    {
+        ret = false;
+    }
+
+    return initGrid(gridSize, flipped, rect) && ret;
+}
+
+bool GridBase::initGrid(const Size& gridSize, bool flipped, const Rect& rect)
+{
     _active = false;
     _reuseGrid = 0;
     _gridSize = gridSize;
-
-    _texture = texture;
-    CC_SAFE_RETAIN(_texture);
     _isTextureFlipped = flipped;
 
     if (rect.equals(Rect::ZERO)) {
-        auto size = _texture->getContentSize();
+        auto size = _textureContentSizeInPixels / CC_CONTENT_SCALE_FACTOR();
         _gridRect.setRect(0, 0, size.width, size.height);
     }
     else{
@@ -148,20 +147,10 @@ bool GridBase::initWithSize(const Size& gridSize, Texture2D *texture, bool flipp
     _step.x = _gridRect.size.width/_gridSize.width;
     _step.y = _gridRect.size.height/_gridSize.height;
 
-    _grabber = new (std::nothrow) Grabber();
-    if (_grabber)
-    {
-        _grabber->grab(_texture);
-    }
-    else
-    {
-        ret = false;
-    }
-
     _shaderProgram = GLProgramCache::getInstance()->getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE);
     calculateVertexPoints();
 
-    return ret;
+    return true;
 }
 
 GridBase::~GridBase()
@@ -169,7 +158,14 @@ GridBase::~GridBase()
     CCLOGINFO("deallocing GridBase: %p", this);
 
     //TODO: ? why 2.0 comments this line:        setActive(false);
-    CC_SAFE_RELEASE(_texture);
+    if (_target)
+    {
+        RenderTargetPool::getInstance()->giveBack(_target);
+    }
+    else
+    {
+        CC_SAFE_RELEASE(_texture);
+    }
     CC_SAFE_RELEASE(_grabber);
 }
 
@@ -198,7 +194,7 @@ void GridBase::set2DProjection()
 {
     Director *director = Director::DirectorInstance;
     Size    size = director->getWinSizeInPixels();
-    glViewport(0, 0, (GLsizei)(size.width), (GLsizei)(size.height) );
+    GL::viewport(0, 0, (GLsizei)(size.width), (GLsizei)(size.height) );
     director->loadIdentityMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION);
 
     Mat4 orthoMatrix;
@@ -226,12 +222,29 @@ void GridBase::beforeDraw()
     set2DProjection();
 
     Size    size = director->getWinSizeInPixels();
-    glViewport(0, 0, (GLsizei)(size.width), (GLsizei)(size.height) );
+    GL::viewport(0, 0, (GLsizei)(size.width), (GLsizei)(size.height) );
+
+    if (_texture == nullptr)
+    {
+        _target = RenderTargetPool::getInstance()->borrow(_texturePixelsWide, _texturePixelsHigh, _textureContentSizeInPixels,
+                                                          Texture2D::PixelFormat::RGBA8888, 0);
+        if (_target == nullptr)
+        {
+            return;
+        }
+        _texture = _target->texture;
+        _grabber->setFramebuffer(_target->FBO);
+    }
     _grabber->beforeRender(_texture);
 }
 
 void GridBase::afterDraw(cocos2d::Node *target)
 {
+    if (_texture == nullptr)
+    {
+        return;
+    }
+
     _grabber->afterRender(_texture);
 
     // restore projection
@@ -246,6 +259,13 @@ void GridBase::afterDraw(cocos2d::Node *target)
     beforeBlit();
     blit();
     afterBlit();
+
+    if (_target)
+    {
+        RenderTargetPool::getInstance()->giveBack(_target);
+        _target = nullptr;
+        _texture = nullptr;
+    }
 }
 
 void GridBase::blit()
@@ -368,16 +388,13 @@ void Grid3D::beforeBlit()
 {
     if(_needDepthTestForBlit)
     {
-        _oldDepthTestValue = glIsEnabled(GL_DEPTH_TEST) != GL_FALSE;
-        GLboolean depthWriteMask;
-        glGetBooleanv(GL_DEPTH_WRITEMASK, &depthWriteMask);
-        _oldDepthWriteValue = depthWriteMask != GL_FALSE;
-        CHECK_GL_ERROR_DEBUG();
+        _oldDepthTestValue = GL::isEnabled(GL_DEPTH_TEST);
+        _oldDepthWriteValue = GL::getDepthMask() != GL_FALSE;
 
-        glEnable(GL_DEPTH_TEST);
+        GL::enable(GL_DEPTH_TEST);
         RenderState::StateBlock::_defaultState->setDepthTest(true);
 
-        glDepthMask(true);
+        GL::depthMask(true);
         RenderState::StateBlock::_defaultState->setDepthWrite(true);
     }
 }
@@ -387,12 +404,12 @@ void Grid3D::afterBlit()
     if(_needDepthTestForBlit)
     {
         if(_oldDepthTestValue)
-            glEnable(GL_DEPTH_TEST);
+            GL::enable(GL_DEPTH_TEST);
         else
-            glDisable(GL_DEPTH_TEST);
+            GL::disable(GL_DEPTH_TEST);
         RenderState::StateBlock::_defaultState->setDepthTest(_oldDepthTestValue);
 
-        glDepthMask(_oldDepthWriteValue);
+        GL::depthMask(_oldDepthWriteValue);
         RenderState::StateBlock::_defaultState->setDepthWrite(_oldDepthWriteValue);
     }
 }
@@ -410,19 +427,19 @@ void Grid3D::blit()
     //
 
     // position
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, 0, _vertices);
+    GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, 0, _vertices);
 
     // texCoords
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, 0, _texCoordinates);
+    GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, 0, _texCoordinates);
 
     glDrawElements(GL_TRIANGLES, (GLsizei) n*6, GL_UNSIGNED_SHORT, _indices);
 }
 
 void Grid3D::calculateVertexPoints()
 {
-    float width = (float)_texture->getPixelsWide();
-    float height = (float)_texture->getPixelsHigh();
-    float imageH = _texture->getContentSizeInPixels().height;
+    float width = (float)_texturePixelsWide;
+    float height = (float)_texturePixelsHigh;
+    float imageH = _textureContentSizeInPixels.height;
 
     int x, y, i;
     CC_SAFE_FREE(_vertices);
@@ -650,10 +667,10 @@ void TiledGrid3D::blit()
     GL::enableVertexAttribs( GL::VERTEX_ATTRIB_FLAG_POSITION | GL::VERTEX_ATTRIB_FLAG_TEX_COORD );
 
     // position
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, 0, _vertices);
+    GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, 0, _vertices);
 
     // texCoords
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, 0, _texCoordinates);
+    GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, 0, _texCoordinates);
 
     glDrawElements(GL_TRIANGLES, (GLsizei)n*6, GL_UNSIGNED_SHORT, _indices);
 
@@ -662,9 +679,9 @@ void TiledGrid3D::blit()
 
 void TiledGrid3D::calculateVertexPoints()
 {
-    float width = (float)_texture->getPixelsWide();
-    float height = (float)_texture->getPixelsHigh();
-    float imageH = _texture->getContentSizeInPixels().height;
+    float width = (float)_texturePixelsWide;
+    float height = (float)_texturePixelsHigh;
+    float imageH = _textureContentSizeInPixels.height;
 
     int numQuads = _gridSize.width * _gridSize.height;
     CC_SAFE_FREE(_vertices);
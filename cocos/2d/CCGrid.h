@@ -29,6 +29,7 @@ THE SOFTWARE.
 #include "base/CCRef.h"
 #include "base/ccTypes.h"
 #include "base/CCDirector.h"
+#include "renderer/CCRenderTargetPool.h"
 
 NS_CC_BEGIN
 
@@ -61,7 +62,8 @@ public:
     /**@{
      Init the Grid base.
      @param gridSize the size of the grid.
-     @param texture The texture used for grab.
+     @param texture The texture used for grab. Without one, the grid borrows a window sized target of the
+     RenderTargetPool while it draws.
      @param flipped whether or not the grab texture should be flip by Y or not.
      @param rect The effective grid rect.
     */
@@ -135,10 +137,17 @@ public:
     inline const Rect& getGridRect() const {return _gridRect;}
 
 protected:
+    bool initGrid(const Size& gridSize, bool flipped, const Rect& rect);
+
     bool _active;
     int  _reuseGrid;
     Size _gridSize;
+    // the texture given to the grid, or the one of _target while it draws
     Texture2D *_texture;
+    RenderTargetPool::Target *_target;
+    int _texturePixelsWide;
+    int _texturePixelsHigh;
+    Size _textureContentSizeInPixels;
     Vec2 _step;
     Grabber *_grabber;
     bool _isTextureFlipped;
@@ -29,11 +29,14 @@
 #include "2d/CCFont.h"
 #include "2d/CCFontAtlasCache.h"
 #include "2d/CCFontAtlas.h"
+#include "2d/CCFontFreeType.h"
 #include "2d/CCSprite.h"
 #include "2d/CCSpriteBatchNode.h"
+#include "2d/CCSystemFontTextureCache.h"
 #include "2d/CCDrawNode.h"
 #include "base/ccUTF8.h"
 #include "platform/CCFileUtils.h"
+#include "platform/CCGLView.h"
 #include "renderer/CCRenderer.h"
 #include "renderer/ccGLStateCache.h"
 #include "base/CCDirector.h"
@@ -41,6 +44,9 @@
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventCustom.h"
 #include "2d/CCFontFNT.h"
+#include "base/CCJobSystem.h"
+#include "base/CCScheduler.h"
+#include "base/CCTracer.h"
 
 NS_CC_BEGIN
 
@@ -162,6 +168,12 @@ private:
     bool _letterVisible;
 };
 
+static const char* PARALLEL_LAYOUT_KEY = "Label::updatePendingLayouts";
+
+bool Label::s_isParallelLayoutEnabled = (CC_LABEL_PARALLEL_LAYOUT != 0);
+bool Label::s_isSinglePassEffectsEnabled = (CC_LABEL_SINGLE_PASS_EFFECTS != 0);
+std::vector<Label*> Label::s_pendingLayouts;
+
 Label* Label::create()
 {
     auto ret = new (std::nothrow) Label;
@@ -367,6 +379,8 @@ Label::Label(TextHAlignment hAlignment /* = TextHAlignment::LEFT */,
 , _boldEnabled(false)
 , _underlineNode(nullptr)
 , _strikethroughEnabled(false)
+, _isLayoutPending(false)
+, _effectQuadsDirty(true)
 {
     setAnchorPoint(Vec2::ANCHOR_MIDDLE);
     reset();
@@ -378,8 +392,10 @@ Label::Label(TextHAlignment hAlignment /* = TextHAlignment::LEFT */,
     addChild(_debugDrawNode);
 #endif
 
+    // the BMFont atlases are only purged when their file is reloaded, see FontAtlasCache::reloadFontFile()
     _purgeTextureListener = EventListenerCustom::create(FontAtlas::CMD_PURGE_FONTATLAS, [this](EventCustom* event){
-        if (_fontAtlas && _currentLabelType == LabelType::TTF && event->getUserData() == _fontAtlas)
+        if (_fontAtlas && (_currentLabelType == LabelType::TTF || _currentLabelType == LabelType::BMFONT)
+            && event->getUserData() == _fontAtlas)
         {
             for (auto&& it : _letters)
             {
@@ -405,8 +421,26 @@ Label::Label(TextHAlignment hAlignment /* = TextHAlignment::LEFT */,
                 getLetter(it.first);
             }
         }
+        else if (_fontAtlas && _currentLabelType == LabelType::BMFONT && event->getUserData() == _fontAtlas)
+        {
+            _fontAtlas = nullptr;
+            this->setBMFontFilePath(_bmFontPath, _bmFontImageOffset, _bmFontSize);
+            for (auto&& it : _letters)
+            {
+                getLetter(it.first);
+            }
+        }
     });
     _eventDispatcher->addEventListenerWithFixedPriority(_resetTextureListener, 2);
+
+    _waitingForLetters = false;
+    _updateTextureListener = EventListenerCustom::create(FontAtlas::CMD_UPDATE_FONTATLAS, [this](EventCustom* event){
+        if (_waitingForLetters && _currentLabelType == LabelType::TTF && event->getUserData() == _fontAtlas)
+        {
+            markContentDirty();
+        }
+    });
+    _eventDispatcher->addEventListenerWithFixedPriority(_updateTextureListener, 3);
 }
 
 Label::~Label()
@@ -422,6 +456,7 @@ Label::~Label()
     }
     _eventDispatcher->removeEventListener(_purgeTextureListener);
     _eventDispatcher->removeEventListener(_resetTextureListener);
+    _eventDispatcher->removeEventListener(_updateTextureListener);
 
     CC_SAFE_RELEASE_NULL(_textSprite);
     CC_SAFE_RELEASE_NULL(_shadowNode);
@@ -485,6 +520,7 @@ void Label::reset()
     _shadowBlurRadius = 0.f;
 
     _useDistanceField = false;
+    _useMSDF = false;
     _useA8Shader = false;
     _clipEnabled = false;
     _blendFuncDirty = false;
@@ -508,6 +544,22 @@ void Label::reset()
 
 void Label::updateShaderProgram()
 {
+    if (_useMSDF)
+    {
+        // the outline is a uniform of the normal program
+        if (_currLabelEffect == LabelEffect::GLOW)
+            setGLProgramState(GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_LABEL_MSDF_GLOW));
+        else
+            setGLProgramState(GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_LABEL_MSDF));
+
+        auto program = getGLProgram()->getProgram();
+        _uniformTextColor = glGetUniformLocation(program, "u_textColor");
+        _uniformEffectColor = glGetUniformLocation(program, "u_effectColor");
+        _uniformDistanceScale = glGetUniformLocation(program, "u_distanceScale");
+        _uniformOutlineWidth = glGetUniformLocation(program, "u_outlineWidth");
+        return;
+    }
+
     switch (_currLabelEffect)
     {
     case cocos2d::LabelEffect::NORMAL:
@@ -571,10 +623,11 @@ void Label::setFontAtlas(FontAtlas* atlas,bool distanceFieldEnabled /* = false *
     if (_fontAtlas)
     {
         _lineHeight = _fontAtlas->getLineHeight();
-        _contentDirty = true;
+        markContentDirty();
         _systemFontDirty = false;
     }
     _useDistanceField = distanceFieldEnabled;
+    _useMSDF = false;
     _useA8Shader = useA8Shader;
 
     if (_currentLabelType != LabelType::TTF)
@@ -614,6 +667,7 @@ bool Label::setBMFontFilePath(const std::string& bmfontFilePath, const Vec2& ima
     }
 
     _bmFontPath = bmfontFilePath;
+    _bmFontImageOffset = imageOffset;
 
     _currentLabelType = LabelType::BMFONT;
     setFontAtlas(newAtlas);
@@ -626,13 +680,19 @@ void Label::setString(const std::string& text)
     if (text.compare(_utf8Text))
     {
         _utf8Text = text;
-        _contentDirty = true;
 
         std::u16string utf16String;
         if (StringUtils::UTF8ToUTF16(_utf8Text, utf16String))
         {
-            _utf16Text  = utf16String;
+            // utf16String holds the text of the current layout from here on
+            _utf16Text.swap(utf16String);
+            if (updateStringIncrementally(utf16String))
+            {
+                invalidateCachedTexture();
+                return;
+            }
         }
+        markContentDirty();
     }
 }
 
@@ -643,7 +703,7 @@ void Label::setAlignment(TextHAlignment hAlignment,TextVAlignment vAlignment)
         _hAlignment = hAlignment;
         _vAlignment = vAlignment;
 
-        _contentDirty = true;
+        markContentDirty();
     }
 }
 
@@ -652,7 +712,7 @@ void Label::setMaxLineWidth(float maxLineWidth)
     if (_labelWidth == 0 && _maxLineWidth != maxLineWidth)
     {
         _maxLineWidth = maxLineWidth;
-        _contentDirty = true;
+        markContentDirty();
     }
 }
 
@@ -669,7 +729,7 @@ void Label::setDimensions(float width, float height)
         _labelDimensions.height = height;
 
         _maxLineWidth = width;
-        _contentDirty = true;
+        markContentDirty();
 
         if(_overflow == Overflow::SHRINK){
             if (_originalFontSize > 0) {
@@ -697,7 +757,7 @@ void Label::setLineBreakWithoutSpace(bool breakWithoutSpace)
     if (breakWithoutSpace != _lineBreakWithoutSpaces)
     {
         _lineBreakWithoutSpaces = breakWithoutSpace;
-        _contentDirty = true;
+        markContentDirty();
     }
 }
 
@@ -761,41 +821,17 @@ bool Label::alignText()
 
     bool ret = true;
     do {
-        _fontAtlas->prepareLetterDefinitions(_utf16Text);
-        auto& textures = _fontAtlas->getTextures();
-        if (textures.size() > _batchNodes.size())
-        {
-            for (auto index = _batchNodes.size(); index < textures.size(); ++index)
-            {
-                auto batchNode = SpriteBatchNode::createWithTexture(textures.at(index));
-                if (batchNode)
-                {
-                    _isOpacityModifyRGB = batchNode->getTexture()->hasPremultipliedAlpha();
-                    _blendFunc = batchNode->getBlendFunc();
-                    batchNode->setAnchorPoint(Vec2::ANCHOR_TOP_LEFT);
-                    batchNode->setPosition(Vec2::ZERO);
-                    _batchNodes.pushBack(batchNode);
-                }
-            }
-        }
-        if (_batchNodes.empty())
+        if (!prepareLetters())
         {
             return true;
         }
-        _reusedLetter->setBatchNode(_batchNodes.at(0));
 
-        _lengthOfString = 0;
-        _textDesiredHeight = 0.f;
-        _linesWidth.clear();
-        if (_maxLineWidth > 0.f && !_lineBreakWithoutSpaces)
-        {
-            multilineTextWrapByWord();
-        }
-        else
+        if (!restoreLayoutFromCache())
         {
-            multilineTextWrapByChar();
+            computeHorizontalKernings(_utf16Text);
+            layoutLetters();
+            addLayoutToCache();
         }
-        computeAlignmentOffset();
 
         if(_overflow == Overflow::SHRINK){
             float fontSize = this->getRenderingFontSize();
@@ -821,6 +857,51 @@ bool Label::alignText()
     return ret;
 }
 
+bool Label::prepareLetters()
+{
+    _fontAtlas->prepareLetterDefinitions(_utf16Text);
+    _waitingForLetters = _fontAtlas->hasPendingLetters();
+    auto& textures = _fontAtlas->getTextures();
+    if (textures.size() > _batchNodes.size())
+    {
+        for (auto index = _batchNodes.size(); index < textures.size(); ++index)
+        {
+            auto batchNode = SpriteBatchNode::createWithTexture(textures.at(index));
+            if (batchNode)
+            {
+                _isOpacityModifyRGB = batchNode->getTexture()->hasPremultipliedAlpha();
+                _blendFunc = batchNode->getBlendFunc();
+                batchNode->setAnchorPoint(Vec2::ANCHOR_TOP_LEFT);
+                batchNode->setPosition(Vec2::ZERO);
+                _batchNodes.pushBack(batchNode);
+            }
+        }
+    }
+    if (_batchNodes.empty())
+    {
+        return false;
+    }
+    _reusedLetter->setBatchNode(_batchNodes.at(0));
+
+    _lengthOfString = 0;
+    _textDesiredHeight = 0.f;
+    _linesWidth.clear();
+    return true;
+}
+
+void Label::layoutLetters()
+{
+    if (_maxLineWidth > 0.f && !_lineBreakWithoutSpaces)
+    {
+        multilineTextWrapByWord();
+    }
+    else
+    {
+        multilineTextWrapByChar();
+    }
+    computeAlignmentOffset();
+}
+
 bool Label::computeHorizontalKernings(const std::u16string& stringToRender)
 {
     if (_horizontalKernings)
@@ -924,6 +1005,311 @@ bool Label::updateQuads()
     return ret;
 }
 
+void Label::computeLetterQuads()
+{
+    _letterQuads.resize(_batchNodes.size());
+    for (auto& quads : _letterQuads)
+    {
+        quads.clear();
+    }
+
+    auto& letterDefinitions = _fontAtlas->_letterDefinitions;
+    for (int ctr = 0; ctr < _lengthOfString; ++ctr)
+    {
+        auto& letterInfo = _lettersInfo[ctr];
+        // find(), the labels of the same atlas read the definitions at the same time
+        auto letterDefIt = letterDefinitions.find(letterInfo.utf16Char);
+        if (!letterInfo.valid || letterDefIt == letterDefinitions.end())
+        {
+            continue;
+        }
+        auto& letterDef = letterDefIt->second;
+
+        Rect rect(letterDef.U, letterDef.V, letterDef.width, letterDef.height);
+        auto py = letterInfo.positionY + _letterOffsetY;
+        if (_labelHeight > 0.f) {
+            if (py > _tailoredTopY)
+            {
+                auto clipTop = py - _tailoredTopY;
+                rect.origin.y += clipTop;
+                rect.size.height -= clipTop;
+                py -= clipTop;
+            }
+            if (py - letterDef.height * _bmfontScale < _tailoredBottomY)
+            {
+                rect.size.height = (py < _tailoredBottomY) ? 0.f : (py - _tailoredBottomY);
+            }
+        }
+
+        auto lineIndex = letterInfo.lineIndex;
+        if (_labelWidth > 0.f && _overflow == Overflow::CLAMP)
+        {
+            auto px = letterInfo.positionX + letterDef.width/2 * _bmfontScale + _linesOffsetX[lineIndex];
+            if (this->isHorizontalClamped(px, lineIndex))
+            {
+                rect.size.width = 0;
+            }
+        }
+
+        if (rect.size.height > 0.f && rect.size.width > 0.f)
+        {
+            auto texture = _batchNodes.at(letterDef.textureID)->getTextureAtlas()->getTexture();
+            auto& quads = _letterQuads[letterDef.textureID];
+            letterInfo.atlasIndex = static_cast<int>(quads.size());
+            quads.push_back(getLetterQuad(texture, rect, letterInfo.positionX + _linesOffsetX[lineIndex], py));
+        }
+    }
+}
+
+void Label::commitLetterQuads()
+{
+    for (size_t index = 0; index < _letterQuads.size() && index < _batchNodes.size(); ++index)
+    {
+        auto textureAtlas = _batchNodes.at(index)->getTextureAtlas();
+        auto& quads = _letterQuads[index];
+        textureAtlas->removeAllQuads();
+        if (static_cast<ssize_t>(quads.size()) > textureAtlas->getCapacity())
+        {
+            textureAtlas->resizeCapacity(quads.size());
+        }
+        if (!quads.empty())
+        {
+            textureAtlas->insertQuads(quads.data(), 0, quads.size());
+        }
+    }
+    std::vector<std::vector<V3F_C4B_T2F_Quad>>().swap(_letterQuads);
+}
+
+V3F_C4B_T2F_Quad Label::getLetterQuad(Texture2D* texture, const Rect& rect, float x, float y) const
+{
+    // _reusedLetter is anchored at its top left and scaled by getLetterScale(), see Sprite::updateTransform()
+    float scale = getLetterScale();
+    float right = x + rect.size.width * scale;
+    float bottom = y - rect.size.height * scale;
+
+    V3F_C4B_T2F_Quad quad;
+    quad.bl.vertices.set(SPRITE_RENDER_IN_SUBPIXEL(x), SPRITE_RENDER_IN_SUBPIXEL(bottom), 0.f);
+    quad.br.vertices.set(SPRITE_RENDER_IN_SUBPIXEL(right), SPRITE_RENDER_IN_SUBPIXEL(bottom), 0.f);
+    quad.tl.vertices.set(SPRITE_RENDER_IN_SUBPIXEL(x), SPRITE_RENDER_IN_SUBPIXEL(y), 0.f);
+    quad.tr.vertices.set(SPRITE_RENDER_IN_SUBPIXEL(right), SPRITE_RENDER_IN_SUBPIXEL(y), 0.f);
+
+    float texLeft, texRight, texTop, texBottom;
+    Sprite::getTextureCoords(texture, rect, false, texLeft, texRight, texTop, texBottom);
+    quad.bl.texCoords.u = texLeft;
+    quad.bl.texCoords.v = texBottom;
+    quad.br.texCoords.u = texRight;
+    quad.br.texCoords.v = texBottom;
+    quad.tl.texCoords.u = texLeft;
+    quad.tl.texCoords.v = texTop;
+    quad.tr.texCoords.u = texRight;
+    quad.tr.texCoords.v = texTop;
+
+    // updateColor() colors them once they're in the atlases
+    quad.bl.colors = quad.br.colors = quad.tl.colors = quad.tr.colors = Color4B::WHITE;
+    return quad;
+}
+
+bool Label::updateStringIncrementally(const std::u16string& oldText)
+{
+    // Only a label that is laid out, isn't wrapped nor clamped and uses one texture is patched,
+    // the other ones go through updateContent().
+    if (_contentDirty || _systemFontDirty || _fontAtlas == nullptr || _waitingForLetters || _underlineNode
+        || _batchNodes.size() != 1 || _labelWidth > 0.f || _labelHeight > 0.f
+        || (_enableWrap && _maxLineWidth > 0.f)
+        || oldText.empty() || _utf16Text.empty()
+        || _lengthOfString != static_cast<int>(oldText.length()))
+    {
+        return false;
+    }
+
+    int oldLength = static_cast<int>(oldText.length());
+    int newLength = static_cast<int>(_utf16Text.length());
+    int prefix = 0;
+    while (prefix < oldLength && prefix < newLength && oldText[prefix] == _utf16Text[prefix])
+    {
+        ++prefix;
+    }
+    int suffix = 0;
+    while (suffix < oldLength - prefix && suffix < newLength - prefix
+           && oldText[oldLength - 1 - suffix] == _utf16Text[newLength - 1 - suffix])
+    {
+        ++suffix;
+    }
+
+    // the line breaks have to stay where they are
+    for (int index = prefix; index < oldLength - suffix; ++index)
+    {
+        if (oldText[index] == '\n')
+            return false;
+    }
+    for (int index = prefix; index < newLength - suffix; ++index)
+    {
+        if (_utf16Text[index] == '\n')
+            return false;
+    }
+
+    if (newLength - suffix > prefix)
+    {
+        auto textures = _fontAtlas->getTextures().size();
+        _fontAtlas->prepareLetterDefinitions(_utf16Text.substr(prefix, newLength - suffix - prefix));
+        if (_fontAtlas->getTextures().size() != textures || _fontAtlas->hasPendingLetters() || _contentDirty)
+        {
+            return false;
+        }
+    }
+
+    // the changed line, in the new text and in the old one
+    int lineStart = prefix;
+    while (lineStart > 0 && _utf16Text[lineStart - 1] != '\n')
+    {
+        --lineStart;
+    }
+    int lineEnd = newLength - suffix;
+    while (lineEnd < newLength && _utf16Text[lineEnd] != '\n')
+    {
+        ++lineEnd;
+    }
+    int lengthDelta = newLength - oldLength;
+    int oldLineEnd = lineEnd - lengthDelta;
+    int lineIndex = static_cast<int>(std::count(_utf16Text.begin(), _utf16Text.begin() + lineStart, '\n'));
+
+    // the kernings of the line and of the line break after it
+    auto font = _fontAtlas->getFont();
+    int kerningStart = lineStart > 0 ? lineStart - 1 : 0;
+    int kerningEnd = std::min(lineEnd + 1, newLength);
+    int letterCount = 0;
+    int* lineKernings = font->getHorizontalKerningForTextUTF16(_utf16Text.substr(kerningStart, kerningEnd - kerningStart), letterCount);
+    if (_horizontalKernings || lineKernings)
+    {
+        int* kernings = new (std::nothrow) int[newLength];
+        if (!kernings)
+        {
+            delete [] lineKernings;
+            return false;
+        }
+        for (int index = 0; index < newLength; ++index)
+        {
+            if (index >= kerningStart && index < kerningEnd)
+                kernings[index] = lineKernings ? lineKernings[index - kerningStart] : 0;
+            else if (!_horizontalKernings)
+                kernings[index] = 0;
+            else
+                kernings[index] = _horizontalKernings[index < kerningStart ? index : index - lengthDelta];
+        }
+        delete [] lineKernings;
+        delete [] _horizontalKernings;
+        _horizontalKernings = kernings;
+    }
+
+    // the quads of the old line are contiguous in the atlas
+    auto batchNode = _batchNodes.at(0);
+    auto textureAtlas = batchNode->getTextureAtlas();
+    auto hasQuad = [this](const LetterInfo& letterInfo) {
+        if (!letterInfo.valid)
+            return false;
+        auto& letterDef = _fontAtlas->_letterDefinitions[letterInfo.utf16Char];
+        return letterDef.width > 0.f && letterDef.height > 0.f;
+    };
+    int firstQuad = -1;
+    int oldQuadCount = 0;
+    for (int index = lineStart; index < oldLineEnd; ++index)
+    {
+        if (hasQuad(_lettersInfo[index]))
+        {
+            if (firstQuad < 0)
+                firstQuad = _lettersInfo[index].atlasIndex;
+            ++oldQuadCount;
+        }
+    }
+    if (firstQuad < 0)
+    {
+        firstQuad = 0;
+        for (int index = lineStart - 1; index >= 0; --index)
+        {
+            if (hasQuad(_lettersInfo[index]))
+            {
+                firstQuad = _lettersInfo[index].atlasIndex + 1;
+                break;
+            }
+        }
+    }
+    textureAtlas->removeQuadsAtIndex(firstQuad, oldQuadCount);
+
+    if (lengthDelta > 0)
+        _lettersInfo.insert(_lettersInfo.begin() + oldLineEnd, lengthDelta, LetterInfo());
+    else if (lengthDelta < 0)
+        _lettersInfo.erase(_lettersInfo.begin() + lineEnd, _lettersInfo.begin() + oldLineEnd);
+
+    _lengthOfString = newLength;
+    _linesWidth[lineIndex] = typesetLine(lineStart, lineEnd, lineIndex);
+
+    float longestLine = 0.f;
+    for (auto lineWidth : _linesWidth)
+    {
+        longestLine = std::max(longestLine, lineWidth);
+    }
+    int otherLine = lineIndex == 0 ? 1 : 0;
+    float oldOffsetX = otherLine < _numberOfLines ? _linesOffsetX[otherLine] : 0.f;
+    setContentSize(Size(longestLine, _contentSize.height));
+    computeAlignmentOffset();
+
+    // the quads left in the atlas are the ones of the other lines,
+    // they all move by the same amount when centered or right aligned
+    if (otherLine < _numberOfLines)
+    {
+        float offsetDelta = _linesOffsetX[otherLine] - oldOffsetX;
+        if (offsetDelta != 0.f)
+        {
+            auto quads = textureAtlas->getQuads();
+            auto count = textureAtlas->getTotalQuads();
+            for (ssize_t index = 0; index < count; ++index)
+            {
+                quads[index].bl.vertices.x += offsetDelta;
+                quads[index].br.vertices.x += offsetDelta;
+                quads[index].tl.vertices.x += offsetDelta;
+                quads[index].tr.vertices.x += offsetDelta;
+            }
+            textureAtlas->setDirty(true);
+        }
+    }
+
+    int quadIndex = firstQuad;
+    for (int index = lineStart; index < lineEnd; ++index)
+    {
+        auto& letterInfo = _lettersInfo[index];
+        if (!hasQuad(letterInfo))
+            continue;
+
+        auto& letterDef = _fontAtlas->_letterDefinitions[letterInfo.utf16Char];
+        _reusedRect.size.height = letterDef.height;
+        _reusedRect.size.width  = letterDef.width;
+        _reusedRect.origin.x    = letterDef.U;
+        _reusedRect.origin.y    = letterDef.V;
+        _reusedLetter->setTextureRect(_reusedRect, false, _reusedRect.size);
+        _reusedLetter->setPosition(letterInfo.positionX + _linesOffsetX[lineIndex], letterInfo.positionY + _letterOffsetY);
+        letterInfo.atlasIndex = quadIndex;
+
+        this->updateLetterSpriteScale(_reusedLetter);
+
+        batchNode->insertQuadFromSprite(_reusedLetter, quadIndex);
+        ++quadIndex;
+    }
+    updateQuadsColor(textureAtlas, firstQuad, quadIndex - firstQuad);
+
+    int quadDelta = quadIndex - firstQuad - oldQuadCount;
+    if (quadDelta != 0)
+    {
+        for (int index = lineEnd; index < newLength; ++index)
+        {
+            _lettersInfo[index].atlasIndex += quadDelta;
+        }
+    }
+
+    updateLabelLetters();
+
+    return true;
+}
+
 bool Label::setTTFConfigInternal(const TTFConfig& ttfConfig)
 {
     FontAtlas *newAtlas = FontAtlasCache::getFontAtlasTTF(&ttfConfig);
@@ -939,7 +1325,18 @@ bool Label::setTTFConfigInternal(const TTFConfig& ttfConfig)
 
     _fontConfig = ttfConfig;
 
-    if (_fontConfig.outlineSize > 0)
+    if (_fontConfig.msdfEnabled)
+    {
+        // the letters are scaled from the shared atlas, see updateBMFontScale()
+        _fontConfig.distanceFieldEnabled = false;
+        _useDistanceField = false;
+        _useA8Shader = false;
+        _useMSDF = true;
+        _currLabelEffect = _fontConfig.outlineSize > 0 ? LabelEffect::OUTLINE : LabelEffect::NORMAL;
+        updateShaderProgram();
+        markContentDirty();
+    }
+    else if (_fontConfig.outlineSize > 0)
     {
         _fontConfig.distanceFieldEnabled = false;
         _useDistanceField = false;
@@ -969,7 +1366,7 @@ void Label::setBMFontSizeInternal(float fontSize)
 {
     if(_currentLabelType == LabelType::BMFONT){
         this->setBMFontFilePath(_bmFontPath, Vec2::ZERO, fontSize);
-        _contentDirty = true;
+        markContentDirty();
     }
 }
 
@@ -999,13 +1396,13 @@ void Label::enableGlow(const Color4B& glowColor)
 {
     if (_currentLabelType == LabelType::TTF)
     {
-        if (_fontConfig.distanceFieldEnabled == false)
+        if (_fontConfig.distanceFieldEnabled == false && _fontConfig.msdfEnabled == false)
         {
             auto config = _fontConfig;
             config.outlineSize = 0;
             config.distanceFieldEnabled = true;
             setTTFConfig(config);
-            _contentDirty = true;
+            markContentDirty();
         }
         _currLabelEffect = LabelEffect::GLOW;
         _effectColorF.r = glowColor.r / 255.0f;
@@ -1028,6 +1425,7 @@ void Label::enableOutline(const Color4B& outlineColor,int outlineSize /* = -1 */
             _effectColorF.g = outlineColor.g / 255.0f;
             _effectColorF.b = outlineColor.b / 255.0f;
             _effectColorF.a = outlineColor.a / 255.0f;
+            _effectQuadsDirty = true;
 
             if (outlineSize > 0 && _fontConfig.outlineSize != outlineSize)
             {
@@ -1042,7 +1440,7 @@ void Label::enableOutline(const Color4B& outlineColor,int outlineSize /* = -1 */
             _effectColorF.b = outlineColor.b / 255.f;
             _effectColorF.a = outlineColor.a / 255.f;
             _currLabelEffect = LabelEffect::OUTLINE;
-            _contentDirty = true;
+            markContentDirty();
         }
         _outlineSize = outlineSize;
     }
@@ -1052,6 +1450,7 @@ void Label::enableShadow(const Color4B& shadowColor /* = Color4B::BLACK */,const
 {
     _shadowEnabled = true;
     _shadowDirty = true;
+    _effectQuadsDirty = true;
 
     _shadowOffset.width = offset.width;
     _shadowOffset.height = offset.height;
@@ -1126,7 +1525,7 @@ void Label::enableUnderline()
     {
         _underlineNode = DrawNode::create();
         addChild(_underlineNode, 100000);
-        _contentDirty = true;
+        markContentDirty();
     }
 }
 
@@ -1139,6 +1538,71 @@ void Label::enableStrikethrough()
     }
 }
 
+Node* Label::cloneInstance() const
+{
+    // the fonts and their atlases are shared through their caches
+    Label* label = nullptr;
+    switch (_currentLabelType)
+    {
+        case LabelType::TTF:
+            label = Label::createWithTTF(_fontConfig, _utf8Text, _hAlignment, _maxLineWidth);
+            break;
+        case LabelType::BMFONT:
+            label = Label::createWithBMFont(_bmFontPath, _utf8Text, _hAlignment, _maxLineWidth, _bmFontImageOffset);
+            break;
+        case LabelType::STRING_TEXTURE:
+            label = Label::createWithSystemFont(_utf8Text, _systemFont, _systemFontSize, _labelDimensions, _hAlignment, _vAlignment);
+            break;
+        default:
+            // the char map file isn't kept
+            break;
+    }
+    if (!label)
+        return Node::cloneInstance();
+
+    label->setDimensions(_labelWidth, _labelHeight);
+    label->setAlignment(_hAlignment, _vAlignment);
+    label->setLineBreakWithoutSpace(_lineBreakWithoutSpaces);
+    label->enableWrap(_enableWrap);
+    if (_overflow != label->getOverflow())
+        label->setOverflow(_overflow);
+    label->setLineSpacing(_lineSpacing);
+    label->setAdditionalKerning(_additionalKerning);
+    label->setClipMarginEnabled(_clipEnabled);
+    label->setTextColor(_textColor);
+
+    Color4B effectColor(_effectColorF);
+    if (_currLabelEffect == LabelEffect::OUTLINE)
+        label->enableOutline(effectColor, (int)_outlineSize);
+    else if (_currLabelEffect == LabelEffect::GLOW)
+        label->enableGlow(effectColor);
+    if (_shadowEnabled)
+        label->enableShadow(Color4B(_shadowColor3B.r, _shadowColor3B.g, _shadowColor3B.b, _shadowOpacity), _shadowOffset, (int)_shadowBlurRadius);
+    label->_boldEnabled = _boldEnabled;
+    if (_underlineNode)
+        label->enableUnderline();
+    label->_strikethroughEnabled = _strikethroughEnabled;
+
+    copyNodeState(label);
+    return label;
+}
+
+bool Label::isInternalChild(const Node* child) const
+{
+#if CC_LABEL_DEBUG_DRAW
+    if (child == _debugDrawNode)
+        return true;
+#endif
+    if (child == _underlineNode)
+        return true;
+    for (const auto& letter : _letters)
+    {
+        if (letter.second == child)
+            return true;
+    }
+    return false;
+}
+
 void Label::disableEffect()
 {
     disableEffect(LabelEffect::ALL);
@@ -1159,13 +1623,14 @@ void Label::disableEffect(LabelEffect effect)
                     setTTFConfig(_fontConfig);
                 }
                 _currLabelEffect = LabelEffect::NORMAL;
-                _contentDirty = true;
+                markContentDirty();
             }
             break;
         case cocos2d::LabelEffect::SHADOW:
             if (_shadowEnabled)
             {
                 _shadowEnabled = false;
+                _effectQuadsDirty = true;
                 CC_SAFE_RELEASE_NULL(_shadowNode);
                 updateShaderProgram();
             }
@@ -1216,14 +1681,10 @@ void Label::createSpriteForSystemFont(const FontDefinition& fontDef)
 {
     _currentLabelType = LabelType::STRING_TEXTURE;
 
-    auto texture = new (std::nothrow) Texture2D;
-    texture->initWithString(_utf8Text, fontDef);
-
-    _textSprite = Sprite::createWithTexture(texture);
+    _textSprite = createSystemFontSprite(fontDef);
     _textSprite->setGlobalZOrder(getGlobalZOrder());
     _textSprite->setAnchorPoint(Vec2::ANCHOR_BOTTOM_LEFT);
     this->setContentSize(_textSprite->getContentSize());
-    texture->release();
     if (_blendFuncDirty)
     {
         _textSprite->setBlendFunc(_blendFunc);
@@ -1234,12 +1695,28 @@ void Label::createSpriteForSystemFont(const FontDefinition& fontDef)
     _textSprite->updateDisplayedOpacity(_displayedOpacity);
 }
 
+Sprite* Label::createSystemFontSprite(const FontDefinition& fontDef)
+{
+    // the labels showing the same text share one rendering, packed with the other small ones
+    auto frame = SystemFontTextureCache::getSpriteFrame(_utf8Text, fontDef);
+    if (frame)
+    {
+        return Sprite::createWithSpriteFrame(frame);
+    }
+
+    auto texture = new (std::nothrow) Texture2D;
+    texture->initWithString(_utf8Text, fontDef);
+    auto sprite = Sprite::createWithTexture(texture);
+    texture->release();
+    return sprite;
+}
+
 void Label::createShadowSpriteForSystemFont(const FontDefinition& fontDef)
 {
     if (!fontDef._stroke._strokeEnabled && fontDef._fontFillColor == _shadowColor3B
         && (fontDef._fontAlpha == _shadowOpacity))
     {
-        _shadowNode = Sprite::createWithTexture(_textSprite->getTexture());
+        _shadowNode = Sprite::createWithSpriteFrame(_textSprite->getSpriteFrame());
     }
     else
     {
@@ -1252,10 +1729,7 @@ void Label::createShadowSpriteForSystemFont(const FontDefinition& fontDef)
         shadowFontDefinition._stroke._strokeColor = shadowFontDefinition._fontFillColor;
         shadowFontDefinition._stroke._strokeAlpha = shadowFontDefinition._fontAlpha;
 
-        auto texture = new (std::nothrow) Texture2D;
-        texture->initWithString(_utf8Text, shadowFontDefinition);
-        _shadowNode = Sprite::createWithTexture(texture);
-        texture->release();
+        _shadowNode = createSystemFontSprite(shadowFontDefinition);
     }
 
     if (_shadowNode)
@@ -1328,13 +1802,7 @@ void Label::updateContent()
 
     if (_fontAtlas)
     {
-        std::u16string utf16String;
-        if (StringUtils::UTF8ToUTF16(_utf8Text, utf16String))
-        {
-            _utf16Text = utf16String;
-        }
-
-        computeHorizontalKernings(_utf16Text);
+        // setString() converted the text, alignText() computes the kernings when the layout isn't cached
         updateFinished = alignText();
     }
     else
@@ -1347,6 +1815,15 @@ void Label::updateContent()
         }
     }
 
+    updateDecorations();
+
+    if(updateFinished){
+        _contentDirty = false;
+    }
+}
+
+void Label::updateDecorations()
+{
     if (_underlineNode)
     {
         _underlineNode->clear();
@@ -1382,10 +1859,6 @@ void Label::updateContent()
         }
     }
 
-    if(updateFinished){
-        _contentDirty = false;
-    }
-
 #if CC_LABEL_DEBUG_DRAW
     _debugDrawNode->clear();
     Vec2 vertices[4] =
@@ -1416,7 +1889,7 @@ void Label::onDrawShadow(GLProgram* glProgram, const Color4F& shadowColor)
     {
         glProgram->setUniformLocationWith4f(_uniformTextColor,
             shadowColor.r, shadowColor.g, shadowColor.b, shadowColor.a);
-        if (_currLabelEffect == LabelEffect::OUTLINE || _currLabelEffect == LabelEffect::GLOW)
+        if (_currLabelEffect == LabelEffect::OUTLINE || _currLabelEffect == LabelEffect::GLOW || _useMSDF)
         {
             glProgram->setUniformLocationWith4f(_uniformEffectColor,
                 shadowColor.r, shadowColor.g, shadowColor.b, shadowColor.a);
@@ -1454,12 +1927,42 @@ void Label::onDrawShadow(GLProgram* glProgram, const Color4F& shadowColor)
     }
 }
 
+void Label::updateMSDFUniforms(GLProgram* glProgram, const Mat4& transform)
+{
+    // the screen pixels of an atlas pixel, from the scale of the letters, the node and the view
+    float nodeScale = (sqrtf(transform.m[0] * transform.m[0] + transform.m[1] * transform.m[1])
+        + sqrtf(transform.m[4] * transform.m[4] + transform.m[5] * transform.m[5])) / 2;
+    auto glview = Director::getInstance()->getOpenGLView();
+    float viewScale = glview ? glview->getScaleX() : 1.0f;
+    float screenScale = _bmfontScale * nodeScale * viewScale / CC_CONTENT_SCALE_FACTOR();
+
+    // a unit of the field spans both sides of the edges
+    float fieldRange = 2.0f * FontFreeType::MSDFSpread;
+    glProgram->setUniformLocationWith1f(_uniformDistanceScale, std::max(fieldRange * screenScale, 1.0f));
+
+    if (_currLabelEffect == LabelEffect::OUTLINE)
+    {
+        // the outline is in points of the label, it can't be wider than the field
+        float outlineWidth = _fontConfig.outlineSize * CC_CONTENT_SCALE_FACTOR() / std::max(_bmfontScale, FLT_EPSILON) / fieldRange;
+        glProgram->setUniformLocationWith1f(_uniformOutlineWidth, std::min(outlineWidth, 0.45f));
+    }
+    else
+    {
+        glProgram->setUniformLocationWith1f(_uniformOutlineWidth, 0.0f);
+    }
+}
+
 void Label::onDraw(const Mat4& transform, bool transformUpdated)
 {
     auto glprogram = getGLProgram();
     glprogram->use();
     GL::blendFunc(_blendFunc.src, _blendFunc.dst);
 
+    if (_useMSDF)
+    {
+        updateMSDFUniforms(glprogram, transform);
+    }
+
     if (_shadowEnabled)
     {
         if (_boldEnabled)
@@ -1474,7 +1977,23 @@ void Label::onDraw(const Mat4& transform, bool transformUpdated)
         it.second->updateTransform();
     }
 
-    if (_currentLabelType == LabelType::TTF)
+    if (_currentLabelType == LabelType::TTF && _useMSDF)
+    {
+        // the outline and the glow are drawn with the text, without the outline the edges blend to the text color
+        glprogram->setUniformLocationWith4f(_uniformTextColor,
+            _textColorF.r, _textColorF.g, _textColorF.b, _textColorF.a);
+        if (_currLabelEffect == LabelEffect::OUTLINE || _currLabelEffect == LabelEffect::GLOW)
+        {
+            glprogram->setUniformLocationWith4f(_uniformEffectColor,
+                _effectColorF.r, _effectColorF.g, _effectColorF.b, _effectColorF.a);
+        }
+        else
+        {
+            glprogram->setUniformLocationWith4f(_uniformEffectColor,
+                _textColorF.r, _textColorF.g, _textColorF.b, _textColorF.a);
+        }
+    }
+    else if (_currentLabelType == LabelType::TTF)
     {
         switch (_currLabelEffect) {
         case LabelEffect::OUTLINE:
@@ -1524,7 +2043,18 @@ void Label::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
     if (_insideBounds)
 #endif
     {
-        if (!_shadowEnabled && (_currentLabelType == LabelType::BMFONT || _currentLabelType == LabelType::CHARMAP))
+        if (isSinglePassEffect())
+        {
+            if (_effectQuadsDirty)
+            {
+                updateEffectQuads();
+            }
+            auto texture = _batchNodes.at(0)->getTextureAtlas()->getTexture();
+            _quadCommand.init(_globalZOrder, texture->getName(), GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_LABEL_EFFECT),
+                _blendFunc, _effectQuads.data(), _effectQuads.size(), transform, flags);
+            renderer->addCommand(&_quadCommand);
+        }
+        else if (!_shadowEnabled && (_currentLabelType == LabelType::BMFONT || _currentLabelType == LabelType::CHARMAP))
         {
             for (auto&& it : _letters)
             {
@@ -1545,6 +2075,68 @@ void Label::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
     }
 }
 
+bool Label::isSinglePassEffect() const
+{
+    if (!s_isSinglePassEffectsEnabled || _currentLabelType != LabelType::TTF || _useDistanceField || _useMSDF
+        || _batchNodes.size() != 1 || !_letters.empty())
+    {
+        return false;
+    }
+
+    // without the outline the text color is a uniform of the A8 program only
+    if (_currLabelEffect != LabelEffect::OUTLINE && !(_currLabelEffect == LabelEffect::NORMAL && _shadowEnabled && _useA8Shader))
+    {
+        return false;
+    }
+
+    auto format = _batchNodes.at(0)->getTextureAtlas()->getTexture()->getPixelFormat();
+    return format == Texture2D::PixelFormat::A8 || format == Texture2D::PixelFormat::AI88;
+}
+
+// A layer of updateEffectQuads(): the quads in a color, moved by the offset. The vertex alpha tells the effect shader
+// what to draw, from 0 to 126 the letters and from 129 to 255 the letters with their outline.
+static void appendEffectLayer(std::vector<V3F_C4B_T2F_Quad>& effectQuads, const V3F_C4B_T2F_Quad* quads, ssize_t count,
+    const Color4F& color, bool withOutline, const Vec3& offset)
+{
+    for (ssize_t i = 0; i < count; ++i)
+    {
+        V3F_C4B_T2F_Quad quad = quads[i];
+        for (auto vertex : { &quad.bl, &quad.br, &quad.tl, &quad.tr })
+        {
+            vertex->vertices += offset;
+            vertex->colors.r = (GLubyte)(vertex->colors.r * color.r);
+            vertex->colors.g = (GLubyte)(vertex->colors.g * color.g);
+            vertex->colors.b = (GLubyte)(vertex->colors.b * color.b);
+            auto alpha = (GLubyte)(vertex->colors.a * color.a * 126 / 255);
+            vertex->colors.a = withOutline ? 129 + alpha : alpha;
+        }
+        effectQuads.push_back(quad);
+    }
+}
+
+void Label::updateEffectQuads()
+{
+    auto textureAtlas = _batchNodes.at(0)->getTextureAtlas();
+    auto quads = textureAtlas->getQuads();
+    ssize_t count = textureAtlas->getTotalQuads();
+    bool outline = _currLabelEffect == LabelEffect::OUTLINE;
+
+    // drawn in the order of onDraw(): the shadow, the outline, then the text over them
+    _effectQuads.clear();
+    _effectQuads.reserve(count * ((_shadowEnabled ? 1 : 0) + (outline ? 1 : 0) + 1));
+    if (_shadowEnabled)
+    {
+        appendEffectLayer(_effectQuads, quads, count, _boldEnabled ? _textColorF : _shadowColor4F, outline, _effectShadowOffset);
+    }
+    if (outline)
+    {
+        appendEffectLayer(_effectQuads, quads, count, _effectColorF, true, Vec3::ZERO);
+    }
+    appendEffectLayer(_effectQuads, quads, count, _textColorF, false, Vec3::ZERO);
+
+    _effectQuadsDirty = false;
+}
+
 void Label::visit(Renderer *renderer, const Mat4 &parentTransform, uint32_t parentFlags)
 {
     if (! _visible || (_utf8Text.empty() && _children.empty()) )
@@ -1571,6 +2163,15 @@ void Label::visit(Renderer *renderer, const Mat4 &parentTransform, uint32_t pare
         _position.y -= _shadowOffset.height;
         _transformDirty = _inverseDirty = true;
 
+        // the offset is in the space of the parent, the layer of the shadow moves the quads in the space of the label
+        Vec3 offset(_shadowOffset.width, _shadowOffset.height, 0);
+        getNodeToParentTransform().getInversed().transformVector(&offset);
+        if (offset != _effectShadowOffset)
+        {
+            _effectShadowOffset = offset;
+            _effectQuadsDirty = true;
+        }
+
         _shadowDirty = false;
     }
 
@@ -1611,6 +2212,158 @@ void Label::visit(Renderer *renderer, const Mat4 &parentTransform, uint32_t pare
     _director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
 }
 
+void Label::onEnter()
+{
+    Node::onEnter();
+
+    // e.g. the labels of a screen that opens, created with their text before they're added
+    if (_contentDirty)
+    {
+        deferLayout();
+    }
+}
+
+void Label::deferLayout()
+{
+    if (!s_isParallelLayoutEnabled || _isLayoutPending || !_running)
+    {
+        return;
+    }
+
+    if (s_pendingLayouts.empty())
+    {
+        auto scheduler = _director->getScheduler();
+        if (!scheduler->isScheduled(PARALLEL_LAYOUT_KEY, &s_pendingLayouts))
+        {
+            // the custom callbacks run after the per-frame updates, so the labels changed by them are in the list by then
+            scheduler->schedule([](float) { Label::updatePendingLayouts(); }, &s_pendingLayouts, 0, false, PARALLEL_LAYOUT_KEY);
+        }
+    }
+
+    // retained until the layout runs, the label may be removed by a later update of the frame
+    this->retain();
+    _isLayoutPending = true;
+    s_pendingLayouts.push_back(this);
+}
+
+void Label::setParallelLayoutEnabled(bool enabled)
+{
+    if (s_isParallelLayoutEnabled == enabled)
+    {
+        return;
+    }
+
+    s_isParallelLayoutEnabled = enabled;
+    if (!enabled)
+    {
+        updatePendingLayouts();
+        Director::getInstance()->getScheduler()->unschedule(PARALLEL_LAYOUT_KEY, &s_pendingLayouts);
+    }
+}
+
+void Label::updatePendingLayouts()
+{
+    if (s_pendingLayouts.empty())
+    {
+        return;
+    }
+
+    CC_TRACE_ZONE("label", "Label::updatePendingLayouts");
+
+    std::vector<Label*> labels;
+    labels.swap(s_pendingLayouts);
+
+    // The letters are rasterized, the kernings read from the fonts and the layouts looked up in the LabelLayoutCache
+    // here. The other labels are laid out by their visit.
+    std::vector<Label*> layouts;
+    std::vector<bool> cached;
+    std::vector<Size> contentSizes;
+    for (auto label : labels)
+    {
+        if (!label->_contentDirty || label->_systemFontDirty || label->_fontAtlas == nullptr || label->_utf16Text.empty()
+            || label->_overflow == Overflow::SHRINK || !label->_running || !label->_visible)
+        {
+            label->_isLayoutPending = false;
+            continue;
+        }
+
+        CC_SAFE_RELEASE_NULL(label->_textSprite);
+        CC_SAFE_RELEASE_NULL(label->_shadowNode);
+        Size contentSize = label->_contentSize;
+        if (!label->prepareLetters() || label->_waitingForLetters)
+        {
+            label->_isLayoutPending = false;
+            continue;
+        }
+
+        bool layoutCached = label->restoreLayoutFromCache();
+        if (!layoutCached)
+        {
+            label->computeHorizontalKernings(label->_utf16Text);
+        }
+        layouts.push_back(label);
+        cached.push_back(layoutCached);
+        contentSizes.push_back(contentSize);
+    }
+
+    // _isLayoutPending stays set meanwhile, the size of the labels is only stored, see setLayoutContentSize()
+    auto task = [&layouts, &cached](int index) {
+        Label* label = layouts[index];
+        if (!cached[index])
+        {
+            label->layoutLetters();
+        }
+        label->computeLetterQuads();
+    };
+    if (layouts.size() > 1)
+    {
+        JobSystem::getInstance()->parallelFor(0, (int)layouts.size(), task, 1);
+    }
+    else if (!layouts.empty())
+    {
+        task(0);
+    }
+
+    for (size_t index = 0; index < layouts.size(); ++index)
+    {
+        Label* label = layouts[index];
+        label->_isLayoutPending = false;
+
+        // set again to tell the ancestors
+        Size contentSize = label->_contentSize;
+        label->_contentSize = contentSizes[index];
+        label->setContentSize(contentSize);
+
+        if (!cached[index])
+        {
+            label->addLayoutToCache();
+        }
+        label->commitLetterQuads();
+        label->updateLabelLetters();
+        label->updateColor();
+        label->updateDecorations();
+        label->_contentDirty = false;
+    }
+
+    for (auto label : labels)
+    {
+        label->release();
+    }
+}
+
+void Label::setLayoutContentSize(const Size& size)
+{
+    // the workers of updatePendingLayouts() leave the ancestors alone, it sets the size again on the main thread
+    if (_isLayoutPending)
+    {
+        _contentSize = size;
+    }
+    else
+    {
+        setContentSize(size);
+    }
+}
+
 void Label::drawSelf(Renderer* renderer, uint32_t flags)
 {
     if (_textSprite)
@@ -1623,6 +2376,7 @@ void Label::drawSelf(Renderer* renderer, uint32_t flags)
     }
     else if (!_utf8Text.empty())
     {
+        Renderer::setDebugOwner(this);
         draw(renderer, _modelViewTransform, flags);
     }
 }
@@ -1633,6 +2387,7 @@ void Label::setSystemFontName(const std::string& systemFont)
     {
         _systemFont = systemFont;
         _systemFontDirty = true;
+        invalidateCachedTexture();
     }
 }
 
@@ -1643,6 +2398,7 @@ void Label::setSystemFontSize(float fontSize)
         _systemFontSize = fontSize;
         _originalFontSize = fontSize;
         _systemFontDirty = true;
+        invalidateCachedTexture();
     }
 }
 
@@ -1717,7 +2473,7 @@ void Label::setLineHeight(float height)
     if (_lineHeight != height)
     {
         _lineHeight = height;
-        _contentDirty = true;
+        markContentDirty();
     }
 }
 
@@ -1732,7 +2488,7 @@ void Label::setLineSpacing(float height)
     if (_lineSpacing != height)
     {
         _lineSpacing = height;
-        _contentDirty = true;
+        markContentDirty();
     }
 }
 
@@ -1749,7 +2505,7 @@ void Label::setAdditionalKerning(float space)
         if (_additionalKerning != space)
         {
             _additionalKerning = space;
-            _contentDirty = true;
+            markContentDirty();
         }
     }
     else
@@ -1830,7 +2586,7 @@ void Label::updateDisplayedColor(const Color3B& parentColor)
         }
 
         if (_underlineNode)
-            _contentDirty = true;
+            markContentDirty();
     }
 
     for (auto&& it : _letters)
@@ -1864,10 +2620,11 @@ void Label::setTextColor(const Color4B &color)
 
     if (_currentLabelType == LabelType::STRING_TEXTURE && _textColor != color)
     {
-        _contentDirty = true;
+        markContentDirty();
     }
 
     _textColor = color;
+    _effectQuadsDirty = true;
     _textColorF.r = _textColor.r / 255.0f;
     _textColorF.g = _textColor.g / 255.0f;
     _textColorF.b = _textColor.b / 255.0f;
@@ -1881,6 +2638,15 @@ void Label::updateColor()
         return;
     }
 
+    for (auto&& batchNode:_batchNodes)
+    {
+        auto textureAtlas = batchNode->getTextureAtlas();
+        updateQuadsColor(textureAtlas, 0, textureAtlas->getTotalQuads());
+    }
+}
+
+void Label::updateQuadsColor(TextureAtlas* textureAtlas, ssize_t index, ssize_t count)
+{
     Color4B color4( _displayedColor.r, _displayedColor.g, _displayedColor.b, _displayedOpacity );
 
     // special opacity for premultiplied textures
@@ -1891,22 +2657,17 @@ void Label::updateColor()
         color4.b *= _displayedOpacity/255.0f;
     }
 
-    cocos2d::TextureAtlas* textureAtlas;
-    V3F_C4B_T2F_Quad *quads;
-    for (auto&& batchNode:_batchNodes)
-    {
-        textureAtlas = batchNode->getTextureAtlas();
-        quads = textureAtlas->getQuads();
-        auto count = textureAtlas->getTotalQuads();
+    // every change of the quads ends here, see updateEffectQuads()
+    _effectQuadsDirty = true;
 
-        for (int index = 0; index < count; ++index)
-        {
-            quads[index].bl.colors = color4;
-            quads[index].br.colors = color4;
-            quads[index].tl.colors = color4;
-            quads[index].tr.colors = color4;
-            textureAtlas->updateQuad(&quads[index], index);
-        }
+    V3F_C4B_T2F_Quad *quads = textureAtlas->getQuads();
+    for (ssize_t end = index + count; index < end; ++index)
+    {
+        quads[index].bl.colors = color4;
+        quads[index].br.colors = color4;
+        quads[index].tl.colors = color4;
+        quads[index].tr.colors = color4;
+        textureAtlas->updateQuad(&quads[index], index);
     }
 }
 
@@ -2048,7 +2809,7 @@ void Label::enableWrap(bool enable)
 
     this->rescaleWithOriginalFontSize();
 
-    _contentDirty = true;
+    markContentDirty();
 }
 
 bool Label::isWrapEnabled()const
@@ -2082,7 +2843,7 @@ void Label::setOverflow(Overflow overflow)
 
     this->rescaleWithOriginalFontSize();
 
-    _contentDirty = true;
+    markContentDirty();
 }
 
 void Label::rescaleWithOriginalFontSize()
@@ -2100,21 +2861,16 @@ Label::Overflow Label::getOverflow()const
 
 void Label::updateLetterSpriteScale(Sprite* sprite)
 {
-    if (_currentLabelType == LabelType::BMFONT && _bmFontSize > 0)
-    {
-        sprite->setScale(_bmfontScale);
-    }
-    else
+    sprite->setScale(getLetterScale());
+}
+
+float Label::getLetterScale() const
+{
+    if ((_currentLabelType == LabelType::BMFONT && _bmFontSize > 0) || _useMSDF)
     {
-        if(fabs(_bmFontSize)<FLT_EPSILON)
-        {
-            sprite->setScale(0);
-        }
-        else
-        {
-            sprite->setScale(1.0);
-        }
+        return _bmfontScale;
     }
+    return fabs(_bmFontSize) < FLT_EPSILON ? 0.f : 1.f;
 }
 
 NS_CC_END
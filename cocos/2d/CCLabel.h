@@ -60,9 +60,15 @@ typedef struct _ttfConfig
     bool underline;
     bool strikethrough;
 
+    /** Renders the letters from a multi-channel signed distance field atlas, shared by all the sizes of the font.
+     The outline and the glow are drawn by the shader in the same pass as the letters. @since v3.11
+     */
+    bool msdfEnabled;
+
     _ttfConfig(const std::string& filePath = "",float size = 12, const GlyphCollection& glyphCollection = GlyphCollection::DYNAMIC,
         const char *customGlyphCollection = nullptr, bool useDistanceField = false, int outline = 0,
-               bool useItalics = false, bool useBold = false, bool useUnderline = false, bool useStrikethrough = false)
+               bool useItalics = false, bool useBold = false, bool useUnderline = false, bool useStrikethrough = false,
+               bool useMSDF = false)
         : fontFilePath(filePath)
         , fontSize(size)
         , glyphs(glyphCollection)
@@ -73,8 +79,9 @@ typedef struct _ttfConfig
         , bold(useBold)
         , underline(useUnderline)
         , strikethrough(useStrikethrough)
+        , msdfEnabled(useMSDF)
     {
-        if(outline > 0)
+        if(outline > 0 || useMSDF)
         {
             distanceFieldEnabled = false;
         }
@@ -84,6 +91,8 @@ typedef struct _ttfConfig
 class Sprite;
 class SpriteBatchNode;
 class DrawNode;
+class TextureAtlas;
+struct LabelLayoutKey;
 class EventListenerCustom;
 
 /**
@@ -517,6 +526,35 @@ public:
     /** Update content immediately.*/
     virtual void updateContent();
 
+    /** Enables/Disables the parallel layout of the labels.
+     When enabled, the labels whose layout is out of date when they enter the scene, or later while they're in it,
+     are laid out together on the JobSystem after the per-frame updates of the Scheduler and before the visit.
+     The line breaks, the letter positions and the quads of each label are computed on a worker; the letters are
+     rasterized and the quads copied into the TextureAtlases on the main thread.
+     The system fonts, the labels that shrink to their dimensions and the ones whose letters are still being
+     rasterized are laid out by their visit as before.
+     Enabled by default when CC_LABEL_PARALLEL_LAYOUT is 1.
+     @since v3.11
+     */
+    static void setParallelLayoutEnabled(bool enabled);
+    /** Whether or not the labels are laid out in parallel.
+     @since v3.11
+     */
+    static bool isParallelLayoutEnabled() { return s_isParallelLayoutEnabled; }
+
+    /** Enables/Disables drawing the outline and the shadow of the TTF labels with their text, in one QuadCommand.
+     The shadow, the outline and the text are layers of copies of the quads drawn by one program, instead of a pass
+     each with the colors in uniforms, so the labels with effects batch with the other ones on the same atlas page.
+     The labels with distance field or MSDF fonts, more than one atlas page, or letters from getLetter() draw as before.
+     Enabled by default when CC_LABEL_SINGLE_PASS_EFFECTS is 1.
+     @since v3.11
+     */
+    static void setSinglePassEffectsEnabled(bool enabled) { s_isSinglePassEffectsEnabled = enabled; }
+    /** Whether or not the effects of the TTF labels are drawn with their text.
+     @since v3.11
+     */
+    static bool isSinglePassEffectsEnabled() { return s_isSinglePassEffectsEnabled; }
+
     /**
      * Provides a way to treat each character like a Sprite.
      * @warning No support system font.
@@ -577,6 +615,7 @@ public:
 
     virtual void visit(Renderer *renderer, const Mat4 &parentTransform, uint32_t parentFlags) override;
     virtual void draw(Renderer *renderer, const Mat4 &transform, uint32_t flags) override;
+    virtual void onEnter() override;
 
     virtual void removeAllChildrenWithCleanup(bool cleanup) override;
     virtual void removeChild(Node* child, bool cleanup = true) override;
@@ -626,11 +665,14 @@ protected:
     };
 
     virtual void setFontAtlas(FontAtlas* atlas, bool distanceFieldEnabled = false, bool useA8Shader = false);
+    virtual Node* cloneInstance() const override;
+    virtual bool isInternalChild(const Node* child) const override;
 
     void computeStringNumLines();
 
     void onDraw(const Mat4& transform, bool transformUpdated);
     void onDrawShadow(GLProgram* glProgram, const Color4F& shadowColor);
+    void updateMSDFUniforms(GLProgram* glProgram, const Mat4& transform);
     void drawSelf(Renderer* renderer, uint32_t flags);
 
     bool multilineTextWrapByChar();
@@ -644,15 +686,38 @@ protected:
 
     void updateLabelLetters();
     virtual bool alignText();
+    // the start of alignText(): rasterizes the letters and creates the batch nodes, returns false without any batch node
+    bool prepareLetters();
+    // the line breaks, the letter positions and the alignment, from the kernings
+    void layoutLetters();
+    // the end of updateContent(): the underline and the debug draw of the laid out text
+    void updateDecorations();
     void computeAlignmentOffset();
     bool computeHorizontalKernings(const std::u16string& stringToRender);
 
     void recordLetterInfo(const cocos2d::Vec2& point, char16_t utf16Char, int letterIndex, int lineIndex);
     void recordPlaceholderInfo(int letterIndex, char16_t utf16Char);
+    float typesetLine(int lineStart, int lineEnd, int lineIndex);
+    void getLayoutCacheKey(LabelLayoutKey& key);
+    bool restoreLayoutFromCache();
+    void addLayoutToCache();
 
     bool updateQuads();
+    // the quads of updateQuads() without shrinking, into _letterQuads instead of the atlases: it only touches the label
+    void computeLetterQuads();
+    // replaces the quads of the atlases with _letterQuads
+    void commitLetterQuads();
+    // the quad _reusedLetter gives a letter, the top left of its rect at (x, y)
+    V3F_C4B_T2F_Quad getLetterQuad(Texture2D* texture, const Rect& rect, float x, float y) const;
+    bool updateStringIncrementally(const std::u16string& oldText);
+    void updateQuadsColor(TextureAtlas* textureAtlas, ssize_t index, ssize_t count);
+    // whether the effects are drawn with the text from _effectQuads, see setSinglePassEffectsEnabled()
+    bool isSinglePassEffect() const;
+    // the layers of the shadow, the outline and the text from the quads of the atlas
+    void updateEffectQuads();
 
     void createSpriteForSystemFont(const FontDefinition& fontDef);
+    Sprite* createSystemFontSprite(const FontDefinition& fontDef);
     void createShadowSpriteForSystemFont(const FontDefinition& fontDef);
 
     virtual void updateShaderProgram();
@@ -663,6 +728,14 @@ protected:
     bool isHorizontalClamped(float letterPositionX, int lineInex);
     void restoreFontSize();
     void updateLetterSpriteScale(Sprite* sprite);
+    float getLetterScale() const;
+
+    // queues the label for updatePendingLayouts() when its layout is out of date in a running scene
+    void deferLayout();
+    // lays out the queued labels in parallel, see setParallelLayoutEnabled()
+    static void updatePendingLayouts();
+    // the size found by the layout
+    void setLayoutContentSize(const Size& size);
 
     void reset();
 
@@ -670,6 +743,9 @@ protected:
 
     virtual void updateColor() override;
 
+    /// Marks the layout out of date, it's done again by the next visit.
+    void markContentDirty() { _contentDirty = true; invalidateCachedTexture(); deferLayout(); }
+
     LabelType _currentLabelType;
     bool _contentDirty;
     std::u16string _utf16Text;
@@ -677,6 +753,7 @@ protected:
     int _numberOfLines;
 
     std::string _bmFontPath;
+    Vec2 _bmFontImageOffset;
     TTFConfig _fontConfig;
     float _outlineSize;
 
@@ -725,7 +802,10 @@ protected:
     Mat4  _shadowTransform;
     GLuint _uniformEffectColor;
     GLuint _uniformTextColor;
+    GLuint _uniformDistanceScale;
+    GLuint _uniformOutlineWidth;
     bool _useDistanceField;
+    bool _useMSDF;
     bool _useA8Shader;
 
     bool _shadowDirty;
@@ -750,6 +830,9 @@ protected:
 
     EventListenerCustom* _purgeTextureListener;
     EventListenerCustom* _resetTextureListener;
+    EventListenerCustom* _updateTextureListener;
+    // the layout skipped letters that the atlas is rasterizing in the background
+    bool _waitingForLetters;
 
 #if CC_LABEL_DEBUG_DRAW
     DrawNode* _debugDrawNode;
@@ -764,6 +847,21 @@ protected:
     bool _boldEnabled;
     DrawNode* _underlineNode;
     bool _strikethroughEnabled;
+
+    /** whether the label waits for updatePendingLayouts(), or is being laid out by it */
+    bool _isLayoutPending;
+    /** the quads of each batch node computed by a worker, until commitLetterQuads() */
+    std::vector<std::vector<V3F_C4B_T2F_Quad>> _letterQuads;
+
+    /** the quads of the shadow, the outline and the text drawn in one command, see updateEffectQuads() */
+    std::vector<V3F_C4B_T2F_Quad> _effectQuads;
+    bool _effectQuadsDirty;
+    /** the shadow offset in the space of the label */
+    Vec3 _effectShadowOffset;
+
+    static bool s_isParallelLayoutEnabled;
+    static bool s_isSinglePassEffectsEnabled;
+    static std::vector<Label*> s_pendingLayouts;
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(Label);
 };
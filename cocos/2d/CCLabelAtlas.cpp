@@ -26,6 +26,8 @@ THE SOFTWARE.
 ****************************************************************************/
 #include "2d/CCLabelAtlas.h"
 #include "renderer/CCTextureAtlas.h"
+#include "2d/CCSpriteFrame.h"
+#include "2d/CCSpriteFrameCache.h"
 #include "platform/CCFileUtils.h"
 #include "base/CCDirector.h"
 #include "renderer/CCTextureCache.h"
@@ -84,6 +86,58 @@ bool LabelAtlas::initWithString(const std::string& string, Texture2D* texture, i
     return false;
 }
 
+LabelAtlas* LabelAtlas::createWithSpriteFrame(const std::string& string, SpriteFrame* spriteFrame, int itemWidth, int itemHeight, int startCharMap)
+{
+    LabelAtlas* ret = new (std::nothrow) LabelAtlas();
+    if(ret && ret->initWithSpriteFrame(string, spriteFrame, itemWidth, itemHeight, startCharMap))
+    {
+        ret->autorelease();
+        return ret;
+    }
+    CC_SAFE_DELETE(ret);
+    return nullptr;
+}
+
+LabelAtlas* LabelAtlas::createWithSpriteFrameName(const std::string& string, const std::string& spriteFrameName, int itemWidth, int itemHeight, int startCharMap)
+{
+    SpriteFrame* spriteFrame = SpriteFrameCache::getInstance()->getSpriteFrameByName(spriteFrameName);
+#if COCOS2D_DEBUG > 0
+    char msg[256] = {0};
+    sprintf(msg, "Invalid spriteFrameName: %s", spriteFrameName.c_str());
+    CCASSERT(spriteFrame != nullptr, msg);
+#endif
+    return createWithSpriteFrame(string, spriteFrame, itemWidth, itemHeight, startCharMap);
+}
+
+bool LabelAtlas::initWithSpriteFrame(const std::string& string, SpriteFrame* spriteFrame, int itemWidth, int itemHeight, int startCharMap)
+{
+    if (spriteFrame == nullptr)
+    {
+        log("LabelAtlas::initWithSpriteFrame error:spriteFrame is nullptr!!");
+        return false;
+    }
+    if (spriteFrame->isRotated())
+    {
+        log("LabelAtlas::initWithSpriteFrame error:the char map can't be a rotated sprite frame");
+        return false;
+    }
+
+    _charMapRect = spriteFrame->getRectInPixels();
+    if (! AtlasNode::initWithTexture(spriteFrame->getTexture(), itemWidth, itemHeight, static_cast<int>(string.size())))
+    {
+        return false;
+    }
+
+    // the items in the frame, not in the whole texture
+    Size size = CC_SIZE_PIXELS_TO_POINTS(_charMapRect.size);
+    _itemsPerRow = (int)(size.width / _itemWidth);
+    _itemsPerColumn = (int)(size.height / _itemHeight);
+
+    _mapStartChar = startCharMap;
+    this->setString(string);
+    return true;
+}
+
 LabelAtlas* LabelAtlas::create(const std::string& string, const std::string& fntFile)
 {
     LabelAtlas *ret = new (std::nothrow) LabelAtlas();
@@ -129,13 +183,16 @@ bool LabelAtlas::initWithString(const std::string& theString, const std::string&
 //CCLabelAtlas - Atlas generation
 void LabelAtlas::updateAtlasValues()
 {
-    if(_itemsPerRow == 0)
+    updateQuads(0, _string.length());
+}
+
+void LabelAtlas::updateQuads(ssize_t begin, ssize_t end)
+{
+    if(_itemsPerRow == 0 || begin >= end)
     {
         return;
     }
 
-    ssize_t n = _string.length();
-
     const unsigned char *s = (unsigned char*)_string.c_str();
 
     Texture2D *texture = _textureAtlas->getTexture();
@@ -148,10 +205,20 @@ void LabelAtlas::updateAtlasValues()
         itemWidthInPixels = _itemWidth;
         itemHeightInPixels = _itemHeight;
     }
+    float originX = _charMapRect.origin.x;
+    float originY = _charMapRect.origin.y;
 
-    CCASSERT(n <= _textureAtlas->getCapacity(), "updateAtlasValues: Invalid String length");
+    Color4B c(_displayedColor.r, _displayedColor.g, _displayedColor.b, _displayedOpacity);
+    if (_isOpacityModifyRGB)
+    {
+        c.r *= _displayedOpacity/255.0f;
+        c.g *= _displayedOpacity/255.0f;
+        c.b *= _displayedOpacity/255.0f;
+    }
+
+    CCASSERT(end <= _textureAtlas->getCapacity(), "updateAtlasValues: Invalid String length");
     V3F_C4B_T2F_Quad* quads = _textureAtlas->getQuads();
-    for(ssize_t i = 0; i < n; i++) {
+    for(ssize_t i = begin; i < end; i++) {
 
         unsigned char a = s[i] - _mapStartChar;
         float row = (float) (a % _itemsPerRow);
@@ -159,14 +226,14 @@ void LabelAtlas::updateAtlasValues()
 
 #if CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
         // Issue #938. Don't use texStepX & texStepY
-        float left        = (2 * row * itemWidthInPixels + 1) / (2 * textureWide);
+        float left        = (2 * (originX + row * itemWidthInPixels) + 1) / (2 * textureWide);
         float right        = left + (itemWidthInPixels * 2 - 2) / (2 * textureWide);
-        float top        = (2 * col * itemHeightInPixels + 1) / (2 * textureHigh);
+        float top        = (2 * (originY + col * itemHeightInPixels) + 1) / (2 * textureHigh);
         float bottom    = top + (itemHeightInPixels * 2 - 2) / (2 * textureHigh);
 #else
-        float left        = row * itemWidthInPixels / textureWide;
+        float left        = (originX + row * itemWidthInPixels) / textureWide;
         float right        = left + itemWidthInPixels / textureWide;
-        float top        = col * itemHeightInPixels / textureHigh;
+        float top        = (originY + col * itemHeightInPixels) / textureHigh;
         float bottom    = top + itemHeightInPixels / textureHigh;
 #endif // ! CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
 
@@ -191,32 +258,56 @@ void LabelAtlas::updateAtlasValues()
         quads[i].tr.vertices.x = (float)(i * _itemWidth + _itemWidth);
         quads[i].tr.vertices.y = (float)(_itemHeight);
         quads[i].tr.vertices.z = 0.0f;
-        Color4B c(_displayedColor.r, _displayedColor.g, _displayedColor.b, _displayedOpacity);
         quads[i].tl.colors = c;
         quads[i].tr.colors = c;
         quads[i].bl.colors = c;
         quads[i].br.colors = c;
     }
-    if (n > 0 ){
-        _textureAtlas->setDirty(true);
-        ssize_t totalQuads = _textureAtlas->getTotalQuads();
-        if (n > totalQuads) {
-            _textureAtlas->increaseTotalQuadsWith(static_cast<int>(n - totalQuads));
-        }
+
+    _textureAtlas->setDirtyRange(begin, end - begin);
+    ssize_t totalQuads = _textureAtlas->getTotalQuads();
+    if (end > totalQuads) {
+        _textureAtlas->increaseTotalQuadsWith(static_cast<int>(end - totalQuads));
     }
 }
 
 //CCLabelAtlas - LabelProtocol
 void LabelAtlas::setString(const std::string &label)
 {
+    if (label == _string)
+    {
+        return;
+    }
+
     ssize_t len = label.size();
-    if (len > _textureAtlas->getTotalQuads())
+    ssize_t capacity = _textureAtlas->getCapacity();
+    if (len > capacity)
     {
-        _textureAtlas->resizeCapacity(len);
+        // grows ahead of the string, e.g. a score gaining digits
+        _textureAtlas->resizeCapacity(std::max(len, capacity + capacity / 2));
     }
-    _string.clear();
+
+    std::string previous;
+    previous.swap(_string);
     _string = label;
-    this->updateAtlasValues();
+
+    // the quad of a character only depends on the character and its index, only the changed ones are rebuilt
+    const ssize_t previousLen = previous.size();
+    ssize_t i = 0;
+    while (i < len)
+    {
+        if (i < previousLen && label[i] == previous[i])
+        {
+            ++i;
+            continue;
+        }
+        ssize_t begin = i;
+        while (i < len && (i >= previousLen || label[i] != previous[i]))
+        {
+            ++i;
+        }
+        this->updateQuads(begin, i);
+    }
 
     Size s = Size(len * _itemWidth, _itemHeight);
 
@@ -249,7 +340,10 @@ void LabelAtlas::updateColor()
             quads[index].br.colors = color4;
             quads[index].tl.colors = color4;
             quads[index].tr.colors = color4;
-            _textureAtlas->updateQuad(&quads[index], index);
+        }
+        if (length > 0)
+        {
+            _textureAtlas->setDirtyRange(0, length);
         }
     }
 }
@@ -34,6 +34,8 @@ THE SOFTWARE.
 #endif
 NS_CC_BEGIN
 
+class SpriteFrame;
+
 /**
  * @addtogroup _2d
  * @{
@@ -51,6 +53,9 @@ NS_CC_BEGIN
  * - LabelAtlas "characters" can be anything you want since they are taken from an image file.
  *
  * A more flexible class is LabelBMFont. It supports variable width characters and it also has a nice editor.
+ *
+ * setString() only rebuilds the quads of the characters that changed. The quads are drawn with a QuadCommand,
+ * so the labels and the sprites of the same texture are drawn in one batch, see createWithSpriteFrame().
  */
 class CC_DLL LabelAtlas : public AtlasNode, public LabelProtocol
 {
@@ -70,6 +75,20 @@ public:
      */
     static LabelAtlas* create(const std::string& string, const std::string& fntFile);
 
+    /**
+     * Creates the LabelAtlas with a string and a char map packed as a sprite frame, e.g. the digits of a UI atlas.
+     * The label draws from the texture of the frame, in the same batch as the sprites of that atlas.
+     * The items fill the rect of the frame row by row from its top left corner, the frame can't be rotated or trimmed.
+     * @since v3.11
+     */
+    static LabelAtlas* createWithSpriteFrame(const std::string& string, SpriteFrame* spriteFrame, int itemWidth, int itemHeight, int startCharMap);
+
+    /**
+     * Same as createWithSpriteFrame() with the name of a frame of the SpriteFrameCache.
+     * @since v3.11
+     */
+    static LabelAtlas* createWithSpriteFrameName(const std::string& string, const std::string& spriteFrameName, int itemWidth, int itemHeight, int startCharMap);
+
     /** Initializes the LabelAtlas with a string, a char map file(the atlas), the width and height of each element and the starting char of the atlas. */
     bool initWithString(const std::string& string, const std::string& charMapFile, int itemWidth, int itemHeight, int startCharMap);
 
@@ -82,6 +101,12 @@ public:
     /** Initializes the LabelAtlas with a string, a texture, the width and height in points of each element and the starting char of the atlas */
     bool initWithString(const std::string& string, Texture2D* texture, int itemWidth, int itemHeight, int startCharMap);
 
+    /**
+     * Initializes the LabelAtlas with a string and a char map packed as a sprite frame, see createWithSpriteFrame().
+     * @since v3.11
+     */
+    bool initWithSpriteFrame(const std::string& string, SpriteFrame* spriteFrame, int itemWidth, int itemHeight, int startCharMap);
+
     virtual void setString(const std::string &label) override;
     virtual const std::string& getString() const override;
 
@@ -98,6 +123,7 @@ public:
 CC_CONSTRUCTOR_ACCESS:
     LabelAtlas()
     :_string("")
+    , _mapStartChar(0)
     {
 #if CC_LABELATLAS_DEBUG_DRAW
         _debugDrawNode = DrawNode::create();
@@ -112,6 +138,8 @@ CC_CONSTRUCTOR_ACCESS:
 
 protected:
     virtual void updateColor() override;
+    // rebuilds the quads of the characters from `begin` to `end`
+    void updateQuads(ssize_t begin, ssize_t end);
 
 #if CC_LABELATLAS_DEBUG_DRAW
     DrawNode *_debugDrawNode;
@@ -121,6 +149,8 @@ protected:
     std::string _string;
     // the first char in the char map
     int _mapStartChar;
+    // the rect of the char map in the texture in pixels, the whole texture when it's empty
+    Rect _charMapRect;
 };
 
 // end group
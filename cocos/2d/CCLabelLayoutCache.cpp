@@ -0,0 +1,132 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "2d/CCLabelLayoutCache.h"
+
+#include <functional>
+
+NS_CC_BEGIN
+
+LabelLayoutCache::LayoutList LabelLayoutCache::_layouts;
+std::unordered_map<LabelLayoutKey, LabelLayoutCache::LayoutList::iterator, LabelLayoutCache::KeyHash> LabelLayoutCache::_layoutMap;
+size_t LabelLayoutCache::_capacity = CC_LABEL_LAYOUT_CACHE_SIZE;
+
+bool LabelLayoutKey::operator==(const LabelLayoutKey& other) const
+{
+    return fontAtlas == other.fontAtlas
+        && maxLineWidth == other.maxLineWidth
+        && labelWidth == other.labelWidth
+        && labelHeight == other.labelHeight
+        && lineHeight == other.lineHeight
+        && lineSpacing == other.lineSpacing
+        && additionalKerning == other.additionalKerning
+        && bmfontScale == other.bmfontScale
+        && contentScaleFactor == other.contentScaleFactor
+        && hAlignment == other.hAlignment
+        && vAlignment == other.vAlignment
+        && enableWrap == other.enableWrap
+        && lineBreakWithoutSpaces == other.lineBreakWithoutSpaces
+        && text == other.text;
+}
+
+size_t LabelLayoutCache::KeyHash::operator()(const LabelLayoutKey& key) const
+{
+    // the text and the atlas tell most layouts apart, the rest is compared by operator==
+    size_t hash = std::hash<std::u16string>()(key.text);
+    hash ^= std::hash<FontAtlas*>()(key.fontAtlas) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    hash ^= std::hash<float>()(key.maxLineWidth + key.labelWidth) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+const LabelLayout* LabelLayoutCache::getLayout(const LabelLayoutKey& key)
+{
+    auto it = _layoutMap.find(key);
+    if (it == _layoutMap.end())
+    {
+        return nullptr;
+    }
+
+    _layouts.splice(_layouts.begin(), _layouts, it->second);
+    return &it->second->second;
+}
+
+void LabelLayoutCache::addLayout(const LabelLayoutKey& key, LabelLayout&& layout)
+{
+    if (_capacity == 0)
+    {
+        return;
+    }
+
+    auto it = _layoutMap.find(key);
+    if (it != _layoutMap.end())
+    {
+        it->second->second = std::move(layout);
+        _layouts.splice(_layouts.begin(), _layouts, it->second);
+        return;
+    }
+
+    while (_layouts.size() >= _capacity)
+    {
+        _layoutMap.erase(_layouts.back().first);
+        _layouts.pop_back();
+    }
+
+    _layouts.emplace_front(key, std::move(layout));
+    _layoutMap[key] = _layouts.begin();
+}
+
+void LabelLayoutCache::removeLayoutsForFontAtlas(FontAtlas* fontAtlas)
+{
+    for (auto it = _layouts.begin(); it != _layouts.end();)
+    {
+        if (it->first.fontAtlas == fontAtlas)
+        {
+            _layoutMap.erase(it->first);
+            it = _layouts.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void LabelLayoutCache::purge()
+{
+    _layoutMap.clear();
+    _layouts.clear();
+}
+
+void LabelLayoutCache::setCapacity(size_t capacity)
+{
+    _capacity = capacity;
+    while (_layouts.size() > _capacity)
+    {
+        _layoutMap.erase(_layouts.back().first);
+        _layouts.pop_back();
+    }
+}
+
+NS_CC_END
@@ -0,0 +1,129 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef _CCLabelLayoutCache_h_
+#define _CCLabelLayoutCache_h_
+
+/// @cond DO_NOT_SHOW
+
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "base/ccTypes.h"
+
+NS_CC_BEGIN
+
+class FontAtlas;
+
+/** What the layout of a Label depends on, besides the glyphs of the atlas. */
+struct CC_DLL LabelLayoutKey
+{
+    FontAtlas* fontAtlas;
+    std::u16string text;
+    float maxLineWidth;
+    float labelWidth;
+    float labelHeight;
+    float lineHeight;
+    float lineSpacing;
+    float additionalKerning;
+    float bmfontScale;
+    float contentScaleFactor;
+    TextHAlignment hAlignment;
+    TextVAlignment vAlignment;
+    bool enableWrap;
+    bool lineBreakWithoutSpaces;
+
+    bool operator==(const LabelLayoutKey& other) const;
+};
+
+/** The letter positions and line metrics multilineTextWrap() and computeAlignmentOffset() give to a Label. */
+struct CC_DLL LabelLayout
+{
+    struct Letter
+    {
+        char16_t utf16Char;
+        bool valid;
+        float positionX;
+        float positionY;
+        int lineIndex;
+    };
+
+    std::vector<Letter> letters;
+    std::vector<int> horizontalKernings;
+    std::vector<float> linesWidth;
+    std::vector<float> linesOffsetX;
+    int numberOfLines;
+    float textDesiredHeight;
+    float letterOffsetY;
+    float tailoredTopY;
+    float tailoredBottomY;
+    Size contentSize;
+};
+
+/**
+ LabelLayoutCache keeps the most recently used layouts, so the labels showing the same string
+ with the same font and options share one line breaking instead of computing their own.
+ The layouts of an atlas are dropped when FontAtlasCache releases or purges it.
+ */
+class CC_DLL LabelLayoutCache
+{
+public:
+    /** Returns the layout of `key` and marks it as the most recently used, or nullptr.
+     The pointer is valid until the next call to addLayout() or one of the remove functions.
+     */
+    static const LabelLayout* getLayout(const LabelLayoutKey& key);
+
+    /** Adds the layout of `key`, evicting the least recently used one when the cache is full. */
+    static void addLayout(const LabelLayoutKey& key, LabelLayout&& layout);
+
+    /** Removes the layouts made with `fontAtlas`. */
+    static void removeLayoutsForFontAtlas(FontAtlas* fontAtlas);
+
+    /** Removes all the layouts. */
+    static void purge();
+
+    /** Sets how many layouts are kept, 0 disables the cache. It defaults to CC_LABEL_LAYOUT_CACHE_SIZE. */
+    static void setCapacity(size_t capacity);
+    static size_t getCapacity() { return _capacity; }
+
+    static size_t getLayoutCount() { return _layouts.size(); }
+
+private:
+    struct KeyHash
+    {
+        size_t operator()(const LabelLayoutKey& key) const;
+    };
+    typedef std::list<std::pair<LabelLayoutKey, LabelLayout>> LayoutList;
+
+    static LayoutList _layouts;
+    static std::unordered_map<LabelLayoutKey, LayoutList::iterator, KeyHash> _layoutMap;
+    static size_t _capacity;
+};
+
+NS_CC_END
+
+/// @endcond
+#endif
@@ -29,6 +29,8 @@
 #include "base/CCDirector.h"
 #include "2d/CCFontAtlas.h"
 #include "2d/CCFontFNT.h"
+#include "2d/CCFontFreeType.h"
+#include "2d/CCLabelLayoutCache.h"
 
 NS_CC_BEGIN
 
@@ -106,6 +108,9 @@ void Label::updateBMFontScale()
         FontFNT *bmFont = (FontFNT*)font;
         float originalFontSize = bmFont->getOriginalFontSize();
         _bmfontScale = _bmFontSize * CC_CONTENT_SCALE_FACTOR() / originalFontSize;
+    }else if (_useMSDF){
+        // the multi-channel distance field atlas is rasterized at one size for all of them
+        _bmfontScale = _fontConfig.fontSize / FontFreeType::MSDFFontSize;
     }else{
         _bmfontScale = 1.0f;
     }
@@ -186,7 +191,7 @@ bool Label::multilineTextWrap(std::function<int(const std::u16string&, int, int)
             recordLetterInfo(letterPosition, character, letterIndex, lineIndex);
 
             if (_horizontalKernings && letterIndex < textLen - 1)
-                nextLetterX += _horizontalKernings[letterIndex + 1];
+                nextLetterX += _useMSDF ? _horizontalKernings[letterIndex + 1] * _bmfontScale : _horizontalKernings[letterIndex + 1];
             nextLetterX += letterDef.xAdvance * _bmfontScale + _additionalKerning;
 
             tokenRight = letterPosition.x + letterDef.width * _bmfontScale;
@@ -225,7 +230,7 @@ bool Label::multilineTextWrap(std::function<int(const std::u16string&, int, int)
         contentSize.width = longestLine;
     if (_labelHeight <= 0.f)
         contentSize.height = _textDesiredHeight;
-    setContentSize(contentSize);
+    setLayoutContentSize(contentSize);
 
     _tailoredTopY = contentSize.height;
     _tailoredBottomY = 0.f;
@@ -237,6 +242,158 @@ bool Label::multilineTextWrap(std::function<int(const std::u16string&, int, int)
     return true;
 }
 
+float Label::typesetLine(int lineStart, int lineEnd, int lineIndex)
+{
+    // the same positions as multilineTextWrap() gives to a line that doesn't wrap
+    int textLen = getStringLength();
+    auto contentScaleFactor = CC_CONTENT_SCALE_FACTOR();
+    float lineSpacing = _lineSpacing * contentScaleFactor;
+    float nextTokenY = -lineIndex * (_lineHeight*_bmfontScale + lineSpacing);
+    float nextLetterX = 0.f;
+    float letterRight = 0.f;
+    FontLetterDefinition letterDef;
+    Vec2 letterPosition;
+
+    for (int letterIndex = lineStart; letterIndex < lineEnd; ++letterIndex)
+    {
+        auto character = _utf16Text[letterIndex];
+        if (character == '\r')
+        {
+            recordPlaceholderInfo(letterIndex, character);
+            continue;
+        }
+        if (_fontAtlas->getLetterDefinitionForChar(character, letterDef) == false)
+        {
+            recordPlaceholderInfo(letterIndex, character);
+            CCLOG("LabelTextFormatter error:can't find letter definition in font file for letter: %c", character);
+            continue;
+        }
+
+        letterPosition.x = (nextLetterX + letterDef.offsetX * _bmfontScale) / contentScaleFactor;
+        letterPosition.y = (nextTokenY - letterDef.offsetY * _bmfontScale) / contentScaleFactor;
+        recordLetterInfo(letterPosition, character, letterIndex, lineIndex);
+
+        if (_horizontalKernings && letterIndex < textLen - 1)
+            nextLetterX += _useMSDF ? _horizontalKernings[letterIndex + 1] * _bmfontScale : _horizontalKernings[letterIndex + 1];
+        nextLetterX += letterDef.xAdvance * _bmfontScale + _additionalKerning;
+
+        letterRight = letterPosition.x + letterDef.width * _bmfontScale;
+    }
+
+    return letterRight;
+}
+
+void Label::getLayoutCacheKey(LabelLayoutKey& key)
+{
+    key.fontAtlas = _fontAtlas;
+    key.text = _utf16Text;
+    key.maxLineWidth = _maxLineWidth;
+    key.labelWidth = _labelWidth;
+    key.labelHeight = _labelHeight;
+    key.lineHeight = _lineHeight;
+    key.lineSpacing = _lineSpacing;
+    key.additionalKerning = _additionalKerning;
+    key.bmfontScale = _bmfontScale;
+    key.contentScaleFactor = CC_CONTENT_SCALE_FACTOR();
+    key.hAlignment = _hAlignment;
+    key.vAlignment = _vAlignment;
+    key.enableWrap = _enableWrap;
+    key.lineBreakWithoutSpaces = _lineBreakWithoutSpaces;
+}
+
+bool Label::restoreLayoutFromCache()
+{
+    // shrinking changes the letter definitions, and pending letters aren't valid yet
+    if (_overflow == Overflow::SHRINK || _waitingForLetters || LabelLayoutCache::getCapacity() == 0)
+    {
+        return false;
+    }
+
+    this->updateBMFontScale();
+
+    LabelLayoutKey key;
+    getLayoutCacheKey(key);
+    auto layout = LabelLayoutCache::getLayout(key);
+    if (layout == nullptr)
+    {
+        return false;
+    }
+
+    _lengthOfString = getStringLength();
+    if (_lettersInfo.size() < layout->letters.size())
+    {
+        _lettersInfo.resize(layout->letters.size());
+    }
+    for (size_t index = 0; index < layout->letters.size(); ++index)
+    {
+        auto& letter = layout->letters[index];
+        auto& letterInfo = _lettersInfo[index];
+        letterInfo.utf16Char = letter.utf16Char;
+        letterInfo.valid = letter.valid;
+        letterInfo.positionX = letter.positionX;
+        letterInfo.positionY = letter.positionY;
+        letterInfo.lineIndex = letter.lineIndex;
+    }
+
+    delete [] _horizontalKernings;
+    _horizontalKernings = nullptr;
+    if (!layout->horizontalKernings.empty())
+    {
+        _horizontalKernings = new (std::nothrow) int[layout->horizontalKernings.size()];
+        if (_horizontalKernings)
+            std::copy(layout->horizontalKernings.begin(), layout->horizontalKernings.end(), _horizontalKernings);
+    }
+
+    _linesWidth = layout->linesWidth;
+    _linesOffsetX = layout->linesOffsetX;
+    _numberOfLines = layout->numberOfLines;
+    _textDesiredHeight = layout->textDesiredHeight;
+    _letterOffsetY = layout->letterOffsetY;
+    _tailoredTopY = layout->tailoredTopY;
+    _tailoredBottomY = layout->tailoredBottomY;
+    setContentSize(layout->contentSize);
+
+    return true;
+}
+
+void Label::addLayoutToCache()
+{
+    if (_overflow == Overflow::SHRINK || _waitingForLetters || LabelLayoutCache::getCapacity() == 0)
+    {
+        return;
+    }
+
+    LabelLayoutKey key;
+    getLayoutCacheKey(key);
+
+    LabelLayout layout;
+    layout.letters.resize(_lengthOfString);
+    for (int index = 0; index < _lengthOfString; ++index)
+    {
+        auto& letterInfo = _lettersInfo[index];
+        auto& letter = layout.letters[index];
+        letter.utf16Char = letterInfo.utf16Char;
+        letter.valid = letterInfo.valid;
+        letter.positionX = letterInfo.positionX;
+        letter.positionY = letterInfo.positionY;
+        letter.lineIndex = letterInfo.lineIndex;
+    }
+    if (_horizontalKernings)
+    {
+        layout.horizontalKernings.assign(_horizontalKernings, _horizontalKernings + _lengthOfString);
+    }
+    layout.linesWidth = _linesWidth;
+    layout.linesOffsetX = _linesOffsetX;
+    layout.numberOfLines = _numberOfLines;
+    layout.textDesiredHeight = _textDesiredHeight;
+    layout.letterOffsetY = _letterOffsetY;
+    layout.tailoredTopY = _tailoredTopY;
+    layout.tailoredBottomY = _tailoredBottomY;
+    layout.contentSize = _contentSize;
+
+    LabelLayoutCache::addLayout(key, std::move(layout));
+}
+
 bool Label::multilineTextWrapByWord()
 {
     return multilineTextWrap(std::bind(getFirstWordLen, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
@@ -344,7 +501,9 @@ void Label::recordLetterInfo(const cocos2d::Vec2& point, char16_t utf16Char, int
     }
     _lettersInfo[letterIndex].lineIndex = lineIndex;
     _lettersInfo[letterIndex].utf16Char = utf16Char;
-    _lettersInfo[letterIndex].valid = _fontAtlas->_letterDefinitions[utf16Char].validDefinition;
+    // find(), the parallel layout of the labels of the same atlas reads the definitions at the same time
+    auto letterDef = _fontAtlas->_letterDefinitions.find(utf16Char);
+    _lettersInfo[letterIndex].valid = letterDef != _fontAtlas->_letterDefinitions.end() && letterDef->second.validDefinition;
     _lettersInfo[letterIndex].positionX = point.x;
     _lettersInfo[letterIndex].positionY = point.y;
 }
@@ -0,0 +1,621 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "2d/CCLargeImage.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "base/CCAsyncTaskPool.h"
+#include "base/CCDirector.h"
+#include "platform/CCFileUtils.h"
+#include "platform/CCGLView.h"
+#include "platform/CCImage.h"
+#include "renderer/CCGLProgramState.h"
+#include "renderer/CCQuadCommand.h"
+#include "renderer/CCRenderer.h"
+#include "renderer/CCTexture2D.h"
+#include "renderer/CCTextureCache.h"
+
+NS_CC_BEGIN
+
+// the tiles that are neither loaded nor drawn are forgotten after these frames
+static const unsigned int FORGET_TILE_FRAMES = 120;
+
+static int getLevelSize(int size, int level)
+{
+    return std::max(1, (size + (1 << level) - 1) >> level);
+}
+
+LargeImage* LargeImage::create(const std::string& filename)
+{
+    LargeImage* ret = new (std::nothrow) LargeImage();
+    if (ret && ret->initWithFile(filename))
+    {
+        ret->autorelease();
+        return ret;
+    }
+    CC_SAFE_DELETE(ret);
+    return nullptr;
+}
+
+LargeImage::LargeImage()
+: _imageWidth(0)
+, _imageHeight(0)
+, _tileSize(0)
+, _loadedTiles(0)
+, _maxLoadedTiles(32)
+, _prefetchBorder(1)
+, _frame(0)
+, _blendFunc(BlendFunc::ALPHA_PREMULTIPLIED)
+, _quadColor(Color4B::WHITE)
+, _alive(std::make_shared<bool>(true))
+{
+}
+
+LargeImage::~LargeImage()
+{
+    *_alive = false;
+    for (auto& entry : _tiles)
+    {
+        releaseTile(&entry.second);
+    }
+}
+
+bool LargeImage::initWithFile(const std::string& filename)
+{
+    if (!Node::init())
+    {
+        return false;
+    }
+    setGLProgramState(GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP));
+
+    auto fileUtils = FileUtils::getInstance();
+    const std::string fullPath = fileUtils->fullPathForFilename(filename);
+    if (fullPath.empty())
+    {
+        CCLOG("cocos2d: LargeImage: can't find %s", filename.c_str());
+        return false;
+    }
+
+    if (fileUtils->getFileExtension(fullPath) == ".plist")
+    {
+        return initWithPyramid(fullPath);
+    }
+
+    // the image is split once into the writable path, again when its size changes
+    std::string name = filename;
+    std::replace(name.begin(), name.end(), '/', '_');
+    std::replace(name.begin(), name.end(), '.', '_');
+    const std::string plistFile = fileUtils->getWritablePath() + "largeimage/" + name + ".plist";
+    if (fileUtils->isFileExist(plistFile))
+    {
+        ValueMap dict = fileUtils->getValueMapFromFile(plistFile);
+        auto iter = dict.find("sourceSize");
+        if (iter != dict.end() && iter->second.asInt() == (int)fileUtils->getFileSize(fullPath))
+        {
+            return initWithPyramid(plistFile);
+        }
+    }
+
+    auto alive = _alive;
+    auto split = std::make_shared<bool>(false);
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO, [this, alive, split, plistFile](void*) {
+        if (*alive && *split)
+        {
+            initWithPyramid(plistFile);
+        }
+    }, nullptr, [fullPath, plistFile, split]() {
+        *split = splitImage(fullPath, plistFile);
+    });
+    return true;
+}
+
+bool LargeImage::initWithPyramid(const std::string& plistFile)
+{
+    ValueMap dict = FileUtils::getInstance()->getValueMapFromFile(plistFile);
+    int width = dict["width"].asInt();
+    int height = dict["height"].asInt();
+    int tileSize = dict["tileSize"].asInt();
+    int levels = dict["levels"].asInt();
+    const std::string tiles = dict["tiles"].asString();
+    if (width <= 0 || height <= 0 || tileSize <= 0 || levels <= 0 || levels > 24 || tiles.empty())
+    {
+        CCLOG("cocos2d: LargeImage: %s is not a valid pyramid", plistFile.c_str());
+        return false;
+    }
+
+    _imageWidth = width;
+    _imageHeight = height;
+    _tileSize = tileSize;
+    _tileFormat = plistFile.substr(0, plistFile.find_last_of('/') + 1) + tiles;
+
+    _levels.clear();
+    for (int i = 0; i < levels; ++i)
+    {
+        Level level;
+        level.width = getLevelSize(width, i);
+        level.height = getLevelSize(height, i);
+        level.columns = (level.width + tileSize - 1) / tileSize;
+        level.rows = (level.height + tileSize - 1) / tileSize;
+        _levels.push_back(level);
+    }
+
+    setContentSize(Size(width, height) / CC_CONTENT_SCALE_FACTOR());
+
+    // the last level is drawn when nothing finer is loaded, it is loaded first and kept
+    const Level& last = _levels.back();
+    for (int row = 0; row < last.rows; ++row)
+    {
+        for (int column = 0; column < last.columns; ++column)
+        {
+            requestTile(getTile(levels - 1, column, row), true);
+        }
+    }
+    return true;
+}
+
+uint64_t LargeImage::getTileKey(int level, int column, int row)
+{
+    return ((uint64_t)level << 48) | ((uint64_t)(uint32_t)row << 24) | (uint64_t)(uint32_t)column;
+}
+
+LargeImage::Tile* LargeImage::getTile(int level, int column, int row)
+{
+    uint64_t key = getTileKey(level, column, row);
+    auto iter = _tiles.find(key);
+    if (iter == _tiles.end())
+    {
+        Tile tile;
+        tile.level = level;
+        tile.column = column;
+        tile.row = row;
+        tile.texture = nullptr;
+        tile.loading = false;
+        tile.usedFrame = _frame;
+        iter = _tiles.emplace(key, tile).first;
+    }
+    return &iter->second;
+}
+
+void LargeImage::requestTile(Tile* tile, bool visible)
+{
+    if (tile->loading || tile->texture)
+    {
+        return;
+    }
+    tile->loading = true;
+
+    char path[1024];
+    snprintf(path, sizeof(path), _tileFormat.c_str(), tile->level, tile->column, tile->row);
+
+    auto priority = tile->level == (int)_levels.size() - 1 ? TextureCache::AsyncPriority::CRITICAL
+                  : visible ? TextureCache::AsyncPriority::VISIBLE : TextureCache::AsyncPriority::PREFETCH;
+    uint64_t key = getTileKey(tile->level, tile->column, tile->row);
+    auto alive = _alive;
+    _director->getTextureCache()->addImageAsync(path, [this, alive, key](Texture2D* texture) {
+        if (*alive)
+        {
+            onTileLoaded(key, texture);
+        }
+        else if (texture)
+        {
+            Director::getInstance()->getTextureCache()->removeTexture(texture);
+        }
+    }, priority);
+}
+
+void LargeImage::onTileLoaded(uint64_t key, Texture2D* texture)
+{
+    auto iter = _tiles.find(key);
+    if (iter == _tiles.end() || !iter->second.loading)
+    {
+        // forgotten while it was loading
+        if (texture)
+        {
+            _director->getTextureCache()->removeTexture(texture);
+        }
+        return;
+    }
+
+    // a tile that failed stays loading, it isn't requested again
+    Tile& tile = iter->second;
+    if (texture == nullptr)
+    {
+        CCLOG("cocos2d: LargeImage: can't load the tile %d %d %d", tile.level, tile.column, tile.row);
+        return;
+    }
+
+    tile.loading = false;
+    tile.texture = texture;
+    texture->retain();
+    // the neighbor tiles aren't sampled, the edges are clamped
+    Texture2D::TexParams params = { GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE };
+    texture->setTexParameters(params);
+    ++_loadedTiles;
+}
+
+void LargeImage::releaseTile(Tile* tile)
+{
+    if (tile->texture)
+    {
+        _director->getTextureCache()->removeTexture(tile->texture);
+        tile->texture->release();
+        tile->texture = nullptr;
+        --_loadedTiles;
+    }
+}
+
+void LargeImage::releaseUnusedTiles()
+{
+    const int lastLevel = (int)_levels.size() - 1;
+
+    if (_loadedTiles > _maxLoadedTiles)
+    {
+        std::vector<Tile*> unused;
+        for (auto& entry : _tiles)
+        {
+            Tile& tile = entry.second;
+            if (tile.texture && tile.usedFrame != _frame && tile.level != lastLevel)
+            {
+                unused.push_back(&tile);
+            }
+        }
+        std::sort(unused.begin(), unused.end(), [](const Tile* a, const Tile* b) {
+            return a->usedFrame < b->usedFrame;
+        });
+        for (size_t i = 0; i < unused.size() && _loadedTiles > _maxLoadedTiles; ++i)
+        {
+            releaseTile(unused[i]);
+        }
+    }
+
+    // the tiles that were only requested, or released above
+    for (auto iter = _tiles.begin(); iter != _tiles.end();)
+    {
+        const Tile& tile = iter->second;
+        if (!tile.texture && !tile.loading && _frame - tile.usedFrame > FORGET_TILE_FRAMES)
+            iter = _tiles.erase(iter);
+        else
+            ++iter;
+    }
+}
+
+void LargeImage::addDraw(Tile* source, int level, int column, int row)
+{
+    Texture2D* texture = source->texture;
+    source->usedFrame = _frame;
+
+    // the area of the tile (level, column, row) in the pixels of the full image, y going down
+    const int span = _tileSize << level;
+    const int x0 = column * span;
+    const int y0 = row * span;
+    const int x1 = std::min(x0 + span, _imageWidth);
+    const int y1 = std::min(y0 + span, _imageHeight);
+
+    // the same area in the texture of the source tile, which may be coarser
+    const float sourceScale = 1.0f / (1 << source->level);
+    const float originX = (float)source->column * _tileSize;
+    const float originY = (float)source->row * _tileSize;
+    const Size& pixels = texture->getContentSizeInPixels();
+    const float maxS = texture->getMaxS() / pixels.width;
+    const float maxT = texture->getMaxT() / pixels.height;
+    const float u0 = (x0 * sourceScale - originX) * maxS;
+    const float u1 = (x1 * sourceScale - originX) * maxS;
+    const float v0 = (y0 * sourceScale - originY) * maxT;
+    const float v1 = (y1 * sourceScale - originY) * maxT;
+
+    const float scale = 1.0f / CC_CONTENT_SCALE_FACTOR();
+    const float left = x0 * scale;
+    const float right = x1 * scale;
+    const float top = (_imageHeight - y0) * scale;
+    const float bottom = (_imageHeight - y1) * scale;
+
+    Draw draw;
+    draw.texture = texture;
+    V3F_C4B_T2F_Quad& quad = draw.quad;
+    quad.tl.vertices.set(left, top, 0);
+    quad.tl.texCoords.u = u0;
+    quad.tl.texCoords.v = v0;
+    quad.bl.vertices.set(left, bottom, 0);
+    quad.bl.texCoords.u = u0;
+    quad.bl.texCoords.v = v1;
+    quad.tr.vertices.set(right, top, 0);
+    quad.tr.texCoords.u = u1;
+    quad.tr.texCoords.v = v0;
+    quad.br.vertices.set(right, bottom, 0);
+    quad.br.texCoords.u = u1;
+    quad.br.texCoords.v = v1;
+    quad.tl.colors = quad.bl.colors = quad.tr.colors = quad.br.colors = _quadColor;
+    _draws.push_back(draw);
+}
+
+int LargeImage::pickLevel(const Mat4& transform) const
+{
+    // the screen pixels per pixel of the full image
+    const float worldScale = std::sqrt(transform.m[0] * transform.m[0] + transform.m[1] * transform.m[1]);
+    const float pixelScale = worldScale * _director->getOpenGLView()->getScaleX() / CC_CONTENT_SCALE_FACTOR();
+    if (pixelScale <= 0)
+    {
+        return (int)_levels.size() - 1;
+    }
+
+    // the coarsest level that still has a pixel per screen pixel
+    int level = (int)std::floor(std::log2(1.0f / pixelScale));
+    return clampf(level, 0, (int)_levels.size() - 1);
+}
+
+Rect LargeImage::getVisibleRect(const Mat4& transform) const
+{
+    // the screen in the space of the node, for the default 2D camera like Renderer::checkVisibility()
+    const Size& winSize = _director->getWinSize();
+    const Mat4 inverse = transform.getInversed();
+    Vec3 corners[4] = { Vec3(0, 0, 0), Vec3(winSize.width, 0, 0), Vec3(0, winSize.height, 0), Vec3(winSize.width, winSize.height, 0) };
+
+    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+    for (auto& corner : corners)
+    {
+        inverse.transformPoint(&corner);
+        minX = std::min(minX, corner.x);
+        minY = std::min(minY, corner.y);
+        maxX = std::max(maxX, corner.x);
+        maxY = std::max(maxY, corner.y);
+    }
+    return Rect(minX, minY, maxX - minX, maxY - minY);
+}
+
+void LargeImage::draw(Renderer* renderer, const Mat4& transform, uint32_t flags)
+{
+    if (_levels.empty())
+    {
+        return;
+    }
+    ++_frame;
+    _draws.clear();
+
+    const int level = pickLevel(transform);
+    const Level& info = _levels[level];
+    const float span = (float)(_tileSize << level) / CC_CONTENT_SCALE_FACTOR();
+    const float height = _imageHeight / CC_CONTENT_SCALE_FACTOR();
+
+    // the tiles of the view, the rows go down from the top of the image
+    Rect view = getVisibleRect(transform);
+    int firstColumn = (int)std::floor(view.getMinX() / span);
+    int lastColumn = (int)std::ceil(view.getMaxX() / span) - 1;
+    int firstRow = (int)std::floor((height - view.getMaxY()) / span);
+    int lastRow = (int)std::ceil((height - view.getMinY()) / span) - 1;
+
+    const int border = _prefetchBorder;
+    for (int row = std::max(firstRow - border, 0); row <= std::min(lastRow + border, info.rows - 1); ++row)
+    {
+        for (int column = std::max(firstColumn - border, 0); column <= std::min(lastColumn + border, info.columns - 1); ++column)
+        {
+            Tile* tile = getTile(level, column, row);
+            tile->usedFrame = _frame;
+
+            bool visible = row >= firstRow && row <= lastRow && column >= firstColumn && column <= lastColumn;
+            if (!visible)
+            {
+                requestTile(tile, false);
+                continue;
+            }
+
+            if (tile->texture)
+            {
+                addDraw(tile, level, column, row);
+                continue;
+            }
+
+            // the closest coarser tile that is loaded, in the meantime
+            requestTile(tile, true);
+            for (int coarser = level + 1; coarser < (int)_levels.size(); ++coarser)
+            {
+                int shift = coarser - level;
+                auto iter = _tiles.find(getTileKey(coarser, column >> shift, row >> shift));
+                if (iter != _tiles.end() && iter->second.texture)
+                {
+                    addDraw(&iter->second, level, column, row);
+                    break;
+                }
+            }
+        }
+    }
+
+    releaseUnusedTiles();
+
+    if (_draws.empty())
+    {
+        return;
+    }
+
+    // one command per texture, a coarse tile may fill the place of several finer ones
+    std::stable_sort(_draws.begin(), _draws.end(), [](const Draw& a, const Draw& b) {
+        return a.texture < b.texture;
+    });
+    _quads.resize(_draws.size());
+    for (size_t i = 0; i < _draws.size(); ++i)
+    {
+        _quads[i] = _draws[i].quad;
+    }
+    // the commands and their quads only live for the frame
+    auto quads = renderer->copyFrameData(_quads.data(), _quads.size());
+
+    for (size_t begin = 0; begin < _draws.size();)
+    {
+        size_t end = begin + 1;
+        while (end < _draws.size() && _draws[end].texture == _draws[begin].texture)
+        {
+            ++end;
+        }
+
+        auto command = renderer->createFrameCommand<QuadCommand>();
+        command->init(_globalZOrder, _draws[begin].texture->getName(), getGLProgramState(), _blendFunc,
+                      quads + begin, end - begin, transform, flags);
+        renderer->addCommand(command);
+        begin = end;
+    }
+}
+
+void LargeImage::updateColor()
+{
+    // the textures have premultiplied alpha
+    float opacity = _displayedOpacity / 255.0f;
+    _quadColor = Color4B(_displayedColor.r * opacity, _displayedColor.g * opacity, _displayedColor.b * opacity, _displayedOpacity);
+}
+
+bool LargeImage::splitImage(const std::string& imageFile, const std::string& plistFile, int tileSize)
+{
+    auto fileUtils = FileUtils::getInstance();
+    const std::string fullPath = fileUtils->fullPathForFilename(imageFile);
+
+    Image* image = new (std::nothrow) Image();
+    if (image == nullptr || !image->initWithImageFile(fullPath) || image->isCompressed()
+        || (image->getRenderFormat() != Texture2D::PixelFormat::RGBA8888 && image->getRenderFormat() != Texture2D::PixelFormat::RGB888))
+    {
+        CCLOG("cocos2d: LargeImage: can't split %s, only the RGB and RGBA images can", imageFile.c_str());
+        CC_SAFE_DELETE(image);
+        return false;
+    }
+
+    // the tiles are written without premultiplied alpha, they are premultiplied again when loaded
+    const int fullWidth = image->getWidth();
+    const int fullHeight = image->getHeight();
+    int width = fullWidth;
+    int height = fullHeight;
+    std::vector<unsigned char> pixels((size_t)width * height * 4);
+    const unsigned char* data = image->getData();
+    const bool rgb = image->getRenderFormat() == Texture2D::PixelFormat::RGB888;
+    const bool premultiplied = image->hasPremultipliedAlpha();
+    for (size_t i = 0, n = (size_t)width * height; i < n; ++i)
+    {
+        unsigned char* out = &pixels[i * 4];
+        if (rgb)
+        {
+            out[0] = data[i * 3];
+            out[1] = data[i * 3 + 1];
+            out[2] = data[i * 3 + 2];
+            out[3] = 255;
+            continue;
+        }
+        memcpy(out, data + i * 4, 4);
+        if (premultiplied && out[3] > 0 && out[3] < 255)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                out[c] = (unsigned char)std::min(255, out[c] * 255 / out[3]);
+            }
+        }
+    }
+    delete image;
+
+    const std::string base = plistFile.substr(0, plistFile.find_last_of('.'));
+    const std::string directory = base.substr(base.find_last_of('/') + 1);
+    if (!fileUtils->createDirectory(base))
+    {
+        CCLOG("cocos2d: LargeImage: can't create %s", base.c_str());
+        return false;
+    }
+
+    bool ok = true;
+    int levels = 0;
+    std::vector<unsigned char> tilePixels;
+    while (ok)
+    {
+        const int columns = (width + tileSize - 1) / tileSize;
+        const int rows = (height + tileSize - 1) / tileSize;
+        for (int row = 0; ok && row < rows; ++row)
+        {
+            for (int column = 0; ok && column < columns; ++column)
+            {
+                const int x0 = column * tileSize;
+                const int y0 = row * tileSize;
+                const int tileWidth = std::min(tileSize, width - x0);
+                const int tileHeight = std::min(tileSize, height - y0);
+                tilePixels.resize((size_t)tileWidth * tileHeight * 4);
+                for (int y = 0; y < tileHeight; ++y)
+                {
+                    memcpy(&tilePixels[(size_t)y * tileWidth * 4], &pixels[((size_t)(y0 + y) * width + x0) * 4], tileWidth * 4);
+                }
+
+                Image tile;
+                char path[64];
+                snprintf(path, sizeof(path), "/%d_%d_%d.png", levels, column, row);
+                ok = tile.initWithRawData(tilePixels.data(), tilePixels.size(), tileWidth, tileHeight, 8)
+                    && tile.saveToFile(base + path, false);
+            }
+        }
+        ++levels;
+        if (columns == 1 && rows == 1)
+        {
+            break;
+        }
+
+        // the next level, a box filter over 2x2 pixels
+        const int nextWidth = std::max(1, (width + 1) / 2);
+        const int nextHeight = std::max(1, (height + 1) / 2);
+        std::vector<unsigned char> next((size_t)nextWidth * nextHeight * 4);
+        for (int y = 0; y < nextHeight; ++y)
+        {
+            const int sy0 = std::min(y * 2, height - 1);
+            const int sy1 = std::min(y * 2 + 1, height - 1);
+            for (int x = 0; x < nextWidth; ++x)
+            {
+                const int sx0 = std::min(x * 2, width - 1);
+                const int sx1 = std::min(x * 2 + 1, width - 1);
+                for (int c = 0; c < 4; ++c)
+                {
+                    int sum = pixels[((size_t)sy0 * width + sx0) * 4 + c] + pixels[((size_t)sy0 * width + sx1) * 4 + c]
+                            + pixels[((size_t)sy1 * width + sx0) * 4 + c] + pixels[((size_t)sy1 * width + sx1) * 4 + c];
+                    next[((size_t)y * nextWidth + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+                }
+            }
+        }
+        pixels.swap(next);
+        width = nextWidth;
+        height = nextHeight;
+    }
+
+    if (!ok)
+    {
+        CCLOG("cocos2d: LargeImage: can't write the tiles of %s", imageFile.c_str());
+        return false;
+    }
+
+    ValueMap dict;
+    dict["width"] = fullWidth;
+    dict["height"] = fullHeight;
+    dict["tileSize"] = tileSize;
+    dict["levels"] = levels;
+    dict["tiles"] = directory + "/%d_%d_%d.png";
+    // create() splits the image again when it changes
+    dict["sourceSize"] = (int)fileUtils->getFileSize(fullPath);
+    if (!fileUtils->writeValueMapToFile(dict, plistFile))
+    {
+        CCLOG("cocos2d: LargeImage: can't write %s", plistFile.c_str());
+        return false;
+    }
+    return true;
+}
+
+NS_CC_END
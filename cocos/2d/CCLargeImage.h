@@ -0,0 +1,192 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CCLARGE_IMAGE_H__
+#define __CCLARGE_IMAGE_H__
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "2d/CCNode.h"
+#include "renderer/CCQuadCommand.h"
+
+NS_CC_BEGIN
+
+class Texture2D;
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/**
+ LargeImage draws an image of any size from tiles that are loaded while they are on screen, e.g. a 16k world map.
+
+ The image is a pyramid of levels, each half the size of the previous one, cut in square tiles of `tileSize` pixels.
+ A plist describes it:
+   - width, height: the size of the full image in pixels
+   - tileSize: the size of the tiles in pixels, at most Configuration::getMaxTextureSize()
+   - levels: the number of levels, the last one fits in one tile
+   - tiles: the path of the tiles relative to the plist, with the level, the column and the row, e.g. "map/%d_%d_%d.png".
+     The rows go down from the top of the image.
+ splitImage() writes the plist and the tiles, offline from a desktop build.
+
+ Each frame, the level whose resolution is closest above the one on screen is picked from the scale of the node, and
+ its tiles in the view are loaded with TextureCache::addImageAsync(), the images are decoded on the loader threads.
+ The tiles of a border around the view are prefetched. Until a tile is loaded, the part of the closest coarser tile
+ that is loaded is drawn in its place; the last level is loaded first and never released. The tiles that aren't drawn
+ are released, the least recently drawn first, once more than getMaxLoadedTiles() are loaded.
+
+ The content size is the size of the image in points.
+
+ @code
+ auto map = LargeImage::create("worldmap.plist");
+ map->setMaxLoadedTiles(48);
+ scrollView->addChild(map);
+ @endcode
+ @since v3.11
+ @js NA
+ @lua NA
+ */
+class CC_DLL LargeImage : public Node
+{
+public:
+    /** The tile size of splitImage() by default. */
+    static const int DEFAULT_TILE_SIZE = 512;
+
+    /**
+     * Creates a LargeImage from the plist of a pyramid of tiles.
+     * Given an image file instead, the image is split on the IO thread into the writable path the first time,
+     * see splitImage(), and the node draws nothing until it is done. The image must fit in memory then.
+     */
+    static LargeImage* create(const std::string& filename);
+
+    /**
+     * Splits an image into the tiles of every level and writes them with their plist, as PNG files next to it.
+     * The whole image is decoded, meant for the offline tools or the images smaller than the memory.
+     * @param imageFile The image to split.
+     * @param plistFile The full path of the plist to write, the tiles go to a directory of the same name.
+     * @param tileSize The size of the tiles in pixels.
+     * @return Whether everything could be written.
+     */
+    static bool splitImage(const std::string& imageFile, const std::string& plistFile, int tileSize = DEFAULT_TILE_SIZE);
+
+    /** The most tiles kept loaded, 32 by default. The tiles on screen are kept even when they are more. */
+    void setMaxLoadedTiles(int count) { _maxLoadedTiles = count; }
+    int getMaxLoadedTiles() const { return _maxLoadedTiles; }
+
+    /** The tiles loaded around the view in advance, 1 by default. */
+    void setPrefetchBorder(int tiles) { _prefetchBorder = tiles; }
+    int getPrefetchBorder() const { return _prefetchBorder; }
+
+    /** The number of tiles that are loaded. */
+    int getLoadedTileCount() const { return _loadedTiles; }
+    /** Whether the pyramid was read, false while the image of create() is being split. */
+    bool isReady() const { return !_levels.empty(); }
+
+    /** The blend function, premultiplied alpha by default like the textures of the tiles. */
+    void setBlendFunc(const BlendFunc& blendFunc) { _blendFunc = blendFunc; }
+    const BlendFunc& getBlendFunc() const { return _blendFunc; }
+
+    // Overrides
+    virtual void draw(Renderer* renderer, const Mat4& transform, uint32_t flags) override;
+
+CC_CONSTRUCTOR_ACCESS:
+    LargeImage();
+    virtual ~LargeImage();
+
+    bool initWithFile(const std::string& filename);
+    bool initWithPyramid(const std::string& plistFile);
+
+protected:
+    virtual void updateColor() override;
+
+    struct Level
+    {
+        int width;
+        int height;
+        int columns;
+        int rows;
+    };
+
+    struct Tile
+    {
+        int level;
+        int column;
+        int row;
+        Texture2D* texture;
+        bool loading;
+        // the frame it was last drawn or prefetched in
+        unsigned int usedFrame;
+    };
+
+    // a quad of the frame, from a tile drawn in place of itself or of a finer one
+    struct Draw
+    {
+        Texture2D* texture;
+        V3F_C4B_T2F_Quad quad;
+    };
+
+    static uint64_t getTileKey(int level, int column, int row);
+    Tile* getTile(int level, int column, int row);
+    void requestTile(Tile* tile, bool visible);
+    void onTileLoaded(uint64_t key, Texture2D* texture);
+    void releaseTile(Tile* tile);
+    void releaseUnusedTiles();
+    void addDraw(Tile* source, int level, int column, int row);
+    int pickLevel(const Mat4& transform) const;
+    Rect getVisibleRect(const Mat4& transform) const;
+
+    std::vector<Level> _levels;
+    int _imageWidth;
+    int _imageHeight;
+    int _tileSize;
+    // the printf format of the tile paths, with the directory of the plist
+    std::string _tileFormat;
+
+    std::unordered_map<uint64_t, Tile> _tiles;
+    int _loadedTiles;
+    int _maxLoadedTiles;
+    int _prefetchBorder;
+    unsigned int _frame;
+
+    BlendFunc _blendFunc;
+    Color4B _quadColor;
+    std::vector<Draw> _draws;
+    std::vector<V3F_C4B_T2F_Quad> _quads;
+    // the callbacks of the loads and of the split compare it, they may outlive the node
+    std::shared_ptr<bool> _alive;
+
+private:
+    CC_DISALLOW_COPY_AND_ASSIGN(LargeImage);
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif // __CCLARGE_IMAGE_H__
@@ -81,6 +81,13 @@ std::string Layer::getDescription() const
     return StringUtils::format("<Layer | Tag = %d>", _tag);
 }
 
+Node* Layer::cloneInstance() const
+{
+    Layer* layer = Layer::create();
+    copyNodeState(layer);
+    return layer;
+}
+
 /// LayerColor
 
 LayerColor::LayerColor()
@@ -245,9 +252,9 @@ void LayerColor::onDraw(const Mat4& transform, uint32_t flags)
     //
     // Attributes
     //
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, 0, _noMVPVertices);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_FLOAT, GL_FALSE, 0, _squareColors);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
+    GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, 0, _noMVPVertices);
+    GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_FLOAT, GL_FALSE, 0, _squareColors);
 
     GL::blendFunc( _blendFunc.src, _blendFunc.dst );
 
@@ -261,6 +268,14 @@ std::string LayerColor::getDescription() const
     return StringUtils::format("<LayerColor | Tag = %d>", _tag);
 }
 
+Node* LayerColor::cloneInstance() const
+{
+    LayerColor* layer = LayerColor::create(Color4B(_realColor.r, _realColor.g, _realColor.b, _realOpacity), _contentSize.width, _contentSize.height);
+    layer->setBlendFunc(_blendFunc);
+    copyNodeState(layer);
+    return layer;
+}
+
 //
 // LayerGradient
 //
@@ -76,6 +76,10 @@ CC_CONSTRUCTOR_ACCESS:
     virtual ~Layer();
 
     virtual bool init() override;
+
+protected:
+    virtual Node* cloneInstance() const override;
+
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(Layer);
 
@@ -166,6 +170,7 @@ protected:
     void onDraw(const Mat4& transform, uint32_t flags);
 
     virtual void updateColor() override;
+    virtual Node* cloneInstance() const override;
 
     BlendFunc _blendFunc;
     Vec2 _squareVertices[4];
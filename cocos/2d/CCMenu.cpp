@@ -42,6 +42,14 @@ enum
     kDefaultPadding =  5,
 };
 
+// the most cells an item is placed in, the larger ones are tested for every touch
+static const int HIT_GRID_MAX_CELLS = 64;
+
+static int64_t hitGridCellKey(int x, int y)
+{
+    return ((int64_t)x << 32) | (uint32_t)y;
+}
+
 //
 //CCMenu
 //
@@ -246,6 +254,62 @@ void Menu::removeChild(Node* child, bool cleanup)
     }
 
     Node::removeChild(child, cleanup);
+    _hitGridDirty = true;
+}
+
+void Menu::visit(Renderer *renderer, const Mat4 &parentTransform, uint32_t parentFlags)
+{
+    // the indices of the items change with their order
+    if (_reorderChildDirty)
+    {
+        _hitGridDirty = true;
+    }
+    Layer::visit(renderer, parentTransform, parentFlags);
+}
+
+void Menu::setHitGridEnabled(bool enabled, float cellSize)
+{
+    CCASSERT(cellSize > 0, "The cells of the hit grid must have a size");
+    _hitGridEnabled = enabled;
+    _hitGridCellSize = cellSize;
+    _hitGridDirty = true;
+    if (!enabled)
+    {
+        _hitGridCells.clear();
+        _hitGridOversized.clear();
+    }
+}
+
+void Menu::buildHitGrid()
+{
+    _hitGridDirty = false;
+    _hitGridCells.clear();
+    _hitGridOversized.clear();
+    _hitGridChildCount = _children.size();
+
+    const float cellSize = _hitGridCellSize;
+    for (int i = 0; i < (int)_children.size(); ++i)
+    {
+        MenuItem* child = dynamic_cast<MenuItem*>(_children.at(i));
+        if (!child)
+            continue;
+
+        Rect bounds = child->getWorldBounds();
+        const int minX = (int)floorf(bounds.getMinX() / cellSize), maxX = (int)floorf(bounds.getMaxX() / cellSize);
+        const int minY = (int)floorf(bounds.getMinY() / cellSize), maxY = (int)floorf(bounds.getMaxY() / cellSize);
+        if ((int64_t)(maxX - minX + 1) * (maxY - minY + 1) > HIT_GRID_MAX_CELLS)
+        {
+            _hitGridOversized.push_back(i);
+            continue;
+        }
+        for (int y = minY; y <= maxY; ++y)
+        {
+            for (int x = minX; x <= maxX; ++x)
+            {
+                _hitGridCells[hitGridCellKey(x, y)].push_back(i);
+            }
+        }
+    }
 }
 
 //Menu - Events
@@ -555,24 +619,73 @@ void Menu::alignItemsInRowsWithArray(const ValueVector& columns)
 MenuItem* Menu::getItemForTouch(Touch *touch)
 {
     Vec2 touchLocation = touch->getLocation();
-    if (!_children.empty())
+    if (_children.empty())
+    {
+        return nullptr;
+    }
+
+    // the menu moved since the last visit, its items didn't see it yet
+    if (_transformUpdated)
+    {
+        for (const auto& child : _children)
+        {
+            MenuItem* item = dynamic_cast<MenuItem*>(child);
+            if (item)
+                item->setHitTransformDirty();
+        }
+    }
+
+    auto hits = [&touchLocation](MenuItem* child) {
+        if (child && child->isVisible() && child->isEnabled())
+        {
+            Vec2 local = child->convertToItemSpace(touchLocation);
+            Rect r = child->rect();
+            r.origin.setZero();
+            return r.containsPoint(local);
+        }
+        return false;
+    };
+
+    if (!_hitGridEnabled)
     {
         for (auto iter = _children.crbegin(); iter != _children.crend(); ++iter)
         {
             MenuItem* child = dynamic_cast<MenuItem*>(*iter);
-            if (child && child->isVisible() && child->isEnabled())
+            if (hits(child))
             {
-                Vec2 local = child->convertToNodeSpace(touchLocation);
-                Rect r = child->rect();
-                r.origin.setZero();
-                if (r.containsPoint(local))
-                {
-                    return child;
-                }
+                return child;
             }
         }
+        return nullptr;
     }
-    return nullptr;
+
+    if (_hitGridDirty || _hitGridChildCount != _children.size())
+    {
+        buildHitGrid();
+    }
+
+    // the last child is the topmost
+    int top = -1;
+    auto test = [&](const std::vector<int>& indices) {
+        for (auto iter = indices.rbegin(); iter != indices.rend() && *iter > top; ++iter)
+        {
+            if (hits(static_cast<MenuItem*>(_children.at(*iter))))
+            {
+                top = *iter;
+                break;
+            }
+        }
+    };
+
+    const float cellSize = _hitGridCellSize;
+    auto cell = _hitGridCells.find(hitGridCellKey((int)floorf(touchLocation.x / cellSize), (int)floorf(touchLocation.y / cellSize)));
+    if (cell != _hitGridCells.end())
+    {
+        test(cell->second);
+    }
+    test(_hitGridOversized);
+
+    return top >= 0 ? static_cast<MenuItem*>(_children.at(top)) : nullptr;
 }
 
 std::string Menu::getDescription() const
@@ -26,6 +26,9 @@ THE SOFTWARE.
 #ifndef __CCMENU_H_
 #define __CCMENU_H_
 
+#include <unordered_map>
+#include <vector>
+
 #include "2d/CCMenuItem.h"
 #include "2d/CCLayer.h"
 #include "base/CCValue.h"
@@ -157,6 +160,23 @@ public:
      */
     virtual void setEnabled(bool value) { _enabled = value; };
 
+    /**
+     * Enables a grid of the world bounds of the items, a touch is only tested against the items of its cell.
+     * For the menus with hundreds of items, the grid is built again when an item or the menu moved.
+     * @param enabled Whether the grid is used.
+     * @param cellSize The size of the cells in world space, in points.
+     * @since v3.11
+     * @js NA
+     * @lua NA
+     */
+    void setHitGridEnabled(bool enabled, float cellSize = 128);
+    /** Whether the grid of the items is used for the touches.
+     * @since v3.11
+     * @js NA
+     * @lua NA
+     */
+    bool isHitGridEnabled() const { return _hitGridEnabled; }
+
     virtual bool onTouchBegan(Touch* touch, Event* event);
     virtual void onTouchEnded(Touch* touch, Event* event);
     virtual void onTouchCancelled(Touch* touch, Event* event);
@@ -164,6 +184,7 @@ public:
 
     // overrides
     virtual void removeChild(Node* child, bool cleanup) override;
+    virtual void visit(Renderer *renderer, const Mat4 &parentTransform, uint32_t parentFlags) override;
 
     virtual void addChild(Node * child) override;
     virtual void addChild(Node * child, int zOrder) override;
@@ -181,7 +202,13 @@ CC_CONSTRUCTOR_ACCESS:
     /**
      * @js ctor
      */
-    Menu() : _selectedItem(nullptr) {}
+    Menu()
+    : _selectedItem(nullptr)
+    , _hitGridEnabled(false)
+    , _hitGridCellSize(128)
+    , _hitGridDirty(true)
+    , _hitGridChildCount(0)
+    {}
     virtual ~Menu();
 
     /** initializes an empty Menu */
@@ -197,9 +224,24 @@ protected:
     /** whether or not the menu will receive events */
     bool _enabled;
 
+    /** Returns the topmost visible and enabled item under the touch. The items are tested with their cached inverse
+     * world transforms, which are all computed again when the menu moved since the last visit. */
     virtual MenuItem* getItemForTouch(Touch * touch);
+    /** Places the items in the cells of the grid by their world bounds */
+    void buildHitGrid();
+
     State _state;
     MenuItem *_selectedItem;
+
+    friend class MenuItem;
+    bool _hitGridEnabled;
+    float _hitGridCellSize;
+    bool _hitGridDirty;
+    // the indices in _children of the items of each cell, in increasing order
+    std::unordered_map<int64_t, std::vector<int>> _hitGridCells;
+    // the items over too many cells, which are tested for every touch
+    std::vector<int> _hitGridOversized;
+    size_t _hitGridChildCount;
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(Menu);
 };
@@ -26,6 +26,7 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "2d/CCMenuItem.h"
+#include "2d/CCMenu.h"
 #include "2d/CCActionInterval.h"
 #include "2d/CCSprite.h"
 #include "2d/CCLabelAtlas.h"
@@ -110,6 +111,56 @@ bool MenuItem::isEnabled() const
     return _enabled;
 }
 
+Vec2 MenuItem::convertToItemSpace(const Vec2& worldPoint)
+{
+    updateHitTransform();
+    Vec3 vec3(worldPoint.x, worldPoint.y, 0);
+    Vec3 ret;
+    _worldToItem.transformPoint(vec3, &ret);
+    return Vec2(ret.x, ret.y);
+}
+
+Rect MenuItem::getWorldBounds()
+{
+    updateHitTransform();
+    return RectApplyTransform(Rect(0, 0, _contentSize.width, _contentSize.height), _itemToWorld);
+}
+
+void MenuItem::visit(Renderer *renderer, const Mat4 &parentTransform, uint32_t parentFlags)
+{
+    // the flags of the parents and the own changes are consumed by the visit
+    if (!_hitTransformDirty && ((parentFlags & FLAGS_DIRTY_MASK) || _transformUpdated))
+    {
+        setHitTransformDirty();
+    }
+    Node::visit(renderer, parentTransform, parentFlags);
+}
+
+void MenuItem::setHitTransformDirty()
+{
+    _hitTransformDirty = true;
+    Menu* menu = dynamic_cast<Menu*>(_parent);
+    if (menu)
+    {
+        menu->_hitGridDirty = true;
+    }
+}
+
+void MenuItem::updateHitTransform()
+{
+    // moved since the last visit
+    if (_transformUpdated)
+    {
+        setHitTransformDirty();
+    }
+    if (_hitTransformDirty)
+    {
+        _itemToWorld = getNodeToWorldTransform();
+        _worldToItem = _itemToWorld.getInversed();
+        _hitTransformDirty = false;
+    }
+}
+
 Rect MenuItem::rect() const
 {
     return Rect( _position.x - _contentSize.width * _anchorPoint.x,
@@ -86,11 +86,29 @@ public:
     */
     void setCallback(const ccMenuCallback& callback);
 
+    /** Converts a point in world space to the space of the item, like convertToNodeSpace() but with the inverse of
+     * the world transform cached: it's only computed again after the item or one of its parents moved.
+     * The parents that moved since the last visit are only seen by their Menu, see Menu::getItemForTouch().
+     * @since v3.11
+     * @js NA
+     * @lua NA
+     */
+    Vec2 convertToItemSpace(const Vec2& worldPoint);
+
+    /** Gets the bounds of the item in world space, with the cached world transform.
+     * @since v3.11
+     * @js NA
+     * @lua NA
+     */
+    Rect getWorldBounds();
+
     /**
      * @js NA
      */
     virtual std::string getDescription() const override;
 
+    virtual void visit(Renderer *renderer, const Mat4 &parentTransform, uint32_t parentFlags) override;
+
 CC_CONSTRUCTOR_ACCESS:
     /**
      * @js ctor
@@ -99,6 +117,7 @@ CC_CONSTRUCTOR_ACCESS:
     : _selected(false)
     , _enabled(false)
     , _callback(nullptr)
+    , _hitTransformDirty(true)
     {}
     /**
      * @js NA
@@ -117,6 +136,16 @@ protected:
     // callback
     ccMenuCallback _callback;
 
+    friend class Menu;
+    /** Marks the cached world transforms to be computed again, and the hit grid of the menu to be rebuilt */
+    void setHitTransformDirty();
+    void updateHitTransform();
+
+    // the world transform and its inverse, for the hit tests
+    Mat4 _itemToWorld;
+    Mat4 _worldToItem;
+    bool _hitTransformDirty;
+
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(MenuItem);
 };
@@ -28,13 +28,21 @@ THE SOFTWARE.
 #include "math/CCVertex.h"
 #include "base/CCDirector.h"
 #include "renderer/CCTextureCache.h"
-#include "renderer/ccGLStateCache.h"
 #include "renderer/CCTexture2D.h"
 #include "renderer/CCRenderer.h"
 #include "renderer/CCGLProgramState.h"
+#include "base/CCScheduler.h"
+#include "base/CCTracer.h"
+#include "base/CCWorkerPool.h"
 
 NS_CC_BEGIN
 
+// the key of the scheduler callback that runs the deferred updates, see MotionStreak::setParallelUpdateEnabled()
+static const char* PARALLEL_UPDATE_KEY = "MotionStreak::updatePendingStreaks";
+
+bool MotionStreak::s_isParallelUpdateEnabled = false;
+std::vector<MotionStreak*> MotionStreak::s_pendingStreaks;
+
 MotionStreak::MotionStreak()
 : _fastMode(false)
 , _startingPositionInitialized(false)
@@ -45,13 +53,18 @@ MotionStreak::MotionStreak()
 , _minSeg(0.0f)
 , _maxPoints(0)
 , _nuPoints(0)
-, _previousNuPoints(0)
+, _firstPoint(0)
+, _texCoordsDirty(false)
 , _pointVertexes(nullptr)
 , _pointState(nullptr)
 , _vertices(nullptr)
-, _colorPointer(nullptr)
-, _texCoords(nullptr)
+, _triangleVertices(nullptr)
+, _indices(nullptr)
+, _isUpdatePending(false)
+, _pendingDelta(0.0f)
 {
+    // the streak is made of world space vertices
+    _isCullingEnabled = false;
 }
 
 MotionStreak::~MotionStreak()
@@ -60,8 +73,8 @@ MotionStreak::~MotionStreak()
     CC_SAFE_FREE(_pointState);
     CC_SAFE_FREE(_pointVertexes);
     CC_SAFE_FREE(_vertices);
-    CC_SAFE_FREE(_colorPointer);
-    CC_SAFE_FREE(_texCoords);
+    CC_SAFE_FREE(_triangleVertices);
+    CC_SAFE_FREE(_indices);
 }
 
 MotionStreak* MotionStreak::create(float fade, float minSeg, float stroke, const Color3B& color, const std::string& path)
@@ -114,19 +127,34 @@ bool MotionStreak::initWithFade(float fade, float minSeg, float stroke, const Co
     _fadeDelta = 1.0f/fade;
 
     _maxPoints = (int)(fade*60.0f)+2;
+    CCASSERT(_maxPoints * 2 <= 65536, "MotionStreak: the fade is too long for 16 bits indices");
     _nuPoints = 0;
+    _firstPoint = 0;
     _pointState = (float *)malloc(sizeof(float) * _maxPoints);
-    _pointVertexes = (Vec2*)malloc(sizeof(Vec2) * _maxPoints);
+    _pointVertexes = (Vec2*)malloc(sizeof(Vec2) * _maxPoints * 2);
 
-    _vertices = (Vec2*)malloc(sizeof(Vec2) * _maxPoints * 2);
-    _texCoords = (Tex2F*)malloc(sizeof(Tex2F) * _maxPoints * 2);
-    _colorPointer =  (GLubyte*)malloc(sizeof(GLubyte) * _maxPoints * 2 * 4);
+    _vertices = (Vec2*)malloc(sizeof(Vec2) * _maxPoints * 2 * 2);
+    _triangleVertices = (V3F_C4B_T2F*)calloc(_maxPoints * 2 * 2, sizeof(V3F_C4B_T2F));
+
+    // the points are drawn as a triangle strip would
+    _indices = (unsigned short*)malloc(sizeof(unsigned short) * (_maxPoints - 1) * 6);
+    for (unsigned int i = 0; i < _maxPoints - 1; i++)
+    {
+        const unsigned short vertex = (unsigned short)(i * 2);
+        unsigned short* indices = _indices + i * 6;
+        indices[0] = vertex;
+        indices[1] = vertex + 1;
+        indices[2] = vertex + 2;
+        indices[3] = vertex + 2;
+        indices[4] = vertex + 1;
+        indices[5] = vertex + 3;
+    }
 
     // Set blend mode
     _blendFunc = BlendFunc::ALPHA_NON_PREMULTIPLIED;
 
     // shader state
-    setGLProgramState(GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR));
+    setGLProgramState(GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP));
 
     setTexture(texture);
     setColor(color);
@@ -198,10 +226,12 @@ void MotionStreak::tintWithColor(const Color3B& colors)
 {
     setColor(colors);
 
-    // Fast assignation
-    for(unsigned int i = 0; i<_nuPoints*2; i++)
+    // Fast assignation, the free points of the rings are set too
+    for(unsigned int i = 0; i<_maxPoints*2*2; i++)
     {
-        *((Color3B*) (_colorPointer+i*4)) = colors;
+        _triangleVertices[i].colors.r = colors.r;
+        _triangleVertices[i].colors.g = colors.g;
+        _triangleVertices[i].colors.b = colors.b;
     }
 }
 
@@ -258,54 +288,54 @@ void MotionStreak::update(float delta)
         return;
     }
 
+    if (s_isParallelUpdateEnabled)
+    {
+        deferUpdate(delta);
+        return;
+    }
+
+    updateStreak(delta);
+}
+
+void MotionStreak::updateStreak(float delta)
+{
     delta *= _fadeDelta;
 
-    unsigned int newIdx, newIdx2, i, i2;
+    unsigned int point, mirror, i;
     unsigned int mov = 0;
 
-    // Update current points
+    // Update current points, they fade at the same pace so the faded ones are the oldest
     for(i = 0; i<_nuPoints; i++)
     {
-        _pointState[i]-=delta;
+        point = _firstPoint + i;
+        if (point >= _maxPoints)
+            point -= _maxPoints;
 
-        if(_pointState[i] <= 0)
+        _pointState[point]-=delta;
+
+        if(_pointState[point] <= 0)
             mov++;
         else
         {
-            newIdx = i-mov;
-
-            if(mov>0)
-            {
-                // Move data
-                _pointState[newIdx] = _pointState[i];
-
-                // Move point
-                _pointVertexes[newIdx] = _pointVertexes[i];
-
-                // Move vertices
-                i2 = i*2;
-                newIdx2 = newIdx*2;
-                _vertices[newIdx2] = _vertices[i2];
-                _vertices[newIdx2+1] = _vertices[i2+1];
-
-                // Move color
-                i2 *= 4;
-                newIdx2 *= 4;
-                _colorPointer[newIdx2+0] = _colorPointer[i2+0];
-                _colorPointer[newIdx2+1] = _colorPointer[i2+1];
-                _colorPointer[newIdx2+2] = _colorPointer[i2+2];
-                _colorPointer[newIdx2+4] = _colorPointer[i2+4];
-                _colorPointer[newIdx2+5] = _colorPointer[i2+5];
-                _colorPointer[newIdx2+6] = _colorPointer[i2+6];
-            }else
-                newIdx2 = newIdx*8;
-
-            const GLubyte op = (GLubyte)(_pointState[newIdx] * 255.0f);
-            _colorPointer[newIdx2+3] = op;
-            _colorPointer[newIdx2+7] = op;
+            const GLubyte op = (GLubyte)(_pointState[point] * 255.0f);
+            mirror = point + _maxPoints;
+            _triangleVertices[point*2].colors.a = op;
+            _triangleVertices[point*2+1].colors.a = op;
+            _triangleVertices[mirror*2].colors.a = op;
+            _triangleVertices[mirror*2+1].colors.a = op;
         }
     }
-    _nuPoints-=mov;
+
+    if(mov>0)
+    {
+        _firstPoint = (_firstPoint + mov) % _maxPoints;
+        _nuPoints-=mov;
+        _texCoordsDirty = true;
+    }
+
+    // the live points, contiguous in the mirrored rings
+    Vec2* points = _pointVertexes + _firstPoint;
+    Vec2* vertices = _vertices + _firstPoint*2;
 
     // Append new point
     bool appendNewPoint = true;
@@ -316,8 +346,8 @@ void MotionStreak::update(float delta)
 
     else if(_nuPoints>0)
     {
-        bool a1 = _pointVertexes[_nuPoints-1].getDistanceSq(_positionR) < _minSeg;
-        bool a2 = (_nuPoints == 1) ? false : (_pointVertexes[_nuPoints-2].getDistanceSq(_positionR)< (_minSeg * 2.0f));
+        bool a1 = points[_nuPoints-1].getDistanceSq(_positionR) < _minSeg;
+        bool a2 = (_nuPoints == 1) ? false : (points[_nuPoints-2].getDistanceSq(_positionR)< (_minSeg * 2.0f));
         if(a1 || a2)
         {
             appendNewPoint = false;
@@ -326,81 +356,176 @@ void MotionStreak::update(float delta)
 
     if(appendNewPoint)
     {
-        _pointVertexes[_nuPoints] = _positionR;
-        _pointState[_nuPoints] = 1.0f;
+        point = (_firstPoint + _nuPoints) % _maxPoints;
+        mirror = point + _maxPoints;
 
-        // Color assignment
-        const unsigned int offset = _nuPoints*8;
-        *((Color3B*)(_colorPointer + offset)) = _displayedColor;
-        *((Color3B*)(_colorPointer + offset+4)) = _displayedColor;
+        _pointVertexes[point] = _positionR;
+        _pointVertexes[mirror] = _positionR;
+        _pointState[point] = 1.0f;
 
-        // Opacity
-        _colorPointer[offset+3] = 255;
-        _colorPointer[offset+7] = 255;
+        // Color assignment and opacity
+        const Color4B color(_displayedColor.r, _displayedColor.g, _displayedColor.b, 255);
+        _triangleVertices[point*2].colors = color;
+        _triangleVertices[point*2+1].colors = color;
+        _triangleVertices[mirror*2].colors = color;
+        _triangleVertices[mirror*2+1].colors = color;
 
         // Generate polygon
         if(_nuPoints > 0 && _fastMode )
         {
             if(_nuPoints > 1)
             {
-                ccVertexLineToPolygon(_pointVertexes, _stroke, _vertices, _nuPoints, 1);
+                ccVertexLineToPolygon(points, _stroke, vertices, _nuPoints, 1);
+                updateVertexPositions(_nuPoints, _nuPoints + 1);
             }
             else
             {
-                ccVertexLineToPolygon(_pointVertexes, _stroke, _vertices, 0, 2);
+                ccVertexLineToPolygon(points, _stroke, vertices, 0, 2);
+                updateVertexPositions(0, 2);
             }
         }
 
         _nuPoints ++;
+        _texCoordsDirty = true;
     }
 
     if( ! _fastMode )
     {
-        ccVertexLineToPolygon(_pointVertexes, _stroke, _vertices, 0, _nuPoints);
+        ccVertexLineToPolygon(points, _stroke, vertices, 0, _nuPoints);
+        updateVertexPositions(0, _nuPoints);
     }
 
-    // Updated Tex Coords only if they are different than previous step
-    if( _nuPoints  && _previousNuPoints != _nuPoints ) {
+    // Updated Tex Coords only if the points changed since the previous step
+    if( _nuPoints && _texCoordsDirty ) {
         float texDelta = 1.0f / _nuPoints;
         for( i=0; i < _nuPoints; i++ ) {
-            _texCoords[i*2] = Tex2F(0, texDelta*i);
-            _texCoords[i*2+1] = Tex2F(1, texDelta*i);
+            point = _firstPoint + i;
+            if (point >= _maxPoints)
+                point -= _maxPoints;
+            mirror = point + _maxPoints;
+
+            const float v = texDelta*i;
+            _triangleVertices[point*2].texCoords = Tex2F(0, v);
+            _triangleVertices[point*2+1].texCoords = Tex2F(1, v);
+            _triangleVertices[mirror*2].texCoords = Tex2F(0, v);
+            _triangleVertices[mirror*2+1].texCoords = Tex2F(1, v);
         }
 
-        _previousNuPoints = _nuPoints;
+        _texCoordsDirty = false;
     }
 }
 
-void MotionStreak::reset()
+void MotionStreak::updateVertexPositions(unsigned int begin, unsigned int end)
 {
-    _nuPoints = 0;
+    for (unsigned int i = begin; i < end; i++)
+    {
+        const unsigned int index = _firstPoint + i;
+        const unsigned int point = index < _maxPoints ? index : index - _maxPoints;
+        const unsigned int mirror = point + _maxPoints;
+
+        const Vec2& v1 = _vertices[index*2];
+        const Vec2& v2 = _vertices[index*2+1];
+        _vertices[(index == point ? mirror : point)*2] = v1;
+        _vertices[(index == point ? mirror : point)*2+1] = v2;
+
+        _triangleVertices[point*2].vertices.set(v1.x, v1.y, 0.0f);
+        _triangleVertices[point*2+1].vertices.set(v2.x, v2.y, 0.0f);
+        _triangleVertices[mirror*2].vertices.set(v1.x, v1.y, 0.0f);
+        _triangleVertices[mirror*2+1].vertices.set(v2.x, v2.y, 0.0f);
+    }
+}
+
+void MotionStreak::deferUpdate(float delta)
+{
+    if (_isUpdatePending)
+    {
+        _pendingDelta += delta;
+        return;
+    }
+
+    if (s_pendingStreaks.empty())
+    {
+        auto scheduler = _director->getScheduler();
+        if (!scheduler->isScheduled(PARALLEL_UPDATE_KEY, &s_pendingStreaks))
+        {
+            // the custom callbacks run after the per-frame updates, so every streak of the frame is in the list by then
+            scheduler->schedule([](float) { MotionStreak::updatePendingStreaks(); }, &s_pendingStreaks, 0, false, PARALLEL_UPDATE_KEY);
+        }
+    }
+
+    // retained until the update runs, the streak may be removed by a later update of the frame
+    this->retain();
+    _isUpdatePending = true;
+    _pendingDelta = delta;
+    s_pendingStreaks.push_back(this);
 }
 
-void MotionStreak::onDraw(const Mat4 &transform, uint32_t flags)
+void MotionStreak::setParallelUpdateEnabled(bool enabled)
 {
-    getGLProgram()->use();
-    getGLProgram()->setUniformsForBuiltins(transform);
+    if (s_isParallelUpdateEnabled == enabled)
+    {
+        return;
+    }
+
+    s_isParallelUpdateEnabled = enabled;
+    if (!enabled)
+    {
+        updatePendingStreaks();
+        Director::getInstance()->getScheduler()->unschedule(PARALLEL_UPDATE_KEY, &s_pendingStreaks);
+    }
+}
+
+void MotionStreak::updatePendingStreaks()
+{
+    if (s_pendingStreaks.empty())
+    {
+        return;
+    }
 
-    GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX );
-    GL::blendFunc( _blendFunc.src, _blendFunc.dst );
+    CC_TRACE_ZONE("streaks", "MotionStreak::updatePendingStreaks");
 
-    GL::bindTexture2D( _texture->getName() );
+    std::vector<MotionStreak*> streaks;
+    streaks.swap(s_pendingStreaks);
 
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, _vertices);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, 0, _texCoords);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, _colorPointer);
+    auto task = [&streaks](int index) {
+        MotionStreak* streak = streaks[index];
+        streak->updateStreak(streak->_pendingDelta);
+    };
+    if (streaks.size() > 1)
+    {
+        WorkerPool::getInstance()->run((int)streaks.size(), task);
+    }
+    else
+    {
+        task(0);
+    }
 
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, (GLsizei)_nuPoints*2);
-    CC_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(1, _nuPoints*2);
+    for (auto streak : streaks)
+    {
+        streak->_isUpdatePending = false;
+        streak->release();
+    }
+}
+
+void MotionStreak::reset()
+{
+    _nuPoints = 0;
+    _firstPoint = 0;
 }
 
 void MotionStreak::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
 {
     if(_nuPoints <= 1)
         return;
-    _customCommand.init(_globalZOrder, transform, flags);
-    _customCommand.func = CC_CALLBACK_0(MotionStreak::onDraw, this, transform, flags);
-    renderer->addCommand(&_customCommand);
+
+    TrianglesCommand::Triangles triangles;
+    triangles.verts = _triangleVertices + _firstPoint*2;
+    triangles.vertCount = _nuPoints*2;
+    triangles.indices = _indices;
+    triangles.indexCount = (_nuPoints-1)*6;
+
+    _trianglesCommand.init(_globalZOrder, _texture->getName(), getGLProgramState(), _blendFunc, triangles, transform, flags);
+    renderer->addCommand(&_trianglesCommand);
 }
 
 NS_CC_END
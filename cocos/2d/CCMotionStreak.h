@@ -26,9 +26,11 @@ THE SOFTWARE.
 #ifndef __CCMOTION_STREAK_H__
 #define __CCMOTION_STREAK_H__
 
+#include <vector>
+
 #include "base/CCProtocols.h"
 #include "2d/CCNode.h"
-#include "renderer/CCCustomCommand.h"
+#include "renderer/CCTrianglesCommand.h"
 
 NS_CC_BEGIN
 
@@ -41,6 +43,10 @@ class Texture2D;
 
 /** @class MotionStreak.
  * @brief Creates a trailing path.
+ *
+ * The points of the ribbon are kept in a ring: the faded points leave at the front and the new ones are added at the
+ * back, nothing is moved. The ribbon is drawn with a TrianglesCommand, so the streaks sharing a texture, a blend
+ * function and a shader are batched in one draw call.
  */
 class CC_DLL MotionStreak : public Node, public TextureProtocol
 {
@@ -111,6 +117,18 @@ public:
         _startingPositionInitialized = bStartingPositionInitialized;
     }
 
+    /** Enables/Disables the parallel update of the motion streaks.
+     When enabled, the scheduled update() of a streak only queues it. The streaks of the frame are then updated
+     together on the WorkerPool, after the per-frame updates of the Scheduler and before the visit.
+     Disabled by default.
+     @since v3.11
+     */
+    static void setParallelUpdateEnabled(bool enabled);
+    /** Whether or not the motion streaks are updated in parallel.
+     @since v3.11
+     */
+    static bool isParallelUpdateEnabled() { return s_isParallelUpdateEnabled; }
+
     // Overrides
     virtual void setPosition(const Vec2& position) override;
     virtual void setPosition(float x, float y) override;
@@ -158,8 +176,15 @@ CC_CONSTRUCTOR_ACCESS:
     bool initWithFade(float fade, float minSeg, float stroke, const Color3B& color, Texture2D* texture);
 
 protected:
-    //renderer callback
-    void onDraw(const Mat4 &transform, uint32_t flags);
+    /** The part of update() that only touches this streak, the parallel update runs it on a worker thread. */
+    void updateStreak(float delta);
+    // copies the positions computed in _vertices for the live points [begin, end) to the other half of the rings
+    void updateVertexPositions(unsigned int begin, unsigned int end);
+
+    // queues the streak for updatePendingStreaks()
+    void deferUpdate(float delta);
+    // updates the queued streaks in parallel, see setParallelUpdateEnabled()
+    static void updatePendingStreaks();
 
     bool _fastMode;
     bool _startingPositionInitialized;
@@ -175,18 +200,34 @@ protected:
 
     unsigned int _maxPoints;
     unsigned int _nuPoints;
-    unsigned int _previousNuPoints;
+    /** the index of the oldest point in the rings */
+    unsigned int _firstPoint;
+    /** whether the first point or the number of points changed since the texture coordinates were set */
+    bool _texCoordsDirty;
 
-    /** Pointers */
+    /** Pointers, rings of _maxPoints points written twice, at i and i + _maxPoints, so that the
+     _nuPoints live points are always contiguous from _firstPoint.
+     */
     Vec2* _pointVertexes;
+    // not mirrored
     float* _pointState;
 
     // Opengl
+    // two per point, the positions ccVertexLineToPolygon() works on
     Vec2* _vertices;
-    GLubyte* _colorPointer;
-    Tex2F* _texCoords;
+    // two per point, the vertices of the triangles
+    V3F_C4B_T2F* _triangleVertices;
+    // the triangles between the points, the same for every window of the rings
+    unsigned short* _indices;
+
+    TrianglesCommand _trianglesCommand;
+
+    /** whether the streak waits for updatePendingStreaks(), and the time to update it by */
+    bool _isUpdatePending;
+    float _pendingDelta;
 
-    CustomCommand _customCommand;
+    static bool s_isParallelUpdateEnabled;
+    static std::vector<MotionStreak*> s_pendingStreaks;
 
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(MotionStreak);
@@ -31,19 +31,32 @@ THE SOFTWARE.
 #include "2d/CCNode.h"
 
 #include <algorithm>
+#include <cfloat>
+#include <cstring>
 #include <string>
-#include <regex>
+#include <deque>
+#include <thread>
+#include <typeinfo>
 
 #include "base/CCDirector.h"
 #include "base/CCScheduler.h"
 #include "base/CCEventDispatcher.h"
 #include "2d/CCActionManager.h"
+#include "2d/CCNodeQuery.h"
+#include "2d/CCRenderTexture.h"
+#include "2d/CCSprite.h"
 #include "2d/CCScene.h"
+#include "2d/CCSpatialNode.h"
+#include "2d/CCTransformSystem.h"
 #include "renderer/CCGLProgram.h"
 #include "renderer/CCGLProgramState.h"
+#include "renderer/CCPostProcess.h"
+#include "renderer/CCRenderer.h"
+#include "renderer/CCStaticBatch.h"
 #include "math/TransformUtils.h"
 #include "base/CCString.h"
 #include "base/CCTouch.h"
+#include "base/CCConfiguration.h"
 
 #if CC_NODE_RENDER_SUBPIXEL
 #define RENDER_IN_SUBPIXEL
@@ -61,13 +74,108 @@ bool nodeComparisonLess(Node* n1, Node* n2)
            );
 }
 
+bool sortNodes(Vector<Node*>& nodes)
+{
+    auto first = nodes.begin();
+    auto last = nodes.end();
+    // insertion sort while the input looks nearly sorted, 4 moves per node
+    ssize_t budget = (last - first) * 4;
+    bool changed = false;
+
+    for (auto it = first + (first != last); it < last; ++it)
+    {
+        if (!nodeComparisonLess(*it, *(it - 1)))
+        {
+            continue;
+        }
+
+        Node* node = *it;
+        auto hole = it;
+        do
+        {
+            *hole = *(hole - 1);
+            --hole;
+            --budget;
+        } while (hole != first && nodeComparisonLess(node, *(hole - 1)));
+        *hole = node;
+        changed = true;
+
+        if (budget < 0)
+        {
+            // the [first, it] part is sorted
+            std::sort(it + 1, last, nodeComparisonLess);
+            std::inplace_merge(first, it + 1, last, nodeComparisonLess);
+            break;
+        }
+    }
+
+    return changed;
+}
+
 // FIXME:: Yes, nodes might have a sort problem once every 15 days if the game runs at 60 FPS and each frame sprites are reordered.
 int Node::s_globalOrderOfArrival = 1;
+unsigned int Node::s_hierarchyVersion = 0;
+int Node::s_cachedTextureCount = 0;
 
 // MARK: Constructor, Destructor, Init
 
+Node::ColdData::ColdData()
+: childNameIndexValid(false)
+, cacheAsTexture(false)
+, cachedTextureDirty(false)
+, cachedTexture(nullptr)
+, cacheAsGeometry(false)
+, staticBatch(nullptr)
+, nativeResolution(false)
+, interpolation(false)
+, interpolationValid(false)
+, interpolationStep(0)
+, interpolationSteps(1)
+{
+}
+
 Node::Node()
-: _rotationX(0.0f)
+// children (lazy allocs)
+: _parent(nullptr)
+, _glProgramState(nullptr)
+, _localZOrder(0)
+, _globalZOrder(0)
+, _orderOfArrival(0)
+, _transformIndex(-1)
+, _childOrder(ChildOrder::LOCAL_Z_ORDER)
+, _cameraMask(1)
+, _displayedOpacity(255)
+, _realOpacity(255)
+, _displayedColor(Color3B::WHITE)
+, _realColor(Color3B::WHITE)
+, _visible(true)
+, _running(false)
+, _transformDirty(true)
+, _inverseDirty(true)
+, _transformUpdated(true)
+, _transformFromSystem(false)
+, _useAdditionalTransform(false)
+, _contentSizeDirty(true)
+, _usingNormalizedPosition(false)
+, _normalizedPositionDirty(false)
+, _reorderChildDirty(false)
+, _isAddingChildren(false)
+, _isRemovingChildren(false)
+, _isParallelVisitEnabled(false)
+, _isCullingEnabled(true)
+, _subtreeBoundsDirty(true)
+, _subtreeBoundsValid(false)
+, _touchIndexDirty(false)
+, _isSpatialContainer(false)
+, _spatialCellDirty(false)
+, _actionTargetCount(0)
+, _eventListenerCount(0)
+// "whole screen" objects. like Scenes and Layers, should set _ignoreAnchorPointForPosition to true
+, _ignoreAnchorPointForPosition(false)
+, _isTransitionFinished(false)
+, _cascadeColorEnabled(false)
+, _cascadeOpacityEnabled(false)
+, _rotationX(0.0f)
 , _rotationY(0.0f)
 , _rotationZ_X(0.0f)
 , _rotationZ_Y(0.0f)
@@ -75,39 +183,14 @@ Node::Node()
 , _scaleY(1.0f)
 , _scaleZ(1.0f)
 , _positionZ(0.0f)
-, _usingNormalizedPosition(false)
-, _normalizedPositionDirty(false)
 , _skewX(0.0f)
 , _skewY(0.0f)
 , _contentSize(Size::ZERO)
-, _contentSizeDirty(true)
-, _transformDirty(true)
-, _inverseDirty(true)
-, _useAdditionalTransform(false)
-, _transformUpdated(true)
-// children (lazy allocs)
-// lazy alloc
-, _localZOrder(0)
-, _globalZOrder(0)
-, _parent(nullptr)
-// "whole screen" objects. like Scenes and Layers, should set _ignoreAnchorPointForPosition to true
 , _tag(Node::INVALID_TAG)
-, _name("")
-, _hashOfName(0)
-, _glProgramState(nullptr)
-, _orderOfArrival(0)
-, _running(false)
-, _visible(true)
-, _ignoreAnchorPointForPosition(false)
-, _reorderChildDirty(false)
-, _isTransitionFinished(false)
-, _displayedOpacity(255)
-, _realOpacity(255)
-, _displayedColor(Color3B::WHITE)
-, _realColor(Color3B::WHITE)
-, _cascadeColorEnabled(false)
-, _cascadeOpacityEnabled(false)
-, _cameraMask(1)
+, _touchIndexListenerCount(0)
+, _nameAtom(0)
+// lazy alloc
+, _coldData(nullptr)
 {
     // set default scheduler and actionManager
     _director = Director::getInstance();
@@ -118,7 +201,7 @@ Node::Node()
     _eventDispatcher = _director->getEventDispatcher();
     _eventDispatcher->retain();
 
-    _transform = _inverse = _additionalTransform = Mat4::IDENTITY;
+    _transform = Mat4::IDENTITY;
 }
 
 Node * Node::create()
@@ -162,6 +245,29 @@ Node::~Node()
         log("Node still marked as running on node destruction! Was base class onExit() called in derived class onExit() implementations?");
     }
     CC_SAFE_RELEASE(_eventDispatcher);
+
+    if (isCacheAsTexture())
+    {
+        --s_cachedTextureCount;
+        CC_SAFE_RELEASE(_coldData->cachedTexture);
+    }
+    if (isCacheAsGeometry())
+    {
+        --s_cachedTextureCount;
+        CC_SAFE_DELETE(_coldData->staticBatch);
+    }
+    CC_SAFE_DELETE(_coldData);
+
+    releaseNameAtom(_nameAtom);
+}
+
+Node::ColdData* Node::getColdData() const
+{
+    if (_coldData == nullptr)
+    {
+        _coldData = new ColdData();
+    }
+    return _coldData;
 }
 
 bool Node::init()
@@ -172,7 +278,10 @@ bool Node::init()
 void Node::cleanup()
 {
     // actions
-    this->stopAllActions();
+    if (_actionTargetCount > 0)
+    {
+        this->stopAllActions();
+    }
     this->unscheduleAllCallbacks();
 
     // timers
@@ -199,6 +308,7 @@ void Node::setSkewX(float skewX)
 
     _skewX = skewX;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSubtreeBounds();
 }
 
 float Node::getSkewY() const
@@ -213,6 +323,7 @@ void Node::setSkewY(float skewY)
 
     _skewY = skewY;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSubtreeBounds();
 }
 
 void Node::setLocalZOrder(int z)
@@ -224,9 +335,8 @@ void Node::setLocalZOrder(int z)
     if (_parent)
     {
         _parent->reorderChild(this, z);
+        _eventDispatcher->setReorderDirtyForNode(_parent);
     }
-
-    _eventDispatcher->setDirtyForNode(this);
 }
 
 void Node::setGlobalZOrder(float globalZOrder)
@@ -234,7 +344,7 @@ void Node::setGlobalZOrder(float globalZOrder)
     if (_globalZOrder != globalZOrder)
     {
         _globalZOrder = globalZOrder;
-        _eventDispatcher->setDirtyForNode(this);
+        _eventDispatcher->setGlobalZOrderDirtyForNode(this);
     }
 }
 
@@ -252,6 +362,7 @@ void Node::setRotation(float rotation)
 
     _rotationZ_X = _rotationZ_Y = rotation;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSubtreeBounds();
 
     updateRotationQuat();
 }
@@ -296,6 +407,7 @@ void Node::setRotationSkewX(float rotationX)
 
     _rotationZ_X = rotationX;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSubtreeBounds();
 
     updateRotationQuat();
 }
@@ -312,6 +424,7 @@ void Node::setRotationSkewY(float rotationY)
 
     _rotationZ_Y = rotationY;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSubtreeBounds();
 
     updateRotationQuat();
 }
@@ -331,6 +444,7 @@ void Node::setScale(float scale)
 
     _scaleX = _scaleY = _scaleZ = scale;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSubtreeBounds();
 }
 
 /// scaleX getter
@@ -348,6 +462,7 @@ void Node::setScale(float scaleX,float scaleY)
     _scaleX = scaleX;
     _scaleY = scaleY;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSubtreeBounds();
 }
 
 /// scaleX setter
@@ -358,6 +473,7 @@ void Node::setScaleX(float scaleX)
 
     _scaleX = scaleX;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSubtreeBounds();
 }
 
 /// scaleY getter
@@ -374,6 +490,7 @@ void Node::setScaleY(float scaleY)
 
     _scaleY = scaleY;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSubtreeBounds();
 }
 
 void Node::setScaleZ(float scaleZ)
@@ -383,6 +500,7 @@ void Node::setScaleZ(float scaleZ)
 
     _scaleZ = scaleZ;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSubtreeBounds();
 }
 
 float Node::getScaleZ() const
@@ -417,6 +535,7 @@ void Node::setPosition(float x, float y)
     _position.y = y;
 
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSubtreeBounds();
     _usingNormalizedPosition = false;
 }
 
@@ -451,6 +570,7 @@ void Node::setPositionZ(float positionZ)
         return;
 
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSubtreeBounds();
 
     _positionZ = positionZ;
 }
@@ -471,6 +591,7 @@ void Node::setNormalizedPosition(const Vec2& position)
     _usingNormalizedPosition = true;
     _normalizedPositionDirty = true;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSubtreeBounds();
 }
 
 ssize_t Node::getChildrenCount() const
@@ -478,6 +599,88 @@ ssize_t Node::getChildrenCount() const
     return _children.size();
 }
 
+Node* Node::clone() const
+{
+    Node* copy = cloneInstance();
+    if (typeid(*copy) != typeid(*this))
+    {
+        CCLOG("cocos2d: Node::clone: %s is cloned as a %s", typeid(*this).name(), typeid(*copy).name());
+    }
+
+    if (!_children.empty())
+    {
+        copy->reserveChildren(copy->_children.size() + _children.size());
+        for (const auto& child : _children)
+        {
+            if (!isInternalChild(child))
+            {
+                copy->addChild(child->clone(), child->_localZOrder, child->_tag);
+            }
+        }
+    }
+    return copy;
+}
+
+Node* Node::cloneInstance() const
+{
+    Node* node = Node::create();
+    copyNodeState(node);
+    return node;
+}
+
+void Node::copyNodeState(Node* target) const
+{
+    // the target isn't in a scene yet, the inputs of the transform are copied as they are
+    target->_rotationX = _rotationX;
+    target->_rotationY = _rotationY;
+    target->_rotationZ_X = _rotationZ_X;
+    target->_rotationZ_Y = _rotationZ_Y;
+    target->_rotationQuat = _rotationQuat;
+    target->_scaleX = _scaleX;
+    target->_scaleY = _scaleY;
+    target->_scaleZ = _scaleZ;
+    target->_position = _position;
+    target->_positionZ = _positionZ;
+    target->_skewX = _skewX;
+    target->_skewY = _skewY;
+    target->_usingNormalizedPosition = _usingNormalizedPosition;
+    target->_normalizedPosition = _normalizedPosition;
+    target->_normalizedPositionDirty = _usingNormalizedPosition;
+    target->_transformUpdated = target->_transformDirty = target->_inverseDirty = true;
+    target->invalidateSubtreeBounds();
+
+    target->ignoreAnchorPointForPosition(_ignoreAnchorPointForPosition);
+    target->setAnchorPoint(_anchorPoint);
+    target->setContentSize(_contentSize);
+
+    target->_localZOrder = _localZOrder;
+    target->setGlobalZOrder(_globalZOrder);
+    target->setCameraMask(_cameraMask, false);
+    target->_tag = _tag;
+    target->setNameAtom(_nameAtom);
+    target->setVisible(_visible);
+    target->setCullingEnabled(_isCullingEnabled);
+    target->setParallelVisitEnabled(_isParallelVisitEnabled);
+    if (_childOrder == ChildOrder::CUSTOM)
+        target->setChildOrderKey(_coldData->childOrderKey);
+    else
+        target->setChildOrder(_childOrder);
+
+    target->setCascadeColorEnabled(_cascadeColorEnabled);
+    target->setCascadeOpacityEnabled(_cascadeOpacityEnabled);
+    target->setColor(_realColor);
+    target->setOpacity(_realOpacity);
+
+    // a state with uniforms of its own would be changed for both nodes if it were shared
+    if (_glProgramState && _glProgramState != target->_glProgramState)
+    {
+        if (_glProgramState->getUniformCount() == 0)
+            target->setGLProgramState(_glProgramState);
+        else
+            target->setGLProgramState(_glProgramState->clone());
+    }
+}
+
 /// isVisible getter
 bool Node::isVisible() const
 {
@@ -492,6 +695,8 @@ void Node::setVisible(bool visible)
         _visible = visible;
         if(_visible)
             _transformUpdated = _transformDirty = _inverseDirty = true;
+        // the bounds of the parent only include the visible children
+        invalidateSubtreeBounds();
     }
 }
 
@@ -513,6 +718,7 @@ void Node::setAnchorPoint(const Vec2& point)
         _anchorPoint = point;
         _anchorPointInPoints.set(_contentSize.width * _anchorPoint.x, _contentSize.height * _anchorPoint.y);
         _transformUpdated = _transformDirty = _inverseDirty = true;
+        invalidateSubtreeBounds();
     }
 }
 
@@ -530,6 +736,8 @@ void Node::setContentSize(const Size & size)
 
         _anchorPointInPoints.set(_contentSize.width * _anchorPoint.x, _contentSize.height * _anchorPoint.y);
         _transformUpdated = _transformDirty = _inverseDirty = _contentSizeDirty = true;
+        invalidateSubtreeBounds();
+        invalidateCachedTexture();
     }
 }
 
@@ -542,8 +750,14 @@ bool Node::isRunning() const
 /// parent setter
 void Node::setParent(Node * parent)
 {
+    if (_parent)
+    {
+        _parent->invalidateSubtreeBounds();
+        _parent->invalidateCachedTexture();
+    }
     _parent = parent;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSubtreeBounds();
 }
 
 /// isRelativeAnchorPoint getter
@@ -558,6 +772,7 @@ void Node::ignoreAnchorPointForPosition(bool newValue)
     {
         _ignoreAnchorPointForPosition = newValue;
         _transformUpdated = _transformDirty = _inverseDirty = true;
+        invalidateSubtreeBounds();
     }
 }
 
@@ -573,16 +788,115 @@ void Node::setTag(int tag)
     _tag = tag ;
 }
 
+// the interned names, never destroyed since nodes may outlive the static objects
+struct NameAtomTable
+{
+    NameAtomTable()
+    {
+        names.push_back("");
+        references.push_back(0);
+    }
+
+    std::unordered_map<std::string, unsigned int> atoms;
+    std::deque<std::string> names;  // by atom, a deque keeps the references of getName() valid
+    std::vector<unsigned int> references;  // by atom, the name is dropped when it reaches 0
+    std::vector<unsigned int> freeAtoms;
+};
+
+static NameAtomTable& getNameAtomTable()
+{
+    static NameAtomTable* table = new NameAtomTable();
+    return *table;
+}
+
+unsigned int Node::internName(const std::string& name)
+{
+    if (name.empty())
+        return 0;
+
+    auto& table = getNameAtomTable();
+    auto it = table.atoms.find(name);
+    if (it != table.atoms.end())
+    {
+        ++table.references[it->second];
+        return it->second;
+    }
+
+    unsigned int atom;
+    if (!table.freeAtoms.empty())
+    {
+        atom = table.freeAtoms.back();
+        table.freeAtoms.pop_back();
+        table.names[atom] = name;
+        table.references[atom] = 1;
+    }
+    else
+    {
+        atom = (unsigned int)table.names.size();
+        table.names.push_back(name);
+        table.references.push_back(1);
+    }
+    table.atoms.emplace(name, atom);
+    return atom;
+}
+
+void Node::retainNameAtom(unsigned int atom)
+{
+    if (atom != 0)
+    {
+        ++getNameAtomTable().references[atom];
+    }
+}
+
+void Node::releaseNameAtom(unsigned int atom)
+{
+    if (atom == 0)
+        return;
+
+    auto& table = getNameAtomTable();
+    CCASSERT(table.references[atom] > 0, "The name atom was released too many times");
+    if (--table.references[atom] == 0)
+    {
+        table.atoms.erase(table.names[atom]);
+        std::string().swap(table.names[atom]);
+        table.freeAtoms.push_back(atom);
+    }
+}
+
+unsigned int Node::findNameAtom(const std::string& name)
+{
+    if (name.empty())
+        return 0;
+
+    auto& table = getNameAtomTable();
+    auto it = table.atoms.find(name);
+    return it != table.atoms.end() ? it->second : 0;
+}
+
 const std::string& Node::getName() const
 {
-    return _name;
+    return getNameAtomTable().names[_nameAtom];
 }
 
 void Node::setName(const std::string& name)
 {
-    _name = name;
-    std::hash<std::string> h;
-    _hashOfName = h(name);
+    unsigned int atom = internName(name);
+    setNameAtom(atom);
+    releaseNameAtom(atom);
+}
+
+void Node::setNameAtom(unsigned int atom)
+{
+    if (atom != _nameAtom)
+    {
+        retainNameAtom(atom);
+        releaseNameAtom(_nameAtom);
+        _nameAtom = atom;
+        if (_parent)
+        {
+            _parent->invalidateChildNameIndex();
+        }
+    }
 }
 
 int Node::getOrderOfArrival() const
@@ -678,13 +992,38 @@ Node* Node::getChildByName(const std::string& name) const
     if (name.empty())
         return nullptr;
 
-    std::hash<std::string> h;
-    size_t hash = h(name);
+    // no node has a name that was never interned
+    unsigned int atom = findNameAtom(name);
+    return atom != 0 ? getChildByNameAtom(atom) : nullptr;
+}
+
+// the nodes with less children scan them, as fast as an index lookup
+static const ssize_t CHILD_NAME_INDEX_MIN_CHILDREN = 16;
+
+Node* Node::getChildByNameAtom(unsigned int atom) const
+{
+    if (_children.size() >= CHILD_NAME_INDEX_MIN_CHILDREN)
+    {
+        auto coldData = getColdData();
+        auto& index = coldData->childNameIndex;
+        if (!coldData->childNameIndexValid)
+        {
+            index.clear();
+            for (const auto& child : _children)
+            {
+                // keeps the first child of each name, like the scan
+                index.emplace(child->_nameAtom, child);
+            }
+            coldData->childNameIndexValid = true;
+        }
+
+        auto it = index.find(atom);
+        return it != index.end() ? it->second : nullptr;
+    }
 
     for (const auto& child : _children)
     {
-        // Different strings may have the same hash code, but can use it to compare first for speed
-        if(child->_hashOfName == hash && child->_name.compare(name) == 0)
+        if (child->_nameAtom == atom)
             return child;
     }
     return nullptr;
@@ -695,114 +1034,28 @@ void Node::enumerateChildren(const std::string &name, std::function<bool (Node *
     CCASSERT(!name.empty(), "Invalid name");
     CCASSERT(callback != nullptr, "Invalid callback function");
 
-    size_t length = name.length();
-
-    size_t subStrStartPos = 0;  // sub string start index
-    size_t subStrlength = length; // sub string length
+    // the last search strings, parsed once; the callbacks may search too, the query is kept alive while it runs.
+    // The queries hold the atoms of their names, the cache is bounded so the names it keeps are too
+    static const size_t MAX_CACHED_QUERIES = 64;
+    static std::unordered_map<std::string, std::shared_ptr<NodeQuery>> queries;
 
-    // Starts with '//'?
-    bool searchRecursively = false;
-    if (length > 2 && name[0] == '/' && name[1] == '/')
+    std::shared_ptr<NodeQuery> query;
+    auto it = queries.find(name);
+    if (it != queries.end())
     {
-        searchRecursively = true;
-        subStrStartPos = 2;
-        subStrlength -= 2;
-    }
-
-    // End with '/..'?
-    bool searchFromParent = false;
-    if (length > 3 &&
-        name[length-3] == '/' &&
-        name[length-2] == '.' &&
-        name[length-1] == '.')
-    {
-        searchFromParent = true;
-        subStrlength -= 3;
-    }
-
-    // Remove '//', '/..' if exist
-    std::string newName = name.substr(subStrStartPos, subStrlength);
-
-    if (searchFromParent)
-    {
-        newName.insert(0, "[[:alnum:]]+/");
-    }
-
-
-    if (searchRecursively)
-    {
-        // name is '//xxx'
-        doEnumerateRecursive(this, newName, callback);
-    }
-    else
-    {
-        // name is xxx
-        doEnumerate(newName, callback);
-    }
-}
-
-bool Node::doEnumerateRecursive(const Node* node, const std::string &name, std::function<bool (Node *)> callback) const
-{
-    bool ret =false;
-
-    if (node->doEnumerate(name, callback))
-    {
-        // search itself
-        ret = true;
+        query = it->second;
     }
     else
     {
-        // search its children
-        for (const auto& child : node->getChildren())
-        {
-            if (doEnumerateRecursive(child, name, callback))
-            {
-                ret = true;
-                break;
-            }
-        }
-    }
-
-    return ret;
-}
-
-bool Node::doEnumerate(std::string name, std::function<bool (Node *)> callback) const
-{
-    // name may be xxx/yyy, should find its parent
-    size_t pos = name.find('/');
-    std::string searchName = name;
-    bool needRecursive = false;
-    if (pos != name.npos)
-    {
-        searchName = name.substr(0, pos);
-        name.erase(0, pos+1);
-        needRecursive = true;
-    }
-
-    bool ret = false;
-    for (const auto& child : _children)
-    {
-        if (std::regex_match(child->_name, std::regex(searchName)))
+        if (queries.size() >= MAX_CACHED_QUERIES)
         {
-            if (!needRecursive)
-            {
-                // terminate enumeration if callback return true
-                if (callback(child))
-                {
-                    ret = true;
-                    break;
-                }
-            }
-            else
-            {
-                ret = child->doEnumerate(name, callback);
-                if (ret)
-                    break;
-            }
+            queries.clear();
         }
+        query = std::make_shared<NodeQuery>(name);
+        queries.emplace(name, query);
     }
 
-    return ret;
+    query->enumerate(this, callback);
 }
 
 /* "add" logic MUST only be on this method
@@ -855,6 +1108,47 @@ void Node::addChildHelper(Node* child, int localZOrder, int tag, const std::stri
         }
     }
 
+    if (_isAddingChildren)
+    {
+        return;
+    }
+
+    if (_cascadeColorEnabled)
+    {
+        updateCascadeColor();
+    }
+
+    if (_cascadeOpacityEnabled)
+    {
+        updateCascadeOpacity();
+    }
+}
+
+void Node::addChildren(const Vector<Node*>& children)
+{
+    if (children.empty())
+    {
+        return;
+    }
+    _children.reserve(_children.size() + children.size());
+
+    // a child added by the onEnter() of another one gets the updates below too
+    bool outermost = !_isAddingChildren;
+    _isAddingChildren = true;
+    for (const auto& child : children)
+    {
+        CCASSERT(child != nullptr, "Argument must be non-nil");
+        if (child)
+        {
+            addChild(child, child->_localZOrder, child->getName());
+        }
+    }
+    if (!outermost)
+    {
+        return;
+    }
+    _isAddingChildren = false;
+
     if (_cascadeColorEnabled)
     {
         updateCascadeColor();
@@ -870,7 +1164,7 @@ void Node::addChild(Node *child, int zOrder)
 {
     CCASSERT( child != nullptr, "Argument must be non-nil");
     if (child) {
-        addChild(child, zOrder, child->_name);
+        addChild(child, zOrder, child->getName());
     }
 }
 
@@ -878,7 +1172,7 @@ void Node::addChild(Node *child)
 {
     CCASSERT( child != nullptr, "Argument must be non-nil");
     if (child) {
-        addChild(child, child->_localZOrder, child->_name);
+        addChild(child, child->_localZOrder, child->getName());
     }
 }
 
@@ -907,11 +1201,50 @@ void Node::removeChild(Node* child, bool cleanup /* = true */)
         return;
     }
 
+    if (_isRemovingChildren)
+    {
+        // removeChildren() erases it with the others
+        if (child->_parent == this)
+        {
+            detachChild(child, CC_INVALID_INDEX, cleanup);
+        }
+        return;
+    }
+
     ssize_t index = _children.getIndex(child);
     if( index != CC_INVALID_INDEX )
         this->detachChild( child, index, cleanup );
 }
 
+void Node::removeChildren(const Vector<Node*>& children, bool cleanup /* = true */)
+{
+    if (_children.empty() || children.empty())
+    {
+        return;
+    }
+
+    // the children stay in the array until the end, so children may be _children, or be changed by an onExit()
+    bool outermost = !_isRemovingChildren;
+    _isRemovingChildren = true;
+    for (ssize_t i = 0; i < children.size(); ++i)
+    {
+        auto child = children.at(i);
+        if (child->_parent == this)
+        {
+            removeChild(child, cleanup);
+        }
+    }
+    if (!outermost)
+    {
+        return;
+    }
+    _isRemovingChildren = false;
+
+    _children.eraseIf([this](Node* child) { return child->_parent != this; });
+    invalidateChildNameIndex();
+    s_hierarchyVersion++;
+}
+
 void Node::removeChildByTag(int tag, bool cleanup/* = true */)
 {
     CCASSERT( tag != Node::INVALID_TAG, "Invalid tag");
@@ -975,6 +1308,8 @@ void Node::removeAllChildrenWithCleanup(bool cleanup)
     }
 
     _children.clear();
+    invalidateChildNameIndex();
+    s_hierarchyVersion++;
 }
 
 void Node::detachChild(Node *child, ssize_t childIndex, bool doCleanup)
@@ -998,7 +1333,13 @@ void Node::detachChild(Node *child, ssize_t childIndex, bool doCleanup)
     // set parent nil at the end
     child->setParent(nullptr);
 
-    _children.erase(childIndex);
+    // without an index, removeChildren() erases it
+    if (childIndex != CC_INVALID_INDEX)
+    {
+        _children.erase(childIndex);
+        invalidateChildNameIndex();
+        s_hierarchyVersion++;
+    }
 }
 
 
@@ -1009,6 +1350,8 @@ void Node::insertChild(Node* child, int z)
     _reorderChildDirty = true;
     _children.pushBack(child);
     child->_localZOrder = z;
+    invalidateChildNameIndex();
+    s_hierarchyVersion++;
 }
 
 void Node::reorderChild(Node *child, int zOrder)
@@ -1017,20 +1360,144 @@ void Node::reorderChild(Node *child, int zOrder)
     _reorderChildDirty = true;
     child->setOrderOfArrival(s_globalOrderOfArrival++);
     child->_localZOrder = zOrder;
+    invalidateCachedTexture();
 }
 
 void Node::sortAllChildren()
 {
-    if (_reorderChildDirty)
+    if (_reorderChildDirty || _childOrder != ChildOrder::LOCAL_Z_ORDER)
     {
-        std::sort(std::begin(_children), std::end(_children), nodeComparisonLess);
+        sortChildren();
         _reorderChildDirty = false;
     }
 }
 
-// MARK: draw / visit
-
-void Node::draw()
+void Node::setChildOrder(ChildOrder order)
+{
+    CCASSERT(order != ChildOrder::CUSTOM || (_coldData && _coldData->childOrderKey), "Set the key with setChildOrderKey()");
+    if (order != _childOrder)
+    {
+        _childOrder = order;
+        // back to the order of arrival
+        _reorderChildDirty = true;
+        _eventDispatcher->setReorderDirtyForNode(this);
+    }
+}
+
+void Node::setChildOrderKey(const std::function<float(Node*)>& key)
+{
+    if (key || _coldData)
+    {
+        getColdData()->childOrderKey = key;
+    }
+    setChildOrder(key ? ChildOrder::CUSTOM : ChildOrder::LOCAL_Z_ORDER);
+}
+
+// the bits of a float ordered as unsigned integers
+static uint32_t floatSortKey(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+bool Node::sortChildren()
+{
+    if (_childOrder == ChildOrder::LOCAL_Z_ORDER)
+    {
+        bool sorted = sortNodes(_children);
+        if (sorted)
+        {
+            // the first child of a name may have changed
+            invalidateChildNameIndex();
+        }
+        return sorted;
+    }
+
+    struct Entry
+    {
+        uint64_t key;
+        Node* node;
+    };
+    // sortAllChildren() may run on the workers of a parallel visit
+    static thread_local std::vector<Entry> entries, buffer;
+
+    const size_t count = _children.size();
+    entries.resize(count);
+    buffer.resize(count);
+
+    // local Z order first, then the key; the sort is stable, equal keys keep their order from the previous frame
+    bool sorted = true;
+    for (size_t i = 0; i < count; ++i)
+    {
+        Node* child = _children.at(i);
+        float key = _childOrder == ChildOrder::POSITION_Y ? -child->_position.y : _coldData->childOrderKey(child);
+        entries[i].key = ((uint64_t)((uint32_t)child->_localZOrder ^ 0x80000000u) << 32) | floatSortKey(key);
+        entries[i].node = child;
+        sorted = sorted && (i == 0 || entries[i - 1].key <= entries[i].key);
+    }
+    if (sorted)
+    {
+        return false;
+    }
+
+    // LSD radix sort by bytes, skipping the bytes all the keys share (e.g. the local Z order)
+    size_t histograms[8][256] = {};
+    for (const auto& entry : entries)
+    {
+        for (int b = 0; b < 8; ++b)
+        {
+            ++histograms[b][(entry.key >> (b * 8)) & 0xff];
+        }
+    }
+    for (int b = 0; b < 8; ++b)
+    {
+        auto& histogram = histograms[b];
+        if (histogram[(entries[0].key >> (b * 8)) & 0xff] == count)
+        {
+            continue;
+        }
+
+        size_t offset = 0;
+        for (auto& bucket : histogram)
+        {
+            size_t n = bucket;
+            bucket = offset;
+            offset += n;
+        }
+        for (const auto& entry : entries)
+        {
+            buffer[histogram[(entry.key >> (b * 8)) & 0xff]++] = entry;
+        }
+        entries.swap(buffer);
+    }
+
+    bool changed = false;
+    for (size_t i = 0; i < count; ++i)
+    {
+        Node* child = entries[i].node;
+        if (_children.at(i) != child)
+        {
+            *(_children.begin() + i) = child;
+            changed = true;
+        }
+    }
+    if (changed)
+    {
+        invalidateChildNameIndex();
+    }
+
+    // the children get a new listener priority, as setLocalZOrder() does, but the dispatcher isn't thread safe
+    if (changed && std::this_thread::get_id() == _director->getCocos2dThreadId())
+    {
+        _eventDispatcher->setReorderDirtyForNode(this);
+    }
+    return changed;
+}
+
+// MARK: draw / visit
+
+void Node::draw()
 {
     auto renderer = _director->getRenderer();
     draw(renderer, _modelViewTransform, true);
@@ -1048,6 +1515,33 @@ void Node::visit()
 }
 
 uint32_t Node::processParentFlags(const Mat4& parentTransform, uint32_t parentFlags)
+{
+    // the interpolated values make the transform dirty, it isn't taken from the TransformSystem then
+    const bool interpolated = _coldData && _coldData->interpolation && beginInterpolation();
+
+    uint32_t flags;
+    if (!TransformSystem::fetchTransform(this, parentTransform, parentFlags, &flags))
+    {
+        flags |= updateTransformFlags(parentFlags);
+        if(flags & FLAGS_DIRTY_MASK)
+            _modelViewTransform = this->transform(parentTransform);
+    }
+
+    if (interpolated)
+    {
+        endInterpolation();
+    }
+
+    // the touch listeners of the node move in the touch spatial index
+    if (_touchIndexListenerCount > 0 && !_touchIndexDirty && (flags & FLAGS_DIRTY_MASK))
+    {
+        _eventDispatcher->setTouchIndexDirtyForNode(this);
+    }
+
+    return flags;
+}
+
+uint32_t Node::updateTransformFlags(uint32_t parentFlags)
 {
     if(_usingNormalizedPosition)
     {
@@ -1066,10 +1560,6 @@ uint32_t Node::processParentFlags(const Mat4& parentTransform, uint32_t parentFl
     flags |= (_transformUpdated ? FLAGS_TRANSFORM_DIRTY : 0);
     flags |= (_contentSizeDirty ? FLAGS_CONTENT_SIZE_DIRTY : 0);
 
-
-    if(flags & FLAGS_DIRTY_MASK)
-        _modelViewTransform = this->transform(parentTransform);
-
     _transformUpdated = false;
     _contentSizeDirty = false;
 
@@ -1091,11 +1581,45 @@ void Node::visit(Renderer* renderer, const Mat4 &parentTransform, uint32_t paren
 
     uint32_t flags = processParentFlags(parentTransform, parentFlags);
 
+    // quick return if the whole subtree is out of the window
+    if (isSubtreeCulled(flags))
+    {
+        return;
+    }
+
+    const bool nativeResolution = _coldData && _coldData->nativeResolution && pushNativeResolutionGroup(renderer);
+
+    if (_coldData && (_coldData->cacheAsTexture || _coldData->cacheAsGeometry))
+    {
+        if (_coldData->cacheAsTexture ? visitCachedTexture(renderer) : visitCachedGeometry(renderer, flags))
+        {
+            if (nativeResolution)
+            {
+                renderer->popGroup();
+            }
+            return;
+        }
+        // the children may keep the transforms of the last time they were drawn into the texture or recorded
+        flags |= FLAGS_TRANSFORM_DIRTY;
+    }
+
+    drawSubtree(renderer, _modelViewTransform, flags);
+
+    if (nativeResolution)
+    {
+        renderer->popGroup();
+    }
+
+    updateSubtreeBounds();
+}
+
+void Node::drawSubtree(Renderer* renderer, const Mat4& transform, uint32_t flags)
+{
     // IMPORTANT:
     // To ease the migration to v3.0, we still support the Mat4 stack,
     // but it is deprecated and your code should not rely on it
     _director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
-    _director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, _modelViewTransform);
+    _director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, transform);
 
     int i = 0;
 
@@ -1108,19 +1632,21 @@ void Node::visit(Renderer* renderer, const Mat4 &parentTransform, uint32_t paren
             auto node = _children.at(i);
 
             if (node && node->_localZOrder < 0)
-                node->visit(renderer, _modelViewTransform, flags);
+                node->visit(renderer, transform, flags);
             else
                 break;
         }
         // self draw
-        this->draw(renderer, _modelViewTransform, flags);
+        Renderer::setDebugOwner(this);
+        this->draw(renderer, transform, flags);
 
         for(auto it=_children.cbegin()+i; it != _children.cend(); ++it)
-            (*it)->visit(renderer, _modelViewTransform, flags);
+            (*it)->visit(renderer, transform, flags);
     }
     else
     {
-        this->draw(renderer, _modelViewTransform, flags);
+        Renderer::setDebugOwner(this);
+        this->draw(renderer, transform, flags);
     }
 
     _director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
@@ -1128,7 +1654,477 @@ void Node::visit(Renderer* renderer, const Mat4 &parentTransform, uint32_t paren
 
 Mat4 Node::transform(const Mat4& parentTransform)
 {
-    return parentTransform * this->getNodeToParentTransform();
+    const Mat4& transform = this->getNodeToParentTransform();
+    if (TransformIsAffine2D(transform) && TransformIsAffine2D(parentTransform))
+    {
+        Mat4 ret;
+        TransformConcatAffine2D(parentTransform, transform, &ret);
+        return ret;
+    }
+    return parentTransform * transform;
+}
+
+// MARK: culling
+
+// the 2D bounds only hold for transforms that keep the z = 0 plane in place, the projection may be a perspective one
+static bool isPlanarTransform(const Mat4& transform)
+{
+    return transform.m[2] == 0 && transform.m[6] == 0 && transform.m[14] == 0;
+}
+
+static void expandBounds(const Rect& rect, const Mat4& transform, float& minX, float& minY, float& maxX, float& maxY)
+{
+    const float corners[4][2] = {
+        { rect.getMinX(), rect.getMinY() },
+        { rect.getMaxX(), rect.getMinY() },
+        { rect.getMinX(), rect.getMaxY() },
+        { rect.getMaxX(), rect.getMaxY() },
+    };
+
+    for (const auto& corner : corners)
+    {
+        float x = transform.m[0] * corner[0] + transform.m[4] * corner[1] + transform.m[12];
+        float y = transform.m[1] * corner[0] + transform.m[5] * corner[1] + transform.m[13];
+        minX = std::min(minX, x);
+        minY = std::min(minY, y);
+        maxX = std::max(maxX, x);
+        maxY = std::max(maxY, y);
+    }
+}
+
+void Node::setCullingEnabled(bool enabled)
+{
+    if (enabled != _isCullingEnabled)
+    {
+        _isCullingEnabled = enabled;
+        invalidateSubtreeBounds();
+    }
+}
+
+void Node::invalidateSubtreeBounds()
+{
+    // the node moved in its parent, or was shown or hidden, the caches above it hold the previous picture
+    if (_parent)
+    {
+        _parent->invalidateCachedTexture();
+
+        // the SpatialNode parent places the node in its new cell before the next visit
+        if (_parent->_isSpatialContainer && !_spatialCellDirty)
+        {
+            static_cast<SpatialNode*>(_parent)->markChildMoved(this);
+        }
+    }
+
+    // the ancestors of a dirty node are dirty too, unless it wasn't visited since, e.g. when it's hidden
+    _subtreeBoundsDirty = true;
+    for (auto node = _parent; node && !node->_subtreeBoundsDirty; node = node->_parent)
+    {
+        node->_subtreeBoundsDirty = true;
+    }
+}
+
+bool Node::isSubtreeCulled(uint32_t flags)
+{
+    if (_subtreeBoundsDirty || !_subtreeBoundsValid || !_director->isCullingEnabled() || !isPlanarTransform(_modelViewTransform))
+    {
+        return false;
+    }
+
+    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+    expandBounds(_subtreeBounds, _modelViewTransform, minX, minY, maxX, maxY);
+
+    const Size& winSize = _director->getWinSize();
+    if (maxX < 0 || maxY < 0 || minX > winSize.width || minY > winSize.height)
+    {
+        if (flags & FLAGS_DIRTY_MASK)
+        {
+            // the children didn't get the new transform, they will when the node is visited again
+            _transformUpdated = true;
+        }
+        return true;
+    }
+    return false;
+}
+
+void Node::updateSubtreeBounds()
+{
+    if (!_subtreeBoundsDirty)
+    {
+        return;
+    }
+    _subtreeBoundsDirty = false;
+    _subtreeBoundsValid = false;
+
+    if (!_isCullingEnabled)
+    {
+        return;
+    }
+
+    float minX = 0, minY = 0, maxX = _contentSize.width, maxY = _contentSize.height;
+    for (const auto& child : _children)
+    {
+        if (!child->_visible)
+        {
+            continue;
+        }
+        // a child that doesn't update its bounds, e.g. because it overrides visit(), can't be culled
+        if (child->_subtreeBoundsDirty || !child->_subtreeBoundsValid)
+        {
+            return;
+        }
+        const Mat4& transform = child->getNodeToParentTransform();
+        if (!isPlanarTransform(transform))
+        {
+            return;
+        }
+        expandBounds(child->_subtreeBounds, transform, minX, minY, maxX, maxY);
+    }
+
+    _subtreeBounds.setRect(minX, minY, maxX - minX, maxY - minY);
+    _subtreeBoundsValid = true;
+}
+
+// MARK: texture cache
+
+void Node::setDrawnAtNativeResolution(bool enabled)
+{
+    if (enabled != isDrawnAtNativeResolution())
+    {
+        getColdData()->nativeResolution = enabled;
+    }
+}
+
+// MARK: interpolation
+
+void Node::setInterpolationEnabled(bool enabled)
+{
+    if (enabled != isInterpolationEnabled())
+    {
+        getColdData()->interpolation = enabled;
+        _coldData->interpolationValid = false;
+        // the last transform may be an interpolated one
+        _transformUpdated = _transformDirty = _inverseDirty = true;
+    }
+}
+
+bool Node::beginInterpolation()
+{
+    auto scheduler = _director->getScheduler();
+    if (scheduler->getFixedTimeStep() <= 0)
+    {
+        return false;
+    }
+
+    auto data = _coldData;
+    ColdData::TransformValues current = { _position, _rotationZ_X, _rotationZ_Y, _scaleX, _scaleY };
+    const uint64_t step = scheduler->getFixedStepCount();
+    const uint64_t steps = step - data->interpolationStep;
+    if (!data->interpolationValid || step < data->interpolationStep || steps > scheduler->getMaxFixedSteps())
+    {
+        // first drawn, or not drawn the previous frame: nothing to interpolate from
+        data->interpolationFrom = current;
+        data->interpolationSteps = 1;
+        data->interpolationValid = true;
+    }
+    else if (steps > 0)
+    {
+        data->interpolationFrom = data->interpolationTo;
+        data->interpolationSteps = (unsigned int)steps;
+    }
+    else if (memcmp(&current, &data->interpolationTo, sizeof(current)) != 0)
+    {
+        // moved outside of the steps, e.g. by an input event
+        data->interpolationFrom = current;
+        data->interpolationSteps = 1;
+    }
+    data->interpolationTo = current;
+    data->interpolationStep = step;
+
+    const auto& from = data->interpolationFrom;
+    if (memcmp(&from, &current, sizeof(current)) == 0)
+    {
+        return false;
+    }
+
+    // the steps of the frame are taken as one, the node is drawn `alpha` after the one before the last
+    const float n = (float)data->interpolationSteps;
+    const float t = (n - 1 + scheduler->getInterpolationAlpha()) / n;
+    data->interpolationLogic = current;
+    _position = from.position + (current.position - from.position) * t;
+    _rotationZ_X = from.rotationX + (current.rotationX - from.rotationX) * t;
+    _rotationZ_Y = from.rotationY + (current.rotationY - from.rotationY) * t;
+    _scaleX = from.scaleX + (current.scaleX - from.scaleX) * t;
+    _scaleY = from.scaleY + (current.scaleY - from.scaleY) * t;
+    _transformUpdated = _transformDirty = _inverseDirty = true;
+
+    // the next frames are drawn until the node reaches its step, retained mode or not
+    _director->requestRedraw();
+    return true;
+}
+
+void Node::endInterpolation()
+{
+    const auto& logic = _coldData->interpolationLogic;
+    _position = logic.position;
+    _rotationZ_X = logic.rotationX;
+    _rotationZ_Y = logic.rotationY;
+    _scaleX = logic.scaleX;
+    _scaleY = logic.scaleY;
+    // the cached transform is the interpolated one, it's computed again for the logic and for the next frame
+    _transformUpdated = _transformDirty = _inverseDirty = true;
+}
+
+bool Node::pushNativeResolutionGroup(Renderer* renderer)
+{
+    // the render groups are on the main thread only
+    if (std::this_thread::get_id() != _director->getCocos2dThreadId())
+    {
+        return false;
+    }
+
+    // drawn straight into the scene, not into a RenderTexture or an ancestor drawn at native resolution
+    auto stack = _director->getPostProcessStack();
+    if (!stack->isDrawingScene() || renderer->getCurrentRenderQueueID() != stack->getRenderQueueID())
+    {
+        return false;
+    }
+
+    renderer->pushGroup(stack->getOverlayRenderQueueID());
+    return true;
+}
+
+void Node::setCacheAsTexture(bool enabled)
+{
+    if (enabled == isCacheAsTexture())
+    {
+        return;
+    }
+
+    if (enabled)
+    {
+        setCacheAsGeometry(false);
+    }
+
+    auto coldData = getColdData();
+    coldData->cacheAsTexture = enabled;
+    if (enabled)
+    {
+        ++s_cachedTextureCount;
+        markCachedTexturesDirty();
+    }
+    else
+    {
+        --s_cachedTextureCount;
+        CC_SAFE_RELEASE_NULL(coldData->cachedTexture);
+        coldData->cachedTextureDirty = false;
+        // the children were last given transforms in the space of the texture
+        _transformUpdated = true;
+        if (_parent)
+        {
+            _parent->invalidateCachedTexture();
+        }
+    }
+}
+
+void Node::setCacheAsGeometry(bool enabled)
+{
+    if (enabled == isCacheAsGeometry())
+    {
+        return;
+    }
+
+    if (enabled)
+    {
+        setCacheAsTexture(false);
+    }
+
+    auto coldData = getColdData();
+    coldData->cacheAsGeometry = enabled;
+    if (enabled)
+    {
+        ++s_cachedTextureCount;
+        markCachedTexturesDirty();
+    }
+    else
+    {
+        --s_cachedTextureCount;
+        CC_SAFE_DELETE(coldData->staticBatch);
+        coldData->cachedTextureDirty = false;
+        // the children were last given transforms in the space of the recording
+        _transformUpdated = true;
+        if (_parent)
+        {
+            _parent->invalidateCachedTexture();
+        }
+    }
+}
+
+void Node::markCachedTexturesDirty()
+{
+    for (auto node = this; node; node = node->_parent)
+    {
+        if (node->_coldData && (node->_coldData->cacheAsTexture || node->_coldData->cacheAsGeometry))
+        {
+            node->_coldData->cachedTextureDirty = true;
+        }
+    }
+}
+
+// the bounds of the content sizes of the visible descendants, `transform` goes from the space of `node` to the cached one
+static void expandCachedBounds(Node* node, const Mat4& transform, float& minX, float& minY, float& maxX, float& maxY)
+{
+    for (const auto& child : node->getChildren())
+    {
+        if (!child->isVisible())
+        {
+            continue;
+        }
+        const Mat4 childTransform = transform * child->getNodeToParentTransform();
+        expandBounds(Rect(Vec2::ZERO, child->getContentSize()), childTransform, minX, minY, maxX, maxY);
+        expandCachedBounds(child, childTransform, minX, minY, maxX, maxY);
+    }
+}
+
+bool Node::visitCachedTexture(Renderer* renderer)
+{
+    // the texture is drawn with the projection stack and a render group, which the worker threads don't have
+    if (std::this_thread::get_id() != _director->getCocos2dThreadId())
+    {
+        return false;
+    }
+
+    auto coldData = _coldData;
+    if (coldData->cachedTextureDirty)
+    {
+        // cleared first, a node that changes while it's drawn marks the texture again for the next frame
+        coldData->cachedTextureDirty = false;
+        if (!renderCachedTexture(renderer))
+        {
+            CC_SAFE_RELEASE_NULL(coldData->cachedTexture);
+        }
+        updateSubtreeBounds();
+    }
+
+    auto texture = coldData->cachedTexture;
+    if (texture == nullptr)
+    {
+        return false;
+    }
+
+    Mat4 transform = _modelViewTransform;
+    transform.translate(coldData->cachedTextureRect.origin.x, coldData->cachedTextureRect.origin.y, 0);
+    auto sprite = texture->getSprite();
+    sprite->setGlobalZOrder(_globalZOrder);
+    sprite->visit(renderer, transform, FLAGS_TRANSFORM_DIRTY);
+    return true;
+}
+
+bool Node::renderCachedTexture(Renderer* renderer)
+{
+    auto coldData = _coldData;
+
+    float minX = 0, minY = 0, maxX = _contentSize.width, maxY = _contentSize.height;
+    expandCachedBounds(this, Mat4::IDENTITY, minX, minY, maxX, maxY);
+
+    // on whole points, the texels fall on the pixels when the node isn't scaled
+    minX = std::floor(minX);
+    minY = std::floor(minY);
+    const int width = (int)std::ceil(maxX - minX);
+    const int height = (int)std::ceil(maxY - minY);
+    const int maxSize = (int)(Configuration::getInstance()->getMaxTextureSize() / CC_CONTENT_SCALE_FACTOR());
+    if (width <= 0 || height <= 0 || width > maxSize || height > maxSize)
+    {
+        return false;
+    }
+
+    const Rect rect(minX, minY, width, height);
+    if (coldData->cachedTexture == nullptr || !coldData->cachedTextureRect.size.equals(rect.size))
+    {
+        CC_SAFE_RELEASE_NULL(coldData->cachedTexture);
+        // with a stencil buffer for the clipping nodes of the subtree
+        auto texture = RenderTexture::create(width, height, Texture2D::PixelFormat::RGBA8888, GL_DEPTH24_STENCIL8);
+        if (texture == nullptr)
+        {
+            return false;
+        }
+        texture->setKeepMatrix(true);
+        texture->getSprite()->setAnchorPoint(Vec2::ZERO);
+        texture->retain();
+        coldData->cachedTexture = texture;
+    }
+    coldData->cachedTextureRect = rect;
+
+    // the texture maps the rectangle of the node space, the subtree is drawn in the space of the node
+    Mat4 projection;
+    Mat4::createOrthographicOffCenter(rect.getMinX(), rect.getMaxX(), rect.getMinY(), rect.getMaxY(), -1024, 1024, &projection);
+    _director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION);
+    _director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION, projection);
+
+    auto texture = coldData->cachedTexture;
+    texture->setGlobalZOrder(_globalZOrder);
+    texture->beginWithClear(0, 0, 0, 0, 1, 0);
+    drawSubtree(renderer, Mat4::IDENTITY, FLAGS_DIRTY_MASK);
+    texture->end();
+
+    _director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION);
+    return true;
+}
+
+bool Node::visitCachedGeometry(Renderer* renderer, uint32_t flags)
+{
+    // the recording goes through the command list of the renderer, which a worker thread or an outer recording owns
+    if (std::this_thread::get_id() != _director->getCocos2dThreadId() || Renderer::isRecordingCommandList())
+    {
+        return false;
+    }
+
+    auto coldData = _coldData;
+    if (coldData->cachedTextureDirty || (coldData->staticBatch && !coldData->staticBatch->isValid()))
+    {
+        // cleared first, a node that changes while it's recorded marks the batch again for the next frame
+        coldData->cachedTextureDirty = false;
+        if (!recordCachedGeometry(renderer))
+        {
+            CC_SAFE_DELETE(coldData->staticBatch);
+        }
+        updateSubtreeBounds();
+    }
+
+    auto batch = coldData->staticBatch;
+    if (batch == nullptr)
+    {
+        return false;
+    }
+
+    batch->draw(renderer, _modelViewTransform, flags, _globalZOrder);
+    return true;
+}
+
+bool Node::recordCachedGeometry(Renderer* renderer)
+{
+    auto coldData = _coldData;
+
+    // the subtree is recorded in the space of the node, where the window culling means nothing
+    Renderer::CommandList list;
+    list.cullingEnabled = false;
+    const bool cullingEnabled = _director->isCullingEnabled();
+    _director->setCullingEnabled(false);
+
+    renderer->beginCommandList(&list);
+    drawSubtree(renderer, Mat4::IDENTITY, FLAGS_DIRTY_MASK);
+    renderer->endCommandList();
+
+    _director->setCullingEnabled(cullingEnabled);
+
+    if (coldData->staticBatch == nullptr)
+    {
+        coldData->staticBatch = new (std::nothrow) StaticBatch();
+        if (coldData->staticBatch == nullptr)
+        {
+            return false;
+        }
+    }
+    return coldData->staticBatch->record(list, _globalZOrder);
 }
 
 // MARK: events
@@ -1320,6 +2316,16 @@ void Node::scheduleOnce(const std::function<void(float)> &callback, float delay,
     _scheduler->schedule(callback, this, 0, 0, delay, !_running, key);
 }
 
+ccSchedulerHandle Node::scheduleOnce(const std::function<void(float)> &callback, float delay)
+{
+    return _scheduler->scheduleOnce(callback, this, delay, !_running);
+}
+
+ccSchedulerHandle Node::schedule(const std::function<void(float)>& callback, float interval, unsigned int repeat, float delay)
+{
+    return _scheduler->schedule(callback, this, interval, repeat, delay, !_running);
+}
+
 void Node::unschedule(SEL_SCHEDULE selector)
 {
     // explicit null handling
@@ -1334,6 +2340,11 @@ void Node::unschedule(const std::string &key)
     _scheduler->unschedule(key, this);
 }
 
+void Node::unschedule(ccSchedulerHandle handle)
+{
+    _scheduler->unschedule(handle);
+}
+
 void Node::unscheduleAllCallbacks()
 {
     _scheduler->unscheduleAllForTarget(this);
@@ -1341,16 +2352,31 @@ void Node::unscheduleAllCallbacks()
 
 void Node::resume()
 {
+    // the Scheduler takes any pointer as a target, it's looked up for every node
     _scheduler->resumeTarget(this);
-    _actionManager->resumeTarget(this);
-    _eventDispatcher->resumeEventListenersForTarget(this);
+
+    // most nodes of a large subtree have no actions nor listeners, onEnter() skips their lookups
+    if (_actionTargetCount > 0)
+    {
+        _actionManager->resumeTarget(this);
+    }
+    if (_eventListenerCount > 0)
+    {
+        _eventDispatcher->resumeEventListenersForTarget(this);
+    }
 }
 
 void Node::pause()
 {
     _scheduler->pauseTarget(this);
-    _actionManager->pauseTarget(this);
-    _eventDispatcher->pauseEventListenersForTarget(this);
+    if (_actionTargetCount > 0)
+    {
+        _actionManager->pauseTarget(this);
+    }
+    if (_eventListenerCount > 0)
+    {
+        _eventDispatcher->pauseEventListenersForTarget(this);
+    }
 }
 
 // override me
@@ -1392,6 +2418,74 @@ AffineTransform Node::getNodeToParentAffineTransform(Node* ancestor) const
 }
 const Mat4& Node::getNodeToParentTransform() const
 {
+    // no 3D rotation, z or 3D additional transform: compose the 2D affine transform only
+    if (_transformDirty && _rotationX == 0 && _rotationY == 0 && _positionZ == 0 && _scaleZ == 1.f
+        && (!_useAdditionalTransform || TransformIsAffine2D(_coldData->additionalTransform)))
+    {
+        float x = _position.x;
+        float y = _position.y;
+
+        if (_ignoreAnchorPointForPosition)
+        {
+            x += _anchorPointInPoints.x;
+            y += _anchorPointInPoints.y;
+        }
+
+        // Rotation values, skewed when _rotationZ_X != _rotationZ_Y
+        float cx = 1, sx = 0, cy = 1, sy = 0;
+        if (_rotationZ_X)
+        {
+            float radiansX = -CC_DEGREES_TO_RADIANS(_rotationZ_X);
+            cx = cosf(radiansX);
+            sx = sinf(radiansX);
+        }
+        if (_rotationZ_X == _rotationZ_Y)
+        {
+            cy = cx;
+            sy = sx;
+        }
+        else if (_rotationZ_Y)
+        {
+            float radiansY = -CC_DEGREES_TO_RADIANS(_rotationZ_Y);
+            cy = cosf(radiansY);
+            sy = sinf(radiansY);
+        }
+
+        // rotation * scale, around the anchor point
+        AffineTransform t;
+        t.a = cy * _scaleX;
+        t.b = sy * _scaleX;
+        t.c = -sx * _scaleY;
+        t.d = cx * _scaleY;
+        t.tx = x - (t.a * _anchorPointInPoints.x + t.c * _anchorPointInPoints.y);
+        t.ty = y - (t.b * _anchorPointInPoints.x + t.d * _anchorPointInPoints.y);
+
+        // same as the skew matrix and anchor point adjustment below
+        if (_skewX || _skewY)
+        {
+            float skewX = tanf(CC_DEGREES_TO_RADIANS(_skewX));
+            float skewY = tanf(CC_DEGREES_TO_RADIANS(_skewY));
+            float a = t.a, b = t.b;
+            t.a += skewY * t.c;
+            t.b += skewY * t.d;
+            t.c += skewX * a;
+            t.d += skewX * b;
+
+            t.tx += _anchorPointInPoints.x * _scaleX - (t.a * _anchorPointInPoints.x + t.c * _anchorPointInPoints.y);
+            t.ty += _anchorPointInPoints.y * _scaleY - (t.b * _anchorPointInPoints.x + t.d * _anchorPointInPoints.y);
+        }
+
+        if (_useAdditionalTransform)
+        {
+            AffineTransform additional;
+            GLToCGAffine(_coldData->additionalTransform.m, &additional);
+            t = AffineTransformConcat(additional, t);
+        }
+
+        CGAffineToGL(t, _transform.m);
+        _transformDirty = false;
+    }
+
     if (_transformDirty)
     {
         // Translate values
@@ -1485,7 +2579,7 @@ const Mat4& Node::getNodeToParentTransform() const
 
         if (_useAdditionalTransform)
         {
-            _transform = _transform * _additionalTransform;
+            _transform = _transform * _coldData->additionalTransform;
         }
 
         _transformDirty = false;
@@ -1499,6 +2593,7 @@ void Node::setNodeToParentTransform(const Mat4& transform)
     _transform = transform;
     _transformDirty = false;
     _transformUpdated = true;
+    invalidateSubtreeBounds();
 }
 
 void Node::setAdditionalTransform(const AffineTransform& additionalTransform)
@@ -1516,10 +2611,11 @@ void Node::setAdditionalTransform(Mat4* additionalTransform)
     }
     else
     {
-        _additionalTransform = *additionalTransform;
+        getColdData()->additionalTransform = *additionalTransform;
         _useAdditionalTransform = true;
     }
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSubtreeBounds();
 }
 
 
@@ -1533,13 +2629,14 @@ AffineTransform Node::getParentToNodeAffineTransform() const
 
 const Mat4& Node::getParentToNodeTransform() const
 {
+    auto coldData = getColdData();
     if ( _inverseDirty )
     {
-        _inverse = getNodeToParentTransform().getInversed();
+        coldData->inverse = getNodeToParentTransform().getInversed();
         _inverseDirty = false;
     }
 
-    return _inverse;
+    return coldData->inverse;
 }
 
 
@@ -1642,6 +2739,7 @@ void Node::updateDisplayedOpacity(GLubyte parentOpacity)
 {
     _displayedOpacity = _realOpacity * parentOpacity/255.0;
     updateColor();
+    invalidateCachedTexture();
 
     if (_cascadeOpacityEnabled)
     {
@@ -1721,6 +2819,7 @@ void Node::updateDisplayedColor(const Color3B& parentColor)
     _displayedColor.g = _realColor.g * parentColor.g/255.0;
     _displayedColor.b = _realColor.b * parentColor.b/255.0;
     updateColor();
+    invalidateCachedTexture();
 
     if (_cascadeColorEnabled)
     {
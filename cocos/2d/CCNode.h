@@ -29,9 +29,12 @@
 #ifndef __CCNODE_H__
 #define __CCNODE_H__
 
+#include <unordered_map>
+
 #include "base/ccMacros.h"
 #include "base/CCVector.h"
 #include "base/CCProtocols.h"
+#include "base/CCScheduler.h"
 #include "math/CCAffineTransform.h"
 #include "math/CCMath.h"
 
@@ -52,6 +55,9 @@ class Director;
 class GLProgram;
 class GLProgramState;
 class Material;
+class TransformSystem;
+class RenderTexture;
+class StaticBatch;
 
 /**
  * @addtogroup _2d
@@ -68,6 +74,16 @@ enum {
 
 bool CC_DLL nodeComparisonLess(Node* n1, Node* n2);
 
+/**
+ * Sorts nodes with nodeComparisonLess, like std::sort but adapted to nodes which are nearly sorted already.
+ * The few nodes whose local Z order changed since the last sort are reinserted at their place, in
+ * O(n + moves). Once the moves grow past a few per node, the rest is sorted with std::sort and merged.
+ *
+ * @param nodes The nodes to sort.
+ * @return True if the order of the nodes changed.
+ */
+bool CC_DLL sortNodes(Vector<Node*>& nodes);
+
 /** @class Node
 * @brief Node is the base element of the Scene Graph. Elements of the Scene Graph must be Node objects or subclasses of it.
  The most common Node objects are: Scene, Layer, Sprite, Menu, Label.
@@ -108,6 +124,16 @@ public:
 
         FLAGS_DIRTY_MASK = (FLAGS_TRANSFORM_DIRTY | FLAGS_CONTENT_SIZE_DIRTY),
     };
+
+    /** ChildOrder
+     How the children are ordered among the children of the same local Z order, see setChildOrder().
+     */
+    enum class ChildOrder
+    {
+        LOCAL_Z_ORDER,  /** By order of arrival, the children are only sorted when reordered. */
+        POSITION_Y,     /** By position Y, the higher children are drawn first, like setLocalZOrder(-y). */
+        CUSTOM,         /** By the key of setChildOrderKey(), the lower keys are drawn first. */
+    };
     /// @{
     /// @name Constructor, Destructor and Initializers
 
@@ -684,6 +710,16 @@ public:
      *
      */
     virtual void addChild(Node* child, int localZOrder, const std::string &name);
+    /**
+     * Adds the children to the container, each with its own local Z order and name like `addChild(Node*)`.
+     *
+     * The children array grows once, and the cascaded color and opacity are updated once at the end
+     * instead of for each child. The children are still added by `addChild()`, with the checks of the subclasses.
+     *
+     * @param children  The nodes to add, none of them may have a parent.
+     * @since v3.11
+     */
+    void addChildren(const Vector<Node*>& children);
     /**
      * Gets a child from the container with its tag.
      *
@@ -724,6 +760,15 @@ public:
     */
     template <typename T>
     inline T getChildByName(const std::string& name) const { return static_cast<T>(getChildByName(name)); }
+    /**
+     * Gets a child from the container with the atom of its name, see internName().
+     * The nodes with many children keep an index of their children by name, built by the first lookup.
+     *
+     * @param atom   The atom of the name of the child.
+     *
+     * @return the first child with that name, nullptr if there is none.
+     */
+    Node* getChildByNameAtom(unsigned int atom) const;
     /** Search the children of the receiving node to perform processing for nodes which share a name.
      *
      * @param name The name to search for, supports c++11 regular expression.
@@ -744,6 +789,9 @@ public:
      *
      * @warning Only support alpha or number for name, and not support unicode.
      *
+     * The names without regular expression syntax are matched by their atom, a NodeQuery kept by the caller skips
+     * the parsing of the search string too.
+     *
      * @param callback A callback function to execute on nodes that match the `name` parameter. The function takes the following arguments:
      *  `node`
      *      A node that matches the name
@@ -767,6 +815,29 @@ public:
      */
     virtual ssize_t getChildrenCount() const;
 
+    /**
+     * Reserves the storage of `count` children, so adding them doesn't grow it several times.
+     *
+     * @param count The number of children the node will have.
+     * @since v3.11
+     */
+    void reserveChildren(ssize_t count) { _children.reserve(count); }
+
+    /**
+     * Creates a copy of the node and of its children, so a template subtree built once is cloned instead of running
+     * the create and init code of every node again.
+     *
+     * The copies get the transforms, colors, z orders, tags, names and visibility of the originals. They share the
+     * textures, sprite frames and fonts. A GLProgramState without uniforms is shared, one with uniforms is cloned.
+     * Actions, schedules, event listeners, user data and the caches of setCacheAsTexture() aren't copied.
+     * Node, Layer, LayerColor, Sprite and Label are cloned. A class that doesn't override cloneInstance() is
+     * cloned as its closest base that does, with a message in the log.
+     *
+     * @return An autoreleased copy of the subtree.
+     * @since v3.11
+     */
+    Node* clone() const;
+
     /**
      * Sets the parent node.
      *
@@ -809,6 +880,18 @@ public:
      */
     virtual void removeChild(Node* child, bool cleanup = true);
 
+    /**
+     * Removes the children from the container, the nodes that aren't children of this one are skipped.
+     *
+     * Each child is removed by `removeChild()`, but they're all erased from the children array at the end in one pass,
+     * instead of a search and an erase for each. The array may be `getChildren()` itself.
+     *
+     * @param children  The nodes to remove.
+     * @param cleanup   True if all running actions and callbacks on the children should be cleaned up, false otherwise.
+     * @since v3.11
+     */
+    virtual void removeChildren(const Vector<Node*>& children, bool cleanup = true);
+
     /**
      * Removes a child from the container by tag value. It will also cleanup all running actions depending on the cleanup parameter.
      *
@@ -855,6 +938,33 @@ public:
      */
     virtual void sortAllChildren();
 
+    /**
+     * Sets how the children are ordered. With POSITION_Y or CUSTOM, the children are sorted by their local Z order
+     * then by their key in one pass before each visit, so moving children don't need a setLocalZOrder() call each
+     * frame. The keys are sorted with a radix sort, only when they are out of order.
+     * The moved children get a new touch priority, as with setLocalZOrder(), except in a subtree visited on a
+     * worker thread (see setParallelVisitEnabled()). A SpriteBatchNode orders the children of its sprites when it
+     * sorts its own children.
+     * LOCAL_Z_ORDER by default.
+     *
+     * @param order How the children are ordered.
+     */
+    void setChildOrder(ChildOrder order);
+
+    /** Returns how the children are ordered.
+     *
+     * @return How the children are ordered.
+     */
+    ChildOrder getChildOrder() const { return _childOrder; }
+
+    /**
+     * Orders the children by a custom key, e.g. the bottom of their bounding box, and sets the ChildOrder to CUSTOM.
+     * The key is computed for every child before each visit, it must be cheap.
+     *
+     * @param key The key of a child, nullptr to order the children by local Z order again.
+     */
+    void setChildOrderKey(const std::function<float(Node*)>& key);
+
     /// @} end of Children and Parent
 
     /// @{
@@ -892,6 +1002,32 @@ public:
      */
     virtual void setName(const std::string& name);
 
+    /** Returns the atom of the name of the node, 0 if it has no name, see internName(). */
+    unsigned int getNameAtom() const { return _nameAtom; }
+    /** Changes the name to the one of an atom returned by internName(), without hashing the name again. */
+    void setNameAtom(unsigned int atom);
+
+    /**
+     * Returns the atom of a name, the number all the nodes with that name share, so the lookups by name compare
+     * numbers instead of strings. The atoms are reference counted: the nodes named with it hold one reference each,
+     * and the caller holds the one returned until it calls releaseNameAtom(). Once no one holds it, the name is
+     * dropped and its atom reused, so naming nodes with generated names doesn't grow the table forever.
+     * Must be called on the main thread, like setName().
+     *
+     * @param name A name, the atom of the empty name is 0.
+     * @return The atom, with a reference held by the caller.
+     */
+    static unsigned int internName(const std::string& name);
+
+    /** Adds a reference to an atom returned by internName(). */
+    static void retainNameAtom(unsigned int atom);
+
+    /** Releases a reference to an atom, see internName(). */
+    static void releaseNameAtom(unsigned int atom);
+
+    /** Returns the atom of a name like internName(), without a reference, or 0 if no one holds that name. */
+    static unsigned int findNameAtom(const std::string& name);
+
     /// @} end of Tag
 
 
@@ -1015,6 +1151,130 @@ public:
     virtual void visit(Renderer *renderer, const Mat4& parentTransform, uint32_t parentFlags);
     virtual void visit() final;
 
+    /**
+     * Enable/Disable the visit of this node on a worker thread, see WorkerPool.
+     * It is only used for the children of a Scene: the marked children are visited in parallel,
+     * each one into its own command list, and their commands are added to the renderer in the usual order.
+     * The visit and draw of the whole subtree must be thread safe: no GL calls (e.g. a Label whose
+     * content is dirty), no creation or autorelease of objects and no change of the scene graph or the projection.
+     * Disabled by default.
+     *
+     * @param enabled Whether the subtree of the node can be visited on a worker thread.
+     */
+    void setParallelVisitEnabled(bool enabled) { _isParallelVisitEnabled = enabled; }
+
+    /** Whether or not the node can be visited on a worker thread.
+     *
+     * @return True if the subtree of the node can be visited on a worker thread.
+     */
+    bool isParallelVisitEnabled() const { return _isParallelVisitEnabled; }
+
+    /**
+     * Enable/Disable the culling of the node and its children.
+     * Each node caches the bounds of its content size and of the visible children of its subtree, in its own space.
+     * The bounds are updated by visit() as the transforms and content sizes change, and a subtree whose bounds
+     * are out of the window is skipped at once, without visiting the children.
+     * Disable it for nodes that draw outside their content size and their children, e.g. DrawNode and ParticleSystem,
+     * their ancestors are then never culled.
+     * Enabled by default.
+     *
+     * @param enabled Whether the subtree of the node can be culled.
+     */
+    void setCullingEnabled(bool enabled);
+
+    /** Whether or not the subtree of the node can be culled.
+     *
+     * @return True if the subtree of the node is skipped when it's out of the window.
+     */
+    bool isCullingEnabled() const { return _isCullingEnabled; }
+
+    /**
+     * Caches the node and its subtree in a texture, drawn as one quad instead of the whole subtree.
+     * The subtree is drawn again into the texture the frame after something in it changed: a transform, the
+     * visibility, the color or the opacity, the children, the content of a sprite or of a label. The nodes whose
+     * drawing changes otherwise, e.g. DrawNode and ParticleSystem, call invalidateCachedTexture(). A subtree that
+     * changes every frame is better not cached.
+     * The texture covers the content sizes of the visible nodes of the subtree, what's drawn outside them is clipped.
+     * The cache is drawn by Node::visit(), a node that overrides visit() or a subtree visited on a worker thread,
+     * see setParallelVisitEnabled(), is drawn as usual.
+     * Disabled by default.
+     *
+     * @param enabled Whether the subtree of the node is drawn from a texture.
+     */
+    void setCacheAsTexture(bool enabled);
+
+    /** Whether or not the subtree of the node is drawn from a texture.
+     *
+     * @return True if the subtree is cached in a texture.
+     */
+    bool isCacheAsTexture() const { return _coldData && _coldData->cacheAsTexture; }
+
+    /** Marks the cached textures of the node and of its ancestors out of date, they are drawn again the next frame.
+     * See setCacheAsTexture().
+     */
+    void invalidateCachedTexture() { if (s_cachedTextureCount > 0) markCachedTexturesDirty(); }
+
+    /**
+     * Records the commands of the node and its subtree once, with their vertices transformed and uploaded to a static
+     * VBO, and draws them every frame without visiting the subtree, see StaticBatch.
+     * Unlike setCacheAsTexture(), the subtree stays vector geometry: it's as sharp at any scale and costs no texture
+     * memory. It's recorded again the frame after something in it changed, see setCacheAsTexture() for what does.
+     * Only the sprites and the other nodes drawn with QuadCommands or TrianglesCommands of the default program and at the
+     * global z order of the node can be recorded, a subtree with anything else, e.g. a ClippingNode, a DrawNode or a custom
+     * shader, is drawn as usual. The cache is drawn by Node::visit(), a node that overrides visit() or a subtree visited on
+     * a worker thread is drawn as usual. It turns setCacheAsTexture() off.
+     * Disabled by default.
+     *
+     * @param enabled Whether the subtree of the node is drawn from recorded geometry.
+     * @since v3.11
+     */
+    void setCacheAsGeometry(bool enabled);
+
+    /** Whether or not the subtree of the node is drawn from recorded geometry.
+     *
+     * @return True if the subtree is recorded.
+     * @since v3.11
+     */
+    bool isCacheAsGeometry() const { return _coldData && _coldData->cacheAsGeometry; }
+
+    /** Draws the node and its subtree over the scene at the resolution of the screen, after the effects of the
+     * PostProcessStack and the scale of the dynamic resolution, see Director::setDynamicResolutionEnabled(). Meant for
+     * the UI, which is cheap to draw and blurry when scaled up.
+     * It only applies to a node of the running scene visited on the main thread, not inside a RenderTexture or a
+     * cached texture; the node is drawn with the scene otherwise, and when the stack isn't active.
+     * Disabled by default.
+     *
+     * @param enabled Whether the subtree is drawn at the resolution of the screen.
+     */
+    void setDrawnAtNativeResolution(bool enabled);
+
+    /** Whether or not the subtree is drawn at the resolution of the screen.
+     *
+     * @return True if the subtree is drawn over the scene at the resolution of the screen.
+     */
+    bool isDrawnAtNativeResolution() const { return _coldData && _coldData->nativeResolution; }
+
+    /** Draws the node between the positions, rotations and scales of its last two fixed steps, see
+     * Scheduler::setFixedTimeStep(). The node moves smoothly when the display runs faster than the steps, while
+     * the getters keep returning the values the logic set. Only the position, the 2D rotation and the scale are
+     * interpolated. Without a fixed time step the node is drawn as usual.
+     * Disabled by default.
+     *
+     * @param enabled Whether the node is drawn interpolated between its fixed steps.
+     */
+    void setInterpolationEnabled(bool enabled);
+
+    /** Whether or not the node is drawn interpolated between its fixed steps.
+     *
+     * @return True if the node is drawn interpolated.
+     */
+    bool isInterpolationEnabled() const { return _coldData && _coldData->interpolation; }
+
+    /** Draws the node where it is now from the next frame on, instead of moving it there from its previous step.
+     * Call it after the node was teleported.
+     */
+    void resetInterpolation() { if (_coldData) _coldData->interpolationValid = false; }
+
 
     /** Returns the Scene that contains the Node.
      It returns `nullptr` if the node doesn't belong to any Scene.
@@ -1245,6 +1505,18 @@ public:
      */
     void scheduleOnce(const std::function<void(float)>& callback, float delay, const std::string &key);
 
+    /**
+     * Schedules a lambda function that runs only once, identified by the returned handle instead of a key.
+     * No key is allocated or compared, use it for the short-lived delayed callbacks.
+     *
+     * @param callback      The lambda function to be scheduled.
+     * @param delay         The amount of time that the first tick will wait before execution.
+     * @return The handle to unschedule it with, see Scheduler::scheduleOnce().
+     * @lua NA
+     * @since v3.11
+     */
+    ccSchedulerHandle scheduleOnce(const std::function<void(float)>& callback, float delay);
+
     /**
      * Schedules a custom selector, the scheduled selector will be ticked every frame.
      * @see schedule(SEL_SCHEDULE, float, unsigned int, float)
@@ -1285,6 +1557,20 @@ public:
      */
     void schedule(const std::function<void(float)>& callback, float interval, unsigned int repeat, float delay, const std::string &key);
 
+    /**
+     * Schedules a lambda function identified by the returned handle instead of a key.
+     * Scheduling the same lambda again schedules it twice.
+     *
+     * @param callback  The lambda function to be schedule.
+     * @param interval  Tick interval in seconds. 0 means tick every frame.
+     * @param repeat    The selector will be executed (repeat + 1) times, you can use CC_REPEAT_FOREVER for tick infinitely.
+     * @param delay     The amount of time that the first tick will wait before execution.
+     * @return The handle to unschedule it with, see Scheduler::schedule().
+     * @lua NA
+     * @since v3.11
+     */
+    ccSchedulerHandle schedule(const std::function<void(float)>& callback, float interval, unsigned int repeat, float delay);
+
     /**
      * Unschedules a custom selector.
      * @see `schedule(SEL_SCHEDULE, float, unsigned int, float)`
@@ -1302,6 +1588,15 @@ public:
      */
     void unschedule(const std::string &key);
 
+    /**
+     * Unschedules a lambda function by the handle it was scheduled with, in constant time.
+     *
+     * @param handle   The handle returned by schedule() or scheduleOnce().
+     * @lua NA
+     * @since v3.11
+     */
+    void unschedule(ccSchedulerHandle handle);
+
     /**
      * Unschedule all scheduled selectors and lambda functions: custom selectors, and the 'update' selector and lambda functions.
      * Actions are not affected by this method.
@@ -1511,6 +1806,9 @@ protected:
     /// helper that reorder a child
     void insertChild(Node* child, int z);
 
+    /// Sorts the children by the child order, returns true if their order changed.
+    bool sortChildren();
+
     /// Removes a child, call child->onExit(), do cleanup, remove it from children array.
     void detachChild(Node *child, ssize_t index, bool doCleanup);
 
@@ -1519,6 +1817,38 @@ protected:
 
     Mat4 transform(const Mat4 &parentTransform);
     uint32_t processParentFlags(const Mat4& parentTransform, uint32_t parentFlags);
+    /// The flags part of processParentFlags(): updates the normalized position and consumes the dirty flags of the node.
+    uint32_t updateTransformFlags(uint32_t parentFlags);
+
+    /// Marks the subtree bounds of the node and of its ancestors out of date, see setCullingEnabled().
+    void invalidateSubtreeBounds();
+    /// Whether or not the subtree is out of the window and must be skipped, processParentFlags() must be called before.
+    bool isSubtreeCulled(uint32_t flags);
+    /// Updates the subtree bounds once the children were visited.
+    void updateSubtreeBounds();
+    /// Draws the node and visits its children in the space given by `transform`, the part of visit() after the culling.
+    void drawSubtree(Renderer* renderer, const Mat4& transform, uint32_t flags);
+
+    /// Draws the cached texture, after drawing the subtree into it if it's out of date. Returns false when the subtree
+    /// can't be cached and must be visited as usual.
+    bool visitCachedTexture(Renderer* renderer);
+    /// Draws the subtree into the cached texture, returns false when it's empty or too large for a texture.
+    bool renderCachedTexture(Renderer* renderer);
+    void markCachedTexturesDirty();
+
+    /// Draws the recorded geometry, after recording the subtree if it's out of date. Returns false when the subtree
+    /// can't be recorded and must be visited as usual.
+    bool visitCachedGeometry(Renderer* renderer, uint32_t flags);
+    /// Records the subtree into the static batch, returns false when one of its commands can't be batched.
+    bool recordCachedGeometry(Renderer* renderer);
+    /// Pushes the overlay queue of the PostProcessStack when the node is drawn at native resolution and the scene is
+    /// drawn by the stack. Returns whether it was pushed.
+    bool pushNativeResolutionGroup(Renderer* renderer);
+    /// Sets the values between the last two fixed steps in place of the ones of the logic, see setInterpolationEnabled().
+    /// Returns false when the node is drawn with its own values.
+    bool beginInterpolation();
+    /// Puts back the values of the logic after the transform was computed with the interpolated ones.
+    void endInterpolation();
 
     virtual void updateCascadeOpacity();
     virtual void disableCascadeOpacity();
@@ -1526,12 +1856,20 @@ protected:
     virtual void disableCascadeColor();
     virtual void updateColor() {}
 
-    bool doEnumerate(std::string name, std::function<bool (Node *)> callback) const;
-    bool doEnumerateRecursive(const Node* node, const std::string &name, std::function<bool (Node *)> callback) const;
+    /// Marks the index of the children by name out of date, see getChildByNameAtom().
+    void invalidateChildNameIndex() { if (_coldData) _coldData->childNameIndexValid = false; }
 
     //check whether this camera mask is visible by the current visiting camera
     bool isVisitableByVisitingCamera() const;
 
+    /// Creates a node of the same class with the state of this one but without the children, see clone().
+    /// The subclasses override it, create their node, then call copyNodeState() on it.
+    virtual Node* cloneInstance() const;
+    /// Copies the state of the Node part to a node created by cloneInstance().
+    void copyNodeState(Node* target) const;
+    /// Whether a child belongs to the implementation of the node, like the letters of a Label, and isn't cloned.
+    virtual bool isInternalChild(const Node* child) const { return false; }
+
     // update quaternion from Rotation3D
     void updateRotationQuat();
     // update Rotation3D from quaternion
@@ -1541,6 +1879,102 @@ private:
     void addChildHelper(Node* child, int localZOrder, int tag, const std::string &name, bool setTag);
 
 protected:
+    /// The state few nodes use, allocated by the first setter that needs it so the other nodes don't carry it.
+    struct ColdData
+    {
+        ColdData();
+
+        mutable Mat4 inverse;           ///< inverse transform
+        Mat4 additionalTransform;       ///< transform
+        std::function<float(Node*)> childOrderKey; ///< the key of the children with ChildOrder::CUSTOM
+        std::unordered_map<unsigned int, Node*> childNameIndex; ///< the first child with each name atom
+        bool childNameIndexValid;       ///< false when the children or their names changed since the index was built
+        bool cacheAsTexture;            ///< the subtree is drawn from cachedTexture, see setCacheAsTexture()
+        bool cachedTextureDirty;        ///< the subtree changed since it was drawn into cachedTexture or recorded
+        RenderTexture* cachedTexture;   ///< the texture the subtree is drawn into, nullptr until it's drawn
+        Rect cachedTextureRect;         ///< the area of the node space the texture covers
+        bool cacheAsGeometry;           ///< the subtree is drawn from staticBatch, see setCacheAsGeometry()
+        StaticBatch* staticBatch;       ///< the recorded subtree, nullptr until it's recorded
+        bool nativeResolution;          ///< the subtree is drawn after the post process, see setDrawnAtNativeResolution()
+
+        /// The values of the transform that are interpolated
+        struct TransformValues
+        {
+            Vec2 position;
+            float rotationX;
+            float rotationY;
+            float scaleX;
+            float scaleY;
+        };
+        bool interpolation;             ///< drawn between the last two fixed steps, see setInterpolationEnabled()
+        bool interpolationValid;        ///< false until the values of a step were taken
+        TransformValues interpolationFrom; ///< the values of the step before interpolationTo
+        TransformValues interpolationTo; ///< the values of the last step, the logic values while they are interpolated
+        TransformValues interpolationLogic; ///< the values of the logic while the interpolated ones are set
+        uint64_t interpolationStep;     ///< the fixed step count when interpolationTo was taken
+        unsigned int interpolationSteps; ///< the steps between interpolationFrom and interpolationTo
+    };
+
+    /// Gets the cold data of the node, allocates it the first time.
+    ColdData* getColdData() const;
+
+    // the state read by every visit comes first, so it shares the cache lines of the vtable pointer and the reference count
+
+    Mat4 _modelViewTransform;    ///< ModelView transform of the Node.
+
+    // "cache" variables are allowed to be mutable
+    mutable Mat4 _transform;      ///< transform
+
+    Vector<Node*> _children;        ///< array of children nodes
+    Node *_parent;                  ///< weak reference to parent node
+    Director* _director;            //cached director pointer to improve rendering performance
+    GLProgramState *_glProgramState; ///< OpenGL Program State
+
+    int _localZOrder;               ///< Local order (relative to its siblings) used to sort the node
+    float _globalZOrder;            ///< Global order used to sort the node
+    int _orderOfArrival;            ///< used to preserve sequence while sorting children with the same localZOrder
+    int _transformIndex;            ///< index of the node in the TransformSystem of its Scene, -1 if it has none
+    ChildOrder _childOrder;         ///< how the children are ordered among the same local Z order
+
+    // camera mask, it is visible only when _cameraMask & current camera' camera flag is true
+    unsigned short _cameraMask;
+
+    // opacity controls
+    GLubyte     _displayedOpacity;
+    GLubyte     _realOpacity;
+    Color3B     _displayedColor;
+    Color3B     _realColor;
+
+    // the flags, packed together
+    bool _visible;                  ///< is this node visible
+    bool _running;                  ///< is running
+    mutable bool _transformDirty;   ///< transform dirty flag
+    mutable bool _inverseDirty;     ///< inverse transform dirty flag
+    bool _transformUpdated;         ///< Whether or not the Transform object was updated since the last frame
+    bool _transformFromSystem;      ///< whether the last processParentFlags() took the transform of the TransformSystem
+    bool _useAdditionalTransform;   ///< The flag to check whether the additional transform is dirty
+    bool _contentSizeDirty;         ///< whether or not the contentSize is dirty
+    bool _usingNormalizedPosition;
+    bool _normalizedPositionDirty;
+    bool _reorderChildDirty;        ///< children order dirty flag
+    bool _isAddingChildren;         ///< in addChildren(), the cascaded color and opacity are updated at the end
+    bool _isRemovingChildren;       ///< in removeChildren(), the removed children are erased at the end
+    bool _isParallelVisitEnabled;   ///< can be visited on a worker thread by its Scene
+    bool _isCullingEnabled;         ///< can be skipped when the subtree is out of the window
+    bool _subtreeBoundsDirty;       ///< the subtree bounds must be updated by the next visit
+    bool _subtreeBoundsValid;       ///< false if something in the subtree can't be culled
+    bool _touchIndexDirty;          ///< the node moved since the touch spatial index placed its listeners
+    bool _isSpatialContainer;       ///< the node is a SpatialNode, its children tell it when they move
+    bool _spatialCellDirty;         ///< the node moved since its SpatialNode parent placed it in a cell
+    int _actionTargetCount;         ///< the ActionManagers with actions for it, pause() and resume() skip them without
+    int _eventListenerCount;        ///< the scene graph listeners of the EventDispatcher associated with it
+    bool _ignoreAnchorPointForPosition; ///< true if the Anchor Vec2 will be (0,0) when you position the Node, false otherwise.
+                                        ///< Used by Layer and Scene.
+    bool _isTransitionFinished;     ///< flag to indicate whether the transition was finished
+    bool _cascadeColorEnabled;
+    bool _cascadeOpacityEnabled;
+
+    // the inputs of the transform, read when it is dirty
 
     float _rotationX;               ///< rotation on the X-axis
     float _rotationY;               ///< rotation on the Y-axis
@@ -1549,17 +1983,12 @@ protected:
     float _rotationZ_X;             ///< rotation angle on Z-axis, component X
     float _rotationZ_Y;             ///< rotation angle on Z-axis, component Y
 
-    Quaternion _rotationQuat;      ///rotation using quaternion, if _rotationZ_X == _rotationZ_Y, _rotationQuat = RotationZ_X * RotationY * RotationX, else _rotationQuat = RotationY * RotationX
-
     float _scaleX;                  ///< scaling factor on x-axis
     float _scaleY;                  ///< scaling factor on y-axis
     float _scaleZ;                  ///< scaling factor on z-axis
 
     Vec2 _position;                ///< position of the node
     float _positionZ;               ///< OpenGL real Z position
-    Vec2 _normalizedPosition;
-    bool _usingNormalizedPosition;
-    bool _normalizedPositionDirty;
 
     float _skewX;                   ///< skew angle on x-axis
     float _skewY;                   ///< skew angle on y-axis
@@ -1568,33 +1997,18 @@ protected:
     Vec2 _anchorPoint;             ///< anchor point normalized (NOT in points)
 
     Size _contentSize;              ///< untransformed size of the node
-    bool _contentSizeDirty;         ///< whether or not the contentSize is dirty
-
-    Mat4 _modelViewTransform;    ///< ModelView transform of the Node.
-
-    // "cache" variables are allowed to be mutable
-    mutable Mat4 _transform;      ///< transform
-    mutable bool _transformDirty;   ///< transform dirty flag
-    mutable Mat4 _inverse;        ///< inverse transform
-    mutable bool _inverseDirty;     ///< inverse transform dirty flag
-    mutable Mat4 _additionalTransform; ///< transform
-    bool _useAdditionalTransform;   ///< The flag to check whether the additional transform is dirty
-    bool _transformUpdated;         ///< Whether or not the Transform object was updated since the last frame
 
-    int _localZOrder;               ///< Local order (relative to its siblings) used to sort the node
-    float _globalZOrder;            ///< Global order used to sort the node
+    Vec2 _normalizedPosition;
 
-    Vector<Node*> _children;        ///< array of children nodes
-    Node *_parent;                  ///< weak reference to parent node
-    Director* _director;            //cached director pointer to improve rendering performance
-    int _tag;                         ///< a tag. Can be any number you assigned just to identify this node
+    Quaternion _rotationQuat;      ///rotation using quaternion, if _rotationZ_X == _rotationZ_Y, _rotationQuat = RotationZ_X * RotationY * RotationX, else _rotationQuat = RotationY * RotationX
 
-    std::string _name;               ///<a string label, an user defined string to identify this node
-    size_t _hashOfName;            ///<hash value of _name, used for speed in getChildByName
+    Rect _subtreeBounds;            ///< the bounds of the subtree in the node space
 
-    GLProgramState *_glProgramState; ///< OpenGL Program State
+    // the rest is read outside of the visit
 
-    int _orderOfArrival;            ///< used to preserve sequence while sorting children with the same localZOrder
+    int _tag;                         ///< a tag. Can be any number you assigned just to identify this node
+    int _touchIndexListenerCount;   ///< the touch listeners of the node in the touch spatial index of the EventDispatcher
+    unsigned int _nameAtom;         ///< the atom of the name, used for speed in getChildByName
 
     Scheduler *_scheduler;          ///< scheduler used to schedule timers and updates
 
@@ -1602,28 +2016,16 @@ protected:
 
     EventDispatcher* _eventDispatcher;  ///< event dispatcher used to dispatch all kinds of events
 
-    bool _running;                  ///< is running
-
-    bool _visible;                  ///< is this node visible
-
-    bool _ignoreAnchorPointForPosition; ///< true if the Anchor Vec2 will be (0,0) when you position the Node, false otherwise.
-                                          ///< Used by Layer and Scene.
-
-    bool _reorderChildDirty;          ///< children order dirty flag
-    bool _isTransitionFinished;       ///< flag to indicate whether the transition was finished
-
-    // opacity controls
-    GLubyte        _displayedOpacity;
-    GLubyte     _realOpacity;
-    Color3B        _displayedColor;
-    Color3B     _realColor;
-    bool        _cascadeColorEnabled;
-    bool        _cascadeOpacityEnabled;
+    mutable ColdData* _coldData;    ///< the rarely used state, nullptr until it is needed
 
     static int s_globalOrderOfArrival;
+    static unsigned int s_hierarchyVersion;   ///< changes when a child is added or removed anywhere, see TransformSystem
+    static int s_cachedTextureCount;          ///< the nodes cached as textures or geometry, nothing is marked when there's none
 
-    // camera mask, it is visible only when _cameraMask & current camera' camera flag is true
-    unsigned short _cameraMask;
+    friend class TransformSystem;
+    friend class EventDispatcher;
+    friend class ActionManager;
+    friend class SpatialNode;
 
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(Node);
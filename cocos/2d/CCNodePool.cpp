@@ -0,0 +1,157 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "2d/CCNodePool.h"
+#include "base/CCEventDispatcher.h"
+
+NS_CC_BEGIN
+
+NodePoolBase::NodePoolBase(const std::function<Node*()>& factory, const std::function<void(Node*)>& reset, int maxIdle)
+: _factory(factory)
+, _reset(reset)
+, _maxIdle(maxIdle)
+{
+    _stats.inUse = 0;
+    _stats.idle = 0;
+    _stats.highWater = 0;
+    _stats.created = 0;
+    _stats.reused = 0;
+}
+
+NodePoolBase::~NodePoolBase()
+{
+}
+
+NodePoolBase::Stats NodePoolBase::getStats() const
+{
+    Stats stats = _stats;
+    stats.idle = (int)_idle.size();
+    return stats;
+}
+
+void NodePoolBase::setMaxIdle(int maxIdle)
+{
+    _maxIdle = maxIdle;
+    while ((int)_idle.size() > _maxIdle)
+    {
+        _idle.popBack();
+    }
+}
+
+void NodePoolBase::prewarm(int count)
+{
+    count = std::min(count, _maxIdle);
+    while ((int)_idle.size() < count)
+    {
+        auto node = _factory();
+        if (!node)
+        {
+            break;
+        }
+        _stats.created++;
+        _idle.pushBack(node);
+    }
+}
+
+void NodePoolBase::clear()
+{
+    _idle.clear();
+}
+
+void NodePoolBase::resetNode(Node* node)
+{
+    node->stopAllActions();
+    node->unscheduleAllCallbacks();
+    node->removeAllChildrenWithCleanup(true);
+    node->getEventDispatcher()->removeEventListenersForTarget(node);
+
+    node->setPosition(Vec2::ZERO);
+    node->setPositionZ(0.0f);
+    node->setRotation(0.0f);
+    node->setScale(1.0f);
+    node->setSkewX(0.0f);
+    node->setSkewY(0.0f);
+    node->setVisible(true);
+    node->setOpacity(255);
+    node->setColor(Color3B::WHITE);
+    node->setTag(Node::INVALID_TAG);
+    if (!node->getName().empty())
+    {
+        node->setName("");
+    }
+    node->setLocalZOrder(0);
+}
+
+Node* NodePoolBase::acquireNode()
+{
+    Node* node = nullptr;
+    if (!_idle.empty())
+    {
+        node = _idle.back();
+        // the reference of the pool goes to the autorelease pool, like a created node
+        node->retain();
+        node->autorelease();
+        _idle.popBack();
+        _stats.reused++;
+    }
+    else
+    {
+        node = _factory();
+        if (!node)
+        {
+            return nullptr;
+        }
+        _stats.created++;
+    }
+
+    _stats.inUse++;
+    _stats.highWater = std::max(_stats.highWater, _stats.inUse);
+    return node;
+}
+
+void NodePoolBase::recycleNode(Node* node)
+{
+    CCASSERT(node, "node must not be nullptr");
+    if (_stats.inUse > 0)
+    {
+        _stats.inUse--;
+    }
+
+    // keeps the node alive through its removal
+    node->retain();
+    node->removeFromParentAndCleanup(true);
+    if ((int)_idle.size() < _maxIdle)
+    {
+        resetNode(node);
+        if (_reset)
+        {
+            _reset(node);
+        }
+        _idle.pushBack(node);
+    }
+    node->release();
+}
+
+NS_CC_END
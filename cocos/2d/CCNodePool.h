@@ -0,0 +1,155 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CC_NODE_POOL_H__
+#define __CC_NODE_POOL_H__
+
+#include <functional>
+
+#include "base/CCVector.h"
+#include "2d/CCNode.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/** @class NodePoolBase
+ * @brief The untyped part of NodePool.
+ * @js NA
+ * @lua NA
+ */
+class CC_DLL NodePoolBase
+{
+public:
+    /** The default max number of idle nodes a pool keeps. */
+    static const int DEFAULT_MAX_IDLE = 256;
+
+    /** The counters of a pool. */
+    struct Stats
+    {
+        /** The number of nodes acquired and not recycled yet. */
+        int inUse;
+        /** The number of idle nodes the pool keeps. */
+        int idle;
+        /** The max number of nodes in use at once, the idle nodes that cover the peaks. */
+        int highWater;
+        /** The number of nodes made by the factory. */
+        unsigned int created;
+        /** The number of acquires that reused an idle node. */
+        unsigned int reused;
+    };
+
+    /** Gets the counters of the pool. */
+    Stats getStats() const;
+
+    /** Sets the max number of idle nodes, past it the recycled nodes are released. */
+    void setMaxIdle(int maxIdle);
+
+    /** Gets the max number of idle nodes. */
+    int getMaxIdle() const { return _maxIdle; }
+
+    /** Makes idle nodes until the pool has `count` of them, so the first acquires don't create any. */
+    void prewarm(int count);
+
+    /** Releases the idle nodes. */
+    void clear();
+
+    /**
+     * Resets what a node gathers while it is used: it stops its actions and scheduled callbacks, removes its
+     * children and its event listeners, and resets its position, rotation, scale, skew, visibility, opacity, color,
+     * tag, name and local z order. The other properties are left as they were.
+     */
+    static void resetNode(Node* node);
+
+protected:
+    NodePoolBase(const std::function<Node*()>& factory, const std::function<void(Node*)>& reset, int maxIdle);
+    ~NodePoolBase();
+
+    Node* acquireNode();
+    void recycleNode(Node* node);
+
+    std::function<Node*()> _factory;
+    std::function<void(Node*)> _reset;
+    Vector<Node*> _idle;
+    int _maxIdle;
+    Stats _stats;
+
+private:
+    NodePoolBase(const NodePoolBase&) = delete;
+    NodePoolBase& operator=(const NodePoolBase&) = delete;
+};
+
+/** @class NodePool
+ * @brief Keeps the nodes of one kind that were removed, to use them again instead of creating new ones.
+
+The nodes that are spawned and removed many times per second, like bullets or damage numbers, come from acquire()
+and go back with recycle() instead of create() and removeFromParentAndCleanup(). recycle() removes the node from
+its parent and resets it with resetNode() and the reset function of the pool, acquire() then returns it without
+running a constructor, a destructor or a texture lookup.
+The nodes given to recycle() must come from acquire() of the same pool, the pool must be used on the main thread.
+
+@code
+NodePool<Sprite> stars([](){ return Sprite::create("star.png"); });
+auto star = stars.acquire();
+layer->addChild(star);
+...
+stars.recycle(star);
+@endcode
+@since v3.11
+@js NA
+@lua NA
+*/
+template <class T>
+class NodePool : public NodePoolBase
+{
+public:
+    /**
+     * @param factory Makes an autoreleased node when the pool has no idle node, like T::create().
+     * @param reset Resets what resetNode() doesn't for the nodes of the pool, called after it, may be nullptr.
+     * @param maxIdle The max number of idle nodes.
+     */
+    explicit NodePool(const std::function<T*()>& factory, const std::function<void(T*)>& reset = nullptr, int maxIdle = DEFAULT_MAX_IDLE)
+    : NodePoolBase([factory]() -> Node* { return factory(); },
+                   reset ? std::function<void(Node*)>([reset](Node* node) { reset(static_cast<T*>(node)); }) : std::function<void(Node*)>(),
+                   maxIdle)
+    {
+    }
+
+    /** Returns an autoreleased node, an idle one or a new one from the factory, nullptr if the factory fails. */
+    T* acquire() { return static_cast<T*>(acquireNode()); }
+
+    /** Removes `node` from its parent and resets it, it is idle until an acquire() returns it. */
+    void recycle(T* node) { recycleNode(node); }
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif // __CC_NODE_POOL_H__
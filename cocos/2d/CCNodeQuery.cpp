@@ -0,0 +1,172 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "2d/CCNodeQuery.h"
+
+#include <regex>
+
+#include "2d/CCNode.h"
+
+NS_CC_BEGIN
+
+struct NodeQuery::Pattern
+{
+    explicit Pattern(const std::string& pattern)
+    : regex(pattern)
+    {
+    }
+
+    std::regex regex;
+};
+
+// the names with none of these are matched exactly by std::regex_match, their atom is enough
+static bool isPlainName(const std::string& name)
+{
+    return name.find_first_of("\\^$.|?*+()[]{}") == std::string::npos;
+}
+
+NodeQuery::NodeQuery(const std::string& query)
+: _query(query)
+, _recursive(false)
+{
+    CCASSERT(!query.empty(), "Invalid name");
+
+    size_t length = query.length();
+    size_t start = 0;
+    size_t end = length;
+
+    // Starts with '//'?
+    if (length > 2 && query[0] == '/' && query[1] == '/')
+    {
+        _recursive = true;
+        start = 2;
+    }
+
+    // Ends with '/..'? It matches the parents of the nodes, so any child, then the node
+    if (length > 3 && query.compare(length - 3, 3, "/..") == 0)
+    {
+        end -= 3;
+        Segment any;
+        any.atom = 0;
+        any.pattern = std::make_shared<Pattern>("[[:alnum:]]+");
+        _segments.push_back(any);
+    }
+
+    // name may be xxx/yyy, a segment per level
+    while (true)
+    {
+        size_t pos = query.find('/', start);
+        if (pos == std::string::npos || pos > end)
+        {
+            pos = end;
+        }
+
+        std::string name = query.substr(start, pos - start);
+        Segment segment;
+        if (isPlainName(name))
+        {
+            segment.atom = Node::internName(name);
+        }
+        else
+        {
+            segment.atom = 0;
+            segment.pattern = std::make_shared<Pattern>(name);
+        }
+        _segments.push_back(segment);
+
+        if (pos >= end)
+        {
+            break;
+        }
+        start = pos + 1;
+    }
+}
+
+NodeQuery::~NodeQuery()
+{
+    for (const auto& segment : _segments)
+    {
+        Node::releaseNameAtom(segment.atom);
+    }
+}
+
+bool NodeQuery::matches(const Segment& segment, const Node* node) const
+{
+    if (segment.pattern)
+    {
+        return std::regex_match(node->getName(), segment.pattern->regex);
+    }
+    return node->getNameAtom() == segment.atom;
+}
+
+bool NodeQuery::enumerateChildren(const Node* node, size_t segment, const std::function<bool(Node*)>& callback) const
+{
+    const auto& current = _segments[segment];
+    const bool last = segment + 1 == _segments.size();
+
+    for (const auto& child : node->getChildren())
+    {
+        if (matches(current, child))
+        {
+            // terminate enumeration if callback return true
+            if (last ? callback(child) : enumerateChildren(child, segment + 1, callback))
+                return true;
+        }
+    }
+    return false;
+}
+
+bool NodeQuery::enumerateRecursive(const Node* node, const std::function<bool(Node*)>& callback) const
+{
+    // search itself
+    if (enumerateChildren(node, 0, callback))
+        return true;
+
+    // search its children
+    for (const auto& child : node->getChildren())
+    {
+        if (enumerateRecursive(child, callback))
+            return true;
+    }
+    return false;
+}
+
+bool NodeQuery::enumerate(const Node* node, const std::function<bool(Node*)>& callback) const
+{
+    CCASSERT(callback != nullptr, "Invalid callback function");
+    return _recursive ? enumerateRecursive(node, callback) : enumerateChildren(node, 0, callback);
+}
+
+Node* NodeQuery::findFirst(const Node* node) const
+{
+    Node* found = nullptr;
+    enumerate(node, [&found](Node* match) {
+        found = match;
+        return true;
+    });
+    return found;
+}
+
+NS_CC_END
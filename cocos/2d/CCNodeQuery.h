@@ -0,0 +1,111 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CC_NODE_QUERY_H__
+#define __CC_NODE_QUERY_H__
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+
+class Node;
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/** @class NodeQuery
+ * @brief A search string of Node::enumerateChildren(), parsed once to be run many times.
+
+The plain names of the search string are matched by their name atom, see Node::internName(), without any string
+compare. Only the parts that use the regular expression syntax are compiled, once, to a std::regex.
+Node::enumerateChildren() keeps the last queries it parsed, a NodeQuery kept by the caller skips that lookup too.
+
+@code
+static const NodeQuery buttons("//buttons/[[:alnum:]]+");
+buttons.enumerate(panel, [](Node* button) { ... return false; });
+@endcode
+@since v3.11
+@js NA
+@lua NA
+*/
+class CC_DLL NodeQuery
+{
+public:
+    /**
+     * Parses a search string, see Node::enumerateChildren() for the syntax.
+     *
+     * @param query The search string, must not be empty.
+     */
+    explicit NodeQuery(const std::string& query);
+    ~NodeQuery();
+
+    /**
+     * Calls the callback on the nodes below `node` that match the query, like Node::enumerateChildren().
+     *
+     * @param callback Returns true to stop the enumeration.
+     * @return True if the callback stopped the enumeration.
+     */
+    bool enumerate(const Node* node, const std::function<bool(Node*)>& callback) const;
+
+    /** Returns the first node below `node` that matches the query, nullptr if there is none. */
+    Node* findFirst(const Node* node) const;
+
+    /** Gets the search string the query was parsed from. */
+    const std::string& getQuery() const { return _query; }
+
+private:
+    struct Pattern;
+
+    /** The name of one level of the path, matched by its atom unless it has a pattern. The query holds the atom. */
+    struct Segment
+    {
+        unsigned int atom;
+        std::shared_ptr<Pattern> pattern;
+    };
+
+    bool matches(const Segment& segment, const Node* node) const;
+    bool enumerateChildren(const Node* node, size_t segment, const std::function<bool(Node*)>& callback) const;
+    bool enumerateRecursive(const Node* node, const std::function<bool(Node*)>& callback) const;
+
+    std::string _query;
+    std::vector<Segment> _segments;
+    bool _recursive;
+
+    CC_DISALLOW_COPY_AND_ASSIGN(NodeQuery);
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif // __CC_NODE_QUERY_H__
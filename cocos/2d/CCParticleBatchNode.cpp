@@ -36,6 +36,7 @@
 #include "renderer/CCRenderer.h"
 #include "renderer/CCTextureAtlas.h"
 #include "base/CCString.h"
+#include "base/CCTracer.h"
 
 NS_CC_BEGIN
 
@@ -133,6 +134,7 @@ void ParticleBatchNode::visit(Renderer *renderer, const Mat4 &parentTransform, u
     _director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
     _director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, _modelViewTransform);
 
+    Renderer::setDebugOwner(this);
     draw(renderer, _modelViewTransform, flags);
 
     _director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
@@ -210,6 +212,7 @@ int ParticleBatchNode::addChildHelper(ParticleSystem* child, int z, int aTag, co
     auto pos = searchNewPositionInChildrenForZ(z);
 
     _children.insert(pos, child);
+    invalidateChildNameIndex();
 
     if (setTag)
         child->setTag(aTag);
@@ -256,6 +259,7 @@ void ParticleBatchNode::reorderChild(Node * aChild, int zOrder)
             child->retain();
             _children.erase(oldIndex);
             _children.insert(newIndex, child);
+            invalidateChildNameIndex();
             child->release();
 
             // save old altasIndex
@@ -394,7 +398,7 @@ void ParticleBatchNode::removeAllChildrenWithCleanup(bool doCleanup)
 
 void ParticleBatchNode::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
 {
-    CC_PROFILER_START("CCParticleBatchNode - draw");
+    CC_TRACE_ZONE("particles", "ParticleBatchNode::draw");
 
     if( _textureAtlas->getTotalQuads() == 0 )
     {
@@ -402,7 +406,6 @@ void ParticleBatchNode::draw(Renderer *renderer, const Mat4 &transform, uint32_t
     }
     _batchCommand.init(_globalZOrder, getGLProgram(), _blendFunc, _textureAtlas, _modelViewTransform, flags);
     renderer->addCommand(&_batchCommand);
-    CC_PROFILER_STOP("CCParticleBatchNode - draw");
 }
 
 
@@ -460,6 +463,9 @@ void ParticleBatchNode::updateAllAtlasIndexes()
     int index = 0;
 
     for(const auto &child : _children) {
+        // removed by Node::removeChildren(), erased at its end
+        if (child->getParent() != this)
+            continue;
         ParticleSystem* partiSys = static_cast<ParticleSystem*>(child);
         partiSys->setAtlasIndex(index);
         index += partiSys->getTotalParticles();
@@ -0,0 +1,183 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "2d/CCParticleCache.h"
+#include "platform/CCFileUtils.h"
+
+NS_CC_BEGIN
+
+ParticleCache* ParticleCache::s_sharedParticleCache = nullptr;
+
+ParticleCache* ParticleCache::getInstance()
+{
+    if (! s_sharedParticleCache)
+    {
+        s_sharedParticleCache = new (std::nothrow) ParticleCache();
+    }
+
+    return s_sharedParticleCache;
+}
+
+void ParticleCache::destroyInstance()
+{
+    CC_SAFE_RELEASE_NULL(s_sharedParticleCache);
+}
+
+ParticleCache::ParticleCache()
+: _maxSystemsPerFile(DEFAULT_MAX_SYSTEMS_PER_FILE)
+{
+}
+
+ParticleCache::~ParticleCache()
+{
+    CCLOGINFO("deallocing ParticleCache: %p", this);
+    removeAllSystems();
+}
+
+ParticleSystemQuad* ParticleCache::getTemplate(const std::string& plistFile)
+{
+    auto it = _entries.find(plistFile);
+    if (it != _entries.end())
+    {
+        return it->second.prototype;
+    }
+
+    auto prototype = ParticleSystemQuad::create(plistFile);
+    if (!prototype)
+    {
+        return nullptr;
+    }
+
+    prototype->retain();
+    _entries[plistFile].prototype = prototype;
+    return prototype;
+}
+
+ValueMap* ParticleCache::getDefinition(const std::string& fullPath)
+{
+    auto it = _definitions.find(fullPath);
+    if (it != _definitions.end())
+    {
+        return &it->second;
+    }
+
+    ValueMap dict = FileUtils::getInstance()->getValueMapFromFile(fullPath);
+    if (dict.empty())
+    {
+        return nullptr;
+    }
+    return &(_definitions[fullPath] = std::move(dict));
+}
+
+ParticleSystemQuad* ParticleCache::acquire(const std::string& plistFile, float prewarmSeconds)
+{
+    auto prototype = getTemplate(plistFile);
+    if (!prototype)
+    {
+        return nullptr;
+    }
+
+    auto& systems = _entries[plistFile].systems;
+    ParticleSystemQuad* system = nullptr;
+    for (auto pooled : systems)
+    {
+        if (pooled->getReferenceCount() == 1)
+        {
+            system = pooled;
+            break;
+        }
+    }
+
+    if (system)
+    {
+        system->copyConfiguration(prototype);
+        system->setScale(1.0f);
+        system->setRotation(0.0f);
+        system->setVisible(true);
+
+        // like a new system, so a second acquire() of the frame doesn't pick it again
+        system->retain();
+        system->autorelease();
+    }
+    else
+    {
+        system = ParticleSystemQuad::createWithTemplate(prototype);
+        if (!system)
+        {
+            return nullptr;
+        }
+        if ((int)systems.size() < _maxSystemsPerFile)
+        {
+            systems.pushBack(system);
+        }
+    }
+
+    if (prewarmSeconds > 0)
+    {
+        system->prewarm(prewarmSeconds);
+    }
+    return system;
+}
+
+void ParticleCache::recycle(ParticleSystemQuad* system)
+{
+    system->removeFromParentAndCleanup(true);
+}
+
+void ParticleCache::removeUnusedSystems()
+{
+    for (auto it = _entries.begin(); it != _entries.end(); )
+    {
+        auto& systems = it->second.systems;
+        for (ssize_t i = systems.size() - 1; i >= 0; --i)
+        {
+            if (systems.at(i)->getReferenceCount() == 1)
+            {
+                systems.erase(i);
+            }
+        }
+
+        if (systems.empty())
+        {
+            it->second.prototype->release();
+            it = _entries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void ParticleCache::removeAllSystems()
+{
+    for (auto& entry : _entries)
+    {
+        entry.second.prototype->release();
+    }
+    _entries.clear();
+}
+
+NS_CC_END
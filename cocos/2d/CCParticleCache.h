@@ -0,0 +1,134 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CC_PARTICLE_CACHE_H__
+#define __CC_PARTICLE_CACHE_H__
+
+#include <string>
+#include <unordered_map>
+
+#include "base/CCRef.h"
+#include "base/CCValue.h"
+#include "base/CCVector.h"
+#include "2d/CCParticleSystemQuad.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/** @class ParticleCache
+ * @brief Singleton that parses each particle plist once and pools the systems made from it.
+
+The first use of a plist creates its template, a ParticleSystemQuad that is never run.
+acquire() copies the template into an idle system of the pool, or into a new one, so the effects spawned
+many times per second don't parse the plist, look the texture up or allocate their particles again.
+A system is idle again when the cache holds the only reference to it: once its parent removed it,
+e.g. because of setAutoRemoveOnFinish(), or after recycle().
+The parsed plists are kept as well, so the systems created with ParticleSystem::create() don't read their file again,
+and the textures embedded in them are decoded once and kept by the TextureCache.
+@since v3.11
+@js NA
+*/
+class CC_DLL ParticleCache : public Ref
+{
+public:
+    /** The default max number of systems pooled per plist. */
+    static const int DEFAULT_MAX_SYSTEMS_PER_FILE = 32;
+
+    /** Returns the shared particle cache. */
+    static ParticleCache* getInstance();
+
+    /** Purges the cache. The systems in use stay alive, they just aren't pooled anymore. */
+    static void destroyInstance();
+
+    /** Gets the template of a plist file, parsed on first use.
+     *
+     * @param plistFile Particle plist file name.
+     * @return The template, nullptr if the file can't be loaded. Don't run it or change it.
+     */
+    ParticleSystemQuad* getTemplate(const std::string& plistFile);
+
+    /** Gets a system configured like its plist file, restarted without particles.
+     The node properties of a reused system, other than the position, scale, rotation and visibility, are left as they were.
+     *
+     * @param plistFile Particle plist file name.
+     * @param prewarmSeconds The time to simulate the system ahead by, see ParticleSystem::prewarm().
+     * @return An autoreleased system, nullptr if the file can't be loaded.
+     */
+    ParticleSystemQuad* acquire(const std::string& plistFile, float prewarmSeconds = 0.0f);
+
+    /** Removes a system from its parent, the next acquire() of its plist file can reuse it. */
+    void recycle(ParticleSystemQuad* system);
+
+    /** Sets the max number of systems pooled per plist file, past it acquire() returns systems that aren't pooled. */
+    void setMaxSystemsPerFile(int maxSystems) { _maxSystemsPerFile = maxSystems; }
+
+    /** Gets the max number of systems pooled per plist file. */
+    int getMaxSystemsPerFile() const { return _maxSystemsPerFile; }
+
+    /** Gets the parsed dictionary of a plist file, read on first use. ParticleSystem::initWithFile() uses it.
+     *
+     * @param fullPath The full path of the plist file.
+     * @return The dictionary, nullptr if the file can't be read.
+     */
+    ValueMap* getDefinition(const std::string& fullPath);
+
+    /** Releases the parsed plist files, the next systems created from them read them again. */
+    void removeDefinitions() { _definitions.clear(); }
+
+    /** Releases the idle systems, and the templates of the plist files that have no system in use. */
+    void removeUnusedSystems();
+
+    /** Releases every template and stops pooling the systems. */
+    void removeAllSystems();
+
+CC_CONSTRUCTOR_ACCESS:
+    ParticleCache();
+    ~ParticleCache();
+
+protected:
+    struct Entry
+    {
+        ParticleSystemQuad* prototype;
+        Vector<ParticleSystemQuad*> systems;
+    };
+
+    static ParticleCache* s_sharedParticleCache;
+
+    std::unordered_map<std::string, Entry> _entries;
+    // the parsed plists by full path
+    std::unordered_map<std::string, ValueMap> _definitions;
+    int _maxSystemsPerFile;
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif //__CC_PARTICLE_CACHE_H__
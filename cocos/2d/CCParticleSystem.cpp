@@ -44,9 +44,12 @@ THE SOFTWARE.
 
 #include "2d/CCParticleSystem.h"
 
+#include <algorithm>
 #include <string>
 
 #include "2d/CCParticleBatchNode.h"
+#include "2d/CCParticleCache.h"
+#include "2d/ccParticleKernels.h"
 #include "renderer/CCTextureAtlas.h"
 #include "base/base64.h"
 #include "base/ZipUtils.h"
@@ -54,11 +57,21 @@ THE SOFTWARE.
 #include "renderer/CCTextureCache.h"
 #include "platform/CCFileUtils.h"
 #include "base/CCString.h"
+#include "base/CCTracer.h"
+#include "base/CCScheduler.h"
+#include "base/CCWorkerPool.h"
+#include "base/ccRandom.h"
 
 using namespace std;
 
 NS_CC_BEGIN
 
+// the key of the scheduler callback that runs the deferred updates, see ParticleSystem::setParallelUpdateEnabled()
+static const char* PARALLEL_UPDATE_KEY = "ParticleSystem::updatePendingSystems";
+
+bool ParticleSystem::s_isParallelUpdateEnabled = (CC_PARTICLE_PARALLEL_UPDATE != 0);
+std::vector<ParticleSystem*> ParticleSystem::s_pendingSystems;
+
 // ideas taken from:
 //     . The ocean spray in your face [Jeff Lander]
 //        http://www.double.co.nz/dust/col0798.pdf
@@ -77,36 +90,6 @@ NS_CC_BEGIN
 //
 
 
-inline void nomalize_point(float x, float y, particle_point* out)
-{
-    float n = x * x + y * y;
-    // Already normalized.
-    if (n == 1.0f)
-        return;
-
-    n = sqrt(n);
-    // Too close to zero.
-    if (n < MATH_TOLERANCE)
-        return;
-
-    n = 1.0f / n;
-    out->x = x * n;
-    out->y = y * n;
-}
-
-/**
- A more effect random number getter function, get from ejoy2d.
- */
-inline static float RANDOM_M11(unsigned int *seed) {
-    *seed = *seed * 134775813 + 1;
-    union {
-        uint32_t d;
-        float f;
-    } u;
-    u.d = (((uint32_t)(*seed) & 0x7fff) << 8) | 0x40000000;
-    return u.f - 3.0f;
-}
-
 ParticleData::ParticleData()
 {
     memset(this, 0, sizeof(ParticleData));
@@ -218,7 +201,13 @@ ParticleSystem::ParticleSystem()
 , _opacityModifyRGB(false)
 , _yCoordFlipped(1)
 , _positionType(PositionType::FREE)
+, _randomSeed(0)
+, _isFinished(false)
+, _isUpdatePending(false)
+, _pendingDelta(0)
 {
+    // the particles aren't bounded by the content size
+    _isCullingEnabled = false;
     modeA.gravity.setZero();
     modeA.speed = 0;
     modeA.speedVar = 0;
@@ -269,10 +258,11 @@ bool ParticleSystem::initWithFile(const std::string& plistFile)
 {
     bool ret = false;
     _plistFile = FileUtils::getInstance()->fullPathForFilename(plistFile);
-    ValueMap dict = FileUtils::getInstance()->getValueMapFromFile(_plistFile);
+    // parsed by the first system of the file
+    ValueMap* dict = ParticleCache::getInstance()->getDefinition(_plistFile);
 
-    CCASSERT( !dict.empty(), "Particles: file not found");
-    if (dict.empty()) {
+    CCASSERT( dict, "Particles: file not found");
+    if (dict == nullptr) {
         log("ParticleSystem::initWithFile error:%s not exist!", plistFile.c_str());
         return false;
     }
@@ -282,11 +272,11 @@ bool ParticleSystem::initWithFile(const std::string& plistFile)
     if (listFilePath.find('/') != string::npos)
     {
         listFilePath = listFilePath.substr(0, listFilePath.rfind('/') + 1);
-        ret = this->initWithDictionary(dict, listFilePath);
+        ret = this->initWithDictionary(*dict, listFilePath);
     }
     else
     {
-        ret = this->initWithDictionary(dict, "");
+        ret = this->initWithDictionary(*dict, "");
     }
 
     return ret;
@@ -475,8 +465,14 @@ bool ParticleSystem::initWithDictionary(ValueMap& dictionary, const std::string&
                 }
 
                 Texture2D *tex = nullptr;
+                const bool embedded = dictionary.find("textureImageData") != dictionary.end();
 
-                if (!textureName.empty())
+                if (embedded)
+                {
+                    // decoded by the first system of the plist
+                    tex = _director->getTextureCache()->getTextureForKey(_plistFile + textureName);
+                }
+                if (!tex && !textureName.empty())
                 {
                     // set not pop-up message box when load image failed
                     bool notify = FileUtils::getInstance()->isPopupNotify();
@@ -490,7 +486,7 @@ bool ParticleSystem::initWithDictionary(ValueMap& dictionary, const std::string&
                 {
                     setTexture(tex);
                 }
-                else if( dictionary.find("textureImageData") != dictionary.end() )
+                else if (embedded)
                 {
                     std::string textureData = dictionary.at("textureImageData").asString();
                     CCASSERT(!textureData.empty(), "textureData can't be empty!");
@@ -591,34 +587,34 @@ ParticleSystem::~ParticleSystem()
 
 void ParticleSystem::addParticles(int count)
 {
-    uint32_t RANDSEED = rand();
+    addParticles(count, rand());
+}
+
+void ParticleSystem::addParticles(int count, uint32_t seed)
+{
+    // each attribute is filled with its range, then fixed up in place
+    RandomGenerator random(seed);
 
     int start = _particleCount;
     _particleCount += count;
 
     //life
+    random.fill(_particleData.timeToLive + start, count, _life - _lifeVar, _life + _lifeVar);
     for (int i = start; i < _particleCount ; ++i)
     {
-        float theLife = _life + _lifeVar * RANDOM_M11(&RANDSEED);
-        _particleData.timeToLive[i] = MAX(0, theLife);
+        _particleData.timeToLive[i] = MAX(0, _particleData.timeToLive[i]);
     }
 
     //position
-    for (int i = start; i < _particleCount; ++i)
-    {
-        _particleData.posx[i] = _sourcePosition.x + _posVar.x * RANDOM_M11(&RANDSEED);
-    }
-
-    for (int i = start; i < _particleCount; ++i)
-    {
-        _particleData.posy[i] = _sourcePosition.y + _posVar.y * RANDOM_M11(&RANDSEED);
-    }
+    random.fill(_particleData.posx + start, count, _sourcePosition.x - _posVar.x, _sourcePosition.x + _posVar.x);
+    random.fill(_particleData.posy + start, count, _sourcePosition.y - _posVar.y, _sourcePosition.y + _posVar.y);
 
     //color
 #define SET_COLOR(c, b, v)\
+random.fill(c + start, count, b - v, b + v);\
 for (int i = start; i < _particleCount; ++i)\
 {\
-c[i] = clampf( b + v * RANDOM_M11(&RANDSEED) , 0 , 1 );\
+c[i] = clampf( c[i] , 0 , 1 );\
 }
 
     SET_COLOR(_particleData.colorR, _startColor.r, _startColorVar.r);
@@ -643,18 +639,18 @@ dc[i] = (dc[i] - c[i]) / _particleData.timeToLive[i];\
     SET_DELTA_COLOR(_particleData.colorA, _particleData.deltaColorA);
 
     //size
+    random.fill(_particleData.size + start, count, _startSize - _startSizeVar, _startSize + _startSizeVar);
     for (int i = start; i < _particleCount; ++i)
     {
-        _particleData.size[i] = _startSize + _startSizeVar * RANDOM_M11(&RANDSEED);
         _particleData.size[i] = MAX(0, _particleData.size[i]);
     }
 
     if (_endSize != START_SIZE_EQUAL_TO_END_SIZE)
     {
+        random.fill(_particleData.deltaSize + start, count, _endSize - _endSizeVar, _endSize + _endSizeVar);
         for (int i = start; i < _particleCount; ++i)
         {
-            float endSize = _endSize + _endSizeVar * RANDOM_M11(&RANDSEED);
-            endSize = MAX(0, endSize);
+            float endSize = MAX(0, _particleData.deltaSize[i]);
             _particleData.deltaSize[i] = (endSize - _particleData.size[i]) / _particleData.timeToLive[i];
         }
     }
@@ -667,13 +663,11 @@ dc[i] = (dc[i] - c[i]) / _particleData.timeToLive[i];\
     }
 
     // rotation
+    random.fill(_particleData.rotation + start, count, _startSpin - _startSpinVar, _startSpin + _startSpinVar);
+    random.fill(_particleData.deltaRotation + start, count, _endSpin - _endSpinVar, _endSpin + _endSpinVar);
     for (int i = start; i < _particleCount; ++i)
     {
-        _particleData.rotation[i] = _startSpin + _startSpinVar * RANDOM_M11(&RANDSEED);
-    }
-    for (int i = start; i < _particleCount; ++i)
-    {
-        float endA = _endSpin + _endSpinVar * RANDOM_M11(&RANDSEED);
+        float endA = _particleData.deltaRotation[i];
         _particleData.deltaRotation[i] = (endA - _particleData.rotation[i]) / _particleData.timeToLive[i];
     }
 
@@ -701,15 +695,24 @@ dc[i] = (dc[i] - c[i]) / _particleData.timeToLive[i];\
     {
 
         // radial accel
-        for (int i = start; i < _particleCount; ++i)
-        {
-            _particleData.modeA.radialAccel[i] = modeA.radialAccel + modeA.radialAccelVar * RANDOM_M11(&RANDSEED);
-        }
+        random.fill(_particleData.modeA.radialAccel + start, count,
+            modeA.radialAccel - modeA.radialAccelVar, modeA.radialAccel + modeA.radialAccelVar);
 
         // tangential accel
+        random.fill(_particleData.modeA.tangentialAccel + start, count,
+            modeA.tangentialAccel - modeA.tangentialAccelVar, modeA.tangentialAccel + modeA.tangentialAccelVar);
+
+        // direction, the angle in dirX and the speed in dirY until they're combined
+        random.fill(_particleData.modeA.dirX + start, count, _angle - _angleVar, _angle + _angleVar);
+        random.fill(_particleData.modeA.dirY + start, count, modeA.speed - modeA.speedVar, modeA.speed + modeA.speedVar);
         for (int i = start; i < _particleCount; ++i)
         {
-            _particleData.modeA.tangentialAccel[i] = modeA.tangentialAccel + modeA.tangentialAccelVar * RANDOM_M11(&RANDSEED);
+            float a = CC_DEGREES_TO_RADIANS( _particleData.modeA.dirX[i] );
+            Vec2 v(cosf( a ), sinf( a ));
+            float s = _particleData.modeA.dirY[i];
+            Vec2 dir = v * s;
+            _particleData.modeA.dirX[i] = dir.x;//v * s ;
+            _particleData.modeA.dirY[i] = dir.y;
         }
 
         // rotation is dir
@@ -717,27 +720,10 @@ dc[i] = (dc[i] - c[i]) / _particleData.timeToLive[i];\
         {
             for (int i = start; i < _particleCount; ++i)
             {
-                float a = CC_DEGREES_TO_RADIANS( _angle + _angleVar * RANDOM_M11(&RANDSEED) );
-                Vec2 v(cosf( a ), sinf( a ));
-                float s = modeA.speed + modeA.speedVar * RANDOM_M11(&RANDSEED);
-                Vec2 dir = v * s;
-                _particleData.modeA.dirX[i] = dir.x;//v * s ;
-                _particleData.modeA.dirY[i] = dir.y;
+                Vec2 dir(_particleData.modeA.dirX[i], _particleData.modeA.dirY[i]);
                 _particleData.rotation[i] = -CC_RADIANS_TO_DEGREES(dir.getAngle());
             }
         }
-        else
-        {
-            for (int i = start; i < _particleCount; ++i)
-            {
-                float a = CC_DEGREES_TO_RADIANS( _angle + _angleVar * RANDOM_M11(&RANDSEED) );
-                Vec2 v(cosf( a ), sinf( a ));
-                float s = modeA.speed + modeA.speedVar * RANDOM_M11(&RANDSEED);
-                Vec2 dir = v * s;
-                _particleData.modeA.dirX[i] = dir.x;//v * s ;
-                _particleData.modeA.dirY[i] = dir.y;
-            }
-        }
 
     }
 
@@ -746,19 +732,20 @@ dc[i] = (dc[i] - c[i]) / _particleData.timeToLive[i];\
     {
         //Need to check by Jacky
         // Set the default diameter of the particle from the source position
-        for (int i = start; i < _particleCount; ++i)
-        {
-            _particleData.modeB.radius[i] = modeB.startRadius + modeB.startRadiusVar * RANDOM_M11(&RANDSEED);
-        }
+        random.fill(_particleData.modeB.radius + start, count,
+            modeB.startRadius - modeB.startRadiusVar, modeB.startRadius + modeB.startRadiusVar);
 
+        random.fill(_particleData.modeB.angle + start, count, _angle - _angleVar, _angle + _angleVar);
         for (int i = start; i < _particleCount; ++i)
         {
-            _particleData.modeB.angle[i] = CC_DEGREES_TO_RADIANS( _angle + _angleVar * RANDOM_M11(&RANDSEED));
+            _particleData.modeB.angle[i] = CC_DEGREES_TO_RADIANS( _particleData.modeB.angle[i] );
         }
 
+        random.fill(_particleData.modeB.degreesPerSecond + start, count,
+            modeB.rotatePerSecond - modeB.rotatePerSecondVar, modeB.rotatePerSecond + modeB.rotatePerSecondVar);
         for (int i = start; i < _particleCount; ++i)
         {
-            _particleData.modeB.degreesPerSecond[i] = CC_DEGREES_TO_RADIANS(modeB.rotatePerSecond + modeB.rotatePerSecondVar * RANDOM_M11(&RANDSEED));
+            _particleData.modeB.degreesPerSecond[i] = CC_DEGREES_TO_RADIANS( _particleData.modeB.degreesPerSecond[i] );
         }
 
         if(modeB.endRadius == START_RADIUS_EQUAL_TO_END_RADIUS)
@@ -770,9 +757,11 @@ dc[i] = (dc[i] - c[i]) / _particleData.timeToLive[i];\
         }
         else
         {
+            random.fill(_particleData.modeB.deltaRadius + start, count,
+                modeB.endRadius - modeB.endRadiusVar, modeB.endRadius + modeB.endRadiusVar);
             for (int i = start; i < _particleCount; ++i)
             {
-                float endRadius = modeB.endRadius + modeB.endRadiusVar * RANDOM_M11(&RANDSEED);
+                float endRadius = _particleData.modeB.deltaRadius[i];
                 _particleData.modeB.deltaRadius[i] = (endRadius - _particleData.modeB.radius[i]) / _particleData.timeToLive[i];
             }
         }
@@ -818,8 +807,25 @@ bool ParticleSystem::isFull()
 // ParticleSystem - MainLoop
 void ParticleSystem::update(float dt)
 {
-    CC_PROFILER_START_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - update");
+    // the particles move every frame, a cached ancestor is drawn again
+    invalidateCachedTexture();
+
+    // the batched systems share the atlas of their ParticleBatchNode, they are always updated here
+    if (s_isParallelUpdateEnabled && !_batchNode)
+    {
+        deferUpdate(dt);
+        return;
+    }
+
+    CC_TRACE_ZONE("particles", "ParticleSystem::update");
 
+    _randomSeed = rand();
+    updateParticles(dt);
+    finishUpdate();
+}
+
+void ParticleSystem::updateParticles(float dt)
+{
     if (_isActive && _emissionRate)
     {
         float rate = 1.0f / _emissionRate;
@@ -832,7 +838,7 @@ void ParticleSystem::update(float dt)
         }
 
         int emitCount = MIN(_totalParticles - _particleCount, _emitCounter / rate);
-        addParticles(emitCount);
+        addParticles(emitCount, _randomSeed);
         _emitCounter -= rate * emitCount;
 
         _elapsed += dt;
@@ -872,117 +878,197 @@ void ParticleSystem::update(float dt)
                 --_particleCount;
                 if( _particleCount == 0 && _isAutoRemoveOnFinish )
                 {
-                    this->unscheduleUpdate();
-                    _parent->removeChild(this, true);
+                    // removed by finishUpdate(), on the main thread
+                    _isFinished = true;
                     return;
                 }
             }
         }
 
+        // the kernels use NEON or SSE2 over the arrays of _particleData when they can
         if (_emitterMode == Mode::GRAVITY)
         {
-            for (int i = 0 ; i < _particleCount; ++i)
-            {
-                particle_point tmp, radial = {0.0f, 0.0f}, tangential;
-
-                // radial acceleration
-                if (_particleData.posx[i] || _particleData.posy[i])
-                {
-                    nomalize_point(_particleData.posx[i], _particleData.posy[i], &radial);
-                }
-                tangential = radial;
-                radial.x *= _particleData.modeA.radialAccel[i];
-                radial.y *= _particleData.modeA.radialAccel[i];
-
-                // tangential acceleration
-                std::swap(tangential.x, tangential.y);
-                tangential.x *= - _particleData.modeA.tangentialAccel[i];
-                tangential.y *= _particleData.modeA.tangentialAccel[i];
-
-                // (gravity + radial + tangential) * dt
-                tmp.x = radial.x + tangential.x + modeA.gravity.x;
-                tmp.y = radial.y + tangential.y + modeA.gravity.y;
-                tmp.x *= dt;
-                tmp.y *= dt;
-
-                _particleData.modeA.dirX[i] += tmp.x;
-                _particleData.modeA.dirY[i] += tmp.y;
-
-                // this is cocos2d-x v3.0
-                // if (_configName.length()>0 && _yCoordFlipped != -1)
-
-                // this is cocos2d-x v3.0
-                tmp.x = _particleData.modeA.dirX[i] * dt * _yCoordFlipped;
-                tmp.y = _particleData.modeA.dirY[i] * dt * _yCoordFlipped;
-                _particleData.posx[i] += tmp.x;
-                _particleData.posy[i] += tmp.y;
-            }
+            particle::updateGravityMode(_particleData, _particleCount, modeA.gravity.x, modeA.gravity.y, dt, _yCoordFlipped);
         }
         else
         {
-            for (int i = 0; i < _particleCount; ++i)
-            {
-                _particleData.modeB.angle[i] += _particleData.modeB.degreesPerSecond[i] * dt;
-            }
+            particle::updateRadiusMode(_particleData, _particleCount, dt, _yCoordFlipped);
+        }
 
-            for (int i = 0; i < _particleCount; ++i)
-            {
-                _particleData.modeB.radius[i] += _particleData.modeB.deltaRadius[i] * dt;
-            }
+        //color r,g,b,a, size and angle
+        particle::updateColorSizeRotation(_particleData, _particleCount, dt);
 
-            for (int i = 0; i < _particleCount; ++i)
-            {
-                _particleData.posx[i] = - cosf(_particleData.modeB.angle[i]) * _particleData.modeB.radius[i];
-            }
-            for (int i = 0; i < _particleCount; ++i)
-            {
-                _particleData.posy[i] = - sinf(_particleData.modeB.angle[i]) * _particleData.modeB.radius[i] * _yCoordFlipped;
-            }
-        }
+        updateParticleQuads();
+        _transformSystemDirty = false;
+    }
+}
 
-        //color r,g,b,a
-        for (int i = 0 ; i < _particleCount; ++i)
+void ParticleSystem::finishUpdate()
+{
+    if (_isFinished)
+    {
+        _isFinished = false;
+        this->unscheduleUpdate();
+        if (_parent)
         {
-            _particleData.colorR[i] += _particleData.deltaColorR[i] * dt;
+            _parent->removeChild(this, true);
         }
+        return;
+    }
 
-        for (int i = 0 ; i < _particleCount; ++i)
-        {
-            _particleData.colorG[i] += _particleData.deltaColorG[i] * dt;
-        }
+    // only update gl buffer when visible
+    if (_visible && ! _batchNode)
+    {
+        postStep();
+    }
+}
 
-        for (int i = 0 ; i < _particleCount; ++i)
-        {
-            _particleData.colorB[i] += _particleData.deltaColorB[i] * dt;
-        }
+void ParticleSystem::deferUpdate(float dt)
+{
+    if (_isUpdatePending)
+    {
+        // updated twice in a frame, e.g. by updateWithNoTime()
+        _pendingDelta += dt;
+        return;
+    }
 
-        for (int i = 0 ; i < _particleCount; ++i)
-        {
-            _particleData.colorA[i] += _particleData.deltaColorA[i] * dt;
-        }
-        //size
-        for (int i = 0 ; i < _particleCount; ++i)
-        {
-            _particleData.size[i] += (_particleData.deltaSize[i] * dt);
-            _particleData.size[i] = MAX(0, _particleData.size[i]);
-        }
-        //angle
-        for (int i = 0 ; i < _particleCount; ++i)
+    if (s_pendingSystems.empty())
+    {
+        auto scheduler = _director->getScheduler();
+        if (!scheduler->isScheduled(PARALLEL_UPDATE_KEY, &s_pendingSystems))
         {
-            _particleData.rotation[i] += _particleData.deltaRotation[i] * dt;
+            // the custom callbacks run after the per-frame updates, so every system of the frame is in the list by then
+            scheduler->schedule([](float) { ParticleSystem::updatePendingSystems(); }, &s_pendingSystems, 0, false, PARALLEL_UPDATE_KEY);
         }
+    }
 
-        updateParticleQuads();
-        _transformSystemDirty = false;
+    // retained until the update runs, the system may be removed by a later update of the frame
+    this->retain();
+    _isUpdatePending = true;
+    _pendingDelta = dt;
+    s_pendingSystems.push_back(this);
+}
+
+void ParticleSystem::setParallelUpdateEnabled(bool enabled)
+{
+    if (s_isParallelUpdateEnabled == enabled)
+    {
+        return;
     }
 
-    // only update gl buffer when visible
-    if (_visible && ! _batchNode)
+    s_isParallelUpdateEnabled = enabled;
+    if (!enabled)
     {
-        postStep();
+        updatePendingSystems();
+        Director::getInstance()->getScheduler()->unschedule(PARALLEL_UPDATE_KEY, &s_pendingSystems);
+    }
+}
+
+void ParticleSystem::updatePendingSystems()
+{
+    if (s_pendingSystems.empty())
+    {
+        return;
+    }
+
+    CC_TRACE_ZONE("particles", "ParticleSystem::updatePendingSystems");
+
+    std::vector<ParticleSystem*> systems;
+    systems.swap(s_pendingSystems);
+
+    // rand() and the lazily computed transforms of the ancestors aren't thread safe, they are taken care of here
+    for (auto system : systems)
+    {
+        system->_randomSeed = rand();
+        system->getNodeToWorldTransform();
     }
 
-    CC_PROFILER_STOP_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - update");
+    auto task = [&systems](int index) {
+        CC_TRACE_ZONE("particles", "ParticleSystem::updateParticles");
+        ParticleSystem* system = systems[index];
+        system->updateParticles(system->_pendingDelta);
+    };
+    if (systems.size() > 1)
+    {
+        WorkerPool::getInstance()->run((int)systems.size(), task);
+    }
+    else
+    {
+        task(0);
+    }
+
+    for (auto system : systems)
+    {
+        system->_isUpdatePending = false;
+        system->finishUpdate();
+        system->release();
+    }
+}
+
+
+void ParticleSystem::prewarm(float seconds, float step)
+{
+    CCASSERT(step > 0, "ParticleSystem: the prewarm step must be positive");
+
+    for (float time = 0; time < seconds && !_isFinished; time += step)
+    {
+        _randomSeed = rand();
+        updateParticles(std::min(step, seconds - time));
+    }
+}
+
+void ParticleSystem::copyConfiguration(const ParticleSystem* other)
+{
+    CCASSERT(other->_totalParticles <= _allocatedParticles, "ParticleSystem: not enough particles allocated for the configuration");
+
+    _totalParticles = other->_totalParticles;
+    _isBlendAdditive = other->_isBlendAdditive;
+    _isAutoRemoveOnFinish = other->_isAutoRemoveOnFinish;
+    _plistFile = other->_plistFile;
+    _configName = other->_configName;
+    modeA = other->modeA;
+    modeB = other->modeB;
+    _duration = other->_duration;
+    _sourcePosition = other->_sourcePosition;
+    _posVar = other->_posVar;
+    _life = other->_life;
+    _lifeVar = other->_lifeVar;
+    _angle = other->_angle;
+    _angleVar = other->_angleVar;
+    _emitterMode = other->_emitterMode;
+    _startSize = other->_startSize;
+    _startSizeVar = other->_startSizeVar;
+    _endSize = other->_endSize;
+    _endSizeVar = other->_endSizeVar;
+    _startColor = other->_startColor;
+    _startColorVar = other->_startColorVar;
+    _endColor = other->_endColor;
+    _endColorVar = other->_endColorVar;
+    _startSpin = other->_startSpin;
+    _startSpinVar = other->_startSpinVar;
+    _endSpin = other->_endSpin;
+    _endSpinVar = other->_endSpinVar;
+    _emissionRate = other->_emissionRate;
+    _blendFunc = other->_blendFunc;
+    _opacityModifyRGB = other->_opacityModifyRGB;
+    _yCoordFlipped = other->_yCoordFlipped;
+    _positionType = other->_positionType;
+
+    if (_texture != other->_texture)
+    {
+        CC_SAFE_RETAIN(other->_texture);
+        CC_SAFE_RELEASE(_texture);
+        _texture = other->_texture;
+    }
+
+    setPosition(other->getPosition());
+
+    _particleCount = 0;
+    _emitCounter = 0;
+    _elapsed = 0;
+    _isActive = true;
+    _isFinished = false;
+    _transformSystemDirty = false;
 }
 
 void ParticleSystem::updateWithNoTime()
@@ -271,6 +271,31 @@ public:
      should be overridden by subclasses. */
     virtual void postStep();
 
+    /** Simulates the system ahead by `seconds`, in steps of `step` seconds, without uploading or drawing anything.
+     E.g. an ambient effect shows up already filled. The FREE position type needs the system to be in the scene.
+     @since v3.11
+     */
+    void prewarm(float seconds, float step = 1.0f / 30);
+
+    /** Copies the emitter configuration, the texture and the position of `other`, and restarts the emitter without particles.
+     It doesn't allocate: `other` mustn't have more particles than this system allocated.
+     @since v3.11
+     */
+    virtual void copyConfiguration(const ParticleSystem* other);
+
+    /** Enables/Disables the parallel update of the particle systems.
+     When enabled, the scheduled update() of a system only queues it. The systems of the frame are then updated
+     together on the WorkerPool, after the per-frame updates of the Scheduler and before the visit.
+     The systems of a ParticleBatchNode keep being updated one by one on the main thread.
+     Enabled by default when CC_PARTICLE_PARALLEL_UPDATE is 1.
+     @since v3.11
+     */
+    static void setParallelUpdateEnabled(bool enabled);
+    /** Whether or not the particle systems are updated in parallel.
+     @since v3.11
+     */
+    static bool isParallelUpdateEnabled() { return s_isParallelUpdateEnabled; }
+
     /** Call the update method with no time..
      */
     virtual void updateWithNoTime();
@@ -796,6 +821,21 @@ CC_CONSTRUCTOR_ACCESS:
 protected:
     virtual void updateBlendFunc();
 
+    /** Adds particles with the random numbers of `seed`. */
+    void addParticles(int count, uint32_t seed);
+
+    /** The part of update() that only touches this system, the parallel update runs it on a worker thread.
+     It emits the particles with _randomSeed and sets _isFinished instead of removing the system.
+     */
+    virtual void updateParticles(float dt);
+    /** The rest of update(), always run on the main thread: removes the finished system or uploads the quads. */
+    virtual void finishUpdate();
+
+    // queues the system for updatePendingSystems()
+    void deferUpdate(float dt);
+    // updates the queued systems in parallel, see setParallelUpdateEnabled()
+    static void updatePendingSystems();
+
     /** whether or not the particles are using blend additive.
      If enabled, the following blending function will be used.
      @code
@@ -948,6 +988,17 @@ protected:
      */
     PositionType _positionType;
 
+    /** the seed of the particles emitted by updateParticles(), rand() isn't thread safe */
+    uint32_t _randomSeed;
+    /** set by updateParticles() when the system must be removed */
+    bool _isFinished;
+    /** whether the system waits for updatePendingSystems(), and the time to update it by */
+    bool _isUpdatePending;
+    float _pendingDelta;
+
+    static bool s_isParallelUpdateEnabled;
+    static std::vector<ParticleSystem*> s_pendingSystems;
+
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(ParticleSystem);
 };
@@ -0,0 +1,396 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "2d/CCParticleSystemGPU.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+#include "2d/CCSpriteFrame.h"
+#include "renderer/ccGLStateCache.h"
+#include "renderer/CCGLProgram.h"
+#include "renderer/CCGLProgramState.h"
+#include "renderer/CCRenderer.h"
+#include "renderer/CCTexture2D.h"
+#include "renderer/CCQuadIndexBuffer.h"
+#include "base/CCDirector.h"
+#include "base/CCEventType.h"
+#include "base/CCEventListenerCustom.h"
+#include "base/CCEventDispatcher.h"
+#include "base/CCString.h"
+
+NS_CC_BEGIN
+
+// the seeds of a slot repeat after this many periods, the shader time wraps with them
+static const double SEED_CYCLES = 64.0;
+
+static const char* s_uniformNames[] = {
+    "u_emission",
+    "u_life",
+    "u_source",
+    "u_startColor",
+    "u_startColorVar",
+    "u_endColor",
+    "u_endColorVar",
+    "u_size",
+    "u_spin",
+    "u_angle",
+    "u_radius",
+    "u_flags",
+    "u_texRect",
+};
+
+ParticleSystemGPU::ParticleSystemGPU()
+: _vbo(0)
+, _time(0.0)
+, _stopTime(DBL_MAX)
+, _wasActive(false)
+, _lastElapsed(0.0f)
+, _uniformProgram(0)
+{
+    _texRect[0] = _texRect[1] = 0.0f;
+    _texRect[2] = _texRect[3] = 1.0f;
+    std::fill(_uniformLocations, _uniformLocations + UNIFORM_MAX, -1);
+}
+
+ParticleSystemGPU::~ParticleSystemGPU()
+{
+    GL::deleteBuffers(1, &_vbo);
+}
+
+ParticleSystemGPU * ParticleSystemGPU::create()
+{
+    ParticleSystemGPU *ret = new (std::nothrow) ParticleSystemGPU();
+    if (ret && ret->init())
+    {
+        ret->autorelease();
+        return ret;
+    }
+    CC_SAFE_DELETE(ret);
+    return nullptr;
+}
+
+ParticleSystemGPU * ParticleSystemGPU::createWithTotalParticles(int numberOfParticles)
+{
+    ParticleSystemGPU *ret = new (std::nothrow) ParticleSystemGPU();
+    if (ret && ret->initWithTotalParticles(numberOfParticles))
+    {
+        ret->autorelease();
+        return ret;
+    }
+    CC_SAFE_DELETE(ret);
+    return nullptr;
+}
+
+ParticleSystemGPU * ParticleSystemGPU::create(const std::string& filename)
+{
+    ParticleSystemGPU *ret = new (std::nothrow) ParticleSystemGPU();
+    if (ret && ret->initWithFile(filename))
+    {
+        ret->autorelease();
+        return ret;
+    }
+    CC_SAFE_DELETE(ret);
+    return nullptr;
+}
+
+bool ParticleSystemGPU::initWithTotalParticles(int numberOfParticles)
+{
+    // the defaults of ParticleSystem::initWithTotalParticles(), without the particle arrays
+    _totalParticles = numberOfParticles;
+    _allocatedParticles = numberOfParticles;
+    _isActive = true;
+    _blendFunc = BlendFunc::ALPHA_PREMULTIPLIED;
+    _positionType = PositionType::FREE;
+    _emitterMode = Mode::GRAVITY;
+    _isAutoRemoveOnFinish = false;
+    _transformSystemDirty = false;
+
+    setupVBO();
+
+    setGLProgramState(GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_PARTICLE_GPU));
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    auto listener = EventListenerCustom::create(EVENT_RENDERER_RECREATED, CC_CALLBACK_1(ParticleSystemGPU::listenRendererRecreated, this));
+    _eventDispatcher->addEventListenerWithSceneGraphPriority(listener, this);
+#endif
+
+    return true;
+}
+
+void ParticleSystemGPU::setupVBO()
+{
+    GL::deleteBuffers(1, &_vbo);
+    _vbo = 0;
+
+    if (_totalParticles <= 0)
+    {
+        return;
+    }
+
+    QuadIndexBuffer::getInstance()->reserve(std::min((ssize_t)_totalParticles, QuadIndexBuffer::MAX_QUADS));
+
+    // tl, bl, tr, br like V3F_C4B_T2F_Quad, so the shared indices apply
+    static const GLfloat corners[8] = { -0.5f, 0.5f, -0.5f, -0.5f, 0.5f, 0.5f, 0.5f, -0.5f };
+
+    std::vector<GLfloat> vertices(_totalParticles * 16);
+    GLfloat* v = vertices.data();
+    for (int i = 0; i < _totalParticles; ++i)
+    {
+        GLfloat seed = CCRANDOM_0_1();
+        for (int j = 0; j < 4; ++j)
+        {
+            *v++ = corners[j * 2];
+            *v++ = corners[j * 2 + 1];
+            *v++ = (GLfloat)i;
+            *v++ = seed;
+        }
+    }
+
+    glGenBuffers(1, &_vbo);
+    GL::bindBuffer(GL_ARRAY_BUFFER, _vbo);
+    GL::bufferData(GL_ARRAY_BUFFER, sizeof(vertices[0]) * vertices.size(), vertices.data(), GL_STATIC_DRAW);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
+
+    CHECK_GL_ERROR_DEBUG();
+}
+
+void ParticleSystemGPU::listenRendererRecreated(EventCustom* event)
+{
+    // the buffer went away with the context
+    _vbo = 0;
+    _uniformProgram = 0;
+    setupVBO();
+}
+
+void ParticleSystemGPU::setTextureWithRect(Texture2D *texture, const Rect& pointRect)
+{
+    // Only update the texture if is different from the current one
+    if( !_texture || texture->getName() != _texture->getName() )
+    {
+        ParticleSystem::setTexture(texture);
+    }
+
+    Rect rect = Rect(
+        pointRect.origin.x * CC_CONTENT_SCALE_FACTOR(),
+        pointRect.origin.y * CC_CONTENT_SCALE_FACTOR(),
+        pointRect.size.width * CC_CONTENT_SCALE_FACTOR(),
+        pointRect.size.height * CC_CONTENT_SCALE_FACTOR());
+
+    GLfloat wide = (GLfloat)_texture->getPixelsWide();
+    GLfloat high = (GLfloat)_texture->getPixelsHigh();
+
+#if CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
+    GLfloat left = (rect.origin.x*2+1) / (wide*2);
+    GLfloat bottom = (rect.origin.y*2+1) / (high*2);
+    GLfloat right = left + (rect.size.width*2-2) / (wide*2);
+    GLfloat top = bottom + (rect.size.height*2-2) / (high*2);
+#else
+    GLfloat left = rect.origin.x / wide;
+    GLfloat bottom = rect.origin.y / high;
+    GLfloat right = left + rect.size.width / wide;
+    GLfloat top = bottom + rect.size.height / high;
+#endif // ! CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
+
+    // Important. Texture in cocos2d are inverted, so the Y component should be inverted
+    _texRect[0] = left;
+    _texRect[1] = top;
+    _texRect[2] = right;
+    _texRect[3] = bottom;
+}
+
+void ParticleSystemGPU::setTexture(Texture2D* texture)
+{
+    const Size& s = texture->getContentSize();
+    this->setTextureWithRect(texture, Rect(0, 0, s.width, s.height));
+}
+
+void ParticleSystemGPU::setDisplayFrame(SpriteFrame *spriteFrame)
+{
+    CCASSERT(spriteFrame->getOffsetInPixels().isZero(),
+             "ParticleSystemGPU only supports SpriteFrames with no offsets");
+
+    this->setTextureWithRect(spriteFrame->getTexture(), spriteFrame->getRect());
+}
+
+void ParticleSystemGPU::setTotalParticles(int tp)
+{
+    if (tp != _totalParticles)
+    {
+        _totalParticles = tp;
+        _allocatedParticles = tp;
+        setupVBO();
+    }
+}
+
+void ParticleSystemGPU::setBatchNode(ParticleBatchNode* batchNode)
+{
+    CCASSERT(batchNode == nullptr, "ParticleSystemGPU can't be added to a ParticleBatchNode");
+}
+
+void ParticleSystemGPU::onEnter()
+{
+    ParticleSystem::onEnter();
+
+    if (_emitterMode == Mode::GRAVITY &&
+        (modeA.radialAccel || modeA.radialAccelVar || modeA.tangentialAccel || modeA.tangentialAccelVar))
+    {
+        CCLOG("ParticleSystemGPU: the radial and tangential accelerations of '%s' are ignored", _plistFile.c_str());
+    }
+}
+
+float ParticleSystemGPU::getMaxLife() const
+{
+    return std::min(_life + std::abs(_lifeVar), _totalParticles / _emissionRate);
+}
+
+void ParticleSystemGPU::updateParticles(float dt)
+{
+    if (_isActive)
+    {
+        // started, or rewound by resetSystem(): the living particles go away and the first slot spawns again
+        if (!_wasActive || _elapsed < _lastElapsed)
+        {
+            _time = 0.0;
+            _stopTime = DBL_MAX;
+        }
+
+        _elapsed += dt;
+        if (_elapsed < 0.f)
+            _elapsed = 0.f;
+        if (_duration != DURATION_INFINITY && _duration < _elapsed)
+        {
+            this->stopSystem();
+        }
+    }
+
+    _time += dt;
+    if (!_isActive && _stopTime == DBL_MAX)
+    {
+        _stopTime = _time;
+    }
+    _wasActive = _isActive;
+    _lastElapsed = _elapsed;
+
+    if (!_isActive && _isAutoRemoveOnFinish && (_emissionRate <= 0 || _time >= _stopTime + getMaxLife()))
+    {
+        _isFinished = true;
+    }
+}
+
+void ParticleSystemGPU::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
+{
+    if (_vbo && _texture && _emissionRate > 0 && _time < _stopTime + getMaxLife())
+    {
+        _customCommand.init(_globalZOrder, transform, flags);
+        _customCommand.func = CC_CALLBACK_0(ParticleSystemGPU::onDraw, this, transform, flags);
+        renderer->addCommand(&_customCommand);
+    }
+}
+
+void ParticleSystemGPU::onDraw(const Mat4 &transform, uint32_t flags)
+{
+    auto glProgram = getGLProgram();
+    glProgram->use();
+    glProgram->setUniformsForBuiltins(transform);
+
+    if (_uniformProgram != glProgram->getProgram())
+    {
+        _uniformProgram = glProgram->getProgram();
+        for (int i = 0; i < UNIFORM_MAX; ++i)
+        {
+            _uniformLocations[i] = glProgram->getUniformLocationForName(s_uniformNames[i]);
+        }
+    }
+
+    float period = _totalParticles / _emissionRate;
+    // keep the time small enough for the float precision of the shader, by whole seed cycles
+    double wrap = period * SEED_CYCLES;
+    double offset = _time < wrap ? 0.0 : (std::floor(_time / wrap) - 1.0) * wrap;
+    float time = (float)(_time - offset);
+    float stopTime = (float)std::min(_stopTime - offset, (double)FLT_MAX);
+
+    bool radiusMode = _emitterMode == Mode::RADIUS;
+    const GLfloat uniforms[UNIFORM_MAX][4] = {
+        { period, 1.0f / _emissionRate, time, stopTime },
+        { _life, _lifeVar, (GLfloat)_yCoordFlipped, _opacityModifyRGB ? 1.0f : 0.0f },
+        { _sourcePosition.x, _sourcePosition.y, _posVar.x, _posVar.y },
+        { _startColor.r, _startColor.g, _startColor.b, _startColor.a },
+        { _startColorVar.r, _startColorVar.g, _startColorVar.b, _startColorVar.a },
+        { _endColor.r, _endColor.g, _endColor.b, _endColor.a },
+        { _endColorVar.r, _endColorVar.g, _endColorVar.b, _endColorVar.a },
+        { _startSize, _startSizeVar, _endSize, _endSizeVar },
+        { _startSpin, _startSpinVar, _endSpin, _endSpinVar },
+        { _angle, _angleVar, radiusMode ? modeB.rotatePerSecond : modeA.speed, radiusMode ? modeB.rotatePerSecondVar : modeA.speedVar },
+        { radiusMode ? modeB.startRadius : modeA.gravity.x, radiusMode ? modeB.startRadiusVar : modeA.gravity.y, modeB.endRadius, modeB.endRadiusVar },
+        { _endSize == START_SIZE_EQUAL_TO_END_SIZE ? 1.0f : 0.0f, modeB.endRadius == START_RADIUS_EQUAL_TO_END_RADIUS ? 1.0f : 0.0f,
+          modeA.rotationIsDir ? 1.0f : 0.0f, radiusMode ? 1.0f : 0.0f },
+        { _texRect[0], _texRect[1], _texRect[2], _texRect[3] },
+    };
+    for (int i = 0; i < UNIFORM_MAX; ++i)
+    {
+        glProgram->setUniformLocationWith4fv(_uniformLocations[i], uniforms[i], 1);
+    }
+
+    GL::bindTexture2D(_texture->getName());
+    GL::blendFunc(_blendFunc.src, _blendFunc.dst);
+
+    // only the slots that spawned at least once can be alive
+    ssize_t count = _totalParticles;
+    if (time < period)
+    {
+        count = std::min(count, (ssize_t)(time * _emissionRate) + 1);
+    }
+
+    GL::bindVAO(0);
+    GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POSITION);
+    GL::bindBuffer(GL_ARRAY_BUFFER, _vbo);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, QuadIndexBuffer::getInstance()->reserve(std::min(count, QuadIndexBuffer::MAX_QUADS)));
+
+    // the indices are GLushort, draw by batches of the quads they can address
+    ssize_t batches = 0;
+    for (ssize_t start = 0; start < count; start += QuadIndexBuffer::MAX_QUADS)
+    {
+        ssize_t quads = std::min(count - start, QuadIndexBuffer::MAX_QUADS);
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 4, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 4, (GLvoid*)(start * 4 * sizeof(GLfloat) * 4));
+        glDrawElements(GL_TRIANGLES, (GLsizei)quads * 6, GL_UNSIGNED_SHORT, (GLvoid*)0);
+        ++batches;
+    }
+
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
+
+    CC_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(batches, count * 6);
+    CHECK_GL_ERROR_DEBUG();
+}
+
+std::string ParticleSystemGPU::getDescription() const
+{
+    return StringUtils::format("<ParticleSystemGPU | Tag = %d, Total Particles = %d>", _tag, _totalParticles);
+}
+
+NS_CC_END
@@ -0,0 +1,162 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CC_PARTICLE_SYSTEM_GPU_H__
+#define __CC_PARTICLE_SYSTEM_GPU_H__
+
+#include "2d/CCParticleSystem.h"
+#include "renderer/CCCustomCommand.h"
+
+NS_CC_BEGIN
+
+class SpriteFrame;
+class EventCustom;
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/** @class ParticleSystemGPU
+ * @brief ParticleSystemGPU is a ParticleSystem simulated by the vertex shader.
+
+It reads the same plist files as ParticleSystemQuad, but nothing is updated or uploaded per particle:
+every particle is evaluated in closed form from its spawn time, so the cost of a frame doesn't depend on the CPU.
+It is meant for the big weather and ambient effects that the CPU can't keep up with.
+
+Limitations:
+- The radial and tangential accelerations are ignored.
+- A particle lives at most totalParticles / emissionRate seconds.
+- The particles always move with the emitter, the FREE and RELATIVE position types behave like GROUPED.
+- It can't be added to a ParticleBatchNode and getParticleCount() is always 0.
+@since v3.11
+@js NA
+*/
+class CC_DLL ParticleSystemGPU : public ParticleSystem
+{
+public:
+    /** Creates a Particle Emitter.
+     *
+     * @return An autoreleased ParticleSystemGPU object.
+     */
+    static ParticleSystemGPU * create();
+    /** Creates a Particle Emitter with a number of particles.
+     *
+     * @param numberOfParticles A given number of particles.
+     * @return An autoreleased ParticleSystemGPU object.
+     */
+    static ParticleSystemGPU * createWithTotalParticles(int numberOfParticles);
+    /** Creates an initializes a ParticleSystemGPU from a plist file.
+     *
+     * @param filename Particle plist file name.
+     * @return An autoreleased ParticleSystemGPU object.
+     */
+    static ParticleSystemGPU * create(const std::string& filename);
+
+    /** Sets the texture with a rect, in points. */
+    void setTextureWithRect(Texture2D *texture, const Rect& rect);
+
+    /** Sets a new SpriteFrame as particle.
+     WARNING: this method is experimental. Use setTextureWithRect instead.
+     */
+    void setDisplayFrame(SpriteFrame *spriteFrame);
+
+    /** Time the particles have been simulated since the last reset, in seconds. */
+    double getSimulationTime() const { return _time; }
+
+    virtual void setTexture(Texture2D* texture) override;
+    virtual void setTotalParticles(int tp) override;
+    virtual void setBatchNode(ParticleBatchNode* batchNode) override;
+    virtual void onEnter() override;
+    virtual void draw(Renderer *renderer, const Mat4 &transform, uint32_t flags) override;
+    virtual std::string getDescription() const override;
+
+CC_CONSTRUCTOR_ACCESS:
+    /**
+     * @js ctor
+     */
+    ParticleSystemGPU();
+    /**
+     * @js NA
+     * @lua NA
+     */
+    virtual ~ParticleSystemGPU();
+
+    // no ParticleData is allocated, the particles only live in the vertex shader
+    virtual bool initWithTotalParticles(int numberOfParticles) override;
+
+protected:
+    enum
+    {
+        UNIFORM_EMISSION,
+        UNIFORM_LIFE,
+        UNIFORM_SOURCE,
+        UNIFORM_START_COLOR,
+        UNIFORM_START_COLOR_VAR,
+        UNIFORM_END_COLOR,
+        UNIFORM_END_COLOR_VAR,
+        UNIFORM_SIZE,
+        UNIFORM_SPIN,
+        UNIFORM_ANGLE,
+        UNIFORM_RADIUS,
+        UNIFORM_FLAGS,
+        UNIFORM_TEX_RECT,
+        UNIFORM_MAX,
+    };
+
+    // only advances the time, it is safe on a worker thread like the CPU simulation
+    virtual void updateParticles(float dt) override;
+
+    void setupVBO();
+    // the longest a particle can live, in seconds
+    float getMaxLife() const;
+    void onDraw(const Mat4 &transform, uint32_t flags);
+    void listenRendererRecreated(EventCustom* event);
+
+    // corner, slot and seed of each vertex
+    GLuint _vbo;
+    // left, bottom, right, top
+    GLfloat _texRect[4];
+
+    double _time;
+    // when the emitter stopped, the slots that spawn later stay empty
+    double _stopTime;
+    bool _wasActive;
+    float _lastElapsed;
+
+    GLuint _uniformProgram;
+    GLint _uniformLocations[UNIFORM_MAX];
+    CustomCommand _customCommand;
+
+private:
+    CC_DISALLOW_COPY_AND_ASSIGN(ParticleSystemGPU);
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif //__CC_PARTICLE_SYSTEM_GPU_H__
@@ -33,9 +33,11 @@ THE SOFTWARE.
 
 #include "2d/CCSpriteFrame.h"
 #include "2d/CCParticleBatchNode.h"
+#include "2d/ccParticleKernels.h"
 #include "renderer/CCTextureAtlas.h"
 #include "renderer/ccGLStateCache.h"
 #include "renderer/CCRenderer.h"
+#include "renderer/CCQuadIndexBuffer.h"
 #include "base/CCDirector.h"
 #include "base/CCEventType.h"
 #include "base/CCConfiguration.h"
@@ -47,7 +49,6 @@ NS_CC_BEGIN
 
 ParticleSystemQuad::ParticleSystemQuad()
 :_quads(nullptr)
-,_indices(nullptr)
 ,_VAOname(0)
 {
     memset(_buffersVBO, 0, sizeof(_buffersVBO));
@@ -58,11 +59,10 @@ ParticleSystemQuad::~ParticleSystemQuad()
     if (nullptr == _batchNode)
     {
         CC_SAFE_FREE(_quads);
-        CC_SAFE_FREE(_indices);
-        glDeleteBuffers(2, &_buffersVBO[0]);
+        GL::deleteBuffers(1, &_buffersVBO[0]);
         if (Configuration::getInstance()->supportsShareableVAO())
         {
-            glDeleteVertexArrays(1, &_VAOname);
+            GL::deleteVAO(_VAOname);
             GL::bindVAO(0);
         }
     }
@@ -105,6 +105,18 @@ ParticleSystemQuad * ParticleSystemQuad::create(ValueMap &dictionary)
     return ret;
 }
 
+ParticleSystemQuad * ParticleSystemQuad::createWithTemplate(const ParticleSystemQuad* prototype)
+{
+    ParticleSystemQuad *ret = new (std::nothrow) ParticleSystemQuad();
+    if (ret && ret->initWithTemplate(prototype))
+    {
+        ret->autorelease();
+        return ret;
+    }
+    CC_SAFE_DELETE(ret);
+    return ret;
+}
+
 //implementation ParticleSystemQuad
 // overriding the init method
 bool ParticleSystemQuad::initWithTotalParticles(int numberOfParticles)
@@ -118,7 +130,6 @@ bool ParticleSystemQuad::initWithTotalParticles(int numberOfParticles)
             return false;
         }
 
-        initIndices();
         if (Configuration::getInstance()->supportsShareableVAO())
         {
             setupVBOandVAO();
@@ -141,6 +152,36 @@ bool ParticleSystemQuad::initWithTotalParticles(int numberOfParticles)
     return false;
 }
 
+bool ParticleSystemQuad::initWithTemplate(const ParticleSystemQuad* prototype)
+{
+    if (!initWithTotalParticles(prototype->_totalParticles))
+    {
+        return false;
+    }
+
+    copyConfiguration(prototype);
+    return true;
+}
+
+void ParticleSystemQuad::copyConfiguration(const ParticleSystem* other)
+{
+    ParticleSystem::copyConfiguration(other);
+
+    auto prototype = dynamic_cast<const ParticleSystemQuad*>(other);
+    if (prototype && !_batchNode && !prototype->_batchNode && _totalParticles > 0)
+    {
+        // every particle uses the same rect of the texture
+        const V3F_C4B_T2F_Quad& quad = prototype->_quads[0];
+        for (int i = 0; i < _totalParticles; ++i)
+        {
+            _quads[i].bl.texCoords = quad.bl.texCoords;
+            _quads[i].br.texCoords = quad.br.texCoords;
+            _quads[i].tl.texCoords = quad.tl.texCoords;
+            _quads[i].tr.texCoords = quad.tr.texCoords;
+        }
+    }
+}
+
 // pointRect should be in Texture coordinates, not pixel coordinates
 void ParticleSystemQuad::initTexCoordsWithRect(const Rect& pointRect)
 {
@@ -246,63 +287,6 @@ void ParticleSystemQuad::setDisplayFrame(SpriteFrame *spriteFrame)
     }
 }
 
-void ParticleSystemQuad::initIndices()
-{
-    for(int i = 0; i < _totalParticles; ++i)
-    {
-        const unsigned int i6 = i*6;
-        const unsigned int i4 = i*4;
-        _indices[i6+0] = (GLushort) i4+0;
-        _indices[i6+1] = (GLushort) i4+1;
-        _indices[i6+2] = (GLushort) i4+2;
-
-        _indices[i6+5] = (GLushort) i4+1;
-        _indices[i6+4] = (GLushort) i4+2;
-        _indices[i6+3] = (GLushort) i4+3;
-    }
-}
-
-inline void updatePosWithParticle(V3F_C4B_T2F_Quad *quad, const Vec2& newPosition,float size,float rotation)
-{
-    // vertices
-    GLfloat size_2 = size/2;
-    GLfloat x1 = -size_2;
-    GLfloat y1 = -size_2;
-
-    GLfloat x2 = size_2;
-    GLfloat y2 = size_2;
-    GLfloat x = newPosition.x;
-    GLfloat y = newPosition.y;
-
-    GLfloat r = (GLfloat)-CC_DEGREES_TO_RADIANS(rotation);
-    GLfloat cr = cosf(r);
-    GLfloat sr = sinf(r);
-    GLfloat ax = x1 * cr - y1 * sr + x;
-    GLfloat ay = x1 * sr + y1 * cr + y;
-    GLfloat bx = x2 * cr - y1 * sr + x;
-    GLfloat by = x2 * sr + y1 * cr + y;
-    GLfloat cx = x2 * cr - y2 * sr + x;
-    GLfloat cy = x2 * sr + y2 * cr + y;
-    GLfloat dx = x1 * cr - y2 * sr + x;
-    GLfloat dy = x1 * sr + y2 * cr + y;
-
-    // bottom-left
-    quad->bl.vertices.x = ax;
-    quad->bl.vertices.y = ay;
-
-    // bottom-right vertex:
-    quad->br.vertices.x = bx;
-    quad->br.vertices.y = by;
-
-    // top-left vertex:
-    quad->tl.vertices.x = dx;
-    quad->tl.vertices.y = dy;
-
-    // top-right vertex:
-    quad->tr.vertices.x = cx;
-    quad->tr.vertices.y = cy;
-}
-
 void ParticleSystemQuad::updateParticleQuads()
 {
     if (_particleCount <= 0) {
@@ -332,113 +316,38 @@ void ParticleSystemQuad::updateParticleQuads()
         startQuad = &(_quads[0]);
     }
 
+    // the center of a particle is its position plus {a, b, c, d, e, f} applied to its start position
+    float startTransform[6] = { 0, 0, pos.x, 0, 0, pos.y };
     if( _positionType == PositionType::FREE )
     {
+        // the start positions are in world space, newPos = pos + position - (worldToNode(current) - worldToNode(start))
         Vec3 p1(currentPosition.x, currentPosition.y, 0);
         Mat4 worldToNodeTM = getWorldToNodeTransform();
         worldToNodeTM.transformPoint(&p1);
-        Vec3 p2;
-        Vec2 newPos;
-        float* startX = _particleData.startPosX;
-        float* startY = _particleData.startPosY;
-        float* x = _particleData.posx;
-        float* y = _particleData.posy;
-        float* s = _particleData.size;
-        float* r = _particleData.rotation;
-        V3F_C4B_T2F_Quad* quadStart = startQuad;
-        for (int i = 0 ; i < _particleCount; ++i, ++startX, ++startY, ++x, ++y, ++quadStart, ++s, ++r)
-        {
-            p2.set(*startX, *startY, 0);
-            worldToNodeTM.transformPoint(&p2);
-            newPos.set(*x,*y);
-            p2 = p1 - p2;
-            newPos.x -= p2.x - pos.x;
-            newPos.y -= p2.y - pos.y;
-            updatePosWithParticle(quadStart, newPos, *s, *r);
-        }
+        const float* m = worldToNodeTM.m;
+        startTransform[0] = m[0];
+        startTransform[1] = m[4];
+        startTransform[2] = m[12] - p1.x + pos.x;
+        startTransform[3] = m[1];
+        startTransform[4] = m[5];
+        startTransform[5] = m[13] - p1.y + pos.y;
     }
     else if( _positionType == PositionType::RELATIVE )
     {
-        Vec2 newPos;
-        float* startX = _particleData.startPosX;
-        float* startY = _particleData.startPosY;
-        float* x = _particleData.posx;
-        float* y = _particleData.posy;
-        float* s = _particleData.size;
-        float* r = _particleData.rotation;
-        V3F_C4B_T2F_Quad* quadStart = startQuad;
-        for (int i = 0 ; i < _particleCount; ++i, ++startX, ++startY, ++x, ++y, ++quadStart, ++s, ++r)
-        {
-            newPos.set(*x, *y);
-            newPos.x = *x - (currentPosition.x - *startX);
-            newPos.y = *y - (currentPosition.y - *startY);
-            newPos += pos;
-            updatePosWithParticle(quadStart, newPos, *s, *r);
-        }
-    }
-    else
-    {
-        Vec2 newPos;
-        float* startX = _particleData.startPosX;
-        float* startY = _particleData.startPosY;
-        float* x = _particleData.posx;
-        float* y = _particleData.posy;
-        float* s = _particleData.size;
-        float* r = _particleData.rotation;
-        V3F_C4B_T2F_Quad* quadStart = startQuad;
-        for (int i = 0 ; i < _particleCount; ++i, ++startX, ++startY, ++x, ++y, ++quadStart, ++s, ++r)
-        {
-            newPos.set(*x + pos.x, *y + pos.y);
-            updatePosWithParticle(quadStart, newPos, *s, *r);
-        }
+        // newPos = pos + position - (current - start)
+        startTransform[0] = 1;
+        startTransform[2] = pos.x - currentPosition.x;
+        startTransform[4] = 1;
+        startTransform[5] = pos.y - currentPosition.y;
     }
 
-    //set color
-    if(_opacityModifyRGB)
-    {
-        V3F_C4B_T2F_Quad* quad = startQuad;
-        float* r = _particleData.colorR;
-        float* g = _particleData.colorG;
-        float* b = _particleData.colorB;
-        float* a = _particleData.colorA;
-
-        for (int i = 0; i < _particleCount; ++i,++quad,++r,++g,++b,++a)
-        {
-            GLubyte colorR = *r * *a * 255;
-            GLubyte colorG = *g * *a * 255;
-            GLubyte colorB = *b * *a * 255;
-            GLubyte colorA = *a * 255;
-            quad->bl.colors.set(colorR, colorG, colorB, colorA);
-            quad->br.colors.set(colorR, colorG, colorB, colorA);
-            quad->tl.colors.set(colorR, colorG, colorB, colorA);
-            quad->tr.colors.set(colorR, colorG, colorB, colorA);
-        }
-    }
-    else
-    {
-        V3F_C4B_T2F_Quad* quad = startQuad;
-        float* r = _particleData.colorR;
-        float* g = _particleData.colorG;
-        float* b = _particleData.colorB;
-        float* a = _particleData.colorA;
-
-        for (int i = 0; i < _particleCount; ++i,++quad,++r,++g,++b,++a)
-        {
-            GLubyte colorR = *r * 255;
-            GLubyte colorG = *g * 255;
-            GLubyte colorB = *b * 255;
-            GLubyte colorA = *a * 255;
-            quad->bl.colors.set(colorR, colorG, colorB, colorA);
-            quad->br.colors.set(colorR, colorG, colorB, colorA);
-            quad->tl.colors.set(colorR, colorG, colorB, colorA);
-            quad->tr.colors.set(colorR, colorG, colorB, colorA);
-        }
-    }
+    particle::updateQuadVertices(_particleData, _particleCount, startTransform, startQuad);
+    particle::updateQuadColors(_particleData, _particleCount, _opacityModifyRGB, startQuad);
 }
 
 void ParticleSystemQuad::postStep()
 {
-    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+    GL::bindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
 
     // Option 1: Sub Data
     glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(_quads[0])*_totalParticles, _quads);
@@ -452,7 +361,7 @@ void ParticleSystemQuad::postStep()
     // memcpy(buf, _quads, sizeof(_quads[0])*_totalParticles);
     // glUnmapBuffer(GL_ARRAY_BUFFER);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
 
     CHECK_GL_ERROR_DEBUG();
 }
@@ -476,7 +385,6 @@ void ParticleSystemQuad::setTotalParticles(int tp)
     {
         // Allocate new memory
         size_t quadsSize = sizeof(_quads[0]) * tp * 1;
-        size_t indicesSize = sizeof(_indices[0]) * tp * 6 * 1;
 
         _particleData.release();
         if (!_particleData.init(tp))
@@ -485,26 +393,20 @@ void ParticleSystemQuad::setTotalParticles(int tp)
             return;
         }
         V3F_C4B_T2F_Quad* quadsNew = (V3F_C4B_T2F_Quad*)realloc(_quads, quadsSize);
-        GLushort* indicesNew = (GLushort*)realloc(_indices, indicesSize);
 
-        if (quadsNew && indicesNew)
+        if (quadsNew)
         {
             // Assign pointers
             _quads = quadsNew;
-            _indices = indicesNew;
 
             // Clear the memory
             memset(_quads, 0, quadsSize);
-            memset(_indices, 0, indicesSize);
 
             _allocatedParticles = tp;
         }
         else
         {
             // Out of memory, failed to resize some array
-            if (quadsNew) _quads = quadsNew;
-            if (indicesNew) _indices = indicesNew;
-
             CCLOG("Particle system: out of memory");
             return;
         }
@@ -520,7 +422,6 @@ void ParticleSystemQuad::setTotalParticles(int tp)
             }
         }
 
-        initIndices();
         if (Configuration::getInstance()->supportsShareableVAO())
         {
             setupVBOandVAO();
@@ -549,56 +450,56 @@ void ParticleSystemQuad::setTotalParticles(int tp)
 void ParticleSystemQuad::setupVBOandVAO()
 {
     // clean VAO
-    glDeleteBuffers(2, &_buffersVBO[0]);
-    glDeleteVertexArrays(1, &_VAOname);
+    GL::deleteBuffers(1, &_buffersVBO[0]);
+    GL::deleteVAO(_VAOname);
     GL::bindVAO(0);
 
+    // the indices are shared with the other quad based nodes
+    GLuint indicesVBO = QuadIndexBuffer::getInstance()->reserve(std::min((ssize_t)_totalParticles, QuadIndexBuffer::MAX_QUADS));
+
     glGenVertexArrays(1, &_VAOname);
     GL::bindVAO(_VAOname);
 
 #define kQuadSize sizeof(_quads[0].bl)
 
-    glGenBuffers(2, &_buffersVBO[0]);
+    glGenBuffers(1, &_buffersVBO[0]);
 
-    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * _totalParticles, _quads, GL_DYNAMIC_DRAW);
+    GL::bindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+    GL::bufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * _totalParticles, _quads, GL_DYNAMIC_DRAW);
 
     // vertices
     glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_POSITION);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, vertices));
+    GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, vertices));
 
     // colors
     glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_COLOR);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, colors));
+    GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, colors));
 
     // tex coords
     glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_TEX_COORD);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, texCoords));
+    GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, texCoords));
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _totalParticles * 6, _indices, GL_STATIC_DRAW);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indicesVBO);
 
     // Must unbind the VAO before changing the element buffer.
     GL::bindVAO(0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
 
     CHECK_GL_ERROR_DEBUG();
 }
 
 void ParticleSystemQuad::setupVBO()
 {
-    glDeleteBuffers(2, &_buffersVBO[0]);
+    GL::deleteBuffers(1, &_buffersVBO[0]);
 
-    glGenBuffers(2, &_buffersVBO[0]);
+    QuadIndexBuffer::getInstance()->reserve(std::min((ssize_t)_totalParticles, QuadIndexBuffer::MAX_QUADS));
 
-    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * _totalParticles, _quads, GL_DYNAMIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glGenBuffers(1, &_buffersVBO[0]);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _totalParticles * 6, _indices, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+    GL::bufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * _totalParticles, _quads, GL_DYNAMIC_DRAW);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
 
     CHECK_GL_ERROR_DEBUG();
 }
@@ -624,22 +525,17 @@ bool ParticleSystemQuad::allocMemory()
     CCASSERT( !_batchNode, "Memory should not be alloced when not using batchNode");
 
     CC_SAFE_FREE(_quads);
-    CC_SAFE_FREE(_indices);
 
     _quads = (V3F_C4B_T2F_Quad*)malloc(_totalParticles * sizeof(V3F_C4B_T2F_Quad));
-    _indices = (GLushort*)malloc(_totalParticles * 6 * sizeof(GLushort));
 
-    if( !_quads || !_indices)
+    if( !_quads )
     {
         CCLOG("cocos2d: Particle system: not enough memory");
-        CC_SAFE_FREE(_quads);
-        CC_SAFE_FREE(_indices);
 
         return false;
     }
 
     memset(_quads, 0, _totalParticles * sizeof(V3F_C4B_T2F_Quad));
-    memset(_indices, 0, _totalParticles * 6 * sizeof(GLushort));
 
     return true;
 }
@@ -656,8 +552,7 @@ void ParticleSystemQuad::setBatchNode(ParticleBatchNode * batchNode)
         if( ! batchNode )
         {
             allocMemory();
-            initIndices();
-            setTexture(oldBatch->getTexture());
+                setTexture(oldBatch->getTexture());
             if (Configuration::getInstance()->supportsShareableVAO())
             {
                 setupVBOandVAO();
@@ -676,13 +571,12 @@ void ParticleSystemQuad::setBatchNode(ParticleBatchNode * batchNode)
             memcpy( quad, _quads, _totalParticles * sizeof(_quads[0]) );
 
             CC_SAFE_FREE(_quads);
-            CC_SAFE_FREE(_indices);
 
-            glDeleteBuffers(2, &_buffersVBO[0]);
+            GL::deleteBuffers(1, &_buffersVBO[0]);
             memset(_buffersVBO, 0, sizeof(_buffersVBO));
             if (Configuration::getInstance()->supportsShareableVAO())
             {
-                glDeleteVertexArrays(1, &_VAOname);
+                GL::deleteVAO(_VAOname);
                 GL::bindVAO(0);
                 _VAOname = 0;
             }
@@ -83,6 +83,13 @@ public:
      * @return An autoreleased ParticleSystemQuad object.
      */
     static ParticleSystemQuad * create(ValueMap &dictionary);
+    /** Creates a Particle Emitter configured like another one, without reading its plist file again.
+     *
+     * @param prototype The system to copy the configuration and the texture of, see ParticleCache.
+     * @return An autoreleased ParticleSystemQuad object.
+     * @since v3.11
+     */
+    static ParticleSystemQuad * createWithTemplate(const ParticleSystemQuad* prototype);
 
     /** Sets a new SpriteFrame as particle.
     WARNING: this method is experimental. Use setTextureWithRect instead.
@@ -142,6 +149,9 @@ public:
      */
     virtual void setTotalParticles(int tp) override;
 
+    /** Also copies the texture coordinates of `other` when it is a ParticleSystemQuad. */
+    virtual void copyConfiguration(const ParticleSystem* other) override;
+
     virtual std::string getDescription() const override;
 
 CC_CONSTRUCTOR_ACCESS:
@@ -162,10 +172,10 @@ CC_CONSTRUCTOR_ACCESS:
      */
     virtual bool initWithTotalParticles(int numberOfParticles) override;
 
-protected:
-    /** initializes the indices for the vertices*/
-    void initIndices();
+    /** Initializes a system configured like `prototype`. */
+    bool initWithTemplate(const ParticleSystemQuad* prototype);
 
+protected:
     /** initializes the texture with a rectangle measured Points */
     void initTexCoordsWithRect(const Rect& rect);
 
@@ -177,9 +187,8 @@ protected:
     bool allocMemory();
 
     V3F_C4B_T2F_Quad    *_quads;        // quads to be rendered
-    GLushort            *_indices;      // indices
     GLuint              _VAOname;
-    GLuint              _buffersVBO[2]; //0: vertex  1: indices
+    GLuint              _buffersVBO[1]; //0: vertex, the indices are in the shared QuadIndexBuffer
 
     QuadCommand _quadCommand;           // quad command
 
@@ -0,0 +1,530 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "2d/CCPrefab.h"
+#include "2d/CCLabel.h"
+#include "2d/CCLayer.h"
+#include "2d/CCSprite.h"
+#include "2d/CCSpriteFrameCache.h"
+#include "base/CCDirector.h"
+#include "base/CCNS.h"
+#include "base/ObjectFactory.h"
+#include "renderer/CCTextureCache.h"
+
+NS_CC_BEGIN
+
+// The header of the binary files, followed by the nodes, the offsets of the strings and their characters.
+// They are little endian like all the targets, the nodes are read in place when the file is aligned.
+struct PrefabHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t nodeCount;
+    uint32_t stringCount;
+    uint32_t stringBytes;
+};
+
+static const char PREFAB_MAGIC[4] = { 'C', 'P', 'F', 'B' };
+static const uint32_t PREFAB_VERSION = 1;
+
+static const Value* findValue(const ValueMap& dict, const char* key)
+{
+    auto iter = dict.find(key);
+    return iter != dict.end() ? &iter->second : nullptr;
+}
+
+static bool readFlag(const ValueMap& dict, const char* key, bool defaultValue)
+{
+    const Value* value = findValue(dict, key);
+    return value ? value->asBool() : defaultValue;
+}
+
+static uint32_t addString(const std::string& string, std::vector<std::string>& strings, std::unordered_map<std::string, uint32_t>& stringIndices)
+{
+    if (string.empty())
+        return 0;
+
+    auto iter = stringIndices.find(string);
+    if (iter != stringIndices.end())
+        return iter->second;
+
+    uint32_t index = (uint32_t)strings.size();
+    strings.push_back(string);
+    stringIndices.emplace(string, index);
+    return index;
+}
+
+Prefab* Prefab::create(const std::string& filename)
+{
+    Prefab *ret = new (std::nothrow) Prefab();
+    if (ret && ret->initWithFile(filename))
+    {
+        ret->autorelease();
+        return ret;
+    }
+
+    delete ret;
+    return nullptr;
+}
+
+Prefab* Prefab::createWithValueMap(const ValueMap& root)
+{
+    Prefab *ret = new (std::nothrow) Prefab();
+    if (ret && ret->initWithValueMap(root))
+    {
+        ret->autorelease();
+        return ret;
+    }
+
+    delete ret;
+    return nullptr;
+}
+
+Prefab::Prefab()
+: _nodes(nullptr)
+, _nodeCount(0)
+, _resolved(false)
+{
+}
+
+Prefab::~Prefab()
+{
+    for (auto atom : _nameAtoms)
+    {
+        Node::releaseNameAtom(atom);
+    }
+}
+
+bool Prefab::initWithFile(const std::string& filename)
+{
+    FileView file = FileUtils::getInstance()->getFileView(filename);
+    if (file.isNull())
+    {
+        CCLOG("cocos2d: Prefab: can not read %s", filename.c_str());
+        return false;
+    }
+
+    if (file.getSize() >= (ssize_t)sizeof(PrefabHeader) && memcmp(PREFAB_MAGIC, file.getBytes(), 4) == 0)
+    {
+        return initWithBinary(std::move(file), filename);
+    }
+
+    ValueMap root = FileUtils::getInstance()->getValueMapFromData((const char*)file.getBytes(), (int)file.getSize());
+    if (root.empty())
+    {
+        CCLOG("cocos2d: Prefab: %s is neither a prefab nor a plist", filename.c_str());
+        return false;
+    }
+    return initWithValueMap(root);
+}
+
+bool Prefab::initWithValueMap(const ValueMap& root)
+{
+    std::unordered_map<std::string, uint32_t> stringIndices;
+    _strings.assign(1, std::string());
+    _nodeStorage.clear();
+    addNode(root, -1, stringIndices);
+
+    _nodes = _nodeStorage.data();
+    _nodeCount = _nodeStorage.size();
+    return true;
+}
+
+void Prefab::addNode(const ValueMap& dict, int parent, std::unordered_map<std::string, uint32_t>& stringIndices)
+{
+    NodeDef def;
+    memset(&def, 0, sizeof(def));
+    def.parent = parent;
+    def.scaleX = def.scaleY = 1;
+    def.r = def.g = def.b = def.opacity = 255;
+
+    static const struct { const char* name; NodeType type; } types[] = {
+        { "Node", NodeType::NODE },
+        { "Sprite", NodeType::SPRITE },
+        { "Layer", NodeType::LAYER },
+        { "LayerColor", NodeType::LAYER_COLOR },
+        { "LabelBMFont", NodeType::LABEL_BMFONT },
+        { "LabelTTF", NodeType::LABEL_TTF },
+        { "LabelSystem", NodeType::LABEL_SYSTEM },
+    };
+    const Value* value = findValue(dict, "type");
+    std::string typeName = value ? value->asString() : "Node";
+    def.type = NodeType::CUSTOM;
+    for (const auto& type : types)
+    {
+        if (typeName == type.name)
+        {
+            def.type = type.type;
+            break;
+        }
+    }
+    if (def.type == NodeType::CUSTOM)
+        def.className = addString(typeName, _strings, stringIndices);
+
+    if ((value = findValue(dict, "name")))
+        def.name = addString(value->asString(), _strings, stringIndices);
+    if ((value = findValue(dict, "tag")))
+    {
+        def.tag = value->asInt();
+        def.flags |= FLAG_HAS_TAG;
+    }
+    if ((value = findValue(dict, "zOrder")))
+        def.zOrder = value->asInt();
+    if ((value = findValue(dict, "position")))
+    {
+        Vec2 position = PointFromString(value->asString());
+        def.x = position.x;
+        def.y = position.y;
+    }
+    if ((value = findValue(dict, "anchor")))
+    {
+        Vec2 anchor = PointFromString(value->asString());
+        def.anchorX = anchor.x;
+        def.anchorY = anchor.y;
+        def.flags |= FLAG_HAS_ANCHOR;
+    }
+    if ((value = findValue(dict, "size")))
+    {
+        Size size = SizeFromString(value->asString());
+        def.width = size.width;
+        def.height = size.height;
+        def.flags |= FLAG_HAS_SIZE;
+    }
+    if ((value = findValue(dict, "scale")))
+    {
+        Vec2 scale = PointFromString(value->asString());
+        def.scaleX = scale.x;
+        def.scaleY = scale.y;
+    }
+    if ((value = findValue(dict, "rotation")))
+        def.rotation = value->asFloat();
+    if ((value = findValue(dict, "color")))
+    {
+        int r = 255, g = 255, b = 255;
+        sscanf(value->asString().c_str(), "{%d,%d,%d}", &r, &g, &b);
+        def.r = (uint8_t)clampf(r, 0, 255);
+        def.g = (uint8_t)clampf(g, 0, 255);
+        def.b = (uint8_t)clampf(b, 0, 255);
+    }
+    if ((value = findValue(dict, "opacity")))
+        def.opacity = (uint8_t)clampf(value->asInt(), 0, 255);
+    if ((value = findValue(dict, "frame")))
+        def.frame = addString(value->asString(), _strings, stringIndices);
+    if ((value = findValue(dict, "file")))
+        def.file = addString(value->asString(), _strings, stringIndices);
+    if ((value = findValue(dict, "text")))
+        def.text = addString(value->asString(), _strings, stringIndices);
+    if ((value = findValue(dict, "fontSize")))
+        def.fontSize = value->asFloat();
+
+    if (readFlag(dict, "visible", true))
+        def.flags |= FLAG_VISIBLE;
+    if (readFlag(dict, "ignoreAnchor", false))
+        def.flags |= FLAG_IGNORE_ANCHOR;
+    if (readFlag(dict, "cascadeColor", false))
+        def.flags |= FLAG_CASCADE_COLOR;
+    if (readFlag(dict, "cascadeOpacity", false))
+        def.flags |= FLAG_CASCADE_OPACITY;
+    if (readFlag(dict, "flippedX", false))
+        def.flags |= FLAG_FLIPPED_X;
+    if (readFlag(dict, "flippedY", false))
+        def.flags |= FLAG_FLIPPED_Y;
+
+    int index = (int)_nodeStorage.size();
+    _nodeStorage.push_back(def);
+    if (parent >= 0)
+        _nodeStorage[parent].childCount++;
+
+    if ((value = findValue(dict, "children")) && value->getType() == Value::Type::VECTOR)
+    {
+        for (const auto& child : value->asValueVector())
+        {
+            if (child.getType() == Value::Type::MAP)
+                addNode(child.asValueMap(), index, stringIndices);
+        }
+    }
+}
+
+bool Prefab::initWithBinary(FileView&& file, const std::string& filename)
+{
+    PrefabHeader header;
+    memcpy(&header, file.getBytes(), sizeof(header));
+    size_t size = file.getSize();
+
+    size_t nodesOffset = sizeof(header);
+    size_t offsetsOffset = nodesOffset + (size_t)header.nodeCount * sizeof(NodeDef);
+    size_t charsOffset = offsetsOffset + ((size_t)header.stringCount + 1) * sizeof(uint32_t);
+    if (header.version != PREFAB_VERSION || header.stringCount == 0 || charsOffset + header.stringBytes > size)
+    {
+        CCLOG("cocos2d: Prefab: %s is an invalid prefab", filename.c_str());
+        return false;
+    }
+
+    const unsigned char* offsets = file.getBytes() + offsetsOffset;
+    const char* chars = (const char*)file.getBytes() + charsOffset;
+    _strings.resize(header.stringCount);
+    uint32_t start, end;
+    memcpy(&start, offsets, sizeof(start));
+    for (uint32_t i = 0; i < header.stringCount; ++i)
+    {
+        memcpy(&end, offsets + (i + 1) * sizeof(uint32_t), sizeof(end));
+        if (start > end || end > header.stringBytes)
+        {
+            CCLOG("cocos2d: Prefab: %s has invalid strings", filename.c_str());
+            return false;
+        }
+        _strings[i].assign(chars + start, end - start);
+        start = end;
+    }
+
+    const NodeDef* nodes;
+    if (((uintptr_t)file.getBytes() & 3) == 0)
+    {
+        nodes = (const NodeDef*)(file.getBytes() + nodesOffset);
+    }
+    else
+    {
+        _nodeStorage.resize(header.nodeCount);
+        memcpy(_nodeStorage.data(), file.getBytes() + nodesOffset, header.nodeCount * sizeof(NodeDef));
+        nodes = _nodeStorage.data();
+    }
+
+    // the parents come first and the strings are in the table, so instantiate() needs no checks
+    for (uint32_t i = 0; i < header.nodeCount; ++i)
+    {
+        const NodeDef& def = nodes[i];
+        bool validParent = i == 0 ? def.parent == -1 : def.parent >= 0 && (uint32_t)def.parent < i;
+        bool validStrings = def.name < header.stringCount && def.className < header.stringCount && def.frame < header.stringCount
+            && def.file < header.stringCount && def.text < header.stringCount;
+        if (!validParent || !validStrings || def.type > NodeType::CUSTOM)
+        {
+            CCLOG("cocos2d: Prefab: %s has an invalid node %u", filename.c_str(), i);
+            return false;
+        }
+    }
+
+    _nodes = nodes;
+    _nodeCount = header.nodeCount;
+    if (_nodeStorage.empty())
+        _file = std::move(file);
+    return true;
+}
+
+bool Prefab::saveToFile(const std::string& path) const
+{
+    PrefabHeader header;
+    memcpy(header.magic, PREFAB_MAGIC, 4);
+    header.version = PREFAB_VERSION;
+    header.nodeCount = (uint32_t)_nodeCount;
+    header.stringCount = (uint32_t)_strings.size();
+    header.stringBytes = 0;
+    for (const auto& string : _strings)
+        header.stringBytes += (uint32_t)string.size();
+
+    size_t offsetsOffset = sizeof(header) + _nodeCount * sizeof(NodeDef);
+    size_t charsOffset = offsetsOffset + (_strings.size() + 1) * sizeof(uint32_t);
+    size_t size = charsOffset + header.stringBytes;
+
+    unsigned char* bytes = (unsigned char*)malloc(size);
+    if (!bytes)
+        return false;
+    memcpy(bytes, &header, sizeof(header));
+    if (_nodeCount)
+        memcpy(bytes + sizeof(header), _nodes, _nodeCount * sizeof(NodeDef));
+    uint32_t offset = 0;
+    for (size_t i = 0; i <= _strings.size(); ++i)
+    {
+        memcpy(bytes + offsetsOffset + i * sizeof(uint32_t), &offset, sizeof(offset));
+        if (i < _strings.size())
+        {
+            memcpy(bytes + charsOffset + offset, _strings[i].data(), _strings[i].size());
+            offset += (uint32_t)_strings[i].size();
+        }
+    }
+
+    Data data;
+    data.fastSet(bytes, size);
+    return FileUtils::getInstance()->writeDataToFile(data, path);
+}
+
+void Prefab::resolve()
+{
+    auto fileUtils = FileUtils::getInstance();
+    auto textureCache = Director::getInstance()->getTextureCache();
+
+    _frameHandles.assign(_nodeCount, 0);
+    _nodeTextures.assign(_nodeCount, nullptr);
+    _nameAtoms.assign(_strings.size(), 0);
+    _fullPaths.assign(_strings.size(), std::string());
+
+    for (ssize_t i = 0; i < _nodeCount; ++i)
+    {
+        const NodeDef& def = _nodes[i];
+        if (def.name && !_nameAtoms[def.name])
+            _nameAtoms[def.name] = Node::internName(_strings[def.name]);
+
+        bool hasFontFile = def.type == NodeType::LABEL_BMFONT || def.type == NodeType::LABEL_TTF;
+        bool hasTexture = def.type == NodeType::SPRITE && !def.frame;
+        if (def.file && (hasFontFile || hasTexture) && _fullPaths[def.file].empty())
+            _fullPaths[def.file] = fileUtils->fullPathForFilename(_strings[def.file]);
+
+        if (def.type == NodeType::SPRITE && def.frame)
+        {
+            _frameHandles[i] = SpriteFrameCache::getSpriteFrameHandle(_strings[def.frame]);
+        }
+        else if (hasTexture && def.file)
+        {
+            Texture2D* texture = textureCache->addImage(_fullPaths[def.file]);
+            if (texture && !_textures.contains(texture))
+                _textures.pushBack(texture);
+            _nodeTextures[i] = texture;
+        }
+    }
+    _resolved = true;
+}
+
+Node* Prefab::createNode(const NodeDef& def, size_t index)
+{
+    Node* node = nullptr;
+    switch (def.type)
+    {
+        case NodeType::SPRITE:
+        {
+            Sprite* sprite = nullptr;
+            if (def.frame)
+            {
+                SpriteFrame* frame = SpriteFrameCache::getInstance()->getSpriteFrameByHandle(_frameHandles[index]);
+                if (frame)
+                    sprite = Sprite::createWithSpriteFrame(frame);
+                else
+                    CCLOG("cocos2d: Prefab: the sprite frame %s isn't in the SpriteFrameCache", _strings[def.frame].c_str());
+            }
+            else if (_nodeTextures[index])
+            {
+                sprite = Sprite::createWithTexture(_nodeTextures[index]);
+            }
+            if (!sprite)
+                sprite = Sprite::create();
+            sprite->setFlippedX((def.flags & FLAG_FLIPPED_X) != 0);
+            sprite->setFlippedY((def.flags & FLAG_FLIPPED_Y) != 0);
+            node = sprite;
+            break;
+        }
+        case NodeType::LAYER:
+            node = Layer::create();
+            break;
+        case NodeType::LAYER_COLOR:
+            node = LayerColor::create(Color4B(def.r, def.g, def.b, def.opacity));
+            break;
+        case NodeType::LABEL_BMFONT:
+            node = Label::createWithBMFont(_fullPaths[def.file], _strings[def.text]);
+            break;
+        case NodeType::LABEL_TTF:
+            node = Label::createWithTTF(_strings[def.text], _fullPaths[def.file], def.fontSize);
+            break;
+        case NodeType::LABEL_SYSTEM:
+            node = Label::createWithSystemFont(_strings[def.text], _strings[def.file], def.fontSize);
+            break;
+        case NodeType::CUSTOM:
+        {
+            Ref* object = ObjectFactory::getInstance()->createObject(_strings[def.className]);
+            node = dynamic_cast<Node*>(object);
+            if (!node)
+                CCLOG("cocos2d: Prefab: %s isn't a Node class of ObjectFactory", _strings[def.className].c_str());
+            break;
+        }
+        default:
+            break;
+    }
+    if (!node)
+        node = Node::create();
+
+    if (def.name)
+        node->setNameAtom(_nameAtoms[def.name]);
+    node->setPosition(def.x, def.y);
+    if (def.flags & FLAG_HAS_ANCHOR)
+        node->setAnchorPoint(Vec2(def.anchorX, def.anchorY));
+    if (def.flags & FLAG_HAS_SIZE)
+    {
+        bool isLabel = def.type == NodeType::LABEL_BMFONT || def.type == NodeType::LABEL_TTF || def.type == NodeType::LABEL_SYSTEM;
+        if (isLabel)
+            static_cast<Label*>(node)->setDimensions(def.width, def.height);
+        else
+            node->setContentSize(Size(def.width, def.height));
+    }
+    if (def.scaleX != 1 || def.scaleY != 1)
+    {
+        node->setScaleX(def.scaleX);
+        node->setScaleY(def.scaleY);
+    }
+    if (def.rotation != 0)
+        node->setRotation(def.rotation);
+    if (def.r != 255 || def.g != 255 || def.b != 255)
+        node->setColor(Color3B(def.r, def.g, def.b));
+    if (def.opacity != 255)
+        node->setOpacity(def.opacity);
+    if (!(def.flags & FLAG_VISIBLE))
+        node->setVisible(false);
+    if (def.flags & FLAG_IGNORE_ANCHOR)
+        node->ignoreAnchorPointForPosition(true);
+    if (def.flags & FLAG_CASCADE_COLOR)
+        node->setCascadeColorEnabled(true);
+    if (def.flags & FLAG_CASCADE_OPACITY)
+        node->setCascadeOpacityEnabled(true);
+    return node;
+}
+
+Node* Prefab::instantiate()
+{
+    if (_nodeCount == 0)
+        return nullptr;
+    if (!_resolved)
+        resolve();
+
+    // the nodes stay autoreleased until they are added, the parents always come first
+    std::vector<Node*> nodes(_nodeCount);
+    for (ssize_t i = 0; i < _nodeCount; ++i)
+    {
+        const NodeDef& def = _nodes[i];
+        Node* node = createNode(def, i);
+        if (def.childCount)
+            node->reserveChildren(def.childCount);
+
+        int tag = (def.flags & FLAG_HAS_TAG) ? def.tag : Node::INVALID_TAG;
+        if (def.parent >= 0)
+        {
+            nodes[def.parent]->addChild(node, def.zOrder, tag);
+        }
+        else
+        {
+            node->setLocalZOrder(def.zOrder);
+            node->setTag(tag);
+        }
+        nodes[i] = node;
+    }
+    return nodes[0];
+}
+
+NS_CC_END
@@ -0,0 +1,190 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CCPREFAB_H__
+#define __CCPREFAB_H__
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "base/CCRef.h"
+#include "base/CCValue.h"
+#include "base/CCVector.h"
+#include "platform/CCFileUtils.h"
+
+NS_CC_BEGIN
+
+class Node;
+class Texture2D;
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/**
+ A Prefab describes a tree of nodes, and instantiate() creates a copy of the tree in one pass.
+
+ The prefabs are read from compact binary files, made with saveToFile(), or from plist dictionaries for the authoring.
+ A dictionary describes a node and its "children" array:
+
+     <key>type</key>     <string>Sprite</string>      Node, Sprite, Layer, LayerColor, LabelBMFont, LabelTTF, LabelSystem,
+                                                      or the name of a class registered in ObjectFactory
+     <key>name</key>     <string>close</string>
+     <key>tag</key>      <integer>3</integer>
+     <key>zOrder</key>   <integer>1</integer>
+     <key>position</key> <string>{120,40}</string>
+     <key>anchor</key>   <string>{0.5,0.5}</string>
+     <key>size</key>     <string>{64,64}</string>
+     <key>scale</key>    <string>{1,1}</string>
+     <key>rotation</key> <real>0</real>
+     <key>color</key>    <string>{255,255,255}</string>
+     <key>opacity</key>  <integer>255</integer>
+     <key>visible</key>  <true/>
+     <key>frame</key>    <string>button_close.png</string>  the sprite frame of a Sprite
+     <key>file</key>     <string>fonts/title.fnt</string>   the texture of a Sprite, the font of a label
+     <key>text</key>     <string>Settings</string>
+     <key>fontSize</key> <real>24</real>
+
+ and the booleans flippedX, flippedY, ignoreAnchor, cascadeColor and cascadeOpacity.
+
+ The sprite frame names are turned into SpriteFrameCache handles, the node names into atoms and the files into full
+ paths by the first instantiate(), the next ones don't look them up again. The children storage of each node is
+ reserved at once, and the nodes are added to their parents before the root is, so nothing is entered twice.
+ @since v3.11
+ @js NA
+ */
+class CC_DLL Prefab : public Ref
+{
+public:
+    /** The kinds of nodes of a prefab. */
+    enum class NodeType : uint16_t
+    {
+        NODE,
+        SPRITE,
+        LAYER,
+        LAYER_COLOR,
+        LABEL_BMFONT,
+        LABEL_TTF,
+        LABEL_SYSTEM,
+        /** A class registered in ObjectFactory. */
+        CUSTOM,
+    };
+
+    /** Creates a prefab from a binary file, or from a plist file. */
+    static Prefab* create(const std::string& filename);
+    /** Creates a prefab from the dictionary of its root node. */
+    static Prefab* createWithValueMap(const ValueMap& root);
+
+    /**
+     Creates a copy of the node tree, must be called on the main thread.
+     @return The autoreleased root node, nullptr if the prefab is empty.
+     */
+    Node* instantiate();
+
+    /** Writes the prefab in the binary format. */
+    bool saveToFile(const std::string& path) const;
+
+    /** The number of nodes of the tree. */
+    ssize_t getNodeCount() const { return _nodeCount; }
+
+    /// @cond DO_NOT_SHOW
+    // A node of the tree, the nodes are stored depth first so a parent comes before its children.
+    // The strings are indices in the string table, 0 is the empty string.
+    struct NodeDef
+    {
+        int32_t parent;
+        NodeType type;
+        uint16_t flags;
+        uint32_t childCount;
+        float x, y;
+        float anchorX, anchorY;
+        float width, height;
+        float scaleX, scaleY;
+        float rotation;
+        float fontSize;
+        int32_t zOrder;
+        int32_t tag;
+        uint8_t r, g, b, opacity;
+        uint32_t name;
+        uint32_t className;
+        uint32_t frame;
+        uint32_t file;
+        uint32_t text;
+    };
+
+    enum NodeFlags
+    {
+        FLAG_VISIBLE = 1 << 0,
+        FLAG_HAS_ANCHOR = 1 << 1,
+        FLAG_HAS_SIZE = 1 << 2,
+        FLAG_HAS_TAG = 1 << 3,
+        FLAG_IGNORE_ANCHOR = 1 << 4,
+        FLAG_CASCADE_COLOR = 1 << 5,
+        FLAG_CASCADE_OPACITY = 1 << 6,
+        FLAG_FLIPPED_X = 1 << 7,
+        FLAG_FLIPPED_Y = 1 << 8,
+    };
+    /// @endcond
+
+CC_CONSTRUCTOR_ACCESS:
+    Prefab();
+    virtual ~Prefab();
+
+    bool initWithFile(const std::string& filename);
+    bool initWithValueMap(const ValueMap& root);
+
+protected:
+    bool initWithBinary(FileView&& file, const std::string& filename);
+    // appends the node of a dictionary and its children, depth first
+    void addNode(const ValueMap& dict, int parent, std::unordered_map<std::string, uint32_t>& stringIndices);
+    // looks the handles, atoms and full paths up, once
+    void resolve();
+    Node* createNode(const NodeDef& def, size_t index);
+
+    const NodeDef* _nodes;
+    ssize_t _nodeCount;
+    std::vector<NodeDef> _nodeStorage;
+    // the binary file the nodes are read from in place
+    FileView _file;
+    std::vector<std::string> _strings;
+
+    bool _resolved;
+    // by node: the sprite frame handle of the sprites
+    std::vector<unsigned int> _frameHandles;
+    // by string: the atom of the names, held by the prefab, the full path of the files
+    std::vector<unsigned int> _nameAtoms;
+    std::vector<std::string> _fullPaths;
+    // the textures of the sprites without a frame, kept while the prefab is alive
+    Vector<Texture2D*> _textures;
+    std::vector<Texture2D*> _nodeTextures;
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif // __CCPREFAB_H__
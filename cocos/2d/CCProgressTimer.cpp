@@ -30,8 +30,8 @@ THE SOFTWARE.
 #include "base/ccMacros.h"
 #include "base/CCDirector.h"
 #include "2d/CCSprite.h"
-#include "renderer/ccGLStateCache.h"
 #include "renderer/CCRenderer.h"
+#include "renderer/CCGLProgramState.h"
 
 NS_CC_BEGIN
 
@@ -39,6 +39,11 @@ NS_CC_BEGIN
 //  kProgressTextureCoords holds points {0,1} {0,0} {1,0} {1,1} we can represent it as bits
 const char kProgressTextureCoords = 0x4b;
 
+// the triangles of the fan of the radial type, for up to 7 vertices
+static unsigned short radialIndices[] = {0,1,2, 0,2,3, 0,3,4, 0,4,5, 0,5,6};
+// the triangles of the strips of the bar type, the reverse direction has two
+static unsigned short barIndices[] = {0,1,2, 2,1,3, 4,5,6, 6,5,7};
+
 
 ProgressTimer::ProgressTimer()
 :_type(Type::RADIAL)
@@ -81,7 +86,7 @@ bool ProgressTimer::initWithSprite(Sprite* sp)
     setSprite(sp);
 
     // shader state
-    setGLProgramState(GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR));
+    setGLProgramState(GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP));
     return true;
 }
 
@@ -167,9 +172,9 @@ Tex2F ProgressTimer::textureCoordFromAlphaPoint(Vec2 alpha)
     return Tex2F(min.x * (1.f - alpha.x) + max.x * alpha.x, min.y * (1.f - alpha.y) + max.y * alpha.y);
 }
 
-Vec2 ProgressTimer::vertexFromAlphaPoint(Vec2 alpha)
+Vec3 ProgressTimer::vertexFromAlphaPoint(Vec2 alpha)
 {
-    Vec2 ret(0.0f, 0.0f);
+    Vec3 ret(0.0f, 0.0f, 0.0f);
     if (!_sprite) {
         return ret;
     }
@@ -353,7 +358,7 @@ void ProgressTimer::updateRadial()
 
     if(!_vertexData) {
         _vertexDataCount = index + 3;
-        _vertexData = (V2F_C4B_T2F*)malloc(_vertexDataCount * sizeof(V2F_C4B_T2F));
+        _vertexData = (V3F_C4B_T2F*)malloc(_vertexDataCount * sizeof(V3F_C4B_T2F));
         CCASSERT( _vertexData, "CCProgressTimer. Not enough memory");
     }
     updateColor();
@@ -424,7 +429,7 @@ void ProgressTimer::updateBar()
     if (!_reverseDirection) {
         if(!_vertexData) {
             _vertexDataCount = 4;
-            _vertexData = (V2F_C4B_T2F*)malloc(_vertexDataCount * sizeof(V2F_C4B_T2F));
+            _vertexData = (V3F_C4B_T2F*)malloc(_vertexDataCount * sizeof(V3F_C4B_T2F));
             CCASSERT( _vertexData, "CCProgressTimer. Not enough memory");
         }
         //    TOPLEFT
@@ -445,7 +450,7 @@ void ProgressTimer::updateBar()
     } else {
         if(!_vertexData) {
             _vertexDataCount = 8;
-            _vertexData = (V2F_C4B_T2F*)malloc(_vertexDataCount * sizeof(V2F_C4B_T2F));
+            _vertexData = (V3F_C4B_T2F*)malloc(_vertexDataCount * sizeof(V3F_C4B_T2F));
             CCASSERT( _vertexData, "CCProgressTimer. Not enough memory");
             //    TOPLEFT 1
             _vertexData[0].texCoords = textureCoordFromAlphaPoint(Vec2(0,1));
@@ -495,55 +500,29 @@ Vec2 ProgressTimer::boundaryTexCoord(char index)
     return Vec2::ZERO;
 }
 
-void ProgressTimer::onDraw(const Mat4 &transform, uint32_t flags)
+void ProgressTimer::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
 {
-    if (_sprite == nullptr ||  _sprite->getTexture() == nullptr) {
+    if( ! _vertexData || ! _sprite || ! _sprite->getTexture())
         return;
-    }
-
-    getGLProgram()->use();
-    getGLProgram()->setUniformsForBuiltins(transform);
-
-    GL::blendFunc( _sprite->getBlendFunc().src, _sprite->getBlendFunc().dst );
 
-    GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX );
-
-    GL::bindTexture2D( _sprite->getTexture()->getName() );
-
-    glVertexAttribPointer( GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, sizeof(_vertexData[0]) , &_vertexData[0].vertices);
-    glVertexAttribPointer( GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(_vertexData[0]), &_vertexData[0].texCoords);
-    glVertexAttribPointer( GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(_vertexData[0]), &_vertexData[0].colors);
-
-    if(_type == Type::RADIAL)
+    TrianglesCommand::Triangles triangles;
+    triangles.verts = _vertexData;
+    triangles.vertCount = _vertexDataCount;
+    if (_type == Type::RADIAL)
     {
-        glDrawArrays(GL_TRIANGLE_FAN, 0, _vertexDataCount);
-        CC_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(1,_vertexDataCount);
+        // the fan of the midpoint
+        triangles.indices = radialIndices;
+        triangles.indexCount = (_vertexDataCount - 2) * 3;
     }
-    else if (_type == Type::BAR)
+    else
     {
-        if (!_reverseDirection)
-        {
-            glDrawArrays(GL_TRIANGLE_STRIP, 0, _vertexDataCount);
-            CC_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(1,_vertexDataCount);
-        }
-        else
-        {
-            glDrawArrays(GL_TRIANGLE_STRIP, 0, _vertexDataCount/2);
-            glDrawArrays(GL_TRIANGLE_STRIP, 4, _vertexDataCount/2);
-            // 2 draw calls
-            CC_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(2,_vertexDataCount);
-        }
+        // a strip of 4 vertices, or 2 in the reverse direction
+        triangles.indices = barIndices;
+        triangles.indexCount = (_vertexDataCount / 4) * 6;
     }
-}
-
-void ProgressTimer::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
-{
-    if( ! _vertexData || ! _sprite)
-        return;
 
-    _customCommand.init(_globalZOrder, transform, flags);
-    _customCommand.func = CC_CALLBACK_0(ProgressTimer::onDraw, this, transform, flags);
-    renderer->addCommand(&_customCommand);
+    _trianglesCommand.init(_globalZOrder, _sprite->getTexture()->getName(), getGLProgramState(), _sprite->getBlendFunc(), triangles, transform, flags);
+    renderer->addCommand(&_trianglesCommand);
 }
 
 
@@ -26,7 +26,7 @@ THE SOFTWARE.
 #ifndef __MISC_NODE_CCPROGRESS_TIMER_H__
 #define __MISC_NODE_CCPROGRESS_TIMER_H__
 
-#include "renderer/CCCustomCommand.h"
+#include "renderer/CCTrianglesCommand.h"
 #include "2d/CCNode.h"
 
 NS_CC_BEGIN
@@ -42,6 +42,8 @@ class Sprite;
   * @brief ProgressTimer is a subclass of Node.
   * It renders the inner sprite according to the percentage.
   * The progress can be Radial, Horizontal or vertical.
+  * It is drawn with a TrianglesCommand using the texture and the blend function of the sprite, so it is batched with
+  * the sprites of the same texture around it.
   * @since v0.99.1
   */
 class CC_DLL ProgressTimer : public Node
@@ -175,10 +177,8 @@ CC_CONSTRUCTOR_ACCESS:
     bool initWithSprite(Sprite* sp);
 
 protected:
-    void onDraw(const Mat4 &transform, uint32_t flags);
-
     Tex2F textureCoordFromAlphaPoint(Vec2 alpha);
-    Vec2 vertexFromAlphaPoint(Vec2 alpha);
+    Vec3 vertexFromAlphaPoint(Vec2 alpha);
     void updateProgress();
     void updateBar();
     void updateRadial();
@@ -191,9 +191,9 @@ protected:
     float _percentage;
     Sprite *_sprite;
     int _vertexDataCount;
-    V2F_C4B_T2F *_vertexData;
+    V3F_C4B_T2F *_vertexData;
 
-    CustomCommand _customCommand;
+    TrianglesCommand _trianglesCommand;
 
     bool _reverseDirection;
 
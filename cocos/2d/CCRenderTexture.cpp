@@ -33,14 +33,65 @@ THE SOFTWARE.
 #include "base/CCDirector.h"
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventDispatcher.h"
+#include "base/CCAsyncTaskPool.h"
+#include "base/CCScheduler.h"
 #include "renderer/CCRenderer.h"
+#include "renderer/CCRenderTargetPool.h"
 #include "renderer/CCTextureCache.h"
+#include "renderer/ccGLStateCache.h"
 
 NS_CC_BEGIN
 
+// the frames a pixel buffer is left to the GPU before it is mapped, when there is no fence to poll
+static const unsigned int READBACK_FRAMES = 2;
+
+struct RenderTexture::Readback
+{
+    std::function<void (Image*)> callback;
+    int width;
+    int height;
+    bool flipImage;
+    // set by saveToFile, the image is written and deleted on the worker thread
+    std::string filename;
+    bool isRGBA;
+
+    // issues the glReadPixels after the commands queued before it
+    CustomCommand startCommand;
+    bool started;
+    unsigned int frames;
+    GLuint pbo;
+#if CC_GL_SYNC_OBJECTS
+    GLsync fence;
+#endif
+    GLubyte* pixels;
+    Image* image;
+
+    Readback()
+    : width(0)
+    , height(0)
+    , flipImage(true)
+    , isRGBA(true)
+    , started(false)
+    , frames(0)
+    , pbo(0)
+#if CC_GL_SYNC_OBJECTS
+    , fence(nullptr)
+#endif
+    , pixels(nullptr)
+    , image(nullptr)
+    {
+    }
+
+    ~Readback()
+    {
+        CC_SAFE_DELETE_ARRAY(pixels);
+    }
+};
+
 // implementation RenderTexture
 RenderTexture::RenderTexture()
 : _keepMatrix(false)
+, _wasCullingEnabled(true)
 , _rtTextureRect(Rect::ZERO)
 , _fullRect(Rect::ZERO)
 , _fullviewPort(Rect::ZERO)
@@ -57,8 +108,9 @@ RenderTexture::RenderTexture()
 , _clearDepth(0.0f)
 , _clearStencil(0)
 , _autoDraw(false)
+, _depthStencilDiscarded(false)
 , _sprite(nullptr)
-, _saveFileCallback(nullptr)
+, _readbackFrame((unsigned int)-1)
 {
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     // Listen this event to save render texture before come to background.
@@ -73,6 +125,9 @@ RenderTexture::RenderTexture()
 
 RenderTexture::~RenderTexture()
 {
+    // every readback retains the RenderTexture, only the polling is left
+    _director->getScheduler()->unschedule("RenderTexture::readback", &_readbacks);
+
     CC_SAFE_RELEASE(_sprite);
     CC_SAFE_RELEASE(_textureCopy);
 
@@ -224,6 +279,7 @@ bool RenderTexture::initWithWidthAndHeight(int w, int h, Texture2D::PixelFormat
         if (_texture)
         {
             _texture->initWithData(data, dataLen, (Texture2D::PixelFormat)_pixelFormat, powW, powH, Size((float)w, (float)h));
+            _texture->setOwner("RenderTexture");
         }
         else
         {
@@ -238,6 +294,7 @@ bool RenderTexture::initWithWidthAndHeight(int w, int h, Texture2D::PixelFormat
             if (_textureCopy)
             {
                 _textureCopy->initWithData(data, dataLen, (Texture2D::PixelFormat)_pixelFormat, powW, powH, Size((float)w, (float)h));
+                _textureCopy->setOwner("RenderTexture");
             }
             else
             {
@@ -437,6 +494,7 @@ void RenderTexture::visit(Renderer *renderer, const Mat4 &parentTransform, uint3
     _director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, _modelViewTransform);
 
     _sprite->visit(renderer, _modelViewTransform, flags);
+    Renderer::setDebugOwner(this);
     draw(renderer, _modelViewTransform, flags);
 
     _director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
@@ -470,28 +528,262 @@ bool RenderTexture::saveToFile(const std::string& fileName, Image::Format format
              "the image can only be saved as JPG or PNG format");
     if (isRGBA && format == Image::Format::JPG) CCLOG("RGBA is not supported for JPG format");
 
-    _saveFileCallback = callback;
-
     std::string fullpath = FileUtils::getInstance()->getWritablePath() + fileName;
-    _saveToFileCommand.init(_globalZOrder);
-    _saveToFileCommand.func = CC_CALLBACK_0(RenderTexture::onSaveToFile, this, fullpath, isRGBA);
 
-    _director->getRenderer()->addCommand(&_saveToFileCommand);
+    auto readback = new (std::nothrow) Readback();
+    if (nullptr == readback)
+    {
+        return false;
+    }
+    readback->filename = fullpath;
+    readback->isRGBA = isRGBA;
+    readback->callback = [this, callback, fullpath](Image* /*image*/)
+    {
+        if (callback)
+        {
+            callback(this, fullpath);
+        }
+    };
+    addReadback(readback);
     return true;
 }
 
-void RenderTexture::onSaveToFile(const std::string& filename, bool isRGBA)
+void RenderTexture::newImageAsync(const std::function<void (Image*)>& callback, bool flipImage)
+{
+    CCASSERT(_pixelFormat == Texture2D::PixelFormat::RGBA8888, "only RGBA8888 can be saved as image");
+
+    auto readback = new (std::nothrow) Readback();
+    if (nullptr == readback)
+    {
+        if (callback)
+        {
+            callback(nullptr);
+        }
+        return;
+    }
+    readback->callback = callback;
+    readback->flipImage = flipImage;
+    addReadback(readback);
+}
+
+void RenderTexture::addReadback(Readback* readback)
+{
+    if (nullptr == _texture)
+    {
+        if (readback->callback)
+        {
+            readback->callback(nullptr);
+        }
+        delete readback;
+        return;
+    }
+
+    const Size& s = _texture->getContentSizeInPixels();
+    readback->width = (int)s.width;
+    readback->height = (int)s.height;
+
+    // released on the main thread, once the callback was called
+    retain();
+    _readbacks.push_back(readback);
+
+    readback->startCommand.init(_globalZOrder);
+    readback->startCommand.func = CC_CALLBACK_0(RenderTexture::startReadback, this, readback);
+    _director->getRenderer()->addCommand(&readback->startCommand);
+
+    // not the RenderTexture itself as target, it would pause the polling when it leaves the scene
+    auto scheduler = _director->getScheduler();
+    if (!scheduler->isScheduled("RenderTexture::readback", &_readbacks))
+    {
+        scheduler->schedule([this](float /*dt*/) { queueReadbackCommand(); }, &_readbacks, 0, false, "RenderTexture::readback");
+    }
+}
+
+void RenderTexture::queueReadbackCommand()
+{
+    if (_readbacks.empty())
+    {
+        _director->getScheduler()->unschedule("RenderTexture::readback", &_readbacks);
+        return;
+    }
+
+    // the scheduler may run twice in a frame
+    if (_readbackFrame == _director->getTotalFrames())
+    {
+        return;
+    }
+    _readbackFrame = _director->getTotalFrames();
+
+    _readbackCommand.init(_globalZOrder);
+    _readbackCommand.func = CC_CALLBACK_0(RenderTexture::onReadback, this);
+    _director->getRenderer()->addCommand(&_readbackCommand);
+}
+
+void RenderTexture::bindFramebufferForReading()
+{
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &_oldFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, _FBO);
+
+    // TODO: move this to configuration, so we don't check it every time
+    /*  Certain Qualcomm Andreno gpu's will retain data in memory after a frame buffer switch which corrupts the render to the texture. The solution is to clear the frame buffer before rendering to the texture. However, calling glClear has the unintended result of clearing the current texture. Create a temporary texture to overcome this. At the end of RenderTexture::begin(), switch the attached texture to the second one, call glClear, and then switch back to the original texture. This solution is unnecessary for other devices as they don't have the same issue with switching frame buffers.
+     */
+    if (Configuration::getInstance()->checkForGLExtension("GL_QCOM"))
+    {
+        // -- bind a temporary texture so we can clear the render buffer without losing our texture
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _textureCopy->getName(), 0);
+        CHECK_GL_ERROR_DEBUG();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _texture->getName(), 0);
+    }
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+}
+
+void RenderTexture::startReadback(Readback* readback)
+{
+    GLsizeiptr size = readback->width * readback->height * 4;
+
+    bindFramebufferForReading();
+#if CC_GL_PIXEL_BUFFER
+    if (Configuration::getInstance()->supportsPixelBufferObject())
+    {
+        // glReadPixels only queues the copy, the buffer is mapped once the GPU has written it
+        glGenBuffers(1, &readback->pbo);
+        GL::bindBuffer(GL_PIXEL_PACK_BUFFER, readback->pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        glReadPixels(0, 0, readback->width, readback->height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        GL::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+#if CC_GL_SYNC_OBJECTS
+        if (Configuration::getInstance()->supportsSyncObjects())
+        {
+            readback->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
+#endif
+    }
+    else
+#endif
+    {
+        readback->pixels = new (std::nothrow) GLubyte[size];
+        if (readback->pixels)
+        {
+            glReadPixels(0, 0, readback->width, readback->height, GL_RGBA, GL_UNSIGNED_BYTE, readback->pixels);
+        }
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, _oldFBO);
+
+    readback->started = true;
+}
+
+bool RenderTexture::isReadbackReady(Readback* readback)
 {
-    Image *image = newImage(true);
-    if (image)
+    if (0 == readback->pbo)
     {
-        image->saveToFile(filename, !isRGBA);
+        // read synchronously
+        return true;
+    }
+#if CC_GL_SYNC_OBJECTS
+    if (readback->fence)
+    {
+        return glClientWaitSync(readback->fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0) != GL_TIMEOUT_EXPIRED;
+    }
+#endif
+    return ++readback->frames > READBACK_FRAMES;
+}
+
+void RenderTexture::onReadback()
+{
+    for (auto iter = _readbacks.begin(); iter != _readbacks.end();)
+    {
+        auto readback = *iter;
+        if (readback->started && isReadbackReady(readback))
+        {
+            iter = _readbacks.erase(iter);
+            finishReadback(readback);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
+
+void RenderTexture::finishReadback(Readback* readback)
+{
+#if CC_GL_PIXEL_BUFFER
+    if (readback->pbo)
+    {
+        GLsizeiptr size = readback->width * readback->height * 4;
+
+        GL::bindBuffer(GL_PIXEL_PACK_BUFFER, readback->pbo);
+        void* mapped = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+        if (mapped)
+        {
+            // copied out so the buffer is unmapped before the worker gets the pixels
+            readback->pixels = new (std::nothrow) GLubyte[size];
+            if (readback->pixels)
+            {
+                memcpy(readback->pixels, mapped, size);
+            }
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        GL::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        GL::deleteBuffers(1, &readback->pbo);
+        readback->pbo = 0;
     }
-    if(_saveFileCallback)
+#if CC_GL_SYNC_OBJECTS
+    if (readback->fence)
     {
-        _saveFileCallback(this, filename);
+        glDeleteSync(readback->fence);
+        readback->fence = nullptr;
     }
-    CC_SAFE_DELETE(image);
+#endif
+#endif
+
+    std::function<void(void*)> mainThread = [this, readback](void* /*param*/)
+    {
+        if (readback->callback)
+        {
+            readback->callback(readback->image);
+        }
+        else
+        {
+            CC_SAFE_DELETE(readback->image);
+        }
+        delete readback;
+        release();
+    };
+
+    // the flip and the encoding don't need the GL context
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO, mainThread, nullptr, [readback]()
+    {
+        if (nullptr == readback->pixels)
+        {
+            return;
+        }
+
+        int rowSize = readback->width * 4;
+        if (readback->flipImage)
+        {
+            // #640 the image read from rendertexture is dirty
+            for (int top = 0, bottom = readback->height - 1; top < bottom; ++top, --bottom)
+            {
+                std::swap_ranges(readback->pixels + top * rowSize, readback->pixels + (top + 1) * rowSize, readback->pixels + bottom * rowSize);
+            }
+        }
+
+        readback->image = new (std::nothrow) Image();
+        if (readback->image && readback->image->initWithRawData(readback->pixels, rowSize * readback->height, readback->width, readback->height, 8))
+        {
+            if (!readback->filename.empty())
+            {
+                readback->image->saveToFile(readback->filename, !readback->isRGBA);
+                CC_SAFE_DELETE(readback->image);
+            }
+        }
+        else
+        {
+            CC_SAFE_DELETE(readback->image);
+        }
+        CC_SAFE_DELETE_ARRAY(readback->pixels);
+    });
 }
 
 /* get buffer as Image */
@@ -527,21 +819,7 @@ Image* RenderTexture::newImage(bool fliimage)
             break;
         }
 
-        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &_oldFBO);
-        glBindFramebuffer(GL_FRAMEBUFFER, _FBO);
-
-        // TODO: move this to configuration, so we don't check it every time
-        /*  Certain Qualcomm Andreno gpu's will retain data in memory after a frame buffer switch which corrupts the render to the texture. The solution is to clear the frame buffer before rendering to the texture. However, calling glClear has the unintended result of clearing the current texture. Create a temporary texture to overcome this. At the end of RenderTexture::begin(), switch the attached texture to the second one, call glClear, and then switch back to the original texture. This solution is unnecessary for other devices as they don't have the same issue with switching frame buffers.
-         */
-        if (Configuration::getInstance()->checkForGLExtension("GL_QCOM"))
-        {
-            // -- bind a temporary texture so we can clear the render buffer without losing our texture
-            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _textureCopy->getName(), 0);
-            CHECK_GL_ERROR_DEBUG();
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _texture->getName(), 0);
-        }
-        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        bindFramebufferForReading();
         glReadPixels(0,0,savedBufferWidth, savedBufferHeight,GL_RGBA,GL_UNSIGNED_BYTE, tempData);
         glBindFramebuffer(GL_FRAMEBUFFER, _oldFBO);
 
@@ -604,7 +882,7 @@ void RenderTexture::onBegin()
         viewport.origin.x = (_fullRect.origin.x - _rtTextureRect.origin.x) * viewPortRectWidthRatio;
         viewport.origin.y = (_fullRect.origin.y - _rtTextureRect.origin.y) * viewPortRectHeightRatio;
         //glViewport(_fullviewPort.origin.x, _fullviewPort.origin.y, (GLsizei)_fullviewPort.size.width, (GLsizei)_fullviewPort.size.height);
-        glViewport(viewport.origin.x, viewport.origin.y, (GLsizei)viewport.size.width, (GLsizei)viewport.size.height);
+        GL::viewport(viewport.origin.x, viewport.origin.y, (GLsizei)viewport.size.width, (GLsizei)viewport.size.height);
     }
 
     // Adjust the orthographic projection and viewport
@@ -627,6 +905,10 @@ void RenderTexture::onBegin()
 
 void RenderTexture::onEnd()
 {
+    if (_depthStencilDiscarded && _depthRenderBufffer)
+    {
+        RenderTargetPool::discard(false, true);
+    }
     glBindFramebuffer(GL_FRAMEBUFFER, _oldFBO);
 
     // restore viewport
@@ -730,6 +1012,9 @@ void RenderTexture::begin()
     director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
     _transformMatrix = director->getMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
 
+    _wasCullingEnabled = director->isCullingEnabled();
+    director->setCullingEnabled(false);
+
     if(!_keepMatrix)
     {
         director->setProjection(director->getProjection());
@@ -773,6 +1058,8 @@ void RenderTexture::end()
 
     director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION);
     director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+
+    director->setCullingEnabled(_wasCullingEnabled);
 }
 
 NS_CC_END
@@ -151,8 +151,20 @@ public:
      */
     Image* newImage(bool flipImage = true);
 
+    /** Reads the texture's data back without stalling the GPU and creates an Image from it.
+     * The pixels are read after the commands already queued in this frame. On desktop GL they go
+     * through a pixel buffer object which is mapped a few frames later, once the GPU is done with it;
+     * GLES2 has no such buffer and reads them synchronously. The flip and the Image are done on a worker thread.
+     *
+     * @param callback Called on the main thread with the image, nullptr if the read failed. It owns the image and releases it by calling delete.
+     * @param flipImage Whether or not to flip image.
+     * @js NA
+     */
+    void newImageAsync(const std::function<void (Image*)>& callback, bool flipImage = true);
+
     /** Saves the texture into a file using JPEG format. The file will be saved in the Documents folder.
      * Returns true if the operation is successful.
+     * The pixels are read as newImageAsync does and the file is encoded on a worker thread.
      *
      * @param filename The file name.
      * @param isRGBA The file is RGBA or not.
@@ -163,9 +175,9 @@ public:
 
     /** saves the texture into a file. The format could be JPG or PNG. The file will be saved in the Documents folder.
         Returns true if the operation is successful.
-     * Notes: since v3.x, saveToFile will generate a custom command, which will be called in the following render->render().
-     * So if this function is called in a event handler, the actual save file will be called in the next frame. If we switch to a different scene, the game will crash.
-     * To solve this, add Director::getInstance()->getRenderer()->render(); after this function.
+     * Notes: the pixels are read after the commands already queued in this frame, as newImageAsync does, and the file
+     * is encoded and written on a worker thread. It is only there once the callback is called, on the main thread.
+     * The RenderTexture is retained until then.
      *
      * @param filename The file name.
      * @param format The image format.
@@ -237,6 +249,14 @@ public:
      */
     inline void setClearStencil(int clearStencil) { _clearStencil = clearStencil; };
 
+    /** Sets whether the depth and stencil content is discarded when the rendering ends, so a tile based GPU doesn't
+     * write it back to memory. For the render textures that clear or don't use them on the next begin. False by default.
+     *
+     * @param discarded Whether the depth and stencil content is discarded.
+     */
+    inline void setDepthStencilDiscarded(bool discarded) { _depthStencilDiscarded = discarded; };
+    inline bool isDepthStencilDiscarded() const { return _depthStencilDiscarded; };
+
     /** When enabled, it will render its children into the texture automatically. Disabled by default for compatibility reasons.
      * Will be enabled in the future.
      *
@@ -319,6 +339,8 @@ protected:
 
     //flags: whether generate new modelView and projection matrix or not
     bool         _keepMatrix;
+    //the culling state of the Director before begin(), the nodes out of the window may be drawn into the texture
+    bool         _wasCullingEnabled;
     Rect         _rtTextureRect;
     Rect         _fullRect;
     Rect         _fullviewPort;
@@ -338,6 +360,7 @@ protected:
     GLclampf     _clearDepth;
     GLint        _clearStencil;
     bool         _autoDraw;
+    bool         _depthStencilDiscarded;
 
     /** The Sprite being used.
      The sprite, by default, will use the following blending function: GL_ONE, GL_ONE_MINUS_SRC_ALPHA.
@@ -352,12 +375,13 @@ protected:
     CustomCommand _clearCommand;
     CustomCommand _beginCommand;
     CustomCommand _endCommand;
-    /*this command is used to encapsulate saveToFile,
-     call saveToFile twice will overwrite this command and callback
-     and the command and callback will be executed twice.
-    */
-    CustomCommand _saveToFileCommand;
-    std::function<void (RenderTexture*, const std::string&)> _saveFileCallback;
+
+    // a pending newImageAsync or saveToFile
+    struct Readback;
+    // polled by _readbackCommand once per frame until the pixels are mapped
+    std::vector<Readback*> _readbacks;
+    CustomCommand _readbackCommand;
+    unsigned int _readbackFrame;
 protected:
     //renderer caches and callbacks
     void onBegin();
@@ -366,7 +390,15 @@ protected:
     void onClear();
     void onClearDepth();
 
-    void onSaveToFile(const std::string& fileName, bool isRGBA = true);
+    void onReadback();
+
+    void addReadback(Readback* readback);
+    void queueReadbackCommand();
+    // binds _FBO for glReadPixels, the previous binding is kept in _oldFBO
+    void bindFramebufferForReading();
+    void startReadback(Readback* readback);
+    bool isReadbackReady(Readback* readback);
+    void finishReadback(Readback* readback);
 
     Mat4 _oldTransMatrix, _oldProjMatrix;
     Mat4 _transformMatrix, _projectionMatrix;
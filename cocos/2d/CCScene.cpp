@@ -26,13 +26,24 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "2d/CCScene.h"
+
+#include "2d/CCActionManager.h"
+#include "2d/CCTransformSystem.h"
 #include "base/CCDirector.h"
+#include "base/CCScheduler.h"
 #include "renderer/CCRenderer.h"
 #include "base/CCString.h"
+#include "base/CCWorkerPool.h"
 
 NS_CC_BEGIN
 
 Scene::Scene()
+: _isCommandReorderEnabled(false)
+, _transformSystem(nullptr)
+, _backgroundUpdate(BackgroundUpdate::PAUSE)
+, _backgroundUpdateRate(10.0f)
+, _backgroundTime(0)
+, _backgroundRunning(false)
 {
     _ignoreAnchorPointForPosition = true;
     setAnchorPoint(Vec2::ANCHOR_MIDDLE);
@@ -40,6 +51,7 @@ Scene::Scene()
 
 Scene::~Scene()
 {
+    delete _transformSystem;
 }
 
 bool Scene::init()
@@ -95,5 +107,184 @@ void Scene::removeAllChildren()
 
 }
 
+void Scene::setTransformSystemEnabled(bool enabled)
+{
+    if (enabled && _transformSystem == nullptr)
+    {
+        _transformSystem = new (std::nothrow) TransformSystem();
+    }
+    else if (!enabled)
+    {
+        CC_SAFE_DELETE(_transformSystem);
+    }
+}
+
+void Scene::setBackgroundUpdate(BackgroundUpdate policy, float rate)
+{
+    CCASSERT(policy != BackgroundUpdate::THROTTLE || rate > 0, "The rate must be positive");
+    _backgroundUpdate = policy;
+    _backgroundUpdateRate = rate;
+}
+
+void Scene::onEnter()
+{
+    // Node::onEnter() resumes everything anyway
+    _backgroundTime = 0;
+    _backgroundRunning = false;
+    Node::onEnter();
+}
+
+bool Scene::beginBackgroundUpdate(float dt)
+{
+    bool run = false;
+    bool once = false;
+    float missedTime = 0;
+    if (_backgroundUpdate == BackgroundUpdate::FULL)
+    {
+        run = true;
+    }
+    else if (_backgroundUpdate == BackgroundUpdate::THROTTLE)
+    {
+        _backgroundTime += dt;
+        if (_backgroundTime >= 1.0f / _backgroundUpdateRate)
+        {
+            // the update of this frame steps the scene by dt, the rest of the time it waited is missed
+            missedTime = _backgroundTime - dt;
+            _backgroundTime = 0;
+            run = once = true;
+        }
+    }
+
+    if (run != _backgroundRunning)
+    {
+        setUpdatesPaused(this, !run, missedTime);
+        _backgroundRunning = run;
+    }
+    return once;
+}
+
+void Scene::endBackgroundUpdate()
+{
+    if (_backgroundRunning)
+    {
+        setUpdatesPaused(this, true, 0);
+        _backgroundRunning = false;
+    }
+}
+
+void Scene::setUpdatesPaused(Node* node, bool paused, float missedTime)
+{
+    // the nodes may have their own scheduler or action manager
+    auto scheduler = node->getScheduler();
+    if (paused)
+    {
+        scheduler->pauseTarget(node);
+        node->getActionManager()->pauseTarget(node);
+    }
+    else
+    {
+        // the scheduler scales the time of the frame, not the missed time
+        float scaledTime = missedTime * scheduler->getTimeScale();
+        scheduler->resumeTarget(node, scaledTime);
+        node->getActionManager()->resumeTarget(node, scaledTime);
+    }
+    for (const auto& child : node->getChildren())
+    {
+        setUpdatesPaused(child, paused, missedTime);
+    }
+}
+
+void Scene::visit(Renderer* renderer, const Mat4& parentTransform, uint32_t parentFlags)
+{
+    if (!_visible)
+    {
+        return;
+    }
+
+    // a scene can be visited inside another one, e.g. by a transition
+    auto previousSystem = TransformSystem::getCurrent();
+    if (_transformSystem)
+    {
+        _transformSystem->update(this, parentTransform, parentFlags);
+    }
+    TransformSystem::setCurrent(_transformSystem);
+    visitChildren(renderer, parentTransform, parentFlags);
+    TransformSystem::setCurrent(previousSystem);
+}
+
+void Scene::visitChildren(Renderer* renderer, const Mat4& parentTransform, uint32_t parentFlags)
+{
+    // the order of the children must be settled before they are split
+    sortAllChildren();
+
+    _parallelChildren.clear();
+    for (const auto& child : _children)
+    {
+        if (child->isParallelVisitEnabled() && child->isVisible())
+        {
+            _parallelChildren.push_back(child);
+        }
+    }
+
+    auto pool = _parallelChildren.size() > 1 ? WorkerPool::getInstance() : nullptr;
+    if (pool == nullptr || pool->getThreadCount() == 1)
+    {
+        Node::visit(renderer, parentTransform, parentFlags);
+        return;
+    }
+
+    uint32_t flags = processParentFlags(parentTransform, parentFlags);
+
+    _director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+    _director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, _modelViewTransform);
+
+    // record the marked subtrees, every thread has its own model view stack
+    if (_commandLists.size() < _parallelChildren.size())
+    {
+        _commandLists.resize(_parallelChildren.size());
+    }
+    pool->run((int)_parallelChildren.size(), [&](int index) {
+        std::stack<Mat4> modelViewStack;
+        modelViewStack.push(_modelViewTransform);
+
+        _director->setThreadModelViewMatrixStack(&modelViewStack);
+        renderer->beginCommandList(&_commandLists[index]);
+
+        _parallelChildren[index]->visit(renderer, _modelViewTransform, flags);
+
+        renderer->endCommandList();
+        _director->setThreadModelViewMatrixStack(nullptr);
+    });
+
+    // then add everything in the order of a serial visit
+    size_t next = 0;
+    bool selfDrawn = false;
+    for (const auto& child : _children)
+    {
+        if (!selfDrawn && child->getLocalZOrder() >= 0)
+        {
+            Renderer::setDebugOwner(this);
+            this->draw(renderer, _modelViewTransform, flags);
+            selfDrawn = true;
+        }
+
+        if (next < _parallelChildren.size() && _parallelChildren[next] == child)
+        {
+            renderer->submitCommandList(_commandLists[next++]);
+        }
+        else
+        {
+            child->visit(renderer, _modelViewTransform, flags);
+        }
+    }
+    if (!selfDrawn)
+    {
+        Renderer::setDebugOwner(this);
+        this->draw(renderer, _modelViewTransform, flags);
+    }
+
+    _director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+}
+
 NS_CC_END
 
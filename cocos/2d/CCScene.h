@@ -29,11 +29,14 @@ THE SOFTWARE.
 #define __CCSCENE_H__
 
 #include <string>
+#include <vector>
 #include "2d/CCNode.h"
+#include "renderer/CCRenderer.h"
 
 NS_CC_BEGIN
 
 class Renderer;
+class TransformSystem;
 
 /**
  * @addtogroup _2d
@@ -75,6 +78,78 @@ public:
     /** override function */
     virtual void removeAllChildren() override;
 
+    /**
+     * Visits the children marked with Node::setParallelVisitEnabled() on the WorkerPool, then the others.
+     * The commands are added to the renderer in the same order as a serial visit.
+     */
+    virtual void visit(Renderer *renderer, const Mat4& parentTransform, uint32_t parentFlags) override;
+    using Node::visit;
+
+    /**
+     * Enable/Disable the reordering of the commands of the scene by material.
+     * Quads and triangles that don't overlap are drawn next to the ones with the same texture, shader and blending,
+     * so interleaved nodes of different atlases still batch. Disabled by default.
+     * Nodes that render into their own group, like ClippingNode, have their own switch, see GroupCommand::setReorderEnabled().
+     *
+     * @param enabled Whether the commands are reordered.
+     */
+    void setCommandReorderEnabled(bool enabled) { _isCommandReorderEnabled = enabled; }
+
+    /** Whether or not the commands of the scene are reordered by material.
+     *
+     * @return True if the commands are reordered.
+     */
+    bool isCommandReorderEnabled() const { return _isCommandReorderEnabled; }
+
+    /**
+     * Enable/Disable the update of the transforms of the scene by a TransformSystem before the visit.
+     * The transforms of the dirty nodes are computed in one pass over arrays ordered by depth instead of node by
+     * node during the visit, it pays off when many nodes move every frame. The arrays are rebuilt when a child is
+     * added or removed anywhere, so it should stay off for scenes whose hierarchy changes every frame.
+     * Disabled by default.
+     *
+     * @param enabled Whether the transforms are updated by a TransformSystem.
+     * @since v3.11
+     */
+    void setTransformSystemEnabled(bool enabled);
+
+    /** Whether or not the transforms of the scene are updated by a TransformSystem.
+     *
+     * @return True if the transforms are updated by a TransformSystem.
+     * @since v3.11
+     */
+    bool isTransformSystemEnabled() const { return _transformSystem != nullptr; }
+
+    /** How a scene is updated while other scenes are pushed over it, see setBackgroundUpdate().
+     * @since v3.11
+     */
+    enum class BackgroundUpdate
+    {
+        //! its timers and actions are paused, by default
+        PAUSE,
+        /** its timers and actions run on one frame every 1 / rate seconds, stepped by the time since
+         the previous one
+         */
+        THROTTLE,
+        //! its timers and actions keep running every frame
+        FULL
+    };
+
+    /**
+     * Sets how the timers and the actions of the scene run while it is covered by the scenes pushed over it with
+     * Director::pushScene(). Its event listeners stay paused and it isn't visited either way.
+     * The throttled scenes keep a bounded share of the frame, e.g. a world simulated at 10 Hz under a menu.
+     *
+     * @param policy The policy.
+     * @param rate The updates per second of BackgroundUpdate::THROTTLE.
+     * @since v3.11
+     */
+    void setBackgroundUpdate(BackgroundUpdate policy, float rate = 10.0f);
+    BackgroundUpdate getBackgroundUpdate() const { return _backgroundUpdate; }
+    float getBackgroundUpdateRate() const { return _backgroundUpdateRate; }
+
+    virtual void onEnter() override;
+
 CC_CONSTRUCTOR_ACCESS:
     Scene();
     virtual ~Scene();
@@ -87,6 +162,31 @@ protected:
     friend class ProtectedNode;
     friend class SpriteBatchNode;
     friend class Renderer;
+    friend class Director;
+
+    void visitChildren(Renderer *renderer, const Mat4& parentTransform, uint32_t parentFlags);
+
+    // called by the Director for the covered scenes around the update of the Scheduler,
+    // beginBackgroundUpdate() returns whether the scene runs this frame only and must be paused after
+    bool beginBackgroundUpdate(float dt);
+    void endBackgroundUpdate();
+    // pauses or resumes the timers and the actions of node and its descendants, not their event listeners,
+    // the resumed ones are stepped by missedTime more on the next update
+    static void setUpdatesPaused(Node* node, bool paused, float missedTime);
+
+    bool _isCommandReorderEnabled;
+    TransformSystem* _transformSystem;
+
+    BackgroundUpdate _backgroundUpdate;
+    float _backgroundUpdateRate;
+    // the time since the last throttled update
+    float _backgroundTime;
+    // whether the updates of the covered scene were resumed
+    bool _backgroundRunning;
+
+    // the command lists of the parallel visit, one per child visited on a worker
+    std::vector<Renderer::CommandList> _commandLists;
+    std::vector<Node*> _parallelChildren;
 
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(Scene);
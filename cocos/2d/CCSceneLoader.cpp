@@ -0,0 +1,284 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "2d/CCSceneLoader.h"
+#include <chrono>
+#include "2d/CCFontAtlasCache.h"
+#include "2d/CCScene.h"
+#include "2d/CCSpriteFrameCache.h"
+#include "base/CCDirector.h"
+#include "base/CCScheduler.h"
+#include "platform/CCFileUtils.h"
+#include "renderer/CCTextureCache.h"
+
+NS_CC_BEGIN
+
+std::unordered_map<std::string, SceneLoader::Loader> SceneLoader::s_loaders;
+float SceneLoader::s_mainThreadBudget = 4.0f;
+
+SceneLoader* SceneLoader::createWithManifest(const std::string& manifestFile)
+{
+    std::string fullPath = FileUtils::getInstance()->fullPathForFilename(manifestFile);
+    if (fullPath.empty())
+    {
+        CCLOG("cocos2d: SceneLoader: can not find %s", manifestFile.c_str());
+        return nullptr;
+    }
+    return createWithManifest(FileUtils::getInstance()->getValueMapFromFile(fullPath));
+}
+
+SceneLoader* SceneLoader::createWithManifest(const ValueMap& manifest)
+{
+    auto loader = new (std::nothrow) SceneLoader();
+    if (loader == nullptr)
+    {
+        return nullptr;
+    }
+
+    for (const auto& kind : manifest)
+    {
+        if (kind.second.getType() != Value::Type::VECTOR)
+        {
+            CCLOG("cocos2d: SceneLoader: the resources of \"%s\" aren't an array", kind.first.c_str());
+            continue;
+        }
+        for (const auto& path : kind.second.asValueVector())
+        {
+            loader->addResource(kind.first, path.asString());
+        }
+    }
+
+    loader->autorelease();
+    return loader;
+}
+
+void SceneLoader::setLoader(const std::string& kind, const Loader& loader)
+{
+    if (loader)
+    {
+        s_loaders[kind] = loader;
+    }
+    else
+    {
+        s_loaders.erase(kind);
+    }
+}
+
+bool SceneLoader::isMainThreadKind(const std::string& kind)
+{
+    return kind == "spriteFrames" || kind == "fonts";
+}
+
+SceneLoader::SceneLoader()
+: _nextMainThreadResource(0)
+, _doneCount(0)
+, _pendingCount(0)
+, _loading(false)
+, _cancelled(false)
+, _resident(false)
+{
+}
+
+SceneLoader::~SceneLoader()
+{
+    for (auto atlas : _fontAtlases)
+    {
+        FontAtlasCache::releaseFontAtlas(atlas);
+    }
+}
+
+void SceneLoader::addResource(const std::string& kind, const std::string& path)
+{
+    CCASSERT(!_loading, "SceneLoader: the resources can't change while it loads");
+    Resource resource = { kind, path };
+    _resources.push_back(resource);
+}
+
+void SceneLoader::load(const SceneFactory& factory, const LoadedCallback& loaded)
+{
+    CCASSERT(!_loading, "SceneLoader: it is loading already");
+    CCASSERT(factory, "SceneLoader: the factory can't be nullptr");
+
+    _factory = factory;
+    _loadedCallback = loaded;
+    _loading = true;
+    _cancelled = false;
+    _resident = false;
+    _doneCount = 0;
+    _nextMainThreadResource = 0;
+    _mainThreadResources.clear();
+
+    // released by finish()
+    retain();
+    Director::getInstance()->getScheduler()->schedule(CC_CALLBACK_1(SceneLoader::update, this), this, 0, false, "SceneLoader");
+
+    startAsyncResources();
+}
+
+void SceneLoader::cancel()
+{
+    if (_loading)
+    {
+        // the pending asynchronous loads still call back, the loader waits for them in update()
+        _cancelled = true;
+    }
+}
+
+void SceneLoader::startAsyncResources()
+{
+    // counted up front, a loader may call back before it returns
+    _pendingCount = 1;
+
+    for (const auto& resource : _resources)
+    {
+        if (isMainThreadKind(resource.kind))
+        {
+            _mainThreadResources.push_back(resource);
+            continue;
+        }
+
+        if (resource.kind == "textures")
+        {
+            ++_pendingCount;
+            TextureCache* textureCache = Director::getInstance()->getTextureCache();
+            textureCache->addImageAsync(resource.path, [this, resource](Texture2D* texture) {
+                if (texture)
+                {
+                    _textures.pushBack(texture);
+                }
+                --_pendingCount;
+                resourceDone(resource, texture != nullptr);
+            });
+            continue;
+        }
+
+        auto it = s_loaders.find(resource.kind);
+        if (it == s_loaders.end())
+        {
+            CCLOG("cocos2d: SceneLoader: no loader for \"%s\", %s is skipped", resource.kind.c_str(), resource.path.c_str());
+            resourceDone(resource, false);
+            continue;
+        }
+
+        ++_pendingCount;
+        it->second(resource.path, [this, resource](bool success) {
+            --_pendingCount;
+            resourceDone(resource, success);
+        });
+    }
+
+    --_pendingCount;
+}
+
+void SceneLoader::resourceDone(const Resource& resource, bool success)
+{
+    if (!success)
+    {
+        CCLOG("cocos2d: SceneLoader: failed to load %s", resource.path.c_str());
+    }
+
+    ++_doneCount;
+    if (_progressCallback && !_cancelled)
+    {
+        _progressCallback(getProgress());
+    }
+}
+
+bool SceneLoader::loadOnMainThread(const Resource& resource)
+{
+    if (resource.kind == "spriteFrames")
+    {
+        auto cache = SpriteFrameCache::getInstance();
+        cache->addSpriteFramesWithFile(resource.path);
+        return cache->isSpriteFramesWithFileLoaded(resource.path);
+    }
+
+    // fonts
+    auto atlas = FontAtlasCache::getFontAtlasFNT(resource.path);
+    if (atlas)
+    {
+        _fontAtlases.push_back(atlas);
+    }
+    return atlas != nullptr;
+}
+
+void SceneLoader::update(float dt)
+{
+    if (_pendingCount > 0)
+    {
+        return;
+    }
+
+    if (_cancelled)
+    {
+        finish();
+        return;
+    }
+
+    if (_resident)
+    {
+        // created in a frame of its own, the last resources may have taken the frame already
+        auto scene = _factory();
+        auto loadedCallback = _loadedCallback;
+        finish();
+
+        if (loadedCallback)
+        {
+            loadedCallback(scene);
+        }
+        else if (scene)
+        {
+            Director::getInstance()->replaceScene(scene);
+        }
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    while (_nextMainThreadResource < _mainThreadResources.size())
+    {
+        const Resource& resource = _mainThreadResources[_nextMainThreadResource++];
+        resourceDone(resource, loadOnMainThread(resource));
+
+        if (s_mainThreadBudget > 0 &&
+            std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() >= s_mainThreadBudget)
+        {
+            break;
+        }
+    }
+
+    _resident = _nextMainThreadResource == _mainThreadResources.size();
+}
+
+void SceneLoader::finish()
+{
+    Director::getInstance()->getScheduler()->unschedule("SceneLoader", this);
+    _loading = false;
+    _factory = nullptr;
+    _loadedCallback = nullptr;
+
+    // retained by load()
+    release();
+}
+
+NS_CC_END
@@ -0,0 +1,157 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CCSCENE_LOADER_H__
+#define __CCSCENE_LOADER_H__
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "base/CCRef.h"
+#include "base/CCValue.h"
+#include "base/CCVector.h"
+
+NS_CC_BEGIN
+
+class FontAtlas;
+class Scene;
+class Texture2D;
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/**
+ SceneLoader makes the resources of a scene resident without blocking the main thread, then creates the scene,
+ so a loading screen keeps animating while it runs.
+
+ The resources are listed by kind in a manifest, a plist dictionary of arrays of paths:
+
+     <key>textures</key>     <array><string>level1/background.png</string> ...</array>
+     <key>spriteFrames</key> <array><string>level1/characters.plist</string> ...</array>
+     <key>fonts</key>        <array><string>fonts/score.fnt</string> ...</array>
+
+ The textures are decoded in parallel with TextureCache::addImageAsync(), so are the kinds of setLoader(), e.g. audio
+ with AudioEngine::preload() or script modules. Once they are all done, the sprite frames and the BMFont atlases are
+ added on the main thread, a few per frame within getMainThreadBudget(): list their images under "textures" too,
+ so that they are decoded in parallel. The loader keeps the textures and the font atlases until it's released,
+ which is after the scene is created.
+ @since v3.11
+ */
+class CC_DLL SceneLoader : public Ref
+{
+public:
+    /** Creates the scene once its resources are resident. */
+    typedef std::function<Scene*()> SceneFactory;
+    /** Called on the main thread with the created scene. */
+    typedef std::function<void(Scene*)> LoadedCallback;
+    /** Called on the main thread with the done part of the resources, from 0 to 1. */
+    typedef std::function<void(float)> ProgressCallback;
+    /** Starts loading `path` and calls `done` on the main thread, with whether it succeeded, once it is resident. */
+    typedef std::function<void(const std::string& path, const std::function<void(bool)>& done)> Loader;
+
+    /** Creates a loader of the resources of a manifest file. */
+    static SceneLoader* createWithManifest(const std::string& manifestFile);
+    /** Creates a loader of the resources of a manifest that was already read. */
+    static SceneLoader* createWithManifest(const ValueMap& manifest);
+
+    /**
+     Sets how the resources of a kind of the manifests are loaded, for all the SceneLoaders. nullptr removes it.
+     The resources of a kind without a loader are skipped with a message in the log.
+     */
+    static void setLoader(const std::string& kind, const Loader& loader);
+
+    /** Sets the milliseconds per frame spent adding sprite frames and font atlases, at least one is added per frame. 4 by default. */
+    static void setMainThreadBudget(float milliseconds) { s_mainThreadBudget = milliseconds; }
+    static float getMainThreadBudget() { return s_mainThreadBudget; }
+
+    /** Adds a resource to load, before load() is called. */
+    void addResource(const std::string& kind, const std::string& path);
+
+    void setProgressCallback(const ProgressCallback& callback) { _progressCallback = callback; }
+
+    /**
+     Loads the resources, then creates the scene with `factory` in a frame of its own.
+     `loaded` is called with it, or the running scene is replaced by it when `loaded` is nullptr.
+     The loader retains itself until it's done.
+     */
+    void load(const SceneFactory& factory, const LoadedCallback& loaded = nullptr);
+
+    /** Stops loading, the scene isn't created. The resources already resident stay in their caches. */
+    void cancel();
+
+    /** The done part of the resources, from 0 to 1. */
+    float getProgress() const { return _resources.empty() ? 1.0f : (float)_doneCount / _resources.size(); }
+    bool isLoading() const { return _loading; }
+
+CC_CONSTRUCTOR_ACCESS:
+    SceneLoader();
+    virtual ~SceneLoader();
+
+protected:
+    struct Resource
+    {
+        std::string kind;
+        std::string path;
+    };
+
+    void update(float dt);
+    void startAsyncResources();
+    // adds a sprite frame file or a font atlas, returns false when it fails
+    bool loadOnMainThread(const Resource& resource);
+    void resourceDone(const Resource& resource, bool success);
+    void finish();
+
+    static bool isMainThreadKind(const std::string& kind);
+
+    static std::unordered_map<std::string, Loader> s_loaders;
+    static float s_mainThreadBudget;
+
+    std::vector<Resource> _resources;
+    // the resources added on the main thread once the others are done
+    std::vector<Resource> _mainThreadResources;
+    size_t _nextMainThreadResource;
+    size_t _doneCount;
+    // the asynchronous loads that haven't called back yet
+    int _pendingCount;
+    bool _loading;
+    bool _cancelled;
+    bool _resident;
+
+    SceneFactory _factory;
+    LoadedCallback _loadedCallback;
+    ProgressCallback _progressCallback;
+
+    Vector<Texture2D*> _textures;
+    std::vector<FontAtlas*> _fontAtlases;
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif // __CCSCENE_LOADER_H__
@@ -0,0 +1,364 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "2d/CCSpatialNode.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "base/CCDirector.h"
+
+NS_CC_BEGIN
+
+// the cell coordinates are clamped so that far away positions don't overflow them
+static const float MAX_CELL_COORDINATE = 1.0e9f;
+
+static int64_t spatialCellKey(int x, int y)
+{
+    return ((int64_t)x << 32) | (uint32_t)y;
+}
+
+static int cellCoordinate(float value, float cellSize)
+{
+    return (int)clampf(floorf(value / cellSize), -MAX_CELL_COORDINATE, MAX_CELL_COORDINATE);
+}
+
+SpatialNode* SpatialNode::create(float cellSize)
+{
+    SpatialNode* ret = new (std::nothrow) SpatialNode();
+    if (ret && ret->initWithCellSize(cellSize))
+    {
+        ret->autorelease();
+        return ret;
+    }
+    CC_SAFE_DELETE(ret);
+    return nullptr;
+}
+
+SpatialNode::SpatialNode()
+: _cellSize(256)
+, _maxChildExtent(0)
+{
+    _isSpatialContainer = true;
+    // the bounds of a world would be built from all the children, the grid culls them instead
+    _isCullingEnabled = false;
+}
+
+SpatialNode::~SpatialNode()
+{
+    // the children may live on, in another SpatialNode
+    for (auto child : _movedChildren)
+    {
+        child->_spatialCellDirty = false;
+    }
+}
+
+bool SpatialNode::initWithCellSize(float cellSize)
+{
+    if (!Node::init())
+    {
+        return false;
+    }
+    setCellSize(cellSize);
+    return true;
+}
+
+void SpatialNode::setCellSize(float cellSize)
+{
+    CCASSERT(cellSize > 0, "SpatialNode: the cell size must be positive");
+    _cellSize = cellSize;
+
+    _cells.clear();
+    _childCells.clear();
+    for (const auto& child : _children)
+    {
+        markChildMoved(child);
+    }
+}
+
+int64_t SpatialNode::getCellKey(const Vec2& position) const
+{
+    return spatialCellKey(cellCoordinate(position.x, _cellSize), cellCoordinate(position.y, _cellSize));
+}
+
+void SpatialNode::addChild(Node* child, int localZOrder, int tag)
+{
+    Node::addChild(child, localZOrder, tag);
+    markChildMoved(child);
+}
+
+void SpatialNode::addChild(Node* child, int localZOrder, const std::string& name)
+{
+    Node::addChild(child, localZOrder, name);
+    markChildMoved(child);
+}
+
+void SpatialNode::removeChild(Node* child, bool cleanup)
+{
+    if (child && child->_parent == this)
+    {
+        forgetChild(child);
+    }
+    Node::removeChild(child, cleanup);
+}
+
+void SpatialNode::removeAllChildrenWithCleanup(bool cleanup)
+{
+    for (auto child : _movedChildren)
+    {
+        child->_spatialCellDirty = false;
+    }
+    _movedChildren.clear();
+    _cells.clear();
+    _childCells.clear();
+    _visibleChildren.clear();
+    _previousVisibleChildren.clear();
+
+    Node::removeAllChildrenWithCleanup(cleanup);
+}
+
+void SpatialNode::markChildMoved(Node* child)
+{
+    if (!child->_spatialCellDirty)
+    {
+        child->_spatialCellDirty = true;
+        _movedChildren.push_back(child);
+    }
+}
+
+void SpatialNode::forgetChild(Node* child)
+{
+    if (child->_spatialCellDirty)
+    {
+        child->_spatialCellDirty = false;
+        _movedChildren.erase(std::find(_movedChildren.begin(), _movedChildren.end(), child));
+    }
+
+    auto iter = _childCells.find(child);
+    if (iter == _childCells.end())
+    {
+        return;
+    }
+
+    auto cell = _cells.find(iter->second);
+    if (cell != _cells.end())
+    {
+        // the order within a cell doesn't matter, the visible children are sorted
+        auto& children = cell->second;
+        auto position = std::find(children.begin(), children.end(), child);
+        if (position != children.end())
+        {
+            *position = children.back();
+            children.pop_back();
+        }
+        if (children.empty())
+        {
+            _cells.erase(cell);
+        }
+    }
+    _childCells.erase(iter);
+
+    // the address may be reused by a node added later
+    auto visible = std::find(_visibleChildren.begin(), _visibleChildren.end(), child);
+    if (visible != _visibleChildren.end())
+    {
+        _visibleChildren.erase(visible);
+    }
+}
+
+void SpatialNode::updateCells()
+{
+    for (auto child : _movedChildren)
+    {
+        child->_spatialCellDirty = false;
+
+        const int64_t key = getCellKey(child->getPosition());
+        auto iter = _childCells.find(child);
+        if (iter != _childCells.end())
+        {
+            if (iter->second == key)
+            {
+                continue;
+            }
+
+            auto& children = _cells[iter->second];
+            auto position = std::find(children.begin(), children.end(), child);
+            if (position != children.end())
+            {
+                *position = children.back();
+                children.pop_back();
+            }
+            if (children.empty())
+            {
+                _cells.erase(iter->second);
+            }
+            iter->second = key;
+        }
+        else
+        {
+            _childCells.emplace(child, key);
+        }
+        _cells[key].push_back(child);
+    }
+    _movedChildren.clear();
+}
+
+bool SpatialNode::getVisibleRect(Rect* rect) const
+{
+    const Mat4& m = _modelViewTransform;
+    // the 2D inverse only holds for transforms that keep the z = 0 plane in place
+    if (!_director->isCullingEnabled() || m.m[2] != 0 || m.m[6] != 0 || m.m[14] != 0)
+    {
+        return false;
+    }
+
+    const float det = m.m[0] * m.m[5] - m.m[1] * m.m[4];
+    if (det == 0)
+    {
+        return false;
+    }
+
+    const Size& winSize = _director->getWinSize();
+    const float corners[4][2] = {
+        { 0, 0 },
+        { winSize.width, 0 },
+        { 0, winSize.height },
+        { winSize.width, winSize.height },
+    };
+
+    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+    for (const auto& corner : corners)
+    {
+        const float dx = corner[0] - m.m[12];
+        const float dy = corner[1] - m.m[13];
+        const float x = (m.m[5] * dx - m.m[4] * dy) / det;
+        const float y = (m.m[0] * dy - m.m[1] * dx) / det;
+        minX = std::min(minX, x);
+        minY = std::min(minY, y);
+        maxX = std::max(maxX, x);
+        maxY = std::max(maxY, y);
+    }
+
+    rect->setRect(minX - _maxChildExtent, minY - _maxChildExtent, maxX - minX + _maxChildExtent * 2, maxY - minY + _maxChildExtent * 2);
+    return true;
+}
+
+void SpatialNode::visit(Renderer* renderer, const Mat4& parentTransform, uint32_t parentFlags)
+{
+    if (!_visible)
+    {
+        return;
+    }
+
+    uint32_t flags = processParentFlags(parentTransform, parentFlags);
+
+    const bool nativeResolution = _coldData && _coldData->nativeResolution && pushNativeResolutionGroup(renderer);
+
+    updateCells();
+
+    Rect rect;
+    if (!getVisibleRect(&rect))
+    {
+        // every child gets the transform of the node
+        _previousVisibleChildren.clear();
+        _visibleChildren.assign(_children.begin(), _children.end());
+        drawSubtree(renderer, _modelViewTransform, flags);
+    }
+    else
+    {
+        _previousVisibleChildren.swap(_visibleChildren);
+        std::sort(_previousVisibleChildren.begin(), _previousVisibleChildren.end());
+        _visibleChildren.clear();
+
+        const int minX = cellCoordinate(rect.getMinX(), _cellSize);
+        const int minY = cellCoordinate(rect.getMinY(), _cellSize);
+        const int maxX = cellCoordinate(rect.getMaxX(), _cellSize);
+        const int maxY = cellCoordinate(rect.getMaxY(), _cellSize);
+
+        // zoomed out, the cells of the window outnumber the cells with children
+        if ((int64_t)(maxX - minX + 1) * (maxY - minY + 1) > (int64_t)_cells.size())
+        {
+            for (const auto& cell : _cells)
+            {
+                const int x = (int)(cell.first >> 32);
+                const int y = (int)(int32_t)(uint32_t)cell.first;
+                if (x >= minX && x <= maxX && y >= minY && y <= maxY)
+                {
+                    _visibleChildren.insert(_visibleChildren.end(), cell.second.begin(), cell.second.end());
+                }
+            }
+        }
+        else
+        {
+            for (int y = minY; y <= maxY; ++y)
+            {
+                for (int x = minX; x <= maxX; ++x)
+                {
+                    auto cell = _cells.find(spatialCellKey(x, y));
+                    if (cell != _cells.end())
+                    {
+                        _visibleChildren.insert(_visibleChildren.end(), cell->second.begin(), cell->second.end());
+                    }
+                }
+            }
+        }
+
+        std::sort(_visibleChildren.begin(), _visibleChildren.end(), nodeComparisonLess);
+
+        _director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+        _director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, _modelViewTransform);
+
+        // a child that wasn't visited last time missed the transforms the node had since
+        auto visitChild = [&](Node* child) {
+            const bool wasVisited = std::binary_search(_previousVisibleChildren.begin(), _previousVisibleChildren.end(), child);
+            child->visit(renderer, _modelViewTransform, wasVisited ? flags : (flags | FLAGS_TRANSFORM_DIRTY));
+        };
+
+        size_t i = 0;
+        // draw children zOrder < 0
+        for (; i < _visibleChildren.size() && _visibleChildren[i]->getLocalZOrder() < 0; ++i)
+        {
+            visitChild(_visibleChildren[i]);
+        }
+        // self draw
+        Renderer::setDebugOwner(this);
+        this->draw(renderer, _modelViewTransform, flags);
+        for (; i < _visibleChildren.size(); ++i)
+        {
+            visitChild(_visibleChildren[i]);
+        }
+
+        _director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+    }
+
+    if (nativeResolution)
+    {
+        renderer->popGroup();
+    }
+
+    updateSubtreeBounds();
+}
+
+NS_CC_END
@@ -0,0 +1,126 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#ifndef __CCSPATIAL_NODE_H__
+#define __CCSPATIAL_NODE_H__
+
+#include <unordered_map>
+#include <vector>
+
+#include "2d/CCNode.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/** @class SpatialNode
+ * @brief A container node for large worlds, which only visits the children near the window.
+ *
+ * The children are kept in a uniform grid, in the cells of their positions. The visit only goes through the cells
+ * that intersect the window, expanded by the max child extent, so it costs O(visible children) and not O(children).
+ * A child that moves is placed in its new cell before the next visit, the others aren't touched.
+ * The visible children are visited in the order of their local Z order, like the children of a Node.
+ *
+ * The children are placed by getPosition(): a child whose drawing goes farther from its position than the max child
+ * extent may be skipped while it is partly in the window. The culling of the children themselves still applies, see
+ * Node::setCullingEnabled(). When Director::isCullingEnabled() is false, or when the node is transformed out of the
+ * z = 0 plane, all the children are visited. The node can't be cached as a texture.
+ * @since v3.11
+ * @js NA
+ * @lua NA
+ */
+class CC_DLL SpatialNode : public Node
+{
+public:
+    /** Creates a spatial node.
+     *
+     * @param cellSize The size of the cells of the grid, in points. A few times the size of the children works well.
+     * @return An autoreleased SpatialNode object.
+     */
+    static SpatialNode* create(float cellSize = 256);
+
+    /** Sets the size of the cells of the grid, in points. All the children are placed again. */
+    void setCellSize(float cellSize);
+    float getCellSize() const { return _cellSize; }
+
+    /** Sets how far from its position a child is drawn, in points. The visited rect is expanded by it, 0 by default. */
+    void setMaxChildExtent(float extent) { _maxChildExtent = extent; }
+    float getMaxChildExtent() const { return _maxChildExtent; }
+
+    /** Gets the number of children the last visit went through. */
+    ssize_t getVisitedChildrenCount() const { return (ssize_t)_visibleChildren.size(); }
+
+    // Overrides
+    using Node::addChild;
+    virtual void addChild(Node* child, int localZOrder, int tag) override;
+    virtual void addChild(Node* child, int localZOrder, const std::string& name) override;
+    virtual void removeChild(Node* child, bool cleanup = true) override;
+    virtual void removeAllChildrenWithCleanup(bool cleanup) override;
+    virtual void visit(Renderer* renderer, const Mat4& parentTransform, uint32_t parentFlags) override;
+
+CC_CONSTRUCTOR_ACCESS:
+    SpatialNode();
+    virtual ~SpatialNode();
+
+    bool initWithCellSize(float cellSize);
+
+protected:
+    friend class Node;
+
+    /** Called by a child when it moves, see Node::invalidateSubtreeBounds(). */
+    void markChildMoved(Node* child);
+    /** Places the children that moved in their new cells. */
+    void updateCells();
+    /** Removes the child from the grid. */
+    void forgetChild(Node* child);
+    /** Gets the rect of the window in the node space, returns false when it can't be computed. */
+    bool getVisibleRect(Rect* rect) const;
+    int64_t getCellKey(const Vec2& position) const;
+
+    float _cellSize;
+    float _maxChildExtent;
+
+    /** The children by cell */
+    std::unordered_map<int64_t, std::vector<Node*>> _cells;
+    /** The cell of each child */
+    std::unordered_map<Node*, int64_t> _childCells;
+    /** The children that moved since the last visit, their _spatialCellDirty is set */
+    std::vector<Node*> _movedChildren;
+
+    /** The children visited by the last visit, and by the one before it sorted by address */
+    std::vector<Node*> _visibleChildren;
+    std::vector<Node*> _previousVisibleChildren;
+
+private:
+    CC_DISALLOW_COPY_AND_ASSIGN(SpatialNode);
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif // __CCSPATIAL_NODE_H__
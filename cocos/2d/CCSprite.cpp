@@ -37,6 +37,7 @@ THE SOFTWARE.
 #include "renderer/CCTexture2D.h"
 #include "renderer/CCRenderer.h"
 #include "base/CCDirector.h"
+#include "platform/CCGLView.h"
 #include "base/CCString.h"
 
 NS_CC_BEGIN
@@ -293,6 +294,8 @@ Sprite::Sprite()
 , _texture(nullptr)
 , _spriteFrame(nullptr)
 , _insideBounds(true)
+, _animationIndex(-1)
+, _opaque(false)
 {
 #if CC_SPRITE_DEBUG_DRAW
     _debugDrawNode = DrawNode::create();
@@ -302,6 +305,10 @@ Sprite::Sprite()
 
 Sprite::~Sprite()
 {
+    if (_animationIndex >= 0)
+    {
+        SpriteAnimationSystem::getInstance()->stop(this, false);
+    }
     CC_SAFE_RELEASE(_spriteFrame);
     CC_SAFE_RELEASE(_texture);
 }
@@ -374,6 +381,7 @@ void Sprite::setTexture(Texture2D *texture)
         CC_SAFE_RELEASE(_texture);
         _texture = texture;
         updateBlendFunc();
+        invalidateCachedTexture();
     }
 }
 
@@ -394,7 +402,11 @@ void Sprite::setTextureRect(const Rect& rect, bool rotated, const Size& untrimme
     setContentSize(untrimmedSize);
     setVertexRect(rect);
     setTextureCoords(rect);
+    updateQuadVertices();
+}
 
+void Sprite::updateQuadVertices()
+{
     float relativeOffsetX = _unflippedOffsetPositionFromCenter.x;
     float relativeOffsetY = _unflippedOffsetPositionFromCenter.y;
 
@@ -435,6 +447,7 @@ void Sprite::setTextureRect(const Rect& rect, bool rotated, const Size& untrimme
     }
 
     _polyInfo.setQuad(&_quad);
+    invalidateCachedTexture();
 }
 
 // override this method to generate "double scale" sprites
@@ -450,14 +463,20 @@ void Sprite::setTextureCoords(Rect rect)
     {
         return;
     }
+
+    float left, right, top, bottom;
+    getTextureCoords(tex, rect, _rectRotated, left, right, top, bottom);
+    setQuadTextureCoords(left, right, top, bottom);
+}
+
+void Sprite::getTextureCoords(Texture2D* tex, Rect rect, bool rotated, float& left, float& right, float& top, float& bottom)
+{
     rect = CC_RECT_POINTS_TO_PIXELS(rect);
 
     float atlasWidth = (float)tex->getPixelsWide();
     float atlasHeight = (float)tex->getPixelsHigh();
 
-    float left, right, top, bottom;
-
-    if (_rectRotated)
+    if (rotated)
     {
 #if CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
         left    = (2*rect.origin.x+1)/(2*atlasWidth);
@@ -470,7 +489,27 @@ void Sprite::setTextureCoords(Rect rect)
         top     = rect.origin.y/atlasHeight;
         bottom  = (rect.origin.y+rect.size.width) / atlasHeight;
 #endif // CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
+    }
+    else
+    {
+#if CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
+        left    = (2*rect.origin.x+1)/(2*atlasWidth);
+        right    = left + (rect.size.width*2-2)/(2*atlasWidth);
+        top        = (2*rect.origin.y+1)/(2*atlasHeight);
+        bottom    = top + (rect.size.height*2-2)/(2*atlasHeight);
+#else
+        left    = rect.origin.x/atlasWidth;
+        right    = (rect.origin.x + rect.size.width) / atlasWidth;
+        top        = rect.origin.y/atlasHeight;
+        bottom    = (rect.origin.y + rect.size.height) / atlasHeight;
+#endif // ! CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
+    }
+}
 
+void Sprite::setQuadTextureCoords(float left, float right, float top, float bottom)
+{
+    if (_rectRotated)
+    {
         if (_flippedX)
         {
             std::swap(top, bottom);
@@ -492,18 +531,6 @@ void Sprite::setTextureCoords(Rect rect)
     }
     else
     {
-#if CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
-        left    = (2*rect.origin.x+1)/(2*atlasWidth);
-        right    = left + (rect.size.width*2-2)/(2*atlasWidth);
-        top        = (2*rect.origin.y+1)/(2*atlasHeight);
-        bottom    = top + (rect.size.height*2-2)/(2*atlasHeight);
-#else
-        left    = rect.origin.x/atlasWidth;
-        right    = (rect.origin.x + rect.size.width) / atlasWidth;
-        top        = rect.origin.y/atlasHeight;
-        bottom    = (rect.origin.y + rect.size.height) / atlasHeight;
-#endif // ! CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
-
         if(_flippedX)
         {
             std::swap(left, right);
@@ -624,7 +651,20 @@ void Sprite::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
             return;
         }
 
-        _trianglesCommand.init(_globalZOrder, _texture->getName(), getGLProgramState(), _blendFunc, _polyInfo.triangles, transform, flags);
+        if (_texture->isStreamed())
+        {
+            // the texels per pixel along the axis the sprite is the most magnified on
+            float scale = std::max(Vec2(transform.m[0], transform.m[1]).length(), Vec2(transform.m[4], transform.m[5]).length());
+            if (scale > 0)
+            {
+                _texture->requestTexelDensity(CC_CONTENT_SCALE_FACTOR() / (scale * _director->getOpenGLView()->getScaleX()));
+            }
+        }
+
+        auto glProgramState = getGLProgramState();
+        const bool opaque = renderer->isOpaquePassEnabled() && isDrawnOpaque();
+        _trianglesCommand.init(_globalZOrder, _texture->getName(), glProgramState, _blendFunc, _polyInfo.triangles, transform, flags);
+        _trianglesCommand.setTransparent(!opaque);
         renderer->addCommand(&_trianglesCommand);
 
 #if CC_SPRITE_DEBUG_DRAW
@@ -750,11 +790,18 @@ void Sprite::removeAllChildrenWithCleanup(bool cleanup)
     Node::removeAllChildrenWithCleanup(cleanup);
 }
 
+void Sprite::cleanup()
+{
+    stopAnimation();
+
+    Node::cleanup();
+}
+
 void Sprite::sortAllChildren()
 {
-    if (_reorderChildDirty)
+    if (_reorderChildDirty || _childOrder != ChildOrder::LOCAL_Z_ORDER)
     {
-        std::sort(std::begin(_children), std::end(_children), nodeComparisonLess);
+        sortChildren();
 
         if ( _batchNode)
         {
@@ -771,6 +818,49 @@ void Sprite::sortAllChildren()
 // used only when parent is SpriteBatchNode
 //
 
+Node* Sprite::cloneInstance() const
+{
+    Sprite* sprite = new (std::nothrow) Sprite();
+    if (!sprite || !sprite->initWithTexture(_texture, _rect, _rectRotated))
+    {
+        delete sprite;
+        return Node::cloneInstance();
+    }
+    sprite->autorelease();
+
+    // the frame is shared, the rect and the offset are taken as they are now in case they were changed since
+    if (_spriteFrame)
+    {
+        _spriteFrame->retain();
+        sprite->_spriteFrame = _spriteFrame;
+    }
+    sprite->_unflippedOffsetPositionFromCenter = _unflippedOffsetPositionFromCenter;
+    sprite->setTextureRect(_rect, _rectRotated, _contentSize);
+    sprite->setFlippedX(_flippedX);
+    sprite->setFlippedY(_flippedY);
+
+    // the vertices of a mesh are flipped and colored per sprite, so they are copied
+    if (!isQuad())
+    {
+        sprite->_polyInfo = _polyInfo;
+    }
+    sprite->setBlendFunc(_blendFunc);
+    sprite->setOpacityModifyRGB(_opacityModifyRGB);
+    sprite->setOpaque(_opaque);
+
+    copyNodeState(sprite);
+    return sprite;
+}
+
+bool Sprite::isInternalChild(const Node* child) const
+{
+#if CC_SPRITE_DEBUG_DRAW
+    return child == _debugDrawNode;
+#else
+    return false;
+#endif
+}
+
 void Sprite::setReorderChildDirtyRecursively()
 {
     //only set parents flag the first time
@@ -913,6 +1003,7 @@ void Sprite::setFlippedX(bool flippedX)
         if (_textureAtlas) {
             setDirty(true);
         }
+        invalidateCachedTexture();
     }
 }
 
@@ -933,6 +1024,7 @@ void Sprite::setFlippedY(bool flippedY)
         if (_textureAtlas) {
             setDirty(true);
         }
+        invalidateCachedTexture();
     }
 }
 
@@ -1009,6 +1101,16 @@ void Sprite::setSpriteFrame(const std::string &spriteFrameName)
     setSpriteFrame(spriteFrame);
 }
 
+void Sprite::setSpriteFrameByHandle(unsigned int spriteFrameHandle)
+{
+    SpriteFrame *spriteFrame = SpriteFrameCache::getInstance()->getSpriteFrameByHandle(spriteFrameHandle);
+    CCASSERT(spriteFrame, std::string("Invalid spriteFrameName :").append(SpriteFrameCache::getSpriteFrameHandleName(spriteFrameHandle)).c_str());
+    if (spriteFrame)
+    {
+        setSpriteFrame(spriteFrame);
+    }
+}
+
 void Sprite::setSpriteFrame(SpriteFrame *spriteFrame)
 {
     CCASSERT(spriteFrame, "Sprite::setSpriteFrame-->spriteFrame should not be nullptr!");
@@ -1035,6 +1137,20 @@ void Sprite::setSpriteFrame(SpriteFrame *spriteFrame)
     // update rect
     _rectRotated = spriteFrame->isRotated();
     setTextureRect(spriteFrame->getRect(), _rectRotated, spriteFrame->getOriginalSize());
+
+    // the tight mesh of the frame is drawn instead of its quad, a batch node takes quads only
+    if (spriteFrame->hasPolygonInfo() && !_batchNode)
+    {
+        _polyInfo = spriteFrame->getPolygonInfo();
+        for (ssize_t i = 0; i < _polyInfo.triangles.vertCount; i++) {
+            auto& v = _polyInfo.triangles.verts[i].vertices;
+            if (_flippedX)
+                v.x = _contentSize.width - v.x;
+            if (_flippedY)
+                v.y = _contentSize.height - v.y;
+        }
+        updateColor();
+    }
 }
 
 void Sprite::setDisplayFrameWithAnimationName(const std::string& animationName, ssize_t frameIndex)
@@ -1056,6 +1172,68 @@ void Sprite::setDisplayFrameWithAnimationName(const std::string& animationName,
     setSpriteFrame(frame->getSpriteFrame());
 }
 
+void Sprite::playAnimation(SpriteAnimationTimeline* timeline, unsigned int loops, float speed)
+{
+    CCASSERT(timeline, "Sprite::playAnimation-->timeline should not be nullptr!");
+    if (timeline == nullptr || timeline->getFrames().empty())
+        return;
+
+    SpriteAnimationSystem::getInstance()->play(this, timeline, loops, speed);
+}
+
+void Sprite::playAnimation(const std::string& animationName, unsigned int loops, float speed)
+{
+    SpriteAnimationTimeline* timeline = AnimationCache::getInstance()->getTimeline(animationName);
+    CCASSERT(timeline, "Sprite::playAnimation: Animation not found");
+    if (timeline == nullptr)
+        return;
+
+    playAnimation(timeline, loops, speed);
+}
+
+void Sprite::stopAnimation()
+{
+    if (_animationIndex >= 0)
+    {
+        SpriteAnimationSystem::getInstance()->stop(this, true);
+    }
+}
+
+void Sprite::setAnimationSpeed(float speed)
+{
+    if (_animationIndex >= 0)
+    {
+        SpriteAnimationSystem::getInstance()->setSpeed(this, speed);
+    }
+}
+
+void Sprite::showAnimationFrame(const SpriteAnimationTimeline::Frame& frame)
+{
+    // the precomputed texture coordinates are on the texture of the frame
+    if (frame.texture != _texture)
+    {
+        setSpriteFrame(frame.spriteFrame);
+        return;
+    }
+
+    if (_spriteFrame != frame.spriteFrame)
+    {
+        CC_SAFE_RELEASE(_spriteFrame);
+        _spriteFrame = frame.spriteFrame;
+        _spriteFrame->retain();
+    }
+    _unflippedOffsetPositionFromCenter = frame.offset;
+    _rectRotated = frame.rotated;
+
+    if (!frame.originalSize.equals(_contentSize))
+    {
+        setContentSize(frame.originalSize);
+    }
+    setVertexRect(frame.rect);
+    setQuadTextureCoords(frame.left, frame.right, frame.top, frame.bottom);
+    updateQuadVertices();
+}
+
 bool Sprite::isFrameDisplayed(SpriteFrame *frame) const
 {
     CCASSERT(frame, "Sprite::isFrameDisplayed-->frame should not be nullptr!");
@@ -1137,6 +1315,21 @@ void Sprite::updateBlendFunc()
     }
 }
 
+bool Sprite::isDrawnOpaque() const
+{
+    if (_opaque)
+        return true;
+    if (_texture == nullptr || _displayedOpacity != 255)
+        return false;
+    if (_blendFunc != BlendFunc::ALPHA_PREMULTIPLIED && _blendFunc != BlendFunc::ALPHA_NON_PREMULTIPLIED && _blendFunc != BlendFunc::DISABLE)
+        return false;
+
+    // every texel has an alpha of 1, the blending doesn't change anything
+    const auto& formats = Texture2D::getPixelFormatInfoMap();
+    auto format = formats.find(_texture->getPixelFormat());
+    return format != formats.end() && !format->second.alpha;
+}
+
 std::string Sprite::getDescription() const
 {
     int texture_id = -1;
@@ -1150,6 +1343,7 @@ std::string Sprite::getDescription() const
 void Sprite::setPolygonInfo(const PolygonInfo& info)
 {
     _polyInfo = info;
+    invalidateCachedTexture();
 }
 
 NS_CC_END
@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include "renderer/CCTrianglesCommand.h"
 #include "renderer/CCCustomCommand.h"
 #include "2d/CCAutoPolygon.h"
+#include "2d/CCSpriteAnimation.h"
 
 NS_CC_BEGIN
 
@@ -253,6 +254,15 @@ public:
     virtual void setSpriteFrame(SpriteFrame* newFrame);
     /** @} */
 
+    /**
+     * Sets the SpriteFrame of a handle, see SpriteFrameCache::getSpriteFrameHandle(). Unlike the name, the handle is
+     * looked up without a hash of the name, for the code that changes the frame every frame.
+     * @since v3.11
+     * @js NA
+     * @lua NA
+     */
+    void setSpriteFrameByHandle(unsigned int spriteFrameHandle);
+
     /**
      * Returns whether or not a SpriteFrame is being displayed.
      */
@@ -273,6 +283,33 @@ public:
      * The animation name will be get from the AnimationCache.
      */
     virtual void setDisplayFrameWithAnimationName(const std::string& animationName, ssize_t frameIndex);
+
+    /**
+     * Plays the frames of a timeline with the SpriteAnimationSystem, instead of the action it would take to run an
+     * Animate. The animation the sprite was playing is replaced. It stops with cleanup(), like the actions.
+     *
+     * @param timeline The frames, see AnimationCache::getTimeline().
+     * @param loops The number of times the frames are played, 0 plays them until stopAnimation() is called.
+     * @param speed The factor of the delays of the frames, 2 plays them twice as fast.
+     */
+    void playAnimation(SpriteAnimationTimeline* timeline, unsigned int loops = 0, float speed = 1.0f);
+
+    /**
+     * Plays the animation of the AnimationCache with the given name, see playAnimation(SpriteAnimationTimeline*, unsigned int, float).
+     */
+    void playAnimation(const std::string& animationName, unsigned int loops = 0, float speed = 1.0f);
+
+    /**
+     * Stops the animation. The sprite keeps the frame it shows, or gets back the frame it had before the animation
+     * if the animation restores it.
+     */
+    void stopAnimation();
+
+    /** Changes the speed of the animation being played. */
+    void setAnimationSpeed(float speed);
+
+    /** Whether the sprite is playing an animation of the SpriteAnimationSystem. */
+    bool isPlayingAnimation() const { return _animationIndex >= 0; }
     /// @}
 
 
@@ -394,6 +431,19 @@ public:
     inline const BlendFunc& getBlendFunc() const override { return _blendFunc; }
     /// @}
 
+    /**
+     * Flags the sprite as opaque: it covers every pixel of its polygon, whatever the alpha of its texture.
+     * The opaque pass of the Renderer draws the opaque sprites at the back of the scene front to back without blending,
+     * see Renderer::setOpaquePassEnabled(). Sprites that aren't flagged are still opaque when their texture has no alpha
+     * channel, they are fully opaque and they are alpha blended or not blended at all.
+     * @since v3.11
+     */
+    void setOpaque(bool opaque) { _opaque = opaque; }
+    /** Whether the sprite is flagged as opaque. */
+    bool isOpaque() const { return _opaque; }
+    /** Whether the sprite is drawn in the opaque pass: it's flagged or detected as opaque. */
+    bool isDrawnOpaque() const;
+
     /**
      * @js NA
      */
@@ -417,6 +467,7 @@ public:
     virtual void setSkewY(float sy) override;
     virtual void removeChild(Node* child, bool cleanup) override;
     virtual void removeAllChildrenWithCleanup(bool cleanup) override;
+    virtual void cleanup() override;
     virtual void reorderChild(Node *child, int zOrder) override;
     using Node::addChild;
     virtual void addChild(Node *child, int zOrder, int tag) override;
@@ -549,11 +600,28 @@ CC_CONSTRUCTOR_ACCESS:
      * @param PolygonInfo the polygon information object
      */
     void setPolygonInfo(const PolygonInfo& info);
+
+    /** Whether the sprite is a plain rectangle, its PolygonInfo is the quad of the sprite. */
+    bool isQuad() const { return _polyInfo.triangles.verts == (V3F_C4B_T2F*)&_quad && _polyInfo.triangles.vertCount == 4; }
 protected:
+    friend class SpriteAnimationSystem;
+    friend class SpriteAnimationTimeline;
+    friend class Label;
+
+    /// Gets the texture coordinates of `rect`, in points, on a texture, not flipped.
+    static void getTextureCoords(Texture2D* texture, Rect rect, bool rotated, float& left, float& right, float& top, float& bottom);
 
     void updateColor() override;
     virtual void setTextureCoords(Rect rect);
+    /// Sets the texture coordinates of the quad from the ones of the rect, flipped as the sprite is.
+    void setQuadTextureCoords(float left, float right, float top, float bottom);
+    /// Places the quad from the rect, the content size and the offset of the frame.
+    void updateQuadVertices();
+    /// Shows a frame of the animation, called by the SpriteAnimationSystem.
+    void showAnimationFrame(const SpriteAnimationTimeline::Frame& frame);
     virtual void updateBlendFunc();
+    virtual Node* cloneInstance() const override;
+    virtual bool isInternalChild(const Node* child) const override;
     virtual void setReorderChildDirtyRecursively();
     virtual void setDirtyRecursively(bool value);
 
@@ -603,6 +671,10 @@ protected:
     bool _flippedY;                         /// Whether the sprite is flipped vertically or not
 
     bool _insideBounds;                     /// whether or not the sprite was inside bounds the previous frame
+
+    int _animationIndex;                    /// the entry of the sprite in the SpriteAnimationSystem, -1 when not playing
+
+    bool _opaque;                           /// whether the sprite is flagged as opaque, see setOpaque()
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(Sprite);
 };
@@ -0,0 +1,356 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "2d/CCSpriteAnimation.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "2d/CCSprite.h"
+#include "2d/CCSpriteFrame.h"
+#include "base/CCDirector.h"
+#include "base/CCEventCustom.h"
+#include "base/CCEventDispatcher.h"
+#include "base/CCScheduler.h"
+#include "renderer/CCTexture2D.h"
+
+NS_CC_BEGIN
+
+// MARK: SpriteAnimationTimeline
+
+SpriteAnimationTimeline* SpriteAnimationTimeline::create(Animation* animation)
+{
+    SpriteAnimationTimeline* timeline = new (std::nothrow) SpriteAnimationTimeline();
+    if (timeline && timeline->initWithAnimation(animation))
+    {
+        timeline->autorelease();
+        return timeline;
+    }
+    CC_SAFE_DELETE(timeline);
+    return nullptr;
+}
+
+SpriteAnimationTimeline::SpriteAnimationTimeline()
+: _animation(nullptr)
+, _duration(0.0f)
+, _restoreOriginalFrame(false)
+{
+}
+
+SpriteAnimationTimeline::~SpriteAnimationTimeline()
+{
+    CC_SAFE_RELEASE(_animation);
+}
+
+bool SpriteAnimationTimeline::initWithAnimation(Animation* animation)
+{
+    CCASSERT(animation != nullptr, "SpriteAnimationTimeline: argument Animation must be non-nullptr");
+    if (animation == nullptr || animation->getFrames().empty())
+    {
+        return false;
+    }
+
+    // the frames point into the animation, it's kept alive with the timeline
+    _animation = animation;
+    _animation->retain();
+    _restoreOriginalFrame = animation->getRestoreOriginalFrame();
+
+    const float delayPerUnit = animation->getDelayPerUnit();
+    float accumUnitsOfTime = 0.0f;
+
+    auto& animationFrames = animation->getFrames();
+    _frames.reserve(animationFrames.size());
+    for (auto& animationFrame : animationFrames)
+    {
+        SpriteFrame* spriteFrame = animationFrame->getSpriteFrame();
+
+        Frame frame;
+        frame.spriteFrame = spriteFrame;
+        frame.texture = spriteFrame->getTexture();
+        frame.rect = spriteFrame->getRect();
+        frame.rotated = spriteFrame->isRotated();
+        frame.offset = spriteFrame->getOffset();
+        frame.originalSize = spriteFrame->getOriginalSize();
+        frame.left = frame.right = frame.top = frame.bottom = 0.0f;
+        if (frame.texture)
+        {
+            Sprite::getTextureCoords(frame.texture, frame.rect, frame.rotated, frame.left, frame.right, frame.top, frame.bottom);
+        }
+        frame.startTime = accumUnitsOfTime * delayPerUnit;
+        frame.userInfo = animationFrame->getUserInfo().empty() ? nullptr : &animationFrame->getUserInfo();
+        _frames.push_back(frame);
+
+        accumUnitsOfTime += animationFrame->getDelayUnits();
+    }
+    _duration = accumUnitsOfTime * delayPerUnit;
+
+    return true;
+}
+
+int SpriteAnimationTimeline::getFrameIndex(float time) const
+{
+    auto it = std::upper_bound(_frames.begin(), _frames.end(), time, [](float t, const Frame& frame) {
+        return t < frame.startTime;
+    });
+    return std::max(0, (int)(it - _frames.begin()) - 1);
+}
+
+// MARK: SpriteAnimationSystem
+
+SpriteAnimationSystem* SpriteAnimationSystem::s_sharedSpriteAnimationSystem = nullptr;
+
+SpriteAnimationSystem* SpriteAnimationSystem::getInstance()
+{
+    if (! s_sharedSpriteAnimationSystem)
+    {
+        s_sharedSpriteAnimationSystem = new (std::nothrow) SpriteAnimationSystem();
+        Director::getInstance()->getScheduler()->scheduleUpdate(s_sharedSpriteAnimationSystem, Scheduler::PRIORITY_SYSTEM, false);
+    }
+
+    return s_sharedSpriteAnimationSystem;
+}
+
+void SpriteAnimationSystem::destroyInstance()
+{
+    if (s_sharedSpriteAnimationSystem)
+    {
+        Director::getInstance()->getScheduler()->unscheduleUpdate(s_sharedSpriteAnimationSystem);
+        CC_SAFE_DELETE(s_sharedSpriteAnimationSystem);
+    }
+}
+
+SpriteAnimationSystem::SpriteAnimationSystem()
+: _updating(false)
+, _hasRemovedEntries(false)
+, _frameDisplayedEvent(nullptr)
+{
+    _frameDisplayedEventInfo.target = nullptr;
+    _frameDisplayedEventInfo.userInfo = nullptr;
+}
+
+SpriteAnimationSystem::~SpriteAnimationSystem()
+{
+    for (auto& entry : _entries)
+    {
+        if (entry.sprite)
+        {
+            entry.sprite->_animationIndex = -1;
+        }
+        CC_SAFE_RELEASE(entry.timeline);
+        CC_SAFE_RELEASE(entry.originalFrame);
+    }
+    CC_SAFE_RELEASE(_frameDisplayedEvent);
+}
+
+void SpriteAnimationSystem::play(Sprite* sprite, SpriteAnimationTimeline* timeline, unsigned int loops, float speed)
+{
+    CCASSERT(speed >= 0.0f, "SpriteAnimationSystem: the speed must not be negative");
+
+    if (sprite->_animationIndex >= 0)
+    {
+        stop(sprite, false);
+    }
+
+    auto& frames = timeline->getFrames();
+
+    Entry entry;
+    entry.sprite = sprite;
+    entry.timeline = timeline;
+    entry.timeline->retain();
+    entry.originalFrame = timeline->getRestoreOriginalFrame() ? sprite->getSpriteFrame() : nullptr;
+    CC_SAFE_RETAIN(entry.originalFrame);
+    entry.time = 0.0f;
+    entry.speed = speed;
+    entry.nextFrameTime = frames.size() > 1 ? frames[1].startTime : timeline->getDuration();
+    entry.frame = 0;
+    entry.loops = loops;
+    entry.loop = 0;
+
+    sprite->_animationIndex = (int)_entries.size();
+    _entries.push_back(entry);
+
+    sprite->showAnimationFrame(frames[0]);
+    if (frames[0].userInfo)
+    {
+        dispatchFrameDisplayed(sprite, frames[0].userInfo);
+    }
+}
+
+void SpriteAnimationSystem::stop(Sprite* sprite, bool restoreOriginalFrame)
+{
+    const int index = sprite->_animationIndex;
+    CCASSERT(index >= 0 && index < (int)_entries.size() && _entries[index].sprite == sprite, "SpriteAnimationSystem: the sprite isn't playing");
+
+    Entry& entry = _entries[index];
+    SpriteAnimationTimeline* timeline = entry.timeline;
+    SpriteFrame* originalFrame = entry.originalFrame;
+
+    sprite->_animationIndex = -1;
+    entry.sprite = nullptr;
+    entry.timeline = nullptr;
+    entry.originalFrame = nullptr;
+
+    // update() walks the entries by index, they are compacted once it's done
+    if (_updating)
+    {
+        _hasRemovedEntries = true;
+    }
+    else
+    {
+        removeEntry(index);
+    }
+
+    if (restoreOriginalFrame && originalFrame)
+    {
+        sprite->setSpriteFrame(originalFrame);
+    }
+    CC_SAFE_RELEASE(originalFrame);
+    timeline->release();
+}
+
+void SpriteAnimationSystem::setSpeed(Sprite* sprite, float speed)
+{
+    CCASSERT(speed >= 0.0f, "SpriteAnimationSystem: the speed must not be negative");
+    _entries[sprite->_animationIndex].speed = speed;
+}
+
+void SpriteAnimationSystem::removeEntry(int index)
+{
+    const int last = (int)_entries.size() - 1;
+    if (index != last)
+    {
+        _entries[index] = _entries[last];
+        if (_entries[index].sprite)
+        {
+            _entries[index].sprite->_animationIndex = index;
+        }
+    }
+    _entries.pop_back();
+}
+
+void SpriteAnimationSystem::dispatchFrameDisplayed(Sprite* sprite, const ValueMap* userInfo)
+{
+    if (_frameDisplayedEvent == nullptr)
+        _frameDisplayedEvent = new (std::nothrow) EventCustom(AnimationFrameDisplayedNotification);
+
+    _frameDisplayedEventInfo.target = sprite;
+    _frameDisplayedEventInfo.userInfo = userInfo;
+    _frameDisplayedEvent->setUserData(&_frameDisplayedEventInfo);
+    Director::getInstance()->getEventDispatcher()->dispatchEvent(_frameDisplayedEvent);
+}
+
+void SpriteAnimationSystem::update(float dt)
+{
+    _updating = true;
+
+    // the entries played from a listener start on the next tick
+    const size_t count = _entries.size();
+    for (size_t i = 0; i < count; ++i)
+    {
+        // not a reference, a listener may play animations and grow the vector
+        Sprite* sprite = _entries[i].sprite;
+        if (sprite == nullptr || !sprite->isRunning())
+        {
+            continue;
+        }
+
+        Entry& entry = _entries[i];
+        entry.time += dt * entry.speed;
+        if (entry.time < entry.nextFrameTime)
+        {
+            continue;
+        }
+
+        SpriteAnimationTimeline* timeline = entry.timeline;
+        auto& frames = timeline->getFrames();
+        const float duration = timeline->getDuration();
+
+        bool finished = false;
+        bool looped = false;
+        if (entry.time >= duration)
+        {
+            unsigned int loops = duration > 0.0f ? (unsigned int)(entry.time / duration) : 1;
+            if (entry.loops != 0 && entry.loop + loops >= entry.loops)
+            {
+                finished = true;
+            }
+            else
+            {
+                entry.loop += loops;
+                entry.time = duration > 0.0f ? fmodf(entry.time, duration) : 0.0f;
+                looped = true;
+            }
+        }
+
+        if (finished)
+        {
+            // like Animate, the last frame is shown before the original one is restored
+            // the user info is in the animation, the timeline is kept until it's dispatched
+            timeline->retain();
+            const auto& frame = frames.back();
+            if (entry.frame != (int)frames.size() - 1)
+            {
+                sprite->showAnimationFrame(frame);
+            }
+            stop(sprite, true);
+            if (frame.userInfo)
+            {
+                dispatchFrameDisplayed(sprite, frame.userInfo);
+            }
+            timeline->release();
+            continue;
+        }
+
+        const int index = timeline->getFrameIndex(entry.time);
+        entry.nextFrameTime = index + 1 < (int)frames.size() ? frames[index + 1].startTime : duration;
+        if (index == entry.frame && !looped)
+        {
+            continue;
+        }
+        entry.frame = index;
+
+        const auto& frame = frames[index];
+        sprite->showAnimationFrame(frame);
+        if (frame.userInfo)
+        {
+            dispatchFrameDisplayed(sprite, frame.userInfo);
+        }
+    }
+
+    _updating = false;
+
+    if (_hasRemovedEntries)
+    {
+        _hasRemovedEntries = false;
+        for (int i = (int)_entries.size() - 1; i >= 0; --i)
+        {
+            if (_entries[i].sprite == nullptr)
+            {
+                removeEntry(i);
+            }
+        }
+    }
+}
+
+NS_CC_END
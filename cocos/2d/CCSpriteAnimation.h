@@ -0,0 +1,173 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_SPRITE_ANIMATION_H__
+#define __CC_SPRITE_ANIMATION_H__
+
+#include <vector>
+
+#include "2d/CCAnimation.h"
+#include "base/CCRef.h"
+#include "base/CCVector.h"
+#include "math/CCGeometry.h"
+
+NS_CC_BEGIN
+
+class EventCustom;
+class Sprite;
+class SpriteFrame;
+class Texture2D;
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/** @class SpriteAnimationTimeline
+ @brief The frames of an Animation laid out for SpriteAnimationSystem: the start time of each frame and its texture
+ coordinates, computed once. It is immutable and shared by all the sprites playing the animation, see
+ AnimationCache::getTimeline() and Sprite::playAnimation().
+ @since v3.11
+ @js NA
+ @lua NA
+ */
+class CC_DLL SpriteAnimationTimeline : public Ref
+{
+public:
+    /** A frame, as Sprite::setSpriteFrame() would show it. */
+    struct Frame
+    {
+        SpriteFrame* spriteFrame;
+        Texture2D* texture;
+        Rect rect;
+        bool rotated;
+        Vec2 offset;
+        Size originalSize;
+        // the texture coordinates of the rect, not flipped
+        float left, right, top, bottom;
+        // the time the frame is shown at, in seconds
+        float startTime;
+        // the user info of the AnimationFrame, nullptr when it's empty
+        const ValueMap* userInfo;
+    };
+
+    /** Creates the timeline of an animation. The animation must not change afterwards. */
+    static SpriteAnimationTimeline* create(Animation* animation);
+
+    const std::vector<Frame>& getFrames() const { return _frames; }
+    /** Gets the duration of one loop, in seconds. */
+    float getDuration() const { return _duration; }
+    /** Whether the sprite shows its frame from before the animation once it's done, see Animation::setRestoreOriginalFrame(). */
+    bool getRestoreOriginalFrame() const { return _restoreOriginalFrame; }
+    Animation* getAnimation() const { return _animation; }
+
+    /** Gets the index of the frame shown at `time`, between 0 and the duration. */
+    int getFrameIndex(float time) const;
+
+protected:
+    SpriteAnimationTimeline();
+    virtual ~SpriteAnimationTimeline();
+    bool initWithAnimation(Animation* animation);
+
+    Animation* _animation;
+    std::vector<Frame> _frames;
+    float _duration;
+    bool _restoreOriginalFrame;
+
+private:
+    CC_DISALLOW_COPY_AND_ASSIGN(SpriteAnimationTimeline);
+};
+
+/** @class SpriteAnimationSystem
+ @brief Plays the frame animations of the sprites in one update, instead of an Animate action per sprite stepped by
+ the ActionManager, see Sprite::playAnimation().
+ The playing sprites are kept in an array. Each frame, update() advances their time and only touches the sprites whose
+ frame changed: it sets the texture coordinates, the vertices and the content size of the new frame, without the
+ texture, blend function and shader checks of Sprite::setSpriteFrame(), which only happen when the frame is on another
+ texture. It is scheduled with the system priority, like the ActionManager, and skips the sprites that aren't running.
+ The AnimationFrameDisplayedNotification event is dispatched when the frame shown has user info. Unlike Animate, the
+ frames skipped over in a long tick don't dispatch it.
+ @since v3.11
+ @js NA
+ @lua NA
+ */
+class CC_DLL SpriteAnimationSystem
+{
+public:
+    /** Returns the shared system, scheduled on the scheduler of the Director. */
+    static SpriteAnimationSystem* getInstance();
+
+    /** Stops all the animations and deletes the shared system. */
+    static void destroyInstance();
+
+    /** Advances the animations, called by the Scheduler. */
+    void update(float dt);
+
+    /** Gets the number of sprites playing an animation. */
+    ssize_t getSpriteCount() const { return (ssize_t)_entries.size(); }
+
+protected:
+    friend class Sprite;
+
+    SpriteAnimationSystem();
+    ~SpriteAnimationSystem();
+
+    void play(Sprite* sprite, SpriteAnimationTimeline* timeline, unsigned int loops, float speed);
+    void stop(Sprite* sprite, bool restoreOriginalFrame);
+    void setSpeed(Sprite* sprite, float speed);
+    void removeEntry(int index);
+    void dispatchFrameDisplayed(Sprite* sprite, const ValueMap* userInfo);
+
+    struct Entry
+    {
+        Sprite* sprite;
+        SpriteAnimationTimeline* timeline;
+        // the frame of the sprite before the animation, when the timeline restores it
+        SpriteFrame* originalFrame;
+        float time;
+        float speed;
+        // the time the next frame starts at
+        float nextFrameTime;
+        int frame;
+        unsigned int loops;
+        unsigned int loop;
+    };
+
+    std::vector<Entry> _entries;
+    // the entries stopped during update() are removed after it
+    bool _updating;
+    bool _hasRemovedEntries;
+
+    EventCustom* _frameDisplayedEvent;
+    AnimationFrame::DisplayedEventInfo _frameDisplayedEventInfo;
+
+    static SpriteAnimationSystem* s_sharedSpriteAnimationSystem;
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif // __CC_SPRITE_ANIMATION_H__
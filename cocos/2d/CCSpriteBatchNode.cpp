@@ -33,6 +33,9 @@ THE SOFTWARE.
 #include "renderer/CCRenderer.h"
 #include "renderer/CCQuadCommand.h"
 #include "base/CCString.h"
+#include "base/CCTracer.h"
+
+#include <algorithm>
 
 NS_CC_BEGIN
 
@@ -127,7 +130,7 @@ SpriteBatchNode::~SpriteBatchNode()
 // don't call visit on it's children
 void SpriteBatchNode::visit(Renderer *renderer, const Mat4 &parentTransform, uint32_t parentFlags)
 {
-    CC_PROFILER_START_CATEGORY(kProfilerCategoryBatchSprite, "CCSpriteBatchNode - visit");
+    CC_TRACE_ZONE("batch_sprite", "SpriteBatchNode::visit");
 
     // CAREFUL:
     // This visit is almost identical to CocosNode#visit
@@ -151,11 +154,10 @@ void SpriteBatchNode::visit(Renderer *renderer, const Mat4 &parentTransform, uin
     _director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
     _director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, _modelViewTransform);
 
+    Renderer::setDebugOwner(this);
     draw(renderer, _modelViewTransform, flags);
 
     _director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
-
-    CC_PROFILER_STOP_CATEGORY(kProfilerCategoryBatchSprite, "CCSpriteBatchNode - visit");
 }
 
 void SpriteBatchNode::addChild(Node *child, int zOrder, int tag)
@@ -229,12 +231,16 @@ void SpriteBatchNode::removeAllChildrenWithCleanup(bool doCleanup)
     // Invalidate atlas index. issue #569
     // useSelfRender should be performed on all descendants. issue #1216
     for(const auto &sprite: _descendants) {
-        sprite->setBatchNode(nullptr);
+        if (sprite)
+        {
+            sprite->setBatchNode(nullptr);
+        }
     }
 
     Node::removeAllChildrenWithCleanup(doCleanup);
 
     _descendants.clear();
+    _atlasHoles.clear();
     if (_textureAtlas)
     {
         _textureAtlas->removeAllQuads();
@@ -244,18 +250,30 @@ void SpriteBatchNode::removeAllChildrenWithCleanup(bool doCleanup)
 //override sortAllChildren
 void SpriteBatchNode::sortAllChildren()
 {
-    if (_reorderChildDirty)
+    // updateAtlasIndex() expects one descendant per quad
+    compactAtlas();
+
+    if (_reorderChildDirty || _childOrder != ChildOrder::LOCAL_Z_ORDER)
     {
-        std::sort(std::begin(_children), std::end(_children), nodeComparisonLess);
+        bool changed = sortChildren();
 
         //sorted now check all children
         if (!_children.empty())
         {
             //first sort all children recursively based on zOrder
             for(const auto &child: _children) {
-                child->sortAllChildren();
+                if (!child->getChildren().empty())
+                {
+                    // a reorder under a child sprite dirties the batch node too, the atlas indices may have changed
+                    changed = true;
+                    child->sortAllChildren();
+                }
             }
+        }
 
+        // the quads are already in order when no sprite moved
+        if (changed && !_children.empty())
+        {
             ssize_t index=0;
 
             //fast dispatch, give every child a new atlasIndex based on their relative zOrder (keep parent -> child relations intact)
@@ -551,26 +569,33 @@ void SpriteBatchNode::removeSpriteFromAtlas(Sprite *sprite)
         return;
     }
 
-    // remove from TextureAtlas
-    _textureAtlas->removeQuadAtIndex(sprite->getAtlasIndex());
-
-    // Cleanup sprite. It might be reused (issue #569)
-    sprite->setBatchNode(nullptr);
-
-    auto it = std::find(_descendants.begin(), _descendants.end(), sprite );
-    if( it != _descendants.end() )
+    // Shifting the quads and the atlas indices of the following sprites is O(n) per removal, so the quad is only
+    // cleared here and the holes are closed together by compactAtlas() before the next sort or draw.
+    // The atlas indices of the other sprites stay valid until then.
+    ssize_t atlasIndex = sprite->getAtlasIndex();
+    ssize_t descendantIndex = atlasIndex;
+    if (descendantIndex < 0 || descendantIndex >= static_cast<ssize_t>(_descendants.size()) || _descendants[descendantIndex] != sprite)
     {
-        auto next = std::next(it);
+        // the atlas index isn't the position in _descendants after addSpriteWithoutQuad()
+        auto it = std::find(_descendants.begin(), _descendants.end(), sprite);
+        descendantIndex = it != _descendants.end() ? std::distance(_descendants.begin(), it) : -1;
+    }
 
-        Sprite *spr = nullptr;
-        for(; next != _descendants.end(); ++next) {
-            spr = *next;
-            spr->setAtlasIndex( spr->getAtlasIndex() - 1 );
+    if (descendantIndex >= 0)
+    {
+        if (atlasIndex >= 0 && atlasIndex < _textureAtlas->getTotalQuads())
+        {
+            // a zero-sized quad draws nothing
+            V3F_C4B_T2F_Quad emptyQuad = V3F_C4B_T2F_Quad();
+            _textureAtlas->updateQuad(&emptyQuad, atlasIndex);
+            _atlasHoles.push_back(atlasIndex);
         }
-
-        _descendants.erase(it);
+        _descendants[descendantIndex] = nullptr;
     }
 
+    // Cleanup sprite. It might be reused (issue #569)
+    sprite->setBatchNode(nullptr);
+
     // remove children recursively
     auto& children = sprite->getChildren();
     for(const auto &obj: children) {
@@ -582,6 +607,64 @@ void SpriteBatchNode::removeSpriteFromAtlas(Sprite *sprite)
     }
 }
 
+void SpriteBatchNode::compactAtlas()
+{
+    if (_atlasHoles.empty())
+    {
+        return;
+    }
+
+    std::sort(_atlasHoles.begin(), _atlasHoles.end());
+
+    // move the quads down over the holes
+    ssize_t totalQuads = _textureAtlas->getTotalQuads();
+    ssize_t firstHole = _atlasHoles.front();
+    auto quads = _textureAtlas->getQuads();
+    ssize_t write = firstHole;
+    size_t hole = 0;
+    for (ssize_t read = firstHole; read < totalQuads; ++read)
+    {
+        if (hole < _atlasHoles.size() && _atlasHoles[hole] == read)
+        {
+            ++hole;
+            continue;
+        }
+        quads[write++] = quads[read];
+    }
+    _textureAtlas->removeQuadsAtIndex(write, totalQuads - write);
+
+    // _descendants is sorted by atlas index: each sprite moves down by the number of holes below it
+    size_t count = 0;
+    hole = 0;
+    for (const auto &sprite : _descendants)
+    {
+        if (sprite == nullptr)
+        {
+            continue;
+        }
+        ssize_t atlasIndex = sprite->getAtlasIndex();
+        while (hole < _atlasHoles.size() && _atlasHoles[hole] < atlasIndex)
+        {
+            ++hole;
+        }
+        if (hole > 0)
+        {
+            sprite->setAtlasIndex(atlasIndex - static_cast<ssize_t>(hole));
+        }
+        _descendants[count++] = sprite;
+    }
+    _descendants.resize(count);
+
+    _atlasHoles.clear();
+}
+
+const std::vector<Sprite*>& SpriteBatchNode::getDescendants() const
+{
+    // the holes are an implementation detail, don't let them out
+    const_cast<SpriteBatchNode*>(this)->compactAtlas();
+    return _descendants;
+}
+
 void SpriteBatchNode::updateBlendFunc()
 {
     if (! _textureAtlas->getTexture()->hasPremultipliedAlpha())
@@ -687,16 +770,15 @@ SpriteBatchNode* SpriteBatchNode::addSpriteWithoutQuad(Sprite*child, int z, int
         return this;
     }
 
+    // the binary search needs _descendants without holes
+    compactAtlas();
+
     // quad index is Z
     child->setAtlasIndex(z);
 
-    // FIXME:: optimize with a binary search
-    auto it = _descendants.begin();
-    for (; it != _descendants.end(); ++it)
-    {
-        if((*it)->getAtlasIndex() >= z)
-            break;
-    }
+    auto it = std::lower_bound(_descendants.begin(), _descendants.end(), z, [](const Sprite* sprite, int index) {
+        return sprite->getAtlasIndex() < index;
+    });
 
     _descendants.insert(it, child);
 
@@ -111,7 +111,7 @@ public:
      *
      * @return An array with the descendants (children, gran children, etc.).
      */
-    inline const std::vector<Sprite*>& getDescendants() const { return _descendants; }
+    const std::vector<Sprite*>& getDescendants() const;
 
     /** Increase the Atlas Capacity. */
     void increaseAtlasCapacity();
@@ -120,7 +120,6 @@ public:
      *
      * @param index A certain index.
      * @param doCleanup Whether or not to cleanup the running actions.
-     * @warning Removing a child from a SpriteBatchNode is very slow.
      */
     void removeChildAtIndex(ssize_t index, bool doCleanup);
 
@@ -131,6 +130,7 @@ public:
     void appendChild(Sprite* sprite);
 
     /** Remove a sprite from Atlas.
+     * Its quad is cleared and left as a hole, the atlas is compacted once before the next sort or draw.
      *
      * @param sprite A Sprite.
      */
@@ -254,6 +254,8 @@ protected:
     void updateQuadFromSprite(Sprite *sprite, ssize_t index);
 
     void updateAtlasIndex(Sprite* sprite, ssize_t* curIndex);
+    /* Closes the holes left by removeSpriteFromAtlas() in the quads and _descendants, in one pass. */
+    void compactAtlas();
     void swap(ssize_t oldIndex, ssize_t newIndex);
     void updateBlendFunc();
 
@@ -265,6 +267,8 @@ protected:
     // There is not need to retain/release these objects, since they are already retained by _children
     // So, using std::vector<Sprite*> is slightly faster than using cocos2d::Array for this particular case
     std::vector<Sprite*> _descendants;
+    // the atlas indices of the sprites removed since the last compactAtlas(), their _descendants entries are nullptr
+    std::vector<ssize_t> _atlasHoles;
 };
 
 // end of sprite_nodes group
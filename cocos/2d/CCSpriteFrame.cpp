@@ -135,10 +135,19 @@ SpriteFrame* SpriteFrame::clone() const
     SpriteFrame *copy = new (std::nothrow) SpriteFrame();
     copy->initWithTextureFilename(_textureFilename, _rectInPixels, _rotated, _offsetInPixels, _originalSizeInPixels);
     copy->setTexture(_texture);
+    if (hasPolygonInfo())
+    {
+        copy->setPolygonInfo(_polygonInfo);
+    }
     copy->autorelease();
     return copy;
 }
 
+void SpriteFrame::setPolygonInfo(const PolygonInfo& polygonInfo)
+{
+    _polygonInfo = polygonInfo;
+}
+
 void SpriteFrame::setRect(const Rect& rect)
 {
     _rect = rect;
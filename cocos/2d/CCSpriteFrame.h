@@ -31,6 +31,7 @@ THE SOFTWARE.
 #include "2d/CCNode.h"
 #include "base/CCRef.h"
 #include "math/CCGeometry.h"
+#include "2d/CCAutoPolygon.h"
 
 NS_CC_BEGIN
 
@@ -187,6 +188,16 @@ public:
      */
     void setOffset(const Vec2& offsets);
 
+    /** Sets the tight mesh of the frame: its vertices are in points in the untrimmed frame, its uvs in the texture.
+     * The sprites showing the frame draw it instead of their quad, see SpriteFrameCache::generatePolygons().
+     * @since v3.11
+     */
+    void setPolygonInfo(const PolygonInfo& polygonInfo);
+    /** The tight mesh of the frame, empty if it has none. */
+    const PolygonInfo& getPolygonInfo() const { return _polygonInfo; }
+    /** Whether the frame has a tight mesh. */
+    bool hasPolygonInfo() const { return _polygonInfo.triangles.vertCount > 0; }
+
     // Overrides
     virtual SpriteFrame *clone() const override;
 
@@ -233,6 +244,7 @@ protected:
     Size _originalSizeInPixels;
     Texture2D *_texture;
     std::string  _textureFilename;
+    PolygonInfo _polygonInfo;
 };
 
 // end of _2d group
@@ -29,6 +29,10 @@ THE SOFTWARE.
 
 #include "2d/CCSpriteFrameCache.h"
 
+#include <string.h>
+#include <algorithm>
+#include <sstream>
+#include <unordered_map>
 #include <vector>
 
 
@@ -41,6 +45,10 @@ THE SOFTWARE.
 #include "renderer/CCTextureCache.h"
 #include "base/CCNinePatchImageParser.h"
 #include "base/CCString.h"
+#include "base/CCAsyncTaskPool.h"
+#include "base/CCScheduler.h"
+#include "base/ccUtils.h"
+#include "platform/CCImage.h"
 
 using namespace std;
 
@@ -48,6 +56,44 @@ NS_CC_BEGIN
 
 static SpriteFrameCache *_sharedSpriteFrameCache = nullptr;
 
+static const char* ASYNC_SCHEDULE_KEY = "SpriteFrameCache.async";
+
+struct SpriteFrameCache::SheetFrame
+{
+    std::string name;
+    Rect rect;
+    bool rotated;
+    Vec2 offset;
+    Size sourceSize;
+    std::vector<std::string> aliases;
+    std::vector<float> vertices;
+    std::vector<float> uvs;
+    std::vector<unsigned short> indices;
+    // the cap insets of a "name.9.png" frame, parsed with the file by addSpriteFramesWithFileAsync()
+    bool hasCapInsets;
+    Rect capInsets;
+
+    SheetFrame() : rotated(false), hasCapInsets(false) {}
+};
+
+struct SpriteFrameCache::AsyncSheet
+{
+    std::string plist;
+    std::string fullPath;
+    // set by the loader thread
+    std::string texturePath;
+    std::vector<SheetFrame> frames;
+    bool read;
+    // set on the main thread
+    std::vector<std::function<void(bool)>> callbacks;
+    Texture2D* texture;
+    size_t next;
+    // the cache was destroyed, the loads that finish later are ignored
+    bool cancelled;
+
+    AsyncSheet() : read(false), texture(nullptr), next(0), cancelled(false) {}
+};
+
 SpriteFrameCache* SpriteFrameCache::getInstance()
 {
     if (! _sharedSpriteFrameCache)
@@ -74,9 +120,196 @@ bool SpriteFrameCache::init()
 
 SpriteFrameCache::~SpriteFrameCache()
 {
+    if (! _asyncSheets.empty())
+    {
+        for (const auto& sheet : _asyncSheets)
+        {
+            sheet->cancelled = true;
+            CC_SAFE_RELEASE_NULL(sheet->texture);
+        }
+        Director::DirectorInstance->getScheduler()->unschedule(ASYNC_SCHEDULE_KEY, this);
+    }
     CC_SAFE_DELETE(_loadedFileNames);
 }
 
+// reads the frame of a plist in `rect`, `rotated`, `offset` and `sourceSize`, the arguments of SpriteFrame::createWithTexture()
+static void readFrameDictionary(ValueMap& frameDict, int format, Rect& rect, bool& rotated, Vec2& offset, Size& sourceSize)
+{
+    rotated = false;
+
+    if(format == 0)
+    {
+        float x = frameDict["x"].asFloat();
+        float y = frameDict["y"].asFloat();
+        float w = frameDict["width"].asFloat();
+        float h = frameDict["height"].asFloat();
+        float ox = frameDict["offsetX"].asFloat();
+        float oy = frameDict["offsetY"].asFloat();
+        int ow = frameDict["originalWidth"].asInt();
+        int oh = frameDict["originalHeight"].asInt();
+        // check ow/oh
+        if(!ow || !oh)
+        {
+            CCLOGWARN("cocos2d: WARNING: originalWidth/Height not found on the SpriteFrame. AnchorPoint won't work as expected. Regenerate the .plist");
+        }
+        // abs ow/oh
+        ow = abs(ow);
+        oh = abs(oh);
+
+        rect = Rect(x, y, w, h);
+        offset = Vec2(ox, oy);
+        sourceSize = Size((float)ow, (float)oh);
+    }
+    else if(format == 1 || format == 2)
+    {
+        rect = RectFromString(frameDict["frame"].asString());
+
+        // rotation
+        if (format == 2)
+        {
+            rotated = frameDict["rotated"].asBool();
+        }
+
+        offset = PointFromString(frameDict["offset"].asString());
+        sourceSize = SizeFromString(frameDict["sourceSize"].asString());
+    }
+    else if (format == 3)
+    {
+        // get values
+        Size spriteSize = SizeFromString(frameDict["spriteSize"].asString());
+        Rect textureRect = RectFromString(frameDict["textureRect"].asString());
+
+        rect = Rect(textureRect.origin.x, textureRect.origin.y, spriteSize.width, spriteSize.height);
+        rotated = frameDict["textureRotated"].asBool();
+        offset = PointFromString(frameDict["spriteOffset"].asString());
+        sourceSize = SizeFromString(frameDict["spriteSourceSize"].asString());
+    }
+}
+
+// reads the numbers separated by spaces of a "vertices", "verticesUV" or "triangles" key
+template <typename T>
+static void readNumbers(ValueMap& frameDict, const char* key, std::vector<T>& numbers)
+{
+    numbers.clear();
+    auto iter = frameDict.find(key);
+    if (iter == frameDict.end())
+    {
+        return;
+    }
+    std::istringstream stream(iter->second.asString());
+    float n;
+    while (stream >> n)
+    {
+        numbers.push_back((T)n);
+    }
+}
+
+void SpriteFrameCache::readDictionaryFrame(ValueMap& frameDict, int format, SheetFrame& frame)
+{
+    readFrameDictionary(frameDict, format, frame.rect, frame.rotated, frame.offset, frame.sourceSize);
+
+    frame.aliases.clear();
+    if (format == 3)
+    {
+        for (const auto& value : frameDict["aliases"].asValueVector())
+        {
+            frame.aliases.push_back(value.asString());
+        }
+    }
+
+    // the mesh written by generatePolygons() or TexturePacker
+    readNumbers(frameDict, "vertices", frame.vertices);
+    readNumbers(frameDict, "verticesUV", frame.uvs);
+    readNumbers(frameDict, "triangles", frame.indices);
+}
+
+// the tight mesh of a frame from the pixels of its outline, y down in the untrimmed frame, and of the texture
+static void initPolygonInfo(SpriteFrame* spriteFrame, const std::vector<float>& vertices, const std::vector<float>& uvs, const std::vector<unsigned short>& indices)
+{
+    const size_t vertCount = vertices.size() / 2;
+    if (vertCount < 3 || uvs.size() != vertices.size() || indices.size() < 3 || vertCount > 0xffff)
+    {
+        return;
+    }
+    for (auto index : indices)
+    {
+        if (index >= vertCount)
+        {
+            CCLOG("cocos2d: SpriteFrameCache: invalid triangles in a sprite frame mesh");
+            return;
+        }
+    }
+
+    Texture2D* texture = spriteFrame->getTexture();
+    const float sourceHeight = spriteFrame->getOriginalSizeInPixels().height;
+    const float scale = CC_CONTENT_SCALE_FACTOR();
+    const float atlasWidth = (float)texture->getPixelsWide();
+    const float atlasHeight = (float)texture->getPixelsHigh();
+
+    std::vector<V3F_C4B_T2F> verts(vertCount);
+    for (size_t i = 0; i < vertCount; ++i)
+    {
+        auto& v = verts[i];
+        v.vertices.set(vertices[i * 2] / scale, (sourceHeight - vertices[i * 2 + 1]) / scale, 0.0f);
+        v.colors = Color4B::WHITE;
+        v.texCoords.u = uvs[i * 2] / atlasWidth;
+        v.texCoords.v = uvs[i * 2 + 1] / atlasHeight;
+    }
+
+    // the frame copies the arrays
+    TrianglesCommand::Triangles triangles;
+    triangles.verts = verts.data();
+    triangles.indices = const_cast<unsigned short*>(indices.data());
+    triangles.vertCount = (int)vertCount;
+    triangles.indexCount = (int)indices.size();
+
+    PolygonInfo info;
+    info.setTriangles(triangles);
+    info.rect = spriteFrame->getRectInPixels();
+    spriteFrame->setPolygonInfo(info);
+}
+
+// the cap insets of the frames named like "name.9.png", `image` is loaded for the first one
+void SpriteFrameCache::addNinePatchCapInset(SpriteFrame* spriteFrame, const std::string& spriteFrameName, Texture2D* texture, const std::string& textureFileName, Image*& image)
+{
+    if (NinePatchImageParser::isNinePatchImage(spriteFrameName))
+    {
+        if (image == nullptr)
+        {
+            image = new (std::nothrow) Image;
+            image->initWithImageFile(textureFileName);
+        }
+        NinePatchImageParser parser;
+        parser.setSpriteFrameInfo(image, spriteFrame->getRectInPixels(), spriteFrame->isRotated());
+        texture->addSpriteFrameCapInset(spriteFrame, parser.parseCapInset());
+    }
+}
+
+SpriteFrame* SpriteFrameCache::addSheetFrame(const SheetFrame& frame, Texture2D* texture)
+{
+    if (_spriteFrames.at(frame.name))
+    {
+        return nullptr;
+    }
+
+    for (const auto& alias : frame.aliases)
+    {
+        if (_spriteFramesAliases.find(alias) != _spriteFramesAliases.end())
+        {
+            CCLOGWARN("cocos2d: WARNING: an alias with name %s already exists", alias.c_str());
+        }
+        _spriteFramesAliases[alias] = Value(frame.name);
+    }
+
+    SpriteFrame* spriteFrame = SpriteFrame::createWithTexture(texture, frame.rect, frame.rotated, frame.offset, frame.sourceSize);
+    if (! frame.vertices.empty())
+    {
+        initPolygonInfo(spriteFrame, frame.vertices, frame.uvs, frame.indices);
+    }
+    _spriteFrames.insert(frame.name, spriteFrame);
+    return spriteFrame;
+}
+
 void SpriteFrameCache::addSpriteFramesWithDictionary(ValueMap& dictionary, Texture2D* texture)
 {
     /*
@@ -118,111 +351,588 @@ void SpriteFrameCache::addSpriteFramesWithDictionary(ValueMap& dictionary, Textu
     }
 
     Image* image = nullptr;
+    SheetFrame frame;
 
     for (auto iter = framesDict.begin(); iter != framesDict.end(); ++iter)
     {
-        ValueMap& frameDict = iter->second.asValueMap();
-        std::string spriteFrameName = iter->first;
-        SpriteFrame* spriteFrame = _spriteFrames.at(spriteFrameName);
-        if (spriteFrame)
+        frame.name = iter->first;
+        if (_spriteFrames.at(frame.name))
         {
             continue;
         }
 
-        if(format == 0)
+        readDictionaryFrame(iter->second.asValueMap(), format, frame);
+        SpriteFrame* spriteFrame = addSheetFrame(frame, texture);
+        addNinePatchCapInset(spriteFrame, frame.name, texture, textureFileName, image);
+    }
+    CC_SAFE_DELETE(image);
+}
+
+namespace
+{
+    /*
+     The binary sprite frames written by SpriteFrameCache::convertPlistToBinary(), little endian:
+
+         "CCSF", u16 version, u16 reserved, u32 frameCount, string textureFileName
+         frameCount times:
+             string name, f32 x, y, width, height, u8 rotated, f32 offsetX, offsetY, sourceWidth, sourceHeight,
+             u16 aliasCount, aliasCount strings,
+             u16 vertexCount, vertexCount times f32 x, y, u, v in pixels, u16 indexCount, indexCount u16 (version 2)
+
+     A string is a u16 length followed by the bytes, without terminator.
+     */
+    const char BINARY_MAGIC[4] = { 'C', 'C', 'S', 'F' };
+    const unsigned short BINARY_VERSION = 2;
+
+    class BinaryReader
+    {
+    public:
+        BinaryReader(const unsigned char* data, ssize_t size)
+        : _p(data)
+        , _end(data + size)
+        , _ok(true)
+        , _version(0)
+        {}
+
+        bool isOK() const { return _ok; }
+        unsigned short getVersion() const { return _version; }
+
+        bool readHeader(unsigned int& frameCount, std::string& textureFileName)
         {
-            float x = frameDict["x"].asFloat();
-            float y = frameDict["y"].asFloat();
-            float w = frameDict["width"].asFloat();
-            float h = frameDict["height"].asFloat();
-            float ox = frameDict["offsetX"].asFloat();
-            float oy = frameDict["offsetY"].asFloat();
-            int ow = frameDict["originalWidth"].asInt();
-            int oh = frameDict["originalHeight"].asInt();
-            // check ow/oh
-            if(!ow || !oh)
+            if (! has(8) || memcmp(_p, BINARY_MAGIC, 4) != 0)
             {
-                CCLOGWARN("cocos2d: WARNING: originalWidth/Height not found on the SpriteFrame. AnchorPoint won't work as expected. Regenerate the .plist");
+                return false;
             }
-            // abs ow/oh
-            ow = abs(ow);
-            oh = abs(oh);
-            // create frame
-            spriteFrame = SpriteFrame::createWithTexture(texture,
-                                                         Rect(x, y, w, h),
-                                                         false,
-                                                         Vec2(ox, oy),
-                                                         Size((float)ow, (float)oh)
-                                                         );
-        }
-        else if(format == 1 || format == 2)
-        {
-            Rect frame = RectFromString(frameDict["frame"].asString());
-            bool rotated = false;
-
-            // rotation
-            if (format == 2)
+            _p += 4;
+            _version = readU16();
+            if (_version == 0 || _version > BINARY_VERSION)
             {
-                rotated = frameDict["rotated"].asBool();
+                CCLOG("cocos2d: SpriteFrameCache: unsupported binary sprite frames version");
+                return false;
             }
+            readU16();
+            frameCount = readU32();
+            readString(textureFileName);
+            return _ok;
+        }
 
-            Vec2 offset = PointFromString(frameDict["offset"].asString());
-            Size sourceSize = SizeFromString(frameDict["sourceSize"].asString());
+        unsigned char readU8()
+        {
+            if (! has(1)) return 0;
+            return *_p++;
+        }
 
-            // create frame
-            spriteFrame = SpriteFrame::createWithTexture(texture,
-                                                         frame,
-                                                         rotated,
-                                                         offset,
-                                                         sourceSize
-                                                         );
+        unsigned short readU16()
+        {
+            if (! has(2)) return 0;
+            unsigned short v = (unsigned short)(_p[0] | (_p[1] << 8));
+            _p += 2;
+            return v;
         }
-        else if (format == 3)
+
+        unsigned int readU32()
+        {
+            if (! has(4)) return 0;
+            unsigned int v = (unsigned int)_p[0] | ((unsigned int)_p[1] << 8) | ((unsigned int)_p[2] << 16) | ((unsigned int)_p[3] << 24);
+            _p += 4;
+            return v;
+        }
+
+        float readFloat()
+        {
+            unsigned int bits = readU32();
+            float v;
+            memcpy(&v, &bits, sizeof(v));
+            return v;
+        }
+
+        void readString(std::string& str)
+        {
+            unsigned short length = readU16();
+            if (! has(length))
+            {
+                str.clear();
+                return;
+            }
+            str.assign(reinterpret_cast<const char*>(_p), length);
+            _p += length;
+        }
+
+    private:
+        bool has(ssize_t count)
+        {
+            if (_end - _p < count)
+            {
+                _ok = false;
+            }
+            return _ok;
+        }
+
+        const unsigned char* _p;
+        const unsigned char* _end;
+        bool _ok;
+        unsigned short _version;
+    };
+
+    class BinaryWriter
+    {
+    public:
+        void writeU8(unsigned char v) { _bytes.push_back(v); }
+        void writeU16(unsigned short v) { writeU8(v & 0xff); writeU8(v >> 8); }
+        void writeU32(unsigned int v) { writeU16(v & 0xffff); writeU16(v >> 16); }
+        void writeFloat(float v)
         {
-            // get values
-            Size spriteSize = SizeFromString(frameDict["spriteSize"].asString());
-            Vec2 spriteOffset = PointFromString(frameDict["spriteOffset"].asString());
-            Size spriteSourceSize = SizeFromString(frameDict["spriteSourceSize"].asString());
-            Rect textureRect = RectFromString(frameDict["textureRect"].asString());
-            bool textureRotated = frameDict["textureRotated"].asBool();
+            unsigned int bits;
+            memcpy(&bits, &v, sizeof(bits));
+            writeU32(bits);
+        }
+        void writeString(const std::string& str)
+        {
+            CCASSERT(str.length() <= 0xffff, "SpriteFrameCache: the name is too long");
+            writeU16((unsigned short)str.length());
+            _bytes.insert(_bytes.end(), str.begin(), str.end());
+        }
+
+        std::vector<unsigned char> _bytes;
+    };
+
+    bool isBinarySpriteFrames(const unsigned char* data, ssize_t size)
+    {
+        return data && size >= 4 && memcmp(data, BINARY_MAGIC, 4) == 0;
+    }
+}
+
+bool SpriteFrameCache::convertPlistToBinary(const std::string& plist, const std::string& binaryFullPath)
+{
+    ValueMap dict = FileUtils::getInstance()->getValueMapFromFile(plist);
+    if (dict.empty() || dict.find("frames") == dict.end())
+    {
+        CCLOG("cocos2d: SpriteFrameCache: can not read %s", plist.c_str());
+        return false;
+    }
+
+    int format = 0;
+    std::string textureFileName;
+    if (dict.find("metadata") != dict.end())
+    {
+        ValueMap& metadataDict = dict["metadata"].asValueMap();
+        format = metadataDict["format"].asInt();
+        textureFileName = metadataDict["textureFileName"].asString();
+    }
+    if (format < 0 || format > 3)
+    {
+        CCLOG("cocos2d: SpriteFrameCache: the format of %s is not supported", plist.c_str());
+        return false;
+    }
+
+    ValueMap& framesDict = dict["frames"].asValueMap();
+
+    BinaryWriter writer;
+    writer._bytes.insert(writer._bytes.end(), BINARY_MAGIC, BINARY_MAGIC + 4);
+    writer.writeU16(BINARY_VERSION);
+    writer.writeU16(0);
+    writer.writeU32((unsigned int)framesDict.size());
+    writer.writeString(textureFileName);
+
+    Rect rect;
+    bool rotated;
+    Vec2 offset;
+    Size sourceSize;
+    std::vector<float> vertices, uvs;
+    std::vector<unsigned short> indices;
 
-            // get aliases
+    for (auto iter = framesDict.begin(); iter != framesDict.end(); ++iter)
+    {
+        ValueMap& frameDict = iter->second.asValueMap();
+        readFrameDictionary(frameDict, format, rect, rotated, offset, sourceSize);
+
+        writer.writeString(iter->first);
+        writer.writeFloat(rect.origin.x);
+        writer.writeFloat(rect.origin.y);
+        writer.writeFloat(rect.size.width);
+        writer.writeFloat(rect.size.height);
+        writer.writeU8(rotated ? 1 : 0);
+        writer.writeFloat(offset.x);
+        writer.writeFloat(offset.y);
+        writer.writeFloat(sourceSize.width);
+        writer.writeFloat(sourceSize.height);
+
+        if (format == 3)
+        {
             ValueVector& aliases = frameDict["aliases"].asValueVector();
+            writer.writeU16((unsigned short)aliases.size());
+            for (const auto& value : aliases)
+            {
+                writer.writeString(value.asString());
+            }
+        }
+        else
+        {
+            writer.writeU16(0);
+        }
+
+        readNumbers(frameDict, "vertices", vertices);
+        readNumbers(frameDict, "verticesUV", uvs);
+        readNumbers(frameDict, "triangles", indices);
+        if (vertices.size() < 6 || uvs.size() != vertices.size())
+        {
+            vertices.clear();
+            indices.clear();
+        }
+        writer.writeU16((unsigned short)(vertices.size() / 2));
+        for (size_t i = 0; i < vertices.size(); i += 2)
+        {
+            writer.writeFloat(vertices[i]);
+            writer.writeFloat(vertices[i + 1]);
+            writer.writeFloat(uvs[i]);
+            writer.writeFloat(uvs[i + 1]);
+        }
+        writer.writeU16((unsigned short)indices.size());
+        for (auto index : indices)
+        {
+            writer.writeU16(index);
+        }
+    }
+
+    Data data;
+    data.fastSet(writer._bytes.data(), writer._bytes.size());
+    bool ret = FileUtils::getInstance()->writeDataToFile(data, binaryFullPath);
+    data.fastSet(nullptr, 0);
+    return ret;
+}
+
+namespace
+{
+    float cross(const Vec2& o, const Vec2& a, const Vec2& b)
+    {
+        return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+    }
+
+    // the convex hull of the points, Andrew's monotone chain
+    std::vector<Vec2> convexHull(std::vector<Vec2>& points)
+    {
+        std::sort(points.begin(), points.end(), [](const Vec2& a, const Vec2& b) {
+            return a.x < b.x || (a.x == b.x && a.y < b.y);
+        });
+        points.erase(std::unique(points.begin(), points.end()), points.end());
+        if (points.size() < 3)
+        {
+            return std::vector<Vec2>();
+        }
 
-            for(const auto &value : aliases) {
-                std::string oneAlias = value.asString();
-                if (_spriteFramesAliases.find(oneAlias) != _spriteFramesAliases.end())
+        std::vector<Vec2> hull(points.size() * 2);
+        size_t k = 0;
+        for (size_t i = 0; i < points.size(); ++i)
+        {
+            while (k >= 2 && cross(hull[k - 2], hull[k - 1], points[i]) <= 0)
+            {
+                --k;
+            }
+            hull[k++] = points[i];
+        }
+        for (size_t i = points.size() - 1, lower = k + 1; i > 0; --i)
+        {
+            while (k >= lower && cross(hull[k - 2], hull[k - 1], points[i - 1]) <= 0)
+            {
+                --k;
+            }
+            hull[k++] = points[i - 1];
+        }
+        hull.resize(k - 1);
+        return hull;
+    }
+
+    // removes the edges of a convex outline until it has `maxVertices` vertices, the edges around a removed one
+    // are extended until they meet, the edge adding the least area goes first and the outline stays in `bounds`
+    void reduceOutline(std::vector<Vec2>& outline, size_t maxVertices, const Rect& bounds)
+    {
+        while (outline.size() > maxVertices)
+        {
+            const size_t n = outline.size();
+            size_t best = n;
+            float bestArea = 0.0f;
+            Vec2 bestPoint;
+            for (size_t i = 0; i < n; ++i)
+            {
+                const Vec2& a = outline[i];
+                const Vec2& b = outline[(i + 1) % n];
+                const Vec2 d1 = a - outline[(i + n - 1) % n];
+                const Vec2 d2 = b - outline[(i + 2) % n];
+                const float denominator = d1.cross(d2);
+                if (fabsf(denominator) < 1e-6f)
+                {
+                    continue;
+                }
+                // a + t * d1 = b + s * d2, both edges go on past the removed one
+                const Vec2 ab = b - a;
+                const float t = ab.cross(d2) / denominator;
+                const float s = ab.cross(d1) / denominator;
+                if (t < 0.0f || s < 0.0f)
                 {
-                    CCLOGWARN("cocos2d: WARNING: an alias with name %s already exists", oneAlias.c_str());
+                    continue;
                 }
+                const Vec2 point = a + d1 * t;
+                const float area = fabsf(cross(a, point, b)) * 0.5f;
+                if (bounds.containsPoint(point) && (best == n || area < bestArea))
+                {
+                    best = i;
+                    bestArea = area;
+                    bestPoint = point;
+                }
+            }
+            if (best == n)
+            {
+                break;
+            }
+            outline[best] = bestPoint;
+            outline.erase(outline.begin() + (best + 1) % n);
+        }
+    }
 
-                _spriteFramesAliases[oneAlias] = Value(spriteFrameName);
+    float outlineArea(const std::vector<Vec2>& outline)
+    {
+        float area = 0.0f;
+        for (size_t i = 0, n = outline.size(); i < n; ++i)
+        {
+            area += outline[i].cross(outline[(i + 1) % n]);
+        }
+        return fabsf(area) * 0.5f;
+    }
+}
+
+bool SpriteFrameCache::generatePolygons(const std::string& plist, const std::string& outputFullPath, int maxVertices)
+{
+    auto fileUtils = FileUtils::getInstance();
+    ValueMap dict = fileUtils->getValueMapFromFile(plist);
+    if (dict.empty() || dict.find("frames") == dict.end())
+    {
+        CCLOG("cocos2d: SpriteFrameCache: can not read %s", plist.c_str());
+        return false;
+    }
+
+    int format = 0;
+    std::string texturePath;
+    if (dict.find("metadata") != dict.end())
+    {
+        ValueMap& metadataDict = dict["metadata"].asValueMap();
+        format = metadataDict["format"].asInt();
+        texturePath = metadataDict["textureFileName"].asString();
+    }
+    if (format < 0 || format > 3)
+    {
+        CCLOG("cocos2d: SpriteFrameCache: the format of %s is not supported", plist.c_str());
+        return false;
+    }
+    if (texturePath.empty())
+    {
+        texturePath = plist.substr(0, plist.find_last_of('.')) + ".png";
+    }
+    else
+    {
+        texturePath = fileUtils->fullPathFromRelativeFile(texturePath, plist);
+    }
+
+    Image* image = new (std::nothrow) Image;
+    if (image == nullptr || ! image->initWithImageFile(texturePath) || image->getRenderFormat() != Texture2D::PixelFormat::RGBA8888)
+    {
+        CCLOG("cocos2d: SpriteFrameCache: %s is not a RGBA8888 image", texturePath.c_str());
+        CC_SAFE_DELETE(image);
+        return false;
+    }
+
+    const unsigned char* pixels = image->getData();
+    const int imageWidth = image->getWidth();
+    const int imageHeight = image->getHeight();
+    const size_t vertexLimit = (size_t)std::max(maxVertices, 3);
+
+    ValueMap& framesDict = dict["frames"].asValueMap();
+    Rect rect;
+    bool rotated;
+    Vec2 offset;
+    Size sourceSize;
+    std::vector<Vec2> points;
+
+    for (auto iter = framesDict.begin(); iter != framesDict.end(); ++iter)
+    {
+        ValueMap& frameDict = iter->second.asValueMap();
+        frameDict.erase("vertices");
+        frameDict.erase("verticesUV");
+        frameDict.erase("triangles");
+
+        readFrameDictionary(frameDict, format, rect, rotated, offset, sourceSize);
+        const int x = (int)rect.origin.x;
+        const int y = (int)rect.origin.y;
+        const int w = (int)rect.size.width;
+        const int h = (int)rect.size.height;
+        // a rotated frame is turned a quarter clockwise in the texture
+        if (w < 1 || h < 1 || x < 0 || y < 0 || x + (rotated ? h : w) > imageWidth || y + (rotated ? w : h) > imageHeight)
+        {
+            continue;
+        }
+
+        // the corners of the first and last opaque pixels of each row, y down
+        points.clear();
+        for (int py = 0; py < h; ++py)
+        {
+            int left = -1;
+            int right = -1;
+            for (int px = 0; px < w; ++px)
+            {
+                const int ax = rotated ? x + h - 1 - py : x + px;
+                const int ay = rotated ? y + px : y + py;
+                if (pixels[(ay * imageWidth + ax) * 4 + 3] != 0)
+                {
+                    if (left < 0)
+                    {
+                        left = px;
+                    }
+                    right = px;
+                }
             }
+            if (left >= 0)
+            {
+                points.push_back(Vec2((float)left, (float)py));
+                points.push_back(Vec2((float)left, (float)py + 1));
+                points.push_back(Vec2((float)right + 1, (float)py));
+                points.push_back(Vec2((float)right + 1, (float)py + 1));
+            }
+        }
 
-            // create frame
-            spriteFrame = SpriteFrame::createWithTexture(texture,
-                                                         Rect(textureRect.origin.x, textureRect.origin.y, spriteSize.width, spriteSize.height),
-                                                         textureRotated,
-                                                         spriteOffset,
-                                                         spriteSourceSize);
+        std::vector<Vec2> outline = convexHull(points);
+        reduceOutline(outline, vertexLimit, Rect(0, 0, (float)w, (float)h));
+        // the quad is cheaper when the mesh would not leave much out
+        if (outline.size() < 3 || outlineArea(outline) > 0.9f * w * h)
+        {
+            continue;
         }
 
-        bool flag = NinePatchImageParser::isNinePatchImage(spriteFrameName);
-        if(flag)
+        // the vertices in the untrimmed frame and the uvs in the texture, in pixels
+        const float left = (sourceSize.width - w) / 2 + offset.x;
+        const float top = (sourceSize.height - h) / 2 - offset.y;
+        std::ostringstream vertices, uvs, triangles;
+        for (size_t i = 0; i < outline.size(); ++i)
         {
-            if (image == nullptr)
+            const Vec2& p = outline[i];
+            const char* separator = i ? " " : "";
+            vertices << separator << left + p.x << " " << top + p.y;
+            if (rotated)
             {
-                image = new (std::nothrow) Image;
-                image->initWithImageFile(textureFileName);
+                uvs << separator << x + h - p.y << " " << y + p.x;
             }
-            NinePatchImageParser parser;
-            parser.setSpriteFrameInfo(image, spriteFrame->getRectInPixels(), spriteFrame->isRotated());
-            texture->addSpriteFrameCapInset(spriteFrame, parser.parseCapInset());
+            else
+            {
+                uvs << separator << x + p.x << " " << y + p.y;
+            }
+        }
+        for (size_t i = 1; i + 1 < outline.size(); ++i)
+        {
+            triangles << (i > 1 ? " " : "") << 0 << " " << i << " " << i + 1;
         }
-        // add sprite frame
-        _spriteFrames.insert(spriteFrameName, spriteFrame);
+        frameDict["vertices"] = Value(vertices.str());
+        frameDict["verticesUV"] = Value(uvs.str());
+        frameDict["triangles"] = Value(triangles.str());
     }
     CC_SAFE_DELETE(image);
+
+    return fileUtils->writeValueMapToFile(dict, outputFullPath);
+}
+
+bool SpriteFrameCache::readBinaryFrames(const unsigned char* data, ssize_t size, std::vector<SheetFrame>& frames)
+{
+    BinaryReader reader(data, size);
+    unsigned int frameCount = 0;
+    std::string textureFileName;
+    if (! reader.readHeader(frameCount, textureFileName))
+    {
+        CCLOG("cocos2d: SpriteFrameCache: invalid binary sprite frames");
+        return false;
+    }
+
+    // a truncated file can't hold that many
+    frames.reserve(std::min<size_t>(frameCount, (size_t)size / 8));
+    for (unsigned int i = 0; i < frameCount && reader.isOK(); ++i)
+    {
+        frames.emplace_back();
+        SheetFrame& frame = frames.back();
+
+        reader.readString(frame.name);
+        float x = reader.readFloat();
+        float y = reader.readFloat();
+        float w = reader.readFloat();
+        float h = reader.readFloat();
+        frame.rect = Rect(x, y, w, h);
+        frame.rotated = reader.readU8() != 0;
+        float ox = reader.readFloat();
+        float oy = reader.readFloat();
+        frame.offset = Vec2(ox, oy);
+        float sw = reader.readFloat();
+        float sh = reader.readFloat();
+        frame.sourceSize = Size(sw, sh);
+
+        unsigned short aliasCount = reader.readU16();
+        frame.aliases.resize(aliasCount);
+        for (unsigned short j = 0; j < aliasCount; ++j)
+        {
+            reader.readString(frame.aliases[j]);
+        }
+
+        if (reader.getVersion() >= 2)
+        {
+            unsigned short vertexCount = reader.readU16();
+            for (unsigned short j = 0; j < vertexCount && reader.isOK(); ++j)
+            {
+                frame.vertices.push_back(reader.readFloat());
+                frame.vertices.push_back(reader.readFloat());
+                frame.uvs.push_back(reader.readFloat());
+                frame.uvs.push_back(reader.readFloat());
+            }
+            unsigned short indexCount = reader.readU16();
+            for (unsigned short j = 0; j < indexCount && reader.isOK(); ++j)
+            {
+                frame.indices.push_back(reader.readU16());
+            }
+        }
+
+        if (! reader.isOK())
+        {
+            frames.pop_back();
+        }
+    }
+
+    if (! reader.isOK())
+    {
+        CCLOG("cocos2d: SpriteFrameCache: the binary sprite frames are truncated");
+        return false;
+    }
+    return true;
+}
+
+bool SpriteFrameCache::addSpriteFramesWithBinary(const unsigned char* data, ssize_t size, Texture2D* texture)
+{
+    CCASSERT(texture != nullptr, "SpriteFrameCache::addSpriteFramesWithBinary, texture should not be nullptr!");
+    if (texture == nullptr)
+    {
+        return false;
+    }
+
+    std::vector<SheetFrame> frames;
+    bool valid = readBinaryFrames(data, size, frames);
+
+    auto textureFileName = Director::DirectorInstance->getTextureCache()->getTextureFilePath(texture);
+    _spriteFrames.reserve(_spriteFrames.size() + frames.size());
+
+    Image* image = nullptr;
+    for (const auto& frame : frames)
+    {
+        SpriteFrame* spriteFrame = addSheetFrame(frame, texture);
+        if (spriteFrame)
+        {
+            addNinePatchCapInset(spriteFrame, frame.name, texture, textureFileName, image);
+        }
+    }
+    CC_SAFE_DELETE(image);
+
+    return valid;
 }
 
 void SpriteFrameCache::addSpriteFramesWithFile(const std::string& plist, Texture2D *texture)
@@ -232,7 +942,18 @@ void SpriteFrameCache::addSpriteFramesWithFile(const std::string& plist, Texture
         return; // We already added it
     }
 
-    ValueMap dict = FileUtils::getInstance()->getValueMapFromFile(plist);
+    auto fileUtils = FileUtils::getInstance();
+    FileView view = fileUtils->getFileView(plist);
+    if (isBinarySpriteFrames(view.getBytes(), view.getSize()))
+    {
+        if (addSpriteFramesWithBinary(view.getBytes(), view.getSize(), texture))
+        {
+            _loadedFileNames->insert(plist);
+        }
+        return;
+    }
+
+    ValueMap dict = fileUtils->getValueMapFromData(reinterpret_cast<const char*>(view.getBytes()), static_cast<int>(view.getSize()));
     if (dict.empty()) {
         log("SpriteFrameCache::addSpriteFramesWithFile,dict is empty!");
         return;
@@ -263,6 +984,28 @@ void SpriteFrameCache::addSpriteFramesWithFile(const std::string& plist, const s
     }
 }
 
+// the texture of a sprite sheet, `textureFileName` is the one of its metadata, relative to the plist
+static std::string getSheetTexturePath(const std::string& textureFileName, const std::string& plist)
+{
+    if (! textureFileName.empty())
+    {
+        return FileUtils::getInstance()->fullPathFromRelativeFile(textureFileName, plist);
+    }
+
+    // build texture path by replacing file extension
+    std::string texturePath = plist;
+
+    // remove .xxx
+    size_t startPos = texturePath.find_last_of(".");
+    texturePath = texturePath.erase(startPos);
+
+    // append .png
+    texturePath = texturePath.append(".png");
+
+    CCLOG("cocos2d: SpriteFrameCache: Trying to use file %s as texture", texturePath.c_str());
+    return texturePath;
+}
+
 void SpriteFrameCache::addSpriteFramesWithFile(const std::string& plist)
 {
     CCASSERT(!plist.empty(), "plist filename should not be nullptr");
@@ -277,50 +1020,277 @@ void SpriteFrameCache::addSpriteFramesWithFile(const std::string& plist)
 
     if (_loadedFileNames->find(plist) == _loadedFileNames->end())
     {
+        auto fileUtils = FileUtils::getInstance();
+        FileView view = fileUtils->getFileView(fullPath);
+        const bool binary = isBinarySpriteFrames(view.getBytes(), view.getSize());
 
-        ValueMap dict = FileUtils::getInstance()->getValueMapFromFile(fullPath);
-
+        ValueMap dict;
         string texturePath("");
 
-        if (dict.find("metadata") != dict.end())
+        if (binary)
         {
-            ValueMap& metadataDict = dict["metadata"].asValueMap();
-            // try to read  texture file name from meta data
-            texturePath = metadataDict["textureFileName"].asString();
+            unsigned int frameCount;
+            BinaryReader reader(view.getBytes(), view.getSize());
+            if (! reader.readHeader(frameCount, texturePath))
+            {
+                CCLOG("cocos2d: SpriteFrameCache: invalid binary sprite frames %s", plist.c_str());
+                return;
+            }
         }
+        else
+        {
+            dict = fileUtils->getValueMapFromData(reinterpret_cast<const char*>(view.getBytes()), static_cast<int>(view.getSize()));
 
-        if (!texturePath.empty())
+            if (dict.find("metadata") != dict.end())
+            {
+                ValueMap& metadataDict = dict["metadata"].asValueMap();
+                // try to read  texture file name from meta data
+                texturePath = metadataDict["textureFileName"].asString();
+            }
+        }
+
+        texturePath = getSheetTexturePath(texturePath, plist);
+
+        Texture2D *texture = Director::DirectorInstance->getTextureCache()->addImage(texturePath);
+
+        if (texture)
         {
-            // build texture path relative to plist file
-            texturePath = FileUtils::getInstance()->fullPathFromRelativeFile(texturePath, plist);
+            if (binary)
+            {
+                if (addSpriteFramesWithBinary(view.getBytes(), view.getSize(), texture))
+                {
+                    _loadedFileNames->insert(plist);
+                }
+            }
+            else
+            {
+                addSpriteFramesWithDictionary(dict, texture);
+                _loadedFileNames->insert(plist);
+            }
         }
         else
         {
-            // build texture path by replacing file extension
-            texturePath = plist;
+            CCLOG("cocos2d: SpriteFrameCache: Couldn't load texture");
+        }
+    }
+}
 
-            // remove .xxx
-            size_t startPos = texturePath.find_last_of(".");
-            texturePath = texturePath.erase(startPos);
+void SpriteFrameCache::addSpriteFramesWithFileAsync(const std::string& plist, const std::function<void(bool)>& callback)
+{
+    CCASSERT(!plist.empty(), "plist filename should not be nullptr");
 
-            // append .png
-            texturePath = texturePath.append(".png");
+    if (_loadedFileNames->find(plist) != _loadedFileNames->end())
+    {
+        if (callback)
+        {
+            callback(true);
+        }
+        return;
+    }
 
-            CCLOG("cocos2d: SpriteFrameCache: Trying to use file %s as texture", texturePath.c_str());
+    for (const auto& sheet : _asyncSheets)
+    {
+        if (sheet->plist == plist)
+        {
+            if (callback)
+            {
+                sheet->callbacks.push_back(callback);
+            }
+            return;
         }
+    }
 
-        Texture2D *texture = Director::DirectorInstance->getTextureCache()->addImage(texturePath);
+    std::string fullPath = FileUtils::getInstance()->fullPathForFilename(plist);
+    if (fullPath.empty())
+    {
+        CCLOG("cocos2d: SpriteFrameCache: can not find %s", plist.c_str());
+        if (callback)
+        {
+            callback(false);
+        }
+        return;
+    }
 
-        if (texture)
+    auto sheet = std::make_shared<AsyncSheet>();
+    sheet->plist = plist;
+    sheet->fullPath = fullPath;
+    if (callback)
+    {
+        sheet->callbacks.push_back(callback);
+    }
+    _asyncSheets.push_back(sheet);
+
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO, [this, sheet](void*) {
+        if (sheet->cancelled)
         {
-            addSpriteFramesWithDictionary(dict, texture);
-            _loadedFileNames->insert(plist);
+            return;
         }
-        else
+        if (! sheet->read)
         {
-            CCLOG("cocos2d: SpriteFrameCache: Couldn't load texture");
+            finishAsyncSheet(sheet, false);
+            return;
+        }
+
+        Director::DirectorInstance->getTextureCache()->addImageAsync(sheet->texturePath, [this, sheet](Texture2D* texture) {
+            if (sheet->cancelled)
+            {
+                return;
+            }
+            if (texture == nullptr)
+            {
+                CCLOG("cocos2d: SpriteFrameCache: Couldn't load texture %s", sheet->texturePath.c_str());
+                finishAsyncSheet(sheet, false);
+                return;
+            }
+
+            texture->retain();
+            sheet->texture = texture;
+            auto scheduler = Director::DirectorInstance->getScheduler();
+            if (! scheduler->isScheduled(ASYNC_SCHEDULE_KEY, this))
+            {
+                scheduler->schedule(CC_CALLBACK_1(SpriteFrameCache::updateAsyncSheets, this), this, 0, false, ASYNC_SCHEDULE_KEY);
+            }
+        });
+    }, nullptr, [sheet]() {
+        readAsyncSheet(*sheet);
+    });
+}
+
+void SpriteFrameCache::readAsyncSheet(AsyncSheet& sheet)
+{
+    auto fileUtils = FileUtils::getInstance();
+    FileView view = fileUtils->getFileView(sheet.fullPath);
+    std::string textureFileName;
+
+    if (isBinarySpriteFrames(view.getBytes(), view.getSize()))
+    {
+        unsigned int frameCount;
+        BinaryReader reader(view.getBytes(), view.getSize());
+        if (! reader.readHeader(frameCount, textureFileName) || ! readBinaryFrames(view.getBytes(), view.getSize(), sheet.frames))
+        {
+            CCLOG("cocos2d: SpriteFrameCache: invalid binary sprite frames %s", sheet.plist.c_str());
+            return;
         }
     }
+    else
+    {
+        ValueMap dict = fileUtils->getValueMapFromData(reinterpret_cast<const char*>(view.getBytes()), static_cast<int>(view.getSize()));
+        if (dict.empty())
+        {
+            CCLOG("cocos2d: SpriteFrameCache: can not read %s", sheet.plist.c_str());
+            return;
+        }
+
+        int format = 0;
+        if (dict.find("metadata") != dict.end())
+        {
+            ValueMap& metadataDict = dict["metadata"].asValueMap();
+            format = metadataDict["format"].asInt();
+            textureFileName = metadataDict["textureFileName"].asString();
+        }
+        if (format < 0 || format > 3)
+        {
+            CCLOG("cocos2d: SpriteFrameCache: format is not supported for %s", sheet.plist.c_str());
+            return;
+        }
+
+        ValueMap& framesDict = dict["frames"].asValueMap();
+        sheet.frames.resize(framesDict.size());
+        size_t i = 0;
+        for (auto iter = framesDict.begin(); iter != framesDict.end(); ++iter, ++i)
+        {
+            sheet.frames[i].name = iter->first;
+            readDictionaryFrame(iter->second.asValueMap(), format, sheet.frames[i]);
+        }
+    }
+
+    sheet.texturePath = getSheetTexturePath(textureFileName, sheet.plist);
+    sheet.read = true;
+
+    // the cap insets need the pixels, the texture is decoded once more here rather than on the main thread
+    Image* image = nullptr;
+    NinePatchImageParser parser;
+    for (auto& frame : sheet.frames)
+    {
+        if (! NinePatchImageParser::isNinePatchImage(frame.name))
+        {
+            continue;
+        }
+        if (image == nullptr)
+        {
+            image = new (std::nothrow) Image;
+            if (! image->initWithImageFile(sheet.texturePath))
+            {
+                CCLOG("cocos2d: SpriteFrameCache: can not read the cap insets of %s", sheet.plist.c_str());
+                break;
+            }
+        }
+        parser.setSpriteFrameInfo(image, frame.rect, frame.rotated);
+        frame.capInsets = parser.parseCapInset();
+        frame.hasCapInsets = true;
+    }
+    CC_SAFE_DELETE(image);
+}
+
+void SpriteFrameCache::updateAsyncSheets(float /*dt*/)
+{
+    const double start = utils::gettime();
+    bool created = false;
+
+    size_t i = 0;
+    while (i < _asyncSheets.size())
+    {
+        // finishAsyncSheet() removes it and its callbacks may add others
+        std::shared_ptr<AsyncSheet> sheet = _asyncSheets[i];
+        if (sheet->texture == nullptr)
+        {
+            ++i;
+            continue;
+        }
+
+        for (; sheet->next < sheet->frames.size(); ++sheet->next)
+        {
+            if (created && _asyncBudget > 0 && (utils::gettime() - start) * 1000.0 >= _asyncBudget)
+            {
+                return;
+            }
+
+            const SheetFrame& frame = sheet->frames[sheet->next];
+            SpriteFrame* spriteFrame = addSheetFrame(frame, sheet->texture);
+            if (spriteFrame && frame.hasCapInsets)
+            {
+                sheet->texture->addSpriteFrameCapInset(spriteFrame, frame.capInsets);
+            }
+            created = true;
+        }
+        finishAsyncSheet(sheet, true);
+    }
+
+    // scheduled again by the next texture loaded
+    Director::DirectorInstance->getScheduler()->unschedule(ASYNC_SCHEDULE_KEY, this);
+}
+
+void SpriteFrameCache::finishAsyncSheet(const std::shared_ptr<AsyncSheet>& sheet, bool success)
+{
+    auto iter = std::find(_asyncSheets.begin(), _asyncSheets.end(), sheet);
+    if (iter != _asyncSheets.end())
+    {
+        _asyncSheets.erase(iter);
+    }
+    CC_SAFE_RELEASE_NULL(sheet->texture);
+
+    if (success)
+    {
+        _loadedFileNames->insert(sheet->plist);
+    }
+
+    // the callbacks may request more files
+    auto callbacks = std::move(sheet->callbacks);
+    sheet->callbacks.clear();
+    for (const auto& callback : callbacks)
+    {
+        callback(success);
+    }
 }
 
 bool SpriteFrameCache::isSpriteFramesWithFileLoaded(const std::string& plist) const
@@ -338,11 +1308,13 @@ bool SpriteFrameCache::isSpriteFramesWithFileLoaded(const std::string& plist) co
 void SpriteFrameCache::addSpriteFrame(SpriteFrame* frame, const std::string& frameName)
 {
     _spriteFrames.insert(frameName, frame);
+    _handleGeneration++;
 }
 
 void SpriteFrameCache::removeSpriteFrames()
 {
     _spriteFrames.clear();
+    _handleGeneration++;
     _spriteFramesAliases.clear();
     _loadedFileNames->clear();
 }
@@ -369,6 +1341,7 @@ void SpriteFrameCache::removeUnusedSpriteFrames()
     // FIXME:. Since we don't know the .plist file that originated the frame, we must remove all .plist from the cache
     if( removed )
     {
+        _handleGeneration++;
         _loadedFileNames->clear();
     }
 }
@@ -392,6 +1365,7 @@ void SpriteFrameCache::removeSpriteFrameByName(const std::string& name)
     {
         _spriteFrames.erase(name);
     }
+    _handleGeneration++;
 
     // FIXME:. Since we don't know the .plist file that originated the frame, we must remove all .plist from the cache
     _loadedFileNames->clear();
@@ -399,14 +1373,50 @@ void SpriteFrameCache::removeSpriteFrameByName(const std::string& name)
 
 void SpriteFrameCache::removeSpriteFramesFromFile(const std::string& plist)
 {
-    ValueMap dict = FileUtils::getInstance()->getValueMapFromFile(plist);
-    if (dict.empty())
+    auto fileUtils = FileUtils::getInstance();
+    FileView view = fileUtils->getFileView(plist);
+    if (isBinarySpriteFrames(view.getBytes(), view.getSize()))
     {
-        CCLOG("cocos2d:SpriteFrameCache:removeSpriteFramesFromFile: create dict by %s fail.",plist.c_str());
-        return;
+        BinaryReader reader(view.getBytes(), view.getSize());
+        unsigned int frameCount = 0;
+        std::string name;
+        reader.readHeader(frameCount, name);
+
+        std::vector<std::string> keysToRemove;
+        for (unsigned int i = 0; i < frameCount && reader.isOK(); ++i)
+        {
+            reader.readString(name);
+            // the rect, rotation, offset and source size
+            for (int j = 0; j < 4 * 4 + 1 + 4 * 4; ++j)
+            {
+                reader.readU8();
+            }
+            unsigned short aliasCount = reader.readU16();
+            for (unsigned short j = 0; j < aliasCount; ++j)
+            {
+                std::string alias;
+                reader.readString(alias);
+            }
+
+            if (reader.isOK() && _spriteFrames.at(name))
+            {
+                keysToRemove.push_back(name);
+            }
+        }
+        _spriteFrames.erase(keysToRemove);
+        _handleGeneration++;
     }
+    else
+    {
+        ValueMap dict = fileUtils->getValueMapFromData(reinterpret_cast<const char*>(view.getBytes()), static_cast<int>(view.getSize()));
+        if (dict.empty())
+        {
+            CCLOG("cocos2d:SpriteFrameCache:removeSpriteFramesFromFile: create dict by %s fail.",plist.c_str());
+            return;
+        }
 
-    removeSpriteFramesFromDictionary(dict);
+        removeSpriteFramesFromDictionary(dict);
+    }
 
     // remove it from the cache
     set<string>::iterator ret = _loadedFileNames->find(plist);
@@ -416,6 +1426,56 @@ void SpriteFrameCache::removeSpriteFramesFromFile(const std::string& plist)
     }
 }
 
+Vector<SpriteFrame*> SpriteFrameCache::reloadSpriteFramesFromFile(const std::string& plist)
+{
+    Vector<SpriteFrame*> updatedFrames;
+
+    // the name the file was loaded with
+    auto fileUtils = FileUtils::getInstance();
+    const std::string fullPath = fileUtils->fullPathForFilename(plist);
+    std::string loadedName;
+    for (auto&& name : *_loadedFileNames)
+    {
+        if (name == plist || fileUtils->fullPathForFilename(name) == fullPath)
+        {
+            loadedName = name;
+            break;
+        }
+    }
+    if (loadedName.empty())
+    {
+        return updatedFrames;
+    }
+
+    // the frames as they are, the new ones are copied into them
+    Map<std::string, SpriteFrame*> oldFrames = _spriteFrames;
+    removeSpriteFramesFromFile(loadedName);
+    addSpriteFramesWithFile(loadedName);
+
+    for (auto&& item : oldFrames)
+    {
+        SpriteFrame* newFrame = _spriteFrames.at(item.first);
+        SpriteFrame* frame = item.second;
+        if (newFrame == nullptr || newFrame == frame)
+        {
+            continue;
+        }
+
+        frame->setTexture(newFrame->getTexture());
+        frame->setRectInPixels(newFrame->getRectInPixels());
+        frame->setRotated(newFrame->isRotated());
+        frame->setOffsetInPixels(newFrame->getOffsetInPixels());
+        frame->setOriginalSizeInPixels(newFrame->getOriginalSizeInPixels());
+        frame->setOriginalSize(newFrame->getOriginalSize());
+        frame->setPolygonInfo(newFrame->getPolygonInfo());
+        _spriteFrames.insert(item.first, frame);
+        updatedFrames.pushBack(frame);
+    }
+    _handleGeneration++;
+
+    return updatedFrames;
+}
+
 void SpriteFrameCache::removeSpriteFramesFromFileContent(const std::string& plist_content)
 {
     ValueMap dict = FileUtils::getInstance()->getValueMapFromData(plist_content.data(), static_cast<int>(plist_content.size()));
@@ -441,6 +1501,7 @@ void SpriteFrameCache::removeSpriteFramesFromDictionary(ValueMap& dictionary)
     }
 
     _spriteFrames.erase(keysToRemove);
+    _handleGeneration++;
 }
 
 void SpriteFrameCache::removeSpriteFramesFromTexture(Texture2D* texture)
@@ -458,6 +1519,7 @@ void SpriteFrameCache::removeSpriteFramesFromTexture(Texture2D* texture)
     }
 
     _spriteFrames.erase(keysToRemove);
+    _handleGeneration++;
 }
 
 SpriteFrame* SpriteFrameCache::getSpriteFrameByName(const std::string& name)
@@ -479,5 +1541,86 @@ SpriteFrame* SpriteFrameCache::getSpriteFrameByName(const std::string& name)
     return frame;
 }
 
-NS_CC_END
+// MARK: handles
+
+namespace
+{
+    // the interned names, shared by all the caches so the handles outlive SpriteFrameCache::destroyInstance()
+    struct HandleTable
+    {
+        HandleTable()
+        {
+            names.push_back(std::string());
+            handles.emplace(std::string(), 0);
+        }
+        std::vector<std::string> names;
+        std::unordered_map<std::string, unsigned int> handles;
+    };
 
+    HandleTable& getHandleTable()
+    {
+        // never deleted, the handles may be used until the end of the program
+        static HandleTable* table = new HandleTable();
+        return *table;
+    }
+}
+
+unsigned int SpriteFrameCache::getSpriteFrameHandle(const std::string& name)
+{
+    auto& table = getHandleTable();
+    auto it = table.handles.find(name);
+    if (it != table.handles.end())
+    {
+        return it->second;
+    }
+    const unsigned int handle = static_cast<unsigned int>(table.names.size());
+    table.names.push_back(name);
+    table.handles.emplace(name, handle);
+    return handle;
+}
+
+std::vector<unsigned int> SpriteFrameCache::getSpriteFrameHandles(const char* format, int first, int last)
+{
+    std::vector<unsigned int> handles;
+    char name[256];
+    for (int i = first; i <= last; ++i)
+    {
+        snprintf(name, sizeof(name), format, i);
+        handles.push_back(getSpriteFrameHandle(name));
+    }
+    return handles;
+}
+
+const std::string& SpriteFrameCache::getSpriteFrameHandleName(unsigned int handle)
+{
+    auto& names = getHandleTable().names;
+    return handle < names.size() ? names[handle] : names[0];
+}
+
+SpriteFrame* SpriteFrameCache::getSpriteFrameByHandle(unsigned int handle)
+{
+    if (handle == 0)
+    {
+        return nullptr;
+    }
+    if (handle >= _handleFrames.size())
+    {
+        HandleFrame unresolved = { nullptr, 0 };
+        _handleFrames.resize(getHandleTable().names.size(), unresolved);
+        if (handle >= _handleFrames.size())
+        {
+            return nullptr;
+        }
+    }
+
+    // the missing frames are looked up again, they may have been added since
+    auto& entry = _handleFrames[handle];
+    if (entry.generation != _handleGeneration || entry.frame == nullptr)
+    {
+        entry.frame = getSpriteFrameByName(getHandleTable().names[handle]);
+        entry.generation = _handleGeneration;
+    }
+    return entry.frame;
+}
+
+NS_CC_END
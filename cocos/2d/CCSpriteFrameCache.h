@@ -34,8 +34,11 @@ THE SOFTWARE.
  * To create sprite frames and texture atlas, use this tool:
  * http://zwoptex.zwopple.com/
  */
+#include <functional>
+#include <memory>
 #include <set>
 #include <string>
+#include <vector>
 #include "2d/CCSpriteFrame.h"
 #include "base/CCRef.h"
 #include "base/CCValue.h"
@@ -45,6 +48,7 @@ NS_CC_BEGIN
 
 class Sprite;
 class Texture2D;
+class Image;
 
 /**
  * @addtogroup _2d
@@ -122,6 +126,65 @@ public:
      */
     void addSpriteFramesWithFileContent(const std::string& plist_content, Texture2D *texture);
 
+    /** Adds multiple Sprite Frames from a plist file like addSpriteFramesWithFile(const std::string& plist), without blocking the main thread.
+     * The plist, or the binary file of convertPlistToBinary(), is read and parsed on a thread of AsyncTaskPool, together
+     * with the cap insets of the "name.9.png" frames. The texture is loaded with TextureCache::addImageAsync(), so it is
+     * decoded on the loader threads and created within its upload budget. The sprite frames are then created on the main
+     * thread, a batch per frame within getAsyncBudget().
+     * The callback is called on the main thread once the sprite frames are added, with false if the file or its texture
+     * couldn't be loaded. It's called at once if the file is already loaded, the requests of a file that is being loaded share the load.
+     * @js NA
+     * @lua NA
+     *
+     * @param plist Plist file name.
+     * @param callback Called with whether the sprite frames were added, may be nullptr.
+     * @since v3.11
+     */
+    void addSpriteFramesWithFileAsync(const std::string& plist, const std::function<void(bool)>& callback = nullptr);
+
+    /** Sets the milliseconds per frame the main thread may spend creating the sprite frames of addSpriteFramesWithFileAsync().
+     * At least one sprite frame is created per frame, 2 ms by default. 0 means no limit.
+     * @js NA
+     * @lua NA
+     * @since v3.11
+     */
+    void setAsyncBudget(float milliseconds) { _asyncBudget = milliseconds; }
+    /** Gets the milliseconds per frame the main thread may spend creating the sprite frames of addSpriteFramesWithFileAsync().
+     * @js NA
+     * @lua NA
+     * @since v3.11
+     */
+    float getAsyncBudget() const { return _asyncBudget; }
+
+    /** Converts a plist of sprite frames to the binary format of the engine.
+     * The addSpriteFramesWithFile() and removeSpriteFramesFromFile() methods read both formats, the binary one
+     * is loaded in a single pass without building a ValueMap. Run it when the game is built, e.g. "ui.plist" to "ui.ccsf".
+     * @js NA
+     * @lua NA
+     *
+     * @param plist Plist file name.
+     * @param binaryFullPath The full path of the file to write.
+     * @return false if the plist can't be read or the file can't be written.
+     * @since v3.11
+     */
+    static bool convertPlistToBinary(const std::string& plist, const std::string& binaryFullPath);
+
+    /** Writes a copy of a plist of sprite frames with a tight mesh around the opaque pixels of each frame.
+     * The mesh is the convex outline of the frame cut down to `maxVertices` vertices, stored with the "vertices",
+     * "verticesUV" and "triangles" keys TexturePacker uses for its polygon sprite sheets. The frames whose outline
+     * covers most of their rectangle keep their quad. The sprites showing a frame with a mesh draw its triangles,
+     * so the transparent pixels around it are not filled. Run it when the game is built, there is no tracing at runtime.
+     * @js NA
+     * @lua NA
+     *
+     * @param plist Plist file name, its texture must be a RGBA8888 image.
+     * @param outputFullPath The full path of the plist to write, convertPlistToBinary() keeps the meshes.
+     * @param maxVertices The most vertices of a mesh, at least 3.
+     * @return false if the plist or its texture can't be read or the file can't be written.
+     * @since v3.11
+     */
+    static bool generatePolygons(const std::string& plist, const std::string& outputFullPath, int maxVertices = 8);
+
     /** Adds an sprite frame with a given name.
      If the name already exists, then the contents of the old name will be replaced with the new one.
      *
@@ -186,6 +249,18 @@ public:
      */
     void removeSpriteFramesFromTexture(Texture2D* texture);
 
+    /** Reads the sprite frames of a plist file loaded before again, when it changed.
+     * The sprite frames that are still in the file are updated in place, so the animations and the sprites holding them
+     * keep them, the new ones are added. The sprites showing them are set them again to be updated, see FileWatcher.
+     * @js NA
+     * @lua NA
+     *
+     * @param plist The name or the full path of the plist file.
+     * @return The sprite frames updated in place, none if the file wasn't loaded.
+     * @since v3.11
+     */
+    Vector<SpriteFrame*> reloadSpriteFramesFromFile(const std::string& plist);
+
     /** Returns an Sprite Frame that was previously added.
      If the name is not found it will return nil.
      You should retain the returned copy if you are going to use it.
@@ -197,14 +272,76 @@ public:
      */
     SpriteFrame* getSpriteFrameByName(const std::string& name);
 
+    /** Returns the handle of a sprite frame name, the number getSpriteFrameByHandle() looks the frame up with.
+     * The names are interned once and kept until the end of the program, the handles stay valid when the frames
+     * are removed and added again. The code that changes frames every frame gets the handles once, instead of
+     * formatting and hashing the names each time.
+     * Must be called on the main thread.
+     * @js NA
+     * @lua NA
+     *
+     * @param name A sprite frame name or alias, the handle of the empty name is 0.
+     * @return The handle of the name.
+     * @since v3.11
+     */
+    static unsigned int getSpriteFrameHandle(const std::string& name);
+
+    /** Returns the handles of the names `format` gives for the numbers from `first` to `last`, e.g.
+     * getSpriteFrameHandles("run_%03d.png", 1, 8) for the frames of an animation.
+     * @js NA
+     * @lua NA
+     * @since v3.11
+     */
+    static std::vector<unsigned int> getSpriteFrameHandles(const char* format, int first, int last);
+
+    /** Returns the name of a handle, see getSpriteFrameHandle().
+     * @js NA
+     * @lua NA
+     * @since v3.11
+     */
+    static const std::string& getSpriteFrameHandleName(unsigned int handle);
+
+    /** Returns the sprite frame of a handle, like getSpriteFrameByName() with the name of the handle.
+     * The frame is resolved by name the first time, and again after frames were removed or replaced.
+     * @js NA
+     * @lua NA
+     *
+     * @param handle The handle of a sprite frame name, see getSpriteFrameHandle().
+     * @return The sprite frame, nullptr if there is none with that name.
+     * @since v3.11
+     */
+    SpriteFrame* getSpriteFrameByHandle(unsigned int handle);
+
 protected:
     // MARMALADE: Made this protected not private, as deriving from this class is pretty useful
-    SpriteFrameCache(){}
+    SpriteFrameCache() : _handleGeneration(1), _asyncBudget(2.0f) {}
+
+    // a frame of a sprite sheet file, read before its sprite frame is created
+    struct SheetFrame;
+    // a file of addSpriteFramesWithFileAsync() being loaded
+    struct AsyncSheet;
 
     /*Adds multiple Sprite Frames with a dictionary. The texture will be associated with the created sprite frames.
      */
     void addSpriteFramesWithDictionary(ValueMap& dictionary, Texture2D *texture);
 
+    /** Adds the sprite frames written by convertPlistToBinary(), returns false if the data is invalid. */
+    bool addSpriteFramesWithBinary(const unsigned char* data, ssize_t size, Texture2D *texture);
+
+    void addNinePatchCapInset(SpriteFrame* spriteFrame, const std::string& spriteFrameName, Texture2D* texture, const std::string& textureFileName, Image*& image);
+
+    static void readDictionaryFrame(ValueMap& frameDict, int format, SheetFrame& frame);
+    /** Reads the frames written by convertPlistToBinary(), returns false if the data is invalid or truncated. */
+    static bool readBinaryFrames(const unsigned char* data, ssize_t size, std::vector<SheetFrame>& frames);
+    /** Adds the sprite frame and the aliases of a frame read from a file, returns nullptr if the name already exists. */
+    SpriteFrame* addSheetFrame(const SheetFrame& frame, Texture2D* texture);
+
+    // reads the file of an AsyncSheet, on a thread of AsyncTaskPool
+    static void readAsyncSheet(AsyncSheet& sheet);
+    // creates the sprite frames of the sheets whose texture is loaded, within _asyncBudget
+    void updateAsyncSheets(float dt);
+    void finishAsyncSheet(const std::shared_ptr<AsyncSheet>& sheet, bool success);
+
     /** Removes multiple Sprite Frames from Dictionary.
     * @since v0.99.5
     */
@@ -214,6 +351,20 @@ protected:
     Map<std::string, SpriteFrame*> _spriteFrames;
     ValueMap _spriteFramesAliases;
     std::set<std::string>*  _loadedFileNames;
+
+    // the frames of the handles, resolved by name when their generation isn't _handleGeneration,
+    // which is increased when frames are removed or replaced
+    struct HandleFrame
+    {
+        SpriteFrame* frame;
+        unsigned int generation;
+    };
+    std::vector<HandleFrame> _handleFrames;
+    unsigned int _handleGeneration;
+
+    // the files of addSpriteFramesWithFileAsync() being loaded, in the order of the requests
+    std::vector<std::shared_ptr<AsyncSheet>> _asyncSheets;
+    float _asyncBudget;
 };
 
 // end of _2d group
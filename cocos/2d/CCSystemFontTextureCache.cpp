@@ -0,0 +1,242 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+
+#include "2d/CCSystemFontTextureCache.h"
+
+#include <algorithm>
+#include <functional>
+#include "2d/CCAtlasPageTexture.h"
+#include "2d/CCSpriteFrame.h"
+#include "base/CCData.h"
+#include "base/CCDirector.h"
+
+NS_CC_BEGIN
+
+namespace {
+
+// the pages are square, in pixels
+const int PAGE_SIZE = 1024;
+const size_t MAX_PAGES = 4;
+// left between the renderings of a page, the linear filtering would pick the neighbours up
+const int PADDING = 2;
+
+}
+
+SystemFontTextureCache::EntryList SystemFontTextureCache::_entries;
+std::unordered_map<SystemFontTextureCache::Key, SystemFontTextureCache::EntryList::iterator, SystemFontTextureCache::KeyHash> SystemFontTextureCache::_entryMap;
+std::vector<SystemFontTextureCache::Page> SystemFontTextureCache::_pages;
+size_t SystemFontTextureCache::_capacity = CC_SYSTEM_FONT_CACHE_SIZE;
+
+bool SystemFontTextureCache::Key::operator==(const Key& other) const
+{
+    // the shadow isn't rendered by the platform, the labels draw it as a second sprite
+    return contentScaleFactor == other.contentScaleFactor
+        && fontDef._fontSize == other.fontDef._fontSize
+        && fontDef._alignment == other.fontDef._alignment
+        && fontDef._vertAlignment == other.fontDef._vertAlignment
+        && fontDef._dimensions.equals(other.fontDef._dimensions)
+        && fontDef._fontFillColor == other.fontDef._fontFillColor
+        && fontDef._fontAlpha == other.fontDef._fontAlpha
+        && fontDef._stroke._strokeEnabled == other.fontDef._stroke._strokeEnabled
+        && (!fontDef._stroke._strokeEnabled
+            || (fontDef._stroke._strokeColor == other.fontDef._stroke._strokeColor
+                && fontDef._stroke._strokeAlpha == other.fontDef._stroke._strokeAlpha
+                && fontDef._stroke._strokeSize == other.fontDef._stroke._strokeSize))
+        && fontDef._fontName == other.fontDef._fontName
+        && text == other.text;
+}
+
+size_t SystemFontTextureCache::KeyHash::operator()(const Key& key) const
+{
+    // the text and the font tell most renderings apart, the rest is compared by operator==
+    size_t hash = std::hash<std::string>()(key.text);
+    hash ^= std::hash<std::string>()(key.fontDef._fontName) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    hash ^= std::hash<int>()(key.fontDef._fontSize) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    hash ^= std::hash<float>()(key.fontDef._dimensions.width) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+SpriteFrame* SystemFontTextureCache::getSpriteFrame(const std::string& text, const FontDefinition& fontDef)
+{
+    if (_capacity == 0)
+    {
+        return nullptr;
+    }
+
+    Key key;
+    key.text = text;
+    key.fontDef = fontDef;
+    key.contentScaleFactor = CC_CONTENT_SCALE_FACTOR();
+
+    auto it = _entryMap.find(key);
+    if (it != _entryMap.end())
+    {
+        _entries.splice(_entries.begin(), _entries, it->second);
+        return it->second->second;
+    }
+
+    auto frame = render(text, fontDef);
+    if (nullptr == frame)
+    {
+        return nullptr;
+    }
+
+    while (_entries.size() >= _capacity)
+    {
+        evictLeastRecentlyUsed();
+    }
+
+    frame->retain();
+    _entries.emplace_front(std::move(key), frame);
+    _entryMap[_entries.front().first] = _entries.begin();
+    return frame;
+}
+
+SpriteFrame* SystemFontTextureCache::render(const std::string& text, const FontDefinition& fontDef)
+{
+    int width = 0;
+    int height = 0;
+    bool hasPremultipliedAlpha = false;
+    Data data = Texture2D::getStringData(text, fontDef, width, height, hasPremultipliedAlpha);
+    if (data.isNull() || width <= 0 || height <= 0)
+    {
+        return nullptr;
+    }
+
+    if (width > PAGE_SIZE / 2 || height > PAGE_SIZE / 4)
+    {
+        auto texture = new (std::nothrow) AtlasPageTexture();
+        if (nullptr == texture || !texture->initWithPixels(data.getBytes(), width, height, hasPremultipliedAlpha))
+        {
+            CC_SAFE_RELEASE(texture);
+            return nullptr;
+        }
+        auto frame = SpriteFrame::createWithTexture(texture, CC_RECT_PIXELS_TO_POINTS(Rect(0, 0, (float)width, (float)height)));
+        texture->release();
+        return frame;
+    }
+
+    int x = 0;
+    int y = 0;
+    if (_pages.empty() || !allocate(_pages.back(), width, height, x, y))
+    {
+        if (_pages.size() >= MAX_PAGES)
+        {
+            removePage(0);
+        }
+
+        auto texture = new (std::nothrow) AtlasPageTexture();
+        if (nullptr == texture || !texture->initWithPixels(nullptr, PAGE_SIZE, PAGE_SIZE, hasPremultipliedAlpha))
+        {
+            CC_SAFE_RELEASE(texture);
+            return nullptr;
+        }
+        Page page = { texture, 0, 0, 0 };
+        _pages.push_back(page);
+        allocate(_pages.back(), width, height, x, y);
+    }
+
+    auto texture = static_cast<AtlasPageTexture*>(_pages.back().texture);
+    texture->updatePixels(data.getBytes(), x, y, width, height);
+    return SpriteFrame::createWithTexture(texture, CC_RECT_PIXELS_TO_POINTS(Rect((float)x, (float)y, (float)width, (float)height)));
+}
+
+bool SystemFontTextureCache::allocate(Page& page, int width, int height, int& x, int& y)
+{
+    if (page.shelfX + width > PAGE_SIZE)
+    {
+        page.shelfX = 0;
+        page.shelfY += page.shelfHeight + PADDING;
+        page.shelfHeight = 0;
+    }
+    if (page.shelfY + height > PAGE_SIZE)
+    {
+        return false;
+    }
+
+    x = page.shelfX;
+    y = page.shelfY;
+    page.shelfX += width + PADDING;
+    page.shelfHeight = std::max(page.shelfHeight, height);
+    return true;
+}
+
+void SystemFontTextureCache::evictLeastRecentlyUsed()
+{
+    // the space of a packed rendering is only reused with its page
+    _entryMap.erase(_entries.back().first);
+    _entries.back().second->release();
+    _entries.pop_back();
+}
+
+void SystemFontTextureCache::removePage(size_t index)
+{
+    auto texture = _pages[index].texture;
+    for (auto it = _entries.begin(); it != _entries.end();)
+    {
+        if (it->second->getTexture() == texture)
+        {
+            _entryMap.erase(it->first);
+            it->second->release();
+            it = _entries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    // the sprites still showing the page keep it
+    texture->release();
+    _pages.erase(_pages.begin() + index);
+}
+
+void SystemFontTextureCache::purge()
+{
+    _entryMap.clear();
+    for (auto& entry : _entries)
+    {
+        entry.second->release();
+    }
+    _entries.clear();
+
+    for (auto& page : _pages)
+    {
+        page.texture->release();
+    }
+    _pages.clear();
+}
+
+void SystemFontTextureCache::setCapacity(size_t capacity)
+{
+    _capacity = capacity;
+    while (_entries.size() > _capacity)
+    {
+        evictLeastRecentlyUsed();
+    }
+}
+
+NS_CC_END
@@ -0,0 +1,104 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+
+#ifndef _CCSystemFontTextureCache_h_
+#define _CCSystemFontTextureCache_h_
+
+/// @cond DO_NOT_SHOW
+
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "base/ccTypes.h"
+
+NS_CC_BEGIN
+
+class SpriteFrame;
+class Texture2D;
+
+/**
+ SystemFontTextureCache keeps the most recently used system font renderings, so the labels showing the
+ same string with the same FontDefinition share one rendering instead of going through the platform's
+ text renderer each. The small renderings are packed into shared atlas pages, the larger ones keep a texture of their own.
+ */
+class CC_DLL SystemFontTextureCache
+{
+public:
+    /** Returns the rendering of `text` with `fontDef` and marks it as the most recently used,
+     rendering it when it isn't in the cache. nullptr if the text can't be rendered.
+     The frame is valid until the next call to getSpriteFrame() or purge(), retain it to keep it.
+     */
+    static SpriteFrame* getSpriteFrame(const std::string& text, const FontDefinition& fontDef);
+
+    /** Removes all the renderings and the pages. The sprites showing them keep their textures. */
+    static void purge();
+
+    /** Sets how many renderings are kept, 0 disables the cache. It defaults to CC_SYSTEM_FONT_CACHE_SIZE. */
+    static void setCapacity(size_t capacity);
+    static size_t getCapacity() { return _capacity; }
+
+    static size_t getEntryCount() { return _entries.size(); }
+    static size_t getPageCount() { return _pages.size(); }
+
+private:
+    struct Key
+    {
+        std::string text;
+        FontDefinition fontDef;
+        float contentScaleFactor;
+
+        bool operator==(const Key& other) const;
+    };
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const;
+    };
+    // the shelf the next small rendering goes on
+    struct Page
+    {
+        Texture2D* texture;
+        int shelfX;
+        int shelfY;
+        int shelfHeight;
+    };
+    typedef std::list<std::pair<Key, SpriteFrame*>> EntryList;
+
+    static SpriteFrame* render(const std::string& text, const FontDefinition& fontDef);
+    static bool allocate(Page& page, int width, int height, int& x, int& y);
+    static void evictLeastRecentlyUsed();
+    static void removePage(size_t index);
+
+    static EntryList _entries;
+    static std::unordered_map<Key, EntryList::iterator, KeyHash> _entryMap;
+    static std::vector<Page> _pages;
+    static size_t _capacity;
+};
+
+NS_CC_END
+
+/// @endcond
+#endif
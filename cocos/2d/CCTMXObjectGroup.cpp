@@ -28,12 +28,18 @@ THE SOFTWARE.
 #include "2d/CCTMXObjectGroup.h"
 #include "base/ccMacros.h"
 
+#include <algorithm>
+#include <cmath>
+
 NS_CC_BEGIN
 
 //implementation TMXObjectGroup
 
 TMXObjectGroup::TMXObjectGroup()
     : _groupName("")
+    , _indexDirty(true)
+    , _gridColumns(0)
+    , _gridRows(0)
 {
 }
 
@@ -44,21 +50,186 @@ TMXObjectGroup::~TMXObjectGroup()
 
 ValueMap TMXObjectGroup::getObject(const std::string& objectName) const
 {
-    if (!_objects.empty())
+    const ObjectInfo* info = findObject(objectName);
+    if (info)
+        return _objects[info->index].asValueMap();
+
+    // object not found
+    return ValueMap();
+}
+
+const std::vector<TMXObjectGroup::ObjectInfo>& TMXObjectGroup::getObjectInfos() const
+{
+    ensureIndex();
+    return _objectInfos;
+}
+
+const std::vector<std::string>& TMXObjectGroup::getObjectStrings() const
+{
+    ensureIndex();
+    return _objectStrings;
+}
+
+const TMXObjectGroup::ObjectInfo* TMXObjectGroup::findObject(const std::string& objectName) const
+{
+    ensureIndex();
+    auto it = _nameIndex.find(objectName);
+    return it != _nameIndex.end() ? &_objectInfos[it->second] : nullptr;
+}
+
+void TMXObjectGroup::findObjectsByType(const std::string& type, std::vector<unsigned int>& result) const
+{
+    ensureIndex();
+    auto it = _typeIndex.find(type);
+    if (it != _typeIndex.end())
+        result.insert(result.end(), it->second.begin(), it->second.end());
+}
+
+int TMXObjectGroup::getCellX(float x) const
+{
+    int cell = (int)std::floor((x - _gridBounds.origin.x) / _cellSize.width);
+    return std::min(std::max(cell, 0), _gridColumns - 1);
+}
+
+int TMXObjectGroup::getCellY(float y) const
+{
+    int cell = (int)std::floor((y - _gridBounds.origin.y) / _cellSize.height);
+    return std::min(std::max(cell, 0), _gridRows - 1);
+}
+
+void TMXObjectGroup::queryObjects(const Rect& rect, std::vector<unsigned int>& result) const
+{
+    ensureIndex();
+    if (_objectInfos.empty() || !rect.intersectsRect(_gridBounds))
+        return;
+
+    int minX = getCellX(rect.getMinX()), maxX = getCellX(rect.getMaxX());
+    int minY = getCellY(rect.getMinY()), maxY = getCellY(rect.getMaxY());
+    for (int y = minY; y <= maxY; ++y)
     {
-        for (const auto& v : _objects)
+        for (int x = minX; x <= maxX; ++x)
         {
-            const ValueMap& dict = v.asValueMap();
-            if (dict.find("name") != dict.end())
+            int cell = y * _gridColumns + x;
+            for (unsigned int i = _cellStarts[cell]; i < _cellStarts[cell + 1]; ++i)
             {
-                if (dict.at("name").asString() == objectName)
-                    return dict;
+                unsigned int object = _cellObjects[i];
+                const Rect& objectRect = _objectInfos[object].rect;
+                if (!objectRect.intersectsRect(rect))
+                    continue;
+                // an object in several cells is only reported by the 1st cell of the overlap
+                if (getCellX(std::max(objectRect.getMinX(), rect.getMinX())) == x
+                    && getCellY(std::max(objectRect.getMinY(), rect.getMinY())) == y)
+                {
+                    result.push_back(object);
+                }
             }
         }
     }
+}
 
-    // object not found
-    return ValueMap();
+void TMXObjectGroup::queryObjects(const Vec2& point, std::vector<unsigned int>& result) const
+{
+    ensureIndex();
+    if (_objectInfos.empty() || !_gridBounds.containsPoint(point))
+        return;
+
+    int cell = getCellY(point.y) * _gridColumns + getCellX(point.x);
+    for (unsigned int i = _cellStarts[cell]; i < _cellStarts[cell + 1]; ++i)
+    {
+        unsigned int object = _cellObjects[i];
+        if (_objectInfos[object].rect.containsPoint(point))
+            result.push_back(object);
+    }
+}
+
+void TMXObjectGroup::buildIndex() const
+{
+    _indexDirty = false;
+    _objectInfos.clear();
+    _objectStrings.clear();
+    _nameIndex.clear();
+    _typeIndex.clear();
+    _cellStarts.clear();
+    _cellObjects.clear();
+    _gridColumns = _gridRows = 0;
+
+    std::unordered_map<std::string, int> strings;
+    auto intern = [&](const ValueMap& dict, const char* key) -> int {
+        auto it = dict.find(key);
+        if (it == dict.end() || it->second.isNull())
+            return -1;
+        std::string value = it->second.asString();
+        auto result = strings.insert(std::make_pair(value, (int)_objectStrings.size()));
+        if (result.second)
+            _objectStrings.push_back(value);
+        return result.first->second;
+    };
+    auto getFloat = [](const ValueMap& dict, const char* key) -> float {
+        auto it = dict.find(key);
+        return it != dict.end() ? it->second.asFloat() : 0.0f;
+    };
+    auto getUnsigned = [](const ValueMap& dict, const char* key) -> unsigned int {
+        auto it = dict.find(key);
+        // the gids have the flip flags in their high bits
+        return it != dict.end() ? (unsigned int)strtoul(it->second.asString().c_str(), nullptr, 10) : 0;
+    };
+
+    _objectInfos.reserve(_objects.size());
+    for (unsigned int i = 0; i < (unsigned int)_objects.size(); ++i)
+    {
+        if (_objects[i].getType() != Value::Type::MAP)
+            continue;
+        const ValueMap& dict = _objects[i].asValueMap();
+
+        ObjectInfo info;
+        info.rect.setRect(getFloat(dict, "x"), getFloat(dict, "y"), getFloat(dict, "width"), getFloat(dict, "height"));
+        info.id = getUnsigned(dict, "id");
+        info.gid = getUnsigned(dict, "gid");
+        info.name = intern(dict, "name");
+        info.type = intern(dict, "type");
+        info.index = i;
+
+        unsigned int object = (unsigned int)_objectInfos.size();
+        if (info.name >= 0)
+            _nameIndex.insert(std::make_pair(_objectStrings[info.name], object));
+        if (info.type >= 0)
+            _typeIndex[_objectStrings[info.type]].push_back(object);
+        _objectInfos.push_back(info);
+    }
+
+    if (_objectInfos.empty())
+        return;
+
+    // about one object per cell, at most 256 x 256 cells
+    _gridBounds = _objectInfos[0].rect;
+    for (const auto& info : _objectInfos)
+        _gridBounds.merge(info.rect);
+    int side = std::min(std::max((int)std::sqrt((float)_objectInfos.size()), 1), 256);
+    _gridColumns = _gridBounds.size.width > 0 ? side : 1;
+    _gridRows = _gridBounds.size.height > 0 ? side : 1;
+    _cellSize.width = _gridBounds.size.width > 0 ? _gridBounds.size.width / _gridColumns : 1.0f;
+    _cellSize.height = _gridBounds.size.height > 0 ? _gridBounds.size.height / _gridRows : 1.0f;
+
+    // counts the objects of each cell, then fills them in place
+    _cellStarts.assign(_gridColumns * _gridRows + 1, 0);
+    for (const auto& info : _objectInfos)
+    {
+        for (int y = getCellY(info.rect.getMinY()); y <= getCellY(info.rect.getMaxY()); ++y)
+            for (int x = getCellX(info.rect.getMinX()); x <= getCellX(info.rect.getMaxX()); ++x)
+                ++_cellStarts[y * _gridColumns + x + 1];
+    }
+    for (size_t i = 1; i < _cellStarts.size(); ++i)
+        _cellStarts[i] += _cellStarts[i - 1];
+
+    _cellObjects.resize(_cellStarts.back());
+    std::vector<unsigned int> fill(_cellStarts.begin(), _cellStarts.end() - 1);
+    for (unsigned int object = 0; object < (unsigned int)_objectInfos.size(); ++object)
+    {
+        const Rect& rect = _objectInfos[object].rect;
+        for (int y = getCellY(rect.getMinY()); y <= getCellY(rect.getMaxY()); ++y)
+            for (int x = getCellX(rect.getMinX()); x <= getCellX(rect.getMaxX()); ++x)
+                _cellObjects[fill[y * _gridColumns + x]++] = object;
+    }
 }
 
 Value TMXObjectGroup::getProperty(const std::string& propertyName) const
@@ -28,6 +28,9 @@ THE SOFTWARE.
 #ifndef __CCTMX_OBJECT_GROUP_H__
 #define __CCTMX_OBJECT_GROUP_H__
 
+#include <unordered_map>
+#include <vector>
+
 #include "math/CCGeometry.h"
 #include "base/CCValue.h"
 #include "base/CCRef.h"
@@ -45,6 +48,24 @@ NS_CC_BEGIN
 class CC_DLL TMXObjectGroup : public Ref
 {
 public:
+    /** The typed copy of an object of getObjects(), see getObjectInfos().
+     * @since v3.11
+     * @js NA
+     * @lua NA
+     */
+    struct ObjectInfo
+    {
+        /** The x, y, width and height of the object, in points. The polygons and polylines have no size. */
+        Rect rect;
+        unsigned int id;
+        unsigned int gid;
+        /** The name and the type, indices in getObjectStrings(). */
+        int name;
+        int type;
+        /** The index of the object in getObjects(), where its properties are. */
+        unsigned int index;
+    };
+
     /**
      * @js ctor
      */
@@ -82,6 +103,58 @@ public:
      */
     ValueMap getObject(const std::string& objectName) const;
 
+    /** Gets the typed copy of the objects, in the order of getObjects().
+     * The objects are indexed by name, type and position when the map is loaded. The non-const getObjects() and
+     * setObjects() mark the index to be built again on the next query, read the objects of a const group to keep it.
+     * @since v3.11
+     * @js NA
+     * @lua NA
+     */
+    const std::vector<ObjectInfo>& getObjectInfos() const;
+
+    /** Gets the names and types of the objects, see ObjectInfo.
+     * @since v3.11
+     * @js NA
+     * @lua NA
+     */
+    const std::vector<std::string>& getObjectStrings() const;
+
+    /** Returns the 1st object with the given name, nullptr when there is none. A hash lookup.
+     * @since v3.11
+     * @js NA
+     * @lua NA
+     */
+    const ObjectInfo* findObject(const std::string& objectName) const;
+
+    /** Appends the indices in getObjectInfos() of the objects of a type to `result`.
+     * @since v3.11
+     * @js NA
+     * @lua NA
+     */
+    void findObjectsByType(const std::string& type, std::vector<unsigned int>& result) const;
+
+    /** Appends the indices in getObjectInfos() of the objects whose rect intersects `rect` to `result`, in no
+     * particular order. Only the cells of a grid the rect overlaps are looked at.
+     * @since v3.11
+     * @js NA
+     * @lua NA
+     */
+    void queryObjects(const Rect& rect, std::vector<unsigned int>& result) const;
+
+    /** Appends the indices in getObjectInfos() of the objects that contain `point` to `result`.
+     * @since v3.11
+     * @js NA
+     * @lua NA
+     */
+    void queryObjects(const Vec2& point, std::vector<unsigned int>& result) const;
+
+    /** Builds the typed objects and their indexes, the TMX parser does it when the group is loaded.
+     * @since v3.11
+     * @js NA
+     * @lua NA
+     */
+    void buildIndex() const;
+
     /** Gets the offset position of child objects.
      *
      * @return The offset position of child objects.
@@ -114,7 +187,7 @@ public:
      * @return The array of the objects.
      */
     inline const ValueVector& getObjects() const { return _objects; };
-    inline ValueVector& getObjects() { return _objects; };
+    inline ValueVector& getObjects() { _indexDirty = true; return _objects; };
 
     /** Sets the array of the objects.
      *
@@ -122,6 +195,7 @@ public:
      */
     inline void setObjects(const ValueVector& objects) {
         _objects = objects;
+        _indexDirty = true;
     };
 
 protected:
@@ -133,6 +207,26 @@ protected:
     ValueMap _properties;
     /** array of the objects */
     ValueVector _objects;
+
+    // the index of getObjectInfos(), built when it's first needed after the objects changed
+    void ensureIndex() const { if (_indexDirty) buildIndex(); }
+    int getCellX(float x) const;
+    int getCellY(float y) const;
+
+    mutable bool _indexDirty;
+    mutable std::vector<ObjectInfo> _objectInfos;
+    mutable std::vector<std::string> _objectStrings;
+    // from a name to its 1st object, and from a type to its objects
+    mutable std::unordered_map<std::string, unsigned int> _nameIndex;
+    mutable std::unordered_map<std::string, std::vector<unsigned int>> _typeIndex;
+    // the objects of each cell of the grid, the cells are in rows from the bottom left corner of the bounds:
+    // the objects of cell i are _cellObjects[_cellStarts[i]] to _cellObjects[_cellStarts[i + 1] - 1]
+    mutable Rect _gridBounds;
+    mutable Size _cellSize;
+    mutable int _gridColumns;
+    mutable int _gridRows;
+    mutable std::vector<unsigned int> _cellStarts;
+    mutable std::vector<unsigned int> _cellObjects;
 };
 
 // end of tilemap_parallax_nodes group
@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include "base/ZipUtils.h"
 #include "base/base64.h"
 #include "base/CCDirector.h"
+#include "base/CCAssetPack.h"
 #include "platform/CCFileUtils.h"
 
 using namespace std;
@@ -100,6 +101,339 @@ Rect TMXTilesetInfo::getRectForGID(uint32_t gid)
     return rect;
 }
 
+namespace
+{
+    /*
+     The binary maps written by TMXMapInfo::writeBinaryFile(), little endian:
+
+         "CTMX", u16 version, u16 reserved, u32 sourceSize, u32 sourceHash,
+         i32 orientation, f32 mapWidth, mapHeight, tileWidth, tileHeight,
+         value properties, u32 tilePropertiesCount, tilePropertiesCount times: i32 gid, value properties
+         u32 tilesetCount, tilesetCount times:
+             string name, i32 firstGid, f32 tileWidth, tileHeight, i32 spacing, margin,
+             u8 imageRelative, string sourceImage, f32 imageWidth, imageHeight,
+             u32 animationCount, animationCount times: u32 gid, u32 frameCount, frameCount times: u32 gid, f32 duration
+         u32 layerCount, layerCount times:
+             string name, value properties, f32 layerWidth, layerHeight, u8 visible, u8 opacity, f32 offsetX, offsetY,
+             u32 tileCount, padding to 4 bytes, tileCount u32 gids
+         u32 objectGroupCount, objectGroupCount times:
+             string name, f32 offsetX, offsetY, value properties, value objects
+
+     A string is a u32 length followed by the bytes, without terminator.
+     A value is a u8 Value::Type followed by its content, containers start with a u32 count.
+     sourceSize and sourceHash describe the .tmx the file was made from, they are 0 for files made at build time.
+     */
+    const char BINARY_MAGIC[4] = { 'C', 'T', 'M', 'X' };
+    const unsigned short BINARY_VERSION = 2;
+    const int MAX_VALUE_DEPTH = 32;
+
+    bool s_binaryCacheEnabled = false;
+
+    class BinaryReader
+    {
+    public:
+        BinaryReader(const unsigned char* data, ssize_t size)
+        : _p(data)
+        , _begin(data)
+        , _end(data + size)
+        , _ok(true)
+        {}
+
+        bool isOK() const { return _ok; }
+
+        bool readHeader(unsigned int& sourceSize, unsigned int& sourceHash)
+        {
+            if (! has(8) || memcmp(_p, BINARY_MAGIC, 4) != 0)
+            {
+                return false;
+            }
+            _p += 4;
+            if (readU16() != BINARY_VERSION)
+            {
+                CCLOG("cocos2d: TMXFormat: unsupported binary map version");
+                return false;
+            }
+            readU16();
+            sourceSize = readU32();
+            sourceHash = readU32();
+            return _ok;
+        }
+
+        unsigned char readU8()
+        {
+            if (! has(1)) return 0;
+            return *_p++;
+        }
+
+        unsigned short readU16()
+        {
+            if (! has(2)) return 0;
+            unsigned short v = (unsigned short)(_p[0] | (_p[1] << 8));
+            _p += 2;
+            return v;
+        }
+
+        unsigned int readU32()
+        {
+            if (! has(4)) return 0;
+            unsigned int v = (unsigned int)_p[0] | ((unsigned int)_p[1] << 8) | ((unsigned int)_p[2] << 16) | ((unsigned int)_p[3] << 24);
+            _p += 4;
+            return v;
+        }
+
+        int readInt() { return (int)readU32(); }
+
+        float readFloat()
+        {
+            unsigned int bits = readU32();
+            float v;
+            memcpy(&v, &bits, sizeof(v));
+            return v;
+        }
+
+        double readDouble()
+        {
+            unsigned long long bits = readU32();
+            bits |= (unsigned long long)readU32() << 32;
+            double v;
+            memcpy(&v, &bits, sizeof(v));
+            return v;
+        }
+
+        void readString(std::string& str)
+        {
+            unsigned int length = readU32();
+            if (! has(length))
+            {
+                str.clear();
+                return;
+            }
+            str.assign(reinterpret_cast<const char*>(_p), length);
+            _p += length;
+        }
+
+        Value readValue(int depth = 0)
+        {
+            auto type = (Value::Type)readU8();
+            if (depth > MAX_VALUE_DEPTH)
+            {
+                _ok = false;
+            }
+            if (! _ok)
+            {
+                return Value::Null;
+            }
+
+            switch (type)
+            {
+                case Value::Type::NONE:
+                    return Value::Null;
+                case Value::Type::BYTE:
+                    return Value(readU8());
+                case Value::Type::INTEGER:
+                    return Value(readInt());
+                case Value::Type::FLOAT:
+                    return Value(readFloat());
+                case Value::Type::DOUBLE:
+                    return Value(readDouble());
+                case Value::Type::BOOLEAN:
+                    return Value(readU8() != 0);
+                case Value::Type::STRING:
+                {
+                    // straight from the file, the short strings don't allocate
+                    unsigned int length = readU32();
+                    if (! has(length))
+                    {
+                        return Value("");
+                    }
+                    Value value(reinterpret_cast<const char*>(_p), length);
+                    _p += length;
+                    return value;
+                }
+                case Value::Type::VECTOR:
+                {
+                    ValueVector vector;
+                    unsigned int count = readU32();
+                    for (unsigned int i = 0; i < count && _ok; ++i)
+                    {
+                        vector.push_back(readValue(depth + 1));
+                    }
+                    return Value(std::move(vector));
+                }
+                case Value::Type::MAP:
+                {
+                    ValueMap map;
+                    readValueMap(map, depth + 1);
+                    return Value(std::move(map));
+                }
+                case Value::Type::INT_KEY_MAP:
+                {
+                    ValueMapIntKey map;
+                    unsigned int count = readU32();
+                    for (unsigned int i = 0; i < count && _ok; ++i)
+                    {
+                        int key = readInt();
+                        map[key] = readValue(depth + 1);
+                    }
+                    return Value(std::move(map));
+                }
+                default:
+                    _ok = false;
+                    return Value::Null;
+            }
+        }
+
+        void readValueMap(ValueMap& map, int depth = 0)
+        {
+            unsigned int count = readU32();
+            map.reserve(count);
+            std::string key;
+            for (unsigned int i = 0; i < count && _ok; ++i)
+            {
+                readString(key);
+                map[key] = readValue(depth + 1);
+            }
+        }
+
+        /** Skips to the next 4 bytes boundary of the file. */
+        void align()
+        {
+            ssize_t padding = (4 - ((_p - _begin) & 3)) & 3;
+            if (has(padding))
+            {
+                _p += padding;
+            }
+        }
+
+        const unsigned char* readBytes(ssize_t count)
+        {
+            if (! has(count)) return nullptr;
+            const unsigned char* bytes = _p;
+            _p += count;
+            return bytes;
+        }
+
+    private:
+        bool has(ssize_t count)
+        {
+            if (count < 0 || _end - _p < count)
+            {
+                _ok = false;
+            }
+            return _ok;
+        }
+
+        const unsigned char* _p;
+        const unsigned char* _begin;
+        const unsigned char* _end;
+        bool _ok;
+    };
+
+    class BinaryWriter
+    {
+    public:
+        void writeU8(unsigned char v) { _bytes.push_back(v); }
+        void writeU16(unsigned short v) { writeU8(v & 0xff); writeU8(v >> 8); }
+        void writeU32(unsigned int v) { writeU16(v & 0xffff); writeU16(v >> 16); }
+        void writeInt(int v) { writeU32((unsigned int)v); }
+        void writeFloat(float v)
+        {
+            unsigned int bits;
+            memcpy(&bits, &v, sizeof(bits));
+            writeU32(bits);
+        }
+        void writeDouble(double v)
+        {
+            unsigned long long bits;
+            memcpy(&bits, &v, sizeof(bits));
+            writeU32((unsigned int)(bits & 0xffffffff));
+            writeU32((unsigned int)(bits >> 32));
+        }
+        void writeString(const std::string& str)
+        {
+            writeU32((unsigned int)str.length());
+            _bytes.insert(_bytes.end(), str.begin(), str.end());
+        }
+
+        void writeValue(const Value& value)
+        {
+            writeU8((unsigned char)value.getType());
+            switch (value.getType())
+            {
+                case Value::Type::BYTE:
+                    writeU8(value.asByte());
+                    break;
+                case Value::Type::INTEGER:
+                    writeInt(value.asInt());
+                    break;
+                case Value::Type::FLOAT:
+                    writeFloat(value.asFloat());
+                    break;
+                case Value::Type::DOUBLE:
+                    writeDouble(value.asDouble());
+                    break;
+                case Value::Type::BOOLEAN:
+                    writeU8(value.asBool() ? 1 : 0);
+                    break;
+                case Value::Type::STRING:
+                    writeString(value.asString());
+                    break;
+                case Value::Type::VECTOR:
+                    writeU32((unsigned int)value.asValueVector().size());
+                    for (const auto& child : value.asValueVector())
+                    {
+                        writeValue(child);
+                    }
+                    break;
+                case Value::Type::MAP:
+                    writeValueMap(value.asValueMap());
+                    break;
+                case Value::Type::INT_KEY_MAP:
+                    writeU32((unsigned int)value.asIntKeyMap().size());
+                    for (const auto& child : value.asIntKeyMap())
+                    {
+                        writeInt(child.first);
+                        writeValue(child.second);
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        void writeValueMap(const ValueMap& map)
+        {
+            writeU32((unsigned int)map.size());
+            for (const auto& child : map)
+            {
+                writeString(child.first);
+                writeValue(child.second);
+            }
+        }
+
+        void align()
+        {
+            while (_bytes.size() & 3)
+            {
+                writeU8(0);
+            }
+        }
+
+        std::vector<unsigned char> _bytes;
+    };
+
+    bool isBinaryMap(const unsigned char* data, ssize_t size)
+    {
+        return data && size >= 4 && memcmp(data, BINARY_MAGIC, 4) == 0;
+    }
+
+    std::string getDirectory(const std::string& path)
+    {
+        size_t pos = path.find_last_of("/");
+        return pos != std::string::npos ? path.substr(0, pos + 1) : "";
+    }
+}
+
 // implementation TMXMapInfo
 
 TMXMapInfo * TMXMapInfo::create(const std::string& tmxFile)
@@ -157,7 +491,283 @@ bool TMXMapInfo::initWithXML(const std::string& tmxString, const std::string& re
 bool TMXMapInfo::initWithTMXFile(const std::string& tmxFile)
 {
     internalInit(tmxFile, "");
-    return parseXMLFile(_TMXFileName);
+
+    auto fileUtils = FileUtils::getInstance();
+    FileView view = fileUtils->getFileView(_TMXFileName);
+    if (isBinaryMap(view.getBytes(), view.getSize()))
+    {
+        return initWithBinaryData(view.getBytes(), view.getSize(), 0, 0);
+    }
+
+    if (! s_binaryCacheEnabled || view.isNull())
+    {
+        return parseXMLFile(_TMXFileName);
+    }
+
+    // the cache is named after the map, and only used while the map has the same size and hash
+    const unsigned int sourceSize = (unsigned int)view.getSize();
+    const unsigned int sourceHash = AssetPack::hash(reinterpret_cast<const char*>(view.getBytes()), view.getSize());
+    std::string cacheDirectory = fileUtils->getWritablePath() + "tmxcache/";
+    char cacheName[16];
+    snprintf(cacheName, sizeof(cacheName), "%08x.tmxb", AssetPack::hash(_TMXFileName.c_str(), _TMXFileName.length()));
+    std::string cachePath = cacheDirectory + cacheName;
+
+    if (fileUtils->isFileExist(cachePath))
+    {
+        FileView cache = fileUtils->getFileView(cachePath);
+        unsigned int cachedSize = 0;
+        unsigned int cachedHash = 0;
+        BinaryReader reader(cache.getBytes(), cache.getSize());
+        if (reader.readHeader(cachedSize, cachedHash) && cachedSize == sourceSize && cachedHash == sourceHash
+            && initWithBinaryData(cache.getBytes(), cache.getSize(), sourceSize, sourceHash))
+        {
+            return true;
+        }
+    }
+
+    SAXParser parser;
+    if (! parser.init("UTF-8"))
+    {
+        return false;
+    }
+    parser.setDelegator(this);
+    bool ret = parser.parse(reinterpret_cast<const char*>(view.getBytes()), view.getSize());
+
+    if (ret && fileUtils->createDirectory(cacheDirectory))
+    {
+        writeBinaryFile(cachePath, sourceSize, sourceHash);
+    }
+    return ret;
+}
+
+void TMXMapInfo::setBinaryCacheEnabled(bool enabled)
+{
+    s_binaryCacheEnabled = enabled;
+}
+
+bool TMXMapInfo::isBinaryCacheEnabled()
+{
+    return s_binaryCacheEnabled;
+}
+
+bool TMXMapInfo::convertTMXToBinary(const std::string& tmxFile, const std::string& binaryFullPath)
+{
+    TMXMapInfo* mapInfo = TMXMapInfo::create(tmxFile);
+    if (! mapInfo)
+    {
+        CCLOG("cocos2d: TMXFormat: can not read %s", tmxFile.c_str());
+        return false;
+    }
+    return mapInfo->writeBinaryFile(binaryFullPath, 0, 0);
+}
+
+bool TMXMapInfo::writeBinaryFile(const std::string& binaryFullPath, unsigned int sourceSize, unsigned int sourceHash) const
+{
+    BinaryWriter writer;
+    writer._bytes.insert(writer._bytes.end(), BINARY_MAGIC, BINARY_MAGIC + 4);
+    writer.writeU16(BINARY_VERSION);
+    writer.writeU16(0);
+    writer.writeU32(sourceSize);
+    writer.writeU32(sourceHash);
+
+    writer.writeInt(_orientation);
+    writer.writeFloat(_mapSize.width);
+    writer.writeFloat(_mapSize.height);
+    writer.writeFloat(_tileSize.width);
+    writer.writeFloat(_tileSize.height);
+    writer.writeValueMap(_properties);
+    writer.writeU32((unsigned int)_tileProperties.size());
+    for (const auto& iter : _tileProperties)
+    {
+        writer.writeInt(iter.first);
+        writer.writeValue(iter.second);
+    }
+
+    // images next to the map are stored relative to it, so the cache keeps working when the app moves
+    std::string directory = getDirectory(_TMXFileName);
+    writer.writeU32((unsigned int)_tilesets.size());
+    for (const auto& tileset : _tilesets)
+    {
+        writer.writeString(tileset->_name);
+        writer.writeInt(tileset->_firstGid);
+        writer.writeFloat(tileset->_tileSize.width);
+        writer.writeFloat(tileset->_tileSize.height);
+        writer.writeInt(tileset->_spacing);
+        writer.writeInt(tileset->_margin);
+        const bool relative = ! directory.empty() && tileset->_sourceImage.compare(0, directory.length(), directory) == 0;
+        writer.writeU8(relative ? 1 : 0);
+        writer.writeString(relative ? tileset->_sourceImage.substr(directory.length()) : tileset->_sourceImage);
+        writer.writeFloat(tileset->_imageSize.width);
+        writer.writeFloat(tileset->_imageSize.height);
+        writer.writeU32((unsigned int)tileset->_animations.size());
+        for (const auto& animation : tileset->_animations)
+        {
+            writer.writeU32(animation.first);
+            writer.writeU32((unsigned int)animation.second.size());
+            for (const auto& frame : animation.second)
+            {
+                writer.writeU32(frame.gid);
+                writer.writeFloat(frame.duration);
+            }
+        }
+    }
+
+    writer.writeU32((unsigned int)_layers.size());
+    for (const auto& layer : _layers)
+    {
+        writer.writeString(layer->_name);
+        writer.writeValueMap(layer->_properties);
+        writer.writeFloat(layer->_layerSize.width);
+        writer.writeFloat(layer->_layerSize.height);
+        writer.writeU8(layer->_visible ? 1 : 0);
+        writer.writeU8(layer->_opacity);
+        writer.writeFloat(layer->_offset.x);
+        writer.writeFloat(layer->_offset.y);
+
+        unsigned int tileCount = layer->_tiles ? (unsigned int)(layer->_layerSize.width * layer->_layerSize.height) : 0;
+        writer.writeU32(tileCount);
+        writer.align();
+        // the gids are kept in the byte order of the decoded .tmx data
+        const unsigned char* tiles = reinterpret_cast<const unsigned char*>(layer->_tiles);
+        writer._bytes.insert(writer._bytes.end(), tiles, tiles + tileCount * sizeof(uint32_t));
+    }
+
+    writer.writeU32((unsigned int)_objectGroups.size());
+    for (const auto& objectGroup : _objectGroups)
+    {
+        writer.writeString(objectGroup->getGroupName());
+        writer.writeFloat(objectGroup->getPositionOffset().x);
+        writer.writeFloat(objectGroup->getPositionOffset().y);
+        writer.writeValueMap(objectGroup->getProperties());
+        writer.writeValue(Value(objectGroup->getObjects()));
+    }
+
+    Data data;
+    data.fastSet(writer._bytes.data(), writer._bytes.size());
+    bool ret = FileUtils::getInstance()->writeDataToFile(data, binaryFullPath);
+    data.fastSet(nullptr, 0);
+    return ret;
+}
+
+bool TMXMapInfo::initWithBinaryData(const unsigned char* data, ssize_t size, unsigned int sourceSize, unsigned int sourceHash)
+{
+    BinaryReader reader(data, size);
+    unsigned int fileSourceSize = 0;
+    unsigned int fileSourceHash = 0;
+    if (! reader.readHeader(fileSourceSize, fileSourceHash)
+        || fileSourceSize != sourceSize || fileSourceHash != sourceHash)
+    {
+        return false;
+    }
+
+    _orientation = reader.readInt();
+    _mapSize.width = reader.readFloat();
+    _mapSize.height = reader.readFloat();
+    _tileSize.width = reader.readFloat();
+    _tileSize.height = reader.readFloat();
+    reader.readValueMap(_properties);
+    unsigned int tilePropertiesCount = reader.readU32();
+    for (unsigned int i = 0; i < tilePropertiesCount && reader.isOK(); ++i)
+    {
+        int gid = reader.readInt();
+        _tileProperties[gid] = reader.readValue();
+    }
+
+    std::string directory = getDirectory(_TMXFileName);
+    unsigned int tilesetCount = reader.readU32();
+    for (unsigned int i = 0; i < tilesetCount && reader.isOK(); ++i)
+    {
+        TMXTilesetInfo* tileset = new (std::nothrow) TMXTilesetInfo();
+        reader.readString(tileset->_name);
+        tileset->_firstGid = reader.readInt();
+        tileset->_tileSize.width = reader.readFloat();
+        tileset->_tileSize.height = reader.readFloat();
+        tileset->_spacing = reader.readInt();
+        tileset->_margin = reader.readInt();
+        const bool relative = reader.readU8() != 0;
+        reader.readString(tileset->_sourceImage);
+        if (relative)
+        {
+            tileset->_sourceImage = directory + tileset->_sourceImage;
+        }
+        tileset->_imageSize.width = reader.readFloat();
+        tileset->_imageSize.height = reader.readFloat();
+        unsigned int animationCount = reader.readU32();
+        for (unsigned int j = 0; j < animationCount && reader.isOK(); ++j)
+        {
+            auto& frames = tileset->_animations[reader.readU32()];
+            unsigned int frameCount = reader.readU32();
+            for (unsigned int k = 0; k < frameCount && reader.isOK(); ++k)
+            {
+                TMXTileAnimationFrame frame;
+                frame.gid = reader.readU32();
+                frame.duration = reader.readFloat();
+                frames.push_back(frame);
+            }
+        }
+        _tilesets.pushBack(tileset);
+        tileset->release();
+    }
+
+    unsigned int layerCount = reader.readU32();
+    for (unsigned int i = 0; i < layerCount && reader.isOK(); ++i)
+    {
+        TMXLayerInfo* layer = new (std::nothrow) TMXLayerInfo();
+        reader.readString(layer->_name);
+        reader.readValueMap(layer->_properties);
+        layer->_layerSize.width = reader.readFloat();
+        layer->_layerSize.height = reader.readFloat();
+        layer->_visible = reader.readU8() != 0;
+        layer->_opacity = reader.readU8();
+        layer->_offset.x = reader.readFloat();
+        layer->_offset.y = reader.readFloat();
+
+        unsigned int tileCount = reader.readU32();
+        reader.align();
+        const unsigned char* tiles = reader.readBytes((ssize_t)tileCount * sizeof(uint32_t));
+        if (tiles && tileCount > 0)
+        {
+            // the layer owns its tiles and setTileGID() writes to them, they can't point into the file
+            layer->_tiles = (uint32_t*) malloc(tileCount * sizeof(uint32_t));
+            memcpy(layer->_tiles, tiles, tileCount * sizeof(uint32_t));
+        }
+        _layers.pushBack(layer);
+        layer->release();
+    }
+
+    unsigned int objectGroupCount = reader.readU32();
+    for (unsigned int i = 0; i < objectGroupCount && reader.isOK(); ++i)
+    {
+        TMXObjectGroup* objectGroup = new (std::nothrow) TMXObjectGroup();
+        std::string name;
+        reader.readString(name);
+        objectGroup->setGroupName(name);
+        Vec2 offset;
+        offset.x = reader.readFloat();
+        offset.y = reader.readFloat();
+        objectGroup->setPositionOffset(offset);
+        reader.readValueMap(objectGroup->getProperties());
+        Value objects = reader.readValue();
+        if (objects.getType() == Value::Type::VECTOR)
+        {
+            objectGroup->setObjects(objects.asValueVector());
+        }
+        objectGroup->buildIndex();
+        _objectGroups.pushBack(objectGroup);
+        objectGroup->release();
+    }
+
+    if (! reader.isOK())
+    {
+        CCLOG("cocos2d: TMXFormat: the binary map %s is truncated", _TMXFileName.c_str());
+        _tilesets.clear();
+        _layers.clear();
+        _objectGroups.clear();
+        _properties.clear();
+        _tileProperties.clear();
+        return false;
+    }
+    return true;
 }
 
 TMXMapInfo::TMXMapInfo()
@@ -341,6 +951,18 @@ void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
             tmxMapInfo->setParentElement(TMXPropertyTile);
         }
     }
+    else if (elementName == "frame")
+    {
+        // a frame of the <animation> of the current <tile>
+        if (tmxMapInfo->getParentElement() == TMXPropertyTile)
+        {
+            TMXTilesetInfo* info = tmxMapInfo->getTilesets().back();
+            TMXTileAnimationFrame frame;
+            frame.gid = static_cast<uint32_t>(info->_firstGid + attributeDict["tileid"].asInt());
+            frame.duration = attributeDict["duration"].asInt() / 1000.0f;
+            info->_animations[tmxMapInfo->getParentGID()].push_back(frame);
+        }
+    }
     else if (elementName == "layer")
     {
         TMXLayerInfo *layer = new (std::nothrow) TMXLayerInfo();
@@ -687,6 +1309,7 @@ void TMXMapInfo::endElement(void *ctx, const char *name)
     {
         // The objectgroup element has ended
         tmxMapInfo->setParentElement(TMXPropertyNone);
+        tmxMapInfo->getObjectGroups().back()->buildIndex();
     }
     else if (elementName == "object")
     {
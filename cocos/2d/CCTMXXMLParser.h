@@ -38,6 +38,8 @@ THE SOFTWARE.
 #include "2d/CCTMXObjectGroup.h" // needed for Vector<TMXObjectGroup*> for binding
 
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 NS_CC_BEGIN
 
@@ -117,6 +119,17 @@ public:
     Vec2               _offset;
 };
 
+/** @brief A frame of the animation of a tile, made with the tile editor of Tiled.
+ * @since v3.11
+ */
+struct TMXTileAnimationFrame
+{
+    //! the gid of the tile shown
+    uint32_t gid;
+    //! how long it is shown, in seconds
+    float duration;
+};
+
 /** @brief TMXTilesetInfo contains the information about the tilesets like:
 - Tileset name
 - Tileset spacing
@@ -139,6 +152,8 @@ public:
     std::string     _sourceImage;
     //! size in pixels of the image
     Size            _imageSize;
+    //! the frames of the animated tiles, by gid
+    std::unordered_map<uint32_t, std::vector<TMXTileAnimationFrame>> _animations;
 public:
     /**
      * @js ctor
@@ -183,7 +198,29 @@ public:
      */
     virtual ~TMXMapInfo();
 
-    /** initializes a TMX format with a  tmx file */
+    /**
+     Converts a tmx file to the binary map format at build time.
+     initWithTMXFile() and TMXTiledMap::create() read the binary file like a tmx file, without XML parsing,
+     base64 decoding or inflating. The tileset images are looked up next to the binary file,
+     so it should replace the tmx file in the resources.
+     @since v3.11
+     */
+    static bool convertTMXToBinary(const std::string& tmxFile, const std::string& binaryFullPath);
+
+    /**
+     Enables the binary cache of the tmx files, it is disabled by default.
+     The first load of a tmx file writes the parsed map under "tmxcache/" of the writable path,
+     the next loads read it while the tmx file keeps the same size and content hash.
+     External tilesets (.tsx) are not checked.
+     @since v3.11
+     */
+    static void setBinaryCacheEnabled(bool enabled);
+    /** Whether the binary cache of the tmx files is enabled.
+     @since v3.11
+     */
+    static bool isBinaryCacheEnabled();
+
+    /** initializes a TMX format with a  tmx file, or a binary map made by convertTMXToBinary() */
     bool initWithTMXFile(const std::string& tmxFile);
     /** initializes a TMX format with an XML string and a TMX resource path */
     bool initWithXML(const std::string& tmxString, const std::string& resourcePath);
@@ -278,6 +315,8 @@ public:
 
 protected:
     void internalInit(const std::string& tmxFileName, const std::string& resourcePath);
+    bool initWithBinaryData(const unsigned char* data, ssize_t size, unsigned int sourceSize, unsigned int sourceHash);
+    bool writeBinaryFile(const std::string& binaryFullPath, unsigned int sourceSize, unsigned int sourceHash) const;
 
     /// map orientation
     int    _orientation;
@@ -0,0 +1,157 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "2d/CCTransformSystem.h"
+
+#include <string.h>
+
+#include "2d/CCNode.h"
+
+NS_CC_BEGIN
+
+TransformSystem* TransformSystem::s_current = nullptr;
+
+TransformSystem::TransformSystem()
+: _root(nullptr)
+, _hierarchyVersion(0)
+, _rootParentFlags(0)
+{
+}
+
+void TransformSystem::rebuild(Node* root)
+{
+    _root = root;
+    _hierarchyVersion = Node::s_hierarchyVersion;
+
+    _nodes.clear();
+    _parents.clear();
+
+    // breadth first, the parents come before their children
+    _nodes.push_back(root);
+    _parents.push_back(-1);
+    for (size_t i = 0; i < _nodes.size(); ++i)
+    {
+        auto node = _nodes[i];
+        node->_transformIndex = (int)i;
+        for (const auto& child : node->_children)
+        {
+            _nodes.push_back(child);
+            _parents.push_back((int)i);
+        }
+    }
+
+    _locals.resize(_nodes.size());
+    _worlds.resize(_nodes.size());
+    _flags.assign(_nodes.size(), 0);
+    _states.assign(_nodes.size(), 0);
+}
+
+void TransformSystem::update(Node* root, const Mat4& parentTransform, uint32_t parentFlags)
+{
+    if (root != _root || _hierarchyVersion != Node::s_hierarchyVersion)
+    {
+        rebuild(root);
+    }
+
+    _rootParentTransform = parentTransform;
+    _rootParentFlags = parentFlags;
+
+    const size_t count = _nodes.size();
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto node = _nodes[i];
+        const int parent = _parents[i];
+
+        // like visit(), the hidden subtrees keep their dirty flags until they're shown
+        if (!node->_visible || (parent >= 0 && !(_states[parent] & STATE_UPDATED)))
+        {
+            _states[i] &= ~STATE_UPDATED;
+            continue;
+        }
+
+        // the flags of a node that wasn't visited, e.g. in a culled subtree
+        const uint32_t missedFlags = (_states[i] & (STATE_UPDATED | STATE_VISITED)) == STATE_UPDATED ? (_flags[i] & Node::FLAGS_DIRTY_MASK) : 0;
+        const uint32_t flags = node->updateTransformFlags(parent >= 0 ? _flags[parent] : parentFlags) | missedFlags;
+        if ((flags & Node::FLAGS_DIRTY_MASK) || !(_states[i] & STATE_WORLD_VALID))
+        {
+            _locals[i] = node->getNodeToParentTransform();
+            const Mat4& parentWorld = parent >= 0 ? _worlds[parent] : parentTransform;
+            if (TransformIsAffine2D(_locals[i]) && TransformIsAffine2D(parentWorld))
+                TransformConcatAffine2D(parentWorld, _locals[i], &_worlds[i]);
+            else
+                Mat4::multiply(parentWorld, _locals[i], &_worlds[i]);
+        }
+        _flags[i] = flags;
+        _states[i] = STATE_UPDATED | STATE_WORLD_VALID;
+    }
+}
+
+bool TransformSystem::fetchTransform(Node* node, const Mat4& parentTransform, uint32_t parentFlags, uint32_t* flags)
+{
+    node->_transformFromSystem = false;
+    *flags = 0;
+
+    auto system = s_current;
+    const int index = node->_transformIndex;
+    if (system == nullptr || index < 0 || index >= (int)system->_nodes.size() || system->_nodes[index] != node || !(system->_states[index] & STATE_UPDATED))
+    {
+        return false;
+    }
+    system->_states[index] |= STATE_VISITED;
+    // update() consumed the dirty flags of the node, they are given back if it computes its transform
+    *flags = system->_flags[index] & Node::FLAGS_DIRTY_MASK;
+
+    // changed since update()
+    if (node->_transformUpdated || node->_contentSizeDirty || (node->_usingNormalizedPosition && node->_normalizedPositionDirty))
+    {
+        return false;
+    }
+
+    // the parent must pass the transform update() used
+    const int parent = system->_parents[index];
+    if (parent < 0)
+    {
+        if (parentFlags != system->_rootParentFlags || memcmp(parentTransform.m, system->_rootParentTransform.m, sizeof(parentTransform.m)) != 0)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        auto parentNode = node->_parent;
+        if (parentNode != system->_nodes[parent] || !parentNode->_transformFromSystem
+            || &parentTransform != &parentNode->_modelViewTransform || parentFlags != system->_flags[parent])
+        {
+            return false;
+        }
+    }
+
+    node->_modelViewTransform = system->_worlds[index];
+    node->_transformFromSystem = true;
+    *flags = system->_flags[index];
+    return true;
+}
+
+NS_CC_END
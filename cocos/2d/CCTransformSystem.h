@@ -0,0 +1,112 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CC_TRANSFORM_SYSTEM_H__
+#define __CC_TRANSFORM_SYSTEM_H__
+
+#include <vector>
+
+#include "math/CCMath.h"
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+
+class Node;
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/** @class TransformSystem
+ @brief Updates the model view transforms of a Scene before it is visited, see Scene::setTransformSystemEnabled().
+ The nodes of the scene are kept in arrays ordered by depth, a parent before its children, with their local
+ and world transforms next to each other. update() goes once over the arrays and multiplies the dirty ones,
+ then visit() takes the world transforms instead of computing them node by node.
+ The arrays are rebuilt when a child is added or removed. The nodes visited with another parent transform,
+ like the protected children or the nodes moved during the visit, compute their transform as usual.
+ @since v3.11
+ @js NA
+ @lua NA
+ */
+class CC_DLL TransformSystem
+{
+public:
+    TransformSystem();
+
+    /** Updates the transforms of `root` and of its subtree, like visit() would. */
+    void update(Node* root, const Mat4& parentTransform, uint32_t parentFlags);
+
+    /** Gets the number of nodes in the arrays. */
+    ssize_t getNodeCount() const { return (ssize_t)_nodes.size(); }
+
+    /** Gets the system of the Scene being visited, nullptr if it has none. */
+    static TransformSystem* getCurrent() { return s_current; }
+    /** Sets the system of the Scene being visited. */
+    static void setCurrent(TransformSystem* system) { s_current = system; }
+
+    /**
+     * Gives the node the transform and flags update() computed for it, if the node and its parent are still
+     * where update() left them. Node::processParentFlags() calls it.
+     * @return False if the node must compute its transform itself, `flags` are then the dirty flags update() consumed.
+     */
+    static bool fetchTransform(Node* node, const Mat4& parentTransform, uint32_t parentFlags, uint32_t* flags);
+
+protected:
+    void rebuild(Node* root);
+
+    enum
+    {
+        // update() went through the node, it's not in a hidden subtree
+        STATE_UPDATED = 1 << 0,
+        // the world transform was computed since the arrays were rebuilt
+        STATE_WORLD_VALID = 1 << 1,
+        // the node was visited, if it wasn't its dirty flags are kept for the next update()
+        STATE_VISITED = 1 << 2,
+    };
+
+    Node*           _root;
+    unsigned int    _hierarchyVersion;
+
+    Mat4            _rootParentTransform;
+    uint32_t        _rootParentFlags;
+
+    // one entry per node, ordered by depth
+    std::vector<Node*>      _nodes;
+    std::vector<int>        _parents;
+    std::vector<Mat4>       _locals;
+    std::vector<Mat4>       _worlds;
+    std::vector<uint32_t>   _flags;
+    std::vector<unsigned char> _states;
+
+    static TransformSystem* s_current;
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif // __CC_TRANSFORM_SYSTEM_H__
@@ -48,6 +48,11 @@ TransitionScene::TransitionScene()
 , _duration(0.0f)
 , _isInSceneOnTop(false)
 , _isSendCleanupToScene(false)
+, _snapshotOutScene(false)
+, _snapshotInScene(false)
+, _snapshotScale(1.0f)
+, _outSnapshot(nullptr)
+, _inSnapshot(nullptr)
 {
 }
 
@@ -55,6 +60,8 @@ TransitionScene::~TransitionScene()
 {
     CC_SAFE_RELEASE(_inScene);
     CC_SAFE_RELEASE(_outScene);
+    CC_SAFE_RELEASE(_outSnapshot);
+    CC_SAFE_RELEASE(_inSnapshot);
 }
 
 TransitionScene * TransitionScene::create(float t, Scene *scene)
@@ -109,14 +116,58 @@ void TransitionScene::draw(Renderer *renderer, const Mat4 &transform, uint32_t f
     Scene::draw(renderer, transform, flags);
 
     if( _isInSceneOnTop ) {
-        _outScene->visit(renderer, transform, flags);
-        _inScene->visit(renderer, transform, flags);
+        visitScene(_outScene, _outSnapshot, renderer, transform, flags);
+        visitScene(_inScene, _inSnapshot, renderer, transform, flags);
     } else {
-        _inScene->visit(renderer, transform, flags);
-        _outScene->visit(renderer, transform, flags);
+        visitScene(_inScene, _inSnapshot, renderer, transform, flags);
+        visitScene(_outScene, _outSnapshot, renderer, transform, flags);
+    }
+}
+
+void TransitionScene::visitScene(Scene* scene, RenderTexture* snapshot, Renderer* renderer, const Mat4& transform, uint32_t flags)
+{
+    if (!snapshot)
+    {
+        scene->visit(renderer, transform, flags);
+        return;
+    }
+
+    // the snapshot follows the position, scale and rotation the actions give to the scene
+    if (scene->isVisible())
+    {
+        snapshot->visit(renderer, transform * scene->getNodeToParentTransform(), flags | FLAGS_TRANSFORM_DIRTY);
     }
 }
 
+RenderTexture* TransitionScene::createSnapshot(Scene* scene)
+{
+    Size size = _director->getWinSize();
+    RenderTexture* snapshot = RenderTexture::create((int)(size.width * _snapshotScale), (int)(size.height * _snapshotScale),
+                                                    Texture2D::PixelFormat::RGBA8888, GL_DEPTH24_STENCIL8);
+    if (nullptr == snapshot)
+    {
+        return nullptr;
+    }
+
+    snapshot->retain();
+    snapshot->setDepthStencilDiscarded(true);
+    snapshot->setPosition(size.width / 2, size.height / 2);
+    snapshot->setScale(1.0f / _snapshotScale);
+
+    // the render texture maps a point to a pixel, the scene is scaled down to fit
+    Mat4 scale;
+    Mat4::createScale(_snapshotScale, _snapshotScale, 1.0f, &scale);
+    _director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+    _director->multiplyMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, scale);
+
+    snapshot->begin();
+    scene->visit();
+    snapshot->end();
+
+    _director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+    return snapshot;
+}
+
 void TransitionScene::finish()
 {
     // clean up
@@ -171,6 +222,16 @@ void TransitionScene::onEnter()
     _outScene->onExitTransitionDidStart();
 
     _inScene->onEnter();
+
+    // before the subclasses move the scenes
+    if (_snapshotOutScene)
+    {
+        _outSnapshot = createSnapshot(_outScene);
+    }
+    if (_snapshotInScene)
+    {
+        _inSnapshot = createSnapshot(_inScene);
+    }
 }
 
 // custom onExit
@@ -178,6 +239,9 @@ void TransitionScene::onExit()
 {
     Scene::onExit();
 
+    CC_SAFE_RELEASE_NULL(_outSnapshot);
+    CC_SAFE_RELEASE_NULL(_inSnapshot);
+
     // enable events while transitions
     _eventDispatcher->setEnabled(true);
     _outScene->onExit();
@@ -44,6 +44,7 @@ NS_CC_BEGIN
 class ActionInterval;
 class Node;
 class NodeGrid;
+class RenderTexture;
 
 /** @class TransitionEaseScene
  * @brief TransitionEaseScene can ease the actions of the scene protocol.
@@ -104,6 +105,32 @@ public:
 
     Scene* getInScene() const{ return _inScene; }
     float getDuration() const { return _duration; }
+
+    /** Sets whether the outgoing scene is drawn from a snapshot taken when the transition starts, instead of being
+     * visited every frame. Its animations are not shown for the rest of the transition.
+     * It applies to the transitions that move, scale, rotate or flip the scenes: the ones going through a grid or
+     * a render texture draw the scenes their own way. Set it before the transition enters.
+     *
+     * @param enabled Whether the outgoing scene is snapshotted.
+     */
+    void setOutSceneSnapshotEnabled(bool enabled) { _snapshotOutScene = enabled; }
+    bool isOutSceneSnapshotEnabled() const { return _snapshotOutScene; }
+
+    /** Sets whether the incoming scene is drawn from a snapshot of its first frame as well.
+     * It is rendered once, offscreen, when the transition starts, which also loads its textures and shaders before
+     * the first frame of the animation. Its own animations are shown once the transition finishes.
+     *
+     * @param enabled Whether the incoming scene is snapshotted.
+     */
+    void setInSceneSnapshotEnabled(bool enabled) { _snapshotInScene = enabled; }
+    bool isInSceneSnapshotEnabled() const { return _snapshotInScene; }
+
+    /** Sets the resolution of the snapshots relative to the window, 0.5 renders them at half the width and height.
+     *
+     * @param scale The scale of the snapshots, 1 by default.
+     */
+    void setSnapshotScale(float scale) { _snapshotScale = scale; }
+    float getSnapshotScale() const { return _snapshotScale; }
     //
     // Overrides
     //
@@ -122,12 +149,19 @@ CC_CONSTRUCTOR_ACCESS:
 protected:
     virtual void sceneOrder();
     void setNewScene(float dt);
+    RenderTexture* createSnapshot(Scene* scene);
+    void visitScene(Scene* scene, RenderTexture* snapshot, Renderer* renderer, const Mat4& transform, uint32_t flags);
 
     Scene *_inScene;
     Scene *_outScene;
     float _duration;
     bool _isInSceneOnTop;
     bool _isSendCleanupToScene;
+    bool _snapshotOutScene;
+    bool _snapshotInScene;
+    float _snapshotScale;
+    RenderTexture* _outSnapshot;
+    RenderTexture* _inSnapshot;
 
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(TransitionScene);
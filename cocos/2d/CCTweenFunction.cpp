@@ -23,6 +23,7 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "2d/CCTweenFunction.h"
+#include "base/ccConfig.h"
 
 #define _USE_MATH_DEFINES // needed for M_PI and M_PI2
 #include <math.h> // M_PI
@@ -37,6 +38,86 @@ namespace tweenfunc {
 #define M_PI_X_2 (float)M_PI * 2.0f
 #endif
 
+// the baked eases, see setTablesEnabled()
+enum EaseTable
+{
+    TABLE_SINE_IN,
+    TABLE_SINE_OUT,
+    TABLE_SINE_IN_OUT,
+    TABLE_EXPO_IN,
+    TABLE_EXPO_OUT,
+    TABLE_EXPO_IN_OUT,
+    TABLE_ELASTIC_IN,
+    TABLE_ELASTIC_OUT,
+    TABLE_ELASTIC_IN_OUT,
+    TABLE_COUNT
+};
+
+// the intervals of the tables, the values at 0 and 1 are exact
+static const int TABLE_SIZE = 512;
+static const float DEFAULT_ELASTIC_PERIOD = 0.3f;
+
+static float s_tables[TABLE_COUNT][TABLE_SIZE + 1];
+static bool s_tablesEnabled = false;
+
+// returns false when `time` isn't covered by the table, it's computed then
+static inline bool sampleTable(EaseTable table, float time, float *value)
+{
+    if (!s_tablesEnabled || !(time >= 0 && time <= 1))
+        return false;
+
+    const float* samples = s_tables[table];
+    float x = time * TABLE_SIZE;
+    int i = (int)x;
+    if (i >= TABLE_SIZE)
+    {
+        *value = samples[TABLE_SIZE];
+        return true;
+    }
+    *value = samples[i] + (samples[i + 1] - samples[i]) * (x - i);
+    return true;
+}
+
+void setTablesEnabled(bool enabled)
+{
+    if (enabled == s_tablesEnabled)
+        return;
+
+    if (enabled)
+    {
+        // the exact eases fill the tables while they are still disabled
+        typedef float (*Ease)(float);
+        static const Ease eases[] = {
+            sineEaseIn, sineEaseOut, sineEaseInOut,
+            expoEaseIn, expoEaseOut, expoEaseInOut,
+        };
+        for (int i = 0; i <= TABLE_SIZE; ++i)
+        {
+            float time = (float)i / TABLE_SIZE;
+            for (int table = 0; table < TABLE_ELASTIC_IN; ++table)
+            {
+                s_tables[table][i] = eases[table](time);
+            }
+            s_tables[TABLE_ELASTIC_IN][i] = elasticEaseIn(time, DEFAULT_ELASTIC_PERIOD);
+            s_tables[TABLE_ELASTIC_OUT][i] = elasticEaseOut(time, DEFAULT_ELASTIC_PERIOD);
+            s_tables[TABLE_ELASTIC_IN_OUT][i] = elasticEaseInOut(time, DEFAULT_ELASTIC_PERIOD);
+        }
+    }
+    s_tablesEnabled = enabled;
+}
+
+bool isTablesEnabled()
+{
+    return s_tablesEnabled;
+}
+
+#if CC_ENABLE_TWEEN_TABLES
+static struct TablesInitializer
+{
+    TablesInitializer() { setTablesEnabled(true); }
+} s_tablesInitializer;
+#endif
+
 
 
 
@@ -181,6 +262,64 @@ float tweenTo(float time, TweenType type, float *easingParam)
     return delta;
 }
 
+// the loops of the polynomial eases, written to be vectorized
+#define TWEEN_BATCH_LOOP(expression) \
+    for (int i = 0; i < count; ++i) \
+    { \
+        float time = times[i]; \
+        results[i] = (expression); \
+    }
+
+void tweenToBatch(const float *times, float *results, int count, TweenType type, float *easingParam)
+{
+    const float overshoot = 1.70158f;
+    switch (type)
+    {
+        case Linear:
+            TWEEN_BATCH_LOOP(time);
+            break;
+        case Quad_EaseIn:
+            TWEEN_BATCH_LOOP(time * time);
+            break;
+        case Quad_EaseOut:
+            TWEEN_BATCH_LOOP(-1 * time * (time - 2));
+            break;
+        case Cubic_EaseIn:
+            TWEEN_BATCH_LOOP(time * time * time);
+            break;
+        case Cubic_EaseOut:
+            TWEEN_BATCH_LOOP((time - 1) * (time - 1) * (time - 1) + 1);
+            break;
+        case Quart_EaseIn:
+            TWEEN_BATCH_LOOP(time * time * time * time);
+            break;
+        case Quart_EaseOut:
+            TWEEN_BATCH_LOOP(-((time - 1) * (time - 1) * (time - 1) * (time - 1) - 1));
+            break;
+        case Quint_EaseIn:
+            TWEEN_BATCH_LOOP(time * time * time * time * time);
+            break;
+        case Quint_EaseOut:
+            TWEEN_BATCH_LOOP((time - 1) * (time - 1) * (time - 1) * (time - 1) * (time - 1) + 1);
+            break;
+        case Back_EaseIn:
+            TWEEN_BATCH_LOOP(time * time * ((overshoot + 1) * time - overshoot));
+            break;
+        case Back_EaseOut:
+            TWEEN_BATCH_LOOP((time - 1) * (time - 1) * ((overshoot + 1) * (time - 1) + overshoot) + 1);
+            break;
+        default:
+            // the piecewise eases, and the tables or libm for the others
+            for (int i = 0; i < count; ++i)
+            {
+                results[i] = tweenTo(times[i], type, easingParam);
+            }
+            break;
+    }
+}
+
+#undef TWEEN_BATCH_LOOP
+
 // Linear
 float linear(float time)
 {
@@ -191,16 +330,28 @@ float linear(float time)
 // Sine Ease
 float sineEaseIn(float time)
 {
+    float value;
+    if (sampleTable(TABLE_SINE_IN, time, &value))
+        return value;
+
     return -1 * cosf(time * (float)M_PI_2) + 1;
 }
 
 float sineEaseOut(float time)
 {
+    float value;
+    if (sampleTable(TABLE_SINE_OUT, time, &value))
+        return value;
+
     return sinf(time * (float)M_PI_2);
 }
 
 float sineEaseInOut(float time)
 {
+    float value;
+    if (sampleTable(TABLE_SINE_IN_OUT, time, &value))
+        return value;
+
     return -0.5f * (cosf((float)M_PI * time) - 1);
 }
 
@@ -294,14 +445,26 @@ float quintEaseInOut(float time)
 // Expo Ease
 float expoEaseIn(float time)
 {
+    float value;
+    if (sampleTable(TABLE_EXPO_IN, time, &value))
+        return value;
+
     return time == 0 ? 0 : powf(2, 10 * (time/1 - 1)) - 1 * 0.001f;
 }
 float expoEaseOut(float time)
 {
+    float value;
+    if (sampleTable(TABLE_EXPO_OUT, time, &value))
+        return value;
+
     return time == 1 ? 1 : (-powf(2, -10 * time / 1) + 1);
 }
 float expoEaseInOut(float time)
 {
+    float value;
+    if (sampleTable(TABLE_EXPO_IN_OUT, time, &value))
+        return value;
+
     time /= 0.5f;
     if (time < 1)
     {
@@ -339,6 +502,9 @@ float circEaseInOut(float time)
 // Elastic Ease
 float elasticEaseIn(float time, float period)
 {
+    float value;
+    if (period == DEFAULT_ELASTIC_PERIOD && sampleTable(TABLE_ELASTIC_IN, time, &value))
+        return value;
 
     float newT = 0;
     if (time == 0 || time == 1)
@@ -356,6 +522,9 @@ float elasticEaseIn(float time, float period)
 }
 float elasticEaseOut(float time, float period)
 {
+    float value;
+    if (period == DEFAULT_ELASTIC_PERIOD && sampleTable(TABLE_ELASTIC_OUT, time, &value))
+        return value;
 
     float newT = 0;
     if (time == 0 || time == 1)
@@ -372,6 +541,9 @@ float elasticEaseOut(float time, float period)
 }
 float elasticEaseInOut(float time, float period)
 {
+    float value;
+    if (period == DEFAULT_ELASTIC_PERIOD && sampleTable(TABLE_ELASTIC_IN_OUT, time, &value))
+        return value;
 
     float newT = 0;
     if (time == 0 || time == 1)
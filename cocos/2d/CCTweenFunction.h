@@ -129,6 +129,30 @@ namespace tweenfunc {
      */
     float CC_DLL tweenTo(float time, TweenType type, float *easingParam);
 
+    /**
+     * Eases `count` times at once, like tweenTo() for each of them: the type is only looked at once, and the loops of
+     * the polynomial eases are simple enough for the compiler to vectorize them.
+     * @param times The times, from 0 to 1.
+     * @param results The eased times, it may be `times`.
+     * @since v3.11
+     */
+    void CC_DLL tweenToBatch(const float *times, float *results, int count, TweenType type, float *easingParam);
+
+    /**
+     * Makes the sine, expo and elastic (with the default period of 0.3) eases read baked tables with linear
+     * interpolation, within 0.001 of the exact values, instead of calling sinf(), cosf() or powf().
+     * It applies to the ease actions and the tweens of the ActionManager. The times out of 0 to 1 are still computed.
+     * CC_ENABLE_TWEEN_TABLES sets the default. Call it before the actions run, from the main thread.
+     * @since v3.11
+     */
+    void CC_DLL setTablesEnabled(bool enabled);
+
+    /**
+     * Whether the baked tables are used, see setTablesEnabled().
+     * @since v3.11
+     */
+    bool CC_DLL isTablesEnabled();
+
     /**
      * @param time in seconds.
      */
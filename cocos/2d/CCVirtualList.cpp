@@ -0,0 +1,464 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "2d/CCVirtualList.h"
+#include <cmath>
+#include "base/CCEventDispatcher.h"
+#include "base/CCEventListenerTouch.h"
+#include "base/CCTouch.h"
+#include "base/ccUtils.h"
+
+NS_CC_BEGIN
+
+// how far a touch moves before the list follows it, in points
+static const float DRAG_THRESHOLD = 10.0f;
+// the speed under which the list stops, in points per second
+static const float MIN_VELOCITY = 5.0f;
+static const int TOUCH_PRIORITY = -1;
+
+VirtualList* VirtualList::create(const Size& viewSize, const Size& cellSize, const CellFactory& factory)
+{
+    VirtualList* ret = new (std::nothrow) VirtualList();
+    if (ret && ret->init(viewSize, cellSize, factory))
+    {
+        ret->autorelease();
+        return ret;
+    }
+
+    delete ret;
+    return nullptr;
+}
+
+VirtualList::VirtualList()
+: _direction(Direction::VERTICAL)
+, _lanes(1)
+, _overscan(1)
+, _itemCount(0)
+, _offset(0)
+, _container(nullptr)
+, _firstIndex(0)
+, _touchListener(nullptr)
+, _dragging(false)
+, _decelerating(false)
+, _velocity(0)
+, _deceleration(0.05f)
+, _lastMoveTime(0)
+{
+}
+
+VirtualList::~VirtualList()
+{
+    CC_SAFE_RELEASE(_touchListener);
+}
+
+bool VirtualList::init(const Size& viewSize, const Size& cellSize, const CellFactory& factory)
+{
+    CCASSERT(factory, "VirtualList needs a cell factory");
+    if (!ClippingRectangleNode::init() || !factory)
+        return false;
+
+    _factory = factory;
+    _cellSize = cellSize;
+
+    _container = Node::create();
+    addChild(_container);
+
+    _touchListener = EventListenerTouchOneByOne::create();
+    _touchListener->retain();
+    _touchListener->setSwallowTouches(false);
+    _touchListener->onTouchBegan = CC_CALLBACK_2(VirtualList::onTouchBegan, this);
+    _touchListener->onTouchMoved = CC_CALLBACK_2(VirtualList::onTouchMoved, this);
+    _touchListener->onTouchEnded = CC_CALLBACK_2(VirtualList::onTouchEnded, this);
+    _touchListener->onTouchCancelled = CC_CALLBACK_2(VirtualList::onTouchCancelled, this);
+
+    setContentSize(viewSize);
+    return true;
+}
+
+void VirtualList::onEnter()
+{
+    ClippingRectangleNode::onEnter();
+    // a fixed priority, so the list sees the touches the Menus of its cells swallow
+    _eventDispatcher->addEventListenerWithFixedPriority(_touchListener, TOUCH_PRIORITY);
+}
+
+void VirtualList::onExit()
+{
+    _eventDispatcher->removeEventListener(_touchListener);
+    _dragging = false;
+    stopDeceleration();
+    ClippingRectangleNode::onExit();
+}
+
+void VirtualList::setContentSize(const Size& contentSize)
+{
+    ClippingRectangleNode::setContentSize(contentSize);
+    setClippingRegion(Rect(Vec2::ZERO, contentSize));
+    if (_container)
+    {
+        // the view shows other lines
+        _offset = clampf(_offset, 0, getMaxContentOffset());
+        updateContainerPosition();
+        updateCells();
+    }
+}
+
+void VirtualList::setItemCount(ssize_t count)
+{
+    _itemCount = std::max(count, (ssize_t)0);
+    _offset = 0;
+    stopDeceleration();
+    reloadData();
+}
+
+void VirtualList::reloadData()
+{
+    recycleCells();
+    _offset = clampf(_offset, 0, getMaxContentOffset());
+    updateContainerPosition();
+    updateCells();
+}
+
+void VirtualList::reloadItem(ssize_t index)
+{
+    ssize_t cellIndex = index - _firstIndex;
+    if (cellIndex < 0 || cellIndex >= (ssize_t)_cells.size())
+        return;
+
+    if (_cells[cellIndex].node)
+        recycleCell(index, _cells[cellIndex]);
+    _cells[cellIndex] = createCell(index);
+}
+
+void VirtualList::setDirection(Direction direction)
+{
+    if (direction != _direction)
+    {
+        _direction = direction;
+        _offset = 0;
+        reloadData();
+    }
+}
+
+void VirtualList::setCellSize(const Size& cellSize)
+{
+    if (!cellSize.equals(_cellSize))
+    {
+        _cellSize = cellSize;
+        reloadData();
+    }
+}
+
+void VirtualList::setLanes(int lanes)
+{
+    CCASSERT(lanes > 0, "A line has a cell at least");
+    lanes = std::max(lanes, 1);
+    if (lanes != _lanes)
+    {
+        _lanes = lanes;
+        reloadData();
+    }
+}
+
+void VirtualList::setSpacing(const Size& spacing)
+{
+    if (!spacing.equals(_spacing))
+    {
+        _spacing = spacing;
+        reloadData();
+    }
+}
+
+void VirtualList::setOverscan(int lines)
+{
+    _overscan = std::max(lines, 0);
+    updateCells();
+}
+
+Node* VirtualList::getCellAtIndex(ssize_t index) const
+{
+    ssize_t cellIndex = index - _firstIndex;
+    if (cellIndex < 0 || cellIndex >= (ssize_t)_cells.size())
+        return nullptr;
+    return _cells[cellIndex].node;
+}
+
+float VirtualList::getLineStep() const
+{
+    return _direction == Direction::VERTICAL ? _cellSize.height + _spacing.height : _cellSize.width + _spacing.width;
+}
+
+float VirtualList::getViewLength() const
+{
+    return _direction == Direction::VERTICAL ? _contentSize.height : _contentSize.width;
+}
+
+float VirtualList::getMaxContentOffset() const
+{
+    ssize_t lines = getLineCount();
+    if (lines == 0)
+        return 0;
+
+    float spacing = _direction == Direction::VERTICAL ? _spacing.height : _spacing.width;
+    float length = lines * getLineStep() - spacing;
+    return std::max(length - getViewLength(), 0.0f);
+}
+
+void VirtualList::setContentOffset(float offset)
+{
+    offset = clampf(offset, 0, getMaxContentOffset());
+    if (offset != _offset)
+    {
+        _offset = offset;
+        updateContainerPosition();
+        updateCells();
+    }
+}
+
+void VirtualList::scrollToIndex(ssize_t index)
+{
+    stopDeceleration();
+    setContentOffset((index / _lanes) * getLineStep());
+}
+
+void VirtualList::updateContainerPosition()
+{
+    // the lines go down from the top of a vertical list, right from the left of a horizontal one
+    if (_direction == Direction::VERTICAL)
+        _container->setPosition(0, _contentSize.height + _offset);
+    else
+        _container->setPosition(-_offset, 0);
+}
+
+Vec2 VirtualList::getCellOrigin(ssize_t index) const
+{
+    ssize_t line = index / _lanes;
+    int lane = (int)(index % _lanes);
+    if (_direction == Direction::VERTICAL)
+    {
+        return Vec2(lane * (_cellSize.width + _spacing.width), -line * (_cellSize.height + _spacing.height) - _cellSize.height);
+    }
+    return Vec2(line * (_cellSize.width + _spacing.width), _contentSize.height - lane * (_cellSize.height + _spacing.height) - _cellSize.height);
+}
+
+void VirtualList::updateCells()
+{
+    ssize_t firstIndex = 0, endIndex = 0;
+    ssize_t lines = getLineCount();
+    float step = getLineStep();
+    if (lines > 0 && step > 0)
+    {
+        ssize_t firstLine = std::max((ssize_t)std::floor(_offset / step) - _overscan, (ssize_t)0);
+        ssize_t lastLine = std::min((ssize_t)std::floor((_offset + getViewLength()) / step) + _overscan, lines - 1);
+        firstIndex = firstLine * _lanes;
+        endIndex = std::min((lastLine + 1) * _lanes, _itemCount);
+    }
+
+    ssize_t oldEnd = _firstIndex + (ssize_t)_cells.size();
+    if (firstIndex == _firstIndex && endIndex == oldEnd)
+        return;
+
+    // the cells that stay in the range keep their items, the others go to the pool first so they can be reused
+    std::vector<Cell> cells(std::max(endIndex - firstIndex, (ssize_t)0), Cell{ nullptr, 0 });
+    for (ssize_t index = _firstIndex; index < oldEnd; ++index)
+    {
+        const Cell& cell = _cells[index - _firstIndex];
+        if (index >= firstIndex && index < endIndex)
+            cells[index - firstIndex] = cell;
+        else if (cell.node)
+            recycleCell(index, cell);
+    }
+    for (ssize_t index = firstIndex; index < endIndex; ++index)
+    {
+        if (!cells[index - firstIndex].node)
+            cells[index - firstIndex] = createCell(index);
+    }
+
+    _cells.swap(cells);
+    _firstIndex = firstIndex;
+}
+
+void VirtualList::recycleCells()
+{
+    for (size_t i = 0; i < _cells.size(); ++i)
+    {
+        if (_cells[i].node)
+            recycleCell(_firstIndex + i, _cells[i]);
+    }
+    _cells.clear();
+    _firstIndex = 0;
+}
+
+void VirtualList::recycleCell(ssize_t index, const Cell& cell)
+{
+    if (_cellRecycledCallback)
+        _cellRecycledCallback(this, index, cell.node);
+
+    // the pool keeps the cell alive, its actions are paused but kept
+    _pool[cell.type].pushBack(cell.node);
+    cell.node->removeFromParentAndCleanup(false);
+}
+
+VirtualList::Cell VirtualList::createCell(ssize_t index)
+{
+    int type = _cellTypeCallback ? _cellTypeCallback(index) : 0;
+
+    Node* reused = nullptr;
+    auto iter = _pool.find(type);
+    if (iter != _pool.end() && !iter->second.empty())
+    {
+        reused = iter->second.back();
+        reused->retain();
+        reused->autorelease();
+        iter->second.popBack();
+    }
+
+    Node* node = _factory(this, index, reused);
+    if (!node)
+    {
+        CCLOG("cocos2d: VirtualList: the factory returned no cell for the item %d", (int)index);
+        return Cell{ nullptr, type };
+    }
+
+    Vec2 origin = getCellOrigin(index);
+    if (!node->isIgnoreAnchorPointForPosition())
+    {
+        const Vec2& anchor = node->getAnchorPoint();
+        origin += Vec2(_cellSize.width * anchor.x, _cellSize.height * anchor.y);
+    }
+    node->setPosition(origin);
+    _container->addChild(node);
+    return Cell{ node, type };
+}
+
+void VirtualList::stopDeceleration()
+{
+    if (_decelerating)
+    {
+        _decelerating = false;
+        unscheduleUpdate();
+    }
+    _velocity = 0;
+}
+
+bool VirtualList::onTouchBegan(Touch* touch, Event* event)
+{
+    if (!_visible || !_running)
+        return false;
+    for (Node* c = _parent; c != nullptr; c = c->getParent())
+    {
+        if (!c->isVisible())
+            return false;
+    }
+
+    Vec2 point = convertToNodeSpace(touch->getLocation());
+    if (!Rect(Vec2::ZERO, _contentSize).containsPoint(point))
+        return false;
+
+    stopDeceleration();
+    _touchStart = point;
+    _dragging = false;
+    _lastMoveTime = utils::gettime();
+    return true;
+}
+
+void VirtualList::onTouchMoved(Touch* touch, Event* event)
+{
+    Vec2 point = convertToNodeSpace(touch->getLocation());
+    if (!_dragging)
+    {
+        if (point.distance(_touchStart) < DRAG_THRESHOLD)
+            return;
+        _dragging = true;
+    }
+
+    // the finger moving up scrolls a vertical list down, moving left scrolls a horizontal one right
+    Vec2 delta = point - convertToNodeSpace(touch->getPreviousLocation());
+    float distance = _direction == Direction::VERTICAL ? delta.y : -delta.x;
+    setContentOffset(_offset + distance);
+
+    double now = utils::gettime();
+    float dt = (float)(now - _lastMoveTime);
+    _lastMoveTime = now;
+    if (dt > 0)
+    {
+        // smoothed, a single move is too noisy
+        _velocity = _velocity * 0.5f + (distance / dt) * 0.5f;
+    }
+}
+
+void VirtualList::onTouchEnded(Touch* touch, Event* event)
+{
+    if (!_dragging)
+    {
+        if (_cellTouchedCallback)
+        {
+            Vec2 point = _container->convertToNodeSpace(touch->getLocation());
+            for (size_t i = 0; i < _cells.size(); ++i)
+            {
+                ssize_t index = _firstIndex + i;
+                if (_cells[i].node && Rect(getCellOrigin(index), _cellSize).containsPoint(point))
+                {
+                    _cellTouchedCallback(this, index, _cells[i].node);
+                    break;
+                }
+            }
+        }
+        return;
+    }
+
+    _dragging = false;
+    // the finger stopped before it was lifted
+    if (utils::gettime() - _lastMoveTime > 0.1)
+        _velocity = 0;
+    if (std::abs(_velocity) > MIN_VELOCITY)
+    {
+        _decelerating = true;
+        scheduleUpdate();
+    }
+}
+
+void VirtualList::onTouchCancelled(Touch* touch, Event* event)
+{
+    _dragging = false;
+    _velocity = 0;
+}
+
+void VirtualList::update(float dt)
+{
+    if (!_decelerating)
+        return;
+
+    float offset = _offset + _velocity * dt;
+    setContentOffset(offset);
+    _velocity *= powf(_deceleration, dt);
+    if (std::abs(_velocity) < MIN_VELOCITY || _offset != offset)
+    {
+        // slowed down, or clamped at an end
+        stopDeceleration();
+    }
+}
+
+NS_CC_END
@@ -0,0 +1,226 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CCVIRTUAL_LIST_H__
+#define __CCVIRTUAL_LIST_H__
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include "2d/CCClippingRectangleNode.h"
+#include "base/CCVector.h"
+
+NS_CC_BEGIN
+
+class EventListenerTouchOneByOne;
+class Touch;
+class Event;
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/**
+ VirtualList is a scrolling list, or grid, of many items that only has nodes for the visible ones.
+
+ The items are laid out in cells of the same size, `lanes` cells per line: the columns of a vertical grid or the rows
+ of a horizontal one, 1 for a list. The cells of the lines in the view, and `overscan` lines before and after them,
+ are asked from the CellFactory. The cells that scroll out are removed and kept in a pool per cell type, and the
+ factory gets them back to show other items, so a list of 5000 items has a few dozen cells.
+
+ @code
+ auto list = VirtualList::create(Size(300, 400), Size(300, 48), [](VirtualList* list, ssize_t index, Node* cell) {
+     auto row = static_cast<ScoreRow*>(cell);
+     if (!row)
+         row = ScoreRow::create();
+     row->setScore(scores[index]);
+     return row;
+ });
+ list->setItemCount(scores.size());
+ @endcode
+
+ The list clips its cells to its content size, and it scrolls with the touches that begin on it. Its touch listener
+ has a fixed priority of -1, so the list sees the touches before the cells, like the Menus of the cells, and doesn't
+ swallow them. The cells should ignore the touches that end while isScrolling() is true.
+ @since v3.11
+ @js NA
+ */
+class CC_DLL VirtualList : public ClippingRectangleNode
+{
+public:
+    enum class Direction
+    {
+        VERTICAL,
+        HORIZONTAL,
+    };
+
+    /**
+     Returns the cell that shows an item. `cell` is a recycled cell of the type of the item, or nullptr, the factory
+     sets it up for the item, or creates a new cell when it's nullptr.
+     */
+    typedef std::function<Node*(VirtualList* list, ssize_t index, Node* cell)> CellFactory;
+    /** Returns the type of the cell of an item, the cells are only recycled for items of the same type. */
+    typedef std::function<int(ssize_t index)> CellTypeCallback;
+    /** Called with an item and its cell. */
+    typedef std::function<void(VirtualList* list, ssize_t index, Node* cell)> CellCallback;
+
+    /**
+     Creates a list.
+     @param viewSize The size of the view, the content size of the list.
+     @param cellSize The size of the cells.
+     @param factory Creates or recycles the cells.
+     */
+    static VirtualList* create(const Size& viewSize, const Size& cellSize, const CellFactory& factory);
+
+    /** Sets the number of items and shows them from the start of the list again. */
+    void setItemCount(ssize_t count);
+    ssize_t getItemCount() const { return _itemCount; }
+
+    /** Recycles all the cells and asks the factory for the visible ones again, after the items changed. */
+    void reloadData();
+    /** Asks the factory for the cell of an item again, if it's visible. */
+    void reloadItem(ssize_t index);
+
+    void setDirection(Direction direction);
+    Direction getDirection() const { return _direction; }
+
+    void setCellSize(const Size& cellSize);
+    const Size& getCellSize() const { return _cellSize; }
+
+    /** Sets the number of cells per line, the columns of a vertical grid or the rows of a horizontal one. 1 by default. */
+    void setLanes(int lanes);
+    int getLanes() const { return _lanes; }
+
+    /** Sets the space between the cells. Zero by default. */
+    void setSpacing(const Size& spacing);
+    const Size& getSpacing() const { return _spacing; }
+
+    /** Sets the number of lines out of the view that have cells too, before and after it. 1 by default. */
+    void setOverscan(int lines);
+    int getOverscan() const { return _overscan; }
+
+    void setCellTypeCallback(const CellTypeCallback& callback) { _cellTypeCallback = callback; }
+    /** Sets the function called when a cell is tapped, touched without scrolling. */
+    void setCellTouchedCallback(const CellCallback& callback) { _cellTouchedCallback = callback; }
+    /** Sets the function called when a cell scrolls out and goes to the pool, e.g. to stop loading its picture. */
+    void setCellRecycledCallback(const CellCallback& callback) { _cellRecycledCallback = callback; }
+
+    /** Gets the cell of an item, nullptr if the item isn't near the view. */
+    Node* getCellAtIndex(ssize_t index) const;
+
+    /** Sets how far the list is scrolled from its start, clamped between 0 and getMaxContentOffset(). */
+    void setContentOffset(float offset);
+    float getContentOffset() const { return _offset; }
+    float getMaxContentOffset() const;
+
+    /** Scrolls to the line of an item, it's at the start of the view unless the list ends before. */
+    void scrollToIndex(ssize_t index);
+
+    /** Whether the list follows a touch or moves on after one. */
+    bool isScrolling() const { return _dragging || _decelerating; }
+
+    /** Sets the part of its speed the list keeps after scrolling on for one second. 0.05 by default. */
+    void setDeceleration(float deceleration) { _deceleration = deceleration; }
+    float getDeceleration() const { return _deceleration; }
+
+    // Overrides
+    virtual void setContentSize(const Size& contentSize) override;
+    virtual void onEnter() override;
+    virtual void onExit() override;
+    virtual void update(float dt) override;
+
+CC_CONSTRUCTOR_ACCESS:
+    VirtualList();
+    virtual ~VirtualList();
+
+    bool init(const Size& viewSize, const Size& cellSize, const CellFactory& factory);
+
+protected:
+    struct Cell
+    {
+        Node* node;
+        int type;
+    };
+
+    // the cells of the items of the lines in the view and around it
+    void updateCells();
+    void recycleCells();
+    void recycleCell(ssize_t index, const Cell& cell);
+    Cell createCell(ssize_t index);
+    // the bottom left corner of the cell of an item, in the space of the container
+    Vec2 getCellOrigin(ssize_t index) const;
+    void updateContainerPosition();
+    ssize_t getLineCount() const { return _lanes > 0 ? (_itemCount + _lanes - 1) / _lanes : 0; }
+    // the size of a line and the space after it along the direction of the scrolling
+    float getLineStep() const;
+    float getViewLength() const;
+    void stopDeceleration();
+
+    bool onTouchBegan(Touch* touch, Event* event);
+    void onTouchMoved(Touch* touch, Event* event);
+    void onTouchEnded(Touch* touch, Event* event);
+    void onTouchCancelled(Touch* touch, Event* event);
+
+    CellFactory _factory;
+    CellTypeCallback _cellTypeCallback;
+    CellCallback _cellTouchedCallback;
+    CellCallback _cellRecycledCallback;
+
+    Direction _direction;
+    Size _cellSize;
+    Size _spacing;
+    int _lanes;
+    int _overscan;
+    ssize_t _itemCount;
+    float _offset;
+
+    // the parent of the cells, it moves when the list scrolls so the cells keep their positions
+    Node* _container;
+    // the cells of the items from _firstIndex on
+    ssize_t _firstIndex;
+    std::vector<Cell> _cells;
+    // the recycled cells by type
+    std::unordered_map<int, Vector<Node*>> _pool;
+
+    EventListenerTouchOneByOne* _touchListener;
+    Vec2 _touchStart;
+    bool _dragging;
+    bool _decelerating;
+    // along the direction of the scrolling, in points per second
+    float _velocity;
+    float _deceleration;
+    double _lastMoveTime;
+
+private:
+    CC_DISALLOW_COPY_AND_ASSIGN(VirtualList);
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif // __CCVIRTUAL_LIST_H__
@@ -0,0 +1,507 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "2d/ccParticleKernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "2d/CCParticleSystem.h"
+#include "math/MathUtil.h"
+
+// the same rules as MathUtil: NEON is always there on arm64, armv7 checks the cpu at runtime on android
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_IOS) || (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+    #if defined (__arm64__) || defined (__aarch64__) || defined (__ARM_NEON__)
+    #define INCLUDE_NEON
+    #include <arm_neon.h>
+    #endif
+#endif
+
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#define INCLUDE_SSE2
+#include <emmintrin.h>
+#endif
+
+NS_CC_BEGIN
+
+namespace particle
+{
+
+namespace
+{
+    // the particles done per iteration of the vector loops
+    static const int BATCH = 4;
+
+    // the lanes of larger angles go through sinf() and cosf(), the range reduction below loses precision
+    static const float MAX_VECTOR_ANGLE = 8192.0f;
+
+    inline void scalarNormalize(float x, float y, float* outX, float* outY)
+    {
+        // the outputs are left alone when it's already normalized or too close to zero
+        float n = x * x + y * y;
+        if (n == 1.0f || (x == 0 && y == 0))
+            return;
+
+        n = sqrt(n);
+        if (n < MATH_TOLERANCE)
+            return;
+
+        n = 1.0f / n;
+        *outX = x * n;
+        *outY = y * n;
+    }
+
+    inline GLubyte clampColor(float value)
+    {
+        return (GLubyte)std::min(std::max(value, 0.0f), 255.0f);
+    }
+
+    inline void scalarQuadVertices(V3F_C4B_T2F_Quad* quad, float x, float y, float size, float rotation)
+    {
+        float size_2 = size / 2;
+        float r = -CC_DEGREES_TO_RADIANS(rotation);
+        float cr = cosf(r);
+        float sr = sinf(r);
+
+        quad->bl.vertices.x = -size_2 * cr + size_2 * sr + x;
+        quad->bl.vertices.y = -size_2 * sr - size_2 * cr + y;
+        quad->br.vertices.x = size_2 * cr + size_2 * sr + x;
+        quad->br.vertices.y = size_2 * sr - size_2 * cr + y;
+        quad->tl.vertices.x = -size_2 * cr - size_2 * sr + x;
+        quad->tl.vertices.y = -size_2 * sr + size_2 * cr + y;
+        quad->tr.vertices.x = size_2 * cr - size_2 * sr + x;
+        quad->tr.vertices.y = size_2 * sr + size_2 * cr + y;
+    }
+
+    inline void setQuadColor(V3F_C4B_T2F_Quad* quad, GLubyte r, GLubyte g, GLubyte b, GLubyte a)
+    {
+        quad->bl.colors.set(r, g, b, a);
+        quad->br.colors.set(r, g, b, a);
+        quad->tl.colors.set(r, g, b, a);
+        quad->tr.colors.set(r, g, b, a);
+    }
+
+#if defined (INCLUDE_NEON) || defined (INCLUDE_SSE2)
+    #define PARTICLE_VECTOR_KERNELS
+
+    // four lanes of floats, masks and ints, so the kernels are written once for NEON and SSE2
+#if defined (INCLUDE_NEON)
+    static bool useNeon()
+    {
+        static const bool neon = MathUtil::isNeon32Enabled() || MathUtil::isNeon64Enabled();
+        return neon;
+    }
+
+    typedef float32x4_t vfloat;
+    typedef uint32x4_t vmask;
+    typedef int32x4_t vint;
+
+    inline bool canVectorize() { return useNeon(); }
+    inline vfloat vset(float f) { return vdupq_n_f32(f); }
+    inline vfloat vload(const float* p) { return vld1q_f32(p); }
+    inline void vstore(float* p, vfloat v) { vst1q_f32(p, v); }
+    inline vfloat vadd(vfloat a, vfloat b) { return vaddq_f32(a, b); }
+    inline vfloat vsub(vfloat a, vfloat b) { return vsubq_f32(a, b); }
+    inline vfloat vmul(vfloat a, vfloat b) { return vmulq_f32(a, b); }
+    inline vfloat vmax(vfloat a, vfloat b) { return vmaxq_f32(a, b); }
+    inline vfloat vmin(vfloat a, vfloat b) { return vminq_f32(a, b); }
+    inline vfloat vabs(vfloat a) { return vabsq_f32(a); }
+    inline vfloat vneg(vfloat a) { return vnegq_f32(a); }
+    inline vmask vlt(vfloat a, vfloat b) { return vcltq_f32(a, b); }
+    inline vmask vgt(vfloat a, vfloat b) { return vcgtq_f32(a, b); }
+    inline vmask vneq(vfloat a, vfloat b) { return vmvnq_u32(vceqq_f32(a, b)); }
+    inline vmask vand(vmask a, vmask b) { return vandq_u32(a, b); }
+    inline vmask vxor(vmask a, vmask b) { return veorq_u32(a, b); }
+    inline vfloat vselect(vmask m, vfloat a, vfloat b) { return vbslq_f32(m, a, b); }
+    inline bool vany(vmask m)
+    {
+        uint32x2_t t = vorr_u32(vget_low_u32(m), vget_high_u32(m));
+        return vget_lane_u32(vpmax_u32(t, t), 0) != 0;
+    }
+    inline vfloat vrsqrt(vfloat n)
+    {
+#if defined (__arm64__) || defined (__aarch64__)
+        return vdivq_f32(vdupq_n_f32(1.0f), vsqrtq_f32(n));
+#else
+        // the estimate and two Newton-Raphson steps, close to 1 / sqrtf()
+        vfloat e = vrsqrteq_f32(n);
+        e = vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(n, e), e));
+        e = vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(n, e), e));
+        return e;
+#endif
+    }
+    inline vint vtrunc(vfloat a) { return vcvtq_s32_f32(a); }
+    inline vfloat vtofloat(vint a) { return vcvtq_f32_s32(a); }
+    inline vint viadd(vint a, int b) { return vaddq_s32(a, vdupq_n_s32(b)); }
+    inline vint viand(vint a, int b) { return vandq_s32(a, vdupq_n_s32(b)); }
+    inline vmask vieq(vint a, int b) { return vceqq_s32(a, vdupq_n_s32(b)); }
+    inline void vstorei(int* p, vint v) { vst1q_s32(p, v); }
+#else
+    typedef __m128 vfloat;
+    typedef __m128 vmask;
+    typedef __m128i vint;
+
+    inline bool canVectorize() { return true; }
+    inline vfloat vset(float f) { return _mm_set1_ps(f); }
+    inline vfloat vload(const float* p) { return _mm_loadu_ps(p); }
+    inline void vstore(float* p, vfloat v) { _mm_storeu_ps(p, v); }
+    inline vfloat vadd(vfloat a, vfloat b) { return _mm_add_ps(a, b); }
+    inline vfloat vsub(vfloat a, vfloat b) { return _mm_sub_ps(a, b); }
+    inline vfloat vmul(vfloat a, vfloat b) { return _mm_mul_ps(a, b); }
+    inline vfloat vmax(vfloat a, vfloat b) { return _mm_max_ps(a, b); }
+    inline vfloat vmin(vfloat a, vfloat b) { return _mm_min_ps(a, b); }
+    inline vfloat vabs(vfloat a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+    inline vfloat vneg(vfloat a) { return _mm_xor_ps(_mm_set1_ps(-0.0f), a); }
+    inline vmask vlt(vfloat a, vfloat b) { return _mm_cmplt_ps(a, b); }
+    inline vmask vgt(vfloat a, vfloat b) { return _mm_cmpgt_ps(a, b); }
+    inline vmask vneq(vfloat a, vfloat b) { return _mm_cmpneq_ps(a, b); }
+    inline vmask vand(vmask a, vmask b) { return _mm_and_ps(a, b); }
+    inline vmask vxor(vmask a, vmask b) { return _mm_xor_ps(a, b); }
+    inline vfloat vselect(vmask m, vfloat a, vfloat b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+    inline bool vany(vmask m) { return _mm_movemask_ps(m) != 0; }
+    inline vfloat vrsqrt(vfloat n) { return _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(n)); }
+    inline vint vtrunc(vfloat a) { return _mm_cvttps_epi32(a); }
+    inline vfloat vtofloat(vint a) { return _mm_cvtepi32_ps(a); }
+    inline vint viadd(vint a, int b) { return _mm_add_epi32(a, _mm_set1_epi32(b)); }
+    inline vint viand(vint a, int b) { return _mm_and_si128(a, _mm_set1_epi32(b)); }
+    inline vmask vieq(vint a, int b) { return _mm_castsi128_ps(_mm_cmpeq_epi32(a, _mm_set1_epi32(b))); }
+    inline void vstorei(int* p, vint v) { _mm_storeu_si128((__m128i*)p, v); }
+#endif
+
+    inline vfloat vmadd(vfloat a, vfloat b, vfloat c) { return vadd(vmul(a, b), c); }
+
+    // sin and cos of the four lanes, the range reduction and polynomials of the cephes library
+    inline void vsincos(vfloat x, vfloat* outSin, vfloat* outCos)
+    {
+        vfloat ax = vabs(x);
+        if (vany(vgt(ax, vset(MAX_VECTOR_ANGLE))))
+        {
+            float lanes[BATCH], sins[BATCH], coss[BATCH];
+            vstore(lanes, x);
+            for (int i = 0; i < BATCH; ++i)
+            {
+                sins[i] = sinf(lanes[i]);
+                coss[i] = cosf(lanes[i]);
+            }
+            *outSin = vload(sins);
+            *outCos = vload(coss);
+            return;
+        }
+
+        // the octant, rounded up to even
+        vint j = vtrunc(vmul(ax, vset(1.27323954473516f)));
+        j = viand(viadd(j, 1), ~1);
+        vfloat y = vtofloat(j);
+
+        vmask negSin = vxor(vlt(x, vset(0.0f)), vieq(viand(j, 4), 4));
+        vmask negCos = vieq(viand(viadd(j, -2), 4), 0);
+        vmask sinPoly = vieq(viand(j, 2), 0);
+
+        // the extended precision modular arithmetic
+        ax = vmadd(y, vset(-0.78515625f), ax);
+        ax = vmadd(y, vset(-2.4187564849853515625e-4f), ax);
+        ax = vmadd(y, vset(-3.77489497744594108e-8f), ax);
+
+        vfloat z = vmul(ax, ax);
+        vfloat c = vmul(vmadd(vmadd(vset(2.443315711809948e-5f), z, vset(-1.388731625493765e-3f)), z, vset(4.166664568298827e-2f)), z);
+        c = vadd(vsub(vmul(c, z), vmul(z, vset(0.5f))), vset(1.0f));
+        vfloat s = vmadd(vmadd(vset(-1.9515295891e-4f), z, vset(8.3321608736e-3f)), z, vset(-1.6666654611e-1f));
+        s = vmadd(vmul(s, z), ax, ax);
+
+        vfloat sinValue = vselect(sinPoly, s, c);
+        vfloat cosValue = vselect(sinPoly, c, s);
+        *outSin = vselect(negSin, vneg(sinValue), sinValue);
+        *outCos = vselect(negCos, vneg(cosValue), cosValue);
+    }
+
+    static int updateGravityModeVector(ParticleData& data, int count, float gravityX, float gravityY, float dt, float yCoordFlipped)
+    {
+        if (!canVectorize())
+            return 0;
+
+        const int done = count - count % BATCH;
+        const vfloat zero = vset(0.0f);
+        const vfloat one = vset(1.0f);
+        const vfloat gx = vset(gravityX);
+        const vfloat gy = vset(gravityY);
+        const vfloat vdt = vset(dt);
+        const vfloat flip = vset(yCoordFlipped);
+        for (int i = 0; i < done; i += BATCH)
+        {
+            vfloat px = vload(data.posx + i);
+            vfloat py = vload(data.posy + i);
+
+            // radial acceleration, along the normalized position
+            vfloat n = vmadd(px, px, vmul(py, py));
+            vmask normalize = vand(vgt(n, zero), vneq(n, one));
+            vfloat inv = vselect(normalize, vrsqrt(vmax(n, vset(MATH_TOLERANCE))), zero);
+            vfloat rx = vmul(px, inv);
+            vfloat ry = vmul(py, inv);
+
+            vfloat radialAccel = vload(data.modeA.radialAccel + i);
+            vfloat tangentialAccel = vload(data.modeA.tangentialAccel + i);
+
+            // (gravity + radial + tangential) * dt
+            vfloat tx = vmul(vadd(vadd(vmul(rx, radialAccel), vneg(vmul(ry, tangentialAccel))), gx), vdt);
+            vfloat ty = vmul(vadd(vadd(vmul(ry, radialAccel), vmul(rx, tangentialAccel)), gy), vdt);
+
+            vfloat dirX = vadd(vload(data.modeA.dirX + i), tx);
+            vfloat dirY = vadd(vload(data.modeA.dirY + i), ty);
+            vstore(data.modeA.dirX + i, dirX);
+            vstore(data.modeA.dirY + i, dirY);
+
+            vstore(data.posx + i, vadd(px, vmul(vmul(dirX, vdt), flip)));
+            vstore(data.posy + i, vadd(py, vmul(vmul(dirY, vdt), flip)));
+        }
+        return done;
+    }
+
+    static int updateRadiusModeVector(ParticleData& data, int count, float dt, float yCoordFlipped)
+    {
+        if (!canVectorize())
+            return 0;
+
+        const int done = count - count % BATCH;
+        const vfloat vdt = vset(dt);
+        const vfloat flip = vset(yCoordFlipped);
+        for (int i = 0; i < done; i += BATCH)
+        {
+            vfloat angle = vmadd(vload(data.modeB.degreesPerSecond + i), vdt, vload(data.modeB.angle + i));
+            vfloat radius = vmadd(vload(data.modeB.deltaRadius + i), vdt, vload(data.modeB.radius + i));
+            vstore(data.modeB.angle + i, angle);
+            vstore(data.modeB.radius + i, radius);
+
+            vfloat s, c;
+            vsincos(angle, &s, &c);
+            vstore(data.posx + i, vneg(vmul(c, radius)));
+            vstore(data.posy + i, vmul(vneg(vmul(s, radius)), flip));
+        }
+        return done;
+    }
+
+    static int updateColorSizeRotationVector(ParticleData& data, int count, float dt)
+    {
+        if (!canVectorize())
+            return 0;
+
+        const int done = count - count % BATCH;
+        const vfloat vdt = vset(dt);
+        const vfloat zero = vset(0.0f);
+        for (int i = 0; i < done; i += BATCH)
+        {
+            vstore(data.colorR + i, vmadd(vload(data.deltaColorR + i), vdt, vload(data.colorR + i)));
+            vstore(data.colorG + i, vmadd(vload(data.deltaColorG + i), vdt, vload(data.colorG + i)));
+            vstore(data.colorB + i, vmadd(vload(data.deltaColorB + i), vdt, vload(data.colorB + i)));
+            vstore(data.colorA + i, vmadd(vload(data.deltaColorA + i), vdt, vload(data.colorA + i)));
+            vstore(data.size + i, vmax(zero, vmadd(vload(data.deltaSize + i), vdt, vload(data.size + i))));
+            vstore(data.rotation + i, vmadd(vload(data.deltaRotation + i), vdt, vload(data.rotation + i)));
+        }
+        return done;
+    }
+
+    static int updateQuadVerticesVector(const ParticleData& data, int count, const float t[6], V3F_C4B_T2F_Quad* quads)
+    {
+        if (!canVectorize())
+            return 0;
+
+        const int done = count - count % BATCH;
+        const vfloat a = vset(t[0]), b = vset(t[1]), c = vset(t[2]);
+        const vfloat d = vset(t[3]), e = vset(t[4]), f = vset(t[5]);
+        const vfloat half = vset(0.5f);
+        const vfloat toRadians = vset(-0.01745329252f);
+        float ax[BATCH], ay[BATCH], bx[BATCH], by[BATCH], cx[BATCH], cy[BATCH], dx[BATCH], dy[BATCH];
+        for (int i = 0; i < done; i += BATCH)
+        {
+            vfloat sx = vload(data.startPosX + i);
+            vfloat sy = vload(data.startPosY + i);
+            vfloat x = vadd(vload(data.posx + i), vmadd(a, sx, vmadd(b, sy, c)));
+            vfloat y = vadd(vload(data.posy + i), vmadd(d, sx, vmadd(e, sy, f)));
+
+            vfloat size_2 = vmul(vload(data.size + i), half);
+            vfloat sr, cr;
+            vsincos(vmul(vload(data.rotation + i), toRadians), &sr, &cr);
+            vfloat hc = vmul(size_2, cr);
+            vfloat hs = vmul(size_2, sr);
+
+            vstore(ax, vadd(vsub(hs, hc), x));
+            vstore(ay, vsub(vsub(y, hs), hc));
+            vstore(bx, vadd(vadd(hc, hs), x));
+            vstore(by, vadd(vsub(hs, hc), y));
+            vstore(cx, vadd(vsub(hc, hs), x));
+            vstore(cy, vadd(vadd(hs, hc), y));
+            vstore(dx, vsub(vsub(x, hc), hs));
+            vstore(dy, vadd(vsub(hc, hs), y));
+
+            V3F_C4B_T2F_Quad* quad = quads + i;
+            for (int k = 0; k < BATCH; ++k, ++quad)
+            {
+                quad->bl.vertices.x = ax[k];
+                quad->bl.vertices.y = ay[k];
+                quad->br.vertices.x = bx[k];
+                quad->br.vertices.y = by[k];
+                quad->tl.vertices.x = dx[k];
+                quad->tl.vertices.y = dy[k];
+                quad->tr.vertices.x = cx[k];
+                quad->tr.vertices.y = cy[k];
+            }
+        }
+        return done;
+    }
+
+    static int updateQuadColorsVector(const ParticleData& data, int count, bool premultiplyAlpha, V3F_C4B_T2F_Quad* quads)
+    {
+        if (!canVectorize())
+            return 0;
+
+        const int done = count - count % BATCH;
+        const vfloat zero = vset(0.0f);
+        const vfloat max = vset(255.0f);
+        int r[BATCH], g[BATCH], b[BATCH], a[BATCH];
+        for (int i = 0; i < done; i += BATCH)
+        {
+            vfloat alpha = vload(data.colorA + i);
+            vfloat scale = premultiplyAlpha ? vmul(alpha, max) : max;
+            vstorei(r, vtrunc(vmin(vmax(vmul(vload(data.colorR + i), scale), zero), max)));
+            vstorei(g, vtrunc(vmin(vmax(vmul(vload(data.colorG + i), scale), zero), max)));
+            vstorei(b, vtrunc(vmin(vmax(vmul(vload(data.colorB + i), scale), zero), max)));
+            vstorei(a, vtrunc(vmin(vmax(vmul(alpha, max), zero), max)));
+
+            V3F_C4B_T2F_Quad* quad = quads + i;
+            for (int k = 0; k < BATCH; ++k, ++quad)
+            {
+                setQuadColor(quad, (GLubyte)r[k], (GLubyte)g[k], (GLubyte)b[k], (GLubyte)a[k]);
+            }
+        }
+        return done;
+    }
+#endif // INCLUDE_NEON || INCLUDE_SSE2
+}
+
+void updateGravityMode(ParticleData& data, int count, float gravityX, float gravityY, float dt, float yCoordFlipped)
+{
+    int i = 0;
+#ifdef PARTICLE_VECTOR_KERNELS
+    i = updateGravityModeVector(data, count, gravityX, gravityY, dt, yCoordFlipped);
+#endif
+    for (; i < count; ++i)
+    {
+        float radialX = 0.0f, radialY = 0.0f;
+
+        // radial acceleration
+        scalarNormalize(data.posx[i], data.posy[i], &radialX, &radialY);
+
+        // tangential acceleration
+        float tangentialX = -radialY * data.modeA.tangentialAccel[i];
+        float tangentialY = radialX * data.modeA.tangentialAccel[i];
+        radialX *= data.modeA.radialAccel[i];
+        radialY *= data.modeA.radialAccel[i];
+
+        // (gravity + radial + tangential) * dt
+        data.modeA.dirX[i] += (radialX + tangentialX + gravityX) * dt;
+        data.modeA.dirY[i] += (radialY + tangentialY + gravityY) * dt;
+
+        data.posx[i] += data.modeA.dirX[i] * dt * yCoordFlipped;
+        data.posy[i] += data.modeA.dirY[i] * dt * yCoordFlipped;
+    }
+}
+
+void updateRadiusMode(ParticleData& data, int count, float dt, float yCoordFlipped)
+{
+    int i = 0;
+#ifdef PARTICLE_VECTOR_KERNELS
+    i = updateRadiusModeVector(data, count, dt, yCoordFlipped);
+#endif
+    for (; i < count; ++i)
+    {
+        data.modeB.angle[i] += data.modeB.degreesPerSecond[i] * dt;
+        data.modeB.radius[i] += data.modeB.deltaRadius[i] * dt;
+        data.posx[i] = - cosf(data.modeB.angle[i]) * data.modeB.radius[i];
+        data.posy[i] = - sinf(data.modeB.angle[i]) * data.modeB.radius[i] * yCoordFlipped;
+    }
+}
+
+void updateColorSizeRotation(ParticleData& data, int count, float dt)
+{
+    int i = 0;
+#ifdef PARTICLE_VECTOR_KERNELS
+    i = updateColorSizeRotationVector(data, count, dt);
+#endif
+    for (; i < count; ++i)
+    {
+        data.colorR[i] += data.deltaColorR[i] * dt;
+        data.colorG[i] += data.deltaColorG[i] * dt;
+        data.colorB[i] += data.deltaColorB[i] * dt;
+        data.colorA[i] += data.deltaColorA[i] * dt;
+        data.size[i] = std::max(0.0f, data.size[i] + data.deltaSize[i] * dt);
+        data.rotation[i] += data.deltaRotation[i] * dt;
+    }
+}
+
+void updateQuadVertices(const ParticleData& data, int count, const float startTransform[6], V3F_C4B_T2F_Quad* quads)
+{
+    int i = 0;
+#ifdef PARTICLE_VECTOR_KERNELS
+    i = updateQuadVerticesVector(data, count, startTransform, quads);
+#endif
+    const float* t = startTransform;
+    for (; i < count; ++i)
+    {
+        float sx = data.startPosX[i];
+        float sy = data.startPosY[i];
+        float x = data.posx[i] + (t[0] * sx + (t[1] * sy + t[2]));
+        float y = data.posy[i] + (t[3] * sx + (t[4] * sy + t[5]));
+        scalarQuadVertices(quads + i, x, y, data.size[i], data.rotation[i]);
+    }
+}
+
+void updateQuadColors(const ParticleData& data, int count, bool premultiplyAlpha, V3F_C4B_T2F_Quad* quads)
+{
+    int i = 0;
+#ifdef PARTICLE_VECTOR_KERNELS
+    i = updateQuadColorsVector(data, count, premultiplyAlpha, quads);
+#endif
+    for (; i < count; ++i)
+    {
+        float alpha = data.colorA[i];
+        float scale = premultiplyAlpha ? alpha * 255 : 255;
+        setQuadColor(quads + i, clampColor(data.colorR[i] * scale), clampColor(data.colorG[i] * scale),
+                     clampColor(data.colorB[i] * scale), clampColor(alpha * 255));
+    }
+}
+
+bool isVectorized()
+{
+#if defined (INCLUDE_NEON)
+    return useNeon();
+#elif defined (INCLUDE_SSE2)
+    return true;
+#else
+    return false;
+#endif
+}
+
+} // namespace particle
+
+NS_CC_END
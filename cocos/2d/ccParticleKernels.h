@@ -0,0 +1,77 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CC_PARTICLE_KERNELS_H__
+#define __CC_PARTICLE_KERNELS_H__
+
+#include "base/ccTypes.h"
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+NS_CC_BEGIN
+
+class ParticleData;
+
+/**
+ The per-particle steps of ParticleSystem::update and ParticleSystemQuad::updateParticleQuads,
+ over the structure of arrays of ParticleData. They use NEON or SSE2 when the CPU has it, four particles at a time,
+ and the scalar code for the rest. The results match the scalar code to float rounding.
+ @js NA
+ */
+namespace particle
+{
+    /** Applies the gravity, radial and tangential accelerations of the gravity mode to the direction and position. */
+    void CC_DLL updateGravityMode(ParticleData& data, int count, float gravityX, float gravityY, float dt, float yCoordFlipped);
+
+    /** Turns and moves the particles of the radius mode, and sets their positions. */
+    void CC_DLL updateRadiusMode(ParticleData& data, int count, float dt, float yCoordFlipped);
+
+    /** Applies the color, size and rotation deltas, the size doesn't go below 0. */
+    void CC_DLL updateColorSizeRotation(ParticleData& data, int count, float dt);
+
+    /**
+     Sets the vertices of the quads of the particles, with their size and rotation.
+     The center of particle i is (posx + a * startPosX + b * startPosY + c, posy + d * startPosX + e * startPosY + f),
+     with {a, b, c, d, e, f} in `startTransform`, which covers the three position types.
+     */
+    void CC_DLL updateQuadVertices(const ParticleData& data, int count, const float startTransform[6], V3F_C4B_T2F_Quad* quads);
+
+    /** Sets the colors of the quads of the particles, premultiplied by their alpha or not. The components are clamped to [0, 255]. */
+    void CC_DLL updateQuadColors(const ParticleData& data, int count, bool premultiplyAlpha, V3F_C4B_T2F_Quad* quads);
+
+    /** Whether the kernels use NEON or SSE2 on this CPU. */
+    bool CC_DLL isVectorized();
+}
+
+NS_CC_END
+
+/**
+ end of _2d group
+ @}
+ */
+#endif //__CC_PARTICLE_KERNELS_H__
@@ -25,10 +25,15 @@
 #include "platform/CCPlatformConfig.h"
 
 #include "audio/include/AudioEngine.h"
+#include <cmath>
 #include <condition_variable>
+#include <memory>
 #include <queue>
 #include "platform/CCFileUtils.h"
 #include "base/ccUtils.h"
+#include "base/CCDirector.h"
+#include "base/CCScheduler.h"
+#include "base/CCMemoryPressure.h"
 
 #if CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID
 #include "android/AudioEngine-inl.h"
@@ -50,13 +55,25 @@ using namespace cocos2d::experimental;
 const int AudioEngine::INVALID_AUDIO_ID = -1;
 const float AudioEngine::TIME_UNKNOWN = -1.0f;
 
-//audio file path,audio IDs
-std::unordered_map<std::string,std::list<int>> AudioEngine::_audioPathIDMap;
+std::vector<AudioEngine::AudioSlot> AudioEngine::_audioSlots;
+std::vector<int> AudioEngine::_freeAudioSlots;
+unsigned int AudioEngine::_voiceCount = 0;
+unsigned int AudioEngine::_playCount = 0;
+unsigned int AudioEngine::_voiceIDCount = 0;
+//audio file path,duration
+std::unordered_map<std::string, float> AudioEngine::_audioPathDurationMap;
 //profileName,ProfileHelper
 std::unordered_map<std::string, AudioEngine::ProfileHelper> AudioEngine::_audioPathProfileHelperMap;
 unsigned int AudioEngine::_maxInstances = MAX_AUDIOINSTANCES;
+size_t AudioEngine::_cacheBudget = 0;
+#if CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
+size_t AudioEngine::_streamingThreshold = 2621440;
+#else
+size_t AudioEngine::_streamingThreshold = 1048576;
+#endif
+bool AudioEngine::_decodeOnPlay = false;
+std::string AudioEngine::_decodedCachePath;
 AudioEngine::ProfileHelper* AudioEngine::_defaultProfileHelper = nullptr;
-std::unordered_map<int, AudioEngine::AudioInfo> AudioEngine::_audioIDInfoMap;
 AudioEngineImpl* AudioEngine::_audioEngineImpl = nullptr;
 
 AudioEngine::AudioEngineThreadPool* AudioEngine::s_threadPool = nullptr;
@@ -146,6 +163,16 @@ void AudioEngine::end()
 
     stopAll();
 
+    if (_audioEngineImpl && Director::DirectorInstance)
+    {
+        Director::DirectorInstance->getScheduler()->unschedule("AudioEngine", &_audioSlots);
+        Director::DirectorInstance->getScheduler()->setTargetQuiet(&_audioSlots, false);
+    }
+    if (_audioEngineImpl)
+    {
+        MemoryPressure::getInstance()->removeHandler("audio");
+    }
+
     delete _audioEngineImpl;
     _audioEngineImpl = nullptr;
 
@@ -163,23 +190,247 @@ bool AudioEngine::lazyInit()
             _audioEngineImpl = nullptr;
            return false;
         }
+
+        // ends the virtual instances and gives them the free voices, without waking the retained mode of the Director
+        auto scheduler = Director::getInstance()->getScheduler();
+        scheduler->schedule(&AudioEngine::update, &_audioSlots, 0.05f, false, "AudioEngine");
+        scheduler->setTargetQuiet(&_audioSlots, true);
+
+        // the decoded audio nothing plays, half of the budget first
+        MemoryPressure::getInstance()->addHandler("audio", 30, [](MemoryPressure::Level level) -> size_t {
+            if (level == MemoryPressure::Level::LOW)
+            {
+                if (_cacheBudget > 0)
+                {
+                    trimCache(_cacheBudget / 2);
+                }
+            }
+            else
+            {
+                trimCache(0);
+            }
+            return 0;
+        });
     }
 
+    // ios and mac load on the JobSystem
 #if CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
     if (_audioEngineImpl && s_threadPool == nullptr)
     {
         s_threadPool = new (std::nothrow) AudioEngineThreadPool(true);
     }
-#elif CC_TARGET_PLATFORM != CC_PLATFORM_ANDROID
-    if (_audioEngineImpl && s_threadPool == nullptr)
-    {
-        s_threadPool = new (std::nothrow) AudioEngineThreadPool(false);
-    }
 #endif
 
     return true;
 }
 
+AudioEngine::AudioInfo* AudioEngine::getAudioInfo(int audioID)
+{
+    if (audioID < 0) {
+        return nullptr;
+    }
+    auto slot = audioID & (MAX_SLOTS - 1);
+    if (slot >= (int)_audioSlots.size() || _audioSlots[slot].audioID != audioID) {
+        return nullptr;
+    }
+    return &_audioSlots[slot].info;
+}
+
+AudioEngine::AudioInfo* AudioEngine::getVoiceInfo(int voiceID)
+{
+    if (voiceID < 0) {
+        return nullptr;
+    }
+    auto slot = voiceID & (MAX_SLOTS - 1);
+    if (slot >= (int)_audioSlots.size() || _audioSlots[slot].audioID == INVALID_AUDIO_ID
+        || _audioSlots[slot].info.voiceID != voiceID) {
+        return nullptr;
+    }
+    return &_audioSlots[slot].info;
+}
+
+int AudioEngine::addInstance(const std::string& filePath)
+{
+    int slot;
+    if (!_freeAudioSlots.empty()) {
+        slot = _freeAudioSlots.back();
+        _freeAudioSlots.pop_back();
+    }
+    else if (_audioSlots.size() < MAX_SLOTS) {
+        slot = (int)_audioSlots.size();
+        _audioSlots.emplace_back();
+    }
+    else {
+        return INVALID_AUDIO_ID;
+    }
+
+    auto it = _audioPathDurationMap.find(filePath);
+    if (it == _audioPathDurationMap.end()) {
+        it = _audioPathDurationMap.insert(std::make_pair(filePath, TIME_UNKNOWN)).first;
+    }
+
+    auto& audioSlot = _audioSlots[slot];
+    audioSlot.generation = (audioSlot.generation + 1) & 0xfffff;
+    audioSlot.audioID = (int)(audioSlot.generation << SLOT_BITS) | slot;
+    audioSlot.info = AudioInfo();
+    audioSlot.info.filePath = &it->first;
+    audioSlot.info.order = ++_playCount;
+    return slot;
+}
+
+void AudioEngine::removeInstance(int slot)
+{
+    auto& audioSlot = _audioSlots[slot];
+    audioSlot.audioID = INVALID_AUDIO_ID;
+    audioSlot.info = AudioInfo();
+    _freeAudioSlots.push_back(slot);
+}
+
+bool AudioEngine::startVoice(int slot)
+{
+    auto& info = _audioSlots[slot].info;
+    _voiceIDCount = (_voiceIDCount + 1) & 0xfffff;
+    auto voiceID = (int)(_voiceIDCount << SLOT_BITS) | slot;
+    // set first, the platform player may find the instance while it starts
+    info.voiceID = voiceID;
+    if (_audioEngineImpl->play2d(*info.filePath, info.loop, info.volume, voiceID) == INVALID_AUDIO_ID) {
+        info.voiceID = INVALID_AUDIO_ID;
+        return false;
+    }
+
+    ++_voiceCount;
+    if (info.finishCallback) {
+        _audioEngineImpl->setFinishCallback(voiceID, &AudioEngine::onVoiceFinished);
+    }
+    return true;
+}
+
+void AudioEngine::stopVoice(AudioInfo& info)
+{
+    _audioEngineImpl->stop(info.voiceID);
+    info.voiceID = INVALID_AUDIO_ID;
+    --_voiceCount;
+}
+
+void AudioEngine::stealVoice(int slot)
+{
+    auto& info = _audioSlots[slot].info;
+    auto time = info.state == AudioState::INITIALZING ? 0.0f : _audioEngineImpl->getCurrentTime(info.voiceID);
+    auto duration = getKnownDuration(info);
+    stopVoice(info);
+
+    // without its duration, a virtual instance that doesn't loop would never end
+    if (info.loop || (duration > 0.0f && time < duration)) {
+        info.virtualTime = time;
+        info.virtualStart = utils::gettime();
+        info.pendingTime = TIME_UNKNOWN;
+        if (info.state == AudioState::INITIALZING) {
+            info.state = AudioState::PLAYING;
+        }
+    }
+    else {
+        removeInstance(slot);
+    }
+}
+
+float AudioEngine::getKnownDuration(const AudioInfo& info)
+{
+    if (info.duration != TIME_UNKNOWN) {
+        return info.duration;
+    }
+    auto it = _audioPathDurationMap.find(*info.filePath);
+    return it != _audioPathDurationMap.end() ? it->second : TIME_UNKNOWN;
+}
+
+float AudioEngine::getVirtualTime(const AudioInfo& info)
+{
+    auto time = info.virtualTime;
+    if (info.state == AudioState::PLAYING) {
+        time += (float)(utils::gettime() - info.virtualStart);
+    }
+    auto duration = getKnownDuration(info);
+    if (info.loop && duration > 0.0f) {
+        time = fmodf(time, duration);
+    }
+    return time;
+}
+
+void AudioEngine::onVoiceFinished(int voiceID, const std::string& filePath)
+{
+    auto info = getVoiceInfo(voiceID);
+    if (info && info->finishCallback) {
+        auto audioID = _audioSlots[voiceID & (MAX_SLOTS - 1)].audioID;
+        // a copy, the callback may stop the instance
+        auto callback = info->finishCallback;
+        callback(audioID, filePath);
+    }
+}
+
+void AudioEngine::update(float dt)
+{
+    for (int slot = 0; slot < (int)_audioSlots.size(); ++slot) {
+        auto& audioSlot = _audioSlots[slot];
+        auto& info = audioSlot.info;
+        if (audioSlot.audioID == INVALID_AUDIO_ID || info.state != AudioState::PLAYING) {
+            continue;
+        }
+
+        if (!info.isVirtual()) {
+            // the durations of the files let the virtual instances that don't loop end
+            if (info.duration == TIME_UNKNOWN) {
+                info.duration = _audioEngineImpl->getDuration(info.voiceID);
+                if (info.duration > 0.0f) {
+                    _audioPathDurationMap[*info.filePath] = info.duration;
+                }
+            }
+            if (info.pendingTime != TIME_UNKNOWN && _audioEngineImpl->setCurrentTime(info.voiceID, info.pendingTime)) {
+                info.pendingTime = TIME_UNKNOWN;
+            }
+            continue;
+        }
+
+        auto duration = getKnownDuration(info);
+        if (!info.loop && duration > 0.0f && getVirtualTime(info) >= duration) {
+            auto audioID = audioSlot.audioID;
+            auto filePath = *info.filePath;
+            auto callback = std::move(info.finishCallback);
+            removeInstance(slot);
+            if (callback) {
+                // the update is quiet, the callback may change the nodes
+                Director::getInstance()->requestRedraw();
+                callback(audioID, filePath);
+            }
+        }
+    }
+
+    // the free voices go to the virtual instances with the highest priority, the oldest first
+    while (_voiceCount < _maxInstances) {
+        int best = INVALID_AUDIO_ID;
+        for (int slot = 0; slot < (int)_audioSlots.size(); ++slot) {
+            auto& info = _audioSlots[slot].info;
+            if (_audioSlots[slot].audioID == INVALID_AUDIO_ID || !info.isVirtual() || info.state != AudioState::PLAYING) {
+                continue;
+            }
+            if (best == INVALID_AUDIO_ID || info.priority > _audioSlots[best].info.priority
+                || (info.priority == _audioSlots[best].info.priority && info.order < _audioSlots[best].info.order)) {
+                best = slot;
+            }
+        }
+        if (best == INVALID_AUDIO_ID) {
+            break;
+        }
+
+        auto& info = _audioSlots[best].info;
+        auto time = getVirtualTime(info);
+        if (!startVoice(best)) {
+            break;
+        }
+        if (time > 0.0f) {
+            info.pendingTime = time;
+        }
+    }
+}
+
 int AudioEngine::play2d(const std::string& filePath, bool loop, float volume, const AudioProfile *profile)
 {
     int ret = AudioEngine::INVALID_AUDIO_ID;
@@ -200,16 +451,8 @@ int AudioEngine::play2d(const std::string& filePath, bool loop, float volume, co
             profileHelper->profile = *profile;
         }
 
-        if (_audioIDInfoMap.size() >= _maxInstances) {
-            log("Fail to play %s cause by limited max instance of AudioEngine",filePath.c_str());
-            break;
-        }
         if (profileHelper)
         {
-             if(profileHelper->profile.maxInstances != 0 && profileHelper->audioIDs.size() >= profileHelper->profile.maxInstances){
-                 log("Fail to play %s cause by limited max instance of AudioProfile",filePath.c_str());
-                 break;
-             }
              if (profileHelper->profile.minDelay > TIME_DELAY_PRECISION) {
                  auto currTime = utils::gettime();
                  if (profileHelper->lastPlayTime > TIME_DELAY_PRECISION && currTime - profileHelper->lastPlayTime <= profileHelper->profile.minDelay) {
@@ -217,6 +460,22 @@ int AudioEngine::play2d(const std::string& filePath, bool loop, float volume, co
                      break;
                  }
              }
+             if (profileHelper->profile.maxInstances != 0) {
+                 // the oldest instance of the profile makes room for the new one
+                 unsigned int count = 0;
+                 int oldest = INVALID_AUDIO_ID;
+                 for (auto& audioSlot : _audioSlots) {
+                     if (audioSlot.audioID != INVALID_AUDIO_ID && audioSlot.info.profileHelper == profileHelper) {
+                         ++count;
+                         if (oldest == INVALID_AUDIO_ID || audioSlot.info.order < getAudioInfo(oldest)->order) {
+                             oldest = audioSlot.audioID;
+                         }
+                     }
+                 }
+                 if (count >= profileHelper->profile.maxInstances) {
+                     stop(oldest);
+                 }
+             }
         }
 
         if (volume < 0.0f) {
@@ -226,23 +485,58 @@ int AudioEngine::play2d(const std::string& filePath, bool loop, float volume, co
             volume = 1.0f;
         }
 
-        ret = _audioEngineImpl->play2d(filePath, loop, volume);
-        if (ret != INVALID_AUDIO_ID)
-        {
-            _audioPathIDMap[filePath].push_back(ret);
-            auto it = _audioPathIDMap.find(filePath);
-
-            auto& audioRef = _audioIDInfoMap[ret];
-            audioRef.volume = volume;
-            audioRef.loop = loop;
-            audioRef.filePath = &it->first;
+        int priority = profileHelper ? profileHelper->profile.priority : 0;
+        bool hasVoice = _voiceCount < _maxInstances;
+        if (!hasVoice) {
+            // steals the voice of the oldest instance with the lowest priority, if lower
+            int victim = INVALID_AUDIO_ID;
+            for (int slot = 0; slot < (int)_audioSlots.size(); ++slot) {
+                auto& info = _audioSlots[slot].info;
+                if (_audioSlots[slot].audioID == INVALID_AUDIO_ID || info.isVirtual() || info.priority >= priority) {
+                    continue;
+                }
+                if (victim == INVALID_AUDIO_ID || info.priority < _audioSlots[victim].info.priority
+                    || (info.priority == _audioSlots[victim].info.priority && info.order < _audioSlots[victim].info.order)) {
+                    victim = slot;
+                }
+            }
+            if (victim != INVALID_AUDIO_ID) {
+                stealVoice(victim);
+                hasVoice = true;
+            }
+        }
+        auto slot = addInstance(filePath);
+        if (slot == INVALID_AUDIO_ID) {
+            log("Fail to play %s cause by limited max instance of AudioEngine",filePath.c_str());
+            break;
+        }
+        // without its duration, a virtual instance that doesn't loop would never end
+        if (!hasVoice && !loop && getKnownDuration(_audioSlots[slot].info) <= 0.0f) {
+            log("Fail to play %s cause by limited max instance of AudioEngine",filePath.c_str());
+            removeInstance(slot);
+            break;
+        }
 
-            if (profileHelper) {
-                profileHelper->lastPlayTime = utils::gettime();
-                profileHelper->audioIDs.push_back(ret);
+        auto& audioRef = _audioSlots[slot].info;
+        audioRef.volume = volume;
+        audioRef.loop = loop;
+        audioRef.priority = priority;
+        audioRef.profileHelper = profileHelper;
+        if (hasVoice) {
+            if (!startVoice(slot)) {
+                removeInstance(slot);
+                break;
             }
-            audioRef.profileHelper = profileHelper;
         }
+        else {
+            audioRef.state = AudioState::PLAYING;
+            audioRef.virtualStart = utils::gettime();
+        }
+
+        if (profileHelper) {
+            profileHelper->lastPlayTime = utils::gettime();
+        }
+        ret = _audioSlots[slot].audioID;
     } while (0);
 
     return ret;
@@ -250,17 +544,24 @@ int AudioEngine::play2d(const std::string& filePath, bool loop, float volume, co
 
 void AudioEngine::setLoop(int audioID, bool loop)
 {
-    auto it = _audioIDInfoMap.find(audioID);
-    if (it != _audioIDInfoMap.end() && it->second.loop != loop){
-        _audioEngineImpl->setLoop(audioID, loop);
-        it->second.loop = loop;
+    auto info = getAudioInfo(audioID);
+    if (info && info->loop != loop){
+        if (!info->isVirtual()) {
+            _audioEngineImpl->setLoop(info->voiceID, loop);
+        }
+        else if (!loop) {
+            // the time of a looping virtual instance wraps, keep the position in the current loop
+            info->virtualTime = getVirtualTime(*info);
+            info->virtualStart = utils::gettime();
+        }
+        info->loop = loop;
     }
 }
 
 void AudioEngine::setVolume(int audioID, float volume)
 {
-    auto it = _audioIDInfoMap.find(audioID);
-    if (it != _audioIDInfoMap.end()){
+    auto info = getAudioInfo(audioID);
+    if (info){
         if (volume < 0.0f) {
             volume = 0.0f;
         }
@@ -268,76 +569,83 @@ void AudioEngine::setVolume(int audioID, float volume)
             volume = 1.0f;
         }
 
-        if (it->second.volume != volume){
-            _audioEngineImpl->setVolume(audioID, volume);
-            it->second.volume = volume;
+        if (info->volume != volume){
+            if (!info->isVirtual()) {
+                _audioEngineImpl->setVolume(info->voiceID, volume);
+            }
+            info->volume = volume;
         }
     }
 }
 
 void AudioEngine::pause(int audioID)
 {
-    auto it = _audioIDInfoMap.find(audioID);
-    if (it != _audioIDInfoMap.end() && it->second.state == AudioState::PLAYING){
-        _audioEngineImpl->pause(audioID);
-        it->second.state = AudioState::PAUSED;
+    auto info = getAudioInfo(audioID);
+    if (info && info->state == AudioState::PLAYING){
+        if (info->isVirtual()) {
+            info->virtualTime = getVirtualTime(*info);
+        }
+        else {
+            _audioEngineImpl->pause(info->voiceID);
+        }
+        info->state = AudioState::PAUSED;
     }
 }
 
 void AudioEngine::pauseAll()
 {
-    auto itEnd = _audioIDInfoMap.end();
-    for (auto it = _audioIDInfoMap.begin(); it != itEnd; ++it)
+    for (auto& audioSlot : _audioSlots)
     {
-        if (it->second.state == AudioState::PLAYING)
+        if (audioSlot.audioID != INVALID_AUDIO_ID)
         {
-            _audioEngineImpl->pause(it->first);
-            it->second.state = AudioState::PAUSED;
+            pause(audioSlot.audioID);
         }
     }
 }
 
 void AudioEngine::resume(int audioID)
 {
-    auto it = _audioIDInfoMap.find(audioID);
-    if (it != _audioIDInfoMap.end() && it->second.state == AudioState::PAUSED){
-        _audioEngineImpl->resume(audioID);
-        it->second.state = AudioState::PLAYING;
+    auto info = getAudioInfo(audioID);
+    if (info && info->state == AudioState::PAUSED){
+        if (info->isVirtual()) {
+            info->virtualStart = utils::gettime();
+        }
+        else {
+            _audioEngineImpl->resume(info->voiceID);
+        }
+        info->state = AudioState::PLAYING;
     }
 }
 
 void AudioEngine::resumeAll()
 {
-    auto itEnd = _audioIDInfoMap.end();
-    for (auto it = _audioIDInfoMap.begin(); it != itEnd; ++it)
+    for (auto& audioSlot : _audioSlots)
     {
-        if (it->second.state == AudioState::PAUSED)
+        if (audioSlot.audioID != INVALID_AUDIO_ID)
         {
-            _audioEngineImpl->resume(it->first);
-            it->second.state = AudioState::PLAYING;
+            resume(audioSlot.audioID);
         }
     }
 }
 
 void AudioEngine::stop(int audioID)
 {
-    auto it = _audioIDInfoMap.find(audioID);
-    if (it != _audioIDInfoMap.end()){
-        _audioEngineImpl->stop(audioID);
-
-        remove(audioID);
+    auto info = getAudioInfo(audioID);
+    if (info){
+        if (!info->isVirtual()) {
+            stopVoice(*info);
+        }
+        removeInstance(audioID & (MAX_SLOTS - 1));
     }
 }
 
-void AudioEngine::remove(int audioID)
+void AudioEngine::remove(int voiceID)
 {
-    auto it = _audioIDInfoMap.find(audioID);
-    if (it != _audioIDInfoMap.end()){
-        if (it->second.profileHelper) {
-            it->second.profileHelper->audioIDs.remove(audioID);
-        }
-        _audioPathIDMap[*it->second.filePath].remove(audioID);
-        _audioIDInfoMap.erase(audioID);
+    auto info = getVoiceInfo(voiceID);
+    if (info){
+        info->voiceID = INVALID_AUDIO_ID;
+        --_voiceCount;
+        removeInstance(voiceID & (MAX_SLOTS - 1));
     }
 }
 
@@ -347,34 +655,26 @@ void AudioEngine::stopAll()
         return;
     }
     _audioEngineImpl->stopAll();
-    auto itEnd = _audioIDInfoMap.end();
-    for (auto it = _audioIDInfoMap.begin(); it != itEnd; ++it)
+    for (int slot = 0; slot < (int)_audioSlots.size(); ++slot)
     {
-        if (it->second.profileHelper){
-            it->second.profileHelper->audioIDs.remove(it->first);
+        if (_audioSlots[slot].audioID != INVALID_AUDIO_ID)
+        {
+            removeInstance(slot);
         }
     }
-    _audioPathIDMap.clear();
-    _audioIDInfoMap.clear();
+    _voiceCount = 0;
 }
 
 void AudioEngine::uncache(const std::string &filePath)
 {
-    if(_audioPathIDMap.find(filePath) != _audioPathIDMap.end()){
-        auto itEnd = _audioPathIDMap[filePath].end();
-        for (auto it = _audioPathIDMap[filePath].begin() ; it != itEnd; ++it) {
-            auto audioID = *it;
-            _audioEngineImpl->stop(audioID);
-
-            auto itInfo = _audioIDInfoMap.find(audioID);
-            if (itInfo != _audioIDInfoMap.end()){
-                if (itInfo->second.profileHelper) {
-                    itInfo->second.profileHelper->audioIDs.remove(audioID);
-                }
-                _audioIDInfoMap.erase(audioID);
+    auto it = _audioPathDurationMap.find(filePath);
+    if (it != _audioPathDurationMap.end()){
+        for (auto& audioSlot : _audioSlots) {
+            if (audioSlot.audioID != INVALID_AUDIO_ID && audioSlot.info.filePath == &it->first) {
+                stop(audioSlot.audioID);
             }
         }
-        _audioPathIDMap.erase(filePath);
+        _audioPathDurationMap.erase(it);
     }
 
     if (_audioEngineImpl){
@@ -388,19 +688,53 @@ void AudioEngine::uncacheAll()
         return;
     }
     stopAll();
+    _audioPathDurationMap.clear();
     _audioEngineImpl->uncacheAll();
 }
 
+void AudioEngine::setCacheBudget(size_t bytes)
+{
+    _cacheBudget = bytes;
+    if (_audioEngineImpl){
+        _audioEngineImpl->trimCaches();
+    }
+}
+
+void AudioEngine::trimCache(size_t bytes)
+{
+    if (!_audioEngineImpl){
+        return;
+    }
+    // the caches trim to the budget, 0 would mean no limit
+    const size_t budget = _cacheBudget;
+    _cacheBudget = std::max(bytes, (size_t)1);
+    _audioEngineImpl->trimCaches();
+    _cacheBudget = budget;
+}
+
+void AudioEngine::setDecodedCachePath(const std::string& path)
+{
+    _decodedCachePath = path;
+    if (!_decodedCachePath.empty())
+    {
+        if (_decodedCachePath.back() != '/')
+        {
+            _decodedCachePath += '/';
+        }
+        FileUtils::getInstance()->createDirectory(_decodedCachePath);
+    }
+}
+
 float AudioEngine::getDuration(int audioID)
 {
-    auto it = _audioIDInfoMap.find(audioID);
-    if (it != _audioIDInfoMap.end() && it->second.state != AudioState::INITIALZING)
+    auto info = getAudioInfo(audioID);
+    if (info)
     {
-        if (it->second.duration == TIME_UNKNOWN)
+        if (info->duration == TIME_UNKNOWN && !info->isVirtual() && info->state != AudioState::INITIALZING)
         {
-            it->second.duration = _audioEngineImpl->getDuration(audioID);
+            info->duration = _audioEngineImpl->getDuration(info->voiceID);
         }
-        return it->second.duration;
+        return getKnownDuration(*info);
     }
 
     return TIME_UNKNOWN;
@@ -408,9 +742,20 @@ float AudioEngine::getDuration(int audioID)
 
 bool AudioEngine::setCurrentTime(int audioID, float time)
 {
-    auto it = _audioIDInfoMap.find(audioID);
-    if (it != _audioIDInfoMap.end() && it->second.state != AudioState::INITIALZING){
-        return _audioEngineImpl->setCurrentTime(audioID, time);
+    auto info = getAudioInfo(audioID);
+    if (info){
+        if (info->isVirtual()) {
+            auto duration = getKnownDuration(*info);
+            if (time < 0.0f || (duration > 0.0f && time >= duration)) {
+                return false;
+            }
+            info->virtualTime = time;
+            info->virtualStart = utils::gettime();
+            return true;
+        }
+        if (info->state != AudioState::INITIALZING) {
+            return _audioEngineImpl->setCurrentTime(info->voiceID, time);
+        }
     }
 
     return false;
@@ -418,18 +763,26 @@ bool AudioEngine::setCurrentTime(int audioID, float time)
 
 float AudioEngine::getCurrentTime(int audioID)
 {
-    auto it = _audioIDInfoMap.find(audioID);
-    if (it != _audioIDInfoMap.end() && it->second.state != AudioState::INITIALZING){
-        return _audioEngineImpl->getCurrentTime(audioID);
+    auto info = getAudioInfo(audioID);
+    if (info){
+        if (info->isVirtual()) {
+            return getVirtualTime(*info);
+        }
+        if (info->state != AudioState::INITIALZING) {
+            return _audioEngineImpl->getCurrentTime(info->voiceID);
+        }
     }
     return 0.0f;
 }
 
 void AudioEngine::setFinishCallback(int audioID, const std::function<void (int, const std::string &)> &callback)
 {
-    auto it = _audioIDInfoMap.find(audioID);
-    if (it != _audioIDInfoMap.end()){
-        _audioEngineImpl->setFinishCallback(audioID, callback);
+    auto info = getAudioInfo(audioID);
+    if (info){
+        info->finishCallback = callback;
+        if (!info->isVirtual()) {
+            _audioEngineImpl->setFinishCallback(info->voiceID, &AudioEngine::onVoiceFinished);
+        }
     }
 }
 
@@ -445,10 +798,10 @@ bool AudioEngine::setMaxAudioInstance(int maxInstances)
 
 bool AudioEngine::isLoop(int audioID)
 {
-    auto tmpIterator = _audioIDInfoMap.find(audioID);
-    if (tmpIterator != _audioIDInfoMap.end())
+    auto info = getAudioInfo(audioID);
+    if (info)
     {
-        return tmpIterator->second.loop;
+        return info->loop;
     }
 
     log("AudioEngine::isLoop-->The audio instance %d is non-existent", audioID);
@@ -457,10 +810,10 @@ bool AudioEngine::isLoop(int audioID)
 
 float AudioEngine::getVolume(int audioID)
 {
-    auto tmpIterator = _audioIDInfoMap.find(audioID);
-    if (tmpIterator != _audioIDInfoMap.end())
+    auto info = getAudioInfo(audioID);
+    if (info)
     {
-        return tmpIterator->second.volume;
+        return info->volume;
     }
 
     log("AudioEngine::getVolume-->The audio instance %d is non-existent", audioID);
@@ -469,10 +822,10 @@ float AudioEngine::getVolume(int audioID)
 
 AudioEngine::AudioState AudioEngine::getState(int audioID)
 {
-    auto tmpIterator = _audioIDInfoMap.find(audioID);
-    if (tmpIterator != _audioIDInfoMap.end())
+    auto info = getAudioInfo(audioID);
+    if (info)
     {
-        return tmpIterator->second.state;
+        return info->state;
     }
 
     return AudioState::ERROR;
@@ -480,10 +833,10 @@ AudioEngine::AudioState AudioEngine::getState(int audioID)
 
 AudioProfile* AudioEngine::getProfile(int audioID)
 {
-    auto it = _audioIDInfoMap.find(audioID);
-    if (it != _audioIDInfoMap.end())
+    auto info = getAudioInfo(audioID);
+    if (info)
     {
-        return &it->second.profileHelper->profile;
+        return &info->profileHelper->profile;
     }
 
     return nullptr;
@@ -527,6 +880,37 @@ void AudioEngine::preload(const std::string& filePath, std::function<void(bool i
     }
 }
 
+void AudioEngine::preload(const std::vector<std::string>& filePaths, std::function<void(bool isSuccess)> callback)
+{
+    if (filePaths.empty()) {
+        if (callback) {
+            callback(true);
+        }
+        return;
+    }
+
+    // the load callbacks run on the cocos thread, the last one calls back
+    struct PreloadBatch
+    {
+        size_t remaining;
+        bool success;
+        std::function<void(bool isSuccess)> callback;
+    };
+    auto batch = std::make_shared<PreloadBatch>();
+    batch->remaining = filePaths.size();
+    batch->success = true;
+    batch->callback = callback;
+
+    for (auto& filePath : filePaths) {
+        preload(filePath, [batch](bool isSuccess){
+            batch->success = batch->success && isSuccess;
+            if (--batch->remaining == 0 && batch->callback) {
+                batch->callback(batch->success);
+            }
+        });
+    }
+}
+
 void AudioEngine::addTask(const std::function<void()>& task)
 {
     lazyInit();
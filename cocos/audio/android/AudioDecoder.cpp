@@ -0,0 +1,410 @@
+/****************************************************************************
+ Copyright (c) 2014-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#include "platform/CCPlatformConfig.h"
+#if CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID
+
+#include "AudioDecoder.h"
+
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <android/asset_manager.h>
+#include <vector>
+#include "platform/CCFileUtils.h"
+#include "platform/android/CCFileUtils-android.h"
+
+using namespace cocos2d;
+using namespace cocos2d::experimental;
+
+namespace
+{
+    // <media/NdkMediaExtractor.h> and <media/NdkMediaCodec.h>, in libmediandk from API level 21
+    typedef struct AMediaExtractor AMediaExtractor;
+    typedef struct AMediaCodec AMediaCodec;
+    typedef struct AMediaFormat AMediaFormat;
+    struct AMediaCodecBufferInfo
+    {
+        int32_t offset;
+        int32_t size;
+        int64_t presentationTimeUs;
+        uint32_t flags;
+    };
+
+    const int AMEDIA_OK = 0;
+    const uint32_t AMEDIACODEC_BUFFER_FLAG_END_OF_STREAM = 4;
+    const ssize_t AMEDIACODEC_INFO_OUTPUT_FORMAT_CHANGED = -2;
+    // the dequeue timeout, the codec runs on its own threads
+    const int64_t DEQUEUE_TIMEOUT_US = 5000;
+
+    struct MediaAPI
+    {
+        AMediaExtractor* (*extractorNew)();
+        int (*extractorDelete)(AMediaExtractor*);
+        int (*extractorSetDataSourceFd)(AMediaExtractor*, int fd, off64_t offset, off64_t length);
+        size_t (*extractorGetTrackCount)(AMediaExtractor*);
+        AMediaFormat* (*extractorGetTrackFormat)(AMediaExtractor*, size_t index);
+        int (*extractorSelectTrack)(AMediaExtractor*, size_t index);
+        ssize_t (*extractorReadSampleData)(AMediaExtractor*, uint8_t* buffer, size_t capacity);
+        int64_t (*extractorGetSampleTime)(AMediaExtractor*);
+        bool (*extractorAdvance)(AMediaExtractor*);
+        bool (*formatGetInt32)(AMediaFormat*, const char* name, int32_t* out);
+        bool (*formatGetInt64)(AMediaFormat*, const char* name, int64_t* out);
+        bool (*formatGetString)(AMediaFormat*, const char* name, const char** out);
+        int (*formatDelete)(AMediaFormat*);
+        AMediaCodec* (*codecCreateDecoderByType)(const char* mimeType);
+        int (*codecConfigure)(AMediaCodec*, const AMediaFormat*, void* surface, void* crypto, uint32_t flags);
+        int (*codecStart)(AMediaCodec*);
+        int (*codecStop)(AMediaCodec*);
+        int (*codecDelete)(AMediaCodec*);
+        ssize_t (*codecDequeueInputBuffer)(AMediaCodec*, int64_t timeoutUs);
+        uint8_t* (*codecGetInputBuffer)(AMediaCodec*, size_t index, size_t* size);
+        int (*codecQueueInputBuffer)(AMediaCodec*, size_t index, off_t offset, size_t size, uint64_t time, uint32_t flags);
+        ssize_t (*codecDequeueOutputBuffer)(AMediaCodec*, AMediaCodecBufferInfo* info, int64_t timeoutUs);
+        uint8_t* (*codecGetOutputBuffer)(AMediaCodec*, size_t index, size_t* size);
+        int (*codecReleaseOutputBuffer)(AMediaCodec*, size_t index, bool render);
+        AMediaFormat* (*codecGetOutputFormat)(AMediaCodec*);
+        bool available;
+    };
+
+    template <typename T>
+    void lookUp(void* lib, const char* name, T* function, bool* available)
+    {
+        *function = (T)dlsym(lib, name);
+        *available = *available && *function != nullptr;
+    }
+
+    MediaAPI loadMediaAPI()
+    {
+        MediaAPI api = {};
+        void* lib = dlopen("libmediandk.so", RTLD_NOW | RTLD_LOCAL);
+        if (!lib)
+            return api;
+
+        api.available = true;
+        lookUp(lib, "AMediaExtractor_new", &api.extractorNew, &api.available);
+        lookUp(lib, "AMediaExtractor_delete", &api.extractorDelete, &api.available);
+        lookUp(lib, "AMediaExtractor_setDataSourceFd", &api.extractorSetDataSourceFd, &api.available);
+        lookUp(lib, "AMediaExtractor_getTrackCount", &api.extractorGetTrackCount, &api.available);
+        lookUp(lib, "AMediaExtractor_getTrackFormat", &api.extractorGetTrackFormat, &api.available);
+        lookUp(lib, "AMediaExtractor_selectTrack", &api.extractorSelectTrack, &api.available);
+        lookUp(lib, "AMediaExtractor_readSampleData", &api.extractorReadSampleData, &api.available);
+        lookUp(lib, "AMediaExtractor_getSampleTime", &api.extractorGetSampleTime, &api.available);
+        lookUp(lib, "AMediaExtractor_advance", &api.extractorAdvance, &api.available);
+        lookUp(lib, "AMediaFormat_getInt32", &api.formatGetInt32, &api.available);
+        lookUp(lib, "AMediaFormat_getInt64", &api.formatGetInt64, &api.available);
+        lookUp(lib, "AMediaFormat_getString", &api.formatGetString, &api.available);
+        lookUp(lib, "AMediaFormat_delete", &api.formatDelete, &api.available);
+        lookUp(lib, "AMediaCodec_createDecoderByType", &api.codecCreateDecoderByType, &api.available);
+        lookUp(lib, "AMediaCodec_configure", &api.codecConfigure, &api.available);
+        lookUp(lib, "AMediaCodec_start", &api.codecStart, &api.available);
+        lookUp(lib, "AMediaCodec_stop", &api.codecStop, &api.available);
+        lookUp(lib, "AMediaCodec_delete", &api.codecDelete, &api.available);
+        lookUp(lib, "AMediaCodec_dequeueInputBuffer", &api.codecDequeueInputBuffer, &api.available);
+        lookUp(lib, "AMediaCodec_getInputBuffer", &api.codecGetInputBuffer, &api.available);
+        lookUp(lib, "AMediaCodec_queueInputBuffer", &api.codecQueueInputBuffer, &api.available);
+        lookUp(lib, "AMediaCodec_dequeueOutputBuffer", &api.codecDequeueOutputBuffer, &api.available);
+        lookUp(lib, "AMediaCodec_getOutputBuffer", &api.codecGetOutputBuffer, &api.available);
+        lookUp(lib, "AMediaCodec_releaseOutputBuffer", &api.codecReleaseOutputBuffer, &api.available);
+        lookUp(lib, "AMediaCodec_getOutputFormat", &api.codecGetOutputFormat, &api.available);
+        return api;
+    }
+
+    const MediaAPI& getMediaAPI()
+    {
+        static const MediaAPI api = loadMediaAPI();
+        return api;
+    }
+
+    /** Converts interleaved 16 bits samples to stereo at `outRate`, linearly interpolated when the rates differ. */
+    std::shared_ptr<PcmData> toMixerFormat(const int16_t* in, int frames, int channels, int rate, int outRate)
+    {
+        auto pcm = std::make_shared<PcmData>();
+        if (frames <= 0 || channels <= 0 || rate <= 0)
+            return pcm;
+
+        pcm->frames = (int)((int64_t)frames * outRate / rate);
+        pcm->samples.resize(pcm->frames * 2);
+        int16_t* out = pcm->samples.data();
+        int right = channels > 1 ? 1 : 0;
+
+        if (rate == outRate)
+        {
+            for (int i = 0; i < frames; ++i)
+            {
+                out[i * 2] = in[i * channels];
+                out[i * 2 + 1] = in[i * channels + right];
+            }
+            return pcm;
+        }
+
+        // 16.16 fixed point position in the input
+        int64_t step = ((int64_t)rate << 16) / outRate;
+        int64_t position = 0;
+        for (int i = 0; i < pcm->frames; ++i, position += step)
+        {
+            int index = (int)(position >> 16);
+            int next = std::min(index + 1, frames - 1);
+            int fraction = (int)(position & 0xFFFF);
+            for (int c = 0; c < 2; ++c)
+            {
+                int channel = c == 0 ? 0 : right;
+                int a = in[index * channels + channel];
+                int b = in[next * channels + channel];
+                out[i * 2 + c] = (int16_t)(a + (((b - a) * fraction) >> 16));
+            }
+        }
+        return pcm;
+    }
+
+    bool readWav(const Data& data, std::vector<int16_t>* samples, int* channels, int* rate)
+    {
+        const unsigned char* bytes = data.getBytes();
+        ssize_t size = data.getSize();
+        if (size < 12 || memcmp(bytes, "RIFF", 4) != 0 || memcmp(bytes + 8, "WAVE", 4) != 0)
+            return false;
+
+        int format = 0;
+        int bits = 0;
+        for (ssize_t pos = 12; pos + 8 <= size; )
+        {
+            const unsigned char* chunk = bytes + pos;
+            uint32_t chunkSize = chunk[4] | (chunk[5] << 8) | (chunk[6] << 16) | ((uint32_t)chunk[7] << 24);
+            const unsigned char* body = chunk + 8;
+            ssize_t available = std::min<ssize_t>(chunkSize, size - pos - 8);
+
+            if (memcmp(chunk, "fmt ", 4) == 0 && available >= 16)
+            {
+                format = body[0] | (body[1] << 8);
+                *channels = body[2] | (body[3] << 8);
+                *rate = body[4] | (body[5] << 8) | (body[6] << 16) | (body[7] << 24);
+                bits = body[14] | (body[15] << 8);
+            }
+            else if (memcmp(chunk, "data", 4) == 0)
+            {
+                // PCM 8 or 16 bits only, MediaCodec decodes the others
+                if (format != 1 || (bits != 8 && bits != 16) || *channels <= 0)
+                    return false;
+
+                ssize_t count = available / (bits / 8);
+                samples->resize(count);
+                for (ssize_t i = 0; i < count; ++i)
+                {
+                    (*samples)[i] = bits == 16 ? (int16_t)(body[i * 2] | (body[i * 2 + 1] << 8)) : (int16_t)((body[i] - 128) << 8);
+                }
+                return true;
+            }
+            pos += 8 + chunkSize + (chunkSize & 1);
+        }
+        return false;
+    }
+
+    /** Opens the file or the asset, the ones of the apk are read through its descriptor. */
+    int openAudioFile(const std::string& fullPath, off64_t* offset, off64_t* length)
+    {
+        if (fullPath[0] == '/')
+        {
+            int fd = open(fullPath.c_str(), O_RDONLY | O_CLOEXEC);
+            struct stat st;
+            if (fd >= 0 && fstat(fd, &st) != 0)
+            {
+                close(fd);
+                return -1;
+            }
+            *offset = 0;
+            *length = fd >= 0 ? st.st_size : 0;
+            return fd;
+        }
+
+        std::string relativePath = fullPath.compare(0, strlen("assets/"), "assets/") == 0 ? fullPath.substr(strlen("assets/")) : fullPath;
+        AAsset* asset = AAssetManager_open(FileUtilsAndroid::getAssetManager(), relativePath.c_str(), AASSET_MODE_UNKNOWN);
+        if (!asset)
+            return -1;
+        off_t start = 0, size = 0;
+        // -1 when the asset is compressed in the apk
+        int fd = AAsset_openFileDescriptor(asset, &start, &size);
+        AAsset_close(asset);
+        *offset = start;
+        *length = size;
+        return fd;
+    }
+
+    AudioDecoder::Result decodeWithMediaCodec(const std::string& fullPath, float maxSeconds,
+                                              std::vector<int16_t>* samples, int* channels, int* rate)
+    {
+        const MediaAPI& api = getMediaAPI();
+        if (!api.available)
+            return AudioDecoder::Result::FAILED;
+
+        off64_t offset = 0, length = 0;
+        int fd = openAudioFile(fullPath, &offset, &length);
+        if (fd < 0)
+            return AudioDecoder::Result::FAILED;
+
+        AMediaExtractor* extractor = api.extractorNew();
+        int status = api.extractorSetDataSourceFd(extractor, fd, offset, length);
+        close(fd);
+        if (status != AMEDIA_OK)
+        {
+            api.extractorDelete(extractor);
+            return AudioDecoder::Result::FAILED;
+        }
+
+        AMediaCodec* codec = nullptr;
+        AudioDecoder::Result result = AudioDecoder::Result::FAILED;
+        for (size_t i = 0; i < api.extractorGetTrackCount(extractor) && !codec; ++i)
+        {
+            AMediaFormat* format = api.extractorGetTrackFormat(extractor, i);
+            const char* mime = nullptr;
+            int64_t durationUs = 0;
+            if (api.formatGetString(format, "mime", &mime) && strncmp(mime, "audio/", 6) == 0)
+            {
+                if (api.formatGetInt64(format, "durationUs", &durationUs) && durationUs > maxSeconds * 1000000)
+                {
+                    result = AudioDecoder::Result::TOO_LONG;
+                }
+                else
+                {
+                    api.formatGetInt32(format, "channel-count", channels);
+                    api.formatGetInt32(format, "sample-rate", rate);
+                    api.extractorSelectTrack(extractor, i);
+                    codec = api.codecCreateDecoderByType(mime);
+                    if (codec && (api.codecConfigure(codec, format, nullptr, nullptr, 0) != AMEDIA_OK || api.codecStart(codec) != AMEDIA_OK))
+                    {
+                        api.codecDelete(codec);
+                        codec = nullptr;
+                    }
+                }
+            }
+            api.formatDelete(format);
+            if (result == AudioDecoder::Result::TOO_LONG)
+                break;
+        }
+
+        if (codec)
+        {
+            bool inputDone = false;
+            bool outputDone = false;
+            bool failed = false;
+            bool tooLong = false;
+            // the dequeues that timed out in a row once the input is done, a broken file may never end
+            int idle = 0;
+            size_t maxSamples = (size_t)(maxSeconds * *rate * *channels);
+            while (!outputDone && !failed)
+            {
+                if (!inputDone)
+                {
+                    ssize_t index = api.codecDequeueInputBuffer(codec, DEQUEUE_TIMEOUT_US);
+                    if (index >= 0)
+                    {
+                        size_t capacity = 0;
+                        uint8_t* buffer = api.codecGetInputBuffer(codec, index, &capacity);
+                        ssize_t size = api.extractorReadSampleData(extractor, buffer, capacity);
+                        if (size < 0)
+                        {
+                            api.codecQueueInputBuffer(codec, index, 0, 0, 0, AMEDIACODEC_BUFFER_FLAG_END_OF_STREAM);
+                            inputDone = true;
+                        }
+                        else
+                        {
+                            api.codecQueueInputBuffer(codec, index, 0, size, api.extractorGetSampleTime(extractor), 0);
+                            api.extractorAdvance(extractor);
+                        }
+                    }
+                }
+
+                AMediaCodecBufferInfo info;
+                ssize_t index = api.codecDequeueOutputBuffer(codec, &info, DEQUEUE_TIMEOUT_US);
+                if (index >= 0)
+                {
+                    size_t capacity = 0;
+                    uint8_t* buffer = api.codecGetOutputBuffer(codec, index, &capacity);
+                    if (buffer && info.size > 0)
+                    {
+                        auto begin = reinterpret_cast<const int16_t*>(buffer + info.offset);
+                        samples->insert(samples->end(), begin, begin + info.size / sizeof(int16_t));
+                    }
+                    api.codecReleaseOutputBuffer(codec, index, false);
+                    outputDone = (info.flags & AMEDIACODEC_BUFFER_FLAG_END_OF_STREAM) != 0;
+                    // the duration of the track was missing or wrong
+                    if (samples->size() > maxSamples)
+                    {
+                        tooLong = true;
+                        failed = true;
+                    }
+                }
+                else if (index == AMEDIACODEC_INFO_OUTPUT_FORMAT_CHANGED)
+                {
+                    AMediaFormat* format = api.codecGetOutputFormat(codec);
+                    api.formatGetInt32(format, "channel-count", channels);
+                    api.formatGetInt32(format, "sample-rate", rate);
+                    api.formatDelete(format);
+                }
+                else if (inputDone && ++idle > 200)
+                {
+                    failed = true;
+                }
+                if (index >= 0)
+                {
+                    idle = 0;
+                }
+            }
+            api.codecStop(codec);
+            api.codecDelete(codec);
+            result = tooLong ? AudioDecoder::Result::TOO_LONG : failed ? AudioDecoder::Result::FAILED : AudioDecoder::Result::OK;
+        }
+        api.extractorDelete(extractor);
+        return result;
+    }
+}
+
+AudioDecoder::Result AudioDecoder::decode(const std::string& fullPath, int sampleRate, float maxSeconds, std::shared_ptr<PcmData>* pcm)
+{
+    std::vector<int16_t> samples;
+    int channels = 0;
+    int rate = 0;
+
+    Result result = Result::FAILED;
+    if (FileUtils::getInstance()->getFileExtension(fullPath) == ".wav"
+        && readWav(FileUtils::getInstance()->getDataFromFile(fullPath), &samples, &channels, &rate))
+    {
+        result = samples.size() > maxSeconds * rate * channels ? Result::TOO_LONG : Result::OK;
+    }
+    else
+    {
+        samples.clear();
+        result = decodeWithMediaCodec(fullPath, maxSeconds, &samples, &channels, &rate);
+    }
+
+    if (result == Result::OK)
+    {
+        if (channels <= 0 || rate <= 0)
+            return Result::FAILED;
+        *pcm = toMixerFormat(samples.data(), (int)(samples.size() / channels), channels, rate, sampleRate);
+    }
+    return result;
+}
+
+#endif
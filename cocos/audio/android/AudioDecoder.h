@@ -0,0 +1,61 @@
+/****************************************************************************
+ Copyright (c) 2014-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#include "platform/CCPlatformConfig.h"
+#if CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID
+
+#ifndef __AUDIO_DECODER_ANDROID_H_
+#define __AUDIO_DECODER_ANDROID_H_
+
+#include <memory>
+#include <string>
+#include "AudioMixer.h"
+
+NS_CC_BEGIN
+    namespace experimental{
+
+/**
+ Decodes a sound into the PcmData the AudioMixer plays. The WAV files are converted as they are, the other
+ formats are decoded with the NDK MediaCodec (Android 5), looked up at runtime. It runs on the loading threads.
+ */
+class AudioDecoder
+{
+public:
+    enum class Result
+    {
+        OK,
+        /** Longer than the limit, it's streamed by an OpenSL player instead. */
+        TOO_LONG,
+        FAILED
+    };
+
+    /** Decodes `fullPath` to 16 bits stereo at `sampleRate`, the sounds longer than `maxSeconds` aren't decoded. */
+    static Result decode(const std::string& fullPath, int sampleRate, float maxSeconds, std::shared_ptr<PcmData>* pcm);
+};
+
+}
+NS_CC_END
+
+#endif // __AUDIO_DECODER_ANDROID_H_
+
+#endif
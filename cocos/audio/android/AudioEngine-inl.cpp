@@ -36,6 +36,7 @@
 #include <jni.h>
 #include "audio/include/AudioEngine.h"
 #include "base/CCDirector.h"
+#include "base/CCJobSystem.h"
 #include "base/CCScheduler.h"
 #include "platform/android/CCFileUtils-android.h"
 
@@ -43,6 +44,8 @@ using namespace cocos2d;
 using namespace cocos2d::experimental;
 
 #define DELAY_TIME_TO_REMOVE 0.5f
+// the longer sounds are streamed by an AudioPlayer, 15 seconds are 2.6 MB of PCM at 44.1 kHz
+#define MIXER_MAX_SECONDS 15.0f
 
 void PlayOverEvent(SLPlayItf caller, void* context, SLuint32 playEvent)
 {
@@ -184,10 +187,12 @@ bool AudioPlayer::init(SLEngineItf engineEngine, SLObjectItf outputMixObject,con
 
 //====================================================
 AudioEngineImpl::AudioEngineImpl()
-    : currentAudioID(0)
-    , _engineObject(nullptr)
+    : _engineObject(nullptr)
     , _engineEngine(nullptr)
     , _outputMixObject(nullptr)
+    , _mixer(nullptr)
+    , _useCount(0)
+    , _alive(std::make_shared<bool>(true))
     , _lazyInitLoop(true)
 {
 
@@ -195,6 +200,11 @@ AudioEngineImpl::AudioEngineImpl()
 
 AudioEngineImpl::~AudioEngineImpl()
 {
+    *_alive = false;
+    // stops its callbacks before the output mix goes away
+    delete _mixer;
+    _mixer = nullptr;
+
     if (_outputMixObject)
     {
         (*_outputMixObject)->Destroy(_outputMixObject);
@@ -231,51 +241,196 @@ bool AudioEngineImpl::init()
         result = (*_outputMixObject)->Realize(_outputMixObject, SL_BOOLEAN_FALSE);
         if(SL_RESULT_SUCCESS != result){ ERRORLOG("realize the output mix fail"); break; }
 
+        _mixer = new (std::nothrow) AudioMixer();
+        if (_mixer && !_mixer->init(_engineEngine, _outputMixObject))
+        {
+            log("AudioEngineImpl: no output for the mixer, the sounds are played by OpenSL players");
+            delete _mixer;
+            _mixer = nullptr;
+        }
+
         ret = true;
     }while (false);
 
     return ret;
 }
 
-int AudioEngineImpl::play2d(const std::string &filePath ,bool loop ,float volume)
+int AudioEngineImpl::play2d(const std::string &filePath ,bool loop ,float volume, int audioID)
 {
-    auto audioId = AudioEngine::INVALID_AUDIO_ID;
+    if (_engineEngine == nullptr)
+        return AudioEngine::INVALID_AUDIO_ID;
 
-    do
+    auto fullPath = FileUtils::getInstance()->fullPathForFilename(filePath);
+    if (_mixer)
     {
-        if (_engineEngine == nullptr)
-            break;
-
-        auto& player = _audioPlayers[currentAudioID];
-        auto fullPath = FileUtils::getInstance()->fullPathForFilename(filePath);
-        auto initPlayer = player.init(_engineEngine, _outputMixObject, fullPath, volume, loop);
-        if (!initPlayer){
-            _audioPlayers.erase(currentAudioID);
-            log("%s,%d message:create player for %s fail", __func__, __LINE__, filePath.c_str());
-            break;
+        auto& cache = loadPcm(fullPath);
+        if (cache.loading || cache.result == AudioDecoder::Result::OK)
+        {
+            cache.lastUse = ++_useCount;
+
+            auto& voice = _mixerVoices[audioID];
+            voice.fullPath = fullPath;
+            voice.volume = volume;
+            voice.loop = loop;
+            voice.paused = false;
+            voice.started = !cache.loading;
+            voice.finishCallback = nullptr;
+
+            // a track of the mixer, no player is created
+            if (voice.started)
+            {
+                _mixer->play(audioID, cache.pcm, volume, loop);
+                auto audioInfo = AudioEngine::getVoiceInfo(audioID);
+                if (audioInfo) {
+                    audioInfo->state = AudioEngine::AudioState::PLAYING;
+                }
+            }
+            scheduleUpdate();
+            return audioID;
         }
+    }
 
-        audioId = currentAudioID++;
-        player._audioID = audioId;
+    if (!playWithPlayer(fullPath, loop, volume, audioID))
+        return AudioEngine::INVALID_AUDIO_ID;
+    return audioID;
+}
 
-        (*(player._fdPlayerPlay))->RegisterCallback(player._fdPlayerPlay, PlayOverEvent, (void*)&player);
-        (*(player._fdPlayerPlay))->SetCallbackEventsMask(player._fdPlayerPlay, SL_PLAYEVENT_HEADATEND);
+bool AudioEngineImpl::playWithPlayer(const std::string& fullPath, bool loop, float volume, int audioID)
+{
+    auto& player = _audioPlayers[audioID];
+    auto initPlayer = player.init(_engineEngine, _outputMixObject, fullPath, volume, loop);
+    if (!initPlayer){
+        _audioPlayers.erase(audioID);
+        log("%s,%d message:create player for %s fail", __func__, __LINE__, fullPath.c_str());
+        return false;
+    }
 
-        AudioEngine::_audioIDInfoMap[audioId].state = AudioEngine::AudioState::PLAYING;
+    player._audioID = audioID;
 
-        if (_lazyInitLoop) {
-            _lazyInitLoop = false;
+    (*(player._fdPlayerPlay))->RegisterCallback(player._fdPlayerPlay, PlayOverEvent, (void*)&player);
+    (*(player._fdPlayerPlay))->SetCallbackEventsMask(player._fdPlayerPlay, SL_PLAYEVENT_HEADATEND);
 
-            auto scheduler = Director::getInstance()->getScheduler();
-            scheduler->schedule(schedule_selector(AudioEngineImpl::update), this, 0.03f, false);
+    auto audioInfo = AudioEngine::getVoiceInfo(audioID);
+    if (audioInfo) {
+        audioInfo->state = AudioEngine::AudioState::PLAYING;
+    }
+
+    scheduleUpdate();
+    return true;
+}
+
+void AudioEngineImpl::scheduleUpdate()
+{
+    if (_lazyInitLoop) {
+        _lazyInitLoop = false;
+
+        auto scheduler = Director::getInstance()->getScheduler();
+        scheduler->schedule(schedule_selector(AudioEngineImpl::update), this, 0.03f, false);
+    }
+}
+
+AudioEngineImpl::PcmCache& AudioEngineImpl::loadPcm(const std::string& fullPath)
+{
+    auto it = _pcmCaches.find(fullPath);
+    if (it != _pcmCaches.end())
+        return it->second;
+
+    auto& cache = _pcmCaches[fullPath];
+    cache.loading = true;
+    cache.result = AudioDecoder::Result::FAILED;
+    cache.lastUse = ++_useCount;
+
+    auto alive = _alive;
+    int sampleRate = _mixer->getSampleRate();
+    JobSystem::getInstance()->run([this, alive, fullPath, sampleRate]() {
+        std::shared_ptr<PcmData> pcm;
+        auto result = AudioDecoder::decode(fullPath, sampleRate, MIXER_MAX_SECONDS, &pcm);
+        Director::getInstance()->getScheduler()->performFunctionInCocosThread([this, alive, fullPath, result, pcm]() {
+            if (*alive) {
+                onPcmLoaded(fullPath, result, pcm);
+            }
+        });
+    });
+    return cache;
+}
+
+void AudioEngineImpl::onPcmLoaded(const std::string& fullPath, AudioDecoder::Result result, const std::shared_ptr<PcmData>& pcm)
+{
+    auto it = _pcmCaches.find(fullPath);
+    if (it == _pcmCaches.end())
+        return;
+
+    auto& cache = it->second;
+    cache.loading = false;
+    cache.result = result;
+    cache.pcm = pcm;
+    auto callbacks = std::move(cache.callbacks);
+    cache.callbacks.clear();
+
+    // the voices that waited for it
+    std::vector<int> waiting;
+    for (auto& voice : _mixerVoices) {
+        if (!voice.second.started && voice.second.fullPath == fullPath) {
+            waiting.push_back(voice.first);
         }
-    } while (0);
+    }
+    for (auto audioID : waiting) {
+        auto voice = _mixerVoices[audioID];
+        if (result == AudioDecoder::Result::OK) {
+            _mixerVoices[audioID].started = true;
+            _mixer->play(audioID, pcm, voice.volume, voice.loop);
+            _mixer->setPaused(audioID, voice.paused);
+            auto audioInfo = AudioEngine::getVoiceInfo(audioID);
+            if (audioInfo) {
+                audioInfo->state = voice.paused ? AudioEngine::AudioState::PAUSED : AudioEngine::AudioState::PLAYING;
+            }
+            continue;
+        }
+
+        // too long or not decodable, an OpenSL player streams it
+        _mixerVoices.erase(audioID);
+        if (playWithPlayer(fullPath, voice.loop, voice.volume, audioID)) {
+            _audioPlayers[audioID]._finishCallback = voice.finishCallback;
+            if (voice.paused) {
+                pause(audioID);
+            }
+        }
+        else {
+            AudioEngine::remove(audioID);
+        }
+    }
 
-    return audioId;
+    for (auto& callback : callbacks) {
+        callback(result != AudioDecoder::Result::FAILED);
+    }
+    trimCaches();
 }
 
 void AudioEngineImpl::update(float dt)
 {
+    if (_mixer) {
+        _mixer->restartIfDisconnected();
+
+        std::vector<int> finished;
+        _mixer->takeFinishedTracks(&finished);
+        for (auto audioID : finished) {
+            auto it = _mixerVoices.find(audioID);
+            if (it == _mixerVoices.end()) {
+                continue;
+            }
+            auto finishCallback = it->second.finishCallback;
+            _mixerVoices.erase(it);
+
+            auto audioInfo = AudioEngine::getVoiceInfo(audioID);
+            if (finishCallback && audioInfo)
+                finishCallback(audioID, *audioInfo->filePath);
+            AudioEngine::remove(audioID);
+        }
+        if (!finished.empty()) {
+            trimCaches();
+        }
+    }
+
     AudioPlayer* player = nullptr;
 
     auto itend = _audioPlayers.end();
@@ -293,8 +448,9 @@ void AudioEngineImpl::update(float dt)
         }
         else if (player->_playOver)
         {
-            if (player->_finishCallback)
-                player->_finishCallback(player->_audioID, *AudioEngine::_audioIDInfoMap[player->_audioID].filePath);
+            auto audioInfo = AudioEngine::getVoiceInfo(player->_audioID);
+            if (player->_finishCallback && audioInfo)
+                player->_finishCallback(player->_audioID, *audioInfo->filePath);
 
             AudioEngine::remove(player->_audioID);
             iter = _audioPlayers.erase(iter);
@@ -304,7 +460,7 @@ void AudioEngineImpl::update(float dt)
         ++iter;
     }
 
-    if(_audioPlayers.empty()){
+    if(_audioPlayers.empty() && _mixerVoices.empty()){
         _lazyInitLoop = true;
 
         auto scheduler = Director::getInstance()->getScheduler();
@@ -314,6 +470,13 @@ void AudioEngineImpl::update(float dt)
 
 void AudioEngineImpl::setVolume(int audioID,float volume)
 {
+    auto voice = _mixerVoices.find(audioID);
+    if (voice != _mixerVoices.end()) {
+        voice->second.volume = volume;
+        _mixer->setVolume(audioID, volume);
+        return;
+    }
+
     auto& player = _audioPlayers[audioID];
     int dbVolume = 2000 * log10(volume);
     if(dbVolume < SL_MILLIBEL_MIN){
@@ -327,6 +490,13 @@ void AudioEngineImpl::setVolume(int audioID,float volume)
 
 void AudioEngineImpl::setLoop(int audioID, bool loop)
 {
+    auto voice = _mixerVoices.find(audioID);
+    if (voice != _mixerVoices.end()) {
+        voice->second.loop = loop;
+        _mixer->setLoop(audioID, loop);
+        return;
+    }
+
     auto& player = _audioPlayers[audioID];
     player._loop = loop;
     SLboolean loopEnabled = SL_BOOLEAN_TRUE;
@@ -338,6 +508,13 @@ void AudioEngineImpl::setLoop(int audioID, bool loop)
 
 void AudioEngineImpl::pause(int audioID)
 {
+    auto voice = _mixerVoices.find(audioID);
+    if (voice != _mixerVoices.end()) {
+        voice->second.paused = true;
+        _mixer->setPaused(audioID, true);
+        return;
+    }
+
     auto& player = _audioPlayers[audioID];
     auto result = (*player._fdPlayerPlay)->SetPlayState(player._fdPlayerPlay, SL_PLAYSTATE_PAUSED);
     if(SL_RESULT_SUCCESS != result){
@@ -347,6 +524,13 @@ void AudioEngineImpl::pause(int audioID)
 
 void AudioEngineImpl::resume(int audioID)
 {
+    auto voice = _mixerVoices.find(audioID);
+    if (voice != _mixerVoices.end()) {
+        voice->second.paused = false;
+        _mixer->setPaused(audioID, false);
+        return;
+    }
+
     auto& player = _audioPlayers[audioID];
     auto result = (*player._fdPlayerPlay)->SetPlayState(player._fdPlayerPlay, SL_PLAYSTATE_PLAYING);
     if(SL_RESULT_SUCCESS != result){
@@ -356,6 +540,14 @@ void AudioEngineImpl::resume(int audioID)
 
 void AudioEngineImpl::stop(int audioID)
 {
+    auto voice = _mixerVoices.find(audioID);
+    if (voice != _mixerVoices.end()) {
+        // a track has no OpenSL object, it's removed right away
+        _mixer->stop(audioID);
+        _mixerVoices.erase(voice);
+        return;
+    }
+
     auto& player = _audioPlayers[audioID];
     auto result = (*player._fdPlayerPlay)->SetPlayState(player._fdPlayerPlay, SL_PLAYSTATE_STOPPED);
     if(SL_RESULT_SUCCESS != result){
@@ -373,6 +565,11 @@ void AudioEngineImpl::stop(int audioID)
 
 void AudioEngineImpl::stopAll()
 {
+    if (_mixer) {
+        _mixer->stopAll();
+    }
+    _mixerVoices.clear();
+
     auto itEnd = _audioPlayers.end();
     for (auto it = _audioPlayers.begin(); it != itEnd; ++it)
     {
@@ -387,6 +584,15 @@ void AudioEngineImpl::stopAll()
 
 float AudioEngineImpl::getDuration(int audioID)
 {
+    auto voice = _mixerVoices.find(audioID);
+    if (voice != _mixerVoices.end()) {
+        auto cache = _pcmCaches.find(voice->second.fullPath);
+        if (!voice->second.started || cache == _pcmCaches.end() || !cache->second.pcm) {
+            return AudioEngine::TIME_UNKNOWN;
+        }
+        return (float)cache->second.pcm->frames / _mixer->getSampleRate();
+    }
+
     SLmillisecond duration;
     auto& player = _audioPlayers[audioID];
     auto result = (*player._fdPlayerPlay)->GetDuration(player._fdPlayerPlay, &duration);
@@ -407,6 +613,10 @@ float AudioEngineImpl::getDuration(int audioID)
 
 float AudioEngineImpl::getCurrentTime(int audioID)
 {
+    if (_mixerVoices.find(audioID) != _mixerVoices.end()) {
+        return _mixer->getCurrentTime(audioID);
+    }
+
     SLmillisecond currPos;
     auto& player = _audioPlayers[audioID];
     (*player._fdPlayerPlay)->GetPosition(player._fdPlayerPlay, &currPos);
@@ -415,6 +625,11 @@ float AudioEngineImpl::getCurrentTime(int audioID)
 
 bool AudioEngineImpl::setCurrentTime(int audioID, float time)
 {
+    auto voice = _mixerVoices.find(audioID);
+    if (voice != _mixerVoices.end()) {
+        return voice->second.started && _mixer->setCurrentTime(audioID, time);
+    }
+
     auto& player = _audioPlayers[audioID];
     SLmillisecond pos = 1000 * time;
     auto result = (*player._fdPlayerSeek)->SetPosition(player._fdPlayerSeek, pos, SL_SEEKMODE_ACCURATE);
@@ -426,15 +641,89 @@ bool AudioEngineImpl::setCurrentTime(int audioID, float time)
 
 void AudioEngineImpl::setFinishCallback(int audioID, const std::function<void (int, const std::string &)> &callback)
 {
+    auto voice = _mixerVoices.find(audioID);
+    if (voice != _mixerVoices.end()) {
+        voice->second.finishCallback = callback;
+        return;
+    }
     _audioPlayers[audioID]._finishCallback = callback;
 }
 
 void AudioEngineImpl::preload(const std::string& filePath, std::function<void(bool)> callback)
 {
-    CCLOG("Preload not support on Anroid");
-    if (callback)
+    if (!_mixer)
     {
-        callback(false);
+        // the players open their files when they play
+        if (callback)
+        {
+            callback(false);
+        }
+        return;
+    }
+
+    auto& cache = loadPcm(FileUtils::getInstance()->fullPathForFilename(filePath));
+    if (cache.loading)
+    {
+        if (callback)
+        {
+            cache.callbacks.push_back(callback);
+        }
+    }
+    else if (callback)
+    {
+        callback(cache.result != AudioDecoder::Result::FAILED);
+    }
+}
+
+void AudioEngineImpl::uncache(const std::string& filePath)
+{
+    // the tracks keep their PcmData, a loading cache is kept for its voices
+    auto it = _pcmCaches.find(FileUtils::getInstance()->fullPathForFilename(filePath));
+    if (it != _pcmCaches.end() && !it->second.loading)
+    {
+        _pcmCaches.erase(it);
+    }
+}
+
+void AudioEngineImpl::uncacheAll()
+{
+    for (auto it = _pcmCaches.begin(); it != _pcmCaches.end(); )
+    {
+        if (it->second.loading)
+            ++it;
+        else
+            it = _pcmCaches.erase(it);
+    }
+}
+
+void AudioEngineImpl::trimCaches()
+{
+    const size_t budget = AudioEngine::getCacheBudget();
+    if (budget == 0) {
+        return;
+    }
+
+    size_t total = 0;
+    for (auto&& cache : _pcmCaches) {
+        total += cache.second.pcm ? cache.second.pcm->getMemorySize() : 0;
+    }
+
+    while (total > budget) {
+        // the least recently used cache no track plays, the tracks hold the other references
+        auto victim = _pcmCaches.end();
+        for (auto it = _pcmCaches.begin(); it != _pcmCaches.end(); ++it) {
+            if (!it->second.pcm || it->second.pcm.use_count() > 1) {
+                continue;
+            }
+            if (victim == _pcmCaches.end() || it->second.lastUse < victim->second.lastUse) {
+                victim = it;
+            }
+        }
+        if (victim == _pcmCaches.end()) {
+            break;
+        }
+        total -= victim->second.pcm->getMemorySize();
+        _pcmCaches.erase(victim);
     }
 }
 
@@ -28,10 +28,14 @@
 
 #include <SLES/OpenSLES.h>
 #include <SLES/OpenSLES_Android.h>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include "base/CCRef.h"
 #include "base/ccUtils.h"
+#include "AudioDecoder.h"
+#include "AudioMixer.h"
 
 #define MAX_AUDIOINSTANCES 24
 
@@ -74,7 +78,8 @@ public:
     ~AudioEngineImpl();
 
     bool init();
-    int play2d(const std::string &fileFullPath ,bool loop ,float volume);
+    /** Plays the file with the voice `audioID`, given by AudioEngine. */
+    int play2d(const std::string &fileFullPath ,bool loop ,float volume, int audioID);
     void setVolume(int audioID,float volume);
     void setLoop(int audioID, bool loop);
     void pause(int audioID);
@@ -86,12 +91,40 @@ public:
     bool setCurrentTime(int audioID, float time);
     void setFinishCallback(int audioID, const std::function<void (int, const std::string &)> &callback);
 
-    void uncache(const std::string& filePath){}
-    void uncacheAll(){}
+    void uncache(const std::string& filePath);
+    void uncacheAll();
     void preload(const std::string& filePath, std::function<void(bool)> callback);
+    /** Releases the least recently used PCM caches that no track plays until they fit AudioEngine::getCacheBudget(). */
+    void trimCaches();
 
     void update(float dt);
 private:
+    // a sound decoded for the mixer
+    struct PcmCache
+    {
+        std::shared_ptr<const PcmData> pcm;
+        bool loading;
+        // TOO_LONG and FAILED are played by an AudioPlayer
+        AudioDecoder::Result result;
+        unsigned int lastUse;
+        std::vector<std::function<void(bool)>> callbacks;
+    };
+
+    // a voice played by the mixer, it waits for its PcmCache while that loads
+    struct MixerVoice
+    {
+        std::string fullPath;
+        float volume;
+        bool loop;
+        bool paused;
+        bool started;
+        std::function<void (int, const std::string &)> finishCallback;
+    };
+
+    bool playWithPlayer(const std::string& fullPath, bool loop, float volume, int audioID);
+    PcmCache& loadPcm(const std::string& fullPath);
+    void onPcmLoaded(const std::string& fullPath, AudioDecoder::Result result, const std::shared_ptr<PcmData>& pcm);
+    void scheduleUpdate();
 
     // engine interfaces
     SLObjectItf _engineObject;
@@ -103,7 +136,15 @@ private:
     //audioID,AudioInfo
     std::unordered_map<int, AudioPlayer>  _audioPlayers;
 
-    int currentAudioID;
+    // nullptr when the device has no output for it, every voice has an AudioPlayer then
+    AudioMixer* _mixer;
+    //fullPath,PcmCache
+    std::unordered_map<std::string, PcmCache> _pcmCaches;
+    //audioID,MixerVoice
+    std::unordered_map<int, MixerVoice> _mixerVoices;
+    unsigned int _useCount;
+    // false once the engine is destroyed, the decodes that still run check it
+    std::shared_ptr<bool> _alive;
 
     bool _lazyInitLoop;
 };
@@ -0,0 +1,449 @@
+/****************************************************************************
+ Copyright (c) 2014-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#include "platform/CCPlatformConfig.h"
+#if CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID
+
+#include "AudioMixer.h"
+
+#include <dlfcn.h>
+#include <string.h>
+#include <algorithm>
+#include "base/CCConsole.h"
+#include "platform/android/jni/JniHelper.h"
+
+using namespace cocos2d;
+using namespace cocos2d::experimental;
+
+namespace
+{
+    // <aaudio/AAudio.h>, in libaaudio from API level 26, looked up at runtime
+    typedef struct AAudioStreamBuilderStruct AAudioStreamBuilder;
+    typedef struct AAudioStreamStruct AAudioStream;
+    typedef int32_t (*AAudioDataCallback)(AAudioStream* stream, void* userData, void* audioData, int32_t numFrames);
+    typedef void (*AAudioErrorCallback)(AAudioStream* stream, void* userData, int32_t error);
+
+    const int32_t AAUDIO_OK = 0;
+    const int32_t AAUDIO_FORMAT_PCM_I16 = 1;
+    const int32_t AAUDIO_PERFORMANCE_MODE_LOW_LATENCY = 12;
+    const int32_t AAUDIO_CALLBACK_RESULT_CONTINUE = 0;
+
+    struct AAudioAPI
+    {
+        int32_t (*createStreamBuilder)(AAudioStreamBuilder** builder);
+        void (*setPerformanceMode)(AAudioStreamBuilder* builder, int32_t mode);
+        void (*setFormat)(AAudioStreamBuilder* builder, int32_t format);
+        void (*setChannelCount)(AAudioStreamBuilder* builder, int32_t channelCount);
+        void (*setDataCallback)(AAudioStreamBuilder* builder, AAudioDataCallback callback, void* userData);
+        void (*setErrorCallback)(AAudioStreamBuilder* builder, AAudioErrorCallback callback, void* userData);
+        int32_t (*openStream)(AAudioStreamBuilder* builder, AAudioStream** stream);
+        int32_t (*deleteBuilder)(AAudioStreamBuilder* builder);
+        int32_t (*getSampleRate)(AAudioStream* stream);
+        int32_t (*getFramesPerBurst)(AAudioStream* stream);
+        int32_t (*setBufferSizeInFrames)(AAudioStream* stream, int32_t frames);
+        int32_t (*requestStart)(AAudioStream* stream);
+        int32_t (*requestStop)(AAudioStream* stream);
+        int32_t (*close)(AAudioStream* stream);
+        bool available;
+    };
+
+    AAudioAPI loadAAudioAPI()
+    {
+        AAudioAPI api = {};
+        void* lib = dlopen("libaaudio.so", RTLD_NOW | RTLD_LOCAL);
+        if (!lib)
+            return api;
+
+        api.createStreamBuilder = (int32_t (*)(AAudioStreamBuilder**))dlsym(lib, "AAudio_createStreamBuilder");
+        api.setPerformanceMode = (void (*)(AAudioStreamBuilder*, int32_t))dlsym(lib, "AAudioStreamBuilder_setPerformanceMode");
+        api.setFormat = (void (*)(AAudioStreamBuilder*, int32_t))dlsym(lib, "AAudioStreamBuilder_setFormat");
+        api.setChannelCount = (void (*)(AAudioStreamBuilder*, int32_t))dlsym(lib, "AAudioStreamBuilder_setChannelCount");
+        api.setDataCallback = (void (*)(AAudioStreamBuilder*, AAudioDataCallback, void*))dlsym(lib, "AAudioStreamBuilder_setDataCallback");
+        api.setErrorCallback = (void (*)(AAudioStreamBuilder*, AAudioErrorCallback, void*))dlsym(lib, "AAudioStreamBuilder_setErrorCallback");
+        api.openStream = (int32_t (*)(AAudioStreamBuilder*, AAudioStream**))dlsym(lib, "AAudioStreamBuilder_openStream");
+        api.deleteBuilder = (int32_t (*)(AAudioStreamBuilder*))dlsym(lib, "AAudioStreamBuilder_delete");
+        api.getSampleRate = (int32_t (*)(AAudioStream*))dlsym(lib, "AAudioStream_getSampleRate");
+        api.getFramesPerBurst = (int32_t (*)(AAudioStream*))dlsym(lib, "AAudioStream_getFramesPerBurst");
+        api.setBufferSizeInFrames = (int32_t (*)(AAudioStream*, int32_t))dlsym(lib, "AAudioStream_setBufferSizeInFrames");
+        api.requestStart = (int32_t (*)(AAudioStream*))dlsym(lib, "AAudioStream_requestStart");
+        api.requestStop = (int32_t (*)(AAudioStream*))dlsym(lib, "AAudioStream_requestStop");
+        api.close = (int32_t (*)(AAudioStream*))dlsym(lib, "AAudioStream_close");
+
+        api.available = api.createStreamBuilder && api.setPerformanceMode && api.setFormat && api.setChannelCount
+            && api.setDataCallback && api.setErrorCallback && api.openStream && api.deleteBuilder && api.getSampleRate
+            && api.getFramesPerBurst && api.setBufferSizeInFrames && api.requestStart && api.requestStop && api.close;
+        return api;
+    }
+
+    const AAudioAPI& getAAudioAPI()
+    {
+        static const AAudioAPI api = loadAAudioAPI();
+        return api;
+    }
+
+    int32_t onAAudioData(AAudioStream* stream, void* userData, void* audioData, int32_t numFrames)
+    {
+        static_cast<AudioMixer*>(userData)->mix(static_cast<int16_t*>(audioData), numFrames);
+        return AAUDIO_CALLBACK_RESULT_CONTINUE;
+    }
+
+    // the gain is Q12
+    const int GAIN_ONE = 4096;
+
+    int toGain(float volume)
+    {
+        return (int)(std::max(0.0f, std::min(volume, 1.0f)) * GAIN_ONE + 0.5f);
+    }
+}
+
+AudioMixer::AudioMixer()
+    : _sampleRate(0)
+    , _framesPerBurst(0)
+    , _aaudioStream(nullptr)
+    , _disconnected(false)
+    , _playerObject(nullptr)
+    , _bufferQueue(nullptr)
+    , _nextBuffer(0)
+{
+}
+
+AudioMixer::~AudioMixer()
+{
+    closeAAudio();
+    if (_playerObject)
+    {
+        (*_playerObject)->Destroy(_playerObject);
+        _playerObject = nullptr;
+    }
+}
+
+bool AudioMixer::init(SLEngineItf engineEngine, SLObjectItf outputMixObject)
+{
+    if (openAAudio())
+    {
+        log("AudioMixer: AAudio at %d Hz, bursts of %d frames", _sampleRate, _framesPerBurst);
+        return true;
+    }
+    if (openOpenSLES(engineEngine, outputMixObject))
+    {
+        log("AudioMixer: OpenSL ES at %d Hz, buffers of %d frames", _sampleRate, _framesPerBurst);
+        return true;
+    }
+    return false;
+}
+
+bool AudioMixer::openAAudio()
+{
+    const AAudioAPI& api = getAAudioAPI();
+    if (!api.available)
+        return false;
+
+    AAudioStreamBuilder* builder = nullptr;
+    if (api.createStreamBuilder(&builder) != AAUDIO_OK)
+        return false;
+
+    // the sample rate isn't set, the stream runs at the one of the device
+    api.setPerformanceMode(builder, AAUDIO_PERFORMANCE_MODE_LOW_LATENCY);
+    api.setFormat(builder, AAUDIO_FORMAT_PCM_I16);
+    api.setChannelCount(builder, 2);
+    api.setDataCallback(builder, onAAudioData, this);
+    api.setErrorCallback(builder, [](AAudioStream*, void* userData, int32_t) {
+        // the stream can't be closed in its callback, restartIfDisconnected() reopens it
+        static_cast<AudioMixer*>(userData)->_disconnected = true;
+    }, this);
+
+    AAudioStream* stream = nullptr;
+    int32_t result = api.openStream(builder, &stream);
+    api.deleteBuilder(builder);
+    if (result != AAUDIO_OK)
+        return false;
+
+    int sampleRate = api.getSampleRate(stream);
+    // a new device may have another sample rate, the caches would have to be decoded again
+    if (_sampleRate != 0 && sampleRate != _sampleRate)
+    {
+        api.close(stream);
+        return false;
+    }
+
+    _sampleRate = sampleRate;
+    _framesPerBurst = api.getFramesPerBurst(stream);
+    // two bursts, the least that doesn't glitch
+    api.setBufferSizeInFrames(stream, _framesPerBurst * 2);
+    _aaudioStream = stream;
+
+    if (api.requestStart(stream) != AAUDIO_OK)
+    {
+        closeAAudio();
+        return false;
+    }
+    return true;
+}
+
+void AudioMixer::closeAAudio()
+{
+    if (_aaudioStream)
+    {
+        const AAudioAPI& api = getAAudioAPI();
+        auto stream = static_cast<AAudioStream*>(_aaudioStream);
+        api.requestStop(stream);
+        api.close(stream);
+        _aaudioStream = nullptr;
+    }
+}
+
+void AudioMixer::restartIfDisconnected()
+{
+    if (_disconnected.exchange(false) && _aaudioStream)
+    {
+        closeAAudio();
+        if (!openAAudio())
+        {
+            log("AudioMixer: can't reopen the AAudio stream");
+        }
+    }
+}
+
+bool AudioMixer::openOpenSLES(SLEngineItf engineEngine, SLObjectItf outputMixObject)
+{
+    // the native rate and buffer size of the output, asked once, the fast mixer of the device takes them as they are
+    _sampleRate = JniHelper::callStaticIntMethod("org/cocos2dx/lib/Cocos2dxHelper", "getAudioOutputSampleRate");
+    _framesPerBurst = JniHelper::callStaticIntMethod("org/cocos2dx/lib/Cocos2dxHelper", "getAudioOutputFramesPerBuffer");
+    if (_sampleRate <= 0)
+        _sampleRate = 44100;
+    if (_framesPerBurst <= 0)
+        _framesPerBurst = 256;
+
+    SLDataLocator_AndroidSimpleBufferQueue locBufferQueue = {SL_DATALOCATOR_ANDROIDSIMPLEBUFFERQUEUE, 2};
+    SLDataFormat_PCM formatPcm = {SL_DATAFORMAT_PCM, 2, (SLuint32)_sampleRate * 1000,
+        SL_PCMSAMPLEFORMAT_FIXED_16, SL_PCMSAMPLEFORMAT_FIXED_16,
+        SL_SPEAKER_FRONT_LEFT | SL_SPEAKER_FRONT_RIGHT, SL_BYTEORDER_LITTLEENDIAN};
+    SLDataSource audioSrc = {&locBufferQueue, &formatPcm};
+
+    SLDataLocator_OutputMix locOutmix = {SL_DATALOCATOR_OUTPUTMIX, outputMixObject};
+    SLDataSink audioSnk = {&locOutmix, nullptr};
+
+    const SLInterfaceID ids[1] = {SL_IID_BUFFERQUEUE};
+    const SLboolean req[1] = {SL_BOOLEAN_TRUE};
+    auto result = (*engineEngine)->CreateAudioPlayer(engineEngine, &_playerObject, &audioSrc, &audioSnk, 1, ids, req);
+    if (SL_RESULT_SUCCESS != result)
+    {
+        _playerObject = nullptr;
+        return false;
+    }
+
+    SLPlayItf play = nullptr;
+    if ((*_playerObject)->Realize(_playerObject, SL_BOOLEAN_FALSE) != SL_RESULT_SUCCESS
+        || (*_playerObject)->GetInterface(_playerObject, SL_IID_PLAY, &play) != SL_RESULT_SUCCESS
+        || (*_playerObject)->GetInterface(_playerObject, SL_IID_BUFFERQUEUE, &_bufferQueue) != SL_RESULT_SUCCESS
+        || (*_bufferQueue)->RegisterCallback(_bufferQueue, enqueueOpenSLESBuffer, this) != SL_RESULT_SUCCESS)
+    {
+        (*_playerObject)->Destroy(_playerObject);
+        _playerObject = nullptr;
+        _bufferQueue = nullptr;
+        return false;
+    }
+
+    for (auto& buffer : _buffers)
+    {
+        buffer.resize(_framesPerBurst * 2);
+    }
+    // one buffer plays while the other is mixed
+    enqueueOpenSLESBuffer(_bufferQueue, this);
+    enqueueOpenSLESBuffer(_bufferQueue, this);
+    (*play)->SetPlayState(play, SL_PLAYSTATE_PLAYING);
+    return true;
+}
+
+void AudioMixer::enqueueOpenSLESBuffer(SLAndroidSimpleBufferQueueItf queue, void* context)
+{
+    auto mixer = static_cast<AudioMixer*>(context);
+    auto& buffer = mixer->_buffers[mixer->_nextBuffer];
+    mixer->_nextBuffer ^= 1;
+    mixer->mix(buffer.data(), mixer->_framesPerBurst);
+    (*queue)->Enqueue(queue, buffer.data(), buffer.size() * sizeof(int16_t));
+}
+
+void AudioMixer::mix(int16_t* out, int frames)
+{
+    if ((int)_mixBuffer.size() < frames * 2)
+    {
+        // the bursts keep their size, it only grows once
+        _mixBuffer.resize(frames * 2);
+    }
+    int32_t* acc = _mixBuffer.data();
+    memset(acc, 0, frames * 2 * sizeof(int32_t));
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& track : _tracks)
+        {
+            if (track.paused || track.frame < 0)
+                continue;
+
+            const int16_t* samples = track.pcm->samples.data();
+            int done = 0;
+            while (done < frames && track.frame < track.pcm->frames)
+            {
+                int count = std::min(frames - done, track.pcm->frames - track.frame);
+                const int16_t* in = samples + track.frame * 2;
+                int32_t* dst = acc + done * 2;
+                for (int i = 0; i < count * 2; ++i)
+                {
+                    dst[i] += (in[i] * track.gain) >> 12;
+                }
+                done += count;
+                track.frame += count;
+                if (track.frame >= track.pcm->frames && track.loop)
+                {
+                    track.frame = 0;
+                }
+            }
+
+            if (track.frame >= track.pcm->frames)
+            {
+                // ended, update() of the engine takes it
+                track.frame = -1;
+                _finished.push_back(track.id);
+            }
+        }
+    }
+
+    for (int i = 0; i < frames * 2; ++i)
+    {
+        out[i] = (int16_t)std::max(-32768, std::min(acc[i], 32767));
+    }
+}
+
+AudioMixer::Track* AudioMixer::findTrack(int id)
+{
+    for (auto& track : _tracks)
+    {
+        if (track.id == id)
+            return &track;
+    }
+    return nullptr;
+}
+
+void AudioMixer::play(int id, const std::shared_ptr<const PcmData>& pcm, float volume, bool loop)
+{
+    Track track;
+    track.id = id;
+    track.pcm = pcm;
+    track.frame = 0;
+    track.gain = toGain(volume);
+    track.loop = loop;
+    track.paused = false;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (pcm->frames == 0)
+    {
+        // nothing to loop over, it ends right away
+        track.frame = -1;
+        _finished.push_back(id);
+    }
+    _tracks.push_back(track);
+}
+
+void AudioMixer::setVolume(int id, float volume)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (auto track = findTrack(id))
+        track->gain = toGain(volume);
+}
+
+void AudioMixer::setLoop(int id, bool loop)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (auto track = findTrack(id))
+        track->loop = loop;
+}
+
+void AudioMixer::setPaused(int id, bool paused)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (auto track = findTrack(id))
+        track->paused = paused;
+}
+
+void AudioMixer::stop(int id)
+{
+    // the PcmData may be released here, not on the audio thread
+    std::shared_ptr<const PcmData> pcm;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = std::find_if(_tracks.begin(), _tracks.end(), [id](const Track& track) { return track.id == id; });
+        if (it != _tracks.end())
+        {
+            pcm = std::move(it->pcm);
+            _tracks.erase(it);
+        }
+        _finished.erase(std::remove(_finished.begin(), _finished.end(), id), _finished.end());
+    }
+}
+
+void AudioMixer::stopAll()
+{
+    std::vector<Track> tracks;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        tracks.swap(_tracks);
+        _finished.clear();
+    }
+}
+
+float AudioMixer::getCurrentTime(int id)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto track = findTrack(id);
+    return track && track->frame > 0 ? (float)track->frame / _sampleRate : 0.0f;
+}
+
+bool AudioMixer::setCurrentTime(int id, float time)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto track = findTrack(id);
+    int frame = (int)(time * _sampleRate);
+    if (!track || track->frame < 0 || frame < 0 || frame >= track->pcm->frames)
+        return false;
+    track->frame = frame;
+    return true;
+}
+
+void AudioMixer::takeFinishedTracks(std::vector<int>* ids)
+{
+    std::vector<Track> finished;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_finished.empty())
+            return;
+        ids->insert(ids->end(), _finished.begin(), _finished.end());
+        _finished.clear();
+
+        auto it = std::stable_partition(_tracks.begin(), _tracks.end(), [](const Track& track) { return track.frame >= 0; });
+        finished.assign(std::make_move_iterator(it), std::make_move_iterator(_tracks.end()));
+        _tracks.erase(it, _tracks.end());
+    }
+}
+
+#endif
@@ -0,0 +1,131 @@
+/****************************************************************************
+ Copyright (c) 2014-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#include "platform/CCPlatformConfig.h"
+#if CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID
+
+#ifndef __AUDIO_MIXER_ANDROID_H_
+#define __AUDIO_MIXER_ANDROID_H_
+
+#include <SLES/OpenSLES.h>
+#include <SLES/OpenSLES_Android.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+    namespace experimental{
+
+/** The decoded samples of a sound: 16 bits stereo interleaved, at the sample rate of the AudioMixer. */
+struct PcmData
+{
+    std::vector<int16_t> samples;
+    int frames;
+
+    PcmData() : frames(0) {}
+    size_t getMemorySize() const { return samples.size() * sizeof(int16_t); }
+};
+
+/**
+ Mixes the PcmData of the playing sounds in the callback of the audio output, a native thread: playing a sound
+ adds a track, it neither calls into Java nor creates an OpenSL player.
+
+ The output is an AAudio low latency stream where the device has it (Android 8), an OpenSL ES buffer queue
+ otherwise. Both run at the native sample rate of the device and mix a burst at a time, the size the device asks for.
+ The tracks are changed under a mutex the callback only holds while it mixes a burst.
+ */
+class AudioMixer
+{
+public:
+    AudioMixer();
+    ~AudioMixer();
+
+    /** Opens the output, AAudio first then OpenSL ES through `engineEngine` and `outputMixObject`. */
+    bool init(SLEngineItf engineEngine, SLObjectItf outputMixObject);
+
+    int getSampleRate() const { return _sampleRate; }
+
+    void play(int id, const std::shared_ptr<const PcmData>& pcm, float volume, bool loop);
+    void setVolume(int id, float volume);
+    void setLoop(int id, bool loop);
+    void setPaused(int id, bool paused);
+    void stop(int id);
+    void stopAll();
+    /** In seconds, 0 when the track has ended. */
+    float getCurrentTime(int id);
+    bool setCurrentTime(int id, float time);
+
+    /** Moves the ids of the tracks that played to the end into `ids`. */
+    void takeFinishedTracks(std::vector<int>* ids);
+
+    /** Reopens the AAudio stream after its device went away, e.g. the headphones were unplugged. */
+    void restartIfDisconnected();
+
+    /** Fills `frames` stereo frames of `out`, on the audio thread. */
+    void mix(int16_t* out, int frames);
+
+private:
+    struct Track
+    {
+        int id;
+        std::shared_ptr<const PcmData> pcm;
+        int frame;
+        // Q12, 4096 is full volume
+        int gain;
+        bool loop;
+        bool paused;
+    };
+
+    bool openAAudio();
+    void closeAAudio();
+    bool openOpenSLES(SLEngineItf engineEngine, SLObjectItf outputMixObject);
+    Track* findTrack(int id);
+
+    static void enqueueOpenSLESBuffer(SLAndroidSimpleBufferQueueItf queue, void* context);
+
+    std::mutex _mutex;
+    std::vector<Track> _tracks;
+    std::vector<int> _finished;
+    std::vector<int32_t> _mixBuffer;
+
+    int _sampleRate;
+    int _framesPerBurst;
+
+    // AAudioStream, the functions are looked up at runtime
+    void* _aaudioStream;
+    std::atomic<bool> _disconnected;
+
+    SLObjectItf _playerObject;
+    SLAndroidSimpleBufferQueueItf _bufferQueue;
+    std::vector<int16_t> _buffers[2];
+    int _nextBuffer;
+};
+
+}
+NS_CC_END
+
+#endif // __AUDIO_MIXER_ANDROID_H_
+
+#endif
@@ -40,15 +40,10 @@ using namespace CocosDenshion::android;
 using namespace cocos2d;
 
 AndroidJavaEngine::AndroidJavaEngine()
-    : _implementBaseOnAudioEngine(false)
+    // the effects are tracks of the native mixer of AudioEngine, playing them doesn't go through JNI and SoundPool
+    : _implementBaseOnAudioEngine(true)
     , _effectVolume(1.f)
 {
-    auto sdk_ver = JniHelper::callStaticIntMethod(CLASS_NAME, "getSDKVersion");
-    __android_log_print(ANDROID_LOG_DEBUG, "AndroidJavaEngine", "android build version:%d", sdk_ver);
-    if (sdk_ver == 21 || sdk_ver == 22)
-    {
-        _implementBaseOnAudioEngine = true;
-    }
 }
 
 AndroidJavaEngine::~AndroidJavaEngine()
@@ -251,7 +246,11 @@ void AndroidJavaEngine::stopAllEffects()
 
 void AndroidJavaEngine::preloadEffect(const char* filePath)
 {
-    if (!_implementBaseOnAudioEngine)
+    if (_implementBaseOnAudioEngine)
+    {
+        AudioEngine::preload(filePath);
+    }
+    else
     {
         std::string fullPath = getFullPathWithoutAssetsPrefix(filePath);
         JniHelper::callStaticVoidMethod(CLASS_NAME, "preloadEffect", fullPath);
@@ -260,7 +259,11 @@ void AndroidJavaEngine::preloadEffect(const char* filePath)
 
 void AndroidJavaEngine::unloadEffect(const char* filePath)
 {
-    if (!_implementBaseOnAudioEngine)
+    if (_implementBaseOnAudioEngine)
+    {
+        AudioEngine::uncache(filePath);
+    }
+    else
     {
         std::string fullPath = getFullPathWithoutAssetsPrefix(filePath);
         JniHelper::callStaticVoidMethod(CLASS_NAME, "unloadEffect", fullPath);
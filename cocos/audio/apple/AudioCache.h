@@ -31,11 +31,13 @@
 #import <OpenAL/al.h>
 #import <AudioToolbox/AudioToolbox.h>
 
+#include <memory>
 #include <string>
 #include <mutex>
 #include <vector>
 
 #include "CCPlatformMacros.h"
+#include "base/CCData.h"
 
 #define QUEUEBUFFER_NUM 3
 #define QUEUEBUFFER_TIME_STEP 0.1
@@ -55,9 +57,28 @@ public:
 
     void addLoadCallback(const std::function<void(bool)>& callback);
 
+    /** The bytes of audio the cache holds, decoded and encoded. */
+    size_t getMemorySize() const;
+
 protected:
     void readDataTask();
 
+    /** Decodes the encoded data of a cache that decodes on play, when it plays. */
+    void decodeTask();
+
+    /** Runs `task` on the JobSystem, it is skipped if the cache is destroyed before it starts. */
+    void runTask(void (AudioCache::*task)());
+
+    OSStatus openEncodedData(AudioFileID* fileID, ExtAudioFileRef* extRef);
+
+    /** Decodes the PCM data into the AL buffer, the play callbacks run once its first buffers are decoded. */
+    bool readPCMData(ExtAudioFileRef extRef);
+
+    /** Releases the PCM data of a cache that decodes on play and is decoded, returns whether it did. */
+    bool releasePCMData();
+
+    bool isDecoding();
+
     void invokingPlayCallbacks();
 
     void invokingLoadCallbacks();
@@ -71,14 +92,16 @@ protected:
     AudioStreamBasicDescription outputFormat;
 
     /*Cache related stuff;
-     * Cache pcm data when sizeInBytes less than PCMDATA_CACHEMAXSIZE
+     * Cache pcm data when sizeInBytes less than _streamingThreshold
      */
     ALuint _alBufferId;
     char* _pcmData;
+    // the size of _pcmData when it comes from the buffers reused by the decodes on play, 0 otherwise
+    size_t _pcmCapacity;
     SInt64 _bytesOfRead;
 
     /*Queue buffer related stuff
-     *  Streaming in openal when sizeInBytes greater then PCMDATA_CACHEMAXSIZE
+     *  Streaming in openal when sizeInBytes greater then _streamingThreshold
      */
     char* _queBuffers[QUEUEBUFFER_NUM];
     ALsizei _queBufferSize[QUEUEBUFFER_NUM];
@@ -91,11 +114,32 @@ protected:
 
     std::vector< std::function<void()> > _callbacks;
     std::vector< std::function<void(bool)> > _loadCallbacks;
-    std::mutex _readDataTaskMutex;
+
+    // the tasks on the JobSystem reach the cache through it, the destructor clears it
+    struct TaskHandle
+    {
+        std::mutex mutex;
+        AudioCache* cache;
+    };
+    std::shared_ptr<TaskHandle> _taskHandle;
 
     bool _exitReadDataTask;
     std::string _fileFullPath;
 
+    // the decoded size above which the file is streamed, AudioEngine::getStreamingThreshold()
+    size_t _streamingThreshold;
+    // set on the cocos thread once the load callbacks ran, the cache can be released from then on
+    bool _loadDone;
+    // when the cache was last preloaded or played, for releasing the least recently used ones
+    unsigned int _lastUse;
+
+    // AudioEngine::isDecodeOnPlay(), the file data is kept and decoded when it plays
+    bool _decodeOnPlay;
+    cocos2d::Data _encodedData;
+    // the encoded data is loaded, it is decoded by the next play
+    bool _encodedReady;
+    bool _decoding;
+
     friend class AudioEngineImpl;
     friend class AudioPlayer;
 } ;
@@ -30,11 +30,13 @@
 #import <Foundation/Foundation.h>
 #import <OpenAL/alc.h>
 #import <AudioToolbox/ExtendedAudioFile.h>
+#include <algorithm>
+#include <cstring>
 #include <thread>
 #include "base/CCDirector.h"
+#include "base/CCJobSystem.h"
 #include "base/CCScheduler.h"
-
-#define PCMDATA_CACHEMAXSIZE 1048576
+#include "platform/CCFileUtils.h"
 
 using alBufferDataStaticProcPtr = ALvoid AL_APIENTRY (*)(const ALint bid, ALenum format, ALvoid* data, ALsizei size, ALsizei freq);
 
@@ -55,31 +57,136 @@ static ALvoid alBufferDataStaticProc(const ALint bid, ALenum format, ALvoid* dat
 using namespace cocos2d;
 using namespace cocos2d::experimental;
 
+// the PCM buffers of the caches that decode on play, reused by the next decodes
+static std::mutex s_pcmPoolMutex;
+static std::vector<std::pair<size_t, char*>> s_pcmPool;
+static size_t s_pcmPoolBytes = 0;
+static const size_t PCM_POOL_MAX_BYTES = 4 * 1024 * 1024;
+
+static char* acquirePCMBuffer(size_t size, size_t* capacity)
+{
+    {
+        std::lock_guard<std::mutex> lk(s_pcmPoolMutex);
+        // the smallest buffer that fits
+        auto best = s_pcmPool.end();
+        for (auto it = s_pcmPool.begin(); it != s_pcmPool.end(); ++it) {
+            if (it->first >= size && (best == s_pcmPool.end() || it->first < best->first)) {
+                best = it;
+            }
+        }
+        if (best != s_pcmPool.end()) {
+            auto buffer = best->second;
+            *capacity = best->first;
+            s_pcmPoolBytes -= best->first;
+            s_pcmPool.erase(best);
+            return buffer;
+        }
+    }
+
+    // power of two sizes, so the buffers fit the next files
+    size_t bufferSize = 16384;
+    while (bufferSize < size) {
+        bufferSize *= 2;
+    }
+    *capacity = bufferSize;
+    return (char*)malloc(bufferSize);
+}
+
+static void releasePCMBuffer(char* buffer, size_t capacity)
+{
+    {
+        std::lock_guard<std::mutex> lk(s_pcmPoolMutex);
+        if (s_pcmPoolBytes + capacity <= PCM_POOL_MAX_BYTES) {
+            s_pcmPool.push_back(std::make_pair(capacity, buffer));
+            s_pcmPoolBytes += capacity;
+            return;
+        }
+    }
+    free(buffer);
+}
+
+static OSStatus readEncodedDataProc(void* clientData, SInt64 position, UInt32 requestCount, void* buffer, UInt32* actualCount)
+{
+    auto data = (const Data*)clientData;
+    auto size = (SInt64)data->getSize();
+    if (position < 0 || position > size) {
+        *actualCount = 0;
+        return kAudioFileInvalidPacketOffsetError;
+    }
+    *actualCount = (UInt32)std::min((SInt64)requestCount, size - position);
+    memcpy(buffer, data->getBytes() + position, *actualCount);
+    return noErr;
+}
+
+static SInt64 getEncodedDataSizeProc(void* clientData)
+{
+    return ((const Data*)clientData)->getSize();
+}
+
+static AudioFileTypeID getFileTypeHint(const std::string& filePath)
+{
+    auto dot = filePath.find_last_of('.');
+    if (dot == std::string::npos) {
+        return 0;
+    }
+    auto extension = filePath.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    if (extension == "mp3") {
+        return kAudioFileMP3Type;
+    } else if (extension == "caf") {
+        return kAudioFileCAFType;
+    } else if (extension == "wav") {
+        return kAudioFileWAVEType;
+    } else if (extension == "aif" || extension == "aiff") {
+        return kAudioFileAIFFType;
+    } else if (extension == "m4a") {
+        return kAudioFileM4AType;
+    } else if (extension == "aac") {
+        return kAudioFileAAC_ADTSType;
+    }
+    return 0;
+}
+
 AudioCache::AudioCache()
 : _dataSize(0)
 , _pcmData(nullptr)
+, _pcmCapacity(0)
 , _bytesOfRead(0)
 , _queBufferFrames(0)
 , _queBufferBytes(0)
 , _alBufferReady(false)
 , _loadFail(false)
+, _taskHandle(std::make_shared<TaskHandle>())
 , _exitReadDataTask(false)
+, _streamingThreshold(0)
+, _loadDone(false)
+, _lastUse(0)
+, _decodeOnPlay(false)
+, _encodedReady(false)
+, _decoding(false)
 {
-
+    _taskHandle->cache = this;
 }
 
 AudioCache::~AudioCache()
 {
     _exitReadDataTask = true;
+    {
+        //wait for the running task to exit, the queued ones don't start
+        std::lock_guard<std::mutex> lk(_taskHandle->mutex);
+        _taskHandle->cache = nullptr;
+    }
+
     if(_pcmData){
         if (_alBufferReady){
             alDeleteBuffers(1, &_alBufferId);
         }
-        //wait for the 'readDataTask' task to exit
-        _readDataTaskMutex.lock();
-        _readDataTaskMutex.unlock();
 
-        free(_pcmData);
+        if (_pcmCapacity > 0) {
+            releasePCMBuffer(_pcmData, _pcmCapacity);
+        } else {
+            free(_pcmData);
+        }
     }
 
     if (_queBufferFrames > 0) {
@@ -89,27 +196,55 @@ AudioCache::~AudioCache()
     }
 }
 
-void AudioCache::readDataTask()
+void AudioCache::runTask(void (AudioCache::*task)())
 {
-    _readDataTaskMutex.lock();
+    auto handle = _taskHandle;
+    JobSystem::getInstance()->run([handle, task](){
+        std::lock_guard<std::mutex> lk(handle->mutex);
+        if (handle->cache) {
+            (handle->cache->*task)();
+        }
+    });
+}
 
+OSStatus AudioCache::openEncodedData(AudioFileID* fileID, ExtAudioFileRef* extRef)
+{
+    auto error = AudioFileOpenWithCallbacks(&_encodedData, readEncodedDataProc, nullptr, getEncodedDataSizeProc, nullptr,
+                                            getFileTypeHint(_fileFullPath), fileID);
+    if (!error) {
+        error = ExtAudioFileWrapAudioFileID(*fileID, false, extRef);
+    }
+    return error;
+}
+
+void AudioCache::readDataTask()
+{
     AudioStreamBasicDescription		theFileFormat;
     UInt32 thePropertySize = sizeof(theFileFormat);
 
     SInt64 theFileLengthInFrames;
-    SInt64 readInFrames;
-    SInt64 dataSize;
     SInt64 frames;
     AudioBufferList theDataBuffer;
     ExtAudioFileRef extRef = nullptr;
+    AudioFileID fileID = nullptr;
+    bool decodeOnPlay = false;
+    bool decode = false;
+    OSStatus error;
+
+    if (_decodeOnPlay) {
+        _encodedData = FileUtils::getInstance()->getDataFromFile(_fileFullPath);
+        error = _encodedData.isNull() ? kAudioFileUnspecifiedError : openEncodedData(&fileID, &extRef);
+    }
+    else {
+        NSString *fileFullPath = [[NSString alloc] initWithCString:_fileFullPath.c_str() encoding:[NSString defaultCStringEncoding]];
+        auto fileURL = (CFURLRef)[[NSURL alloc] initFileURLWithPath:fileFullPath];
+        [fileFullPath release];
 
-    NSString *fileFullPath = [[NSString alloc] initWithCString:_fileFullPath.c_str() encoding:[NSString defaultCStringEncoding]];
-    auto fileURL = (CFURLRef)[[NSURL alloc] initFileURLWithPath:fileFullPath];
-    [fileFullPath release];
-
-    auto error = ExtAudioFileOpenURL(fileURL, &extRef);
+        error = ExtAudioFileOpenURL(fileURL, &extRef);
+        CFRelease(fileURL);
+    }
     if(error) {
-        printf("%s: ExtAudioFileOpenURL FAILED, Error = %ld\n", __PRETTY_FUNCTION__, (long)error);
+        printf("%s: opening the audio file FAILED, Error = %ld\n", __PRETTY_FUNCTION__, (long)error);
         goto ExitThread;
     }
 
@@ -156,51 +291,17 @@ void AudioCache::readDataTask()
     _sampleRate = (ALsizei)outputFormat.mSampleRate;
     _duration = 1.0f * theFileLengthInFrames / outputFormat.mSampleRate;
 
-    if (_dataSize <= PCMDATA_CACHEMAXSIZE) {
-        _pcmData = (char*)malloc(_dataSize);
-        alGenBuffers(1, &_alBufferId);
-        auto alError = alGetError();
-        if (alError != AL_NO_ERROR) {
-            printf("%s: attaching audio to buffer fail: %x\n", __PRETTY_FUNCTION__, alError);
-            goto ExitThread;
+    if ((size_t)_dataSize <= _streamingThreshold) {
+        if (_decodeOnPlay) {
+            // decoded by the plays, see decodeTask()
+            decodeOnPlay = true;
         }
-        alBufferDataStaticProc(_alBufferId, _format, _pcmData, _dataSize, _sampleRate);
-
-        readInFrames = theFileFormat.mSampleRate * QUEUEBUFFER_TIME_STEP * QUEUEBUFFER_NUM;
-        dataSize = outputFormat.mBytesPerFrame * readInFrames;
-        if (dataSize > _dataSize) {
-            dataSize = _dataSize;
-            readInFrames = theFileLengthInFrames;
+        else {
+            readPCMData(extRef);
         }
-        theDataBuffer.mNumberBuffers = 1;
-        theDataBuffer.mBuffers[0].mDataByteSize = (UInt32)dataSize;
-        theDataBuffer.mBuffers[0].mNumberChannels = outputFormat.mChannelsPerFrame;
-
-        theDataBuffer.mBuffers[0].mData = _pcmData;
-        frames = readInFrames;
-        ExtAudioFileRead(extRef, (UInt32*)&frames, &theDataBuffer);
-        _alBufferReady = true;
-        _bytesOfRead += dataSize;
-        invokingPlayCallbacks();
-
-        while (!_exitReadDataTask && _bytesOfRead + dataSize < _dataSize) {
-            theDataBuffer.mBuffers[0].mData = _pcmData + _bytesOfRead;
-            frames = readInFrames;
-            ExtAudioFileRead(extRef, (UInt32*)&frames, &theDataBuffer);
-            _bytesOfRead += dataSize;
-        }
-
-        dataSize = _dataSize - _bytesOfRead;
-        if (!_exitReadDataTask && dataSize > 0) {
-            theDataBuffer.mBuffers[0].mDataByteSize = (UInt32)dataSize;
-            theDataBuffer.mBuffers[0].mData = _pcmData + _bytesOfRead;
-            frames = readInFrames;
-            ExtAudioFileRead(extRef, (UInt32*)&frames, &theDataBuffer);
-        }
-
-        _bytesOfRead = _dataSize;
     }
     else{
+        // the players stream from the file, the encoded data is released once read
         _queBufferFrames = theFileFormat.mSampleRate * QUEUEBUFFER_TIME_STEP;
         _queBufferBytes = _queBufferFrames * outputFormat.mBytesPerFrame;
 
@@ -219,21 +320,146 @@ void AudioCache::readDataTask()
     }
 
 ExitThread:
-    CFRelease(fileURL);
     if (extRef)
         ExtAudioFileDispose(extRef);
+    if (fileID)
+        AudioFileClose(fileID);
+    if (!decodeOnPlay)
+        _encodedData.clear();
 
-    _readDataTaskMutex.unlock();
+    _callbackMutex.lock();
     if (_queBufferFrames > 0)
         _alBufferReady = true;
     else
         _loadFail = true;
+    // the plays that waited for the load decode now
+    _encodedReady = decodeOnPlay;
+    decode = decodeOnPlay && !_callbacks.empty();
+    _decoding = decode;
+    _callbackMutex.unlock();
 
-    invokingPlayCallbacks();
+    if (decode)
+        runTask(&AudioCache::decodeTask);
+    else
+        invokingPlayCallbacks();
 
     invokingLoadCallbacks();
 }
 
+bool AudioCache::readPCMData(ExtAudioFileRef extRef)
+{
+    SInt64 readInFrames;
+    SInt64 dataSize;
+    SInt64 frames;
+    AudioBufferList theDataBuffer;
+
+    _bytesOfRead = 0;
+    // a decode that failed left its buffer
+    if (_pcmData == nullptr) {
+        if (_decodeOnPlay) {
+            _pcmData = acquirePCMBuffer(_dataSize, &_pcmCapacity);
+        } else {
+            _pcmData = (char*)malloc(_dataSize);
+        }
+    }
+    alGenBuffers(1, &_alBufferId);
+    auto alError = alGetError();
+    if (alError != AL_NO_ERROR) {
+        printf("%s: attaching audio to buffer fail: %x\n", __PRETTY_FUNCTION__, alError);
+        return false;
+    }
+    alBufferDataStaticProc(_alBufferId, _format, _pcmData, _dataSize, _sampleRate);
+
+    readInFrames = outputFormat.mSampleRate * QUEUEBUFFER_TIME_STEP * QUEUEBUFFER_NUM;
+    dataSize = outputFormat.mBytesPerFrame * readInFrames;
+    if (dataSize > _dataSize) {
+        dataSize = _dataSize;
+        readInFrames = _dataSize / outputFormat.mBytesPerFrame;
+    }
+    theDataBuffer.mNumberBuffers = 1;
+    theDataBuffer.mBuffers[0].mDataByteSize = (UInt32)dataSize;
+    theDataBuffer.mBuffers[0].mNumberChannels = outputFormat.mChannelsPerFrame;
+
+    theDataBuffer.mBuffers[0].mData = _pcmData;
+    frames = readInFrames;
+    ExtAudioFileRead(extRef, (UInt32*)&frames, &theDataBuffer);
+    _alBufferReady = true;
+    _bytesOfRead += dataSize;
+    invokingPlayCallbacks();
+
+    while (!_exitReadDataTask && _bytesOfRead + dataSize < _dataSize) {
+        theDataBuffer.mBuffers[0].mData = _pcmData + _bytesOfRead;
+        frames = readInFrames;
+        ExtAudioFileRead(extRef, (UInt32*)&frames, &theDataBuffer);
+        _bytesOfRead += dataSize;
+    }
+
+    dataSize = _dataSize - _bytesOfRead;
+    if (!_exitReadDataTask && dataSize > 0) {
+        theDataBuffer.mBuffers[0].mDataByteSize = (UInt32)dataSize;
+        theDataBuffer.mBuffers[0].mData = _pcmData + _bytesOfRead;
+        frames = readInFrames;
+        ExtAudioFileRead(extRef, (UInt32*)&frames, &theDataBuffer);
+    }
+
+    _bytesOfRead = _dataSize;
+    return true;
+}
+
+void AudioCache::decodeTask()
+{
+    AudioFileID fileID = nullptr;
+    ExtAudioFileRef extRef = nullptr;
+
+    auto error = openEncodedData(&fileID, &extRef);
+    if (!error) {
+        error = ExtAudioFileSetProperty(extRef, kExtAudioFileProperty_ClientDataFormat, sizeof(outputFormat), &outputFormat);
+    }
+    if (error) {
+        printf("%s: opening the encoded data FAILED, Error = %ld\n", __PRETTY_FUNCTION__, (long)error);
+    }
+    else {
+        readPCMData(extRef);
+    }
+
+    if (extRef)
+        ExtAudioFileDispose(extRef);
+    if (fileID)
+        AudioFileClose(fileID);
+
+    _callbackMutex.lock();
+    _decoding = false;
+    _callbackMutex.unlock();
+
+    invokingPlayCallbacks();
+}
+
+bool AudioCache::releasePCMData()
+{
+    std::lock_guard<std::mutex> lk(_callbackMutex);
+    if (!_encodedReady || !_alBufferReady || _decoding) {
+        return false;
+    }
+
+    alDeleteBuffers(1, &_alBufferId);
+    if (_pcmCapacity > 0) {
+        releasePCMBuffer(_pcmData, _pcmCapacity);
+    } else {
+        free(_pcmData);
+    }
+    _pcmData = nullptr;
+    _pcmCapacity = 0;
+    _bytesOfRead = 0;
+    _alBufferReady = false;
+    return true;
+}
+
+bool AudioCache::isDecoding()
+{
+    std::lock_guard<std::mutex> lk(_callbackMutex);
+    return _decoding;
+}
+
 void AudioCache::addPlayCallback(const std::function<void()>& callback)
 {
     _callbackMutex.lock();
@@ -241,6 +467,12 @@ void AudioCache::addPlayCallback(const std::function<void()>& callback)
         callback();
     } else if(!_loadFail){
         _callbacks.push_back(callback);
+    } else if (_encodedReady) {
+        _callbacks.push_back(callback);
+        if (!_decoding) {
+            _decoding = true;
+            runTask(&AudioCache::decodeTask);
+        }
     }
     _callbackMutex.unlock();
 }
@@ -258,7 +490,7 @@ void AudioCache::invokingPlayCallbacks()
 
 void AudioCache::addLoadCallback(const std::function<void(bool)>& callback)
 {
-    if (_alBufferReady) {
+    if (_alBufferReady || _encodedReady) {
         callback(true);
     } else if(_loadFail){
         callback(false);
@@ -274,11 +506,23 @@ void AudioCache::invokingLoadCallbacks()
     scheduler->performFunctionInCocosThread([&](){
         auto count = _loadCallbacks.size();
         for (size_t index = 0; index < count; ++index) {
-            _loadCallbacks[index](_alBufferReady);
+            _loadCallbacks[index](_alBufferReady || _encodedReady);
         }
         _loadCallbacks.clear();
+        _loadDone = true;
     });
 }
 
-#endif
+size_t AudioCache::getMemorySize() const
+{
+    size_t size = 0;
+    if (_pcmData) {
+        size += _pcmCapacity > 0 ? _pcmCapacity : _dataSize;
+    }
+    if (_queBufferFrames > 0) {
+        size += QUEUEBUFFER_NUM * _queBufferBytes;
+    }
+    return size + _encodedData.getSize();
+}
 
+#endif
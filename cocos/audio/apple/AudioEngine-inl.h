@@ -47,7 +47,8 @@ public:
     ~AudioEngineImpl();
 
     bool init();
-    int play2d(const std::string &fileFullPath ,bool loop ,float volume);
+    /** Plays the file with the voice `audioID`, given by AudioEngine. */
+    int play2d(const std::string &fileFullPath ,bool loop ,float volume, int audioID);
     void setVolume(int audioID,float volume);
     void setLoop(int audioID, bool loop);
     bool pause(int audioID);
@@ -62,10 +63,13 @@ public:
     void uncache(const std::string& filePath);
     void uncacheAll();
     AudioCache* preload(const std::string& filePath, std::function<void(bool)> callback);
+    /** Releases the least recently used caches that no audio plays until they fit AudioEngine::getCacheBudget(), but `keep`. */
+    void trimCaches(const AudioCache* keep = nullptr);
     void update(float dt);
 
 private:
     void _play2d(AudioCache *cache, int audioID);
+    bool isCachePlayed(const AudioCache* cache) const;
 
     ALuint _alSources[MAX_AUDIOINSTANCES];
 
@@ -81,7 +85,8 @@ private:
 
     bool _lazyInitLoop;
 
-    int _currentAudioID;
+    // increased by each preload, the last use of the caches
+    unsigned int _cacheUseCount;
     Scheduler* _scheduler;
 };
 }
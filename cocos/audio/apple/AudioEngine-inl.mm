@@ -119,7 +119,7 @@ static id s_AudioEngineSessionHandler = nullptr;
 
 AudioEngineImpl::AudioEngineImpl()
 : _lazyInitLoop(true)
-, _currentAudioID(0)
+, _cacheUseCount(0)
 {
 
 }
@@ -184,12 +184,16 @@ AudioCache* AudioEngineImpl::preload(const std::string& filePath, std::function<
     if (it == _audioCaches.end()) {
         audioCache = &_audioCaches[filePath];
         audioCache->_fileFullPath = FileUtils::getInstance()->fullPathForFilename(filePath);
+        audioCache->_streamingThreshold = AudioEngine::getStreamingThreshold();
+        audioCache->_decodeOnPlay = AudioEngine::isDecodeOnPlay();
 
-        AudioEngine::addTask(std::bind(&AudioCache::readDataTask, audioCache));
+        audioCache->runTask(&AudioCache::readDataTask);
     }
     else {
         audioCache = &it->second;
     }
+    audioCache->_lastUse = ++_cacheUseCount;
+    trimCaches(audioCache);
 
     if(audioCache && callback)
     {
@@ -198,7 +202,7 @@ AudioCache* AudioEngineImpl::preload(const std::string& filePath, std::function<
     return audioCache;
 }
 
-int AudioEngineImpl::play2d(const std::string &filePath ,bool loop ,float volume)
+int AudioEngineImpl::play2d(const std::string &filePath ,bool loop ,float volume, int audioID)
 {
     if (s_ALDevice == nullptr) {
         return AudioEngine::INVALID_AUDIO_ID;
@@ -233,10 +237,10 @@ int AudioEngineImpl::play2d(const std::string &filePath ,bool loop ,float volume
     }
 
     _threadMutex.lock();
-    _audioPlayers[_currentAudioID] = player;
+    _audioPlayers[audioID] = player;
     _threadMutex.unlock();
 
-    audioCache->addPlayCallback(std::bind(&AudioEngineImpl::_play2d,this,audioCache,_currentAudioID));
+    audioCache->addPlayCallback(std::bind(&AudioEngineImpl::_play2d,this,audioCache,audioID));
 
     _alSourceUsed[alSource] = true;
 
@@ -245,7 +249,7 @@ int AudioEngineImpl::play2d(const std::string &filePath ,bool loop ,float volume
         _scheduler->schedule(CC_SCHEDULE_SELECTOR(AudioEngineImpl::update), this, 0.05f, false);
     }
 
-    return _currentAudioID++;
+    return audioID;
 }
 
 void AudioEngineImpl::_play2d(AudioCache *cache, int audioID)
@@ -255,8 +259,9 @@ void AudioEngineImpl::_play2d(AudioCache *cache, int audioID)
         auto playerIt = _audioPlayers.find(audioID);
         if (playerIt != _audioPlayers.end() && playerIt->second->play2d(cache)) {
             _scheduler->performFunctionInCocosThread([audioID](){
-                if (AudioEngine::_audioIDInfoMap.find(audioID) != AudioEngine::_audioIDInfoMap.end()) {
-                    AudioEngine::_audioIDInfoMap[audioID].state = AudioEngine::AudioState::PLAYING;
+                auto audioInfo = AudioEngine::getVoiceInfo(audioID);
+                if (audioInfo) {
+                    audioInfo->state = AudioEngine::AudioState::PLAYING;
                 }
             });
         }
@@ -440,10 +445,14 @@ void AudioEngineImpl::update(float dt)
             delete player;
         }
         else if (player->_ready && sourceState == AL_STOPPED) {
+            if (!player->_streamingSource) {
+                // the buffer of a cache that decodes on play can't be deleted while a source holds it
+                alSourcei(player->_alSource, AL_BUFFER, 0);
+            }
             _alSourceUsed[player->_alSource] = false;
-            if (player->_finishCallbak) {
-                auto& audioInfo = AudioEngine::_audioIDInfoMap[audioID];
-                player->_finishCallbak(audioID, *audioInfo.filePath);
+            auto audioInfo = AudioEngine::getVoiceInfo(audioID);
+            if (player->_finishCallbak && audioInfo) {
+                player->_finishCallbak(audioID, *audioInfo->filePath);
             }
 
             AudioEngine::remove(audioID);
@@ -457,6 +466,14 @@ void AudioEngineImpl::update(float dt)
         }
     }
 
+    // the caches of the audio that ended may be released now
+    for (auto&& cache : _audioCaches) {
+        if (cache.second._encodedReady && cache.second._alBufferReady && !isCachePlayed(&cache.second)) {
+            cache.second.releasePCMData();
+        }
+    }
+    trimCaches();
+
     if(_audioPlayers.empty()){
         _lazyInitLoop = true;
         _scheduler->unschedule(CC_SCHEDULE_SELECTOR(AudioEngineImpl::update), this);
@@ -473,5 +490,50 @@ void AudioEngineImpl::uncacheAll()
     _audioCaches.clear();
 }
 
+bool AudioEngineImpl::isCachePlayed(const AudioCache* cache) const
+{
+    for (auto&& player : _audioPlayers) {
+        if (player.second->_audioCache == cache) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void AudioEngineImpl::trimCaches(const AudioCache* keep)
+{
+    const size_t budget = AudioEngine::getCacheBudget();
+    if (budget == 0) {
+        return;
+    }
+
+    size_t total = 0;
+    for (auto&& cache : _audioCaches) {
+        total += cache.second.getMemorySize();
+    }
+
+    while (total > budget) {
+        // the least recently used cache that is loaded, holds some memory and isn't played
+        auto victim = _audioCaches.end();
+        for (auto it = _audioCaches.begin(); it != _audioCaches.end(); ++it) {
+            const AudioCache* cache = &it->second;
+            if (cache == keep || !cache->_loadDone || cache->getMemorySize() == 0) {
+                continue;
+            }
+            if (victim != _audioCaches.end() && victim->second._lastUse <= cache->_lastUse) {
+                continue;
+            }
+            if (!isCachePlayed(cache) && !it->second.isDecoding()) {
+                victim = it;
+            }
+        }
+        if (victim == _audioCaches.end()) {
+            break;
+        }
+        total -= victim->second.getMemorySize();
+        _audioCaches.erase(victim);
+    }
+}
+
 #endif
 
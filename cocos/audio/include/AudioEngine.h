@@ -28,9 +28,9 @@
 #define __AUDIO_ENGINE_H_
 
 #include <functional>
-#include <list>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "platform/CCPlatformMacros.h"
 #include "Export.h"
@@ -64,6 +64,12 @@ public:
     /* Minimum delay in between sounds */
     double minDelay;
 
+    /**
+     * The priority of the instances, 0 by default. When all the voices play, a new instance takes the voice
+     * of the instance with the lowest priority if it is lower than its own.
+     */
+    int priority;
+
     /**
      * Default constructor
      *
@@ -72,6 +78,7 @@ public:
     AudioProfile()
     : maxInstances(0)
     , minDelay(0.0)
+    , priority(0)
     {
 
     }
@@ -129,6 +136,11 @@ public:
      * @param profile A profile for audio instance. When profile is not specified, default profile will be used.
      * @return An audio ID. It allows you to dynamically change the behavior of an audio instance on the fly.
      *
+     * When the profile has its maximum number of instances, its oldest instance is stopped.
+     * When all the voices (getMaxAudioInstance()) play, the instance takes the voice of an instance with a lower
+     * priority, which becomes virtual, or becomes virtual itself: its time goes on without playing until a voice
+     * is free. A sound that doesn't loop and was never played, so its duration is unknown, fails instead.
+     *
      * @see `AudioProfile`
      */
     static int play2d(const std::string& filePath, bool loop = false, float volume = 1.0f, const AudioProfile *profile = nullptr);
@@ -242,7 +254,8 @@ public:
     static int getMaxAudioInstance() {return _maxInstances;}
 
     /**
-     * Sets the maximum number of simultaneous audio instance for AudioEngine.
+     * Sets the maximum number of simultaneous audio instance for AudioEngine, the voices.
+     * The instances above it are virtual, see play2d().
      *
      * @param maxInstances The maximum number of simultaneous audio instance.
      */
@@ -264,6 +277,68 @@ public:
      */
     static void uncacheAll();
 
+    /**
+     * Sets the memory budget of the decoded audio kept in the caches, 0 for no limit (the default).
+     * When the caches hold more, the least recently used ones that no audio plays are released,
+     * as uncache() would. The caches are on ios, mac and win32.
+     *
+     * @param bytes The budget in bytes.
+     * @since v3.11
+     */
+    static void setCacheBudget(size_t bytes);
+
+    /** Gets the memory budget of the caches, see setCacheBudget(). */
+    static size_t getCacheBudget() { return _cacheBudget; }
+
+    /**
+     * Releases the least recently used caches that no audio plays until they hold `bytes` at most, as the budget
+     * would, without changing the budget. 0 releases all of them. See MemoryPressure.
+     *
+     * @param bytes The bytes the caches may keep.
+     * @since v3.11
+     */
+    static void trimCache(size_t bytes);
+
+    /**
+     * Sets the decoded size above which the audio files are streamed: the cache only decodes a few buffers ahead
+     * and the rest is decoded as it plays. The files loaded before keep the way they were loaded.
+     * It is 1 MB on ios and mac and 2.5 MB on win32 by default.
+     *
+     * @param bytes The size in bytes.
+     * @since v3.11
+     */
+    static void setStreamingThreshold(size_t bytes) { _streamingThreshold = bytes; }
+
+    /** Gets the decoded size above which the audio files are streamed, see setStreamingThreshold(). */
+    static size_t getStreamingThreshold() { return _streamingThreshold; }
+
+    /**
+     * Sets whether the audio files that are not streamed keep their encoded data in memory and decode it when they
+     * play, into buffers that are reused. The decoded data is released once no instance plays the file. A pack of short
+     * effects then loads without decoding and takes the memory of its files, each play costs a decode.
+     * The files loaded before keep the way they were loaded. Only ios and mac decode on play, it is off by default.
+     *
+     * @param decodeOnPlay Whether the files decode when they play.
+     * @since v3.11
+     */
+    static void setDecodeOnPlay(bool decodeOnPlay) { _decodeOnPlay = decodeOnPlay; }
+
+    /** Gets whether the audio files decode when they play, see setDecodeOnPlay(). */
+    static bool isDecodeOnPlay() { return _decodeOnPlay; }
+
+    /**
+     * Sets the directory the decoded audio files are kept in, named after a hash of their content. A file then
+     * decodes once: the next loads read its decoded data, in this run and in the next ones. Empty, the default,
+     * keeps nothing. The files loaded before keep the way they were loaded. Only win32 keeps the decoded files.
+     *
+     * @param path The directory, created when it is missing.
+     * @since v3.11
+     */
+    static void setDecodedCachePath(const std::string& path);
+
+    /** Gets the directory of the decoded audio files, see setDecodedCachePath(). */
+    static const std::string& getDecodedCachePath() { return _decodedCachePath; }
+
     /**
      * Gets the audio profile by id of audio instance.
      *
@@ -293,16 +368,22 @@ public:
      */
     static void preload(const std::string& filePath, std::function<void(bool isSuccess)> callback);
 
+    /**
+     * Preloads audio files, they load in parallel.
+     * @param filePaths The file paths of the audio.
+     * @param callback A callback which will be called once all of them are loaded, isSuccess if all of them loaded.
+     */
+    static void preload(const std::vector<std::string>& filePaths, std::function<void(bool isSuccess)> callback);
+
 protected:
     static void addTask(const std::function<void()>& task);
-    static void remove(int audioID);
+    /** Called by the platform players when the voice `voiceID` ended, removes its instance. */
+    static void remove(int voiceID);
 
     struct ProfileHelper
     {
         AudioProfile profile;
 
-        std::list<int> audioIDs;
-
         double lastPlayTime;
 
         ProfileHelper()
@@ -322,26 +403,88 @@ protected:
         float duration;
         AudioState state;
 
+        int priority;
+        // the order of the plays, the oldest instances are stolen first
+        unsigned int order;
+        // the ID of the platform player, INVALID_AUDIO_ID for a virtual instance
+        int voiceID;
+        // the time of a virtual instance at virtualStart, it goes on while the instance is PLAYING
+        float virtualTime;
+        double virtualStart;
+        // the time to seek to once the voice plays, after a virtual instance got a voice
+        float pendingTime;
+        std::function<void(int, const std::string&)> finishCallback;
+
         AudioInfo()
-            : profileHelper(nullptr)
+            : filePath(nullptr)
+            , profileHelper(nullptr)
+            , volume(1.0f)
+            , loop(false)
             , duration(TIME_UNKNOWN)
             , state(AudioState::INITIALZING)
+            , priority(0)
+            , order(0)
+            , voiceID(INVALID_AUDIO_ID)
+            , virtualTime(0.0f)
+            , virtualStart(0.0)
+            , pendingTime(TIME_UNKNOWN)
         {
 
         }
+
+        bool isVirtual() const { return voiceID == INVALID_AUDIO_ID; }
     };
 
-    //audioID,audioAttribute
-    static std::unordered_map<int, AudioInfo> _audioIDInfoMap;
+    /**
+     * The instances are in slots, an audio ID (and a voice ID) is the index of its slot in the low bits
+     * and a count in the others, so a stale ID doesn't find the next instance of the slot.
+     */
+    struct AudioSlot
+    {
+        int audioID;
+        unsigned int generation;
+        AudioInfo info;
+
+        AudioSlot() : audioID(INVALID_AUDIO_ID), generation(0) {}
+    };
 
-    //audio file path,audio IDs
-    static std::unordered_map<std::string,std::list<int>> _audioPathIDMap;
+    static const int SLOT_BITS = 10;
+    static const int MAX_SLOTS = 1 << SLOT_BITS;
+
+    /** Returns the instance of `audioID`, nullptr when it ended. */
+    static AudioInfo* getAudioInfo(int audioID);
+    /** Returns the instance played by the voice `voiceID` of the platform player, nullptr when it has none. */
+    static AudioInfo* getVoiceInfo(int voiceID);
+
+    static int addInstance(const std::string& filePath);
+    static void removeInstance(int slot);
+    static bool startVoice(int slot);
+    static void stopVoice(AudioInfo& info);
+    static void stealVoice(int slot);
+    static float getKnownDuration(const AudioInfo& info);
+    static float getVirtualTime(const AudioInfo& info);
+    static void onVoiceFinished(int voiceID, const std::string& filePath);
+    static void update(float dt);
+
+    static std::vector<AudioSlot> _audioSlots;
+    static std::vector<int> _freeAudioSlots;
+    static unsigned int _voiceCount;
+    static unsigned int _playCount;
+    static unsigned int _voiceIDCount;
+
+    //audio file path,duration
+    static std::unordered_map<std::string, float> _audioPathDurationMap;
 
     //profileName,ProfileHelper
     static std::unordered_map<std::string, ProfileHelper> _audioPathProfileHelperMap;
 
     static unsigned int _maxInstances;
 
+    static size_t _cacheBudget;
+    static size_t _streamingThreshold;
+    static bool _decodeOnPlay;
+    static std::string _decodedCachePath;
+
     static ProfileHelper* _defaultProfileHelper;
 
     static AudioEngineImpl* _audioEngineImpl;
@@ -350,6 +493,8 @@ protected:
     static AudioEngineThreadPool* s_threadPool;
 
     friend class AudioEngineImpl;
+    friend class AudioCache;
+    friend class AudioStream;
 };
 
 }
@@ -28,17 +28,307 @@
 #include "AudioCache.h"
 #include <thread>
 #include <algorithm>
+#include <climits>
+#include <stdint.h>
 #include "vorbis/codec.h"
 #include "vorbis/vorbisfile.h"
 #include "platform/CCFileUtils.h"
 #include "mpg123/mpg123.h"
+#include "audio/include/AudioEngine.h"
 #include "base/CCDirector.h"
 #include "base/CCScheduler.h"
 
-#define PCMDATA_CACHEMAXSIZE 2621440
-
 using namespace cocos2d::experimental;
 
+// the chunks a stream decodes ahead of each of its players
+static const int READ_AHEAD_CHUNKS = QUEUEBUFFER_NUM * 2;
+
+NS_CC_BEGIN
+namespace experimental{
+
+namespace {
+
+// the header of the decoded files, the 16 bit PCM follows
+struct DecodedHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t sampleRate;
+    uint32_t channels;
+    uint64_t frames;
+};
+
+const char DECODED_MAGIC[4] = {'C', 'C', 'P', 'M'};
+const uint32_t DECODED_VERSION = 1;
+
+// the decoded file of `fullPath` in the directory `cachePath`, named after a hash of its content, empty when it can't be read
+std::string getDecodedFilePath(const std::string& cachePath, const std::string& fullPath)
+{
+    FILE* file = fopen(FileUtils::getInstance()->getSuitableFOpen(fullPath).c_str(), "rb");
+    if (!file) {
+        return "";
+    }
+
+    // FNV-1a over the content and the size
+    uint64_t hash = 14695981039346656037ULL;
+    uint64_t size = 0;
+    std::vector<unsigned char> block(65536);
+    size_t readBytes;
+    while ((readBytes = fread(block.data(), 1, block.size(), file)) > 0) {
+        for (size_t index = 0; index < readBytes; ++index) {
+            hash = (hash ^ block[index]) * 1099511628211ULL;
+        }
+        size += readBytes;
+    }
+    fclose(file);
+    hash = (hash ^ size) * 1099511628211ULL;
+
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.pcm", (unsigned long long)hash);
+    return cachePath + name;
+}
+
+// writes the decoded file `path` from `read`, which fills the buffer given and returns the bytes it put there, 0 at the end
+bool writeDecodedPcm(const std::string& path, ALuint sampleRate, int channels, const std::function<size_t(char*, size_t)>& read)
+{
+    auto fileUtils = FileUtils::getInstance();
+    // written aside and renamed, the loads never see a partial file
+    const std::string tmpPath = path + ".tmp";
+    FILE* file = fopen(fileUtils->getSuitableFOpen(tmpPath).c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    DecodedHeader header;
+    memcpy(header.magic, DECODED_MAGIC, sizeof(header.magic));
+    header.version = DECODED_VERSION;
+    header.sampleRate = sampleRate;
+    header.channels = channels;
+    header.frames = 0;
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    uint64_t bytes = 0;
+    std::vector<char> block(65536);
+    size_t readBytes;
+    while (ok && (readBytes = read(block.data(), block.size())) > 0) {
+        ok = fwrite(block.data(), 1, readBytes, file) == readBytes;
+        bytes += readBytes;
+    }
+    header.frames = bytes / (2 * channels);
+    ok = ok && fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = fclose(file) == 0 && ok;
+
+    if (ok) {
+        fileUtils->removeFile(path);
+        ok = fileUtils->renameFile(tmpPath, path);
+    }
+    if (!ok) {
+        fileUtils->removeFile(tmpPath);
+        log("%s: can't write %s", __FUNCTION__, path.c_str());
+    }
+    return ok;
+}
+
+}
+
+/** Reads the 16 bit PCM of an audio file from its decoder, or from its decoded file. */
+class PcmReader
+{
+public:
+    PcmReader()
+    : sampleRate(0)
+    , channels(0)
+    , bytesPerFrame(0)
+    , totalFrames(0)
+    , _fileFormat(AudioCache::FileFormat::UNKNOWN)
+    , _vorbisFile(nullptr)
+    , _mpg123handle(nullptr)
+    , _decodedFile(nullptr)
+    {
+    }
+
+    ~PcmReader()
+    {
+        if (_vorbisFile) {
+            ov_clear(_vorbisFile);
+            delete _vorbisFile;
+        }
+        if (_mpg123handle) {
+            mpg123_close(_mpg123handle);
+            mpg123_delete(_mpg123handle);
+        }
+        if (_decodedFile) {
+            fclose(_decodedFile);
+        }
+    }
+
+    /** Opens the decoder of `fullPath`, `scan` gets the exact length of the mp3 files. */
+    bool open(const std::string& fullPath, AudioCache::FileFormat fileFormat, bool scan)
+    {
+        _fileFormat = fileFormat;
+        switch (fileFormat)
+        {
+        case AudioCache::FileFormat::OGG:
+            {
+                _vorbisFile = new OggVorbis_File;
+                int openCode = ov_fopen(FileUtils::getInstance()->getSuitableFOpen(fullPath).c_str(), _vorbisFile);
+                if (openCode) {
+                    log("Input does not appear to be an Ogg bitstream: %s. Code: 0x%x\n", fullPath.c_str(), openCode);
+                    delete _vorbisFile;
+                    _vorbisFile = nullptr;
+                    return false;
+                }
+
+                auto vi = ov_info(_vorbisFile, -1);
+                channels = vi->channels;
+                sampleRate = vi->rate;
+                totalFrames = (long)ov_pcm_total(_vorbisFile, -1);
+            }
+            break;
+        case AudioCache::FileFormat::MP3:
+            {
+                int error = MPG123_OK;
+                _mpg123handle = mpg123_new(nullptr, &error);
+                if (!_mpg123handle) {
+                    log("Basic setup goes wrong: %s", mpg123_plain_strerror(error));
+                    return false;
+                }
+
+                long rate = 0;
+                int encoding = 0;
+                if (mpg123_open(_mpg123handle, fullPath.c_str()) != MPG123_OK ||
+                    mpg123_getformat(_mpg123handle, &rate, &channels, &encoding) != MPG123_OK) {
+                    log("Trouble with mpg123: %s\n", mpg123_strerror(_mpg123handle));
+                    return false;
+                }
+                sampleRate = rate;
+
+                /* Ensure that this output format will not change, mpg123 converts to 16 bit. */
+                mpg123_format_none(_mpg123handle);
+                mpg123_format(_mpg123handle, rate, channels, MPG123_ENC_SIGNED_16);
+                /* Ensure that we can get accurate length by call mpg123_length */
+                if (scan) {
+                    mpg123_scan(_mpg123handle);
+                }
+                totalFrames = (long)mpg123_length(_mpg123handle);
+            }
+            break;
+        case AudioCache::FileFormat::UNKNOWN:
+        default:
+            return false;
+        }
+
+        bytesPerFrame = 2 * channels;
+        return channels > 0 && sampleRate > 0;
+    }
+
+    /** Opens the decoded file `path`, false when it is missing or doesn't check out. */
+    bool openDecoded(const std::string& path)
+    {
+        _decodedFile = fopen(FileUtils::getInstance()->getSuitableFOpen(path).c_str(), "rb");
+        if (!_decodedFile) {
+            return false;
+        }
+
+        DecodedHeader header;
+        bool ok = fread(&header, sizeof(header), 1, _decodedFile) == 1
+            && memcmp(header.magic, DECODED_MAGIC, sizeof(header.magic)) == 0
+            && header.version == DECODED_VERSION
+            && (header.channels == 1 || header.channels == 2)
+            && header.sampleRate > 0;
+        if (ok) {
+            // a file cut short is decoded again
+            ok = fseek(_decodedFile, 0, SEEK_END) == 0
+                && (uint64_t)ftell(_decodedFile) >= sizeof(header) + header.frames * 2 * header.channels
+                && fseek(_decodedFile, sizeof(header), SEEK_SET) == 0;
+        }
+        if (!ok) {
+            fclose(_decodedFile);
+            _decodedFile = nullptr;
+            return false;
+        }
+
+        sampleRate = header.sampleRate;
+        channels = header.channels;
+        bytesPerFrame = 2 * channels;
+        totalFrames = (long)header.frames;
+        return true;
+    }
+
+    bool seek(long frame)
+    {
+        if (_decodedFile) {
+            return fseek(_decodedFile, (long)(sizeof(DecodedHeader) + frame * bytesPerFrame), SEEK_SET) == 0;
+        }
+        switch (_fileFormat)
+        {
+        case AudioCache::FileFormat::OGG:
+            return ov_pcm_seek(_vorbisFile, frame) == 0;
+        case AudioCache::FileFormat::MP3:
+            return mpg123_seek(_mpg123handle, frame, SEEK_SET) >= 0;
+        default:
+            return false;
+        }
+    }
+
+    /** Fills `buffer` with up to `bytes`, less at the end only. Returns the bytes read. */
+    size_t read(char* buffer, size_t bytes)
+    {
+        if (_decodedFile) {
+            return fread(buffer, 1, bytes, _decodedFile);
+        }
+
+        size_t done = 0;
+        switch (_fileFormat)
+        {
+        case AudioCache::FileFormat::OGG:
+            while (done < bytes) {
+                int currentSection;
+                long readRet = ov_read(_vorbisFile, buffer + done, (int)(bytes - done), 0, 2, 1, &currentSection);
+                if (readRet == OV_HOLE) {
+                    continue;
+                }
+                if (readRet <= 0) {
+                    break;
+                }
+                done += readRet;
+            }
+            break;
+        case AudioCache::FileFormat::MP3:
+            while (done < bytes) {
+                size_t readRet = 0;
+                auto err = mpg123_read(_mpg123handle, (unsigned char*)buffer + done, bytes - done, &readRet);
+                done += readRet;
+                if (err != MPG123_OK || readRet == 0) {
+                    if (err == MPG123_ERR) {
+                        log("Trouble with mpg123: %s\n", mpg123_strerror(_mpg123handle));
+                    }
+                    break;
+                }
+            }
+            break;
+        default:
+            break;
+        }
+        // whole frames only
+        return done - done % bytesPerFrame;
+    }
+
+    ALuint sampleRate;
+    int channels;
+    size_t bytesPerFrame;
+    long totalFrames;
+
+private:
+    AudioCache::FileFormat _fileFormat;
+    OggVorbis_File* _vorbisFile;
+    mpg123_handle* _mpg123handle;
+    FILE* _decodedFile;
+};
+
+}
+NS_CC_END
+
 AudioCache::AudioCache()
 : _pcmData(nullptr)
 , _pcmDataSize(0)
@@ -49,6 +339,9 @@ AudioCache::AudioCache()
 , _queBufferFrames(0)
 , _queBufferBytes(0)
 , _mp3Encoding(0)
+, _streamingThreshold(0)
+, _loadDone(false)
+, _lastUse(0)
 {
 
 }
@@ -63,6 +356,12 @@ AudioCache::AudioCache(const AudioCache& cache)
     _queBufferFrames = cache._queBufferFrames;
     _queBufferBytes = cache._queBufferBytes;
     _mp3Encoding = cache._mp3Encoding;
+    _streamingThreshold = cache._streamingThreshold;
+    _loadDone = cache._loadDone;
+    _lastUse = cache._lastUse;
+    _decodedCachePath = cache._decodedCachePath;
+    _decodedFilePath = cache._decodedFilePath;
+    _stream = cache._stream;
 }
 
 AudioCache::~AudioCache()
@@ -85,187 +384,127 @@ AudioCache::~AudioCache()
     }
 }
 
+PcmReader* AudioCache::openDecodedFile()
+{
+    _decodedFilePath = getDecodedFilePath(_decodedCachePath, _fileFullPath);
+    if (_decodedFilePath.empty()) {
+        return nullptr;
+    }
+
+    auto reader = new PcmReader;
+    if (!reader->openDecoded(_decodedFilePath)) {
+        delete reader;
+        return nullptr;
+    }
+    return reader;
+}
+
+void AudioCache::writeDecodedFile()
+{
+    if (_pcmData) {
+        const char* data = (const char*)_pcmData;
+        size_t offset = 0;
+        const size_t size = _pcmDataSize;
+        writeDecodedPcm(_decodedFilePath, _sampleRate, _channels, [&](char* buffer, size_t bytes) {
+            bytes = std::min(bytes, size - offset);
+            memcpy(buffer, data + offset, bytes);
+            offset += bytes;
+            return bytes;
+        });
+        return;
+    }
+
+    // a streamed file decodes on its own, the players go on streaming from the decoder meanwhile
+    auto path = _decodedFilePath;
+    auto fullPath = _fileFullPath;
+    auto fileFormat = _fileFormat;
+    AudioEngine::addTask([path, fullPath, fileFormat]() {
+        PcmReader reader;
+        if (reader.open(fullPath, fileFormat, false)) {
+            writeDecodedPcm(path, reader.sampleRate, reader.channels, [&](char* buffer, size_t bytes) {
+                return reader.read(buffer, bytes);
+            });
+        }
+    });
+}
+
 void AudioCache::readDataTask()
 {
     _readDataTaskMutex.lock();
 
-     OggVorbis_File* vf = nullptr;
-     mpg123_handle* mpg123handle = nullptr;
-     long totalFrames = 0;
-
-     switch (_fileFormat)
-     {
-     case FileFormat::OGG:
-         {
-             vf = new OggVorbis_File;
-             int openCode;
-             if (openCode = ov_fopen(FileUtils::getInstance()->getSuitableFOpen(_fileFullPath).c_str(), vf)){
-                 log("Input does not appear to be an Ogg bitstream: %s. Code: 0x%x\n", _fileFullPath.c_str(), openCode);
-                 goto ExitThread;
-             }
-
-             auto vi = ov_info(vf,-1);
-             totalFrames = (long)ov_pcm_total(vf,-1);
-             _bytesPerFrame =  vi->channels * 2;
-             _alBufferFormat = (vi->channels > 1) ? AL_FORMAT_STEREO16 : AL_FORMAT_MONO16;
-             _sampleRate = vi->rate;
-             _pcmDataSize = totalFrames * _bytesPerFrame;
-             _duration = 1.0f * totalFrames / _sampleRate;
-         }
-         break;
-     case FileFormat::MP3:
-         {
-             long rate = 0;
-             int error = MPG123_OK;
-             mpg123handle = mpg123_new(nullptr, &error);
-             if (!mpg123handle){
-                 log("Basic setup goes wrong: %s", mpg123_plain_strerror(error));
-                 goto ExitThread;
-             }
-
-             if (mpg123_open(mpg123handle,_fileFullPath.c_str()) != MPG123_OK ||
-                 mpg123_getformat(mpg123handle, &rate, &_channels, &_mp3Encoding) != MPG123_OK) {
-                 log("Trouble with mpg123: %s\n", mpg123_strerror(mpg123handle) );
-                 goto ExitThread;
-             }
-
-             if (_mp3Encoding == MPG123_ENC_SIGNED_16){
-                 _bytesPerFrame = 2 * _channels;
-             }
-             else if (_mp3Encoding == MPG123_ENC_FLOAT_32){
-                 _bytesPerFrame = 4 * _channels;
-             }
-             else{
-                 log("Bad encoding: 0x%x!\n", _mp3Encoding);
-                 goto ExitThread;
-             }
-
-             _alBufferFormat = (_channels > 1) ? AL_FORMAT_STEREO16 : AL_FORMAT_MONO16;
-             _sampleRate = rate;
-
-             /* Ensure that this output format will not change (it could, when we allow it). */
-             mpg123_format_none(mpg123handle);
-             mpg123_format(mpg123handle, rate, _channels, _mp3Encoding);
-             /* Ensure that we can get accurate length by call mpg123_length */
-             mpg123_scan(mpg123handle);
-
-             auto framesLength = mpg123_length(mpg123handle);
-             totalFrames = framesLength;
-             _pcmDataSize = totalFrames * _bytesPerFrame;
-             _duration = 1.0f * totalFrames / _sampleRate;
-         }
-         break;
-     case FileFormat::UNKNOWN:
-     default:
-         break;
-     }
-
-    if (_pcmDataSize <= PCMDATA_CACHEMAXSIZE)
+    PcmReader* reader = nullptr;
+    bool decoded = false;
+
+    do
     {
-        _pcmData = malloc(_pcmDataSize);
-        auto alError = alGetError();
-        alGenBuffers(1, &_alBufferId);
-        alError = alGetError();
-        if (alError != AL_NO_ERROR) {
-            log("%s: attaching audio to buffer fail: %x\n", __FUNCTION__, alError);
-            goto ExitThread;
+        if (!_decodedCachePath.empty()) {
+            reader = openDecodedFile();
+            decoded = reader != nullptr;
+        }
+        if (!reader) {
+            reader = new PcmReader;
+            if (!reader->open(_fileFullPath, _fileFormat, true)) {
+                break;
+            }
         }
 
-        switch (_fileFormat)
-        {
-        case FileFormat::OGG:
-            {
-                int current_section;
-                unsigned int currPos = 0;
-                long readRet = 0;
-                do
-                {
-                    readRet = ov_read(vf,(char*)_pcmData + _bytesOfRead,4096,0,2,1,&current_section);
-                    if (readRet > 0){
-                        _bytesOfRead += readRet;
-                    }
-                } while (_bytesOfRead < _pcmDataSize);
+        _channels = reader->channels;
+        _sampleRate = reader->sampleRate;
+        _bytesPerFrame = reader->bytesPerFrame;
+        _mp3Encoding = MPG123_ENC_SIGNED_16;
+        _alBufferFormat = (_channels > 1) ? AL_FORMAT_STEREO16 : AL_FORMAT_MONO16;
+        _pcmDataSize = reader->totalFrames * _bytesPerFrame;
+        _duration = 1.0f * reader->totalFrames / _sampleRate;
 
-                _alBufferReady = true;
-                _bytesOfRead = _pcmDataSize;
+        if (_pcmDataSize <= _streamingThreshold)
+        {
+            _pcmData = malloc(_pcmDataSize);
+            auto alError = alGetError();
+            alGenBuffers(1, &_alBufferId);
+            alError = alGetError();
+            if (alError != AL_NO_ERROR) {
+                log("%s: attaching audio to buffer fail: %x\n", __FUNCTION__, alError);
                 break;
             }
-        case FileFormat::MP3:
-            {
-                size_t done = 0;
-                auto err = mpg123_read(mpg123handle,(unsigned char*)_pcmData, _pcmDataSize,&done);
-                if (err == MPG123_ERR){
-                    log("Trouble with mpg123: %s\n", mpg123_strerror(mpg123handle) );
-                    goto ExitThread;
-                }
-                if (err == MPG123_DONE || err == MPG123_OK){
-                    _alBufferReady = true;
-                    _pcmDataSize = done;
-                    _bytesOfRead = done;
-                }
-            }
-            break;
-        case FileFormat::UNKNOWN:
-        default:
-            break;
+
+            _bytesOfRead = reader->read((char*)_pcmData, _pcmDataSize);
+            _pcmDataSize = _bytesOfRead;
+            alBufferData(_alBufferId, _alBufferFormat, _pcmData, _pcmDataSize, _sampleRate);
+            _alBufferReady = true;
         }
-        alBufferData(_alBufferId,_alBufferFormat,_pcmData,_pcmDataSize,_sampleRate);
-    }
-    else{
-        _queBufferFrames = _sampleRate * QUEUEBUFFER_TIME_STEP;
-        _queBufferBytes = _queBufferFrames * _bytesPerFrame;
+        else
+        {
+            _queBufferFrames = _sampleRate * QUEUEBUFFER_TIME_STEP;
+            _queBufferBytes = _queBufferFrames * _bytesPerFrame;
 
-        for (int index = 0; index < QUEUEBUFFER_NUM; ++index) {
-            _queBuffers[index] = (char*)malloc(_queBufferBytes);
-
-            switch (_fileFormat){
-            case FileFormat::MP3:
-                {
-                    size_t done = 0;
-                    mpg123_read(mpg123handle,(unsigned char*)_queBuffers[index], _queBufferBytes,&done);
-                    _queBufferSize[index] = done;
-                    _bytesOfRead += done;
-                }
-                break;
-            case FileFormat::OGG:
-                {
-                    int current_section;
-                    auto readRet = ov_read(vf,_queBuffers[index],_queBufferBytes,0,2,1,&current_section);
-                    _queBufferSize[index] = readRet;
-                }
-                break;
+            for (int index = 0; index < QUEUEBUFFER_NUM; ++index) {
+                _queBuffers[index] = (char*)malloc(_queBufferBytes);
+                _queBufferSize[index] = reader->read(_queBuffers[index], _queBufferBytes);
+                _bytesOfRead += _queBufferSize[index];
             }
+
+            _stream = std::make_shared<AudioStream>(*this);
+            _alBufferReady = true;
         }
-    }
+    } while (false);
 
-ExitThread:
-    switch (_fileFormat)
-    {
-    case FileFormat::OGG:
-        ov_clear(vf);
-        delete vf;
-        break;
-    case FileFormat::MP3:
-        mpg123_close(mpg123handle);
-        mpg123_delete(mpg123handle);
-        break;
-    case FileFormat::UNKNOWN:
-    default:
-        break;
-    }
+    delete reader;
 
-    _readDataTaskMutex.unlock();
-    if (_queBufferFrames > 0)
-    {
-        _alBufferReady = true;
-    }
-    else
+    if (!_alBufferReady)
     {
         _loadFail = true;
     }
 
     invokingLoadCallbacks();
     invokingPlayCallbacks();
+
+    // after the callbacks, the first play doesn't wait for the write
+    if (_alBufferReady && !decoded && !_decodedFilePath.empty())
+    {
+        writeDecodedFile();
+    }
+
+    _readDataTaskMutex.unlock();
 }
 
 void AudioCache::invokingPlayCallbacks()
@@ -299,9 +538,22 @@ void AudioCache::invokingLoadCallbacks()
             _loadCallbacks[index](_alBufferReady);
         }
         _loadCallbacks.clear();
+        _loadDone = true;
     });
 }
 
+size_t AudioCache::getMemorySize() const
+{
+    size_t size = _pcmData ? _pcmDataSize : 0;
+    if (_queBufferFrames > 0) {
+        size += QUEUEBUFFER_NUM * _queBufferBytes;
+    }
+    if (_stream) {
+        size += _stream->getMemorySize();
+    }
+    return size;
+}
+
 void AudioCache::addLoadCallback(const std::function<void(bool)>& callback)
 {
     if (_alBufferReady) {
@@ -315,5 +567,148 @@ void AudioCache::addLoadCallback(const std::function<void(bool)>& callback)
     }
 }
 
-#endif
+AudioStream::AudioStream(const AudioCache& cache)
+: _fileFullPath(cache._fileFullPath)
+, _decodedFilePath(cache._decodedFilePath)
+, _fileFormat(cache._fileFormat)
+, _sampleRate(cache._sampleRate)
+, _channels(cache._channels)
+, _chunkFrames(cache._queBufferFrames)
+, _chunkBytes(cache._queBufferBytes)
+, _reader(nullptr)
+, _readerFailed(false)
+, _readerChunk(-1)
+, _endChunk(INT_MAX)
+, _readAheadPending(false)
+{
+}
 
+AudioStream::~AudioStream()
+{
+    delete _reader;
+}
+
+size_t AudioStream::read(const void* reader, int index, char* buffer)
+{
+    size_t size = 0;
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        _readers[reader] = index;
+
+        auto it = _chunks.find(index);
+        if (it == _chunks.end() && decodeChunk(index) > 0) {
+            it = _chunks.find(index);
+        }
+        if (it != _chunks.end()) {
+            size = it->second.size();
+            memcpy(buffer, it->second.data(), size);
+        }
+        dropChunks();
+
+        if (_readAheadPending || _readerFailed || index + 1 >= _endChunk) {
+            return size;
+        }
+        _readAheadPending = true;
+    }
+
+    auto self = shared_from_this();
+    AudioEngine::addTask([self]() {
+        self->readAheadTask();
+    });
+    return size;
+}
+
+void AudioStream::removeReader(const void* reader)
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    _readers.erase(reader);
+    dropChunks();
+}
+
+size_t AudioStream::getMemorySize()
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    return _chunks.size() * _chunkBytes;
+}
+
+size_t AudioStream::decodeChunk(int index)
+{
+    if (!_reader && !_readerFailed) {
+        // the decoded file when it was written meanwhile, the decoder otherwise
+        _reader = new PcmReader;
+        if ((_decodedFilePath.empty() || !_reader->openDecoded(_decodedFilePath))
+            && !_reader->open(_fileFullPath, _fileFormat, false)) {
+            delete _reader;
+            _reader = nullptr;
+            _readerFailed = true;
+        }
+    }
+    if (!_reader || index >= _endChunk) {
+        return 0;
+    }
+
+    if (_readerChunk != index && !_reader->seek((long)index * _chunkFrames)) {
+        _readerChunk = -1;
+        return 0;
+    }
+
+    std::vector<char> chunk(_chunkBytes);
+    size_t size = _reader->read(chunk.data(), _chunkBytes);
+    if (size == 0) {
+        _endChunk = index;
+        _readerChunk = -1;
+        return 0;
+    }
+    chunk.resize(size);
+    _chunks[index] = std::move(chunk);
+    _readerChunk = index + 1;
+    return size;
+}
+
+void AudioStream::dropChunks()
+{
+    for (auto it = _chunks.begin(); it != _chunks.end();) {
+        bool needed = false;
+        for (auto&& reader : _readers) {
+            if (it->first > reader.second && it->first <= reader.second + READ_AHEAD_CHUNKS) {
+                needed = true;
+                break;
+            }
+        }
+        if (needed) {
+            ++it;
+        } else {
+            it = _chunks.erase(it);
+        }
+    }
+}
+
+void AudioStream::readAheadTask()
+{
+    while (true) {
+        std::lock_guard<std::mutex> lk(_mutex);
+
+        // the first chunk a reader is about to read that isn't decoded yet
+        int next = INT_MAX;
+        for (auto&& reader : _readers) {
+            const int last = std::min(reader.second + READ_AHEAD_CHUNKS, _endChunk - 1);
+            for (int index = reader.second + 1; index <= last; ++index) {
+                if (_chunks.find(index) == _chunks.end()) {
+                    next = std::min(next, index);
+                    break;
+                }
+            }
+        }
+        if (next == INT_MAX || _readerFailed) {
+            _readAheadPending = false;
+            return;
+        }
+        if (decodeChunk(next) == 0 && !_readerFailed && next < _endChunk) {
+            // a chunk that fails to seek isn't tried again and again
+            _readAheadPending = false;
+            return;
+        }
+    }
+}
+
+#endif
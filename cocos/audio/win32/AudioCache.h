@@ -31,6 +31,9 @@
 #include <string>
 #include <mutex>
 #include <vector>
+#include <map>
+#include <memory>
+#include <unordered_map>
 #ifdef OPENAL_PLAIN_INCLUDES
 #include <al.h>
 #else
@@ -46,6 +49,8 @@ namespace experimental{
 
 class AudioEngineImpl;
 class AudioPlayer;
+class AudioStream;
+class PcmReader;
 
 class CC_DLL AudioCache{
 public:
@@ -64,11 +69,19 @@ public:
 
     void addLoadCallback(const std::function<void(bool)>& callback);
 
+    /** The bytes of decoded audio the cache holds. */
+    size_t getMemorySize() const;
+
 protected:
     void readDataTask();
     void invokingPlayCallbacks();
     void invokingLoadCallbacks();
 
+    // reads the decoded file of _decodedCachePath the file has, returns its reader or null when there is none
+    PcmReader* openDecodedFile();
+    // writes the decoded file of the file from _pcmData, or from a decode on the AudioEngine pool when it is streamed
+    void writeDecodedFile();
+
     std::string _fileFullPath;
     FileFormat _fileFormat;
     //pcm data related stuff
@@ -81,14 +94,14 @@ protected:
     float _duration;
 
     /*Cache related stuff;
-     * Cache pcm data when sizeInBytes less than PCMDATA_CACHEMAXSIZE
+     * Cache pcm data when sizeInBytes less than _streamingThreshold
      */
     ALuint _alBufferId;
     void* _pcmData;
     size_t _bytesOfRead;
 
     /*Queue buffer related stuff
-     *  Streaming in OpenAL when sizeInBytes greater then PCMDATA_CACHEMAXSIZE
+     *  Streaming in OpenAL when sizeInBytes greater then _streamingThreshold
      */
     char* _queBuffers[QUEUEBUFFER_NUM];
     ALsizei _queBufferSize[QUEUEBUFFER_NUM];
@@ -105,10 +118,78 @@ protected:
 
     int _mp3Encoding;
 
+    // the decoded size above which the file is streamed, AudioEngine::getStreamingThreshold()
+    size_t _streamingThreshold;
+    // set on the cocos thread once the load callbacks ran, the cache can be released from then on
+    bool _loadDone;
+    // when the cache was last preloaded or played, for releasing the least recently used ones
+    unsigned int _lastUse;
+
+    // the directory of the decoded files, AudioEngine::getDecodedCachePath(), and the decoded file of this one
+    std::string _decodedCachePath;
+    std::string _decodedFilePath;
+    // the decoded chunks the players of a streamed file share
+    std::shared_ptr<AudioStream> _stream;
+
     friend class AudioEngineImpl;
     friend class AudioPlayer;
+    friend class AudioStream;
 } ;
 
+/**
+ The decoded chunks of a streamed file, of QUEUEBUFFER_TIME_STEP seconds each. The players of the file share them:
+ a chunk is decoded once, on the AudioEngine pool a few chunks ahead of the players, and dropped once no player
+ is about to play it.
+ */
+class CC_DLL AudioStream : public std::enable_shared_from_this<AudioStream>
+{
+public:
+    explicit AudioStream(const AudioCache& cache);
+    ~AudioStream();
+
+    /**
+     * Copies the chunk `index` into `buffer`, of AudioCache::_queBufferBytes, and returns its size, 0 past the end.
+     * The chunk is decoded there when the read ahead didn't get to it yet.
+     *
+     * @param reader The player, the chunks after `index` are read ahead for it.
+     */
+    size_t read(const void* reader, int index, char* buffer);
+
+    /** Forgets `reader`, the chunks read ahead for it are dropped. */
+    void removeReader(const void* reader);
+
+    /** The bytes of the chunks held. */
+    size_t getMemorySize();
+
+protected:
+    // decodes the chunk `index` into _chunks, _mutex is locked
+    size_t decodeChunk(int index);
+    // drops the chunks no reader is about to read, _mutex is locked
+    void dropChunks();
+    void readAheadTask();
+
+    std::string _fileFullPath;
+    std::string _decodedFilePath;
+    AudioCache::FileFormat _fileFormat;
+    ALuint _sampleRate;
+    int _channels;
+    int _mp3Encoding;
+    int _chunkFrames;
+    size_t _chunkBytes;
+
+    std::mutex _mutex;
+    PcmReader* _reader;
+    bool _readerFailed;
+    // the chunk the reader decodes next
+    int _readerChunk;
+    // the first chunk past the end, once the reader got there
+    int _endChunk;
+    std::map<int, std::vector<char>> _chunks;
+    // the last chunk each reader read
+    std::unordered_map<const void*, int> _readers;
+    bool _readAheadPending;
+};
+
 }
 NS_CC_END
 
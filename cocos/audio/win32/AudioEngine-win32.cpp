@@ -49,7 +49,7 @@ static bool MPG123_LAZYINIT = true;
 
 AudioEngineImpl::AudioEngineImpl()
 : _lazyInitLoop(true)
-, _currentAudioID(0)
+, _cacheUseCount(0)
 {
 
 }
@@ -113,6 +113,7 @@ AudioCache* AudioEngineImpl::preload(const std::string& filePath, std::function<
         if (it != _audioCaches.end())
         {
             audioCache = &it->second;
+            audioCache->_lastUse = ++_cacheUseCount;
             if (callback && audioCache->_alBufferReady)
             {
                 callback(true);
@@ -153,6 +154,10 @@ AudioCache* AudioEngineImpl::preload(const std::string& filePath, std::function<
 
         audioCache = &_audioCaches[filePath];
         audioCache->_fileFormat = fileFormat;
+        audioCache->_streamingThreshold = AudioEngine::getStreamingThreshold();
+        audioCache->_decodedCachePath = AudioEngine::getDecodedCachePath();
+        audioCache->_lastUse = ++_cacheUseCount;
+        trimCaches(audioCache);
 
         audioCache->_fileFullPath = FileUtils::getInstance()->fullPathForFilename(filePath);
         AudioEngine::addTask(std::bind(&AudioCache::readDataTask, audioCache));
@@ -173,7 +178,7 @@ AudioCache* AudioEngineImpl::preload(const std::string& filePath, std::function<
     return audioCache;
 }
 
-int AudioEngineImpl::play2d(const std::string &filePath ,bool loop ,float volume)
+int AudioEngineImpl::play2d(const std::string &filePath ,bool loop ,float volume, int audioID)
 {
     bool availableSourceExist = false;
     ALuint alSource;
@@ -194,11 +199,11 @@ int AudioEngineImpl::play2d(const std::string &filePath ,bool loop ,float volume
         return AudioEngine::INVALID_AUDIO_ID;
     }
 
-    auto player = &_audioPlayers[_currentAudioID];
+    auto player = &_audioPlayers[audioID];
     player->_alSource = alSource;
     player->_loop = loop;
     player->_volume = volume;
-    audioCache->addPlayCallback(std::bind(&AudioEngineImpl::_play2d, this, audioCache, _currentAudioID));
+    audioCache->addPlayCallback(std::bind(&AudioEngineImpl::_play2d, this, audioCache, audioID));
 
     _alSourceUsed[alSource] = true;
 
@@ -209,7 +214,7 @@ int AudioEngineImpl::play2d(const std::string &filePath ,bool loop ,float volume
         scheduler->schedule(schedule_selector(AudioEngineImpl::update), this, 0.05f, false);
     }
 
-    return _currentAudioID++;
+    return audioID;
 }
 
 void AudioEngineImpl::_play2d(AudioCache *cache, int audioID)
@@ -218,7 +223,10 @@ void AudioEngineImpl::_play2d(AudioCache *cache, int audioID)
         auto playerIt = _audioPlayers.find(audioID);
         if (playerIt != _audioPlayers.end()) {
             if (playerIt->second.play2d(cache)) {
-                AudioEngine::_audioIDInfoMap[audioID].state = AudioEngine::AudioState::PLAYING;
+                auto audioInfo = AudioEngine::getVoiceInfo(audioID);
+                if (audioInfo) {
+                    audioInfo->state = AudioEngine::AudioState::PLAYING;
+                }
             }
             else{
                 _threadMutex.lock();
@@ -431,9 +439,9 @@ void AudioEngineImpl::update(float dt)
             auto playerIt = _audioPlayers.find(audioID);
             if (playerIt != _audioPlayers.end()) {
                 _alSourceUsed[playerIt->second._alSource] = false;
-                if(playerIt->second._finishCallbak) {
-                    auto& audioInfo = AudioEngine::_audioIDInfoMap[audioID];
-                    playerIt->second._finishCallbak(audioID, *audioInfo.filePath);
+                auto audioInfo = AudioEngine::getVoiceInfo(audioID);
+                if(playerIt->second._finishCallbak && audioInfo) {
+                    playerIt->second._finishCallbak(audioID, *audioInfo->filePath);
                 }
                 _audioPlayers.erase(audioID);
                 AudioEngine::remove(audioID);
@@ -463,9 +471,9 @@ void AudioEngineImpl::update(float dt)
         }
         else if (player._ready && sourceState == AL_STOPPED) {
             _alSourceUsed[player._alSource] = false;
-            if (player._finishCallbak) {
-                auto& audioInfo = AudioEngine::_audioIDInfoMap[audioID];
-                player._finishCallbak(audioID, *audioInfo.filePath);
+            auto audioInfo = AudioEngine::getVoiceInfo(audioID);
+            if (player._finishCallbak && audioInfo) {
+                player._finishCallbak(audioID, *audioInfo->filePath);
             }
 
             AudioEngine::remove(audioID);
@@ -485,6 +493,9 @@ void AudioEngineImpl::update(float dt)
         }
     }
 
+    // the caches of the audio that ended may be released now
+    trimCaches();
+
     if(_audioPlayers.empty()){
         _lazyInitLoop = true;
 
@@ -503,5 +514,47 @@ void AudioEngineImpl::uncacheAll()
     _audioCaches.clear();
 }
 
+void AudioEngineImpl::trimCaches(const AudioCache* keep)
+{
+    const size_t budget = AudioEngine::getCacheBudget();
+    if (budget == 0) {
+        return;
+    }
+
+    size_t total = 0;
+    for (auto&& cache : _audioCaches) {
+        total += cache.second.getMemorySize();
+    }
+
+    while (total > budget) {
+        // the least recently used cache that is loaded, holds some memory and isn't played
+        auto victim = _audioCaches.end();
+        for (auto it = _audioCaches.begin(); it != _audioCaches.end(); ++it) {
+            const AudioCache* cache = &it->second;
+            if (cache == keep || !cache->_loadDone || cache->getMemorySize() == 0) {
+                continue;
+            }
+            if (victim != _audioCaches.end() && victim->second._lastUse <= cache->_lastUse) {
+                continue;
+            }
+            bool played = false;
+            for (auto&& player : _audioPlayers) {
+                if (player.second._audioCache == cache) {
+                    played = true;
+                    break;
+                }
+            }
+            if (!played) {
+                victim = it;
+            }
+        }
+        if (victim == _audioCaches.end()) {
+            break;
+        }
+        total -= victim->second.getMemorySize();
+        _audioCaches.erase(victim);
+    }
+}
+
 #endif
 
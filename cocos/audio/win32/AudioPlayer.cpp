@@ -27,10 +27,7 @@
 #include "AudioPlayer.h"
 #include "AudioCache.h"
 #include "base/CCConsole.h"
-#include "platform/CCFileUtils.h"
-#include "mpg123/mpg123.h"
-#include "vorbis/codec.h"
-#include "vorbis/vorbisfile.h"
+#include <algorithm>
 
 using namespace cocos2d::experimental;
 
@@ -116,7 +113,8 @@ bool AudioPlayer::play2d(AudioCache* cache)
 
     if (_streamingSource)
     {
-        _rotateBufferThread = std::thread(&AudioPlayer::rotateBufferThread, this, _audioCache->_queBufferFrames * QUEUEBUFFER_NUM + 1);
+        // the first chunks are the queue buffers of the cache
+        _rotateBufferThread = std::thread(&AudioPlayer::rotateBufferThread, this, QUEUEBUFFER_NUM);
         _rotateBufferThread.detach();
     }
     else
@@ -135,60 +133,18 @@ bool AudioPlayer::play2d(AudioCache* cache)
     return true;
 }
 
-void AudioPlayer::rotateBufferThread(int offsetFrame)
+void AudioPlayer::rotateBufferThread(int chunk)
 {
     ALint sourceState;
     ALint bufferProcessed = 0;
-    mpg123_handle* mpg123handle = nullptr;
-    OggVorbis_File* vorbisFile = nullptr;
 
-    auto audioFileFormat = _audioCache->_fileFormat;
+    // the chunks are shared with the other players of the file and decoded ahead on the AudioEngine pool
+    auto stream = _audioCache->_stream;
+    const int chunkFrames = _audioCache->_queBufferFrames;
+    const size_t bytesPerFrame = _audioCache->_bytesPerFrame;
     char* tmpBuffer = (char*)malloc(_audioCache->_queBufferBytes);
-
-    switch (audioFileFormat)
-    {
-    case AudioCache::FileFormat::MP3:
-        {
-            int error = MPG123_OK;
-            mpg123handle = mpg123_new(nullptr, &error);
-            if (!mpg123handle){
-                log("Basic setup goes wrong: %s", mpg123_plain_strerror(error));
-                goto ExitBufferThread;
-            }
-            long rate = 0;
-            int channels = 0;
-            int mp3Encoding = 0;
-            if (mpg123_open(mpg123handle,_audioCache->_fileFullPath.c_str()) != MPG123_OK
-                || mpg123_getformat(mpg123handle, &rate, &channels, &mp3Encoding) != MPG123_OK){
-                log("Trouble with mpg123: %s\n", mpg123_strerror(mpg123handle) );
-                goto ExitBufferThread;
-            }
-
-            /* Ensure that this output format will not change (it could, when we allow it). */
-            mpg123_format_none(mpg123handle);
-            mpg123_format(mpg123handle, _audioCache->_sampleRate, _audioCache->_channels, _audioCache->_mp3Encoding);
-
-            if (offsetFrame != 0) {
-                mpg123_seek(mpg123handle,offsetFrame,SEEK_SET);
-            }
-            break;
-        }
-    case AudioCache::FileFormat::OGG:
-        {
-            vorbisFile = new OggVorbis_File;
-            int openCode;
-            if (openCode = ov_fopen(FileUtils::getInstance()->getSuitableFOpen(_audioCache->_fileFullPath).c_str(), vorbisFile)){
-                log("Input does not appear to be an Ogg bitstream: %s. Code: 0x%x\n", _audioCache->_fileFullPath.c_str(), openCode);
-                goto ExitBufferThread;
-            }
-            if (offsetFrame != 0) {
-                ov_pcm_seek(vorbisFile,offsetFrame);
-            }
-            break;
-        }
-    default:
-        break;
-    }
+    // the frames to skip in the next chunk, after a seek
+    int skipFrames = 0;
 
     alSourcePlay(_alSource);
 
@@ -202,19 +158,9 @@ void AudioPlayer::rotateBufferThread(int offsetFrame)
                 bufferProcessed--;
                 if (_timeDirty) {
                     _timeDirty = false;
-                    offsetFrame = _currTime * _audioCache->_sampleRate;
-
-                    switch (audioFileFormat)
-                    {
-                    case AudioCache::FileFormat::MP3:
-                        mpg123_seek(mpg123handle,offsetFrame,SEEK_SET);
-                        break;
-                    case AudioCache::FileFormat::OGG:
-                        ov_pcm_seek(vorbisFile,offsetFrame);
-                        break;
-                    default:
-                        break;
-                    }
+                    int offsetFrame = _currTime * _audioCache->_sampleRate;
+                    chunk = offsetFrame / chunkFrames;
+                    skipFrames = offsetFrame % chunkFrames;
                 }
                 else {
                     _currTime += QUEUEBUFFER_TIME_STEP;
@@ -227,42 +173,31 @@ void AudioPlayer::rotateBufferThread(int offsetFrame)
                     }
                 }
 
-                size_t readRet = 0;
-                if(audioFileFormat == AudioCache::FileFormat::MP3)
-                {
-                    mpg123_read(mpg123handle,(unsigned char*)tmpBuffer, _audioCache->_queBufferBytes,&readRet);
-                    if (readRet <= 0) {
-                        if (_loop) {
-                            mpg123_seek(mpg123handle,0,SEEK_SET);
-                            mpg123_read(mpg123handle,(unsigned char*)tmpBuffer, _audioCache->_queBufferBytes,&readRet);
-                        } else {
-                            _exitThread = true;
-                            break;
-                        }
+                size_t readRet = stream->read(this, chunk, tmpBuffer);
+                if (readRet <= 0) {
+                    if (_loop) {
+                        chunk = 0;
+                        skipFrames = 0;
+                        readRet = stream->read(this, chunk, tmpBuffer);
                     }
-                    else
-                    {
-                        _audioCache->_bytesOfRead += readRet;
-                    }
-                }
-                else if(audioFileFormat ==  AudioCache::FileFormat::OGG)
-                {
-                    int current_section;
-                    readRet = ov_read(vorbisFile,tmpBuffer,_audioCache->_queBufferBytes,0,2,1,&current_section);
                     if (readRet <= 0) {
-                        if (_loop) {
-                            ov_pcm_seek(vorbisFile,0);
-                            readRet = ov_read(vorbisFile,tmpBuffer,_audioCache->_queBufferBytes,0,2,1,&current_section);
-                        } else {
-                            _exitThread = true;
-                            break;
-                        }
+                        _exitThread = true;
+                        break;
                     }
                 }
+                ++chunk;
+
+                const char* data = tmpBuffer;
+                if (skipFrames > 0) {
+                    const size_t skipBytes = std::min(readRet, skipFrames * bytesPerFrame);
+                    data += skipBytes;
+                    readRet -= skipBytes;
+                    skipFrames = 0;
+                }
 
                 ALuint bid;
                 alSourceUnqueueBuffers(_alSource, 1, &bid);
-                alBufferData(bid, _audioCache->_alBufferFormat, tmpBuffer, readRet, _audioCache->_sampleRate);
+                alBufferData(bid, _audioCache->_alBufferFormat, data, readRet, _audioCache->_sampleRate);
                 alSourceQueueBuffers(_alSource, 1, &bid);
             }
         }
@@ -275,21 +210,8 @@ void AudioPlayer::rotateBufferThread(int offsetFrame)
 
         _sleepCondition.wait_for(lk,std::chrono::milliseconds(35));
     }
-ExitBufferThread:
-    switch (audioFileFormat)
-    {
-    case AudioCache::FileFormat::OGG:
-        ov_clear(vorbisFile);
-        delete vorbisFile;
-        break;
-    case AudioCache::FileFormat::MP3:
-        mpg123_close(mpg123handle);
-        mpg123_delete(mpg123handle);
-        break;
-    case AudioCache::FileFormat::UNKNOWN:
-    default:
-        break;
-    }
+
+    stream->removeReader(this);
     free(tmpBuffer);
     _readForRemove = true;
 }
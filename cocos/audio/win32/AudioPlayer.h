@@ -59,7 +59,7 @@ public:
     void notifyExitThread();
 
 protected:
-    void rotateBufferThread(int offsetFrame);
+    void rotateBufferThread(int chunk);
     bool play2d(AudioCache* cache);
 
     AudioCache* _audioCache;
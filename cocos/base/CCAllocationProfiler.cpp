@@ -0,0 +1,210 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "base/CCAllocationProfiler.h"
+
+#include <algorithm>
+#include <typeinfo>
+#if defined(__GNUC__) || defined(__clang__)
+#include <cxxabi.h>
+#endif
+
+#include "base/CCRef.h"
+#include "base/CCString.h"
+#include "base/ccMacros.h"
+
+NS_CC_BEGIN
+
+std::atomic<bool> AllocationProfiler::s_enabled(false);
+
+static std::string className(const std::type_info& type)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+    if (demangled)
+    {
+        std::string name(demangled);
+        free(demangled);
+        return name;
+    }
+#endif
+    return type.name();
+}
+
+AllocationProfiler* AllocationProfiler::getInstance()
+{
+    static AllocationProfiler instance;
+    return &instance;
+}
+
+AllocationProfiler::AllocationProfiler()
+: _frameCount(0)
+{
+}
+
+void AllocationProfiler::setEnabled(bool enabled)
+{
+#if !CC_ENABLE_ALLOCATION_PROFILER
+    if (enabled)
+    {
+        CCLOG("AllocationProfiler: nothing is recorded, see CC_ENABLE_ALLOCATION_PROFILER");
+    }
+#endif
+    if (enabled && !isEnabled())
+    {
+        reset();
+        std::lock_guard<std::mutex> lock(_mutex);
+        // the Refs of the other threads may be in construction at the end of a frame, their class can't be read
+        _mainThread = std::this_thread::get_id();
+    }
+    s_enabled = enabled;
+}
+
+void AllocationProfiler::reset()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _sites.clear();
+    _refs.clear();
+    _freedRefs = Counter();
+    _otherThreadRefs = Counter();
+    _lastFrame.clear();
+    _totals.clear();
+    _frameCount = 0;
+}
+
+void AllocationProfiler::record(const char* site, size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _sites[site].add(bytes);
+}
+
+void AllocationProfiler::trackRef(void* ref, size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (std::this_thread::get_id() == _mainThread)
+    {
+        _refs[ref] = bytes;
+    }
+    else
+    {
+        _otherThreadRefs.add(bytes);
+    }
+}
+
+void AllocationProfiler::untrackRef(void* ref)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto found = _refs.find(ref);
+    if (found != _refs.end())
+    {
+        _freedRefs.add(found->second);
+        _refs.erase(found);
+    }
+}
+
+void AllocationProfiler::endFrame()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _lastFrame.clear();
+    for (auto& ref : _refs)
+    {
+        _lastFrame[className(typeid(*static_cast<Ref*>(ref.first)))].add(ref.second);
+    }
+    if (_freedRefs.count)
+    {
+        _lastFrame["(freed in the frame)"] = _freedRefs;
+    }
+    if (_otherThreadRefs.count)
+    {
+        _lastFrame["(created on another thread)"] = _otherThreadRefs;
+    }
+    for (auto& site : _sites)
+    {
+        Counter& counter = _lastFrame[site.first];
+        counter.count += site.second.count;
+        counter.bytes += site.second.bytes;
+    }
+
+    for (auto& entry : _lastFrame)
+    {
+        Counter& total = _totals[entry.first];
+        total.count += entry.second.count;
+        total.bytes += entry.second.bytes;
+    }
+    ++_frameCount;
+
+    _refs.clear();
+    _sites.clear();
+    _freedRefs = Counter();
+    _otherThreadRefs = Counter();
+}
+
+std::vector<AllocationProfiler::Entry> AllocationProfiler::sorted(const std::map<std::string, Counter>& counters)
+{
+    std::vector<Entry> entries;
+    entries.reserve(counters.size());
+    for (auto& counter : counters)
+    {
+        entries.push_back({counter.first, counter.second.count, counter.second.bytes});
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.count != b.count ? a.count > b.count : a.name < b.name;
+    });
+    return entries;
+}
+
+std::vector<AllocationProfiler::Entry> AllocationProfiler::getLastFrame() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return sorted(_lastFrame);
+}
+
+std::vector<AllocationProfiler::Entry> AllocationProfiler::getTotals() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return sorted(_totals);
+}
+
+unsigned int AllocationProfiler::getFrameCount() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _frameCount;
+}
+
+std::string AllocationProfiler::getReport(size_t maxEntries) const
+{
+    auto totals = getTotals();
+    unsigned int frames = std::max(getFrameCount(), 1u);
+    std::string report = StringUtils::format("%u frames\nper frame\tbytes/frame\tname\n", getFrameCount());
+    for (size_t i = 0; i < totals.size() && i < maxEntries; ++i)
+    {
+        report += StringUtils::format("%.2f\t\t%.0f\t\t%s\n", totals[i].count / (float)frames,
+                                      totals[i].bytes / (float)frames, totals[i].name.c_str());
+    }
+    return report;
+}
+
+NS_CC_END
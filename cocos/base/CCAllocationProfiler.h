@@ -0,0 +1,142 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CC_ALLOCATION_PROFILER_H__
+#define __CC_ALLOCATION_PROFILER_H__
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "platform/CCPlatformMacros.h"
+#include "base/ccConfig.h"
+
+/**
+ * @addtogroup base
+ * @{
+ */
+NS_CC_BEGIN
+
+/**
+ * @class AllocationProfiler
+ * @brief Counts the allocations of each frame when CC_ENABLE_ALLOCATION_PROFILER is enabled, to find the ones
+ * made every frame in a steady state.
+ *
+ * The Refs are counted by class: the ones created on the main thread and still alive at the end of the frame get
+ * the name of their dynamic type, the ones already freed are counted as "(freed in the frame)". Besides the Refs,
+ * the engine records its heavy sites with CC_PROFILE_ALLOCATION(): the std::function copies of the Scheduler and of
+ * the event listeners, the strings and containers of Value and StringUtils::format(). The bytes are the size of
+ * the object allocated at the site, not of what it owns.
+ *
+ * It records nothing until setEnabled(true). A frame ends after Director::drawScene(), before the autoreleased
+ * objects are released. See the "allocations" command of the Console.
+ * @since v3.11
+ * @js NA
+ * @lua NA
+ */
+class CC_DLL AllocationProfiler
+{
+public:
+    /** The allocations of a class or of a site. */
+    struct Entry
+    {
+        std::string name;
+        unsigned int count;
+        size_t bytes;
+    };
+
+    static AllocationProfiler* getInstance();
+
+    /** Starts or stops the recording. Starting drops what was recorded before. */
+    void setEnabled(bool enabled);
+    /** Whether or not the allocations are recorded. */
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    /** Drops the frames recorded so far. */
+    void reset();
+
+    /** Gets the allocations of the last frame, the most frequent first. */
+    std::vector<Entry> getLastFrame() const;
+    /** Gets the allocations of all the frames since the recording started, the most frequent first. */
+    std::vector<Entry> getTotals() const;
+    /** Gets the number of frames recorded. */
+    unsigned int getFrameCount() const;
+
+    /** Returns a table of the totals per frame, `maxEntries` lines at most. */
+    std::string getReport(size_t maxEntries) const;
+
+    /// @cond DO_NOT_SHOW
+    void record(const char* site, size_t bytes);
+    void trackRef(void* ref, size_t bytes);
+    void untrackRef(void* ref);
+    void endFrame();
+    /// @endcond
+
+protected:
+    struct Counter
+    {
+        unsigned int count;
+        size_t bytes;
+        Counter() : count(0), bytes(0) {}
+        void add(size_t size) { ++count; bytes += size; }
+    };
+
+    AllocationProfiler();
+
+    static std::vector<Entry> sorted(const std::map<std::string, Counter>& counters);
+
+    static std::atomic<bool> s_enabled;
+
+    mutable std::mutex _mutex;
+    std::thread::id _mainThread;
+    // the sites of the current frame, keyed by their literal
+    std::unordered_map<const char*, Counter> _sites;
+    // the Refs created on the main thread in the current frame, with their size
+    std::unordered_map<void*, size_t> _refs;
+    Counter _freedRefs;
+    Counter _otherThreadRefs;
+
+    std::map<std::string, Counter> _lastFrame;
+    std::map<std::string, Counter> _totals;
+    unsigned int _frameCount;
+};
+
+#if CC_ENABLE_ALLOCATION_PROFILER
+/** Records an allocation of `bytes` at `site`, a string literal, when the AllocationProfiler is enabled. */
+#define CC_PROFILE_ALLOCATION(site, bytes) do { \
+    if (cocos2d::AllocationProfiler::isEnabled()) cocos2d::AllocationProfiler::getInstance()->record(site, bytes); \
+} while (0)
+#else
+#define CC_PROFILE_ALLOCATION(site, bytes) do {} while (0)
+#endif
+
+NS_CC_END
+// end group
+/// @}
+#endif //__CC_ALLOCATION_PROFILER_H__
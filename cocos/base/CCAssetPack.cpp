@@ -0,0 +1,231 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "base/CCAssetPack.h"
+
+#include <string.h>
+#include <zlib.h>
+
+#include "base/ccMacros.h"
+
+NS_CC_BEGIN
+
+static const unsigned int HEADER_SIZE = 32;
+static const unsigned int ENTRY_SIZE = 32;
+static const unsigned int PACK_VERSION = 1;
+
+// the view may come from an asset buffer, which isn't always aligned
+static inline unsigned int readU32(const unsigned char* p)
+{
+    return (unsigned int)p[0] | ((unsigned int)p[1] << 8) | ((unsigned int)p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+std::shared_ptr<AssetPack> AssetPack::create(FileView&& view)
+{
+    std::shared_ptr<AssetPack> ret(new (std::nothrow) AssetPack(std::move(view)));
+    if (ret && ret->init())
+    {
+        return ret;
+    }
+    return nullptr;
+}
+
+unsigned int AssetPack::hash(const char* name, size_t length)
+{
+    unsigned int h = 2166136261u;
+    for (size_t i = 0; i < length; ++i)
+    {
+        h ^= (unsigned char)name[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+AssetPack::AssetPack(FileView&& view)
+: _view(std::move(view))
+, _entryCount(0)
+, _bucketMask(0)
+, _buckets(nullptr)
+, _entries(nullptr)
+, _names(nullptr)
+, _namesSize(0)
+{
+}
+
+AssetPack::~AssetPack()
+{
+}
+
+bool AssetPack::init()
+{
+    const unsigned char* bytes = _view.getBytes();
+    const uint64_t size = _view.getSize();
+    if (bytes == nullptr || size < HEADER_SIZE || memcmp(bytes, "CCPK", 4) != 0)
+    {
+        CCLOG("cocos2d: AssetPack: not a pack");
+        return false;
+    }
+
+    const unsigned int version = readU32(bytes + 4);
+    const uint64_t entryCount = readU32(bytes + 8);
+    const uint64_t bucketCount = readU32(bytes + 12);
+    const uint64_t bucketsOffset = readU32(bytes + 16);
+    const uint64_t entriesOffset = readU32(bytes + 20);
+    const uint64_t namesOffset = readU32(bytes + 24);
+
+    if (version != PACK_VERSION)
+    {
+        CCLOG("cocos2d: AssetPack: unsupported version %u", version);
+        return false;
+    }
+    if (bucketCount == 0 || (bucketCount & (bucketCount - 1)) != 0
+        || bucketsOffset + bucketCount * 4 > size
+        || entriesOffset + entryCount * ENTRY_SIZE > size
+        || namesOffset > size)
+    {
+        CCLOG("cocos2d: AssetPack: the index is corrupted");
+        return false;
+    }
+
+    _entryCount = (unsigned int)entryCount;
+    _bucketMask = (unsigned int)bucketCount - 1;
+    _buckets = bytes + bucketsOffset;
+    _entries = bytes + entriesOffset;
+    _names = bytes + namesOffset;
+    _namesSize = (ssize_t)(size - namesOffset);
+
+    // the lookups trust the entries, check them once
+    for (unsigned int i = 0; i < _entryCount; ++i)
+    {
+        const unsigned char* e = _entries + i * ENTRY_SIZE;
+        const uint64_t next = readU32(e + 4);
+        const uint64_t nameOffset = readU32(e + 8);
+        const uint64_t nameLength = readU32(e + 12);
+        const uint64_t dataOffset = readU32(e + 16);
+        const uint64_t storedSize = readU32(e + 24);
+        if (next > entryCount || nameOffset + nameLength > (uint64_t)_namesSize || dataOffset + storedSize > size)
+        {
+            CCLOG("cocos2d: AssetPack: entry %u is corrupted", i);
+            return false;
+        }
+    }
+    for (unsigned int i = 0; i <= _bucketMask; ++i)
+    {
+        if (readU32(_buckets + i * 4) > entryCount)
+        {
+            CCLOG("cocos2d: AssetPack: bucket %u is corrupted", i);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool AssetPack::findEntry(const char* name, size_t length, Entry* entry) const
+{
+    const unsigned int h = hash(name, length);
+    unsigned int index = readU32(_buckets + (h & _bucketMask) * 4);
+
+    // a corrupted pack could chain the entries in a loop
+    for (unsigned int steps = 0; index != 0 && steps < _entryCount; ++steps)
+    {
+        const unsigned char* e = _entries + (index - 1) * ENTRY_SIZE;
+        if (readU32(e) == h && readU32(e + 12) == length
+            && memcmp(_names + readU32(e + 8), name, length) == 0)
+        {
+            if (entry)
+            {
+                entry->bytes = _view.getBytes() + readU32(e + 16);
+                entry->size = readU32(e + 20);
+                entry->storedSize = readU32(e + 24);
+                entry->codec = (Codec)readU32(e + 28);
+            }
+            return true;
+        }
+        index = readU32(e + 4);
+    }
+
+    return false;
+}
+
+Data AssetPack::getData(const Entry& entry, bool forString) const
+{
+    Data ret;
+    const ssize_t allocSize = forString ? entry.size + 1 : entry.size;
+    unsigned char* buffer = (unsigned char*)malloc(allocSize > 0 ? allocSize : 1);
+    if (buffer == nullptr)
+    {
+        CCLOG("cocos2d: AssetPack: can't allocate %d bytes", (int)allocSize);
+        return ret;
+    }
+
+    bool success = false;
+    switch (entry.codec)
+    {
+        case Codec::STORED:
+            memcpy(buffer, entry.bytes, entry.size);
+            success = (entry.size == entry.storedSize);
+            break;
+
+        case Codec::ZLIB:
+        {
+            uLongf destLen = (uLongf)entry.size;
+            int err = uncompress(buffer, &destLen, entry.bytes, (uLong)entry.storedSize);
+            success = (err == Z_OK && destLen == (uLongf)entry.size);
+            break;
+        }
+
+        default:
+            CCLOG("cocos2d: AssetPack: codec %d isn't supported", (int)entry.codec);
+            break;
+    }
+
+    if (!success)
+    {
+        CCLOG("cocos2d: AssetPack: can't decode an entry");
+        free(buffer);
+        return ret;
+    }
+
+    if (forString)
+    {
+        buffer[entry.size] = '\0';
+    }
+    ret.fastSet(buffer, entry.size);
+    return ret;
+}
+
+FileView AssetPack::getFileView(const Entry& entry)
+{
+    if (entry.codec == Codec::STORED)
+    {
+        auto self = shared_from_this();
+        return FileView(entry.bytes, entry.size, [self]() {});
+    }
+
+    return FileView(getData(entry, false));
+}
+
+NS_CC_END
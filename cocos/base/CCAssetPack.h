@@ -0,0 +1,123 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CC_ASSET_PACK_H__
+#define __CC_ASSET_PACK_H__
+
+#include <memory>
+#include <string>
+
+#include "platform/CCFileUtils.h"
+
+/**
+ * @addtogroup base
+ * @{
+ */
+
+NS_CC_BEGIN
+
+/**
+ An AssetPack is a read-only archive of many files with an index that is looked up in O(1),
+ it is mounted with FileUtils::mountAssetPack().
+
+ The pack is read through FileUtils::getFileView(), so it is memory mapped (an asset buffer on Android,
+ keep it uncompressed in the apk). All the integers are little endian:
+
+     header   "CCPK", u32 version (1), u32 entryCount, u32 bucketCount (a power of two),
+              u32 bucketsOffset, u32 entriesOffset, u32 namesOffset, u32 reserved
+     buckets  u32[bucketCount], the index + 1 of the first entry of the bucket, 0 when it is empty
+     entries  u32 hash, u32 next (index + 1 of the next entry in the bucket, or 0),
+              u32 nameOffset, u32 nameLength, u32 dataOffset, u32 size, u32 storedSize, u32 codec
+     names    the paths of the entries relative to the pack, with '/' separators and no terminator
+     data     the stored bytes of the entries
+
+ The hash is the 32 bits FNV-1a of the path, the bucket of an entry is `hash & (bucketCount - 1)`.
+ Name offsets are relative to the names, data offsets to the beginning of the pack.
+ @js NA
+ */
+class CC_DLL AssetPack : public std::enable_shared_from_this<AssetPack>
+{
+public:
+    /** How the bytes of an entry are stored. */
+    enum class Codec
+    {
+        STORED = 0,
+        /** zlib stream of `size` bytes. */
+        ZLIB = 1,
+        /** Reserved, there is no LZ4 decoder in the engine yet. */
+        LZ4 = 2,
+    };
+
+    struct Entry
+    {
+        const unsigned char* bytes;
+        ssize_t size;
+        ssize_t storedSize;
+        Codec codec;
+    };
+
+    /**
+     Opens the pack in `view`.
+     @return nullptr if the view isn't a valid pack.
+     */
+    static std::shared_ptr<AssetPack> create(FileView&& view);
+
+    /** The 32 bits FNV-1a hash of the pack index. */
+    static unsigned int hash(const char* name, size_t length);
+
+    /** Finds the entry of `name`, returns false when the pack doesn't have it. */
+    bool findEntry(const char* name, size_t length, Entry* entry) const;
+    bool findEntry(const std::string& name, Entry* entry) const { return findEntry(name.c_str(), name.length(), entry); }
+
+    /** Returns the bytes of the entry, null with a message in the log when they can't be decoded. */
+    Data getData(const Entry& entry, bool forString) const;
+
+    /** Returns a view of the entry, a stored entry is not copied and keeps the pack alive. */
+    FileView getFileView(const Entry& entry);
+
+    ssize_t getEntryCount() const { return _entryCount; }
+
+    ~AssetPack();
+
+protected:
+    AssetPack(FileView&& view);
+    bool init();
+
+    FileView _view;
+    unsigned int _entryCount;
+    unsigned int _bucketMask;
+    const unsigned char* _buckets;
+    const unsigned char* _entries;
+    const unsigned char* _names;
+    ssize_t _namesSize;
+};
+
+NS_CC_END
+
+/**
+ end of support group
+ @}
+ */
+#endif //__CC_ASSET_PACK_H__
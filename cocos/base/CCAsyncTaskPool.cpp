@@ -28,6 +28,7 @@ THE SOFTWARE.
 NS_CC_BEGIN
 
 AsyncTaskPool* AsyncTaskPool::s_asyncTaskPool = nullptr;
+std::atomic<AsyncTaskPool::AsyncTaskCallBack*> AsyncTaskPool::s_finishedCallBacks(nullptr);
 
 AsyncTaskPool* AsyncTaskPool::getInstance()
 {
@@ -42,14 +43,73 @@ void AsyncTaskPool::destoryInstance()
 {
     delete s_asyncTaskPool;
     s_asyncTaskPool = nullptr;
+
+    // the task threads are joined, the callbacks they pushed are not called anymore
+    deleteCallBacks(s_finishedCallBacks.exchange(nullptr, std::memory_order_acquire));
 }
 
 AsyncTaskPool::AsyncTaskPool()
+: _pendingCallBacks(nullptr)
+, _lastPendingCallBack(nullptr)
+, _maxCallbacksPerFrame(CC_ASYNC_TASK_POOL_MAX_CALLBACKS_PER_FRAME)
 {
 }
 
 AsyncTaskPool::~AsyncTaskPool()
 {
+    deleteCallBacks(_pendingCallBacks);
+}
+
+void AsyncTaskPool::deleteCallBacks(AsyncTaskCallBack* callbacks)
+{
+    while (callbacks)
+    {
+        auto next = callbacks->next;
+        delete callbacks;
+        callbacks = next;
+    }
+}
+
+unsigned int AsyncTaskPool::dispatchCallbacks()
+{
+    auto pool = s_asyncTaskPool;
+    if (pool == nullptr)
+        return 0;
+
+    // take all the finished tasks at once, the list is the newest first so reverse it
+    auto finished = s_finishedCallBacks.exchange(nullptr, std::memory_order_acquire);
+    if (finished)
+    {
+        AsyncTaskCallBack* first = nullptr;
+        auto last = finished;
+        while (finished)
+        {
+            auto next = finished->next;
+            finished->next = first;
+            first = finished;
+            finished = next;
+        }
+
+        if (pool->_lastPendingCallBack)
+            pool->_lastPendingCallBack->next = first;
+        else
+            pool->_pendingCallBacks = first;
+        pool->_lastPendingCallBack = last;
+    }
+
+    unsigned int count = 0;
+    while (pool->_pendingCallBacks && (pool->_maxCallbacksPerFrame == 0 || count < pool->_maxCallbacksPerFrame))
+    {
+        auto callback = pool->_pendingCallBacks;
+        pool->_pendingCallBacks = callback->next;
+        if (pool->_pendingCallBacks == nullptr)
+            pool->_lastPendingCallBack = nullptr;
+        ++count;
+
+        callback->callback(callback->callbackParam);
+        delete callback;
+    }
+    return count;
 }
 
 NS_CC_END
@@ -30,6 +30,7 @@ THE SOFTWARE.
 #include "base/CCScheduler.h"
 #include <vector>
 #include <queue>
+#include <atomic>
 #include <memory>
 #include <thread>
 #include <mutex>
@@ -48,6 +49,8 @@ NS_CC_BEGIN
 /**
  * @class AsyncTaskPool
  * @brief This class allows to perform background operations without having to manipulate threads.
+ * The task threads hand the finished tasks over to the main thread through a lock-free list,
+ * their callbacks are called in batches once per frame.
  * @js NA
  */
 class CC_DLL AsyncTaskPool
@@ -92,19 +95,52 @@ public:
     template<class F>
     inline void enqueue(TaskType type, const TaskCallBack& callback, void* callbackParam, F&& f);
 
+    /**
+     * Sets the max number of task callbacks called per frame, 0 means no limit.
+     * The callbacks over the limit are called in the next frames, in the order the tasks finished.
+     * CC_ASYNC_TASK_POOL_MAX_CALLBACKS_PER_FRAME by default.
+     * @since v3.11
+     */
+    void setMaxCallbacksPerFrame(unsigned int maxCallbacks) { _maxCallbacksPerFrame = maxCallbacks; }
+    /**
+     * Gets the max number of task callbacks called per frame.
+     * @since v3.11
+     */
+    unsigned int getMaxCallbacksPerFrame() const { return _maxCallbacksPerFrame; }
+
+    /**
+     * Calls the callbacks of the tasks finished since the last call, up to the max number per frame.
+     * The Director calls it every frame after the Scheduler, it does nothing if the pool wasn't created.
+     * @return The number of callbacks called.
+     * @since v3.11
+     */
+    static unsigned int dispatchCallbacks();
+
 CC_CONSTRUCTOR_ACCESS:
     AsyncTaskPool();
     ~AsyncTaskPool();
 
 protected:
 
+    // the callback of a task, allocated when it is enqueued so the task thread can hand it over without allocating
+    struct AsyncTaskCallBack
+    {
+        TaskCallBack          callback;
+        void*                 callbackParam;
+        AsyncTaskCallBack*    next;
+    };
+
+    // pushes the callback of a finished task, it's called by the task threads without locking
+    static void pushFinishedCallBack(AsyncTaskCallBack* callback)
+    {
+        callback->next = s_finishedCallBacks.load(std::memory_order_relaxed);
+        while (!s_finishedCallBacks.compare_exchange_weak(callback->next, callback, std::memory_order_release, std::memory_order_relaxed))
+        {
+        }
+    }
+
     // thread tasks internally used
     class ThreadTasks {
-        struct AsyncTaskCallBack
-        {
-            TaskCallBack          callback;
-            void*                 callbackParam;
-        };
     public:
         ThreadTasks()
         : _stop(false)
@@ -115,7 +151,7 @@ protected:
                                       for(;;)
                                       {
                                           std::function<void()> task;
-                                          AsyncTaskCallBack callback;
+                                          AsyncTaskCallBack* callback;
                                           {
                                               std::unique_lock<std::mutex> lock(this->_queueMutex);
                                               this->_condition.wait(lock,
@@ -123,13 +159,13 @@ protected:
                                               if(this->_stop && this->_tasks.empty())
                                                   return;
                                               task = std::move(this->_tasks.front());
-                                              callback = std::move(this->_taskCallBacks.front());
+                                              callback = this->_taskCallBacks.front();
                                               this->_tasks.pop();
                                               this->_taskCallBacks.pop();
                                           }
 
                                           task();
-                                          Director::getInstance()->getScheduler()->performFunctionInCocosThread([&, callback]{ callback.callback(callback.callbackParam); });
+                                          pushFinishedCallBack(callback);
                                       }
                                   }
                                   );
@@ -143,7 +179,10 @@ protected:
                 while(_tasks.size())
                     _tasks.pop();
                 while (_taskCallBacks.size())
+                {
+                    delete _taskCallBacks.front();
                     _taskCallBacks.pop();
+                }
             }
             _condition.notify_all();
             _thread.join();
@@ -154,7 +193,10 @@ protected:
             while(_tasks.size())
                 _tasks.pop();
             while (_taskCallBacks.size())
+            {
+                delete _taskCallBacks.front();
                 _taskCallBacks.pop();
+            }
         }
         template<class F>
         void enqueue(const TaskCallBack& callback, void* callbackParam, F&& f)
@@ -171,9 +213,10 @@ protected:
                     return;
                 }
 
-                AsyncTaskCallBack taskCallBack;
-                taskCallBack.callback = callback;
-                taskCallBack.callbackParam = callbackParam;
+                auto taskCallBack = new AsyncTaskCallBack();
+                taskCallBack->callback = callback;
+                taskCallBack->callbackParam = callbackParam;
+                taskCallBack->next = nullptr;
                 _tasks.emplace([task](){ task(); });
                 _taskCallBacks.emplace(taskCallBack);
             }
@@ -185,7 +228,7 @@ protected:
         std::thread _thread;
         // the task queue
         std::queue< std::function<void()> > _tasks;
-        std::queue<AsyncTaskCallBack>            _taskCallBacks;
+        std::queue<AsyncTaskCallBack*>           _taskCallBacks;
 
         // synchronization
         std::mutex _queueMutex;
@@ -193,10 +236,19 @@ protected:
         bool _stop;
     };
 
+    static void deleteCallBacks(AsyncTaskCallBack* callbacks);
+
     //tasks
     ThreadTasks _threadTasks[int(TaskType::TASK_MAX_TYPE)];
 
+    // the callbacks taken from s_finishedCallBacks but not called yet because of the limit, the oldest first
+    AsyncTaskCallBack* _pendingCallBacks;
+    AsyncTaskCallBack* _lastPendingCallBack;
+    unsigned int _maxCallbacksPerFrame;
+
     static AsyncTaskPool* s_asyncTaskPool;
+    // the callbacks of the finished tasks, the newest first
+    static std::atomic<AsyncTaskCallBack*> s_finishedCallBacks;
 };
 
 inline void AsyncTaskPool::stopTasks(TaskType type)
@@ -25,25 +25,33 @@ THE SOFTWARE.
 #include "base/CCAutoreleasePool.h"
 #include "base/ccMacros.h"
 
+#include <algorithm>
+
 NS_CC_BEGIN
 
 AutoreleasePool::AutoreleasePool()
-: _name("")
+: _top(nullptr)
+, _end(nullptr)
+, _lastClearCount(0)
+, _peakClearCount(0)
+, _name("")
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
 , _isClearing(false)
 #endif
 {
-    _managedObjectArray.reserve(150);
     PoolManager::getInstance()->push(this);
 }
 
 AutoreleasePool::AutoreleasePool(const std::string &name)
-: _name(name)
+: _top(nullptr)
+, _end(nullptr)
+, _lastClearCount(0)
+, _peakClearCount(0)
+, _name(name)
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
 , _isClearing(false)
 #endif
 {
-    _managedObjectArray.reserve(150);
     PoolManager::getInstance()->push(this);
 }
 
@@ -52,25 +60,82 @@ AutoreleasePool::~AutoreleasePool()
     CCLOGINFO("deallocing AutoreleasePool: %p", this);
     clear();
 
+    for (auto chunk : _chunks)
+    {
+        delete chunk;
+    }
+    for (auto chunk : _freeChunks)
+    {
+        delete chunk;
+    }
+
     PoolManager::getInstance()->pop();
 }
 
 void AutoreleasePool::addObject(Ref* object)
 {
-    _managedObjectArray.push_back(object);
+    if (_top == _end)
+    {
+        nextChunk();
+    }
+    *_top++ = object;
+}
+
+void AutoreleasePool::nextChunk()
+{
+    Chunk* chunk = nullptr;
+    if (_freeChunks.empty())
+    {
+        chunk = new Chunk();
+    }
+    else
+    {
+        chunk = _freeChunks.back();
+        _freeChunks.pop_back();
+    }
+    _chunks.push_back(chunk);
+    _top = chunk->objects;
+    _end = chunk->objects + CHUNK_SIZE;
+}
+
+size_t AutoreleasePool::getObjectCount() const
+{
+    if (_chunks.empty())
+        return 0;
+    return (_chunks.size() - 1) * CHUNK_SIZE + (_top - _chunks.back()->objects);
 }
 
 void AutoreleasePool::clear()
 {
+    if (_chunks.empty())
+    {
+        _lastClearCount = 0;
+        return;
+    }
+
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
     _isClearing = true;
 #endif
-    std::vector<Ref*> releasings;
-    releasings.swap(_managedObjectArray);
-    for (const auto &obj : releasings)
+    // the objects autoreleased by the destructors go to new chunks, released by the next clear
+    size_t count = getObjectCount();
+    Ref** top = _top;
+    _releasingChunks.swap(_chunks);
+    _top = _end = nullptr;
+
+    for (size_t i = 0, n = _releasingChunks.size(); i < n; ++i)
     {
-        obj->release();
+        Ref** obj = _releasingChunks[i]->objects;
+        Ref** end = (i + 1 == n) ? top : obj + CHUNK_SIZE;
+        for (; obj != end; ++obj)
+        {
+            (*obj)->release();
+        }
     }
+
+    _freeChunks.insert(_freeChunks.end(), _releasingChunks.begin(), _releasingChunks.end());
+    _releasingChunks.clear();
+    _lastClearCount = count;
+    _peakClearCount = std::max(_peakClearCount, count);
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
     _isClearing = false;
 #endif
@@ -78,22 +143,31 @@ void AutoreleasePool::clear()
 
 bool AutoreleasePool::contains(Ref* object) const
 {
-    for (const auto& obj : _managedObjectArray)
+    for (size_t i = 0, n = _chunks.size(); i < n; ++i)
     {
-        if (obj == object)
-            return true;
+        Ref* const* obj = _chunks[i]->objects;
+        Ref* const* end = (i + 1 == n) ? _top : obj + CHUNK_SIZE;
+        for (; obj != end; ++obj)
+        {
+            if (*obj == object)
+                return true;
+        }
     }
     return false;
 }
 
 void AutoreleasePool::dump()
 {
-    CCLOG("autorelease pool: %s, number of managed object %d\n", _name.c_str(), static_cast<int>(_managedObjectArray.size()));
+    CCLOG("autorelease pool: %s, number of managed object %d\n", _name.c_str(), static_cast<int>(getObjectCount()));
     CCLOG("%20s%20s%20s", "Object pointer", "Object id", "reference count");
-    for (const auto &obj : _managedObjectArray)
+    for (size_t i = 0, n = _chunks.size(); i < n; ++i)
     {
-        CC_UNUSED_PARAM(obj);
-        CCLOG("%20p%20u\n", obj, obj->getReferenceCount());
+        Ref** obj = _chunks[i]->objects;
+        Ref** end = (i + 1 == n) ? _top : obj + CHUNK_SIZE;
+        for (; obj != end; ++obj)
+        {
+            CCLOG("%20p%20u\n", *obj, (*obj)->getReferenceCount());
+        }
     }
 }
 
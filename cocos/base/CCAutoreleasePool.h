@@ -111,6 +111,30 @@ public:
      */
     bool contains(Ref* object) const;
 
+    /**
+     * Gets the number of objects added to the pool since it was last cleared, e.g. by the current frame.
+     *
+     * @js NA
+     * @lua NA
+     */
+    size_t getObjectCount() const;
+
+    /**
+     * Gets the number of objects released by the last clear(), e.g. the objects autoreleased by the last frame.
+     *
+     * @js NA
+     * @lua NA
+     */
+    size_t getLastClearCount() const { return _lastClearCount; }
+
+    /**
+     * Gets the max number of objects released by one clear(), e.g. the objects autoreleased by the busiest frame.
+     *
+     * @js NA
+     * @lua NA
+     */
+    size_t getPeakClearCount() const { return _peakClearCount; }
+
     /**
      * Dump the objects that are put into the autorelease pool. It is used for debugging.
      *
@@ -123,16 +147,32 @@ public:
     void dump();
 
 private:
+    static const int CHUNK_SIZE = 512;
+
     /**
-     * The underlying array of object managed by the pool.
+     * The objects are stored in chunks of fixed size, so adding one never moves the others like a growing
+     * vector does. The chunks released by clear() are kept for the next frames.
      *
-     * Although Array retains the object once when an object is added, proper
-     * Ref::release() is called outside the array to make sure that the pool
-     * does not affect the managed object's reference count. So an object can
-     * be destructed properly by calling Ref::release() even if the object
-     * is in the pool.
+     * The pool doesn't retain the objects, proper Ref::release() is called by clear() to make sure that the
+     * pool does not affect the managed object's reference count. So an object can be destructed properly by
+     * calling Ref::release() even if the object is in the pool.
      */
-    std::vector<Ref*> _managedObjectArray;
+    struct Chunk
+    {
+        Ref* objects[CHUNK_SIZE];
+    };
+
+    void nextChunk();
+
+    /** The chunks in use, the last one is being filled from _top to _end. */
+    std::vector<Chunk*> _chunks;
+    std::vector<Chunk*> _freeChunks;
+    /** The chunks clear() is releasing, a member to keep its capacity. */
+    std::vector<Chunk*> _releasingChunks;
+    Ref** _top;
+    Ref** _end;
+    size_t _lastClearCount;
+    size_t _peakClearCount;
     std::string _name;
 
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
@@ -43,6 +43,8 @@ Configuration::Configuration()
 , _maxModelviewStackDepth(0)
 , _supportsPVRTC(false)
 , _supportsETC1(false)
+, _supportsETC2(false)
+, _supportsASTC(false)
 //, _supportsS3TC(false)
 //, _supportsATITC(false)
 , _supportsNPOT(false)
@@ -51,6 +53,12 @@ Configuration::Configuration()
 , _supportsShareableVAO(false)
 , _supportsOESDepth24(false)
 , _supportsOESPackedDepthStencil(false)
+, _supportsMapBufferRange(false)
+, _supportsSyncObjects(false)
+, _supportsInstancing(false)
+, _supportsTimerQuery(false)
+, _supportsPixelBufferObject(false)
+, _supportsProgramBinary(false)
 , _maxSamplesAllowed(0)
 , _maxTextureUnits(0)
 , _glExtensions(nullptr)
@@ -131,6 +139,13 @@ void Configuration::gatherGPUInfo()
     _supportsETC1 = checkForGLExtension("GL_OES_compressed_ETC1_RGB8_texture");
     _valueDict["gl.supports_ETC1"] = Value(_supportsETC1);
 
+    const char* glVersion = (const char*)glGetString(GL_VERSION);
+    _supportsETC2 = (glVersion && strstr(glVersion, "OpenGL ES 3")) || checkForGLExtension("GL_ARB_ES3_compatibility");
+    _valueDict["gl.supports_ETC2"] = Value(_supportsETC2);
+
+    _supportsASTC = checkForGLExtension("texture_compression_astc_ldr");
+    _valueDict["gl.supports_ASTC"] = Value(_supportsASTC);
+
 //    _supportsS3TC = checkForGLExtension("GL_EXT_texture_compression_s3tc");
 //    _valueDict["gl.supports_S3TC"] = Value(_supportsS3TC);
 //
@@ -150,6 +165,17 @@ void Configuration::gatherGPUInfo()
     _valueDict["gl.supports_discard_framebuffer"] = Value(_supportsDiscardFramebuffer);
 
     _supportsShareableVAO = checkForGLExtension("vertex_array_object");
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+    // the OES extension of the GLES2 drivers is unreliable, the VAOs are core in GLES3,
+    // the entry points are resolved at runtime, see initExtensions()
+    _supportsShareableVAO = glVersion && strstr(glVersion, "OpenGL ES 3")
+        && glGenVertexArrays && glBindVertexArray && glDeleteVertexArrays;
+#endif
+    // VAOs aren't shared between contexts, the render thread can't draw the ones created on the main thread
+    if (getValue("cocos2d.x.renderer.render_thread", Value(false)).asBool())
+    {
+        _supportsShareableVAO = false;
+    }
     _valueDict["gl.supports_vertex_array_object"] = Value(_supportsShareableVAO);
 
     _supportsOESDepth24 = checkForGLExtension("GL_OES_depth24");
@@ -158,6 +184,56 @@ void Configuration::gatherGPUInfo()
     _supportsOESPackedDepthStencil = checkForGLExtension("GL_OES_packed_depth_stencil");
     _valueDict["gl.supports_OES_packed_depth_stencil"] = Value(_supportsOESPackedDepthStencil);
 
+    _supportsMapBufferRange = checkForGLExtension("map_buffer_range");
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+    // the entry points are resolved at runtime, see initExtensions()
+    _supportsMapBufferRange = _supportsMapBufferRange && glMapBufferRange && glFlushMappedBufferRange;
+#endif
+    _valueDict["gl.supports_map_buffer_range"] = Value(_supportsMapBufferRange);
+
+    _supportsSyncObjects = checkForGLExtension("GL_APPLE_sync") || checkForGLExtension("GL_ARB_sync");
+    _valueDict["gl.supports_sync_objects"] = Value(_supportsSyncObjects);
+
+    _supportsInstancing = checkForGLExtension("instanced_arrays") || (glVersion && strstr(glVersion, "OpenGL ES 3"));
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_MAC)
+    _supportsInstancing = _supportsInstancing && checkForGLExtension("GL_ARB_draw_instanced");
+#elif (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID) || (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+    // the entry points are resolved at runtime
+    _supportsInstancing = _supportsInstancing && glDrawElementsInstanced && glVertexAttribDivisor;
+#endif
+    _valueDict["gl.supports_instancing"] = Value(_supportsInstancing);
+
+    // GL_EXT_disjoint_timer_query on GLES, GL_EXT_timer_query or GL_ARB_timer_query on desktop
+    _supportsTimerQuery = checkForGLExtension("timer_query");
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID) || (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+    _supportsTimerQuery = _supportsTimerQuery && glGenQueries && glGetQueryObjectui64vEXT;
+#endif
+    _valueDict["gl.supports_timer_query"] = Value(_supportsTimerQuery);
+
+    // core since desktop GL 2.1 and GLES3, the GLES2 extension is NV only
+    _supportsPixelBufferObject = checkForGLExtension("pixel_buffer_object") || (glVersion && strstr(glVersion, "OpenGL ES 3"));
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_MAC) || (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+    _supportsPixelBufferObject = true;
+#endif
+    _valueDict["gl.supports_pixel_buffer_object"] = Value(_supportsPixelBufferObject);
+
+    // GL_OES_get_program_binary on GLES, GL_ARB_get_program_binary on desktop, core in GLES3.
+    // some drivers expose it without any binary format, which is of no use
+    _supportsProgramBinary = checkForGLExtension("get_program_binary") || (glVersion && strstr(glVersion, "OpenGL ES 3"));
+#if CC_GL_PROGRAM_BINARY
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID) || (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+    // the entry points are resolved at runtime
+    _supportsProgramBinary = _supportsProgramBinary && glGetProgramBinary && glProgramBinary;
+#endif
+    if (_supportsProgramBinary)
+    {
+        GLint binaryFormats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormats);
+        _supportsProgramBinary = binaryFormats > 0;
+    }
+#endif
+    _valueDict["gl.supports_program_binary"] = Value(_supportsProgramBinary);
+
     CHECK_GL_ERROR_DEBUG();
 }
 
@@ -221,6 +297,16 @@ bool Configuration::supportsETC() const
 #endif
 }
 
+bool Configuration::supportsETC2() const
+{
+    return _supportsETC2;
+}
+
+bool Configuration::supportsASTC() const
+{
+    return _supportsASTC;
+}
+
 //bool Configuration::supportsS3TC() const
 //{
 //#ifdef GL_EXT_texture_compression_s3tc
@@ -264,6 +350,60 @@ bool Configuration::supportsOESPackedDepthStencil() const
     return _supportsOESPackedDepthStencil;
 }
 
+bool Configuration::supportsMapBufferRange() const
+{
+#if CC_GL_MAP_BUFFER_RANGE
+    return _supportsMapBufferRange;
+#else
+    return false;
+#endif
+}
+
+bool Configuration::supportsInstancing() const
+{
+#if CC_GL_INSTANCING
+    return _supportsInstancing;
+#else
+    return false;
+#endif
+}
+
+bool Configuration::supportsTimerQuery() const
+{
+#if CC_GL_TIMER_QUERY
+    return _supportsTimerQuery;
+#else
+    return false;
+#endif
+}
+
+bool Configuration::supportsPixelBufferObject() const
+{
+#if CC_GL_PIXEL_BUFFER
+    return _supportsPixelBufferObject;
+#else
+    return false;
+#endif
+}
+
+bool Configuration::supportsProgramBinary() const
+{
+#if CC_GL_PROGRAM_BINARY
+    return _supportsProgramBinary;
+#else
+    return false;
+#endif
+}
+
+bool Configuration::supportsSyncObjects() const
+{
+#if CC_GL_SYNC_OBJECTS
+    return _supportsSyncObjects;
+#else
+    return false;
+#endif
+}
+
 int Configuration::getMaxSupportDirLightInShader() const
 {
     return _maxDirLightInShader;
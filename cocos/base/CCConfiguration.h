@@ -107,6 +107,20 @@ public:
      */
     bool supportsETC() const;
 
+    /** Whether or not ETC2/EAC Texture Compressed is supported, it's part of GLES 3.0 and GL 4.3 (ARB_ES3_compatibility).
+     *
+     * @return Is true if supports ETC2/EAC Texture Compressed.
+     * @since v3.11
+     */
+    bool supportsETC2() const;
+
+    /** Whether or not ASTC Texture Compressed is supported (KHR_texture_compression_astc_ldr).
+     *
+     * @return Is true if supports ASTC Texture Compressed.
+     * @since v3.11
+     */
+    bool supportsASTC() const;
+
     /** Whether or not S3TC Texture Compressed is supported.
      *
      * @return Is true if supports S3TC Texture Compressed.
@@ -133,6 +147,7 @@ public:
     bool supportsDiscardFramebuffer() const;
 
     /** Whether or not shareable VAOs are supported.
+     * It is false when the "cocos2d.x.renderer.render_thread" key is set, see Renderer::setRenderThreadEnabled().
      *
      * @return Is true if supports shareable VAOs.
      * @since v2.0.0
@@ -153,6 +168,48 @@ public:
      */
     bool supportsOESPackedDepthStencil() const;
 
+    /** Whether or not glMapBufferRange (EXT/ARB_map_buffer_range) can be used.
+     *
+     * @return Is true if buffer ranges can be mapped.
+     * @since v3.11
+     */
+    bool supportsMapBufferRange() const;
+
+    /** Whether or not fence sync objects (APPLE/ARB_sync) can be used.
+     *
+     * @return Is true if supports fence sync objects.
+     * @since v3.11
+     */
+    bool supportsSyncObjects() const;
+
+    /** Whether or not instanced drawing (glDrawElementsInstanced and glVertexAttribDivisor) can be used.
+     *
+     * @return Is true if supports instanced arrays, from EXT/ARB_instanced_arrays or GLES3.
+     * @since v3.11
+     */
+    bool supportsInstancing() const;
+
+    /** Whether or not GPU timer queries (GL_TIME_ELAPSED_EXT) can be used.
+     *
+     * @return Is true if supports EXT_disjoint_timer_query on GLES, or EXT/ARB_timer_query on desktop GL.
+     * @since v3.11
+     */
+    bool supportsTimerQuery() const;
+
+    /** Whether or not glReadPixels can write into a GL_PIXEL_PACK_BUFFER, without stalling on the GPU.
+     *
+     * @return Is true on desktop GL, or with GLES3 or pixel_buffer_object on GLES.
+     * @since v3.11
+     */
+    bool supportsPixelBufferObject() const;
+
+    /** Whether or not linked programs can be saved with glGetProgramBinary and loaded back with glProgramBinary.
+     *
+     * @return Is true if supports OES_get_program_binary on GLES or ARB_get_program_binary on desktop GL, with a binary format.
+     * @since v3.11
+     */
+    bool supportsProgramBinary() const;
+
     /** Max support directional light in shader, for Sprite3D.
      *
      * @return Maximum supports directional light in shader.
@@ -230,6 +287,8 @@ protected:
     GLint           _maxModelviewStackDepth;
     bool            _supportsPVRTC;
     bool            _supportsETC1;
+    bool            _supportsETC2;
+    bool            _supportsASTC;
 //    bool            _supportsS3TC;
 //    bool            _supportsATITC;
     bool            _supportsNPOT;
@@ -238,6 +297,12 @@ protected:
     bool            _supportsShareableVAO;
     bool            _supportsOESDepth24;
     bool            _supportsOESPackedDepthStencil;
+    bool            _supportsMapBufferRange;
+    bool            _supportsSyncObjects;
+    bool            _supportsInstancing;
+    bool            _supportsTimerQuery;
+    bool            _supportsPixelBufferObject;
+    bool            _supportsProgramBinary;
     GLint           _maxSamplesAllowed;
     GLint           _maxTextureUnits;
     char *          _glExtensions;
@@ -65,8 +65,19 @@
 #include "2d/CCScene.h"
 #include "platform/CCFileUtils.h"
 #include "renderer/CCTextureCache.h"
+#include "renderer/CCRenderTargetPool.h"
+#include "renderer/CCPostProcess.h"
+#include "renderer/CCVideoMemory.h"
 #include "base/base64.h"
 #include "base/ccUtils.h"
+#include "base/CCAutoreleasePool.h"
+#include "base/CCEventDispatcher.h"
+#include "base/CCEventListenerCustom.h"
+#include "base/CCFrameTimings.h"
+#include "base/CCRefAllocator.h"
+#include "base/CCAllocationProfiler.h"
+#include "base/CCMemoryPressure.h"
+#include "base/CCTracer.h"
 NS_CC_BEGIN
 
 extern const char* cocos2dVersion();
@@ -130,6 +141,11 @@ static ssize_t mydprintf(int sock, const char *format, ...)
     return send(sock, buf, strlen(buf),0);
 }
 
+// the records of [perf start] waiting for the console thread, the next ones are dropped
+static const size_t MAX_PENDING_PERF_RECORDS = 1024;
+// the size of a binary record of [perf start binary]
+static const size_t PERF_RECORD_SIZE = 64;
+
 static void sendPrompt(int fd)
 {
     const char prompt[] = "> ";
@@ -159,6 +175,37 @@ static void printSceneGraphBoot(int fd)
     sendPrompt(fd);
 }
 
+// "P frame total update actions visit sort fill submit swap gpu batches vertices texture_kb autoreleased", or
+// a 64 bytes little endian record: "CCPF", uint32 frame, 9 floats in the same order, 4 reserved bytes, 4 uint32 counters
+static std::string formatPerfRecord(const FrameTiming& timing, size_t textureBytes, size_t autoreleased, bool binary)
+{
+    const float times[] = { timing.total, timing.update, timing.actions, timing.visit, timing.sort,
+                            timing.batchFill, timing.submit, timing.swap, timing.gpu };
+    const int timeCount = sizeof(times) / sizeof(times[0]);
+
+    if (binary)
+    {
+        char record[PERF_RECORD_SIZE] = { 'C', 'C', 'P', 'F' };
+        uint32_t counters[] = { (uint32_t)timing.drawnBatches, (uint32_t)timing.drawnVertices,
+                                (uint32_t)(textureBytes / 1024), (uint32_t)autoreleased };
+        uint32_t frame = timing.frame;
+        memcpy(record + 4, &frame, 4);
+        memcpy(record + 8, times, sizeof(times));
+        memcpy(record + 48, counters, sizeof(counters));
+        return std::string(record, sizeof(record));
+    }
+
+    char line[256];
+    int length = snprintf(line, sizeof(line), "P %u", timing.frame);
+    for (int i = 0; i < timeCount; ++i)
+    {
+        length += snprintf(line + length, sizeof(line) - length, " %.2f", times[i]);
+    }
+    snprintf(line + length, sizeof(line) - length, " %ld %ld %lu %lu\n", (long)timing.drawnBatches, (long)timing.drawnVertices,
+             (unsigned long)(textureBytes / 1024), (unsigned long)autoreleased);
+    return line;
+}
+
 static void printFileUtils(int fd)
 {
     FileUtils* fu = FileUtils::getInstance();
@@ -179,7 +226,7 @@ static void printFileUtils(int fd)
     mydprintf(fd, "%s\n", fu->getWritablePath().c_str());
 
     mydprintf(fd, "\nFull Path Cache:\n");
-    auto& cache = fu->getFullPathCache();
+    auto cache = fu->getFullPathCache();
     for( const auto &item : cache) {
         mydprintf(fd, "%s -> %s\n", item.first.c_str(), item.second.c_str());
     }
@@ -331,10 +378,14 @@ Console::Console()
 , _running(false)
 , _endThread(false)
 , _sendDebugStrings(false)
+, _perfListener(nullptr)
+, _perfEnabledTimings(false)
 , _bindAddress("")
 {
     // VS2012 doesn't support initializer list, so we create a new array and assign its elements to '_command'.
     Command commands[] = {
+        { "allocations", "Record the allocations per frame, print them per frame on average or for the last frame. Args: [start | stop | frame | ]", std::bind(&Console::commandAllocations, this, std::placeholders::_1, std::placeholders::_2) },
+        { "allocator", "Print the RefAllocator stats or free its lists. Args: [purge | ]", std::bind(&Console::commandAllocator, this, std::placeholders::_1, std::placeholders::_2) },
         { "config", "Print the Configuration object", std::bind(&Console::commandConfig, this, std::placeholders::_1, std::placeholders::_2) },
         { "debugmsg", "Whether or not to forward the debug messages on the console. Args: [on | off]", [&](int fd, const std::string& args) {
             if( args.compare("on")==0 || args.compare("off")==0) {
@@ -356,13 +407,17 @@ Console::Console()
             }
         } },
         { "help", "Print this message", std::bind(&Console::commandHelp, this, std::placeholders::_1, std::placeholders::_2) },
+        { "memory", "Shrink the caches for a memory pressure level, set the resident budget in MB or print the report. Args: [low | medium | critical | budget MB | ]", std::bind(&Console::commandMemory, this, std::placeholders::_1, std::placeholders::_2) },
+        { "perf", "Stream the frame timings, draw calls, texture memory and autoreleased objects. Args: [start [frames] [line | binary] | stop | help | ]", std::bind(&Console::commandPerf, this, std::placeholders::_1, std::placeholders::_2) },
         { "projection", "Change or print the current projection. Args: [2d | 3d]", std::bind(&Console::commandProjection, this, std::placeholders::_1, std::placeholders::_2) },
         { "resolution", "Change or print the window resolution. Args: [width height resolution_policy | ]", std::bind(&Console::commandResolution, this, std::placeholders::_1, std::placeholders::_2) },
         { "scenegraph", "Print the scene graph", std::bind(&Console::commandSceneGraph, this, std::placeholders::_1, std::placeholders::_2) },
-        { "texture", "Flush or print the TextureCache info. Args: [flush | ] ", std::bind(&Console::commandTextures, this, std::placeholders::_1, std::placeholders::_2) },
+        { "texture", "Flush, set the memory budget in MB or print the TextureCache info. Args: [flush | budget MB | ] ", std::bind(&Console::commandTextures, this, std::placeholders::_1, std::placeholders::_2) },
+        { "trace", "Record the traced zones and write them as a Chrome trace, in the writable path by default. Args: [start | stop [file] | ]", std::bind(&Console::commandTrace, this, std::placeholders::_1, std::placeholders::_2) },
         { "director", "director commands, type -h or [director help] to list supported directives", std::bind(&Console::commandDirector, this, std::placeholders::_1, std::placeholders::_2) },
         { "touch", "simulate touch event via console, type -h or [touch help] to list supported directives", std::bind(&Console::commandTouch, this, std::placeholders::_1, std::placeholders::_2) },
         { "upload", "upload file. Args: [filename base64_encoded_data]", std::bind(&Console::commandUpload, this, std::placeholders::_1) },
+        { "vram", "Print the video memory of the textures and buffers, by owner and by texture. Args: [scene | all | ]", std::bind(&Console::commandVideoMemory, this, std::placeholders::_1, std::placeholders::_2) },
         { "version", "print version string ", [](int fd, const std::string& args) {
             mydprintf(fd, "%s\n", cocos2dVersion());
         } },
@@ -378,6 +433,11 @@ Console::Console()
 Console::~Console()
 {
     stop();
+
+    if (_perfListener)
+    {
+        Director::DirectorInstance->getEventDispatcher()->removeEventListener(_perfListener);
+    }
 }
 
 bool Console::listenOnTCP(int port)
@@ -520,6 +580,7 @@ void Console::commandHelp(int fd, const std::string &args)
 
 void Console::commandExit(int fd, const std::string &args)
 {
+    removePerfClient(fd);
     FD_CLR(fd, &_read_set);
     _fds.erase(std::remove(_fds.begin(), _fds.end(), fd), _fds.end());
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32) || (CC_TARGET_PLATFORM == CC_PLATFORM_WINRT)
@@ -658,17 +719,201 @@ void Console::commandTextures(int fd, const std::string& args)
         }
                                             );
     }
+    else if(args.compare(0, 7, "budget ") == 0 && isFloat(args.substr(7)))
+    {
+        size_t budget = (size_t)(std::max(atof(args.substr(7).c_str()), 0.0) * 1024 * 1024);
+        sched->performFunctionInCocosThread( [=](){
+            Director::DirectorInstance->getTextureCache()->setMemoryBudget(budget);
+        }
+                                            );
+    }
     else if(args.empty())
     {
         sched->performFunctionInCocosThread( [=](){
             mydprintf(fd, "%s", Director::DirectorInstance->getTextureCache()->getCachedTextureInfo().c_str());
+            mydprintf(fd, "%s", RenderTargetPool::getInstance()->getDescription().c_str());
+            mydprintf(fd, "%s\n", Director::DirectorInstance->getPostProcessStack()->getDescription().c_str());
             sendPrompt(fd);
         }
                                             );
     }
     else
     {
-        mydprintf(fd, "Unsupported argument: '%s'. Supported arguments: 'flush' or nothing", args.c_str());
+        mydprintf(fd, "Unsupported argument: '%s'. Supported arguments: 'flush', 'budget MB' or nothing", args.c_str());
+    }
+}
+
+void Console::commandVideoMemory(int fd, const std::string& args)
+{
+    Scheduler *sched = Director::DirectorInstance->getScheduler();
+
+    if (args.empty() || args.compare("scene") == 0 || args.compare("all") == 0)
+    {
+        // the 20 largest textures by default, every texture of the scene or every texture otherwise
+        bool sceneOnly = args.compare("scene") == 0;
+        size_t limit = args.empty() ? 20 : 0;
+        sched->performFunctionInCocosThread( [=](){
+            auto report = VideoMemory::getReport();
+            mydprintf(fd, "%s", VideoMemory::getDescription(report, sceneOnly, limit).c_str());
+            sendPrompt(fd);
+        }
+                                            );
+    }
+    else
+    {
+        mydprintf(fd, "Unsupported argument: '%s'. Supported arguments: 'scene', 'all' or nothing\n", args.c_str());
+    }
+}
+
+void Console::commandAllocator(int fd, const std::string& args)
+{
+    Scheduler *sched = Director::DirectorInstance->getScheduler();
+
+    if (args.compare("purge") == 0)
+    {
+        // the free lists of the main thread, where the Refs are released
+        sched->performFunctionInCocosThread( [](){
+            RefAllocator::purge();
+        }
+                                            );
+    }
+    else if (args.empty())
+    {
+#if CC_ENABLE_REF_ALLOCATOR
+        auto stats = RefAllocator::getStats();
+        size_t freeBytes = 0;
+        mydprintf(fd, "size\thits\tmisses\tfree\n");
+        for (auto& classStats : stats)
+        {
+            mydprintf(fd, "%d\t%u\t%u\t%u\n", (int)classStats.objectSize, classStats.hits, classStats.misses, classStats.freeCount);
+            freeBytes += classStats.objectSize * classStats.freeCount;
+        }
+        mydprintf(fd, "%d size classes, %.2f KB in the free lists\n", (int)stats.size(), freeBytes / 1024.0f);
+#else
+        mydprintf(fd, "RefAllocator is disabled, see CC_ENABLE_REF_ALLOCATOR\n");
+#endif
+    }
+    else
+    {
+        mydprintf(fd, "Unsupported argument: '%s'. Supported arguments: 'purge' or nothing\n", args.c_str());
+    }
+}
+
+void Console::commandMemory(int fd, const std::string& args)
+{
+    Scheduler *sched = Director::DirectorInstance->getScheduler();
+
+    if (args.compare("low") == 0 || args.compare("medium") == 0 || args.compare("critical") == 0)
+    {
+        auto level = args.compare("low") == 0 ? MemoryPressure::Level::LOW
+                   : args.compare("medium") == 0 ? MemoryPressure::Level::MEDIUM
+                   : MemoryPressure::Level::CRITICAL;
+        sched->performFunctionInCocosThread( [=](){
+            MemoryPressure::getInstance()->trim(level);
+            mydprintf(fd, "%s", MemoryPressure::getInstance()->getReport().c_str());
+            sendPrompt(fd);
+        }
+                                            );
+    }
+    else if (args.compare(0, 7, "budget ") == 0 && isFloat(args.substr(7)))
+    {
+        size_t budget = (size_t)(std::max(atof(args.substr(7).c_str()), 0.0) * 1024 * 1024);
+        sched->performFunctionInCocosThread( [=](){
+            MemoryPressure::getInstance()->setResidentBudget(budget);
+        }
+                                            );
+    }
+    else if (args.empty())
+    {
+        sched->performFunctionInCocosThread( [=](){
+            mydprintf(fd, "%s", MemoryPressure::getInstance()->getReport().c_str());
+            sendPrompt(fd);
+        }
+                                            );
+    }
+    else
+    {
+        mydprintf(fd, "Unsupported argument: '%s'. Supported arguments: 'low', 'medium', 'critical', 'budget MB' or nothing\n", args.c_str());
+    }
+}
+
+void Console::commandTrace(int fd, const std::string& args)
+{
+    Scheduler *sched = Director::DirectorInstance->getScheduler();
+
+    if (args.compare("start") == 0)
+    {
+        // Tracer is started and stopped from the main thread
+        sched->performFunctionInCocosThread( [](){
+            Tracer::start();
+        }
+                                            );
+    }
+    else if (args.compare("stop") == 0 || args.compare(0, 5, "stop ") == 0)
+    {
+        std::string file = args.length() > 5 ? args.substr(5) : "trace.json";
+        sched->performFunctionInCocosThread( [=](){
+            Tracer::stop();
+            std::string path = FileUtils::getInstance()->isAbsolutePath(file) ? file : FileUtils::getInstance()->getWritablePath() + file;
+            if (Tracer::writeChromeTrace(path))
+            {
+                mydprintf(fd, "Trace written to %s, %d zones dropped\n", path.c_str(), Tracer::getDroppedZones());
+            }
+            else
+            {
+                mydprintf(fd, "Can't write the trace to %s\n", path.c_str());
+            }
+            sendPrompt(fd);
+        }
+                                            );
+    }
+    else if (args.empty())
+    {
+#if CC_ENABLE_TRACING
+        mydprintf(fd, "Tracing is: %s\n", Tracer::isRecording() ? "recording" : "stopped");
+#else
+        mydprintf(fd, "Tracing is disabled, see CC_ENABLE_TRACING\n");
+#endif
+    }
+    else
+    {
+        mydprintf(fd, "Unsupported argument: '%s'. Supported arguments: 'start', 'stop [file]' or nothing\n", args.c_str());
+    }
+}
+
+void Console::commandAllocations(int fd, const std::string& args)
+{
+    Scheduler *sched = Director::DirectorInstance->getScheduler();
+
+    if (args.compare("start") == 0 || args.compare("stop") == 0)
+    {
+        bool enabled = args.compare("start") == 0;
+        // from the main thread, which the Refs are counted on
+        sched->performFunctionInCocosThread( [=](){
+            AllocationProfiler::getInstance()->setEnabled(enabled);
+        }
+                                            );
+    }
+    else if (args.compare("frame") == 0)
+    {
+        auto entries = AllocationProfiler::getInstance()->getLastFrame();
+        mydprintf(fd, "count\tbytes\tname\n");
+        for (auto& entry : entries)
+        {
+            mydprintf(fd, "%u\t%d\t%s\n", entry.count, (int)entry.bytes, entry.name.c_str());
+        }
+    }
+    else if (args.empty())
+    {
+#if CC_ENABLE_ALLOCATION_PROFILER
+        mydprintf(fd, "%s", AllocationProfiler::getInstance()->getReport(30).c_str());
+#else
+        mydprintf(fd, "AllocationProfiler is disabled, see CC_ENABLE_ALLOCATION_PROFILER\n");
+#endif
+    }
+    else
+    {
+        mydprintf(fd, "Unsupported argument: '%s'. Supported arguments: 'start', 'stop', 'frame' or nothing\n", args.c_str());
     }
 }
 
@@ -718,6 +963,159 @@ void Console::commandDirector(int fd, const std::string& args)
 
 }
 
+void Console::commandPerf(int fd, const std::string& args)
+{
+    auto argv = split(args, ' ');
+    std::string directive = argv.empty() ? "" : argv[0];
+    auto sched = Director::DirectorInstance->getScheduler();
+
+    if (directive == "help" || directive == "-h")
+    {
+        const char help[] = "available perf directives:\n"
+                            "\tstart [frames] [line | binary], send a record every [frames] frames, 1 by default. The line records are\n"
+                            "\t\tP frame total update actions visit sort fill submit swap gpu batches vertices texture_kb autoreleased\n"
+                            "\t\tthe times are in ms, -1 when unknown. The binary records take 64 bytes, see formatPerfRecord()\n"
+                            "\tstop, stop sending records\n"
+                            "\twithout directive, print the record of the last frame\n";
+        send(fd, help, sizeof(help) - 1, 0);
+    }
+    else if (directive == "start")
+    {
+        PerfClient client = { fd, 1, false, 0 };
+        for (size_t i = 1; i < argv.size(); ++i)
+        {
+            if (argv[i] == "line" || argv[i] == "binary")
+            {
+                client.binary = (argv[i] == "binary");
+            }
+            else if (isFloat(argv[i]) && atoi(argv[i].c_str()) >= 1)
+            {
+                client.interval = atoi(argv[i].c_str());
+            }
+            else
+            {
+                mydprintf(fd, "Unsupported argument: '%s'. Type [perf help] for options\n", argv[i].c_str());
+                return;
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_perfMutex);
+            _perfClients.erase(std::remove_if(_perfClients.begin(), _perfClients.end(), [fd](const PerfClient& item){ return item.fd == fd; }), _perfClients.end());
+            _perfClients.push_back(client);
+        }
+
+        sched->performFunctionInCocosThread([this](){
+            auto director = Director::DirectorInstance;
+            if (!director->isFrameTimingsEnabled())
+            {
+                director->setFrameTimingsEnabled(true);
+                _perfEnabledTimings = true;
+            }
+            if (_perfListener == nullptr)
+            {
+                _perfListener = director->getEventDispatcher()->addCustomEventListener(Director::EVENT_AFTER_DRAW, [this](EventCustom*){
+                    updatePerfClients();
+                });
+            }
+        });
+    }
+    else if (directive == "stop")
+    {
+        removePerfClient(fd);
+    }
+    else if (directive.empty())
+    {
+        sched->performFunctionInCocosThread([=](){
+            auto director = Director::DirectorInstance;
+            auto timings = director->getFrameTimings();
+            if (timings == nullptr || timings->size() < 2)
+            {
+                mydprintf(fd, "The frame timings are off, type [perf start]\n");
+            }
+            else
+            {
+                auto record = formatPerfRecord(timings->at(1), director->getTextureCache()->getTotalTextureBytes(),
+                                               PoolManager::getInstance()->getCurrentPool()->getLastClearCount(), false);
+                send(fd, record.c_str(), record.length(), 0);
+            }
+            sendPrompt(fd);
+        });
+    }
+    else
+    {
+        mydprintf(fd, "Unsupported argument: '%s'. Type [perf help] for options\n", args.c_str());
+    }
+}
+
+void Console::updatePerfClients()
+{
+    auto director = Director::DirectorInstance;
+    std::lock_guard<std::mutex> lock(_perfMutex);
+
+    if (_perfClients.empty())
+    {
+        if (_perfEnabledTimings)
+        {
+            director->setFrameTimingsEnabled(false);
+            _perfEnabledTimings = false;
+        }
+        return;
+    }
+
+    // the previous frame, its total is only known once this one started
+    auto timings = director->getFrameTimings();
+    if (timings == nullptr || timings->size() < 2)
+        return;
+
+    const auto& timing = timings->at(1);
+    size_t textureBytes = 0, autoreleased = 0;
+    bool measured = false;
+    std::string records[2];
+    for (auto& client : _perfClients)
+    {
+        if (++client.frames < client.interval)
+            continue;
+        client.frames = 0;
+
+        if (_perfRecords.size() >= MAX_PENDING_PERF_RECORDS)
+            continue;
+
+        if (!measured)
+        {
+            textureBytes = director->getTextureCache()->getTotalTextureBytes();
+            autoreleased = PoolManager::getInstance()->getCurrentPool()->getLastClearCount();
+            measured = true;
+        }
+        auto& record = records[client.binary ? 1 : 0];
+        if (record.empty())
+        {
+            record = formatPerfRecord(timing, textureBytes, autoreleased, client.binary);
+        }
+        _perfRecords.push_back(std::make_pair(client.fd, record));
+    }
+}
+
+void Console::removePerfClient(int fd)
+{
+    std::lock_guard<std::mutex> lock(_perfMutex);
+    _perfClients.erase(std::remove_if(_perfClients.begin(), _perfClients.end(), [fd](const PerfClient& item){ return item.fd == fd; }), _perfClients.end());
+    _perfRecords.erase(std::remove_if(_perfRecords.begin(), _perfRecords.end(), [fd](const std::pair<int, std::string>& item){ return item.first == fd; }), _perfRecords.end());
+}
+
+void Console::sendPerfRecords()
+{
+    std::vector<std::pair<int, std::string>> records;
+    {
+        std::lock_guard<std::mutex> lock(_perfMutex);
+        records.swap(_perfRecords);
+    }
+    for (const auto& record : records)
+    {
+        send(record.first, record.second.data(), record.second.length(), 0);
+    }
+}
+
 void Console::commandTouch(int fd, const std::string& args)
 {
     if(args =="help" || args == "-h")
@@ -1191,6 +1589,7 @@ void Console::loop()
 
             /* remove closed connections */
             for(int fd: to_remove) {
+                removePerfClient(fd);
                 FD_CLR(fd, &_read_set);
                 _fds.erase(std::remove(_fds.begin(), _fds.end(), fd), _fds.end());
             }
@@ -1209,6 +1608,8 @@ void Console::loop()
                 _DebugStringsMutex.unlock();
             }
         }
+
+        sendPerfRecords();
     }
 
     // clean up: ignore stdin, stdout and stderr
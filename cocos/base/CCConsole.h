@@ -53,6 +53,8 @@ typedef SSIZE_T ssize_t;
 
 NS_CC_BEGIN
 
+class EventListenerCustom;
+
 /// The max length of CCLog message.
 static const int MAX_LOG_LENGTH = 16*1024;
 
@@ -130,6 +132,25 @@ protected:
     void commandDirector(int fd, const std::string &args);
     void commandTouch(int fd, const std::string &args);
     void commandUpload(int fd);
+    void commandPerf(int fd, const std::string &args);
+    void commandAllocator(int fd, const std::string &args);
+    void commandMemory(int fd, const std::string &args);
+    void commandAllocations(int fd, const std::string &args);
+    void commandTrace(int fd, const std::string &args);
+    void commandVideoMemory(int fd, const std::string &args);
+
+    // [perf start]: the main thread formats a record per client after each drawn frame,
+    // the console thread sends them
+    struct PerfClient
+    {
+        int fd;
+        int interval;
+        bool binary;
+        int frames;
+    };
+    void updatePerfClients();
+    void removePerfClient(int fd);
+    void sendPerfRecords();
     // file descriptor: socket, console, etc.
     int _listenfd;
     int _maxfd;
@@ -150,6 +171,14 @@ protected:
 
     intptr_t _touchId;
 
+    // guards _perfClients and _perfRecords
+    std::mutex _perfMutex;
+    std::vector<PerfClient> _perfClients;
+    std::vector<std::pair<int, std::string>> _perfRecords;
+    EventListenerCustom* _perfListener;
+    // the frame timings were enabled by [perf start]
+    bool _perfEnabledTimings;
+
     std::string _bindAddress;
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(Console);
@@ -36,9 +36,13 @@ THE SOFTWARE.
 #include "platform/CCFileUtils.h"
 
 #include "2d/CCActionManager.h"
+#include "2d/CCActionPool.h"
 #include "2d/CCFontFNT.h"
 #include "2d/CCFontAtlasCache.h"
+#include "2d/CCSystemFontTextureCache.h"
+#include "2d/CCDynamicAtlas.h"
 #include "2d/CCAnimationCache.h"
+#include "2d/CCParticleCache.h"
 #include "2d/CCTransition.h"
 #include "2d/CCFontFreeType.h"
 #include "2d/CCLabelAtlas.h"
@@ -47,6 +51,10 @@ THE SOFTWARE.
 #include "renderer/CCTextureCache.h"
 #include "renderer/ccGLStateCache.h"
 #include "renderer/CCRenderer.h"
+#include "renderer/CCQuadIndexBuffer.h"
+#include "renderer/CCRenderTargetPool.h"
+#include "renderer/CCPostProcess.h"
+#include "base/CCDynamicResolution.h"
 #include "renderer/CCRenderState.h"
 #include "base/ccFPSImages.h"
 #include "base/CCScheduler.h"
@@ -57,6 +65,12 @@ THE SOFTWARE.
 #include "base/CCAutoreleasePool.h"
 #include "base/CCConfiguration.h"
 #include "base/CCAsyncTaskPool.h"
+#include "base/CCWorkerPool.h"
+#include "base/CCJobSystem.h"
+#include "base/CCRefAllocator.h"
+#include "base/CCAllocationProfiler.h"
+#include "base/CCTracer.h"
+#include "base/CCMemoryPressure.h"
 #include "platform/CCApplication.h"
 
 /**
@@ -80,6 +94,7 @@ Director* Director::DirectorInstance = nullptr;
 
 const char *Director::EVENT_PROJECTION_CHANGED = "director_projection_changed";
 const char *Director::EVENT_AFTER_DRAW = "director_after_draw";
+const char *Director::EVENT_AFTER_FRAME = "director_after_frame";
 const char *Director::EVENT_AFTER_VISIT = "director_after_visit";
 const char *Director::EVENT_BEFORE_UPDATE = "director_before_update";
 const char *Director::EVENT_AFTER_UPDATE = "director_after_update";
@@ -102,6 +117,77 @@ Director::Director()
 {
 }
 
+// the caches of the engine, by what they retain: the pools first, the textures once nothing else holds them
+static void addMemoryPressureHandlers()
+{
+    typedef MemoryPressure::Level Level;
+    auto pressure = MemoryPressure::getInstance();
+
+    pressure->addHandler("pools", 0, [](Level level) -> size_t {
+        ActionPool::purge();
+        RefAllocator::purge();
+        RenderTargetPool::getInstance()->purgeUnusedTargets();
+        return 0;
+    });
+    // no use order is kept for these, they are only shrunk when everything unused has to go
+    pressure->addHandler("sprite frames", 10, [](Level level) -> size_t {
+        if (level >= Level::MEDIUM && Director::getInstance()->getOpenGLView())
+            SpriteFrameCache::getInstance()->removeUnusedSpriteFrames();
+        return 0;
+    });
+    pressure->addHandler("particle templates", 10, [](Level level) -> size_t {
+        if (level >= Level::MEDIUM && Director::getInstance()->getOpenGLView())
+        {
+            ParticleCache::getInstance()->removeUnusedSystems();
+            ParticleCache::getInstance()->removeDefinitions();
+        }
+        return 0;
+    });
+    pressure->addHandler("dynamic atlas", 10, [](Level level) -> size_t {
+        if (level >= Level::MEDIUM && Director::getInstance()->getOpenGLView())
+            DynamicAtlas::removeUnusedImages();
+        return 0;
+    });
+    pressure->addHandler("fonts", 20, [](Level level) -> size_t {
+        if (level >= Level::MEDIUM)
+        {
+            FontFNT::purgeCachedData();
+            SystemFontTextureCache::purge();
+        }
+        // the labels rebuild their atlases
+        if (level == Level::CRITICAL)
+            FontAtlasCache::purgeCachedData();
+        return 0;
+    });
+    pressure->addHandler("textures", 30, [](Level level) -> size_t {
+        auto director = Director::getInstance();
+        if (!director->getOpenGLView())
+            return 0;
+        auto textureCache = director->getTextureCache();
+        switch (level)
+        {
+            case Level::LOW:
+                return textureCache->trimUnusedTextures(0.5f);
+            case Level::MEDIUM:
+                return textureCache->trimUnusedTextures(1.0f);
+            case Level::CRITICAL:
+            {
+                size_t before = textureCache->getTotalTextureBytes();
+                textureCache->removeUnusedTextures();
+                size_t after = textureCache->getTotalTextureBytes();
+                return before > after ? before - after : 0;
+            }
+            default:
+                return 0;
+        }
+    });
+    pressure->addHandler("file utils", 40, [](Level level) -> size_t {
+        if (level == Level::CRITICAL)
+            FileUtils::getInstance()->purgeCachedEntries();
+        return 0;
+    });
+}
+
 bool Director::init()
 {
     setDefaultValues();
@@ -112,6 +198,9 @@ bool Director::init()
 
     _notificationNode = nullptr;
 
+    _postProcessStack = nullptr;
+    _dynamicResolution = nullptr;
+
     _scenesStack.reserve(15);
 
     // FPS
@@ -119,7 +208,8 @@ bool Director::init()
     _frameRate = 0.0f;
     _FPSLabel = _drawnBatchesLabel = _drawnVerticesLabel = nullptr;
     _totalFrames = 0;
-    _lastUpdate = new (std::nothrow) struct timeval;
+    _frameTimings = nullptr;
+    Tracer::setThreadName("main");
     _secondsPerFrame = 1.0f;
 
     // paused ?
@@ -131,6 +221,16 @@ bool Director::init()
     // restart ?
     _restartDirectorInNextLoop = false;
 
+    _isCullingEnabled = true;
+
+    _isRetainedModeEnabled = false;
+    _redrawRequested = true;
+    _skippedFrames = 0;
+    _lastFrameSkipped = false;
+    _isIdleModeEnabled = false;
+    _lastCallbackCount = 0;
+    _lastInputEventCount = 0;
+
     _winSizeInPoints = Size::ZERO;
 
     _openGLView = nullptr;
@@ -148,6 +248,8 @@ bool Director::init()
     _eventDispatcher = new (std::nothrow) EventDispatcher();
     _eventAfterDraw = new (std::nothrow) EventCustom(EVENT_AFTER_DRAW);
     _eventAfterDraw->setUserData(this);
+    _eventAfterFrame = new (std::nothrow) EventCustom(EVENT_AFTER_FRAME);
+    _eventAfterFrame->setUserData(this);
     _eventAfterVisit = new (std::nothrow) EventCustom(EVENT_AFTER_VISIT);
     _eventAfterVisit->setUserData(this);
     _eventBeforeUpdate = new (std::nothrow) EventCustom(EVENT_BEFORE_UPDATE);
@@ -164,6 +266,8 @@ bool Director::init()
     _renderer = new (std::nothrow) Renderer;
     RenderState::initialize();
 
+    addMemoryPressureHandlers();
+
     return true;
 }
 
@@ -193,11 +297,21 @@ Director::~Director()
     delete _eventBeforeUpdate;
     delete _eventAfterUpdate;
     delete _eventAfterDraw;
+    delete _eventAfterFrame;
     delete _eventAfterVisit;
     delete _eventProjectionChanged;
     delete _eventResetDirector;
 
-    delete _renderer;
+    // the textures released from here on are deleted without the renderer
+    CC_SAFE_DELETE(_renderer);
+    delete _postProcessStack;
+    delete _dynamicResolution;
+    // the renderer and the atlases are gone, nothing refers to the shared quad indices anymore
+    QuadIndexBuffer::destroyInstance();
+    RenderTargetPool::destroyInstance();
+
+    WorkerPool::destroyInstance();
+    JobSystem::destroyInstance();
 
     delete _console;
     
@@ -207,8 +321,7 @@ Director::~Director()
         _eventDispatcher = nullptr;
     }
     
-    // delete _lastUpdate
-    CC_SAFE_DELETE(_lastUpdate);
+    CC_SAFE_DELETE(_frameTimings);
 
     Configuration::destroyInstance();
     
@@ -266,22 +379,64 @@ void Director::setGLDefaultValues()
 // Draw the Scene
 void Director::drawScene()
 {
+    CC_TRACE_ZONE("director", "Director::drawScene");
+
+    FrameTiming timing;
+    if (_frameTimings)
+    {
+        auto now = FrameTimings::Clock::now();
+        auto previous = _frameTimings->find(_totalFrames - 1);
+        if (previous)
+        {
+            previous->total = std::chrono::duration<float, std::milli>(now - _frameStart).count();
+        }
+        _frameStart = now;
+        timing.frame = _totalFrames;
+    }
+
     // calculate "global" dt
     calculateDeltaTime();
 
     if (_openGLView)
     {
         _openGLView->pollEvents();
+        _openGLView->dispatchCoalescedTouches();
     }
 
     //tick before glClear: issue #533
     if (! _paused)
     {
+        CC_TRACE_ZONE("director", "Director::update");
         _eventDispatcher->dispatchEvent(_eventBeforeUpdate);
+        auto updateStart = FrameTimings::Clock::now();
+        updateBackgroundScenes();
         _scheduler->update(_deltaTime);
+        for (auto scene : _backgroundUpdates)
+        {
+            scene->endBackgroundUpdate();
+        }
+        _backgroundUpdates.clear();
+        if (AsyncTaskPool::dispatchCallbacks() > 0)
+        {
+            _redrawRequested = true;
+        }
+        if (_frameTimings)
+        {
+            timing.update = FrameTimings::elapsed(updateStart);
+            timing.actions = _actionManager->getLastUpdateTime();
+        }
         _eventDispatcher->dispatchEvent(_eventAfterUpdate);
     }
 
+    if (_isRetainedModeEnabled && _nextScene == nullptr && !isRedrawNeeded())
+    {
+        // nothing changed what is drawn, the screen keeps the last frame
+        _skippedFrames++;
+        _lastFrameSkipped = true;
+        return;
+    }
+    _lastFrameSkipped = false;
+
     _renderer->clear();
     /* to avoid flickr, nextScene MUST be here: after tick and before draw.
      * FIXME: Which bug is this one. It seems that it can't be reproduced with v0.9
@@ -293,14 +448,40 @@ void Director::drawScene()
 
     pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
 
+    auto visitStart = FrameTimings::Clock::now();
     if (_runningScene)
     {
-        //clear draw stats
-        _renderer->clearDrawStats();
+        CC_TRACE_ZONE("director", "Director::visit");
+
+        //clear draw stats, the render thread clears them when it starts a frame
+        if (!_renderer->isRenderThreadEnabled())
+        {
+            _renderer->clearDrawStats();
+        }
+
+        //the scene is rendered into the default render queue, or the one of the post process stack
+        if (_dynamicResolution)
+        {
+            getPostProcessStack()->setRenderScale(_dynamicResolution->update(_frameTimings, _totalFrames, _animationInterval * 1000));
+        }
+
+        const bool postProcess = _postProcessStack && _postProcessStack->isActive();
+        const bool reorder = _runningScene->isCommandReorderEnabled();
+        if (postProcess)
+        {
+            _postProcessStack->beginScene(_renderer);
+            _renderer->setRenderQueueReorderEnabled(_postProcessStack->getOverlayRenderQueueID(), reorder);
+        }
+        _renderer->setRenderQueueReorderEnabled(postProcess ? _postProcessStack->getRenderQueueID() : 0, reorder);
 
         //render the scene
         _runningScene->visit(_renderer, Mat4::IDENTITY, false);
 
+        if (postProcess)
+        {
+            _postProcessStack->endScene(_renderer);
+        }
+
         _eventDispatcher->dispatchEvent(_eventAfterVisit);
     }
 
@@ -310,8 +491,17 @@ void Director::drawScene()
         _notificationNode->visit(_renderer, Mat4::IDENTITY, 0);
     }
 
+    if (_frameTimings)
+    {
+        // the renderer adds its timings to the frame while rendering it
+        timing.visit = FrameTimings::elapsed(visitStart);
+        _frameTimings->push(timing);
+    }
+
     if (_displayStats)
     {
+        // the stats of the previous frame are written by the render thread
+        _renderer->waitForRenderThread();
         showStats();
     }
     _renderer->render();
@@ -322,10 +512,21 @@ void Director::drawScene()
 
     _totalFrames++;
 
-    // swap buffers
-    if (_openGLView)
+    // swap buffers, the render thread swaps the frames it draws
+    if (_openGLView && !_renderer->isRenderThreadEnabled())
     {
+        CC_TRACE_ZONE("director", "GLView::swapBuffers");
+        auto swapStart = FrameTimings::Clock::now();
         _openGLView->swapBuffers();
+
+        // the renderer may have dropped the frame if the timings were disabled meanwhile
+        auto drawn = _frameTimings ? _frameTimings->find(timing.frame) : nullptr;
+        if (drawn)
+        {
+            drawn->swap = FrameTimings::elapsed(swapStart);
+            drawn->drawnBatches = _renderer->getDrawnBatches();
+            drawn->drawnVertices = _renderer->getDrawnVertices();
+        }
     }
 
     if (_displayStats)
@@ -334,43 +535,78 @@ void Director::drawScene()
     }
 }
 
-void Director::calculateDeltaTime()
+void Director::setRetainedModeEnabled(bool enabled)
+{
+    _isRetainedModeEnabled = enabled;
+    requestRedraw();
+}
+
+bool Director::isRedrawNeeded()
 {
-    struct timeval now;
+    bool needed = _redrawRequested;
+    _redrawRequested = false;
 
-    if (gettimeofday(&now, nullptr) != 0)
+    // the game code runs from the callbacks of the scheduler, the actions and the input events
+    auto callbackCount = _scheduler->getCallbackCount();
+    auto inputEventCount = _eventDispatcher->getInputEventCount();
+    if (callbackCount != _lastCallbackCount || inputEventCount != _lastInputEventCount
+        || (!_paused && _actionManager->getLastStepCount() > 0))
     {
-        CCLOG("error in gettimeofday");
-        _deltaTime = 0;
-        return;
+        needed = true;
     }
+    _lastCallbackCount = callbackCount;
+    _lastInputEventCount = inputEventCount;
+    return needed;
+}
+
+float Director::getIdleTime()
+{
+    // the frames are run while something may change what is drawn
+    if (!_isIdleModeEnabled || !_isRetainedModeEnabled || !_lastFrameSkipped || _paused || _nextScene || _redrawRequested
+        || _scheduler->getCallbackCount() != _lastCallbackCount || _eventDispatcher->getInputEventCount() != _lastInputEventCount)
+    {
+        return 0;
+    }
+
+    // the functions queued by other threads don't wake the loop up, they wait for the next check
+    static const float MAX_IDLE_TIME = 0.1f;
+    const float wait = std::min(_scheduler->getTimeToNextCallback(), MAX_IDLE_TIME) - _framePacer.getTimeSinceFrameStart();
+    return std::max(wait, 0.0f);
+}
+
+void Director::calculateDeltaTime()
+{
+    auto now = FramePacer::Clock::now();
 
     // new delta time. Re-fixed issue #1277
     if (_nextDeltaTimeZero)
     {
         _deltaTime = 0;
         _nextDeltaTimeZero = false;
+        _framePacer.reset(now);
     }
     else
     {
-        _deltaTime = (now.tv_sec - _lastUpdate->tv_sec) + (now.tv_usec - _lastUpdate->tv_usec) / 1000000.0f;
-        _deltaTime = MAX(0, _deltaTime);
+        _deltaTime = _framePacer.nextDeltaTime(now);
     }
 
 #if COCOS2D_DEBUG
-    // If we are debugging our code, prevent big delta time
-    if (_deltaTime > 0.2f)
+    // If we are debugging our code, prevent big delta time, the loop may have waited for events in the idle mode
+    if (_deltaTime > 0.2f && !(_isIdleModeEnabled && _lastFrameSkipped))
     {
         _deltaTime = 1 / 60.0f;
     }
 #endif
-
-    *_lastUpdate = now;
 }
 float Director::getDeltaTime() const
 {
     return _deltaTime;
 }
+
+float Director::getFrameTimeLeft() const
+{
+    return _framePacer.getPacedInterval(_animationInterval) - _framePacer.getTimeSinceFrameStart();
+}
 void Director::setOpenGLView(GLView *openGLView)
 {
     CCASSERT(openGLView, "opengl view should not be null");
@@ -401,6 +637,27 @@ void Director::setOpenGLView(GLView *openGLView)
 
         CHECK_GL_ERROR_DEBUG();
 
+        if (conf->getValue("cocos2d.x.renderer.render_thread", Value(false)).asBool())
+        {
+            _renderer->setRenderThreadEnabled(true);
+        }
+        if (conf->getValue("cocos2d.x.frame_timings", Value(false)).asBool())
+        {
+            setFrameTimingsEnabled(true);
+        }
+        if (conf->getValue("cocos2d.x.texture.variants", Value(true)).asBool())
+        {
+            // the smallest format first, ETC1 has no alpha so only the opaque images should have an ".etc1.ktx" variant
+            std::vector<std::string> variants;
+            if (conf->supportsASTC())
+                variants.push_back(".astc.ktx");
+            if (conf->supportsETC2())
+                variants.push_back(".etc2.ktx");
+            if (conf->supportsETC())
+                variants.push_back(".etc1.ktx");
+            FileUtils::getInstance()->setTextureVariants(variants);
+        }
+
         if (_eventDispatcher)
         {
             _eventDispatcher->setEnabled(true);
@@ -413,6 +670,15 @@ TextureCache* Director::getTextureCache() const
     return _textureCache;
 }
 
+PostProcessStack* Director::getPostProcessStack()
+{
+    if (_postProcessStack == nullptr)
+    {
+        _postProcessStack = new (std::nothrow) PostProcessStack();
+    }
+    return _postProcessStack;
+}
+
 void Director::initTextureCache()
 {
     _textureCache = new (std::nothrow) TextureCache();
@@ -473,11 +739,29 @@ void Director::resetMatrixStack()
     initMatrixStack();
 }
 
+// the stack of the threads of a parallel visit, see setThreadModelViewMatrixStack()
+static thread_local std::stack<Mat4>* s_threadModelViewMatrixStack = nullptr;
+
+void Director::setThreadModelViewMatrixStack(std::stack<Mat4>* stack)
+{
+    s_threadModelViewMatrixStack = stack;
+}
+
+std::stack<Mat4>& Director::modelViewMatrixStack()
+{
+    return s_threadModelViewMatrixStack ? *s_threadModelViewMatrixStack : _modelViewMatrixStack;
+}
+
+const std::stack<Mat4>& Director::modelViewMatrixStack() const
+{
+    return s_threadModelViewMatrixStack ? *s_threadModelViewMatrixStack : _modelViewMatrixStack;
+}
+
 void Director::popMatrix(MATRIX_STACK_TYPE type)
 {
     if(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW == type)
     {
-        _modelViewMatrixStack.pop();
+        modelViewMatrixStack().pop();
     }
     else if(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION == type)
     {
@@ -497,7 +781,7 @@ void Director::loadIdentityMatrix(MATRIX_STACK_TYPE type)
 {
     if(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW == type)
     {
-        _modelViewMatrixStack.top() = Mat4::IDENTITY;
+        modelViewMatrixStack().top() = Mat4::IDENTITY;
     }
     else if(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION == type)
     {
@@ -517,7 +801,7 @@ void Director::loadMatrix(MATRIX_STACK_TYPE type, const Mat4& mat)
 {
     if(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW == type)
     {
-        _modelViewMatrixStack.top() = mat;
+        modelViewMatrixStack().top() = mat;
     }
     else if(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION == type)
     {
@@ -537,7 +821,7 @@ void Director::multiplyMatrix(MATRIX_STACK_TYPE type, const Mat4& mat)
 {
     if(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW == type)
     {
-        _modelViewMatrixStack.top() *= mat;
+        modelViewMatrixStack().top() *= mat;
     }
     else if(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION == type)
     {
@@ -557,7 +841,7 @@ void Director::pushMatrix(MATRIX_STACK_TYPE type)
 {
     if(type == MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW)
     {
-        _modelViewMatrixStack.push(_modelViewMatrixStack.top());
+        modelViewMatrixStack().push(modelViewMatrixStack().top());
     }
     else if(type == MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION)
     {
@@ -577,7 +861,7 @@ const Mat4& Director::getMatrix(MATRIX_STACK_TYPE type) const
 {
     if(type == MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW)
     {
-        return _modelViewMatrixStack.top();
+        return modelViewMatrixStack().top();
     }
     else if(type == MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION)
     {
@@ -589,12 +873,16 @@ const Mat4& Director::getMatrix(MATRIX_STACK_TYPE type) const
     }
 
     CCASSERT(false, "unknow matrix stack type, will return modelview matrix instead");
-    return  _modelViewMatrixStack.top();
+    return  modelViewMatrixStack().top();
 }
 
 void Director::setProjection(Projection projection)
 {
     Size size = _winSizeInPoints;
+    requestRedraw();
+
+    // the render thread reads the projection matrix
+    _renderer->waitForRenderThread();
 
     setViewport();
 
@@ -650,19 +938,15 @@ void Director::setProjection(Projection projection)
 
 void Director::purgeCachedData()
 {
-    FontFNT::purgeCachedData();
-    FontAtlasCache::purgeCachedData();
+    // the handlers of the caches free everything that can be reloaded at CRITICAL
+    MemoryPressure::getInstance()->trim(MemoryPressure::Level::CRITICAL);
 
     if (DirectorInstance->getOpenGLView())
     {
-        SpriteFrameCache::getInstance()->removeUnusedSpriteFrames();
-        _textureCache->removeUnusedTextures();
-
         // Note: some tests such as ActionsTest are leaking refcounted textures
         // There should be no test textures left in the cache
         log("%s\n", _textureCache->getCachedTextureInfo().c_str());
     }
-    FileUtils::getInstance()->purgeCachedEntries();
 }
 
 float Director::getZEye() const
@@ -829,6 +1113,19 @@ void Director::replaceScene(Scene *scene)
     _nextScene = scene;
 }
 
+void Director::updateBackgroundScenes()
+{
+    // the scenes covered by pushScene(), the running one is on top of the stack
+    for (ssize_t i = 0, count = _scenesStack.size() - 1; i < count; ++i)
+    {
+        Scene* scene = _scenesStack.at(i);
+        if (scene != _runningScene && !scene->isRunning() && scene->beginBackgroundUpdate(_deltaTime))
+        {
+            _backgroundUpdates.pushBack(scene);
+        }
+    }
+}
+
 void Director::pushScene(Scene *scene)
 {
     CCASSERT(scene, "the scene should not null");
@@ -918,6 +1215,9 @@ void Director::restart()
 
 void Director::reset()
 {
+    // nothing the frame in flight uses may be released while it's drawn
+    _renderer->waitForRenderThread();
+
     if (_runningScene)
     {
         _runningScene->onExit();
@@ -943,6 +1243,11 @@ void Director::reset()
     // runWithScene might be executed after 'end'.
     _scenesStack.clear();
 
+    if (_postProcessStack)
+    {
+        _postProcessStack->removeAllEffects();
+    }
+
     stopAnimation();
 
     CC_SAFE_RELEASE_NULL(_notificationNode);
@@ -953,6 +1258,8 @@ void Director::reset()
     // purge bitmap cache
     FontFNT::purgeCachedData();
     FontAtlasCache::purgeCachedData();
+    SystemFontTextureCache::purge();
+    DynamicAtlas::purge();
     FontFreeType::shutdownFreeType();
 
     // purge all managed caches
@@ -972,6 +1279,8 @@ void Director::reset()
 #elif _MSC_VER >= 1400 //vs 2005 or higher
 #pragma warning (pop)
 #endif
+    ParticleCache::destroyInstance();
+    SpriteAnimationSystem::destroyInstance();
     AnimationCache::destroyInstance();
     SpriteFrameCache::destroyInstance();
     GLProgramCache::destroyInstance();
@@ -986,8 +1295,46 @@ void Director::reset()
     destroyTextureCache();
 }
 
+void Director::setFrameTimingsEnabled(bool enabled)
+{
+    if (enabled == isFrameTimingsEnabled())
+        return;
+
+    _renderer->setTimingsEnabled(enabled);
+    if (enabled)
+    {
+        _frameTimings = new (std::nothrow) FrameTimings();
+        _frameStart = FrameTimings::Clock::now();
+    }
+    else
+    {
+        CC_SAFE_DELETE(_frameTimings);
+    }
+}
+
+void Director::setDynamicResolutionEnabled(bool enabled)
+{
+    if (enabled == isDynamicResolutionEnabled())
+        return;
+
+    if (enabled)
+    {
+        _dynamicResolution = new (std::nothrow) DynamicResolution();
+        // the scale follows the GPU time of the frames
+        setFrameTimingsEnabled(true);
+    }
+    else
+    {
+        CC_SAFE_DELETE(_dynamicResolution);
+        getPostProcessStack()->setRenderScale(1.0f);
+    }
+}
+
 void Director::purgeDirector()
 {
+    // the context must be back on the main thread before the view ends
+    _renderer->setRenderThreadEnabled(false);
+
     reset();
 
     CHECK_GL_ERROR_DEBUG();
@@ -1055,6 +1402,12 @@ void Director::setNextScene()
         _runningScene->onEnter();
         _runningScene->onEnterTransitionDidFinish();
     }
+
+    // the batches of the previous scene may have needed much more memory
+    if (! newIsTransition)
+    {
+        _renderer->shrinkToFit();
+    }
 }
 
 void Director::pause()
@@ -1147,10 +1500,7 @@ void Director::calculateMPF()
     static float prevSecondsPerFrame = 0;
     static const float MPF_FILTER = 0.10f;
 
-    struct timeval now;
-    gettimeofday(&now, nullptr);
-
-    _secondsPerFrame = (now.tv_sec - _lastUpdate->tv_sec) + (now.tv_usec - _lastUpdate->tv_usec) / 1000000.0f;
+    _secondsPerFrame = _framePacer.getTimeSinceFrameStart();
 
     _secondsPerFrame = _secondsPerFrame * MPF_FILTER + (1-MPF_FILTER) * prevSecondsPerFrame;
     prevSecondsPerFrame = _secondsPerFrame;
@@ -1301,12 +1651,10 @@ void Director::setEventDispatcher(EventDispatcher* dispatcher)
 // so we now only support DisplayLinkDirector
 void DisplayLinkDirector::startAnimation()
 {
-    if (gettimeofday(_lastUpdate, nullptr) != 0)
-    {
-        CCLOG("cocos2d: DisplayLinkDirector: Error on gettimeofday");
-    }
+    _framePacer.reset(FramePacer::Clock::now());
 
     _invalid = false;
+    requestRedraw();
 
     _cocos2d_thread_id = std::this_thread::get_id();
 
@@ -1332,8 +1680,19 @@ void DisplayLinkDirector::mainLoop()
     {
         drawScene();
 
+#if CC_ENABLE_ALLOCATION_PROFILER
+        // the autoreleased objects of the frame are still alive, their class can be read
+        if (AllocationProfiler::isEnabled())
+        {
+            AllocationProfiler::getInstance()->endFrame();
+        }
+#endif
+
         // release the objects
         PoolManager::getInstance()->getCurrentPool()->clear();
+
+        // the rest of the frame is idle
+        _eventDispatcher->dispatchEvent(_eventAfterFrame);
     }
 }
 
@@ -38,6 +38,8 @@ THE SOFTWARE.
 #include "math/CCMath.h"
 #include "platform/CCGL.h"
 #include "platform/CCGLView.h"
+#include "base/CCFramePacer.h"
+#include "base/CCFrameTimings.h"
 
 NS_CC_BEGIN
 
@@ -58,6 +60,8 @@ class EventCustom;
 class EventListenerCustom;
 class TextureCache;
 class Renderer;
+class PostProcessStack;
+class DynamicResolution;
 
 class Console;
 
@@ -103,6 +107,12 @@ public:
     static const char* EVENT_AFTER_VISIT;
     /** Director will trigger an event after a scene is drawn, the data is sent to GPU. */
     static const char* EVENT_AFTER_DRAW;
+    /**
+     * Director will trigger an event at the end of a frame, after the buffers are swapped and the autoreleased
+     * objects are released. The listeners may use the time left in the frame, see getFrameTimeLeft().
+     * @since v3.11
+     */
+    static const char* EVENT_AFTER_FRAME;
     /** Director will trigger an event while resetting Director */
     static const char* EVENT_RESET;
 
@@ -157,6 +167,77 @@ public:
     /** Display the FPS on the bottom-left corner of the screen. */
     inline void setDisplayStats(bool displayStats) { _displayStats = displayStats; }
 
+    /**
+     * Enable/Disable the culling of the subtrees that are out of the window, see Node::setCullingEnabled().
+     * RenderTexture disables it between begin() and end(), the texture may cover more than the window.
+     * Enabled by default.
+     */
+    inline void setCullingEnabled(bool enabled) { _isCullingEnabled = enabled; }
+    /** Whether or not the subtrees that are out of the window are skipped by the visit. */
+    inline bool isCullingEnabled() const { return _isCullingEnabled; }
+
+    /**
+     * Enable/Disable the retained mode: a frame is only visited and rendered when something may have changed what
+     * is drawn, otherwise the screen keeps the last frame, nothing is swapped. Static screens like menus then cost
+     * almost no CPU and GPU.
+     * A frame is drawn when an update or a timer of the scheduler ran (see Scheduler::getCallbackCount()), when an
+     * action ran, when an input event was dispatched, when the scene changed or when requestRedraw() was called.
+     * The code that changes nodes from anywhere else, e.g. a callback of another library, calls requestRedraw().
+     * Disabled by default.
+     */
+    void setRetainedModeEnabled(bool enabled);
+    /** Whether or not the frames are only drawn when something changed. */
+    inline bool isRetainedModeEnabled() const { return _isRetainedModeEnabled; }
+    /** Draws the next frame in retained mode, see setRetainedModeEnabled(). */
+    inline void requestRedraw() { _redrawRequested = true; }
+    /** Gets the number of frames the retained mode didn't draw. */
+    inline unsigned int getSkippedFrames() const { return _skippedFrames; }
+
+    /**
+     * Enable/Disable the idle mode of the desktop main loops: when the retained mode didn't draw the last frame and
+     * no update runs every frame, Application::run() waits for an input event or for the next timer of the scheduler,
+     * see getIdleTime(), instead of running a frame every animation interval. A static screen then costs almost no CPU.
+     * The functions queued from other threads, e.g. by Scheduler::performFunctionInCocosThread(), are run within
+     * 0.1 seconds. It needs the retained mode, see setRetainedModeEnabled().
+     * Disabled by default.
+     * @since v3.11
+     */
+    inline void setIdleModeEnabled(bool enabled) { _isIdleModeEnabled = enabled; }
+    /** Whether or not the main loop waits for events when nothing changes. */
+    inline bool isIdleModeEnabled() const { return _isIdleModeEnabled; }
+    /**
+     * Gets the seconds the main loop may wait for an event before it runs the next frame, 0 when the next frame
+     * must run on time. It's 0 unless the idle mode is enabled and the last frame wasn't drawn.
+     * @since v3.11
+     */
+    float getIdleTime();
+
+    /**
+     * Enable/Disable the recording of the timings of the frames: update, actions, visit, sort, batch fill,
+     * submit, swap and GPU time, see getFrameTimings().
+     * It costs a few clock reads per frame and per batch, and a timer query per frame when the GPU supports it,
+     * so it can stay in release builds. The "cocos2d.x.frame_timings" configuration key enables it with the GLView.
+     * Disabled by default.
+     */
+    void setFrameTimingsEnabled(bool enabled);
+    /** Whether or not the timings of the frames are recorded. */
+    inline bool isFrameTimingsEnabled() const { return _frameTimings != nullptr; }
+    /** Gets the timings of the last frames, nullptr when they aren't recorded. */
+    inline FrameTimings* getFrameTimings() const { return _frameTimings; }
+
+    /**
+     * Enable/Disable the dynamic resolution: the running scene is drawn into a smaller target when the GPU time of
+     * the frames, or the thermal state of the device, calls for it, and scaled up to the screen, see DynamicResolution.
+     * It goes through the PostProcessStack and turns on the frame timings, the GPU time comes from their timer queries.
+     * The nodes drawn at native resolution, see Node::setDrawnAtNativeResolution(), e.g. the UI, stay sharp.
+     * Disabled by default.
+     */
+    void setDynamicResolutionEnabled(bool enabled);
+    /** Whether or not the resolution of the scene follows the GPU time. */
+    inline bool isDynamicResolutionEnabled() const { return _dynamicResolution != nullptr; }
+    /** Gets the settings and the current scale of the dynamic resolution, nullptr when it's disabled. */
+    inline DynamicResolution* getDynamicResolution() const { return _dynamicResolution; }
+
     /** Get seconds per frame. */
     inline float getSecondsPerFrame() { return _secondsPerFrame; }
 
@@ -429,6 +510,13 @@ public:
      */
     Renderer* getRenderer() const { return _renderer; }
 
+    /** Returns the effects drawn over the running scene, blur, bloom, color grading and vignette, created on first use.
+     * The notifications node and the stats aren't affected.
+     * @since v3.11
+     * @js NA
+     */
+    PostProcessStack* getPostProcessStack();
+
     /** Returns the Console associated with this director.
      * @since v3.0
      * @js NA
@@ -438,6 +526,20 @@ public:
     /* Gets delta time since last tick to main loop. */
     float getDeltaTime() const;
 
+    /**
+     * Gets the time left in the current frame in seconds: the animation interval, rounded to a whole number of
+     * refreshes, minus the time since the frame started, when calculateDeltaTime() measured the delta time. It is negative when the frame is late.
+     * @since v3.11
+     */
+    float getFrameTimeLeft() const;
+
+    /**
+     * Gets the frame pacer, which measures the delta time and snaps it to the refreshes of the display.
+     * The platforms set its refresh rate, see FramePacer::setRefreshRate().
+     * @js NA
+     */
+    FramePacer* getFramePacer() { return &_framePacer; }
+
     /**
      *  Gets Frame Rate.
      * @js NA
@@ -484,6 +586,14 @@ public:
      */
     void resetMatrixStack();
 
+    /**
+     * Makes the calling thread use its own model view matrix stack, nullptr switches back to the shared one.
+     * It is used by the threads of a parallel visit, see Node::setParallelVisitEnabled().
+     * The projection and texture stacks are still shared and must not be changed by those threads.
+     * @js NA
+     */
+    void setThreadModelViewMatrixStack(std::stack<Mat4>* stack);
+
     /**
      * returns the cocos2d thread id.
      Useful to know if certain code is already running on the cocos2d thread
@@ -502,6 +612,8 @@ protected:
     bool _restartDirectorInNextLoop; // this flag will be set to true in restart()
 
     void setNextScene();
+    /** Resumes the covered scenes that run this frame, see Scene::setBackgroundUpdate(). */
+    void updateBackgroundScenes();
 
     void showStats();
     void createStatsLabel();
@@ -511,11 +623,17 @@ protected:
     /** calculates delta time since last time it was called */
     void calculateDeltaTime();
 
+    /** Whether or not something ran since the last drawn frame, in retained mode. */
+    bool isRedrawNeeded();
+
     //textureCache creation or release
     void initTextureCache();
     void destroyTextureCache();
 
     void initMatrixStack();
+    //the model view stack of the calling thread
+    std::stack<Mat4>& modelViewMatrixStack();
+    const std::stack<Mat4>& modelViewMatrixStack() const;
 
     std::stack<Mat4> _modelViewMatrixStack;
     std::stack<Mat4> _projectionMatrixStack;
@@ -535,7 +653,7 @@ protected:
      @since v3.0
      */
     EventDispatcher* _eventDispatcher;
-    EventCustom *_eventProjectionChanged, *_eventAfterDraw, *_eventAfterVisit, *_eventBeforeUpdate, *_eventAfterUpdate, *_eventResetDirector;
+    EventCustom *_eventProjectionChanged, *_eventAfterDraw, *_eventAfterFrame, *_eventAfterVisit, *_eventBeforeUpdate, *_eventAfterUpdate, *_eventResetDirector;
 
     /* delta time since last tick to main loop */
     float _deltaTime;
@@ -554,6 +672,17 @@ protected:
     bool _landscape;
 
     bool _displayStats;
+    bool _isCullingEnabled;
+
+    /* the retained mode, the counters of the last drawn frame tell whether something ran since then */
+    bool _isRetainedModeEnabled;
+    bool _redrawRequested;
+    unsigned int _skippedFrames;
+    bool _lastFrameSkipped;
+    /* waits for the events instead of running the frames that wouldn't be drawn */
+    bool _isIdleModeEnabled;
+    unsigned int _lastCallbackCount;
+    unsigned int _lastInputEventCount;
     float _accumDt;
     float _frameRate;
 
@@ -580,9 +709,15 @@ protected:
 
     /* scheduled scenes */
     Vector<Scene*> _scenesStack;
+    /* the throttled scenes resumed for the current update */
+    Vector<Scene*> _backgroundUpdates;
+
+    /* measures the delta time, from the last time the main loop was updated */
+    FramePacer _framePacer;
 
-    /* last time the main loop was updated */
-    struct timeval *_lastUpdate;
+    /* the timings of the last frames, nullptr when they aren't recorded */
+    FrameTimings *_frameTimings;
+    FrameTimings::Clock::time_point _frameStart;
 
     /* whether or not the next delta time will be zero */
     bool _nextDeltaTimeZero;
@@ -602,6 +737,12 @@ protected:
     /* Renderer for the Director */
     Renderer *_renderer;
 
+    /* the effects drawn over the running scene, created on first use */
+    PostProcessStack *_postProcessStack;
+
+    /* the scale of the scene from the GPU time, nullptr when disabled */
+    DynamicResolution *_dynamicResolution;
+
     /* Console for the director */
     Console *_console;
 
@@ -0,0 +1,215 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "base/CCDynamicResolution.h"
+#include <algorithm>
+#include <cmath>
+#include "base/ccMacros.h"
+#include "math/CCMath.h"
+
+NS_CC_BEGIN
+
+namespace
+{
+    // the scale changes by steps, so the targets of the scene come in a few sizes
+    const float SCALE_STEP = 0.05f;
+    // the frames under the target before the scale goes up, half a second at 60 fps
+    const int FRAMES_BEFORE_INCREASE = 30;
+    // without timer queries, the missed frames in a row before the scale goes down
+    const int MISSES_BEFORE_DECREASE = 3;
+    // and the frames without a miss before it goes up again
+    const int FRAMES_BEFORE_PROBE = 120;
+    // the system is asked for the thermal state once a second
+    const float THERMAL_STATE_INTERVAL = 1000;
+}
+
+DynamicResolution::DynamicResolution()
+: _minScale(0.5f)
+, _maxScale(1.0f)
+, _targetGPUTime(0)
+, _thermalScaling(true)
+, _scale(1.0f)
+, _lastFrame(0)
+, _hasLastFrame(false)
+, _fullResolutionGPUTime(-1)
+, _framesUnder(0)
+, _framesOver(0)
+, _thermalState(Device::ThermalState::NOMINAL)
+{
+    std::fill(_frames, _frames + HISTORY, 0);
+    std::fill(_scales, _scales + HISTORY, 1.0f);
+    updateThermalState();
+}
+
+void DynamicResolution::setScaleRange(float minScale, float maxScale)
+{
+    _maxScale = clampf(maxScale, 0.1f, 1.0f);
+    _minScale = clampf(minScale, 0.1f, _maxScale);
+    _scale = clampf(_scale, _minScale, _maxScale);
+}
+
+void DynamicResolution::setThermalScalingEnabled(bool enabled)
+{
+    _thermalScaling = enabled;
+    if (enabled)
+    {
+        updateThermalState();
+    }
+}
+
+void DynamicResolution::setScale(float scale)
+{
+    _scale = clampf(scale, _minScale, _maxScale);
+    _framesUnder = 0;
+    _framesOver = 0;
+}
+
+void DynamicResolution::updateThermalState()
+{
+    if (!_thermalScaling)
+    {
+        return;
+    }
+
+    // on Android it goes through JNI
+    auto now = FrameTimings::Clock::now();
+    if (std::chrono::duration<float, std::milli>(now - _thermalStateTime).count() >= THERMAL_STATE_INTERVAL)
+    {
+        _thermalStateTime = now;
+        _thermalState = Device::getThermalState();
+    }
+}
+
+float DynamicResolution::getScaleOfFrame(unsigned int frame) const
+{
+    const int index = frame % HISTORY;
+    return _frames[index] == frame ? _scales[index] : _scale;
+}
+
+float DynamicResolution::update(const FrameTimings* timings, unsigned int frame, float frameBudget)
+{
+    updateThermalState();
+
+    float maxScale = _maxScale;
+    if (_thermalScaling && _thermalState == Device::ThermalState::SERIOUS)
+    {
+        maxScale = (_minScale + _maxScale) / 2;
+    }
+    else if (_thermalScaling && _thermalState == Device::ThermalState::CRITICAL)
+    {
+        maxScale = _minScale;
+    }
+
+    float scale = _scale;
+    if (timings && timings->size() > 0)
+    {
+        const float target = _targetGPUTime > 0 ? _targetGPUTime : frameBudget * 0.85f;
+
+        // the GPU times arrive a few frames late, the newest one is used once
+        const FrameTiming* measured = nullptr;
+        for (int i = 0; i < timings->size(); ++i)
+        {
+            if (timings->at(i).gpu >= 0)
+            {
+                measured = &timings->at(i);
+                break;
+            }
+        }
+
+        if (measured)
+        {
+            if (!_hasLastFrame || (int)(measured->frame - _lastFrame) > 0)
+            {
+                _hasLastFrame = true;
+                _lastFrame = measured->frame;
+
+                // the time at full resolution, it follows a heavier frame at once and a lighter one slowly
+                const float frameScale = getScaleOfFrame(measured->frame);
+                const float fullResolutionTime = measured->gpu / (frameScale * frameScale);
+                if (_fullResolutionGPUTime < 0 || fullResolutionTime > _fullResolutionGPUTime)
+                {
+                    _fullResolutionGPUTime = fullResolutionTime;
+                }
+                else
+                {
+                    _fullResolutionGPUTime = _fullResolutionGPUTime * 0.9f + fullResolutionTime * 0.1f;
+                }
+
+                const float fitting = std::sqrt(target / std::max(_fullResolutionGPUTime, 0.001f));
+                if (measured->gpu > target)
+                {
+                    scale = std::min(scale - SCALE_STEP, std::floor(fitting / SCALE_STEP) * SCALE_STEP);
+                    _framesUnder = 0;
+                }
+                else if (fitting >= scale + SCALE_STEP && ++_framesUnder >= FRAMES_BEFORE_INCREASE)
+                {
+                    scale += SCALE_STEP;
+                    _framesUnder = 0;
+                }
+                else if (fitting < scale + SCALE_STEP)
+                {
+                    _framesUnder = 0;
+                }
+            }
+        }
+        else
+        {
+            // no timer queries, the newest frame has its total time
+            const FrameTiming& last = timings->at(0);
+            if (last.total > 0 && (!_hasLastFrame || (int)(last.frame - _lastFrame) > 0))
+            {
+                _hasLastFrame = true;
+                _lastFrame = last.frame;
+
+                if (last.total > frameBudget * 1.25f)
+                {
+                    _framesUnder = 0;
+                    if (++_framesOver >= MISSES_BEFORE_DECREASE)
+                    {
+                        scale -= SCALE_STEP;
+                        _framesOver = 0;
+                    }
+                }
+                else
+                {
+                    _framesOver = 0;
+                    if (++_framesUnder >= FRAMES_BEFORE_PROBE)
+                    {
+                        scale += SCALE_STEP;
+                        _framesUnder = 0;
+                    }
+                }
+            }
+        }
+    }
+
+    _scale = clampf(scale, _minScale, maxScale);
+
+    const int index = frame % HISTORY;
+    _frames[index] = frame;
+    _scales[index] = _scale;
+    return _scale;
+}
+
+NS_CC_END
@@ -0,0 +1,114 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_DYNAMIC_RESOLUTION_H__
+#define __CC_DYNAMIC_RESOLUTION_H__
+
+#include "base/CCFrameTimings.h"
+#include "platform/CCDevice.h"
+
+/**
+ * @addtogroup base
+ * @{
+ */
+NS_CC_BEGIN
+
+/**
+ * @class DynamicResolution
+ * @brief Picks the resolution the scene is drawn at from the GPU time of the last frames and the thermal state of
+ * the device, see Director::setDynamicResolutionEnabled().
+ *
+ * The GPU time of a frame, from FrameTimings, is brought back to full resolution assuming it grows with the
+ * number of pixels, and the scale is the one that would fit it in the target time. The scale goes down as soon as
+ * a frame goes over the target and up once the frames have been under it for half a second, in steps of 1/20
+ * so the targets of the scene come in a few sizes only. Without timer queries, it goes down after the frames
+ * missed their budget three times in a row and back up after two seconds without a miss.
+ * The SERIOUS and CRITICAL thermal states lower the highest scale, to the middle of the range and to the lowest.
+ * @js NA
+ */
+class CC_DLL DynamicResolution
+{
+public:
+    DynamicResolution();
+
+    /** Sets the lowest and the highest scale, 0.5 and 1 by default. */
+    void setScaleRange(float minScale, float maxScale);
+    float getMinScale() const { return _minScale; }
+    float getMaxScale() const { return _maxScale; }
+
+    /** Sets the GPU time of a frame the scale aims at, in milliseconds. 0, the default, aims at 85% of the animation interval. */
+    void setTargetGPUTime(float milliseconds) { _targetGPUTime = milliseconds; }
+    float getTargetGPUTime() const { return _targetGPUTime; }
+
+    /** Whether the thermal state of the device lowers the highest scale. True by default. */
+    void setThermalScalingEnabled(bool enabled);
+    bool isThermalScalingEnabled() const { return _thermalScaling; }
+
+    /** Gets the scale the scene is drawn at. */
+    float getScale() const { return _scale; }
+
+    /** Sets the scale, before a heavy scene for instance; the next frames adjust it again. */
+    void setScale(float scale);
+
+    /**
+     * Adjusts the scale, called by the Director before it draws a frame.
+     * @param timings The timings of the last frames.
+     * @param frame The number of the frame about to be drawn.
+     * @param frameBudget The animation interval, in milliseconds.
+     * @return The scale to draw the frame at.
+     */
+    float update(const FrameTimings* timings, unsigned int frame, float frameBudget);
+
+protected:
+    // the scales of the last frames, their GPU times arrive a few frames late
+    static const int HISTORY = 16;
+
+    void updateThermalState();
+    float getScaleOfFrame(unsigned int frame) const;
+
+    float _minScale;
+    float _maxScale;
+    float _targetGPUTime;
+    bool _thermalScaling;
+    float _scale;
+
+    // the last frame whose GPU time was used, and the GPU time at full resolution, smoothed
+    unsigned int _lastFrame;
+    bool _hasLastFrame;
+    float _fullResolutionGPUTime;
+    // the frames in a row the scale could have gone up, or that missed their budget without timer queries
+    int _framesUnder;
+    int _framesOver;
+
+    Device::ThermalState _thermalState;
+    FrameTimings::Clock::time_point _thermalStateTime;
+
+    unsigned int _frames[HISTORY];
+    float _scales[HISTORY];
+};
+
+NS_CC_END
+// end group
+/// @}
+#endif //__CC_DYNAMIC_RESOLUTION_H__
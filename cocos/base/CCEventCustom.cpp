@@ -26,8 +26,24 @@
 #include "base/CCEvent.h"
 #include "base/CCEventListener.h"
 
+#include <mutex>
+#include <unordered_map>
+
 NS_CC_BEGIN
 
+// the interned event names by ID, the events of getEventID() may be dispatched before the statics of the file are built
+static std::unordered_map<long, std::string>& getInternedNames()
+{
+    static std::unordered_map<long, std::string> names;
+    return names;
+}
+
+static std::mutex& getInternedNamesMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
 EventCustom::EventCustom(const std::string& eventName)
 : Event(Type::CUSTOM)
 , _userData(nullptr)
@@ -36,5 +52,36 @@ EventCustom::EventCustom(const std::string& eventName)
     _typeKey = EventListener::getHashCode(eventName);
 }
 
+EventCustom::EventCustom(long eventID)
+: Event(Type::CUSTOM)
+, _userData(nullptr)
+{
+    _typeKey = eventID;
+}
+
+long EventCustom::getEventID(const std::string& eventName)
+{
+    const long eventID = (long)EventListener::getHashCode(eventName);
+    std::lock_guard<std::mutex> lock(getInternedNamesMutex());
+    getInternedNames().emplace(eventID, eventName);
+    return eventID;
+}
+
+const std::string& EventCustom::getEventName() const
+{
+    if (_eventName.empty() && _typeKey != EventListener::TYPEKEY_CUSTOM)
+    {
+        // built from an ID, the node of an interned name is never erased
+        std::lock_guard<std::mutex> lock(getInternedNamesMutex());
+        const auto& names = getInternedNames();
+        auto iter = names.find(_typeKey);
+        if (iter != names.end())
+        {
+            return iter->second;
+        }
+    }
+    return _eventName;
+}
+
 NS_CC_END
 
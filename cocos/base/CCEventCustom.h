@@ -48,6 +48,25 @@ public:
      */
     EventCustom(const std::string& eventName);
 
+    /** Constructor from the ID of the event name, see getEventID(). The name isn't copied, getEventName() looks it up.
+     *
+     * @param eventID The ID of a custom event name.
+     * @js NA
+     * @since v3.11
+     */
+    explicit EventCustom(long eventID);
+
+    /** Gets the ID of an event name, the key the listeners of the event are found with.
+     * The name is interned: the events built from the ID get it back from getEventName().
+     * Keep the ID in a static to dispatch the event without hashing its name, see EventDispatcher::dispatchCustomEvent().
+     *
+     * @param eventName A given name of the custom event.
+     * @return The ID of the event name.
+     * @js NA
+     * @since v3.11
+     */
+    static long getEventID(const std::string& eventName);
+
     /** Sets user data.
      *
      * @param data The user data pointer, it's a void*.
@@ -64,7 +83,7 @@ public:
      *
      * @return The name of the event.
      */
-    inline const std::string& getEventName() const { return _eventName; };
+    const std::string& getEventName() const;
 protected:
     void* _userData;       ///< User data
     std::string _eventName;
@@ -38,9 +38,29 @@
 
 #define DUMP_LISTENER_ITEM_PRIORITY_INFO 0
 
+// the listeners whose node covers more cells are tested for every touch
+#define TOUCH_INDEX_MAX_CELLS 64
+
 namespace
 {
 
+bool isTouchInsideNode(cocos2d::Touch* touch, cocos2d::Node* node)
+{
+    for (auto n = node; n != nullptr; n = n->getParent())
+    {
+        if (!n->isVisible())
+            return false;
+    }
+
+    auto point = node->convertToNodeSpace(touch->getLocation());
+    return cocos2d::Rect(cocos2d::Vec2::ZERO, node->getContentSize()).containsPoint(point);
+}
+
+int64_t touchIndexCellKey(int x, int y)
+{
+    return ((int64_t)x << 32) | (uint32_t)y;
+}
+
 class DispatchGuard
 {
 public:
@@ -155,9 +175,15 @@ void EventDispatcher::EventListenerVector::clear()
 
 
 EventDispatcher::EventDispatcher()
-: _inDispatch(0)
+: _nodePriorityDirty(true)
+, _inDispatch(0)
 , _isEnabled(false)
+, _inputEventCount(0)
 , _nodePriorityIndex(0)
+, _isTouchIndexEnabled(false)
+, _touchIndexCellSize(128)
+, _touchIndexListenersDirty(true)
+, _hasUnregisteredListeners(false)
 {
     _toAddedListeners.reserve(50);
     _toRemovedListeners.reserve(50);
@@ -175,9 +201,15 @@ EventDispatcher::~EventDispatcher()
     // so removeAllEventListeners would clean internal custom listeners.
     _internalCustomTypeKeys.clear();
     removeAllEventListeners();
+
+    for (auto& node : _reorderedNodes)
+    {
+        node->release();
+    }
+    _reorderedNodes.clear();
 }
 
-void EventDispatcher::visitTarget(Node* node, bool isRootNode)
+void EventDispatcher::visitTarget(Node* node, std::vector<Node*>* nodes)
 {
     node->sortAllChildren();
 
@@ -195,54 +227,98 @@ void EventDispatcher::visitTarget(Node* node, bool isRootNode)
             child = children.at(i);
 
             if ( child && child->getLocalZOrder() < 0 )
-                visitTarget(child, false);
+                visitTarget(child, nodes);
             else
                 break;
         }
 
         if (_nodeListenersMap.find(node) != _nodeListenersMap.end())
         {
-            _globalZOrderNodeMap[node->getGlobalZOrder()].push_back(node);
+            nodes->push_back(node);
         }
 
         for( ; i < childrenCount; i++ )
         {
             child = children.at(i);
             if (child)
-                visitTarget(child, false);
+                visitTarget(child, nodes);
         }
     }
     else
     {
         if (_nodeListenersMap.find(node) != _nodeListenersMap.end())
         {
-            _globalZOrderNodeMap[node->getGlobalZOrder()].push_back(node);
+            nodes->push_back(node);
         }
     }
+}
+
+bool EventDispatcher::updateNodePriorities()
+{
+    auto rootNode = Director::DirectorInstance->getRunningScene();
+    if (rootNode == nullptr)
+        return false;
+
+    std::vector<Node*> nodes;
+    nodes.reserve(_nodeListenersMap.size());
+    visitTarget(rootNode, &nodes);
 
-    if (isRootNode)
+    // Reset priority index
+    _nodePriorityIndex = 0;
+    _nodePriorityMap.clear();
+
+    for (const auto& n : nodes)
+    {
+        _nodePriorityMap[n] = ++_nodePriorityIndex;
+    }
+
+    // Every scene graph listener may have moved, they are sorted again by the draw order just walked
+    for (const auto& e : _listenerMap)
     {
-        std::vector<float> globalZOrders;
-        globalZOrders.reserve(_globalZOrderNodeMap.size());
+        auto sceneGraphListeners = e.second->getSceneGraphPriorityListeners();
+        if (sceneGraphListeners && !sceneGraphListeners->empty())
+        {
+            setDirty(e.first, DirtyFlag::SCENE_GRAPH_PRIORITY);
+        }
+    }
+
+    _nodePriorityDirty = false;
+    return true;
+}
 
-        for (const auto& e : _globalZOrderNodeMap)
+void EventDispatcher::updateNodePriorities(Node* node)
+{
+    // The subtree is contiguous in the draw order, so its nodes keep the priorities they already had between them
+    std::vector<Node*> nodes;
+    visitTarget(node, &nodes);
+
+    std::vector<int> priorities;
+    priorities.reserve(nodes.size());
+    for (const auto& n : nodes)
+    {
+        auto iter = _nodePriorityMap.find(n);
+        if (iter == _nodePriorityMap.end())
         {
-            globalZOrders.push_back(e.first);
+            // A node the last walk didn't see, only a walk of the whole scene can place it
+            _nodePriorityDirty = true;
+            return;
         }
+        priorities.push_back(iter->second);
+    }
 
-        std::sort(globalZOrders.begin(), globalZOrders.end(), [](const float a, const float b){
-            return a < b;
-        });
+    std::sort(priorities.begin(), priorities.end());
 
-        for (const auto& globalZ : globalZOrders)
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        int& priority = _nodePriorityMap[nodes[i]];
+        if (priority != priorities[i])
         {
-            for (const auto& n : _globalZOrderNodeMap[globalZ])
+            priority = priorities[i];
+            for (auto& l : *_nodeListenersMap[nodes[i]])
             {
-                _nodePriorityMap[n] = ++_nodePriorityIndex;
+                setDirty(l->getTypeKey(), DirtyFlag::SCENE_GRAPH_PRIORITY);
             }
         }
-
-        _globalZOrderNodeMap.clear();
     }
 }
 
@@ -373,10 +449,21 @@ void EventDispatcher::associateNodeAndEventListener(Node* node, EventListener* l
     }
 
     listeners->push_back(listener);
+    node->_eventListenerCount++;
+
+    // A node without draw order yet needs a walk of the scene to get one
+    if (_nodePriorityMap.find(node) == _nodePriorityMap.end())
+    {
+        _nodePriorityDirty = true;
+    }
+
+    addToTouchIndex(node, listener);
 }
 
 void EventDispatcher::dissociateNodeAndEventListener(Node* node, EventListener* listener)
 {
+    removeFromTouchIndex(node, listener);
+
     std::vector<EventListener*>* listeners = nullptr;
     auto found = _nodeListenersMap.find(node);
     if (found != _nodeListenersMap.end())
@@ -386,6 +473,7 @@ void EventDispatcher::dissociateNodeAndEventListener(Node* node, EventListener*
         if (iter != listeners->end())
         {
             listeners->erase(iter);
+            node->_eventListenerCount--;
         }
 
         if (listeners->empty())
@@ -577,6 +665,7 @@ void EventDispatcher::removeEventListener(EventListener* listener)
             {
                 CC_SAFE_RETAIN(l);
                 l->setRegistered(false);
+                _hasUnregisteredListeners = true;
                 if (l->getAssociatedNode() != nullptr)
                 {
                     dissociateNodeAndEventListener(l->getAssociatedNode(), l);
@@ -695,11 +784,13 @@ void EventDispatcher::setPriority(EventListener* listener, int fixedPriority)
     }
 }
 
-void EventDispatcher::dispatchEventToListeners(EventListenerVector* listeners, const std::function<bool(EventListener*)>& onEvent)
+template <typename OnEvent>
+void EventDispatcher::dispatchEventToListeners(EventListenerVector* listeners, const OnEvent& onEvent,
+                                               const std::vector<EventListener*>* sceneGraphListeners)
 {
     bool shouldStopPropagation = false;
     auto fixedPriorityListeners = listeners->getFixedPriorityListeners();
-    auto sceneGraphPriorityListeners = listeners->getSceneGraphPriorityListeners();
+    const std::vector<EventListener*>* sceneGraphPriorityListeners = sceneGraphListeners ? sceneGraphListeners : listeners->getSceneGraphPriorityListeners();
 
     ssize_t i = 0;
     // priority < 0
@@ -781,6 +872,11 @@ void EventDispatcher::dispatchEvent(Event* event)
     if (!_isEnabled)
         return;
 
+    if (event->getType() != Event::Type::CUSTOM)
+    {
+        _inputEventCount++;
+    }
+
     updateDirtyFlagForSceneGraph();
 
     DispatchGuard guard(_inDispatch);
@@ -814,11 +910,25 @@ void EventDispatcher::dispatchEvent(Event* event)
 
 void EventDispatcher::dispatchCustomEvent(const std::string &eventName, void *optionalUserData)
 {
+    // most events of a gameplay bus have no listener, they don't need the copy of their name
+    if (!_isEnabled || _listenerMap.find(EventListener::getHashCode(eventName)) == _listenerMap.end())
+        return;
+
     EventCustom ev(eventName);
     ev.setUserData(optionalUserData);
     dispatchEvent(&ev);
 }
 
+void EventDispatcher::dispatchCustomEvent(long eventID, void *optionalUserData)
+{
+    if (!_isEnabled || _listenerMap.find(eventID) == _listenerMap.end())
+        return;
+
+    EventCustom ev(eventID);
+    ev.setUserData(optionalUserData);
+    dispatchEvent(&ev);
+}
+
 void EventDispatcher::dispatchTouchEvent(EventTouch* event)
 {
     sortEventListeners(EventListener::TYPEKEY_TOUCH_ONE_BY_ONE);
@@ -845,6 +955,15 @@ void EventDispatcher::dispatchTouchEvent(EventTouch* event)
         auto mutableTouchesIter = mutableTouches.begin();
         auto touchesIter = originalTouches.begin();
 
+        // with the spatial index, a touch only begins for the listeners around it
+        const bool useTouchIndex = _isTouchIndexEnabled && event->getEventCode() == EventTouch::EventCode::BEGAN
+                                   && oneByOneListeners->getSceneGraphPriorityListeners() != nullptr;
+        std::vector<EventListener*> candidates;
+        if (useTouchIndex)
+        {
+            updateTouchIndex(oneByOneListeners);
+        }
+
         for (; touchesIter != originalTouches.end(); ++touchesIter)
         {
             bool isSwallowed = false;
@@ -865,7 +984,8 @@ void EventDispatcher::dispatchTouchEvent(EventTouch* event)
 
                 if (eventCode == EventTouch::EventCode::BEGAN)
                 {
-                    if (listener->onTouchBegan)
+                    if (listener->onTouchBegan && (!listener->_isHitTestEnabled || listener->_node == nullptr
+                                                   || isTouchInsideNode(*touchesIter, listener->_node)))
                     {
                         isClaimed = listener->onTouchBegan(*touchesIter, event);
                         if (isClaimed && listener->_isRegistered)
@@ -937,7 +1057,15 @@ void EventDispatcher::dispatchTouchEvent(EventTouch* event)
             };
 
             //
-            dispatchEventToListeners(oneByOneListeners, onTouchEvent);
+            if (useTouchIndex)
+            {
+                getTouchIndexCandidates((*touchesIter)->getLocation(), &candidates);
+                dispatchEventToListeners(oneByOneListeners, onTouchEvent, &candidates);
+            }
+            else
+            {
+                dispatchEventToListeners(oneByOneListeners, onTouchEvent);
+            }
             if (event->isStopped())
             {
                 return;
@@ -1020,6 +1148,11 @@ void EventDispatcher::updateListeners(Event* event)
     if (_inDispatch > 1)
         return;
 
+    // nothing to clean up, the listeners were only called
+    if (!_hasUnregisteredListeners && _toAddedListeners.empty() && _toRemovedListeners.empty())
+        return;
+    _hasUnregisteredListeners = false;
+
     auto onUpdateListeners = [this](const EventListener::TypeKey listenerID)
     {
         auto listenersIter = _listenerMap.find(listenerID);
@@ -1144,6 +1277,29 @@ void EventDispatcher::updateDirtyFlagForSceneGraph()
         }
 
         _dirtyNodes.clear();
+        _nodePriorityDirty = true;
+    }
+
+    if (!_reorderedNodes.empty())
+    {
+        // Sorting the children while walking may reorder more nodes, they're left for the next update
+        std::unordered_set<Node*> reorderedNodes;
+        reorderedNodes.swap(_reorderedNodes);
+
+        for (auto& node : reorderedNodes)
+        {
+            // A walk of the whole scene covers the reordered nodes
+            if (!_nodePriorityDirty)
+            {
+                updateNodePriorities(node);
+            }
+            node->release();
+        }
+    }
+
+    if (_nodePriorityDirty && !_nodeListenersMap.empty())
+    {
+        updateNodePriorities();
     }
 }
 
@@ -1159,7 +1315,7 @@ void EventDispatcher::sortEventListeners(const EventListener::TypeKey listenerID
 
     if (dirtyFlag != DirtyFlag::NONE)
     {
-        // Clear the dirty flag first, if `rootNode` is nullptr, then set its dirty flag of scene graph priority
+        // Clear the dirty flag first, if the draw order is still out of date, then set its dirty flag of scene graph priority
         dirtyIter->second = DirtyFlag::NONE;
 
         if ((int)dirtyFlag & (int)DirtyFlag::FIXED_PRIORITY)
@@ -1169,10 +1325,9 @@ void EventDispatcher::sortEventListeners(const EventListener::TypeKey listenerID
 
         if ((int)dirtyFlag & (int)DirtyFlag::SCENE_GRAPH_PRIORITY)
         {
-            auto rootNode = Director::DirectorInstance->getRunningScene();
-            if (rootNode)
+            if (!_nodePriorityDirty)
             {
-                sortEventListenersOfSceneGraphPriority(listenerID, rootNode);
+                sortEventListenersOfSceneGraphPriority(listenerID);
             }
             else
             {
@@ -1182,7 +1337,7 @@ void EventDispatcher::sortEventListeners(const EventListener::TypeKey listenerID
     }
 }
 
-void EventDispatcher::sortEventListenersOfSceneGraphPriority(const EventListener::TypeKey listenerID, Node* rootNode)
+void EventDispatcher::sortEventListenersOfSceneGraphPriority(const EventListener::TypeKey listenerID)
 {
     auto listeners = getListeners(listenerID);
 
@@ -1193,17 +1348,28 @@ void EventDispatcher::sortEventListenersOfSceneGraphPriority(const EventListener
     if (sceneGraphListeners == nullptr)
         return;
 
-    // Reset priority index
-    _nodePriorityIndex = 0;
-    _nodePriorityMap.clear();
-
-    visitTarget(rootNode, true);
+    // The nodes out of the running scene have no draw order, they go last
+    auto priorityOf = [this](Node* node) {
+        auto iter = _nodePriorityMap.find(node);
+        return iter != _nodePriorityMap.end() ? iter->second : 0;
+    };
 
-    // After sort: priority < 0, > 0
-    std::sort(sceneGraphListeners->begin(), sceneGraphListeners->end(), [this](const EventListener* l1, const EventListener* l2) {
-        return _nodePriorityMap[l1->getAssociatedNode()] > _nodePriorityMap[l2->getAssociatedNode()];
+    // After sort: the highest global Z order first, then the latest drawn
+    std::sort(sceneGraphListeners->begin(), sceneGraphListeners->end(), [&priorityOf](const EventListener* l1, const EventListener* l2) {
+        Node* n1 = l1->getAssociatedNode();
+        Node* n2 = l2->getAssociatedNode();
+        if (n1->getGlobalZOrder() != n2->getGlobalZOrder())
+        {
+            return n1->getGlobalZOrder() > n2->getGlobalZOrder();
+        }
+        return priorityOf(n1) > priorityOf(n2);
     });
 
+    if (listenerID == EventListener::TYPEKEY_TOUCH_ONE_BY_ONE)
+    {
+        _touchIndexListenersDirty = true;
+    }
+
 #if DUMP_LISTENER_ITEM_PRIORITY_INFO
     log("-----------------------------------");
     for (auto& l : *sceneGraphListeners)
@@ -1278,6 +1444,7 @@ void EventDispatcher::removeEventListenersForTypeKey(const EventListener::TypeKe
             {
                 auto l = *iter;
                 l->setRegistered(false);
+                _hasUnregisteredListeners = true;
                 if (l->getAssociatedNode() != nullptr)
                 {
                     dissociateNodeAndEventListener(l->getAssociatedNode(), l);
@@ -1403,6 +1570,232 @@ bool EventDispatcher::isEnabled() const
     return _isEnabled;
 }
 
+void EventDispatcher::setTouchSpatialIndexEnabled(bool enabled, float cellSize)
+{
+    CCASSERT(cellSize > 0, "Invalid cell size");
+
+    if (_isTouchIndexEnabled)
+    {
+        // start over, with the new cell size
+        auto oneByOneListeners = getListeners(EventListener::TYPEKEY_TOUCH_ONE_BY_ONE);
+        if (oneByOneListeners && oneByOneListeners->getSceneGraphPriorityListeners())
+        {
+            for (auto& l : *oneByOneListeners->getSceneGraphPriorityListeners())
+            {
+                if (l->isRegistered())
+                {
+                    removeFromTouchIndex(l->getAssociatedNode(), l);
+                }
+            }
+        }
+        _touchIndexCells.clear();
+        _touchIndexOversized.clear();
+        _touchIndexUnindexed.clear();
+        std::lock_guard<std::mutex> lock(_touchIndexMutex);
+        _touchIndexDirtyNodes.clear();
+    }
+
+    _isTouchIndexEnabled = enabled;
+    _touchIndexCellSize = cellSize;
+    _touchIndexListenersDirty = true;
+
+    if (enabled)
+    {
+        auto oneByOneListeners = getListeners(EventListener::TYPEKEY_TOUCH_ONE_BY_ONE);
+        if (oneByOneListeners && oneByOneListeners->getSceneGraphPriorityListeners())
+        {
+            for (auto& l : *oneByOneListeners->getSceneGraphPriorityListeners())
+            {
+                if (l->isRegistered())
+                {
+                    addToTouchIndex(l->getAssociatedNode(), l);
+                }
+            }
+        }
+    }
+}
+
+void EventDispatcher::addToTouchIndex(Node* node, EventListener* listener)
+{
+    if (listener->getType() != EventListener::Type::TOUCH_ONE_BY_ONE)
+        return;
+
+    _touchIndexListenersDirty = true;
+
+    auto touchListener = static_cast<EventListenerTouchOneByOne*>(listener);
+    if (!_isTouchIndexEnabled || !touchListener->_isHitTestEnabled)
+        return;
+
+    // placed by the next touch, as a moved node
+    ++node->_touchIndexListenerCount;
+    setTouchIndexDirtyForNode(node);
+}
+
+void EventDispatcher::removeFromTouchIndex(Node* node, EventListener* listener)
+{
+    if (listener->getType() != EventListener::Type::TOUCH_ONE_BY_ONE)
+        return;
+
+    _touchIndexListenersDirty = true;
+
+    auto touchListener = static_cast<EventListenerTouchOneByOne*>(listener);
+    if (!_isTouchIndexEnabled || !touchListener->_isHitTestEnabled)
+        return;
+
+    removeFromTouchIndexCells(touchListener);
+
+    if (--node->_touchIndexListenerCount == 0)
+    {
+        // the node may be destroyed next
+        std::lock_guard<std::mutex> lock(_touchIndexMutex);
+        if (node->_touchIndexDirty)
+        {
+            _touchIndexDirtyNodes.erase(std::find(_touchIndexDirtyNodes.begin(), _touchIndexDirtyNodes.end(), node));
+            node->_touchIndexDirty = false;
+        }
+    }
+}
+
+void EventDispatcher::setTouchIndexDirtyForNode(Node* node)
+{
+    std::lock_guard<std::mutex> lock(_touchIndexMutex);
+    if (!node->_touchIndexDirty)
+    {
+        node->_touchIndexDirty = true;
+        _touchIndexDirtyNodes.push_back(node);
+    }
+}
+
+void EventDispatcher::placeInTouchIndex(EventListenerTouchOneByOne* listener)
+{
+    removeFromTouchIndexCells(listener);
+
+    auto node = listener->_node;
+    const Size& size = node->getContentSize();
+    Rect bounds = RectApplyTransform(Rect(0, 0, size.width, size.height), node->getNodeToWorldTransform());
+
+    const float cellSize = _touchIndexCellSize;
+    const int minX = (int)floorf(bounds.getMinX() / cellSize), maxX = (int)floorf(bounds.getMaxX() / cellSize);
+    const int minY = (int)floorf(bounds.getMinY() / cellSize), maxY = (int)floorf(bounds.getMaxY() / cellSize);
+
+    if ((int64_t)(maxX - minX + 1) * (maxY - minY + 1) > TOUCH_INDEX_MAX_CELLS)
+    {
+        listener->_isOversized = true;
+        _touchIndexOversized.push_back(listener);
+        return;
+    }
+
+    listener->_cellMinX = minX, listener->_cellMinY = minY;
+    listener->_cellMaxX = maxX, listener->_cellMaxY = maxY;
+    for (int y = minY; y <= maxY; ++y)
+    {
+        for (int x = minX; x <= maxX; ++x)
+        {
+            _touchIndexCells[touchIndexCellKey(x, y)].push_back(listener);
+        }
+    }
+}
+
+void EventDispatcher::removeFromTouchIndexCells(EventListenerTouchOneByOne* listener)
+{
+    auto removeFrom = [listener](std::vector<EventListenerTouchOneByOne*>& listeners) {
+        auto iter = std::find(listeners.begin(), listeners.end(), listener);
+        if (iter != listeners.end())
+        {
+            // the order within a cell doesn't matter, the candidates are sorted
+            *iter = listeners.back();
+            listeners.pop_back();
+        }
+    };
+
+    if (listener->_isOversized)
+    {
+        removeFrom(_touchIndexOversized);
+        listener->_isOversized = false;
+    }
+
+    for (int y = listener->_cellMinY; y <= listener->_cellMaxY; ++y)
+    {
+        for (int x = listener->_cellMinX; x <= listener->_cellMaxX; ++x)
+        {
+            auto cell = _touchIndexCells.find(touchIndexCellKey(x, y));
+            if (cell != _touchIndexCells.end())
+            {
+                removeFrom(cell->second);
+                if (cell->second.empty())
+                {
+                    _touchIndexCells.erase(cell);
+                }
+            }
+        }
+    }
+    listener->_cellMinX = listener->_cellMinY = 0;
+    listener->_cellMaxX = listener->_cellMaxY = -1;
+}
+
+void EventDispatcher::updateTouchIndex(EventListenerVector* listeners)
+{
+    if (_touchIndexListenersDirty)
+    {
+        _touchIndexListenersDirty = false;
+        _touchIndexUnindexed.clear();
+
+        auto sceneGraphListeners = listeners->getSceneGraphPriorityListeners();
+        for (size_t i = 0; i < sceneGraphListeners->size(); ++i)
+        {
+            auto l = static_cast<EventListenerTouchOneByOne*>(sceneGraphListeners->at(i));
+            l->_sceneGraphOrder = (int)i;
+            if (!l->_isHitTestEnabled)
+            {
+                _touchIndexUnindexed.push_back(l);
+            }
+        }
+    }
+
+    std::vector<Node*> dirtyNodes;
+    {
+        std::lock_guard<std::mutex> lock(_touchIndexMutex);
+        dirtyNodes.swap(_touchIndexDirtyNodes);
+        for (auto node : dirtyNodes)
+        {
+            node->_touchIndexDirty = false;
+        }
+    }
+
+    for (auto node : dirtyNodes)
+    {
+        auto iter = _nodeListenersMap.find(node);
+        if (iter == _nodeListenersMap.end())
+            continue;
+
+        for (auto l : *iter->second)
+        {
+            if (l->getType() == EventListener::Type::TOUCH_ONE_BY_ONE && l->isRegistered()
+                && static_cast<EventListenerTouchOneByOne*>(l)->_isHitTestEnabled)
+            {
+                placeInTouchIndex(static_cast<EventListenerTouchOneByOne*>(l));
+            }
+        }
+    }
+}
+
+void EventDispatcher::getTouchIndexCandidates(const Vec2& location, std::vector<EventListener*>* candidates)
+{
+    candidates->assign(_touchIndexUnindexed.begin(), _touchIndexUnindexed.end());
+    candidates->insert(candidates->end(), _touchIndexOversized.begin(), _touchIndexOversized.end());
+
+    const float cellSize = _touchIndexCellSize;
+    auto cell = _touchIndexCells.find(touchIndexCellKey((int)floorf(location.x / cellSize), (int)floorf(location.y / cellSize)));
+    if (cell != _touchIndexCells.end())
+    {
+        candidates->insert(candidates->end(), cell->second.begin(), cell->second.end());
+    }
+
+    std::sort(candidates->begin(), candidates->end(), [](const EventListener* l1, const EventListener* l2) {
+        return static_cast<const EventListenerTouchOneByOne*>(l1)->_sceneGraphOrder < static_cast<const EventListenerTouchOneByOne*>(l2)->_sceneGraphOrder;
+    });
+}
+
 void EventDispatcher::setDirtyForNode(Node* node)
 {
     // Mark the node dirty only when there is an eventlistener associated with it.
@@ -1419,6 +1812,31 @@ void EventDispatcher::setDirtyForNode(Node* node)
     }
 }
 
+void EventDispatcher::setReorderDirtyForNode(Node* node)
+{
+    // Nothing to keep in order without scene graph listeners, and a walk of the whole scene is due anyway
+    if (_nodeListenersMap.empty() || _nodePriorityDirty)
+        return;
+
+    if (_reorderedNodes.insert(node).second)
+    {
+        node->retain();
+    }
+}
+
+void EventDispatcher::setGlobalZOrderDirtyForNode(Node* node)
+{
+    // The draw order is left as is, only the listeners of the node are sorted again
+    auto iter = _nodeListenersMap.find(node);
+    if (iter != _nodeListenersMap.end())
+    {
+        for (auto& l : *iter->second)
+        {
+            setDirty(l->getTypeKey(), DirtyFlag::SCENE_GRAPH_PRIORITY);
+        }
+    }
+}
+
 void EventDispatcher::setDirty(const EventListener::TypeKey listenerID, DirtyFlag flag)
 {
     auto iter = _priorityDirtyFlagMap.find(listenerID);
@@ -30,10 +30,13 @@
 #include <unordered_map>
 #include <vector>
 #include <set>
+#include <unordered_set>
+#include <mutex>
 
 #include "platform/CCPlatformMacros.h"
 #include "base/CCEventListener.h"
 #include "base/CCEvent.h"
+#include "math/Vec2.h"
 #include "platform/CCStdC.h"
 
 /**
@@ -48,6 +51,7 @@ class EventTouch;
 class Node;
 class EventCustom;
 class EventListenerCustom;
+class EventListenerTouchOneByOne;
 
 /** @class EventDispatcher
 * @brief This class manages event listener subscriptions
@@ -160,6 +164,29 @@ public:
      */
     bool isEnabled() const;
 
+    /** Gets the number of events other than the custom ones, the input events, dispatched since the dispatcher was created.
+     * The Director compares it between frames, see Director::setRetainedModeEnabled().
+     */
+    unsigned int getInputEventCount() const { return _inputEventCount; }
+
+    /** Enables the spatial index of the touch listeners with hit test, see EventListenerTouchOneByOne::setHitTestEnabled().
+     * Their nodes are kept in a grid by their bounds in world space, updated when a node is visited with a changed
+     * transform or content size. A touch then only begins for the listeners of its cell and the listeners without hit test,
+     * instead of going through every listener.
+     * The nodes must be visited to move in the grid, so it doesn't suit the sprites of a SpriteBatchNode.
+     * Disabled by default.
+     *
+     * @param enabled True to index the touch listeners with hit test.
+     * @param cellSize The size of the cells of the grid, in points.
+     */
+    void setTouchSpatialIndexEnabled(bool enabled, float cellSize = 128);
+
+    /** Checks whether the touch listeners with hit test are indexed.
+     *
+     * @return True if the touch spatial index is enabled.
+     */
+    bool isTouchSpatialIndexEnabled() const { return _isTouchIndexEnabled; }
+
     /////////////////////////////////////////////
 
     /** Dispatches the event.
@@ -177,6 +204,16 @@ public:
      */
     void dispatchCustomEvent(const std::string &eventName, void *optionalUserData = nullptr);
 
+    /** Dispatches a Custom Event by the ID of its name, see EventCustom::getEventID().
+     * The event is built on the stack without copying its name or hashing it, nothing is built when the event has no listener.
+     * Use it for the events dispatched every frame, with the ID kept in a static.
+     *
+     * @param eventID The ID of the event which needs to be dispatched.
+     * @param optionalUserData The optional user data, it's a void*, the default value is nullptr.
+     * @since v3.11
+     */
+    void dispatchCustomEvent(long eventID, void *optionalUserData = nullptr);
+
     /////////////////////////////////////////////
 
     /** Constructor of EventDispatcher.
@@ -199,9 +236,18 @@ public:
 protected:
     friend class Node;
 
-    /** Sets the dirty flag for a node. */
+    /** Sets the dirty flag for a node, its place in the scene graph changed. */
     void setDirtyForNode(Node* node);
 
+    /** Sets the dirty flag for the children order of a node, only the priorities of its subtree are updated. */
+    void setReorderDirtyForNode(Node* node);
+
+    /** Sets the dirty flag for the global Z order of a node, its listeners are sorted again without a scene graph walk. */
+    void setGlobalZOrderDirtyForNode(Node* node);
+
+    /** Marks the touch index entries of a node out of date, its transform changed. Thread safe. */
+    void setTouchIndexDirtyForNode(Node* node);
+
     /**
      *  The vector to store event listeners with scene graph based priority and fixed priority.
      */
@@ -253,7 +299,7 @@ protected:
     void sortEventListeners(const EventListener::TypeKey listenerID);
 
     /** Sorts the listeners of specified type by scene graph priority */
-    void sortEventListenersOfSceneGraphPriority(const EventListener::TypeKey listenerID, Node* rootNode);
+    void sortEventListenersOfSceneGraphPriority(const EventListener::TypeKey listenerID);
 
     /** Sorts the listeners of specified type by fixed priority */
     void sortEventListenersOfFixedPriority(const EventListener::TypeKey listenerID);
@@ -273,8 +319,32 @@ protected:
     /** Dissociates node with event listener */
     void dissociateNodeAndEventListener(Node* node, EventListener* listener);
 
-    /** Dispatches event to listeners with a specified listener type */
-    void dispatchEventToListeners(EventListenerVector* listeners, const std::function<bool(EventListener*)>& onEvent);
+    /** Dispatches event to listeners with a specified listener type
+     *  @param onEvent Called with each listener, returns whether the propagation stops. A template, the lambdas are called
+     *         without wrapping them into a std::function.
+     *  @param sceneGraphListeners The scene graph listeners to go through instead of all of them, in priority order.
+     */
+    template <typename OnEvent>
+    void dispatchEventToListeners(EventListenerVector* listeners, const OnEvent& onEvent,
+                                  const std::vector<EventListener*>* sceneGraphListeners = nullptr);
+
+    /** Adds a touch listener with hit test to the touch spatial index, it's placed in the grid by the next touch */
+    void addToTouchIndex(Node* node, EventListener* listener);
+
+    /** Removes a touch listener from the touch spatial index */
+    void removeFromTouchIndex(Node* node, EventListener* listener);
+
+    /** Places a touch listener with hit test in the cells of its node bounds */
+    void placeInTouchIndex(EventListenerTouchOneByOne* listener);
+
+    /** Removes a touch listener with hit test from its cells */
+    void removeFromTouchIndexCells(EventListenerTouchOneByOne* listener);
+
+    /** Brings the touch spatial index up to date with the scene graph listeners and the moved nodes */
+    void updateTouchIndex(EventListenerVector* listeners);
+
+    /** Gathers the scene graph listeners a touch may begin for, in priority order */
+    void getTouchIndexCandidates(const Vec2& location, std::vector<EventListener*>* candidates);
 
     /// Priority dirty flag
     enum class DirtyFlag
@@ -288,8 +358,14 @@ protected:
     /** Sets the dirty flag for a specified listener ID */
     void setDirty(const EventListener::TypeKey listenerID, DirtyFlag flag);
 
-    /** Walks though scene graph to get the draw order for each node, it's called before sorting event listener with scene graph priority */
-    void visitTarget(Node* node, bool isRootNode);
+    /** Walks though scene graph to get the draw order of the nodes with listeners */
+    void visitTarget(Node* node, std::vector<Node*>* nodes);
+
+    /** Gives the nodes of the running scene their draw order, returns false if there is no running scene */
+    bool updateNodePriorities();
+
+    /** Gives the nodes under a reordered node their new draw order, reusing the priorities they had */
+    void updateNodePriorities(Node* node);
 
     /** Remove all listeners in _toRemoveListeners list and cleanup */
     void cleanToRemovedListeners();
@@ -303,12 +379,9 @@ protected:
     /** The map of node and event listeners */
     std::unordered_map<Node*, std::vector<EventListener*>*> _nodeListenersMap;
 
-    /** The map of node and its event priority */
+    /** The map of node and its draw order, the priority is the global Z order then the draw order */
     std::unordered_map<Node*, int> _nodePriorityMap;
 
-    /** key: Global Z Order, value: Sorted Nodes */
-    std::unordered_map<float, std::vector<Node*>> _globalZOrderNodeMap;
-
     /** The listeners to be added after dispatching event */
     std::vector<EventListener*> _toAddedListeners;
 
@@ -318,15 +391,49 @@ protected:
     /** The nodes were associated with scene graph based priority listeners */
     std::set<Node*> _dirtyNodes;
 
+    /** The nodes whose children were reordered, retained until their priorities are updated */
+    std::unordered_set<Node*> _reorderedNodes;
+
+    /** Whether the draw order of all the nodes must be walked again */
+    bool _nodePriorityDirty;
+
     /** Whether the dispatcher is dispatching event */
     int _inDispatch;
 
     /** Whether to enable dispatching event */
     bool _isEnabled;
 
+    /** The number of events other than the custom ones dispatched */
+    unsigned int _inputEventCount;
+
     int _nodePriorityIndex;
 
     std::set<EventListener::TypeKey> _internalCustomTypeKeys;
+
+    /** Whether the touch listeners with hit test are indexed */
+    bool _isTouchIndexEnabled;
+
+    /** The size of the cells of the touch spatial index */
+    float _touchIndexCellSize;
+
+    /** The touch listeners with hit test by cell */
+    std::unordered_map<int64_t, std::vector<EventListenerTouchOneByOne*>> _touchIndexCells;
+
+    /** The touch listeners with hit test whose node covers too many cells */
+    std::vector<EventListenerTouchOneByOne*> _touchIndexOversized;
+
+    /** The touch scene graph listeners without hit test, they are tested for every touch */
+    std::vector<EventListener*> _touchIndexUnindexed;
+
+    /** Whether the scene graph touch listeners were sorted, added or removed since the last updateTouchIndex() */
+    bool _touchIndexListenersDirty;
+
+    /** The nodes of indexed listeners whose transform changed, they may be pushed by the parallel visit */
+    std::vector<Node*> _touchIndexDirtyNodes;
+    std::mutex _touchIndexMutex;
+
+    /** Whether a listener was unregistered since the last updateListeners(), which has nothing to clean up otherwise */
+    bool _hasUnregisteredListeners;
 };
 
 
@@ -25,6 +25,7 @@
 #include "base/CCEventListener.h"
 #include "base/CCConsole.h"
 #include "base/CCEventListenerCustom.h"
+#include "base/CCAllocationProfiler.h"
 
 NS_CC_BEGIN
 
@@ -39,6 +40,10 @@ EventListener::~EventListener()
 
 bool EventListener::init(Type t, const std::function<void(Event*)>& callback)
 {
+    if (callback)
+    {
+        CC_PROFILE_ALLOCATION("EventListener std::function", sizeof(callback));
+    }
     _onEvent = callback;
     _type = t;
     switch (_type) {
@@ -37,6 +37,13 @@ EventListenerTouchOneByOne::EventListenerTouchOneByOne()
 , onTouchEnded(nullptr)
 , onTouchCancelled(nullptr)
 , _needSwallow(false)
+, _isHitTestEnabled(false)
+, _sceneGraphOrder(0)
+, _cellMinX(0)
+, _cellMinY(0)
+, _cellMaxX(-1)
+, _cellMaxY(-1)
+, _isOversized(false)
 {
 }
 
@@ -106,6 +113,7 @@ EventListenerTouchOneByOne* EventListenerTouchOneByOne::clone()
 
         ret->_claimedTouches = _claimedTouches;
         ret->_needSwallow = _needSwallow;
+        ret->_isHitTestEnabled = _isHitTestEnabled;
     }
     else
     {
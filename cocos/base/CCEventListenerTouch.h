@@ -67,6 +67,21 @@ public:
      */
     bool isSwallowTouches();
 
+    /** Whether or not to only begin the touches inside the node of the listener.
+     * When enabled, onTouchBegan is only called for the touches inside the content size of the node, in world space,
+     * while the node and its ancestors are visible. The EventDispatcher can then skip the listener at once when its
+     * touch spatial index is enabled, see EventDispatcher::setTouchSpatialIndexEnabled().
+     * It must be set before the listener is added. Disabled by default.
+     *
+     * @param enabled True to hit test the touches against the node of the listener.
+     */
+    void setHitTestEnabled(bool enabled) { _isHitTestEnabled = enabled; }
+    /** Whether or not the touches are hit tested against the node of the listener.
+     *
+     * @return True if only the touches inside the node begin.
+     */
+    bool isHitTestEnabled() const { return _isHitTestEnabled; }
+
     /// Overrides
     virtual EventListenerTouchOneByOne* clone() override;
     virtual bool checkAvailable() override;
@@ -89,6 +104,12 @@ CC_CONSTRUCTOR_ACCESS:
 private:
     std::vector<Touch*> _claimedTouches;
     bool _needSwallow;
+    bool _isHitTestEnabled;
+
+    // the touch spatial index of EventDispatcher
+    int _sceneGraphOrder;   ///< the index of the listener in its sorted scene graph listeners
+    int _cellMinX, _cellMinY, _cellMaxX, _cellMaxY; ///< the cells of the node bounds, none if _cellMinX > _cellMaxX
+    bool _isOversized;      ///< the node covers too many cells, the listener is tested for every touch
 
     friend class EventDispatcher;
 };
@@ -0,0 +1,234 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "base/CCFileWatcher.h"
+
+#include "base/CCDirector.h"
+#include "base/CCScheduler.h"
+#include "base/CCEventDispatcher.h"
+#include "base/CCEventCustom.h"
+#include "platform/CCFileUtils.h"
+#include "renderer/CCTextureCache.h"
+#include "2d/CCSprite.h"
+#include "2d/CCSpriteFrameCache.h"
+#include "2d/CCFontAtlasCache.h"
+
+NS_CC_BEGIN
+
+const char* FileWatcher::EVENT_FILE_CHANGED = "file_watcher_file_changed";
+
+// the seconds a file must be left alone before it is reloaded, editors write a file in several steps
+static const float QUIET_TIME = 0.2f;
+
+static FileWatcher* s_sharedFileWatcher = nullptr;
+
+FileWatcher* FileWatcher::getInstance()
+{
+    if (s_sharedFileWatcher == nullptr)
+    {
+        s_sharedFileWatcher = new (std::nothrow) FileWatcher();
+    }
+    return s_sharedFileWatcher;
+}
+
+void FileWatcher::destroyInstance()
+{
+    delete s_sharedFileWatcher;
+    s_sharedFileWatcher = nullptr;
+}
+
+FileWatcher::FileWatcher()
+{
+}
+
+FileWatcher::~FileWatcher()
+{
+    removeAllDirectories();
+}
+
+bool FileWatcher::addDirectory(const std::string& directory)
+{
+#if CC_ENABLE_FILE_WATCHER
+    std::string path = directory;
+    if (!path.empty() && path.back() != '/')
+    {
+        path += '/';
+    }
+    if (_watches.find(path) != _watches.end())
+    {
+        return true;
+    }
+
+    Watch* watch = this->watch(path);
+    if (!watch)
+    {
+        CCLOG("FileWatcher: can't watch %s", path.c_str());
+        return false;
+    }
+
+    if (_watches.empty())
+    {
+        // quiet, the retained mode of the Director isn't woken for nothing
+        auto scheduler = Director::getInstance()->getScheduler();
+        scheduler->schedule(CC_CALLBACK_1(FileWatcher::update, this), this, 0.1f, false, "FileWatcher");
+        scheduler->setTargetQuiet(this, true);
+    }
+    _watches[path] = watch;
+    return true;
+#else
+    CCLOG("FileWatcher: nothing is watched, see CC_ENABLE_FILE_WATCHER");
+    return false;
+#endif
+}
+
+void FileWatcher::removeDirectory(const std::string& directory)
+{
+    std::string path = directory;
+    if (!path.empty() && path.back() != '/')
+    {
+        path += '/';
+    }
+    auto it = _watches.find(path);
+    if (it == _watches.end())
+    {
+        return;
+    }
+
+    unwatch(it->second);
+    _watches.erase(it);
+    if (_watches.empty())
+    {
+        removeAllDirectories();
+    }
+}
+
+void FileWatcher::removeAllDirectories()
+{
+    for (auto&& item : _watches)
+    {
+        unwatch(item.second);
+    }
+    _watches.clear();
+
+    if (Director::DirectorInstance)
+    {
+        auto scheduler = Director::DirectorInstance->getScheduler();
+        scheduler->unschedule("FileWatcher", this);
+        scheduler->setTargetQuiet(this, false);
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _changedFiles.clear();
+}
+
+void FileWatcher::onFileChanged(const std::string& fullPath)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _changedFiles.insert(fullPath);
+    _lastChange = std::chrono::steady_clock::now();
+}
+
+void FileWatcher::update(float dt)
+{
+    std::set<std::string> changedFiles;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_changedFiles.empty() || std::chrono::steady_clock::now() - _lastChange < std::chrono::duration<float>(QUIET_TIME))
+        {
+            return;
+        }
+        changedFiles.swap(_changedFiles);
+    }
+
+    auto fileUtils = FileUtils::getInstance();
+    for (auto&& path : changedFiles)
+    {
+        // the directories are reported along with their files, the files removed have nothing to reload
+        if (fileUtils->isFileExist(path))
+        {
+            CCLOG("FileWatcher: %s changed", path.c_str());
+            reloadFile(path);
+        }
+    }
+    // the callback is quiet, the reloads are drawn all the same
+    Director::getInstance()->requestRedraw();
+}
+
+void FileWatcher::reloadFile(const std::string& fullPath)
+{
+    auto director = Director::getInstance();
+
+    auto textureCache = director->getTextureCache();
+    if (textureCache->getTextureForKey(fullPath))
+    {
+        textureCache->reloadTexture(fullPath);
+    }
+
+    // the sprites copy the rect of their frame, they are set it again
+    Vector<SpriteFrame*> frames = SpriteFrameCache::getInstance()->reloadSpriteFramesFromFile(fullPath);
+    if (!frames.empty() && director->getRunningScene())
+    {
+        std::set<SpriteFrame*> frameSet(frames.begin(), frames.end());
+        refreshSprites(director->getRunningScene(), frameSet);
+    }
+
+    FontAtlasCache::reloadFontFile(fullPath);
+
+    EventCustom event(EVENT_FILE_CHANGED);
+    event.setUserData(const_cast<std::string*>(&fullPath));
+    director->getEventDispatcher()->dispatchEvent(&event);
+}
+
+void FileWatcher::refreshSprites(Node* node, const std::set<SpriteFrame*>& frames)
+{
+    auto sprite = dynamic_cast<Sprite*>(node);
+    if (sprite)
+    {
+        SpriteFrame* frame = sprite->getSpriteFrame();
+        if (frames.find(frame) != frames.end())
+        {
+            sprite->setSpriteFrame(frame);
+        }
+    }
+
+    for (auto&& child : node->getChildren())
+    {
+        refreshSprites(child, frames);
+    }
+}
+
+#if !CC_ENABLE_FILE_WATCHER || (CC_TARGET_PLATFORM != CC_PLATFORM_MAC && CC_TARGET_PLATFORM != CC_PLATFORM_WIN32)
+
+FileWatcher::Watch* FileWatcher::watch(const std::string& directory)
+{
+    return nullptr;
+}
+
+void FileWatcher::unwatch(Watch* watch)
+{
+}
+
+#endif
+
+NS_CC_END
@@ -0,0 +1,111 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CC_FILE_WATCHER_H__
+#define __CC_FILE_WATCHER_H__
+
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+#include "platform/CCPlatformMacros.h"
+#include "base/ccConfig.h"
+
+/**
+ * @addtogroup base
+ * @{
+ */
+NS_CC_BEGIN
+
+class Node;
+class SpriteFrame;
+
+/**
+ * @class FileWatcher
+ * @brief Watches directories for the files that change, to iterate on the content of the game without relaunching it.
+ *
+ * The changes are handled on the cocos thread once the files are quiet for a moment, an editor saving a file
+ * gives a single one. The engine reloads what the file backs in place, the other resources stay cached: the texture of
+ * TextureCache, the sprite frames of SpriteFrameCache with the sprites of the running scene showing them, and the font
+ * atlases of FontAtlasCache with their labels. Then EVENT_FILE_CHANGED is dispatched with the full path of the file as
+ * user data, a std::string, for the game to reload the rest, its scripts for instance.
+ *
+ * It needs CC_ENABLE_FILE_WATCHER, enabled in the debug builds of mac and win32.
+ * @since v3.11
+ * @js NA
+ * @lua NA
+ */
+class CC_DLL FileWatcher
+{
+public:
+    /** The custom event dispatched for each file that changed, after the engine reloaded it. */
+    static const char* EVENT_FILE_CHANGED;
+
+    static FileWatcher* getInstance();
+    static void destroyInstance();
+
+    /**
+     * Watches the files of a directory and of its subdirectories.
+     *
+     * @param directory The full path of the directory.
+     * @return false if the directory can't be watched, always without CC_ENABLE_FILE_WATCHER.
+     */
+    bool addDirectory(const std::string& directory);
+    void removeDirectory(const std::string& directory);
+    void removeAllDirectories();
+
+    /** Reloads what a file backs and dispatches EVENT_FILE_CHANGED, as when the file changes. */
+    void reloadFile(const std::string& fullPath);
+
+    /** Called by the platforms when a file of a watched directory changed, from any thread. */
+    void onFileChanged(const std::string& fullPath);
+
+    /** The platform part of a watched directory. */
+    struct Watch;
+
+protected:
+    FileWatcher();
+    ~FileWatcher();
+
+    void update(float dt);
+    void refreshSprites(Node* node, const std::set<SpriteFrame*>& frames);
+
+    // implemented by the platforms, null when the directory can't be watched
+    Watch* watch(const std::string& directory);
+    void unwatch(Watch* watch);
+
+    std::unordered_map<std::string, Watch*> _watches;
+
+    std::mutex _mutex;
+    std::set<std::string> _changedFiles;
+    std::chrono::steady_clock::time_point _lastChange;
+};
+
+NS_CC_END
+// end group
+/// @}
+#endif //__CC_FILE_WATCHER_H__
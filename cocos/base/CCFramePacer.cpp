@@ -0,0 +1,112 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "base/CCFramePacer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "base/ccMacros.h"
+
+NS_CC_BEGIN
+
+// the rounding error, in refresh periods, above which a delta time isn't snapped
+static const float SNAP_TOLERANCE = 0.25f;
+// longer delta times are hitches, there's nothing to smooth
+static const int MAX_SNAPPED_REFRESHES = 8;
+
+FramePacer::FramePacer()
+: _refreshRate(DEFAULT_REFRESH_RATE)
+, _refreshPeriod(1.0f / DEFAULT_REFRESH_RATE)
+, _smoothingEnabled(true)
+, _frameStart(Clock::now())
+, _rawDeltaTime(0)
+, _carry(0)
+{
+}
+
+void FramePacer::setRefreshRate(float refreshRate)
+{
+    CCASSERT(refreshRate > 0, "FramePacer: invalid refresh rate");
+    if (refreshRate <= 0 || refreshRate == _refreshRate)
+    {
+        return;
+    }
+    _refreshRate = refreshRate;
+    _refreshPeriod = 1.0f / refreshRate;
+    _carry = 0;
+}
+
+int FramePacer::getSwapInterval(float animationInterval) const
+{
+    return std::max(1, (int)std::lround(animationInterval * _refreshRate));
+}
+
+float FramePacer::getPacedInterval(float animationInterval) const
+{
+    return getSwapInterval(animationInterval) * _refreshPeriod;
+}
+
+void FramePacer::setSmoothingEnabled(bool enabled)
+{
+    _smoothingEnabled = enabled;
+    _carry = 0;
+}
+
+void FramePacer::reset(const Clock::time_point& now)
+{
+    _frameStart = now;
+    _rawDeltaTime = 0;
+    _carry = 0;
+}
+
+float FramePacer::nextDeltaTime(const Clock::time_point& now)
+{
+    _rawDeltaTime = std::max(0.0f, std::chrono::duration<float>(now - _frameStart).count());
+    _frameStart = now;
+
+    if (!_smoothingEnabled)
+    {
+        return _rawDeltaTime;
+    }
+
+    const float measured = _rawDeltaTime + _carry;
+    const float refreshes = std::max(1.0f, std::round(measured / _refreshPeriod));
+    const float snapped = refreshes * _refreshPeriod;
+    if (refreshes > MAX_SNAPPED_REFRESHES || std::fabs(measured - snapped) > SNAP_TOLERANCE * _refreshPeriod)
+    {
+        _carry = 0;
+        return _rawDeltaTime;
+    }
+    _carry = measured - snapped;
+    return snapped;
+}
+
+float FramePacer::getTimeSinceFrameStart() const
+{
+    return std::chrono::duration<float>(Clock::now() - _frameStart).count();
+}
+
+NS_CC_END
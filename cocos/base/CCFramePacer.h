@@ -0,0 +1,104 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CC_FRAME_PACER_H__
+#define __CC_FRAME_PACER_H__
+
+#include <chrono>
+
+#include "platform/CCPlatformMacros.h"
+
+/**
+ * @addtogroup base
+ * @{
+ */
+NS_CC_BEGIN
+
+/**
+ * @class FramePacer
+ * @brief Measures the delta time of the frames on a monotonic clock and keeps it steady.
+ * The frames are presented on the refreshes of the display, so a frame lasts a whole number of refresh periods,
+ * but the time measured when it starts jitters around it. With the smoothing the delta time is snapped to that number
+ * of periods and the rounding error is carried to the next frame, so the motion advances by the time the frame is
+ * actually displayed. A delta time too far from a whole number of periods, a hitch, is kept as measured.
+ * The platforms pace the main loop on the refresh rate, see getSwapInterval(), and update it when the display
+ * changes it (30, 60, 90 or 120 Hz).
+ * @js NA
+ */
+class CC_DLL FramePacer
+{
+public:
+    /** The monotonic clock of the frame times. */
+    typedef std::chrono::steady_clock Clock;
+
+    /** The refresh rate until the platform tells the one of the display. */
+    static const int DEFAULT_REFRESH_RATE = 60;
+
+    FramePacer();
+
+    /** Sets the refresh rate of the display, in Hz. */
+    void setRefreshRate(float refreshRate);
+    /** Gets the refresh rate of the display, in Hz. */
+    float getRefreshRate() const { return _refreshRate; }
+
+    /** Returns the number of refreshes a frame lasts for an animation interval, at least 1. */
+    int getSwapInterval(float animationInterval) const;
+
+    /** Returns the animation interval rounded to a whole number of refreshes, the time between two paced frames. */
+    float getPacedInterval(float animationInterval) const;
+
+    /** Enables the snapping of the delta time to the refresh periods, it's enabled by default. */
+    void setSmoothingEnabled(bool enabled);
+    bool isSmoothingEnabled() const { return _smoothingEnabled; }
+
+    /** Starts over from `now`: the next delta time is measured from it, with no error carried. */
+    void reset(const Clock::time_point& now);
+
+    /** Returns the delta time of the frame starting at `now`, in seconds, and starts the frame. */
+    float nextDeltaTime(const Clock::time_point& now);
+
+    /** Gets the start of the current frame. */
+    const Clock::time_point& getFrameStart() const { return _frameStart; }
+
+    /** Returns the seconds elapsed since the start of the current frame. */
+    float getTimeSinceFrameStart() const;
+
+    /** Gets the delta time of the current frame as measured, before the smoothing. */
+    float getRawDeltaTime() const { return _rawDeltaTime; }
+
+protected:
+    float _refreshRate;
+    float _refreshPeriod;
+    bool _smoothingEnabled;
+    Clock::time_point _frameStart;
+    float _rawDeltaTime;
+    // the measured time not given to the delta times yet, it may be negative
+    float _carry;
+};
+
+NS_CC_END
+// end group
+/// @}
+#endif //__CC_FRAME_PACER_H__
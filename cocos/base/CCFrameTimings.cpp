@@ -0,0 +1,93 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "base/CCFrameTimings.h"
+
+#include <algorithm>
+
+#include "base/ccMacros.h"
+
+NS_CC_BEGIN
+
+FrameTiming::FrameTiming()
+: frame(0)
+, update(0)
+, actions(0)
+, visit(0)
+, sort(-1)
+, batchFill(-1)
+, submit(-1)
+, swap(-1)
+, total(0)
+, gpu(-1)
+, drawnBatches(0)
+, drawnVertices(0)
+, issuedStateCalls(0)
+, skippedStateCalls(0)
+{
+}
+
+FrameTimings::FrameTimings(int capacity)
+: _next(0)
+, _count(0)
+{
+    setCapacity(capacity);
+}
+
+void FrameTimings::setCapacity(int capacity)
+{
+    _frames.assign(std::max(capacity, 1), FrameTiming());
+    clear();
+}
+
+const FrameTiming& FrameTimings::at(int index) const
+{
+    CCASSERT(index >= 0 && index < _count, "FrameTimings: invalid index");
+    int capacity = (int)_frames.size();
+    return _frames[(_next - 1 - index + capacity) % capacity];
+}
+
+void FrameTimings::push(const FrameTiming& timing)
+{
+    _frames[_next] = timing;
+    _next = (_next + 1) % (int)_frames.size();
+    _count = std::min(_count + 1, (int)_frames.size());
+}
+
+FrameTiming* FrameTimings::find(unsigned int frame)
+{
+    int capacity = (int)_frames.size();
+    for (int i = 0; i < _count; ++i)
+    {
+        auto& timing = _frames[(_next - 1 - i + capacity) % capacity];
+        if (timing.frame == frame)
+        {
+            return &timing;
+        }
+    }
+    return nullptr;
+}
+
+NS_CC_END
@@ -0,0 +1,136 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CC_FRAME_TIMINGS_H__
+#define __CC_FRAME_TIMINGS_H__
+
+#include <vector>
+#include <chrono>
+
+#include "platform/CCPlatformMacros.h"
+#include "platform/CCStdC.h"
+
+/**
+ * @addtogroup base
+ * @{
+ */
+NS_CC_BEGIN
+
+/**
+ * @struct FrameTiming
+ * @brief Where the time of one frame went, see Director::getFrameTimings().
+ * The times are in milliseconds. The renderer times of a frame drawn by the render thread arrive with the next frame,
+ * the GPU time a few frames later, they stay negative until then.
+ * @js NA
+ */
+struct CC_DLL FrameTiming
+{
+    /** The number of the frame, see Director::getTotalFrames(). */
+    unsigned int frame;
+
+    /** Scheduler::update(), the actions included. */
+    float update;
+    /** ActionManager::update(). */
+    float actions;
+    /** The visit of the scene graph, the notification node included. */
+    float visit;
+    /** The sort of the render queues. */
+    float sort;
+    /** The time of Renderer::render() that isn't spent sorting or submitting: filling the batches, state changes. */
+    float batchFill;
+    /** The draw calls of the batches and the custom, batch and primitive commands. */
+    float submit;
+    /** GLView::swapBuffers(). */
+    float swap;
+    /** The whole frame, from the start of an update to the start of the next one. */
+    float total;
+    /** The GPU time of the commands of Renderer::render(), from a timer query. */
+    float gpu;
+
+    /** The number of draw calls. */
+    ssize_t drawnBatches;
+    /** The number of vertices drawn. */
+    ssize_t drawnVertices;
+    /** The number of GL state calls made by the renderer, see Renderer::getIssuedStateCalls(). */
+    unsigned int issuedStateCalls;
+    /** The number of redundant GL state calls dropped by the GL state cache. */
+    unsigned int skippedStateCalls;
+
+    FrameTiming();
+};
+
+/**
+ * @class FrameTimings
+ * @brief The timings of the last frames, in a ring buffer.
+ * @js NA
+ */
+class CC_DLL FrameTimings
+{
+public:
+    /** The number of frames kept by default. */
+    static const int DEFAULT_CAPACITY = 120;
+
+    /** The clock of the CPU timings. */
+    typedef std::chrono::steady_clock Clock;
+
+    /** Returns the milliseconds elapsed since `start`. */
+    static float elapsed(const Clock::time_point& start)
+    {
+        return std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+    }
+
+    explicit FrameTimings(int capacity = DEFAULT_CAPACITY);
+
+    /** Changes the number of frames kept, it drops the frames kept so far. */
+    void setCapacity(int capacity);
+    /** Gets the number of frames kept. */
+    int getCapacity() const { return (int)_frames.size(); }
+
+    /** Gets the number of frames recorded, up to the capacity. */
+    int size() const { return _count; }
+
+    /** Gets a frame, 0 is the most recent one and size() - 1 the oldest one. */
+    const FrameTiming& at(int index) const;
+
+    /** Adds the timings of a frame, the oldest one is dropped when the buffer is full. */
+    void push(const FrameTiming& timing);
+
+    /** Returns the frame with the given number, or nullptr when it's not kept anymore. */
+    FrameTiming* find(unsigned int frame);
+
+    /** Drops all the frames. */
+    void clear() { _count = 0; _next = 0; }
+
+protected:
+    std::vector<FrameTiming> _frames;
+    // the slot of the next push()
+    int _next;
+    int _count;
+};
+
+NS_CC_END
+// end group
+/// @}
+#endif //__CC_FRAME_TIMINGS_H__
@@ -0,0 +1,311 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "base/CCJobSystem.h"
+
+#include <algorithm>
+
+#include "base/ccConfig.h"
+#include "base/CCTracer.h"
+
+NS_CC_BEGIN
+
+struct JobSystem::JobEntry
+{
+    Job job;
+    Counter* counter;
+};
+
+// the index of the worker running on this thread, -1 for the other threads
+static thread_local int s_workerIndex = -1;
+
+JobSystem* JobSystem::s_sharedJobSystem = nullptr;
+
+JobSystem* JobSystem::getInstance()
+{
+    if (s_sharedJobSystem == nullptr)
+    {
+        s_sharedJobSystem = new (std::nothrow) JobSystem();
+    }
+    return s_sharedJobSystem;
+}
+
+void JobSystem::destroyInstance()
+{
+    delete s_sharedJobSystem;
+    s_sharedJobSystem = nullptr;
+}
+
+JobSystem::JobSystem()
+: _queuedJobs(0)
+, _stop(false)
+{
+    // hardware_concurrency() may return 0 when it's unknown, the main thread takes one core
+    int cores = (int)std::thread::hardware_concurrency();
+    int workers = std::max(std::min(cores - 1, CC_JOB_SYSTEM_MAX_THREADS), 1);
+
+    for (int i = 0; i <= workers; ++i)
+    {
+        _queues.emplace_back(new WorkerQueue());
+    }
+    for (int i = 0; i < workers; ++i)
+    {
+        _workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _wakeCondition.notify_all();
+
+    for (auto& worker : _workers)
+    {
+        worker.join();
+    }
+
+    for (auto& queue : _queues)
+    {
+        for (auto entry : queue->jobs)
+        {
+            delete entry;
+        }
+    }
+}
+
+bool JobSystem::isWorkerThread() const
+{
+    return s_workerIndex >= 0;
+}
+
+void JobSystem::run(const Job& job, Counter* counter, Counter* dependency)
+{
+    JobEntry* entry = new (std::nothrow) JobEntry();
+    entry->job = job;
+    entry->counter = counter;
+    if (counter)
+    {
+        ++counter->_value;
+    }
+
+    if (dependency)
+    {
+        std::lock_guard<std::mutex> lock(dependency->_mutex);
+        if (dependency->_value.load() > 0)
+        {
+            // pushed by the job that finishes it
+            dependency->_waitingJobs.push_back(entry);
+            return;
+        }
+    }
+
+    push(entry);
+}
+
+void JobSystem::wait(Counter* counter)
+{
+    while (counter->_value.load() > 0)
+    {
+        JobEntry* entry = pop(s_workerIndex);
+        if (entry)
+        {
+            execute(entry);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _wakeCondition.wait(lock, [&]{ return _stop || counter->_value.load() == 0 || _queuedJobs.load() > 0; });
+        if (_stop)
+            return;
+    }
+
+    // the job that finished it may still be releasing its waiting jobs
+    std::lock_guard<std::mutex> lock(counter->_mutex);
+}
+
+void JobSystem::parallelFor(int begin, int end, const std::function<void(int)>& body, int grainSize)
+{
+    int count = end - begin;
+    if (count <= 0)
+        return;
+
+    if (grainSize <= 0)
+    {
+        grainSize = std::max(1, count / ((getWorkerCount() + 1) * 4));
+    }
+    int chunks = (count + grainSize - 1) / grainSize;
+
+    auto runChunk = [&](int chunk) {
+        int first = begin + chunk * grainSize;
+        int last = std::min(first + grainSize, end);
+        for (int i = first; i < last; ++i)
+        {
+            body(i);
+        }
+    };
+
+    if (_workers.empty() || chunks == 1)
+    {
+        runChunk(0);
+        for (int chunk = 1; chunk < chunks; ++chunk)
+        {
+            runChunk(chunk);
+        }
+        return;
+    }
+
+    Counter counter;
+    for (int chunk = 1; chunk < chunks; ++chunk)
+    {
+        run([&runChunk, chunk]{ runChunk(chunk); }, &counter);
+    }
+    runChunk(0);
+    wait(&counter);
+}
+
+void JobSystem::push(JobEntry* entry)
+{
+    int index = s_workerIndex >= 0 ? s_workerIndex : (int)_workers.size();
+    {
+        auto& queue = *_queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(entry);
+        ++_queuedJobs;
+    }
+    notify(false);
+}
+
+JobSystem::JobEntry* JobSystem::pop(int index)
+{
+    if (_queuedJobs.load() == 0)
+        return nullptr;
+
+    int queueCount = (int)_queues.size();
+    int shared = queueCount - 1;
+
+    // the newest job of its own queue, it's likely in the cache
+    if (index >= 0)
+    {
+        auto& queue = *_queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty())
+        {
+            auto entry = queue.jobs.back();
+            queue.jobs.pop_back();
+            --_queuedJobs;
+            return entry;
+        }
+    }
+
+    // then the oldest job of the other threads and of the other workers
+    for (int i = 0; i < queueCount; ++i)
+    {
+        int victim = (i == 0) ? shared : (std::max(index, 0) + i) % shared;
+        if (victim == index)
+            continue;
+
+        auto& queue = *_queues[victim];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty())
+        {
+            auto entry = queue.jobs.front();
+            queue.jobs.pop_front();
+            --_queuedJobs;
+            return entry;
+        }
+    }
+
+    return nullptr;
+}
+
+void JobSystem::execute(JobEntry* entry)
+{
+    entry->job();
+
+    auto counter = entry->counter;
+    delete entry;
+    if (counter == nullptr)
+        return;
+
+    std::vector<JobEntry*> waitingJobs;
+    bool done = false;
+    {
+        std::lock_guard<std::mutex> lock(counter->_mutex);
+        if (--counter->_value == 0)
+        {
+            done = true;
+            waitingJobs.swap(counter->_waitingJobs);
+        }
+    }
+
+    // the counter may be gone from here on
+    for (auto waitingJob : waitingJobs)
+    {
+        push(waitingJob);
+    }
+    if (done)
+    {
+        notify(true);
+    }
+}
+
+void JobSystem::notify(bool all)
+{
+    // the waiting threads check their condition under _mutex
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+    }
+    if (all)
+        _wakeCondition.notify_all();
+    else
+        _wakeCondition.notify_one();
+}
+
+void JobSystem::workerLoop(int index)
+{
+    Tracer::setThreadName("job");
+    s_workerIndex = index;
+
+    for (;;)
+    {
+        JobEntry* entry = pop(index);
+        if (entry)
+        {
+            CC_TRACE_ZONE("job", "JobSystem::execute");
+            execute(entry);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _wakeCondition.wait(lock, [this]{ return _stop || _queuedJobs.load() > 0; });
+        if (_stop)
+            return;
+    }
+}
+
+NS_CC_END
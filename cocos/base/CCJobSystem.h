@@ -0,0 +1,145 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CC_JOB_SYSTEM_H__
+#define __CC_JOB_SYSTEM_H__
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+#include "platform/CCPlatformMacros.h"
+
+/**
+ * @addtogroup base
+ * @{
+ */
+NS_CC_BEGIN
+
+/**
+ * @class JobSystem
+ * @brief Runs short CPU jobs on one thread per core, e.g. the WorkerPool batches of the parallel visit and of the particles.
+ * Each worker has its own deque: it runs the newest of its jobs first and steals the oldest ones of the others when it's idle.
+ * A job can count itself in a Counter and wait for another Counter to reach 0 before it starts,
+ * wait() runs jobs on the calling thread until its counter is done.
+ * The jobs must not block on IO, use AsyncTaskPool for that. The number of workers is bounded by CC_JOB_SYSTEM_MAX_THREADS.
+ * @js NA
+ */
+class CC_DLL JobSystem
+{
+public:
+    typedef std::function<void()> Job;
+
+    struct JobEntry;
+
+    /**
+     * The number of the unfinished jobs that were run with it.
+     * It must outlive these jobs and the jobs that depend on it, wait() makes sure it can be destroyed when it returns.
+     */
+    class CC_DLL Counter
+    {
+    public:
+        Counter() : _value(0) {}
+
+        /** Whether all the jobs counted by it are finished. */
+        bool isDone() const { return _value.load() == 0; }
+
+    private:
+        friend class JobSystem;
+
+        Counter(const Counter&) = delete;
+        Counter& operator=(const Counter&) = delete;
+
+        std::atomic<int> _value;
+        // the jobs waiting for it to reach 0, and the last decrement, are guarded by _mutex
+        std::mutex _mutex;
+        std::vector<JobEntry*> _waitingJobs;
+    };
+
+    /** Returns the shared job system, its workers are started on first use. */
+    static JobSystem* getInstance();
+
+    /** Stops the workers and destroys the shared job system, the jobs that didn't start are dropped. */
+    static void destroyInstance();
+
+    /**
+     * Runs `job` on a worker, it can be called from any thread and from the jobs.
+     * @param job The job.
+     * @param counter If not nullptr, it counts the job until it is finished.
+     * @param dependency If not nullptr, the job starts once it is done.
+     */
+    void run(const Job& job, Counter* counter = nullptr, Counter* dependency = nullptr);
+
+    /** Runs jobs on the calling thread until `counter` is done. It can be called from a job. */
+    void wait(Counter* counter);
+
+    /**
+     * Calls body(begin) ... body(end - 1) on the workers and the calling thread, returns when all of them are done.
+     * @param grainSize The number of indices a job calls body() for, 0 to split the range into a few jobs per thread.
+     */
+    void parallelFor(int begin, int end, const std::function<void(int)>& body, int grainSize = 0);
+
+    /** Returns the number of workers, the threads that call wait() help them. */
+    int getWorkerCount() const { return (int)_workers.size(); }
+
+    /** Whether the calling thread is one of the workers. */
+    bool isWorkerThread() const;
+
+protected:
+    JobSystem();
+    ~JobSystem();
+
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<JobEntry*> jobs;
+    };
+
+    void workerLoop(int index);
+    void push(JobEntry* entry);
+    JobEntry* pop(int index);
+    void execute(JobEntry* entry);
+    void notify(bool all);
+
+    static JobSystem* s_sharedJobSystem;
+
+    std::vector<std::thread> _workers;
+    // one queue per worker, then the one of the other threads
+    std::vector<std::unique_ptr<WorkerQueue>> _queues;
+    std::atomic<int> _queuedJobs;
+    std::mutex _mutex;
+    std::condition_variable _wakeCondition;
+    bool _stop;
+};
+
+NS_CC_END
+// end group
+/// @}
+#endif //__CC_JOB_SYSTEM_H__
@@ -0,0 +1,277 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "base/CCMemoryPressure.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+
+#include "base/CCDirector.h"
+#include "base/CCScheduler.h"
+#include "base/CCString.h"
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_IOS) || (CC_TARGET_PLATFORM == CC_PLATFORM_MAC)
+#include <mach/mach.h>
+#elif (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID) || (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
+#include <unistd.h>
+#endif
+
+NS_CC_BEGIN
+
+static double getSteadySeconds()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+MemoryPressure* MemoryPressure::getInstance()
+{
+    static MemoryPressure instance;
+    return &instance;
+}
+
+MemoryPressure::MemoryPressure()
+: _lastLevel(Level::NONE)
+, _lastTrimTime(0.0)
+, _trimCount(0)
+, _residentBudget(0)
+, _pollHandle(0)
+, _pollScheduler(nullptr)
+, _pendingLevel(Level::NONE)
+{
+}
+
+const char* MemoryPressure::getLevelName(Level level)
+{
+    switch (level)
+    {
+        case Level::LOW:
+            return "low";
+        case Level::MEDIUM:
+            return "medium";
+        case Level::CRITICAL:
+            return "critical";
+        default:
+            return "none";
+    }
+}
+
+void MemoryPressure::addHandler(const std::string& name, int priority, const Handler& handler)
+{
+    removeHandler(name);
+
+    Entry entry;
+    entry.info.name = name;
+    entry.info.priority = priority;
+    entry.info.calls = 0;
+    entry.info.lastFreedBytes = 0;
+    entry.info.totalFreedBytes = 0;
+    entry.handler = handler;
+
+    // after the handlers of the same priority, they run in the order they were added
+    auto it = std::upper_bound(_entries.begin(), _entries.end(), priority, [](int p, const Entry& e) {
+        return p < e.info.priority;
+    });
+    _entries.insert(it, entry);
+}
+
+void MemoryPressure::removeHandler(const std::string& name)
+{
+    _entries.erase(std::remove_if(_entries.begin(), _entries.end(), [&name](const Entry& e) {
+        return e.info.name == name;
+    }), _entries.end());
+}
+
+void MemoryPressure::signal(Level level)
+{
+    if (level == Level::NONE)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(_signalMutex);
+        const bool queued = _pendingLevel != Level::NONE;
+        if (level <= _pendingLevel)
+            return;
+        _pendingLevel = level;
+        // the queued function handles the highest level signaled until it runs
+        if (queued)
+            return;
+    }
+
+    Director::getInstance()->getScheduler()->performFunctionInCocosThread([this](){
+        Level pending;
+        {
+            std::lock_guard<std::mutex> lock(_signalMutex);
+            pending = _pendingLevel;
+            _pendingLevel = Level::NONE;
+        }
+
+        if (pending <= _lastLevel && getSteadySeconds() - _lastTrimTime < CC_MEMORY_PRESSURE_COOLDOWN)
+        {
+            CCLOG("MemoryPressure: %s level ignored, %s was handled %.1f s ago", getLevelName(pending),
+                  getLevelName(_lastLevel), getSteadySeconds() - _lastTrimTime);
+            return;
+        }
+        trim(pending);
+    });
+}
+
+void MemoryPressure::trim(Level level)
+{
+    if (level == Level::NONE)
+        return;
+
+    // only logged, getResidentBytes() isn't free
+#if COCOS2D_DEBUG > 0
+    const size_t residentBefore = getResidentBytes();
+    size_t totalFreed = 0;
+#endif
+
+    // a handler may add or remove handlers
+    std::vector<Entry> entries = _entries;
+    for (auto& entry : entries)
+    {
+        const size_t freed = entry.handler(level);
+#if COCOS2D_DEBUG > 0
+        totalFreed += freed;
+#endif
+
+        for (auto& current : _entries)
+        {
+            if (current.info.name == entry.info.name)
+            {
+                ++current.info.calls;
+                current.info.lastFreedBytes = freed;
+                current.info.totalFreedBytes += freed;
+                break;
+            }
+        }
+    }
+
+    _lastLevel = level;
+    _lastTrimTime = getSteadySeconds();
+    ++_trimCount;
+
+#if COCOS2D_DEBUG > 0
+    CCLOG("MemoryPressure: %s level handled, %.1f MB freed by the caches, resident %.1f MB -> %.1f MB",
+          getLevelName(level), totalFreed / (1024.0 * 1024.0), residentBefore / (1024.0 * 1024.0),
+          getResidentBytes() / (1024.0 * 1024.0));
+#endif
+}
+
+void MemoryPressure::setResidentBudget(size_t bytes, float interval)
+{
+    auto scheduler = Director::getInstance()->getScheduler();
+    if (_pollHandle != 0 && _pollScheduler == scheduler)
+    {
+        scheduler->unschedule(_pollHandle);
+    }
+    _pollHandle = 0;
+    _pollScheduler = nullptr;
+
+    _residentBudget = bytes;
+    if (bytes == 0)
+        return;
+
+    if (getResidentBytes() == 0)
+    {
+        CCLOG("MemoryPressure: the resident memory can't be polled on this platform");
+        return;
+    }
+
+    _pollHandle = scheduler->schedule([this](float) {
+        pollResidentMemory();
+    }, this, std::max(interval, 0.1f), CC_REPEAT_FOREVER, 0.0f, false);
+    _pollScheduler = scheduler;
+    // the polling doesn't change what is drawn
+    scheduler->setTargetQuiet(this, true);
+}
+
+void MemoryPressure::pollResidentMemory()
+{
+    const double ratio = (double)getResidentBytes() / _residentBudget;
+    if (ratio > 1.3)
+    {
+        signal(Level::CRITICAL);
+    }
+    else if (ratio > 1.15)
+    {
+        signal(Level::MEDIUM);
+    }
+    else if (ratio > 1.0)
+    {
+        signal(Level::LOW);
+    }
+}
+
+size_t MemoryPressure::getResidentBytes()
+{
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_IOS) || (CC_TARGET_PLATFORM == CC_PLATFORM_MAC)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) == KERN_SUCCESS)
+    {
+        return (size_t)info.resident_size;
+    }
+#elif (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID) || (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
+    FILE *file = fopen("/proc/self/statm", "r");
+    if (file)
+    {
+        long size = 0, resident = 0;
+        int read = fscanf(file, "%ld %ld", &size, &resident);
+        fclose(file);
+        if (read == 2)
+        {
+            return (size_t)resident * (size_t)sysconf(_SC_PAGESIZE);
+        }
+    }
+#endif
+    return 0;
+}
+
+std::vector<MemoryPressure::HandlerInfo> MemoryPressure::getHandlers() const
+{
+    std::vector<HandlerInfo> handlers;
+    for (const auto& entry : _entries)
+    {
+        handlers.push_back(entry.info);
+    }
+    return handlers;
+}
+
+std::string MemoryPressure::getReport() const
+{
+    std::string report = StringUtils::format("Memory pressure: last level %s, %u trims, resident %.1f MB, budget %.1f MB\n",
+                                             getLevelName(_lastLevel), _trimCount, getResidentBytes() / (1024.0 * 1024.0),
+                                             _residentBudget / (1024.0 * 1024.0));
+    report += StringUtils::format("%8s  %-24s %6s %12s %12s\n", "priority", "handler", "calls", "last KB", "total KB");
+    for (const auto& entry : _entries)
+    {
+        report += StringUtils::format("%8d  %-24s %6u %12zu %12zu\n", entry.info.priority, entry.info.name.c_str(),
+                                      entry.info.calls, entry.info.lastFreedBytes / 1024, entry.info.totalFreedBytes / 1024);
+    }
+    return report;
+}
+
+NS_CC_END
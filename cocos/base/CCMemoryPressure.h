@@ -0,0 +1,161 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CC_MEMORY_PRESSURE_H__
+#define __CC_MEMORY_PRESSURE_H__
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "platform/CCPlatformMacros.h"
+#include "base/CCRef.h"
+#include "base/CCScheduler.h"
+
+/**
+ * @addtogroup base
+ * @{
+ */
+NS_CC_BEGIN
+
+class Scheduler;
+
+/**
+ * @class MemoryPressure
+ * @brief Shrinks the caches of the engine and of the game by tiers when the system runs short of memory, instead of
+ * purging them all at once.
+ *
+ * Each cache registers a handler, which frees more at each level: the pools and the least recently used half of what
+ * nothing uses at LOW, everything unused at MEDIUM, and whatever can be reloaded at CRITICAL, which is what
+ * Director::purgeCachedData() does. The handlers run on the cocos thread by priority, the lowest first: the caches
+ * that retain others, like the sprite frames of the textures, go first.
+ *
+ * The levels come from the platforms: the memory warnings of iOS, which the AppController forwards with signal(),
+ * and onTrimMemory() and onLowMemory() on Android. An optional budget of the resident memory of the process is
+ * polled on the others too, see setResidentBudget(). See the "memory" command of the Console.
+ * @since v3.11
+ * @js NA
+ * @lua NA
+ */
+class CC_DLL MemoryPressure
+{
+public:
+    /** How much memory the handlers have to free. */
+    enum class Level
+    {
+        NONE,
+        LOW,        ///< the least recently used part of what isn't used, and the pools
+        MEDIUM,     ///< everything that isn't used
+        CRITICAL    ///< everything that can be reloaded or rebuilt, even if it's in use
+    };
+
+    /** Frees the memory of a cache for a level, returns the bytes freed, 0 when it can't tell. */
+    typedef std::function<size_t(Level level)> Handler;
+
+    /** What a handler did, for the report. */
+    struct HandlerInfo
+    {
+        std::string name;
+        int priority;
+        unsigned int calls;
+        size_t lastFreedBytes;
+        size_t totalFreedBytes;
+    };
+
+    static MemoryPressure* getInstance();
+
+    /**
+     * Registers the handler of a cache, a handler with the same name is replaced.
+     * @param name The name of the cache in the report.
+     * @param priority The handlers with a lower priority run first.
+     * @param handler The function that frees the memory.
+     */
+    void addHandler(const std::string& name, int priority, const Handler& handler);
+    /** Unregisters the handler of a cache. */
+    void removeHandler(const std::string& name);
+
+    /**
+     * Reports a shortage of memory, the handlers run in the next update of the cocos thread. Thread safe.
+     * A level that isn't higher than the one handled in the last CC_MEMORY_PRESSURE_COOLDOWN seconds is ignored,
+     * the platforms tend to repeat their warnings.
+     */
+    void signal(Level level);
+
+    /** Runs the handlers for a level right away, on the cocos thread. */
+    void trim(Level level);
+
+    /**
+     * Sets the bytes the process may keep resident, 0 disables the polling, the default.
+     * Every `interval` seconds, the resident memory is compared with the budget: LOW is signaled over it, MEDIUM over
+     * 115% of it and CRITICAL over 130%. For the platforms without warnings, or to act before them.
+     */
+    void setResidentBudget(size_t bytes, float interval = 1.0f);
+    /** Gets the budget of the resident memory, 0 when it isn't polled. */
+    size_t getResidentBudget() const { return _residentBudget; }
+
+    /** Gets the resident memory of the process, 0 on the platforms that can't tell. */
+    static size_t getResidentBytes();
+
+    /** Gets the last level handled. */
+    Level getLastLevel() const { return _lastLevel; }
+    /** Gets the handlers with what they freed, in the order they run. */
+    std::vector<HandlerInfo> getHandlers() const;
+    /** Returns the handlers, what they freed and the resident memory as text. */
+    std::string getReport() const;
+
+    static const char* getLevelName(Level level);
+
+protected:
+    struct Entry
+    {
+        HandlerInfo info;
+        Handler handler;
+    };
+
+    MemoryPressure();
+
+    void pollResidentMemory();
+
+    std::vector<Entry> _entries;
+    Level _lastLevel;
+    // when the last level was handled, in seconds since the epoch of the steady clock
+    double _lastTrimTime;
+    unsigned int _trimCount;
+
+    size_t _residentBudget;
+    ccSchedulerHandle _pollHandle;
+    // the scheduler of the handle, a new Director has another one
+    Scheduler* _pollScheduler;
+
+    // the level signaled for the next update, NONE when nothing is pending
+    std::mutex _signalMutex;
+    Level _pendingLevel;
+};
+
+NS_CC_END
+// end group
+/// @}
+#endif // __CC_MEMORY_PRESSURE_H__
@@ -47,6 +47,7 @@ class ProfilingTimer;
  cocos2d builtin profiler.
 
  To use it, enable set the CC_ENABLE_PROFILERS=1 in the ccConfig.h file
+ The timers are looked up by name and aren't thread safe, the engine records its zones with Tracer instead.
  */
 
 class CC_DLL Profiler : public Ref
@@ -26,6 +26,7 @@ THE SOFTWARE.
 #include "base/CCRef.h"
 #include "base/CCAutoreleasePool.h"
 #include "base/ccMacros.h"
+#include "base/CCAllocationProfiler.h"
 
 #if CC_REF_LEAK_DETECTION
 #include <algorithm>    // std::find
@@ -38,20 +39,93 @@ static void trackRef(Ref* ref);
 static void untrackRef(Ref* ref);
 #endif
 
+#if CC_ENABLE_SCRIPT_OBJECT_REMOVER
+static Ref::ScriptObjectRemover s_scriptObjectRemover = nullptr;
+
+void Ref::setScriptObjectRemover(ScriptObjectRemover remover)
+{
+    s_scriptObjectRemover = remover;
+}
+#endif
+
+#if CC_ENABLE_ALLOCATION_PROFILER
+// the size given to the last Ref::operator new of the thread, 0 for the Refs on the stack or in arrays
+static thread_local size_t s_allocatedSize = 0;
+
+void* Ref::operator new(size_t size)
+{
+#if CC_ENABLE_REF_ALLOCATOR
+    void* ptr = RefAllocator::allocate(size);
+#else
+    void* ptr = ::operator new(size);
+#endif
+    s_allocatedSize = size;
+    return ptr;
+}
+
+void* Ref::operator new(size_t size, const std::nothrow_t& nothrow) throw()
+{
+#if CC_ENABLE_REF_ALLOCATOR
+    void* ptr = RefAllocator::allocate(size, nothrow);
+#else
+    void* ptr = ::operator new(size, nothrow);
+#endif
+    s_allocatedSize = ptr ? size : 0;
+    return ptr;
+}
+
+void Ref::operator delete(void* ptr, size_t size)
+{
+#if CC_ENABLE_REF_ALLOCATOR
+    RefAllocator::deallocate(ptr, size);
+#else
+    ::operator delete(ptr);
+#endif
+}
+#endif // CC_ENABLE_ALLOCATION_PROFILER
+
 Ref::Ref()
 : _referenceCount(1) // when the Ref is created, the reference count of it is 1
+#if CC_ENABLE_SCRIPT_OBJECT_REMOVER
+, _scriptObject(nullptr)
+#endif
 {
 #if CC_REF_LEAK_DETECTION
     trackRef(this);
 #endif
+
+#if CC_ENABLE_ALLOCATION_PROFILER
+    if (s_allocatedSize != 0)
+    {
+        if (AllocationProfiler::isEnabled())
+        {
+            AllocationProfiler::getInstance()->trackRef(this, s_allocatedSize);
+        }
+        s_allocatedSize = 0;
+    }
+#endif
 }
 
 Ref::~Ref()
 {
+#if CC_ENABLE_SCRIPT_OBJECT_REMOVER
+    if (_scriptObject && s_scriptObjectRemover)
+    {
+        s_scriptObjectRemover(this);
+    }
+#endif
+
 #if CC_REF_LEAK_DETECTION
     if (_referenceCount != 0)
         untrackRef(this);
 #endif
+
+#if CC_ENABLE_ALLOCATION_PROFILER
+    if (AllocationProfiler::isEnabled())
+    {
+        AllocationProfiler::getInstance()->untrackRef(this);
+    }
+#endif
 }
 
 void Ref::retain()
@@ -28,6 +28,7 @@ THE SOFTWARE.
 
 #include "platform/CCPlatformMacros.h"
 #include "base/ccConfig.h"
+#include "base/CCRefAllocator.h"
 
 #define CC_REF_LEAK_DETECTION 0
 
@@ -114,6 +115,38 @@ public:
      */
     unsigned int getReferenceCount() const;
 
+#if CC_ENABLE_SCRIPT_OBJECT_REMOVER
+    /** The function called with each destroyed Ref that has a script object. */
+    typedef void (*ScriptObjectRemover)(Ref* ref);
+
+    /**
+     * Sets the function that drops the script proxy of a destroyed Ref.
+     *
+     * @param remover The remover, nullptr for none.
+     * @js NA
+     * @lua NA
+     */
+    static void setScriptObjectRemover(ScriptObjectRemover remover);
+
+    /**
+     * Sets the script object owning a proxy of the Ref. The remover is only called for Refs that have one.
+     *
+     * @param scriptObject The script object, nullptr for none.
+     * @js NA
+     * @lua NA
+     */
+    void setScriptObject(void* scriptObject) { _scriptObject = scriptObject; }
+
+    /**
+     * Gets the script object owning a proxy of the Ref.
+     *
+     * @return The script object, nullptr for none.
+     * @js NA
+     * @lua NA
+     */
+    void* getScriptObject() const { return _scriptObject; }
+#endif
+
 CC_CONSTRUCTOR_ACCESS:
     /**
      * Constructor
@@ -132,10 +165,35 @@ public:
      */
     virtual ~Ref();
 
+#if CC_ENABLE_ALLOCATION_PROFILER
+    /// @cond DO_NOT_SHOW
+    // the size is handed to the constructor, which records the Ref with AllocationProfiler
+    static void* operator new(size_t size);
+    static void* operator new(size_t size, const std::nothrow_t& nothrow) throw();
+    static void* operator new(size_t size, void* where) throw() { return where; }
+    static void operator delete(void* ptr, size_t size);
+    static void operator delete(void* ptr, void* where) throw() {}
+    /// @endcond
+#elif CC_ENABLE_REF_ALLOCATOR
+    /// @cond DO_NOT_SHOW
+    static void* operator new(size_t size) { return RefAllocator::allocate(size); }
+    static void* operator new(size_t size, const std::nothrow_t& nothrow) throw() { return RefAllocator::allocate(size, nothrow); }
+    static void* operator new(size_t size, void* where) throw() { return where; }
+    // the virtual destructor passes the size of the most derived class
+    static void operator delete(void* ptr, size_t size) { RefAllocator::deallocate(ptr, size); }
+    static void operator delete(void* ptr, void* where) throw() {}
+    /// @endcond
+#endif
+
 protected:
     /// count of references
     unsigned int _referenceCount;
 
+#if CC_ENABLE_SCRIPT_OBJECT_REMOVER
+    /// the script state owning a proxy of the Ref, set by the script binding
+    void* _scriptObject;
+#endif
+
     friend class AutoreleasePool;
 
     // Memory leak diagnostic data (only included when CC_REF_LEAK_DETECTION is defined and its value isn't zero)
@@ -0,0 +1,278 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "base/CCRefAllocator.h"
+
+#include <atomic>
+#include <mutex>
+
+NS_CC_BEGIN
+
+namespace
+{
+    struct FreeObject
+    {
+        FreeObject* next;
+    };
+
+    // the counters are only written by their thread, relaxed atomics let the other threads read them
+    void increment(std::atomic<unsigned int>& counter)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void decrement(std::atomic<unsigned int>& counter)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+    }
+
+    int getSizeClass(size_t size)
+    {
+        return size == 0 ? 0 : (int)((size - 1) / RefAllocator::SIZE_CLASS_STEP);
+    }
+}
+
+struct RefAllocator::ThreadCache
+{
+    FreeObject* freeLists[SIZE_CLASS_COUNT];
+    std::atomic<unsigned int> freeCounts[SIZE_CLASS_COUNT];
+    std::atomic<unsigned int> hits[SIZE_CLASS_COUNT];
+    std::atomic<unsigned int> misses[SIZE_CLASS_COUNT];
+
+    ThreadCache()
+    {
+        for (int i = 0; i < SIZE_CLASS_COUNT; ++i)
+        {
+            freeLists[i] = nullptr;
+            freeCounts[i].store(0, std::memory_order_relaxed);
+            hits[i].store(0, std::memory_order_relaxed);
+            misses[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void purge()
+    {
+        for (int i = 0; i < SIZE_CLASS_COUNT; ++i)
+        {
+            while (freeLists[i])
+            {
+                auto object = freeLists[i];
+                freeLists[i] = object->next;
+                ::operator delete(object);
+            }
+            freeCounts[i].store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+namespace
+{
+    // never destroyed, the threads that exit during the static destruction still unregister
+    struct Registry
+    {
+        std::mutex mutex;
+        std::vector<RefAllocator::ThreadCache*> caches;
+        // the counters of the threads that exited
+        unsigned int hits[RefAllocator::SIZE_CLASS_COUNT];
+        unsigned int misses[RefAllocator::SIZE_CLASS_COUNT];
+
+        Registry()
+        {
+            for (int i = 0; i < RefAllocator::SIZE_CLASS_COUNT; ++i)
+            {
+                hits[i] = 0;
+                misses[i] = 0;
+            }
+        }
+    };
+
+    Registry* getRegistry()
+    {
+        static Registry* s_registry = new Registry();
+        return s_registry;
+    }
+
+    thread_local RefAllocator::ThreadCache* t_cache = nullptr;
+    // set once the cache of the thread is destroyed, the Refs released after it are freed as usual
+    thread_local bool t_cacheDestroyed = false;
+
+    struct ThreadCacheOwner
+    {
+        ~ThreadCacheOwner()
+        {
+            auto cache = t_cache;
+            t_cache = nullptr;
+            t_cacheDestroyed = true;
+
+            auto registry = getRegistry();
+            {
+                std::lock_guard<std::mutex> lock(registry->mutex);
+                for (int i = 0; i < RefAllocator::SIZE_CLASS_COUNT; ++i)
+                {
+                    registry->hits[i] += cache->hits[i].load(std::memory_order_relaxed);
+                    registry->misses[i] += cache->misses[i].load(std::memory_order_relaxed);
+                }
+                for (auto it = registry->caches.begin(); it != registry->caches.end(); ++it)
+                {
+                    if (*it == cache)
+                    {
+                        registry->caches.erase(it);
+                        break;
+                    }
+                }
+            }
+            cache->purge();
+            delete cache;
+        }
+    };
+
+    RefAllocator::ThreadCache* getThreadCache()
+    {
+        if (t_cache == nullptr && !t_cacheDestroyed)
+        {
+            // constructed on the first use of the thread, destroyed when it exits
+            static thread_local ThreadCacheOwner s_owner;
+            (void)s_owner;
+
+            t_cache = new (std::nothrow) RefAllocator::ThreadCache();
+            if (t_cache)
+            {
+                auto registry = getRegistry();
+                std::lock_guard<std::mutex> lock(registry->mutex);
+                registry->caches.push_back(t_cache);
+            }
+        }
+        return t_cache;
+    }
+}
+
+void* RefAllocator::allocate(size_t size)
+{
+    if (size > CC_REF_ALLOCATOR_MAX_SIZE)
+    {
+        return ::operator new(size);
+    }
+
+    int sizeClass = getSizeClass(size);
+    auto cache = getThreadCache();
+    if (cache)
+    {
+        auto object = cache->freeLists[sizeClass];
+        if (object)
+        {
+            cache->freeLists[sizeClass] = object->next;
+            decrement(cache->freeCounts[sizeClass]);
+            increment(cache->hits[sizeClass]);
+            return object;
+        }
+        increment(cache->misses[sizeClass]);
+    }
+    // the whole size of the class, any object of the class can reuse it
+    return ::operator new((sizeClass + 1) * SIZE_CLASS_STEP);
+}
+
+void* RefAllocator::allocate(size_t size, const std::nothrow_t& nothrow)
+{
+    if (size > CC_REF_ALLOCATOR_MAX_SIZE)
+    {
+        return ::operator new(size, nothrow);
+    }
+
+    int sizeClass = getSizeClass(size);
+    auto cache = getThreadCache();
+    if (cache)
+    {
+        auto object = cache->freeLists[sizeClass];
+        if (object)
+        {
+            cache->freeLists[sizeClass] = object->next;
+            decrement(cache->freeCounts[sizeClass]);
+            increment(cache->hits[sizeClass]);
+            return object;
+        }
+        increment(cache->misses[sizeClass]);
+    }
+    return ::operator new((sizeClass + 1) * SIZE_CLASS_STEP, nothrow);
+}
+
+void RefAllocator::deallocate(void* ptr, size_t size)
+{
+    if (ptr == nullptr)
+    {
+        return;
+    }
+    // each object is allocated on its own, so it can go to the list of any thread or back to malloc
+    if (size <= CC_REF_ALLOCATOR_MAX_SIZE)
+    {
+        auto cache = getThreadCache();
+        int sizeClass = getSizeClass(size);
+        if (cache && cache->freeCounts[sizeClass].load(std::memory_order_relaxed) < CC_REF_ALLOCATOR_CAPACITY)
+        {
+            auto object = static_cast<FreeObject*>(ptr);
+            object->next = cache->freeLists[sizeClass];
+            cache->freeLists[sizeClass] = object;
+            increment(cache->freeCounts[sizeClass]);
+            return;
+        }
+    }
+    ::operator delete(ptr);
+}
+
+std::vector<RefAllocator::Stats> RefAllocator::getStats()
+{
+    std::vector<Stats> stats;
+    auto registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry->mutex);
+    for (int i = 0; i < SIZE_CLASS_COUNT; ++i)
+    {
+        Stats classStats;
+        classStats.objectSize = (i + 1) * SIZE_CLASS_STEP;
+        classStats.hits = registry->hits[i];
+        classStats.misses = registry->misses[i];
+        classStats.freeCount = 0;
+        for (auto cache : registry->caches)
+        {
+            classStats.hits += cache->hits[i].load(std::memory_order_relaxed);
+            classStats.misses += cache->misses[i].load(std::memory_order_relaxed);
+            classStats.freeCount += cache->freeCounts[i].load(std::memory_order_relaxed);
+        }
+        if (classStats.hits > 0 || classStats.misses > 0)
+        {
+            stats.push_back(classStats);
+        }
+    }
+    return stats;
+}
+
+void RefAllocator::purge()
+{
+    auto cache = getThreadCache();
+    if (cache)
+    {
+        cache->purge();
+    }
+}
+
+NS_CC_END
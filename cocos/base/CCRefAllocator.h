@@ -0,0 +1,93 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __BASE_CCREF_ALLOCATOR_H__
+#define __BASE_CCREF_ALLOCATOR_H__
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#include "platform/CCPlatformMacros.h"
+#include "base/ccConfig.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup base
+ * @{
+ */
+
+/** @class RefAllocator
+ @brief The allocator of the Refs when CC_ENABLE_REF_ALLOCATOR is enabled.
+ The objects are sorted in size classes of 16 bytes up to CC_REF_ALLOCATOR_MAX_SIZE. The memory of a released object
+ goes to the free list of its class on the releasing thread, the next allocation of the class on that thread takes it
+ instead of calling malloc. Up to CC_REF_ALLOCATOR_CAPACITY objects are kept per class and thread, a thread frees
+ its lists when it exits. The larger objects and the classes with their own operator new, like the pooled actions,
+ are allocated as usual.
+ @since v3.11
+ @js NA
+ @lua NA
+ */
+class CC_DLL RefAllocator
+{
+public:
+    /** The counters of one size class, summed over the threads. */
+    struct Stats
+    {
+        /** The size of the objects of the class, in bytes. */
+        size_t          objectSize;
+        /** The number of objects taken from the free lists. */
+        unsigned int    hits;
+        /** The number of objects allocated because the free list was empty. */
+        unsigned int    misses;
+        /** The number of objects in the free lists. */
+        unsigned int    freeCount;
+    };
+
+    /** Gets the counters of the size classes that allocated objects. */
+    static std::vector<Stats> getStats();
+
+    /** Frees the objects of the free lists of the calling thread, Director::purgeCachedData() calls it. */
+    static void purge();
+
+    /// @cond DO_NOT_SHOW
+    static void* allocate(size_t size);
+    static void* allocate(size_t size, const std::nothrow_t& nothrow);
+    static void deallocate(void* ptr, size_t size);
+
+    static const size_t SIZE_CLASS_STEP = 16;
+    static const int SIZE_CLASS_COUNT = (CC_REF_ALLOCATOR_MAX_SIZE + SIZE_CLASS_STEP - 1) / SIZE_CLASS_STEP;
+
+    struct ThreadCache;
+    /// @endcond
+};
+
+// end of base group
+/// @}
+
+NS_CC_END
+
+#endif // __BASE_CCREF_ALLOCATOR_H__
@@ -29,7 +29,9 @@
 
 #include "base/CCRef.h"
 #include "base/ccMacros.h"
+#include <new>
 #include <type_traits>
+#include <utility>
 
 NS_CC_BEGIN
 
@@ -299,6 +301,40 @@ template<class T, class U> RefPtr<T> dynamic_pointer_cast(const RefPtr<U> & r)
     return RefPtr<T>(dynamic_cast<T*>(r.get()));
 }
 
+/**
+ * Takes the reference of an object created by 'new', without retaining it again. The RefPtr<T> releases it when it
+ * goes away, the object never goes through the autorelease pool.
+ *
+ * E.G:
+ *      auto sprite = adoptRef(new (std::nothrow) Sprite());
+ *      sprite->initWithFile("star.png");
+ */
+template<class T> RefPtr<T> adoptRef(T * ptr)
+{
+    RefPtr<T> ref;
+    ref.weakAssign(ptr);
+    return ref;
+}
+
+/**
+ * Creates an object and calls its init(args...) like the create() of CREATE_FUNC, but returns it in a RefPtr<T>
+ * instead of autoreleasing it. The objects created by hot code this way don't fill the autorelease pool of the frame.
+ * Returns an empty RefPtr<T> if init() fails.
+ *
+ * E.G:
+ *      RefPtr<Node> node = makeRef<Node>();
+ */
+template<class T, class... Args> RefPtr<T> makeRef(Args&&... args)
+{
+    T * ptr = new (std::nothrow) T();
+    if (ptr && ptr->init(std::forward<Args>(args)...))
+    {
+        return adoptRef(ptr);
+    }
+    delete ptr;
+    return RefPtr<T>();
+}
+
 /**
  * Done with these macros.
  */
@@ -30,9 +30,41 @@ THE SOFTWARE.
 #include "base/CCDirector.h"
 #include "base/utlist.h"
 #include "base/ccCArray.h"
+#include "base/CCAllocationProfiler.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
 
 NS_CC_BEGIN
 
+// The timers wait in a hierarchical timing wheel: 256 slots of one tick, then 3 levels of 64 slots
+// that are cascaded into the lower ones when the ticks reach them, and a slot for the farther ones.
+static const double TIMER_TICKS_PER_SECOND = 256.0;
+static const int TIMER_LEVEL0_BITS = 8;
+static const int TIMER_LEVEL_BITS = 6;
+static const int TIMER_LEVELS = 4;
+static const int TIMER_SLOT_OVERFLOW = (1 << TIMER_LEVEL0_BITS) + (TIMER_LEVELS - 1) * (1 << TIMER_LEVEL_BITS);
+static const int TIMER_SLOT_CURRENT = TIMER_SLOT_OVERFLOW + 1;    // due within the tick already played
+static const int TIMER_SLOT_PENDING = TIMER_SLOT_OVERFLOW + 2;    // not started, they start at the end of the next update
+static const int TIMER_SLOT_PROCESSING = TIMER_SLOT_OVERFLOW + 3; // a slot being run or cascaded
+static const int TIMER_SLOT_COUNT = TIMER_SLOT_OVERFLOW + 4;
+
+// the generation of a handle slot wraps at 21 bits, the handles fit the 53 bits of a double
+static const uint32_t MAX_HANDLE_GENERATION = (1u << 21) - 1;
+static const int TIMER_NO_SLOT = -1;
+
+static int getTimerSlot(int level, uint64_t tick)
+{
+    if (level == 0)
+    {
+        return static_cast<int>(tick & ((1 << TIMER_LEVEL0_BITS) - 1));
+    }
+    auto index = (tick >> (TIMER_LEVEL0_BITS + (level - 1) * TIMER_LEVEL_BITS)) & ((1 << TIMER_LEVEL_BITS) - 1);
+    return (1 << TIMER_LEVEL0_BITS) + (level - 1) * (1 << TIMER_LEVEL_BITS) + static_cast<int>(index);
+}
+
 // data structures
 
 // A list double-linked list used for "updates with priority"
@@ -44,6 +76,7 @@ typedef struct _listEntry
     int                 priority;
     bool                paused;
     bool                markedForDeletion; // selector will no longer be called and entry will be removed at end of the next tick
+    float               missedTime;        // added to the dt of the next call, see resumeTarget()
 } tListEntry;
 
 typedef struct _hashUpdateEntry
@@ -78,6 +111,13 @@ Timer::Timer()
 , _repeat(0)
 , _delay(0.0f)
 , _interval(0.0f)
+, _deadline(0.0)
+, _wheelPrev(nullptr)
+, _wheelNext(nullptr)
+, _wheelSlot(TIMER_NO_SLOT)
+, _started(false)
+, _aborted(false)
+, _timerEntry(nullptr)
 {
 }
 
@@ -143,6 +183,53 @@ void Timer::update(float dt)
     }
 }
 
+void Timer::fire(double time)
+{
+    if (_useDelay)
+    {
+        trigger(_delay);
+        _timesExecuted += 1;
+        _useDelay = false;
+        // after delay, the next deadline is counted from the delay
+        if (!_runForever && _timesExecuted > _repeat)
+        {    //unschedule timer
+            cancel();
+            return;
+        }
+        if (_interval <= 0.f)
+        {
+            return;
+        }
+        _deadline += _interval;
+    }
+    else if (_interval <= 0.f)
+    {
+        // triggers once every frame, the deadline is the previous trigger
+        trigger(static_cast<float>(time - _deadline));
+        _timesExecuted += 1;
+        _deadline = time;
+        if (!_runForever && _timesExecuted > _repeat)
+        {
+            cancel();
+        }
+        return;
+    }
+
+    while (!_aborted && _deadline <= time)
+    {
+        trigger(_interval);
+        _timesExecuted += 1;
+
+        if (!_runForever && _timesExecuted > _repeat)
+        {
+            cancel();
+            break;
+        }
+
+        _deadline += _interval;
+    }
+}
+
 // TimerTargetSelector
 
 TimerTargetSelector::TimerTargetSelector()
@@ -178,6 +265,9 @@ void TimerTargetSelector::cancel()
 TimerTargetCallback::TimerTargetCallback()
 : _target(nullptr)
 , _callback(nullptr)
+, _intKey(0)
+, _hasIntKey(false)
+, _handle(0)
 {
 }
 
@@ -191,6 +281,17 @@ bool TimerTargetCallback::initWithCallback(Scheduler* scheduler, const ccSchedul
     return true;
 }
 
+bool TimerTargetCallback::initWithCallback(Scheduler* scheduler, const ccSchedulerFunc& callback, void *target, int key, float seconds, unsigned int repeat, float delay)
+{
+    _scheduler = scheduler;
+    _target = target;
+    _callback = callback;
+    _intKey = key;
+    _hasIntKey = true;
+    setupTimerWithInterval(seconds, repeat, delay);
+    return true;
+}
+
 void TimerTargetCallback::trigger(float dt)
 {
     if (_callback)
@@ -201,7 +302,18 @@ void TimerTargetCallback::trigger(float dt)
 
 void TimerTargetCallback::cancel()
 {
-    _scheduler->unschedule(_key, _target);
+    if (_handle != 0)
+    {
+        _scheduler->unschedule(_handle);
+    }
+    else if (_hasIntKey)
+    {
+        _scheduler->unschedule(_intKey, _target);
+    }
+    else
+    {
+        _scheduler->unschedule(_key, _target);
+    }
 }
 
 // implementation of Scheduler
@@ -214,6 +326,10 @@ const int Scheduler::PRIORITY_NON_SYSTEM_MIN = PRIORITY_SYSTEM + 1;
 
 Scheduler::Scheduler()
 : _timeScale(1.0f)
+, _fixedTimeStep(0.0f)
+, _maxFixedSteps(CC_SCHEDULER_MAX_FIXED_STEPS)
+, _fixedAccumulator(0.0)
+, _fixedStepCount(0)
 , _updatesNegList(nullptr)
 , _updates0List(nullptr)
 , _updatesPosList(nullptr)
@@ -222,7 +338,18 @@ Scheduler::Scheduler()
 , _currentTarget(nullptr)
 , _currentTargetSalvaged(false)
 , _updateHashLocked(false)
+, _timerSlotHeads(TIMER_SLOT_COUNT, nullptr)
+, _timerSlotTails(TIMER_SLOT_COUNT, nullptr)
+, _timerTime(0.0)
+, _timerTick(0)
+, _deferredTaskOrder(0)
+, _deferredTaskBudget(CC_SCHEDULER_DEFERRED_TASK_BUDGET / 1000.0f)
+, _callbackCount(0)
 {
+    _deferredTaskStats.executed = 0;
+    _deferredTaskStats.pending = 0;
+    _deferredTaskStats.time = 0.0f;
+
     // I don't expect to have more than 30 functions to all per frame
     _functionsToPerform.reserve(30);
 }
@@ -234,6 +361,10 @@ Scheduler::~Scheduler()
 
 void Scheduler::removeHashElement(_hashSelectorEntry *element)
 {
+    for (int i = 0; i < element->timers->num; ++i)
+    {
+        removeTimer(static_cast<Timer*>(element->timers->arr[i]));
+    }
     ccArrayFree(element->timers);
     HASH_DEL(_hashForTimers, element);
     free(element);
@@ -249,6 +380,85 @@ void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float in
     CCASSERT(target, "Argument target must be non-nullptr");
     CCASSERT(!key.empty(), "key should not be empty!");
 
+    tHashTimerEntry *element = getTimerEntry(target, paused);
+    for (int i = 0; i < element->timers->num; ++i)
+    {
+        TimerTargetCallback *timer = dynamic_cast<TimerTargetCallback*>(element->timers->arr[i]);
+
+        if (timer && key == timer->getKey())
+        {
+            CCLOG("CCScheduler#scheduleSelector. Selector already scheduled. Updating interval from: %.4f to %.4f", timer->getInterval(), interval);
+            setTimerInterval(timer, interval);
+            return;
+        }
+    }
+
+    TimerTargetCallback *timer = new (std::nothrow) TimerTargetCallback();
+    CC_PROFILE_ALLOCATION("Scheduler::schedule std::function", sizeof(ccSchedulerFunc));
+    timer->initWithCallback(this, callback, target, key, interval, repeat, delay);
+    addCallbackTimer(element, timer);
+}
+
+void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float interval, unsigned int repeat, float delay, bool paused, int key)
+{
+    CCASSERT(target, "Argument target must be non-nullptr");
+
+    tHashTimerEntry *element = getTimerEntry(target, paused);
+    for (int i = 0; i < element->timers->num; ++i)
+    {
+        TimerTargetCallback *timer = dynamic_cast<TimerTargetCallback*>(element->timers->arr[i]);
+
+        if (timer && timer->hasIntKey() && key == timer->getIntKey())
+        {
+            CCLOG("CCScheduler#scheduleSelector. Selector already scheduled. Updating interval from: %.4f to %.4f", timer->getInterval(), interval);
+            setTimerInterval(timer, interval);
+            return;
+        }
+    }
+
+    TimerTargetCallback *timer = new (std::nothrow) TimerTargetCallback();
+    CC_PROFILE_ALLOCATION("Scheduler::schedule std::function", sizeof(ccSchedulerFunc));
+    timer->initWithCallback(this, callback, target, key, interval, repeat, delay);
+    addCallbackTimer(element, timer);
+}
+
+ccSchedulerHandle Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float interval, unsigned int repeat, float delay, bool paused)
+{
+    CCASSERT(target, "Argument target must be non-nullptr");
+
+    tHashTimerEntry *element = getTimerEntry(target, paused);
+
+    TimerTargetCallback *timer = new (std::nothrow) TimerTargetCallback();
+    CC_PROFILE_ALLOCATION("Scheduler::schedule std::function", sizeof(ccSchedulerFunc));
+    timer->initWithCallback(this, callback, target, std::string(), interval, repeat, delay);
+
+    uint32_t slot;
+    if (_freeHandleSlots.empty())
+    {
+        slot = (uint32_t)_handleTimers.size();
+        _handleTimers.push_back(nullptr);
+        _handleGenerations.push_back(1);
+    }
+    else
+    {
+        slot = _freeHandleSlots.back();
+        _freeHandleSlots.pop_back();
+    }
+    _handleTimers[slot] = timer;
+    timer->_handle = ((ccSchedulerHandle)_handleGenerations[slot] << 32) | slot;
+
+    const ccSchedulerHandle handle = timer->_handle;
+    addCallbackTimer(element, timer);
+    return handle;
+}
+
+ccSchedulerHandle Scheduler::scheduleOnce(const ccSchedulerFunc& callback, void *target, float delay, bool paused)
+{
+    return schedule(callback, target, 0, 0, delay, paused);
+}
+
+tHashTimerEntry* Scheduler::getTimerEntry(void *target, bool paused)
+{
     tHashTimerEntry *element = nullptr;
     HASH_FIND_PTR(_hashForTimers, &target, element);
 
@@ -273,26 +483,49 @@ void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float in
     }
     else
     {
-        for (int i = 0; i < element->timers->num; ++i)
-        {
-            TimerTargetCallback *timer = dynamic_cast<TimerTargetCallback*>(element->timers->arr[i]);
-
-            if (timer && key == timer->getKey())
-            {
-                CCLOG("CCScheduler#scheduleSelector. Selector already scheduled. Updating interval from: %.4f to %.4f", timer->getInterval(), interval);
-                timer->setInterval(interval);
-                return;
-            }
-        }
         ccArrayEnsureExtraCapacity(element->timers, 1);
     }
+    return element;
+}
 
-    TimerTargetCallback *timer = new (std::nothrow) TimerTargetCallback();
-    timer->initWithCallback(this, callback, target, key, interval, repeat, delay);
+void Scheduler::addCallbackTimer(tHashTimerEntry *element, TimerTargetCallback *timer)
+{
     ccArrayAppendObject(element->timers, timer);
+    addTimer(element, timer);
     timer->release();
 }
 
+void Scheduler::unscheduleTimer(tHashTimerEntry *element, int index)
+{
+    Timer *timer = static_cast<Timer*>(element->timers->arr[index]);
+    if (timer == element->currentTimer && (! element->currentTimerSalvaged))
+    {
+        element->currentTimer->retain();
+        element->currentTimerSalvaged = true;
+    }
+
+    removeTimer(timer);
+    ccArrayRemoveObjectAtIndex(element->timers, index, true);
+
+    // update timerIndex in case we are in tick:, looping over the actions
+    if (element->timerIndex >= index)
+    {
+        element->timerIndex--;
+    }
+
+    if (element->timers->num == 0)
+    {
+        if (_currentTarget == element)
+        {
+            _currentTargetSalvaged = true;
+        }
+        else
+        {
+            removeHashElement(element);
+        }
+    }
+}
+
 void Scheduler::unschedule(const std::string &key, void *target)
 {
     // explicit handle nil arguments when removing an object
@@ -301,9 +534,6 @@ void Scheduler::unschedule(const std::string &key, void *target)
         return;
     }
 
-    //CCASSERT(target);
-    //CCASSERT(selector);
-
     tHashTimerEntry *element = nullptr;
     HASH_FIND_PTR(_hashForTimers, &target, element);
 
@@ -315,38 +545,53 @@ void Scheduler::unschedule(const std::string &key, void *target)
 
             if (timer && key == timer->getKey())
             {
-                if (timer == element->currentTimer && (! element->currentTimerSalvaged))
-                {
-                    element->currentTimer->retain();
-                    element->currentTimerSalvaged = true;
-                }
+                unscheduleTimer(element, i);
+                return;
+            }
+        }
+    }
+}
 
-                ccArrayRemoveObjectAtIndex(element->timers, i, true);
+void Scheduler::unschedule(int key, void *target)
+{
+    if (target == nullptr)
+    {
+        return;
+    }
 
-                // update timerIndex in case we are in tick:, looping over the actions
-                if (element->timerIndex >= i)
-                {
-                    element->timerIndex--;
-                }
+    tHashTimerEntry *element = nullptr;
+    HASH_FIND_PTR(_hashForTimers, &target, element);
 
-                if (element->timers->num == 0)
-                {
-                    if (_currentTarget == element)
-                    {
-                        _currentTargetSalvaged = true;
-                    }
-                    else
-                    {
-                        removeHashElement(element);
-                    }
-                }
+    if (element)
+    {
+        for (int i = 0; i < element->timers->num; ++i)
+        {
+            TimerTargetCallback *timer = dynamic_cast<TimerTargetCallback*>(element->timers->arr[i]);
 
+            if (timer && timer->hasIntKey() && key == timer->getIntKey())
+            {
+                unscheduleTimer(element, i);
                 return;
             }
         }
     }
 }
 
+void Scheduler::unschedule(ccSchedulerHandle handle)
+{
+    if (! isScheduled(handle))
+    {
+        return;
+    }
+
+    TimerTargetCallback *timer = _handleTimers[(uint32_t)handle];
+    tHashTimerEntry *element = timer->_timerEntry;
+    // the timers of a target are few, finding the pointer is what's left of the cancel
+    const ssize_t index = ccArrayGetIndexOfObject(element->timers, timer);
+    CCASSERT(index != CC_INVALID_INDEX, "The timer of a handle must be in the timers of its target");
+    unscheduleTimer(element, (int)index);
+}
+
 void Scheduler::priorityIn(tListEntry **list, const ccSchedulerFunc& callback, void *target, int priority, bool paused)
 {
     tListEntry *listElement = new (std::nothrow) tListEntry();
@@ -357,6 +602,7 @@ void Scheduler::priorityIn(tListEntry **list, const ccSchedulerFunc& callback, v
     listElement->paused = paused;
     listElement->next = listElement->prev = nullptr;
     listElement->markedForDeletion = false;
+    listElement->missedTime = 0;
 
     // empty list ?
     if (! *list)
@@ -413,6 +659,7 @@ void Scheduler::appendIn(_listEntry **list, const ccSchedulerFunc& callback, voi
     listElement->paused = paused;
     listElement->priority = 0;
     listElement->markedForDeletion = false;
+    listElement->missedTime = 0;
 
     DL_APPEND(*list, listElement);
 
@@ -454,6 +701,8 @@ void Scheduler::schedulePerFrame(const ccSchedulerFunc& callback, void *target,
         }
     }
 
+    CC_PROFILE_ALLOCATION("Scheduler::schedulePerFrame std::function", sizeof(ccSchedulerFunc));
+
     // most of the updates are going to be 0, that's way there
     // is an special list for updates with priority 0
     if (priority == 0)
@@ -471,6 +720,37 @@ void Scheduler::schedulePerFrame(const ccSchedulerFunc& callback, void *target,
     }
 }
 
+bool Scheduler::isScheduled(int key, void *target)
+{
+    CCASSERT(target, "Argument target must be non-nullptr");
+
+    tHashTimerEntry *element = nullptr;
+    HASH_FIND_PTR(_hashForTimers, &target, element);
+
+    if (!element || element->timers == nullptr)
+    {
+        return false;
+    }
+
+    for (int i = 0; i < element->timers->num; ++i)
+    {
+        TimerTargetCallback *timer = dynamic_cast<TimerTargetCallback*>(element->timers->arr[i]);
+
+        if (timer && timer->hasIntKey() && key == timer->getIntKey())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Scheduler::isScheduled(ccSchedulerHandle handle) const
+{
+    const uint32_t slot = (uint32_t)handle;
+    return handle != 0 && slot < _handleTimers.size() && _handleTimers[slot] != nullptr
+        && _handleGenerations[slot] == (uint32_t)(handle >> 32);
+}
+
 bool Scheduler::isScheduled(const std::string& key, void *target)
 {
     CCASSERT(!key.empty(), "Argument key must not be empty");
@@ -594,6 +874,18 @@ void Scheduler::unscheduleAllWithMinPriority(int minPriority)
     }
 }
 
+void Scheduler::setTargetQuiet(void *target, bool quiet)
+{
+    if (quiet)
+    {
+        _quietTargets.insert(target);
+    }
+    else
+    {
+        _quietTargets.erase(target);
+    }
+}
+
 void Scheduler::unscheduleAllForTarget(void *target)
 {
     // explicit nullptr handling
@@ -614,6 +906,10 @@ void Scheduler::unscheduleAllForTarget(void *target)
             element->currentTimer->retain();
             element->currentTimerSalvaged = true;
         }
+        for (int i = 0; i < element->timers->num; ++i)
+        {
+            removeTimer(static_cast<Timer*>(element->timers->arr[i]));
+        }
         ccArrayRemoveAllObjects(element->timers);
 
         if (_currentTarget == element)
@@ -631,6 +927,11 @@ void Scheduler::unscheduleAllForTarget(void *target)
 }
 
 void Scheduler::resumeTarget(void *target)
+{
+    resumeTarget(target, 0);
+}
+
+void Scheduler::resumeTarget(void *target, float missedTime)
 {
     CCASSERT(target != nullptr, "target can't be nullptr!");
 
@@ -639,7 +940,7 @@ void Scheduler::resumeTarget(void *target)
     HASH_FIND_PTR(_hashForTimers, &target, element);
     if (element)
     {
-        element->paused = false;
+        resumeTimers(element, missedTime);
     }
 
     // update selector
@@ -648,6 +949,10 @@ void Scheduler::resumeTarget(void *target)
     if (elementUpdate)
     {
         CCASSERT(elementUpdate->entry != nullptr, "elementUpdate's entry can't be nullptr!");
+        if (elementUpdate->entry->paused)
+        {
+            elementUpdate->entry->missedTime += missedTime;
+        }
         elementUpdate->entry->paused = false;
     }
 }
@@ -661,7 +966,7 @@ void Scheduler::pauseTarget(void *target)
     HASH_FIND_PTR(_hashForTimers, &target, element);
     if (element)
     {
-        element->paused = true;
+        pauseTimers(element);
     }
 
     // update selector
@@ -710,7 +1015,7 @@ std::set<void*> Scheduler::pauseAllTargetsWithMinPriority(int minPriority)
     for(tHashTimerEntry *element = _hashForTimers; element != nullptr;
         element = (tHashTimerEntry*)element->hh.next)
     {
-        element->paused = true;
+        pauseTimers(element);
         idsWithSelectors.insert(element->target);
     }
 
@@ -758,6 +1063,8 @@ void Scheduler::resumeTargets(const std::set<void*>& targetsToResume)
 
 void Scheduler::performFunctionInCocosThread(const std::function<void ()> &function)
 {
+    CC_PROFILE_ALLOCATION("Scheduler::performFunctionInCocosThread std::function", sizeof(function));
+
     _performMutex.lock();
 
     _functionsToPerform.push_back(function);
@@ -765,16 +1072,175 @@ void Scheduler::performFunctionInCocosThread(const std::function<void ()> &funct
     _performMutex.unlock();
 }
 
+void Scheduler::performDeferredTask(const std::function<void ()> &task, int priority)
+{
+    std::lock_guard<std::mutex> lock(_performMutex);
+
+    DeferredTask deferredTask;
+    deferredTask.priority = priority;
+    deferredTask.order = _deferredTaskOrder++;
+    deferredTask.task = task;
+    _deferredTasksToQueue.push_back(std::move(deferredTask));
+}
+
+void Scheduler::runDeferredTasks()
+{
+    // the top of the heap is the highest priority, then the first queued
+    auto compareDeferredTasks = [](const DeferredTask& a, const DeferredTask& b) {
+        if (a.priority != b.priority)
+        {
+            return a.priority < b.priority;
+        }
+        // the order wraps around after 2^32 tasks, compare the distance
+        return static_cast<int>(a.order - b.order) > 0;
+    };
+
+    _deferredTaskStats.executed = 0;
+    _deferredTaskStats.time = 0.0f;
+
+    if (!_deferredTasksToQueue.empty())
+    {
+        std::lock_guard<std::mutex> lock(_performMutex);
+        for (auto& deferredTask : _deferredTasksToQueue)
+        {
+            _deferredTasks.push_back(std::move(deferredTask));
+            std::push_heap(_deferredTasks.begin(), _deferredTasks.end(), compareDeferredTasks);
+        }
+        _deferredTasksToQueue.clear();
+    }
+
+    if (!_deferredTasks.empty())
+    {
+        auto start = std::chrono::steady_clock::now();
+        float elapsed = 0.0f;
+        do
+        {
+            std::pop_heap(_deferredTasks.begin(), _deferredTasks.end(), compareDeferredTasks);
+            auto task = std::move(_deferredTasks.back().task);
+            _deferredTasks.pop_back();
+
+            // the tasks it queues wait for the next update
+            task();
+            _deferredTaskStats.executed++;
+
+            elapsed = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+        } while (!_deferredTasks.empty() && (_deferredTaskBudget <= 0.0f || elapsed < _deferredTaskBudget));
+
+        _deferredTaskStats.time = elapsed * 1000.0f;
+    }
+
+    _deferredTaskStats.pending = static_cast<unsigned int>(_deferredTasks.size());
+}
+
+void Scheduler::setFixedTimeStep(float seconds)
+{
+    _fixedTimeStep = std::max(seconds, 0.0f);
+    _fixedAccumulator = 0.0;
+    _fixedStepCount = 0;
+}
+
+float Scheduler::getTimeToNextCallback()
+{
+    for (auto list : { _updatesNegList, _updates0List, _updatesPosList })
+    {
+        tListEntry *entry;
+        DL_FOREACH(list, entry)
+        {
+            if (!entry->paused && !entry->markedForDeletion && entry->priority != PRIORITY_SYSTEM)
+            {
+                return 0;
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_performMutex);
+        if (!_functionsToPerform.empty() || !_deferredTasksToQueue.empty())
+        {
+            return 0;
+        }
+    }
+    // the timers scheduled since the last update start with the next one
+    if (!_deferredTasks.empty() || _timerSlotHeads[TIMER_SLOT_PENDING])
+    {
+        return 0;
+    }
+
+    double deadline = DBL_MAX;
+    for (int slot = 0; slot < TIMER_SLOT_COUNT; ++slot)
+    {
+        for (Timer* timer = _timerSlotHeads[slot]; timer; timer = timer->_wheelNext)
+        {
+            deadline = std::min(deadline, timer->_deadline);
+        }
+    }
+    if (deadline == DBL_MAX || _timeScale <= 0)
+    {
+        return FLT_MAX;
+    }
+    return (float)std::max((deadline - _timerTime) / _timeScale, 0.0);
+}
+
 // main loop
 void Scheduler::update(float dt)
 {
-    _updateHashLocked = true;
-
     if (_timeScale != 1.0f)
     {
         dt *= _timeScale;
     }
 
+    if (_fixedTimeStep > 0)
+    {
+        _fixedAccumulator += dt;
+        unsigned int steps = 0;
+        while (_fixedTimeStep > 0 && _fixedAccumulator >= _fixedTimeStep && steps < _maxFixedSteps)
+        {
+            tick(_fixedTimeStep);
+            _fixedAccumulator -= _fixedTimeStep;
+            _fixedStepCount++;
+            steps++;
+        }
+        // too far behind, the game slows down instead of running more steps every frame
+        if (_fixedTimeStep > 0 && _fixedAccumulator >= _fixedTimeStep)
+        {
+            _fixedAccumulator = std::fmod(_fixedAccumulator, (double)_fixedTimeStep);
+        }
+    }
+    else
+    {
+        tick(dt);
+    }
+
+    //
+    // Functions allocated from another thread
+    //
+
+    // Testing size is faster than locking / unlocking.
+    // And almost never there will be functions scheduled to be called.
+    if( !_functionsToPerform.empty() ) {
+        _performMutex.lock();
+        // fixed #4123: Save the callback functions, they must be invoked after '_performMutex.unlock()', otherwise if new functions are added in callback, it will cause thread deadlock.
+        auto temp = _functionsToPerform;
+        _functionsToPerform.clear();
+        _performMutex.unlock();
+        for( const auto &function : temp ) {
+            function();
+        }
+        _callbackCount++;
+
+    }
+
+    runDeferredTasks();
+    if (_deferredTaskStats.executed > 0)
+    {
+        _callbackCount++;
+    }
+}
+
+void Scheduler::tick(float dt)
+{
+    _updateHashLocked = true;
+
     //
     // Selector callbacks
     //
@@ -787,7 +1253,10 @@ void Scheduler::update(float dt)
     {
         if ((! entry->paused) && (! entry->markedForDeletion))
         {
-            entry->callback(dt);
+            countCallback(entry->target, entry->priority);
+            float missedTime = entry->missedTime;
+            entry->missedTime = 0;
+            entry->callback(dt + missedTime);
         }
     }
 
@@ -796,7 +1265,10 @@ void Scheduler::update(float dt)
     {
         if ((! entry->paused) && (! entry->markedForDeletion))
         {
-            entry->callback(dt);
+            countCallback(entry->target, entry->priority);
+            float missedTime = entry->missedTime;
+            entry->missedTime = 0;
+            entry->callback(dt + missedTime);
         }
     }
 
@@ -805,48 +1277,15 @@ void Scheduler::update(float dt)
     {
         if ((! entry->paused) && (! entry->markedForDeletion))
         {
-            entry->callback(dt);
+            countCallback(entry->target, entry->priority);
+            float missedTime = entry->missedTime;
+            entry->missedTime = 0;
+            entry->callback(dt + missedTime);
         }
     }
 
-    // Iterate over all the custom selectors
-    for (tHashTimerEntry *elt = _hashForTimers; elt != nullptr; )
-    {
-        _currentTarget = elt;
-        _currentTargetSalvaged = false;
-
-        if (! _currentTarget->paused)
-        {
-            // The 'timers' array may change while inside this loop
-            for (elt->timerIndex = 0; elt->timerIndex < elt->timers->num; ++(elt->timerIndex))
-            {
-                elt->currentTimer = (Timer*)(elt->timers->arr[elt->timerIndex]);
-                elt->currentTimerSalvaged = false;
-
-                elt->currentTimer->update(dt);
-
-                if (elt->currentTimerSalvaged)
-                {
-                    // The currentTimer told the remove itself. To prevent the timer from
-                    // accidentally deallocating itself before finishing its step, we retained
-                    // it. Now that step is done, it's safe to release it.
-                    elt->currentTimer->release();
-                }
-
-                elt->currentTimer = nullptr;
-            }
-        }
-
-        // elt, at this moment, is still valid
-        // so it is safe to ask this here (issue #490)
-        elt = (tHashTimerEntry *)elt->hh.next;
-
-        // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
-        if (_currentTargetSalvaged && _currentTarget->timers->num == 0)
-        {
-            removeHashElement(_currentTarget);
-        }
-    }
+    // Run the custom selectors that are due
+    updateTimers(dt);
 
     // delete all updates that are marked for deletion
     // updates with priority < 0
@@ -878,24 +1317,319 @@ void Scheduler::update(float dt)
 
     _updateHashLocked = false;
     _currentTarget = nullptr;
+}
 
-    //
-    // Functions allocated from another thread
-    //
+// timing wheel
 
-    // Testing size is faster than locking / unlocking.
-    // And almost never there will be functions scheduled to be called.
-    if( !_functionsToPerform.empty() ) {
-        _performMutex.lock();
-        // fixed #4123: Save the callback functions, they must be invoked after '_performMutex.unlock()', otherwise if new functions are added in callback, it will cause thread deadlock.
-        auto temp = _functionsToPerform;
-        _functionsToPerform.clear();
-        _performMutex.unlock();
-        for( const auto &function : temp ) {
-            function();
+void Scheduler::addTimer(tHashTimerEntry *element, Timer *timer)
+{
+    timer->_timerEntry = element;
+    timer->_started = false;
+    timer->_aborted = false;
+    if (! element->paused)
+    {
+        linkTimer(timer, TIMER_SLOT_PENDING);
+    }
+}
+
+void Scheduler::removeTimer(Timer *timer)
+{
+    timer->_aborted = true;
+    unlinkTimer(timer);
+
+    // frees the slot of the handle, the old handle no longer matches it
+    auto callbackTimer = dynamic_cast<TimerTargetCallback*>(timer);
+    if (callbackTimer && callbackTimer->_handle != 0)
+    {
+        const uint32_t slot = (uint32_t)callbackTimer->_handle;
+        _handleTimers[slot] = nullptr;
+        if (++_handleGenerations[slot] > MAX_HANDLE_GENERATION)
+        {
+            _handleGenerations[slot] = 1;
+        }
+        _freeHandleSlots.push_back(slot);
+        callbackTimer->_handle = 0;
+    }
+}
+
+void Scheduler::setTimerInterval(Timer *timer, float interval)
+{
+    // the deadline is counted from the previous trigger, or is the previous trigger when the interval is 0
+    float oldInterval = timer->getInterval();
+    timer->setInterval(interval);
+    if (timer->_started && !timer->_useDelay)
+    {
+        timer->_deadline += interval - oldInterval;
+        if (timer->_wheelSlot != TIMER_NO_SLOT)
+        {
+            unlinkTimer(timer);
+            insertTimer(timer);
+        }
+    }
+}
+
+void Scheduler::pauseTimers(tHashTimerEntry *element)
+{
+    if (element->paused)
+    {
+        return;
+    }
+    element->paused = true;
+
+    for (int i = 0; i < element->timers->num; ++i)
+    {
+        auto timer = static_cast<Timer*>(element->timers->arr[i]);
+        // the running timer is handled by runTimer()
+        if (timer->_wheelSlot != TIMER_NO_SLOT)
+        {
+            unlinkTimer(timer);
+            if (timer->_started)
+            {
+                timer->_deadline -= _timerTime;
+            }
+        }
+    }
+}
+
+void Scheduler::resumeTimers(tHashTimerEntry *element, float missedTime)
+{
+    if (! element->paused)
+    {
+        return;
+    }
+    element->paused = false;
+
+    for (int i = 0; i < element->timers->num; ++i)
+    {
+        auto timer = static_cast<Timer*>(element->timers->arr[i]);
+        if (timer->_wheelSlot != TIMER_NO_SLOT || timer == element->currentTimer)
+        {
+            continue;
+        }
+        if (timer->_started)
+        {
+            // the deadlines are relative while paused, the missed time brings them closer
+            timer->_deadline += _timerTime - missedTime;
+            insertTimer(timer);
+        }
+        else
+        {
+            linkTimer(timer, TIMER_SLOT_PENDING);
+        }
+    }
+}
+
+void Scheduler::updateTimers(float dt)
+{
+    _timerTime += dt;
+
+    runTimers(TIMER_SLOT_CURRENT);
+
+    uint64_t lastTick = static_cast<uint64_t>(_timerTime * TIMER_TICKS_PER_SECOND);
+    while (_timerTick <= lastTick)
+    {
+        uint64_t tick = _timerTick;
+        cascadeTimers(tick);
+        _timerTick = tick + 1;
+        runTimers(getTimerSlot(0, tick));
+    }
+
+    // the timers scheduled since the previous update start counting from now
+    startTimers();
+}
+
+void Scheduler::runTimers(int slot)
+{
+    // the timers are run from a snapshot of the slot: the ones not due yet go back to the current slot for the
+    // next update, and a timer rescheduled 256 ticks later lands in the level 0 slot being run
+    moveTimers(slot, TIMER_SLOT_PROCESSING);
+
+    // the snapshot may change while the timers are triggered
+    while (Timer* timer = _timerSlotHeads[TIMER_SLOT_PROCESSING])
+    {
+        unlinkTimer(timer);
+        if (timer->_deadline > _timerTime)
+        {
+            insertTimer(timer);
+        }
+        else
+        {
+            runTimer(timer);
+        }
+    }
+}
+
+void Scheduler::runTimer(Timer *timer)
+{
+    tHashTimerEntry *element = timer->_timerEntry;
+    _currentTarget = element;
+    _currentTargetSalvaged = false;
+    element->currentTimer = timer;
+    element->currentTimerSalvaged = false;
+
+    countCallback(element->target, 0);
+    timer->fire(_timerTime);
+
+    if (element->currentTimerSalvaged)
+    {
+        // The currentTimer told the remove itself. To prevent the timer from
+        // accidentally deallocating itself before finishing its step, we retained
+        // it. Now that step is done, it's safe to release it.
+        timer->release();
+    }
+    else if (! timer->_aborted)
+    {
+        if (element->paused)
+        {
+            timer->_deadline -= _timerTime;
+        }
+        else
+        {
+            insertTimer(timer);
+        }
+    }
+    element->currentTimer = nullptr;
+
+    // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
+    if (_currentTargetSalvaged && element->timers->num == 0)
+    {
+        removeHashElement(element);
+    }
+    _currentTarget = nullptr;
+}
+
+void Scheduler::startTimers()
+{
+    moveTimers(TIMER_SLOT_PENDING, TIMER_SLOT_PROCESSING);
+    while (Timer* timer = _timerSlotHeads[TIMER_SLOT_PROCESSING])
+    {
+        unlinkTimer(timer);
+        timer->_started = true;
+        timer->_timesExecuted = 0;
+        timer->_deadline = _timerTime;
+        if (timer->_useDelay)
+        {
+            timer->_deadline += timer->_delay;
+        }
+        else if (timer->_interval > 0.f)
+        {
+            timer->_deadline += timer->_interval;
+        }
+        insertTimer(timer);
+    }
+}
+
+void Scheduler::cascadeTimers(uint64_t tick)
+{
+    if (tick & ((1 << TIMER_LEVEL0_BITS) - 1))
+    {
+        return;
+    }
+
+    // a level is cascaded when the ticks reach its slot, the next level when the level wraps around
+    int level = 1;
+    for (; level < TIMER_LEVELS; ++level)
+    {
+        int slot = getTimerSlot(level, tick);
+        moveTimers(slot, TIMER_SLOT_PROCESSING);
+        while (Timer* timer = _timerSlotHeads[TIMER_SLOT_PROCESSING])
+        {
+            unlinkTimer(timer);
+            insertTimer(timer);
         }
+        if (slot != getTimerSlot(level, 0))
+        {
+            return;
+        }
+    }
+
+    moveTimers(TIMER_SLOT_OVERFLOW, TIMER_SLOT_PROCESSING);
+    while (Timer* timer = _timerSlotHeads[TIMER_SLOT_PROCESSING])
+    {
+        unlinkTimer(timer);
+        insertTimer(timer);
+    }
+}
+
+void Scheduler::insertTimer(Timer *timer)
+{
+    double tick = std::floor(timer->_deadline * TIMER_TICKS_PER_SECOND);
+    if (tick < static_cast<double>(_timerTick))
+    {
+        linkTimer(timer, TIMER_SLOT_CURRENT);
+        return;
+    }
+
+    double ticksLeft = tick - static_cast<double>(_timerTick);
+    int level = 0;
+    int bits = TIMER_LEVEL0_BITS;
+    while (level < TIMER_LEVELS && ticksLeft >= static_cast<double>(1ull << bits))
+    {
+        ++level;
+        bits += TIMER_LEVEL_BITS;
+    }
 
+    if (level == TIMER_LEVELS)
+    {
+        linkTimer(timer, TIMER_SLOT_OVERFLOW);
+    }
+    else
+    {
+        linkTimer(timer, getTimerSlot(level, static_cast<uint64_t>(tick)));
+    }
+}
+
+void Scheduler::linkTimer(Timer *timer, int slot)
+{
+    CCASSERT(timer->_wheelSlot == TIMER_NO_SLOT, "the timer is already in the timing wheel");
+
+    timer->_wheelSlot = slot;
+    timer->_wheelNext = nullptr;
+    timer->_wheelPrev = _timerSlotTails[slot];
+    if (timer->_wheelPrev)
+    {
+        timer->_wheelPrev->_wheelNext = timer;
+    }
+    else
+    {
+        _timerSlotHeads[slot] = timer;
+    }
+    _timerSlotTails[slot] = timer;
+}
+
+void Scheduler::unlinkTimer(Timer *timer)
+{
+    int slot = timer->_wheelSlot;
+    if (slot == TIMER_NO_SLOT)
+    {
+        return;
+    }
+
+    if (timer->_wheelPrev)
+        timer->_wheelPrev->_wheelNext = timer->_wheelNext;
+    else
+        _timerSlotHeads[slot] = timer->_wheelNext;
+
+    if (timer->_wheelNext)
+        timer->_wheelNext->_wheelPrev = timer->_wheelPrev;
+    else
+        _timerSlotTails[slot] = timer->_wheelPrev;
+
+    timer->_wheelPrev = timer->_wheelNext = nullptr;
+    timer->_wheelSlot = TIMER_NO_SLOT;
+}
+
+void Scheduler::moveTimers(int fromSlot, int toSlot)
+{
+    CCASSERT(_timerSlotHeads[toSlot] == nullptr, "the slot should be empty");
+
+    for (Timer* timer = _timerSlotHeads[fromSlot]; timer; timer = timer->_wheelNext)
+    {
+        timer->_wheelSlot = toSlot;
     }
+    _timerSlotHeads[toSlot] = _timerSlotHeads[fromSlot];
+    _timerSlotTails[toSlot] = _timerSlotTails[fromSlot];
+    _timerSlotHeads[fromSlot] = _timerSlotTails[fromSlot] = nullptr;
 }
 
 void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, unsigned int repeat, float delay, bool paused)
@@ -933,7 +1667,7 @@ void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, uns
             if (timer && selector == timer->getSelector())
             {
                 CCLOG("CCScheduler#scheduleSelector. Selector already scheduled. Updating interval from: %.4f to %.4f", timer->getInterval(), interval);
-                timer->setInterval(interval);
+                setTimerInterval(timer, interval);
                 return;
             }
         }
@@ -943,6 +1677,7 @@ void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, uns
     TimerTargetSelector *timer = new (std::nothrow) TimerTargetSelector();
     timer->initWithSelector(this, selector, target, interval, repeat, delay);
     ccArrayAppendObject(element->timers, timer);
+    addTimer(element, timer);
     timer->release();
 }
 
@@ -1014,6 +1749,7 @@ void Scheduler::unschedule(SEL_SCHEDULE selector, Ref *target)
                     element->currentTimerSalvaged = true;
                 }
 
+                removeTimer(timer);
                 ccArrayRemoveObjectAtIndex(element->timers, i, true);
 
                 // update timerIndex in case we are in tick:, looping over the actions
@@ -28,9 +28,11 @@ THE SOFTWARE.
 #ifndef __CCSCHEDULER_H__
 #define __CCSCHEDULER_H__
 
+#include <algorithm>
 #include <functional>
 #include <mutex>
 #include <set>
+#include <vector>
 
 #include "base/CCRef.h"
 #include "base/CCVector.h"
@@ -39,8 +41,13 @@ THE SOFTWARE.
 NS_CC_BEGIN
 
 class Scheduler;
+struct _hashSelectorEntry;
 
 typedef std::function<void(float)> ccSchedulerFunc;
+/** Identifies a callback scheduled without a key, see Scheduler::schedule(). 0 is never a valid handle.
+ The handles stay below 2^53, so the scripts keep them exactly in their numbers.
+ */
+typedef uint64_t ccSchedulerHandle;
 
 /**
  * @cond
@@ -63,7 +70,11 @@ public:
     /** triggers the timer */
     void update(float dt);
 
+    /** Triggers the timer for its deadlines up to `time`, how the Scheduler runs it from its timing wheel. */
+    void fire(double time);
+
 protected:
+    friend class Scheduler;
 
     Scheduler* _scheduler; // weak ref
     float _elapsed;
@@ -73,6 +84,15 @@ protected:
     unsigned int _repeat; //0 = once, 1 is 2 x executed
     float _delay;
     float _interval;
+
+    // the timing wheel of the Scheduler
+    double _deadline; // the next trigger, the time left while the target is paused
+    Timer* _wheelPrev;
+    Timer* _wheelNext;
+    int _wheelSlot;
+    bool _started;
+    bool _aborted;
+    struct _hashSelectorEntry* _timerEntry;
 };
 
 
@@ -102,17 +122,27 @@ public:
 
     // Initializes a timer with a target, a lambda and an interval in seconds, repeat in number of times to repeat, delay in seconds.
     bool initWithCallback(Scheduler* scheduler, const ccSchedulerFunc& callback, void *target, const std::string& key, float seconds, unsigned int repeat, float delay);
+    // Same with an integer key.
+    bool initWithCallback(Scheduler* scheduler, const ccSchedulerFunc& callback, void *target, int key, float seconds, unsigned int repeat, float delay);
 
     inline const ccSchedulerFunc& getCallback() const { return _callback; };
     inline const std::string& getKey() const { return _key; };
+    inline bool hasIntKey() const { return _hasIntKey; };
+    inline int getIntKey() const { return _intKey; };
+    inline ccSchedulerHandle getHandle() const { return _handle; };
 
     virtual void trigger(float dt) override;
     virtual void cancel() override;
 
 protected:
+    friend class Scheduler;
+
     void* _target;
     ccSchedulerFunc _callback;
     std::string _key;
+    int _intKey;
+    bool _hasIntKey;
+    ccSchedulerHandle _handle; // 0 when it's identified by its key
 };
 
 /**
@@ -125,7 +155,6 @@ protected:
  */
 
 struct _listEntry;
-struct _hashSelectorEntry;
 struct _hashUpdateEntry;
 
 /** @brief Scheduler is responsible for triggering the scheduled callbacks.
@@ -136,6 +165,7 @@ There are 2 different types of callbacks (selectors):
 - update selector: the 'update' selector will be called every frame. You can customize the priority.
 - custom selector: A custom selector will be called every frame, or with a custom interval of time
 
+The 'custom selectors' wait in a hierarchical timing wheel, a frame only touches the ones that are due.
 The 'custom selectors' should be avoided when possible. It is faster, and consumes less memory to use the 'update selector'.
 
 */
@@ -185,6 +215,41 @@ public:
     */
     inline void setTimeScale(float timeScale) { _timeScale = timeScale; }
 
+    /** Runs the updates and the timers in steps of a fixed time instead of once per frame with the frame time.
+     The time of the frames, scaled by the time scale, is accumulated and as many steps as it holds run in update(),
+     none or several in a frame, each with `seconds` as delta time. The logic runs at the same rate whatever the
+     display rate, and the same inputs give the same results, so a game can be replayed.
+     The time left in the accumulator is given by getInterpolationAlpha(), the nodes with
+     Node::setInterpolationEnabled() are drawn between their last two steps with it.
+     The functions of performFunctionInCocosThread() and the deferred tasks still run once per update.
+     @param seconds The time of a step, 1/60 for instance. 0 runs the callbacks once per frame, the default.
+     @since v3.11
+     @js NA
+     */
+    void setFixedTimeStep(float seconds);
+    float getFixedTimeStep() const { return _fixedTimeStep; }
+
+    /** Sets the most steps an update runs, the time of the others is dropped.
+     It defaults to CC_SCHEDULER_MAX_FIXED_STEPS.
+     @since v3.11
+     @js NA
+     */
+    void setMaxFixedSteps(unsigned int steps) { _maxFixedSteps = std::max(steps, 1u); }
+    unsigned int getMaxFixedSteps() const { return _maxFixedSteps; }
+
+    /** Gets how far the time is between the last step and the next one, from 0 to 1.
+     1 without a fixed time step.
+     @since v3.11
+     @js NA
+     */
+    float getInterpolationAlpha() const { return _fixedTimeStep > 0 ? (float)(_fixedAccumulator / _fixedTimeStep) : 1.0f; }
+
+    /** Gets the number of fixed steps run since the fixed time step was set, the frame number of a replay.
+     @since v3.11
+     @js NA
+     */
+    uint64_t getFixedStepCount() const { return _fixedStepCount; }
+
     /** 'update' the scheduler.
      * You should NEVER call this method, unless you know what you are doing.
      * @lua NA
@@ -223,6 +288,31 @@ public:
      */
     void schedule(const ccSchedulerFunc& callback, void *target, float interval, bool paused, const std::string& key);
 
+    /** The scheduled method will be called every 'interval' seconds, identified by an integer key instead of a string.
+     The key isn't allocated, hashed or compared as a string. See the string key version for the parameters.
+     @since v3.11
+     @js NA
+     */
+    void schedule(const ccSchedulerFunc& callback, void *target, float interval, unsigned int repeat, float delay, bool paused, int key);
+
+    /** The scheduled method will be called every 'interval' seconds, identified by the returned handle.
+     Nothing identifies the callback but the handle: scheduling it again schedules it twice. It's cancelled by
+     unschedule(ccSchedulerHandle) in constant time, with the other callbacks of the target, or when it runs for the last time.
+     Use it for the short-lived callbacks, like the delayed ones, which don't need a key.
+     See the string key version for the parameters.
+     @return The handle of the callback, it's no longer valid once the callback is unscheduled.
+     @since v3.11
+     @js NA
+     */
+    ccSchedulerHandle schedule(const ccSchedulerFunc& callback, void *target, float interval, unsigned int repeat, float delay, bool paused);
+
+    /** Calls the callback once after 'delay' seconds, identified by the returned handle.
+     @return The handle of the callback, see schedule().
+     @since v3.11
+     @js NA
+     */
+    ccSchedulerHandle scheduleOnce(const ccSchedulerFunc& callback, void *target, float delay, bool paused);
+
 
     /** The scheduled method will be called every `interval` seconds.
      If paused is true, then it won't be called until it is resumed.
@@ -276,6 +366,22 @@ public:
      */
     void unschedule(const std::string& key, void *target);
 
+    /** Unschedules a callback for an integer key and a given target.
+     @param key The key the callback was scheduled with.
+     @param target The target to be unscheduled.
+     @since v3.11
+     @js NA
+     */
+    void unschedule(int key, void *target);
+
+    /** Unschedules a callback by the handle it was scheduled with, in constant time.
+     Nothing happens when the callback was unscheduled already.
+     @param handle The handle returned by schedule() or scheduleOnce().
+     @since v3.11
+     @js NA
+     */
+    void unschedule(ccSchedulerHandle handle);
+
     /** Unschedules a selector for a given target.
      If you want to unschedule the "update", use `unscheudleUpdate()`.
      @param selector The selector that is unscheduled.
@@ -324,6 +430,18 @@ public:
      */
     bool isScheduled(const std::string& key, void *target);
 
+    /** Checks whether a callback associated with an integer key and 'target' is scheduled.
+     @since v3.11
+     @js NA
+     */
+    bool isScheduled(int key, void *target);
+
+    /** Checks whether the callback of a handle is still scheduled.
+     @since v3.11
+     @js NA
+     */
+    bool isScheduled(ccSchedulerHandle handle) const;
+
     /** Checks whether a selector for a given target is scheduled.
      @param selector The selector to be checked.
      @param target The target of the callback.
@@ -350,6 +468,15 @@ public:
      */
     void resumeTarget(void *target);
 
+    /** Resumes the target as if it had run while paused.
+     Its next update and the timers it runs are stepped by missedTime more than the time of the frame.
+     If the target is not present, nothing happens.
+     @param target The target to be resumed.
+     @param missedTime The time the target missed while paused, in seconds.
+     @since v3.11
+     */
+    void resumeTarget(void *target, float missedTime);
+
     /** Returns whether or not the target is paused.
      * @param target The target to be checked.
      * @return True if the target is paused, false if not.
@@ -387,6 +514,67 @@ public:
      */
     void performFunctionInCocosThread( const std::function<void()> &function);
 
+    /** Queues a function to be run in the cocos2d thread within the budget of a frame.
+     Unlike performFunctionInCocosThread(), the queue isn't drained in one update: the tasks run by priority,
+     the highest first and in order of arrival for the same priority, until the budget is used,
+     and the others wait for the next updates. At least one task runs per update.
+     This function is thread safe.
+     @param task The function to be run in cocos2d thread.
+     @param priority The priority of the task.
+     @see setDeferredTaskBudget()
+     @since v3.11
+     @js NA
+     */
+    void performDeferredTask(const std::function<void()> &task, int priority = 0);
+
+    /** Sets the seconds the deferred tasks may take per update, 0 runs them all.
+     It defaults to CC_SCHEDULER_DEFERRED_TASK_BUDGET milliseconds.
+     @since v3.11
+     @js NA
+     */
+    void setDeferredTaskBudget(float seconds) { _deferredTaskBudget = seconds; }
+    float getDeferredTaskBudget() const { return _deferredTaskBudget; }
+
+    /** What the deferred tasks did in the last update. */
+    struct DeferredTaskStats
+    {
+        unsigned int executed; // the tasks run
+        unsigned int pending;  // the tasks carried over
+        float time;            // the milliseconds they took
+    };
+
+    /** Gets the stats of the deferred tasks of the last update.
+     @since v3.11
+     @js NA
+     */
+    const DeferredTaskStats& getDeferredTaskStats() const { return _deferredTaskStats; }
+
+    /** Gets the number of callbacks run since the scheduler was created: the updates and the timers, except the ones
+     with PRIORITY_SYSTEM and the ones of the quiet targets, and the batches of functions and deferred tasks.
+     The Director compares it between frames to know whether game code ran, see Director::setRetainedModeEnabled().
+     @since v3.11
+     @js NA
+     */
+    unsigned int getCallbackCount() const { return _callbackCount; }
+
+    /** Sets whether the callbacks of a target are left out of getCallbackCount(), for the engine callbacks that don't
+     change what is drawn, like the polling of the AudioEngine.
+     @param target The target of the callbacks.
+     @param quiet True to leave its callbacks out.
+     @since v3.11
+     @js NA
+     */
+    void setTargetQuiet(void *target, bool quiet);
+
+    /** Gets the seconds until a callback has to run: 0 when an update runs every frame or a function or a deferred
+     task is queued, the time to the next timer otherwise, FLT_MAX when nothing is scheduled.
+     The updates with PRIORITY_SYSTEM, like the one of the ActionManager, are left out, they run every frame whether
+     they have something to do or not. See Director::setIdleModeEnabled().
+     @since v3.11
+     @js NA
+     */
+    float getTimeToNextCallback();
+
 protected:
 
     /** Schedules the 'callback' function for a given target with a given priority.
@@ -398,6 +586,9 @@ protected:
      */
     void schedulePerFrame(const ccSchedulerFunc& callback, void *target, int priority, bool paused);
 
+    /// Runs the updates and the timers that are due, once per frame or once per fixed step.
+    void tick(float dt);
+
     void removeHashElement(struct _hashSelectorEntry *element);
     void removeUpdateFromHash(struct _listEntry *entry);
 
@@ -406,9 +597,47 @@ protected:
     void priorityIn(struct _listEntry **list, const ccSchedulerFunc& callback, void *target, int priority, bool paused);
     void appendIn(struct _listEntry **list, const ccSchedulerFunc& callback, void *target, bool paused);
 
+    // timers specific
+
+    void addTimer(struct _hashSelectorEntry *element, Timer *timer);
+    void removeTimer(Timer *timer);
+    // Gets the timers of a target, created with the given paused state when it has none, with room for one more.
+    struct _hashSelectorEntry* getTimerEntry(void *target, bool paused);
+    // Adds a new callback timer to the timers of its target.
+    void addCallbackTimer(struct _hashSelectorEntry *element, TimerTargetCallback *timer);
+    // Removes the timer at `index` of the timers of a target.
+    void unscheduleTimer(struct _hashSelectorEntry *element, int index);
+    void setTimerInterval(Timer *timer, float interval);
+    void pauseTimers(struct _hashSelectorEntry *element);
+    void resumeTimers(struct _hashSelectorEntry *element, float missedTime);
+    void updateTimers(float dt);
+    void runTimers(int slot);
+    void runTimer(Timer *timer);
+    /// Counts a callback in getCallbackCount(), unless it is a system update or the target is quiet.
+    void countCallback(void *target, int priority)
+    {
+        if (priority != PRIORITY_SYSTEM && (_quietTargets.empty() || _quietTargets.find(target) == _quietTargets.end()))
+        {
+            _callbackCount++;
+        }
+    }
+    void startTimers();
+    void cascadeTimers(uint64_t tick);
+    void insertTimer(Timer *timer);
+    void linkTimer(Timer *timer, int slot);
+    void unlinkTimer(Timer *timer);
+    void moveTimers(int fromSlot, int toSlot);
+
+    void runDeferredTasks();
+
 
     float _timeScale;
 
+    float _fixedTimeStep;
+    unsigned int _maxFixedSteps;
+    double _fixedAccumulator;
+    uint64_t _fixedStepCount;
+
     //
     // "updates with priority" stuff
     //
@@ -424,9 +653,37 @@ protected:
     // If true unschedule will not remove anything from a hash. Elements will only be marked for deletion.
     bool _updateHashLocked;
 
+    // the slots of the timing wheel, as lists of timers
+    std::vector<Timer*> _timerSlotHeads;
+    std::vector<Timer*> _timerSlotTails;
+    double _timerTime;
+    uint64_t _timerTick;
+
+    // the timers of the handles by slot, a handle is the generation of its slot in the high 32 bits and the slot in
+    // the low ones, the generation changes when the timer is removed so the old handles don't match
+    std::vector<TimerTargetCallback*> _handleTimers;
+    std::vector<uint32_t> _handleGenerations;
+    std::vector<uint32_t> _freeHandleSlots;
+
     // Used for "perform Function"
     std::vector<std::function<void()>> _functionsToPerform;
     std::mutex _performMutex;
+
+    // Used for "deferred tasks", queued under _performMutex then moved to the heap of the cocos2d thread
+    struct DeferredTask
+    {
+        int priority;
+        unsigned int order;
+        std::function<void()> task;
+    };
+    std::vector<DeferredTask> _deferredTasksToQueue;
+    std::vector<DeferredTask> _deferredTasks;
+    unsigned int _deferredTaskOrder;
+    float _deferredTaskBudget;
+    DeferredTaskStats _deferredTaskStats;
+
+    unsigned int _callbackCount;
+    std::set<void*> _quietTargets;
 };
 
 // end of base group
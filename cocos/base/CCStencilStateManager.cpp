@@ -85,9 +85,9 @@ void StencilStateManager::drawFullScreenQuadClearStencil()
     glProgram->setUniformsForBuiltins();
     glProgram->setUniformLocationWith4fv(colorLocation, (GLfloat*) &color.r, 1);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
     GL::enableVertexAttribs( GL::VERTEX_ATTRIB_FLAG_POSITION );
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, vertices);
+    GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, vertices);
     glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
 
     CC_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(1, 4);
@@ -132,19 +132,15 @@ void StencilStateManager::onBeforeVisit()
     // mask of all layers less than or equal to the current (ie: for layer 3: 00000111)
     _mask_layer_le = mask_layer | mask_layer_l;
 
-    // manually save the stencil state
+    // manually save the stencil state, from the GL state cache
 
-    _currentStencilEnabled = glIsEnabled(GL_STENCIL_TEST);
-    glGetIntegerv(GL_STENCIL_WRITEMASK, (GLint *)&_currentStencilWriteMask);
-    glGetIntegerv(GL_STENCIL_FUNC, (GLint *)&_currentStencilFunc);
-    glGetIntegerv(GL_STENCIL_REF, &_currentStencilRef);
-    glGetIntegerv(GL_STENCIL_VALUE_MASK, (GLint *)&_currentStencilValueMask);
-    glGetIntegerv(GL_STENCIL_FAIL, (GLint *)&_currentStencilFail);
-    glGetIntegerv(GL_STENCIL_PASS_DEPTH_FAIL, (GLint *)&_currentStencilPassDepthFail);
-    glGetIntegerv(GL_STENCIL_PASS_DEPTH_PASS, (GLint *)&_currentStencilPassDepthPass);
+    _currentStencilEnabled = GL::isEnabled(GL_STENCIL_TEST);
+    _currentStencilWriteMask = GL::getStencilMask();
+    GL::getStencilFunc(&_currentStencilFunc, &_currentStencilRef, &_currentStencilValueMask);
+    GL::getStencilOp(&_currentStencilFail, &_currentStencilPassDepthFail, &_currentStencilPassDepthPass);
 
     // enable stencil use
-    glEnable(GL_STENCIL_TEST);
+    GL::enable(GL_STENCIL_TEST);
     //    RenderState::StateBlock::_defaultState->setStencilTest(true);
 
     // check for OpenGL error while enabling stencil test
@@ -152,12 +148,12 @@ void StencilStateManager::onBeforeVisit()
 
     // all bits on the stencil buffer are readonly, except the current layer bit,
     // this means that operation like glClear or glStencilOp will be masked with this value
-    glStencilMask(mask_layer);
+    GL::stencilMask(mask_layer);
     //    RenderState::StateBlock::_defaultState->setStencilWrite(mask_layer);
 
     // manually save the depth test state
 
-    glGetBooleanv(GL_DEPTH_WRITEMASK, &_currentDepthWriteMask);
+    _currentDepthWriteMask = GL::getDepthMask();
 
     // disable depth test while drawing the stencil
     //glDisable(GL_DEPTH_TEST);
@@ -165,7 +161,7 @@ void StencilStateManager::onBeforeVisit()
     // as the stencil is not meant to be rendered in the real scene,
     // it should never prevent something else to be drawn,
     // only disabling depth buffer update should do
-    glDepthMask(GL_FALSE);
+    GL::depthMask(GL_FALSE);
     RenderState::StateBlock::_defaultState->setDepthWrite(false);
 
     ///////////////////////////////////
@@ -177,8 +173,8 @@ void StencilStateManager::onBeforeVisit()
     //     never draw it into the frame buffer
     //     if not in inverted mode: set the current layer value to 0 in the stencil buffer
     //     if in inverted mode: set the current layer value to 1 in the stencil buffer
-    glStencilFunc(GL_NEVER, mask_layer, mask_layer);
-    glStencilOp(!_inverted ? GL_ZERO : GL_REPLACE, GL_KEEP, GL_KEEP);
+    GL::stencilFunc(GL_NEVER, mask_layer, mask_layer);
+    GL::stencilOp(!_inverted ? GL_ZERO : GL_REPLACE, GL_KEEP, GL_KEEP);
 
     // draw a fullscreen solid rectangle to clear the stencil buffer
     //ccDrawSolidRect(Vec2::ZERO, ccpFromSize([[Director sharedDirector] winSize]), Color4F(1, 1, 1, 1));
@@ -192,10 +188,10 @@ void StencilStateManager::onBeforeVisit()
     //     never draw it into the frame buffer
     //     if not in inverted mode: set the current layer value to 1 in the stencil buffer
     //     if in inverted mode: set the current layer value to 0 in the stencil buffer
-    glStencilFunc(GL_NEVER, mask_layer, mask_layer);
+    GL::stencilFunc(GL_NEVER, mask_layer, mask_layer);
     //    RenderState::StateBlock::_defaultState->setStencilFunction(RenderState::STENCIL_NEVER, mask_layer, mask_layer);
 
-    glStencilOp(!_inverted ? GL_REPLACE : GL_ZERO, GL_KEEP, GL_KEEP);
+    GL::stencilOp(!_inverted ? GL_REPLACE : GL_ZERO, GL_KEEP, GL_KEEP);
     //    RenderState::StateBlock::_defaultState->setStencilOperation(
     //                                                                !_inverted ? RenderState::STENCIL_OP_REPLACE : RenderState::STENCIL_OP_ZERO,
     //                                                                RenderState::STENCIL_OP_KEEP,
@@ -240,7 +236,7 @@ void StencilStateManager::onAfterDrawStencil()
     }
 
     // restore the depth test state
-    glDepthMask(_currentDepthWriteMask);
+    GL::depthMask(_currentDepthWriteMask);
     RenderState::StateBlock::_defaultState->setDepthWrite(_currentDepthWriteMask != 0);
 
     //if (currentDepthTestEnabled) {
@@ -256,10 +252,10 @@ void StencilStateManager::onAfterDrawStencil()
     //         draw the pixel and keep the current layer in the stencil buffer
     //     else
     //         do not draw the pixel but keep the current layer in the stencil buffer
-    glStencilFunc(GL_EQUAL, _mask_layer_le, _mask_layer_le);
+    GL::stencilFunc(GL_EQUAL, _mask_layer_le, _mask_layer_le);
     //    RenderState::StateBlock::_defaultState->setStencilFunction(RenderState::STENCIL_EQUAL, _mask_layer_le, _mask_layer_le);
 
-    glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+    GL::stencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
     //    RenderState::StateBlock::_defaultState->setStencilOperation(RenderState::STENCIL_OP_KEEP, RenderState::STENCIL_OP_KEEP, RenderState::STENCIL_OP_KEEP);
 
     // draw (according to the stencil test function) this node and its children
@@ -272,18 +268,18 @@ void StencilStateManager::onAfterVisit()
     // CLEANUP
 
     // manually restore the stencil state
-    glStencilFunc(_currentStencilFunc, _currentStencilRef, _currentStencilValueMask);
+    GL::stencilFunc(_currentStencilFunc, _currentStencilRef, _currentStencilValueMask);
     //    RenderState::StateBlock::_defaultState->setStencilFunction((RenderState::StencilFunction)_currentStencilFunc, _currentStencilRef, _currentStencilValueMask);
 
-    glStencilOp(_currentStencilFail, _currentStencilPassDepthFail, _currentStencilPassDepthPass);
+    GL::stencilOp(_currentStencilFail, _currentStencilPassDepthFail, _currentStencilPassDepthPass);
     //    RenderState::StateBlock::_defaultState->setStencilOperation((RenderState::StencilOperation)_currentStencilFail,
     //                                                                (RenderState::StencilOperation)_currentStencilPassDepthFail,
     //                                                                (RenderState::StencilOperation)_currentStencilPassDepthPass);
 
-    glStencilMask(_currentStencilWriteMask);
+    GL::stencilMask(_currentStencilWriteMask);
     if (!_currentStencilEnabled)
     {
-        glDisable(GL_STENCIL_TEST);
+        GL::disable(GL_STENCIL_TEST);
         //        RenderState::StateBlock::_defaultState->setStencilTest(false);
     }
 
@@ -25,6 +25,7 @@ Copyright (c) 2013-2016 Chukong Technologies
 
 #include "base/CCString.h"
 #include <stdarg.h>
+#include "base/CCAllocationProfiler.h"
 
 NS_CC_BEGIN
 
@@ -40,6 +41,7 @@ std::string format(const char* format, ...)
     va_start(ap, format);
 
     char* buf = (char*)malloc(CC_MAX_STRING_LENGTH);
+    CC_PROFILE_ALLOCATION("StringUtils::format", CC_MAX_STRING_LENGTH);
     if (buf != nullptr)
     {
         vsnprintf(buf, CC_MAX_STRING_LENGTH, format, ap);
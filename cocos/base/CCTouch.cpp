@@ -64,6 +64,30 @@ Vec2 Touch::getStartLocation() const
     return Director::DirectorInstance->convertToGL(_startPoint);
 }
 
+// returns the predicted touch location in screen coordinates
+Vec2 Touch::getPredictedLocationInView() const
+{
+    return _predictedPoint;
+}
+
+// returns the predicted touch location in OpenGL coordinates
+Vec2 Touch::getPredictedLocation() const
+{
+    return Director::DirectorInstance->convertToGL(_predictedPoint);
+}
+
+// returns the samples of the last move in OpenGL coordinates
+std::vector<Vec2> Touch::getHistory() const
+{
+    std::vector<Vec2> history;
+    history.reserve(_history.size());
+    for (const auto& point : _history)
+    {
+        history.push_back(Director::DirectorInstance->convertToGL(point));
+    }
+    return history;
+}
+
 // returns the delta position between the current location and the previous location in OpenGL coordinates
 Vec2 Touch::getDelta() const
 {
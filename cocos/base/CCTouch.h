@@ -29,6 +29,8 @@ THE SOFTWARE.
 #include "base/CCRef.h"
 #include "math/CCGeometry.h"
 
+#include <vector>
+
 NS_CC_BEGIN
 
 /**
@@ -59,7 +61,9 @@ public:
         : _id(0),
         _startPointCaptured(false),
         _curForce(0.f),
-        _maxForce(0.f)
+        _maxForce(0.f),
+        _time(0),
+        _prevTime(0)
     {}
 
     /** Returns the current touch location in OpenGL coordinates.
@@ -97,6 +101,28 @@ public:
      * @return The start touch location in screen coordinates.
      */
     Vec2 getStartLocationInView() const;
+    /** Returns the location the touch is expected at when the frame is shown, in OpenGL coordinates.
+     * It is the current location unless GLView::setTouchPrediction() is set.
+     *
+     * @return The predicted touch location in OpenGL coordinates.
+     */
+    Vec2 getPredictedLocation() const;
+    /** Returns the location the touch is expected at when the frame is shown, in screen coordinates.
+     *
+     * @return The predicted touch location in screen coordinates.
+     */
+    Vec2 getPredictedLocationInView() const;
+    /** Returns the samples of the touch since the previous move event in OpenGL coordinates, oldest first.
+     * The last one is the current location. There are several when GLView coalesces the moves.
+     *
+     * @return The locations of the samples in OpenGL coordinates.
+     */
+    std::vector<Vec2> getHistory() const;
+    /** Returns the samples of the touch since the previous move event in screen coordinates, oldest first.
+     *
+     * @return The locations of the samples in screen coordinates.
+     */
+    const std::vector<Vec2>& getHistoryInView() const { return _history; }
 
     /** Set the touch information. It always used to monitor touch event.
      *
@@ -118,6 +144,7 @@ public:
             _startPointCaptured = true;
             _prevPoint = _point;
         }
+        _predictedPoint = _point;
     }
 
     /** Set the touch information. It always used to monitor touch event.
@@ -142,6 +169,7 @@ public:
             _startPointCaptured = true;
             _prevPoint = _point;
         }
+        _predictedPoint = _point;
     }
     /** Get touch id.
      * @js getId
@@ -172,6 +200,13 @@ private:
     Vec2 _prevPoint;
     float _curForce;
     float _maxForce;
+    Vec2 _predictedPoint;
+    // the samples of the current move, and the times of the last samples of the current and the previous moves
+    std::vector<Vec2> _history;
+    double _time;
+    double _prevTime;
+
+    friend class GLView;
 };
 
 // end of base group
@@ -0,0 +1,294 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "base/CCTracer.h"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdio>
+
+#include "base/ccMacros.h"
+#include "platform/CCFileUtils.h"
+
+NS_CC_BEGIN
+
+namespace {
+
+struct TraceZoneInfo
+{
+    const char* category;
+    const char* name;
+};
+
+// a closed zone, in nanoseconds of the trace clock
+struct TraceEvent
+{
+    int64_t start;
+    int64_t duration;
+    int zone;
+};
+
+// the zones of one thread, only that thread writes them. The count publishes the events to writeChromeTrace().
+struct ThreadBuffer
+{
+    std::unique_ptr<TraceEvent[]> events;
+    std::atomic<int> count;
+    std::atomic<int> dropped;
+    // the recording the events belong to, the writer empties its buffer when a new one starts
+    std::atomic<unsigned int> session;
+    std::atomic<const char*> name;
+    std::atomic<bool> inUse;
+    int tid;
+
+    ThreadBuffer(int threadID)
+    : count(0)
+    , dropped(0)
+    , session(0)
+    , name(nullptr)
+    , inUse(true)
+    , tid(threadID)
+    {
+    }
+};
+
+// hands the buffer over to the next thread when the thread exits, e.g. a short lived loader thread
+struct ThreadBufferHolder
+{
+    ThreadBuffer* buffer;
+
+    ThreadBufferHolder() : buffer(nullptr) {}
+    ~ThreadBufferHolder()
+    {
+        if (buffer)
+        {
+            buffer->name = nullptr;
+            buffer->inUse = false;
+        }
+    }
+};
+
+// guards the registration of the zones and of the threads, a thread only takes it for its first zone
+std::mutex s_registryMutex;
+std::vector<TraceZoneInfo> s_zones;
+// never freed, the threads that record may outlive every other object
+std::vector<ThreadBuffer*> s_threadBuffers;
+
+std::atomic<unsigned int> s_session(0);
+std::atomic<int64_t> s_sessionStart(0);
+
+thread_local ThreadBufferHolder s_threadBuffer;
+
+const std::chrono::steady_clock::time_point s_epoch = std::chrono::steady_clock::now();
+
+ThreadBuffer* getThreadBuffer()
+{
+    if (s_threadBuffer.buffer)
+        return s_threadBuffer.buffer;
+
+    std::lock_guard<std::mutex> lock(s_registryMutex);
+    for (auto buffer : s_threadBuffers)
+    {
+        if (!buffer->inUse)
+        {
+            buffer->inUse = true;
+            s_threadBuffer.buffer = buffer;
+            return buffer;
+        }
+    }
+
+    auto buffer = new (std::nothrow) ThreadBuffer((int)s_threadBuffers.size() + 1);
+    if (buffer)
+    {
+        s_threadBuffers.push_back(buffer);
+        s_threadBuffer.buffer = buffer;
+    }
+    return buffer;
+}
+
+// the names are usually literals, but a quote would break the whole file
+void writeJSONString(FILE* file, const char* str)
+{
+    fputc('"', file);
+    for (; str && *str; ++str)
+    {
+        if (*str == '"' || *str == '\\')
+            fputc('\\', file);
+        if ((unsigned char)*str >= 0x20)
+            fputc(*str, file);
+    }
+    fputc('"', file);
+}
+
+} // namespace
+
+std::atomic<bool> Tracer::s_isRecording(false);
+
+int Tracer::registerZone(const char* category, const char* name)
+{
+    std::lock_guard<std::mutex> lock(s_registryMutex);
+    TraceZoneInfo info = { category, name };
+    s_zones.push_back(info);
+    return (int)s_zones.size() - 1;
+}
+
+void Tracer::setThreadName(const char* name)
+{
+    auto buffer = getThreadBuffer();
+    if (buffer)
+    {
+        buffer->name = name;
+    }
+}
+
+void Tracer::start()
+{
+    s_sessionStart = now();
+    s_session.fetch_add(1, std::memory_order_release);
+    s_isRecording = true;
+}
+
+void Tracer::stop()
+{
+    s_isRecording = false;
+}
+
+int64_t Tracer::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_epoch).count();
+}
+
+void Tracer::record(int zone, int64_t start, int64_t end)
+{
+    if (!isRecording())
+        return;
+
+    auto buffer = getThreadBuffer();
+    if (buffer == nullptr)
+        return;
+
+    unsigned int session = s_session.load(std::memory_order_acquire);
+    if (buffer->session.load(std::memory_order_relaxed) != session)
+    {
+        buffer->count.store(0, std::memory_order_relaxed);
+        buffer->dropped.store(0, std::memory_order_relaxed);
+        buffer->session.store(session, std::memory_order_release);
+    }
+    // the zone was opened by a previous recording
+    if (start < s_sessionStart.load(std::memory_order_relaxed))
+        return;
+
+    if (!buffer->events)
+    {
+        buffer->events.reset(new (std::nothrow) TraceEvent[CC_TRACE_EVENTS_PER_THREAD]);
+    }
+
+    int count = buffer->count.load(std::memory_order_relaxed);
+    if (!buffer->events || count == CC_TRACE_EVENTS_PER_THREAD)
+    {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    auto& event = buffer->events[count];
+    event.start = start;
+    event.duration = end - start;
+    event.zone = zone;
+    buffer->count.store(count + 1, std::memory_order_release);
+}
+
+int Tracer::getDroppedZones()
+{
+    std::lock_guard<std::mutex> lock(s_registryMutex);
+    unsigned int session = s_session.load(std::memory_order_acquire);
+    int dropped = 0;
+    for (auto buffer : s_threadBuffers)
+    {
+        if (buffer->session.load(std::memory_order_acquire) == session)
+        {
+            dropped += buffer->dropped.load(std::memory_order_relaxed);
+        }
+    }
+    return dropped;
+}
+
+bool Tracer::writeChromeTrace(const std::string& path)
+{
+    FILE* file = fopen(FileUtils::getInstance()->getSuitableFOpen(path).c_str(), "w");
+    if (file == nullptr)
+    {
+        CCLOG("cocos2d: Tracer: can't open %s", path.c_str());
+        return false;
+    }
+
+    // the zones and the threads registered later don't have events in the buffers read below
+    std::lock_guard<std::mutex> lock(s_registryMutex);
+    unsigned int session = s_session.load(std::memory_order_acquire);
+
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file);
+    bool first = true;
+    for (auto buffer : s_threadBuffers)
+    {
+        if (buffer->session.load(std::memory_order_acquire) != session)
+            continue;
+
+        int count = buffer->count.load(std::memory_order_acquire);
+        if (count == 0)
+            continue;
+
+        const char* name = buffer->name;
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", first ? "" : ",\n", buffer->tid);
+        if (name)
+        {
+            writeJSONString(file, name);
+        }
+        else
+        {
+            fprintf(file, "\"thread %d\"", buffer->tid);
+        }
+        fputs("}}", file);
+        first = false;
+
+        for (int i = 0; i < count; ++i)
+        {
+            const auto& event = buffer->events[i];
+            const auto& zone = s_zones[event.zone];
+            fputs(",\n{\"name\":", file);
+            writeJSONString(file, zone.name);
+            fputs(",\"cat\":", file);
+            writeJSONString(file, zone.category);
+            // the trace is in microseconds
+            fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    buffer->tid, event.start / 1000.0, event.duration / 1000.0);
+        }
+    }
+    fputs("\n]}\n", file);
+
+    bool ok = ferror(file) == 0;
+    fclose(file);
+    return ok;
+}
+
+NS_CC_END
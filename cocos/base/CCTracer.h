@@ -0,0 +1,136 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_TRACER_H__
+#define __CC_TRACER_H__
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "platform/CCPlatformMacros.h"
+#include "base/ccConfig.h"
+
+/**
+ * @addtogroup base
+ * @{
+ */
+NS_CC_BEGIN
+
+/**
+ * @class Tracer
+ * @brief Records the CC_TRACE_ZONE() scopes of every thread and writes them as a Chrome trace.
+ * Each thread appends its zones to its own buffer without locking, the zone names are registered once per
+ * call site. The trace can be opened with chrome://tracing or https://ui.perfetto.dev.
+ * start(), stop() and writeChromeTrace() are called from one thread, usually the main one.
+ * Unlike Profiler it doesn't look the zones up by name and it is thread safe.
+ * @js NA
+ * @lua NA
+ */
+class CC_DLL Tracer
+{
+public:
+    /** Registers the zone of a call site and returns its id, CC_TRACE_ZONE() calls it once per site. */
+    static int registerZone(const char* category, const char* name);
+
+    /** Names the calling thread in the traces, e.g. "main" or "texture loader". The name must stay valid. */
+    static void setThreadName(const char* name);
+
+    /** Drops what was recorded so far and starts recording. */
+    static void start();
+    /** Stops recording, the zones that are still open are dropped. */
+    static void stop();
+    /** Whether or not the zones are recorded. */
+    static bool isRecording() { return s_isRecording.load(std::memory_order_relaxed); }
+
+    /**
+     * Writes the zones recorded since start() into a Chrome trace JSON file.
+     * It can be called while recording, the zones closed after the call aren't in the file.
+     * @return Whether or not the file could be written.
+     */
+    static bool writeChromeTrace(const std::string& path);
+
+    /** Gets the number of zones dropped since start() because a thread buffer was full. */
+    static int getDroppedZones();
+
+    /** Returns the time of the trace clock, in nanoseconds. */
+    static int64_t now();
+    /** Records a zone of the calling thread that started at `start` and ends now. */
+    static void record(int zone, int64_t start) { record(zone, start, now()); }
+    /**
+     * Records a zone of the calling thread from `start` to `end`, e.g. a sampled script function.
+     * The zones of a thread must nest, they are recorded when they close.
+     */
+    static void record(int zone, int64_t start, int64_t end);
+
+protected:
+    static std::atomic<bool> s_isRecording;
+};
+
+/**
+ * @class TraceZone
+ * @brief Records the scope it lives in as a zone of the trace, see CC_TRACE_ZONE().
+ * @js NA
+ * @lua NA
+ */
+class CC_DLL TraceZone
+{
+public:
+    explicit TraceZone(int zone)
+    : _zone(zone)
+    , _start(Tracer::isRecording() ? Tracer::now() : -1)
+    {
+    }
+
+    ~TraceZone()
+    {
+        if (_start >= 0)
+            Tracer::record(_zone, _start);
+    }
+
+private:
+    TraceZone(const TraceZone&) = delete;
+    TraceZone& operator=(const TraceZone&) = delete;
+
+    int _zone;
+    int64_t _start;
+};
+
+NS_CC_END
+
+#define CC_TRACE_CONCAT_(__a__, __b__) __a__##__b__
+#define CC_TRACE_CONCAT(__a__, __b__) CC_TRACE_CONCAT_(__a__, __b__)
+
+#if CC_ENABLE_TRACING
+/** Records the rest of the enclosing scope as a zone of the trace. The category and the name must be string literals. */
+#define CC_TRACE_ZONE(__category__, __name__) \
+    static const int CC_TRACE_CONCAT(__traceZoneId, __LINE__) = NS_CC::Tracer::registerZone(__category__, __name__); \
+    NS_CC::TraceZone CC_TRACE_CONCAT(__traceZone, __LINE__)(CC_TRACE_CONCAT(__traceZoneId, __LINE__))
+#else
+#define CC_TRACE_ZONE(__category__, __name__) do {} while (0)
+#endif
+
+// end group
+/// @}
+#endif //__CC_TRACER_H__
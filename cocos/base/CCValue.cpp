@@ -26,6 +26,7 @@
 #include <sstream>
 #include <iomanip>
 #include "base/ccUtils.h"
+#include "base/CCAllocationProfiler.h"
 
 NS_CC_BEGIN
 
@@ -37,6 +38,7 @@ const Value Value::Null;
 
 Value::Value()
 : _type(Type::NONE)
+, _shortStringLength(0)
 {
     memset(&_field, 0, sizeof(_field));
 }
@@ -72,20 +74,27 @@ Value::Value(bool v)
 }
 
 Value::Value(const char* v)
-: _type(Type::STRING)
+: _type(Type::NONE)
 {
-    _field.strVal = new (std::nothrow) std::string();
-    if (v)
-    {
-        *_field.strVal = v;
-    }
+    assignString(v, v ? strlen(v) : 0);
+}
+
+Value::Value(const char* v, size_t length)
+: _type(Type::NONE)
+{
+    assignString(v, length);
 }
 
 Value::Value(const std::string& v)
-: _type(Type::STRING)
+: _type(Type::NONE)
+{
+    assignString(v.data(), v.length());
+}
+
+Value::Value(std::string&& v)
+: _type(Type::NONE)
 {
-    _field.strVal = new (std::nothrow) std::string();
-    *_field.strVal = v;
+    assignString(std::move(v));
 }
 
 Value::Value(const ValueVector& v)
@@ -169,11 +178,7 @@ Value& Value::operator= (const Value& other)
                 _field.boolVal = other._field.boolVal;
                 break;
             case Type::STRING:
-                if (_field.strVal == nullptr)
-                {
-                    _field.strVal = new (std::nothrow) std::string();
-                }
-                *_field.strVal = *other._field.strVal;
+                assignString(other.getStringChars(), other.getStringLength());
                 break;
             case Type::VECTOR:
                 if (_field.vectorVal == nullptr)
@@ -226,7 +231,8 @@ Value& Value::operator= (Value&& other)
                 _field.boolVal = other._field.boolVal;
                 break;
             case Type::STRING:
-                _field.strVal = other._field.strVal;
+                memcpy(&_field, &other._field, sizeof(_field));
+                _shortStringLength = other._shortStringLength;
                 break;
             case Type::VECTOR:
                 _field.vectorVal = other._field.vectorVal;
@@ -286,15 +292,19 @@ Value& Value::operator= (bool v)
 
 Value& Value::operator= (const char* v)
 {
-    reset(Type::STRING);
-    *_field.strVal = v ? v : "";
+    assignString(v ? v : "", v ? strlen(v) : 0);
     return *this;
 }
 
 Value& Value::operator= (const std::string& v)
 {
-    reset(Type::STRING);
-    *_field.strVal = v;
+    assignString(v.data(), v.length());
+    return *this;
+}
+
+Value& Value::operator= (std::string&& v)
+{
+    assignString(std::move(v));
     return *this;
 }
 
@@ -364,7 +374,8 @@ bool Value::operator== (const Value& v) const
     case Type::BYTE:    return v._field.byteVal   == this->_field.byteVal;
     case Type::INTEGER: return v._field.intVal    == this->_field.intVal;
     case Type::BOOLEAN: return v._field.boolVal   == this->_field.boolVal;
-    case Type::STRING:  return *v._field.strVal   == *this->_field.strVal;
+    case Type::STRING:  return v.getStringLength() == this->getStringLength()
+                            && memcmp(v.getStringChars(), this->getStringChars(), this->getStringLength()) == 0;
     case Type::FLOAT:   return fabs(v._field.floatVal  - this->_field.floatVal)  <= FLT_EPSILON;
     case Type::DOUBLE:  return fabs(v._field.doubleVal - this->_field.doubleVal) <= FLT_EPSILON;
     case Type::VECTOR:
@@ -434,7 +445,7 @@ unsigned char Value::asByte() const
 
     if (_type == Type::STRING)
     {
-        return static_cast<unsigned char>(atoi(_field.strVal->c_str()));
+        return static_cast<unsigned char>(atoi(getStringChars()));
     }
 
     if (_type == Type::FLOAT)
@@ -470,7 +481,7 @@ int Value::asInt() const
 
     if (_type == Type::STRING)
     {
-        return atoi(_field.strVal->c_str());
+        return atoi(getStringChars());
     }
 
     if (_type == Type::FLOAT)
@@ -506,7 +517,7 @@ float Value::asFloat() const
 
     if (_type == Type::STRING)
     {
-        return utils::atof(_field.strVal->c_str());
+        return utils::atof(getStringChars());
     }
 
     if (_type == Type::INTEGER)
@@ -542,7 +553,7 @@ double Value::asDouble() const
 
     if (_type == Type::STRING)
     {
-        return static_cast<double>(utils::atof(_field.strVal->c_str()));
+        return static_cast<double>(utils::atof(getStringChars()));
     }
 
     if (_type == Type::INTEGER)
@@ -578,7 +589,7 @@ bool Value::asBool() const
 
     if (_type == Type::STRING)
     {
-        return (*_field.strVal == "0" || *_field.strVal == "false") ? false : true;
+        return (strcmp(getStringChars(), "0") == 0 || strcmp(getStringChars(), "false") == 0) ? false : true;
     }
 
     if (_type == Type::INTEGER)
@@ -605,7 +616,7 @@ std::string Value::asString() const
 
     if (_type == Type::STRING)
     {
-        return *_field.strVal;
+        return std::string(getStringChars(), getStringLength());
     }
 
     std::stringstream ret;
@@ -785,7 +796,10 @@ void Value::clear()
             _field.boolVal = false;
             break;
         case Type::STRING:
-            CC_SAFE_DELETE(_field.strVal);
+            if (isLongString())
+            {
+                CC_SAFE_DELETE(_field.strVal);
+            }
             break;
         case Type::VECTOR:
             CC_SAFE_DELETE(_field.vectorVal);
@@ -814,16 +828,21 @@ void Value::reset(Type type)
     switch (type)
     {
         case Type::STRING:
-            _field.strVal = new (std::nothrow) std::string();
+            // an empty short string, assignString() allocates the long ones
+            _field.shortStrVal[0] = '\0';
+            _shortStringLength = 0;
             break;
         case Type::VECTOR:
             _field.vectorVal = new (std::nothrow) ValueVector();
+            CC_PROFILE_ALLOCATION("Value ValueVector", sizeof(ValueVector));
             break;
         case Type::MAP:
             _field.mapVal = new (std::nothrow) ValueMap();
+            CC_PROFILE_ALLOCATION("Value ValueMap", sizeof(ValueMap));
             break;
         case Type::INT_KEY_MAP:
             _field.intKeyMapVal = new (std::nothrow) ValueMapIntKey();
+            CC_PROFILE_ALLOCATION("Value ValueMapIntKey", sizeof(ValueMapIntKey));
             break;
         default:
             break;
@@ -832,5 +851,53 @@ void Value::reset(Type type)
     _type = type;
 }
 
+void Value::assignString(const char* chars, size_t length)
+{
+    reset(Type::STRING);
+
+    if (length <= SHORT_STRING_CAPACITY)
+    {
+        if (isLongString())
+        {
+            CC_SAFE_DELETE(_field.strVal);
+        }
+        memcpy(_field.shortStrVal, chars, length);
+        _field.shortStrVal[length] = '\0';
+        _shortStringLength = static_cast<unsigned char>(length);
+    }
+    else if (isLongString())
+    {
+        _field.strVal->assign(chars, length);
+    }
+    else
+    {
+        _field.strVal = new (std::nothrow) std::string(chars, length);
+        CC_PROFILE_ALLOCATION("Value std::string", sizeof(std::string));
+        _shortStringLength = LONG_STRING;
+    }
+}
+
+void Value::assignString(std::string&& v)
+{
+    if (v.length() <= SHORT_STRING_CAPACITY)
+    {
+        assignString(v.data(), v.length());
+        return;
+    }
+
+    reset(Type::STRING);
+
+    if (isLongString())
+    {
+        *_field.strVal = std::move(v);
+    }
+    else
+    {
+        _field.strVal = new (std::nothrow) std::string(std::move(v));
+        CC_PROFILE_ALLOCATION("Value std::string", sizeof(std::string));
+        _shortStringLength = LONG_STRING;
+    }
+}
+
 NS_CC_END
 
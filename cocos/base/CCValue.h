@@ -50,6 +50,7 @@ CC_DLL extern const ValueMapIntKey ValueMapIntKeyNull;
 
 /*
  * This class is provide as a wrapper of basic types, such as int and bool.
+ * The strings of up to SHORT_STRING_CAPACITY chars are stored in the Value itself, the longer ones are allocated.
  */
 class CC_DLL Value
 {
@@ -78,8 +79,13 @@ public:
     /** Create a Value by a char pointer. It will copy the chars internally. */
     explicit Value(const char* v);
 
+    /** Create a Value by `length` chars of a char pointer, which doesn't need to be terminated. */
+    explicit Value(const char* v, size_t length);
+
     /** Create a Value by a string. */
     explicit Value(const std::string& v);
+    /** Create a Value by a string. It will use std::move internally. */
+    explicit Value(std::string&& v);
 
     /** Create a Value by a ValueVector object. */
     explicit Value(const ValueVector& v);
@@ -123,6 +129,8 @@ public:
     Value& operator= (const char* v);
     /** Assignment operator, assign from string to Value. */
     Value& operator= (const std::string& v);
+    /** Assignment operator, assign from string to Value. It will use std::move internally. */
+    Value& operator= (std::string&& v);
 
     /** Assignment operator, assign from ValueVector to Value. */
     Value& operator= (const ValueVector& v);
@@ -213,10 +221,22 @@ public:
     /** Gets the description of the class. */
     std::string getDescription() const;
 
+    /** The length of the longest string stored without an allocation. */
+    static const size_t SHORT_STRING_CAPACITY = 15;
+
 private:
     void clear();
     void reset(Type type);
 
+    void assignString(const char* chars, size_t length);
+    void assignString(std::string&& v);
+    bool isLongString() const { return _shortStringLength == LONG_STRING; }
+    const char* getStringChars() const { return isLongString() ? _field.strVal->c_str() : _field.shortStrVal; }
+    size_t getStringLength() const { return isLongString() ? _field.strVal->length() : _shortStringLength; }
+
+    // the value of _shortStringLength when the string is in strVal
+    static const unsigned char LONG_STRING = 0xff;
+
     union
     {
         unsigned char byteVal;
@@ -226,12 +246,15 @@ private:
         bool boolVal;
 
         std::string* strVal;
+        // terminated like a C string
+        char shortStrVal[SHORT_STRING_CAPACITY + 1];
         ValueVector* vectorVal;
         ValueMap* mapVal;
         ValueMapIntKey* intKeyMapVal;
     }_field;
 
     Type _type;
+    unsigned char _shortStringLength;
 };
 
 /** @} */
@@ -422,6 +422,28 @@ public:
         return _data.erase(first, last);
     }
 
+    /** @brief Removes the elements for which the predicate returns true, in one pass, keeping the order of the others.
+     *  @param predicate Called once for each element, in order, before any is removed.
+     *  @since v3.11
+     */
+    template<class Predicate>
+    void eraseIf(Predicate predicate)
+    {
+        auto kept = _data.begin();
+        for (auto iter = _data.begin(); iter != _data.end(); ++iter)
+        {
+            if (predicate(*iter))
+            {
+                (*iter)->release();
+            }
+            else
+            {
+                *kept++ = *iter;
+            }
+        }
+        _data.erase(kept, _data.end());
+    }
+
     /** @brief Removes from the Vector by index.
      *  @param index The index of the element to be removed from the Vector.
      *  @return An iterator pointing to the successor of Vector[index].
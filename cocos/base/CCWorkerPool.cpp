@@ -0,0 +1,98 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "base/CCWorkerPool.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "base/ccConfig.h"
+#include "base/CCTracer.h"
+#include "base/CCJobSystem.h"
+
+NS_CC_BEGIN
+
+WorkerPool* WorkerPool::s_sharedWorkerPool = nullptr;
+
+WorkerPool* WorkerPool::getInstance()
+{
+    if (s_sharedWorkerPool == nullptr)
+    {
+        s_sharedWorkerPool = new (std::nothrow) WorkerPool();
+    }
+    return s_sharedWorkerPool;
+}
+
+void WorkerPool::destroyInstance()
+{
+    delete s_sharedWorkerPool;
+    s_sharedWorkerPool = nullptr;
+}
+
+WorkerPool::WorkerPool()
+{
+    // the thread that calls run() is one of them
+    _threadCount = std::min(JobSystem::getInstance()->getWorkerCount() + 1, CC_WORKER_POOL_MAX_THREADS);
+}
+
+WorkerPool::~WorkerPool()
+{
+}
+
+void WorkerPool::run(int count, const Task& task)
+{
+    if (count <= 0)
+        return;
+
+    int threads = std::min(_threadCount, count);
+    if (threads <= 1)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            task(i);
+        }
+        return;
+    }
+
+    std::atomic<int> nextTask(0);
+    auto runTasks = [&]() {
+        CC_TRACE_ZONE("worker", "WorkerPool::runTasks");
+
+        for (int i = nextTask++; i < count; i = nextTask++)
+        {
+            task(i);
+        }
+    };
+
+    auto jobSystem = JobSystem::getInstance();
+    JobSystem::Counter counter;
+    for (int i = 1; i < threads; ++i)
+    {
+        jobSystem->run(runTasks, &counter);
+    }
+    runTasks();
+    jobSystem->wait(&counter);
+}
+
+NS_CC_END
@@ -0,0 +1,79 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_WORKER_POOL_H__
+#define __CC_WORKER_POOL_H__
+
+#include <functional>
+
+#include "platform/CCPlatformMacros.h"
+
+/**
+ * @addtogroup base
+ * @{
+ */
+NS_CC_BEGIN
+
+/**
+ * @class WorkerPool
+ * @brief A pool of threads that run a batch of tasks in parallel and wait for all of them, e.g. the parallel visit of Scene.
+ * Unlike AsyncTaskPool, run() blocks: the calling thread takes part in the work and there is no callback.
+ * The tasks run on the workers of the JobSystem, the number of threads is bounded by CC_WORKER_POOL_MAX_THREADS.
+ * @js NA
+ * @lua NA
+ */
+class CC_DLL WorkerPool
+{
+public:
+    /** The task of run(), called with the index of the task. */
+    typedef std::function<void(int)> Task;
+
+    /** Returns the shared worker pool. */
+    static WorkerPool* getInstance();
+
+    /** Destroys the shared worker pool. */
+    static void destroyInstance();
+
+    /**
+     * Calls task(0) ... task(count - 1) on the workers and the calling thread, returns when all of them are done.
+     * Tasks are started in order but may finish in any order. It must not be called from a task.
+     */
+    void run(int count, const Task& task);
+
+    /** Returns the number of threads that run tasks, the calling thread included. */
+    int getThreadCount() const { return _threadCount; }
+
+protected:
+    WorkerPool();
+    ~WorkerPool();
+
+    static WorkerPool* s_sharedWorkerPool;
+
+    int _threadCount;
+};
+
+NS_CC_END
+// end group
+/// @}
+#endif //__CC_WORKER_POOL_H__
@@ -274,11 +274,12 @@ tImageTGA* tgaLoadBuffer(unsigned char* buffer, long size)
 // this is the function to call when we want to load an image
 tImageTGA * tgaLoad(const char *filename)
 {
-    Data data = FileUtils::getInstance()->getDataFromFile(filename);
+    FileView data = FileUtils::getInstance()->getFileView(filename);
 
     if (!data.isNull())
     {
-        return tgaLoadBuffer(data.getBytes(), data.getSize());
+        // tgaLoadBuffer only reads the buffer
+        return tgaLoadBuffer(const_cast<unsigned char*>(data.getBytes()), data.getSize());
     }
 
     return nullptr;
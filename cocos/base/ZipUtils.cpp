@@ -35,9 +35,14 @@
 #include <zlib.h>
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <vector>
 
 #include "base/CCData.h"
 #include "base/ccMacros.h"
+#include "base/CCWorkerPool.h"
 #include "platform/CCFileUtils.h"
 #include <map>
 
@@ -49,12 +54,75 @@
 
 NS_CC_BEGIN
 
+// --------------------- InflateStream ---------------------
+
+InflateStream::InflateStream(unsigned char *out, ssize_t outLength)
+: _stream(new z_stream)
+, _out(out)
+, _finished(false)
+, _failed(false)
+{
+    memset(_stream, 0, sizeof(*_stream));
+    _stream->next_out = out;
+    _stream->avail_out = static_cast<unsigned int>(outLength);
+
+    // zlib or gzip, detected from the header
+    if (inflateInit2(_stream, 15 + 32) != Z_OK)
+    {
+        CCLOG("cocos2d: ZipUtils: Incompatible zlib version!");
+        _failed = true;
+    }
+}
+
+InflateStream::~InflateStream()
+{
+    inflateEnd(_stream);
+    delete _stream;
+}
+
+bool InflateStream::write(const unsigned char *in, ssize_t inLength)
+{
+    if (_failed)
+        return false;
+
+    // anything after the end of the stream is ignored
+    if (_finished)
+        return true;
+
+    _stream->next_in = const_cast<Bytef*>(in);
+    _stream->avail_in = static_cast<unsigned int>(inLength);
+
+    while (_stream->avail_in > 0)
+    {
+        int err = inflate(_stream, Z_NO_FLUSH);
+        if (err == Z_STREAM_END)
+        {
+            _finished = true;
+            break;
+        }
+
+        // Z_BUF_ERROR: the output is full before the end of the stream
+        if (err != Z_OK)
+        {
+            _failed = true;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+ssize_t InflateStream::getLength() const
+{
+    return _stream->next_out - _out;
+}
+
+// --------------------- ZipUtils ---------------------
+
 unsigned int ZipUtils::s_uEncryptedPvrKeyParts[4] = {0,0,0,0};
 unsigned int ZipUtils::s_uEncryptionKey[1024];
 bool ZipUtils::s_bEncryptionKeyIsValid = false;
 
-// --------------------- ZipUtils ---------------------
-
 inline void ZipUtils::decodeEncodedPvr(unsigned int *data, ssize_t len)
 {
     const int enclen = 1024;
@@ -244,7 +312,31 @@ ssize_t ZipUtils::inflateMemoryWithHint(unsigned char *in, ssize_t inLength, uns
 ssize_t ZipUtils::inflateMemory(unsigned char *in, ssize_t inLength, unsigned char **out)
 {
     // 256k for hint
-    return inflateMemoryWithHint(in, inLength, out, 256 * 1024);
+    ssize_t outLengthHint = 256 * 1024;
+
+    // a gzip stream ends with its inflated size, modulo 4GB
+    if (isGZipBuffer(in, inLength) && inLength >= 18)
+    {
+        const unsigned char *size = in + inLength - 4;
+        unsigned int inflatedSize = size[0] | (size[1] << 8) | (size[2] << 16) | ((unsigned int)size[3] << 24);
+        if (inflatedSize > 0)
+        {
+            outLengthHint = inflatedSize;
+        }
+    }
+
+    return inflateMemoryWithHint(in, inLength, out, outLengthHint);
+}
+
+ssize_t ZipUtils::inflateMemoryInto(const unsigned char *in, ssize_t inLength, unsigned char *out, ssize_t outLength)
+{
+    InflateStream stream(out, outLength);
+    if (!stream.write(in, inLength) || !stream.isFinished())
+    {
+        return -1;
+    }
+
+    return stream.getLength();
 }
 
 int ZipUtils::inflateGZipFile(const char *path, unsigned char **out)
@@ -320,7 +412,7 @@ int ZipUtils::inflateGZipFile(const char *path, unsigned char **out)
 bool ZipUtils::isCCZFile(const char *path)
 {
     // load file into memory
-    Data compressedData = FileUtils::getInstance()->getDataFromFile(path);
+    FileView compressedData = FileUtils::getInstance()->getFileView(path);
 
     if (compressedData.isNull())
     {
@@ -346,7 +438,7 @@ bool ZipUtils::isCCZBuffer(const unsigned char *buffer, ssize_t len)
 bool ZipUtils::isGZipFile(const char *path)
 {
     // load file into memory
-    Data compressedData = FileUtils::getInstance()->getDataFromFile(path);
+    FileView compressedData = FileUtils::getInstance()->getFileView(path);
 
     if (compressedData.isNull())
     {
@@ -368,45 +460,108 @@ bool ZipUtils::isGZipBuffer(const unsigned char *buffer, ssize_t len)
 }
 
 
-int ZipUtils::inflateCCZBuffer(const unsigned char *buffer, ssize_t bufferLen, unsigned char **out)
+ssize_t ZipUtils::getCCZBufferLength(const unsigned char *buffer, ssize_t len)
 {
-    struct CCZHeader *header = (struct CCZHeader*) buffer;
+    if (!isCCZBuffer(buffer, len))
+    {
+        return -1;
+    }
+
+    const struct CCZHeader *header = (const struct CCZHeader*) buffer;
+    return CC_SWAP_INT32_BIG_TO_HOST( header->len );
+}
 
-    // verify header
-    if( header->sig[0] == 'C' && header->sig[1] == 'C' && header->sig[2] == 'Z' && header->sig[3] == '!' )
+bool ZipUtils::inflateCCZChunks(const unsigned char *buffer, ssize_t len, unsigned char *out, ssize_t outLength)
+{
+    if (static_cast<size_t>(len) < sizeof(struct CCZChunkHeader))
     {
-        // verify header version
-        unsigned int version = CC_SWAP_INT16_BIG_TO_HOST( header->version );
-        if( version > 2 )
+        return false;
+    }
+
+    const struct CCZChunkHeader *chunkHeader = (const struct CCZChunkHeader*) buffer;
+    const ssize_t chunkSize = CC_SWAP_INT32_BIG_TO_HOST( chunkHeader->chunk_size );
+    const unsigned int chunkCount = CC_SWAP_INT32_BIG_TO_HOST( chunkHeader->chunk_count );
+    if (chunkSize == 0 || chunkCount == 0 || (outLength + chunkSize - 1) / chunkSize != chunkCount)
+    {
+        return false;
+    }
+
+    // the chunks follow the table of their compressed sizes
+    const unsigned int *sizes = (const unsigned int*) (buffer + sizeof(*chunkHeader));
+    const ssize_t tableLength = sizeof(*chunkHeader) + chunkCount * sizeof(unsigned int);
+    if (len < tableLength)
+    {
+        return false;
+    }
+
+    std::vector<ssize_t> offsets(chunkCount + 1);
+    offsets[0] = tableLength;
+    for (unsigned int i = 0; i < chunkCount; ++i)
+    {
+        offsets[i + 1] = offsets[i] + CC_SWAP_INT32_BIG_TO_HOST( sizes[i] );
+        if (offsets[i + 1] > len)
         {
-            CCLOG("cocos2d: Unsupported CCZ header format");
-            return -1;
+            return false;
         }
+    }
 
-        // verify compression format
-        if( CC_SWAP_INT16_BIG_TO_HOST(header->compression_type) != CCZ_COMPRESSION_ZLIB )
+    std::atomic<bool> failed(false);
+    auto task = [&](int i) {
+        const ssize_t offset = i * chunkSize;
+        const ssize_t length = std::min(chunkSize, outLength - offset);
+        if (inflateMemoryInto(buffer + offsets[i], offsets[i + 1] - offsets[i], out + offset, length) != length)
         {
-            CCLOG("cocos2d: CCZ Unsupported compression method");
-            return -1;
+            failed = true;
         }
+    };
+
+    if (chunkCount == 1)
+    {
+        task(0);
     }
-    else if( header->sig[0] == 'C' && header->sig[1] == 'C' && header->sig[2] == 'Z' && header->sig[3] == 'p' )
+    else
     {
-        // encrypted ccz file
-        header = (struct CCZHeader*) buffer;
+        WorkerPool::getInstance()->run((int)chunkCount, task);
+    }
 
+    return !failed;
+}
+
+ssize_t ZipUtils::inflateCCZBufferInto(const unsigned char *buffer, ssize_t bufferLen, unsigned char *out, ssize_t outLength)
+{
+    if (!isCCZBuffer(buffer, bufferLen))
+    {
+        CCLOG("cocos2d: Invalid CCZ file");
+        return -1;
+    }
+
+    struct CCZHeader *header = (struct CCZHeader*) buffer;
+    unsigned int version = CC_SWAP_INT16_BIG_TO_HOST( header->version );
+
+    // verify compression format
+    if( CC_SWAP_INT16_BIG_TO_HOST(header->compression_type) != CCZ_COMPRESSION_ZLIB )
+    {
+        CCLOG("cocos2d: CCZ Unsupported compression method");
+        return -1;
+    }
+
+    if( header->sig[3] == '!' )
+    {
         // verify header version
-        unsigned int version = CC_SWAP_INT16_BIG_TO_HOST( header->version );
-        if( version > 0 )
+        if( version > 3 )
         {
             CCLOG("cocos2d: Unsupported CCZ header format");
             return -1;
         }
+    }
+    else
+    {
+        // encrypted ccz file
 
-        // verify compression format
-        if( CC_SWAP_INT16_BIG_TO_HOST(header->compression_type) != CCZ_COMPRESSION_ZLIB )
+        // verify header version
+        if( version > 0 )
         {
-            CCLOG("cocos2d: CCZ Unsupported compression method");
+            CCLOG("cocos2d: Unsupported CCZ header format");
             return -1;
         }
 
@@ -428,14 +583,49 @@ int ZipUtils::inflateCCZBuffer(const unsigned char *buffer, ssize_t bufferLen, u
         }
 #endif
     }
+
+    unsigned int len = CC_SWAP_INT32_BIG_TO_HOST( header->len );
+    if (outLength < len)
+    {
+        CCLOG("cocos2d: CCZ: The buffer is too small for the data");
+        return -1;
+    }
+
+    const unsigned char *source = buffer + sizeof(*header);
+    const ssize_t sourceLen = bufferLen - sizeof(*header);
+
+    if (version == 3)
+    {
+        if (!inflateCCZChunks(source, sourceLen, out, len))
+        {
+            CCLOG("cocos2d: CCZ: Failed to uncompress data");
+            return -1;
+        }
+    }
     else
+    {
+        uLongf destlen = len;
+        int ret = uncompress(out, &destlen, (const Bytef*)source, sourceLen);
+
+        if( ret != Z_OK )
+        {
+            CCLOG("cocos2d: CCZ: Failed to uncompress data");
+            return -1;
+        }
+    }
+
+    return len;
+}
+
+int ZipUtils::inflateCCZBuffer(const unsigned char *buffer, ssize_t bufferLen, unsigned char **out)
+{
+    ssize_t len = getCCZBufferLength(buffer, bufferLen);
+    if (len < 0)
     {
         CCLOG("cocos2d: Invalid CCZ file");
         return -1;
     }
 
-    unsigned int len = CC_SWAP_INT32_BIG_TO_HOST( header->len );
-
     *out = (unsigned char*)malloc( len );
     if(! *out )
     {
@@ -443,19 +633,14 @@ int ZipUtils::inflateCCZBuffer(const unsigned char *buffer, ssize_t bufferLen, u
         return -1;
     }
 
-    unsigned long destlen = len;
-    size_t source = (size_t) buffer + sizeof(*header);
-    int ret = uncompress(*out, &destlen, (Bytef*)source, bufferLen - sizeof(*header) );
-
-    if( ret != Z_OK )
+    if (inflateCCZBufferInto(buffer, bufferLen, *out, len) < 0)
     {
-        CCLOG("cocos2d: CCZ: Failed to uncompress data");
         free( *out );
         *out = nullptr;
         return -1;
     }
 
-    return len;
+    return (int)len;
 }
 
 int ZipUtils::inflateCCZFile(const char *path, unsigned char **out)
@@ -463,7 +648,7 @@ int ZipUtils::inflateCCZFile(const char *path, unsigned char **out)
     CCASSERT(out, "Invalid pointer for buffer!");
 
     // load file into memory
-    Data compressedData = FileUtils::getInstance()->getDataFromFile(path);
+    FileView compressedData = FileUtils::getInstance()->getFileView(path);
 
     if (compressedData.isNull())
     {
@@ -611,10 +796,40 @@ bool ZipFile::fileExists(const std::string &fileName) const
 
 unsigned char *ZipFile::getFileData(const std::string &fileName, ssize_t *size)
 {
-    unsigned char * buffer = nullptr;
     if (size)
         *size = 0;
 
+    ssize_t fileSize = getFileSize(fileName);
+    if (fileSize < 0)
+        return nullptr;
+
+    unsigned char *buffer = (unsigned char*)malloc(fileSize);
+    if (!getFileData(fileName, buffer, fileSize))
+    {
+        free(buffer);
+        return nullptr;
+    }
+
+    if (size)
+    {
+        *size = fileSize;
+    }
+    return buffer;
+}
+
+ssize_t ZipFile::getFileSize(const std::string &fileName) const
+{
+    ZipFilePrivate::FileListContainer::const_iterator it = _data->fileList.find(fileName);
+    if (it == _data->fileList.end())
+        return -1;
+
+    return it->second.uncompressed_size;
+}
+
+bool ZipFile::getFileData(const std::string &fileName, unsigned char *buffer, ssize_t bufferSize)
+{
+    bool ret = false;
+
     do
     {
         CC_BREAK_IF(!_data->zipFile);
@@ -624,6 +839,7 @@ unsigned char *ZipFile::getFileData(const std::string &fileName, ssize_t *size)
         CC_BREAK_IF(it ==  _data->fileList.end());
 
         ZipEntryInfo fileInfo = it->second;
+        CC_BREAK_IF(bufferSize < (ssize_t)fileInfo.uncompressed_size);
 
         int nRet = unzGoToFilePos(_data->zipFile, &fileInfo.pos);
         CC_BREAK_IF(UNZ_OK != nRet);
@@ -631,18 +847,13 @@ unsigned char *ZipFile::getFileData(const std::string &fileName, ssize_t *size)
         nRet = unzOpenCurrentFile(_data->zipFile);
         CC_BREAK_IF(UNZ_OK != nRet);
 
-        buffer = (unsigned char*)malloc(fileInfo.uncompressed_size);
-        int CC_UNUSED nSize = unzReadCurrentFile(_data->zipFile, buffer, static_cast<unsigned int>(fileInfo.uncompressed_size));
-        CCASSERT(nSize == 0 || nSize == (int)fileInfo.uncompressed_size, "the file size is wrong");
-
-        if (size)
-        {
-            *size = fileInfo.uncompressed_size;
-        }
+        int nSize = unzReadCurrentFile(_data->zipFile, buffer, static_cast<unsigned int>(fileInfo.uncompressed_size));
         unzCloseCurrentFile(_data->zipFile);
+
+        ret = nSize == (int)fileInfo.uncompressed_size;
     } while (0);
 
-    return buffer;
+    return ret;
 }
 
 std::string ZipFile::getFirstFilename()
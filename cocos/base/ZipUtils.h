@@ -39,6 +39,9 @@ THE SOFTWARE.
 #include "platform/CCStdC.h"
 #endif
 
+// from zlib.h
+struct z_stream_s;
+
 /**
  * @addtogroup base
  * @{
@@ -60,6 +63,16 @@ typedef struct unz_file_info_s unz_file_info;
         unsigned int    len;                /** Size of the uncompressed file. */
     };
 
+    /** The chunk table that follows the CCZHeader of version 3, its fields are big endian.
+     * It is followed by `chunk_count` compressed sizes, then by the chunks. Each chunk is a zlib stream
+     * that inflates to `chunk_size` bytes, the last one to the rest of CCZHeader::len.
+     * The chunks are independent, ZipUtils inflates them in parallel.
+     */
+    struct CCZChunkHeader {
+        unsigned int    chunk_size;         /** Size of an uncompressed chunk. */
+        unsigned int    chunk_count;        /** Number of chunks. */
+    };
+
     enum {
         CCZ_COMPRESSION_ZLIB,               /** zlib format. */
         CCZ_COMPRESSION_BZIP2,              /** bzip2 format (not supported yet). */
@@ -67,6 +80,38 @@ typedef struct unz_file_info_s unz_file_info;
         CCZ_COMPRESSION_NONE,               /** plain (not supported yet). */
     };
 
+    /**
+     * Inflates zlib or gzip deflated data into a buffer of the caller, as the input comes in.
+     *
+     * The input can be given in as many pieces as needed, e.g. while it is read from a file.
+     * Nothing is allocated for the output: the buffer must hold the whole inflated data.
+     */
+    class CC_DLL InflateStream
+    {
+    public:
+        InflateStream(unsigned char *out, ssize_t outLength);
+        ~InflateStream();
+
+        /**
+         * Inflates the next piece of the input.
+         *
+         * @return False when the data is corrupt or doesn't fit in the output, true otherwise.
+         */
+        bool write(const unsigned char *in, ssize_t inLength);
+
+        /** Whether the end of the deflated stream was reached. */
+        bool isFinished() const { return _finished; }
+
+        /** The number of bytes inflated so far. */
+        ssize_t getLength() const;
+
+    private:
+        ::z_stream_s *_stream;
+        unsigned char *_out;
+        bool _finished;
+        bool _failed;
+    };
+
     class CC_DLL ZipUtils
     {
     public:
@@ -90,6 +135,15 @@ typedef struct unz_file_info_s unz_file_info;
         */
         static ssize_t inflateMemoryWithHint(unsigned char *in, ssize_t inLength, unsigned char **out, ssize_t outLengthHint);
 
+        /**
+         * Inflates either zlib or gzip deflated memory into a buffer of the caller.
+         *
+         * @param outLength The size of `out`, it must hold the whole inflated data.
+         *
+         * @return The length of the inflated data, -1 when the data is corrupt or doesn't fit in `out`.
+         */
+        static ssize_t inflateMemoryInto(const unsigned char *in, ssize_t inLength, unsigned char *out, ssize_t outLength);
+
         /**
          * Inflates a GZip file into memory.
          *
@@ -130,6 +184,23 @@ typedef struct unz_file_info_s unz_file_info;
          */
         static int inflateCCZBuffer(const unsigned char *buffer, ssize_t len, unsigned char **out);
 
+        /**
+         * Gets the size of the data of a CCZ buffer once inflated, from its header.
+         *
+         * @return The inflated length, -1 when the buffer is not in CCZ format.
+         */
+        static ssize_t getCCZBufferLength(const unsigned char *buffer, ssize_t len);
+
+        /**
+         * Inflates a buffer with CCZ format into a buffer of the caller, e.g. the final destination of the data.
+         * The chunks of a CCZ buffer of version 3 are inflated in parallel, see CCZChunkHeader.
+         *
+         * @param outLength The size of `out`, at least getCCZBufferLength().
+         *
+         * @return The length of the inflated data, -1 on error.
+         */
+        static ssize_t inflateCCZBufferInto(const unsigned char *buffer, ssize_t len, unsigned char *out, ssize_t outLength);
+
         /**
          * Test a file is a CCZ format file or not.
          *
@@ -198,6 +269,7 @@ typedef struct unz_file_info_s unz_file_info;
 
     private:
         static int inflateMemoryWithHint(unsigned char *in, ssize_t inLength, unsigned char **out, ssize_t *outLength, ssize_t outLenghtHint);
+        static bool inflateCCZChunks(const unsigned char *buffer, ssize_t len, unsigned char *out, ssize_t outLength);
         static inline void decodeEncodedPvr (unsigned int *data, ssize_t len);
         static inline unsigned int checksumPvr(const unsigned int *data, ssize_t len);
 
@@ -265,6 +337,22 @@ typedef struct unz_file_info_s unz_file_info;
         */
         unsigned char *getFileData(const std::string &fileName, ssize_t *size);
 
+        /**
+        * Get the size of a file of the zip file once decompressed.
+        * @param fileName File name
+        * @return The size of the file, -1 if it is not in the zip file.
+        */
+        ssize_t getFileSize(const std::string &fileName) const;
+
+        /**
+        * Decompress a file of the zip file straight into a buffer of the caller, e.g. its final destination.
+        * @param fileName File name
+        * @param buffer The destination, it must hold getFileSize() bytes.
+        * @param bufferSize The size of `buffer`.
+        * @return true if the whole file was read, false otherwise.
+        */
+        bool getFileData(const std::string &fileName, unsigned char *buffer, ssize_t bufferSize);
+
         std::string getFirstFilename();
         std::string getNextFilename();
 
@@ -27,29 +27,179 @@ THE SOFTWARE.
 #include <stdlib.h>
 #include "base/base64.h"
 
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_IOS) || (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+    #if defined (__arm64__) || defined (__aarch64__) || defined (__ARM_NEON__)
+    #define INCLUDE_NEON
+    #include <arm_neon.h>
+    #endif
+#endif
+
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#define INCLUDE_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace cocos2d {
 
 unsigned char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
-int _base64Decode(const unsigned char *input, unsigned int input_len, unsigned char *output, unsigned int *output_len )
+// the 6 bits of each character of the alphabet, 255 for the other characters
+static const unsigned char decoder[256] = {
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 62, 255, 255, 255, 63,
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 255, 255, 255, 255, 255, 255,
+    255, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 255, 255, 255, 255, 255,
+    255, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+};
+
+#if defined (INCLUDE_NEON)
+
+// the 6 bits of 16 characters, the lanes of `invalid` are set for the characters out of the alphabet
+static inline uint8x16_t decodeCharacters(uint8x16_t c, uint8x16_t& invalid)
+{
+    const uint8x16_t upper = vandq_u8(vcgeq_u8(c, vdupq_n_u8('A')), vcleq_u8(c, vdupq_n_u8('Z')));
+    const uint8x16_t lower = vandq_u8(vcgeq_u8(c, vdupq_n_u8('a')), vcleq_u8(c, vdupq_n_u8('z')));
+    const uint8x16_t digit = vandq_u8(vcgeq_u8(c, vdupq_n_u8('0')), vcleq_u8(c, vdupq_n_u8('9')));
+    const uint8x16_t plus = vceqq_u8(c, vdupq_n_u8('+'));
+    const uint8x16_t slash = vceqq_u8(c, vdupq_n_u8('/'));
+
+    uint8x16_t value = vandq_u8(upper, vsubq_u8(c, vdupq_n_u8('A')));
+    value = vorrq_u8(value, vandq_u8(lower, vsubq_u8(c, vdupq_n_u8('a' - 26))));
+    value = vorrq_u8(value, vandq_u8(digit, vaddq_u8(c, vdupq_n_u8(52 - '0'))));
+    value = vorrq_u8(value, vandq_u8(plus, vdupq_n_u8(62)));
+    value = vorrq_u8(value, vandq_u8(slash, vdupq_n_u8(63)));
+
+    const uint8x16_t valid = vorrq_u8(vorrq_u8(vorrq_u8(upper, lower), vorrq_u8(digit, plus)), slash);
+    invalid = vorrq_u8(invalid, vmvnq_u8(valid));
+    return value;
+}
+
+#elif defined (INCLUDE_SSE2)
+
+// the 6 bits of 16 characters, the lanes of `invalid` are set for the characters out of the alphabet.
+// The characters above 127 are negative in the signed comparisons, and out of all the ranges.
+static inline __m128i decodeCharacters(__m128i c, __m128i& invalid)
+{
+    const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('Z' + 1)));
+    const __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('z' + 1)));
+    const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+    const __m128i plus = _mm_cmpeq_epi8(c, _mm_set1_epi8('+'));
+    const __m128i slash = _mm_cmpeq_epi8(c, _mm_set1_epi8('/'));
+
+    __m128i value = _mm_and_si128(upper, _mm_sub_epi8(c, _mm_set1_epi8('A')));
+    value = _mm_or_si128(value, _mm_and_si128(lower, _mm_sub_epi8(c, _mm_set1_epi8('a' - 26))));
+    value = _mm_or_si128(value, _mm_and_si128(digit, _mm_add_epi8(c, _mm_set1_epi8(52 - '0'))));
+    value = _mm_or_si128(value, _mm_and_si128(plus, _mm_set1_epi8(62)));
+    value = _mm_or_si128(value, _mm_and_si128(slash, _mm_set1_epi8(63)));
+
+    const __m128i valid = _mm_or_si128(_mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, plus)), slash);
+    invalid = _mm_or_si128(invalid, _mm_andnot_si128(valid, _mm_set1_epi8(-1)));
+    return value;
+}
+
+#endif
+
+// Decodes the leading groups of 4 characters of the alphabet, 64 or 16 at a time with NEON or SSE2, then 4 at a
+// time. Stops at the first group with another character, e.g. a line break or '='. Returns the characters decoded.
+static unsigned int decodeGroups(const unsigned char *input, unsigned int input_len, unsigned char *output)
 {
-    static char inalphabet[256], decoder[256];
-    int i, bits, c = 0, char_count, errors = 0;
     unsigned int input_idx = 0;
-    unsigned int output_idx = 0;
 
-    for (i = (sizeof alphabet) - 1; i >= 0 ; i--) {
-        inalphabet[alphabet[i]] = 1;
-        decoder[alphabet[i]] = i;
+#if defined (INCLUDE_NEON)
+    for ( ; input_idx + 64 <= input_len; input_idx += 64) {
+        // the 4 characters of each group go to 4 vectors
+        const uint8x16x4_t chars = vld4q_u8(input + input_idx);
+        uint8x16_t invalid = vdupq_n_u8(0);
+        const uint8x16_t a = decodeCharacters(chars.val[0], invalid);
+        const uint8x16_t b = decodeCharacters(chars.val[1], invalid);
+        const uint8x16_t c = decodeCharacters(chars.val[2], invalid);
+        const uint8x16_t d = decodeCharacters(chars.val[3], invalid);
+
+        const uint8x8_t reduced = vorr_u8(vget_low_u8(invalid), vget_high_u8(invalid));
+        if (vget_lane_u64(vreinterpret_u64_u8(reduced), 0) != 0)
+            break;
+
+        uint8x16x3_t bytes;
+        bytes.val[0] = vorrq_u8(vshlq_n_u8(a, 2), vshrq_n_u8(b, 4));
+        bytes.val[1] = vorrq_u8(vshlq_n_u8(b, 4), vshrq_n_u8(c, 2));
+        bytes.val[2] = vorrq_u8(vshlq_n_u8(c, 6), d);
+        vst3q_u8(output + input_idx / 4 * 3, bytes);
+    }
+#elif defined (INCLUDE_SSE2)
+    for ( ; input_idx + 16 <= input_len; input_idx += 16) {
+        __m128i invalid = _mm_setzero_si128();
+        const __m128i values = decodeCharacters(_mm_loadu_si128((const __m128i*)(input + input_idx)), invalid);
+        if (_mm_movemask_epi8(invalid) != 0)
+            break;
+
+        // 2 characters a and b per 16 bits lane make a << 6 | b, then 2 of those per 32 bits lane make the 24 bits
+        const __m128i pairs = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(values, _mm_set1_epi16(0xff)), 6), _mm_srli_epi16(values, 8));
+        const __m128i groups = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(pairs, _mm_set1_epi32(0xffff)), 12), _mm_srli_epi32(pairs, 16));
+
+        unsigned int words[4];
+        _mm_storeu_si128((__m128i*)words, groups);
+        unsigned char *out = output + input_idx / 4 * 3;
+        for (int i = 0; i < 4; i++) {
+            out[i * 3] = (unsigned char)(words[i] >> 16);
+            out[i * 3 + 1] = (unsigned char)(words[i] >> 8);
+            out[i * 3 + 2] = (unsigned char)words[i];
+        }
+    }
+#endif
+
+    for ( ; input_idx + 4 <= input_len; input_idx += 4) {
+        const unsigned int a = decoder[input[input_idx]];
+        const unsigned int b = decoder[input[input_idx + 1]];
+        const unsigned int c = decoder[input[input_idx + 2]];
+        const unsigned int d = decoder[input[input_idx + 3]];
+        if ((a | b | c | d) == 255)
+            break;
+
+        const unsigned int bits = (a << 18) | (b << 12) | (c << 6) | d;
+        unsigned char *out = output + input_idx / 4 * 3;
+        out[0] = (unsigned char)(bits >> 16);
+        out[1] = (unsigned char)(bits >> 8);
+        out[2] = (unsigned char)bits;
     }
 
+    return input_idx;
+}
+
+int _base64Decode(const unsigned char *input, unsigned int input_len, unsigned char *output, unsigned int *output_len )
+{
+    int bits, c = 0, char_count, errors = 0;
+    unsigned int input_idx = 0;
+    unsigned int output_idx = 0;
+    // the groups aren't tried again before this index once they stopped at a character out of the alphabet
+    unsigned int groups_idx = 0;
+
     char_count = 0;
     bits = 0;
     for( input_idx=0; input_idx < input_len ; input_idx++ ) {
+        if (char_count == 0 && input_idx >= groups_idx) {
+            const unsigned int decoded = decodeGroups(input + input_idx, input_len - input_idx, output + output_idx);
+            input_idx += decoded;
+            output_idx += decoded / 4 * 3;
+            groups_idx = input_idx + 4;
+            if (input_idx >= input_len)
+                break;
+        }
+
         c = input[ input_idx ];
         if (c == '=')
             break;
-        if (c > 255 || ! inalphabet[c])
+        if (decoder[c] == 255)
             continue;
         bits += decoder[c];
         char_count++;
@@ -46,14 +46,29 @@ THE SOFTWARE.
 #define CC_ENABLE_STACKABLE_ACTIONS 1
 #endif
 
+/** @def CC_ENABLE_TWEEN_TABLES
+ * If enabled, the sine, expo and elastic eases of tweenfunc read baked tables with linear interpolation
+ * instead of calling the libm functions, see tweenfunc::setTablesEnabled().
+ * Disabled by default.
+ * @since v3.11
+ */
+#ifndef CC_ENABLE_TWEEN_TABLES
+#define CC_ENABLE_TWEEN_TABLES 0
+#endif
+
 /** @def CC_ENABLE_GL_STATE_CACHE
  * If enabled, cocos2d will maintain an OpenGL state cache internally to avoid unnecessary switches.
  * In order to use them, you have to use the following functions, instead of the GL ones:
  *  - ccGLUseProgram() instead of glUseProgram().
  *  - GL::deleteProgram() instead of glDeleteProgram().
  *  - GL::blendFunc() instead of glBlendFunc().
+ *  - GL::enable(), GL::disable() and GL::isEnabled() instead of glEnable(), glDisable() and glIsEnabled().
+ *  - GL::bindBuffer(), GL::deleteBuffers() and GL::vertexAttribPointer() instead of glBindBuffer(), glDeleteBuffers() and glVertexAttribPointer().
+ *  - GL::depthMask(), GL::depthFunc(), GL::cullFace(), GL::frontFace(), GL::viewport() and GL::scissor().
+ *  - GL::stencilFunc(), GL::stencilOp() and GL::stencilMask().
 
  * If this functionality is disabled, then ccGLUseProgram(), GL::deleteProgram(), GL::blendFunc() will call the GL ones, without using the cache.
+ * Code that calls the GL ones directly must call GL::invalidateStateCache() afterwards.
 
  * It is recommended to enable whenever possible to improve speed.
  * If you are migrating your code from GL ES 1.1, then keep it disabled. Once all your code works as expected, turn it on.
@@ -66,6 +81,20 @@ THE SOFTWARE.
 #define CC_ENABLE_GL_STATE_CACHE 1
 #endif
 
+/** @def CC_GL_STATE_CACHE_VALIDATION
+ * If enabled, the renderer checks the GL state cache against the GL state after each frame, see GL::validateStateCache().
+ * The state is read back with glGet*(), which stalls the pipeline.
+
+ * Default value: Enabled in the debug builds with COCOS2D_DEBUG > 1
+ */
+#ifndef CC_GL_STATE_CACHE_VALIDATION
+#if COCOS2D_DEBUG > 1
+#define CC_GL_STATE_CACHE_VALIDATION 1
+#else
+#define CC_GL_STATE_CACHE_VALIDATION 0
+#endif
+#endif
+
 /** @def CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
  * If enabled, the texture coordinates will be calculated by using this formula:
  * - texCoord.left = (rect.origin.x*2+1) / (texture.wide*2);
@@ -158,13 +187,13 @@ THE SOFTWARE.
  * Apple recommends its usage but they might consume a lot of memory, specially if you use many of them.
  * So for certain cases, where you might need hundreds of VAO objects, it might be a good idea to disable it.
  * To disable it set it to 0. Enabled by default.
+ * On Android the VAOs are only used by GLES3 contexts, GL_OES_vertex_array_object is ignored on GLES2.
  */
 #ifndef CC_TEXTURE_ATLAS_USE_VAO
-    #if (CC_TARGET_PLATFORM == CC_PLATFORM_IOS) || (CC_TARGET_PLATFORM == CC_PLATFORM_MAC)
+    #if (CC_TARGET_PLATFORM == CC_PLATFORM_IOS) || (CC_TARGET_PLATFORM == CC_PLATFORM_MAC) || (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
         #define CC_TEXTURE_ATLAS_USE_VAO 1
     #else
         /* Some Windows display adapter driver cannot support VAO.
-         * Some android devices cannot support VAO very well, so we disable it by default for android platform.
          * Blackberry also doesn't support this feature.
          */
         #define CC_TEXTURE_ATLAS_USE_VAO 0
@@ -172,6 +201,293 @@ THE SOFTWARE.
 #endif
 
 
+/** @def CC_RENDERER_USE_RING_BUFFER
+ * If enabled, the Renderer streams batched quads and triangles straight into a triple-buffered VBO
+ * mapped with glMapBufferRange, instead of copying them into a client side array
+ * and orphaning the VBO on every flush.
+ * It's only used when the GPU supports map_buffer_range, see Renderer::setRingBufferEnabled().
+ * To disable it set it to 0. Enabled by default.
+ */
+#ifndef CC_RENDERER_USE_RING_BUFFER
+#define CC_RENDERER_USE_RING_BUFFER 1
+#endif
+
+/** @def CC_RENDERER_REORDER_WINDOW
+ * The max number of commands a QuadCommand or TrianglesCommand can be moved back
+ * when a render queue reorders its commands by material, see Scene::setCommandReorderEnabled()
+ * and GroupCommand::setReorderEnabled().
+ * Bigger values find more batches but cost more time in RenderQueue::sort(). 64 by default.
+ */
+#ifndef CC_RENDERER_REORDER_WINDOW
+#define CC_RENDERER_REORDER_WINDOW 64
+#endif
+
+/** @def CC_RENDERER_USE_INSTANCING
+ * If enabled, the Renderer draws plain sprite quads with glDrawElementsInstanced:
+ * one unit quad plus a transform, uv and color per sprite, instead of 4 transformed vertices.
+ * It's only used when the GPU supports instanced arrays, see Renderer::setInstancingEnabled().
+ * To enable it set it to 1. Disabled by default.
+ */
+#ifndef CC_RENDERER_USE_INSTANCING
+#define CC_RENDERER_USE_INSTANCING 0
+#endif
+
+/** @def CC_RENDERER_USE_COMPACT_VERTICES
+ * If enabled, the Renderer batches the vertices of the 2D triangles and quads as V2F_C4B_T2US, 16 bytes instead of 24,
+ * when they lie in the z = 0 plane and their uvs are in [0, 1]. See Renderer::setCompactVerticesEnabled().
+ * To enable it set it to 1. Disabled by default.
+ */
+#ifndef CC_RENDERER_USE_COMPACT_VERTICES
+#define CC_RENDERER_USE_COMPACT_VERTICES 0
+#endif
+
+/** @def CC_RENDERER_USE_OPAQUE_PASS
+ * If enabled, the opaque sprites at the back of the 2D render queues are drawn front to back with depth testing
+ * and without blending, before the rest of the queue. See Renderer::setOpaquePassEnabled().
+ * To enable it set it to 1. Disabled by default.
+ */
+#ifndef CC_RENDERER_USE_OPAQUE_PASS
+#define CC_RENDERER_USE_OPAQUE_PASS 0
+#endif
+
+/** @def CC_RENDERER_BATCH_ACROSS_GROUPS
+ * If enabled, the Renderer goes on with the current batch across the group commands of ClippingNode, RenderTexture
+ * or NodeGrid, it only breaks when the render state of the group differs. See Renderer::setGroupBatchingEnabled().
+ * To disable it set it to 0. Enabled by default.
+ */
+#ifndef CC_RENDERER_BATCH_ACROSS_GROUPS
+#define CC_RENDERER_BATCH_ACROSS_GROUPS 1
+#endif
+
+/** @def CC_RENDERER_USE_MULTI_TEXTURE
+ * If enabled, the Renderer batches the sprites of up to CC_RENDERER_MAX_BATCH_TEXTURES textures together:
+ * each vertex carries the unit of its texture, so a batch only breaks on a blend change or when the units run out.
+ * See Renderer::setMultiTextureBatchingEnabled().
+ * To enable it set it to 1. Disabled by default.
+ */
+#ifndef CC_RENDERER_USE_MULTI_TEXTURE
+#define CC_RENDERER_USE_MULTI_TEXTURE 0
+#endif
+
+/** @def CC_RENDERER_MAX_BATCH_TEXTURES
+ * The max number of textures a multi texture batch binds, at most 8 which is the number of samplers
+ * of its shader. Less are used when the GPU has less texture units. 8 by default.
+ */
+#ifndef CC_RENDERER_MAX_BATCH_TEXTURES
+#define CC_RENDERER_MAX_BATCH_TEXTURES 8
+#endif
+
+/** @def CC_PARTICLE_PARALLEL_UPDATE
+ * If enabled, the particle systems of a frame are updated together on the WorkerPool
+ * instead of one by one in their scheduled update, see ParticleSystem::setParallelUpdateEnabled().
+ * To enable it set it to 1. Disabled by default.
+ */
+#ifndef CC_PARTICLE_PARALLEL_UPDATE
+#define CC_PARTICLE_PARALLEL_UPDATE 0
+#endif
+
+/** @def CC_LABEL_PARALLEL_LAYOUT
+ * If enabled, the labels laid out in a frame are laid out together on the JobSystem
+ * instead of one by one in their visit, see Label::setParallelLayoutEnabled().
+ * To enable it set it to 1. Disabled by default.
+ */
+#ifndef CC_LABEL_PARALLEL_LAYOUT
+#define CC_LABEL_PARALLEL_LAYOUT 0
+#endif
+
+/** @def CC_LABEL_SINGLE_PASS_EFFECTS
+ * If enabled, the outline and the shadow of the TTF labels are drawn with their text in one command,
+ * see Label::setSinglePassEffectsEnabled().
+ * To disable it set it to 0. Enabled by default.
+ */
+#ifndef CC_LABEL_SINGLE_PASS_EFFECTS
+#define CC_LABEL_SINGLE_PASS_EFFECTS 1
+#endif
+
+/** @def CC_SCHEDULER_DEFERRED_TASK_BUDGET
+ * The milliseconds the tasks queued by Scheduler::performDeferredTask() may take per frame,
+ * the remaining ones are carried over to the next frames. 4 by default, 0 runs them all every frame.
+ */
+#ifndef CC_SCHEDULER_DEFERRED_TASK_BUDGET
+#define CC_SCHEDULER_DEFERRED_TASK_BUDGET 4
+#endif
+
+/** @def CC_SCHEDULER_MAX_FIXED_STEPS
+ * The most fixed steps Scheduler::update() runs per frame with Scheduler::setFixedTimeStep(),
+ * the time of the steps over it is dropped so a slow frame doesn't make the next ones slower. 5 by default.
+ */
+#ifndef CC_SCHEDULER_MAX_FIXED_STEPS
+#define CC_SCHEDULER_MAX_FIXED_STEPS 5
+#endif
+
+/** @def CC_FONT_ATLAS_ASYNC_RASTERIZATION
+ * If enabled, the new glyphs of the TTF labels are rasterized on the AsyncTaskPool and shown a few frames later,
+ * instead of stalling the frame that needs them, see FontAtlas::setAsyncRasterizationEnabled().
+ * To enable it set it to 1. Disabled by default.
+ */
+#ifndef CC_FONT_ATLAS_ASYNC_RASTERIZATION
+#define CC_FONT_ATLAS_ASYNC_RASTERIZATION 0
+#endif
+
+/** @def CC_LABEL_LAYOUT_CACHE_SIZE
+ * The number of text layouts the labels share, the most recently used ones are kept, see LabelLayoutCache.
+ * Set it to 0 to lay out every label on its own. 256 by default.
+ */
+#ifndef CC_LABEL_LAYOUT_CACHE_SIZE
+#define CC_LABEL_LAYOUT_CACHE_SIZE 256
+#endif
+
+/** @def CC_SYSTEM_FONT_CACHE_SIZE
+ * The number of system font renderings the labels share, the most recently used ones are kept, see SystemFontTextureCache.
+ * Set it to 0 to render every system font label into its own texture. 128 by default.
+ */
+#ifndef CC_SYSTEM_FONT_CACHE_SIZE
+#define CC_SYSTEM_FONT_CACHE_SIZE 128
+#endif
+
+/** @def CC_DYNAMIC_ATLAS_PAGE_SIZE
+ * The width and height in pixels of the pages DynamicAtlas packs the images into. 1024 by default.
+ */
+#ifndef CC_DYNAMIC_ATLAS_PAGE_SIZE
+#define CC_DYNAMIC_ATLAS_PAGE_SIZE 1024
+#endif
+
+/** @def CC_DYNAMIC_ATLAS_MAX_PAGES
+ * The max number of pages of DynamicAtlas, the images that don't fit get a texture of their own. 4 by default.
+ */
+#ifndef CC_DYNAMIC_ATLAS_MAX_PAGES
+#define CC_DYNAMIC_ATLAS_MAX_PAGES 4
+#endif
+
+/** @def CC_JOB_SYSTEM_MAX_THREADS
+ * The max number of workers of the JobSystem, it starts one per core but the one of the main thread.
+ * 8 by default.
+ */
+#ifndef CC_JOB_SYSTEM_MAX_THREADS
+#define CC_JOB_SYSTEM_MAX_THREADS 8
+#endif
+
+/** @def CC_WORKER_POOL_MAX_THREADS
+ * The max number of threads of the WorkerPool, the thread that waits for the tasks included.
+ * The pool runs its tasks on the JobSystem with up to this number of threads, see Node::setParallelVisitEnabled().
+ * Big.LITTLE devices usually don't gain anything past their number of big cores. 4 by default.
+ */
+#ifndef CC_WORKER_POOL_MAX_THREADS
+#define CC_WORKER_POOL_MAX_THREADS 4
+#endif
+
+/** @def CC_ENABLE_FAST_ACTIONS
+ * If enabled, the ActionManager runs MoveTo, MoveBy, ScaleTo, ScaleBy, FadeTo, FadeIn, FadeOut, RotateTo and
+ * RotateBy, alone or in a tweenfunc ease action, from contiguous arrays instead of stepping them one by one.
+ * The actions keep working with the Action and Node interfaces. Subclasses of them are stepped like the other actions.
+ * Enabled by default.
+ */
+#ifndef CC_ENABLE_FAST_ACTIONS
+#define CC_ENABLE_FAST_ACTIONS 1
+#endif
+
+/** @def CC_ENABLE_ACTION_POOL
+ * If enabled, the actions of CCActionInterval.h and CCActionInstant.h reuse the memory of the released ones
+ * of their class instead of allocating, see ActionPool. Enabled by default.
+ */
+#ifndef CC_ENABLE_ACTION_POOL
+#define CC_ENABLE_ACTION_POOL 1
+#endif
+
+/** @def CC_ACTION_POOL_CAPACITY
+ * The max number of released actions ActionPool keeps per class. 256 by default.
+ */
+#ifndef CC_ACTION_POOL_CAPACITY
+#define CC_ACTION_POOL_CAPACITY 256
+#endif
+
+/** @def CC_ENABLE_REF_ALLOCATOR
+ * If enabled, the Refs are allocated by RefAllocator: the memory of the released ones goes to free lists of their
+ * size class on the releasing thread instead of back to malloc, the next Refs of the class reuse it.
+ * Disabled by default.
+ */
+#ifndef CC_ENABLE_REF_ALLOCATOR
+#define CC_ENABLE_REF_ALLOCATOR 0
+#endif
+
+/** @def CC_REF_ALLOCATOR_MAX_SIZE
+ * The size in bytes of the largest objects RefAllocator keeps in free lists, the larger ones are allocated as usual.
+ * 1024 by default.
+ */
+#ifndef CC_REF_ALLOCATOR_MAX_SIZE
+#define CC_REF_ALLOCATOR_MAX_SIZE 1024
+#endif
+
+/** @def CC_REF_ALLOCATOR_CAPACITY
+ * The max number of released objects RefAllocator keeps per size class and thread. 512 by default.
+ */
+#ifndef CC_REF_ALLOCATOR_CAPACITY
+#define CC_REF_ALLOCATOR_CAPACITY 512
+#endif
+
+/** @def CC_MEMORY_PRESSURE_COOLDOWN
+ * The seconds during which MemoryPressure::signal() ignores the levels that aren't higher than the one it handled.
+ * 5 by default.
+ */
+#ifndef CC_MEMORY_PRESSURE_COOLDOWN
+#define CC_MEMORY_PRESSURE_COOLDOWN 5
+#endif
+
+/** @def CC_ENABLE_ALLOCATION_PROFILER
+ * If enabled, AllocationProfiler can count the Refs created per frame by class, and the allocations of the heavy
+ * engine sites: the std::function copies of the Scheduler and of the event listeners, Value and StringUtils::format().
+ * It costs a branch per site and per Ref while not recording. Disabled by default.
+ */
+#ifndef CC_ENABLE_ALLOCATION_PROFILER
+#define CC_ENABLE_ALLOCATION_PROFILER 0
+#endif
+
+/** @def CC_ASYNC_TASK_POOL_MAX_CALLBACKS_PER_FRAME
+ * The max number of AsyncTaskPool callbacks called per frame, the others wait for the next frames.
+ * 0 means no limit, see AsyncTaskPool::setMaxCallbacksPerFrame(). 0 by default.
+ */
+#ifndef CC_ASYNC_TASK_POOL_MAX_CALLBACKS_PER_FRAME
+#define CC_ASYNC_TASK_POOL_MAX_CALLBACKS_PER_FRAME 0
+#endif
+
+/** @def CC_VOLATILE_TEXTURE_RESIDENT_SIZE
+ * The bytes of compressed image files that VolatileTextureMgr keeps in memory with CC_ENABLE_CACHE_TEXTURE_DATA,
+ * to reload them without reading them when the GL context is recreated. 16 MB by default.
+ */
+#ifndef CC_VOLATILE_TEXTURE_RESIDENT_SIZE
+#define CC_VOLATILE_TEXTURE_RESIDENT_SIZE (16 * 1024 * 1024)
+#endif
+
+/** @def CC_TEXTURE_CACHE_MAX_ASYNC_THREADS
+ * The max number of threads that decode the images of TextureCache::addImageAsync() in parallel.
+ * The cache uses one thread per core but one, up to this number, see TextureCache::setAsyncThreadCount(). 4 by default.
+ */
+#ifndef CC_TEXTURE_CACHE_MAX_ASYNC_THREADS
+#define CC_TEXTURE_CACHE_MAX_ASYNC_THREADS 4
+#endif
+
+/** @def CC_ENABLE_FILE_WATCHER
+ * If enabled, FileWatcher watches directories for the files that change and reloads the textures, sprite frames and
+ * fonts they back in place, to iterate on the content without relaunching. It uses FSEvents on mac and
+ * ReadDirectoryChangesW on win32. Enabled by default in the debug builds of mac and win32.
+ */
+#ifndef CC_ENABLE_FILE_WATCHER
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_MAC || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32) && defined(COCOS2D_DEBUG) && COCOS2D_DEBUG > 0
+#define CC_ENABLE_FILE_WATCHER 1
+#else
+#define CC_ENABLE_FILE_WATCHER 0
+#endif
+#endif
+
+/** @def CC_ENABLE_SCRIPT_OBJECT_REMOVER
+ * If enabled, a Ref tells the script binding set with Ref::setScriptObjectRemover() when it's destroyed,
+ * so the binding drops the script proxy of the Ref. Enabled by default.
+ * It's separate from CC_ENABLE_SCRIPT_BINDING, which guards the script engine hooks this lite engine doesn't ship.
+ */
+#ifndef CC_ENABLE_SCRIPT_OBJECT_REMOVER
+#define CC_ENABLE_SCRIPT_OBJECT_REMOVER 1
+#endif
+
 /** @def CC_USE_LA88_LABELS
  * If enabled, it will use LA88 (Luminance Alpha 16-bit textures) for LabelTTF objects.
  * If it is disabled, it will use A8 (Alpha 8-bit textures).
@@ -253,6 +569,23 @@ THE SOFTWARE.
 #define CC_ENABLE_PROFILERS 0
 #endif
 
+/** @def CC_ENABLE_TRACING
+ * If enabled, the CC_TRACE_ZONE() scopes of the engine and the game are compiled in, see Tracer.
+ * A zone costs an atomic load while the Tracer doesn't record, so it can stay enabled in release builds
+ * to capture traces in the field. To disable set it to 0. Enabled by default.
+ */
+#ifndef CC_ENABLE_TRACING
+#define CC_ENABLE_TRACING 1
+#endif
+
+/** @def CC_TRACE_EVENTS_PER_THREAD
+ * The number of zones a thread can record between Tracer::start() and Tracer::stop(), the next ones are dropped.
+ * Each zone takes 24 bytes, the buffer of a thread is allocated the first time it records. 65536 by default.
+ */
+#ifndef CC_TRACE_EVENTS_PER_THREAD
+#define CC_TRACE_EVENTS_PER_THREAD 65536
+#endif
+
 /** Enable Lua engine debug log. */
 #ifndef CC_LUA_ENGINE_DEBUG
 #define CC_LUA_ENGINE_DEBUG 0
@@ -300,6 +633,17 @@ THE SOFTWARE.
 #endif
 #endif // CC_USE_WIC
 
+/** Support the image decoders of the platform or not: ImageIO on iOS and Mac, AImageDecoder on Android.
+ They can decode PNG and JPEG instead of libpng and libjpeg, see Image::setDecoder().
+ */
+#ifndef CC_USE_PLATFORM_IMAGE_DECODER
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_IOS || CC_TARGET_PLATFORM == CC_PLATFORM_MAC || CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+#define CC_USE_PLATFORM_IMAGE_DECODER  1
+#else
+#define CC_USE_PLATFORM_IMAGE_DECODER  0
+#endif
+#endif // CC_USE_PLATFORM_IMAGE_DECODER
+
 /** @def CC_CONSTRUCTOR_ACCESS
  * Indicate the init functions access modifier. If value equals to protected, then these functions are protected.
  * If value equals to public, these functions are public,
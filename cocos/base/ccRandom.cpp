@@ -25,9 +25,175 @@ THE SOFTWARE.
 
 #include "ccRandom.h"
 
-std::mt19937 &cocos2d::RandomHelper::getEngine() {
-    static std::random_device seed_gen;
-    static std::mt19937 engine(seed_gen());
-    return engine;
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+NS_CC_BEGIN
+
+// spreads a seed over the state, see http://xoshiro.di.unimi.it/splitmix64.c
+static uint64_t splitMix64(uint64_t& x)
+{
+    uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+RandomGenerator::RandomGenerator()
+{
+    std::random_device device;
+    seed(((uint64_t)device() << 32) | device());
+}
+
+RandomGenerator::RandomGenerator(uint64_t seed)
+{
+    this->seed(seed);
+}
+
+void RandomGenerator::seed(uint64_t seed)
+{
+    for (int i = 0; i < 4; i += 2)
+    {
+        uint64_t value = splitMix64(seed);
+        _state[i] = (uint32_t)value;
+        _state[i + 1] = (uint32_t)(value >> 32);
+    }
+    for (int word = 0; word < 4; ++word)
+    {
+        for (int lane = 0; lane < 4; lane += 2)
+        {
+            uint64_t value = splitMix64(seed);
+            _lanes[word][lane] = (uint32_t)value;
+            _lanes[word][lane + 1] = (uint32_t)(value >> 32);
+        }
+    }
+}
+
+uint64_t RandomGenerator::nextBounded(uint64_t max)
+{
+    if (max == UINT64_MAX)
+    {
+        return next64();
+    }
+    if (max == UINT32_MAX)
+    {
+        return next();
+    }
+
+    if (max < UINT32_MAX)
+    {
+        // Lemire's multiply and shift, the products below the threshold would make the low values more likely
+        uint32_t range = (uint32_t)max + 1;
+        uint64_t product = (uint64_t)next() * range;
+        if ((uint32_t)product < range)
+        {
+            uint32_t threshold = (0u - range) % range;
+            while ((uint32_t)product < threshold)
+            {
+                product = (uint64_t)next() * range;
+            }
+        }
+        return product >> 32;
+    }
+
+    uint64_t range = max + 1;
+    uint64_t threshold = (0ULL - range) % range;
+    uint64_t value = next64();
+    while (value < threshold)
+    {
+        value = next64();
+    }
+    return value % range;
+}
+
+void RandomGenerator::fill(float* values, size_t count, float min, float max)
+{
+    // 24 random bits to a float in [min, max)
+    float scale = (max - min) * (1.0f / 16777216.0f);
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    __m128i s0 = _mm_loadu_si128((const __m128i*)_lanes[0]);
+    __m128i s1 = _mm_loadu_si128((const __m128i*)_lanes[1]);
+    __m128i s2 = _mm_loadu_si128((const __m128i*)_lanes[2]);
+    __m128i s3 = _mm_loadu_si128((const __m128i*)_lanes[3]);
+    __m128 vmin = _mm_set1_ps(min);
+    __m128 vscale = _mm_set1_ps(scale);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i result = _mm_add_epi32(s0, s3);
+        __m128i t = _mm_slli_epi32(s1, 9);
+        s2 = _mm_xor_si128(s2, s0);
+        s3 = _mm_xor_si128(s3, s1);
+        s1 = _mm_xor_si128(s1, s2);
+        s0 = _mm_xor_si128(s0, s3);
+        s2 = _mm_xor_si128(s2, t);
+        s3 = _mm_or_si128(_mm_slli_epi32(s3, 11), _mm_srli_epi32(s3, 21));
+
+        __m128 unit = _mm_cvtepi32_ps(_mm_srli_epi32(result, 8));
+        _mm_storeu_ps(values + i, _mm_add_ps(vmin, _mm_mul_ps(unit, vscale)));
+    }
+    _mm_storeu_si128((__m128i*)_lanes[0], s0);
+    _mm_storeu_si128((__m128i*)_lanes[1], s1);
+    _mm_storeu_si128((__m128i*)_lanes[2], s2);
+    _mm_storeu_si128((__m128i*)_lanes[3], s3);
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+    uint32x4_t s0 = vld1q_u32(_lanes[0]);
+    uint32x4_t s1 = vld1q_u32(_lanes[1]);
+    uint32x4_t s2 = vld1q_u32(_lanes[2]);
+    uint32x4_t s3 = vld1q_u32(_lanes[3]);
+    float32x4_t vmin = vdupq_n_f32(min);
+    for (; i + 4 <= count; i += 4)
+    {
+        uint32x4_t result = vaddq_u32(s0, s3);
+        uint32x4_t t = vshlq_n_u32(s1, 9);
+        s2 = veorq_u32(s2, s0);
+        s3 = veorq_u32(s3, s1);
+        s1 = veorq_u32(s1, s2);
+        s0 = veorq_u32(s0, s3);
+        s2 = veorq_u32(s2, t);
+        s3 = vsriq_n_u32(vshlq_n_u32(s3, 11), s3, 21);
+
+        float32x4_t unit = vcvtq_f32_u32(vshrq_n_u32(result, 8));
+        vst1q_f32(values + i, vaddq_f32(vmin, vmulq_n_f32(unit, scale)));
+    }
+    vst1q_u32(_lanes[0], s0);
+    vst1q_u32(_lanes[1], s1);
+    vst1q_u32(_lanes[2], s2);
+    vst1q_u32(_lanes[3], s3);
+#endif
+
+    // the values left, or all of them without SIMD: the four lanes step together, the extra values are dropped
+    for (; i < count; i += 4)
+    {
+        float group[4];
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            uint32_t result = _lanes[0][lane] + _lanes[3][lane];
+            uint32_t t = _lanes[1][lane] << 9;
+            _lanes[2][lane] ^= _lanes[0][lane];
+            _lanes[3][lane] ^= _lanes[1][lane];
+            _lanes[1][lane] ^= _lanes[2][lane];
+            _lanes[0][lane] ^= _lanes[3][lane];
+            _lanes[2][lane] ^= t;
+            _lanes[3][lane] = rotl(_lanes[3][lane], 11);
+
+            group[lane] = min + (float)(result >> 8) * scale;
+        }
+        for (size_t lane = 0; lane < 4 && i + lane < count; ++lane)
+        {
+            values[i + lane] = group[lane];
+        }
+    }
+}
+
+RandomGenerator& RandomGenerator::getInstance()
+{
+    static thread_local RandomGenerator s_generator;
+    return s_generator;
 }
 
+NS_CC_END
@@ -295,6 +295,23 @@ struct CC_DLL V3F_C4B_T2F
     Tex2F        texCoords;           // 8 bytes
 };
 
+/** @struct V2F_C4B_T2US
+ * The compact vertex of the Renderer batches: a 2D point, a color 4B and a tex coord point normalized to unsigned shorts,
+ * 16 bytes instead of the 24 of V3F_C4B_T2F. See Renderer::setCompactVerticesEnabled().
+ * @since v3.11
+ */
+struct CC_DLL V2F_C4B_T2US
+{
+    /// vertices (2F)
+    Vec2         vertices;            // 8 bytes
+
+    /// colors (4B)
+    Color4B      colors;              // 4 bytes
+
+    /// tex coords (2US), 0 to 65535 for 0 to 1
+    GLushort     texCoords[2];        // 4 bytes
+};
+
 /** @struct V3F_T2F
  * A Vec2 with a vertex point, a tex coord point.
  */
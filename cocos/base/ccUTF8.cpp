@@ -28,6 +28,18 @@
 #include "base/CCConsole.h"
 #include "ConvertUTF/ConvertUTF.h"
 
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_IOS) || (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+    #if defined (__arm64__) || defined (__aarch64__) || defined (__ARM_NEON__)
+    #define INCLUDE_NEON
+    #include <arm_neon.h>
+    #endif
+#endif
+
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#define INCLUDE_SSE2
+#include <emmintrin.h>
+#endif
+
 NS_CC_BEGIN
 
 namespace StringUtils {
@@ -116,6 +128,59 @@ void trimUTF16Vector(std::vector<char16_t>& str)
     }
 }
 
+// Gets the number of leading ASCII characters, 16 or 8 at a time.
+static size_t getASCIIPrefixLength(const char* utf8, size_t length)
+{
+    size_t i = 0;
+#if defined (INCLUDE_NEON)
+    for ( ; i + 16 <= length; i += 16)
+    {
+        const uint8x16_t chars = vld1q_u8(reinterpret_cast<const uint8_t*>(utf8 + i));
+        const uint8x8_t reduced = vorr_u8(vget_low_u8(chars), vget_high_u8(chars));
+        if (vget_lane_u64(vreinterpret_u64_u8(reduced), 0) & 0x8080808080808080ULL)
+            break;
+    }
+#elif defined (INCLUDE_SSE2)
+    for ( ; i + 16 <= length; i += 16)
+    {
+        if (_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(utf8 + i))) != 0)
+            break;
+    }
+#endif
+    while (i < length && static_cast<unsigned char>(utf8[i]) < 0x80)
+    {
+        ++i;
+    }
+    return i;
+}
+
+static size_t getASCIIPrefixLength(const char16_t* utf16, size_t length)
+{
+    size_t i = 0;
+#if defined (INCLUDE_NEON)
+    for ( ; i + 8 <= length; i += 8)
+    {
+        const uint16x8_t chars = vld1q_u16(reinterpret_cast<const uint16_t*>(utf16 + i));
+        const uint16x4_t reduced = vorr_u16(vget_low_u16(chars), vget_high_u16(chars));
+        if (vget_lane_u64(vreinterpret_u64_u16(reduced), 0) & 0xff80ff80ff80ff80ULL)
+            break;
+    }
+#elif defined (INCLUDE_SSE2)
+    for ( ; i + 8 <= length; i += 8)
+    {
+        const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf16 + i));
+        const __m128i high = _mm_and_si128(chars, _mm_set1_epi16((short)0xff80));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())) != 0xffff)
+            break;
+    }
+#endif
+    while (i < length && utf16[i] < 0x80)
+    {
+        ++i;
+    }
+    return i;
+}
+
 bool UTF8ToUTF16(const std::string& utf8, std::u16string& outUtf16)
 {
     if (utf8.empty())
@@ -124,24 +189,38 @@ bool UTF8ToUTF16(const std::string& utf8, std::u16string& outUtf16)
         return true;
     }
 
-    bool ret = false;
-
-    const size_t utf16Bytes = (utf8.length()+1) * sizeof(char16_t);
-    char16_t* utf16 = (char16_t*)malloc(utf16Bytes);
-    memset(utf16, 0, utf16Bytes);
+    // a UTF-8 string has at least as many bytes as its UTF-16 version has units
+    const size_t length = utf8.length();
+    std::u16string utf16(length, 0);
 
-    char* utf16ptr = reinterpret_cast<char*>(utf16);
-    const UTF8* error = nullptr;
+    // the ASCII characters are widened as they are, the rest is decoded
+    const size_t asciiLength = getASCIIPrefixLength(utf8.data(), length);
+    for (size_t i = 0; i < asciiLength; ++i)
+    {
+        utf16[i] = static_cast<unsigned char>(utf8[i]);
+    }
 
-    if (llvm::ConvertUTF8toWide(2, utf8, utf16ptr, error))
+    if (asciiLength < length)
     {
-        outUtf16 = utf16;
-        ret = true;
+        const UTF8* source = reinterpret_cast<const UTF8*>(utf8.data()) + asciiLength;
+        UTF16* target = reinterpret_cast<UTF16*>(&utf16[0]) + asciiLength;
+        UTF16* targetStart = reinterpret_cast<UTF16*>(&utf16[0]);
+        if (ConvertUTF8toUTF16(&source, source + (length - asciiLength), &target, targetStart + length, strictConversion) != conversionOK)
+        {
+            return false;
+        }
+        utf16.resize(target - targetStart);
     }
 
-    free(utf16);
+    // like the previous conversion through a C string, the string ends at the first null character
+    const size_t end = utf16.find(u'\0');
+    if (end != std::u16string::npos)
+    {
+        utf16.resize(end);
+    }
 
-    return ret;
+    outUtf16.swap(utf16);
+    return true;
 }
 
 bool UTF16ToUTF8(const std::u16string& utf16, std::string& outUtf8)
@@ -152,7 +231,37 @@ bool UTF16ToUTF8(const std::u16string& utf16, std::string& outUtf8)
         return true;
     }
 
-    return llvm::convertUTF16ToUTF8String(utf16, outUtf8);
+    // a string that starts with a byte order mark is byte swapped by the full conversion
+    const size_t length = utf16.length();
+    const size_t asciiLength = getASCIIPrefixLength(utf16.data(), length);
+    if (asciiLength == 0)
+    {
+        return llvm::convertUTF16ToUTF8String(utf16, outUtf8);
+    }
+
+    // the ASCII characters are narrowed as they are, the rest takes up to 3 bytes per unit
+    std::string utf8(asciiLength + (length - asciiLength) * 3, 0);
+    for (size_t i = 0; i < asciiLength; ++i)
+    {
+        utf8[i] = static_cast<char>(utf16[i]);
+    }
+
+    size_t utf8Length = asciiLength;
+    if (asciiLength < length)
+    {
+        const UTF16* source = reinterpret_cast<const UTF16*>(utf16.data()) + asciiLength;
+        UTF8* targetStart = reinterpret_cast<UTF8*>(&utf8[0]);
+        UTF8* target = targetStart + asciiLength;
+        if (ConvertUTF16toUTF8(&source, source + (length - asciiLength), &target, targetStart + utf8.length(), strictConversion) != conversionOK)
+        {
+            return false;
+        }
+        utf8Length = target - targetStart;
+    }
+    utf8.resize(utf8Length);
+
+    outUtf8.swap(utf8);
+    return true;
 }
 
 std::vector<char16_t> getChar16VectorFromUTF16String(const std::u16string& utf16)
@@ -29,10 +29,15 @@ THE SOFTWARE.
 
 #include "base/CCDirector.h"
 #include "base/CCAsyncTaskPool.h"
+#include "base/CCConfiguration.h"
+#include "base/CCData.h"
 #include "base/CCEventDispatcher.h"
+#include "base/CCJobSystem.h"
+#include "base/CCScheduler.h"
 #include "base/base64.h"
 #include "renderer/CCCustomCommand.h"
 #include "renderer/CCRenderer.h"
+#include "renderer/ccGLStateCache.h"
 #include "platform/CCImage.h"
 #include "platform/CCFileUtils.h"
 #include "2d/CCSprite.h"
@@ -52,119 +57,363 @@ int ccNextPOT(int x)
 
 namespace utils
 {
-/**
-* Capture screen implementation, don't use it directly.
-*/
-void onCaptureScreen(const std::function<void(bool, const std::string&)>& afterCaptured, const std::string& filename)
+// the frames a pixel buffer is left to the GPU before it is mapped, when there is no fence to poll
+static const unsigned int CAPTURE_READBACK_FRAMES = 2;
+
+struct ScreenCapture
 {
-    static bool startedCapture = false;
+    std::function<void(bool, const std::string&, const Data&)> callback;
+    // empty when the encoded bytes are returned instead
+    std::string outputFile;
+    std::string extension;
+    float scale;
+    int width;
+    int height;
+    unsigned int frames;
+    GLuint pbo;
+#if CC_GL_SYNC_OBJECTS
+    GLsync fence;
+#endif
+    GLubyte* pixels;
+    bool succeed;
+    Data encoded;
+
+    ScreenCapture()
+    : scale(1.0f)
+    , width(0)
+    , height(0)
+    , frames(0)
+    , pbo(0)
+#if CC_GL_SYNC_OBJECTS
+    , fence(nullptr)
+#endif
+    , pixels(nullptr)
+    , succeed(false)
+    {
+    }
 
-    if (startedCapture)
+    ~ScreenCapture()
     {
-        CCLOG("Screen capture is already working");
-        if (afterCaptured)
-        {
-            afterCaptured(false, filename);
-        }
-        return;
+        CC_SAFE_DELETE_ARRAY(pixels);
     }
-    else
+};
+
+static std::vector<ScreenCapture*> s_screenCaptures;
+static EventListenerCustom* s_captureScreenListener;
+static CustomCommand s_captureScreenCommand;
+
+/*
+ * Scales the pixels down with a box filter and flips them, on the workers of the JobSystem
+ */
+static GLubyte* scaleAndFlipCapture(const ScreenCapture* capture, int* outWidth, int* outHeight)
+{
+    const int width = capture->width;
+    const int height = capture->height;
+    const int dstWidth = std::max(1, static_cast<int>(width * capture->scale));
+    const int dstHeight = std::max(1, static_cast<int>(height * capture->scale));
+
+    GLubyte* dst = new (std::nothrow) GLubyte[dstWidth * dstHeight * 4];
+    if (nullptr == dst)
     {
-        startedCapture = true;
+        return nullptr;
     }
 
+    const GLubyte* src = capture->pixels;
+    JobSystem::getInstance()->parallelFor(0, dstHeight, [=](int row) {
+        // the rows of the framebuffer start at the bottom
+        GLubyte* out = dst + (dstHeight - row - 1) * dstWidth * 4;
+        if (dstWidth == width && dstHeight == height)
+        {
+            memcpy(out, src + row * width * 4, width * 4);
+            return;
+        }
 
-    auto glView = Director::DirectorInstance->getOpenGLView();
-    auto frameSize = glView->getFrameSize();
-#if (CC_TARGET_PLATFORM == CC_PLATFORM_MAC) || (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32) || (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
-    frameSize = frameSize * glView->getFrameZoomFactor() * glView->getRetinaFactor();
-#endif
+        int y0 = row * height / dstHeight;
+        int y1 = std::max(y0 + 1, (row + 1) * height / dstHeight);
+        for (int column = 0; column < dstWidth; ++column)
+        {
+            int x0 = column * width / dstWidth;
+            int x1 = std::max(x0 + 1, (column + 1) * width / dstWidth);
+            unsigned int sum[4] = { 0, 0, 0, 0 };
+            for (int y = y0; y < y1; ++y)
+            {
+                const GLubyte* pixel = src + (y * width + x0) * 4;
+                for (int x = x0; x < x1; ++x, pixel += 4)
+                {
+                    sum[0] += pixel[0];
+                    sum[1] += pixel[1];
+                    sum[2] += pixel[2];
+                    sum[3] += pixel[3];
+                }
+            }
+            unsigned int count = (y1 - y0) * (x1 - x0);
+            for (int i = 0; i < 4; ++i)
+            {
+                out[column * 4 + i] = static_cast<GLubyte>(sum[i] / count);
+            }
+        }
+    });
+
+    *outWidth = dstWidth;
+    *outHeight = dstHeight;
+    return dst;
+}
 
-    int width = static_cast<int>(frameSize.width);
-    int height = static_cast<int>(frameSize.height);
+static bool readWholeFile(const std::string& path, Data* data)
+{
+    FILE* fp = fopen(FileUtils::getInstance()->getSuitableFOpen(path).c_str(), "rb");
+    if (nullptr == fp)
+    {
+        return false;
+    }
 
-    bool succeed = false;
-    std::string outputFile = "";
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    bool ret = false;
+    unsigned char* bytes = size > 0 ? static_cast<unsigned char*>(malloc(size)) : nullptr;
+    if (bytes && fread(bytes, 1, size, fp) == (size_t)size)
+    {
+        data->fastSet(bytes, size);
+        ret = true;
+    }
+    else
+    {
+        free(bytes);
+    }
+    fclose(fp);
+    return ret;
+}
 
-    do
+/*
+ * Scales, encodes and writes the capture on the IO thread, then calls back on the main thread
+ */
+static void encodeCapture(ScreenCapture* capture)
+{
+    std::function<void(void*)> mainThread = [capture](void* /*param*/)
     {
-        std::shared_ptr<GLubyte> buffer(new GLubyte[width * height * 4], [](GLubyte* p){ CC_SAFE_DELETE_ARRAY(p); });
-        if (!buffer)
+        if (capture->callback)
         {
-            break;
+            capture->callback(capture->succeed, capture->outputFile, capture->encoded);
         }
+        delete capture;
+    };
 
-        glPixelStorei(GL_PACK_ALIGNMENT, 1);
-        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, buffer.get());
-
-        std::shared_ptr<GLubyte> flippedBuffer(new GLubyte[width * height * 4], [](GLubyte* p) { CC_SAFE_DELETE_ARRAY(p); });
-        if (!flippedBuffer)
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO, mainThread, nullptr, [capture]()
+    {
+        if (nullptr == capture->pixels)
         {
-            break;
+            return;
         }
 
-        for (int row = 0; row < height; ++row)
+        int width = 0;
+        int height = 0;
+        GLubyte* pixels = scaleAndFlipCapture(capture, &width, &height);
+        CC_SAFE_DELETE_ARRAY(capture->pixels);
+        if (nullptr == pixels)
         {
-            memcpy(flippedBuffer.get() + (height - row - 1) * width * 4, buffer.get() + row * width * 4, width * 4);
+            return;
         }
 
         Image* image = new (std::nothrow) Image;
-        if (image)
+        if (image && image->initWithRawData(pixels, width * height * 4, width, height, 8))
         {
-            image->initWithRawData(flippedBuffer.get(), width * height * 4, width, height, 8);
-            if (FileUtils::getInstance()->isAbsolutePath(filename))
+            if (!capture->outputFile.empty())
             {
-                outputFile = filename;
+                capture->succeed = image->saveToFile(capture->outputFile);
             }
             else
             {
-                CCASSERT(filename.find("/") == std::string::npos, "The existence of a relative path is not guaranteed!");
-                outputFile = FileUtils::getInstance()->getWritablePath() + filename;
+                // the encoders only write files, the bytes are read back from a temporary one
+                static unsigned int s_encodedCount = 0;
+                std::string tempFile = FileUtils::getInstance()->getWritablePath() + "capture-"
+                    + std::to_string(s_encodedCount++) + ".tmp" + capture->extension;
+                capture->succeed = image->saveToFile(tempFile) && readWholeFile(tempFile, &capture->encoded);
+                remove(FileUtils::getInstance()->getSuitableFOpen(tempFile).c_str());
             }
+        }
+        CC_SAFE_DELETE(image);
+        delete [] pixels;
+    });
+}
 
-            // Save image in AsyncTaskPool::TaskType::TASK_IO thread, and call afterCaptured in mainThread
-            static bool succeedSaveToFile = false;
-            std::function<void(void*)> mainThread = [afterCaptured, outputFile](void* param)
-            {
-                if (afterCaptured)
-                {
-                    afterCaptured(succeedSaveToFile, outputFile);
-                }
-                startedCapture = false;
-            };
+static bool isCaptureReady(ScreenCapture* capture)
+{
+    if (0 == capture->pbo)
+    {
+        // read synchronously
+        return true;
+    }
+#if CC_GL_SYNC_OBJECTS
+    if (capture->fence)
+    {
+        return glClientWaitSync(capture->fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0) != GL_TIMEOUT_EXPIRED;
+    }
+#endif
+    return ++capture->frames > CAPTURE_READBACK_FRAMES;
+}
+
+static void finishCapture(ScreenCapture* capture)
+{
+#if CC_GL_PIXEL_BUFFER
+    if (capture->pbo)
+    {
+        GLsizeiptr size = capture->width * capture->height * 4;
 
-            AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO, mainThread, (void*)NULL, [image, outputFile]()
+        GL::bindBuffer(GL_PIXEL_PACK_BUFFER, capture->pbo);
+        void* mapped = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+        if (mapped)
+        {
+            // copied out so the buffer is unmapped before the worker gets the pixels
+            capture->pixels = new (std::nothrow) GLubyte[size];
+            if (capture->pixels)
             {
-                succeedSaveToFile = image->saveToFile(outputFile);
-                delete image;
-            });
+                memcpy(capture->pixels, mapped, size);
+            }
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        GL::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        GL::deleteBuffers(1, &capture->pbo);
+        capture->pbo = 0;
+    }
+#if CC_GL_SYNC_OBJECTS
+    if (capture->fence)
+    {
+        glDeleteSync(capture->fence);
+        capture->fence = nullptr;
+    }
+#endif
+#endif
+
+    encodeCapture(capture);
+}
+
+static void pollScreenCaptures(float /*dt*/)
+{
+    for (auto iter = s_screenCaptures.begin(); iter != s_screenCaptures.end();)
+    {
+        auto capture = *iter;
+        if (isCaptureReady(capture))
+        {
+            iter = s_screenCaptures.erase(iter);
+            finishCapture(capture);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+
+    if (s_screenCaptures.empty())
+    {
+        Director::DirectorInstance->getScheduler()->unschedule("utils::captureScreen", &s_screenCaptures);
+    }
+}
+
+/*
+ * Queues the read of the back buffer, after the commands of the frame
+ */
+static void startCapture(ScreenCapture* capture)
+{
+    auto glView = Director::DirectorInstance->getOpenGLView();
+    auto frameSize = glView->getFrameSize();
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_MAC) || (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32) || (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
+    frameSize = frameSize * glView->getFrameZoomFactor() * glView->getRetinaFactor();
+#endif
+
+    capture->width = static_cast<int>(frameSize.width);
+    capture->height = static_cast<int>(frameSize.height);
+    GLsizeiptr size = capture->width * capture->height * 4;
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+#if CC_GL_PIXEL_BUFFER
+    if (Configuration::getInstance()->supportsPixelBufferObject())
+    {
+        // glReadPixels only queues the copy, the buffer is mapped once the GPU has written it
+        glGenBuffers(1, &capture->pbo);
+        GL::bindBuffer(GL_PIXEL_PACK_BUFFER, capture->pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        glReadPixels(0, 0, capture->width, capture->height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        GL::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+#if CC_GL_SYNC_OBJECTS
+        if (Configuration::getInstance()->supportsSyncObjects())
+        {
+            capture->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
+#endif
+    }
+    else
+#endif
+    {
+        capture->pixels = new (std::nothrow) GLubyte[size];
+        if (capture->pixels)
+        {
+            glReadPixels(0, 0, capture->width, capture->height, GL_RGBA, GL_UNSIGNED_BYTE, capture->pixels);
         }
         else
         {
             CCLOG("Malloc Image memory failed!");
-            if (afterCaptured)
-            {
-                afterCaptured(succeed, outputFile);
-            }
-            startedCapture = false;
         }
-    } while (0);
+    }
+
+    s_screenCaptures.push_back(capture);
+    auto scheduler = Director::DirectorInstance->getScheduler();
+    if (!scheduler->isScheduled("utils::captureScreen", &s_screenCaptures))
+    {
+        scheduler->schedule(pollScreenCaptures, &s_screenCaptures, 0, false, "utils::captureScreen");
+    }
 }
 
 /*
  * Capture screen interface
  */
-static EventListenerCustom* s_captureScreenListener;
-static CustomCommand s_captureScreenCommand;
 void captureScreen(const std::function<void(bool, const std::string&)>& afterCaptured, const std::string& filename)
+{
+    captureScreenAsync([afterCaptured](bool succeed, const std::string& outputFile, const Data& /*encoded*/) {
+        if (afterCaptured)
+        {
+            afterCaptured(succeed, outputFile);
+        }
+    }, filename);
+}
+
+void captureScreenAsync(const std::function<void(bool, const std::string&, const Data&)>& afterCaptured, const std::string& filename, float scale)
 {
     if (s_captureScreenListener)
     {
         CCLOG("Warning: CaptureScreen has been called already, don't call more than once in one frame.");
         return;
     }
+    CCASSERT(scale > 0 && scale <= 1, "The scale must be in (0, 1]");
+
+    auto capture = new (std::nothrow) ScreenCapture();
+    if (nullptr == capture)
+    {
+        if (afterCaptured)
+        {
+            afterCaptured(false, "", Data::Null);
+        }
+        return;
+    }
+    capture->callback = afterCaptured;
+    capture->scale = std::min(std::max(scale, 0.01f), 1.0f);
+    capture->extension = FileUtils::getInstance()->getFileExtension(filename);
+    if (filename.length() != capture->extension.length())
+    {
+        if (FileUtils::getInstance()->isAbsolutePath(filename))
+        {
+            capture->outputFile = filename;
+        }
+        else
+        {
+            CCASSERT(filename.find("/") == std::string::npos, "The existence of a relative path is not guaranteed!");
+            capture->outputFile = FileUtils::getInstance()->getWritablePath() + filename;
+        }
+    }
+
     s_captureScreenCommand.init(std::numeric_limits<float>::max());
-    s_captureScreenCommand.func = std::bind(onCaptureScreen, afterCaptured, filename);
+    s_captureScreenCommand.func = std::bind(startCapture, capture);
     s_captureScreenListener = Director::DirectorInstance->getEventDispatcher()->addCustomEventListener(Director::EVENT_AFTER_DRAW, [](EventCustom *event) {
         auto director = Director::DirectorInstance;
         director->getEventDispatcher()->removeEventListener((EventListener*)(s_captureScreenListener));
@@ -53,6 +53,7 @@ Examples:
 int ccNextPOT(int value);
 
 class Sprite;
+class Data;
 namespace utils
 {
     /** Capture the entire screen.
@@ -65,6 +66,20 @@ namespace utils
      */
     void CC_DLL captureScreen(const std::function<void(bool, const std::string&)>& afterCaptured, const std::string& filename);
 
+    /** Captures the entire screen without stalling the frame, like captureScreen().
+     * With pixel buffer objects the back buffer is copied by the GPU and mapped a few frames later, otherwise it is
+     * read synchronously. The scaling and the flip run on the JobSystem, the encoding and the write on the IO thread
+     * of AsyncTaskPool. captureScreen() uses it too.
+     * @param afterCaptured called on the main thread with whether it succeeded, the full path of the file and the
+     * encoded bytes, which are only set when `filename` is an extension.
+     * @param filename the file like in captureScreen(), or only ".png" or ".jpg" to get the encoded bytes instead of a file.
+     * @param scale the image is scaled down by this factor, in (0, 1], e.g. 0.25 for the thumbnail of a bug report.
+     * @since v3.11
+     * @js NA
+     * @lua NA
+     */
+    void CC_DLL captureScreenAsync(const std::function<void(bool, const std::string&, const Data&)>& afterCaptured, const std::string& filename, float scale = 1.0f);
+
     /** Find children by name, it will return all child that has the same name.
      * It supports c++ 11 regular expression. It is  a helper function of `Node::enumerateChildren()`.
      * You can refer to `Node::enumerateChildren()` for detail information.
@@ -39,6 +39,14 @@ THE SOFTWARE.
 
 // base
 #include "base/CCAsyncTaskPool.h"
+#include "base/CCWorkerPool.h"
+#include "base/CCJobSystem.h"
+#include "base/CCFramePacer.h"
+#include "base/CCFileWatcher.h"
+#include "base/CCDynamicResolution.h"
+#include "base/CCFrameTimings.h"
+#include "base/CCTracer.h"
+#include "base/CCMemoryPressure.h"
 #include "base/CCAutoreleasePool.h"
 #include "base/CCConfiguration.h"
 #include "base/CCConsole.h"
@@ -101,6 +109,7 @@ THE SOFTWARE.
 #include "2d/CCActionInterval.h"
 #include "2d/CCActionManager.h"
 #include "2d/CCActionPageTurn3D.h"
+#include "2d/CCActionPool.h"
 #include "2d/CCActionProgressTimer.h"
 #include "2d/CCActionTiledGrid.h"
 #include "2d/CCActionTween.h"
@@ -122,15 +131,24 @@ THE SOFTWARE.
 #include "2d/CCMotionStreak.h"
 #include "2d/CCNode.h"
 #include "2d/CCNodeGrid.h"
+#include "2d/CCNodePool.h"
+#include "2d/CCNodeQuery.h"
 #include "2d/CCParticleBatchNode.h"
 #include "2d/CCParticleSystem.h"
 #include "2d/CCParticleSystemQuad.h"
+#include "2d/CCParticleSystemGPU.h"
+#include "2d/CCParticleCache.h"
+#include "2d/CCPrefab.h"
 #include "2d/CCProgressTimer.h"
 #include "2d/CCRenderTexture.h"
 #include "2d/CCScene.h"
+#include "2d/CCSceneLoader.h"
+#include "2d/CCTransformSystem.h"
 #include "2d/CCTransition.h"
 #include "2d/CCTransitionPageTurn.h"
 #include "2d/CCTransitionProgress.h"
+#include "2d/CCVirtualList.h"
+#include "2d/CCLargeImage.h"
 
 // 2d utils
 #include "2d/CCGrabber.h"
@@ -146,10 +164,14 @@ THE SOFTWARE.
 #include "renderer/CCGLProgramState.h"
 #include "renderer/CCGroupCommand.h"
 #include "renderer/CCPrimitive.h"
+#include "renderer/CCPostProcess.h"
 #include "renderer/CCPrimitiveCommand.h"
 #include "renderer/CCQuadCommand.h"
+#include "renderer/CCQuadIndexBuffer.h"
+#include "renderer/CCRenderTargetPool.h"
 #include "renderer/CCRenderCommand.h"
 #include "renderer/CCRenderCommandPool.h"
+#include "renderer/CCFrameArena.h"
 #include "renderer/CCRenderState.h"
 #include "renderer/CCRenderer.h"
 #include "renderer/CCTexture2D.h"
@@ -158,6 +180,7 @@ THE SOFTWARE.
 #include "renderer/CCVertexAttribBinding.h"
 #include "renderer/CCVertexIndexBuffer.h"
 #include "renderer/CCVertexIndexData.h"
+#include "renderer/CCVideoMemory.h"
 #include "renderer/CCPrimitive.h"
 #include "renderer/CCPrimitiveCommand.h"
 #include "renderer/CCTrianglesCommand.h"
@@ -211,6 +234,8 @@ THE SOFTWARE.
 #include "2d/CCSpriteBatchNode.h"
 #include "2d/CCSpriteFrame.h"
 #include "2d/CCSpriteFrameCache.h"
+#include "2d/CCSpriteAnimation.h"
+#include "2d/CCDynamicAtlas.h"
 
 // text_input_node
 #include "2d/CCTextFieldTTF.h"
@@ -220,6 +245,7 @@ THE SOFTWARE.
 
 // tilemap_parallax_nodes
 #include "2d/CCParallaxNode.h"
+#include "2d/CCSpatialNode.h"
 #include "2d/CCTMXObjectGroup.h"
 #include "2d/CCTMXXMLParser.h"
 #include "2d/CCTileMapAtlas.h"
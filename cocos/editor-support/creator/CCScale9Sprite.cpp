@@ -29,6 +29,8 @@
 #include "2d/CCSpriteFrameCache.h"
 #include "renderer/CCRenderer.h"
 
+#include <unordered_map>
+
 namespace creator {
     
 class simpleQuadGenerator
@@ -845,6 +847,88 @@ public:
     }
 };
 
+struct Scale9SpriteV2::Geometry
+{
+    //the frame can't be freed, and its address reused by another one, while the geometry is alive
+    cocos2d::SpriteFrame* spriteFrame;
+    std::vector<cocos2d::V3F_C4B_T2F> verts;
+    std::vector<unsigned short> indices;
+    
+    explicit Geometry(cocos2d::SpriteFrame* frame) : spriteFrame(frame) {
+        CC_SAFE_RETAIN(spriteFrame);
+    }
+    Geometry(const Geometry& other) : spriteFrame(other.spriteFrame), verts(other.verts), indices(other.indices) {
+        CC_SAFE_RETAIN(spriteFrame);
+    }
+    ~Geometry() {
+        CC_SAFE_RELEASE(spriteFrame);
+    }
+    Geometry& operator=(const Geometry&) = delete;
+};
+
+namespace {
+
+struct GeometryKey
+{
+    cocos2d::SpriteFrame* spriteFrame;
+    Scale9SpriteV2::RenderingType renderingType;
+    bool isTrimmedContentSize;
+    float width, height;
+    float insetLeft, insetRight, insetTop, insetBottom;
+    cocos2d::Color4B color;
+    
+    bool operator==(const GeometryKey& other) const {
+        return spriteFrame == other.spriteFrame && renderingType == other.renderingType && isTrimmedContentSize == other.isTrimmedContentSize
+            && width == other.width && height == other.height
+            && insetLeft == other.insetLeft && insetRight == other.insetRight && insetTop == other.insetTop && insetBottom == other.insetBottom
+            && color == other.color;
+    }
+};
+
+struct GeometryKeyHash
+{
+    size_t operator()(const GeometryKey& key) const {
+        size_t h = std::hash<void*>()(key.spriteFrame);
+        auto combine = [&h](size_t value) { h ^= value + 0x9e3779b9 + (h << 6) + (h >> 2); };
+        combine((size_t)key.renderingType);
+        combine(key.isTrimmedContentSize);
+        combine(std::hash<float>()(key.width));
+        combine(std::hash<float>()(key.height));
+        combine(std::hash<float>()(key.insetLeft));
+        combine(std::hash<float>()(key.insetRight));
+        combine(std::hash<float>()(key.insetTop));
+        combine(std::hash<float>()(key.insetBottom));
+        combine(((size_t)key.color.r << 24) | ((size_t)key.color.g << 16) | ((size_t)key.color.b << 8) | key.color.a);
+        return h;
+    }
+};
+
+typedef std::unordered_map<GeometryKey, std::weak_ptr<const Scale9SpriteV2::Geometry>, GeometryKeyHash> GeometryCache;
+
+//the geometries alive, filled and read on the main thread
+GeometryCache s_geometryCache;
+size_t s_geometryCachePruneSize = 64;
+
+std::shared_ptr<const Scale9SpriteV2::Geometry> findGeometry(const GeometryKey& key)
+{
+    auto it = s_geometryCache.find(key);
+    return it != s_geometryCache.end() ? it->second.lock() : nullptr;
+}
+
+void addGeometry(const GeometryKey& key, const std::shared_ptr<const Scale9SpriteV2::Geometry>& geometry)
+{
+    //the geometries of the resized and recolored sprites expire, drop them once the cache doubled
+    if (s_geometryCache.size() >= s_geometryCachePruneSize) {
+        for (auto it = s_geometryCache.begin(); it != s_geometryCache.end();) {
+            it = it->second.expired() ? s_geometryCache.erase(it) : std::next(it);
+        }
+        s_geometryCachePruneSize = std::max((size_t)64, s_geometryCache.size() * 2);
+    }
+    s_geometryCache[key] = geometry;
+}
+
+}
+
 //begin of Scale9 sprite implementation
 Scale9SpriteV2::Scale9SpriteV2() :
 _spriteFrame(nullptr),
@@ -855,14 +939,16 @@ _insetBottom(0),
 _blendFunc(cocos2d::BlendFunc::ALPHA_NON_PREMULTIPLIED),
 _renderingType(Scale9SpriteV2::RenderingType::SIMPLE),
 _brightState(Scale9SpriteV2::State::NORMAL),
+_isBlendFuncSet(false),
 _quadsDirty(true),
+_colorDirty(false),
 _isTriangle(false),
 _isTrimmedContentSize(true),
 _fillType(Scale9SpriteV2::FillType::HORIZONTAL),
 _fillCenter(cocos2d::Vec2(0,0)),
 _fillStart(0),
 _fillRange(0),
-_needRebuildRenderCommand(true)
+_insideBounds(true)
 {
     this->setAnchorPoint(cocos2d::Vec2(0.5,0.5));
     this->setGLProgramState(cocos2d::GLProgramState::getOrCreateWithGLProgramName(cocos2d::GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP));
@@ -897,6 +983,11 @@ bool Scale9SpriteV2::setSpriteFrame(cocos2d::SpriteFrame* spriteFrame)
     this->_spriteFrame = spriteFrame;
     CC_SAFE_RETAIN(spriteFrame);
     this->_quadsDirty = true;
+    //like a Sprite, so that it batches with the sprites of the same atlas
+    auto texture = spriteFrame->getTexture();
+    if (!this->_isBlendFuncSet && texture) {
+        this->_blendFunc = texture->hasPremultipliedAlpha() ? cocos2d::BlendFunc::ALPHA_PREMULTIPLIED : cocos2d::BlendFunc::ALPHA_NON_PREMULTIPLIED;
+    }
     if(this->_contentSize.equals(cocos2d::Size::ZERO))
     {
         this->setContentSize(spriteFrame->getRect().size);
@@ -911,6 +1002,7 @@ void Scale9SpriteV2::setBlendFunc(const cocos2d::BlendFunc& blendFunc) {
 void Scale9SpriteV2::setBlendFunc(GLenum src, GLenum dst) {
     this->_blendFunc.src = src;
     this->_blendFunc.dst = dst;
+    this->_isBlendFuncSet = true;
 }
 
 const cocos2d::BlendFunc& Scale9SpriteV2::getBlendFunc() const {
@@ -923,6 +1015,17 @@ void Scale9SpriteV2::setContentSize(const cocos2d::Size &contentSize) {
     this->_quadsDirty = true;
 }
 
+void Scale9SpriteV2::setContentSizes(Scale9SpriteV2* const* sprites, const cocos2d::Size* contentSizes, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        auto sprite = sprites[i];
+        sprite->setContentSize(contentSizes[i]);
+        //the sprites resized the same find the geometry of the first one in the cache
+        if (sprite->_spriteFrame && sprite->_spriteFrame->getTexture()) {
+            sprite->_rebuildQuads();
+        }
+    }
+}
+
 void Scale9SpriteV2::enableTrimmedContentSize(bool isTrimmed) {
     if (this->_isTrimmedContentSize != isTrimmed) {
         this->_isTrimmedContentSize = isTrimmed;
@@ -992,13 +1095,30 @@ void Scale9SpriteV2::_rebuildQuads()
     if (this->_quadsDirty == false) return;
     cocos2d::Color4B color(this->getDisplayedColor());
     color.a = this->getDisplayedOpacity();
+    this->_quadsDirty = false;
+    this->_colorDirty = false;
+    
+    //the filled sprites are animated, their geometry isn't shared
+    bool isCached = this->_renderingType != RenderingType::FILLED;
+    GeometryKey key = { this->_spriteFrame, this->_renderingType, this->_isTrimmedContentSize,
+        this->_contentSize.width, this->_contentSize.height,
+        this->_insetLeft, this->_insetRight, this->_insetTop, this->_insetBottom, color };
+    if (isCached) {
+        auto geometry = findGeometry(key);
+        if (geometry) {
+            this->_geometry = geometry;
+            return;
+        }
+    }
+    
+    std::vector<cocos2d::V3F_C4B_T2F_Quad> quads;
     this->_isTriangle = false;
     if (this->_renderingType == RenderingType::SIMPLE) {
-        this->_quads = simpleQuadGenerator()._rebuildQuads_base(this->_spriteFrame, this->getContentSize(), color, this->_isTrimmedContentSize);
+        quads = simpleQuadGenerator()._rebuildQuads_base(this->_spriteFrame, this->getContentSize(), color, this->_isTrimmedContentSize);
     } else if (this->_renderingType == RenderingType::SLICED) {
-        this->_quads = scale9QuadGenerator()._rebuildQuads_base(this->_spriteFrame, this->getContentSize(), color, this->_insetLeft, this->_insetRight, this->_insetTop, this->_insetBottom);
+        quads = scale9QuadGenerator()._rebuildQuads_base(this->_spriteFrame, this->getContentSize(), color, this->_insetLeft, this->_insetRight, this->_insetTop, this->_insetBottom);
     } else if (this->_renderingType == RenderingType::TILED) {
-        this->_quads = tiledQuadGenerator()._rebuildQuads_base(this->_spriteFrame, this->getContentSize(), color);
+        quads = tiledQuadGenerator()._rebuildQuads_base(this->_spriteFrame, this->getContentSize(), color);
     } else if (this->_renderingType == RenderingType::FILLED) {
         auto fillstart = this->_fillStart;
         auto fillRange = this->_fillRange;
@@ -1014,29 +1134,82 @@ void Scale9SpriteV2::_rebuildQuads()
             fillRange = fillRange > 1.0 ? 1.0 : fillRange;
             fillRange = fillRange < 0.0 ? 0.0 : fillRange;
             fillRange = fillRange - fillstart;
-            this->_quads = fillQuadGeneratorBar()._rebuildQuads_base(this->_spriteFrame, this->getContentSize(), color, this->_fillType, fillstart,fillRange);
+            quads = fillQuadGeneratorBar()._rebuildQuads_base(this->_spriteFrame, this->getContentSize(), color, this->_fillType, fillstart,fillRange);
         } else {
             this->_isTriangle = true;
-            this->_quads = fillQuadGeneratorRadial()._rebuildQuads_base(this->_spriteFrame, this->getContentSize(), color,this->_fillCenter,fillstart,fillRange, this->_rawQuad);
+            quads = fillQuadGeneratorRadial()._rebuildQuads_base(this->_spriteFrame, this->getContentSize(), color,this->_fillCenter,fillstart,fillRange, this->_rawQuad);
         }
     } else {
-        this->_quads.clear();
         cocos2d::log("Can not generate quad");
     }
-    this->_quadsDirty = false;
+    
+    //fill triangles
+    auto geometry = std::make_shared<Geometry>(this->_spriteFrame);
+    int vertsStep = this->_isTriangle ? 3 : 4;
+    int indicesStep = this->_isTriangle ? 3 : 6;
+    geometry->verts.resize(quads.size() * vertsStep);
+    geometry->indices.resize(quads.size() * indicesStep);
+    unsigned short indices[6];
+    for(int index = 0; index < quads.size(); ++index) {
+        memcpy(&geometry->verts[vertsStep * index], &quads[index], sizeof(cocos2d::V3F_C4B_T2F) * vertsStep);
+        if(this->_isTriangle) {
+            indices[0] = indicesStep * index;
+            indices[1] = indicesStep * index + 1;
+            indices[2] = indicesStep * index + 2;
+            
+        } else {
+            indices[0] = vertsStep * index;
+            indices[1] = vertsStep * index + 1;
+            indices[2] = vertsStep * index + 2;
+            indices[3] = vertsStep * index + 3;
+            indices[4] = vertsStep * index + 2;
+            indices[5] = vertsStep * index + 1;
+            
+        }
+        
+        memcpy(&geometry->indices[indicesStep * index], indices, sizeof(unsigned short) * indicesStep);
+        
+    }
+    
+    if (isCached) {
+        addGeometry(key, geometry);
+    }
+    this->_geometry = geometry;
 }
 
-void Scale9SpriteV2::updateColor() {
+void Scale9SpriteV2::_recolorGeometry()
+{
+    if (this->_colorDirty == false) return;
     cocos2d::Color4B color(this->getDisplayedColor());
     color.a = this->getDisplayedOpacity();
-    for (int index = 0; index < this->_quads.size(); ++index) {
-        this->_quads[index].bl.colors = color;
-        this->_quads[index].br.colors = color;
-        this->_quads[index].tl.colors = color;
-        this->_quads[index].tr.colors = color;
+    this->_colorDirty = false;
+    
+    bool isCached = this->_renderingType != RenderingType::FILLED;
+    GeometryKey key = { this->_spriteFrame, this->_renderingType, this->_isTrimmedContentSize,
+        this->_contentSize.width, this->_contentSize.height,
+        this->_insetLeft, this->_insetRight, this->_insetTop, this->_insetBottom, color };
+    if (isCached) {
+        auto geometry = findGeometry(key);
+        if (geometry) {
+            this->_geometry = geometry;
+            return;
+        }
+    }
+    
+    //the same triangles in the new color, the shared ones are left as they are
+    auto geometry = std::make_shared<Geometry>(*this->_geometry);
+    for (auto& vert : geometry->verts) {
+        vert.colors = color;
     }
     
-    this->_needRebuildRenderCommand = true;
+    if (isCached) {
+        addGeometry(key, geometry);
+    }
+    this->_geometry = geometry;
+}
+
+void Scale9SpriteV2::updateColor() {
+    this->_colorDirty = true;
 }
 
 void Scale9SpriteV2::draw(cocos2d::Renderer *renderer, const cocos2d::Mat4 &transform, uint32_t flags) {
@@ -1044,54 +1217,33 @@ void Scale9SpriteV2::draw(cocos2d::Renderer *renderer, const cocos2d::Mat4 &tran
         return;
     }
     
-    if(this->_quadsDirty) {
+#if CC_USE_CULLING
+    // Don't do calculate the culling if the transform was not updated
+    _insideBounds = (flags & FLAGS_TRANSFORM_DIRTY) ? renderer->checkVisibility(transform, _contentSize) : _insideBounds;
+    if (!_insideBounds) {
+        return;
+    }
+#endif
+    
+    if(this->_quadsDirty || !this->_geometry) {
         //rebuild quads
+        this->_quadsDirty = true;
         this->_rebuildQuads();
-        this->_needRebuildRenderCommand = true;
+    } else if(this->_colorDirty) {
+        this->_recolorGeometry();
     }
-    if(this->_needRebuildRenderCommand) {
-        //fill triangles
-        int vertsStep = this->_isTriangle ? 3 : 4;
-        int indicesStep = this->_isTriangle ? 3 : 6;
-        this->_verts.resize(_quads.size() * vertsStep);
-        this->_indices.resize(_quads.size() * indicesStep);
-        unsigned short indices[6];
-        for(int index = 0; index < _quads.size(); ++index) {
-            memcpy(&this->_verts[vertsStep * index], &this->_quads[index], sizeof(cocos2d::V3F_C4B_T2F) * vertsStep);
-            if(this->_isTriangle) {
-                indices[0] = indicesStep * index;
-                indices[1] = indicesStep * index + 1;
-                indices[2] = indicesStep * index + 2;
-                
-            } else {
-                indices[0] = vertsStep * index;
-                indices[1] = vertsStep * index + 1;
-                indices[2] = vertsStep * index + 2;
-                indices[3] = vertsStep * index + 3;
-                indices[4] = vertsStep * index + 2;
-                indices[5] = vertsStep * index + 1;
-                
-            }
-            
-            memcpy(&this->_indices[indicesStep * index], indices, sizeof(unsigned short) * indicesStep);
-            
-        }
-        
-        this->_needRebuildRenderCommand = false;
-        
+    
+    //the same texture, program and blend function as the sprites of the atlas, so that they batch
+    if (this->_geometry->indices.size() > 0 && this->_geometry->verts.size() > 0) {
+        cocos2d::TrianglesCommand::Triangles triangles;
+        triangles.indices = const_cast<unsigned short*>(this->_geometry->indices.data());
+        triangles.verts = const_cast<cocos2d::V3F_C4B_T2F*>(this->_geometry->verts.data());
+        triangles.vertCount = this->_geometry->verts.size();
+        triangles.indexCount = this->_geometry->indices.size();
+        auto texture = this->_spriteFrame->getTexture();
+        this->_renderCommand.init(this->_globalZOrder, texture->getName(), this->getGLProgramState(), this->_blendFunc, triangles, transform, flags);
+        renderer->addCommand(&this->_renderCommand);
     }
-
-	if (this->_indices.size() > 0 && this->_verts.size() > 0) {
-		cocos2d::TrianglesCommand::Triangles triangles;
-		triangles.indices = &this->_indices[0];
-		triangles.verts = &this->_verts[0];
-		triangles.vertCount = this->_verts.size();
-		triangles.indexCount = this->_indices.size();
-		auto texture = this->_spriteFrame->getTexture();
-		this->_renderCommand.init(this->_globalZOrder, texture->getName(), this->getGLProgramState(), this->_blendFunc, triangles, transform, 0);
-		renderer->addCommand(&this->_renderCommand);
-	}
-
 }
     
 }
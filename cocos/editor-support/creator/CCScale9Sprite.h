@@ -33,6 +33,7 @@
 #include "renderer/CCTrianglesCommand.h"
 
 #include <math.h>
+#include <memory>
 
 namespace creator {
 
@@ -91,6 +92,15 @@ public:
     
     virtual void setContentSize(const cocos2d::Size& contentSize) override;
     
+    /**
+     * Resizes the sprites at once, for a layout pass. Their geometry is built right away, once for the
+     * sprites of the same frame, rendering type, insets, size and color, which share their vertex data.
+     */
+    static void setContentSizes(Scale9SpriteV2* const* sprites, const cocos2d::Size* contentSizes, size_t count);
+    
+    //the triangles of a sprite, shared by the sprites drawing the same ones
+    struct Geometry;
+    
     void enableTrimmedContentSize (bool isTrimmed);
     bool isTrimmedContentSizeEnabled() const { return this->_isTrimmedContentSize; }
     
@@ -127,6 +137,7 @@ protected:
 
 private:
     void _rebuildQuads ();
+    void _recolorGeometry ();
     //resource data
     cocos2d::SpriteFrame* _spriteFrame;
     
@@ -141,9 +152,12 @@ private:
     RenderingType _renderingType;
     //bright or not
     State _brightState;
-    //rendering quads
-    std::vector<cocos2d::V3F_C4B_T2F_Quad> _quads;
+    //explicitly set blend function, or the one of the texture
+    bool _isBlendFuncSet;
+    //rendering geometry, shared by the sprites drawing the same one
+    std::shared_ptr<const Geometry> _geometry;
     bool _quadsDirty;
+    bool _colorDirty;
     cocos2d::V3F_C4B_T2F_Quad _rawQuad;
     bool _isTriangle;
     bool _isTrimmedContentSize;
@@ -154,12 +168,9 @@ private:
     //normalized filled start and range
     float _fillStart;
     float _fillRange;
-    //indicate that rendercommand need to be rebuild or not;
-    bool _needRebuildRenderCommand;
     
-    std::vector<cocos2d::V3F_C4B_T2F> _verts;
-    std::vector<unsigned short> _indices;
     cocos2d::TrianglesCommand _renderCommand;
+    bool _insideBounds;
     
 };
 
@@ -156,6 +156,34 @@ Mat4 TransformConcat(const Mat4& t1, const Mat4& t2)
     return t1 * t2;
 }
 
+bool TransformIsAffine2D(const Mat4& t)
+{
+    const float* m = t.m;
+    return m[2] == 0 && m[3] == 0 && m[6] == 0 && m[7] == 0
+        && m[8] == 0 && m[9] == 0 && m[10] == 1 && m[11] == 0
+        && m[14] == 0 && m[15] == 1;
+}
+
+void TransformConcatAffine2D(const Mat4& t1, const Mat4& t2, Mat4* dst)
+{
+    const float* m1 = t1.m;
+    const float* m2 = t2.m;
+
+    // 12 multiplies instead of the 64 of Mat4::multiply, the z and w rows stay the identity
+    const float a  = m1[0] * m2[0] + m1[4] * m2[1];
+    const float b  = m1[1] * m2[0] + m1[5] * m2[1];
+    const float c  = m1[0] * m2[4] + m1[4] * m2[5];
+    const float d  = m1[1] * m2[4] + m1[5] * m2[5];
+    const float tx = m1[0] * m2[12] + m1[4] * m2[13] + m1[12];
+    const float ty = m1[1] * m2[12] + m1[5] * m2[13] + m1[13];
+
+    float* m = dst->m;
+    m[0] = a;  m[1] = b;  m[2] = 0;   m[3] = 0;
+    m[4] = c;  m[5] = d;  m[6] = 0;   m[7] = 0;
+    m[8] = 0;  m[9] = 0;  m[10] = 1;  m[11] = 0;
+    m[12] = tx; m[13] = ty; m[14] = 0; m[15] = 1;
+}
+
 
 /* Return true if `t1' and `t2' are equal, false otherwise. */
 bool AffineTransformEqualToTransform(const AffineTransform& t1, const AffineTransform& t2)
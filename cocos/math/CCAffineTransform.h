@@ -108,6 +108,16 @@ CC_DLL bool AffineTransformEqualToTransform(const AffineTransform& t1, const Aff
 CC_DLL AffineTransform AffineTransformInvert(const AffineTransform& t);
 /**Concat Mat4, return t1 * t2.*/
 CC_DLL Mat4 TransformConcat(const Mat4& t1, const Mat4& t2);
+/**@{
+ 2D affine fast path of Mat4.
+ A Mat4 is a 2D affine transform when it only holds a, b, c, d, tx and ty in m[0], m[1], m[4], m[5], m[12] and m[13],
+ and the rest is the identity. Such a transform keeps z as it is.
+ */
+/**Return true if the Mat4 is a 2D affine transform.*/
+CC_DLL bool TransformIsAffine2D(const Mat4& t);
+/**Concat two 2D affine Mat4, dst = t1 * t2. Only the affine part is computed, dst may be t1 or t2.*/
+CC_DLL void TransformConcatAffine2D(const Mat4& t1, const Mat4& t2, Mat4* dst);
+/**@}*/
 
 extern CC_DLL const AffineTransform AffineTransformIdentity;
 
@@ -911,6 +911,27 @@ void Mat4::transformVector(float x, float y, float z, float w, Vec3* dst) const
     MathUtil::transformVec4(m, x, y, z, w, (float*)dst);
 }
 
+void Mat4::transformVertices(const float* src, float* dst, int count) const
+{
+    GP_ASSERT(src && dst);
+#ifdef __SSE__
+    MathUtil::transformVertices(col, src, dst, count);
+#else
+    MathUtil::transformVertices(m, src, dst, count);
+#endif
+}
+
+void Mat4::transformVerticesAffine2D(const float* src, float* dst, int count) const
+{
+    GP_ASSERT(src && dst);
+#ifdef __SSE__
+    // one multiply-add per column, the z column is as cheap as copying z
+    MathUtil::transformVertices(col, src, dst, count);
+#else
+    MathUtil::transformVerticesAffine2D(m, src, dst, count);
+#endif
+}
+
 void Mat4::transformVector(Vec4* vector) const
 {
     GP_ASSERT(vector);
@@ -772,6 +772,29 @@ public:
      */
     inline void transformPoint(const Vec3& point, Vec3* dst) const { GP_ASSERT(dst); transformVector(point.x, point.y, point.z, 1.0f, dst); }
 
+    /**
+     * Transforms the positions of interleaved vertices by this matrix, and stores them in dst.
+     *
+     * Each vertex is 6 floats wide, the layout of V3F_C4B_T2F: a position which is transformed
+     * as a point, followed by 12 bytes which are copied untouched. dst is written sequentially and
+     * never read, so it can point into mapped GPU memory.
+     *
+     * @param src The vertices to transform.
+     * @param dst The vertices to store the result in, it must not overlap src.
+     * @param count The number of vertices.
+     */
+    void transformVertices(const float* src, float* dst, int count) const;
+
+    /**
+     * Same as transformVertices(), for a matrix which is a 2D affine transform (see TransformIsAffine2D()):
+     * only x and y are transformed, z is copied.
+     *
+     * @param src The vertices to transform.
+     * @param dst The vertices to store the result in, it must not overlap src.
+     * @param count The number of vertices.
+     */
+    void transformVerticesAffine2D(const float* src, float* dst, int count) const;
+
     /**
      * Transforms the specified vector by this matrix by
      * treating the fourth (w) coordinate as zero.
@@ -261,6 +261,35 @@ void MathUtil::transformVec4(const float* m, const float* v, float* dst)
 #endif
 }
 
+void MathUtil::transformVertices(const float* m, const float* src, float* dst, int count)
+{
+#ifdef USE_NEON32
+    MathUtilNeon::transformVertices(m, src, dst, count);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::transformVertices(m, src, dst, count);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::transformVertices(m, src, dst, count);
+    else MathUtilC::transformVertices(m, src, dst, count);
+#else
+    MathUtilC::transformVertices(m, src, dst, count);
+#endif
+}
+
+void MathUtil::transformVerticesAffine2D(const float* m, const float* src, float* dst, int count)
+{
+    // the NEON kernel does a column per multiply-add, dropping the z column saves little
+#ifdef USE_NEON32
+    MathUtilNeon::transformVertices(m, src, dst, count);
+#elif defined (USE_NEON64)
+    MathUtilNeon64::transformVertices(m, src, dst, count);
+#elif defined (INCLUDE_NEON32)
+    if(isNeon32Enabled()) MathUtilNeon::transformVertices(m, src, dst, count);
+    else MathUtilC::transformVerticesAffine2D(m, src, dst, count);
+#else
+    MathUtilC::transformVerticesAffine2D(m, src, dst, count);
+#endif
+}
+
 void MathUtil::crossVec3(const float* v1, const float* v2, float* dst)
 {
 #ifdef USE_NEON32
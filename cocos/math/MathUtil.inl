@@ -41,6 +41,10 @@ public:
     
     inline static void transformVec4(const float* m, const float* v, float* dst);
     
+    inline static void transformVertices(const float* m, const float* src, float* dst, int count);
+    
+    inline static void transformVerticesAffine2D(const float* m, const float* src, float* dst, int count);
+    
     inline static void crossVec3(const float* v1, const float* v2, float* dst);
 };
 
@@ -204,6 +208,29 @@ inline void MathUtilC::transformVec4(const float* m, const float* v, float* dst)
     dst[3] = w;
 }
 
+inline void MathUtilC::transformVertices(const float* m, const float* src, float* dst, int count)
+{
+    for (int i = 0; i < count; ++i, src += 6, dst += 6)
+    {
+        dst[0] = src[0] * m[0] + src[1] * m[4] + src[2] * m[8] + m[12];
+        dst[1] = src[0] * m[1] + src[1] * m[5] + src[2] * m[9] + m[13];
+        dst[2] = src[0] * m[2] + src[1] * m[6] + src[2] * m[10] + m[14];
+        // the payload isn't always a float (colors), copy the bits
+        memcpy(dst + 3, src + 3, sizeof(float) * 3);
+    }
+}
+
+inline void MathUtilC::transformVerticesAffine2D(const float* m, const float* src, float* dst, int count)
+{
+    for (int i = 0; i < count; ++i, src += 6, dst += 6)
+    {
+        // m[2], m[6], m[8], m[9] and m[14] are 0, m[10] is 1: z is kept
+        dst[0] = src[0] * m[0] + src[1] * m[4] + m[12];
+        dst[1] = src[0] * m[1] + src[1] * m[5] + m[13];
+        memcpy(dst + 2, src + 2, sizeof(float) * 4);
+    }
+}
+
 inline void MathUtilC::crossVec3(const float* v1, const float* v2, float* dst)
 {
     float x = (v1[1] * v2[2]) - (v1[2] * v2[1]);
@@ -40,6 +40,8 @@ public:
     
     inline static void transformVec4(const float* m, const float* v, float* dst);
     
+    inline static void transformVertices(const float* m, const float* src, float* dst, int count);
+    
     inline static void crossVec3(const float* v1, const float* v2, float* dst);
 };
 
@@ -243,6 +245,34 @@ inline void MathUtilNeon::transformVec4(const float* m, const float* v, float* d
      );
 }
 
+inline void MathUtilNeon::transformVertices(const float* m, const float* src, float* dst, int count)
+{
+    if (count <= 0)
+        return;
+
+    asm volatile
+    (
+     "vld1.32    {d18 - d21}, [%3]! \n\t"   // M[m0-m7]
+     "vld1.32    {d22 - d25}, [%3]  \n\t"   // M[m8-m15]
+
+     "1:                            \n\t"
+     "vld1.32    {d0 - d2}, [%1]!   \n\t"   // V[x, y, z], P[0, 1, 2]
+     "vmov       q2, q12            \n\t"   // DST->V = M[m12-m15]
+     "vmla.f32   q2, q9, d0[0]      \n\t"   // DST->V += M[m0-m3] * V[x]
+     "vmla.f32   q2, q10, d0[1]     \n\t"   // DST->V += M[m4-m7] * V[y]
+     "vmla.f32   q2, q11, d1[0]     \n\t"   // DST->V += M[m8-m11] * V[z]
+     "vmov.f32   s11, s3            \n\t"   // DST->V[w] = P[0]
+
+     "vst1.32    {d4, d5}, [%0]!    \n\t"   // DST->V[x, y, z], P[0]
+     "vst1.32    {d2}, [%0]!        \n\t"   // P[1, 2]
+     "subs       %2, %2, #1         \n\t"
+     "bne        1b                 \n\t"
+     : "+r"(dst), "+r"(src), "+r"(count), "+r"(m)
+     :
+     : "q0", "q1", "q2", "q9", "q10", "q11", "q12", "cc", "memory"
+     );
+}
+
 inline void MathUtilNeon::crossVec3(const float* v1, const float* v2, float* dst)
 {
     asm volatile(
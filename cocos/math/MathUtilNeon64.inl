@@ -40,6 +40,8 @@ public:
     inline static void transformVec4(const float* m, float x, float y, float z, float w, float* dst);
     
     inline static void transformVec4(const float* m, const float* v, float* dst);
+
+    inline static void transformVertices(const float* m, const float* src, float* dst, int count);
     
     inline static void crossVec3(const float* v1, const float* v2, float* dst);
 };
@@ -223,6 +225,34 @@ inline void MathUtilNeon64::transformVec4(const float* m, const float* v, float*
     );
 }
 
+inline void MathUtilNeon64::transformVertices(const float* m, const float* src, float* dst, int count)
+{
+    if (count <= 0)
+        return;
+
+    asm volatile
+    (
+        "ld1    {v9.4s, v10.4s, v11.4s, v12.4s}, [%3] \n\t"   // M[m0-m7] M[m8-m15]
+
+        "1:                                 \n\t"
+        "ld1    {v0.4s}, [%1], #16          \n\t"   // V[x, y, z], P[0]
+        "ld1    {v1.2s}, [%1], #8           \n\t"   // P[1, 2]
+        "mov    v2.16b, v12.16b             \n\t"   // DST->V = M[m12-m15]
+        "fmla   v2.4s, v9.4s, v0.s[0]       \n\t"   // DST->V += M[m0-m3] * V[x]
+        "fmla   v2.4s, v10.4s, v0.s[1]      \n\t"   // DST->V += M[m4-m7] * V[y]
+        "fmla   v2.4s, v11.4s, v0.s[2]      \n\t"   // DST->V += M[m8-m11] * V[z]
+        "mov    v2.s[3], v0.s[3]            \n\t"   // DST->V[w] = P[0]
+
+        "st1    {v2.4s}, [%0], #16          \n\t"   // DST->V[x, y, z], P[0]
+        "st1    {v1.2s}, [%0], #8           \n\t"   // P[1, 2]
+        "subs   %w2, %w2, #1                \n\t"
+        "b.ne   1b                          \n\t"
+        : "+r"(dst), "+r"(src), "+r"(count)
+        : "r"(m)
+        : "v0", "v1", "v2", "v9", "v10", "v11", "v12", "cc", "memory"
+    );
+}
+
 inline void MathUtilNeon64::crossVec3(const float* v1, const float* v2, float* dst)
 {
         asm volatile(
@@ -151,6 +151,25 @@ void MathUtil::transformVec4(const __m128 m[4], const __m128& v, __m128& dst)
                      );
 }
 
+void MathUtil::transformVertices(const __m128 m[4], const float* src, float* dst, int count)
+{
+    for (int i = 0; i < count; ++i, src += 6, dst += 6)
+    {
+        // V[x, y, z], P[0]
+        __m128 v = _mm_loadu_ps(src);
+        __m128 r = _mm_add_ps(
+                              _mm_add_ps(_mm_mul_ps(m[0], _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0))),
+                                         _mm_mul_ps(m[1], _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)))),
+                              _mm_add_ps(_mm_mul_ps(m[2], _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))), m[3])
+                              );
+        // (r[x], r[y], r[z], P[0])
+        __m128 zw = _mm_shuffle_ps(r, v, _MM_SHUFFLE(3, 3, 2, 2));
+        _mm_storeu_ps(dst, _mm_shuffle_ps(r, zw, _MM_SHUFFLE(2, 0, 1, 0)));
+        // P[1, 2]
+        _mm_storel_pi((__m64*)(dst + 4), _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)(src + 4)));
+    }
+}
+
 #endif
 
 
@@ -92,6 +92,21 @@ public:
      */
     static void vibrate(float duration);
 
+    /** How hot the device is, from the system. */
+    enum class ThermalState
+    {
+        NOMINAL,  /** No throttling. */
+        FAIR,     /** Slightly warm, the system may start to throttle. */
+        SERIOUS,  /** Throttled, the frame rate should be lowered. */
+        CRITICAL, /** Heavily throttled, the device needs to cool down. */
+    };
+
+    /**
+     * Gets the thermal state of the device, from NSProcessInfo on iOS and Mac, from PowerManager on Android 10 and later.
+     * NOMINAL where the system doesn't report it.
+     */
+    static ThermalState getThermalState();
+
     /**
      * Gets texture data for text.
      */
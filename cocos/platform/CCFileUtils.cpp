@@ -25,307 +25,35 @@ THE SOFTWARE.
 
 #include "CCFileUtils.h"
 
-#include <stack>
 
 #include "base/CCData.h"
+#include "base/CCAssetPack.h"
 #include "base/ccMacros.h"
 #include "base/CCDirector.h"
-#include "platform/CCSAXParser.h"
+#include "platform/CCPlistDocument.h"
 #include "base/ccUtils.h"
+#include "base/CCAsyncTaskPool.h"
 
-#include "tinyxml2/tinyxml2.h"
 #ifdef MINIZIP_FROM_SYSTEM
 #include <minizip/unzip.h>
 #else // from our embedded sources
 #include "unzip/unzip.h"
 #endif
 #include <sys/stat.h>
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32)
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <windows.h>
+#endif
 
 NS_CC_BEGIN
 
-// Implement DictMaker
+// the plists are read and written by PlistDocument
 
 #if (CC_TARGET_PLATFORM != CC_PLATFORM_IOS) && (CC_TARGET_PLATFORM != CC_PLATFORM_MAC)
 
-typedef enum
-{
-    SAX_NONE = 0,
-    SAX_KEY,
-    SAX_DICT,
-    SAX_INT,
-    SAX_REAL,
-    SAX_STRING,
-    SAX_ARRAY
-}SAXState;
-
-typedef enum
-{
-    SAX_RESULT_NONE = 0,
-    SAX_RESULT_DICT,
-    SAX_RESULT_ARRAY
-}SAXResult;
-
-class DictMaker : public SAXDelegator
-{
-public:
-    SAXResult _resultType;
-    ValueMap _rootDict;
-    ValueVector _rootArray;
-
-    std::string _curKey;   ///< parsed key
-    std::string _curValue; // parsed value
-    SAXState _state;
-
-    ValueMap*  _curDict;
-    ValueVector* _curArray;
-
-    std::stack<ValueMap*> _dictStack;
-    std::stack<ValueVector*> _arrayStack;
-    std::stack<SAXState>  _stateStack;
-
-public:
-    DictMaker()
-        : _resultType(SAX_RESULT_NONE)
-    {
-    }
-
-    ~DictMaker()
-    {
-    }
-
-    ValueMap dictionaryWithContentsOfFile(const std::string& fileName)
-    {
-        _resultType = SAX_RESULT_DICT;
-        SAXParser parser;
-
-        CCASSERT(parser.init("UTF-8"), "The file format isn't UTF-8");
-        parser.setDelegator(this);
-
-        parser.parse(fileName);
-        return _rootDict;
-    }
-
-    ValueMap dictionaryWithDataOfFile(const char* filedata, int filesize)
-    {
-        _resultType = SAX_RESULT_DICT;
-        SAXParser parser;
-
-        CCASSERT(parser.init("UTF-8"), "The file format isn't UTF-8");
-        parser.setDelegator(this);
-
-        parser.parse(filedata, filesize);
-        return _rootDict;
-    }
-
-    ValueVector arrayWithContentsOfFile(const std::string& fileName)
-    {
-        _resultType = SAX_RESULT_ARRAY;
-        SAXParser parser;
-
-        CCASSERT(parser.init("UTF-8"), "The file format isn't UTF-8");
-        parser.setDelegator(this);
-
-        parser.parse(fileName);
-        return _rootArray;
-    }
-
-    void startElement(void *ctx, const char *name, const char **atts)
-    {
-        CC_UNUSED_PARAM(ctx);
-        CC_UNUSED_PARAM(atts);
-        const std::string sName(name);
-        if( sName == "dict" )
-        {
-            if(_resultType == SAX_RESULT_DICT && _rootDict.empty())
-            {
-                _curDict = &_rootDict;
-            }
-
-            _state = SAX_DICT;
-
-            SAXState preState = SAX_NONE;
-            if (! _stateStack.empty())
-            {
-                preState = _stateStack.top();
-            }
-
-            if (SAX_ARRAY == preState)
-            {
-                // add a new dictionary into the array
-                _curArray->push_back(Value(ValueMap()));
-                _curDict = &(_curArray->rbegin())->asValueMap();
-            }
-            else if (SAX_DICT == preState)
-            {
-                // add a new dictionary into the pre dictionary
-                CCASSERT(! _dictStack.empty(), "The state is wrong!");
-                ValueMap* preDict = _dictStack.top();
-                (*preDict)[_curKey] = Value(ValueMap());
-                _curDict = &(*preDict)[_curKey].asValueMap();
-            }
-
-            // record the dict state
-            _stateStack.push(_state);
-            _dictStack.push(_curDict);
-        }
-        else if(sName == "key")
-        {
-            _state = SAX_KEY;
-        }
-        else if(sName == "integer")
-        {
-            _state = SAX_INT;
-        }
-        else if(sName == "real")
-        {
-            _state = SAX_REAL;
-        }
-        else if(sName == "string")
-        {
-            _state = SAX_STRING;
-        }
-        else if (sName == "array")
-        {
-            _state = SAX_ARRAY;
-
-            if (_resultType == SAX_RESULT_ARRAY && _rootArray.empty())
-            {
-                _curArray = &_rootArray;
-            }
-            SAXState preState = SAX_NONE;
-            if (! _stateStack.empty())
-            {
-                preState = _stateStack.top();
-            }
-
-            if (preState == SAX_DICT)
-            {
-                (*_curDict)[_curKey] = Value(ValueVector());
-                _curArray = &(*_curDict)[_curKey].asValueVector();
-            }
-            else if (preState == SAX_ARRAY)
-            {
-                CCASSERT(! _arrayStack.empty(), "The state is wrong!");
-                ValueVector* preArray = _arrayStack.top();
-                preArray->push_back(Value(ValueVector()));
-                _curArray = &(_curArray->rbegin())->asValueVector();
-            }
-            // record the array state
-            _stateStack.push(_state);
-            _arrayStack.push(_curArray);
-        }
-        else
-        {
-            _state = SAX_NONE;
-        }
-    }
-
-    void endElement(void *ctx, const char *name)
-    {
-        CC_UNUSED_PARAM(ctx);
-        SAXState curState = _stateStack.empty() ? SAX_DICT : _stateStack.top();
-        const std::string sName((char*)name);
-        if( sName == "dict" )
-        {
-            _stateStack.pop();
-            _dictStack.pop();
-            if ( !_dictStack.empty())
-            {
-                _curDict = _dictStack.top();
-            }
-        }
-        else if (sName == "array")
-        {
-            _stateStack.pop();
-            _arrayStack.pop();
-            if (! _arrayStack.empty())
-            {
-                _curArray = _arrayStack.top();
-            }
-        }
-        else if (sName == "true")
-        {
-            if (SAX_ARRAY == curState)
-            {
-                _curArray->push_back(Value(true));
-            }
-            else if (SAX_DICT == curState)
-            {
-                (*_curDict)[_curKey] = Value(true);
-            }
-        }
-        else if (sName == "false")
-        {
-            if (SAX_ARRAY == curState)
-            {
-                _curArray->push_back(Value(false));
-            }
-            else if (SAX_DICT == curState)
-            {
-                (*_curDict)[_curKey] = Value(false);
-            }
-        }
-        else if (sName == "string" || sName == "integer" || sName == "real")
-        {
-            if (SAX_ARRAY == curState)
-            {
-                if (sName == "string")
-                    _curArray->push_back(Value(_curValue));
-                else if (sName == "integer")
-                    _curArray->push_back(Value(atoi(_curValue.c_str())));
-                else
-                    _curArray->push_back(Value(utils::atof(_curValue.c_str())));
-            }
-            else if (SAX_DICT == curState)
-            {
-                if (sName == "string")
-                    (*_curDict)[_curKey] = Value(_curValue);
-                else if (sName == "integer")
-                    (*_curDict)[_curKey] = Value(atoi(_curValue.c_str()));
-                else
-                    (*_curDict)[_curKey] = Value(utils::atof(_curValue.c_str()));
-            }
-
-            _curValue.clear();
-        }
-
-        _state = SAX_NONE;
-    }
-
-    void textHandler(void *ctx, const char *ch, int len)
-    {
-        CC_UNUSED_PARAM(ctx);
-        if (_state == SAX_NONE)
-        {
-            return;
-        }
-
-        SAXState curState = _stateStack.empty() ? SAX_DICT : _stateStack.top();
-        const std::string text = std::string((char*)ch,len);
-
-        switch(_state)
-        {
-        case SAX_KEY:
-            _curKey = text;
-            break;
-        case SAX_INT:
-        case SAX_REAL:
-        case SAX_STRING:
-            {
-                if (curState == SAX_DICT)
-                {
-                    CCASSERT(!_curKey.empty(), "key not found : <integer/real>");
-                }
-
-                _curValue.append(text);
-            }
-            break;
-        default:
-            break;
-        }
-    }
-};
-
 ValueMap FileUtils::getValueMapFromFile(const std::string& filename)
 {
     const std::string fullPath = fullPathForFilename(filename);
@@ -335,33 +63,34 @@ ValueMap FileUtils::getValueMapFromFile(const std::string& filename)
         return ret;
     }
 
-    DictMaker tMaker;
-    return tMaker.dictionaryWithContentsOfFile(fullPath);
+    PlistDocument doc;
+    doc.initWithFile(fullPath);
+    return doc.getRoot().toValueMap();
 }
 
 ValueMap FileUtils::getValueMapFromData(const char* filedata, int filesize)
 {
-    DictMaker tMaker;
-    return tMaker.dictionaryWithDataOfFile(filedata, filesize);
+    PlistDocument doc;
+    doc.initWithData(filedata, filesize);
+    return doc.getRoot().toValueMap();
+}
+
+ValueMap FileUtils::getValueMapFromData(Data&& data)
+{
+    PlistDocument doc;
+    doc.initWithData(std::move(data));
+    return doc.getRoot().toValueMap();
 }
 
 ValueVector FileUtils::getValueVectorFromFile(const std::string& filename)
 {
     const std::string fullPath = fullPathForFilename(filename.c_str());
-    DictMaker tMaker;
-    return tMaker.arrayWithContentsOfFile(fullPath);
+    PlistDocument doc;
+    doc.initWithFile(fullPath);
+    return doc.getRoot().toValueVector();
 }
 
 
-/*
- * forward statement
- */
-static tinyxml2::XMLElement* generateElementForArray(const ValueVector& array, tinyxml2::XMLDocument *doc);
-static tinyxml2::XMLElement* generateElementForDict(const ValueMap& dict, tinyxml2::XMLDocument *doc);
-
-/*
- * Use tinyxml2 to write plist files
- */
 bool FileUtils::writeToFile(const ValueMap& dict, const std::string &fullPath)
 {
     return writeValueMapToFile(dict, fullPath);
@@ -369,203 +98,172 @@ bool FileUtils::writeToFile(const ValueMap& dict, const std::string &fullPath)
 
 bool FileUtils::writeValueMapToFile(const ValueMap& dict, const std::string& fullPath)
 {
-    tinyxml2::XMLDocument *doc = new (std::nothrow)tinyxml2::XMLDocument();
-    if (nullptr == doc)
-        return false;
+    Data data = PlistDocument::serialize(dict);
+    return !data.isNull() && writeDataToFile(data, fullPath);
+}
 
-    tinyxml2::XMLDeclaration *declaration = doc->NewDeclaration("xml version=\"1.0\" encoding=\"UTF-8\"");
-    if (nullptr == declaration)
-    {
-        delete doc;
-        return false;
-    }
+bool FileUtils::writeValueVectorToFile(const ValueVector& vecData, const std::string& fullPath)
+{
+    Data data = PlistDocument::serialize(vecData);
+    return !data.isNull() && writeDataToFile(data, fullPath);
+}
 
-    doc->LinkEndChild(declaration);
-    tinyxml2::XMLElement *docType = doc->NewElement("!DOCTYPE plist PUBLIC \"-//Apple//DTD PLIST 1.0//EN\" \"http://www.apple.com/DTDs/PropertyList-1.0.dtd\"");
-    doc->LinkEndChild(docType);
+#else
 
-    tinyxml2::XMLElement *rootEle = doc->NewElement("plist");
-    rootEle->SetAttribute("version", "1.0");
-    if (nullptr == rootEle)
-    {
-        delete doc;
-        return false;
-    }
-    doc->LinkEndChild(rootEle);
+/* The subclass FileUtilsApple should override these two method. */
+ValueMap FileUtils::getValueMapFromFile(const std::string& filename) {return ValueMap();}
+ValueMap FileUtils::getValueMapFromData(const char* filedata, int filesize) {return ValueMap();}
+ValueMap FileUtils::getValueMapFromData(Data&& data)
+{
+    // FileUtilsApple reads the bytes without copying them
+    return getValueMapFromData(reinterpret_cast<const char*>(data.getBytes()), static_cast<int>(data.getSize()));
+}
+ValueVector FileUtils::getValueVectorFromFile(const std::string& filename) {return ValueVector();}
+bool FileUtils::writeToFile(const ValueMap& dict, const std::string &fullPath) {return false;}
 
-    tinyxml2::XMLElement *innerDict = generateElementForDict(dict, doc);
-    if (nullptr == innerDict)
-    {
-        delete doc;
-        return false;
-    }
-    rootEle->LinkEndChild(innerDict);
+#endif /* (CC_TARGET_PLATFORM != CC_PLATFORM_IOS) && (CC_TARGET_PLATFORM != CC_PLATFORM_MAC) */
 
-    bool ret = tinyxml2::XML_SUCCESS == doc->SaveFile(getSuitableFOpen(fullPath).c_str());
+// Implement FileUtils
+FileUtils* FileUtils::s_sharedFileUtils = nullptr;
 
-    delete doc;
-    return ret;
+void FileUtils::destroyInstance()
+{
+    CC_SAFE_DELETE(s_sharedFileUtils);
 }
 
-bool FileUtils::writeValueVectorToFile(const ValueVector& vecData, const std::string& fullPath)
+// a delegate may transform the data it reads, the files are no longer mapped then
+static bool s_mapFiles = true;
+
+void FileUtils::setDelegate(FileUtils *delegate)
 {
-    tinyxml2::XMLDocument *doc = new (std::nothrow)tinyxml2::XMLDocument();
-    if (nullptr == doc)
-        return false;
+    if (s_sharedFileUtils)
+        delete s_sharedFileUtils;
 
-    tinyxml2::XMLDeclaration *declaration = doc->NewDeclaration("xml version=\"1.0\" encoding=\"UTF-8\"");
-    if (nullptr == declaration)
-    {
-        delete doc;
-        return false;
-    }
+    s_sharedFileUtils = delegate;
+    s_mapFiles = (delegate == nullptr);
+}
 
-    doc->LinkEndChild(declaration);
-    tinyxml2::XMLElement *docType = doc->NewElement("!DOCTYPE plist PUBLIC \"-//Apple//DTD PLIST 1.0//EN\" \"http://www.apple.com/DTDs/PropertyList-1.0.dtd\"");
-    doc->LinkEndChild(docType);
+FilePathCache::Shard& FilePathCache::getShard(const std::string& key) const
+{
+    return _shards[std::hash<std::string>()(key) % SHARD_COUNT];
+}
 
-    tinyxml2::XMLElement *rootEle = doc->NewElement("plist");
-    rootEle->SetAttribute("version", "1.0");
-    if (nullptr == rootEle)
+bool FilePathCache::find(const std::string& key, std::string* value) const
+{
+    Shard& shard = getShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto iter = shard.entries.find(key);
+    if (iter == shard.entries.end())
     {
-        delete doc;
         return false;
     }
-    doc->LinkEndChild(rootEle);
-
-    tinyxml2::XMLElement *innerDict = generateElementForArray(vecData, doc);
-    if (nullptr == innerDict)
+    if (value)
     {
-        delete doc;
-        return false;
+        *value = iter->second;
     }
-    rootEle->LinkEndChild(innerDict);
-
-    bool ret = tinyxml2::XML_SUCCESS == doc->SaveFile(getSuitableFOpen(fullPath).c_str());
-
-    delete doc;
-    return ret;
+    return true;
 }
 
-/*
- * Generate tinyxml2::XMLElement for Object through a tinyxml2::XMLDocument
- */
-static tinyxml2::XMLElement* generateElementForObject(const Value& value, tinyxml2::XMLDocument *doc)
+void FilePathCache::insert(const std::string& key, const std::string& value)
 {
-    // object is String
-    if (value.getType() == Value::Type::STRING)
-    {
-        tinyxml2::XMLElement* node = doc->NewElement("string");
-        tinyxml2::XMLText* content = doc->NewText(value.asString().c_str());
-        node->LinkEndChild(content);
-        return node;
-    }
+    Shard& shard = getShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.entries.insert(std::make_pair(key, value));
+}
 
-    // object is integer
-    if (value.getType() == Value::Type::INTEGER)
+void FilePathCache::clear()
+{
+    for (auto& shard : _shards)
     {
-        tinyxml2::XMLElement* node = doc->NewElement("integer");
-        tinyxml2::XMLText* content = doc->NewText(value.asString().c_str());
-        node->LinkEndChild(content);
-        return node;
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.entries.clear();
     }
+}
 
-    // object is real
-    if (value.getType() == Value::Type::FLOAT || value.getType() == Value::Type::DOUBLE)
+std::unordered_map<std::string, std::string> FilePathCache::toMap() const
+{
+    std::unordered_map<std::string, std::string> ret;
+    for (auto& shard : _shards)
     {
-        tinyxml2::XMLElement* node = doc->NewElement("real");
-        tinyxml2::XMLText* content = doc->NewText(value.asString().c_str());
-        node->LinkEndChild(content);
-        return node;
-    }
-
-    //object is bool
-    if (value.getType() == Value::Type::BOOLEAN) {
-        tinyxml2::XMLElement* node = doc->NewElement(value.asString().c_str());
-        return node;
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        ret.insert(shard.entries.begin(), shard.entries.end());
     }
-
-    // object is Array
-    if (value.getType() == Value::Type::VECTOR)
-        return generateElementForArray(value.asValueVector(), doc);
-
-    // object is Dictionary
-    if (value.getType() == Value::Type::MAP)
-        return generateElementForDict(value.asValueMap(), doc);
-
-    CCLOG("This type cannot appear in property list");
-    return nullptr;
+    return ret;
 }
 
-/*
- * Generate tinyxml2::XMLElement for Dictionary through a tinyxml2::XMLDocument
- */
-static tinyxml2::XMLElement* generateElementForDict(const ValueMap& dict, tinyxml2::XMLDocument *doc)
+FileView::FileView()
+: _bytes(nullptr)
+, _size(0)
 {
-    tinyxml2::XMLElement* rootNode = doc->NewElement("dict");
+}
 
-    for (const auto &iter : dict)
-    {
-        tinyxml2::XMLElement* tmpNode = doc->NewElement("key");
-        rootNode->LinkEndChild(tmpNode);
-        tinyxml2::XMLText* content = doc->NewText(iter.first.c_str());
-        tmpNode->LinkEndChild(content);
+FileView::FileView(Data&& data)
+: _bytes(data.getBytes())
+, _size(data.getSize())
+, _data(std::move(data))
+{
+}
 
-        tinyxml2::XMLElement *element = generateElementForObject(iter.second, doc);
-        if (element)
-            rootNode->LinkEndChild(element);
-    }
-    return rootNode;
+FileView::FileView(const unsigned char* bytes, ssize_t size, const std::function<void()>& release)
+: _bytes(bytes)
+, _size(size)
+, _release(release)
+{
 }
 
-/*
- * Generate tinyxml2::XMLElement for Array through a tinyxml2::XMLDocument
- */
-static tinyxml2::XMLElement* generateElementForArray(const ValueVector& array, tinyxml2::XMLDocument *pDoc)
+FileView::FileView(FileView&& other)
+: _bytes(other._bytes)
+, _size(other._size)
+, _data(std::move(other._data))
+, _release(std::move(other._release))
 {
-    tinyxml2::XMLElement* rootNode = pDoc->NewElement("array");
+    other._bytes = nullptr;
+    other._size = 0;
+    other._release = nullptr;
+}
 
-    for(const auto &value : array) {
-        tinyxml2::XMLElement *element = generateElementForObject(value, pDoc);
-        if (element)
-            rootNode->LinkEndChild(element);
+FileView& FileView::operator= (FileView&& other)
+{
+    if (this != &other)
+    {
+        release();
+        _bytes = other._bytes;
+        _size = other._size;
+        _data = std::move(other._data);
+        _release = std::move(other._release);
+        other._bytes = nullptr;
+        other._size = 0;
+        other._release = nullptr;
     }
-    return rootNode;
+    return *this;
 }
 
-#else
-
-/* The subclass FileUtilsApple should override these two method. */
-ValueMap FileUtils::getValueMapFromFile(const std::string& filename) {return ValueMap();}
-ValueMap FileUtils::getValueMapFromData(const char* filedata, int filesize) {return ValueMap();}
-ValueVector FileUtils::getValueVectorFromFile(const std::string& filename) {return ValueVector();}
-bool FileUtils::writeToFile(const ValueMap& dict, const std::string &fullPath) {return false;}
-
-#endif /* (CC_TARGET_PLATFORM != CC_PLATFORM_IOS) && (CC_TARGET_PLATFORM != CC_PLATFORM_MAC) */
-
-// Implement FileUtils
-FileUtils* FileUtils::s_sharedFileUtils = nullptr;
-
-void FileUtils::destroyInstance()
+FileView::~FileView()
 {
-    CC_SAFE_DELETE(s_sharedFileUtils);
+    release();
 }
 
-void FileUtils::setDelegate(FileUtils *delegate)
+void FileView::release()
 {
-    if (s_sharedFileUtils)
-        delete s_sharedFileUtils;
-
-    s_sharedFileUtils = delegate;
+    if (_release)
+    {
+        _release();
+        _release = nullptr;
+    }
+    _data.clear();
+    _bytes = nullptr;
+    _size = 0;
 }
 
 FileUtils::FileUtils()
-    : _writablePath("")
+    : _asyncWriteCount(0)
+    , _writablePath("")
 {
 }
 
 FileUtils::~FileUtils()
 {
+    waitForAsyncWrites();
 }
 
 bool FileUtils::writeStringToFile(const std::string& dataStr, const std::string& fullPath)
@@ -586,6 +284,8 @@ bool FileUtils::writeDataToFile(const Data& retData, const std::string& fullPath
 
     CCASSERT(!fullPath.empty() && retData.getSize() != 0, "Invalid parameters.");
 
+    _missingFileCache.clear();
+
     auto fileutils = FileUtils::getInstance();
     do
     {
@@ -604,6 +304,128 @@ bool FileUtils::writeDataToFile(const Data& retData, const std::string& fullPath
     return false;
 }
 
+bool FileUtils::writeDataToFileAtomically(const Data& data, const std::string& fullPath)
+{
+    const std::string path = getSuitableFOpen(fullPath);
+    const std::string tempPath = path + ".tmp";
+
+    FILE *fp = fopen(tempPath.c_str(), "wb");
+    if (!fp)
+    {
+        return false;
+    }
+
+    bool written = fwrite(data.getBytes(), 1, data.getSize(), fp) == (size_t)data.getSize() && fflush(fp) == 0;
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32)
+    // the rename must not reach the disk before the data
+    written = written && fsync(fileno(fp)) == 0;
+#endif
+    written = fclose(fp) == 0 && written;
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+    written = written && MoveFileExA(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    written = written && rename(tempPath.c_str(), path.c_str()) == 0;
+#endif
+
+    if (!written)
+    {
+        CCLOG("cocos2d: FileUtils: failed to write %s", fullPath.c_str());
+        remove(tempPath.c_str());
+    }
+    return written;
+}
+
+void FileUtils::enqueueWrite(const std::string& fullPath, std::function<Data()>&& serialize, const WriteCallback& callback)
+{
+    CCASSERT(!fullPath.empty(), "Invalid parameters.");
+
+    {
+        std::lock_guard<std::mutex> lock(_asyncWriteMutex);
+        auto iter = _pendingWrites.find(fullPath);
+        if (iter != _pendingWrites.end())
+        {
+            // the queued write didn't start yet, only the latest data is written
+            iter->second.serialize = std::move(serialize);
+            if (callback)
+                iter->second.callbacks.push_back(callback);
+            return;
+        }
+
+        PendingWrite& write = _pendingWrites[fullPath];
+        write.serialize = std::move(serialize);
+        if (callback)
+            write.callbacks.push_back(callback);
+        ++_asyncWriteCount;
+    }
+
+    struct Result
+    {
+        bool written;
+        std::vector<WriteCallback> callbacks;
+    };
+    auto result = std::make_shared<Result>();
+    result->written = false;
+
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO, [result](void*) {
+        for (const auto& callback : result->callbacks)
+        {
+            callback(result->written);
+        }
+    }, nullptr, [this, fullPath, result]() {
+        std::function<Data()> serialize;
+        {
+            std::lock_guard<std::mutex> lock(_asyncWriteMutex);
+            auto iter = _pendingWrites.find(fullPath);
+            serialize = std::move(iter->second.serialize);
+            result->callbacks = std::move(iter->second.callbacks);
+            _pendingWrites.erase(iter);
+        }
+
+        Data data = serialize();
+        result->written = !data.isNull() && writeDataToFileAtomically(data, fullPath);
+        _missingFileCache.clear();
+
+        std::lock_guard<std::mutex> lock(_asyncWriteMutex);
+        --_asyncWriteCount;
+        _asyncWriteDone.notify_all();
+    });
+}
+
+void FileUtils::writeDataToFileAsync(Data data, const std::string& fullPath, const WriteCallback& callback)
+{
+    auto shared = std::make_shared<Data>(std::move(data));
+    enqueueWrite(fullPath, [shared]() { return std::move(*shared); }, callback);
+}
+
+void FileUtils::writeStringToFileAsync(std::string dataStr, const std::string& fullPath, const WriteCallback& callback)
+{
+    auto shared = std::make_shared<std::string>(std::move(dataStr));
+    enqueueWrite(fullPath, [shared]() {
+        Data data;
+        data.copy(reinterpret_cast<const unsigned char*>(shared->c_str()), shared->size());
+        return data;
+    }, callback);
+}
+
+void FileUtils::writeValueMapToFileAsync(ValueMap dict, const std::string& fullPath, const WriteCallback& callback, PlistDocument::Format format)
+{
+    auto shared = std::make_shared<ValueMap>(std::move(dict));
+    enqueueWrite(fullPath, [shared, format]() { return PlistDocument::serialize(*shared, format); }, callback);
+}
+
+void FileUtils::writeValueVectorToFileAsync(ValueVector vecData, const std::string& fullPath, const WriteCallback& callback, PlistDocument::Format format)
+{
+    auto shared = std::make_shared<ValueVector>(std::move(vecData));
+    enqueueWrite(fullPath, [shared, format]() { return PlistDocument::serialize(*shared, format); }, callback);
+}
+
+void FileUtils::waitForAsyncWrites()
+{
+    std::unique_lock<std::mutex> lock(_asyncWriteMutex);
+    _asyncWriteDone.wait(lock, [this]() { return _asyncWriteCount == 0; });
+}
+
 bool FileUtils::init()
 {
     _searchPathArray.push_back(_defaultResRootPath);
@@ -614,6 +436,8 @@ bool FileUtils::init()
 void FileUtils::purgeCachedEntries()
 {
     _fullPathCache.clear();
+    _textureFullPathCache.clear();
+    _missingFileCache.clear();
 }
 
 static Data getData(const std::string& filename, bool forString)
@@ -683,19 +507,86 @@ static Data getData(const std::string& filename, bool forString)
 
 std::string FileUtils::getStringFromFile(const std::string& filename)
 {
-    Data data = getData(filename, true);
-    if (data.isNull())
+    // the string is the only copy of a mapped file
+    FileView view = getFileView(filename);
+    if (view.isNull())
         return "";
 
-    std::string ret((const char*)data.getBytes());
-    return ret;
+    // like the C string it was read as, it stops at the first null character
+    const char* bytes = reinterpret_cast<const char*>(view.getBytes());
+    const char* end = static_cast<const char*>(memchr(bytes, '\0', view.getSize()));
+    return std::string(bytes, end ? end - bytes : view.getSize());
 }
 
 Data FileUtils::getDataFromFile(const std::string& filename)
 {
+    Data data;
+    if (getDataFromAssetPack(filename, false, &data))
+    {
+        return data;
+    }
     return getData(filename, false);
 }
 
+FileView FileUtils::getFileView(const std::string& filename)
+{
+    if (s_mapFiles)
+    {
+        std::string fullPath = fullPathForFilename(filename);
+        if (!fullPath.empty())
+        {
+            std::string name;
+            AssetPack::Entry entry;
+            AssetPack* pack = findAssetPack(fullPath, &name);
+            if (pack && pack->findEntry(name, &entry))
+            {
+                return pack->getFileView(entry);
+            }
+
+            FileView view = mapFile(fullPath);
+            if (!view.isNull())
+            {
+                return view;
+            }
+        }
+    }
+
+    return FileView(getDataFromFile(filename));
+}
+
+FileView FileUtils::mapFile(const std::string& fullPath)
+{
+    // FileUtilsWin32 maps with MapViewOfFile
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32)
+    int fd = open(getSuitableFOpen(fullPath).c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return FileView();
+    }
+
+    struct stat st;
+    void* bytes = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        bytes = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    // the mapping keeps its own reference to the file
+    close(fd);
+
+    if (bytes == MAP_FAILED)
+    {
+        return FileView();
+    }
+
+    size_t size = st.st_size;
+    return FileView(static_cast<const unsigned char*>(bytes), size, [bytes, size]() {
+        munmap(bytes, size);
+    });
+#else
+    return FileView();
+#endif
+}
+
 unsigned char* FileUtils::getFileData(const std::string& filename, const char* mode, ssize_t *size)
 {
     unsigned char * buffer = nullptr;
@@ -825,42 +716,353 @@ std::string FileUtils::fullPathForFilename(const std::string &filename) const
         return filename;
     }
 
+    std::string fullpath = searchFullPathForFilename(filename);
+
+    if(fullpath.empty() && isPopupNotify()){
+        CCLOG("cocos2d: fullPathForFilename: No file found at %s. Possible missing file.", filename.c_str());
+    }
+
+    return fullpath;
+}
+
+// appends the name getPathForFilename() looks for, like getFullPathForDirectoryAndFilename() it only adds the '/' when needed
+static void appendResolvedName(std::string& name, const std::string& filePath, const std::string& resolutionDirectory, const std::string& file)
+{
+    name += filePath;
+    name += resolutionDirectory;
+    if (!name.empty() && name[name.length()-1] != '/')
+    {
+        name += '/';
+    }
+    name += file;
+}
+
+std::string FileUtils::searchFullPathForFilename(const std::string &filename) const
+{
     // Already Cached ?
-    auto cacheIter = _fullPathCache.find(filename);
-    if(cacheIter != _fullPathCache.end())
+    std::string cached;
+    if (_fullPathCache.find(filename, &cached))
     {
-        return cacheIter->second;
+        return cached;
+    }
+    if (_missingFileCache.contains(filename))
+    {
+        return "";
     }
 
     // Get the new file name.
     const std::string newFilename( getNewFilename(filename) );
+    // the manifest names are normalized, "./" and "../" have to be probed
+    const bool useManifest = !_fileManifest.empty() && newFilename.find("./") == std::string::npos;
+
+    std::string file = newFilename;
+    std::string file_path = "";
+    if (useManifest)
+    {
+        size_t pos = newFilename.find_last_of("/");
+        if (pos != std::string::npos)
+        {
+            file_path = newFilename.substr(0, pos+1);
+            file = newFilename.substr(pos+1);
+        }
+    }
+    std::string name;
 
     std::string fullpath;
 
+    // the packs are hash lookups, try them before the file system
+    if (!_assetPacks.empty())
+    {
+        fullpath = searchAssetPacks(newFilename, true);
+        if (!fullpath.empty())
+        {
+            _fullPathCache.insert(filename, fullpath);
+            return fullpath;
+        }
+    }
+
     for (const auto& searchIt : _searchPathArray)
     {
+        // an empty root is the bundle of iOS and Mac, the absolute search paths are outside of it
+        const bool inManifest = useManifest && (_fileManifestRoot.empty() ?
+            !isAbsolutePath(searchIt) : searchIt.compare(0, _fileManifestRoot.length(), _fileManifestRoot) == 0);
+
         for (const auto& resolutionIt : _searchResolutionsOrderArray)
         {
+            if (inManifest)
+            {
+                name.assign(searchIt, _fileManifestRoot.length(), std::string::npos);
+                appendResolvedName(name, file_path, resolutionIt, file);
+                if (_fileManifest.find(name) == _fileManifest.end())
+                {
+                    continue;
+                }
+            }
+
             fullpath = this->getPathForFilename(newFilename, resolutionIt, searchIt);
 
             if (!fullpath.empty())
             {
                 // Using the filename passed in as key.
-                _fullPathCache.insert(std::make_pair(filename, fullpath));
+                _fullPathCache.insert(filename, fullpath);
                 return fullpath;
             }
 
         }
     }
 
-    if(isPopupNotify()){
-        CCLOG("cocos2d: fullPathForFilename: No file found at %s. Possible missing file.", filename.c_str());
+    if (!_assetPacks.empty())
+    {
+        fullpath = searchAssetPacks(newFilename, false);
+        if (!fullpath.empty())
+        {
+            _fullPathCache.insert(filename, fullpath);
+            return fullpath;
+        }
     }
 
     // The file wasn't found, return empty string.
+    _missingFileCache.insert(filename, "");
+    return "";
+}
+
+std::string FileUtils::searchAssetPacks(const std::string& filename, bool front) const
+{
+    std::string file = filename;
+    std::string file_path = "";
+    size_t pos = filename.find_last_of("/");
+    if (pos != std::string::npos)
+    {
+        file_path = filename.substr(0, pos+1);
+        file = filename.substr(pos+1);
+    }
+
+    // the same names as getPathForFilename(), relative to the root of the pack
+    std::string name;
+    for (const auto& mounted : _assetPacks)
+    {
+        if (mounted.front != front)
+        {
+            continue;
+        }
+
+        for (const auto& resolutionIt : _searchResolutionsOrderArray)
+        {
+            name.clear();
+            appendResolvedName(name, file_path, resolutionIt, file);
+
+            if (mounted.pack->findEntry(name, nullptr))
+            {
+                return mounted.root + name;
+            }
+        }
+    }
+
     return "";
 }
 
+AssetPack* FileUtils::findAssetPack(const std::string& fullPath, std::string* name) const
+{
+    for (const auto& mounted : _assetPacks)
+    {
+        if (fullPath.compare(0, mounted.root.length(), mounted.root) == 0)
+        {
+            *name = fullPath.substr(mounted.root.length());
+            return mounted.pack.get();
+        }
+    }
+
+    return nullptr;
+}
+
+bool FileUtils::getDataFromAssetPack(const std::string& filename, bool forString, Data* data) const
+{
+    if (_assetPacks.empty() || filename.empty())
+    {
+        return false;
+    }
+
+    const std::string fullPath = isAbsolutePath(filename) ? filename : searchFullPathForFilename(filename);
+    std::string name;
+    AssetPack::Entry entry;
+    AssetPack* pack = findAssetPack(fullPath, &name);
+    if (pack == nullptr || !pack->findEntry(name, &entry))
+    {
+        return false;
+    }
+
+    *data = pack->getData(entry, forString);
+    return true;
+}
+
+bool FileUtils::mountAssetPack(const std::string& filename, bool front)
+{
+    for (const auto& mounted : _assetPacks)
+    {
+        if (mounted.filename == filename)
+        {
+            return true;
+        }
+    }
+
+    const std::string fullPath = fullPathForFilename(filename);
+    if (fullPath.empty())
+    {
+        return false;
+    }
+
+    auto pack = AssetPack::create(getFileView(fullPath));
+    if (!pack)
+    {
+        CCLOG("cocos2d: FileUtils: can't mount the asset pack %s", filename.c_str());
+        return false;
+    }
+
+    MountedAssetPack mounted;
+    mounted.filename = filename;
+    mounted.root = fullPath + "/";
+    mounted.pack = pack;
+    mounted.front = front;
+    // the last pack mounted in front comes first, like addSearchPath()
+    if (front)
+    {
+        _assetPacks.insert(_assetPacks.begin(), mounted);
+    }
+    else
+    {
+        _assetPacks.push_back(mounted);
+    }
+
+    _fullPathCache.clear();
+    _textureFullPathCache.clear();
+    _missingFileCache.clear();
+    return true;
+}
+
+bool FileUtils::loadFileManifest(const std::string& filename)
+{
+    FileView view = getFileView(filename);
+    if (view.isNull())
+    {
+        CCLOG("cocos2d: FileUtils: can't load the file manifest %s", filename.c_str());
+        return false;
+    }
+
+    _fileManifest.clear();
+    _fileManifestRoot = _defaultResRootPath;
+
+    const char* p = reinterpret_cast<const char*>(view.getBytes());
+    const char* end = p + view.getSize();
+    while (p < end)
+    {
+        const char* lineEnd = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (lineEnd == nullptr)
+        {
+            lineEnd = end;
+        }
+
+        const char* last = lineEnd;
+        if (last > p && last[-1] == '\r')
+        {
+            --last;
+        }
+        if (last > p && *p != '#')
+        {
+            _fileManifest.emplace(p, last - p);
+        }
+
+        p = lineEnd + 1;
+    }
+
+    _fullPathCache.clear();
+    _textureFullPathCache.clear();
+    _missingFileCache.clear();
+    return true;
+}
+
+void FileUtils::clearFileManifest()
+{
+    _fileManifest.clear();
+    _fileManifestRoot.clear();
+    _fullPathCache.clear();
+    _textureFullPathCache.clear();
+    _missingFileCache.clear();
+}
+
+void FileUtils::unmountAssetPack(const std::string& filename)
+{
+    for (auto iter = _assetPacks.begin(); iter != _assetPacks.end(); ++iter)
+    {
+        if (iter->filename == filename)
+        {
+            _assetPacks.erase(iter);
+            _fullPathCache.clear();
+            _textureFullPathCache.clear();
+            _missingFileCache.clear();
+            return;
+        }
+    }
+}
+
+std::string FileUtils::fullPathForTextureFilename(const std::string &filename) const
+{
+    if (_textureVariants.empty() || filename.empty())
+    {
+        return fullPathForFilename(filename);
+    }
+
+    std::string cached;
+    if (_textureFullPathCache.find(filename, &cached))
+    {
+        return cached;
+    }
+
+    size_t dot = filename.find_last_of('.');
+    size_t slash = filename.find_last_of('/');
+    std::string basename = (dot != std::string::npos && (slash == std::string::npos || dot > slash)) ? filename.substr(0, dot) : filename;
+
+    std::string fullpath;
+    for (const auto& suffix : _textureVariants)
+    {
+        std::string variant = basename + suffix;
+        if (isAbsolutePath(variant))
+        {
+            fullpath = isFileExistInternal(variant) ? variant : "";
+        }
+        else
+        {
+            fullpath = searchFullPathForFilename(variant);
+        }
+
+        if (!fullpath.empty())
+        {
+            break;
+        }
+    }
+
+    if (fullpath.empty())
+    {
+        fullpath = fullPathForFilename(filename);
+    }
+
+    if (!fullpath.empty())
+    {
+        _textureFullPathCache.insert(filename, fullpath);
+    }
+    return fullpath;
+}
+
+void FileUtils::setTextureVariants(const std::vector<std::string>& suffixes)
+{
+    _textureFullPathCache.clear();
+    _textureVariants = suffixes;
+}
+
+const std::vector<std::string>& FileUtils::getTextureVariants() const
+{
+    return _textureVariants;
+}
+
 std::string FileUtils::fullPathFromRelativeFile(const std::string &filename, const std::string &relativeFile)
 {
     return relativeFile.substr(0, relativeFile.rfind('/')+1) + getNewFilename(filename);
@@ -870,6 +1072,8 @@ void FileUtils::setSearchResolutionsOrder(const std::vector<std::string>& search
 {
     bool existDefault = false;
     _fullPathCache.clear();
+    _textureFullPathCache.clear();
+    _missingFileCache.clear();
     _searchResolutionsOrderArray.clear();
     for(const auto& iter : searchResolutionsOrder)
     {
@@ -947,6 +1151,8 @@ void FileUtils::setSearchPaths(const std::vector<std::string>& searchPaths)
     bool existDefaultRootPath = false;
 
     _fullPathCache.clear();
+    _textureFullPathCache.clear();
+    _missingFileCache.clear();
     _searchPathArray.clear();
     for (const auto& iter : searchPaths)
     {
@@ -987,6 +1193,12 @@ void FileUtils::addSearchPath(const std::string &searchpath,const bool front)
     {
         path += "/";
     }
+
+    // a new path may shadow the found files or have the missing ones
+    _fullPathCache.clear();
+    _textureFullPathCache.clear();
+    _missingFileCache.clear();
+
     if (front) {
         _searchPathArray.insert(_searchPathArray.begin(), path);
     } else {
@@ -997,6 +1209,8 @@ void FileUtils::addSearchPath(const std::string &searchpath,const bool front)
 void FileUtils::setFilenameLookupDictionary(const ValueMap& filenameLookupDict)
 {
     _fullPathCache.clear();
+    _textureFullPathCache.clear();
+    _missingFileCache.clear();
     _filenameLookupDict = filenameLookupDict;
 }
 
@@ -1040,6 +1254,12 @@ bool FileUtils::isFileExist(const std::string& filename) const
 {
     if (isAbsolutePath(filename))
     {
+        std::string name;
+        AssetPack* pack = findAssetPack(filename, &name);
+        if (pack)
+        {
+            return pack->findEntry(name, nullptr);
+        }
         return isFileExistInternal(filename);
     }
     else
@@ -1067,10 +1287,10 @@ bool FileUtils::isDirectoryExist(const std::string& dirPath) const
     }
 
     // Already Cached ?
-    auto cacheIter = _fullPathCache.find(dirPath);
-    if( cacheIter != _fullPathCache.end() )
+    std::string cached;
+    if (_fullPathCache.find(dirPath, &cached))
     {
-        return isDirectoryExistInternal(cacheIter->second);
+        return isDirectoryExistInternal(cached);
     }
 
     std::string fullpath;
@@ -1082,7 +1302,7 @@ bool FileUtils::isDirectoryExist(const std::string& dirPath) const
             fullpath = searchIt + dirPath + resolutionIt;
             if (isDirectoryExistInternal(fullpath))
             {
-                _fullPathCache.insert(std::make_pair(dirPath, fullpath));
+                _fullPathCache.insert(dirPath, fullpath);
                 return true;
             }
         }
@@ -1250,6 +1470,8 @@ bool FileUtils::renameFile(const std::string &oldfullpath, const std::string &ne
     CCASSERT(!oldfullpath.empty(), "Invalid path");
     CCASSERT(!newfullpath.empty(), "Invalid path");
 
+    _missingFileCache.clear();
+
     int errorCode = rename(oldfullpath.c_str(), newfullpath.c_str());
 
     if (0 != errorCode)
@@ -1287,6 +1509,14 @@ long FileUtils::getFileSize(const std::string &filepath)
             return 0;
     }
 
+    std::string name;
+    AssetPack::Entry entry;
+    AssetPack* pack = findAssetPack(fullpath, &name);
+    if (pack)
+    {
+        return pack->findEntry(name, &entry) ? (long)entry.size : -1;
+    }
+
     struct stat info;
     // Get data associated with "crt_stat.c":
     int result = stat(fullpath.c_str(), &info);
@@ -28,11 +28,17 @@ THE SOFTWARE.
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
 
 #include "platform/CCPlatformMacros.h"
 #include "base/ccTypes.h"
 #include "base/CCValue.h"
 #include "base/CCData.h"
+#include "platform/CCPlistDocument.h"
 
 NS_CC_BEGIN
 
@@ -41,7 +47,80 @@ NS_CC_BEGIN
  * @{
  */
 
-/** Helper class to handle file operations. */
+/**
+ * The read-only bytes of a whole file, see FileUtils::getFileView().
+ * They are a memory mapping, an Android asset buffer or a heap copy, and are released with the view.
+ */
+class CC_DLL FileView
+{
+public:
+    /** An empty view. */
+    FileView();
+    /** A view of a heap copy. */
+    explicit FileView(Data&& data);
+    /** A view of `size` bytes at `bytes`, `release` is called when the view goes away. */
+    FileView(const unsigned char* bytes, ssize_t size, const std::function<void()>& release);
+    FileView(FileView&& other);
+    FileView& operator= (FileView&& other);
+    ~FileView();
+
+    const unsigned char* getBytes() const { return _bytes; }
+    ssize_t getSize() const { return _size; }
+    bool isNull() const { return _bytes == nullptr; }
+
+private:
+    FileView(const FileView&) = delete;
+    FileView& operator= (const FileView&) = delete;
+    void release();
+
+    const unsigned char* _bytes;
+    ssize_t _size;
+    Data _data;
+    std::function<void()> _release;
+};
+
+/**
+ * The path caches of FileUtils, they are shared by the threads that load files.
+ * The entries are split in shards with their own lock, so the lookups of different files seldom wait for each other.
+ * @js NA
+ */
+class CC_DLL FilePathCache
+{
+public:
+    /** Returns whether `key` is cached, and copies its value in `value` if it isn't null. */
+    bool find(const std::string& key, std::string* value) const;
+    bool contains(const std::string& key) const { return find(key, nullptr); }
+    /** Caches `value` for `key`, keeps the current value if there is one. */
+    void insert(const std::string& key, const std::string& value);
+    void clear();
+    /** A copy of all the entries. */
+    std::unordered_map<std::string, std::string> toMap() const;
+
+private:
+    static const int SHARD_COUNT = 16;
+
+    struct Shard
+    {
+        std::mutex mutex;
+        std::unordered_map<std::string, std::string> entries;
+    };
+
+    Shard& getShard(const std::string& key) const;
+
+    mutable Shard _shards[SHARD_COUNT];
+};
+
+class AssetPack;
+
+/**
+ * Helper class to handle file operations.
+ *
+ * The lookups and reads (fullPathForFilename(), fullPathForTextureFilename(), isFileExist(), getFileSize(),
+ * getDataFromFile(), getStringFromFile(), getFileView(), getValueMapFromFile() and getValueVectorFromFile())
+ * can be called from any thread. The methods that change where files are found (the search paths, resolution orders,
+ * lookup dictionary, texture variants, packs and manifest) must be called on the main thread while no other thread
+ * is loading files, e.g. before starting the background loads or once they are done.
+ */
 class CC_DLL FileUtils
 {
 public:
@@ -93,6 +172,16 @@ public:
      */
     virtual Data getDataFromFile(const std::string& filename);
 
+    /**
+     *  Gets the bytes of a file without copying them when the platform can map it:
+     *  mmap on iOS, OS X and the Android files, MapViewOfFile on Windows, AAsset_getBuffer on the uncompressed Android assets.
+     *  The other files are read with getDataFromFile(), so does every file once a delegate is set,
+     *  the delegate may have to decrypt them.
+     *
+     *  @since v3.11
+     */
+    FileView getFileView(const std::string& filename);
+
     /**
      *  Gets resource file data
      *
@@ -162,6 +251,33 @@ public:
      */
     virtual std::string fullPathForFilename(const std::string &filename) const;
 
+    /**
+     *  Returns the fullpath of the preferred variant of an image, or fullPathForFilename(filename) when it has none.
+     *  A variant is the filename with its extension replaced by one of the texture variant suffixes,
+     *  e.g. "hero.png" has the variants "hero.astc.ktx" and "hero.etc2.ktx" with the suffixes ".astc.ktx" and ".etc2.ktx".
+     *  TextureCache resolves its images with this method.
+     *
+     *  @see setTextureVariants()
+     *  @since v3.11
+     */
+    virtual std::string fullPathForTextureFilename(const std::string &filename) const;
+
+    /**
+     *  Sets the suffixes of the texture variants, the most preferred first.
+     *  Director sets them from the compressed formats the GPU supports when the OpenGL view is set,
+     *  unless the "cocos2d.x.texture.variants" configuration key is false.
+     *
+     *  @see fullPathForTextureFilename()
+     *  @since v3.11
+     */
+    virtual void setTextureVariants(const std::vector<std::string>& suffixes);
+
+    /**
+     *  Gets the suffixes of the texture variants.
+     *  @since v3.11
+     */
+    virtual const std::vector<std::string>& getTextureVariants() const;
+
     /**
      * Loads the filenameLookup dictionary from the contents of a filename.
      *
@@ -321,6 +437,11 @@ public:
      */
     virtual ValueMap getValueMapFromData(const char* filedata, int filesize);
 
+    /** Converts the contents of a file to a ValueMap, parsing `data` in place instead of a copy of it.
+     *  This method is used internally.
+     */
+    ValueMap getValueMapFromData(Data&& data);
+
     /**
     * write a ValueMap into a plist file
     *
@@ -367,6 +488,61 @@ public:
     */
     virtual bool writeValueVectorToFile(const ValueVector& vecData, const std::string& fullPath);
 
+    /** Called on the main thread when an asynchronous write is done, with whether the file was written. */
+    typedef std::function<void(bool)> WriteCallback;
+
+    /**
+     * Writes data into a file on the IO thread of AsyncTaskPool, the file is replaced atomically.
+     * The data is written to `fullPath.tmp`, flushed to the disk, then renamed over `fullPath`: a crash or a
+     * power loss leaves the old file or the new one, never a part of it.
+     * The writes run one after the other. A write to a file whose previous write didn't start yet replaces it,
+     * the callbacks of both are called when the file is written.
+     *
+     * @param data The data to save, it is moved to the IO thread.
+     * @param fullPath The full path to the file.
+     * @param callback Called on the main thread when done, may be nullptr.
+     * @since v3.11
+     * @js NA
+     * @lua NA
+     */
+    void writeDataToFileAsync(Data data, const std::string& fullPath, const WriteCallback& callback = nullptr);
+
+    /**
+     * Writes a string into a file like writeDataToFileAsync().
+     * @since v3.11
+     * @js NA
+     * @lua NA
+     */
+    void writeStringToFileAsync(std::string dataStr, const std::string& fullPath, const WriteCallback& callback = nullptr);
+
+    /**
+     * Writes a ValueMap into a plist file like writeDataToFileAsync(), the ValueMap is copied and serialized on
+     * the IO thread. The binary plists are smaller and faster to read, getValueMapFromFile() reads both formats.
+     * @since v3.11
+     * @js NA
+     * @lua NA
+     */
+    void writeValueMapToFileAsync(ValueMap dict, const std::string& fullPath, const WriteCallback& callback = nullptr,
+                                  PlistDocument::Format format = PlistDocument::Format::XML);
+
+    /**
+     * Writes a ValueVector into a plist file like writeValueMapToFileAsync().
+     * @since v3.11
+     * @js NA
+     * @lua NA
+     */
+    void writeValueVectorToFileAsync(ValueVector vecData, const std::string& fullPath, const WriteCallback& callback = nullptr,
+                                     PlistDocument::Format format = PlistDocument::Format::XML);
+
+    /**
+     * Blocks until the asynchronous writes are done, call it before the application quits or goes to the background.
+     * The callbacks are still called on the main thread later.
+     * @since v3.11
+     * @js NA
+     * @lua NA
+     */
+    void waitForAsyncWrites();
+
     /**
     * Windows fopen can't support UTF-8 filename
     * Need convert all parameters fopen and other 3rd-party libs
@@ -468,8 +644,48 @@ public:
      */
     virtual long getFileSize(const std::string &filepath);
 
-    /** Returns the full path cache. */
-    const std::unordered_map<std::string, std::string>& getFullPathCache() const { return _fullPathCache; }
+    /** Returns a copy of the full path cache. */
+    std::unordered_map<std::string, std::string> getFullPathCache() const { return _fullPathCache.toMap(); }
+
+    /**
+     *  Mounts an AssetPack as a search root, the relative filenames are looked up in its index first
+     *  (or after the search paths when `front` is false) and the files do not touch the file system.
+     *  The full path of a file in the pack is the full path of the pack followed by '/' and the filename,
+     *  getDataFromFile(), getStringFromFile(), getFileView(), isFileExist() and getFileSize() read it.
+     *
+     *  @param filename The pack, it is mapped for as long as it is mounted.
+     *  @param front Whether the pack takes precedence over the search paths.
+     *  @return false if the pack can't be read.
+     *  @see AssetPack
+     *  @since v3.11
+     */
+    bool mountAssetPack(const std::string& filename, bool front = true);
+
+    /**
+     *  Unmounts a pack mounted by mountAssetPack(), the views of its files stay valid.
+     *  @since v3.11
+     */
+    void unmountAssetPack(const std::string& filename);
+
+    /**
+     *  Loads the list of the files shipped in the default resource root, generated when the game is built.
+     *  The search paths under the root are then resolved with the manifest instead of probing the file system,
+     *  the other search paths (e.g. the writable path) are still probed.
+     *
+     *  The manifest is a text file with one path per line, relative to the default resource root
+     *  and with '/' separators. Empty lines and lines starting with '#' are ignored.
+     *
+     *  @param filename The manifest, e.g. "files.manifest".
+     *  @return false if the manifest can't be read.
+     *  @since v3.11
+     */
+    bool loadFileManifest(const std::string& filename);
+
+    /**
+     *  Forgets the manifest loaded by loadFileManifest(), e.g. after the resource root was updated in place.
+     *  @since v3.11
+     */
+    void clearFileManifest();
 
 protected:
     /**
@@ -496,6 +712,32 @@ protected:
      */
     virtual std::string getNewFilename(const std::string &filename) const;
 
+    /**
+     *  Maps a file for getFileView(), returns an empty view when it can't.
+     *  @param fullPath The result of fullPathForFilename().
+     */
+    virtual FileView mapFile(const std::string& fullPath);
+
+    /**
+     *  fullPathForFilename() without the "No file found" log, for the lookups that may fail.
+     */
+    std::string searchFullPathForFilename(const std::string &filename) const;
+
+    /** Looks the resolution directories up in the mounted packs, the first or last ones depending on `front`. */
+    std::string searchAssetPacks(const std::string& filename, bool front) const;
+
+    /**
+     *  Finds the mounted pack of a full path.
+     *  @return nullptr when the path isn't under a mounted pack, otherwise the pack and the name of the file in it.
+     */
+    AssetPack* findAssetPack(const std::string& fullPath, std::string* name) const;
+
+    /**
+     *  Reads `filename` when it is in a mounted pack, for the platform getDataFromFile() and getStringFromFile().
+     *  @return false when the file isn't in a pack.
+     */
+    bool getDataFromAssetPack(const std::string& filename, bool forString, Data* data) const;
+
     /**
      *  Checks whether a file exists without considering search paths and resolution orders.
      *  @param filename The file (with absolute path) to look up for
@@ -566,7 +808,50 @@ protected:
      *  The full path cache. When a file is found, it will be added into this cache.
      *  This variable is used for improving the performance of file search.
      */
-    mutable std::unordered_map<std::string, std::string> _fullPathCache;
+    mutable FilePathCache _fullPathCache;
+
+    /**
+     *  The filenames fullPathForFilename() didn't find, cleared with _fullPathCache and when FileUtils writes a file.
+     *  Call purgeCachedEntries() after creating files by other means.
+     */
+    mutable FilePathCache _missingFileCache;
+
+    // the asynchronous writes waiting for the IO thread, by path
+    struct PendingWrite
+    {
+        std::function<Data()> serialize;
+        std::vector<WriteCallback> callbacks;
+    };
+    void enqueueWrite(const std::string& fullPath, std::function<Data()>&& serialize, const WriteCallback& callback);
+    bool writeDataToFileAtomically(const Data& data, const std::string& fullPath);
+
+    std::mutex _asyncWriteMutex;
+    std::condition_variable _asyncWriteDone;
+    std::unordered_map<std::string, PendingWrite> _pendingWrites;
+    unsigned int _asyncWriteCount;
+
+    /**
+     *  The files of the default resource root listed by loadFileManifest(), relative to `_fileManifestRoot`.
+     */
+    std::unordered_set<std::string> _fileManifest;
+    std::string _fileManifestRoot;
+
+    /**
+     *  The suffixes of the texture variants, and the cache of fullPathForTextureFilename().
+     *  The images without a variant are cached too, so they are only searched once.
+     */
+    std::vector<std::string> _textureVariants;
+    mutable FilePathCache _textureFullPathCache;
+
+    /** The packs mounted by mountAssetPack(), `root` is the full path of the pack with a trailing '/'. */
+    struct MountedAssetPack
+    {
+        std::string filename;
+        std::string root;
+        std::shared_ptr<AssetPack> pack;
+        bool front;
+    };
+    std::vector<MountedAssetPack> _assetPacks;
 
     /**
      * Writable path.
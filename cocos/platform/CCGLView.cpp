@@ -25,9 +25,14 @@ THE SOFTWARE.
 
 #include "platform/CCGLView.h"
 
+#include <chrono>
+#include <thread>
+
 #include "base/CCTouch.h"
 #include "base/CCDirector.h"
 #include "base/CCEventDispatcher.h"
+#include "base/ccUtils.h"
+#include "renderer/ccGLStateCache.h"
 
 NS_CC_BEGIN
 
@@ -35,6 +40,8 @@ namespace {
 
     static Touch* g_touches[EventTouch::MAX_TOUCHES] = { nullptr };
     static unsigned int g_indexBitsUsed = 0;
+    // the touches with a coalesced move to dispatch
+    static unsigned int g_indexBitsMoved = 0;
     // System touch pointer ID (It may not be ascending order number) <-> Ascending order number from 0
     static std::map<intptr_t, int> g_touchIdReorderMap;
 
@@ -102,6 +109,9 @@ GLView::GLView()
 : _scaleX(1.0f)
 , _scaleY(1.0f)
 , _resolutionPolicy(ResolutionPolicy::UNKNOWN)
+, _renderScale(1.0f)
+, _touchCoalescing(false)
+, _touchPrediction(0)
 {
 }
 
@@ -114,6 +124,12 @@ void GLView::pollEvents()
 {
 }
 
+void GLView::waitEvents(float timeout)
+{
+    std::this_thread::sleep_for(std::chrono::duration<float>(timeout));
+    pollEvents();
+}
+
 void GLView::updateDesignResolutionSize()
 {
     if (_screenSize.width > 0 && _screenSize.height > 0
@@ -221,33 +237,33 @@ Vec2 GLView::getVisibleOrigin() const
 
 void GLView::setViewPortInPoints(float x , float y , float w , float h)
 {
-    glViewport((GLint)(x * _scaleX + _viewPortRect.origin.x),
-        (GLint)(y * _scaleY + _viewPortRect.origin.y),
-        (GLsizei)(w * _scaleX),
-        (GLsizei)(h * _scaleY));
+    GL::viewport((GLint)((x * _scaleX + _viewPortRect.origin.x) * _renderScale),
+        (GLint)((y * _scaleY + _viewPortRect.origin.y) * _renderScale),
+        (GLsizei)(w * _scaleX * _renderScale),
+        (GLsizei)(h * _scaleY * _renderScale));
 }
 
 void GLView::setScissorInPoints(float x , float y , float w , float h)
 {
-    glScissor((GLint)(x * _scaleX + _viewPortRect.origin.x),
-              (GLint)(y * _scaleY + _viewPortRect.origin.y),
-              (GLsizei)(w * _scaleX),
-              (GLsizei)(h * _scaleY));
+    GL::scissor((GLint)((x * _scaleX + _viewPortRect.origin.x) * _renderScale),
+                (GLint)((y * _scaleY + _viewPortRect.origin.y) * _renderScale),
+                (GLsizei)(w * _scaleX * _renderScale),
+                (GLsizei)(h * _scaleY * _renderScale));
 }
 
 bool GLView::isScissorEnabled()
 {
-    return (GL_FALSE == glIsEnabled(GL_SCISSOR_TEST)) ? false : true;
+    return GL::isEnabled(GL_SCISSOR_TEST);
 }
 
 Rect GLView::getScissorRect() const
 {
-    GLfloat params[4];
-    glGetFloatv(GL_SCISSOR_BOX, params);
-    float x = (params[0] - _viewPortRect.origin.x) / _scaleX;
-    float y = (params[1] - _viewPortRect.origin.y) / _scaleY;
-    float w = params[2] / _scaleX;
-    float h = params[3] / _scaleY;
+    GLint params[4];
+    GL::getScissorBox(params);
+    float x = (params[0] / _renderScale - _viewPortRect.origin.x) / _scaleX;
+    float y = (params[1] / _renderScale - _viewPortRect.origin.y) / _scaleY;
+    float w = params[2] / _renderScale / _scaleX;
+    float h = params[3] / _renderScale / _scaleY;
     return Rect(x, y, w, h);
 }
 
@@ -269,6 +285,8 @@ void GLView::handleTouchesBegin(int num, intptr_t ids[], float xs[], float ys[])
     int unusedIndex = 0;
     EventTouch touchEvent;
 
+    dispatchCoalescedTouches();
+
     for (int i = 0; i < num; ++i)
     {
         id = ids[i];
@@ -291,6 +309,7 @@ void GLView::handleTouchesBegin(int num, intptr_t ids[], float xs[], float ys[])
             Touch* touch = g_touches[unusedIndex] = new (std::nothrow) Touch();
             touch->setTouchInfo(unusedIndex, (x - _viewPortRect.origin.x) / _scaleX,
                                      (y - _viewPortRect.origin.y) / _scaleY);
+            touch->_time = utils::gettime();
 
             CCLOGINFO("x = %f y = %f", touch->getLocationInView().x, touch->getLocationInView().y);
 
@@ -322,13 +341,14 @@ void GLView::handleTouchesMove(int num, intptr_t ids[], float xs[], float ys[],
     float y = 0.0f;
     float force = 0.0f;
     float maxForce = 0.0f;
+    double now = utils::gettime();
     EventTouch touchEvent;
 
     for (int i = 0; i < num; ++i)
     {
         id = ids[i];
-        x = xs[i];
-        y = ys[i];
+        x = (xs[i] - _viewPortRect.origin.x) / _scaleX;
+        y = (ys[i] - _viewPortRect.origin.y) / _scaleY;
         force = fs ? fs[i] : 0.0f;
         maxForce = ms ? ms[i] : 0.0f;
 
@@ -343,10 +363,32 @@ void GLView::handleTouchesMove(int num, intptr_t ids[], float xs[], float ys[],
         Touch* touch = g_touches[iter->second];
         if (touch)
         {
-            touch->setTouchInfo(iter->second, (x - _viewPortRect.origin.x) / _scaleX,
-                                (y - _viewPortRect.origin.y) / _scaleY, force, maxForce);
+            unsigned int bit = 1 << iter->second;
+            if (g_indexBitsMoved & bit)
+            {
+                // a later sample of a coalesced move, the previous location stays the one of the last event
+                touch->_point.set(x, y);
+                touch->_curForce = force;
+                touch->_maxForce = maxForce;
+            }
+            else
+            {
+                touch->setTouchInfo(iter->second, x, y, force, maxForce);
+                touch->_history.clear();
+                touch->_prevTime = touch->_time;
+            }
+            touch->_history.push_back(touch->_point);
+            touch->_time = now;
 
-            touchEvent._touches.push_back(touch);
+            if (_touchCoalescing)
+            {
+                g_indexBitsMoved |= bit;
+            }
+            else
+            {
+                predictTouch(touch);
+                touchEvent._touches.push_back(touch);
+            }
         }
         else
         {
@@ -356,6 +398,11 @@ void GLView::handleTouchesMove(int num, intptr_t ids[], float xs[], float ys[],
         }
     }
 
+    if (_touchCoalescing)
+    {
+        return;
+    }
+
     if (touchEvent._touches.empty())
     {
         CCLOG("touchesMoved: size = 0");
@@ -367,6 +414,55 @@ void GLView::handleTouchesMove(int num, intptr_t ids[], float xs[], float ys[],
     dispatcher->dispatchEvent(&touchEvent);
 }
 
+void GLView::dispatchCoalescedTouches()
+{
+    if (g_indexBitsMoved == 0)
+    {
+        return;
+    }
+
+    EventTouch touchEvent;
+    for (int i = 0; i < EventTouch::MAX_TOUCHES; ++i)
+    {
+        if ((g_indexBitsMoved & (1 << i)) && g_touches[i])
+        {
+            predictTouch(g_touches[i]);
+            touchEvent._touches.push_back(g_touches[i]);
+        }
+    }
+    g_indexBitsMoved = 0;
+
+    if (touchEvent._touches.empty())
+    {
+        return;
+    }
+
+    touchEvent._eventCode = EventTouch::EventCode::MOVED;
+    auto dispatcher = Director::DirectorInstance->getEventDispatcher();
+    dispatcher->dispatchEvent(&touchEvent);
+}
+
+void GLView::predictTouch(Touch* touch) const
+{
+    touch->_predictedPoint = touch->_point;
+
+    // the velocity of the last move, a touch that stood still for a while isn't predicted to move
+    double elapsed = touch->_time - touch->_prevTime;
+    if (_touchPrediction > 0 && elapsed > 0 && elapsed < 0.1)
+    {
+        touch->_predictedPoint += (touch->_point - touch->_prevPoint) * (float)(_touchPrediction / elapsed);
+    }
+}
+
+void GLView::setTouchCoalescingEnabled(bool enabled)
+{
+    if (!enabled)
+    {
+        dispatchCoalescedTouches();
+    }
+    _touchCoalescing = enabled;
+}
+
 void GLView::handleTouchesOfEndOrCancel(EventTouch::EventCode eventCode, int num, intptr_t ids[], float xs[], float ys[])
 {
     intptr_t id = 0;
@@ -374,6 +470,8 @@ void GLView::handleTouchesOfEndOrCancel(EventTouch::EventCode eventCode, int num
     float y = 0.0f;
     EventTouch touchEvent;
 
+    dispatchCoalescedTouches();
+
     for (int i = 0; i < num; ++i)
     {
         id = ids[i];
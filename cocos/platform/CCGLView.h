@@ -115,6 +115,34 @@ public:
     /** Exchanges the front and back buffers, subclass must implement this method. */
     virtual void swapBuffers() = 0;
 
+    /** Whether or not the view can be drawn by the render thread of the Renderer, see Renderer::setRenderThreadEnabled(). */
+    virtual bool isRenderThreadSupported() const { return false; }
+
+    /**
+     * Whether swapBuffers() waits for the display at the pace of the animation interval.
+     * The main loop of the platform doesn't sleep between the frames then.
+     * @since v3.11
+     */
+    virtual bool isPacedBySwaps() const { return false; }
+
+    /** Makes the context of the view current, or not current, on the calling thread. */
+    virtual void makeContextCurrent(bool current) {}
+
+    /**
+     * Makes a context that shares its objects with the context of the view current, or not current, on the calling thread.
+     * The main thread uses it to create textures and shaders while the render thread draws.
+     */
+    virtual void makeSharedContextCurrent(bool current) {}
+
+    /**
+     * Creates the context of the upload thread of TextureCache, in the share group of the view. It's called on the main thread.
+     * Returns false when the view has none, the textures are uploaded on the main thread then.
+     */
+    virtual bool createUploadContext() { return false; }
+
+    /** Makes the context of createUploadContext() current, or not current, on the calling thread. */
+    virtual void makeUploadContextCurrent(bool current) {}
+
     /** Open or close IME keyboard , subclass must implement this method.
      *
      * @param open Open or close IME keyboard.
@@ -146,6 +174,12 @@ public:
     /** Polls the events. */
     virtual void pollEvents();
 
+    /** Waits for an event for `timeout` seconds at most and dispatches the events, see Director::getIdleTime().
+     * The default implementation sleeps then polls the events.
+     * @since v3.11
+     */
+    virtual void waitEvents(float timeout);
+
     /**
      * Get the frame size of EGL view.
      * In general, it returns the screen size since the EGL view is a fullscreen view.
@@ -278,6 +312,17 @@ public:
      */
     virtual Rect getScissorRect() const;
 
+    /**
+     * Scales the viewport and the scissor box set in points, the Director sets it while it draws the scene into a
+     * smaller target, see Director::setDynamicResolutionEnabled(). It is used on the thread that draws the frames.
+     *
+     * @param scale The scale, 1 by default.
+     */
+    void setRenderScale(float scale) { _renderScale = scale; }
+
+    /** Gets the scale of the viewport and the scissor box. */
+    float getRenderScale() const { return _renderScale; }
+
     /** Set the view name.
      *
      * @param viewname A string will be set to the view as name.
@@ -337,6 +382,28 @@ public:
      */
     virtual void handleTouchesCancel(int num, intptr_t ids[], float xs[], float ys[]);
 
+    /** Sets whether the moves of the touches are coalesced: instead of an event per platform callback, the moves are
+     * dispatched in a single MOVED event at the start of the next frame, and Touch::getHistory() has their samples.
+     * Off by default. The BEGAN, ENDED and CANCELLED events dispatch the pending moves first, they stay in order.
+     *
+     * @param enabled Whether the moves are coalesced.
+     */
+    void setTouchCoalescingEnabled(bool enabled);
+    /** Returns whether the moves of the touches are coalesced. */
+    bool isTouchCoalescingEnabled() const { return _touchCoalescing; }
+
+    /** Sets how far ahead Touch::getPredictedLocation() extrapolates the moves, from the velocity of the last move.
+     * About the latency from the input to the display, a frame or two. 0, the default, turns the prediction off.
+     *
+     * @param seconds The time to predict the touches for.
+     */
+    void setTouchPrediction(float seconds) { _touchPrediction = seconds; }
+    /** Returns how far ahead the moves are predicted, in seconds. */
+    float getTouchPrediction() const { return _touchPrediction; }
+
+    /** Dispatches the moves coalesced since the last call. The Director calls it once per frame, before the update. */
+    void dispatchCoalescedTouches();
+
     /**
      * Get the opengl view port rectangle.
      *
@@ -383,6 +450,7 @@ protected:
     void updateDesignResolutionSize();
 
     void handleTouchesOfEndOrCancel(EventTouch::EventCode eventCode, int num, intptr_t ids[], float xs[], float ys[]);
+    void predictTouch(Touch* touch) const;
 
     // real screen size
     Size _screenSize;
@@ -396,6 +464,10 @@ protected:
     float _scaleX;
     float _scaleY;
     ResolutionPolicy _resolutionPolicy;
+    float _renderScale;
+
+    bool _touchCoalescing;
+    float _touchPrediction;
 };
 
 // end of platform group
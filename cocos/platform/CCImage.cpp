@@ -28,6 +28,9 @@ THE SOFTWARE.
 
 #include <string>
 #include <ctype.h>
+#include <chrono>
+#include <mutex>
+#include <vector>
 
 #include "base/CCData.h"
 #include "base/ccConfig.h" // CC_USE_JPEG, CC_USE_TIFF, CC_USE_WEBP
@@ -39,6 +42,7 @@ extern "C"
 
 #if CC_USE_PNG
 #include "png/png.h"
+#include <zlib.h>
 #endif //CC_USE_PNG
 
 #if CC_USE_TIFF
@@ -63,8 +67,10 @@ extern "C"
 #include "CCStdC.h"
 #include "CCFileUtils.h"
 #include "base/CCConfiguration.h"
+#include "base/CCJobSystem.h"
 #include "base/ccUtils.h"
 #include "base/ZipUtils.h"
+#include "renderer/ccPixelConversion.h"
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
 #include "android/CCFileUtils-android.h"
 #endif
@@ -212,6 +218,8 @@ namespace
         _pixel3_formathash::value_type(PVR3TexturePixelFormat::PVRTC4BPP_RGBA,      Texture2D::PixelFormat::PVRTC4A),
 
         _pixel3_formathash::value_type(PVR3TexturePixelFormat::ETC1,        Texture2D::PixelFormat::ETC),
+        _pixel3_formathash::value_type(PVR3TexturePixelFormat::ETC2_RGB,    Texture2D::PixelFormat::ETC2_RGB),
+        _pixel3_formathash::value_type(PVR3TexturePixelFormat::ETC2_RGBA,   Texture2D::PixelFormat::ETC2_RGBA),
     };
 
     static const int PVR3_MAX_TABLE_ELEMENTS = sizeof(v3_pixel_formathash_value) / sizeof(v3_pixel_formathash_value[0]);
@@ -261,6 +269,36 @@ namespace
 }
 //pvr structure end
 
+//////////////////////////////////////////////////////////////////////////
+//struct and data for ktx structure
+
+namespace
+{
+    static const unsigned char gKTXIdentifier[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+
+    // written in the endianness of the file, it reads as 0x01020304 when the file must be swapped
+    static const uint32_t KTX_ENDIANNESS = 0x04030201;
+
+    typedef struct
+    {
+        unsigned char identifier[12];
+        uint32_t endianness;
+        uint32_t glType;
+        uint32_t glTypeSize;
+        uint32_t glFormat;
+        uint32_t glInternalFormat;
+        uint32_t glBaseInternalFormat;
+        uint32_t pixelWidth;
+        uint32_t pixelHeight;
+        uint32_t pixelDepth;
+        uint32_t numberOfArrayElements;
+        uint32_t numberOfFaces;
+        uint32_t numberOfMipmapLevels;
+        uint32_t bytesOfKeyValueData;
+    } KTXTexHeader;
+}
+//ktx structure end
+
 namespace
 {
     typedef struct
@@ -327,6 +365,8 @@ Image::Image()
 , _renderFormat(Texture2D::PixelFormat::NONE)
 , _numberOfMipmaps(0)
 , _hasPremultipliedAlpha(true)
+, _decodePixelFormat(Texture2D::PixelFormat::NONE)
+, _unpackedData(nullptr)
 {
 
 }
@@ -347,7 +387,7 @@ bool Image::initWithImageFile(const std::string& path)
     bool ret = false;
     _filePath = FileUtils::getInstance()->fullPathForFilename(path);
 
-    Data data = FileUtils::getInstance()->getDataFromFile(_filePath);
+    FileView data = FileUtils::getInstance()->getFileView(_filePath);
 
     if (!data.isNull())
     {
@@ -362,7 +402,7 @@ bool Image::initWithImageFileThreadSafe(const std::string& fullpath)
     bool ret = false;
     _filePath = fullpath;
 
-    Data data = FileUtils::getInstance()->getDataFromFile(fullpath);
+    FileView data = FileUtils::getInstance()->getFileView(fullpath);
 
     if (!data.isNull())
     {
@@ -398,15 +438,18 @@ bool Image::initWithImageData(const unsigned char * data, ssize_t dataLen)
             unpackedLen = dataLen;
         }
 
+        if (unpackedData != data)
+        {
+            _unpackedData = unpackedData;
+        }
+
         _fileType = detectFormat(unpackedData, unpackedLen);
 
         switch (_fileType)
         {
         case Format::PNG:
-            ret = initWithPngData(unpackedData, unpackedLen);
-            break;
         case Format::JPG:
-            ret = initWithJpgData(unpackedData, unpackedLen);
+            ret = initWithPngOrJpgData(unpackedData, unpackedLen);
             break;
         case Format::TIFF:
             ret = initWithTiffData(unpackedData, unpackedLen);
@@ -417,6 +460,9 @@ bool Image::initWithImageData(const unsigned char * data, ssize_t dataLen)
         case Format::ETC:
             ret = initWithETCData(unpackedData, unpackedLen);
             break;
+        case Format::KTX:
+            ret = initWithKTXData(unpackedData, unpackedLen);
+            break;
         default:
             {
                 // load and detect image format
@@ -436,15 +482,31 @@ bool Image::initWithImageData(const unsigned char * data, ssize_t dataLen)
             }
         }
 
-        if(unpackedData != data)
-        {
-            free(unpackedData);
-        }
+        // still there unless setDataFromBuffer() took it
+        free(_unpackedData);
+        _unpackedData = nullptr;
     } while (0);
 
     return ret;
 }
 
+void Image::setDataFromBuffer(const unsigned char * buffer, ssize_t offset, ssize_t length)
+{
+    _dataLen = length;
+    if (buffer == _unpackedData)
+    {
+        // the pixels move to the start of the inflated buffer, there is no second one
+        memmove(_unpackedData, _unpackedData + offset, length);
+        _data = _unpackedData;
+        _unpackedData = nullptr;
+    }
+    else
+    {
+        _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
+        memcpy(_data, buffer + offset, _dataLen);
+    }
+}
+
 bool Image::isPng(const unsigned char * data, ssize_t dataLen)
 {
     if (dataLen <= 8)
@@ -462,6 +524,16 @@ bool Image::isEtc(const unsigned char * data, ssize_t dataLen)
     return etc1_pkm_is_valid((etc1_byte*)data) ? true : false;
 }
 
+bool Image::isKtx(const unsigned char * data, ssize_t dataLen)
+{
+    if (static_cast<size_t>(dataLen) < sizeof(KTXTexHeader))
+    {
+        return false;
+    }
+
+    return memcmp(data, gKTXIdentifier, sizeof(gKTXIdentifier)) == 0;
+}
+
 bool Image::isJpg(const unsigned char * data, ssize_t dataLen)
 {
     if (dataLen <= 4)
@@ -523,6 +595,10 @@ Image::Format Image::detectFormat(const unsigned char * data, ssize_t dataLen)
     {
         return Format::ETC;
     }
+    else if (isKtx(data, dataLen))
+    {
+        return Format::KTX;
+    }
     else
     {
         return Format::UNKNOWN;
@@ -562,6 +638,8 @@ namespace
             case PVR3TexturePixelFormat::PVRTC4BPP_RGB:
             case PVR3TexturePixelFormat::PVRTC4BPP_RGBA:
             case PVR3TexturePixelFormat::ETC1:
+            case PVR3TexturePixelFormat::ETC2_RGB:
+            case PVR3TexturePixelFormat::ETC2_RGBA:
             case PVR3TexturePixelFormat::RGBA8888:
             case PVR3TexturePixelFormat::RGBA4444:
             case PVR3TexturePixelFormat::RGBA5551:
@@ -648,9 +726,7 @@ bool Image::initWithPVRv2Data(const unsigned char * data, ssize_t dataLen)
     dataLength = CC_SWAP_INT32_LITTLE_TO_HOST(header->dataLength);
 
     //Move by size of header
-    _dataLen = dataLen - sizeof(PVRv2TexHeader);
-    _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
-    memcpy(_data, (unsigned char*)data + sizeof(PVRv2TexHeader), _dataLen);
+    setDataFromBuffer(data, sizeof(PVRv2TexHeader), dataLen - sizeof(PVRv2TexHeader));
 
     // Calculate the data size for each texture level and respect the minimum number of blocks
     while (dataOffset < dataLength)
@@ -802,13 +878,12 @@ bool Image::initWithPVRv3Data(const unsigned char * data, ssize_t dataLen)
     int dataOffset = 0, dataSize = 0;
     int blockSize = 0, widthBlocks = 0, heightBlocks = 0;
 
-    _dataLen = dataLen - (sizeof(PVRv3TexHeader) + header->metadataLength);
-    _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
-    memcpy(_data, static_cast<const unsigned char*>(data) + sizeof(PVRv3TexHeader) + header->metadataLength, _dataLen);
-
     _numberOfMipmaps = header->numberOfMipmaps;
     CCAssert(_numberOfMipmaps < MIPMAP_MAX, "Image: Maximum number of mimpaps reached. Increase the CC_MIPMAP_MAX value");
 
+    // the header is overwritten when the buffer is reused
+    setDataFromBuffer(data, sizeof(PVRv3TexHeader) + header->metadataLength, dataLen - (sizeof(PVRv3TexHeader) + header->metadataLength));
+
     for (int i = 0; i < _numberOfMipmaps; i++)
     {
         switch ((PVR3TexturePixelFormat)pixelFormat)
@@ -861,6 +936,17 @@ bool Image::initWithPVRv3Data(const unsigned char * data, ssize_t dataLen)
                 widthBlocks = width / 4;
                 heightBlocks = height / 4;
                 break;
+            case PVR3TexturePixelFormat::ETC2_RGB:
+            case PVR3TexturePixelFormat::ETC2_RGBA:
+                if (!Configuration::getInstance()->supportsETC2())
+                {
+                    CCLOG("cocos2d: Image. ETC2 not supported on this device");
+                    return false;
+                }
+                blockSize = 4 * 4;
+                widthBlocks = (width + 3) / 4;
+                heightBlocks = (height + 3) / 4;
+                break;
             case PVR3TexturePixelFormat::BGRA8888:
                 if (! Configuration::getInstance()->supportsBGRA8888())
                 {
@@ -934,9 +1020,7 @@ bool Image::initWithETCData(const unsigned char * data, ssize_t dataLen)
         //old opengl version has no define for GL_ETC1_RGB8_OES, add macro to make compiler happy.
 #ifdef GL_ETC1_RGB8_OES
         _renderFormat = Texture2D::PixelFormat::ETC;
-        _dataLen = dataLen - ETC_PKM_HEADER_SIZE;
-        _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
-        memcpy(_data, static_cast<const unsigned char*>(data) + ETC_PKM_HEADER_SIZE, _dataLen);
+        setDataFromBuffer(data, ETC_PKM_HEADER_SIZE, dataLen - ETC_PKM_HEADER_SIZE);
         return true;
 #endif
     }
@@ -967,6 +1051,104 @@ bool Image::initWithETCData(const unsigned char * data, ssize_t dataLen)
     return false;
 }
 
+bool Image::initWithKTXData(const unsigned char * data, ssize_t dataLen)
+{
+    KTXTexHeader header;
+    memcpy(&header, data, sizeof(header));
+
+    bool swap = header.endianness != KTX_ENDIANNESS;
+    auto read = [swap](uint32_t value) -> uint32_t {
+        return swap ? ((value >> 24) | ((value >> 8) & 0xFF00) | ((value << 8) & 0xFF0000) | (value << 24)) : value;
+    };
+
+    if (read(header.endianness) != KTX_ENDIANNESS)
+    {
+        CCLOG("cocos2d: WARNING: invalid ktx endianness");
+        return false;
+    }
+
+    // only the 2D textures of a compressed format, glType is 0 for them
+    if (read(header.glType) != 0 || read(header.pixelDepth) > 1 || read(header.numberOfArrayElements) > 0 || read(header.numberOfFaces) != 1)
+    {
+        CCLOG("cocos2d: WARNING: only the compressed 2D ktx textures are supported");
+        return false;
+    }
+
+    GLenum internalFormat = read(header.glInternalFormat);
+    _renderFormat = Texture2D::PixelFormat::NONE;
+    for (const auto& info : Texture2D::getPixelFormatInfoMap())
+    {
+        if (info.second.compressed && info.second.internalFormat == internalFormat)
+        {
+            _renderFormat = info.first;
+            break;
+        }
+    }
+
+    if (_renderFormat == Texture2D::PixelFormat::NONE)
+    {
+        CCLOG("cocos2d: WARNING: Unsupported ktx internal format: 0x%04X", internalFormat);
+        return false;
+    }
+    if (!Texture2D::isPixelFormatSupported(_renderFormat))
+    {
+        CCLOG("cocos2d: WARNING: the ktx internal format 0x%04X isn't supported on this device, ship a variant of another format", internalFormat);
+        return false;
+    }
+
+    _width = read(header.pixelWidth);
+    _height = read(header.pixelHeight);
+    _numberOfMipmaps = MAX(read(header.numberOfMipmapLevels), 1u);
+    if (0 == _width || 0 == _height || _numberOfMipmaps > MIPMAP_MAX)
+    {
+        return false;
+    }
+
+    // the compressed formats carry no premultiplied alpha flag, like the pvr files
+    _hasPremultipliedAlpha = _PVRHaveAlphaPremultiplied;
+
+    // each level is its size followed by the blocks, padded to 4 bytes
+    ssize_t offset = sizeof(KTXTexHeader) + read(header.bytesOfKeyValueData);
+    ssize_t levelOffsets[MIPMAP_MAX];
+    uint32_t levelSizes[MIPMAP_MAX];
+    _dataLen = 0;
+    for (int i = 0; i < _numberOfMipmaps; ++i)
+    {
+        uint32_t imageSize = 0;
+        if (offset + (ssize_t)sizeof(imageSize) > dataLen)
+        {
+            CCLOG("cocos2d: WARNING: truncated ktx file");
+            return false;
+        }
+        memcpy(&imageSize, data + offset, sizeof(imageSize));
+        imageSize = read(imageSize);
+        offset += sizeof(imageSize);
+
+        if (offset + (ssize_t)imageSize > dataLen)
+        {
+            CCLOG("cocos2d: WARNING: truncated ktx file");
+            return false;
+        }
+        levelOffsets[i] = offset;
+        levelSizes[i] = imageSize;
+        _dataLen += imageSize;
+        offset += (imageSize + 3) & ~3;
+    }
+
+    // the levels are packed without their sizes, the level 0 is also what a texture without mipmaps uploads
+    _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
+    ssize_t dataOffset = 0;
+    for (int i = 0; i < _numberOfMipmaps; ++i)
+    {
+        memcpy(_data + dataOffset, data + levelOffsets[i], levelSizes[i]);
+        _mipmaps[i].address = _data + dataOffset;
+        _mipmaps[i].len = static_cast<int>(levelSizes[i]);
+        dataOffset += levelSizes[i];
+    }
+
+    return true;
+}
+
 bool Image::initWithTGAData(tImageTGA* tgaData)
 {
     bool ret = false;
@@ -1076,270 +1258,354 @@ bool Image::initWithRawData(const unsigned char * data, ssize_t dataLen, int wid
 
 
 #if (CC_TARGET_PLATFORM != CC_PLATFORM_IOS)
-bool Image::saveToFile(const std::string& filename, bool isToRGB)
+bool Image::generateMipmaps()
 {
-    //only support for Texture2D::PixelFormat::RGB888 or Texture2D::PixelFormat::RGBA8888 uncompressed data
-    if (isCompressed() || (_renderFormat != Texture2D::PixelFormat::RGB888 && _renderFormat != Texture2D::PixelFormat::RGBA8888))
+    if (_numberOfMipmaps > 1 || _unpack || isCompressed() || _data == nullptr)
     {
-        CCLOG("cocos2d: Image: saveToFile is only support for Texture2D::PixelFormat::RGB888 or Texture2D::PixelFormat::RGBA8888 uncompressed data for now");
-        return false;
+        return _numberOfMipmaps > 1;
     }
 
-    std::string fileExtension = FileUtils::getInstance()->getFileExtension(filename);
+    int bytesPerPixel = 0;
+    switch (_renderFormat)
+    {
+        case Texture2D::PixelFormat::I8:       bytesPerPixel = 1; break;
+        case Texture2D::PixelFormat::AI88:     bytesPerPixel = 2; break;
+        case Texture2D::PixelFormat::RGB888:   bytesPerPixel = 3; break;
+        case Texture2D::PixelFormat::RGBA8888: bytesPerPixel = 4; break;
+        default: return false;
+    }
+    if (ccNextPOT(_width) != _width || ccNextPOT(_height) != _height)
+    {
+        return false;
+    }
 
-    if (fileExtension == ".png")
+    // the levels follow each other in one buffer, like the mipmaps of a PVR file
+    int levels = 1;
+    size_t total = (size_t)_width * _height * bytesPerPixel;
+    for (int w = _width, h = _height; w > 1 || h > 1; ++levels)
     {
-        return saveImageToPNG(filename, isToRGB);
+        w = std::max(w >> 1, 1);
+        h = std::max(h >> 1, 1);
+        total += (size_t)w * h * bytesPerPixel;
     }
-    else if (fileExtension == ".jpg")
+    if (levels > MIPMAP_MAX)
     {
-        return saveImageToJPG(filename);
+        return false;
     }
-    else
+
+    unsigned char* data = static_cast<unsigned char*>(malloc(total));
+    if (data == nullptr)
     {
-        CCLOG("cocos2d: Image: saveToFile no support file extension(only .png or .jpg) for file: %s", filename.c_str());
         return false;
     }
+    memcpy(data, _data, (size_t)_width * _height * bytesPerPixel);
+    free(_data);
+    _data = data;
+    _dataLen = total;
+
+    int width = _width;
+    int height = _height;
+    _mipmaps[0].address = data;
+    _mipmaps[0].len = width * height * bytesPerPixel;
+    for (int level = 1; level < levels; ++level)
+    {
+        const unsigned char* src = _mipmaps[level - 1].address;
+        unsigned char* dst = _mipmaps[level - 1].address + _mipmaps[level - 1].len;
+        const int srcWidth = width;
+        const int srcHeight = height;
+        width = std::max(width >> 1, 1);
+        height = std::max(height >> 1, 1);
+
+        // a side already 1 pixel long averages the same pixel twice
+        const size_t srcRow = (size_t)srcWidth * bytesPerPixel;
+        const int dx = srcWidth > 1 ? bytesPerPixel : 0;
+        const size_t dy = srcHeight > 1 ? srcRow : 0;
+        for (int y = 0; y < height; ++y)
+        {
+            const unsigned char* row = src + (size_t)y * 2 * dy;
+            unsigned char* out = dst + (size_t)y * width * bytesPerPixel;
+            for (int x = 0; x < width; ++x)
+            {
+                const unsigned char* p = row + (size_t)x * 2 * dx;
+                for (int c = 0; c < bytesPerPixel; ++c)
+                {
+                    *out++ = (unsigned char)((p[c] + p[c + dx] + p[c + dy] + p[c + dx + dy] + 2) >> 2);
+                }
+            }
+        }
+        _mipmaps[level].address = dst;
+        _mipmaps[level].len = width * height * bytesPerPixel;
+    }
+    _numberOfMipmaps = levels;
+    return true;
 }
 
-bool Image::saveImageToPNG(const std::string& filePath, bool isToRGB)
+bool Image::saveToFile(const std::string& filename, bool isToRGB)
 {
-#if CC_USE_WIC
-    return encodeWithWIC(filePath, isToRGB, GUID_ContainerFormatPng);
-#elif CC_USE_PNG
-    bool ret = false;
-    do
+    EncodeOptions options;
+    options.toRGB = isToRGB;
+    return saveToFile(filename, options);
+}
+
+#if CC_USE_PNG
+namespace
+{
+    // the fewest rows deflated by a slice, the smaller images are deflated in one piece
+    const int PNG_MIN_SLICE_ROWS = 64;
+
+    struct PNGSlice
+    {
+        int firstRow;
+        int endRow;
+        std::vector<unsigned char> deflated;
+        size_t deflatedSize;
+        uLong adler;
+        uLong length;
+        bool ok;
+    };
+
+    unsigned char* writeBigEndian(unsigned char* out, uint32_t value)
     {
-        FILE *fp;
-        png_structp png_ptr;
-        png_infop info_ptr;
-        png_colorp palette;
-        png_bytep *row_pointers;
+        out[0] = (unsigned char)(value >> 24);
+        out[1] = (unsigned char)(value >> 16);
+        out[2] = (unsigned char)(value >> 8);
+        out[3] = (unsigned char)value;
+        return out + 4;
+    }
 
-        fp = fopen(FileUtils::getInstance()->getSuitableFOpen(filePath).c_str(), "wb");
-        CC_BREAK_IF(nullptr == fp);
+    // writes the length and the type of a chunk, the CRC is written after its data
+    unsigned char* writeChunkHeader(unsigned char* out, uint32_t length, const char* type)
+    {
+        out = writeBigEndian(out, length);
+        memcpy(out, type, 4);
+        return out + 4;
+    }
 
-        png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    unsigned char* writeChunkCRC(unsigned char* out, const unsigned char* type, uint32_t length)
+    {
+        return writeBigEndian(out, (uint32_t)crc32(crc32(0, Z_NULL, 0), type, length + 4));
+    }
 
-        if (nullptr == png_ptr)
-        {
-            fclose(fp);
-            break;
-        }
+    inline unsigned char paethPredictor(int a, int b, int c)
+    {
+        int p = a + b - c;
+        int pa = abs(p - a);
+        int pb = abs(p - b);
+        int pc = abs(p - c);
+        if (pa <= pb && pa <= pc)
+            return (unsigned char)a;
+        return (unsigned char)(pb <= pc ? b : c);
+    }
 
-        info_ptr = png_create_info_struct(png_ptr);
-        if (nullptr == info_ptr)
-        {
-            fclose(fp);
-            png_destroy_write_struct(&png_ptr, nullptr);
-            break;
-        }
-#if (CC_TARGET_PLATFORM != CC_PLATFORM_BADA && CC_TARGET_PLATFORM != CC_PLATFORM_NACL)
-        if (setjmp(png_jmpbuf(png_ptr)))
+    /*
+     Filters a row with the filter whose output has the least sum of absolute values, the heuristic of libpng.
+     out receives the filter type and the length bytes, scratch holds 5 rows.
+     */
+    void filterPNGRow(const unsigned char* row, const unsigned char* prev, int length, int bpp, unsigned char* out, unsigned char* scratch)
+    {
+        unsigned char* filtered[5] = { nullptr, scratch, scratch + length, scratch + length * 2, scratch + length * 3 };
+        unsigned int sums[5] = { 0, 0, 0, 0, 0 };
+        for (int i = 0; i < length; ++i)
         {
-            fclose(fp);
-            png_destroy_write_struct(&png_ptr, &info_ptr);
-            break;
+            int left = i >= bpp ? row[i - bpp] : 0;
+            int up = prev[i];
+            int upLeft = i >= bpp ? prev[i - bpp] : 0;
+            unsigned char sub = (unsigned char)(row[i] - left);
+            unsigned char upDelta = (unsigned char)(row[i] - up);
+            unsigned char average = (unsigned char)(row[i] - ((left + up) >> 1));
+            unsigned char paeth = (unsigned char)(row[i] - paethPredictor(left, up, upLeft));
+            filtered[1][i] = sub;
+            filtered[2][i] = upDelta;
+            filtered[3][i] = average;
+            filtered[4][i] = paeth;
+            sums[0] += abs((signed char)row[i]);
+            sums[1] += abs((signed char)sub);
+            sums[2] += abs((signed char)upDelta);
+            sums[3] += abs((signed char)average);
+            sums[4] += abs((signed char)paeth);
         }
-#endif
-        png_init_io(png_ptr, fp);
 
-        if (!isToRGB && hasAlpha())
-        {
-            png_set_IHDR(png_ptr, info_ptr, _width, _height, 8, PNG_COLOR_TYPE_RGB_ALPHA,
-                PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
-        }
-        else
+        int best = 0;
+        for (int type = 1; type < 5; ++type)
         {
-            png_set_IHDR(png_ptr, info_ptr, _width, _height, 8, PNG_COLOR_TYPE_RGB,
-                PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
+            if (sums[type] < sums[best])
+                best = type;
         }
+        out[0] = (unsigned char)best;
+        memcpy(out + 1, best == 0 ? row : filtered[best], length);
+    }
 
-        palette = (png_colorp)png_malloc(png_ptr, PNG_MAX_PALETTE_LENGTH * sizeof (png_color));
-        png_set_PLTE(png_ptr, info_ptr, palette, PNG_MAX_PALETTE_LENGTH);
-
-        png_write_info(png_ptr, info_ptr);
-
-        png_set_packing(png_ptr);
-
-        row_pointers = (png_bytep *)malloc(_height * sizeof(png_bytep));
-        if(row_pointers == nullptr)
+    // deflates the input of the stream to the end of out, which grows as needed
+    bool deflateTo(z_stream* stream, std::vector<unsigned char>* out, size_t* used, int flush)
+    {
+        for (;;)
         {
-            fclose(fp);
-            png_destroy_write_struct(&png_ptr, &info_ptr);
-            break;
+            if (*used == out->size())
+            {
+                out->resize(out->size() * 2 + 4096);
+            }
+            stream->next_out = out->data() + *used;
+            stream->avail_out = (uInt)(out->size() - *used);
+            int ret = deflate(stream, flush);
+            *used = out->size() - stream->avail_out;
+            if (ret == Z_STREAM_ERROR)
+                return false;
+            if (flush == Z_FINISH ? ret == Z_STREAM_END : (stream->avail_in == 0 && stream->avail_out != 0))
+                return true;
         }
+    }
+}
+#endif // CC_USE_PNG
 
-        if (!hasAlpha())
-        {
-            for (int i = 0; i < (int)_height; i++)
+bool Image::encodeToPNG(const EncodeOptions& options, Data* out)
+{
+#if CC_USE_PNG
+    // the PNG container is a few chunks written here, so the image data can be deflated in slices on the workers:
+    // each slice is a raw deflate stream ended by a sync flush, the last one by the end of the zlib stream
+    const int srcBpp = hasAlpha() ? 4 : 3;
+    const int bpp = (hasAlpha() && !options.toRGB) ? 4 : 3;
+    const int rowLength = _width * bpp;
+    const int level = std::min(std::max(options.pngCompressionLevel, 0), 9);
+
+    int sliceCount = options.pngSlices > 0 ? options.pngSlices : JobSystem::getInstance()->getWorkerCount() + 1;
+    sliceCount = std::max(std::min(sliceCount, _height / PNG_MIN_SLICE_ROWS), 1);
+    std::vector<PNGSlice> slices(sliceCount);
+    for (int i = 0; i < sliceCount; ++i)
+    {
+        slices[i].firstRow = (int)((int64_t)_height * i / sliceCount);
+        slices[i].endRow = (int)((int64_t)_height * (i + 1) / sliceCount);
+    }
+
+    auto deflateSlice = [&](int index) {
+        PNGSlice& slice = slices[index];
+        slice.ok = false;
+        slice.adler = adler32(0, Z_NULL, 0);
+        slice.length = 0;
+        slice.deflatedSize = 0;
+
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        if (deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 8, options.pngFiltered ? Z_FILTERED : Z_DEFAULT_STRATEGY) != Z_OK)
+            return;
+        slice.deflated.resize(deflateBound(&stream, (uLong)(rowLength + 1) * (slice.endRow - slice.firstRow)) + 16);
+
+        // the rows are converted to the output pixels when these differ, a slice starts from the row before it
+        std::vector<unsigned char> buffer(rowLength * 8 + 1);
+        unsigned char* converted[2] = { buffer.data(), buffer.data() + rowLength };
+        unsigned char* zeroes = buffer.data() + rowLength * 2;
+        unsigned char* filtered = buffer.data() + rowLength * 3;
+        unsigned char* scratch = filtered + rowLength + 1;
+        memset(zeroes, 0, rowLength);
+
+        auto convertRow = [&](int y) -> const unsigned char* {
+            const unsigned char* src = _data + (size_t)y * _width * srcBpp;
+            if (srcBpp == bpp)
+                return src;
+            unsigned char* dst = converted[y & 1];
+            for (int x = 0; x < _width; ++x)
             {
-                row_pointers[i] = (png_bytep)_data + i * _width * 3;
+                dst[x * 3] = src[x * 4];
+                dst[x * 3 + 1] = src[x * 4 + 1];
+                dst[x * 3 + 2] = src[x * 4 + 2];
             }
+            return dst;
+        };
 
-            png_write_image(png_ptr, row_pointers);
-
-            free(row_pointers);
-            row_pointers = nullptr;
-        }
-        else
+        const unsigned char* prev = slice.firstRow > 0 ? convertRow(slice.firstRow - 1) : zeroes;
+        bool ok = true;
+        for (int y = slice.firstRow; y < slice.endRow && ok; ++y)
         {
-            if (isToRGB)
+            const unsigned char* row = convertRow(y);
+            if (options.pngFiltered)
             {
-                unsigned char *tempData = static_cast<unsigned char*>(malloc(_width * _height * 3 * sizeof(unsigned char)));
-                if (nullptr == tempData)
-                {
-                    fclose(fp);
-                    png_destroy_write_struct(&png_ptr, &info_ptr);
-
-                    free(row_pointers);
-                    row_pointers = nullptr;
-                    break;
-                }
-
-                for (int i = 0; i < _height; ++i)
-                {
-                    for (int j = 0; j < _width; ++j)
-                    {
-                        tempData[(i * _width + j) * 3] = _data[(i * _width + j) * 4];
-                        tempData[(i * _width + j) * 3 + 1] = _data[(i * _width + j) * 4 + 1];
-                        tempData[(i * _width + j) * 3 + 2] = _data[(i * _width + j) * 4 + 2];
-                    }
-                }
-
-                for (int i = 0; i < (int)_height; i++)
-                {
-                    row_pointers[i] = (png_bytep)tempData + i * _width * 3;
-                }
-
-                png_write_image(png_ptr, row_pointers);
-
-                free(row_pointers);
-                row_pointers = nullptr;
-
-                if (tempData != nullptr)
-                {
-                    free(tempData);
-                }
+                filterPNGRow(row, prev, rowLength, bpp, filtered, scratch);
             }
             else
             {
-                for (int i = 0; i < (int)_height; i++)
-                {
-                    row_pointers[i] = (png_bytep)_data + i * _width * 4;
-                }
-
-                png_write_image(png_ptr, row_pointers);
-
-                free(row_pointers);
-                row_pointers = nullptr;
+                filtered[0] = 0;
+                memcpy(filtered + 1, row, rowLength);
             }
-        }
-
-        png_write_end(png_ptr, info_ptr);
-
-        png_free(png_ptr, palette);
-        palette = nullptr;
-
-        png_destroy_write_struct(&png_ptr, &info_ptr);
-
-        fclose(fp);
+            slice.adler = adler32(slice.adler, filtered, rowLength + 1);
+            slice.length += rowLength + 1;
 
-        ret = true;
-    } while (0);
-    return ret;
-#else
-    CCLOG("png is not enabled, please enable it in ccConfig.h");
-    return false;
-#endif // CC_USE_PNG
-}
+            stream.next_in = filtered;
+            stream.avail_in = rowLength + 1;
+            ok = deflateTo(&stream, &slice.deflated, &slice.deflatedSize, Z_NO_FLUSH);
+            prev = row;
+        }
+        ok = ok && deflateTo(&stream, &slice.deflated, &slice.deflatedSize, index == sliceCount - 1 ? Z_FINISH : Z_SYNC_FLUSH);
+        deflateEnd(&stream);
+        slice.ok = ok;
+    };
 
-bool Image::saveImageToJPG(const std::string& filePath)
-{
-#if CC_USE_WIC
-    return encodeWithWIC(filePath, false, GUID_ContainerFormatJpeg);
-#elif CC_USE_JPEG
-    bool ret = false;
-    do
+    if (sliceCount > 1)
     {
-        struct jpeg_compress_struct cinfo;
-        struct jpeg_error_mgr jerr;
-        FILE * outfile;                 /* target file */
-        JSAMPROW row_pointer[1];        /* pointer to JSAMPLE row[s] */
-        int     row_stride;          /* physical row width in image buffer */
-
-        cinfo.err = jpeg_std_error(&jerr);
-        /* Now we can initialize the JPEG compression object. */
-        jpeg_create_compress(&cinfo);
-
-        CC_BREAK_IF((outfile = fopen(FileUtils::getInstance()->getSuitableFOpen(filePath).c_str(), "wb")) == nullptr);
-
-        jpeg_stdio_dest(&cinfo, outfile);
-
-        cinfo.image_width = _width;    /* image width and height, in pixels */
-        cinfo.image_height = _height;
-        cinfo.input_components = 3;       /* # of color components per pixel */
-        cinfo.in_color_space = JCS_RGB;       /* colorspace of input image */
-
-        jpeg_set_defaults(&cinfo);
-        jpeg_set_quality(&cinfo, 90, TRUE);
-
-        jpeg_start_compress(&cinfo, TRUE);
-
-        row_stride = _width * 3; /* JSAMPLEs per row in image_buffer */
-
-        if (hasAlpha())
-        {
-            unsigned char *tempData = static_cast<unsigned char*>(malloc(_width * _height * 3 * sizeof(unsigned char)));
-            if (nullptr == tempData)
-            {
-                jpeg_finish_compress(&cinfo);
-                jpeg_destroy_compress(&cinfo);
-                fclose(outfile);
-                break;
-            }
-
-            for (int i = 0; i < _height; ++i)
-            {
-                for (int j = 0; j < _width; ++j)
+        JobSystem::getInstance()->parallelFor(0, sliceCount, deflateSlice, 1);
+    }
+    else
+    {
+        deflateSlice(0);
+    }
 
-                {
-                    tempData[(i * _width + j) * 3] = _data[(i * _width + j) * 4];
-                    tempData[(i * _width + j) * 3 + 1] = _data[(i * _width + j) * 4 + 1];
-                    tempData[(i * _width + j) * 3 + 2] = _data[(i * _width + j) * 4 + 2];
-                }
-            }
+    size_t idatLength = 2 + 4;
+    uLong adler = adler32(0, Z_NULL, 0);
+    for (const auto& slice : slices)
+    {
+        if (!slice.ok)
+            return false;
+        idatLength += slice.deflatedSize;
+        adler = adler32_combine(adler, slice.adler, (z_off_t)slice.length);
+    }
 
-            while (cinfo.next_scanline < cinfo.image_height)
-            {
-                row_pointer[0] = & tempData[cinfo.next_scanline * row_stride];
-                (void) jpeg_write_scanlines(&cinfo, row_pointer, 1);
-            }
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    const size_t size = sizeof(signature) + (12 + 13) + (12 + idatLength) + 12;
+    unsigned char* bytes = static_cast<unsigned char*>(malloc(size));
+    if (bytes == nullptr)
+        return false;
 
-            if (tempData != nullptr)
-            {
-                free(tempData);
-            }
-        }
-        else
-        {
-            while (cinfo.next_scanline < cinfo.image_height) {
-                row_pointer[0] = & _data[cinfo.next_scanline * row_stride];
-                (void) jpeg_write_scanlines(&cinfo, row_pointer, 1);
-            }
-        }
+    unsigned char* p = bytes;
+    memcpy(p, signature, sizeof(signature));
+    p += sizeof(signature);
+
+    unsigned char* chunk = p + 4;
+    p = writeChunkHeader(p, 13, "IHDR");
+    p = writeBigEndian(p, _width);
+    p = writeBigEndian(p, _height);
+    *p++ = 8;                       // bit depth
+    *p++ = bpp == 4 ? 6 : 2;        // RGBA or RGB
+    *p++ = 0;                       // deflate
+    *p++ = 0;                       // adaptive filtering
+    *p++ = 0;                       // no interlace
+    p = writeChunkCRC(p, chunk, 13);
+
+    chunk = p + 4;
+    p = writeChunkHeader(p, (uint32_t)idatLength, "IDAT");
+    // the zlib header, 32K window and the level hint
+    const unsigned char cmf = 0x78;
+    unsigned char flg = (unsigned char)((level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3) << 6);
+    const int check = (cmf * 256 + flg) % 31;
+    flg += check ? 31 - check : 0;
+    *p++ = cmf;
+    *p++ = flg;
+    for (const auto& slice : slices)
+    {
+        memcpy(p, slice.deflated.data(), slice.deflatedSize);
+        p += slice.deflatedSize;
+    }
+    p = writeBigEndian(p, (uint32_t)adler);
+    p = writeChunkCRC(p, chunk, (uint32_t)idatLength);
 
-        jpeg_finish_compress(&cinfo);
-        fclose(outfile);
-        jpeg_destroy_compress(&cinfo);
+    chunk = p + 4;
+    p = writeChunkHeader(p, 0, "IEND");
+    p = writeChunkCRC(p, chunk, 0);
 
-        ret = true;
-    } while (0);
-    return ret;
+    CCASSERT(p == bytes + size, "PNG size mismatch");
+    out->fastSet(bytes, size);
+    return true;
 #else
-    CCLOG("jpeg is not enabled, please enable it in ccConfig.h");
+    CCLOG("png is not enabled, please enable it in ccConfig.h");
     return false;
-#endif // CC_USE_JPEG
+#endif // CC_USE_PNG
 }
 
 namespace
@@ -1401,6 +1667,65 @@ namespace
 #endif // CC_USE_JPEG
 }
 
+bool Image::encodeToJPG(const EncodeOptions& options, Data* out)
+{
+#if CC_USE_JPEG
+    struct jpeg_compress_struct cinfo;
+    struct MyErrorMgr jerr;
+    unsigned char* buffer = nullptr;
+    unsigned long size = 0;
+    const int srcBpp = hasAlpha() ? 4 : 3;
+    // the alpha is dropped row by row
+    std::vector<unsigned char> row(srcBpp == 4 ? _width * 3 : 0);
+
+    cinfo.err = jpeg_std_error(&jerr.pub);
+    jerr.pub.error_exit = myErrorExit;
+    if (setjmp(jerr.setjmp_buffer))
+    {
+        jpeg_destroy_compress(&cinfo);
+        free(buffer);
+        return false;
+    }
+
+    jpeg_create_compress(&cinfo);
+    jpeg_mem_dest(&cinfo, &buffer, &size);
+
+    cinfo.image_width = _width;
+    cinfo.image_height = _height;
+    cinfo.input_components = 3;
+    cinfo.in_color_space = JCS_RGB;
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, std::min(std::max(options.jpgQuality, 1), 100), TRUE);
+
+    jpeg_start_compress(&cinfo, TRUE);
+    while (cinfo.next_scanline < cinfo.image_height)
+    {
+        unsigned char* src = _data + (size_t)cinfo.next_scanline * _width * srcBpp;
+        JSAMPROW rowPointer = src;
+        if (srcBpp == 4)
+        {
+            for (int x = 0; x < _width; ++x)
+            {
+                row[x * 3] = src[x * 4];
+                row[x * 3 + 1] = src[x * 4 + 1];
+                row[x * 3 + 2] = src[x * 4 + 2];
+            }
+            rowPointer = row.data();
+        }
+        jpeg_write_scanlines(&cinfo, &rowPointer, 1);
+    }
+    jpeg_finish_compress(&cinfo);
+    jpeg_destroy_compress(&cinfo);
+
+    // jpeg_mem_dest() allocates with malloc()
+    out->fastSet(buffer, size);
+    return true;
+#else
+    CCLOG("jpeg is not enabled, please enable it in ccConfig.h");
+    return false;
+#endif // CC_USE_JPEG
+}
+
 bool Image::initWithJpgData(const unsigned char * data, ssize_t dataLen)
 {
 #if CC_USE_WIC
@@ -1602,10 +1927,53 @@ bool Image::initWithPngData(const unsigned char * data, ssize_t dataLen)
 
         // read png data
         png_size_t rowbytes;
-        png_bytep* row_pointers = (png_bytep*)malloc( sizeof(png_bytep) * _height );
-
         rowbytes = png_get_rowbytes(png_ptr, info_ptr);
 
+        // decode the rows straight into the format of the texture, the RGBA8888 image is never allocated
+        if (color_type == PNG_COLOR_TYPE_RGB_ALPHA && bit_depth == 8
+            && png_get_interlace_type(png_ptr, info_ptr) == PNG_INTERLACE_NONE
+            && (_decodePixelFormat == Texture2D::PixelFormat::RGBA4444
+                || _decodePixelFormat == Texture2D::PixelFormat::RGB565
+                || _decodePixelFormat == Texture2D::PixelFormat::A8))
+        {
+            int outRowBytes = _width * Texture2D::getPixelFormatInfoMap().at(_decodePixelFormat).bpp / 8;
+            _dataLen = outRowBytes * _height;
+            _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
+            png_bytep row = (png_bytep)malloc(rowbytes);
+            if (!_data || !row)
+            {
+                free(row);
+                break;
+            }
+
+            for (int i = 0; i < _height; ++i)
+            {
+                png_read_row(png_ptr, row, nullptr);
+                if (PNG_PREMULTIPLIED_ALPHA_ENABLED)
+                {
+                    pixel::premultiplyAlpha(row, _width);
+                }
+
+                unsigned char* out = _data + i * outRowBytes;
+                if (_decodePixelFormat == Texture2D::PixelFormat::RGBA4444)
+                    pixel::convertRGBA8888ToRGBA4444(row, rowbytes, out);
+                else if (_decodePixelFormat == Texture2D::PixelFormat::RGB565)
+                    pixel::convertRGBA8888ToRGB565(row, rowbytes, out);
+                else
+                    pixel::convertRGBA8888ToA8(row, rowbytes, out);
+            }
+            free(row);
+
+            png_read_end(png_ptr, nullptr);
+
+            _renderFormat = _decodePixelFormat;
+            _hasPremultipliedAlpha = PNG_PREMULTIPLIED_ALPHA_ENABLED;
+            ret = true;
+            break;
+        }
+
+        png_bytep* row_pointers = (png_bytep*)malloc( sizeof(png_bytep) * _height );
+
         _dataLen = rowbytes * _height;
         _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
         if (!_data)
@@ -1836,20 +2204,285 @@ bool Image::initWithTiffData(const unsigned char * data, ssize_t dataLen)
 
 #endif // (CC_TARGET_PLATFORM != CC_PLATFORM_IOS)
 
+bool Image::saveToFile(const std::string& filename, const EncodeOptions& options)
+{
+    std::string fileExtension = FileUtils::getInstance()->getFileExtension(filename);
+    Format format;
+    if (fileExtension == ".png")
+    {
+        format = Format::PNG;
+    }
+    else if (fileExtension == ".jpg")
+    {
+        format = Format::JPG;
+    }
+    else
+    {
+        CCLOG("cocos2d: Image: saveToFile no support file extension(only .png or .jpg) for file: %s", filename.c_str());
+        return false;
+    }
+
+#if CC_USE_WIC
+    if (isCompressed() || (_renderFormat != Texture2D::PixelFormat::RGB888 && _renderFormat != Texture2D::PixelFormat::RGBA8888))
+    {
+        CCLOG("cocos2d: Image: saveToFile is only support for Texture2D::PixelFormat::RGB888 or Texture2D::PixelFormat::RGBA8888 uncompressed data for now");
+        return false;
+    }
+    return encodeWithWIC(filename, format == Format::PNG && options.toRGB, format == Format::PNG ? GUID_ContainerFormatPng : GUID_ContainerFormatJpeg);
+#else
+    Data data = encode(format, options);
+    return !data.isNull() && FileUtils::getInstance()->writeDataToFile(data, filename);
+#endif
+}
+
+Data Image::encode(Format format, const EncodeOptions& options)
+{
+    Data data;
+    //only support for Texture2D::PixelFormat::RGB888 or Texture2D::PixelFormat::RGBA8888 uncompressed data
+    if (isCompressed() || (_renderFormat != Texture2D::PixelFormat::RGB888 && _renderFormat != Texture2D::PixelFormat::RGBA8888))
+    {
+        CCLOG("cocos2d: Image: saveToFile is only support for Texture2D::PixelFormat::RGB888 or Texture2D::PixelFormat::RGBA8888 uncompressed data for now");
+        return data;
+    }
+    if (format != Format::PNG && format != Format::JPG)
+    {
+        CCLOG("cocos2d: Image: encode only supports Format::PNG and Format::JPG");
+        return data;
+    }
+
+#if CC_USE_PLATFORM_IMAGE_DECODER
+    // iOS has no bundled encoders
+    if ((options.platformEncoder || CC_TARGET_PLATFORM == CC_PLATFORM_IOS) && encodeWithPlatform(format, options, &data))
+    {
+        return data;
+    }
+#endif
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_IOS)
+    if (format == Format::PNG)
+    {
+        encodeToPNG(options, &data);
+    }
+    else
+    {
+        encodeToJPG(options, &data);
+    }
+#endif
+    return data;
+}
+
 void Image::premultipliedAlpha()
 {
     CCASSERT(_renderFormat == Texture2D::PixelFormat::RGBA8888, "The pixel format should be RGBA8888!");
 
-    unsigned int* fourBytes = (unsigned int*)_data;
-    for(int i = 0; i < _width * _height; i++)
+    pixel::premultiplyAlpha(_data, (ssize_t)_width * _height);
+
+    _hasPremultipliedAlpha = true;
+}
+
+
+namespace
+{
+    // AUTO times each decoder on this many images of at least DECODER_CALIBRATION_PIXELS, the small ones say little
+    const int DECODER_CALIBRATION_SAMPLES = 3;
+    const int DECODER_CALIBRATION_PIXELS = 256 * 256;
+
+    struct DecoderTiming
     {
-        unsigned char* p = _data + i * 4;
-        fourBytes[i] = CC_RGB_PREMULTIPLY_ALPHA(p[0], p[1], p[2], p[3]);
+        Image::Decoder decoder;
+        // of the bundled and the platform decoder
+        int samples[2];
+        double nsPerPixel[2];
+        int turn;
+    };
+
+    // PNG and JPG, the images are decoded on several threads
+    DecoderTiming s_decoderTimings[2] = {
+        { Image::Decoder::AUTO, { 0, 0 }, { 0, 0 }, 0 },
+        { Image::Decoder::AUTO, { 0, 0 }, { 0, 0 }, 0 },
+    };
+    std::mutex s_decoderMutex;
+
+    DecoderTiming* getDecoderTiming(Image::Format format)
+    {
+        if (format == Image::Format::PNG)
+            return &s_decoderTimings[0];
+        if (format == Image::Format::JPG)
+            return &s_decoderTimings[1];
+        return nullptr;
     }
 
-    _hasPremultipliedAlpha = true;
+    bool isCalibrated(const DecoderTiming& timing)
+    {
+        return timing.samples[0] >= DECODER_CALIBRATION_SAMPLES && timing.samples[1] >= DECODER_CALIBRATION_SAMPLES;
+    }
+
+    Image::Decoder getFasterDecoder(const DecoderTiming& timing)
+    {
+        return timing.nsPerPixel[1] / timing.samples[1] < timing.nsPerPixel[0] / timing.samples[0]
+            ? Image::Decoder::PLATFORM : Image::Decoder::BUNDLED;
+    }
+}
+
+void Image::setDecoder(Format format, Decoder decoder)
+{
+    DecoderTiming* timing = getDecoderTiming(format);
+    CCASSERT(timing, "Only PNG and JPG have a platform decoder");
+    if (timing)
+    {
+        std::lock_guard<std::mutex> lock(s_decoderMutex);
+        *timing = { decoder, { 0, 0 }, { 0, 0 }, 0 };
+    }
+}
+
+Image::Decoder Image::getDecoder(Format format)
+{
+    DecoderTiming* timing = getDecoderTiming(format);
+    if (!timing)
+        return Decoder::BUNDLED;
+
+    std::lock_guard<std::mutex> lock(s_decoderMutex);
+    if (timing->decoder == Decoder::AUTO && isCalibrated(*timing))
+        return getFasterDecoder(*timing);
+    return timing->decoder;
+}
+
+bool Image::initWithPngOrJpgData(const unsigned char * data, ssize_t dataLen)
+{
+#if CC_USE_PLATFORM_IMAGE_DECODER
+    DecoderTiming* timing = getDecoderTiming(_fileType);
+    Decoder decoder = Decoder::BUNDLED;
+    bool timed = false;
+    if (isPlatformDecoderAvailable())
+    {
+        std::lock_guard<std::mutex> lock(s_decoderMutex);
+        decoder = timing->decoder;
+        if (decoder == Decoder::AUTO && isCalibrated(*timing))
+        {
+            decoder = getFasterDecoder(*timing);
+        }
+        else if (decoder == Decoder::AUTO)
+        {
+            // the one with fewer samples, in turns when they have as many
+            int platformFirst = timing->samples[1] == timing->samples[0] ? (timing->turn ^= 1) : timing->samples[1] < timing->samples[0];
+            decoder = platformFirst ? Decoder::PLATFORM : Decoder::BUNDLED;
+            timed = true;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    bool ret = false;
+    if (decoder == Decoder::PLATFORM)
+    {
+        ret = initWithPlatformData(data, dataLen);
+        // unsupported by the platform, or CCImage would have to unpremultiply its result
+        if (!ret)
+        {
+            timed = false;
+            decoder = Decoder::BUNDLED;
+        }
+    }
+    if (!ret)
+    {
+        ret = _fileType == Format::PNG ? initWithPngData(data, dataLen) : initWithJpgData(data, dataLen);
+    }
+
+    if (ret && timed && (ssize_t)_width * _height >= DECODER_CALIBRATION_PIXELS)
+    {
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        int index = decoder == Decoder::PLATFORM ? 1 : 0;
+
+        std::lock_guard<std::mutex> lock(s_decoderMutex);
+        if (timing->decoder == Decoder::AUTO && timing->samples[index] < DECODER_CALIBRATION_SAMPLES)
+        {
+            timing->samples[index]++;
+            timing->nsPerPixel[index] += ns / ((double)_width * _height);
+            if (isCalibrated(*timing))
+            {
+                CCLOG("cocos2d: %s images are decoded by the %s decoder", _fileType == Format::PNG ? "PNG" : "JPG",
+                      getFasterDecoder(*timing) == Decoder::PLATFORM ? "platform" : "bundled");
+            }
+        }
+    }
+    return ret;
+#else
+    return _fileType == Format::PNG ? initWithPngData(data, dataLen) : initWithJpgData(data, dataLen);
+#endif // CC_USE_PLATFORM_IMAGE_DECODER
 }
 
+bool Image::initWithPlatformData(const unsigned char * data, ssize_t dataLen)
+{
+    bool premultiplied = false;
+    bool opaque = false;
+    if (!decodeWithPlatform(data, dataLen, &premultiplied, &opaque))
+    {
+        return false;
+    }
+
+    // the same formats as libpng and libjpeg give
+    ssize_t pixels = (ssize_t)_width * _height;
+    if (opaque)
+    {
+        for (ssize_t i = 0; i < pixels; ++i)
+        {
+            memmove(_data + i * 3, _data + i * 4, 3);
+        }
+        _dataLen = pixels * 3;
+        _renderFormat = Texture2D::PixelFormat::RGB888;
+        _hasPremultipliedAlpha = false;
+        return true;
+    }
+
+    if (premultiplied && !PNG_PREMULTIPLIED_ALPHA_ENABLED)
+    {
+        free(_data);
+        _data = nullptr;
+        return false;
+    }
+
+    _dataLen = pixels * 4;
+    _renderFormat = Texture2D::PixelFormat::RGBA8888;
+    _hasPremultipliedAlpha = premultiplied;
+    if (!premultiplied && PNG_PREMULTIPLIED_ALPHA_ENABLED)
+    {
+        premultipliedAlpha();
+    }
+
+    if (_decodePixelFormat == Texture2D::PixelFormat::RGBA4444
+        || _decodePixelFormat == Texture2D::PixelFormat::RGB565
+        || _decodePixelFormat == Texture2D::PixelFormat::A8)
+    {
+        ssize_t outLen = pixels * Texture2D::getPixelFormatInfoMap().at(_decodePixelFormat).bpp / 8;
+        unsigned char* out = static_cast<unsigned char*>(malloc(outLen));
+        if (out)
+        {
+            if (_decodePixelFormat == Texture2D::PixelFormat::RGBA4444)
+                pixel::convertRGBA8888ToRGBA4444(_data, _dataLen, out);
+            else if (_decodePixelFormat == Texture2D::PixelFormat::RGB565)
+                pixel::convertRGBA8888ToRGB565(_data, _dataLen, out);
+            else
+                pixel::convertRGBA8888ToA8(_data, _dataLen, out);
+
+            free(_data);
+            _data = out;
+            _dataLen = outLen;
+            _renderFormat = _decodePixelFormat;
+        }
+    }
+    return true;
+}
+
+#if !CC_USE_PLATFORM_IMAGE_DECODER
+bool Image::decodeWithPlatform(const unsigned char * data, ssize_t dataLen, bool* premultiplied, bool* opaque)
+{
+    return false;
+}
+
+bool Image::isPlatformDecoderAvailable()
+{
+    return false;
+}
+#endif // !CC_USE_PLATFORM_IMAGE_DECODER
 
 void Image::setPVRImagesHavePremultipliedAlpha(bool haveAlphaPremultiplied)
 {
@@ -28,6 +28,7 @@ THE SOFTWARE.
 /// @cond DO_NOT_SHOW
 
 #include "base/CCRef.h"
+#include "base/CCData.h"
 #include "renderer/CCTexture2D.h"
 
 // premultiply alpha, or the effect will wrong when want to use other pixel format in Texture2D,
@@ -59,6 +60,7 @@ class CC_DLL Image : public Ref
 {
 public:
     friend class TextureCache;
+    friend class VolatileTextureMgr;
     /**
      * @js ctor
      */
@@ -84,6 +86,8 @@ public:
         PVR,
         //! ETC
         ETC,
+        //! KTX, a container of GL compressed formats such as ETC2 or ASTC
+        KTX,
         //! S3TC
 //        S3TC,
         //! ATITC
@@ -113,6 +117,15 @@ public:
     */
     bool initWithImageData(const unsigned char * data, ssize_t dataLen);
 
+    /**
+     @brief The pixel format the image is going to be converted to, set it before the init methods.
+     The RGBA8888 PNG files are then decoded into RGBA4444, RGB565 or A8 row by row,
+     so the full size RGBA8888 image isn't allocated.
+     The other images and formats are decoded as usual.
+     @since v3.11
+     */
+    void setDecodePixelFormat(Texture2D::PixelFormat format) { _decodePixelFormat = format; }
+
     // @warning kFmtRawData only support RGBA8888
     bool initWithRawData(const unsigned char * data, ssize_t dataLen, int width, int height, int bitsPerComponent, bool preMulti = false);
 
@@ -131,6 +144,47 @@ public:
     bool                     hasAlpha();
     bool                     isCompressed();
 
+    /**
+     @brief Builds the mipmaps of an uncompressed image on the CPU, a 2x2 box filter down to 1x1,
+     so that a loader thread does the work of Texture2D::generateMipmap().
+     Only the power of two I8, AI88, RGB888 and RGBA8888 images without mipmaps can.
+     @return Whether the image has a full mipmap chain now.
+     @since v3.11
+     */
+    bool generateMipmaps();
+
+    /** How saveToFile() and encode() write the PNG and JPG files.
+     @since v3.11
+     */
+    struct EncodeOptions
+    {
+        //! whether the alpha is dropped, the JPG files never have it, true by default
+        bool toRGB;
+        //! the zlib level of the PNG files from 0, stored, to 9, 6 by default. 1 is a few times faster for larger files
+        int pngCompressionLevel;
+        //! whether the rows of the PNG files are filtered, true by default. The files are smaller for a pass over the rows
+        bool pngFiltered;
+        /** the PNG rows are deflated in that many slices on the JobSystem, 0 by default for one per thread.
+         The slices don't share their dictionary, the file is a little larger than with 1.
+         */
+        int pngSlices;
+        //! the quality of the JPG files from 1 to 100, 90 by default
+        int jpgQuality;
+        /** encodes with ImageIO on iOS and Mac, Bitmap.compress on Android, false by default.
+         Only toRGB and jpgQuality apply then. When the platform has no encoder, or it fails, the bundled one is used.
+         */
+        bool platformEncoder;
+
+        EncodeOptions()
+        : toRGB(true)
+        , pngCompressionLevel(6)
+        , pngFiltered(true)
+        , pngSlices(0)
+        , jpgQuality(90)
+        , platformEncoder(false)
+        {}
+    };
+
     /**
      @brief    Save Image data to the specified file, with specified format.
      @param    filePath        the file's absolute path, including file suffix.
@@ -138,6 +192,21 @@ public:
      */
     bool saveToFile(const std::string &filename, bool isToRGB = true);
 
+    /**
+     @brief Saves the image to a .png or .jpg file, see encode().
+     @since v3.11
+     */
+    bool saveToFile(const std::string &filename, const EncodeOptions& options);
+
+    /**
+     @brief Encodes the image to a PNG or JPG file in memory, only RGB888 and RGBA8888 uncompressed images can.
+     It can be called from any thread.
+     @param format Format::PNG or Format::JPG.
+     @return The file, null if the image couldn't be encoded.
+     @since v3.11
+     */
+    Data encode(Format format, const EncodeOptions& options = EncodeOptions());
+
     /**
      * Enables or disables premultiplied alpha for PNG files.
      *
@@ -145,6 +214,32 @@ public:
      */
     static void setPNGPremultipliedAlphaEnabled(bool enabled) { PNG_PREMULTIPLIED_ALPHA_ENABLED = enabled; }
     
+    /** The decoders of the PNG and JPEG files, see setDecoder().
+     @since v3.11
+     */
+    enum class Decoder
+    {
+        //! times both decoders on the first large images of the format, then keeps the faster one
+        AUTO,
+        //! libpng and libjpeg, UIImage on iOS
+        BUNDLED,
+        //! ImageIO on iOS and Mac, AImageDecoder on Android 11 and later
+        PLATFORM
+    };
+
+    /**
+     @brief Selects the decoder of the PNG or JPG files, AUTO by default.
+     The platform decoders decode on the same threads as the bundled ones, the result is converted to the same
+     pixel formats and premultiplied the same way. When the platform has none, or it fails on a file, the
+     bundled decoder is used.
+     @since v3.11
+     */
+    static void setDecoder(Format format, Decoder decoder);
+    /** The decoder set for the format, or the one AUTO settled on once it has timed both.
+     @since v3.11
+     */
+    static Decoder getDecoder(Format format);
+
     /** treats (or not) PVR files as if they have alpha premultiplied.
      Since it is impossible to know at runtime if the PVR images have the alpha channel premultiplied, it is
      possible load them as if they have (or not) the alpha channel premultiplied.
@@ -161,15 +256,31 @@ protected:
     bool initWithPVRv2Data(const unsigned char * data, ssize_t dataLen);
     bool initWithPVRv3Data(const unsigned char * data, ssize_t dataLen);
     bool initWithETCData(const unsigned char * data, ssize_t dataLen);
+    bool initWithKTXData(const unsigned char * data, ssize_t dataLen);
+    void setDataFromBuffer(const unsigned char * buffer, ssize_t offset, ssize_t length);
 
     typedef struct sImageTGA tImageTGA;
     bool initWithTGAData(tImageTGA* tgaData);
 
-    bool saveImageToPNG(const std::string& filePath, bool isToRGB = true);
-    bool saveImageToJPG(const std::string& filePath);
+    bool encodeToPNG(const EncodeOptions& options, Data* out);
+    bool encodeToJPG(const EncodeOptions& options, Data* out);
+    /*
+     Encodes with the platform encoder, implemented per platform when CC_USE_PLATFORM_IMAGE_DECODER is set.
+     */
+    bool encodeWithPlatform(Format format, const EncodeOptions& options, Data* out);
 
     void premultipliedAlpha();
 
+    bool initWithPngOrJpgData(const unsigned char * data, ssize_t dataLen);
+    bool initWithPlatformData(const unsigned char * data, ssize_t dataLen);
+    /*
+     Decodes a PNG or JPEG with the platform decoder into _data, RGBA8888 and _width * _height * 4 bytes,
+     *premultiplied tells whether the color is premultiplied, *opaque whether the alpha is 255 everywhere.
+     Implemented per platform when CC_USE_PLATFORM_IMAGE_DECODER is set.
+     */
+    bool decodeWithPlatform(const unsigned char * data, ssize_t dataLen, bool* premultiplied, bool* opaque);
+    static bool isPlatformDecoderAvailable();
+
 protected:
     /**
      @brief Determine how many mipmaps can we have.
@@ -190,7 +301,10 @@ protected:
     int _numberOfMipmaps;
     // false if we can't auto detect the image is premultiplied or not.
     bool _hasPremultipliedAlpha;
+    Texture2D::PixelFormat _decodePixelFormat;
     std::string _filePath;
+    // the buffer initWithImageData() inflated, setDataFromBuffer() takes it instead of copying it
+    unsigned char *_unpackedData;
 
 protected:
     // noncopyable
@@ -212,6 +326,7 @@ protected:
     bool isTiff(const unsigned char * data, ssize_t dataLen);
     bool isPvr(const unsigned char * data, ssize_t dataLen);
     bool isEtc(const unsigned char * data, ssize_t dataLen);
+    bool isKtx(const unsigned char * data, ssize_t dataLen);
 };
 
 // end of platform group
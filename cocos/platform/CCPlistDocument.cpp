@@ -0,0 +1,1247 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "platform/CCPlistDocument.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "platform/CCFileUtils.h"
+#include "platform/CCSAXParser.h"
+#include "base/ccMacros.h"
+#include "base/ccUTF8.h"
+#include "base/ccUtils.h"
+#include "tinyxml2/tinyxml2.h"
+
+NS_CC_BEGIN
+
+// the dictionaries with more keys get a hash index, a scan is faster below
+static const unsigned int INDEXED_DICT_SIZE = 16;
+
+static const char BINARY_MAGIC[8] = { 'b', 'p', 'l', 'i', 's', 't', '0', '0' };
+static const size_t BINARY_TRAILER_SIZE = 32;
+// the containers nested deeper make the file invalid, a binary plist can reference its own objects
+static const int BINARY_MAX_DEPTH = 512;
+
+static uint64_t readBigEndian(const unsigned char* bytes, size_t size)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+static void writeBigEndian(std::vector<unsigned char>& out, uint64_t value, size_t size)
+{
+    for (size_t i = size; i > 0; --i)
+    {
+        out.push_back(static_cast<unsigned char>(value >> ((i - 1) * 8)));
+    }
+}
+
+class PlistDocument::Builder : public SAXDelegator
+{
+public:
+    explicit Builder(PlistDocument* doc)
+    : _doc(doc)
+    , _text(nullptr)
+    , _textLength(0)
+    , _key(nullptr)
+    , _keyLength(0)
+    , _capture(CAPTURE_NONE)
+    , _valid(true)
+    {}
+
+    bool isValid() const { return _valid && _open.empty(); }
+
+    virtual void startElement(void *ctx, const char *name, const char **atts) override
+    {
+        CC_UNUSED_PARAM(ctx);
+        CC_UNUSED_PARAM(atts);
+
+        _text = nullptr;
+        _textLength = 0;
+        _capture = CAPTURE_NONE;
+
+        if (strcmp(name, "key") == 0)
+        {
+            _capture = CAPTURE_KEY;
+        }
+        else if (strcmp(name, "dict") == 0)
+        {
+            _open.push_back(addNode(Type::DICT));
+        }
+        else if (strcmp(name, "array") == 0)
+        {
+            _open.push_back(addNode(Type::ARRAY));
+        }
+        else if (strcmp(name, "string") == 0 || strcmp(name, "integer") == 0 || strcmp(name, "real") == 0)
+        {
+            _capture = CAPTURE_VALUE;
+        }
+    }
+
+    virtual void endElement(void *ctx, const char *name) override
+    {
+        CC_UNUSED_PARAM(ctx);
+
+        if (strcmp(name, "key") == 0)
+        {
+            _key = _text;
+            _keyLength = _textLength;
+        }
+        else if (strcmp(name, "dict") == 0 || strcmp(name, "array") == 0)
+        {
+            if (_open.empty())
+            {
+                _valid = false;
+                return;
+            }
+            _open.pop_back();
+        }
+        else if (strcmp(name, "string") == 0)
+        {
+            addValue(Type::STRING);
+        }
+        else if (strcmp(name, "integer") == 0)
+        {
+            addValue(Type::INTEGER);
+        }
+        else if (strcmp(name, "real") == 0)
+        {
+            addValue(Type::REAL);
+        }
+        else if (strcmp(name, "true") == 0 || strcmp(name, "false") == 0)
+        {
+            _text = name[0] == 't' ? "true" : "false";
+            _textLength = name[0] == 't' ? 4 : 5;
+            addValue(Type::BOOLEAN);
+        }
+
+        _capture = CAPTURE_NONE;
+        _text = nullptr;
+        _textLength = 0;
+    }
+
+    virtual void textHandler(void *ctx, const char *s, int len) override
+    {
+        CC_UNUSED_PARAM(ctx);
+        if (_capture == CAPTURE_NONE)
+        {
+            return;
+        }
+
+        if (_text == nullptr)
+        {
+            _text = s;
+            _textLength = len;
+        }
+        else
+        {
+            // a text and a CDATA section, they aren't contiguous in the buffer any more
+            std::string joined(_text, _textLength);
+            joined.append(s, len);
+            _doc->_joinedTexts.push_back(std::move(joined));
+            _text = _doc->_joinedTexts.back().c_str();
+            _textLength = static_cast<unsigned int>(_doc->_joinedTexts.back().length());
+        }
+    }
+
+private:
+    enum Capture
+    {
+        CAPTURE_NONE,
+        CAPTURE_KEY,
+        CAPTURE_VALUE,
+    };
+
+    void addValue(Type type)
+    {
+        // the values outside of a container are ignored, like the ValueMap does
+        if (_open.empty())
+        {
+            return;
+        }
+        unsigned int index = addNode(type);
+        NodeData& node = _doc->_nodes[index];
+        node.text = _text ? _text : "";
+        node.textLength = _textLength;
+    }
+
+    unsigned int addNode(Type type)
+    {
+        auto& nodes = _doc->_nodes;
+        unsigned int index = static_cast<unsigned int>(nodes.size());
+
+        NodeData node;
+        node.type = type;
+        node.key = "";
+        node.keyLength = 0;
+        node.text = "";
+        node.textLength = 0;
+        node.firstChild = 0;
+        node.lastChild = 0;
+        node.nextSibling = 0;
+        node.childCount = 0;
+
+        if (!_open.empty())
+        {
+            NodeData& parent = nodes[_open.back()];
+            if (parent.type == Type::DICT && _key)
+            {
+                node.key = _key;
+                node.keyLength = _keyLength;
+            }
+            if (parent.lastChild)
+            {
+                nodes[parent.lastChild].nextSibling = index;
+            }
+            else
+            {
+                parent.firstChild = index;
+            }
+            parent.lastChild = index;
+            ++parent.childCount;
+        }
+        else if (index != 1)
+        {
+            // a second top level container
+            _valid = false;
+        }
+
+        nodes.push_back(node);
+        return index;
+    }
+
+    PlistDocument* _doc;
+    std::vector<unsigned int> _open;
+    const char* _text;
+    unsigned int _textLength;
+    const char* _key;
+    unsigned int _keyLength;
+    Capture _capture;
+    bool _valid;
+};
+
+// Makes the nodes of a binary plist, the ASCII strings point into the file and the other values are converted to text
+class PlistDocument::BinaryReader
+{
+public:
+    explicit BinaryReader(PlistDocument* doc)
+    : _doc(doc)
+    , _bytes(doc->_data.getBytes())
+    , _size(doc->_data.getSize())
+    , _offsetSize(0)
+    , _refSize(0)
+    , _objectCount(0)
+    , _offsetTable(0)
+    {}
+
+    bool read()
+    {
+        if (_size < sizeof(BINARY_MAGIC) + BINARY_TRAILER_SIZE)
+        {
+            return false;
+        }
+
+        const unsigned char* trailer = _bytes + _size - BINARY_TRAILER_SIZE;
+        _offsetSize = trailer[6];
+        _refSize = trailer[7];
+        _objectCount = readBigEndian(trailer + 8, 8);
+        uint64_t topObject = readBigEndian(trailer + 16, 8);
+        _offsetTable = readBigEndian(trailer + 24, 8);
+
+        uint64_t tableEnd = _size - BINARY_TRAILER_SIZE;
+        if (_offsetSize < 1 || _offsetSize > 8 || _refSize < 1 || _refSize > 8 || topObject >= _objectCount
+            || _offsetTable < sizeof(BINARY_MAGIC) || _offsetTable > tableEnd
+            || _objectCount > (tableEnd - _offsetTable) / _offsetSize)
+        {
+            return false;
+        }
+
+        return readObject(topObject, 0, nullptr, 0, 0);
+    }
+
+private:
+    bool getObjectOffset(uint64_t object, size_t* offset) const
+    {
+        if (object >= _objectCount)
+        {
+            return false;
+        }
+        uint64_t value = readBigEndian(_bytes + _offsetTable + object * _offsetSize, _offsetSize);
+        if (value < sizeof(BINARY_MAGIC) || value >= _offsetTable)
+        {
+            return false;
+        }
+        *offset = static_cast<size_t>(value);
+        return true;
+    }
+
+    // the count of the marker, or the integer after it when the count doesn't fit
+    bool readCount(size_t& pos, unsigned int info, uint64_t* count) const
+    {
+        if (info != 0xf)
+        {
+            *count = info;
+            return true;
+        }
+        if (pos >= _offsetTable || (_bytes[pos] >> 4) != 0x1)
+        {
+            return false;
+        }
+        size_t size = size_t(1) << (_bytes[pos] & 0xf);
+        ++pos;
+        if (size > 8 || pos + size > _offsetTable)
+        {
+            return false;
+        }
+        *count = readBigEndian(_bytes + pos, size);
+        pos += size;
+        return true;
+    }
+
+    bool fits(size_t pos, uint64_t count, size_t size) const
+    {
+        return count <= (_offsetTable - pos) / size;
+    }
+
+    bool readString(uint64_t object, const char** text, unsigned int* length)
+    {
+        size_t pos;
+        if (!getObjectOffset(object, &pos))
+        {
+            return false;
+        }
+        unsigned int type = _bytes[pos] >> 4;
+        unsigned int info = _bytes[pos] & 0xf;
+        ++pos;
+
+        uint64_t count;
+        if ((type != 0x5 && type != 0x6) || !readCount(pos, info, &count))
+        {
+            return false;
+        }
+
+        if (type == 0x5)
+        {
+            if (!fits(pos, count, 1))
+            {
+                return false;
+            }
+            *text = reinterpret_cast<const char*>(_bytes + pos);
+            *length = static_cast<unsigned int>(count);
+            return true;
+        }
+
+        if (!fits(pos, count, 2))
+        {
+            return false;
+        }
+        std::u16string utf16(static_cast<size_t>(count), 0);
+        for (size_t i = 0; i < count; ++i)
+        {
+            utf16[i] = static_cast<char16_t>(readBigEndian(_bytes + pos + i * 2, 2));
+        }
+        std::string utf8;
+        StringUtils::UTF16ToUTF8(utf16, utf8);
+        setJoinedText(std::move(utf8), text, length);
+        return true;
+    }
+
+    void setJoinedText(std::string&& value, const char** text, unsigned int* length)
+    {
+        _doc->_joinedTexts.push_back(std::move(value));
+        *text = _doc->_joinedTexts.back().c_str();
+        *length = static_cast<unsigned int>(_doc->_joinedTexts.back().length());
+    }
+
+    bool readObject(uint64_t object, unsigned int parent, const char* key, unsigned int keyLength, int depth)
+    {
+        size_t pos;
+        if (depth > BINARY_MAX_DEPTH || !getObjectOffset(object, &pos))
+        {
+            return false;
+        }
+        unsigned char marker = _bytes[pos];
+        unsigned int type = marker >> 4;
+        unsigned int info = marker & 0xf;
+
+        const char* text = nullptr;
+        unsigned int length = 0;
+        switch (type)
+        {
+            case 0x0:
+                // null and fill are ignored
+                if (marker == 0x08 || marker == 0x09)
+                {
+                    text = marker == 0x09 ? "true" : "false";
+                    length = marker == 0x09 ? 4 : 5;
+                    addValue(Type::BOOLEAN, parent, key, keyLength, text, length);
+                }
+                return true;
+            case 0x1:
+            {
+                // the 16 bytes integers keep their low 8 bytes, the shorter ones are unsigned
+                size_t size = size_t(1) << info;
+                ++pos;
+                if (size > 16 || pos + size > _offsetTable)
+                {
+                    return false;
+                }
+                uint64_t value = size == 16 ? readBigEndian(_bytes + pos + 8, 8) : readBigEndian(_bytes + pos, size);
+                char buffer[32];
+                if (size >= 8)
+                    snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(value));
+                else
+                    snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(value));
+                setJoinedText(buffer, &text, &length);
+                addValue(Type::INTEGER, parent, key, keyLength, text, length);
+                return true;
+            }
+            case 0x2:
+            {
+                size_t size = size_t(1) << info;
+                ++pos;
+                if ((size != 4 && size != 8) || pos + size > _offsetTable)
+                {
+                    return false;
+                }
+                double value;
+                if (size == 4)
+                {
+                    uint32_t bits = static_cast<uint32_t>(readBigEndian(_bytes + pos, 4));
+                    float single;
+                    memcpy(&single, &bits, sizeof(single));
+                    value = single;
+                }
+                else
+                {
+                    uint64_t bits = readBigEndian(_bytes + pos, 8);
+                    memcpy(&value, &bits, sizeof(value));
+                }
+                char buffer[32];
+                snprintf(buffer, sizeof(buffer), "%.17g", value);
+                setJoinedText(buffer, &text, &length);
+                addValue(Type::REAL, parent, key, keyLength, text, length);
+                return true;
+            }
+            case 0x5:
+            case 0x6:
+                if (!readString(object, &text, &length))
+                {
+                    return false;
+                }
+                addValue(Type::STRING, parent, key, keyLength, text, length);
+                return true;
+            case 0xA:
+            case 0xD:
+            {
+                ++pos;
+                uint64_t count;
+                size_t refCount = type == 0xD ? 2 : 1;
+                if (!readCount(pos, info, &count) || !fits(pos, count, _refSize * refCount))
+                {
+                    return false;
+                }
+
+                unsigned int index = addNode(type == 0xD ? Type::DICT : Type::ARRAY, parent, key, keyLength);
+                if (index == 0)
+                {
+                    return false;
+                }
+                // the keys of a dictionary come first, then its values
+                const unsigned char* refs = _bytes + pos;
+                const unsigned char* valueRefs = refs + (type == 0xD ? count * _refSize : 0);
+                for (uint64_t i = 0; i < count; ++i)
+                {
+                    const char* childKey = nullptr;
+                    unsigned int childKeyLength = 0;
+                    if (type == 0xD && !readString(readBigEndian(refs + i * _refSize, _refSize), &childKey, &childKeyLength))
+                    {
+                        return false;
+                    }
+                    if (!readObject(readBigEndian(valueRefs + i * _refSize, _refSize), index, childKey, childKeyLength, depth + 1))
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+            default:
+                // data, dates, UIDs and sets are ignored, like <data> and <date>
+                return true;
+        }
+    }
+
+    void addValue(Type type, unsigned int parent, const char* key, unsigned int keyLength, const char* text, unsigned int length)
+    {
+        // the values outside of a container are ignored, like in the XML plists
+        if (parent == 0)
+        {
+            return;
+        }
+        unsigned int index = addNode(type, parent, key, keyLength);
+        _doc->_nodes[index].text = text;
+        _doc->_nodes[index].textLength = length;
+    }
+
+    unsigned int addNode(Type type, unsigned int parent, const char* key, unsigned int keyLength)
+    {
+        auto& nodes = _doc->_nodes;
+        unsigned int index = static_cast<unsigned int>(nodes.size());
+        if (parent == 0 && index != 1)
+        {
+            return 0;
+        }
+
+        NodeData node;
+        node.type = type;
+        node.key = key ? key : "";
+        node.keyLength = key ? keyLength : 0;
+        node.text = "";
+        node.textLength = 0;
+        node.firstChild = 0;
+        node.lastChild = 0;
+        node.nextSibling = 0;
+        node.childCount = 0;
+
+        if (parent)
+        {
+            NodeData& parentNode = nodes[parent];
+            if (parentNode.lastChild)
+            {
+                nodes[parentNode.lastChild].nextSibling = index;
+            }
+            else
+            {
+                parentNode.firstChild = index;
+            }
+            parentNode.lastChild = index;
+            ++parentNode.childCount;
+        }
+
+        nodes.push_back(node);
+        return index;
+    }
+
+    PlistDocument* _doc;
+    const unsigned char* _bytes;
+    size_t _size;
+    size_t _offsetSize;
+    size_t _refSize;
+    uint64_t _objectCount;
+    uint64_t _offsetTable;
+};
+
+// Flattens the values into the objects of a binary plist, the strings are written once
+class BinaryPlistWriter
+{
+public:
+    Data write(const Value& root)
+    {
+        if (root.getType() == Value::Type::MAP)
+            addDict(root.asValueMap());
+        else
+            addArray(root.asValueVector());
+
+        uint64_t count = _objects.size();
+        _refSize = count < 0x100 ? 1 : (count < 0x10000 ? 2 : 4);
+
+        _out.assign(BINARY_MAGIC, BINARY_MAGIC + sizeof(BINARY_MAGIC));
+        std::vector<uint64_t> offsets;
+        offsets.reserve(_objects.size());
+        for (const auto& object : _objects)
+        {
+            offsets.push_back(_out.size());
+            writeObject(object);
+        }
+
+        uint64_t offsetTable = _out.size();
+        size_t offsetSize = offsetTable < 0x100 ? 1 : (offsetTable < 0x10000 ? 2 : (offsetTable < 0x100000000ULL ? 4 : 8));
+        for (uint64_t offset : offsets)
+        {
+            writeBigEndian(_out, offset, offsetSize);
+        }
+
+        _out.insert(_out.end(), 6, 0);
+        _out.push_back(static_cast<unsigned char>(offsetSize));
+        _out.push_back(static_cast<unsigned char>(_refSize));
+        writeBigEndian(_out, count, 8);
+        writeBigEndian(_out, 0, 8);
+        writeBigEndian(_out, offsetTable, 8);
+
+        Data data;
+        data.copy(_out.data(), _out.size());
+        return data;
+    }
+
+private:
+    enum class Kind
+    {
+        DICT,
+        ARRAY,
+        STRING,
+        INTEGER,
+        REAL,
+        BOOLEAN,
+    };
+
+    struct Object
+    {
+        Kind kind;
+        int64_t integer;
+        double real;
+        std::string string;
+        std::vector<uint32_t> refs;
+    };
+
+    static bool isWritable(const Value& value)
+    {
+        return value.getType() != Value::Type::NONE && value.getType() != Value::Type::INT_KEY_MAP;
+    }
+
+    uint32_t addObject(Kind kind)
+    {
+        Object object;
+        object.kind = kind;
+        object.integer = 0;
+        object.real = 0;
+        _objects.push_back(std::move(object));
+        return static_cast<uint32_t>(_objects.size() - 1);
+    }
+
+    uint32_t addDict(const ValueMap& dict)
+    {
+        uint32_t index = addObject(Kind::DICT);
+        std::vector<uint32_t> keys, values;
+        keys.reserve(dict.size() * 2);
+        values.reserve(dict.size());
+        for (const auto& entry : dict)
+        {
+            if (isWritable(entry.second))
+            {
+                keys.push_back(addString(entry.first));
+                values.push_back(addValue(entry.second));
+            }
+        }
+        keys.insert(keys.end(), values.begin(), values.end());
+        _objects[index].refs = std::move(keys);
+        return index;
+    }
+
+    uint32_t addArray(const ValueVector& array)
+    {
+        uint32_t index = addObject(Kind::ARRAY);
+        std::vector<uint32_t> values;
+        values.reserve(array.size());
+        for (const auto& value : array)
+        {
+            if (isWritable(value))
+            {
+                values.push_back(addValue(value));
+            }
+        }
+        _objects[index].refs = std::move(values);
+        return index;
+    }
+
+    uint32_t addString(const std::string& string)
+    {
+        auto iter = _strings.find(string);
+        if (iter != _strings.end())
+        {
+            return iter->second;
+        }
+        uint32_t index = addObject(Kind::STRING);
+        _objects[index].string = string;
+        _strings.emplace(string, index);
+        return index;
+    }
+
+    uint32_t addValue(const Value& value)
+    {
+        uint32_t index;
+        switch (value.getType())
+        {
+            case Value::Type::MAP:
+                return addDict(value.asValueMap());
+            case Value::Type::VECTOR:
+                return addArray(value.asValueVector());
+            case Value::Type::STRING:
+                return addString(value.asString());
+            case Value::Type::BYTE:
+            case Value::Type::INTEGER:
+                index = addObject(Kind::INTEGER);
+                _objects[index].integer = value.asInt();
+                return index;
+            case Value::Type::FLOAT:
+            case Value::Type::DOUBLE:
+                index = addObject(Kind::REAL);
+                _objects[index].real = value.asDouble();
+                return index;
+            default:
+                index = addObject(Kind::BOOLEAN);
+                _objects[index].integer = value.asBool() ? 1 : 0;
+                return index;
+        }
+    }
+
+    void writeInteger(int64_t value)
+    {
+        // the negative values take 8 bytes, the shorter integers are unsigned
+        if (value >= 0 && value < 0x100)
+        {
+            _out.push_back(0x10);
+            writeBigEndian(_out, value, 1);
+        }
+        else if (value >= 0 && value < 0x10000)
+        {
+            _out.push_back(0x11);
+            writeBigEndian(_out, value, 2);
+        }
+        else if (value >= 0 && value < 0x100000000LL)
+        {
+            _out.push_back(0x12);
+            writeBigEndian(_out, value, 4);
+        }
+        else
+        {
+            _out.push_back(0x13);
+            writeBigEndian(_out, static_cast<uint64_t>(value), 8);
+        }
+    }
+
+    void writeMarker(unsigned char type, size_t count)
+    {
+        if (count < 0xf)
+        {
+            _out.push_back(static_cast<unsigned char>((type << 4) | count));
+        }
+        else
+        {
+            _out.push_back(static_cast<unsigned char>((type << 4) | 0xf));
+            writeInteger(count);
+        }
+    }
+
+    void writeObject(const Object& object)
+    {
+        switch (object.kind)
+        {
+            case Kind::DICT:
+            case Kind::ARRAY:
+            {
+                bool dict = object.kind == Kind::DICT;
+                writeMarker(dict ? 0xD : 0xA, dict ? object.refs.size() / 2 : object.refs.size());
+                for (uint32_t ref : object.refs)
+                {
+                    writeBigEndian(_out, ref, _refSize);
+                }
+                break;
+            }
+            case Kind::STRING:
+            {
+                bool ascii = true;
+                for (unsigned char c : object.string)
+                {
+                    ascii = ascii && c < 0x80;
+                }
+                std::u16string utf16;
+                if (ascii || !StringUtils::UTF8ToUTF16(object.string, utf16))
+                {
+                    writeMarker(0x5, object.string.size());
+                    _out.insert(_out.end(), object.string.begin(), object.string.end());
+                }
+                else
+                {
+                    writeMarker(0x6, utf16.size());
+                    for (char16_t c : utf16)
+                    {
+                        writeBigEndian(_out, c, 2);
+                    }
+                }
+                break;
+            }
+            case Kind::INTEGER:
+                writeInteger(object.integer);
+                break;
+            case Kind::REAL:
+            {
+                uint64_t bits;
+                memcpy(&bits, &object.real, sizeof(bits));
+                _out.push_back(0x23);
+                writeBigEndian(_out, bits, 8);
+                break;
+            }
+            case Kind::BOOLEAN:
+                _out.push_back(object.integer ? 0x09 : 0x08);
+                break;
+        }
+    }
+
+    std::vector<Object> _objects;
+    std::unordered_map<std::string, uint32_t> _strings;
+    size_t _refSize;
+    std::vector<unsigned char> _out;
+};
+
+/*
+ * Generate tinyxml2::XMLElement for Object through a tinyxml2::XMLDocument
+ */
+static tinyxml2::XMLElement* generateElementForArray(const ValueVector& array, tinyxml2::XMLDocument *doc);
+static tinyxml2::XMLElement* generateElementForDict(const ValueMap& dict, tinyxml2::XMLDocument *doc);
+
+static tinyxml2::XMLElement* generateElementForObject(const Value& value, tinyxml2::XMLDocument *doc)
+{
+    // object is String
+    if (value.getType() == Value::Type::STRING)
+    {
+        tinyxml2::XMLElement* node = doc->NewElement("string");
+        tinyxml2::XMLText* content = doc->NewText(value.asString().c_str());
+        node->LinkEndChild(content);
+        return node;
+    }
+
+    // object is integer
+    if (value.getType() == Value::Type::INTEGER)
+    {
+        tinyxml2::XMLElement* node = doc->NewElement("integer");
+        tinyxml2::XMLText* content = doc->NewText(value.asString().c_str());
+        node->LinkEndChild(content);
+        return node;
+    }
+
+    // object is real
+    if (value.getType() == Value::Type::FLOAT || value.getType() == Value::Type::DOUBLE)
+    {
+        tinyxml2::XMLElement* node = doc->NewElement("real");
+        tinyxml2::XMLText* content = doc->NewText(value.asString().c_str());
+        node->LinkEndChild(content);
+        return node;
+    }
+
+    //object is bool
+    if (value.getType() == Value::Type::BOOLEAN) {
+        tinyxml2::XMLElement* node = doc->NewElement(value.asString().c_str());
+        return node;
+    }
+
+    // object is Array
+    if (value.getType() == Value::Type::VECTOR)
+        return generateElementForArray(value.asValueVector(), doc);
+
+    // object is Dictionary
+    if (value.getType() == Value::Type::MAP)
+        return generateElementForDict(value.asValueMap(), doc);
+
+    CCLOG("This type cannot appear in property list");
+    return nullptr;
+}
+
+/*
+ * Generate tinyxml2::XMLElement for Dictionary through a tinyxml2::XMLDocument
+ */
+static tinyxml2::XMLElement* generateElementForDict(const ValueMap& dict, tinyxml2::XMLDocument *doc)
+{
+    tinyxml2::XMLElement* rootNode = doc->NewElement("dict");
+
+    for (const auto &iter : dict)
+    {
+        tinyxml2::XMLElement* tmpNode = doc->NewElement("key");
+        rootNode->LinkEndChild(tmpNode);
+        tinyxml2::XMLText* content = doc->NewText(iter.first.c_str());
+        tmpNode->LinkEndChild(content);
+
+        tinyxml2::XMLElement *element = generateElementForObject(iter.second, doc);
+        if (element)
+            rootNode->LinkEndChild(element);
+    }
+    return rootNode;
+}
+
+/*
+ * Generate tinyxml2::XMLElement for Array through a tinyxml2::XMLDocument
+ */
+static tinyxml2::XMLElement* generateElementForArray(const ValueVector& array, tinyxml2::XMLDocument *pDoc)
+{
+    tinyxml2::XMLElement* rootNode = pDoc->NewElement("array");
+
+    for(const auto &value : array) {
+        tinyxml2::XMLElement *element = generateElementForObject(value, pDoc);
+        if (element)
+            rootNode->LinkEndChild(element);
+    }
+    return rootNode;
+}
+
+static Data serializeXML(const Value& root)
+{
+    Data ret;
+    tinyxml2::XMLDocument *doc = new (std::nothrow)tinyxml2::XMLDocument();
+    if (nullptr == doc)
+        return ret;
+
+    tinyxml2::XMLDeclaration *declaration = doc->NewDeclaration("xml version=\"1.0\" encoding=\"UTF-8\"");
+    if (nullptr == declaration)
+    {
+        delete doc;
+        return ret;
+    }
+
+    doc->LinkEndChild(declaration);
+    tinyxml2::XMLElement *docType = doc->NewElement("!DOCTYPE plist PUBLIC \"-//Apple//DTD PLIST 1.0//EN\" \"http://www.apple.com/DTDs/PropertyList-1.0.dtd\"");
+    doc->LinkEndChild(docType);
+
+    tinyxml2::XMLElement *rootEle = doc->NewElement("plist");
+    if (nullptr == rootEle)
+    {
+        delete doc;
+        return ret;
+    }
+    rootEle->SetAttribute("version", "1.0");
+    doc->LinkEndChild(rootEle);
+
+    tinyxml2::XMLElement *innerElement = root.getType() == Value::Type::MAP
+        ? generateElementForDict(root.asValueMap(), doc)
+        : generateElementForArray(root.asValueVector(), doc);
+    if (nullptr == innerElement)
+    {
+        delete doc;
+        return ret;
+    }
+    rootEle->LinkEndChild(innerElement);
+
+    // printed in memory, the callers write the file
+    tinyxml2::XMLPrinter printer;
+    doc->Print(&printer);
+    ret.copy(reinterpret_cast<const unsigned char*>(printer.CStr()), printer.CStrSize() - 1);
+
+    delete doc;
+    return ret;
+}
+
+Data PlistDocument::serialize(const ValueMap& dict, Format format)
+{
+    Value root(dict);
+    return format == Format::BINARY ? BinaryPlistWriter().write(root) : serializeXML(root);
+}
+
+Data PlistDocument::serialize(const ValueVector& array, Format format)
+{
+    Value root(array);
+    return format == Format::BINARY ? BinaryPlistWriter().write(root) : serializeXML(root);
+}
+
+PlistDocument::PlistDocument()
+{
+}
+
+PlistDocument::~PlistDocument()
+{
+}
+
+bool PlistDocument::initWithFile(const std::string& filename)
+{
+    _data = FileUtils::getInstance()->getDataFromFile(filename);
+    return parse();
+}
+
+bool PlistDocument::initWithData(const char* data, ssize_t size)
+{
+    _data.copy(reinterpret_cast<const unsigned char*>(data), size);
+    return parse();
+}
+
+bool PlistDocument::initWithData(Data&& data)
+{
+    _data = std::move(data);
+    return parse();
+}
+
+bool PlistDocument::parse()
+{
+    _nodes.clear();
+    _joinedTexts.clear();
+    _dictIndexes.clear();
+
+    NodeData null;
+    memset(&null, 0, sizeof(null));
+    null.type = Type::NONE;
+    null.key = "";
+    null.text = "";
+    _nodes.push_back(null);
+
+    if (_data.isNull())
+    {
+        return false;
+    }
+
+    if (_data.getSize() >= (ssize_t)sizeof(BINARY_MAGIC) && memcmp(_data.getBytes(), BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0)
+    {
+        BinaryReader reader(this);
+        if (!reader.read())
+        {
+            CCLOG("cocos2d: PlistDocument: the binary plist is not valid");
+            _nodes.resize(1);
+            _joinedTexts.clear();
+            return false;
+        }
+        return true;
+    }
+
+    Builder builder(this);
+    SAXParser parser;
+    parser.setDelegator(&builder);
+    if (!parser.parseInSitu(reinterpret_cast<char*>(_data.getBytes()), _data.getSize()) || !builder.isValid())
+    {
+        CCLOG("cocos2d: PlistDocument: the plist is not valid");
+        _nodes.resize(1);
+        return false;
+    }
+
+    return true;
+}
+
+PlistDocument::Node PlistDocument::getRoot() const
+{
+    return Node(this, _nodes.size() > 1 ? 1 : 0);
+}
+
+unsigned int PlistDocument::findKey(unsigned int dict, const std::string& key) const
+{
+    const NodeData& node = _nodes[dict];
+    if (node.childCount < INDEXED_DICT_SIZE)
+    {
+        // the last one wins, like in the ValueMap
+        unsigned int found = 0;
+        for (unsigned int child = node.firstChild; child; child = _nodes[child].nextSibling)
+        {
+            const NodeData& childNode = _nodes[child];
+            if (childNode.keyLength == key.length() && memcmp(childNode.key, key.data(), key.length()) == 0)
+            {
+                found = child;
+            }
+        }
+        return found;
+    }
+
+    auto iter = _dictIndexes.find(dict);
+    if (iter == _dictIndexes.end())
+    {
+        std::unordered_map<std::string, unsigned int> index;
+        index.reserve(node.childCount);
+        for (unsigned int child = node.firstChild; child; child = _nodes[child].nextSibling)
+        {
+            index[std::string(_nodes[child].key, _nodes[child].keyLength)] = child;
+        }
+        iter = _dictIndexes.insert(std::make_pair(dict, std::move(index))).first;
+    }
+
+    auto found = iter->second.find(key);
+    return found != iter->second.end() ? found->second : 0;
+}
+
+PlistDocument::Type PlistDocument::Node::getType() const
+{
+    return _doc ? _doc->getNode(_index).type : Type::NONE;
+}
+
+ssize_t PlistDocument::Node::size() const
+{
+    return _doc ? _doc->getNode(_index).childCount : 0;
+}
+
+PlistDocument::Node PlistDocument::Node::operator[](const std::string& key) const
+{
+    if (getType() != Type::DICT)
+    {
+        return Node();
+    }
+    return Node(_doc, _doc->findKey(_index, key));
+}
+
+PlistDocument::Node PlistDocument::Node::at(ssize_t index) const
+{
+    if (index < 0 || index >= size())
+    {
+        return Node();
+    }
+
+    unsigned int child = _doc->getNode(_index).firstChild;
+    for (; index > 0; --index)
+    {
+        child = _doc->getNode(child).nextSibling;
+    }
+    return Node(_doc, child);
+}
+
+PlistDocument::Node PlistDocument::Node::getFirstChild() const
+{
+    return _doc ? Node(_doc, _doc->getNode(_index).firstChild) : Node();
+}
+
+PlistDocument::Node PlistDocument::Node::getNextSibling() const
+{
+    return _doc ? Node(_doc, _doc->getNode(_index).nextSibling) : Node();
+}
+
+std::string PlistDocument::Node::getKey() const
+{
+    if (!_doc)
+    {
+        return "";
+    }
+    const NodeData& node = _doc->getNode(_index);
+    return std::string(node.key, node.keyLength);
+}
+
+std::string PlistDocument::Node::asString() const
+{
+    if (!_doc)
+    {
+        return "";
+    }
+    const NodeData& node = _doc->getNode(_index);
+    return std::string(node.text, node.textLength);
+}
+
+int PlistDocument::Node::asInt() const
+{
+    switch (getType())
+    {
+        case Type::INTEGER:
+        case Type::STRING:
+            return atoi(asString().c_str());
+        case Type::REAL:
+            return static_cast<int>(asDouble());
+        case Type::BOOLEAN:
+            return asBool() ? 1 : 0;
+        default:
+            return 0;
+    }
+}
+
+double PlistDocument::Node::asDouble() const
+{
+    switch (getType())
+    {
+        case Type::INTEGER:
+        case Type::REAL:
+        case Type::STRING:
+            return utils::atof(asString().c_str());
+        case Type::BOOLEAN:
+            return asBool() ? 1.0 : 0.0;
+        default:
+            return 0.0;
+    }
+}
+
+bool PlistDocument::Node::asBool() const
+{
+    switch (getType())
+    {
+        case Type::BOOLEAN:
+            return _doc->getNode(_index).textLength == 4;
+        case Type::STRING:
+        {
+            // like Value::asBool()
+            std::string str = asString();
+            return !(str == "0" || str == "false");
+        }
+        case Type::INTEGER:
+        case Type::REAL:
+            return asDouble() != 0.0;
+        default:
+            return false;
+    }
+}
+
+Value PlistDocument::Node::toValue() const
+{
+    switch (getType())
+    {
+        case Type::DICT:
+            return Value(toValueMap());
+        case Type::ARRAY:
+            return Value(toValueVector());
+        case Type::STRING:
+        {
+            const NodeData& node = _doc->getNode(_index);
+            return Value(node.text, node.textLength);
+        }
+        case Type::INTEGER:
+            return Value(asInt());
+        case Type::REAL:
+            return Value(asDouble());
+        case Type::BOOLEAN:
+            return Value(asBool());
+        default:
+            return Value::Null;
+    }
+}
+
+ValueMap PlistDocument::Node::toValueMap() const
+{
+    ValueMap ret;
+    if (getType() != Type::DICT)
+    {
+        return ret;
+    }
+
+    ret.reserve(size());
+    for (Node child = getFirstChild(); child._index; child = child.getNextSibling())
+    {
+        if (!child.isNull())
+        {
+            ret[child.getKey()] = child.toValue();
+        }
+    }
+    return ret;
+}
+
+ValueVector PlistDocument::Node::toValueVector() const
+{
+    ValueVector ret;
+    if (getType() != Type::ARRAY)
+    {
+        return ret;
+    }
+
+    ret.reserve(size());
+    for (Node child = getFirstChild(); child._index; child = child.getNextSibling())
+    {
+        if (!child.isNull())
+        {
+            ret.push_back(child.toValue());
+        }
+    }
+    return ret;
+}
+
+NS_CC_END
@@ -0,0 +1,183 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CC_PLIST_DOCUMENT_H__
+#define __CC_PLIST_DOCUMENT_H__
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "platform/CCPlatformMacros.h"
+#include "base/CCData.h"
+#include "base/CCValue.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup platform
+ * @{
+ */
+
+/**
+ A parsed XML plist that keeps the file and a flat array of nodes, and only makes a Value of what is read.
+
+ The strings point into the file, which is parsed in place, so reading a few keys of a big plist doesn't build
+ the ValueMap of the whole file. toValueMap() and toValueVector() make the same values as FileUtils::getValueMapFromFile().
+ Binary plists ("bplist00", the format of serialize() with Format::BINARY) are read too.
+
+ @code
+ PlistDocument doc;
+ if (doc.initWithFile("config.plist"))
+ {
+     int width = doc.getRoot()["window"]["width"].asInt();
+ }
+ @endcode
+ @since v3.11
+ @js NA
+ @lua NA
+ */
+class CC_DLL PlistDocument
+{
+public:
+    enum class Type
+    {
+        /** A missing node, or an element the ValueMap ignores too: <date> and <data>. */
+        NONE,
+        DICT,
+        ARRAY,
+        STRING,
+        INTEGER,
+        REAL,
+        BOOLEAN,
+    };
+
+    /** A node of the document, it is valid as long as the document. */
+    class CC_DLL Node
+    {
+    public:
+        Node() : _doc(nullptr), _index(0) {}
+
+        Type getType() const;
+        bool isNull() const { return getType() == Type::NONE; }
+
+        /** The number of children of a dictionary or an array. */
+        ssize_t size() const;
+
+        /** The value of `key` in a dictionary, a null node if there is none. */
+        Node operator[](const std::string& key) const;
+        /** The children of a dictionary or an array in the order of the file. */
+        Node at(ssize_t index) const;
+        /** The first child, then the next sibling, for the loops over the children. */
+        Node getFirstChild() const;
+        Node getNextSibling() const;
+        /** The key of a child of a dictionary. */
+        std::string getKey() const;
+
+        std::string asString() const;
+        int asInt() const;
+        double asDouble() const;
+        float asFloat() const { return static_cast<float>(asDouble()); }
+        bool asBool() const;
+
+        Value toValue() const;
+        ValueMap toValueMap() const;
+        ValueVector toValueVector() const;
+
+    private:
+        friend class PlistDocument;
+        Node(const PlistDocument* doc, unsigned int index) : _doc(doc), _index(index) {}
+
+        const PlistDocument* _doc;
+        unsigned int _index;
+    };
+
+    /** The formats serialize() writes. */
+    enum class Format
+    {
+        XML,
+        /** The binary plists of Apple, smaller and faster to read and write. */
+        BINARY,
+    };
+
+    PlistDocument();
+    ~PlistDocument();
+
+    /** Returns the contents of a plist file of a dictionary, or null data if it can't be written. */
+    static Data serialize(const ValueMap& dict, Format format = Format::XML);
+    /** Returns the contents of a plist file of an array, or null data if it can't be written. */
+    static Data serialize(const ValueVector& array, Format format = Format::XML);
+
+    /** Parses the plist `filename`, returns false if it can't be read or isn't valid XML. */
+    bool initWithFile(const std::string& filename);
+    /** Parses a copy of the plist in `data`. */
+    bool initWithData(const char* data, ssize_t size);
+    /** Parses the plist in `data` in place, the document takes it. */
+    bool initWithData(Data&& data);
+
+    /** The top level dictionary or array. */
+    Node getRoot() const;
+
+protected:
+    struct NodeData
+    {
+        Type type;
+        const char* key;
+        unsigned int keyLength;
+        const char* text;
+        unsigned int textLength;
+        unsigned int firstChild;
+        unsigned int lastChild;
+        unsigned int nextSibling;
+        unsigned int childCount;
+    };
+
+    class Builder;
+    class BinaryReader;
+
+    bool parse();
+    const NodeData& getNode(unsigned int index) const { return _nodes[index]; }
+    unsigned int findKey(unsigned int dict, const std::string& key) const;
+
+    Data _data;
+    // node 0 is the null node, the indexes of the children are never 0
+    std::vector<NodeData> _nodes;
+    // the texts split in several pieces by CDATA sections, joined
+    std::deque<std::string> _joinedTexts;
+    // the key indexes of the big dictionaries, made when they are first looked up
+    mutable std::unordered_map<unsigned int, std::unordered_map<std::string, unsigned int>> _dictIndexes;
+
+private:
+    PlistDocument(const PlistDocument&) = delete;
+    PlistDocument& operator=(const PlistDocument&) = delete;
+};
+
+// end of platform group
+/** @} */
+
+NS_CC_END
+
+#endif // __CC_PLIST_DOCUMENT_H__
@@ -24,68 +24,363 @@
 
 #include "platform/CCSAXParser.h"
 
+#include <string.h>
 #include <vector> // because its based on windows 8 build :P
 
 #include "platform/CCFileUtils.h"
-#include "tinyxml2/tinyxml2.h"
 
 
 NS_CC_BEGIN
 
-class XmlSaxHander : public tinyxml2::XMLVisitor
+/*
+ A non-validating parser working in place, like rapidxml: the names, attribute values and texts are
+ decoded and terminated in the buffer itself and given to the delegator without copies.
+ It reports what tinyxml2 reports: the elements, their attributes, the CDATA sections and the texts which are
+ not only white spaces, with the entities replaced and the line breaks converted to '\n'.
+ The declarations, comments, processing instructions and DTDs are skipped.
+ */
+class InSituParser
 {
 public:
-    XmlSaxHander():_ccsaxParserImp(0){};
+    InSituParser(SAXParser* parser, char* data, size_t length)
+    : _parser(parser)
+    , _p(data)
+    , _end(data + length)
+    {}
 
-    virtual bool VisitEnter( const tinyxml2::XMLElement& element, const tinyxml2::XMLAttribute* firstAttribute );
-    virtual bool VisitExit( const tinyxml2::XMLElement& element );
-    virtual bool Visit( const tinyxml2::XMLText& text );
-    virtual bool Visit( const tinyxml2::XMLUnknown&){ return true; }
-
-    void setSAXParserImp(SAXParser* parser)
+    bool parse()
     {
-        _ccsaxParserImp = parser;
+        // UTF-8 BOM
+        if (_end - _p >= 3 && (unsigned char)_p[0] == 0xef && (unsigned char)_p[1] == 0xbb && (unsigned char)_p[2] == 0xbf)
+        {
+            _p += 3;
+        }
+
+        while (_p < _end)
+        {
+            if (*_p != '<')
+            {
+                if (!parseText())
+                    return false;
+                continue;
+            }
+
+            if (_p + 1 >= _end)
+                return false;
+
+            bool ok;
+            switch (_p[1])
+            {
+                case '?':
+                    ok = skipPast("?>");
+                    break;
+                case '!':
+                    ok = parseBang();
+                    break;
+                case '/':
+                    ok = parseEndTag();
+                    break;
+                default:
+                    ok = parseStartTag();
+                    break;
+            }
+            if (!ok)
+                return false;
+        }
+
+        // every element has to be closed
+        return _openElements.empty();
     }
 
 private:
-    SAXParser *_ccsaxParserImp;
-};
+    static bool isSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
 
+    static bool isNameEnd(char c)
+    {
+        return isSpace(c) || c == '/' || c == '>' || c == '=';
+    }
 
-bool XmlSaxHander::VisitEnter( const tinyxml2::XMLElement& element, const tinyxml2::XMLAttribute* firstAttribute )
-{
-    //log(" VisitEnter %s",element.Value());
+    void skipSpaces()
+    {
+        while (_p < _end && isSpace(*_p))
+            ++_p;
+    }
 
-    std::vector<const char*> attsVector;
-    for( const tinyxml2::XMLAttribute* attrib = firstAttribute; attrib; attrib = attrib->Next() )
+    bool skipPast(const char* terminator)
     {
-        //log("%s", attrib->Name());
-        attsVector.push_back(attrib->Name());
-        //log("%s",attrib->Value());
-        attsVector.push_back(attrib->Value());
+        const size_t length = strlen(terminator);
+        for (; _end - _p >= (ptrdiff_t)length; ++_p)
+        {
+            if (memcmp(_p, terminator, length) == 0)
+            {
+                _p += length;
+                return true;
+            }
+        }
+        return false;
     }
 
-    // nullptr is used in c++11
-    //attsVector.push_back(nullptr);
-    attsVector.push_back(nullptr);
+    // <!-- -->, <![CDATA[ ]]> or <!DOCTYPE >
+    bool parseBang()
+    {
+        if (_end - _p >= 4 && memcmp(_p, "<!--", 4) == 0)
+        {
+            _p += 4;
+            return skipPast("-->");
+        }
 
-    SAXParser::startElement(_ccsaxParserImp, (const CC_XML_CHAR *)element.Value(), (const CC_XML_CHAR **)(&attsVector[0]));
-    return true;
-}
-bool XmlSaxHander::VisitExit( const tinyxml2::XMLElement& element )
-{
-    //log("VisitExit %s",element.Value());
+        if (_end - _p >= 9 && memcmp(_p, "<![CDATA[", 9) == 0)
+        {
+            _p += 9;
+            char* text = _p;
+            if (!skipPast("]]>"))
+                return false;
+            char* textEnd = _p - 3;
+            *textEnd = '\0';
+            SAXParser::textHandler(_parser, (const CC_XML_CHAR*)text, static_cast<int>(textEnd - text));
+            return true;
+        }
 
-    SAXParser::endElement(_ccsaxParserImp, (const CC_XML_CHAR *)element.Value());
-    return true;
-}
+        // a DTD, it may have an internal subset in brackets
+        int brackets = 0;
+        for (_p += 2; _p < _end; ++_p)
+        {
+            if (*_p == '[')
+                ++brackets;
+            else if (*_p == ']')
+                --brackets;
+            else if (*_p == '>' && brackets <= 0)
+            {
+                ++_p;
+                return true;
+            }
+        }
+        return false;
+    }
 
-bool XmlSaxHander::Visit( const tinyxml2::XMLText& text )
-{
-    //log("Visit %s",text.Value());
-    SAXParser::textHandler(_ccsaxParserImp, (const CC_XML_CHAR *)text.Value(), static_cast<int>(strlen(text.Value())));
-    return true;
-}
+    bool parseStartTag()
+    {
+        char* name = ++_p;
+        while (_p < _end && !isNameEnd(*_p))
+            ++_p;
+        if (_p == name || _p >= _end)
+            return false;
+        char* nameEnd = _p;
+
+        _atts.clear();
+        bool empty = false;
+        while (true)
+        {
+            skipSpaces();
+            if (_p >= _end)
+                return false;
+
+            if (*_p == '>')
+            {
+                ++_p;
+                break;
+            }
+            if (*_p == '/')
+            {
+                if (_p + 1 >= _end || _p[1] != '>')
+                    return false;
+                _p += 2;
+                empty = true;
+                break;
+            }
+
+            // attribute="value"
+            char* attName = _p;
+            while (_p < _end && !isNameEnd(*_p))
+                ++_p;
+            if (_p == attName)
+                return false;
+            char* attNameEnd = _p;
+            skipSpaces();
+            if (_p >= _end || *_p != '=')
+                return false;
+            ++_p;
+            skipSpaces();
+            if (_p >= _end || (*_p != '"' && *_p != '\''))
+                return false;
+            const char quote = *_p++;
+            char* value = _p;
+            while (_p < _end && *_p != quote)
+                ++_p;
+            if (_p >= _end)
+                return false;
+            char* valueEnd = _p++;
+
+            // the delimiters were read, they can be overwritten
+            *attNameEnd = '\0';
+            *decode(value, valueEnd) = '\0';
+            _atts.push_back(attName);
+            _atts.push_back(value);
+        }
+        _atts.push_back(nullptr);
+
+        *nameEnd = '\0';
+        SAXParser::startElement(_parser, (const CC_XML_CHAR*)name, (const CC_XML_CHAR**)_atts.data());
+        if (empty)
+        {
+            SAXParser::endElement(_parser, (const CC_XML_CHAR*)name);
+        }
+        else
+        {
+            _openElements.push_back(name);
+        }
+        return true;
+    }
+
+    bool parseEndTag()
+    {
+        _p += 2;
+        char* name = _p;
+        while (_p < _end && !isNameEnd(*_p))
+            ++_p;
+        char* nameEnd = _p;
+        skipSpaces();
+        if (_p >= _end || *_p != '>' || _openElements.empty())
+            return false;
+        ++_p;
+
+        *nameEnd = '\0';
+        if (strcmp(name, _openElements.back()) != 0)
+            return false;
+        _openElements.pop_back();
+
+        SAXParser::endElement(_parser, (const CC_XML_CHAR*)name);
+        return true;
+    }
+
+    bool parseText()
+    {
+        char* text = _p;
+        bool blank = true;
+        while (_p < _end && *_p != '<')
+        {
+            if (!isSpace(*_p))
+                blank = false;
+            ++_p;
+        }
+
+        // the texts between the elements only, there is no room for a terminator after the last one anyway
+        if (blank || _p >= _end || _openElements.empty())
+            return true;
+
+        // the '<' stays in _p
+        char* textEnd = decode(text, _p);
+        const char next = *_p;
+        *textEnd = '\0';
+        SAXParser::textHandler(_parser, (const CC_XML_CHAR*)text, static_cast<int>(textEnd - text));
+        *_p = next;
+        return true;
+    }
+
+    // replaces the entities and line breaks of [begin, end) in place, returns the new end
+    static char* decode(char* begin, char* end)
+    {
+        char* out = begin;
+        for (char* in = begin; in < end; )
+        {
+            if (*in == '\r')
+            {
+                *out++ = '\n';
+                in += (in + 1 < end && in[1] == '\n') ? 2 : 1;
+            }
+            else if (*in == '&')
+            {
+                in = decodeEntity(in, end, out);
+            }
+            else
+            {
+                *out++ = *in++;
+            }
+        }
+        return out;
+    }
+
+    static char* decodeEntity(char* in, char* end, char*& out)
+    {
+        static const struct { const char* name; size_t length; char value; } entities[] = {
+            { "&lt;", 4, '<' }, { "&gt;", 4, '>' }, { "&amp;", 5, '&' }, { "&quot;", 6, '"' }, { "&apos;", 6, '\'' },
+        };
+        for (const auto& entity : entities)
+        {
+            if ((size_t)(end - in) >= entity.length && memcmp(in, entity.name, entity.length) == 0)
+            {
+                *out++ = entity.value;
+                return in + entity.length;
+            }
+        }
+
+        // &#123; or &#x7b;, the UTF-8 bytes are never longer than the reference
+        if (end - in >= 4 && in[1] == '#')
+        {
+            char* p = in + 2;
+            const bool hex = (*p == 'x' || *p == 'X');
+            if (hex)
+                ++p;
+            unsigned long code = 0;
+            char* digits = p;
+            for (; p < end && *p != ';'; ++p)
+            {
+                int digit;
+                if (*p >= '0' && *p <= '9')
+                    digit = *p - '0';
+                else if (hex && *p >= 'a' && *p <= 'f')
+                    digit = *p - 'a' + 10;
+                else if (hex && *p >= 'A' && *p <= 'F')
+                    digit = *p - 'A' + 10;
+                else
+                    break;
+                code = code * (hex ? 16 : 10) + digit;
+                if (code > 0x10ffff)
+                    break;
+            }
+            if (p < end && *p == ';' && p != digits && code != 0)
+            {
+                if (code < 0x80)
+                {
+                    *out++ = (char)code;
+                }
+                else if (code < 0x800)
+                {
+                    *out++ = (char)(0xc0 | (code >> 6));
+                    *out++ = (char)(0x80 | (code & 0x3f));
+                }
+                else if (code < 0x10000)
+                {
+                    *out++ = (char)(0xe0 | (code >> 12));
+                    *out++ = (char)(0x80 | ((code >> 6) & 0x3f));
+                    *out++ = (char)(0x80 | (code & 0x3f));
+                }
+                else
+                {
+                    *out++ = (char)(0xf0 | (code >> 18));
+                    *out++ = (char)(0x80 | ((code >> 12) & 0x3f));
+                    *out++ = (char)(0x80 | ((code >> 6) & 0x3f));
+                    *out++ = (char)(0x80 | (code & 0x3f));
+                }
+                return p + 1;
+            }
+        }
+
+        // an unknown entity is kept as it is
+        *out++ = *in;
+        return in + 1;
+    }
+
+    SAXParser* _parser;
+    char* _p;
+    char* _end;
+    // reused by all the elements, they are the only allocations
+    std::vector<const char*> _atts;
+    std::vector<const char*> _openElements;
+};
 
 SAXParser::SAXParser()
 {
@@ -105,24 +400,32 @@ bool SAXParser::init(const char *encoding)
 
 bool SAXParser::parse(const char* xmlData, size_t dataLength)
 {
-    tinyxml2::XMLDocument tinyDoc;
-    tinyDoc.Parse(xmlData, dataLength);
-    XmlSaxHander printer;
-    printer.setSAXParserImp(this);
-
-    return tinyDoc.Accept( &printer );
+    // the only copy, the parser works in it
+    std::vector<char> buffer(xmlData, xmlData + dataLength);
+    return parseInSitu(buffer.data(), buffer.size());
 }
 
-bool SAXParser::parse(const std::string& filename)
+bool SAXParser::parseInSitu(char* xmlData, size_t dataLength)
 {
-    bool ret = false;
-    Data data = FileUtils::getInstance()->getDataFromFile(filename);
-    if (!data.isNull())
+    if (xmlData == nullptr || dataLength == 0)
     {
-        ret = parse((const char*)data.getBytes(), data.getSize());
+        return false;
     }
 
-    return ret;
+    InSituParser parser(this, xmlData, dataLength);
+    return parser.parse();
+}
+
+bool SAXParser::parse(Data&& xmlData)
+{
+    Data data(std::move(xmlData));
+    return parseInSitu((char*)data.getBytes(), data.getSize());
+}
+
+bool SAXParser::parse(const std::string& filename)
+{
+    // a heap copy the parser can modify, instead of a mapping and a copy
+    return parse(FileUtils::getInstance()->getDataFromFile(filename));
 }
 
 void SAXParser::startElement(void *ctx, const CC_XML_CHAR *name, const CC_XML_CHAR **atts)
@@ -27,6 +27,7 @@
 
 #include "platform/CCPlatformConfig.h"
 #include "platform/CCCommon.h"
+#include "base/CCData.h"
 #include <string>
 
 NS_CC_BEGIN
@@ -84,6 +85,22 @@ public:
      * @lua NA
      */
     bool parse(const char* xmlData, size_t dataLength);
+    /**
+     * Parses `xmlData` without copying it. The buffer is modified: the names, attribute values and texts given to
+     * the delegator are decoded and terminated in place, and stay valid as long as the buffer.
+     * It doesn't need to be terminated.
+     * @since v3.11
+     * @js NA
+     * @lua NA
+     */
+    bool parseInSitu(char* xmlData, size_t dataLength);
+    /**
+     * Parses `xmlData` in place like parseInSitu() and frees it when done: the strings given to the delegator
+     * are only valid during the callbacks.
+     * @js NA
+     * @lua NA
+     */
+    bool parse(Data&& xmlData);
     /**
      * @js NA
      * @lua NA
@@ -28,6 +28,7 @@ THE SOFTWARE.
 
 #include "platform/CCDevice.h"
 #include <string.h>
+#include <algorithm>
 #include <android/log.h>
 #include <jni.h>
 #include "base/ccTypes.h"
@@ -178,6 +179,13 @@ void Device::vibrate(float duration)
     JniHelper::callStaticVoidMethod(helperClassName, "vibrate", duration);
 }
 
+Device::ThermalState Device::getThermalState()
+{
+    // Cocos2dxHelper maps the thermal status of Android to the states of iOS
+    int state = JniHelper::callStaticIntMethod(helperClassName, "getThermalState");
+    return (ThermalState)std::max(std::min(state, (int)ThermalState::CRITICAL), (int)ThermalState::NOMINAL);
+}
+
 NS_CC_END
 
 #endif // CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID
@@ -29,10 +29,20 @@ THE SOFTWARE.
 #include "CCFileUtils-android.h"
 #include "platform/CCCommon.h"
 #include "platform/android/jni/JniHelper.h"
+#include "platform/android/jni/Java_org_cocos2dx_lib_Cocos2dxHelper.h"
 #include "android/asset_manager.h"
 #include "android/asset_manager_jni.h"
 #include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <zlib.h>
 
 #define  LOG_TAG    "CCFileUtils-android.cpp"
 #define  LOGD(...)  __android_log_print(ANDROID_LOG_DEBUG,LOG_TAG,__VA_ARGS__)
@@ -43,6 +53,224 @@ NS_CC_BEGIN
 
 AAssetManager* FileUtilsAndroid::assetmanager = nullptr;
 
+namespace
+{
+    // stored files smaller than this are read, mapping them would cost more than the copy
+    const uint32_t MAP_FILE_MIN_SIZE = 64 * 1024;
+
+    uint16_t readU16(const unsigned char* p)
+    {
+        return p[0] | (p[1] << 8);
+    }
+
+    uint32_t readU32(const unsigned char* p)
+    {
+        return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    bool preadFully(int fd, void* buffer, size_t size, off_t offset)
+    {
+        unsigned char* out = static_cast<unsigned char*>(buffer);
+        while (size > 0)
+        {
+            ssize_t n = pread(fd, out, size, offset);
+            if (n <= 0)
+            {
+                if (n < 0 && errno == EINTR)
+                    continue;
+                return false;
+            }
+            out += n;
+            size -= n;
+            offset += n;
+        }
+        return true;
+    }
+
+    std::string getAssetPath(const std::string& fullPath)
+    {
+        // "assets/" is at the beginning of the path and we don't want it
+        return fullPath.compare(0, strlen("assets/"), "assets/") == 0 ? fullPath.substr(strlen("assets/")) : fullPath;
+    }
+}
+
+struct FileUtilsAndroid::ZipEntry
+{
+    // of the local header, the data follows it
+    off_t headerOffset;
+    uint32_t storedSize;
+    uint32_t size;
+    // 0 stored, 8 deflated
+    uint16_t method;
+};
+
+/*
+ The central directory of a zip, the apk or an OBB, read once. The files are then found without opening them,
+ and read with pread() or mmap() from the zip, the deflated ones are inflated with zlib.
+ */
+struct FileUtilsAndroid::ZipIndex
+{
+    std::string path;
+    int fd;
+    // the names without the prefix of create()
+    std::unordered_map<std::string, ZipEntry> entries;
+    // the directories of the entries, without the trailing '/'
+    std::unordered_set<std::string> directories;
+
+    ZipIndex() : fd(-1) {}
+    ~ZipIndex()
+    {
+        if (fd >= 0)
+            close(fd);
+    }
+
+    /** Indexes the entries of the zip under `prefix`, returns nullptr when the zip can't be read or is a zip64. */
+    static std::shared_ptr<ZipIndex> create(const std::string& path, const std::string& prefix)
+    {
+        auto index = std::make_shared<ZipIndex>();
+        index->path = path;
+        index->fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat st;
+        if (index->fd < 0 || fstat(index->fd, &st) != 0)
+            return nullptr;
+
+        // the end of central directory record is in the last 22 bytes, followed by a comment of 64 KB at most
+        off_t tailSize = std::min<off_t>(st.st_size, 0xFFFF + 22);
+        std::vector<unsigned char> tail(tailSize);
+        if (tailSize < 22 || !preadFully(index->fd, tail.data(), tailSize, st.st_size - tailSize))
+            return nullptr;
+
+        const unsigned char* eocd = nullptr;
+        for (off_t i = tailSize - 22; i >= 0; --i)
+        {
+            if (readU32(&tail[i]) == 0x06054b50)
+            {
+                eocd = &tail[i];
+                break;
+            }
+        }
+        if (!eocd)
+            return nullptr;
+
+        uint16_t entryCount = readU16(eocd + 10);
+        uint32_t directorySize = readU32(eocd + 12);
+        uint32_t directoryOffset = readU32(eocd + 16);
+        if (entryCount == 0xFFFF || directoryOffset == 0xFFFFFFFF || (off_t)directoryOffset + directorySize > st.st_size)
+            return nullptr;
+
+        std::vector<unsigned char> directory(directorySize);
+        if (!preadFully(index->fd, directory.data(), directorySize, directoryOffset))
+            return nullptr;
+
+        index->entries.reserve(entryCount);
+        size_t pos = 0;
+        for (uint16_t i = 0; i < entryCount; ++i)
+        {
+            const unsigned char* p = directory.data() + pos;
+            if (pos + 46 > directorySize || readU32(p) != 0x02014b50)
+                return nullptr;
+
+            uint16_t nameLength = readU16(p + 28);
+            size_t recordSize = 46 + nameLength + readU16(p + 30) + readU16(p + 32);
+            if (pos + recordSize > directorySize)
+                return nullptr;
+            pos += recordSize;
+
+            if (nameLength <= prefix.length() || memcmp(p + 46, prefix.c_str(), prefix.length()) != 0)
+                continue;
+
+            std::string name(reinterpret_cast<const char*>(p + 46) + prefix.length(), nameLength - prefix.length());
+            for (size_t slash = name.find('/'); slash != std::string::npos; slash = name.find('/', slash + 1))
+            {
+                index->directories.insert(name.substr(0, slash));
+            }
+            if (name.back() == '/')
+                continue;
+
+            ZipEntry& entry = index->entries[name];
+            entry.method = readU16(p + 10);
+            entry.storedSize = readU32(p + 20);
+            entry.size = readU32(p + 24);
+            entry.headerOffset = readU32(p + 42);
+        }
+        return index;
+    }
+
+    bool hasDirectory(const std::string& name) const
+    {
+        return name.empty() ? !entries.empty() : directories.find(name) != directories.end();
+    }
+
+    off_t getDataOffset(const ZipEntry& entry) const
+    {
+        unsigned char header[30];
+        if (!preadFully(fd, header, sizeof(header), entry.headerOffset) || readU32(header) != 0x04034b50)
+            return -1;
+        return entry.headerOffset + sizeof(header) + readU16(header + 26) + readU16(header + 28);
+    }
+
+    /** Reads the entry into `buffer`, which holds entry.size bytes. */
+    bool read(const ZipEntry& entry, unsigned char* buffer) const
+    {
+        off_t offset = getDataOffset(entry);
+        if (offset < 0)
+            return false;
+
+        if (entry.method == 0)
+            return preadFully(fd, buffer, entry.size, offset);
+        if (entry.method != Z_DEFLATED)
+            return false;
+
+        std::vector<unsigned char> stored(entry.storedSize);
+        if (!preadFully(fd, stored.data(), entry.storedSize, offset))
+            return false;
+
+        // raw deflate, without the zlib header
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+            return false;
+        stream.next_in = stored.data();
+        stream.avail_in = entry.storedSize;
+        stream.next_out = buffer;
+        stream.avail_out = entry.size;
+        int err = inflate(&stream, Z_FINISH);
+        inflateEnd(&stream);
+        return err == Z_STREAM_END && stream.total_out == entry.size;
+    }
+
+    FileView map(const ZipEntry& entry) const
+    {
+        if (entry.method == 0 && entry.size >= MAP_FILE_MIN_SIZE)
+        {
+            off_t offset = getDataOffset(entry);
+            if (offset < 0)
+                return FileView();
+
+            // the mapping stays valid after the zip is closed
+            off_t alignedOffset = offset & ~((off_t)sysconf(_SC_PAGESIZE) - 1);
+            size_t length = entry.size + (offset - alignedOffset);
+            void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, alignedOffset);
+            if (mapped != MAP_FAILED)
+            {
+                return FileView(static_cast<const unsigned char*>(mapped) + (offset - alignedOffset), entry.size, [mapped, length]() {
+                    munmap(mapped, length);
+                });
+            }
+        }
+
+        unsigned char* bytes = static_cast<unsigned char*>(malloc(std::max<uint32_t>(entry.size, 1)));
+        if (!bytes || !read(entry, bytes))
+        {
+            free(bytes);
+            return FileView();
+        }
+        Data data;
+        data.fastSet(bytes, entry.size);
+        return FileView(std::move(data));
+    }
+};
+
 void FileUtilsAndroid::setassetmanager(AAssetManager* a) {
     if (nullptr == a) {
         LOGD("setassetmanager : received unexpected nullptr parameter");
@@ -146,11 +374,18 @@ bool FileUtilsAndroid::isFileExistInternal(const std::string& strFilePath) const
     // Check whether file exists in apk.
     if (strFilePath[0] != '/')
     {
-        const char* s = strFilePath.c_str();
-
-        // Found "assets/" at the beginning of the path and we don't want it
-        if (strFilePath.find(_defaultResRootPath) == 0) s += strlen("assets/");
+        std::string relativePath = getAssetPath(strFilePath);
+        std::shared_ptr<const ZipIndex> index;
+        if (findAsset(relativePath, &index))
+        {
+            return true;
+        }
+        if (getApkIndex())
+        {
+            return false;
+        }
 
+        const char* s = relativePath.c_str();
         if (FileUtilsAndroid::assetmanager) {
             AAsset* aa = AAssetManager_open(FileUtilsAndroid::assetmanager, s, AASSET_MODE_UNKNOWN);
             if (aa)
@@ -204,6 +439,25 @@ bool FileUtilsAndroid::isDirectoryExistInternal(const std::string& dirPath) cons
     {
         s += lenOfAssets;
     }
+
+    std::string relativePath(s);
+    if (!relativePath.empty() && relativePath.back() == '/')
+    {
+        relativePath.pop_back();
+    }
+    for (const auto& obb : _obbs)
+    {
+        if (obb->hasDirectory(relativePath))
+        {
+            return true;
+        }
+    }
+    auto apk = getApkIndex();
+    if (apk)
+    {
+        return apk->hasDirectory(relativePath);
+    }
+
     if (FileUtilsAndroid::assetmanager)
     {
         AAssetDir* aa = AAssetManager_openDir(FileUtilsAndroid::assetmanager, s);
@@ -229,6 +483,44 @@ bool FileUtilsAndroid::isAbsolutePath(const std::string& strPath) const
     return false;
 }
 
+FileView FileUtilsAndroid::mapFile(const std::string& fullPath)
+{
+    if (fullPath[0] == '/')
+    {
+        return FileUtils::mapFile(fullPath);
+    }
+
+    std::string relativePath = getAssetPath(fullPath);
+    std::shared_ptr<const ZipIndex> index;
+    if (const ZipEntry* entry = findAsset(relativePath, &index))
+    {
+        return index->map(*entry);
+    }
+
+    if (getApkIndex() || nullptr == FileUtilsAndroid::assetmanager)
+    {
+        return FileView();
+    }
+
+    AAsset* asset = AAssetManager_open(FileUtilsAndroid::assetmanager, relativePath.c_str(), AASSET_MODE_BUFFER);
+    if (nullptr == asset)
+    {
+        return FileView();
+    }
+
+    // the buffer is mapped from the apk when the asset is stored uncompressed, else it's inflated into memory
+    const void* bytes = AAsset_getBuffer(asset);
+    if (nullptr == bytes)
+    {
+        AAsset_close(asset);
+        return FileView();
+    }
+
+    return FileView(static_cast<const unsigned char*>(bytes), AAsset_getLength(asset), [asset]() {
+        AAsset_close(asset);
+    });
+}
+
 Data FileUtilsAndroid::getData(const std::string& filename, bool forString)
 {
     if (filename.empty())
@@ -252,40 +544,64 @@ Data FileUtilsAndroid::getData(const std::string& filename, bool forString)
         }
         CCLOGINFO("relative path = %s", relativePath.c_str());
 
-        if (nullptr == FileUtilsAndroid::assetmanager) {
-            LOGD("... FileUtilsAndroid::assetmanager is nullptr");
-            return Data::Null;
+        std::shared_ptr<const ZipIndex> index;
+        if (const ZipEntry* entry = findAsset(relativePath, &index))
+        {
+            // read it straight from the zip
+            data = (unsigned char*) malloc(entry->size + 1);
+            if (data && index->read(*entry, data))
+            {
+                data[entry->size] = '\0';
+                size = entry->size;
+            }
+            else
+            {
+                free(data);
+                data = nullptr;
+            }
         }
+        else
+        {
+            if (getApkIndex()) {
+                LOGD("asset is nullptr,%s", relativePath.c_str());
+                return Data::Null;
+            }
 
-        // read asset data
-        AAsset* asset =
-            AAssetManager_open(FileUtilsAndroid::assetmanager,
-                               relativePath.c_str(),
-                               AASSET_MODE_UNKNOWN);
-        if (nullptr == asset) {
-            LOGD("asset is nullptr,%s", relativePath.c_str());
-            return Data::Null;
-        }
+            if (nullptr == FileUtilsAndroid::assetmanager) {
+                LOGD("... FileUtilsAndroid::assetmanager is nullptr");
+                return Data::Null;
+            }
 
-        off_t fileSize = AAsset_getLength(asset);
+            // read asset data
+            AAsset* asset =
+                AAssetManager_open(FileUtilsAndroid::assetmanager,
+                                   relativePath.c_str(),
+                                   AASSET_MODE_UNKNOWN);
+            if (nullptr == asset) {
+                LOGD("asset is nullptr,%s", relativePath.c_str());
+                return Data::Null;
+            }
 
-        if (forString)
-        {
-            data = (unsigned char*) malloc(fileSize + 1);
+            off_t fileSize = AAsset_getLength(asset);
+
+            if (forString)
+            {
+                data = (unsigned char*) malloc(fileSize + 1);
+                if (data)
+                    data[fileSize] = '\0';
+            }
+            else
+            {
+                data = (unsigned char*) malloc(fileSize);
+            }
             if (data)
-                data[fileSize] = '\0';
-        }
-        else
-        {
-            data = (unsigned char*) malloc(fileSize);
-        }
-        if (data)
-        {
-            int bytesread = AAsset_read(asset, (void*)data, fileSize);
-            size = bytesread;
-        }
+            {
+                int bytesread = AAsset_read(asset, (void*)data, fileSize);
+                size = bytesread;
+            }
 
-        AAsset_close(asset);
+            AAsset_close(asset);
+        }
     }
     else
     {
@@ -343,18 +659,13 @@ Data FileUtilsAndroid::getData(const std::string& filename, bool forString)
     return ret;
 }
 
-std::string FileUtilsAndroid::getStringFromFile(const std::string& filename)
-{
-    Data data = getData(filename, true);
-    if (data.isNull())
-        return "";
-
-    std::string ret((const char*)data.getBytes());
-    return ret;
-}
-
 Data FileUtilsAndroid::getDataFromFile(const std::string& filename)
 {
+    Data data;
+    if (getDataFromAssetPack(filename, false, &data))
+    {
+        return data;
+    }
     return getData(filename, false);
 }
 
@@ -381,6 +692,26 @@ unsigned char* FileUtilsAndroid::getFileData(const std::string& filename, const
         }
         LOGD("relative path = %s", relativePath.c_str());
 
+        std::shared_ptr<const ZipIndex> index;
+        if (const ZipEntry* entry = findAsset(relativePath, &index))
+        {
+            data = (unsigned char*) malloc(std::max<uint32_t>(entry->size, 1));
+            if (data && index->read(*entry, data))
+            {
+                if (size)
+                {
+                    *size = entry->size;
+                }
+                return data;
+            }
+            free(data);
+            return nullptr;
+        }
+        if (getApkIndex()) {
+            LOGD("asset is nullptr");
+            return nullptr;
+        }
+
         if (nullptr == FileUtilsAndroid::assetmanager) {
             LOGD("... FileUtilsAndroid::assetmanager is nullptr");
             return nullptr;
@@ -442,6 +773,90 @@ unsigned char* FileUtilsAndroid::getFileData(const std::string& filename, const
     return data;
 }
 
+std::shared_ptr<const FileUtilsAndroid::ZipIndex> FileUtilsAndroid::getApkIndex()
+{
+    // the loading threads look assets up too, and the apk path is set by Cocos2dxHelper.init()
+    static std::mutex mutex;
+    static std::shared_ptr<const ZipIndex> index;
+    static bool indexed = false;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!indexed && getApkPath()[0] != '\0')
+    {
+        indexed = true;
+        index = ZipIndex::create(getApkPath(), "assets/");
+        if (!index)
+        {
+            LOGD("can't index the apk %s, the assets are read with the AAssetManager", getApkPath());
+        }
+    }
+    return index;
+}
+
+const FileUtilsAndroid::ZipEntry* FileUtilsAndroid::findAsset(const std::string& relativePath, std::shared_ptr<const ZipIndex>* index) const
+{
+    for (const auto& obb : _obbs)
+    {
+        auto iter = obb->entries.find(relativePath);
+        if (iter != obb->entries.end())
+        {
+            *index = obb;
+            return &iter->second;
+        }
+    }
+
+    auto apk = getApkIndex();
+    if (apk)
+    {
+        auto iter = apk->entries.find(relativePath);
+        if (iter != apk->entries.end())
+        {
+            *index = apk;
+            return &iter->second;
+        }
+    }
+    return nullptr;
+}
+
+bool FileUtilsAndroid::mountObb(const std::string& path)
+{
+    for (const auto& obb : _obbs)
+    {
+        if (obb->path == path)
+        {
+            return true;
+        }
+    }
+
+    auto obb = ZipIndex::create(path, "");
+    if (!obb)
+    {
+        CCLOG("cocos2d: FileUtilsAndroid: can't mount the OBB %s", path.c_str());
+        return false;
+    }
+    _obbs.insert(_obbs.begin(), obb);
+
+    _fullPathCache.clear();
+    _textureFullPathCache.clear();
+    _missingFileCache.clear();
+    return true;
+}
+
+void FileUtilsAndroid::unmountObb(const std::string& path)
+{
+    for (auto iter = _obbs.begin(); iter != _obbs.end(); ++iter)
+    {
+        if ((*iter)->path == path)
+        {
+            _obbs.erase(iter);
+            _fullPathCache.clear();
+            _textureFullPathCache.clear();
+            _missingFileCache.clear();
+            return;
+        }
+    }
+}
+
 std::string FileUtilsAndroid::getWritablePath() const
 {
     // Fix for Nexus 10 (Android 4.2 multi-user environment)
@@ -31,6 +31,7 @@ Copyright (c) 2013-2016 Chukong Technologies Inc.
 #include "platform/CCFileUtils.h"
 #include "platform/CCPlatformMacros.h"
 #include "base/ccTypes.h"
+#include <memory>
 #include <string>
 #include <vector>
 #include "jni.h"
@@ -66,11 +67,6 @@ public:
     /** @deprecated Please use FileUtils::getDataFromFile or FileUtils::getStringFromFile instead. */
     CC_DEPRECATED_ATTRIBUTE virtual unsigned char* getFileData(const std::string& filename, const char* mode, ssize_t * size) override;
 
-    /**
-     *  Gets string from a file.
-     */
-    virtual std::string getStringFromFile(const std::string& filename) override;
-
     /**
      *  Creates binary data from a file.
      *  @return A data object.
@@ -80,12 +76,38 @@ public:
     virtual std::string getWritablePath() const override;
     virtual bool isAbsolutePath(const std::string& strPath) const override;
 
+    /**
+     * Mounts an OBB, a zip whose files overlay the assets of the apk: "assets/a.png" is read from the "a.png" of the
+     * OBB when it has it. The last OBB mounted comes first. Like the apk, its files are read straight from the zip,
+     * its directory is indexed once.
+     * @param path The absolute path of the OBB, e.g. from Context.getObbDir().
+     * @since v3.11
+     */
+    bool mountObb(const std::string& path);
+    /** Unmounts an OBB mounted by mountObb(), the views of its files stay valid. */
+    void unmountObb(const std::string& path);
+
+protected:
+    virtual FileView mapFile(const std::string& fullPath) override;
+
 private:
+    struct ZipIndex;
+    struct ZipEntry;
+
     virtual bool isFileExistInternal(const std::string& strFilePath) const override;
     virtual bool isDirectoryExistInternal(const std::string& dirPath) const override;
     Data getData(const std::string& filename, bool forString);
 
+    /**
+     * The index of the apk, read from its central directory the first time an asset is looked up.
+     * nullptr when the apk can't be indexed, the assets are then read with the AAssetManager.
+     */
+    static std::shared_ptr<const ZipIndex> getApkIndex();
+    /** Finds an asset, the path without "assets/", in the OBBs then in the apk. */
+    const ZipEntry* findAsset(const std::string& relativePath, std::shared_ptr<const ZipIndex>* index) const;
+
     static AAssetManager* assetmanager;
+    std::vector<std::shared_ptr<const ZipIndex>> _obbs;
 };
 
 // end of platform group
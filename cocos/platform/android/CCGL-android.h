@@ -39,6 +39,39 @@ THE SOFTWARE.
 #define GL_DEPTH24_STENCIL8         GL_DEPTH24_STENCIL8_OES
 #define GL_WRITE_ONLY               GL_WRITE_ONLY_OES
 
+#define glMapBufferRange            glMapBufferRangeEXT
+#define glFlushMappedBufferRange    glFlushMappedBufferRangeEXT
+#define GL_MAP_WRITE_BIT            GL_MAP_WRITE_BIT_EXT
+#define GL_MAP_INVALIDATE_RANGE_BIT GL_MAP_INVALIDATE_RANGE_BIT_EXT
+#define GL_MAP_FLUSH_EXPLICIT_BIT   GL_MAP_FLUSH_EXPLICIT_BIT_EXT
+#define GL_MAP_UNSYNCHRONIZED_BIT   GL_MAP_UNSYNCHRONIZED_BIT_EXT
+
+#define glDrawElementsInstanced     glDrawElementsInstancedEXT
+#define glVertexAttribDivisor       glVertexAttribDivisorEXT
+
+#define glGenQueries                glGenQueriesEXT
+#define glDeleteQueries             glDeleteQueriesEXT
+#define glBeginQuery                glBeginQueryEXT
+#define glEndQuery                  glEndQueryEXT
+#define glGetQueryObjectuiv         glGetQueryObjectuivEXT
+#define GL_QUERY_RESULT             GL_QUERY_RESULT_EXT
+#define GL_QUERY_RESULT_AVAILABLE   GL_QUERY_RESULT_AVAILABLE_EXT
+
+#define glGetProgramBinary          glGetProgramBinaryOES
+#define glProgramBinary             glProgramBinaryOES
+#define GL_PROGRAM_BINARY_LENGTH    GL_PROGRAM_BINARY_LENGTH_OES
+#define GL_NUM_PROGRAM_BINARY_FORMATS GL_NUM_PROGRAM_BINARY_FORMATS_OES
+
+// GLES2 on android has no portable fence object, the ring buffer orphans once per frame instead
+#define CC_GL_MAP_BUFFER_RANGE      1
+#define CC_GL_SYNC_OBJECTS          0
+#define CC_GL_INSTANCING            1
+#define CC_GL_TIMER_QUERY           1
+#define CC_GL_PIXEL_BUFFER          0
+#define CC_GL_PROGRAM_BINARY        1
+// GL_EXT_discard_framebuffer on the tile based GPUs, checked at runtime
+#define CC_GL_DISCARD_FRAMEBUFFER   1
+
 // GL_GLEXT_PROTOTYPES isn't defined in glplatform.h on android ndk r7
 // we manually define it here
 #include <GLES2/gl2platform.h>
@@ -65,6 +98,38 @@ extern PFNGLDELETEVERTEXARRAYSOESPROC glDeleteVertexArraysOESEXT;
 #define glBindVertexArrayOES glBindVertexArrayOESEXT
 #define glDeleteVertexArraysOES glDeleteVertexArraysOESEXT
 
+extern PFNGLMAPBUFFERRANGEEXTPROC glMapBufferRangeEXTEXT;
+extern PFNGLFLUSHMAPPEDBUFFERRANGEEXTPROC glFlushMappedBufferRangeEXTEXT;
+
+#define glMapBufferRangeEXT glMapBufferRangeEXTEXT
+#define glFlushMappedBufferRangeEXT glFlushMappedBufferRangeEXTEXT
+
+extern PFNGLDRAWELEMENTSINSTANCEDEXTPROC glDrawElementsInstancedEXTEXT;
+extern PFNGLVERTEXATTRIBDIVISOREXTPROC glVertexAttribDivisorEXTEXT;
+
+#define glDrawElementsInstancedEXT glDrawElementsInstancedEXTEXT
+#define glVertexAttribDivisorEXT glVertexAttribDivisorEXTEXT
+
+extern PFNGLGENQUERIESEXTPROC glGenQueriesEXTEXT;
+extern PFNGLDELETEQUERIESEXTPROC glDeleteQueriesEXTEXT;
+extern PFNGLBEGINQUERYEXTPROC glBeginQueryEXTEXT;
+extern PFNGLENDQUERYEXTPROC glEndQueryEXTEXT;
+extern PFNGLGETQUERYOBJECTUIVEXTPROC glGetQueryObjectuivEXTEXT;
+extern PFNGLGETQUERYOBJECTUI64VEXTPROC glGetQueryObjectui64vEXTEXT;
+
+#define glGenQueriesEXT glGenQueriesEXTEXT
+#define glDeleteQueriesEXT glDeleteQueriesEXTEXT
+#define glBeginQueryEXT glBeginQueryEXTEXT
+#define glEndQueryEXT glEndQueryEXTEXT
+#define glGetQueryObjectuivEXT glGetQueryObjectuivEXTEXT
+#define glGetQueryObjectui64vEXT glGetQueryObjectui64vEXTEXT
+
+extern PFNGLGETPROGRAMBINARYOESPROC glGetProgramBinaryOESEXT;
+extern PFNGLPROGRAMBINARYOESPROC glProgramBinaryOESEXT;
+
+#define glGetProgramBinaryOES glGetProgramBinaryOESEXT
+#define glProgramBinaryOES glProgramBinaryOESEXT
+
 
 #endif // CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID
 
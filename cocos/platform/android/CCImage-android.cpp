@@ -0,0 +1,207 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "platform/CCPlatformConfig.h"
+#if CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID
+
+#include "platform/CCImage.h"
+
+#if CC_USE_PLATFORM_IMAGE_DECODER
+
+#include <dlfcn.h>
+#include <stdint.h>
+#include <vector>
+#include "platform/android/jni/JniHelper.h"
+
+NS_CC_BEGIN
+
+namespace
+{
+    // AImageDecoder of <android/imagedecoder.h>, it's in libjnigraphics from API level 30.
+    // The functions are looked up at runtime, so the engine still runs on the older devices.
+    struct AImageDecoder;
+    struct AImageDecoderHeaderInfo;
+
+    const int32_t ANDROID_IMAGE_DECODER_SUCCESS = 0;
+    const int32_t ANDROID_BITMAP_FORMAT_RGBA_8888 = 1;
+    const int ANDROID_BITMAP_FLAGS_ALPHA_OPAQUE = 1;
+
+    struct ImageDecoderAPI
+    {
+        int (*createFromBuffer)(const void* buffer, size_t length, AImageDecoder** outDecoder);
+        void (*destroy)(AImageDecoder* decoder);
+        const AImageDecoderHeaderInfo* (*getHeaderInfo)(const AImageDecoder* decoder);
+        int32_t (*getWidth)(const AImageDecoderHeaderInfo* info);
+        int32_t (*getHeight)(const AImageDecoderHeaderInfo* info);
+        int (*getAlphaFlags)(const AImageDecoderHeaderInfo* info);
+        int (*setAndroidBitmapFormat)(AImageDecoder* decoder, int32_t format);
+        int (*setUnpremultipliedRequired)(AImageDecoder* decoder, bool required);
+        size_t (*getMinimumStride)(AImageDecoder* decoder);
+        int (*decodeImage)(AImageDecoder* decoder, void* pixels, size_t stride, size_t size);
+        bool available;
+    };
+
+    ImageDecoderAPI loadImageDecoderAPI()
+    {
+        ImageDecoderAPI api = {};
+        void* lib = dlopen("libjnigraphics.so", RTLD_NOW | RTLD_LOCAL);
+        if (!lib)
+            return api;
+
+        api.createFromBuffer = (int (*)(const void*, size_t, AImageDecoder**))dlsym(lib, "AImageDecoder_createFromBuffer");
+        api.destroy = (void (*)(AImageDecoder*))dlsym(lib, "AImageDecoder_delete");
+        api.getHeaderInfo = (const AImageDecoderHeaderInfo* (*)(const AImageDecoder*))dlsym(lib, "AImageDecoder_getHeaderInfo");
+        api.getWidth = (int32_t (*)(const AImageDecoderHeaderInfo*))dlsym(lib, "AImageDecoderHeaderInfo_getWidth");
+        api.getHeight = (int32_t (*)(const AImageDecoderHeaderInfo*))dlsym(lib, "AImageDecoderHeaderInfo_getHeight");
+        api.getAlphaFlags = (int (*)(const AImageDecoderHeaderInfo*))dlsym(lib, "AImageDecoderHeaderInfo_getAlphaFlags");
+        api.setAndroidBitmapFormat = (int (*)(AImageDecoder*, int32_t))dlsym(lib, "AImageDecoder_setAndroidBitmapFormat");
+        api.setUnpremultipliedRequired = (int (*)(AImageDecoder*, bool))dlsym(lib, "AImageDecoder_setUnpremultipliedRequired");
+        api.getMinimumStride = (size_t (*)(AImageDecoder*))dlsym(lib, "AImageDecoder_getMinimumStride");
+        api.decodeImage = (int (*)(AImageDecoder*, void*, size_t, size_t))dlsym(lib, "AImageDecoder_decodeImage");
+
+        api.available = api.createFromBuffer && api.destroy && api.getHeaderInfo && api.getWidth && api.getHeight
+            && api.getAlphaFlags && api.setAndroidBitmapFormat && api.setUnpremultipliedRequired
+            && api.getMinimumStride && api.decodeImage;
+        // the library stays loaded, it's part of the platform anyway
+        return api;
+    }
+
+    const ImageDecoderAPI& getImageDecoderAPI()
+    {
+        static const ImageDecoderAPI api = loadImageDecoderAPI();
+        return api;
+    }
+}
+
+bool Image::isPlatformDecoderAvailable()
+{
+    return getImageDecoderAPI().available;
+}
+
+bool Image::decodeWithPlatform(const unsigned char * data, ssize_t dataLen, bool* premultiplied, bool* opaque)
+{
+    const ImageDecoderAPI& api = getImageDecoderAPI();
+    if (!api.available)
+        return false;
+
+    AImageDecoder* decoder = nullptr;
+    if (api.createFromBuffer(data, dataLen, &decoder) != ANDROID_IMAGE_DECODER_SUCCESS)
+        return false;
+
+    const AImageDecoderHeaderInfo* info = api.getHeaderInfo(decoder);
+    int width = api.getWidth(info);
+    int height = api.getHeight(info);
+    bool hasAlpha = api.getAlphaFlags(info) != ANDROID_BITMAP_FLAGS_ALPHA_OPAQUE;
+
+    // the decoder premultiplies as it decodes, which saves the pass of premultipliedAlpha()
+    bool ok = api.setAndroidBitmapFormat(decoder, ANDROID_BITMAP_FORMAT_RGBA_8888) == ANDROID_IMAGE_DECODER_SUCCESS
+        && api.setUnpremultipliedRequired(decoder, !PNG_PREMULTIPLIED_ALPHA_ENABLED) == ANDROID_IMAGE_DECODER_SUCCESS
+        && api.getMinimumStride(decoder) == (size_t)width * 4;
+
+    size_t size = (size_t)width * height * 4;
+    if (ok)
+    {
+        _data = static_cast<unsigned char*>(malloc(size));
+        ok = _data && api.decodeImage(decoder, _data, (size_t)width * 4, size) == ANDROID_IMAGE_DECODER_SUCCESS;
+    }
+    api.destroy(decoder);
+
+    if (!ok)
+    {
+        free(_data);
+        _data = nullptr;
+        return false;
+    }
+
+    _width = width;
+    _height = height;
+    *premultiplied = hasAlpha && PNG_PREMULTIPLIED_ALPHA_ENABLED;
+    *opaque = !hasAlpha;
+    return true;
+}
+
+bool Image::encodeWithPlatform(Format format, const EncodeOptions& options, Data* out)
+{
+    JniMethodInfo t;
+    if (!JniHelper::getStaticMethodInfo(t, "org/cocos2dx/lib/Cocos2dxBitmap", "encodeImage", "([BIIZZI)[B"))
+        return false;
+
+    // Bitmap takes RGBA8888, written as they are with straight alpha like the bundled encoders
+    const bool keepAlpha = hasAlpha() && !options.toRGB && format == Format::PNG;
+    const jsize size = _width * _height * 4;
+    jbyteArray pixels = t.env->NewByteArray(size);
+    if (pixels && keepAlpha)
+    {
+        t.env->SetByteArrayRegion(pixels, 0, size, reinterpret_cast<const jbyte*>(_data));
+    }
+    else if (pixels)
+    {
+        const int srcBpp = hasAlpha() ? 4 : 3;
+        std::vector<unsigned char> row(_width * 4);
+        for (int y = 0; y < _height; ++y)
+        {
+            const unsigned char* src = _data + (size_t)y * _width * srcBpp;
+            for (int x = 0; x < _width; ++x)
+            {
+                row[x * 4] = src[x * srcBpp];
+                row[x * 4 + 1] = src[x * srcBpp + 1];
+                row[x * 4 + 2] = src[x * srcBpp + 2];
+                row[x * 4 + 3] = 255;
+            }
+            t.env->SetByteArrayRegion(pixels, y * _width * 4, _width * 4, reinterpret_cast<const jbyte*>(row.data()));
+        }
+    }
+
+    jbyteArray encoded = nullptr;
+    if (pixels)
+    {
+        encoded = (jbyteArray)t.env->CallStaticObjectMethod(t.classID, t.methodID, pixels, _width, _height,
+                                                            format == Format::PNG, keepAlpha, options.jpgQuality);
+        t.env->DeleteLocalRef(pixels);
+    }
+    t.env->DeleteLocalRef(t.classID);
+    if (t.env->ExceptionCheck())
+    {
+        t.env->ExceptionClear();
+        encoded = nullptr;
+    }
+    if (!encoded)
+        return false;
+
+    jsize length = t.env->GetArrayLength(encoded);
+    unsigned char* bytes = static_cast<unsigned char*>(malloc(length));
+    if (bytes)
+    {
+        t.env->GetByteArrayRegion(encoded, 0, length, reinterpret_cast<jbyte*>(bytes));
+        out->fastSet(bytes, length);
+    }
+    t.env->DeleteLocalRef(encoded);
+    return bytes != nullptr;
+}
+
+NS_CC_END
+
+#endif // CC_USE_PLATFORM_IMAGE_DECODER
+
+#endif // CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID
@@ -25,6 +25,7 @@ THE SOFTWARE.
 package org.cocos2dx.lib;
 
 import android.app.Activity;
+import android.content.ComponentCallbacks2;
 import android.content.Context;
 import android.content.Intent;
 import android.content.pm.ApplicationInfo;
@@ -308,6 +309,41 @@ public abstract class Cocos2dxActivity extends Activity {
         mGLSurfaceView.onPause();
     }
 
+    @Override
+    public void onTrimMemory(int level) {
+        super.onTrimMemory(level);
+        // to the levels of MemoryPressure: 1 LOW, 2 MEDIUM, 3 CRITICAL
+        int pressure;
+        switch (level) {
+            case ComponentCallbacks2.TRIM_MEMORY_RUNNING_MODERATE:
+            case ComponentCallbacks2.TRIM_MEMORY_UI_HIDDEN:
+                pressure = 1;
+                break;
+            case ComponentCallbacks2.TRIM_MEMORY_RUNNING_LOW:
+            case ComponentCallbacks2.TRIM_MEMORY_BACKGROUND:
+                pressure = 2;
+                break;
+            case ComponentCallbacks2.TRIM_MEMORY_RUNNING_CRITICAL:
+            case ComponentCallbacks2.TRIM_MEMORY_MODERATE:
+            case ComponentCallbacks2.TRIM_MEMORY_COMPLETE:
+                pressure = 3;
+                break;
+            default:
+                return;
+        }
+        if (mGLSurfaceView != null) {
+            mGLSurfaceView.onTrimMemory(pressure);
+        }
+    }
+
+    @Override
+    public void onLowMemory() {
+        super.onLowMemory();
+        if (mGLSurfaceView != null) {
+            mGLSurfaceView.onTrimMemory(3);
+        }
+    }
+
     @Override
     protected void onDestroy() {
         super.onDestroy();
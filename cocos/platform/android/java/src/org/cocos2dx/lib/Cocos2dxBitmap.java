@@ -34,6 +34,7 @@ import android.text.TextPaint;
 import android.text.TextUtils;
 import android.util.Log;
 
+import java.io.ByteArrayOutputStream;
 import java.nio.ByteBuffer;
 import java.nio.ByteOrder;
 
@@ -186,6 +187,38 @@ public final class Cocos2dxBitmap {
         return null;
     }
 
+    /* Encodes RGBA8888 pixels to a PNG or JPEG file, for Image::encode(). Returns null on failure. */
+    public static byte[] encodeImage(final byte[] pixels, int width, int height, boolean png, boolean keepAlpha, int quality) {
+        // the alpha of the pixels is straight, the older bitmaps are always premultiplied
+        if (keepAlpha && android.os.Build.VERSION.SDK_INT < 19) {
+            return null;
+        }
+        Bitmap bitmap = null;
+        try {
+            bitmap = Bitmap.createBitmap(width, height, Bitmap.Config.ARGB_8888);
+            if (keepAlpha) {
+                bitmap.setPremultiplied(false);
+            }
+            bitmap.setHasAlpha(keepAlpha);
+            bitmap.copyPixelsFromBuffer(ByteBuffer.wrap(pixels));
+
+            ByteArrayOutputStream stream = new ByteArrayOutputStream(png ? pixels.length / 2 : pixels.length / 8);
+            if (!bitmap.compress(png ? Bitmap.CompressFormat.PNG : Bitmap.CompressFormat.JPEG, quality, stream)) {
+                return null;
+            }
+            return stream.toByteArray();
+        } catch (Exception e) {
+            Log.e("Cocos2dxBitmap", "encodeImage failed", e);
+            return null;
+        } catch (OutOfMemoryError e) {
+            return null;
+        } finally {
+            if (bitmap != null) {
+                bitmap.recycle();
+            }
+        }
+    }
+
     public static int getFontSizeAccordingHeight(int height) {
         TextPaint paint = new TextPaint();
         Rect bounds = new Rect();
@@ -24,16 +24,20 @@ THE SOFTWARE.
  ****************************************************************************/
 package org.cocos2dx.lib;
 
+import android.annotation.TargetApi;
 import android.app.Activity;
 import android.content.Context;
 import android.opengl.GLSurfaceView;
+import android.os.Build;
 import android.os.Handler;
 import android.os.Message;
 import android.util.AttributeSet;
 import android.util.Log;
+import android.view.Choreographer;
 import android.view.KeyEvent;
 import android.view.MotionEvent;
 import android.view.View;
+import android.view.WindowManager;
 import android.view.inputmethod.InputMethodManager;
 
 public class Cocos2dxGLSurfaceView extends GLSurfaceView {
@@ -46,6 +50,9 @@ public class Cocos2dxGLSurfaceView extends GLSurfaceView {
     private final static int HANDLER_OPEN_IME_KEYBOARD = 2;
     private final static int HANDLER_CLOSE_IME_KEYBOARD = 3;
 
+    // the vsyncs between two checks of the refresh rate of the display
+    private final static int REFRESH_RATE_CHECK_VSYNCS = 60;
+
     // ===========================================================
     // Fields
     // ===========================================================
@@ -56,6 +63,7 @@ public class Cocos2dxGLSurfaceView extends GLSurfaceView {
     private Cocos2dxRenderer mCocosRenderer;
     private Cocos2dxEditBox mCocosEditText;
     private boolean mSoftKeyboardShown = false;
+    private VsyncPacer mVsyncPacer;
 
     public boolean isSoftKeyboardShown() {
         return mSoftKeyboardShown;
@@ -111,10 +119,72 @@ public class Cocos2dxGLSurfaceView extends GLSurfaceView {
         }
     }
 
+    /*
+     * Requests the frames on the vsyncs of the Choreographer, one every Cocos2dxRenderer.getSwapInterval() vsyncs,
+     * so each frame is displayed for the same number of refreshes. The refresh rate of the display may change,
+     * 90 or 120 Hz on some devices, it's checked regularly.
+     */
+    @TargetApi(Build.VERSION_CODES.JELLY_BEAN)
+    private class VsyncPacer implements Choreographer.FrameCallback {
+        private boolean mRunning = false;
+        private int mVsyncs = 0;
+        private int mVsyncsSinceCheck = 0;
+
+        public void start() {
+            if (mRunning) {
+                return;
+            }
+            mRunning = true;
+            mVsyncs = 0;
+            mVsyncsSinceCheck = 0;
+            checkRefreshRate();
+            Choreographer.getInstance().postFrameCallback(this);
+        }
+
+        public void stop() {
+            mRunning = false;
+            Choreographer.getInstance().removeFrameCallback(this);
+        }
+
+        @Override
+        public void doFrame(final long frameTimeNanos) {
+            if (!mRunning) {
+                return;
+            }
+            Choreographer.getInstance().postFrameCallback(this);
+
+            if (++mVsyncsSinceCheck >= REFRESH_RATE_CHECK_VSYNCS) {
+                mVsyncsSinceCheck = 0;
+                checkRefreshRate();
+            }
+            if (++mVsyncs >= Cocos2dxRenderer.getSwapInterval()) {
+                mVsyncs = 0;
+                requestRender();
+            }
+        }
+    }
+
+    private void checkRefreshRate() {
+        final WindowManager windowManager = (WindowManager) getContext().getSystemService(Context.WINDOW_SERVICE);
+        final float refreshRate = windowManager.getDefaultDisplay().getRefreshRate();
+        if (refreshRate > 0 && refreshRate != Cocos2dxRenderer.getRefreshRate()) {
+            queueEvent(new Runnable() {
+                @Override
+                public void run() {
+                    sGLSurfaceView.mCocosRenderer.handleRefreshRateChanged(refreshRate);
+                }
+            });
+        }
+    }
+
     protected void initView() {
         setEGLContextClientVersion(2);
         setFocusableInTouchMode(true);
 
+        if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.JELLY_BEAN) {
+            mVsyncPacer = new VsyncPacer();
+        }
+
         sGLSurfaceView = this;
         sTextInputWrapper = new Cocos2dxTextInputWrapper(this);
         sIMEHandler = new IMEHandler();
@@ -168,7 +238,13 @@ public class Cocos2dxGLSurfaceView extends GLSurfaceView {
     @Override
     public void onResume() {
         super.onResume();
-        setRenderMode(RENDERMODE_CONTINUOUSLY);
+        if (mVsyncPacer != null) {
+            setRenderMode(RENDERMODE_WHEN_DIRTY);
+            Cocos2dxRenderer.setVsyncPaced(true);
+            mVsyncPacer.start();
+        } else {
+            setRenderMode(RENDERMODE_CONTINUOUSLY);
+        }
         queueEvent(new Runnable() {
             @Override
             public void run() {
@@ -185,10 +261,22 @@ public class Cocos2dxGLSurfaceView extends GLSurfaceView {
                 sGLSurfaceView.mCocosRenderer.handleOnPause();
             }
         });
+        if (mVsyncPacer != null) {
+            mVsyncPacer.stop();
+        }
         setRenderMode(RENDERMODE_WHEN_DIRTY);
         //super.onPause();
     }
 
+    public void onTrimMemory(final int level) {
+        queueEvent(new Runnable() {
+            @Override
+            public void run() {
+                sGLSurfaceView.mCocosRenderer.handleTrimMemory(level);
+            }
+        });
+    }
+
     @Override
     public boolean onTouchEvent(final MotionEvent pMotionEvent) {
         // these data are used in ACTION_MOVE and ACTION_CANCEL
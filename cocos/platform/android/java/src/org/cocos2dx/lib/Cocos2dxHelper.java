@@ -30,8 +30,10 @@ import android.content.Intent;
 import android.content.SharedPreferences;
 import android.content.pm.ApplicationInfo;
 import android.content.res.AssetManager;
+import android.media.AudioManager;
 import android.net.Uri;
 import android.os.Build;
+import android.os.PowerManager;
 import android.os.Vibrator;
 import android.preference.PreferenceManager.OnActivityResultListener;
 import android.util.DisplayMetrics;
@@ -39,6 +41,7 @@ import android.view.Display;
 import android.view.WindowManager;
 
 import java.io.UnsupportedEncodingException;
+import java.lang.reflect.Method;
 import java.util.LinkedHashSet;
 import java.util.Locale;
 import java.util.Map;
@@ -134,6 +137,31 @@ public class Cocos2dxHelper {
         return Build.VERSION.SDK_INT;
     }
 
+    /** The native sample rate of the audio output, 0 when unknown, AudioMixer asks it once for OpenSL ES. */
+    public static int getAudioOutputSampleRate() {
+        return getAudioOutputProperty("android.media.property.OUTPUT_SAMPLE_RATE");
+    }
+
+    /** The frames of the native buffers of the audio output, 0 when unknown. */
+    public static int getAudioOutputFramesPerBuffer() {
+        return getAudioOutputProperty("android.media.property.OUTPUT_FRAMES_PER_BUFFER");
+    }
+
+    private static int getAudioOutputProperty(final String name) {
+        // AudioManager.getProperty() is in API level 17
+        if (Build.VERSION.SDK_INT < 17) {
+            return 0;
+        }
+        try {
+            final AudioManager audioManager = (AudioManager)getActivity().getSystemService(Context.AUDIO_SERVICE);
+            final Method getProperty = AudioManager.class.getMethod("getProperty", String.class);
+            final String value = (String)getProperty.invoke(audioManager, name);
+            return value != null ? Integer.parseInt(value) : 0;
+        } catch (Exception e) {
+            return 0;
+        }
+    }
+
     public static AssetManager getAssetManager() {
         return Cocos2dxHelper.sAssetManager;
     }
@@ -167,6 +195,26 @@ public class Cocos2dxHelper {
             sVibrateService.vibrate((long)(duration * 1000));
     }
 
+    // the thermal status of PowerManager, mapped to the states of Device::ThermalState: nominal, fair, serious, critical
+    public static int getThermalState() {
+        if (Build.VERSION.SDK_INT < 29 || Cocos2dxActivity.COCOS_ACTIVITY == null)
+            return 0;
+        try {
+            PowerManager powerManager = (PowerManager)Cocos2dxActivity.COCOS_ACTIVITY.getSystemService(Context.POWER_SERVICE);
+            // built against an older SDK, getCurrentThermalStatus() is called by reflection
+            Method method = PowerManager.class.getMethod("getCurrentThermalStatus");
+            int status = (Integer)method.invoke(powerManager);
+            // none, light, moderate, severe, critical, emergency, shutdown
+            if (status <= 0)
+                return 0;
+            if (status <= 2)
+                return status;
+            return 3;
+        } catch (Exception e) {
+            return 0;
+        }
+    }
+
     public static boolean openURL(String url) {
         boolean ret = false;
         try {
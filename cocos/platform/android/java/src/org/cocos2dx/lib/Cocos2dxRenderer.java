@@ -35,7 +35,10 @@ public class Cocos2dxRenderer implements GLSurfaceView.Renderer {
     private final static long NANOSECONDSPERSECOND = 1000000000L;
     private final static long NANOSECONDSPERMICROSECOND = 1000000;
 
-    private static long sAnimationInterval = (long) (1.0 / 60 * Cocos2dxRenderer.NANOSECONDSPERSECOND);
+    private static volatile long sAnimationInterval = (long) (1.0 / 60 * Cocos2dxRenderer.NANOSECONDSPERSECOND);
+    private static volatile float sRefreshRate = 60;
+    // set when the frames are requested on the vsyncs by Cocos2dxGLSurfaceView, they aren't paced here then
+    private static volatile boolean sVsyncPaced = false;
 
     // ===========================================================
     // Fields
@@ -54,6 +57,23 @@ public class Cocos2dxRenderer implements GLSurfaceView.Renderer {
         Cocos2dxRenderer.sAnimationInterval = (long) (animationInterval * Cocos2dxRenderer.NANOSECONDSPERSECOND);
     }
 
+    public static float getRefreshRate() {
+        return Cocos2dxRenderer.sRefreshRate;
+    }
+
+    /*
+     * The number of vsyncs a frame lasts, the animation interval rounded to a whole number of refreshes.
+     * See FramePacer::getSwapInterval().
+     */
+    public static int getSwapInterval() {
+        final double refreshes = (double) Cocos2dxRenderer.sAnimationInterval * Cocos2dxRenderer.sRefreshRate / Cocos2dxRenderer.NANOSECONDSPERSECOND;
+        return Math.max(1, (int) Math.round(refreshes));
+    }
+
+    public static void setVsyncPaced(final boolean vsyncPaced) {
+        Cocos2dxRenderer.sVsyncPaced = vsyncPaced;
+    }
+
     public void setScreenWidthAndHeight(final int surfaceWidth, final int surfaceHeight) {
         mScreenWidth = surfaceWidth;
         mScreenHeight = surfaceHeight;
@@ -66,6 +86,7 @@ public class Cocos2dxRenderer implements GLSurfaceView.Renderer {
     @Override
     public void onSurfaceCreated(final GL10 GL10, final EGLConfig EGLConfig) {
         Cocos2dxRenderer.nativeInit(mScreenWidth, mScreenHeight);
+        Cocos2dxRenderer.nativeSetRefreshRate(Cocos2dxRenderer.sRefreshRate);
         mLastTickInNanoSeconds = System.nanoTime();
         mNativeInitCompleted = true;
     }
@@ -81,7 +102,7 @@ public class Cocos2dxRenderer implements GLSurfaceView.Renderer {
          * No need to use algorithm in default(60 FPS) situation,
          * since onDrawFrame() was called by system 60 times per second by default.
          */
-        if (sAnimationInterval <= 1.0 / 60 * Cocos2dxRenderer.NANOSECONDSPERSECOND) {
+        if (Cocos2dxRenderer.sVsyncPaced || sAnimationInterval <= 1.0 / 60 * Cocos2dxRenderer.NANOSECONDSPERSECOND) {
             Cocos2dxRenderer.nativeRender();
         } else {
             final long now = System.nanoTime();
@@ -115,6 +136,8 @@ public class Cocos2dxRenderer implements GLSurfaceView.Renderer {
     private static native void nativeOnSurfaceChanged(final int width, final int height);
     private static native void nativeOnPause();
     private static native void nativeOnResume();
+    private static native void nativeSetRefreshRate(final float refreshRate);
+    private static native void nativeOnTrimMemory(final int level);
 
     public void handleActionDown(final int id, final float x, final float y) {
         Cocos2dxRenderer.nativeTouchesBegin(id, x, y);
@@ -154,11 +177,24 @@ public class Cocos2dxRenderer implements GLSurfaceView.Renderer {
         Cocos2dxRenderer.nativeOnPause();
     }
 
+    public void handleRefreshRateChanged(final float refreshRate) {
+        Cocos2dxRenderer.sRefreshRate = refreshRate;
+        if (mNativeInitCompleted) {
+            Cocos2dxRenderer.nativeSetRefreshRate(refreshRate);
+        }
+    }
+
     public void handleOnResume() {
         Cocos2dxHelper.onEnterForeground();
         Cocos2dxRenderer.nativeOnResume();
     }
 
+    public void handleTrimMemory(final int level) {
+        if (mNativeInitCompleted) {
+            Cocos2dxRenderer.nativeOnTrimMemory(level);
+        }
+    }
+
     private static native void nativeInsertText(final String text);
     private static native void nativeDeleteBackward();
     private static native String nativeGetContentText();
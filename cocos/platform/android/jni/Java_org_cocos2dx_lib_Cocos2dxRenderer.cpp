@@ -3,6 +3,7 @@
 #include "base/CCEventType.h"
 #include "base/CCEventCustom.h"
 #include "base/CCEventDispatcher.h"
+#include "base/CCMemoryPressure.h"
 #include "../CCApplication.h"
 #include "platform/CCFileUtils.h"
 #include "JniHelper.h"
@@ -34,6 +35,19 @@ extern "C" {
         }
     }
 
+    JNIEXPORT void JNICALL Java_org_cocos2dx_lib_Cocos2dxRenderer_nativeSetRefreshRate(JNIEnv* env, jobject thiz, jfloat refreshRate) {
+        if (refreshRate > 0) {
+            Director::getInstance()->getFramePacer()->setRefreshRate(refreshRate);
+        }
+    }
+
+    JNIEXPORT void JNICALL Java_org_cocos2dx_lib_Cocos2dxRenderer_nativeOnTrimMemory(JNIEnv* env, jobject thiz, jint level) {
+        // 1 LOW, 2 MEDIUM, 3 CRITICAL, see Cocos2dxActivity.onTrimMemory()
+        if (level >= (int)MemoryPressure::Level::LOW && level <= (int)MemoryPressure::Level::CRITICAL) {
+            MemoryPressure::getInstance()->signal((MemoryPressure::Level)level);
+        }
+    }
+
     JNIEXPORT void JNICALL Java_org_cocos2dx_lib_Cocos2dxRenderer_nativeInsertText(JNIEnv* env, jobject thiz, jstring text) {
         std::string  strValue = JniHelper::getStringUTFCharsJNI(env, text);
         const char* pszText = strValue.c_str();
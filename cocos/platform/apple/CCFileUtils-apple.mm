@@ -379,20 +379,23 @@ bool FileUtilsApple::isFileExistInternal(const std::string& filePath, bool& isDi
         return false;
     
     isDirectory = false;
-    
-    NSString* path = nil;
-    if (filePath[0] != '/')
-        path = [[getBundle() resourcePath] stringByAppendingPathComponent:
-                          [NSString stringWithUTF8String:filePath.c_str()]];
-    else
-        path = [NSString stringWithUTF8String:filePath.c_str()];
-    
-    BOOL isDir = NO;
-    // Search path is an absolute path.
-    if ([s_fileManager fileExistsAtPath:path isDirectory:&isDir]) {
-        if (isDir)
-            isDirectory = true;
-        return true;
+
+    // the loader threads have no autorelease pool
+    @autoreleasepool {
+        NSString* path = nil;
+        if (filePath[0] != '/')
+            path = [[getBundle() resourcePath] stringByAppendingPathComponent:
+                              [NSString stringWithUTF8String:filePath.c_str()]];
+        else
+            path = [NSString stringWithUTF8String:filePath.c_str()];
+
+        BOOL isDir = NO;
+        // Search path is an absolute path.
+        if ([s_fileManager fileExistsAtPath:path isDirectory:&isDir]) {
+            if (isDir)
+                isDirectory = true;
+            return true;
+        }
     }
 
     return false;
@@ -425,21 +428,24 @@ bool FileUtilsApple::removeDirectory(const std::string& path)
 
 std::string FileUtilsApple::getFullPathForDirectoryAndFilename(const std::string& directory, const std::string& filename) const
 {
-    if (directory[0] != '/')
-    {
-        NSString* fullpath = [getBundle() pathForResource:[NSString stringWithUTF8String:filename.c_str()]
-                                                             ofType:nil
-                                                        inDirectory:[NSString stringWithUTF8String:directory.c_str()]];
-        if (fullpath != nil) {
-            return [fullpath UTF8String];
+    // the loader threads have no autorelease pool
+    @autoreleasepool {
+        if (directory[0] != '/')
+        {
+            NSString* fullpath = [getBundle() pathForResource:[NSString stringWithUTF8String:filename.c_str()]
+                                                                 ofType:nil
+                                                            inDirectory:[NSString stringWithUTF8String:directory.c_str()]];
+            if (fullpath != nil) {
+                return [fullpath UTF8String];
+            }
         }
-    }
-    else
-    {
-        std::string fullPath = directory+filename;
-        // Search path is an absolute path.
-        if ([s_fileManager fileExistsAtPath:[NSString stringWithUTF8String:fullPath.c_str()]]) {
-            return fullPath;
+        else
+        {
+            std::string fullPath = directory+filename;
+            // Search path is an absolute path.
+            if ([s_fileManager fileExistsAtPath:[NSString stringWithUTF8String:fullPath.c_str()]]) {
+                return fullPath;
+            }
         }
     }
     return "";
@@ -447,13 +453,14 @@ std::string FileUtilsApple::getFullPathForDirectoryAndFilename(const std::string
 
 ValueMap FileUtilsApple::getValueMapFromFile(const std::string& filename)
 {
-    auto d(FileUtils::getInstance()->getDataFromFile(filename));
-    return getValueMapFromData(reinterpret_cast<char*>(d.getBytes()), static_cast<int>(d.getSize()));
+    auto d(FileUtils::getInstance()->getFileView(filename));
+    return getValueMapFromData(reinterpret_cast<const char*>(d.getBytes()), static_cast<int>(d.getSize()));
 }
 
 ValueMap FileUtilsApple::getValueMapFromData(const char* filedata, int filesize)
 {
-    NSData* file = [NSData dataWithBytes:filedata length:filesize];
+    // the property list doesn't keep the bytes, they don't need a copy
+    NSData* file = [NSData dataWithBytesNoCopy:const_cast<char*>(filedata) length:filesize freeWhenDone:NO];
     NSPropertyListFormat format;
     NSError* error;
     NSDictionary* dict = [NSPropertyListSerialization propertyListWithData:file options:NSPropertyListImmutable format:&format error:&error];
@@ -478,6 +485,7 @@ bool FileUtilsApple::writeToFile(const ValueMap& dict, const std::string &fullPa
 
 bool FileUtils::writeValueMapToFile(const ValueMap& dict, const std::string& fullPath)
 {
+    _missingFileCache.clear();
 
     //CCLOG("iOS||Mac Dictionary %d write to file %s", dict->_ID, fullPath.c_str());
     NSMutableDictionary *nsDict = [NSMutableDictionary dictionary];
@@ -496,6 +504,8 @@ bool FileUtils::writeValueMapToFile(const ValueMap& dict, const std::string& ful
 
 bool FileUtils::writeValueVectorToFile(const ValueVector& vecData, const std::string& fullPath)
 {
+    _missingFileCache.clear();
+
     NSString* path = [NSString stringWithUTF8String:fullPath.c_str()];
     NSMutableArray* array = [NSMutableArray array];
 
@@ -0,0 +1,154 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "platform/CCImage.h"
+
+#if CC_USE_PLATFORM_IMAGE_DECODER
+
+#import <ImageIO/ImageIO.h>
+#import <CoreGraphics/CoreGraphics.h>
+
+NS_CC_BEGIN
+
+bool Image::isPlatformDecoderAvailable()
+{
+    return true;
+}
+
+bool Image::decodeWithPlatform(const unsigned char * data, ssize_t dataLen, bool* premultiplied, bool* opaque)
+{
+    CFDataRef cfData = CFDataCreateWithBytesNoCopy(kCFAllocatorDefault, data, dataLen, kCFAllocatorNull);
+    if (!cfData)
+        return false;
+    CGImageSourceRef source = CGImageSourceCreateWithData(cfData, nullptr);
+    CFRelease(cfData);
+    if (!source)
+        return false;
+
+    // the pixels are drawn into _data right away, ImageIO doesn't need to keep its own copy
+    const void* keys[] = { kCGImageSourceShouldCache };
+    const void* values[] = { kCFBooleanFalse };
+    CFDictionaryRef options = CFDictionaryCreate(kCFAllocatorDefault, keys, values, 1,
+                                                 &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
+    CGImageRef image = CGImageSourceCreateImageAtIndex(source, 0, options);
+    CFRelease(options);
+    CFRelease(source);
+    if (!image)
+        return false;
+
+    CGImageAlphaInfo alphaInfo = CGImageGetAlphaInfo(image);
+    bool hasAlpha = alphaInfo != kCGImageAlphaNone && alphaInfo != kCGImageAlphaNoneSkipLast && alphaInfo != kCGImageAlphaNoneSkipFirst;
+    // CoreGraphics only draws into premultiplied bitmaps, libpng keeps the straight alpha
+    if (hasAlpha && !PNG_PREMULTIPLIED_ALPHA_ENABLED)
+    {
+        CGImageRelease(image);
+        return false;
+    }
+
+    size_t width = CGImageGetWidth(image);
+    size_t height = CGImageGetHeight(image);
+    _data = static_cast<unsigned char*>(malloc(width * height * 4));
+    if (!_data)
+    {
+        CGImageRelease(image);
+        return false;
+    }
+
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGContextRef context = CGBitmapContextCreate(_data, width, height, 8, width * 4, colorSpace,
+                                                 kCGImageAlphaPremultipliedLast | kCGBitmapByteOrder32Big);
+    CGColorSpaceRelease(colorSpace);
+    if (!context)
+    {
+        free(_data);
+        _data = nullptr;
+        CGImageRelease(image);
+        return false;
+    }
+
+    // copy instead of blending, the bitmap isn't cleared first
+    CGContextSetBlendMode(context, kCGBlendModeCopy);
+    CGContextDrawImage(context, CGRectMake(0, 0, width, height), image);
+    CGContextRelease(context);
+    CGImageRelease(image);
+
+    _width = (int)width;
+    _height = (int)height;
+    *premultiplied = hasAlpha;
+    *opaque = !hasAlpha;
+    return true;
+}
+
+bool Image::encodeWithPlatform(Format format, const EncodeOptions& options, Data* out)
+{
+    // the pixels are written as they are, straight alpha like the bundled encoders
+    const int srcBpp = hasAlpha() ? 4 : 3;
+    bool keepAlpha = hasAlpha() && !options.toRGB && format == Format::PNG;
+    CGBitmapInfo bitmapInfo = kCGBitmapByteOrderDefault;
+    if (srcBpp == 4)
+    {
+        bitmapInfo |= keepAlpha ? kCGImageAlphaLast : kCGImageAlphaNoneSkipLast;
+    }
+
+    CGDataProviderRef provider = CGDataProviderCreateWithData(nullptr, _data, (size_t)_width * _height * srcBpp, nullptr);
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGImageRef image = CGImageCreate(_width, _height, 8, srcBpp * 8, _width * srcBpp, colorSpace, bitmapInfo, provider,
+                                     nullptr, false, kCGRenderingIntentDefault);
+    CGColorSpaceRelease(colorSpace);
+    CGDataProviderRelease(provider);
+    if (!image)
+        return false;
+
+    CFMutableDataRef data = CFDataCreateMutable(kCFAllocatorDefault, 0);
+    CFStringRef type = format == Format::PNG ? CFSTR("public.png") : CFSTR("public.jpeg");
+    CGImageDestinationRef destination = CGImageDestinationCreateWithData(data, type, 1, nullptr);
+    bool ok = false;
+    if (destination)
+    {
+        float quality = std::min(std::max(options.jpgQuality, 1), 100) / 100.0f;
+        CFNumberRef qualityNumber = CFNumberCreate(kCFAllocatorDefault, kCFNumberFloatType, &quality);
+        const void* keys[] = { kCGImageDestinationLossyCompressionQuality };
+        const void* values[] = { qualityNumber };
+        CFDictionaryRef properties = CFDictionaryCreate(kCFAllocatorDefault, keys, values, 1,
+                                                        &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
+        CFRelease(qualityNumber);
+
+        CGImageDestinationAddImage(destination, image, properties);
+        ok = CGImageDestinationFinalize(destination);
+        CFRelease(properties);
+        CFRelease(destination);
+    }
+    CGImageRelease(image);
+
+    if (ok)
+    {
+        out->copy(CFDataGetBytePtr(data), CFDataGetLength(data));
+    }
+    CFRelease(data);
+    return ok;
+}
+
+NS_CC_END
+
+#endif // CC_USE_PLATFORM_IMAGE_DECODER
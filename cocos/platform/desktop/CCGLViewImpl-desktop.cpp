@@ -25,6 +25,9 @@ THE SOFTWARE.
 
 #include "CCGLViewImpl-desktop.h"
 
+#include <chrono>
+#include <climits>
+#include <thread>
 #include <unordered_map>
 
 #include "platform/CCApplication.h"
@@ -37,6 +40,7 @@ THE SOFTWARE.
 #include "base/ccUtils.h"
 #include "base/ccUTF8.h"
 #include "base/CCString.h"
+#include "renderer/ccGLStateCache.h"
 
 NS_CC_BEGIN
 
@@ -271,7 +275,15 @@ GLViewImpl::GLViewImpl()
 , _retinaFactor(1)
 , _frameZoomFactor(1.0f)
 , _mainWindow(nullptr)
+, _sharedWindow(nullptr)
+, _uploadWindow(nullptr)
 , _monitor(nullptr)
+, _vsync(VSync::ON)
+, _maxFrameLatency(0)
+, _swapPacing(false)
+, _swapIntervalSet(false)
+, _swapInterval(0)
+, _adaptiveVSyncSupported(-1)
 , _mouseX(0.0f)
 , _mouseY(0.0f)
 {
@@ -394,6 +406,14 @@ bool GLViewImpl::initWithRect(const std::string& viewName, Rect rect, float fram
 
     glfwMakeContextCurrent(_mainWindow);
 
+    // the delta times are snapped to the refreshes of the display the window is on, the primary one when windowed
+    GLFWmonitor* monitor = _monitor ? _monitor : glfwGetPrimaryMonitor();
+    const GLFWvidmode* videoMode = monitor ? glfwGetVideoMode(monitor) : nullptr;
+    if (videoMode && videoMode->refreshRate > 0)
+    {
+        Director::getInstance()->getFramePacer()->setRefreshRate(videoMode->refreshRate);
+    }
+
     glfwSetMouseButtonCallback(_mainWindow, GLFWEventHandler::onGLFWMouseCallBack);
     glfwSetCursorPosCallback(_mainWindow, GLFWEventHandler::onGLFWMouseMoveCallBack);
     glfwSetScrollCallback(_mainWindow, GLFWEventHandler::onGLFWMouseScrollCallback);
@@ -461,6 +481,18 @@ bool GLViewImpl::isOpenGLReady()
 
 void GLViewImpl::end()
 {
+    if (_sharedWindow)
+    {
+        glfwDestroyWindow(_sharedWindow);
+        _sharedWindow = nullptr;
+    }
+    if (_uploadWindow)
+    {
+        glfwDestroyWindow(_uploadWindow);
+        _uploadWindow = nullptr;
+    }
+    // deleted with the context
+    _frameFences.clear();
     if(_mainWindow)
     {
         glfwSetWindowShouldClose(_mainWindow,1);
@@ -472,8 +504,137 @@ void GLViewImpl::end()
 
 void GLViewImpl::swapBuffers()
 {
-    if(_mainWindow)
-        glfwSwapBuffers(_mainWindow);
+    if(!_mainWindow)
+        return;
+
+    if (_swapIntervalSet)
+    {
+        int interval = computeSwapInterval();
+        if (interval != _swapInterval)
+        {
+            glfwSwapInterval(interval);
+            _swapInterval = interval;
+        }
+    }
+
+    glfwSwapBuffers(_mainWindow);
+    limitFrameLatency();
+}
+
+void GLViewImpl::setVSync(VSync vsync)
+{
+    _vsync = vsync;
+    _swapIntervalSet = true;
+    // applied by the next swap
+    _swapInterval = INT_MIN;
+}
+
+void GLViewImpl::setSwapPacingEnabled(bool enabled)
+{
+    _swapPacing = enabled;
+    if (!_swapIntervalSet)
+    {
+        _swapIntervalSet = true;
+        _swapInterval = INT_MIN;
+    }
+}
+
+int GLViewImpl::computeSwapInterval()
+{
+    if (_vsync == VSync::OFF)
+    {
+        return 0;
+    }
+
+    int interval = 1;
+    if (_swapPacing)
+    {
+        auto director = Director::getInstance();
+        interval = director->getFramePacer()->getSwapInterval(director->getAnimationInterval());
+    }
+
+    if (_vsync == VSync::ADAPTIVE)
+    {
+        if (_adaptiveVSyncSupported < 0)
+        {
+            _adaptiveVSyncSupported = glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear") ? 1 : 0;
+        }
+        // a negative interval lets the late frames tear
+        if (_adaptiveVSyncSupported)
+        {
+            interval = -interval;
+        }
+    }
+    return interval;
+}
+
+void GLViewImpl::limitFrameLatency()
+{
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_MAC)
+    if (_maxFrameLatency > 0 && (GLEW_ARB_sync || GLEW_VERSION_3_2))
+    {
+        _frameFences.push_back(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+        // the frames in flight, this one included, stay under the limit
+        while ((int)_frameFences.size() >= _maxFrameLatency)
+        {
+            GLsync fence = static_cast<GLsync>(_frameFences.front());
+            glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 100000000);
+            glDeleteSync(fence);
+            _frameFences.pop_front();
+        }
+        return;
+    }
+
+    for (auto fence : _frameFences)
+    {
+        glDeleteSync(static_cast<GLsync>(fence));
+    }
+    _frameFences.clear();
+#endif
+
+    if (_maxFrameLatency > 0)
+    {
+        glFinish();
+    }
+}
+
+void GLViewImpl::makeContextCurrent(bool current)
+{
+    glfwMakeContextCurrent(current ? _mainWindow : nullptr);
+}
+
+void GLViewImpl::makeSharedContextCurrent(bool current)
+{
+    if (!current)
+    {
+        glfwMakeContextCurrent(nullptr);
+        return;
+    }
+
+    // windows can only be created on the main thread, which is the one that uses the shared context
+    if (!_sharedWindow && _mainWindow)
+    {
+        glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+        _sharedWindow = glfwCreateWindow(1, 1, "", nullptr, _mainWindow);
+        glfwWindowHint(GLFW_VISIBLE, GL_TRUE);
+    }
+    glfwMakeContextCurrent(_sharedWindow);
+}
+
+bool GLViewImpl::createUploadContext()
+{
+    if (!_uploadWindow && _mainWindow)
+    {
+        glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+        _uploadWindow = glfwCreateWindow(1, 1, "", nullptr, _mainWindow);
+        glfwWindowHint(GLFW_VISIBLE, GL_TRUE);
+    }
+    return _uploadWindow != nullptr;
+}
+
+void GLViewImpl::makeUploadContextCurrent(bool current)
+{
+    glfwMakeContextCurrent(current ? _uploadWindow : nullptr);
 }
 
 bool GLViewImpl::windowShouldClose()
@@ -489,6 +650,23 @@ void GLViewImpl::pollEvents()
     glfwPollEvents();
 }
 
+void GLViewImpl::waitEvents(float timeout)
+{
+#if GLFW_VERSION_MAJOR > 3 || (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 2)
+    glfwWaitEventsTimeout(timeout);
+#else
+    // without glfwWaitEventsTimeout() the events are polled every few milliseconds until one comes
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    const auto inputEventCount = dispatcher->getInputEventCount();
+    const auto end = std::chrono::steady_clock::now() + std::chrono::duration<float>(timeout);
+    do
+    {
+        std::this_thread::sleep_for(std::min(std::chrono::duration<float>(end - std::chrono::steady_clock::now()), std::chrono::duration<float>(0.005f)));
+        glfwPollEvents();
+    } while (dispatcher->getInputEventCount() == inputEventCount && std::chrono::steady_clock::now() < end);
+#endif
+}
+
 void GLViewImpl::enableRetina(bool enabled)
 {
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_MAC)
@@ -585,28 +763,31 @@ void GLViewImpl::setFrameSize(float width, float height)
 
 void GLViewImpl::setViewPortInPoints(float x , float y , float w , float h)
 {
-    glViewport((float)(x * _scaleX * _retinaFactor * _frameZoomFactor + _viewPortRect.origin.x * _retinaFactor * _frameZoomFactor),
-        (float)(y * _scaleY * _retinaFactor  * _frameZoomFactor + _viewPortRect.origin.y * _retinaFactor * _frameZoomFactor),
-        (float)(w * _scaleX * _retinaFactor * _frameZoomFactor),
-        (float)(h * _scaleY * _retinaFactor * _frameZoomFactor));
+    const float pixelScale = _retinaFactor * _frameZoomFactor * _renderScale;
+    GL::viewport((GLint)(x * _scaleX * pixelScale + _viewPortRect.origin.x * pixelScale),
+        (GLint)(y * _scaleY * pixelScale + _viewPortRect.origin.y * pixelScale),
+        (GLsizei)(w * _scaleX * pixelScale),
+        (GLsizei)(h * _scaleY * pixelScale));
 }
 
 void GLViewImpl::setScissorInPoints(float x , float y , float w , float h)
 {
-    glScissor((GLint)(x * _scaleX * _retinaFactor * _frameZoomFactor + _viewPortRect.origin.x * _retinaFactor * _frameZoomFactor),
-               (GLint)(y * _scaleY * _retinaFactor  * _frameZoomFactor + _viewPortRect.origin.y * _retinaFactor * _frameZoomFactor),
-               (GLsizei)(w * _scaleX * _retinaFactor * _frameZoomFactor),
-               (GLsizei)(h * _scaleY * _retinaFactor * _frameZoomFactor));
+    const float pixelScale = _retinaFactor * _frameZoomFactor * _renderScale;
+    GL::scissor((GLint)(x * _scaleX * pixelScale + _viewPortRect.origin.x * pixelScale),
+                (GLint)(y * _scaleY * pixelScale + _viewPortRect.origin.y * pixelScale),
+                (GLsizei)(w * _scaleX * pixelScale),
+                (GLsizei)(h * _scaleY * pixelScale));
 }
 
 Rect GLViewImpl::getScissorRect() const
 {
-    GLfloat params[4];
-    glGetFloatv(GL_SCISSOR_BOX, params);
-    float x = (params[0] - _viewPortRect.origin.x * _retinaFactor * _frameZoomFactor) / (_scaleX * _retinaFactor * _frameZoomFactor);
-    float y = (params[1] - _viewPortRect.origin.y * _retinaFactor * _frameZoomFactor) / (_scaleY * _retinaFactor  * _frameZoomFactor);
-    float w = params[2] / (_scaleX * _retinaFactor * _frameZoomFactor);
-    float h = params[3] / (_scaleY * _retinaFactor  * _frameZoomFactor);
+    GLint params[4];
+    GL::getScissorBox(params);
+    const float pixelScale = _retinaFactor * _frameZoomFactor * _renderScale;
+    float x = (params[0] - _viewPortRect.origin.x * pixelScale) / (_scaleX * pixelScale);
+    float y = (params[1] - _viewPortRect.origin.y * pixelScale) / (_scaleY * pixelScale);
+    float w = params[2] / (_scaleX * pixelScale);
+    float h = params[3] / (_scaleY * pixelScale);
     return Rect(x, y, w, h);
 }
 
@@ -26,6 +26,8 @@ THE SOFTWARE.
 #ifndef __CC_EGLViewIMPL_DESKTOP_H__
 #define __CC_EGLViewIMPL_DESKTOP_H__
 
+#include <deque>
+
 #include "base/CCRef.h"
 #include "platform/CCCommon.h"
 #include "platform/CCGLView.h"
@@ -76,12 +78,18 @@ public:
 
     bool windowShouldClose() override;
     void pollEvents() override;
+    void waitEvents(float timeout) override;
     GLFWwindow* getWindow() const { return _mainWindow; }
 
     /* override functions */
     virtual bool isOpenGLReady() override;
     virtual void end() override;
     virtual void swapBuffers() override;
+    virtual bool isRenderThreadSupported() const override { return true; }
+    virtual void makeContextCurrent(bool current) override;
+    virtual void makeSharedContextCurrent(bool current) override;
+    virtual bool createUploadContext() override;
+    virtual void makeUploadContextCurrent(bool current) override;
     virtual void setFrameSize(float width, float height) override;
     virtual void setIMEKeyboardState(bool bOpen) override;
 
@@ -103,6 +111,48 @@ public:
     /** Get retina factor */
     int getRetinaFactor() const override { return _retinaFactor; }
 
+    /** How the buffer swaps wait for the refreshes of the display. */
+    enum class VSync
+    {
+        /** The swaps don't wait, the frames may tear. */
+        OFF,
+        /** The swaps wait for a refresh. */
+        ON,
+        /** The swaps wait for a refresh unless the frame missed it, then it's shown at once and may tear.
+         * Needs WGL_EXT_swap_control_tear or GLX_EXT_swap_control_tear, it's ON otherwise.
+         */
+        ADAPTIVE
+    };
+
+    /**
+     * Sets the synchronization of the swaps with the display, it's left to the driver until set.
+     * @since v3.11
+     */
+    void setVSync(VSync vsync);
+    /** Gets the synchronization of the swaps with the display, ON by default. @since v3.11 */
+    VSync getVSync() const { return _vsync; }
+
+    /**
+     * Sets the most frames the CPU may run ahead of the GPU. The driver queues 2 or 3 frames, so the input
+     * of a frame is shown that many refreshes later; with 1 the next frame starts once the last one is displayed.
+     * The swaps wait on fences, or glFinish() without GL_ARB_sync. 0, the default, leaves it to the driver.
+     * @since v3.11
+     */
+    void setMaxFrameLatency(int frames) { _maxFrameLatency = frames; }
+    /** Gets the most frames the CPU may run ahead of the GPU, 0 when it's left to the driver. @since v3.11 */
+    int getMaxFrameLatency() const { return _maxFrameLatency; }
+
+    /**
+     * Lets the swaps pace the frames instead of the sleeps of Application::run(). The swap interval is the number of
+     * refreshes of the animation interval, see FramePacer::getSwapInterval(). Only when the vsync isn't OFF, disabled by default.
+     * @since v3.11
+     */
+    void setSwapPacingEnabled(bool enabled);
+    /** Whether the swaps pace the frames. @since v3.11 */
+    bool isSwapPacingEnabled() const { return _swapPacing; }
+
+    virtual bool isPacedBySwaps() const override { return _swapPacing && _vsync != VSync::OFF; }
+
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
     HWND getWin32Window() { return glfwGetWin32Window(_mainWindow); }
 #endif /* (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32) */
@@ -123,6 +173,11 @@ protected:
 
     void updateFrameSize();
 
+    // the interval of glfwSwapInterval() for the presentation settings, called on the thread of the context
+    int computeSwapInterval();
+    // waits for the GPU to finish the frames past _maxFrameLatency, after the swap
+    void limitFrameLatency();
+
     // GLFW callbacks
     void onGLFWError(int errorID, const char* errorDesc);
     void onGLFWMouseCallBack(GLFWwindow* window, int button, int action, int modify);
@@ -144,10 +199,25 @@ protected:
     float _frameZoomFactor;
 
     GLFWwindow* _mainWindow;
+    // hidden window whose context shares its objects with the one of _mainWindow, see makeSharedContextCurrent()
+    GLFWwindow* _sharedWindow;
+    // hidden window in the same share group, for the upload thread of TextureCache, see createUploadContext()
+    GLFWwindow* _uploadWindow;
     GLFWmonitor* _monitor;
 
     std::string _glfwError;
 
+    VSync _vsync;
+    int _maxFrameLatency;
+    bool _swapPacing;
+    // swapBuffers() applies the settings on the thread of the context, once they were set
+    bool _swapIntervalSet;
+    int _swapInterval;
+    // -1 until the extensions are checked
+    int _adaptiveVSyncSupported;
+    // the GLsync fences of the frames the GPU may still be drawing
+    std::deque<void*> _frameFences;
+
     float _mouseX;
     float _mouseY;
 
@@ -473,6 +473,19 @@ void Device::vibrate(float duration)
     AudioServicesPlayAlertSound(kSystemSoundID_Vibrate);
 }
 
+Device::ThermalState Device::getThermalState()
+{
+#if defined(__IPHONE_11_0) && __IPHONE_OS_VERSION_MAX_ALLOWED >= __IPHONE_11_0
+    NSProcessInfo* processInfo = [NSProcessInfo processInfo];
+    if ([processInfo respondsToSelector:@selector(thermalState)])
+    {
+        // the states are in the same order
+        return (ThermalState)[processInfo thermalState];
+    }
+#endif
+    return ThermalState::NOMINAL;
+}
+
 NS_CC_END
 
 #endif // CC_PLATFORM_IOS
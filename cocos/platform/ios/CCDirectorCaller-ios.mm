@@ -40,9 +40,21 @@ static id s_sharedDirectorCaller;
 +(id) displayLinkWithTarget: (id)arg1 selector:(SEL)arg2;
 -(void) addToRunLoop: (id)arg1 forMode: (id)arg2;
 -(void) setFrameInterval: (NSInteger)interval;
+-(void) setPreferredFramesPerSecond: (NSInteger)preferredFramesPerSecond;
 -(void) invalidate;
 @end
 
+// the refresh rate of the screen, above 60 Hz on the ProMotion displays
+static float getScreenRefreshRate()
+{
+    UIScreen* screen = [UIScreen mainScreen];
+    if ([screen respondsToSelector:@selector(maximumFramesPerSecond)])
+    {
+        return (float)screen.maximumFramesPerSecond;
+    }
+    return 60.0f;
+}
+
 @implementation CCDirectorCaller
 
 @synthesize interval;
@@ -99,14 +111,31 @@ static id s_sharedDirectorCaller;
     [super dealloc];
 }
 
+-(void) scheduleDisplayLink
+{
+    auto pacer = cocos2d::Director::getInstance()->getFramePacer();
+    pacer->setRefreshRate(getScreenRefreshRate());
+
+    displayLink = [NSClassFromString(@"CADisplayLink") displayLinkWithTarget:self selector:@selector(doCaller:)];
+    if ([displayLink respondsToSelector:@selector(setPreferredFramesPerSecond:)])
+    {
+        // a whole number of refreshes per frame, or the frames are shown for uneven times
+        const float frameRate = pacer->getRefreshRate() / self.interval;
+        [displayLink setPreferredFramesPerSecond: (NSInteger)(frameRate + 0.5f)];
+    }
+    else
+    {
+        [displayLink setFrameInterval: self.interval];
+    }
+    [displayLink addToRunLoop:[NSRunLoop currentRunLoop] forMode:NSDefaultRunLoopMode];
+}
+
 -(void) startMainLoop
 {
     // Director::setAnimationInterval() is called, we should invalidate it first
     [self stopMainLoop];
 
-    displayLink = [NSClassFromString(@"CADisplayLink") displayLinkWithTarget:self selector:@selector(doCaller:)];
-    [displayLink setFrameInterval: self.interval];
-    [displayLink addToRunLoop:[NSRunLoop currentRunLoop] forMode:NSDefaultRunLoopMode];
+    [self scheduleDisplayLink];
 }
 
 -(void) stopMainLoop
@@ -120,11 +149,11 @@ static id s_sharedDirectorCaller;
     // Director::setAnimationInterval() is called, we should invalidate it first
     [self stopMainLoop];
 
-    self.interval = 60.0 * intervalNew;
+    auto pacer = cocos2d::Director::getInstance()->getFramePacer();
+    pacer->setRefreshRate(getScreenRefreshRate());
+    self.interval = pacer->getSwapInterval(intervalNew);
 
-    displayLink = [NSClassFromString(@"CADisplayLink") displayLinkWithTarget:self selector:@selector(doCaller:)];
-    [displayLink setFrameInterval: self.interval];
-    [displayLink addToRunLoop:[NSRunLoop currentRunLoop] forMode:NSDefaultRunLoopMode];
+    [self scheduleDisplayLink];
 }
 
 -(void) doCaller: (id) sender
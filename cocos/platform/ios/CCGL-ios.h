@@ -39,6 +39,36 @@ THE SOFTWARE.
 #define GL_DEPTH24_STENCIL8         GL_DEPTH24_STENCIL8_OES
 #define GL_WRITE_ONLY               GL_WRITE_ONLY_OES
 
+#define glMapBufferRange            glMapBufferRangeEXT
+#define glFlushMappedBufferRange    glFlushMappedBufferRangeEXT
+#define GL_MAP_WRITE_BIT            GL_MAP_WRITE_BIT_EXT
+#define GL_MAP_INVALIDATE_RANGE_BIT GL_MAP_INVALIDATE_RANGE_BIT_EXT
+#define GL_MAP_FLUSH_EXPLICIT_BIT   GL_MAP_FLUSH_EXPLICIT_BIT_EXT
+#define GL_MAP_UNSYNCHRONIZED_BIT   GL_MAP_UNSYNCHRONIZED_BIT_EXT
+
+#define glFenceSync                 glFenceSyncAPPLE
+#define glClientWaitSync            glClientWaitSyncAPPLE
+#define glDeleteSync                glDeleteSyncAPPLE
+#define GL_SYNC_GPU_COMMANDS_COMPLETE   GL_SYNC_GPU_COMMANDS_COMPLETE_APPLE
+#define GL_SYNC_FLUSH_COMMANDS_BIT      GL_SYNC_FLUSH_COMMANDS_BIT_APPLE
+#define GL_TIMEOUT_EXPIRED          GL_TIMEOUT_EXPIRED_APPLE
+#define GL_WAIT_FAILED              GL_WAIT_FAILED_APPLE
+
+#define glDrawElementsInstanced     glDrawElementsInstancedEXT
+#define glVertexAttribDivisor       glVertexAttribDivisorEXT
+
+#define CC_GL_MAP_BUFFER_RANGE      1
+#define CC_GL_SYNC_OBJECTS          1
+#define CC_GL_INSTANCING            1
+// there is no timer query extension on iOS
+#define CC_GL_TIMER_QUERY           0
+// GLES2 has no GL_PIXEL_PACK_BUFFER, the readbacks stay synchronous
+#define CC_GL_PIXEL_BUFFER          0
+// iOS doesn't expose program binaries, the shaders are compiled on every run
+#define CC_GL_PROGRAM_BINARY        0
+// GL_EXT_discard_framebuffer, the tile memory of a framebuffer isn't written back when discarded
+#define CC_GL_DISCARD_FRAMEBUFFER   1
+
 #include <OpenGLES/ES2/gl.h>
 #include <OpenGLES/ES2/glext.h>
 
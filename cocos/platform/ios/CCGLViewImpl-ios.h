@@ -73,6 +73,12 @@ public:
     virtual bool isOpenGLReady() override;
     virtual void end() override;
     virtual void swapBuffers() override;
+    /** The view must not be resized while the render thread runs. */
+    virtual bool isRenderThreadSupported() const override { return true; }
+    virtual void makeContextCurrent(bool current) override;
+    virtual void makeSharedContextCurrent(bool current) override;
+    virtual bool createUploadContext() override;
+    virtual void makeUploadContextCurrent(bool current) override;
     virtual void setIMEKeyboardState(bool bOpen) override;
 
 protected:
@@ -85,6 +91,10 @@ protected:
 
     // the objective-c CCEAGLView instance
     void *_eaglview;
+    // the EAGLContext in the sharegroup of the view, see makeSharedContextCurrent()
+    void *_sharedContext;
+    // another EAGLContext in the sharegroup, for the upload thread of TextureCache, see createUploadContext()
+    void *_uploadContext;
 };
 
 NS_CC_END
@@ -108,6 +108,9 @@ void GLViewImpl::convertAttrs()
 }
 
 GLViewImpl::GLViewImpl()
+: _eaglview(nullptr)
+, _sharedContext(nullptr)
+, _uploadContext(nullptr)
 {
 }
 
@@ -195,6 +198,17 @@ void GLViewImpl::end()
 {
     [CCDirectorCaller destroy];
 
+    if (_sharedContext)
+    {
+        [(EAGLContext*)_sharedContext release];
+        _sharedContext = nullptr;
+    }
+    if (_uploadContext)
+    {
+        [(EAGLContext*)_uploadContext release];
+        _uploadContext = nullptr;
+    }
+
     //runtime版本由宿主（eg：QQ浏览器）负责移除EAGLView
     //CCEAGLView *eaglview = (CCEAGLView*) _eaglview;
     //[eaglview removeFromSuperview];
@@ -208,6 +222,39 @@ void GLViewImpl::swapBuffers()
     [eaglview swapBuffers];
 }
 
+void GLViewImpl::makeContextCurrent(bool current)
+{
+    CCEAGLView *eaglview = (CCEAGLView*) _eaglview;
+    [EAGLContext setCurrentContext:current ? [eaglview context] : nil];
+}
+
+void GLViewImpl::makeSharedContextCurrent(bool current)
+{
+    if (current && !_sharedContext)
+    {
+        CCEAGLView *eaglview = (CCEAGLView*) _eaglview;
+        EAGLContext *context = [eaglview context];
+        _sharedContext = [[EAGLContext alloc] initWithAPI:[context API] sharegroup:[context sharegroup]];
+    }
+    [EAGLContext setCurrentContext:current ? (EAGLContext*)_sharedContext : nil];
+}
+
+bool GLViewImpl::createUploadContext()
+{
+    if (!_uploadContext)
+    {
+        CCEAGLView *eaglview = (CCEAGLView*) _eaglview;
+        EAGLContext *context = [eaglview context];
+        _uploadContext = [[EAGLContext alloc] initWithAPI:[context API] sharegroup:[context sharegroup]];
+    }
+    return _uploadContext != nullptr;
+}
+
+void GLViewImpl::makeUploadContextCurrent(bool current)
+{
+    [EAGLContext setCurrentContext:current ? (EAGLContext*)_uploadContext : nil];
+}
+
 void GLViewImpl::setIMEKeyboardState(bool open)
 {
     CCEAGLView *eaglview = (CCEAGLView*) _eaglview;
@@ -28,6 +28,8 @@ THE SOFTWARE.
 
 #import <Cocoa/Cocoa.h>
 #include <algorithm>
+#include <chrono>
+#include <thread>
 
 #import "platform/CCApplication.h"
 #include "platform/CCFileUtils.h"
@@ -36,20 +38,10 @@ THE SOFTWARE.
 
 NS_CC_BEGIN
 
-static long getCurrentMillSecond()
-{
-    long lLastTime = 0;
-    struct timeval stCurrentTime;
-
-    gettimeofday(&stCurrentTime,NULL);
-    lLastTime = stCurrentTime.tv_sec*1000+stCurrentTime.tv_usec*0.001; //millseconds
-    return lLastTime;
-}
-
 Application* Application::sm_pSharedApplication = 0;
 
 Application::Application()
-: _animationInterval(1.0f/60.0f*1000.0f)
+: _animationInterval(1.0f/60.0f*1000000.0f)
 {
     CCASSERT(! sm_pSharedApplication, "sm_pSharedApplication already exist");
     sm_pSharedApplication = this;
@@ -69,8 +61,10 @@ int Application::run()
         return 1;
     }
 
-    long lastTime = 0L;
-    long curTime = 0L;
+    typedef std::chrono::steady_clock Clock;
+    // usleep() may wake up late, so the last millisecond before a frame is spun
+    const auto spin = std::chrono::milliseconds(1);
+    auto next = Clock::now();
 
     auto director = Director::getInstance();
     auto glview = director->getOpenGLView();
@@ -80,15 +74,42 @@ int Application::run()
 
     while (!glview->windowShouldClose())
     {
-        lastTime = getCurrentMillSecond();
+        // nothing to draw, wait for an event or the next timer instead of running frames
+        const float idleTime = director->getIdleTime();
+        if (idleTime > 0)
+        {
+            glview->waitEvents(idleTime);
+            next = Clock::now();
+            continue;
+        }
 
-        director->mainLoop();
+        // the input is sampled right before the frame rather than before the sleep
         glview->pollEvents();
+        director->mainLoop();
 
-        curTime = getCurrentMillSecond();
-        if (curTime - lastTime < _animationInterval)
+        // the swap waited for the display already
+        if (glview->isPacedBySwaps())
+        {
+            next = Clock::now();
+            continue;
+        }
+
+        // the deadlines follow each other so the frames don't drift, a loop late by a whole frame starts over
+        const auto interval = std::chrono::microseconds(_animationInterval);
+        auto now = Clock::now();
+        next += interval;
+        if (next <= now)
+        {
+            next = now;
+            continue;
+        }
+        if (next - now > spin)
+        {
+            std::this_thread::sleep_for(next - now - spin);
+        }
+        while (Clock::now() < next)
         {
-            usleep(static_cast<useconds_t>((_animationInterval - curTime + lastTime)*1000));
+            std::this_thread::yield();
         }
     }
 
@@ -110,7 +131,7 @@ int Application::run()
 
 void Application::setAnimationInterval(float interval)
 {
-    _animationInterval = interval*1000.0f;
+    _animationInterval = interval*1000000.0f;
 }
 
 Application::Platform Application::getTargetPlatform()
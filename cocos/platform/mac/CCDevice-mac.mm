@@ -241,6 +241,19 @@ void Device::vibrate(float duration)
     CC_UNUSED_PARAM(duration);
 }
 
+Device::ThermalState Device::getThermalState()
+{
+#if defined(MAC_OS_X_VERSION_10_10_3) && MAC_OS_X_VERSION_MAX_ALLOWED >= MAC_OS_X_VERSION_10_10_3
+    NSProcessInfo* processInfo = [NSProcessInfo processInfo];
+    if ([processInfo respondsToSelector:@selector(thermalState)])
+    {
+        // the states are in the same order
+        return (ThermalState)[processInfo thermalState];
+    }
+#endif
+    return ThermalState::NOMINAL;
+}
+
 NS_CC_END
 
 #endif // CC_TARGET_PLATFORM == CC_PLATFORM_MAC
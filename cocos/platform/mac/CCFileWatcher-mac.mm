@@ -0,0 +1,118 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "platform/CCPlatformConfig.h"
+#if CC_TARGET_PLATFORM == CC_PLATFORM_MAC
+
+#include "base/CCFileWatcher.h"
+
+#if CC_ENABLE_FILE_WATCHER
+
+#include <CoreServices/CoreServices.h>
+#include <limits.h>
+#include <stdlib.h>
+
+NS_CC_BEGIN
+
+struct FileWatcher::Watch
+{
+    FSEventStreamRef stream;
+    // the directory as given and as FSEvents reports its files, with the symbolic links resolved
+    std::string directory;
+    std::string realDirectory;
+};
+
+static void fileEventsCallback(ConstFSEventStreamRef stream, void* info, size_t count, void* eventPaths,
+                               const FSEventStreamEventFlags flags[], const FSEventStreamEventId ids[])
+{
+    auto watch = static_cast<FileWatcher::Watch*>(info);
+    auto paths = static_cast<const char**>(eventPaths);
+    const FSEventStreamEventFlags changed = kFSEventStreamEventFlagItemCreated | kFSEventStreamEventFlagItemModified
+        | kFSEventStreamEventFlagItemRenamed;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (!(flags[i] & kFSEventStreamEventFlagItemIsFile) || !(flags[i] & changed))
+        {
+            continue;
+        }
+
+        std::string path = paths[i];
+        if (path.compare(0, watch->realDirectory.length(), watch->realDirectory) == 0)
+        {
+            path = watch->directory + path.substr(watch->realDirectory.length());
+        }
+        FileWatcher::getInstance()->onFileChanged(path);
+    }
+}
+
+FileWatcher::Watch* FileWatcher::watch(const std::string& directory)
+{
+    char realDirectory[PATH_MAX];
+    if (!realpath(directory.c_str(), realDirectory))
+    {
+        return nullptr;
+    }
+
+    auto watch = new (std::nothrow) Watch();
+    watch->directory = directory;
+    watch->realDirectory = std::string(realDirectory) + "/";
+
+    CFStringRef path = CFStringCreateWithCString(kCFAllocatorDefault, realDirectory, kCFStringEncodingUTF8);
+    CFArrayRef paths = CFArrayCreate(kCFAllocatorDefault, (const void**)&path, 1, &kCFTypeArrayCallBacks);
+    FSEventStreamContext context = {0, watch, nullptr, nullptr, nullptr};
+    // per file events, delivered on the main run loop
+    watch->stream = FSEventStreamCreate(kCFAllocatorDefault, &fileEventsCallback, &context, paths,
+                                        kFSEventStreamEventIdSinceNow, 0.05,
+                                        kFSEventStreamCreateFlagFileEvents | kFSEventStreamCreateFlagNoDefer);
+    CFRelease(paths);
+    CFRelease(path);
+
+    if (!watch->stream)
+    {
+        delete watch;
+        return nullptr;
+    }
+    FSEventStreamScheduleWithRunLoop(watch->stream, CFRunLoopGetMain(), kCFRunLoopDefaultMode);
+    if (!FSEventStreamStart(watch->stream))
+    {
+        unwatch(watch);
+        return nullptr;
+    }
+    return watch;
+}
+
+void FileWatcher::unwatch(Watch* watch)
+{
+    FSEventStreamStop(watch->stream);
+    FSEventStreamInvalidate(watch->stream);
+    FSEventStreamRelease(watch->stream);
+    delete watch;
+}
+
+NS_CC_END
+
+#endif // CC_ENABLE_FILE_WATCHER
+
+#endif // CC_TARGET_PLATFORM == CC_PLATFORM_MAC
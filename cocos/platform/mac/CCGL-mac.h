@@ -43,6 +43,21 @@ THE SOFTWARE.
 #define glDepthRangef                   glDepthRange
 #define glReleaseShaderCompiler(xxx)
 
+#define glDrawElementsInstanced         glDrawElementsInstancedARB
+#define glVertexAttribDivisor           glVertexAttribDivisorARB
+
+// the legacy (2.1) context doesn't expose ARB_map_buffer_range, the renderer keeps orphaning VBOs
+#define CC_GL_MAP_BUFFER_RANGE      0
+#define CC_GL_SYNC_OBJECTS          0
+#define CC_GL_INSTANCING            1
+// GL_EXT_timer_query, the queries themselves are core in 2.1
+#define CC_GL_TIMER_QUERY           1
+// pixel buffer objects are core in 2.1, without fences the readbacks wait a few frames
+#define CC_GL_PIXEL_BUFFER          1
+// ARB_get_program_binary needs a 4.1 core context
+#define CC_GL_PROGRAM_BINARY        0
+#define CC_GL_DISCARD_FRAMEBUFFER   0
+
 
 #endif // __PLATFORM_MAC_CCGL_H__
 
@@ -31,6 +31,9 @@ THE SOFTWARE.
 #include <algorithm>
 #include "platform/CCFileUtils.h"
 #include <shellapi.h>
+#include <mmsystem.h>
+
+#pragma comment(lib,"winmm.lib")
 /**
 @brief    This function change the PVRFrame show/hide setting in register.
 @param  bEnable If true show the PVRFrame window, otherwise hide.
@@ -63,10 +66,13 @@ int Application::run()
     PVRFrameEnableControlWindow(false);
 
     // Main message loop:
-    LARGE_INTEGER nLast;
+    LARGE_INTEGER nFreq;
+    LARGE_INTEGER nNext;
     LARGE_INTEGER nNow;
 
-    QueryPerformanceCounter(&nLast);
+    QueryPerformanceFrequency(&nFreq);
+    // Sleep() wakes up late by up to the timer resolution, so the last 2 ms before a frame are spun
+    const LONGLONG spinTicks = nFreq.QuadPart / 500;
 
     initGLContextAttrs();
 
@@ -82,22 +88,55 @@ int Application::run()
     // Retain glview to avoid glview being released in the while loop
     glview->retain();
 
+    timeBeginPeriod(1);
+    QueryPerformanceCounter(&nNext);
+
     while(!glview->windowShouldClose())
     {
-        QueryPerformanceCounter(&nNow);
-        if (nNow.QuadPart - nLast.QuadPart > _animationInterval.QuadPart)
+        // nothing to draw, wait for an event or the next timer instead of running frames
+        const float idleTime = director->getIdleTime();
+        if (idleTime > 0)
         {
-            nLast.QuadPart = nNow.QuadPart - (nNow.QuadPart % _animationInterval.QuadPart);
+            glview->waitEvents(idleTime);
+            QueryPerformanceCounter(&nNext);
+            continue;
+        }
 
+        // the swap waits for the display, see GLViewImpl::setSwapPacingEnabled()
+        if (glview->isPacedBySwaps())
+        {
+            glview->pollEvents();
             director->mainLoop();
+            QueryPerformanceCounter(&nNext);
+            continue;
+        }
+
+        QueryPerformanceCounter(&nNow);
+        if (nNow.QuadPart >= nNext.QuadPart)
+        {
+            // the deadlines follow each other so the frames don't drift, a loop late by a whole frame starts over
+            nNext.QuadPart += _animationInterval.QuadPart;
+            if (nNext.QuadPart <= nNow.QuadPart)
+            {
+                nNext.QuadPart = nNow.QuadPart + _animationInterval.QuadPart;
+            }
+
+            // the input is sampled right before the frame rather than before the sleep
             glview->pollEvents();
+            director->mainLoop();
         }
-        else
+        else if (nNext.QuadPart - nNow.QuadPart > spinTicks)
         {
             Sleep(1);
         }
+        else
+        {
+            Sleep(0);
+        }
     }
 
+    timeEndPeriod(1);
+
     // Director should still do a cleanup if the window was closed manually.
     if (glview->isOpenGLReady())
     {
@@ -501,6 +501,11 @@ void Device::vibrate(float duration)
     CC_UNUSED_PARAM(duration);
 }
 
+Device::ThermalState Device::getThermalState()
+{
+    return ThermalState::NOMINAL;
+}
+
 NS_CC_END
 
 #endif // CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
@@ -28,6 +28,7 @@ THE SOFTWARE.
 
 #include "CCFileUtils-win32.h"
 #include "platform/CCCommon.h"
+#include "base/CCAssetPack.h"
 #include <Shlobj.h>
 #include <cstdlib>
 #include <regex>
@@ -194,6 +195,14 @@ std::string FileUtilsWin32::getSuitableFOpen(const std::string& filenameUtf8) co
 
 long FileUtilsWin32::getFileSize(const std::string &filepath)
 {
+    std::string name;
+    AssetPack::Entry entry;
+    AssetPack* pack = findAssetPack(filepath, &name);
+    if (pack)
+    {
+        return pack->findEntry(name, &entry) ? (long)entry.size : 0;
+    }
+
     WIN32_FILE_ATTRIBUTE_DATA fad;
     if (!GetFileAttributesEx(StringUtf8ToWideChar(filepath).c_str(), GetFileExInfoStandard, &fad))
     {
@@ -352,7 +361,11 @@ static Data getData(const std::string& filename, bool forString)
 
 std::string FileUtilsWin32::getStringFromFile(const std::string& filename)
 {
-    Data data = getData(filename, true);
+    Data data;
+    if (!getDataFromAssetPack(filename, true, &data))
+    {
+        data = getData(filename, true);
+    }
     if (data.isNull())
     {
         return "";
@@ -362,8 +375,42 @@ std::string FileUtilsWin32::getStringFromFile(const std::string& filename)
     return ret;
 }
 
+FileView FileUtilsWin32::mapFile(const std::string& fullPath)
+{
+    HANDLE fileHandle = ::CreateFile(StringUtf8ToWideChar(fullPath).c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+        return FileView();
+    }
+
+    DWORD size = ::GetFileSize(fileHandle, nullptr);
+    HANDLE mappingHandle = (size > 0 && size != INVALID_FILE_SIZE) ? ::CreateFileMapping(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    // the mapping keeps the file open
+    ::CloseHandle(fileHandle);
+    if (mappingHandle == nullptr)
+    {
+        return FileView();
+    }
+
+    void* bytes = ::MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    ::CloseHandle(mappingHandle);
+    if (bytes == nullptr)
+    {
+        return FileView();
+    }
+
+    return FileView(static_cast<const unsigned char*>(bytes), size, [bytes]() {
+        ::UnmapViewOfFile(bytes);
+    });
+}
+
 Data FileUtilsWin32::getDataFromFile(const std::string& filename)
 {
+    Data data;
+    if (getDataFromAssetPack(filename, false, &data))
+    {
+        return data;
+    }
     return getData(filename, false);
 }
 
@@ -486,6 +533,8 @@ bool FileUtilsWin32::renameFile(const std::string &oldfullpath, const std::strin
     CCASSERT(!oldfullpath.empty(), "Invalid path");
     CCASSERT(!newfullpath.empty(), "Invalid path");
 
+    _missingFileCache.clear();
+
     std::wstring _wNew = StringUtf8ToWideChar(newfullpath);
     std::wstring _wOld = StringUtf8ToWideChar(oldfullpath);
 
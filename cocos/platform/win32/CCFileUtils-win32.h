@@ -129,6 +129,11 @@ protected:
      */
     virtual Data getDataFromFile(const std::string& filename) override;
 
+    /**
+     *  Maps a file with MapViewOfFile.
+     */
+    virtual FileView mapFile(const std::string& fullPath) override;
+
     /**
      *  Gets full path for filename, resolution directory and search path.
      *
@@ -0,0 +1,151 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "platform/CCPlatformConfig.h"
+#if CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
+
+#include "base/CCFileWatcher.h"
+
+#if CC_ENABLE_FILE_WATCHER
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include "platform/CCStdC.h"
+
+NS_CC_BEGIN
+
+struct FileWatcher::Watch
+{
+    HANDLE directoryHandle;
+    // signaled to stop the thread
+    HANDLE stopEvent;
+    std::thread thread;
+    std::string directory;
+};
+
+static std::wstring toWide(const std::string& text)
+{
+    int length = MultiByteToWideChar(CP_UTF8, 0, text.c_str(), (int)text.length(), nullptr, 0);
+    std::wstring ret(length, L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, text.c_str(), (int)text.length(), &ret[0], length);
+    return ret;
+}
+
+static std::string toUtf8(const WCHAR* text, int length)
+{
+    int size = WideCharToMultiByte(CP_UTF8, 0, text, length, nullptr, 0, nullptr, nullptr);
+    std::string ret(size, '\0');
+    WideCharToMultiByte(CP_UTF8, 0, text, length, &ret[0], size, nullptr, nullptr);
+    return ret;
+}
+
+static void watchDirectory(FileWatcher::Watch* watch)
+{
+    // DWORD aligned, as ReadDirectoryChangesW needs
+    std::vector<DWORD> buffer(16 * 1024);
+    OVERLAPPED overlapped = {0};
+    overlapped.hEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+    HANDLE events[2] = {overlapped.hEvent, watch->stopEvent};
+
+    while (true)
+    {
+        ResetEvent(overlapped.hEvent);
+        if (!ReadDirectoryChangesW(watch->directoryHandle, buffer.data(), (DWORD)(buffer.size() * sizeof(DWORD)), TRUE,
+                                   FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE,
+                                   nullptr, &overlapped, nullptr))
+        {
+            break;
+        }
+
+        DWORD bytes = 0;
+        if (WaitForMultipleObjects(2, events, FALSE, INFINITE) != WAIT_OBJECT_0)
+        {
+            CancelIo(watch->directoryHandle);
+            GetOverlappedResult(watch->directoryHandle, &overlapped, &bytes, TRUE);
+            break;
+        }
+        if (!GetOverlappedResult(watch->directoryHandle, &overlapped, &bytes, FALSE))
+        {
+            break;
+        }
+        // 0 when the buffer overflowed, the changes are lost
+        if (bytes == 0)
+        {
+            continue;
+        }
+
+        auto info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(buffer.data());
+        while (true)
+        {
+            if (info->Action == FILE_ACTION_ADDED || info->Action == FILE_ACTION_MODIFIED
+                || info->Action == FILE_ACTION_RENAMED_NEW_NAME)
+            {
+                std::string path = watch->directory + toUtf8(info->FileName, info->FileNameLength / sizeof(WCHAR));
+                std::replace(path.begin(), path.end(), '\\', '/');
+                FileWatcher::getInstance()->onFileChanged(path);
+            }
+            if (info->NextEntryOffset == 0)
+            {
+                break;
+            }
+            info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(reinterpret_cast<const char*>(info) + info->NextEntryOffset);
+        }
+    }
+
+    CloseHandle(overlapped.hEvent);
+}
+
+FileWatcher::Watch* FileWatcher::watch(const std::string& directory)
+{
+    HANDLE directoryHandle = CreateFileW(toWide(directory).c_str(), FILE_LIST_DIRECTORY,
+                                         FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                                         FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    if (directoryHandle == INVALID_HANDLE_VALUE)
+    {
+        return nullptr;
+    }
+
+    auto watch = new (std::nothrow) Watch();
+    watch->directoryHandle = directoryHandle;
+    watch->stopEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+    watch->directory = directory;
+    watch->thread = std::thread(&watchDirectory, watch);
+    return watch;
+}
+
+void FileWatcher::unwatch(Watch* watch)
+{
+    SetEvent(watch->stopEvent);
+    watch->thread.join();
+    CloseHandle(watch->stopEvent);
+    CloseHandle(watch->directoryHandle);
+    delete watch;
+}
+
+NS_CC_END
+
+#endif // CC_ENABLE_FILE_WATCHER
+
+#endif // CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
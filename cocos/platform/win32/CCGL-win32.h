@@ -33,6 +33,14 @@ THE SOFTWARE.
 
 #define CC_GL_DEPTH24_STENCIL8      GL_DEPTH24_STENCIL8
 
+#define CC_GL_MAP_BUFFER_RANGE      1
+#define CC_GL_SYNC_OBJECTS          1
+#define CC_GL_INSTANCING            1
+#define CC_GL_TIMER_QUERY           1
+#define CC_GL_PIXEL_BUFFER          1
+#define CC_GL_PROGRAM_BINARY        1
+#define CC_GL_DISCARD_FRAMEBUFFER   0
+
 #endif // CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
 
 #endif // __CCGL_H__
@@ -28,6 +28,8 @@ NS_CC_BEGIN
 
 CustomCommand::CustomCommand()
 : func(nullptr)
+, _callback(nullptr)
+, _callbackContext(nullptr)
 {
     _type = RenderCommand::Type::CUSTOM_COMMAND;
 }
@@ -49,7 +51,11 @@ CustomCommand::~CustomCommand()
 
 void CustomCommand::execute()
 {
-    if(func)
+    if(_callback)
+    {
+        _callback(_callbackContext);
+    }
+    else if(func)
     {
         func();
     }
@@ -60,6 +60,20 @@ public:
     */
     void init(float globalZOrder);
 
+    /**
+    Sets a callback that is a function pointer with its context, it's called instead of func.
+    It costs no allocation, unlike a std::function that captures more than a pointer, which suits the commands
+    created for one frame, see Renderer::createFrameCommand(). When the context was allocated with the command from
+    the frame arena too, the command doesn't read its node, so the render thread draws it without the main thread
+    waiting, see Renderer::setRenderThreadEnabled(). Passing nullptr goes back to func.
+    @since v3.11
+    */
+    void setCallback(void (*callback)(void*), void* context) { _callback = callback; _callbackContext = context; }
+    /**The function pointer callback, see setCallback().*/
+    void (*getCallback() const)(void*) { return _callback; }
+    /**The context of the function pointer callback, see setCallback().*/
+    void* getCallbackContext() const { return _callbackContext; }
+
     /**
     Execute the render command and call callback functions.
     */
@@ -70,6 +84,8 @@ public:
     std::function<void()> func;
 
 protected:
+    void (*_callback)(void*);
+    void* _callbackContext;
 };
 
 NS_CC_END
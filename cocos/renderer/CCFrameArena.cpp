@@ -0,0 +1,157 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "renderer/CCFrameArena.h"
+
+#include <algorithm>
+
+#include "base/ccMacros.h"
+
+NS_CC_BEGIN
+
+FrameArena::FrameArena()
+: _current(0)
+, _peakBlocks(0)
+, _usedSize(0)
+, _peakSize(0)
+, _shrinkRequested(false)
+{
+}
+
+FrameArena::~FrameArena()
+{
+    reset();
+    for (auto& block : _blocks)
+    {
+        delete[] block.data;
+    }
+}
+
+void* FrameArena::allocate(size_t size, size_t alignment)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // the blocks are aligned like new char[], the pointers are aligned within them
+    for (;; ++_current)
+    {
+        if (_current == _blocks.size())
+        {
+            Block block;
+            block.size = std::max(BLOCK_SIZE, size + alignment);
+            block.data = new (std::nothrow) char[block.size];
+            block.used = 0;
+            if (block.data == nullptr)
+            {
+                CCLOG("cocos2d: FrameArena: out of memory allocating %d bytes", (int)block.size);
+                return nullptr;
+            }
+            _blocks.push_back(block);
+        }
+
+        auto& block = _blocks[_current];
+        auto address = reinterpret_cast<uintptr_t>(block.data) + block.used;
+        size_t padding = (0 - address) & (alignment - 1);
+        if (block.used + padding + size <= block.size)
+        {
+            block.used += padding + size;
+            _usedSize += padding + size;
+            _peakSize = std::max(_peakSize, _usedSize);
+            return reinterpret_cast<void*>(address + padding);
+        }
+    }
+}
+
+void FrameArena::addDestructor(void (*destructor)(void*), void* object)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _destructors.emplace_back(destructor, object);
+}
+
+bool FrameArena::contains(const void* pointer) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto address = static_cast<const char*>(pointer);
+    for (size_t i = 0; i <= _current && i < _blocks.size(); ++i)
+    {
+        const auto& block = _blocks[i];
+        if (address >= block.data && address < block.data + block.used)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void FrameArena::reset()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for (auto iter = _destructors.rbegin(); iter != _destructors.rend(); ++iter)
+    {
+        iter->first(iter->second);
+    }
+    _destructors.clear();
+
+    if (_usedSize > 0)
+    {
+        _peakBlocks = std::max(_peakBlocks, _current + 1);
+    }
+    for (size_t i = 0; i <= _current && i < _blocks.size(); ++i)
+    {
+        _blocks[i].used = 0;
+    }
+    _current = 0;
+    _usedSize = 0;
+
+    if (_shrinkRequested)
+    {
+        for (size_t i = _peakBlocks; i < _blocks.size(); ++i)
+        {
+            delete[] _blocks[i].data;
+        }
+        _blocks.resize(std::min(_peakBlocks, _blocks.size()));
+        _peakBlocks = 0;
+        _peakSize = 0;
+        _shrinkRequested = false;
+    }
+}
+
+void FrameArena::shrinkToFit()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _shrinkRequested = true;
+}
+
+size_t FrameArena::getCapacity() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t capacity = 0;
+    for (const auto& block : _blocks)
+    {
+        capacity += block.size;
+    }
+    return capacity;
+}
+
+NS_CC_END
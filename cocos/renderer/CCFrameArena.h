@@ -0,0 +1,138 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#ifndef __CC_FRAME_ARENA_H__
+#define __CC_FRAME_ARENA_H__
+
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "platform/CCPlatformMacros.h"
+
+/**
+ * @addtogroup renderer
+ * @{
+ */
+
+NS_CC_BEGIN
+
+/**
+ FrameArena is the storage of the render commands and of their payloads that only live for one frame, see
+ Renderer::createFrameCommand(). It allocates linearly from blocks that are kept when it's reset, so once the
+ blocks fit the biggest frame, nothing is allocated anymore. The objects are destroyed by reset(), in reverse order.
+ It can be used from several threads at once, e.g. by a parallel visit.
+ @since v3.11
+ @js NA
+ @lua NA
+ */
+class CC_DLL FrameArena
+{
+public:
+    /** The size of the blocks, the allocations bigger than that get a block of their own. */
+    static const size_t BLOCK_SIZE = 64 * 1024;
+
+    FrameArena();
+    ~FrameArena();
+
+    /** Returns `size` bytes aligned on `alignment`, a power of 2. They are valid until reset(). */
+    void* allocate(size_t size, size_t alignment);
+
+    /** Constructs an object, it's destroyed by reset(). */
+    template <class T, class... Args>
+    T* create(Args&&... args)
+    {
+        void* memory = allocate(sizeof(T), alignof(T));
+        T* object = new (memory) T(std::forward<Args>(args)...);
+        if (!std::is_trivially_destructible<T>::value)
+        {
+            addDestructor(&destroy<T>, object);
+        }
+        return object;
+    }
+
+    /** Copies `count` elements, e.g. the vertices of a command. They aren't destroyed, they must hold no resources. */
+    template <class T>
+    T* copy(const T* data, size_t count)
+    {
+        T* result = static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+        std::uninitialized_copy(data, data + count, result);
+        return result;
+    }
+
+    /** Whether the memory was allocated by the arena since the last reset(). */
+    bool contains(const void* pointer) const;
+
+    /** Destroys the objects and rewinds the blocks, they are kept for the next frame. */
+    void reset();
+
+    /** Makes the next reset() free the blocks that weren't used since the previous shrink. */
+    void shrinkToFit();
+
+    /** The bytes allocated since the last reset(). */
+    size_t getUsedSize() const { return _usedSize; }
+    /** The most bytes allocated between two resets since the last shrinkToFit(). */
+    size_t getPeakSize() const { return _peakSize; }
+    /** The bytes of the blocks. */
+    size_t getCapacity() const;
+
+private:
+    struct Block
+    {
+        char* data;
+        size_t size;
+        size_t used;
+    };
+
+    template <class T>
+    static void destroy(void* object)
+    {
+        static_cast<T*>(object)->~T();
+    }
+
+    void addDestructor(void (*destructor)(void*), void* object);
+
+    std::vector<Block> _blocks;
+    // the block allocated from, the next ones are empty
+    size_t _current;
+    // the most blocks used in a frame since the last shrinkToFit()
+    size_t _peakBlocks;
+    std::vector<std::pair<void (*)(void*), void*>> _destructors;
+    size_t _usedSize;
+    size_t _peakSize;
+    bool _shrinkRequested;
+    mutable std::mutex _mutex;
+
+    CC_DISALLOW_COPY_AND_ASSIGN(FrameArena);
+};
+
+NS_CC_END
+
+/**
+ end of support group
+ @}
+ */
+#endif //__CC_FRAME_ARENA_H__
@@ -33,6 +33,7 @@ THE SOFTWARE.
 #endif
 
 #include "base/CCDirector.h"
+#include "base/CCConfiguration.h"
 #include "base/uthash.h"
 #include "base/CCString.h"
 #include "renderer/ccGLStateCache.h"
@@ -76,6 +77,14 @@ NS_CC_BEGIN
 
 const char* GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR = "ShaderPositionTextureColor";
 const char* GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP = "ShaderPositionTextureColor_noMVP";
+const char* GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_INSTANCED = "ShaderPositionTextureColor_instanced";
+const char* GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_MULTI_TEXTURE = "ShaderPositionTextureColor_multiTexture";
+const char* GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_OPAQUE = "ShaderPositionTextureColor_opaque";
+const char* GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_DEBUG = "ShaderPositionTextureColor_debug";
+const char* GLProgram::SHADER_NAME_PARTICLE_GPU = "ShaderParticleGPU";
+const char* GLProgram::SHADER_NAME_POST_PROCESS_BLUR = "ShaderPostProcessBlur";
+const char* GLProgram::SHADER_NAME_POST_PROCESS_BRIGHT_PASS = "ShaderPostProcessBrightPass";
+const char* GLProgram::SHADER_NAME_POST_PROCESS_COMPOSITE = "ShaderPostProcessComposite";
 const char* GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST = "ShaderPositionTextureColorAlphaTest";
 const char* GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST_NO_MV = "ShaderPositionTextureColorAlphaTest_NoMV";
 const char* GLProgram::SHADER_NAME_POSITION_COLOR = "ShaderPositionColor";
@@ -87,11 +96,15 @@ const char* GLProgram::SHADER_NAME_POSITION_TEXTURE_U_COLOR = "ShaderPositionTex
 const char* GLProgram::SHADER_NAME_POSITION_TEXTURE_A8_COLOR = "ShaderPositionTextureA8Color";
 const char* GLProgram::SHADER_NAME_POSITION_U_COLOR = "ShaderPosition_uColor";
 const char* GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR = "ShaderPositionLengthTextureColor";
+const char* GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR_NO_MVP = "ShaderPositionLengthTextureColor_noMVP";
 const char* GLProgram::SHADER_NAME_POSITION_GRAYSCALE = "ShaderUIGrayScale";
 const char* GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_NORMAL = "ShaderLabelDFNormal";
 const char* GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_GLOW = "ShaderLabelDFGlow";
+const char* GLProgram::SHADER_NAME_LABEL_MSDF = "ShaderLabelMSDF";
+const char* GLProgram::SHADER_NAME_LABEL_MSDF_GLOW = "ShaderLabelMSDFGlow";
 const char* GLProgram::SHADER_NAME_LABEL_NORMAL = "ShaderLabelNormal";
 const char* GLProgram::SHADER_NAME_LABEL_OUTLINE = "ShaderLabelOutline";
+const char* GLProgram::SHADER_NAME_LABEL_EFFECT = "ShaderLabelEffect";
 
 const char* GLProgram::SHADER_CAMERA_CLEAR = "ShaderCameraClear";
 
@@ -140,6 +153,35 @@ static const char * COCOS2D_SHADER_UNIFORMS =
 
 static const std::string EMPTY_DEFINE;
 
+// the time uniforms are shared by all the programs, computed once per frame
+struct FrameTimeUniforms
+{
+    unsigned int frame;
+    GLfloat time[4];
+    GLfloat sinTime[4];
+    GLfloat cosTime[4];
+};
+
+static const FrameTimeUniforms& getFrameTimeUniforms(Director* director)
+{
+    static FrameTimeUniforms uniforms = { (unsigned int)-1, { 0 }, { 0 }, { 0 } };
+
+    unsigned int frame = director->getTotalFrames();
+    if (uniforms.frame != frame)
+    {
+        // This doesn't give the most accurate global time value.
+        // Cocos2D doesn't store a high precision time value, so this will have to do.
+        // Getting Mach time per frame per shader using time could be extremely expensive.
+        float time = frame * director->getAnimationInterval();
+
+        uniforms.frame = frame;
+        uniforms.time[0] = time/10.0f; uniforms.time[1] = time; uniforms.time[2] = time*2; uniforms.time[3] = time*4;
+        uniforms.sinTime[0] = time/8.0f; uniforms.sinTime[1] = time/4.0f; uniforms.sinTime[2] = time/2.0f; uniforms.sinTime[3] = sinf(time);
+        uniforms.cosTime[0] = time/8.0f; uniforms.cosTime[1] = time/4.0f; uniforms.cosTime[2] = time/2.0f; uniforms.cosTime[3] = cosf(time);
+    }
+    return uniforms;
+}
+
 GLProgram* GLProgram::createWithByteArrays(const GLchar* vShaderByteArray, const GLchar* fShaderByteArray)
 {
     return createWithByteArrays(vShaderByteArray, fShaderByteArray, EMPTY_DEFINE);
@@ -185,6 +227,8 @@ GLProgram::GLProgram()
 , _vertShader(0)
 , _fragShader(0)
 , _flags()
+, _builtinMatricesSet(false)
+, _builtinTimeFrame((unsigned int)-1)
 {
     _director = Director::DirectorInstance;
     CCASSERT(nullptr != _director, "Director is null when init a GLProgram");
@@ -263,6 +307,78 @@ bool GLProgram::initWithByteArrays(const GLchar* vShaderByteArray, const GLchar*
     return true;
 }
 
+bool GLProgram::initWithProgramBinary(GLenum binaryFormat, const void* binary, GLsizei length)
+{
+#if CC_GL_PROGRAM_BINARY
+    if (!Configuration::getInstance()->supportsProgramBinary())
+    {
+        return false;
+    }
+
+    _program = glCreateProgram();
+    _vertShader = _fragShader = 0;
+    _hashForUniforms.clear();
+
+    glProgramBinary(_program, binaryFormat, binary, length);
+
+    // a binary of another driver or GPU fails to link, it isn't an error
+    GLint status = GL_FALSE;
+    glGetProgramiv(_program, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE)
+    {
+        GL::deleteProgram(_program);
+        _program = 0;
+        glGetError();
+        return false;
+    }
+
+    parseVertexAttribs();
+    parseUniforms();
+
+    CHECK_GL_ERROR_DEBUG();
+
+    return true;
+#else
+    CC_UNUSED_PARAM(binaryFormat);
+    CC_UNUSED_PARAM(binary);
+    CC_UNUSED_PARAM(length);
+    return false;
+#endif
+}
+
+Data GLProgram::getProgramBinary(GLenum& binaryFormat) const
+{
+    Data ret;
+#if CC_GL_PROGRAM_BINARY
+    if (!_program || !Configuration::getInstance()->supportsProgramBinary())
+    {
+        return ret;
+    }
+
+    GLint length = 0;
+    glGetProgramiv(_program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+    {
+        return ret;
+    }
+
+    unsigned char* bytes = (unsigned char*)malloc(length);
+    GLsizei written = 0;
+    glGetProgramBinary(_program, length, &written, &binaryFormat, bytes);
+    if (written > 0)
+    {
+        ret.fastSet(bytes, written);
+    }
+    else
+    {
+        free(bytes);
+    }
+#else
+    CC_UNUSED_PARAM(binaryFormat);
+#endif
+    return ret;
+}
+
 bool GLProgram::initWithFilenames(const std::string& vShaderFilename, const std::string& fShaderFilename)
 {
     return initWithFilenames(vShaderFilename, fShaderFilename, EMPTY_DEFINE);
@@ -356,6 +472,8 @@ void GLProgram::parseUniforms()
         if(length > 0)
         {
             Uniform uniform;
+            // the values of the program are unknown after a link
+            uniform.serial = 0;
 
             GLchar* uniformName = (GLchar*)alloca(length + 1);
 
@@ -546,6 +664,14 @@ bool GLProgram::link()
 
     bindPredefinedVertexAttribs();
 
+#if CC_GL_PROGRAM_BINARY && defined(GL_PROGRAM_BINARY_RETRIEVABLE_HINT)
+    // desktop drivers may only keep the binary of the programs that asked for it before linking
+    if (Configuration::getInstance()->supportsProgramBinary())
+    {
+        glProgramParameteri(_program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+#endif
+
     glLinkProgram(_program);
 
     parseVertexAttribs();
@@ -868,6 +994,34 @@ void GLProgram::setUniformsForBuiltins(const Mat4 &matrixMV)
 {
     const auto& matrixP = _director->getMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION);
 
+    // the batches of a frame mostly share the projection and an identity model view,
+    // the program keeps the values until they change
+    bool matricesSet = _builtinMatricesSet
+        && memcmp(matrixMV.m, _builtinModelView.m, sizeof(matrixMV.m)) == 0
+        && memcmp(matrixP.m, _builtinProjection.m, sizeof(matrixP.m)) == 0;
+    if (!matricesSet)
+    {
+        _builtinMatricesSet = true;
+        _builtinProjection = matrixP;
+        _builtinModelView = matrixMV;
+        setUniformsForMatrices(matrixP, matrixMV);
+    }
+
+    if (_flags.usesTime && _builtinTimeFrame != _director->getTotalFrames())
+    {
+        const auto& frameTime = getFrameTimeUniforms(_director);
+        _builtinTimeFrame = frameTime.frame;
+        setUniformLocationWith4fv(_builtInUniforms[GLProgram::UNIFORM_TIME], frameTime.time, 1);
+        setUniformLocationWith4fv(_builtInUniforms[GLProgram::UNIFORM_SIN_TIME], frameTime.sinTime, 1);
+        setUniformLocationWith4fv(_builtInUniforms[GLProgram::UNIFORM_COS_TIME], frameTime.cosTime, 1);
+    }
+
+    if (_flags.usesRandom)
+        setUniformLocationWith4f(_builtInUniforms[GLProgram::UNIFORM_RANDOM01], CCRANDOM_0_1(), CCRANDOM_0_1(), CCRANDOM_0_1(), CCRANDOM_0_1());
+}
+
+void GLProgram::setUniformsForMatrices(const Mat4 &matrixP, const Mat4 &matrixMV)
+{
     if (_flags.usesP)
         setUniformLocationWithMatrix4fv(_builtInUniforms[UNIFORM_P_MATRIX], matrixP.m, 1);
 
@@ -892,20 +1046,6 @@ void GLProgram::setUniformsForBuiltins(const Mat4 &matrixMV)
         normalMat[6] = mvInverse.m[8];normalMat[7] = mvInverse.m[9];normalMat[8] = mvInverse.m[10];
         setUniformLocationWithMatrix3fv(_builtInUniforms[UNIFORM_NORMAL_MATRIX], normalMat, 1);
     }
-
-    if (_flags.usesTime) {
-        // This doesn't give the most accurate global time value.
-        // Cocos2D doesn't store a high precision time value, so this will have to do.
-        // Getting Mach time per frame per shader using time could be extremely expensive.
-        float time = _director->getTotalFrames() * _director->getAnimationInterval();
-
-        setUniformLocationWith4f(_builtInUniforms[GLProgram::UNIFORM_TIME], time/10.0, time, time*2, time*4);
-        setUniformLocationWith4f(_builtInUniforms[GLProgram::UNIFORM_SIN_TIME], time/8.0, time/4.0, time/2.0, sinf(time));
-        setUniformLocationWith4f(_builtInUniforms[GLProgram::UNIFORM_COS_TIME], time/8.0, time/4.0, time/2.0, cosf(time));
-    }
-
-    if (_flags.usesRandom)
-        setUniformLocationWith4f(_builtInUniforms[GLProgram::UNIFORM_RANDOM01], CCRANDOM_0_1(), CCRANDOM_0_1(), CCRANDOM_0_1(), CCRANDOM_0_1());
 }
 
 void GLProgram::reset()
@@ -924,6 +1064,10 @@ void GLProgram::reset()
     }
 
     _hashForUniforms.clear();
+
+    // the relinked program has none of the values
+    _builtinMatricesSet = false;
+    _builtinTimeFrame = (unsigned int)-1;
 }
 
 void GLProgram::clearShader()
@@ -35,6 +35,7 @@ THE SOFTWARE.
 
 #include "base/ccMacros.h"
 #include "base/CCRef.h"
+#include "base/CCData.h"
 #include "base/ccTypes.h"
 #include "platform/CCGL.h"
 #include "math/CCMath.h"
@@ -75,6 +76,8 @@ struct Uniform
     GLenum type;
     /**String of the uniform name.*/
     std::string name;
+    /**Identifies the last UniformValue uploaded to the location, 0 if unknown, see UniformValue::apply.*/
+    unsigned int serial;
 };
 
 /** GLProgram
@@ -169,6 +172,37 @@ public:
     static const char* SHADER_NAME_POSITION_TEXTURE_COLOR;
     /**Built in shader for 2d. Support Position, Texture and Color vertex attribute, but without multiply vertex by MVP matrix.*/
     static const char* SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP;
+    /**Built in shader for 2d. Draws instanced quads, the unit quad corner is the position and the quad geometry is per instance.
+     Only loaded when Configuration::supportsInstancing() is true.
+     @since v3.11
+     */
+    static const char* SHADER_NAME_POSITION_TEXTURE_COLOR_INSTANCED;
+    /**Built in shader for 2d. Like SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP, a_texCoord1 picks one of the u_textures samplers per vertex.
+     Used by the multi texture batches of the Renderer.
+     @since v3.11
+     */
+    static const char* SHADER_NAME_POSITION_TEXTURE_COLOR_MULTI_TEXTURE;
+    /**Built in shader for 2d. Like SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP, a_position.z is the depth of the vertex.
+     Used by the opaque pass of the Renderer.
+     @since v3.11
+     */
+    static const char* SHADER_NAME_POSITION_TEXTURE_COLOR_OPAQUE;
+    /**Built in shader for 2d. Like SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP, fills with u_debugColor, scaled by the texture alpha
+     when u_textureAlpha is 1. Used by the debug modes of the Renderer.
+     @since v3.11
+     */
+    static const char* SHADER_NAME_POSITION_TEXTURE_COLOR_DEBUG;
+    /**Built in shader for 2d. Evaluates the particles of a ParticleSystemGPU from their slot and the emitter uniforms.
+     @since v3.11
+     */
+    static const char* SHADER_NAME_PARTICLE_GPU;
+    /**Built in shaders of the PostProcessStack: a separable gaussian blur pass, the bright pass of the bloom and the final
+     pass adding the bloom, grading the colors and darkening the borders. They draw a quad given in clip space.
+     @since v3.11
+     */
+    static const char* SHADER_NAME_POST_PROCESS_BLUR;
+    static const char* SHADER_NAME_POST_PROCESS_BRIGHT_PASS;
+    static const char* SHADER_NAME_POST_PROCESS_COMPOSITE;
     /**Built in shader for 2d. Support Position, Texture vertex attribute, but include alpha test.*/
     static const char* SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST;
     /**Built in shader for 2d. Support Position, Texture and Color vertex attribute, include alpha test and without multiply vertex by MVP matrix.*/
@@ -189,6 +223,10 @@ public:
     static const char* SHADER_NAME_POSITION_U_COLOR;
     /**Built in shader for draw a sector with 90 degrees with center at bottom left point.*/
     static const char* SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR;
+    /**Built in shader for draw a sector with 90 degrees with center at bottom left point, without multiply vertex by MVP matrix.
+     @since v3.11
+     */
+    static const char* SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR_NO_MVP;
 
     /**Built in shader for ui effects */
     static const char* SHADER_NAME_POSITION_GRAYSCALE;
@@ -197,8 +235,14 @@ public:
     */
     static const char* SHADER_NAME_LABEL_NORMAL;
     static const char* SHADER_NAME_LABEL_OUTLINE;
+    /** The outline and the shadow of a label drawn with its text, as layers of quads, see Label::setSinglePassEffectsEnabled().
+     @since v3.11
+     */
+    static const char* SHADER_NAME_LABEL_EFFECT;
     static const char* SHADER_NAME_LABEL_DISTANCEFIELD_NORMAL;
     static const char* SHADER_NAME_LABEL_DISTANCEFIELD_GLOW;
+    static const char* SHADER_NAME_LABEL_MSDF;
+    static const char* SHADER_NAME_LABEL_MSDF_GLOW;
 
     /**
      Built in shader for camera clear
@@ -291,6 +335,21 @@ public:
     /**
     @}
     */
+
+    /**
+     * Initializes the GLProgram with a binary of getProgramBinary(), instead of compiling and linking its sources.
+     * The program is linked when it returns true, only updateUniforms() is left to call.
+     * It returns false if the driver rejects the binary, e.g. after an update, the sources have to be compiled then.
+     * @since v3.11
+     */
+    bool initWithProgramBinary(GLenum binaryFormat, const void* binary, GLsizei length);
+    /**
+     * Gets the binary of the linked program, to give to initWithProgramBinary() in a later run.
+     * It is null if Configuration::supportsProgramBinary() is false.
+     * @since v3.11
+     */
+    Data getProgramBinary(GLenum& binaryFormat) const;
+
     /** @{
     Create or Initializes the GLProgram with a vertex and fragment with contents of filenames.
      * @js init
@@ -454,6 +513,7 @@ protected:
     /**Parse user defined uniform automatically.*/
     void parseUniforms();
     /**Compile the shader sources.*/
+    void setUniformsForMatrices(const Mat4 &matrixP, const Mat4 &matrixMV);
     bool compileShader(GLuint * shader, GLenum type, const GLchar* source, const std::string& convertedDefines);
     bool compileShader(GLuint * shader, GLenum type, const GLchar* source);
     void clearShader();
@@ -480,6 +540,13 @@ protected:
 
     /*needed uniforms*/
     UniformFlags _flags;
+
+    /**The matrices the built in uniforms were last set from, setUniformsForBuiltins() skips them while they are the same.*/
+    bool              _builtinMatricesSet;
+    Mat4              _builtinProjection;
+    Mat4              _builtinModelView;
+    /**The frame the time uniforms were last set for.*/
+    unsigned int      _builtinTimeFrame;
 };
 
 NS_CC_END
@@ -34,6 +34,10 @@ THE SOFTWARE.
 #include "base/CCEventListenerCustom.h"
 #include "base/CCDirector.h"
 #include "base/CCEventDispatcher.h"
+#include "base/CCAssetPack.h"
+#include "base/CCAsyncTaskPool.h"
+#include "base/CCString.h"
+#include "platform/CCFileUtils.h"
 
 NS_CC_BEGIN
 
@@ -50,12 +54,24 @@ enum {
     kShaderType_PositionTextureA8Color,
     kShaderType_Position_uColor,
     kShaderType_PositionLengthTexureColor,
+    kShaderType_PositionLengthTexureColor_noMVP,
     kShaderType_LabelDistanceFieldNormal,
     kShaderType_LabelDistanceFieldGlow,
+    kShaderType_LabelMSDF,
+    kShaderType_LabelMSDFGlow,
     kShaderType_UIGrayScale,
     kShaderType_LabelNormal,
     kShaderType_LabelOutline,
+    kShaderType_LabelEffect,
     kShaderType_CameraClear,
+    kShaderType_PositionTextureColor_instanced,
+    kShaderType_PositionTextureColor_multiTexture,
+    kShaderType_PositionTextureColor_opaque,
+    kShaderType_PositionTextureColor_debug,
+    kShaderType_ParticleGPU,
+    kShaderType_PostProcessBlur,
+    kShaderType_PostProcessBrightPass,
+    kShaderType_PostProcessComposite,
     kShaderType_MAX,
 };
 
@@ -93,6 +109,147 @@ GLProgramCache::~GLProgramCache()
     CCLOGINFO("deallocing GLProgramCache: %p", this);
 }
 
+// the files of the program binary cache, "shadercache/<source hash>.glpb" in the writable path:
+// this header, then the binary of glGetProgramBinary()
+struct ProgramBinaryHeader
+{
+    char            magic[4];
+    unsigned int    version;
+    unsigned int    driverHash;
+    unsigned int    sourceHash;
+    unsigned int    binaryFormat;
+    unsigned int    binaryLength;
+};
+
+static const char PROGRAM_BINARY_MAGIC[4] = {'C', 'C', 'P', 'B'};
+// bump it when the preamble that GLProgram::compileShader() adds to the sources changes
+static const unsigned int PROGRAM_BINARY_VERSION = 1;
+
+static bool s_binaryCacheEnabled = true;
+
+static bool isProgramBinaryCacheUsable()
+{
+    return s_binaryCacheEnabled && Configuration::getInstance()->supportsProgramBinary();
+}
+
+static unsigned int getDriverHash()
+{
+    // the binaries of another driver version are rejected at best, the hash tells them apart before
+    static unsigned int driverHash = 0;
+    if (driverHash == 0)
+    {
+        std::string driver;
+        const GLenum names[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+        for (GLenum name : names)
+        {
+            const char* value = (const char*)glGetString(name);
+            if (value)
+            {
+                driver.append(value).append("\n");
+            }
+        }
+        driverHash = AssetPack::hash(driver.c_str(), driver.length()) | 1;
+    }
+    return driverHash;
+}
+
+static unsigned int hashProgramSources(int type, const GLchar* vert, const GLchar* frag)
+{
+    // the type is part of it, a program may bind its own attribute locations, which the binary keeps
+    std::string sources = StringUtils::format("%d\n", type);
+    sources.append(vert).append("\n").append(frag);
+    return AssetPack::hash(sources.c_str(), sources.length());
+}
+
+static std::string getProgramBinaryPath(unsigned int sourceHash)
+{
+    char fileName[16];
+    snprintf(fileName, sizeof(fileName), "%08x.glpb", sourceHash);
+    return FileUtils::getInstance()->getWritablePath() + "shadercache/" + fileName;
+}
+
+static bool loadProgramBinary(GLProgram* program, unsigned int sourceHash)
+{
+    if (!isProgramBinaryCacheUsable())
+    {
+        return false;
+    }
+
+    auto fileUtils = FileUtils::getInstance();
+    std::string path = getProgramBinaryPath(sourceHash);
+    if (!fileUtils->isFileExist(path))
+    {
+        return false;
+    }
+
+    FileView view = fileUtils->getFileView(path);
+    ProgramBinaryHeader header;
+    if (view.isNull() || view.getSize() < (ssize_t)sizeof(header))
+    {
+        return false;
+    }
+    memcpy(&header, view.getBytes(), sizeof(header));
+
+    // a file of another driver or a partly written one is compiled again and replaced
+    if (memcmp(header.magic, PROGRAM_BINARY_MAGIC, sizeof(header.magic)) != 0
+        || header.version != PROGRAM_BINARY_VERSION
+        || header.driverHash != getDriverHash()
+        || header.sourceHash != sourceHash
+        || header.binaryLength != view.getSize() - sizeof(header))
+    {
+        return false;
+    }
+
+    if (!program->initWithProgramBinary(header.binaryFormat, view.getBytes() + sizeof(header), header.binaryLength))
+    {
+        CCLOG("cocos2d: GLProgramCache: the driver rejected %s", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+static void saveProgramBinary(GLProgram* program, unsigned int sourceHash)
+{
+    if (!isProgramBinaryCacheUsable())
+    {
+        return;
+    }
+
+    GLenum binaryFormat = 0;
+    Data binary = program->getProgramBinary(binaryFormat);
+    if (binary.isNull())
+    {
+        return;
+    }
+
+    ProgramBinaryHeader header;
+    memcpy(header.magic, PROGRAM_BINARY_MAGIC, sizeof(header.magic));
+    header.version = PROGRAM_BINARY_VERSION;
+    header.driverHash = getDriverHash();
+    header.sourceHash = sourceHash;
+    header.binaryFormat = binaryFormat;
+    header.binaryLength = (unsigned int)binary.getSize();
+
+    ssize_t size = sizeof(header) + binary.getSize();
+    unsigned char* bytes = (unsigned char*)malloc(size);
+    memcpy(bytes, &header, sizeof(header));
+    memcpy(bytes + sizeof(header), binary.getBytes(), binary.getSize());
+    Data data;
+    data.fastSet(bytes, size);
+
+    // the file is only read by the next runs, it is written by a worker
+    std::string path = getProgramBinaryPath(sourceHash);
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO, [](void*){}, nullptr, [data, path]()
+    {
+        auto fileUtils = FileUtils::getInstance();
+        std::string directory = path.substr(0, path.rfind('/') + 1);
+        if (!fileUtils->createDirectory(directory) || !fileUtils->writeDataToFile(data, path))
+        {
+            CCLOG("cocos2d: GLProgramCache: can not write %s", path.c_str());
+        }
+    });
+}
+
 bool GLProgramCache::init()
 {
     loadDefaultGLPrograms();
@@ -106,201 +263,70 @@ bool GLProgramCache::init()
     return true;
 }
 
+void GLProgramCache::setBinaryCacheEnabled(bool enabled)
+{
+    s_binaryCacheEnabled = enabled;
+}
+
+bool GLProgramCache::isBinaryCacheEnabled()
+{
+    return s_binaryCacheEnabled;
+}
+
 void GLProgramCache::loadDefaultGLPrograms()
 {
-    // Position Texture Color shader
-    GLProgram *p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionTextureColor);
-    _programs.insert( std::make_pair( GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR, p ) );
-
-    // Position Texture Color without MVP shader
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionTextureColor_noMVP);
-    _programs.insert( std::make_pair( GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP, p ) );
-
-    // Position Texture Color alpha test
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionTextureColorAlphaTest);
-    _programs.insert( std::make_pair(GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST, p) );
-
-    // Position Texture Color alpha test
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionTextureColorAlphaTestNoMV);
-    _programs.insert( std::make_pair(GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST_NO_MV, p) );
-    //
-    // Position, Color shader
-    //
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionColor);
-    _programs.insert( std::make_pair(GLProgram::SHADER_NAME_POSITION_COLOR, p) );
-
-    // Position, Color, PointSize shader
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionColorTextureAsPointsize);
-    _programs.insert( std::make_pair(GLProgram::SHADER_NAME_POSITION_COLOR_TEXASPOINTSIZE, p) );
-
-    //
-    // Position, Color shader no MVP
-    //
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionColor_noMVP);
-    _programs.insert( std::make_pair(GLProgram::SHADER_NAME_POSITION_COLOR_NO_MVP, p) );
-
-    //
-    // Position Texture shader
-    //
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionTexture);
-    _programs.insert( std::make_pair( GLProgram::SHADER_NAME_POSITION_TEXTURE, p) );
-
-    //
-    // Position, Texture attribs, 1 Color as uniform shader
-    //
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionTexture_uColor);
-    _programs.insert( std::make_pair( GLProgram::SHADER_NAME_POSITION_TEXTURE_U_COLOR, p) );
-
-    //
-    // Position Texture A8 Color shader
-    //
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionTextureA8Color);
-    _programs.insert( std::make_pair(GLProgram::SHADER_NAME_POSITION_TEXTURE_A8_COLOR, p) );
-
-    //
-    // Position and 1 color passed as a uniform (to simulate glColor4ub )
-    //
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_Position_uColor);
-    _programs.insert( std::make_pair(GLProgram::SHADER_NAME_POSITION_U_COLOR, p) );
-
-    //
-    // Position, Length(TexCoords, Color (used by Draw Node basically )
-    //
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionLengthTexureColor);
-    _programs.insert( std::make_pair(GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR, p) );
-
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_LabelDistanceFieldNormal);
-    _programs.insert( std::make_pair(GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_NORMAL, p) );
-
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_LabelDistanceFieldGlow);
-    _programs.insert( std::make_pair(GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_GLOW, p) );
-
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_UIGrayScale);
-    _programs.insert(std::make_pair(GLProgram::SHADER_NAME_POSITION_GRAYSCALE, p));
-
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_LabelNormal);
-    _programs.insert( std::make_pair(GLProgram::SHADER_NAME_LABEL_NORMAL, p) );
-
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_LabelOutline);
-    _programs.insert( std::make_pair(GLProgram::SHADER_NAME_LABEL_OUTLINE, p) );
-
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_CameraClear);
-    _programs.insert(std::make_pair(GLProgram::SHADER_CAMERA_CLEAR, p));
+    // the programs are compiled by getGLProgram(), the first time they are asked for
+    _defaultPrograms[GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR] = kShaderType_PositionTextureColor;
+    _defaultPrograms[GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP] = kShaderType_PositionTextureColor_noMVP;
+    _defaultPrograms[GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST] = kShaderType_PositionTextureColorAlphaTest;
+    _defaultPrograms[GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST_NO_MV] = kShaderType_PositionTextureColorAlphaTestNoMV;
+    _defaultPrograms[GLProgram::SHADER_NAME_POSITION_COLOR] = kShaderType_PositionColor;
+    _defaultPrograms[GLProgram::SHADER_NAME_POSITION_COLOR_TEXASPOINTSIZE] = kShaderType_PositionColorTextureAsPointsize;
+    _defaultPrograms[GLProgram::SHADER_NAME_POSITION_COLOR_NO_MVP] = kShaderType_PositionColor_noMVP;
+    _defaultPrograms[GLProgram::SHADER_NAME_POSITION_TEXTURE] = kShaderType_PositionTexture;
+    _defaultPrograms[GLProgram::SHADER_NAME_POSITION_TEXTURE_U_COLOR] = kShaderType_PositionTexture_uColor;
+    _defaultPrograms[GLProgram::SHADER_NAME_POSITION_TEXTURE_A8_COLOR] = kShaderType_PositionTextureA8Color;
+    _defaultPrograms[GLProgram::SHADER_NAME_POSITION_U_COLOR] = kShaderType_Position_uColor;
+    _defaultPrograms[GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR] = kShaderType_PositionLengthTexureColor;
+    _defaultPrograms[GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR_NO_MVP] = kShaderType_PositionLengthTexureColor_noMVP;
+    _defaultPrograms[GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_NORMAL] = kShaderType_LabelDistanceFieldNormal;
+    _defaultPrograms[GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_GLOW] = kShaderType_LabelDistanceFieldGlow;
+    _defaultPrograms[GLProgram::SHADER_NAME_LABEL_MSDF] = kShaderType_LabelMSDF;
+    _defaultPrograms[GLProgram::SHADER_NAME_LABEL_MSDF_GLOW] = kShaderType_LabelMSDFGlow;
+    _defaultPrograms[GLProgram::SHADER_NAME_POSITION_GRAYSCALE] = kShaderType_UIGrayScale;
+    _defaultPrograms[GLProgram::SHADER_NAME_LABEL_NORMAL] = kShaderType_LabelNormal;
+    _defaultPrograms[GLProgram::SHADER_NAME_LABEL_OUTLINE] = kShaderType_LabelOutline;
+    _defaultPrograms[GLProgram::SHADER_NAME_LABEL_EFFECT] = kShaderType_LabelEffect;
+    _defaultPrograms[GLProgram::SHADER_CAMERA_CLEAR] = kShaderType_CameraClear;
+
+    // Position Texture Color for instanced quads, needs instanced arrays
+    if (Configuration::getInstance()->supportsInstancing())
+    {
+        _defaultPrograms[GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_INSTANCED] = kShaderType_PositionTextureColor_instanced;
+    }
+    _defaultPrograms[GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_MULTI_TEXTURE] = kShaderType_PositionTextureColor_multiTexture;
+    _defaultPrograms[GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_OPAQUE] = kShaderType_PositionTextureColor_opaque;
+    _defaultPrograms[GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_DEBUG] = kShaderType_PositionTextureColor_debug;
+
+    _defaultPrograms[GLProgram::SHADER_NAME_PARTICLE_GPU] = kShaderType_ParticleGPU;
+
+    _defaultPrograms[GLProgram::SHADER_NAME_POST_PROCESS_BLUR] = kShaderType_PostProcessBlur;
+    _defaultPrograms[GLProgram::SHADER_NAME_POST_PROCESS_BRIGHT_PASS] = kShaderType_PostProcessBrightPass;
+    _defaultPrograms[GLProgram::SHADER_NAME_POST_PROCESS_COMPOSITE] = kShaderType_PostProcessComposite;
 }
 
 void GLProgramCache::reloadDefaultGLPrograms()
 {
-    // reset all programs and reload them
-
-    // Position Texture Color shader
-    GLProgram *p = getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_PositionTextureColor);
-
-    // Position Texture Color without MVP shader
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_PositionTextureColor_noMVP);
-
-    // Position Texture Color alpha test
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_PositionTextureColorAlphaTest);
-
-    // Position Texture Color alpha test
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST_NO_MV);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_PositionTextureColorAlphaTestNoMV);
-    //
-    // Position, Color shader
-    //
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_COLOR);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_PositionColor);
-
-    // Position, Color, PointSize shader
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_COLOR_TEXASPOINTSIZE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_PositionColorTextureAsPointsize);
-
-    //
-    // Position, Color shader no MVP
-    //
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_COLOR_NO_MVP);
-    loadDefaultGLProgram(p, kShaderType_PositionColor_noMVP);
-
-    //
-    // Position Texture shader
-    //
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_PositionTexture);
-
-    //
-    // Position, Texture attribs, 1 Color as uniform shader
-    //
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_U_COLOR);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_PositionTexture_uColor);
-
-    //
-    // Position Texture A8 Color shader
-    //
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_A8_COLOR);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_PositionTextureA8Color);
-
-    //
-    // Position and 1 color passed as a uniform (to simulate glColor4ub )
-    //
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_U_COLOR);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_Position_uColor);
-
-    //
-    // Position, Length(TexCoords, Color (used by Draw Node basically )
-    //
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_PositionLengthTexureColor);
-
-    p = getGLProgram(GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_NORMAL);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_LabelDistanceFieldNormal);
-
-    p = getGLProgram(GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_GLOW);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_LabelDistanceFieldGlow);
-
-    p = getGLProgram(GLProgram::SHADER_NAME_LABEL_NORMAL);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_LabelNormal);
-
-    p = getGLProgram(GLProgram::SHADER_NAME_LABEL_OUTLINE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_LabelOutline);
-
-    p = getGLProgram(GLProgram::SHADER_CAMERA_CLEAR);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_CameraClear);
+    // reset the programs compiled so far and reload them, the others are still compiled on first use
+    for (const auto& defaultProgram : _defaultPrograms)
+    {
+        auto it = _programs.find(defaultProgram.first);
+        if (it != _programs.end())
+        {
+            it->second->reset();
+            loadDefaultGLProgram(it->second, defaultProgram.second);
+        }
+    }
 }
 
 void GLProgramCache::reloadDefaultGLProgramsRelativeToLights()
@@ -309,71 +335,124 @@ void GLProgramCache::reloadDefaultGLProgramsRelativeToLights()
 
 void GLProgramCache::loadDefaultGLProgram(GLProgram *p, int type)
 {
+    const GLchar* vert = nullptr;
+    const GLchar* frag = nullptr;
+
     switch (type) {
         case kShaderType_PositionTextureColor:
-            p->initWithByteArrays(ccPositionTextureColor_vert, ccPositionTextureColor_frag);
+            vert = ccPositionTextureColor_vert; frag = ccPositionTextureColor_frag;
             break;
         case kShaderType_PositionTextureColor_noMVP:
-            p->initWithByteArrays(ccPositionTextureColor_noMVP_vert, ccPositionTextureColor_noMVP_frag);
+            vert = ccPositionTextureColor_noMVP_vert; frag = ccPositionTextureColor_noMVP_frag;
             break;
         case kShaderType_PositionTextureColorAlphaTest:
-            p->initWithByteArrays(ccPositionTextureColor_vert, ccPositionTextureColorAlphaTest_frag);
+            vert = ccPositionTextureColor_vert; frag = ccPositionTextureColorAlphaTest_frag;
             break;
         case kShaderType_PositionTextureColorAlphaTestNoMV:
-            p->initWithByteArrays(ccPositionTextureColor_noMVP_vert, ccPositionTextureColorAlphaTest_frag);
+            vert = ccPositionTextureColor_noMVP_vert; frag = ccPositionTextureColorAlphaTest_frag;
             break;
         case kShaderType_PositionColor:
-            p->initWithByteArrays(ccPositionColor_vert ,ccPositionColor_frag);
+            vert = ccPositionColor_vert; frag = ccPositionColor_frag;
             break;
         case kShaderType_PositionColorTextureAsPointsize:
-            p->initWithByteArrays(ccPositionColorTextureAsPointsize_vert ,ccPositionColor_frag);
+            vert = ccPositionColorTextureAsPointsize_vert; frag = ccPositionColor_frag;
             break;
         case kShaderType_PositionColor_noMVP:
-            p->initWithByteArrays(ccPositionTextureColor_noMVP_vert ,ccPositionColor_frag);
+            vert = ccPositionTextureColor_noMVP_vert; frag = ccPositionColor_frag;
             break;
         case kShaderType_PositionTexture:
-            p->initWithByteArrays(ccPositionTexture_vert ,ccPositionTexture_frag);
+            vert = ccPositionTexture_vert; frag = ccPositionTexture_frag;
             break;
         case kShaderType_PositionTexture_uColor:
-            p->initWithByteArrays(ccPositionTexture_uColor_vert, ccPositionTexture_uColor_frag);
+            vert = ccPositionTexture_uColor_vert; frag = ccPositionTexture_uColor_frag;
             break;
         case kShaderType_PositionTextureA8Color:
-            p->initWithByteArrays(ccPositionTextureA8Color_vert, ccPositionTextureA8Color_frag);
+            vert = ccPositionTextureA8Color_vert; frag = ccPositionTextureA8Color_frag;
             break;
         case kShaderType_Position_uColor:
-            p->initWithByteArrays(ccPosition_uColor_vert, ccPosition_uColor_frag);
-            p->bindAttribLocation("aVertex", GLProgram::VERTEX_ATTRIB_POSITION);
+            vert = ccPosition_uColor_vert; frag = ccPosition_uColor_frag;
             break;
         case kShaderType_PositionLengthTexureColor:
-            p->initWithByteArrays(ccPositionColorLengthTexture_vert, ccPositionColorLengthTexture_frag);
+            vert = ccPositionColorLengthTexture_vert; frag = ccPositionColorLengthTexture_frag;
+            break;
+        case kShaderType_PositionLengthTexureColor_noMVP:
+            vert = ccPositionColorLengthTexture_noMVP_vert; frag = ccPositionColorLengthTexture_frag;
             break;
         case kShaderType_LabelDistanceFieldNormal:
-            p->initWithByteArrays(ccLabel_vert, ccLabelDistanceFieldNormal_frag);
+            vert = ccLabel_vert; frag = ccLabelDistanceFieldNormal_frag;
             break;
         case kShaderType_LabelDistanceFieldGlow:
-            p->initWithByteArrays(ccLabel_vert, ccLabelDistanceFieldGlow_frag);
+            vert = ccLabel_vert; frag = ccLabelDistanceFieldGlow_frag;
+            break;
+        case kShaderType_LabelMSDF:
+            vert = ccLabel_vert; frag = ccLabelMSDF_frag;
+            break;
+        case kShaderType_LabelMSDFGlow:
+            vert = ccLabel_vert; frag = ccLabelMSDFGlow_frag;
             break;
         case kShaderType_UIGrayScale:
-            p->initWithByteArrays(ccPositionTextureColor_noMVP_vert,
-                                  ccPositionTexture_GrayScale_frag);
+            vert = ccPositionTextureColor_noMVP_vert; frag = ccPositionTexture_GrayScale_frag;
             break;
         case kShaderType_LabelNormal:
-            p->initWithByteArrays(ccLabel_vert, ccLabelNormal_frag);
+            vert = ccLabel_vert; frag = ccLabelNormal_frag;
             break;
         case kShaderType_LabelOutline:
-            p->initWithByteArrays(ccLabel_vert, ccLabelOutline_frag);
+            vert = ccLabel_vert; frag = ccLabelOutline_frag;
+            break;
+        case kShaderType_LabelEffect:
+            vert = ccPositionTextureColor_noMVP_vert; frag = ccLabelEffect_frag;
             break;
         case kShaderType_CameraClear:
-            p->initWithByteArrays(ccCameraClearVert, ccCameraClearFrag);
+            vert = ccCameraClearVert; frag = ccCameraClearFrag;
+            break;
+        case kShaderType_PositionTextureColor_instanced:
+            vert = ccPositionTextureColor_instanced_vert; frag = ccPositionTextureColor_noMVP_frag;
+            break;
+        case kShaderType_PositionTextureColor_multiTexture:
+            vert = ccPositionTextureColor_multiTexture_vert; frag = ccPositionTextureColor_multiTexture_frag;
+            break;
+        case kShaderType_PositionTextureColor_opaque:
+            vert = ccPositionTextureColor_opaque_vert; frag = ccPositionTextureColor_noMVP_frag;
+            break;
+        case kShaderType_PositionTextureColor_debug:
+            vert = ccPositionTextureColor_noMVP_vert; frag = ccPositionTextureColor_debug_frag;
+            break;
+        case kShaderType_ParticleGPU:
+            vert = ccParticleGPU_vert; frag = ccPositionTextureColor_noMVP_frag;
+            break;
+        case kShaderType_PostProcessBlur:
+            vert = ccPostProcess_vert; frag = ccPostProcessBlur_frag;
+            break;
+        case kShaderType_PostProcessBrightPass:
+            vert = ccPostProcess_vert; frag = ccPostProcessBrightPass_frag;
+            break;
+        case kShaderType_PostProcessComposite:
+            vert = ccPostProcess_vert; frag = ccPostProcessComposite_frag;
             break;
         default:
             CCLOG("cocos2d: %s:%d, error shader type", __FUNCTION__, __LINE__);
             return;
     }
 
+    const unsigned int sourceHash = hashProgramSources(type, vert, frag);
+    if (loadProgramBinary(p, sourceHash))
+    {
+        p->updateUniforms();
+        CHECK_GL_ERROR_DEBUG();
+        return;
+    }
+
+    p->initWithByteArrays(vert, frag);
+    if (type == kShaderType_Position_uColor)
+    {
+        p->bindAttribLocation("aVertex", GLProgram::VERTEX_ATTRIB_POSITION);
+    }
+
     p->link();
     p->updateUniforms();
 
+    saveProgramBinary(p, sourceHash);
+
     CHECK_GL_ERROR_DEBUG();
 }
 
@@ -382,13 +461,26 @@ GLProgram* GLProgramCache::getGLProgram(const std::string &key)
     auto it = _programs.find(key);
     if( it != _programs.end() )
         return it->second;
+
+    auto defaultProgram = _defaultPrograms.find(key);
+    if (defaultProgram != _defaultPrograms.end())
+    {
+        GLProgram* p = new (std::nothrow) GLProgram();
+        loadDefaultGLProgram(p, defaultProgram->second);
+        _programs.insert(std::make_pair(key, p));
+        return p;
+    }
     return nullptr;
 }
 
 void GLProgramCache::addGLProgram(GLProgram* program, const std::string &key)
 {
+    // a program added for the key of a default one replaces it, it isn't compiled on first use or reloaded then
+    _defaultPrograms.erase(key);
+
     // release old one
-    auto prev = getGLProgram(key);
+    auto it = _programs.find(key);
+    auto prev = it != _programs.end() ? it->second : nullptr;
     if( prev == program )
         return;
 
@@ -68,19 +68,33 @@ public:
     static void destroyInstance();
 
 
-    /** loads the default shaders */
+    /** registers the default shaders, each one is compiled by getGLProgram() the first time it is asked for */
     void loadDefaultGLPrograms();
 
-    /** reload the default shaders */
+    /** reload the default shaders which were compiled so far */
     void reloadDefaultGLPrograms();
 
-    /** returns a GL program for a given key
+    /** returns a GL program for a given key, compiling it if it is a default one not used yet
      */
     GLProgram * getGLProgram(const std::string &key);
 
-    /** adds a GLProgram to the cache for a given name */
+    /** adds a GLProgram to the cache for a given name, it replaces the default one of the same name */
     void addGLProgram(GLProgram* program, const std::string &key);
 
+    /**
+     * Enables/Disables the program binary cache of the default shaders, enabled by default.
+     * A default shader linked once is saved with glGetProgramBinary in "shadercache/" of the writable path,
+     * the next runs load it with glProgramBinary instead of compiling it.
+     * The files are replaced when the shader sources or the GL driver change.
+     * It does nothing if Configuration::supportsProgramBinary() is false.
+     * @since v3.11
+     */
+    static void setBinaryCacheEnabled(bool enabled);
+    /** Whether the program binary cache of the default shaders is enabled.
+     * @since v3.11
+     */
+    static bool isBinaryCacheEnabled();
+
     /** reload default programs these are relative to light */
     void reloadDefaultGLProgramsRelativeToLights();
 
@@ -100,6 +114,8 @@ private:
 
     /**Predefined shaders.*/
     std::unordered_map<std::string, GLProgram*> _programs;
+    /**The shader types of the predefined shaders by name, compiled on first use.*/
+    std::unordered_map<std::string, int> _defaultPrograms;
 };
 
 NS_CC_END
@@ -44,6 +44,76 @@ NS_CC_BEGIN
 // static vector with all the registered custom binding resolvers
 std::vector<GLProgramState::AutoBindingResolver*> GLProgramState::_customAutoBindingResolvers;
 
+//
+//
+// UniformKey
+//
+//
+
+struct UniformKeyTable
+{
+    UniformKeyTable()
+    {
+        // the id 0 is the invalid key
+        names.push_back(std::string());
+    }
+
+    std::unordered_map<std::string, unsigned int> ids;
+    std::vector<std::string> names;
+};
+
+static UniformKeyTable& getUniformKeyTable()
+{
+    // never destroyed, the keys may be static too
+    static UniformKeyTable* table = new UniformKeyTable();
+    return *table;
+}
+
+UniformKey::UniformKey(const std::string& name)
+{
+    auto& table = getUniformKeyTable();
+    auto it = table.ids.find(name);
+    if (it != table.ids.end())
+    {
+        _id = it->second;
+    }
+    else
+    {
+        _id = (unsigned int)table.names.size();
+        table.names.push_back(name);
+        table.ids.emplace(name, _id);
+    }
+}
+
+UniformKey UniformKey::find(const std::string& name)
+{
+    UniformKey key;
+    auto& table = getUniformKeyTable();
+    auto it = table.ids.find(name);
+    if (it != table.ids.end())
+    {
+        key._id = it->second;
+    }
+    return key;
+}
+
+const std::string& UniformKey::getName() const
+{
+    return getUniformKeyTable().names[_id];
+}
+
+// identifies the uploads of the UniformValues, 0 is never used
+static unsigned int s_uniformSerial = 0;
+
+static unsigned int nextUniformSerial()
+{
+    if (++s_uniformSerial == 0)
+    {
+        ++s_uniformSerial;
+    }
+    return s_uniformSerial;
+}
+
 //
 //
 // UniformValue
@@ -54,6 +124,7 @@ UniformValue::UniformValue()
 : _uniform(nullptr)
 , _glprogram(nullptr)
 , _type(Type::VALUE)
+, _serial(0)
 {
 }
 
@@ -61,6 +132,7 @@ UniformValue::UniformValue(Uniform *uniform, GLProgram* glprogram)
 : _uniform(uniform)
 , _glprogram(glprogram)
 , _type(Type::VALUE)
+, _serial(0)
 {
 }
 
@@ -72,6 +144,16 @@ UniformValue::~UniformValue()
 
 void UniformValue::apply()
 {
+    // the program still holds this value when nothing was uploaded to the location since,
+    // the other states of the program give the Uniform a new serial
+    bool uploaded = _type == Type::VALUE && _serial != 0 && _serial == _uniform->serial;
+    if (!uploaded)
+    {
+        // the callbacks and the pointed values may change without a setter, they are always uploaded
+        _uniform->serial = _type == Type::VALUE ? nextUniformSerial() : 0;
+        _serial = _uniform->serial;
+    }
+
     if (_type == Type::CALLBACK_FN)
     {
         (*_value.callback)(_glprogram, _uniform);
@@ -100,6 +182,14 @@ void UniformValue::apply()
                 break;
         }
     }
+    else if (uploaded)
+    {
+        // only the textures are bound again
+        if (_uniform->type == GL_SAMPLER_2D)
+            GL::bindTexture2DN(_value.tex.textureUnit, _value.tex.textureId);
+        else if (_uniform->type == GL_SAMPLER_CUBE)
+            GL::bindTextureN(_value.tex.textureUnit, _value.tex.textureId, GL_TEXTURE_CUBE_MAP);
+    }
     else /* _type == VALUE */
     {
         switch (_uniform->type) {
@@ -162,6 +252,9 @@ void UniformValue::setCallback(const std::function<void(GLProgram*, Uniform*)> &
 void UniformValue::setTexture(GLuint textureId, GLuint textureUnit)
 {
     //CCASSERT(_uniform->type == GL_SAMPLER_2D, "Wrong type. expecting GL_SAMPLER_2D");
+    // only the unit is uploaded, the texture is bound by every apply()
+    if (_type != Type::VALUE || _value.tex.textureUnit != textureUnit)
+        _serial = 0;
     _value.tex.textureId = textureId;
     _value.tex.textureUnit = textureUnit;
     _type = Type::VALUE;
@@ -169,6 +262,8 @@ void UniformValue::setTexture(GLuint textureId, GLuint textureUnit)
 void UniformValue::setInt(int value)
 {
     CCASSERT(_uniform->type == GL_INT, "Wrong type: expecting GL_INT");
+    if (_type != Type::VALUE || _value.intValue != value)
+        _serial = 0;
     _value.intValue = value;
     _type = Type::VALUE;
 }
@@ -176,6 +271,8 @@ void UniformValue::setInt(int value)
 void UniformValue::setFloat(float value)
 {
     CCASSERT(_uniform->type == GL_FLOAT, "Wrong type: expecting GL_FLOAT");
+    if (_type != Type::VALUE || _value.floatValue != value)
+        _serial = 0;
     _value.floatValue = value;
     _type = Type::VALUE;
 }
@@ -191,6 +288,8 @@ void UniformValue::setFloatv(ssize_t size, const float* pointer)
 void UniformValue::setVec2(const Vec2& value)
 {
     CCASSERT(_uniform->type == GL_FLOAT_VEC2, "Wrong type: expecting GL_FLOAT_VEC2");
+    if (_type != Type::VALUE || memcmp(_value.v2Value, &value, sizeof(_value.v2Value)) != 0)
+        _serial = 0;
     memcpy(_value.v2Value, &value, sizeof(_value.v2Value));
     _type = Type::VALUE;
 }
@@ -206,6 +305,8 @@ void UniformValue::setVec2v(ssize_t size, const Vec2* pointer)
 void UniformValue::setVec3(const Vec3& value)
 {
     CCASSERT(_uniform->type == GL_FLOAT_VEC3, "Wrong type: expecting GL_FLOAT_VEC3");
+    if (_type != Type::VALUE || memcmp(_value.v3Value, &value, sizeof(_value.v3Value)) != 0)
+        _serial = 0;
     memcpy(_value.v3Value, &value, sizeof(_value.v3Value));
     _type = Type::VALUE;
 
@@ -223,6 +324,8 @@ void UniformValue::setVec3v(ssize_t size, const Vec3* pointer)
 void UniformValue::setVec4(const Vec4& value)
 {
     CCASSERT (_uniform->type == GL_FLOAT_VEC4, "Wrong type: expecting GL_FLOAT_VEC4");
+    if (_type != Type::VALUE || memcmp(_value.v4Value, &value, sizeof(_value.v4Value)) != 0)
+        _serial = 0;
     memcpy(_value.v4Value, &value, sizeof(_value.v4Value));
     _type = Type::VALUE;
 }
@@ -238,6 +341,8 @@ void UniformValue::setVec4v(ssize_t size, const Vec4* pointer)
 void UniformValue::setMat4(const Mat4& value)
 {
     CCASSERT(_uniform->type == GL_FLOAT_MAT4, "_uniform's type should be equal GL_FLOAT_MAT4.");
+    if (_type != Type::VALUE || memcmp(_value.matrixValue, &value, sizeof(_value.matrixValue)) != 0)
+        _serial = 0;
     memcpy(_value.matrixValue, &value, sizeof(_value.matrixValue));
     _type = Type::VALUE;
 }
@@ -276,12 +381,12 @@ void VertexAttribValue::apply()
         }
         else
         {
-            glVertexAttribPointer(_vertexAttrib->index,
-                                  _value.pointer.size,
-                                  _value.pointer.type,
-                                  _value.pointer.normalized,
-                                  _value.pointer.stride,
-                                  _value.pointer.pointer);
+            GL::vertexAttribPointer(_vertexAttrib->index,
+                                    _value.pointer.size,
+                                    _value.pointer.type,
+                                    _value.pointer.normalized,
+                                    _value.pointer.stride,
+                                    _value.pointer.pointer);
         }
     }
 }
@@ -397,8 +502,8 @@ GLProgramState* GLProgramState::clone() const
     glprogramstate->_vertexAttribsFlags = this->_vertexAttribsFlags;
 
     // copy uniforms
-    glprogramstate->_uniformsByName = this->_uniformsByName;
     glprogramstate->_uniforms = this->_uniforms;
+    glprogramstate->indexUniforms();
     glprogramstate->_uniformAttributeValueDirty = this->_uniformAttributeValueDirty;
 
     // copy textures
@@ -431,17 +536,27 @@ bool GLProgramState::init(GLProgram* glprogram)
     for(auto &uniform : _glprogram->_userUniforms) {
         UniformValue value(&uniform.second, _glprogram);
         _uniforms[uniform.second.location] = value;
-        _uniformsByName[uniform.first] = uniform.second.location;
     }
+    indexUniforms();
 
     return true;
 }
 
+void GLProgramState::indexUniforms()
+{
+    _uniformsByKey.clear();
+    _uniformsByKey.reserve(_uniforms.size());
+    for(auto& uniform : _uniforms) {
+        _uniformsByKey.push_back(std::make_pair(UniformKey(uniform.second._uniform->name), &uniform.second));
+    }
+}
+
 void GLProgramState::resetGLProgram()
 {
     CC_SAFE_RELEASE(_glprogram);
     _glprogram = nullptr;
     _uniforms.clear();
+    _uniformsByKey.clear();
     _attributes.clear();
     // first texture is GL_TEXTURE1
     _textureUnitIndex = 1;
@@ -462,9 +577,10 @@ void GLProgramState::updateUniformsAndAttributes()
     CCASSERT(_glprogram, "invalid glprogram");
     if(_uniformAttributeValueDirty)
     {
-        for(auto& uniformLocation : _uniformsByName)
+        // the keys don't depend on the locations, the reloaded program is looked up by name
+        for(auto& uniform : _uniformsByKey)
         {
-            _uniforms[uniformLocation.second]._uniform = _glprogram->getUniform(uniformLocation.first);
+            uniform.second->_uniform = _glprogram->getUniform(uniform.first.getName());
         }
 
         _vertexAttribsFlags = 0;
@@ -544,11 +660,18 @@ UniformValue* GLProgramState::getUniformValue(GLint uniformLocation)
 }
 
 UniformValue* GLProgramState::getUniformValue(const std::string& name)
+{
+    return getUniformValue(UniformKey::find(name));
+}
+
+UniformValue* GLProgramState::getUniformValue(const UniformKey& uniformKey)
 {
     updateUniformsAndAttributes();
-    const auto itr = _uniformsByName.find(name);
-    if (itr != _uniformsByName.end())
-        return &_uniforms[itr->second];
+    for (auto& uniform : _uniformsByKey)
+    {
+        if (uniform.first.getId() == uniformKey.getId())
+            return uniform.second;
+    }
     return nullptr;
 }
 
@@ -846,6 +969,139 @@ void GLProgramState::setUniformTexture(GLint uniformLocation, GLuint textureId)
     }
 }
 
+// Uniform keys
+
+void GLProgramState::setUniformInt(const UniformKey& uniformKey, int value)
+{
+    auto v = getUniformValue(uniformKey);
+    if (v)
+        v->setInt(value);
+    else
+        CCLOG("cocos2d: warning: Uniform not found: %s", uniformKey.getName().c_str());
+}
+
+void GLProgramState::setUniformFloat(const UniformKey& uniformKey, float value)
+{
+    auto v = getUniformValue(uniformKey);
+    if (v)
+        v->setFloat(value);
+    else
+        CCLOG("cocos2d: warning: Uniform not found: %s", uniformKey.getName().c_str());
+}
+
+void GLProgramState::setUniformFloatv(const UniformKey& uniformKey, ssize_t size, const float* pointer)
+{
+    auto v = getUniformValue(uniformKey);
+    if (v)
+        v->setFloatv(size, pointer);
+    else
+        CCLOG("cocos2d: warning: Uniform not found: %s", uniformKey.getName().c_str());
+}
+
+void GLProgramState::setUniformVec2(const UniformKey& uniformKey, const Vec2& value)
+{
+    auto v = getUniformValue(uniformKey);
+    if (v)
+        v->setVec2(value);
+    else
+        CCLOG("cocos2d: warning: Uniform not found: %s", uniformKey.getName().c_str());
+}
+
+void GLProgramState::setUniformVec2v(const UniformKey& uniformKey, ssize_t size, const Vec2* pointer)
+{
+    auto v = getUniformValue(uniformKey);
+    if (v)
+        v->setVec2v(size, pointer);
+    else
+        CCLOG("cocos2d: warning: Uniform not found: %s", uniformKey.getName().c_str());
+}
+
+void GLProgramState::setUniformVec3(const UniformKey& uniformKey, const Vec3& value)
+{
+    auto v = getUniformValue(uniformKey);
+    if (v)
+        v->setVec3(value);
+    else
+        CCLOG("cocos2d: warning: Uniform not found: %s", uniformKey.getName().c_str());
+}
+
+void GLProgramState::setUniformVec3v(const UniformKey& uniformKey, ssize_t size, const Vec3* pointer)
+{
+    auto v = getUniformValue(uniformKey);
+    if (v)
+        v->setVec3v(size, pointer);
+    else
+        CCLOG("cocos2d: warning: Uniform not found: %s", uniformKey.getName().c_str());
+}
+
+void GLProgramState::setUniformVec4(const UniformKey& uniformKey, const Vec4& value)
+{
+    auto v = getUniformValue(uniformKey);
+    if (v)
+        v->setVec4(value);
+    else
+        CCLOG("cocos2d: warning: Uniform not found: %s", uniformKey.getName().c_str());
+}
+
+void GLProgramState::setUniformVec4v(const UniformKey& uniformKey, ssize_t size, const Vec4* pointer)
+{
+    auto v = getUniformValue(uniformKey);
+    if (v)
+        v->setVec4v(size, pointer);
+    else
+        CCLOG("cocos2d: warning: Uniform not found: %s", uniformKey.getName().c_str());
+}
+
+void GLProgramState::setUniformMat4(const UniformKey& uniformKey, const Mat4& value)
+{
+    auto v = getUniformValue(uniformKey);
+    if (v)
+        v->setMat4(value);
+    else
+        CCLOG("cocos2d: warning: Uniform not found: %s", uniformKey.getName().c_str());
+}
+
+void GLProgramState::setUniformCallback(const UniformKey& uniformKey, const std::function<void(GLProgram*, Uniform*)> &callback)
+{
+    auto v = getUniformValue(uniformKey);
+    if (v)
+        v->setCallback(callback);
+    else
+        CCLOG("cocos2d: warning: Uniform not found: %s", uniformKey.getName().c_str());
+}
+
+void GLProgramState::setUniformTexture(const UniformKey& uniformKey, Texture2D *texture)
+{
+    CCASSERT(texture, "Invalid texture");
+    setUniformTexture(uniformKey, texture->getName());
+}
+
+void GLProgramState::setUniformTexture(const UniformKey& uniformKey, GLuint textureId)
+{
+    auto v = getUniformValue(uniformKey);
+    if (v)
+    {
+        // the units start at 1, a sampler given a texture before keeps its unit
+        if (v->_type == UniformValue::Type::VALUE && v->_value.tex.textureUnit != 0)
+        {
+            v->setTexture(textureId, v->_value.tex.textureUnit);
+        }
+        else if (_boundTextureUnits.find(uniformKey.getName()) != _boundTextureUnits.end())
+        {
+            v->setTexture(textureId, _boundTextureUnits[uniformKey.getName()]);
+        }
+        else
+        {
+            v->setTexture(textureId, _textureUnitIndex);
+            _boundTextureUnits[uniformKey.getName()] = _textureUnitIndex++;
+        }
+    }
+    else
+    {
+        CCLOG("cocos2d: warning: Uniform not found: %s", uniformKey.getName().c_str());
+    }
+}
+
 // Auto bindings
 void GLProgramState::setParameterAutoBinding(const std::string& uniformName, const std::string& autoBinding)
 {
@@ -50,6 +50,33 @@ class EventListenerCustom;
 class EventCustom;
 class Node;
 
+/**
+ * The interned name of a uniform. GLProgramState finds the value of a UniformKey without hashing its name,
+ * keep one in a static or a member for the uniforms set every frame. It doesn't depend on the uniform
+ * locations, so it stays valid when the GLProgram is reloaded.
+ *
+ * @lua NA
+ */
+class CC_DLL UniformKey
+{
+public:
+    /** An invalid key, no GLProgramState has a value for it. */
+    UniformKey() : _id(0) {}
+    /** Interns the name, once for all the keys with that name. */
+    explicit UniformKey(const std::string& name);
+
+    /** Returns the key of a name, invalid if no program and no key was ever given that name. */
+    static UniformKey find(const std::string& name);
+
+    /** The number all the keys of the name share, 0 for an invalid key. */
+    unsigned int getId() const { return _id; }
+    const std::string& getName() const;
+    bool isValid() const { return _id != 0; }
+
+private:
+    unsigned int _id;
+};
+
 /**
  * Uniform Value, which is used to store to value send to openGL pipe line by glUniformXXX.
  *
@@ -121,6 +148,8 @@ protected:
     GLProgram* _glprogram;
     /** What kind of type is the Uniform */
     Type _type;
+    /** The serial the Uniform got when this value was uploaded, 0 once the value changed. */
+    unsigned int _serial;
 
     /**
      @name Uniform Value Uniform
@@ -335,6 +364,24 @@ public:
     void setUniformTexture(GLint uniformLocation, GLuint textureId);
     /**@}*/
 
+    /** @{
+     Sets the value of a uniform by its interned name, without hashing the name.
+     */
+    void setUniformInt(const UniformKey& uniformKey, int value);
+    void setUniformFloat(const UniformKey& uniformKey, float value);
+    void setUniformFloatv(const UniformKey& uniformKey, ssize_t size, const float* pointer);
+    void setUniformVec2(const UniformKey& uniformKey, const Vec2& value);
+    void setUniformVec2v(const UniformKey& uniformKey, ssize_t size, const Vec2* pointer);
+    void setUniformVec3(const UniformKey& uniformKey, const Vec3& value);
+    void setUniformVec3v(const UniformKey& uniformKey, ssize_t size, const Vec3* pointer);
+    void setUniformVec4(const UniformKey& uniformKey, const Vec4& value);
+    void setUniformVec4v(const UniformKey& uniformKey, ssize_t size, const Vec4* pointer);
+    void setUniformMat4(const UniformKey& uniformKey, const Mat4& value);
+    void setUniformCallback(const UniformKey& uniformKey, const std::function<void(GLProgram*, Uniform*)> &callback);
+    void setUniformTexture(const UniformKey& uniformKey, Texture2D *texture);
+    void setUniformTexture(const UniformKey& uniformKey, GLuint textureId);
+    /**@}*/
+
     /**
      * Returns the Node bound to the GLProgramState
      */
@@ -444,11 +491,14 @@ protected:
     VertexAttribValue* getVertexAttribValue(const std::string& attributeName);
     UniformValue* getUniformValue(const std::string& uniformName);
     UniformValue* getUniformValue(GLint uniformLocation);
+    UniformValue* getUniformValue(const UniformKey& uniformKey);
+    void indexUniforms();
 
 
     bool _uniformAttributeValueDirty;
-    std::unordered_map<std::string, GLint> _uniformsByName;
     std::unordered_map<GLint, UniformValue> _uniforms;
+    // the values of _uniforms by their UniformKey, a few keys are scanned faster than a name is hashed
+    std::vector<std::pair<UniformKey, UniformValue*>> _uniformsByKey;
     std::unordered_map<std::string, VertexAttribValue> _attributes;
     std::unordered_map<std::string, int> _boundTextureUnits;
 
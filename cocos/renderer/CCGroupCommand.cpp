@@ -48,6 +48,8 @@ bool GroupCommandManager::init()
 
 int GroupCommandManager::getGroupID()
 {
+    std::lock_guard<std::mutex> lock(_mutex);
+
     //Reuse old id
     if (!_unusedIDs.empty())
     {
@@ -67,16 +69,27 @@ int GroupCommandManager::getGroupID()
 
 void GroupCommandManager::releaseGroupID(int groupID)
 {
+    std::lock_guard<std::mutex> lock(_mutex);
     _groupMapping[groupID] = false;
     _unusedIDs.push_back(groupID);
 }
 
 GroupCommand::GroupCommand()
+: _isReorderEnabled(false)
+, _ownsRenderQueueID(true)
 {
     _type = RenderCommand::Type::GROUP_COMMAND;
     _renderQueueID = Director::DirectorInstance->getRenderer()->getGroupCommandManager()->getGroupID();
 }
 
+GroupCommand::GroupCommand(const GroupCommand& other)
+: RenderCommand(other)
+, _renderQueueID(other._renderQueueID)
+, _isReorderEnabled(other._isReorderEnabled)
+, _ownsRenderQueueID(false)
+{
+}
+
 void GroupCommand::init(float globalOrder)
 {
     _globalOrder = globalOrder;
@@ -87,7 +100,10 @@ void GroupCommand::init(float globalOrder)
 
 GroupCommand::~GroupCommand()
 {
-    Director::DirectorInstance->getRenderer()->getGroupCommandManager()->releaseGroupID(_renderQueueID);
+    if (_ownsRenderQueueID)
+    {
+        Director::DirectorInstance->getRenderer()->getGroupCommandManager()->releaseGroupID(_renderQueueID);
+    }
 }
 
 NS_CC_END
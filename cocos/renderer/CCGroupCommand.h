@@ -28,6 +28,7 @@
 
 #include <vector>
 #include <unordered_map>
+#include <mutex>
 
 #include "base/CCRef.h"
 #include "CCRenderCommand.h"
@@ -53,6 +54,8 @@ protected:
     bool init();
     std::unordered_map<int, bool> _groupMapping;
     std::vector<int> _unusedIDs;
+    //GroupCommand::init() may be called by the workers of a parallel visit
+    std::mutex _mutex;
 };
 
 /**
@@ -69,14 +72,31 @@ public:
     ~GroupCommand();
     /**@}*/
 
+    /**
+     Makes a copy that refers to the same render queue without owning its ID.
+     It is used by the Renderer to keep the commands of a frame drawn by the render thread.
+     */
+    GroupCommand(const GroupCommand& other);
+    GroupCommand& operator=(const GroupCommand& other) = delete;
+
     /**Init function for group command*/
     void init(float globalOrder);
 
     /**called by renderer, get the group ID.*/
     inline int getRenderQueueID() const {return _renderQueueID;}
 
+    /**
+     Enable/Disable the reordering of the commands of the group by material, see RenderQueue::setReorderEnabled().
+     It's kept across frames. Disabled by default.
+     */
+    inline void setReorderEnabled(bool enabled) { _isReorderEnabled = enabled; }
+    /**Whether or not the commands of the group are reordered by material.*/
+    inline bool isReorderEnabled() const { return _isReorderEnabled; }
+
 protected:
     int _renderQueueID;
+    bool _isReorderEnabled;
+    bool _ownsRenderQueueID;
 };
 
 NS_CC_END
@@ -0,0 +1,550 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "renderer/CCPostProcess.h"
+#include <algorithm>
+#include "base/ccMacros.h"
+#include "base/CCDirector.h"
+#include "base/CCString.h"
+#include "platform/CCGLView.h"
+#include "renderer/CCGLProgram.h"
+#include "renderer/CCGLProgramCache.h"
+#include "renderer/CCRenderer.h"
+#include "renderer/CCTexture2D.h"
+#include "renderer/ccGLStateCache.h"
+
+NS_CC_BEGIN
+
+PostProcessFrame::PostProcessFrame()
+: color(nullptr)
+, bloom(nullptr)
+, bloomIntensity(0)
+, colorOffset(Vec4::ZERO)
+, lookupTexture(nullptr)
+, lookupIntensity(0)
+, vignette(Vec4::ZERO)
+{
+}
+
+// PostProcessEffect
+
+PostProcessEffect::PostProcessEffect(float resolutionScale)
+: _enabled(true)
+, _resolutionScale(resolutionScale)
+{
+}
+
+PostProcessEffect::~PostProcessEffect()
+{
+}
+
+void PostProcessEffect::setResolutionScale(float scale)
+{
+    _resolutionScale = clampf(scale, 0.0625f, 1.0f);
+}
+
+// PostProcessBlur
+
+PostProcessBlur* PostProcessBlur::create(float radius)
+{
+    auto ret = new (std::nothrow) PostProcessBlur(radius);
+    if (ret)
+    {
+        ret->autorelease();
+    }
+    return ret;
+}
+
+PostProcessBlur::PostProcessBlur(float radius)
+: PostProcessEffect(0.5f)
+, _radius(radius)
+, _iterations(1)
+{
+}
+
+void PostProcessBlur::setIterations(int iterations)
+{
+    _iterations = std::max(iterations, 1);
+}
+
+void PostProcessBlur::render(PostProcessStack* stack, PostProcessFrame& frame)
+{
+    auto blurred = stack->blur(frame.color, _resolutionScale, _radius, _iterations);
+    if (blurred)
+    {
+        stack->giveBackTarget(frame.color);
+        frame.color = blurred;
+    }
+}
+
+// PostProcessBloom
+
+PostProcessBloom* PostProcessBloom::create(float threshold, float intensity)
+{
+    auto ret = new (std::nothrow) PostProcessBloom(threshold, intensity);
+    if (ret)
+    {
+        ret->autorelease();
+    }
+    return ret;
+}
+
+PostProcessBloom::PostProcessBloom(float threshold, float intensity)
+: PostProcessEffect(0.25f)
+, _threshold(threshold)
+, _softKnee(0.5f)
+, _intensity(intensity)
+, _radius(16.0f)
+{
+}
+
+void PostProcessBloom::render(PostProcessStack* stack, PostProcessFrame& frame)
+{
+    // the bright pass also downsamples, at twice the scale of the blur to keep the small highlights
+    auto bright = stack->borrowTarget(std::min(_resolutionScale * 2, 1.0f));
+    if (bright == nullptr)
+    {
+        return;
+    }
+
+    auto program = stack->getBrightPassProgram();
+    program->use();
+    program->setUniformLocationWith2f(program->getUniformLocation("u_threshold"), _threshold, std::max(_softKnee * _threshold, 0.0001f));
+    stack->drawPass(program, frame.color, bright);
+
+    auto blurred = stack->blur(bright, _resolutionScale, _radius, 1);
+    stack->giveBackTarget(bright);
+    if (blurred == nullptr)
+    {
+        return;
+    }
+
+    if (frame.bloom)
+    {
+        stack->giveBackTarget(frame.bloom);
+    }
+    frame.bloom = blurred;
+    frame.bloomIntensity = _intensity;
+}
+
+// PostProcessColorGrading
+
+PostProcessColorGrading* PostProcessColorGrading::create()
+{
+    auto ret = new (std::nothrow) PostProcessColorGrading();
+    if (ret)
+    {
+        ret->autorelease();
+    }
+    return ret;
+}
+
+PostProcessColorGrading::PostProcessColorGrading()
+: PostProcessEffect(1.0f)
+, _brightness(0)
+, _contrast(1)
+, _saturation(1)
+, _tint(Color3B::WHITE)
+, _lookupTexture(nullptr)
+, _lookupIntensity(0)
+{
+}
+
+PostProcessColorGrading::~PostProcessColorGrading()
+{
+    CC_SAFE_RELEASE(_lookupTexture);
+}
+
+void PostProcessColorGrading::setLookupTexture(Texture2D* texture, float intensity)
+{
+    CC_SAFE_RETAIN(texture);
+    CC_SAFE_RELEASE(_lookupTexture);
+    _lookupTexture = texture;
+    _lookupIntensity = texture ? intensity : 0;
+}
+
+void PostProcessColorGrading::render(PostProcessStack* stack, PostProcessFrame& frame)
+{
+    // color = tint * (contrast * (saturation * color) + (1 - contrast) / 2 + brightness)
+    static const float luminance[3] = { 0.2126f, 0.7152f, 0.0722f };
+    const float tint[3] = { _tint.r / 255.0f, _tint.g / 255.0f, _tint.b / 255.0f };
+
+    Mat4 grading;
+    for (int row = 0; row < 3; ++row)
+    {
+        for (int column = 0; column < 3; ++column)
+        {
+            float saturation = (1 - _saturation) * luminance[column] + (row == column ? _saturation : 0);
+            // column major
+            grading.m[column * 4 + row] = tint[row] * _contrast * saturation;
+        }
+    }
+    const float offset = (1 - _contrast) * 0.5f + _brightness;
+    Vec4 gradingOffset(tint[0] * offset, tint[1] * offset, tint[2] * offset, 0);
+
+    // after the grading of the effects before
+    frame.colorOffset = grading * frame.colorOffset + gradingOffset;
+    frame.colorMatrix = grading * frame.colorMatrix;
+
+    if (_lookupTexture)
+    {
+        frame.lookupTexture = _lookupTexture;
+        frame.lookupIntensity = _lookupIntensity;
+    }
+}
+
+// PostProcessVignette
+
+PostProcessVignette* PostProcessVignette::create(float intensity)
+{
+    auto ret = new (std::nothrow) PostProcessVignette(intensity);
+    if (ret)
+    {
+        ret->autorelease();
+    }
+    return ret;
+}
+
+PostProcessVignette::PostProcessVignette(float intensity)
+: PostProcessEffect(1.0f)
+, _intensity(intensity)
+, _radius(0.9f)
+, _softness(0.5f)
+{
+}
+
+void PostProcessVignette::render(PostProcessStack* stack, PostProcessFrame& frame)
+{
+    const float aspect = (float)frame.color->texture->getPixelsWide() / frame.color->texture->getPixelsHigh();
+    frame.vignette.set(clampf(_intensity, 0, 1), _radius, std::max(_softness, 0.001f), aspect);
+}
+
+// PostProcessStack
+
+PostProcessStack::PostProcessStack()
+: _renderScale(1.0f)
+, _drawingScene(false)
+, _blurProgram(nullptr)
+, _brightPassProgram(nullptr)
+, _compositeProgram(nullptr)
+, _pixelsWide(0)
+, _pixelsHigh(0)
+, _oldFBO(0)
+, _sceneTarget(nullptr)
+{
+}
+
+PostProcessStack::~PostProcessStack()
+{
+    CCASSERT(_sceneTarget == nullptr, "PostProcessStack: deleted while drawing a frame");
+}
+
+void PostProcessStack::addEffect(PostProcessEffect* effect)
+{
+    CCASSERT(effect, "PostProcessStack: the effect is null");
+    std::lock_guard<std::mutex> lock(_mutex);
+    _effects.pushBack(effect);
+}
+
+void PostProcessStack::removeEffect(PostProcessEffect* effect)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _effects.eraseObject(effect);
+}
+
+void PostProcessStack::removeAllEffects()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _effects.clear();
+}
+
+Vector<PostProcessEffect*> PostProcessStack::getEffects() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _effects;
+}
+
+void PostProcessStack::setRenderScale(float scale)
+{
+    _renderScale = clampf(scale, 0.1f, 1.0f);
+}
+
+bool PostProcessStack::isActive() const
+{
+    if (_renderScale < 1.0f)
+    {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    return std::any_of(_effects.begin(), _effects.end(), [](PostProcessEffect* effect) {
+        return effect->isEnabled();
+    });
+}
+
+RenderTargetPool::Target* PostProcessStack::borrowTarget(float scale)
+{
+    const int pixelsWide = std::max((int)(_pixelsWide * scale), 1);
+    const int pixelsHigh = std::max((int)(_pixelsHigh * scale), 1);
+    auto target = RenderTargetPool::getInstance()->borrow(pixelsWide, pixelsHigh, Size(pixelsWide, pixelsHigh),
+                                                          Texture2D::PixelFormat::RGBA8888, 0);
+    if (target)
+    {
+        // the passes read the targets scaled
+        target->texture->setAntiAliasTexParameters();
+    }
+    return target;
+}
+
+void PostProcessStack::giveBackTarget(RenderTargetPool::Target* target)
+{
+    RenderTargetPool::getInstance()->giveBack(target);
+}
+
+void PostProcessStack::drawPass(GLProgram* program, RenderTargetPool::Target* source, RenderTargetPool::Target* destination)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, destination->FBO);
+    // the pass covers the whole target, there is nothing to load
+    RenderTargetPool::discard(true, false);
+    GL::viewport(0, 0, destination->texture->getPixelsWide(), destination->texture->getPixelsHigh());
+
+    program->use();
+    GL::bindTexture2DN(0, source->texture->getName());
+    drawQuad();
+}
+
+void PostProcessStack::drawQuad()
+{
+    static const GLfloat vertices[] = { -1, -1, 1, -1, -1, 1, 1, 1 };
+    static const GLfloat texCoords[] = { 0, 0, 1, 0, 0, 1, 1, 1 };
+
+    // client side arrays
+    GL::bindVAO(0);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
+    GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POSITION | GL::VERTEX_ATTRIB_FLAG_TEX_COORD);
+    GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, vertices);
+    GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, 0, texCoords);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+    CC_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(1, 4);
+}
+
+RenderTargetPool::Target* PostProcessStack::blur(RenderTargetPool::Target* source, float scale, float radius, int iterations)
+{
+    auto horizontal = borrowTarget(scale);
+    auto vertical = borrowTarget(scale);
+    if (horizontal == nullptr || vertical == nullptr)
+    {
+        if (horizontal)
+            giveBackTarget(horizontal);
+        if (vertical)
+            giveBackTarget(vertical);
+        return nullptr;
+    }
+
+    const float texelWide = 1.0f / horizontal->texture->getPixelsWide();
+    const float texelHigh = 1.0f / horizontal->texture->getPixelsHigh();
+    // the kernel reaches about 4 taps, spread over the radius in pixels of the target
+    const float spread = std::max(radius * scale / 4, 1.0f);
+
+    _blurProgram->use();
+    const GLint direction = _blurProgram->getUniformLocation("u_direction");
+    for (int i = 0; i < iterations; ++i)
+    {
+        _blurProgram->setUniformLocationWith2f(direction, spread * texelWide, 0);
+        drawPass(_blurProgram, i == 0 ? source : vertical, horizontal);
+        _blurProgram->setUniformLocationWith2f(direction, 0, spread * texelHigh);
+        drawPass(_blurProgram, horizontal, vertical);
+    }
+
+    giveBackTarget(horizontal);
+    return vertical;
+}
+
+void PostProcessStack::beginScene(Renderer* renderer)
+{
+    auto glview = Director::getInstance()->getOpenGLView();
+    // the size of the framebuffer, the viewport of the director is kept in the target
+    const Size& frameSize = glview->getFrameSize();
+    const float pixelScale = glview->getRetinaFactor() * glview->getFrameZoomFactor();
+    const int pixelsWide = (int)(frameSize.width * pixelScale);
+    const int pixelsHigh = (int)(frameSize.height * pixelScale);
+
+    // the programs are compiled on the main thread, the render thread only draws
+    auto cache = GLProgramCache::getInstance();
+    _blurProgram = cache->getGLProgram(GLProgram::SHADER_NAME_POST_PROCESS_BLUR);
+    _brightPassProgram = cache->getGLProgram(GLProgram::SHADER_NAME_POST_PROCESS_BRIGHT_PASS);
+    _compositeProgram = cache->getGLProgram(GLProgram::SHADER_NAME_POST_PROCESS_COMPOSITE);
+
+    const float renderScale = _renderScale;
+    _beginCommand.init(0);
+    _beginCommand.func = [this, pixelsWide, pixelsHigh, renderScale]() {
+        onBegin(pixelsWide, pixelsHigh, renderScale);
+    };
+    renderer->addCommand(&_beginCommand);
+
+    _groupCommand.init(0);
+    renderer->addCommand(&_groupCommand);
+
+    // added before the scene is visited, the overlay queue filled during the visit comes after it
+    _endCommand.init(0);
+    _endCommand.func = CC_CALLBACK_0(PostProcessStack::onEnd, this);
+    renderer->addCommand(&_endCommand);
+
+    _overlayCommand.init(0);
+    renderer->addCommand(&_overlayCommand);
+
+    renderer->pushGroup(_groupCommand.getRenderQueueID());
+    _drawingScene = true;
+}
+
+void PostProcessStack::endScene(Renderer* renderer)
+{
+    _drawingScene = false;
+    renderer->popGroup();
+}
+
+int PostProcessStack::getRenderQueueID() const
+{
+    return _groupCommand.getRenderQueueID();
+}
+
+int PostProcessStack::getOverlayRenderQueueID() const
+{
+    return _overlayCommand.getRenderQueueID();
+}
+
+void PostProcessStack::onBegin(int pixelsWide, int pixelsHigh, float renderScale)
+{
+    _pixelsWide = pixelsWide;
+    _pixelsHigh = pixelsHigh;
+    const int sceneWide = std::max((int)(pixelsWide * renderScale), 1);
+    const int sceneHigh = std::max((int)(pixelsHigh * renderScale), 1);
+    _sceneTarget = RenderTargetPool::getInstance()->borrow(sceneWide, sceneHigh, Size(sceneWide, sceneHigh),
+                                                           Texture2D::PixelFormat::RGBA8888, GL_DEPTH24_STENCIL8);
+    if (_sceneTarget == nullptr)
+    {
+        // the scene is drawn to the screen without the effects
+        return;
+    }
+
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &_oldFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, _sceneTarget->FBO);
+
+    // the viewport and the scissor box of the scene are scaled down with it, the composite scales it up
+    _sceneTarget->texture->setAntiAliasTexParameters();
+    Director::getInstance()->getOpenGLView()->setRenderScale(renderScale);
+    Director::getInstance()->setViewport();
+
+    // clearing all the attachments spares a tile based GPU loading them
+    const Color4F& clearColor = Director::getInstance()->getRenderer()->getClearColor();
+    GL::depthMask(true);
+    glClearColor(clearColor.r, clearColor.g, clearColor.b, clearColor.a);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+    GL::depthMask(false);
+}
+
+void PostProcessStack::onEnd()
+{
+    if (_sceneTarget == nullptr)
+    {
+        return;
+    }
+
+    // the depth and stencil of the scene aren't needed anymore
+    glBindFramebuffer(GL_FRAMEBUFFER, _sceneTarget->FBO);
+    RenderTargetPool::discard(false, true);
+
+    // the passes replace the pixels
+    GL::blendFunc(GL_ONE, GL_ZERO);
+    GL::disable(GL_DEPTH_TEST);
+    GL::disable(GL_STENCIL_TEST);
+    GL::disable(GL_SCISSOR_TEST);
+    GL::disable(GL_CULL_FACE);
+
+    PostProcessFrame frame;
+    frame.color = _sceneTarget;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto effect : _effects)
+        {
+            if (effect->isEnabled())
+            {
+                effect->render(this, frame);
+            }
+        }
+    }
+
+    // the composite pass, to the framebuffer the scene would have been drawn into
+    glBindFramebuffer(GL_FRAMEBUFFER, _oldFBO);
+    GL::viewport(0, 0, _pixelsWide, _pixelsHigh);
+    Director::getInstance()->getOpenGLView()->setRenderScale(1.0f);
+
+    const GLuint colorName = frame.color->texture->getName();
+    _compositeProgram->use();
+    _compositeProgram->setUniformLocationWith1f(_compositeProgram->getUniformLocation("u_bloomIntensity"), frame.bloom ? frame.bloomIntensity : 0);
+    _compositeProgram->setUniformLocationWithMatrix4fv(_compositeProgram->getUniformLocation("u_colorMatrix"), frame.colorMatrix.m, 1);
+    _compositeProgram->setUniformLocationWith4f(_compositeProgram->getUniformLocation("u_colorOffset"),
+                                                frame.colorOffset.x, frame.colorOffset.y, frame.colorOffset.z, frame.colorOffset.w);
+    _compositeProgram->setUniformLocationWith1f(_compositeProgram->getUniformLocation("u_lookupIntensity"), frame.lookupTexture ? frame.lookupIntensity : 0);
+    _compositeProgram->setUniformLocationWith4f(_compositeProgram->getUniformLocation("u_vignette"),
+                                                frame.vignette.x, frame.vignette.y, frame.vignette.z, frame.vignette.w);
+
+    // the samplers left out are bound to the image, a valid texture
+    GL::bindTexture2DN(1, frame.bloom ? frame.bloom->texture->getName() : colorName);
+    GL::bindTexture2DN(2, frame.lookupTexture ? frame.lookupTexture->getName() : colorName);
+    GL::bindTexture2DN(0, colorName);
+    drawQuad();
+
+    Director::getInstance()->setViewport();
+
+    giveBackTarget(frame.color);
+    if (frame.bloom)
+    {
+        giveBackTarget(frame.bloom);
+    }
+    _sceneTarget = nullptr;
+}
+
+std::string PostProcessStack::getDescription() const
+{
+    std::string description = StringUtils::format("post process: %dx%d, render scale %.2f", _pixelsWide, _pixelsHigh, _renderScale);
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto effect : _effects)
+    {
+        const char* name = "effect";
+        if (dynamic_cast<PostProcessBlur*>(effect))
+            name = "blur";
+        else if (dynamic_cast<PostProcessBloom*>(effect))
+            name = "bloom";
+        else if (dynamic_cast<PostProcessColorGrading*>(effect))
+            name = "color grading";
+        else if (dynamic_cast<PostProcessVignette*>(effect))
+            name = "vignette";
+        description += StringUtils::format("\n\t%s%s, resolution scale %.3f", name, effect->isEnabled() ? "" : " (disabled)", effect->getResolutionScale());
+    }
+    return description;
+}
+
+NS_CC_END
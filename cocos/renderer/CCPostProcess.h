@@ -0,0 +1,336 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_POST_PROCESS_H__
+#define __CC_POST_PROCESS_H__
+
+#include <mutex>
+#include <string>
+
+#include "base/CCRef.h"
+#include "base/CCVector.h"
+#include "math/CCMath.h"
+#include "renderer/CCCustomCommand.h"
+#include "renderer/CCGroupCommand.h"
+#include "renderer/CCRenderTargetPool.h"
+
+/**
+ * @addtogroup renderer
+ * @{
+ */
+
+NS_CC_BEGIN
+
+class GLProgram;
+class PostProcessStack;
+class Renderer;
+
+/**
+ The image a PostProcessStack hands from effect to effect while it draws a frame.
+ The effects that change the image, such as the blur, draw it into a target they borrow from the stack and give back
+ the one they read. The bloom, the color grading and the vignette only set what the composite pass adds to it.
+ @js NA
+ */
+struct CC_DLL PostProcessFrame
+{
+    PostProcessFrame();
+
+    /** The image, the scene at full resolution until an effect replaces it. */
+    RenderTargetPool::Target* color;
+    /** The blurred bright parts added to the image, nullptr without bloom. */
+    RenderTargetPool::Target* bloom;
+    float bloomIntensity;
+    /** The transform of the colors, applied after the bloom. */
+    Mat4 colorMatrix;
+    Vec4 colorOffset;
+    /** The 256x16 color lookup strip, nullptr for none. */
+    Texture2D* lookupTexture;
+    float lookupIntensity;
+    /** The intensity, radius, softness and aspect ratio of the vignette. */
+    Vec4 vignette;
+};
+
+/**
+ An effect of a PostProcessStack.
+ Its resolution scale is the size of the targets its passes draw into, relative to the screen: the blurs are about
+ as good at half or quarter resolution, for a fraction of the fill rate.
+ @js NA
+ */
+class CC_DLL PostProcessEffect : public Ref
+{
+public:
+    /** Enables or disables the effect. A stack without enabled effects draws the scene directly. */
+    void setEnabled(bool enabled) { _enabled = enabled; }
+    bool isEnabled() const { return _enabled; }
+
+    /** Sets the size of the targets of the effect relative to the screen, between 0.0625 and 1. */
+    void setResolutionScale(float scale);
+    float getResolutionScale() const { return _resolutionScale; }
+
+protected:
+    friend class PostProcessStack;
+
+    PostProcessEffect(float resolutionScale);
+    virtual ~PostProcessEffect();
+
+    /** Draws the passes of the effect, on the thread that draws the frames. */
+    virtual void render(PostProcessStack* stack, PostProcessFrame& frame) = 0;
+
+    bool _enabled;
+    float _resolutionScale;
+};
+
+/** Blurs the image with a separable gaussian, at half resolution by default. */
+class CC_DLL PostProcessBlur : public PostProcessEffect
+{
+public:
+    static PostProcessBlur* create(float radius = 4.0f);
+
+    /** Sets the radius of the blur in pixels of the screen. */
+    void setRadius(float radius) { _radius = radius; }
+    float getRadius() const { return _radius; }
+
+    /** Sets the number of horizontal and vertical pass pairs, more is smoother and wider. */
+    void setIterations(int iterations);
+    int getIterations() const { return _iterations; }
+
+protected:
+    PostProcessBlur(float radius);
+    virtual void render(PostProcessStack* stack, PostProcessFrame& frame) override;
+
+    float _radius;
+    int _iterations;
+};
+
+/**
+ Adds a glow around the bright parts of the image: they are extracted at twice the resolution scale, blurred at the
+ resolution scale, a quarter by default, and added in the composite pass.
+ */
+class CC_DLL PostProcessBloom : public PostProcessEffect
+{
+public:
+    static PostProcessBloom* create(float threshold = 0.8f, float intensity = 1.0f);
+
+    /** Sets the brightness, between 0 and 1, the bloom starts at. */
+    void setThreshold(float threshold) { _threshold = threshold; }
+    float getThreshold() const { return _threshold; }
+
+    /** Sets how far below the threshold the bloom fades in. */
+    void setSoftKnee(float softKnee) { _softKnee = softKnee; }
+    float getSoftKnee() const { return _softKnee; }
+
+    /** Sets the factor of the bloom added to the image. */
+    void setIntensity(float intensity) { _intensity = intensity; }
+    float getIntensity() const { return _intensity; }
+
+    /** Sets the radius of the glow in pixels of the screen. */
+    void setRadius(float radius) { _radius = radius; }
+    float getRadius() const { return _radius; }
+
+protected:
+    PostProcessBloom(float threshold, float intensity);
+    virtual void render(PostProcessStack* stack, PostProcessFrame& frame) override;
+
+    float _threshold;
+    float _softKnee;
+    float _intensity;
+    float _radius;
+};
+
+/**
+ Grades the colors of the image: brightness, contrast, saturation and tint, then an optional lookup strip of 16
+ cells of 16x16 texels side by side, where the blue picks the cell, the red increases to the right and the green
+ from the first row of the image. It is applied in the composite pass, it takes no pass of its own.
+ */
+class CC_DLL PostProcessColorGrading : public PostProcessEffect
+{
+public:
+    static PostProcessColorGrading* create();
+
+    /** Sets the value added to the colors, 0 by default. */
+    void setBrightness(float brightness) { _brightness = brightness; }
+    float getBrightness() const { return _brightness; }
+
+    /** Sets the scale of the colors around the middle gray, 1 by default. */
+    void setContrast(float contrast) { _contrast = contrast; }
+    float getContrast() const { return _contrast; }
+
+    /** Sets the saturation, 0 is grayscale, 1 by default. */
+    void setSaturation(float saturation) { _saturation = saturation; }
+    float getSaturation() const { return _saturation; }
+
+    /** Sets the color the image is multiplied by, white by default. */
+    void setTint(const Color3B& tint) { _tint = tint; }
+    const Color3B& getTint() const { return _tint; }
+
+    /** Sets the lookup strip, 256x16 texels, and how much of it is applied. */
+    void setLookupTexture(Texture2D* texture, float intensity = 1.0f);
+    Texture2D* getLookupTexture() const { return _lookupTexture; }
+    float getLookupIntensity() const { return _lookupIntensity; }
+
+protected:
+    PostProcessColorGrading();
+    virtual ~PostProcessColorGrading();
+    virtual void render(PostProcessStack* stack, PostProcessFrame& frame) override;
+
+    float _brightness;
+    float _contrast;
+    float _saturation;
+    Color3B _tint;
+    Texture2D* _lookupTexture;
+    float _lookupIntensity;
+};
+
+/** Darkens the borders of the image, in the composite pass. */
+class CC_DLL PostProcessVignette : public PostProcessEffect
+{
+public:
+    static PostProcessVignette* create(float intensity = 0.5f);
+
+    /** Sets how dark the corners get, between 0 and 1. */
+    void setIntensity(float intensity) { _intensity = intensity; }
+    float getIntensity() const { return _intensity; }
+
+    /** Sets the distance from the center, in screen heights, the darkening ends at. */
+    void setRadius(float radius) { _radius = radius; }
+    float getRadius() const { return _radius; }
+
+    /** Sets the width of the fade, in screen heights. */
+    void setSoftness(float softness) { _softness = softness; }
+    float getSoftness() const { return _softness; }
+
+protected:
+    PostProcessVignette(float intensity);
+    virtual void render(PostProcessStack* stack, PostProcessFrame& frame) override;
+
+    float _intensity;
+    float _radius;
+    float _softness;
+};
+
+/**
+ The effects drawn over the scene by the Director, see Director::getPostProcessStack().
+
+ While one of its effects is enabled, or the render scale is below 1, the running scene is drawn into a target of the
+ size of the screen times the render scale, borrowed from the RenderTargetPool, instead of the screen. The effects then ping-pong the image between pooled targets at their
+ resolution scale, in the order they were added, and a composite pass draws it to the screen with the bloom, the
+ color grading and the vignette in one go, scaled up to the screen. The nodes drawn at native resolution, see
+ Node::setDrawnAtNativeResolution(), the notifications node and the stats are drawn over the result.
+ The depth and stencil of the scene and the color of the targets about to be overwritten are discarded, so a tile
+ based GPU neither loads nor stores them.
+ @js NA
+ */
+class CC_DLL PostProcessStack
+{
+public:
+    PostProcessStack();
+    ~PostProcessStack();
+
+    /** Adds an effect after the others. */
+    void addEffect(PostProcessEffect* effect);
+    void removeEffect(PostProcessEffect* effect);
+    void removeAllEffects();
+    /** Returns a copy of the effects. */
+    Vector<PostProcessEffect*> getEffects() const;
+
+    /**
+     Sets the scale of the resolution the scene is drawn at, between 0.1 and 1. The Director sets it with the dynamic
+     resolution, see Director::setDynamicResolutionEnabled(). 1 by default.
+     */
+    void setRenderScale(float scale);
+    float getRenderScale() const { return _renderScale; }
+
+    /** Whether one of the effects is enabled or the render scale is below 1. */
+    bool isActive() const;
+
+    /**
+     Borrows a target of the size of the screen times `scale`, with linear filtering. Used by the effects.
+     */
+    RenderTargetPool::Target* borrowTarget(float scale);
+    void giveBackTarget(RenderTargetPool::Target* target);
+
+    /**
+     Draws `source` into `destination` with `program`, in use with its uniforms set, as a full screen quad.
+     The source is bound to CC_Texture0. Used by the effects.
+     */
+    void drawPass(GLProgram* program, RenderTargetPool::Target* source, RenderTargetPool::Target* destination);
+
+    /**
+     Blurs `source` into a target of the given scale, borrowed and returned, with `iterations` pairs of passes.
+     `radius` is in pixels of the screen. Used by the effects.
+     */
+    RenderTargetPool::Target* blur(RenderTargetPool::Target* source, float scale, float radius, int iterations);
+
+    /** The programs of the passes, valid while the stack draws a frame. Used by the effects. */
+    GLProgram* getBlurProgram() const { return _blurProgram; }
+    GLProgram* getBrightPassProgram() const { return _brightPassProgram; }
+
+    /** Called by the Director before the scene is visited: the scene is drawn in the render queue of the stack. */
+    void beginScene(Renderer* renderer);
+    /** Called by the Director after the scene is visited, adds the passes of the effects. */
+    void endScene(Renderer* renderer);
+    /** The render queue the scene is visited into between beginScene() and endScene(). */
+    int getRenderQueueID() const;
+    /** The render queue drawn after the composite pass, at the resolution of the screen. */
+    int getOverlayRenderQueueID() const;
+    /** Whether the scene is being visited into the render queue of the stack, between beginScene() and endScene(). */
+    bool isDrawingScene() const { return _drawingScene; }
+
+    /** Returns the effects and the size of the last frame, for the console. */
+    std::string getDescription() const;
+
+protected:
+    void onBegin(int pixelsWide, int pixelsHigh, float renderScale);
+    void onEnd();
+    void drawQuad();
+
+    Vector<PostProcessEffect*> _effects;
+    // the effects are added on the main thread and drawn on the thread that draws the frames
+    mutable std::mutex _mutex;
+
+    CustomCommand _beginCommand;
+    GroupCommand _groupCommand;
+    CustomCommand _endCommand;
+    GroupCommand _overlayCommand;
+    float _renderScale;
+    bool _drawingScene;
+
+    GLProgram* _blurProgram;
+    GLProgram* _brightPassProgram;
+    GLProgram* _compositeProgram;
+
+    // the frame being drawn, on the thread that draws the frames
+    int _pixelsWide;
+    int _pixelsHigh;
+    GLint _oldFBO;
+    RenderTargetPool::Target* _sceneTarget;
+};
+
+NS_CC_END
+
+/**
+ end of support group
+ @}
+ */
+#endif //__CC_POST_PROCESS_H__
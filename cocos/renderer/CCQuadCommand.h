@@ -79,6 +79,9 @@ public:
     inline const Mat4& getModelView() const { return _mv; }
 
 protected:
+    //the render thread of the Renderer draws copies pointing to quads it owns
+    friend class Renderer;
+
     /**Generate the material ID by textureID, glProgramState, and blend function.*/
     void generateMaterialID();
 
@@ -0,0 +1,140 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "renderer/CCQuadIndexBuffer.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "renderer/ccGLStateCache.h"
+#include "base/ccMacros.h"
+#include "base/CCDirector.h"
+#include "base/CCEventType.h"
+#include "base/CCEventListenerCustom.h"
+#include "base/CCEventDispatcher.h"
+
+NS_CC_BEGIN
+
+// the smallest number of quads the buffer grows to, so small atlases don't reupload it one by one
+static const ssize_t MIN_QUADS = 256;
+
+QuadIndexBuffer* QuadIndexBuffer::s_sharedQuadIndexBuffer = nullptr;
+
+QuadIndexBuffer* QuadIndexBuffer::getInstance()
+{
+    if (! s_sharedQuadIndexBuffer)
+    {
+        s_sharedQuadIndexBuffer = new (std::nothrow) QuadIndexBuffer();
+    }
+
+    return s_sharedQuadIndexBuffer;
+}
+
+void QuadIndexBuffer::destroyInstance()
+{
+    CC_SAFE_DELETE(s_sharedQuadIndexBuffer);
+}
+
+QuadIndexBuffer::QuadIndexBuffer()
+: _vbo(0)
+, _capacity(0)
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+, _rendererRecreatedListener(nullptr)
+#endif
+{
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    /** listen the event that renderer was recreated on Android/WP8 */
+    // Renderer, TextureAtlas and particles rebuild their VAOs at priority -1 or in the scene graph,
+    // they must find the new buffer by then.
+    _rendererRecreatedListener = EventListenerCustom::create(EVENT_RENDERER_RECREATED, CC_CALLBACK_1(QuadIndexBuffer::listenRendererRecreated, this));
+    Director::getInstance()->getEventDispatcher()->addEventListenerWithFixedPriority(_rendererRecreatedListener, -2);
+#endif
+}
+
+QuadIndexBuffer::~QuadIndexBuffer()
+{
+    if (_vbo)
+    {
+        GL::deleteBuffers(1, &_vbo);
+    }
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    Director::getInstance()->getEventDispatcher()->removeEventListener(_rendererRecreatedListener);
+#endif
+}
+
+GLuint QuadIndexBuffer::reserve(ssize_t quadCount)
+{
+    CCASSERT(quadCount >= 0 && quadCount <= MAX_QUADS, "QuadIndexBuffer: invalid number of quads");
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_vbo == 0 || quadCount > _capacity)
+    {
+        if (quadCount > _capacity)
+        {
+            _capacity = std::min(std::max(std::max(quadCount, _capacity * 2), MIN_QUADS), MAX_QUADS);
+        }
+        upload();
+    }
+
+    return _vbo;
+}
+
+void QuadIndexBuffer::upload()
+{
+    std::vector<GLushort> indices(_capacity * 6);
+    for (ssize_t i = 0; i < _capacity; i++)
+    {
+        indices[i*6+0] = (GLushort) (i*4+0);
+        indices[i*6+1] = (GLushort) (i*4+1);
+        indices[i*6+2] = (GLushort) (i*4+2);
+
+        // inverted index. issue #179
+        indices[i*6+3] = (GLushort) (i*4+3);
+        indices[i*6+4] = (GLushort) (i*4+2);
+        indices[i*6+5] = (GLushort) (i*4+1);
+    }
+
+    if (_vbo == 0)
+    {
+        glGenBuffers(1, &_vbo);
+    }
+
+    // Avoid changing the element buffer for whatever VAO might be bound.
+    GL::bindVAO(0);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _vbo);
+    GL::bufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices[0]) * indices.size(), indices.data(), GL_STATIC_DRAW);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    CHECK_GL_ERROR_DEBUG();
+}
+
+void QuadIndexBuffer::listenRendererRecreated(EventCustom* event)
+{
+    // the old name went away with the context
+    _vbo = 0;
+    upload();
+}
+
+NS_CC_END
@@ -0,0 +1,99 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_QUAD_INDEX_BUFFER_H__
+#define __CC_QUAD_INDEX_BUFFER_H__
+
+#include <mutex>
+
+#include "base/ccTypes.h"
+#include "platform/CCGL.h"
+
+/**
+ * @addtogroup renderer
+ * @{
+ */
+
+NS_CC_BEGIN
+
+class EventCustom;
+class EventListenerCustom;
+
+/**
+ QuadIndexBuffer is the element buffer shared by everything that draws quads with
+ the 0-1-2, 3-2-1 triangle pattern: the Renderer quad batches, TextureAtlas and ParticleSystemQuad.
+ The buffer only grows, and keeps its name while growing, so VAOs that captured it stay valid.
+ It is rebuilt before the other listeners run when the renderer is recreated.
+ @js NA
+ */
+class CC_DLL QuadIndexBuffer
+{
+public:
+    /** The maximum number of quads, the last index must fit in a GLushort. */
+    static const ssize_t MAX_QUADS = 65536 / 4;
+
+    /** Returns the shared quad index buffer. */
+    static QuadIndexBuffer* getInstance();
+
+    /** Purges the shared quad index buffer. */
+    static void destroyInstance();
+
+    /**
+     Makes sure the buffer holds the indices of at least `quadCount` quads.
+     It binds VAO 0 while uploading and leaves GL_ELEMENT_ARRAY_BUFFER unbound.
+     It can be called by the render thread of the Renderer while the main thread creates atlases.
+     @return The GL name of the buffer.
+     */
+    GLuint reserve(ssize_t quadCount);
+
+    /** Gets the GL name of the buffer. */
+    GLuint getVBO() const { return _vbo; }
+
+    /** Gets the number of quads the buffer holds indices for. */
+    ssize_t getCapacity() const { return _capacity; }
+
+protected:
+    QuadIndexBuffer();
+    ~QuadIndexBuffer();
+
+    void upload();
+    void listenRendererRecreated(EventCustom* event);
+
+    static QuadIndexBuffer* s_sharedQuadIndexBuffer;
+
+    GLuint _vbo;
+    ssize_t _capacity;
+    std::mutex _mutex;
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    EventListenerCustom* _rendererRecreatedListener;
+#endif
+};
+
+NS_CC_END
+
+/**
+ end of support group
+ @}
+ */
+#endif //__CC_QUAD_INDEX_BUFFER_H__
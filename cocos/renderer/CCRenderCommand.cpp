@@ -34,6 +34,7 @@ RenderCommand::RenderCommand()
 , _isTransparent(true)
 , _skipBatching(false)
 , _depth(0)
+, _debugOwner(nullptr)
 {
 }
 
@@ -38,6 +38,8 @@
 
 NS_CC_BEGIN
 
+class Node;
+
 /** Base class of the `RenderCommand` hierarchy.
 *
  The `Renderer` knows how to render `RenderCommands` objects.
@@ -93,6 +95,10 @@ public:
     inline void setSkipBatching(bool value) { _skipBatching = value; }
     /**Get the depth by current model view matrix.*/
     inline float getDepth() const { return _depth; }
+    /**The node that added the command, only recorded in Renderer::DebugMode::BATCHES.*/
+    inline Node* getDebugOwner() const { return _debugOwner; }
+    /**Set the node that added the command, see Renderer::setDebugOwner().*/
+    inline void setDebugOwner(Node* owner) { _debugOwner = owner; }
 
 protected:
     /**Constructor.*/
@@ -119,6 +125,9 @@ protected:
 
     /** Depth from the model view matrix.*/
     float _depth;
+
+    /** The node that added the command, not retained. */
+    Node* _debugOwner;
 };
 
 NS_CC_END
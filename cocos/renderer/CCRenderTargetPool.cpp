@@ -0,0 +1,339 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "renderer/CCRenderTargetPool.h"
+
+#include <algorithm>
+
+#include "base/ccMacros.h"
+#include "base/CCConfiguration.h"
+#include "base/CCDirector.h"
+#include "base/CCEventType.h"
+#include "base/CCEventListenerCustom.h"
+#include "base/CCEventDispatcher.h"
+#include "base/ccUtils.h"
+#include "base/CCString.h"
+
+NS_CC_BEGIN
+
+RenderTargetPool* RenderTargetPool::s_sharedRenderTargetPool = nullptr;
+
+RenderTargetPool* RenderTargetPool::getInstance()
+{
+    if (! s_sharedRenderTargetPool)
+    {
+        s_sharedRenderTargetPool = new (std::nothrow) RenderTargetPool();
+    }
+
+    return s_sharedRenderTargetPool;
+}
+
+void RenderTargetPool::destroyInstance()
+{
+    CC_SAFE_DELETE(s_sharedRenderTargetPool);
+}
+
+void RenderTargetPool::endFrame()
+{
+    if (s_sharedRenderTargetPool)
+    {
+        std::lock_guard<std::mutex> lock(s_sharedRenderTargetPool->_mutex);
+        s_sharedRenderTargetPool->purge(s_sharedRenderTargetPool->_purgeRequested);
+        s_sharedRenderTargetPool->_purgeRequested = false;
+        ++s_sharedRenderTargetPool->_frame;
+    }
+}
+
+void RenderTargetPool::discard(bool color, bool depthStencil)
+{
+#if CC_GL_DISCARD_FRAMEBUFFER
+    if (!Configuration::getInstance()->supportsDiscardFramebuffer())
+    {
+        return;
+    }
+
+    GLenum attachments[3];
+    GLsizei count = 0;
+    if (color)
+    {
+        attachments[count++] = GL_COLOR_ATTACHMENT0;
+    }
+    if (depthStencil)
+    {
+        attachments[count++] = GL_DEPTH_ATTACHMENT;
+        attachments[count++] = GL_STENCIL_ATTACHMENT;
+    }
+    if (count > 0)
+    {
+        glDiscardFramebufferEXT(GL_FRAMEBUFFER, count, attachments);
+    }
+#else
+    CC_UNUSED_PARAM(color);
+    CC_UNUSED_PARAM(depthStencil);
+#endif
+}
+
+RenderTargetPool::RenderTargetPool()
+: _frame(0)
+, _purgeRequested(false)
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+, _rendererRecreatedListener(nullptr)
+#endif
+{
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    _rendererRecreatedListener = EventListenerCustom::create(EVENT_RENDERER_RECREATED, CC_CALLBACK_1(RenderTargetPool::listenRendererRecreated, this));
+    Director::getInstance()->getEventDispatcher()->addEventListenerWithFixedPriority(_rendererRecreatedListener, -1);
+#endif
+}
+
+RenderTargetPool::~RenderTargetPool()
+{
+    for (auto target : _targets)
+    {
+        CCASSERT(!target->borrowed, "RenderTargetPool: a target is still borrowed");
+        deleteTarget(target);
+    }
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    Director::getInstance()->getEventDispatcher()->removeEventListener(_rendererRecreatedListener);
+#endif
+}
+
+RenderTargetPool::Target* RenderTargetPool::borrow(int pixelsWide, int pixelsHigh, const Size& contentSize, Texture2D::PixelFormat format, GLenum depthStencilFormat)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for (auto target : _targets)
+    {
+        if (!target->borrowed
+            && target->texture->getPixelsWide() == pixelsWide
+            && target->texture->getPixelsHigh() == pixelsHigh
+            && target->texture->getContentSizeInPixels().equals(contentSize)
+            && target->texture->getPixelFormat() == format
+            && target->depthStencilFormat == depthStencilFormat)
+        {
+            target->borrowed = true;
+            target->lastFrame = _frame;
+            return target;
+        }
+    }
+
+    auto texture = new (std::nothrow) Texture2D();
+    if (texture == nullptr)
+    {
+        return nullptr;
+    }
+
+    auto dataLen = pixelsWide * pixelsHigh * texture->getBitsPerPixelForFormat(format) / 8;
+    void *data = calloc(dataLen, 1);
+    if (data == nullptr)
+    {
+        CCLOG("cocos2d: RenderTargetPool: not enough memory.");
+        texture->release();
+        return nullptr;
+    }
+    texture->initWithData(data, dataLen, format, pixelsWide, pixelsHigh, contentSize);
+    texture->setOwner("RenderTargetPool");
+    free(data);
+
+    Target* target = new (std::nothrow) Target();
+    target->texture = texture;
+    target->depthBuffer = 0;
+    target->stencilBuffer = 0;
+    target->depthStencilFormat = depthStencilFormat;
+    target->bytes = dataLen;
+    target->borrowed = true;
+    target->lastFrame = _frame;
+
+    GLint oldFBO;
+    GLint oldRBO;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &oldFBO);
+    glGetIntegerv(GL_RENDERBUFFER_BINDING, &oldRBO);
+
+    glGenFramebuffers(1, &target->FBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, target->FBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture->getName(), 0);
+
+    if (depthStencilFormat != 0)
+    {
+        GLenum depthFormat = depthStencilFormat;
+        bool packed = true;
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+        // without OES_packed_depth_stencil the stencil gets its own renderbuffer, as in RenderTexture
+        if (depthStencilFormat == GL_DEPTH24_STENCIL8 && !Configuration::getInstance()->supportsOESPackedDepthStencil())
+        {
+            depthFormat = Configuration::getInstance()->supportsOESDepth24() ? GL_DEPTH_COMPONENT24_OES : GL_DEPTH_COMPONENT16;
+            packed = false;
+        }
+#endif
+        glGenRenderbuffers(1, &target->depthBuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, target->depthBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, depthFormat, (GLsizei)pixelsWide, (GLsizei)pixelsHigh);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, target->depthBuffer);
+        target->bytes += pixelsWide * pixelsHigh * (depthFormat == GL_DEPTH_COMPONENT16 ? 2 : 4);
+
+        if (depthStencilFormat == GL_DEPTH24_STENCIL8)
+        {
+            if (packed)
+            {
+                glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_RENDERBUFFER, target->depthBuffer);
+            }
+            else
+            {
+                glGenRenderbuffers(1, &target->stencilBuffer);
+                glBindRenderbuffer(GL_RENDERBUFFER, target->stencilBuffer);
+                glRenderbufferStorage(GL_RENDERBUFFER, GL_STENCIL_INDEX8, (GLsizei)pixelsWide, (GLsizei)pixelsHigh);
+                glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_RENDERBUFFER, target->stencilBuffer);
+                target->bytes += pixelsWide * pixelsHigh;
+            }
+        }
+    }
+
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+    glBindRenderbuffer(GL_RENDERBUFFER, oldRBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, oldFBO);
+
+    if (!complete)
+    {
+        CCLOG("cocos2d: RenderTargetPool: could not attach texture to framebuffer");
+        deleteTarget(target);
+        return nullptr;
+    }
+
+    _targets.push_back(target);
+    return target;
+}
+
+void RenderTargetPool::giveBack(Target* target)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    CCASSERT(target->borrowed, "RenderTargetPool: the target isn't borrowed");
+    target->borrowed = false;
+    target->lastFrame = _frame;
+}
+
+void RenderTargetPool::purgeUnusedTargets()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    // the framebuffers aren't shared between contexts, they are deleted on the thread that draws
+    _purgeRequested = true;
+}
+
+void RenderTargetPool::purge(bool all)
+{
+    auto last = std::remove_if(_targets.begin(), _targets.end(), [&](Target* target) {
+        if (target->borrowed || (!all && _frame - target->lastFrame < IDLE_FRAMES))
+        {
+            return false;
+        }
+        deleteTarget(target);
+        return true;
+    });
+    _targets.erase(last, _targets.end());
+}
+
+void RenderTargetPool::deleteTarget(Target* target)
+{
+    if (target->FBO)
+    {
+        glDeleteFramebuffers(1, &target->FBO);
+    }
+    if (target->depthBuffer)
+    {
+        glDeleteRenderbuffers(1, &target->depthBuffer);
+    }
+    if (target->stencilBuffer)
+    {
+        glDeleteRenderbuffers(1, &target->stencilBuffer);
+    }
+    CC_SAFE_RELEASE(target->texture);
+    delete target;
+}
+
+size_t RenderTargetPool::getTotalBytes() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t bytes = 0;
+    for (auto target : _targets)
+    {
+        bytes += target->bytes;
+    }
+    return bytes;
+}
+
+size_t RenderTargetPool::getBorrowedBytes() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t bytes = 0;
+    for (auto target : _targets)
+    {
+        if (target->borrowed)
+        {
+            bytes += target->bytes;
+        }
+    }
+    return bytes;
+}
+
+size_t RenderTargetPool::getTargetCount() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _targets.size();
+}
+
+std::string RenderTargetPool::getDescription() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::string description;
+    size_t bytes = 0;
+    for (auto target : _targets)
+    {
+        description += StringUtils::format("\"RenderTarget\" %dx%d bpp=%u depthStencil=0x%x bytes=%u %s\n",
+                                           target->texture->getPixelsWide(), target->texture->getPixelsHigh(),
+                                           target->texture->getBitsPerPixelForFormat(), target->depthStencilFormat,
+                                           (unsigned int)target->bytes, target->borrowed ? "borrowed" : "free");
+        bytes += target->bytes;
+    }
+    description += StringUtils::format("RenderTargetPool: %u targets for %.2f KB\n", (unsigned int)_targets.size(), bytes / 1024.0f);
+    return description;
+}
+
+void RenderTargetPool::listenRendererRecreated(EventCustom* event)
+{
+    CC_UNUSED_PARAM(event);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    // the names went away with the context, and the targets are only borrowed during a frame
+    for (auto target : _targets)
+    {
+        target->FBO = 0;
+        target->depthBuffer = 0;
+        target->stencilBuffer = 0;
+        deleteTarget(target);
+    }
+    _targets.clear();
+}
+
+NS_CC_END
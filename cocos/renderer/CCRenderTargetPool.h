@@ -0,0 +1,141 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#ifndef __CC_RENDER_TARGET_POOL_H__
+#define __CC_RENDER_TARGET_POOL_H__
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "renderer/CCTexture2D.h"
+#include "platform/CCGL.h"
+
+/**
+ * @addtogroup renderer
+ * @{
+ */
+
+NS_CC_BEGIN
+
+class EventCustom;
+class EventListenerCustom;
+
+/**
+ RenderTargetPool lends framebuffers to the effects that only need them while they draw, such as the grids of
+ NodeGrid and of the grid actions: they borrow a target in beforeDraw and return it after the blit, so the
+ effects drawn in a frame share one target of each size instead of holding a full screen texture each.
+ The targets are matched on their size, pixel format and depth stencil format. The ones that aren't borrowed
+ for IDLE_FRAMES frames are deleted.
+ It is used from the render commands, on the thread that draws the frames.
+ @js NA
+ */
+class CC_DLL RenderTargetPool
+{
+public:
+    /** The frames a target is kept without being borrowed. */
+    static const unsigned int IDLE_FRAMES = 120;
+
+    /** A framebuffer with a color texture, and the depth and stencil renderbuffers when asked for. */
+    struct Target
+    {
+        GLuint FBO;
+        Texture2D* texture;
+        GLuint depthBuffer;
+        GLuint stencilBuffer;
+        GLenum depthStencilFormat;
+        size_t bytes;
+        bool borrowed;
+        unsigned int lastFrame;
+    };
+
+    /** Returns the shared pool. */
+    static RenderTargetPool* getInstance();
+
+    /** Deletes the shared pool and its targets. */
+    static void destroyInstance();
+
+    /** Called by the Renderer after each frame, deletes the idle targets. Does nothing if the pool was never used. */
+    static void endFrame();
+
+    /**
+     Hints the driver that the content of the attachments of the bound framebuffer isn't needed anymore, so a tile
+     based GPU doesn't write them back to memory. It does nothing where GL_EXT_discard_framebuffer isn't supported.
+     @param color Whether the color attachment is discarded.
+     @param depthStencil Whether the depth and stencil attachments are discarded.
+     */
+    static void discard(bool color, bool depthStencil);
+
+    /**
+     Borrows a target, creating it if none of the free ones matches.
+     @param pixelsWide The width of the texture in pixels.
+     @param pixelsHigh The height of the texture in pixels.
+     @param contentSize The content size of the texture, in pixels.
+     @param format The pixel format of the texture.
+     @param depthStencilFormat The format of the depth renderbuffer, GL_DEPTH24_STENCIL8 adds the stencil, 0 for none.
+     @return The target, or nullptr if the framebuffer can't be created.
+     */
+    Target* borrow(int pixelsWide, int pixelsHigh, const Size& contentSize, Texture2D::PixelFormat format, GLenum depthStencilFormat);
+
+    /** Returns a target borrowed from the pool. Its content is undefined the next time it is borrowed. */
+    void giveBack(Target* target);
+
+    /** Deletes the targets that aren't borrowed, at the end of the next frame. */
+    void purgeUnusedTargets();
+
+    /** Gets the memory of the textures and renderbuffers of the targets. */
+    size_t getTotalBytes() const;
+    /** Gets the memory of the targets borrowed now. */
+    size_t getBorrowedBytes() const;
+    /** Gets the number of targets. */
+    size_t getTargetCount() const;
+
+    /** Returns a description of the targets, for the console. */
+    std::string getDescription() const;
+
+protected:
+    RenderTargetPool();
+    ~RenderTargetPool();
+
+    void deleteTarget(Target* target);
+    void purge(bool all);
+    void listenRendererRecreated(EventCustom* event);
+
+    static RenderTargetPool* s_sharedRenderTargetPool;
+
+    std::vector<Target*> _targets;
+    unsigned int _frame;
+    bool _purgeRequested;
+    mutable std::mutex _mutex;
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    EventListenerCustom* _rendererRecreatedListener;
+#endif
+};
+
+NS_CC_END
+
+/**
+ end of support group
+ @}
+ */
+#endif //__CC_RENDER_TARGET_POOL_H__
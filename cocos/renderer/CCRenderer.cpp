@@ -25,6 +25,11 @@
 #include "renderer/CCRenderer.h"
 
 #include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <condition_variable>
 
 #include "renderer/CCTrianglesCommand.h"
 #include "renderer/CCQuadCommand.h"
@@ -32,12 +37,19 @@
 #include "renderer/CCCustomCommand.h"
 #include "renderer/CCGroupCommand.h"
 #include "renderer/CCPrimitiveCommand.h"
+#include "renderer/CCQuadIndexBuffer.h"
+#include "renderer/CCRenderTargetPool.h"
+#include "renderer/CCVertexIndexBuffer.h"
 #include "renderer/CCGLProgramCache.h"
 #include "renderer/CCRenderState.h"
 #include "renderer/ccGLStateCache.h"
 
 #include "base/CCConfiguration.h"
 #include "base/CCDirector.h"
+#include "base/CCFrameTimings.h"
+#include "base/CCString.h"
+#include "base/CCTracer.h"
+#include "platform/CCGLView.h"
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventType.h"
@@ -45,33 +57,125 @@
 
 NS_CC_BEGIN
 
+static_assert(sizeof(V3F_C4B_T2F) == sizeof(float) * 6, "Mat4::transformVertices() expects 6 floats wide vertices");
+
+//the quad indices of PolygonInfo::setQuad(), the only ones the instanced path draws
+static const unsigned short s_instanceQuadIndices[6] = {0, 1, 2, 3, 2, 1};
+//the corners of the unit quad in the tl, bl, tr, br order of V3F_C4B_T2F_Quad
+static const GLfloat s_instanceQuadCorners[8] = {0, 1, 0, 0, 1, 1, 1, 0};
+
 // helper
-static bool compareRenderCommand(RenderCommand* a, RenderCommand* b)
+// The sort key of a command: the global z in the high 32 bits, mapped so that the unsigned order of the bits is the
+// order of the floats, and the position in its group in the low 32 bits, which keeps the sort stable.
+static uint64_t makeSortKey(float globalOrder, size_t sequence)
+{
+    uint32_t bits;
+    memcpy(&bits, &globalOrder, sizeof(bits));
+    // negative floats have their order reversed, positive ones only need to come after them
+    bits = (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+    return ((uint64_t)bits << 32) | (uint32_t)sequence;
+}
+
+// Computes the bounds in world coordinates of a quad or triangles command.
+// Returns false if the command can't be moved: other commands, or transforms that can't be tested without the projection.
+static bool getReorderBounds(RenderCommand* command, float& minX, float& minY, float& maxX, float& maxY)
 {
-    return a->getGlobalOrder() < b->getGlobalOrder();
+    const V3F_C4B_T2F* verts = nullptr;
+    ssize_t count = 0;
+    const Mat4* mv = nullptr;
+    if (command->getType() == RenderCommand::Type::TRIANGLES_COMMAND)
+    {
+        auto cmd = static_cast<TrianglesCommand*>(command);
+        verts = cmd->getVertices();
+        count = cmd->getVertexCount();
+        mv = &cmd->getModelView();
+    }
+    else if (command->getType() == RenderCommand::Type::QUAD_COMMAND)
+    {
+        auto cmd = static_cast<QuadCommand*>(command);
+        verts = &cmd->getQuads()->tl;
+        count = cmd->getQuadCount() * 4;
+        mv = &cmd->getModelView();
+    }
+    else
+    {
+        return false;
+    }
+
+    const float* m = mv->m;
+    if (m[3] != 0 || m[7] != 0 || m[11] != 0 || m[15] != 1)
+        return false;
+
+    if (count <= 0)
+    {
+        // overlaps nothing
+        minX = minY = FLT_MAX;
+        maxX = maxY = -FLT_MAX;
+        return true;
+    }
+
+    float lminX = verts[0].vertices.x, lmaxX = lminX;
+    float lminY = verts[0].vertices.y, lmaxY = lminY;
+    const float z = verts[0].vertices.z;
+    for (ssize_t i = 1; i < count; ++i)
+    {
+        const Vec3& v = verts[i].vertices;
+        if (v.z != z)
+            return false;
+        lminX = std::min(lminX, v.x);
+        lmaxX = std::max(lmaxX, v.x);
+        lminY = std::min(lminY, v.y);
+        lmaxY = std::max(lmaxY, v.y);
+    }
+
+    const float corners[4][2] = { {lminX, lminY}, {lmaxX, lminY}, {lminX, lmaxY}, {lmaxX, lmaxY} };
+    minX = minY = FLT_MAX;
+    maxX = maxY = -FLT_MAX;
+    for (const auto& corner : corners)
+    {
+        // with a perspective projection the boxes are comparable only on the same plane
+        float wz = m[2] * corner[0] + m[6] * corner[1] + m[10] * z + m[14];
+        if (std::abs(wz) > FLT_EPSILON)
+            return false;
+
+        float wx = m[0] * corner[0] + m[4] * corner[1] + m[8] * z + m[12];
+        float wy = m[1] * corner[0] + m[5] * corner[1] + m[9] * z + m[13];
+        minX = std::min(minX, wx);
+        maxX = std::max(maxX, wx);
+        minY = std::min(minY, wy);
+        maxY = std::max(maxY, wy);
+    }
+    return true;
 }
 
 // queue
 RenderQueue::RenderQueue()
+: _isReorderEnabled(false)
 {
-
+    for (int i = 0; i < QUEUE_COUNT; ++i)
+    {
+        _isSorted[i] = true;
+    }
 }
 
 void RenderQueue::push_back(RenderCommand* command)
 {
     float z = command->getGlobalOrder();
-    if(z < 0)
-    {
-        _commands[QUEUE_GROUP::GLOBALZ_NEG].push_back(command);
-    }
-    else if(z > 0)
+    if(z == 0)
     {
-        _commands[QUEUE_GROUP::GLOBALZ_POS].push_back(command);
+        _commands[QUEUE_GROUP::GLOBALZ_ZERO].push_back(command);
+        return;
     }
-    else
+
+    const QUEUE_GROUP group = z < 0 ? QUEUE_GROUP::GLOBALZ_NEG : QUEUE_GROUP::GLOBALZ_POS;
+    auto& keys = _sortKeys[group];
+    const uint64_t key = makeSortKey(z, _commands[group].size());
+    if (!keys.empty() && keys.back() > key)
     {
-        _commands[QUEUE_GROUP::GLOBALZ_ZERO].push_back(command);
+        _isSorted[group] = false;
     }
+    keys.push_back(key);
+    _commands[group].push_back(command);
 }
 
 ssize_t RenderQueue::size() const
@@ -88,8 +192,147 @@ ssize_t RenderQueue::size() const
 void RenderQueue::sort()
 {
     // Don't sort _queue0, it already comes sorted
-    std::sort(std::begin(_commands[QUEUE_GROUP::GLOBALZ_NEG]), std::end(_commands[QUEUE_GROUP::GLOBALZ_NEG]), compareRenderCommand);
-    std::sort(std::begin(_commands[QUEUE_GROUP::GLOBALZ_POS]), std::end(_commands[QUEUE_GROUP::GLOBALZ_POS]), compareRenderCommand);
+    sortByKey(QUEUE_GROUP::GLOBALZ_NEG);
+    sortByKey(QUEUE_GROUP::GLOBALZ_POS);
+
+    if (_isReorderEnabled)
+    {
+        reorderByMaterial(_commands[QUEUE_GROUP::GLOBALZ_NEG]);
+        reorderByMaterial(_commands[QUEUE_GROUP::GLOBALZ_ZERO]);
+        reorderByMaterial(_commands[QUEUE_GROUP::GLOBALZ_POS]);
+    }
+}
+
+void RenderQueue::sortByKey(QUEUE_GROUP group)
+{
+    auto& commands = _commands[group];
+    auto& keys = _sortKeys[group];
+    const size_t count = commands.size();
+    if (keys.size() != count)
+    {
+        // the sub queue was changed through getSubQueue()
+        keys.clear();
+        _isSorted[group] = true;
+        for (size_t i = 0; i < count; ++i)
+        {
+            keys.push_back(makeSortKey(commands[i]->getGlobalOrder(), i));
+            if (i > 0 && keys[i - 1] > keys[i])
+            {
+                _isSorted[group] = false;
+            }
+        }
+    }
+
+    if (_isSorted[group] || count < 2)
+    {
+        return;
+    }
+
+    // least significant digit first on the 32 bits of the global z, 8 bits a pass, the order of arrival breaks no tie:
+    // every pass is stable
+    _sortScratch.resize(count);
+    uint64_t* src = keys.data();
+    uint64_t* dst = _sortScratch.data();
+    for (int shift = 32; shift < 64; shift += 8)
+    {
+        size_t offsets[256] = {0};
+        for (size_t i = 0; i < count; ++i)
+        {
+            ++offsets[(src[i] >> shift) & 0xff];
+        }
+        // the keys all share the digit, the pass would copy them as they are
+        if (offsets[(src[0] >> shift) & 0xff] == count)
+        {
+            continue;
+        }
+        size_t total = 0;
+        for (int digit = 0; digit < 256; ++digit)
+        {
+            const size_t digitCount = offsets[digit];
+            offsets[digit] = total;
+            total += digitCount;
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            dst[offsets[(src[i] >> shift) & 0xff]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+
+    _sortedCommands.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        _sortedCommands[i] = commands[(uint32_t)src[i]];
+    }
+    commands.swap(_sortedCommands);
+
+    // the keys stay in the order of the sorted commands
+    for (size_t i = 0; i < count; ++i)
+    {
+        keys[i] = (src[i] & 0xffffffff00000000ull) | (uint32_t)i;
+    }
+    _isSorted[group] = true;
+}
+
+void RenderQueue::reorderByMaterial(std::vector<RenderCommand*>& commands)
+{
+    if (commands.size() < 3)
+        return;
+
+    _reorderEntries.clear();
+    _reorderEntries.reserve(commands.size());
+
+    // the entries before the barrier are never jumped over
+    size_t barrier = 0;
+    for (auto command : commands)
+    {
+        ReorderEntry entry;
+        entry.command = command;
+        entry.materialID = Renderer::MATERIAL_ID_DO_NOT_BATCH;
+
+        if (!getReorderBounds(command, entry.minX, entry.minY, entry.maxX, entry.maxY))
+        {
+            _reorderEntries.push_back(entry);
+            barrier = _reorderEntries.size();
+            continue;
+        }
+
+        if (!command->isSkipBatching())
+        {
+            entry.materialID = command->getType() == RenderCommand::Type::QUAD_COMMAND
+                ? static_cast<QuadCommand*>(command)->getMaterialID()
+                : static_cast<TrianglesCommand*>(command)->getMaterialID();
+        }
+
+        size_t insertAt = _reorderEntries.size();
+        if (entry.materialID != Renderer::MATERIAL_ID_DO_NOT_BATCH)
+        {
+            const size_t window = CC_RENDERER_REORDER_WINDOW;
+            size_t first = std::max(barrier, insertAt > window ? insertAt - window : 0);
+            for (size_t i = insertAt; i > first; --i)
+            {
+                const auto& other = _reorderEntries[i - 1];
+                if (other.materialID == entry.materialID && other.command->getType() == command->getType())
+                {
+                    // draw right after the last command of the same batch
+                    insertAt = i;
+                    break;
+                }
+                if (other.command->getGlobalOrder() != command->getGlobalOrder()
+                    || (other.minX < entry.maxX && entry.minX < other.maxX && other.minY < entry.maxY && entry.minY < other.maxY))
+                {
+                    // painter's order matters
+                    break;
+                }
+            }
+        }
+        _reorderEntries.insert(_reorderEntries.begin() + insertAt, entry);
+    }
+
+    for (size_t i = 0; i < commands.size(); ++i)
+    {
+        commands[i] = _reorderEntries[i].command;
+    }
 }
 
 RenderCommand* RenderQueue::operator[](ssize_t index) const
@@ -115,7 +358,10 @@ void RenderQueue::clear()
     for(int i = 0; i < QUEUE_COUNT; ++i)
     {
         _commands[i].clear();
+        _sortKeys[i].clear();
+        _isSorted[i] = true;
     }
+    _isReorderEnabled = false;
 }
 
 void RenderQueue::realloc(size_t reserveSize)
@@ -124,65 +370,260 @@ void RenderQueue::realloc(size_t reserveSize)
     {
         _commands[i] = std::vector<RenderCommand*>();
         _commands[i].reserve(reserveSize);
+        _sortKeys[i] = std::vector<uint64_t>();
+        _isSorted[i] = true;
     }
 }
 
 void RenderQueue::saveRenderState()
 {
-    _isDepthEnabled = glIsEnabled(GL_DEPTH_TEST) != GL_FALSE;
-    _isCullEnabled = glIsEnabled(GL_CULL_FACE) != GL_FALSE;
-    glGetBooleanv(GL_DEPTH_WRITEMASK, &_isDepthWrite);
+    _isDepthEnabled = GL::isEnabled(GL_DEPTH_TEST);
+    _isCullEnabled = GL::isEnabled(GL_CULL_FACE);
+    _isDepthWrite = GL::getDepthMask();
+}
 
-    CHECK_GL_ERROR_DEBUG();
+bool RenderQueue::isRenderStateChanged() const
+{
+    return GL::isEnabled(GL_DEPTH_TEST) != _isDepthEnabled
+        || GL::isEnabled(GL_CULL_FACE) != _isCullEnabled
+        || GL::getDepthMask() != _isDepthWrite;
 }
 
 void RenderQueue::restoreRenderState()
 {
     if (_isCullEnabled)
     {
-        glEnable(GL_CULL_FACE);
+        GL::enable(GL_CULL_FACE);
         RenderState::StateBlock::_defaultState->setCullFace(true);
     }
     else
     {
-        glDisable(GL_CULL_FACE);
+        GL::disable(GL_CULL_FACE);
         RenderState::StateBlock::_defaultState->setCullFace(false);
     }
 
 
     if (_isDepthEnabled)
     {
-        glEnable(GL_DEPTH_TEST);
+        GL::enable(GL_DEPTH_TEST);
         RenderState::StateBlock::_defaultState->setDepthTest(true);
     }
     else
     {
-        glDisable(GL_DEPTH_TEST);
+        GL::disable(GL_DEPTH_TEST);
         RenderState::StateBlock::_defaultState->setDepthTest(false);
     }
 
-    glDepthMask(_isDepthWrite);
+    GL::depthMask(_isDepthWrite);
     RenderState::StateBlock::_defaultState->setDepthWrite(_isDepthEnabled);
 
     CHECK_GL_ERROR_DEBUG();
 }
 
+//
+// ring buffer
+//
+
+// The frame handed over to the render thread. The render queues are swapped with the ones of the renderer,
+// the commands that point into their nodes are replaced by copies that point into the frame.
+struct Renderer::RenderThread
+{
+    GLView* glview;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable condition;
+    // set by the main thread when the frame is handed over, reset by the render thread once it's swapped
+    bool hasFrame;
+    bool quit;
+
+    std::vector<RenderQueue> renderGroups;
+    std::vector<TrianglesCommand> trianglesCommands;
+    std::vector<QuadCommand> quadCommands;
+    std::vector<GroupCommand> groupCommands;
+    std::vector<V3F_C4B_T2F> vertices;
+    std::vector<unsigned short> indices;
+    std::vector<V3F_C4B_T2F_Quad> quads;
+    // retained until the frame is recycled
+    std::vector<GLProgramState*> programStates;
+    // the textures deleted by the main thread while the frame may sample them, deleted when it's recycled
+    std::vector<GLuint> deletedTextures;
+
+    Color4F clearColor;
+    bool clear;
+    bool applyDepthTest;
+    bool shrink;
+    // the frame has commands that read their nodes, the main thread waits until it's drawn
+    bool needsSync;
+
+    RenderThread()
+    : glview(nullptr)
+    , hasFrame(false)
+    , quit(false)
+    , clear(false)
+    , applyDepthTest(false)
+    , shrink(false)
+    , needsSync(false)
+    {
+    }
+};
+
+static void setVertexAttribPointers(GLintptr offset, bool compact = false)
+{
+    if (compact)
+    {
+        // GL expands the position to (x, y, 0, 1) and normalizes the uvs, the shaders read the same values
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2US), (GLvoid*) (offset + offsetof(V2F_C4B_T2US, vertices)));
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V2F_C4B_T2US), (GLvoid*) (offset + offsetof(V2F_C4B_T2US, colors)));
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(V2F_C4B_T2US), (GLvoid*) (offset + offsetof(V2F_C4B_T2US, texCoords)));
+        return;
+    }
+
+    // vertices
+    GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*) (offset + offsetof(V3F_C4B_T2F, vertices)));
+
+    // colors
+    GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V3F_C4B_T2F), (GLvoid*) (offset + offsetof(V3F_C4B_T2F, colors)));
+
+    // tex coords
+    GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*) (offset + offsetof(V3F_C4B_T2F, texCoords)));
+}
+
 //
 //
 //
 static const int DEFAULT_RENDER_QUEUE = 0;
 
+//Whether the transformed vertices are in the z = 0 plane
+static bool isInPlaneZ0(const Mat4& modelView, const V3F_C4B_T2F* vertices, ssize_t count)
+{
+    if (!TransformIsAffine2D(modelView))
+        return false;
+
+    for (ssize_t i = 0; i < count; ++i)
+    {
+        if (vertices[i].vertices.z != 0)
+            return false;
+    }
+    return true;
+}
+
+//Whether the vertices can be batched as V2F_C4B_T2US: they must stay in the z = 0 plane and have uvs in [0, 1]
+static bool canCompactVertices(const Mat4& modelView, const V3F_C4B_T2F* vertices, ssize_t count)
+{
+    if (!isInPlaneZ0(modelView, vertices, count))
+        return false;
+
+    for (ssize_t i = 0; i < count; ++i)
+    {
+        const Tex2F& uv = vertices[i].texCoords;
+        if (uv.u < 0 || uv.u > 1 || uv.v < 0 || uv.v > 1)
+            return false;
+    }
+    return true;
+}
+
+static void transformVerticesCompact(const Mat4& modelView, const V3F_C4B_T2F* vertices, V2F_C4B_T2US* dst, ssize_t count)
+{
+    const float* m = modelView.m;
+    for (ssize_t i = 0; i < count; ++i)
+    {
+        const V3F_C4B_T2F& v = vertices[i];
+        V2F_C4B_T2US& out = dst[i];
+        out.vertices.x = m[0] * v.vertices.x + m[4] * v.vertices.y + m[12];
+        out.vertices.y = m[1] * v.vertices.x + m[5] * v.vertices.y + m[13];
+        out.colors = v.colors;
+        out.texCoords[0] = (GLushort)(v.texCoords.u * 65535.0f + 0.5f);
+        out.texCoords[1] = (GLushort)(v.texCoords.v * 65535.0f + 0.5f);
+    }
+}
+//the list the calling thread records its commands into, see beginCommandList()
+static thread_local Renderer::CommandList* s_commandList = nullptr;
+//the node the commands of the thread come from, see Renderer::setDebugOwner()
+static thread_local Node* s_debugOwner = nullptr;
+//the batch storage never grows by less than this number of vertices
+static const int MIN_BATCH_STORAGE = 1024;
+
+//adds the time spent in its scope to a timing of the frame, when the timings are measured
+class SubmitTimer
+{
+public:
+    SubmitTimer(bool enabled, float& time)
+    : _enabled(enabled)
+    , _time(time)
+    {
+        if (_enabled)
+            _start = FrameTimings::Clock::now();
+    }
+    ~SubmitTimer()
+    {
+        if (_enabled)
+            _time += FrameTimings::elapsed(_start);
+    }
+private:
+    bool _enabled;
+    float& _time;
+    FrameTimings::Clock::time_point _start;
+};
+
 //
 // constructors, destructor, init
 //
 Renderer::Renderer()
 :_lastMaterialID(0)
+,_batchCapacity(VBO_SIZE)
+,_peakBatchVertices(0)
+,_shrinkRequested(false)
 ,_filledVertex(0)
 ,_filledIndex(0)
 ,_numberQuads(0)
+,_isCompactVerticesEnabled(CC_RENDERER_USE_COMPACT_VERTICES != 0)
+,_trianglesCompact(false)
+,_quadsCompact(false)
+,_trianglesVAOCompact(false)
+,_quadVAOCompact(false)
+,_trianglesRing(nullptr)
+,_quadRing(nullptr)
+,_ringBufferRequested(CC_RENDERER_USE_RING_BUFFER != 0)
+,_instancedProgram(nullptr)
+,_instanceSourceProgram(nullptr)
+,_isInstancingEnabled(CC_RENDERER_USE_INSTANCING != 0)
+,_maxBatchTextures(0)
+,_multiTextureProgram(nullptr)
+,_isMultiTextureEnabled(CC_RENDERER_USE_MULTI_TEXTURE != 0)
+,_opaqueTexture(0)
+,_opaqueProgram(nullptr)
+,_isOpaquePassEnabled(CC_RENDERER_USE_OPAQUE_PASS != 0)
+,_isGroupBatchingEnabled(CC_RENDERER_BATCH_ACROSS_GROUPS != 0)
 ,_glViewAssigned(false)
+,_frameArenaIndex(0)
+,_commandCount(0)
+,_peakCommandCount(0)
+,_frameCommandCount(0)
+,_drawnBatches(0)
+,_drawnVertices(0)
+,_capacityBreaks(0)
+,_issuedStateCalls(0)
+,_skippedStateCalls(0)
 ,_isRendering(false)
 ,_isDepthTestFor2D(false)
+,_renderThread(nullptr)
+,_clearRequested(false)
+,_depthTestChanged(false)
+,_isTimingsEnabled(false)
+,_timedFrame(0)
+,_renderTime(-1)
+,_sortTime(0)
+,_submitTime(0)
+,_swapTime(0)
+,_timerQueryFirst(0)
+,_timerQueryCount(0)
+,_isTimerQueryActive(false)
+,_debugMode(DebugMode::NONE)
+,_debugProgram(nullptr)
+,_debugColorLocation(-1)
+,_debugTextureAlphaLocation(-1)
+,_batchBreak(BatchBreak::END_OF_QUEUE)
+,_batchBreakCommand(nullptr)
 #if CC_ENABLE_CACHE_TEXTURE_DATA
 ,_cacheTextureListener(nullptr)
 #endif
@@ -193,24 +634,54 @@ Renderer::Renderer()
 
     RenderQueue defaultRenderQueue;
     _renderGroups.push_back(defaultRenderQueue);
+    _drawnGroups = &_renderGroups;
     _batchedCommands.reserve(BATCH_QUADCOMMAND_RESEVER_SIZE);
 
+    _instanceVBO[0] = _instanceVBO[1] = 0;
+    _multiTextureVBO[0] = _multiTextureVBO[1] = 0;
+    _opaqueVBO[0] = _opaqueVBO[1] = 0;
+    for (int i = 0; i < TIMER_QUERY_COUNT; ++i)
+    {
+        _timerQueries[i] = 0;
+    }
+
     // default clear color
     _clearColor = Color4F::BLACK;
 }
 
 Renderer::~Renderer()
 {
+    setRenderThreadEnabled(false);
+    deleteTimerQueries();
+
+    // the group commands of the arenas give their render queues back
+    _frameArenas[0].reset();
+    _frameArenas[1].reset();
+
     _renderGroups.clear();
     _groupCommandManager->release();
 
-    glDeleteBuffers(2, _buffersVBO);
-    glDeleteBuffers(2, _quadbuffersVBO);
+    CC_SAFE_RELEASE_NULL(_trianglesRing);
+    CC_SAFE_RELEASE_NULL(_quadRing);
+    GL::deleteBuffers(2, _buffersVBO);
+    GL::deleteBuffers(1, _quadbuffersVBO);
+    if (_instanceVBO[0])
+    {
+        GL::deleteBuffers(2, _instanceVBO);
+    }
+    if (_multiTextureVBO[0])
+    {
+        GL::deleteBuffers(2, _multiTextureVBO);
+    }
+    if (_opaqueVBO[0])
+    {
+        GL::deleteBuffers(2, _opaqueVBO);
+    }
 
     if (Configuration::getInstance()->supportsShareableVAO())
     {
-        glDeleteVertexArrays(1, &_buffersVAO);
-        glDeleteVertexArrays(1, &_quadVAO);
+        GL::deleteVAO(_buffersVAO);
+        GL::deleteVAO(_quadVAO);
         GL::bindVAO(0);
     }
 #if CC_ENABLE_CACHE_TEXTURE_DATA
@@ -223,23 +694,27 @@ void Renderer::initGLView()
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     _cacheTextureListener = EventListenerCustom::create(EVENT_RENDERER_RECREATED, [this](EventCustom* event){
         /** listen the event that renderer was recreated on Android/WP8 */
+        // the buffers and sync objects went away with the old context
+        if (_quadRing)
+        {
+            _trianglesRing->abandon();
+            _quadRing->abandon();
+            CC_SAFE_RELEASE_NULL(_trianglesRing);
+            CC_SAFE_RELEASE_NULL(_quadRing);
+        }
+        for (int i = 0; i < TIMER_QUERY_COUNT; ++i)
+        {
+            _timerQueries[i] = 0;
+        }
+        _timerQueryFirst = _timerQueryCount = 0;
         this->setupBuffer();
     });
 
     Director::getInstance()->getEventDispatcher()->addEventListenerWithFixedPriority(_cacheTextureListener, -1);
 #endif
 
-    //setup index data for quads
-
-    for( int i=0; i < VBO_SIZE/4; i++)
-    {
-        _quadIndices[i*6+0] = (GLushort) (i*4+0);
-        _quadIndices[i*6+1] = (GLushort) (i*4+1);
-        _quadIndices[i*6+2] = (GLushort) (i*4+2);
-        _quadIndices[i*6+3] = (GLushort) (i*4+3);
-        _quadIndices[i*6+4] = (GLushort) (i*4+2);
-        _quadIndices[i*6+5] = (GLushort) (i*4+1);
-    }
+    int capacity = Configuration::getInstance()->getValue("cocos2d.x.renderer.batch_capacity", Value(VBO_SIZE)).asInt();
+    _batchCapacity = std::min(std::max(capacity, 4), (int)VBO_SIZE);
 
     setupBuffer();
 
@@ -256,67 +731,239 @@ void Renderer::setupBuffer()
     {
         setupVBO();
     }
+
+    setupRingBuffers();
+    setupInstancing();
+    setupMultiTexture();
+    setupOpaquePass();
+}
+
+void Renderer::setupInstancing()
+{
+    _instancedProgram = nullptr;
+    _instanceVBO[0] = _instanceVBO[1] = 0;
+
+    // the multi texture path batches the commands of this program as well
+    auto cache = GLProgramCache::getInstance();
+    _instanceSourceProgram = cache->getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP);
+
+    if (!Configuration::getInstance()->supportsInstancing())
+        return;
+
+    _instancedProgram = cache->getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_INSTANCED);
+    if (_instancedProgram == nullptr)
+        return;
+
+    glGenBuffers(2, &_instanceVBO[0]);
+
+    GL::bindBuffer(GL_ARRAY_BUFFER, _instanceVBO[0]);
+    GL::bufferData(GL_ARRAY_BUFFER, sizeof(s_instanceQuadCorners), s_instanceQuadCorners, GL_STATIC_DRAW);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
+
+    CHECK_GL_ERROR_DEBUG();
+}
+
+void Renderer::setupMultiTexture()
+{
+    _multiTextureProgram = nullptr;
+    _multiTextureVBO[0] = _multiTextureVBO[1] = 0;
+
+    _maxBatchTextures = std::min(std::min(Configuration::getInstance()->getMaxTextureUnits(), CC_RENDERER_MAX_BATCH_TEXTURES), 8);
+    if (_maxBatchTextures < 2)
+        return;
+
+    _multiTextureProgram = GLProgramCache::getInstance()->getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_MULTI_TEXTURE);
+    if (_multiTextureProgram == nullptr)
+        return;
+
+    for (int i = 0; i < _maxBatchTextures; ++i)
+    {
+        _multiTextureSamplers[i] = _multiTextureProgram->getUniformLocation(StringUtils::format("u_textures[%d]", i));
+    }
+
+    glGenBuffers(2, &_multiTextureVBO[0]);
+    CHECK_GL_ERROR_DEBUG();
+}
+
+void Renderer::setupOpaquePass()
+{
+    _opaqueVBO[0] = _opaqueVBO[1] = 0;
+    _opaqueProgram = GLProgramCache::getInstance()->getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_OPAQUE);
+    if (_opaqueProgram == nullptr)
+        return;
+
+    glGenBuffers(2, &_opaqueVBO[0]);
+    CHECK_GL_ERROR_DEBUG();
+}
+
+void Renderer::setOpaquePassEnabled(bool enabled)
+{
+    CCASSERT(!_isRendering, "Cannot change the opaque pass while rendering");
+    waitForRenderThread();
+    _isOpaquePassEnabled = enabled;
+}
+
+void Renderer::setGroupBatchingEnabled(bool enabled)
+{
+    CCASSERT(!_isRendering, "Cannot change the group batching while rendering");
+    waitForRenderThread();
+    _isGroupBatchingEnabled = enabled;
+}
+
+void Renderer::setCompactVerticesEnabled(bool enabled)
+{
+    CCASSERT(!_isRendering, "Cannot change the vertex format while rendering");
+    waitForRenderThread();
+    _isCompactVerticesEnabled = enabled;
+}
+
+void Renderer::setMultiTextureBatchingEnabled(bool enabled)
+{
+    CCASSERT(!_isRendering, "Cannot change the multi texture mode while rendering");
+    waitForRenderThread();
+    _isMultiTextureEnabled = enabled;
+}
+
+void Renderer::setInstancingEnabled(bool enabled)
+{
+    CCASSERT(!_isRendering, "Cannot change the instancing mode while rendering");
+    waitForRenderThread();
+    _isInstancingEnabled = enabled;
+}
+
+void Renderer::setDebugMode(DebugMode mode)
+{
+    CCASSERT(!_isRendering, "Cannot change the debug mode while rendering");
+    waitForRenderThread();
+    _debugMode = mode;
+    _loggedDebugBatches.clear();
+
+    if (mode != DebugMode::NONE && _debugProgram == nullptr)
+    {
+        _debugProgram = GLProgramCache::getInstance()->getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_DEBUG);
+        if (_debugProgram)
+        {
+            _debugColorLocation = _debugProgram->getUniformLocation("u_debugColor");
+            _debugTextureAlphaLocation = _debugProgram->getUniformLocation("u_textureAlpha");
+        }
+    }
+}
+
+void Renderer::setDebugOwner(Node* node)
+{
+    s_debugOwner = node;
+}
+
+void Renderer::setupRingBuffers()
+{
+    auto conf = Configuration::getInstance();
+    if (_ringBufferRequested && conf->supportsMapBufferRange())
+    {
+        _trianglesRing = StreamBuffer::createWithBuffer(GL_ARRAY_BUFFER, _buffersVBO[0], sizeof(_verts[0]) * _batchCapacity);
+        _quadRing = StreamBuffer::createWithBuffer(GL_ARRAY_BUFFER, _quadbuffersVBO[0], sizeof(_quadVerts[0]) * _batchCapacity);
+        CC_SAFE_RETAIN(_trianglesRing);
+        CC_SAFE_RETAIN(_quadRing);
+
+        // the client side storage is only used when streaming is off
+        std::vector<V3F_C4B_T2F>().swap(_verts);
+        std::vector<V3F_C4B_T2F>().swap(_quadVerts);
+    }
+}
+
+void Renderer::releaseRingBuffers()
+{
+    if (_quadRing == nullptr)
+        return;
+
+    CC_SAFE_RELEASE_NULL(_trianglesRing);
+    CC_SAFE_RELEASE_NULL(_quadRing);
+
+    if (Configuration::getInstance()->supportsShareableVAO())
+    {
+        // the VAOs point into the middle of the ring buffer, restore them
+        GL::bindVAO(_buffersVAO);
+        GL::bindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+        GL::bufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_DYNAMIC_DRAW);
+        setVertexAttribPointers(0);
+
+        GL::bindVAO(_quadVAO);
+        GL::bindBuffer(GL_ARRAY_BUFFER, _quadbuffersVBO[0]);
+        GL::bufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_DYNAMIC_DRAW);
+        setVertexAttribPointers(0);
+
+        GL::bindVAO(0);
+        GL::bindBuffer(GL_ARRAY_BUFFER, 0);
+        _trianglesVAOCompact = _quadVAOCompact = false;
+    }
+}
+
+void Renderer::setRingBufferEnabled(bool enabled)
+{
+    CCASSERT(!_isRendering, "Cannot change the ring buffer mode while rendering");
+    waitForRenderThread();
+    _ringBufferRequested = enabled;
+
+    if (!_glViewAssigned)
+        return;
+
+    if (enabled && _quadRing == nullptr)
+    {
+        setupRingBuffers();
+    }
+    else if (!enabled)
+    {
+        releaseRingBuffers();
+    }
 }
 
 void Renderer::setupVBOAndVAO()
 {
+    _trianglesVAOCompact = _quadVAOCompact = false;
+
     //generate vbo and vao for trianglesCommand
     glGenVertexArrays(1, &_buffersVAO);
     GL::bindVAO(_buffersVAO);
 
     glGenBuffers(2, &_buffersVBO[0]);
 
-    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * VBO_SIZE, _verts, GL_DYNAMIC_DRAW);
+    GL::bindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+    GL::bufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * _verts.size(), _verts.data(), GL_DYNAMIC_DRAW);
 
-    // vertices
     glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_POSITION);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, vertices));
-
-    // colors
     glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_COLOR);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, colors));
-
-    // tex coords
     glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_TEX_COORD);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, texCoords));
+    setVertexAttribPointers(0);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * INDEX_VBO_SIZE, _indices, GL_STATIC_DRAW);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+    GL::bufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _indices.size(), _indices.data(), GL_STATIC_DRAW);
 
     // Must unbind the VAO before changing the element buffer.
     GL::bindVAO(0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
+
+    //generate vbo and vao for quadCommand, the indices are shared with the other quad based nodes
+    GLuint quadIndicesVBO = QuadIndexBuffer::getInstance()->reserve(0);
 
-    //generate vbo and vao for quadCommand
     glGenVertexArrays(1, &_quadVAO);
     GL::bindVAO(_quadVAO);
 
-    glGenBuffers(2, &_quadbuffersVBO[0]);
+    glGenBuffers(1, &_quadbuffersVBO[0]);
 
-    glBindBuffer(GL_ARRAY_BUFFER, _quadbuffersVBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(_quadVerts[0]) * VBO_SIZE, _quadVerts, GL_DYNAMIC_DRAW);
+    GL::bindBuffer(GL_ARRAY_BUFFER, _quadbuffersVBO[0]);
+    GL::bufferData(GL_ARRAY_BUFFER, sizeof(_quadVerts[0]) * _quadVerts.size(), _quadVerts.data(), GL_DYNAMIC_DRAW);
 
-    // vertices
     glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_POSITION);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, vertices));
-
-    // colors
     glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_COLOR);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, colors));
-
-    // tex coords
     glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_TEX_COORD);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, texCoords));
+    setVertexAttribPointers(0);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _quadbuffersVBO[1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_quadIndices[0]) * INDEX_VBO_SIZE, _quadIndices, GL_STATIC_DRAW);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadIndicesVBO);
 
     // Must unbind the VAO before changing the element buffer.
     GL::bindVAO(0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
 
     CHECK_GL_ERROR_DEBUG();
 }
@@ -324,7 +971,7 @@ void Renderer::setupVBOAndVAO()
 void Renderer::setupVBO()
 {
     glGenBuffers(2, &_buffersVBO[0]);
-    glGenBuffers(2, &_quadbuffersVBO[0]);
+    glGenBuffers(1, &_quadbuffersVBO[0]);
     mapBuffers();
 }
 
@@ -333,28 +980,25 @@ void Renderer::mapBuffers()
     // Avoid changing the element buffer for whatever VAO might be bound.
     GL::bindVAO(0);
 
-    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * VBO_SIZE, _verts, GL_DYNAMIC_DRAW);
-
-    glBindBuffer(GL_ARRAY_BUFFER, _quadbuffersVBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(_quadVerts[0]) * VBO_SIZE, _quadVerts, GL_DYNAMIC_DRAW);
+    GL::bindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+    GL::bufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * _verts.size(), _verts.data(), GL_DYNAMIC_DRAW);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ARRAY_BUFFER, _quadbuffersVBO[0]);
+    GL::bufferData(GL_ARRAY_BUFFER, sizeof(_quadVerts[0]) * _quadVerts.size(), _quadVerts.data(), GL_DYNAMIC_DRAW);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * INDEX_VBO_SIZE, _indices, GL_STATIC_DRAW);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _quadbuffersVBO[1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_quadIndices[0]) * INDEX_VBO_SIZE, _quadIndices, GL_STATIC_DRAW);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+    GL::bufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _indices.size(), _indices.data(), GL_STATIC_DRAW);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
     CHECK_GL_ERROR_DEBUG();
 }
 
 void Renderer::addCommand(RenderCommand* command)
 {
-    int renderQueue =_commandGroupStack.top();
+    int renderQueue = s_commandList ? s_commandList->groupStack.top() : _commandGroupStack.top();
     addCommand(command, renderQueue);
 }
 
@@ -364,48 +1008,167 @@ void Renderer::addCommand(RenderCommand* command, int renderQueue)
     CCASSERT(renderQueue >=0, "Invalid render queue");
     CCASSERT(command->getType() != RenderCommand::Type::UNKNOWN_COMMAND, "Invalid Command Type");
 
-    _renderGroups[renderQueue].push_back(command);
-}
+    if (_debugMode == DebugMode::BATCHES)
+    {
+        command->setDebugOwner(s_debugOwner);
+    }
 
-void Renderer::pushGroup(int renderQueueID)
-{
+    if (s_commandList)
+    {
+        s_commandList->commands.emplace_back(renderQueue, command);
+        return;
+    }
+
+    _renderGroups[renderQueue].push_back(command);
+    ++_frameCommandCount;
+
+    if (command->getType() == RenderCommand::Type::GROUP_COMMAND)
+    {
+        auto groupCommand = static_cast<GroupCommand*>(command);
+        if (groupCommand->isReorderEnabled())
+        {
+            _renderGroups[groupCommand->getRenderQueueID()].setReorderEnabled(true);
+        }
+    }
+}
+
+void Renderer::pushGroup(int renderQueueID)
+{
     CCASSERT(!_isRendering, "Cannot change render queue while rendering");
+    if (s_commandList)
+    {
+        s_commandList->groupStack.push(renderQueueID);
+        return;
+    }
     _commandGroupStack.push(renderQueueID);
 }
 
 void Renderer::popGroup()
 {
     CCASSERT(!_isRendering, "Cannot change render queue while rendering");
+    if (s_commandList)
+    {
+        s_commandList->groupStack.pop();
+        return;
+    }
     _commandGroupStack.pop();
 }
 
 int Renderer::createRenderQueue()
 {
+    std::lock_guard<std::mutex> lock(_renderGroupsMutex);
     RenderQueue newRenderQueue;
     _renderGroups.push_back(newRenderQueue);
     return (int)_renderGroups.size() - 1;
 }
 
+void Renderer::beginCommandList(CommandList* list)
+{
+    CCASSERT(s_commandList == nullptr, "The thread is already recording a command list");
+    list->commands.clear();
+    list->groupStack = std::stack<int>();
+    list->groupStack.push(_commandGroupStack.top());
+    s_commandList = list;
+}
+
+void Renderer::endCommandList()
+{
+    CCASSERT(s_commandList && s_commandList->groupStack.size() == 1, "Unbalanced pushGroup()/popGroup() in the command list");
+    s_commandList = nullptr;
+    s_debugOwner = nullptr;
+}
+
+bool Renderer::isRecordingCommandList()
+{
+    return s_commandList != nullptr;
+}
+
+void Renderer::submitCommandList(CommandList& list)
+{
+    CCASSERT(s_commandList == nullptr, "Command lists must be submitted by the main thread");
+    for (const auto& entry : list.commands)
+    {
+        addCommand(entry.second, entry.first);
+    }
+    list.commands.clear();
+}
+
+void Renderer::setRenderQueueReorderEnabled(int renderQueueID, bool enabled)
+{
+    CCASSERT(renderQueueID >= 0 && renderQueueID < (int)_renderGroups.size(), "Invalid render queue");
+    _renderGroups[renderQueueID].setReorderEnabled(enabled);
+}
+
 void Renderer::processRenderCommand(RenderCommand* command)
 {
+    //the batches drawn for this command are drawn because it doesn't fit them, unless said otherwise below
+    breakBatch(BatchBreak::STATE, command);
+
     auto commandType = command->getType();
-    if( RenderCommand::Type::TRIANGLES_COMMAND == commandType)
+    if (RenderCommand::Type::TRIANGLES_COMMAND == commandType && canDrawInstanced(static_cast<TrianglesCommand*>(command)))
+    {
+        //Draw if we have batched other commands which are not instanced
+        flushMultiTextures();
+        flushQuads();
+        flushTriangles();
+
+        auto cmd = static_cast<TrianglesCommand*>(command);
+
+        //Draw batched instances if the batch is full
+        if ((ssize_t)(_instances.size() + 1) * 4 > _batchCapacity)
+        {
+            ++_capacityBreaks;
+            breakBatch(BatchBreak::CAPACITY, command);
+            drawBatchedInstances();
+        }
+
+        _batchInstanceCommands.push_back(cmd);
+        fillInstance(cmd);
+    }
+    else if (RenderCommand::Type::TRIANGLES_COMMAND == commandType && canDrawMultiTexture(static_cast<TrianglesCommand*>(command)))
+    {
+        //Draw if we have batched other commands which don't pick their texture per vertex
+        flushInstances();
+        flushQuads();
+        flushTriangles();
+
+        fillMultiTexture(static_cast<TrianglesCommand*>(command));
+    }
+    else if( RenderCommand::Type::TRIANGLES_COMMAND == commandType)
     {
         //Draw if we have batched other commands which are not triangle command
+        flushInstances();
+        flushMultiTextures();
         flushQuads();
 
         //Process triangle command
         auto cmd = static_cast<TrianglesCommand*>(command);
 
+        //Draw batched Triangles if the vertex format changes
+        const bool compact = _isCompactVerticesEnabled && canCompactVertices(cmd->getModelView(), cmd->getVertices(), cmd->getVertexCount());
+        if (compact != _trianglesCompact)
+        {
+            drawBatchedTriangles();
+            _trianglesCompact = compact;
+        }
+
         //Draw batched Triangles if necessary
-        if(cmd->isSkipBatching() || _filledVertex + cmd->getVertexCount() > VBO_SIZE || _filledIndex + cmd->getIndexCount() > INDEX_VBO_SIZE)
+        if(cmd->isSkipBatching() || _filledVertex + cmd->getVertexCount() > _batchCapacity || _filledIndex + cmd->getIndexCount() > _batchCapacity * 6 / 4
+           || (_trianglesRing && !_trianglesRing->fits(getTrianglesVertexSize() * (_filledVertex + cmd->getVertexCount()))))
         {
             CCASSERT(cmd->getVertexCount()>= 0 && cmd->getVertexCount() < VBO_SIZE, "VBO for vertex is not big enough, please break the data down or use customized render command");
             CCASSERT(cmd->getIndexCount()>= 0 && cmd->getIndexCount() < INDEX_VBO_SIZE, "VBO for index is not big enough, please break the data down or use customized render command");
+            if (!cmd->isSkipBatching() && _filledVertex > 0)
+            {
+                ++_capacityBreaks;
+                breakBatch(BatchBreak::CAPACITY, command);
+            }
             //Draw batched Triangles if VBO is full
             drawBatchedTriangles();
         }
 
+        reserveTriangles(cmd->getVertexCount(), cmd->getIndexCount());
+
         //Batch Triangles
         _batchedCommands.push_back(cmd);
 
@@ -413,6 +1176,7 @@ void Renderer::processRenderCommand(RenderCommand* command)
 
         if(cmd->isSkipBatching())
         {
+            breakBatch(BatchBreak::STATE, command);
             drawBatchedTriangles();
         }
 
@@ -420,19 +1184,37 @@ void Renderer::processRenderCommand(RenderCommand* command)
     else if ( RenderCommand::Type::QUAD_COMMAND == commandType )
     {
         //Draw if we have batched other commands which are not quad command
+        flushInstances();
+        flushMultiTextures();
         flushTriangles();
 
         //Process quad command
         auto cmd = static_cast<QuadCommand*>(command);
 
+        //Draw batched quads if the vertex format changes
+        const bool compact = _isCompactVerticesEnabled && canCompactVertices(cmd->getModelView(), (const V3F_C4B_T2F*)cmd->getQuads(), cmd->getQuadCount() * 4);
+        if (compact != _quadsCompact)
+        {
+            drawBatchedQuads();
+            _quadsCompact = compact;
+        }
+
         //Draw batched quads if necessary
-        if(cmd->isSkipBatching()|| (_numberQuads + cmd->getQuadCount()) * 4 > VBO_SIZE )
+        if(cmd->isSkipBatching()|| (_numberQuads + cmd->getQuadCount()) * 4 > _batchCapacity
+           || (_quadRing && !_quadRing->fits(getQuadsVertexSize() * (_numberQuads + cmd->getQuadCount()) * 4)))
         {
             CCASSERT(cmd->getQuadCount()>= 0 && cmd->getQuadCount() * 4 < VBO_SIZE, "VBO for vertex is not big enough, please break the data down or use customized render command");
+            if (!cmd->isSkipBatching() && _numberQuads > 0)
+            {
+                ++_capacityBreaks;
+                breakBatch(BatchBreak::CAPACITY, command);
+            }
             //Draw batched quads if VBO is full
             drawBatchedQuads();
         }
 
+        reserveQuads(cmd->getQuadCount());
+
         //Batch Quads
         _batchQuadCommands.push_back(cmd);
 
@@ -440,266 +1222,1418 @@ void Renderer::processRenderCommand(RenderCommand* command)
 
         if(cmd->isSkipBatching())
         {
-            drawBatchedQuads();
+            breakBatch(BatchBreak::STATE, command);
+            drawBatchedQuads();
+        }
+    }
+    else if(RenderCommand::Type::GROUP_COMMAND == commandType)
+    {
+        //the batch only breaks at the group when the state of its queue differs, see setGroupBatchingEnabled()
+        breakBatch(BatchBreak::GROUP_COMMAND, command);
+        if (!_isGroupBatchingEnabled)
+        {
+            flush();
+        }
+        int renderQueueID = ((GroupCommand*) command)->getRenderQueueID();
+        visitRenderQueue((*_drawnGroups)[renderQueueID]);
+    }
+    else if(RenderCommand::Type::CUSTOM_COMMAND == commandType)
+    {
+        breakBatch(BatchBreak::CUSTOM_COMMAND, command);
+        flush();
+        auto cmd = static_cast<CustomCommand*>(command);
+        SubmitTimer timer(_isTimingsEnabled, _submitTime);
+        cmd->execute();
+    }
+    else if(RenderCommand::Type::BATCH_COMMAND == commandType)
+    {
+        breakBatch(BatchBreak::CUSTOM_COMMAND, command);
+        flush();
+        auto cmd = static_cast<BatchCommand*>(command);
+        SubmitTimer timer(_isTimingsEnabled, _submitTime);
+        cmd->execute();
+    }
+    else if(RenderCommand::Type::PRIMITIVE_COMMAND == commandType)
+    {
+        breakBatch(BatchBreak::CUSTOM_COMMAND, command);
+        flush();
+        auto cmd = static_cast<PrimitiveCommand*>(command);
+        SubmitTimer timer(_isTimingsEnabled, _submitTime);
+        cmd->execute();
+    }
+    else
+    {
+        CCLOGERROR("Unknown commands in renderQueue");
+    }
+
+    //the batches drawn from now on end with their global z group
+    breakBatch(BatchBreak::END_OF_QUEUE, nullptr);
+}
+
+void Renderer::visitRenderQueue(RenderQueue& queue)
+{
+    queue.saveRenderState();
+
+    //the opaque commands the queue starts with are already drawn, they are skipped below
+    size_t opaqueCount = drawOpaqueCommands(queue);
+
+    //the global z groups in the order they are drawn, each starts where the opaque commands end
+    const RenderQueue::QUEUE_GROUP groups[] = {RenderQueue::GLOBALZ_NEG, RenderQueue::GLOBALZ_ZERO, RenderQueue::GLOBALZ_POS};
+    for (auto group : groups)
+    {
+        const auto& commands = queue.getSubQueue(group);
+        const size_t first = std::min(opaqueCount, commands.size());
+        opaqueCount -= first;
+        if (first == commands.size())
+            continue;
+
+        apply2DState();
+        for (auto it = commands.cbegin() + first; it != commands.cend(); ++it)
+        {
+            processRenderCommand(*it);
+        }
+        if (!_isGroupBatchingEnabled)
+        {
+            flush();
+        }
+    }
+
+    //the batch goes on in the parent queue, unless it was filled with a state the parent doesn't have
+    if (_isGroupBatchingEnabled && queue.isRenderStateChanged())
+    {
+        flush();
+    }
+    queue.restoreRenderState();
+}
+
+void Renderer::apply2DState()
+{
+    //the pending batches were filled with the current state, they are only drawn first if it changes
+    const bool depthTest = _isDepthTestFor2D;
+    if (_isGroupBatchingEnabled
+        && (GL::isEnabled(GL_DEPTH_TEST) != depthTest || (GL::getDepthMask() != GL_FALSE) != depthTest || !GL::isEnabled(GL_BLEND)))
+    {
+        flush();
+    }
+
+    if (depthTest)
+    {
+        GL::enable(GL_DEPTH_TEST);
+        GL::depthMask(true);
+    }
+    else
+    {
+        GL::disable(GL_DEPTH_TEST);
+        GL::depthMask(false);
+    }
+    GL::enable(GL_BLEND);
+
+    RenderState::StateBlock::_defaultState->setDepthTest(depthTest);
+    RenderState::StateBlock::_defaultState->setDepthWrite(depthTest);
+    RenderState::StateBlock::_defaultState->setBlend(true);
+}
+
+bool Renderer::canDrawOpaque(const RenderCommand* command) const
+{
+    if (command->getType() != RenderCommand::Type::TRIANGLES_COMMAND || command->isTransparent())
+        return false;
+
+    auto cmd = static_cast<const TrianglesCommand*>(command);
+    return !cmd->isSkipBatching() && cmd->getMaterialID() != MATERIAL_ID_DO_NOT_BATCH
+        && cmd->getGLProgramState()->getGLProgram() == _instanceSourceProgram
+        && isInPlaneZ0(cmd->getModelView(), cmd->getVertices(), cmd->getVertexCount());
+}
+
+size_t Renderer::drawOpaqueCommands(RenderQueue& queue)
+{
+    if (!isOpaquePassEnabled() || _isDepthTestFor2D || _debugMode != DebugMode::NONE)
+        return 0;
+
+    // the commands at the back of the painter's order, nothing transparent is behind them
+    _opaqueCommands.clear();
+    const RenderQueue::QUEUE_GROUP groups[] = {RenderQueue::GLOBALZ_NEG, RenderQueue::GLOBALZ_ZERO, RenderQueue::GLOBALZ_POS};
+    for (auto group : groups)
+    {
+        const auto& commands = queue.getSubQueue(group);
+        size_t i = 0;
+        while (i < commands.size() && canDrawOpaque(commands[i]))
+        {
+            _opaqueCommands.push_back(static_cast<TrianglesCommand*>(commands[i]));
+            ++i;
+        }
+        if (i < commands.size())
+            break;
+    }
+
+    // a single command can't hide anything
+    if (_opaqueCommands.size() < 2)
+        return 0;
+
+    GLint depthBits = 0;
+    glGetIntegerv(GL_DEPTH_BITS, &depthBits);
+    if (depthBits == 0)
+        return 0;
+
+    flush();
+
+    GL::enable(GL_DEPTH_TEST);
+    GL::depthMask(true);
+    GL::depthFunc(GL_LEQUAL);
+    GL::disable(GL_BLEND);
+    glClear(GL_DEPTH_BUFFER_BIT);
+
+    // front to back, the last command of the painter's order is the nearest
+    const size_t count = _opaqueCommands.size();
+    for (size_t i = count; i-- > 0;)
+    {
+        const TrianglesCommand* cmd = _opaqueCommands[i];
+        const ssize_t vertexCount = cmd->getVertexCount();
+        const ssize_t indexCount = cmd->getIndexCount();
+
+        if (!_opaqueIndices.empty()
+            && (cmd->getTextureID() != _opaqueTexture
+                || (ssize_t)_opaqueVerts.size() + vertexCount > _batchCapacity
+                || (ssize_t)_opaqueIndices.size() + indexCount > _batchCapacity * 6 / 4))
+        {
+            drawBatchedOpaque();
+        }
+        _opaqueTexture = cmd->getTextureID();
+
+        const float depth = 1.0f - 2.0f * (i + 1) / (count + 1);
+        const GLushort firstVertex = (GLushort)_opaqueVerts.size();
+        const Mat4& modelView = cmd->getModelView();
+        const V3F_C4B_T2F* vertices = cmd->getVertices();
+        for (ssize_t v = 0; v < vertexCount; ++v)
+        {
+            _opaqueVerts.push_back(vertices[v]);
+            V3F_C4B_T2F& vertex = _opaqueVerts.back();
+            modelView.transformPoint(vertices[v].vertices, &vertex.vertices);
+            vertex.vertices.z = depth;
+        }
+
+        const unsigned short* indices = cmd->getIndices();
+        for (ssize_t n = 0; n < indexCount; ++n)
+        {
+            _opaqueIndices.push_back(firstVertex + indices[n]);
+        }
+    }
+    drawBatchedOpaque();
+
+    GL::enable(GL_BLEND);
+    return count;
+}
+
+void Renderer::drawBatchedOpaque()
+{
+    if (_opaqueIndices.empty())
+        return;
+
+    SubmitTimer timer(_isTimingsEnabled, _submitTime);
+
+    // binds VAO 0
+    GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX);
+
+    // orphan the buffers, the previous batch may still be in flight
+    GL::bindBuffer(GL_ARRAY_BUFFER, _opaqueVBO[0]);
+    GL::bufferData(GL_ARRAY_BUFFER, sizeof(_opaqueVerts[0]) * _opaqueVerts.size(), _opaqueVerts.data(), GL_STREAM_DRAW);
+    setVertexAttribPointers(0);
+
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _opaqueVBO[1]);
+    GL::bufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_opaqueIndices[0]) * _opaqueIndices.size(), _opaqueIndices.data(), GL_STREAM_DRAW);
+
+    GL::bindTexture2D(_opaqueTexture);
+    _opaqueProgram->use();
+    _opaqueProgram->setUniformsForBuiltins(Mat4::IDENTITY);
+
+    glDrawElements(GL_TRIANGLES, (GLsizei)_opaqueIndices.size(), GL_UNSIGNED_SHORT, (GLvoid*)0);
+    _drawnBatches++;
+    _drawnVertices += _opaqueIndices.size();
+
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    // the program state of the next batch must be applied again
+    _lastMaterialID = 0;
+
+    _peakBatchVertices = std::max(_peakBatchVertices, (int)_opaqueVerts.size());
+    _opaqueVerts.clear();
+    _opaqueIndices.clear();
+}
+
+void Renderer::render()
+{
+    CC_TRACE_ZONE("renderer", "Renderer::render");
+
+    // the nodes may be gone by the next frame
+    s_debugOwner = nullptr;
+
+    if (_renderThread)
+    {
+        // the previous frame must be drawn before its storage is reused
+        waitForRenderThread();
+        reportTimings();
+        recycleFrame();
+        captureFrame();
+        _timedFrame = Director::getInstance()->getTotalFrames();
+
+        // the textures and buffers created on the main thread must reach the shared objects
+        glFlush();
+        {
+            std::lock_guard<std::mutex> lock(_renderThread->mutex);
+            _renderThread->hasFrame = true;
+        }
+        _renderThread->condition.notify_all();
+
+        if (_renderThread->needsSync)
+        {
+            waitForRenderThread();
+        }
+        return;
+    }
+
+    //Uncomment this once everything is rendered by new renderer
+    //glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    //TODO: setup MVP
+    _isRendering = true;
+
+    if (_glViewAssigned)
+    {
+        _timedFrame = Director::getInstance()->getTotalFrames();
+        drawFrame(_renderGroups);
+
+        if (_shrinkRequested)
+        {
+            shrinkBuffers();
+            _shrinkRequested = false;
+        }
+        reportTimings();
+    }
+    clean();
+    _isRendering = false;
+}
+
+void Renderer::drawFrame(std::vector<RenderQueue>& renderGroups)
+{
+    CC_TRACE_ZONE("renderer", "Renderer::drawFrame");
+
+    _drawnGroups = &renderGroups;
+
+    FrameTimings::Clock::time_point start;
+    if (_isTimingsEnabled)
+    {
+        start = FrameTimings::Clock::now();
+        _sortTime = _submitTime = 0;
+        beginTimerQuery();
+    }
+
+    if (_quadRing)
+    {
+        _trianglesRing->beginFrame();
+        _quadRing->beginFrame();
+    }
+    _debugBatches.clear();
+
+    //Process render commands
+    //1. Sort render commands based on ID
+    for (auto &renderqueue : renderGroups)
+    {
+        renderqueue.sort();
+    }
+    if (_isTimingsEnabled)
+    {
+        _sortTime = FrameTimings::elapsed(start);
+    }
+    visitRenderQueue(renderGroups[0]);
+    flush();
+
+    // flush() may have turned the ring buffer off if mapping failed
+    if (_quadRing)
+    {
+        _trianglesRing->endFrame();
+        _quadRing->endFrame();
+    }
+
+    if (_isTimingsEnabled)
+    {
+        endTimerQuery();
+        _renderTime = FrameTimings::elapsed(start);
+    }
+
+    _drawnGroups = &_renderGroups;
+
+    if (_debugMode == DebugMode::BATCHES)
+    {
+        logDebugBatches();
+    }
+
+    RenderTargetPool::endFrame();
+
+#if CC_GL_STATE_CACHE_VALIDATION
+    GL::validateStateCache();
+#endif
+    // the state calls of the thread since the previous frame, the uploads of the update included
+    auto stateCalls = GL::getStateCacheStats();
+    _issuedStateCalls = stateCalls.issued;
+    _skippedStateCalls = stateCalls.skipped;
+    GL::resetStateCacheStats();
+}
+
+void Renderer::clean()
+{
+    recordCommandCount();
+
+    // Clear render group
+    for (size_t j = 0 ; j < _renderGroups.size(); j++)
+    {
+        //commands are owned by nodes
+        // for (const auto &cmd : _renderGroups[j])
+        // {
+        //     cmd->releaseToCommandPool();
+        // }
+        _renderGroups[j].clear();
+    }
+
+    // the batches and the arena of the frame belong to the render thread when it's enabled
+    if (!_renderThread)
+    {
+        resetBatches();
+        _frameArenas[_frameArenaIndex].reset();
+    }
+}
+
+void Renderer::recordCommandCount()
+{
+    _commandCount = _frameCommandCount;
+    _peakCommandCount = std::max(_peakCommandCount, _commandCount);
+    _frameCommandCount = 0;
+}
+
+void Renderer::shrinkToFit()
+{
+    _shrinkRequested = true;
+    _frameArenas[0].shrinkToFit();
+    _frameArenas[1].shrinkToFit();
+}
+
+void Renderer::resetBatches()
+{
+    // Clear batch commands
+    _batchedCommands.clear();
+    _batchQuadCommands.clear();
+    _filledVertex = 0;
+    _filledIndex = 0;
+    _numberQuads = 0;
+    _lastMaterialID = 0;
+}
+
+void Renderer::clear()
+{
+    if (_renderThread)
+    {
+        _clearRequested = true;
+        return;
+    }
+
+    clearBuffers(_clearColor);
+}
+
+void Renderer::clearBuffers(const Color4F& clearColor)
+{
+    //Enable Depth mask to make sure glClear clear the depth buffer correctly
+    GL::depthMask(true);
+    if (_debugMode == DebugMode::OVERDRAW)
+        glClearColor(0, 0, 0, 1);
+    else
+        glClearColor(clearColor.r, clearColor.g, clearColor.b, clearColor.a);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    GL::depthMask(false);
+
+    RenderState::StateBlock::_defaultState->setDepthWrite(false);
+}
+
+void Renderer::setRenderThreadEnabled(bool enabled)
+{
+    if (enabled == isRenderThreadEnabled())
+        return;
+
+    CCASSERT(!_isRendering, "Cannot change the render thread while rendering");
+
+    if (enabled)
+    {
+        auto glview = Director::getInstance()->getOpenGLView();
+        if (!_glViewAssigned || glview == nullptr || !glview->isRenderThreadSupported())
+        {
+            CCLOG("cocos2d: Renderer: the render thread isn't supported by the GLView");
+            return;
+        }
+        if (Configuration::getInstance()->supportsShareableVAO())
+        {
+            CCLOG("cocos2d: Renderer: the render thread can't draw the VAOs of the main thread, set cocos2d.x.renderer.render_thread before the GLView");
+            return;
+        }
+
+        // the render thread takes the context over with everything drawn so far,
+        // its timer queries are its own
+        collectTimerQueries();
+        reportTimings();
+        deleteTimerQueries();
+        GL::enableVertexAttribs(0);
+        glFinish();
+        glview->makeContextCurrent(false);
+
+        _renderThread = new (std::nothrow) RenderThread();
+        _renderThread->glview = glview;
+        _renderThread->thread = std::thread(&Renderer::runRenderThread, this);
+
+        glview->makeSharedContextCurrent(true);
+        GL::invalidateContextStateCache();
+    }
+    else
+    {
+        waitForRenderThread();
+        reportTimings();
+        recycleFrame();
+        {
+            std::lock_guard<std::mutex> lock(_renderThread->mutex);
+            _renderThread->quit = true;
+        }
+        _renderThread->condition.notify_all();
+        _renderThread->thread.join();
+
+        auto glview = _renderThread->glview;
+        CC_SAFE_DELETE(_renderThread);
+
+        GL::enableVertexAttribs(0);
+        glFinish();
+        glview->makeSharedContextCurrent(false);
+        glview->makeContextCurrent(true);
+        GL::invalidateContextStateCache();
+
+        _clearRequested = false;
+        if (_depthTestChanged)
+        {
+            applyDepthTest();
+            _depthTestChanged = false;
+        }
+    }
+}
+
+void Renderer::waitForRenderThread()
+{
+    if (!_renderThread)
+        return;
+
+    std::unique_lock<std::mutex> lock(_renderThread->mutex);
+    _renderThread->condition.wait(lock, [this]{ return !_renderThread->hasFrame; });
+}
+
+void Renderer::deleteTexture(GLuint name)
+{
+    if (_renderThread)
+    {
+        _renderThread->deletedTextures.push_back(name);
+        return;
+    }
+    GL::deleteTexture(name);
+}
+
+void Renderer::runRenderThread()
+{
+    auto frame = _renderThread;
+    Tracer::setThreadName("render");
+    frame->glview->makeContextCurrent(true);
+    GL::invalidateContextStateCache();
+
+    std::unique_lock<std::mutex> lock(frame->mutex);
+    while (true)
+    {
+        frame->condition.wait(lock, [frame]{ return frame->hasFrame || frame->quit; });
+        if (!frame->hasFrame)
+            break;
+
+        lock.unlock();
+        drawCapturedFrame();
+        auto swapStart = FrameTimings::Clock::now();
+        {
+            CC_TRACE_ZONE("renderer", "GLView::swapBuffers");
+            frame->glview->swapBuffers();
+        }
+        if (_isTimingsEnabled)
+        {
+            _swapTime = FrameTimings::elapsed(swapStart);
+        }
+        lock.lock();
+
+        frame->hasFrame = false;
+        frame->condition.notify_all();
+    }
+
+    // the GPU times that are ready go to the main thread, the others are dropped with the queries
+    collectTimerQueries();
+    deleteTimerQueries();
+    GL::enableVertexAttribs(0);
+    frame->glview->makeContextCurrent(false);
+}
+
+void Renderer::drawCapturedFrame()
+{
+    auto frame = _renderThread;
+
+    clearDrawStats();
+    // the main thread deletes and creates the objects this context may still have bound
+    GL::invalidateSharedObjectBindings();
+
+    // the viewport set by the Director on the main thread went to the shared context
+    Director::getInstance()->setViewport();
+    if (frame->applyDepthTest)
+    {
+        applyDepthTest();
+    }
+    if (frame->clear)
+    {
+        clearBuffers(frame->clearColor);
+    }
+
+    drawFrame(frame->renderGroups);
+    resetBatches();
+
+    if (frame->shrink)
+    {
+        shrinkBuffers();
+    }
+}
+
+void Renderer::captureFrame()
+{
+    auto frame = _renderThread;
+
+    // count first, the copies must not move once the render queues point to them
+    ssize_t trianglesCount = 0, quadsCount = 0, groupsCount = 0;
+    ssize_t vertexCount = 0, indexCount = 0, quadCount = 0;
+    frame->needsSync = false;
+    for (auto& queue : _renderGroups)
+    {
+        for (int i = 0; i < RenderQueue::QUEUE_COUNT; ++i)
+        {
+            for (auto command : queue.getSubQueue((RenderQueue::QUEUE_GROUP)i))
+            {
+                auto commandType = command->getType();
+                if (RenderCommand::Type::TRIANGLES_COMMAND == commandType)
+                {
+                    auto cmd = static_cast<TrianglesCommand*>(command);
+                    ++trianglesCount;
+                    vertexCount += cmd->getVertexCount();
+                    indexCount += cmd->getIndexCount();
+                    // the uniforms are read from the GLProgramState when the command is drawn
+                    frame->needsSync |= cmd->getGLProgramState()->getUniformCount() > 0;
+                }
+                else if (RenderCommand::Type::QUAD_COMMAND == commandType)
+                {
+                    auto cmd = static_cast<QuadCommand*>(command);
+                    ++quadsCount;
+                    quadCount += cmd->getQuadCount();
+                    frame->needsSync |= cmd->getGLProgramState()->getUniformCount() > 0;
+                }
+                else if (RenderCommand::Type::GROUP_COMMAND == commandType)
+                {
+                    ++groupsCount;
+                }
+                else if (RenderCommand::Type::CUSTOM_COMMAND != commandType || !isFrameCustomCommand(static_cast<CustomCommand*>(command)))
+                {
+                    // custom, batch and primitive commands call back into their nodes,
+                    // unless they were created for the frame with their context, the arena goes to the render thread
+                    frame->needsSync = true;
+                }
+            }
+        }
+    }
+
+    frame->trianglesCommands.reserve(trianglesCount);
+    frame->quadCommands.reserve(quadsCount);
+    frame->groupCommands.reserve(groupsCount);
+    frame->vertices.reserve(vertexCount);
+    frame->indices.reserve(indexCount);
+    frame->quads.reserve(quadCount);
+
+    // the ids of the groups stay valid, the renderer goes on with the emptied queues of the previous frame
+    frame->renderGroups.swap(_renderGroups);
+    _renderGroups.resize(frame->renderGroups.size());
+
+    for (auto& queue : frame->renderGroups)
+    {
+        for (int i = 0; i < RenderQueue::QUEUE_COUNT; ++i)
+        {
+            for (auto& command : queue.getSubQueue((RenderQueue::QUEUE_GROUP)i))
+            {
+                auto commandType = command->getType();
+                if (RenderCommand::Type::TRIANGLES_COMMAND == commandType)
+                {
+                    auto cmd = static_cast<TrianglesCommand*>(command);
+                    frame->trianglesCommands.push_back(*cmd);
+                    auto& copy = frame->trianglesCommands.back();
+
+                    copy._triangles.verts = frame->vertices.data() + frame->vertices.size();
+                    frame->vertices.insert(frame->vertices.end(), cmd->getVertices(), cmd->getVertices() + cmd->getVertexCount());
+                    copy._triangles.indices = frame->indices.data() + frame->indices.size();
+                    frame->indices.insert(frame->indices.end(), cmd->getIndices(), cmd->getIndices() + cmd->getIndexCount());
+
+                    copy._glProgramState->retain();
+                    frame->programStates.push_back(copy._glProgramState);
+                    command = &copy;
+                }
+                else if (RenderCommand::Type::QUAD_COMMAND == commandType)
+                {
+                    auto cmd = static_cast<QuadCommand*>(command);
+                    frame->quadCommands.push_back(*cmd);
+                    auto& copy = frame->quadCommands.back();
+
+                    copy._quads = frame->quads.data() + frame->quads.size();
+                    frame->quads.insert(frame->quads.end(), cmd->getQuads(), cmd->getQuads() + cmd->getQuadCount());
+
+                    copy._glProgramState->retain();
+                    frame->programStates.push_back(copy._glProgramState);
+                    command = &copy;
+                }
+                else if (RenderCommand::Type::GROUP_COMMAND == commandType)
+                {
+                    frame->groupCommands.push_back(*static_cast<GroupCommand*>(command));
+                    command = &frame->groupCommands.back();
+                }
+            }
+        }
+    }
+
+    // the debug owners of the commands are read while they are drawn
+    frame->needsSync |= _debugMode == DebugMode::BATCHES;
+
+    frame->clearColor = _clearColor;
+    frame->clear = _clearRequested;
+    frame->applyDepthTest = _depthTestChanged;
+    frame->shrink = _shrinkRequested;
+    _clearRequested = false;
+    _depthTestChanged = false;
+    _shrinkRequested = false;
+
+    // the commands created for the frame stay in their arena until it's recycled
+    _frameArenaIndex ^= 1;
+    recordCommandCount();
+}
+
+bool Renderer::isFrameCustomCommand(CustomCommand* command)
+{
+    auto arena = getFrameArena();
+    return command->getCallback() && arena->contains(command)
+        && (command->getCallbackContext() == nullptr || arena->contains(command->getCallbackContext()));
+}
+
+void Renderer::recycleFrame()
+{
+    auto frame = _renderThread;
+
+    for (auto& queue : frame->renderGroups)
+    {
+        queue.clear();
+    }
+    frame->trianglesCommands.clear();
+    frame->quadCommands.clear();
+    frame->groupCommands.clear();
+    frame->vertices.clear();
+    frame->indices.clear();
+    frame->quads.clear();
+    _frameArenas[_frameArenaIndex ^ 1].reset();
+
+    for (auto programState : frame->programStates)
+    {
+        programState->release();
+    }
+    frame->programStates.clear();
+
+    for (auto name : frame->deletedTextures)
+    {
+        GL::deleteTexture(name);
+    }
+    frame->deletedTextures.clear();
+}
+
+void Renderer::setTimingsEnabled(bool enabled)
+{
+    // the render thread reads the flag while it draws
+    waitForRenderThread();
+    reportTimings();
+    _isTimingsEnabled = enabled;
+}
+
+void Renderer::beginTimerQuery()
+{
+#if CC_GL_TIMER_QUERY
+    if (!Configuration::getInstance()->supportsTimerQuery())
+        return;
+
+    collectTimerQueries();
+    // the GPU is more than TIMER_QUERY_COUNT frames behind, this frame goes without GPU time
+    if (_timerQueryCount == TIMER_QUERY_COUNT)
+        return;
+
+    if (_timerQueries[0] == 0)
+    {
+        glGenQueries(TIMER_QUERY_COUNT, _timerQueries);
+    }
+
+    int index = (_timerQueryFirst + _timerQueryCount) % TIMER_QUERY_COUNT;
+    _timerQueryFrames[index] = _timedFrame;
+    glBeginQuery(GL_TIME_ELAPSED_EXT, _timerQueries[index]);
+    _isTimerQueryActive = true;
+#endif
+}
+
+void Renderer::endTimerQuery()
+{
+#if CC_GL_TIMER_QUERY
+    if (_isTimerQueryActive)
+    {
+        glEndQuery(GL_TIME_ELAPSED_EXT);
+        _isTimerQueryActive = false;
+        ++_timerQueryCount;
+    }
+#endif
+}
+
+void Renderer::collectTimerQueries()
+{
+#if CC_GL_TIMER_QUERY
+    if (_timerQueryCount == 0)
+        return;
+
+#ifdef GL_GPU_DISJOINT_EXT
+    // the results of the pending queries are meaningless after a disjoint operation, e.g. a frequency change
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+    if (disjoint)
+    {
+        _timerQueryFirst = _timerQueryCount = 0;
+        return;
+    }
+#endif
+
+    while (_timerQueryCount > 0)
+    {
+        GLuint query = _timerQueries[_timerQueryFirst];
+        GLuint available = 0;
+        glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            break;
+
+        uint64_t nanoseconds = 0;
+        glGetQueryObjectui64vEXT(query, GL_QUERY_RESULT, &nanoseconds);
+        _gpuTimes.push_back(std::make_pair(_timerQueryFrames[_timerQueryFirst], nanoseconds / 1000000.0f));
+
+        _timerQueryFirst = (_timerQueryFirst + 1) % TIMER_QUERY_COUNT;
+        --_timerQueryCount;
+    }
+#endif
+}
+
+void Renderer::deleteTimerQueries()
+{
+#if CC_GL_TIMER_QUERY
+    if (_timerQueries[0])
+    {
+        glDeleteQueries(TIMER_QUERY_COUNT, _timerQueries);
+    }
+#endif
+    for (int i = 0; i < TIMER_QUERY_COUNT; ++i)
+    {
+        _timerQueries[i] = 0;
+    }
+    _timerQueryFirst = _timerQueryCount = 0;
+}
+
+void Renderer::reportTimings()
+{
+    auto timings = Director::getInstance()->getFrameTimings();
+    if (!_isTimingsEnabled || timings == nullptr)
+    {
+        _gpuTimes.clear();
+        _renderTime = -1;
+        return;
+    }
+
+    auto timing = _renderTime >= 0 ? timings->find(_timedFrame) : nullptr;
+    if (timing)
+    {
+        timing->sort = _sortTime;
+        timing->submit = _submitTime;
+        timing->batchFill = std::max(_renderTime - _sortTime - _submitTime, 0.0f);
+        timing->issuedStateCalls = _issuedStateCalls;
+        timing->skippedStateCalls = _skippedStateCalls;
+        if (_renderThread)
+        {
+            // the Director doesn't see the swap and the stats of the frames drawn by the render thread
+            timing->swap = _swapTime;
+            timing->drawnBatches = _drawnBatches;
+            timing->drawnVertices = _drawnVertices;
+        }
+    }
+    _renderTime = -1;
+
+    for (const auto& gpuTime : _gpuTimes)
+    {
+        auto frame = timings->find(gpuTime.first);
+        if (frame)
+        {
+            frame->gpu = gpuTime.second;
+        }
+    }
+    _gpuTimes.clear();
+}
+
+void Renderer::setDepthTest(bool enable)
+{
+    if (_renderThread)
+    {
+        // the GL state belongs to the context of the render thread
+        waitForRenderThread();
+        _isDepthTestFor2D = enable;
+        _depthTestChanged = true;
+        return;
+    }
+
+    _isDepthTestFor2D = enable;
+    applyDepthTest();
+}
+
+void Renderer::applyDepthTest()
+{
+    if (_isDepthTestFor2D)
+    {
+        glClearDepth(1.0f);
+        GL::enable(GL_DEPTH_TEST);
+        GL::depthFunc(GL_LEQUAL);
+
+        RenderState::StateBlock::_defaultState->setDepthTest(true);
+        RenderState::StateBlock::_defaultState->setDepthFunction(RenderState::DEPTH_LEQUAL);
+
+//        glHint(GL_PERSPECTIVE_CORRECTION_HINT, GL_NICEST);
+    }
+    else
+    {
+        GL::disable(GL_DEPTH_TEST);
+
+        RenderState::StateBlock::_defaultState->setDepthTest(false);
+    }
+
+    CHECK_GL_ERROR_DEBUG();
+}
+
+void Renderer::pushScissor(const Rect& ndcRect)
+{
+    ScissorState previous;
+    previous.enabled = GL::isEnabled(GL_SCISSOR_TEST);
+    if (previous.enabled)
+    {
+        GL::getScissorBox(previous.box);
+    }
+    _scissorStates.push_back(previous);
+
+    GLint viewport[4];
+    GL::getViewport(viewport);
+    // the edges are rounded to the nearest pixel, like the ones of the rasterized rect
+    GLint left = viewport[0] + (GLint)std::floor((ndcRect.getMinX() + 1) * 0.5f * viewport[2] + 0.5f);
+    GLint right = viewport[0] + (GLint)std::floor((ndcRect.getMaxX() + 1) * 0.5f * viewport[2] + 0.5f);
+    GLint bottom = viewport[1] + (GLint)std::floor((ndcRect.getMinY() + 1) * 0.5f * viewport[3] + 0.5f);
+    GLint top = viewport[1] + (GLint)std::floor((ndcRect.getMaxY() + 1) * 0.5f * viewport[3] + 0.5f);
+    if (previous.enabled)
+    {
+        left = std::max(left, previous.box[0]);
+        bottom = std::max(bottom, previous.box[1]);
+        right = std::min(right, previous.box[0] + previous.box[2]);
+        top = std::min(top, previous.box[1] + previous.box[3]);
+    }
+
+    GL::enable(GL_SCISSOR_TEST);
+    GL::scissor(left, bottom, std::max(right - left, 0), std::max(top - bottom, 0));
+}
+
+void Renderer::popScissor()
+{
+    CCASSERT(!_scissorStates.empty(), "popScissor() without pushScissor()");
+    const auto& previous = _scissorStates.back();
+    if (previous.enabled)
+    {
+        GL::scissor(previous.box[0], previous.box[1], previous.box[2], previous.box[3]);
+    }
+    else
+    {
+        GL::disable(GL_SCISSOR_TEST);
+    }
+    _scissorStates.pop_back();
+}
+
+bool Renderer::projectScissorRect(const Rect& rect, const Mat4& transform, Rect* ndcRect, bool* axisAligned)
+{
+    const Mat4 mvp = Director::getInstance()->getMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION) * transform;
+    const Vec2 corners[4] = {
+        Vec2(rect.getMinX(), rect.getMinY()), Vec2(rect.getMaxX(), rect.getMinY()),
+        Vec2(rect.getMaxX(), rect.getMaxY()), Vec2(rect.getMinX(), rect.getMaxY()),
+    };
+    Vec2 projected[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        Vec4 clip;
+        mvp.transformVector(Vec4(corners[i].x, corners[i].y, 0, 1), &clip);
+        if (clip.w <= 0)
+        {
+            return false;
+        }
+        projected[i].set(clip.x / clip.w, clip.y / clip.w);
+    }
+
+    float minX = std::min(std::min(projected[0].x, projected[1].x), std::min(projected[2].x, projected[3].x));
+    float maxX = std::max(std::max(projected[0].x, projected[1].x), std::max(projected[2].x, projected[3].x));
+    float minY = std::min(std::min(projected[0].y, projected[1].y), std::min(projected[2].y, projected[3].y));
+    float maxY = std::max(std::max(projected[0].y, projected[1].y), std::max(projected[2].y, projected[3].y));
+    ndcRect->setRect(minX, minY, maxX - minX, maxY - minY);
+
+    if (axisAligned)
+    {
+        // the edges stay horizontal and vertical, or get swapped by a quarter turn
+        static const float EPSILON = 1e-4f;
+        auto same = [](float a, float b) { return std::abs(a - b) <= EPSILON; };
+        *axisAligned = (same(projected[0].x, projected[3].x) && same(projected[1].x, projected[2].x) &&
+                        same(projected[0].y, projected[1].y) && same(projected[2].y, projected[3].y)) ||
+                       (same(projected[0].x, projected[1].x) && same(projected[2].x, projected[3].x) &&
+                        same(projected[0].y, projected[3].y) && same(projected[1].y, projected[2].y));
+    }
+    return true;
+}
+
+void Renderer::setBatchCapacity(int vertexCount)
+{
+    CCASSERT(!_isRendering, "Cannot change the batch capacity while rendering");
+    waitForRenderThread();
+    _batchCapacity = std::min(std::max(vertexCount, 4), (int)VBO_SIZE);
+
+    if (_quadRing)
+    {
+        _trianglesRing->resize(sizeof(_verts[0]) * _batchCapacity);
+        _quadRing->resize(sizeof(_quadVerts[0]) * _batchCapacity);
+    }
+    if ((ssize_t)_verts.size() > _batchCapacity || (ssize_t)_quadVerts.size() > _batchCapacity)
+    {
+        shrinkToFit();
+    }
+}
+
+static ssize_t growStorage(ssize_t current, ssize_t required, ssize_t limit)
+{
+    return std::min(limit, std::max(required, std::max(current * 2, (ssize_t)MIN_BATCH_STORAGE)));
+}
+
+void Renderer::reserveTriangles(ssize_t vertexCount, ssize_t indexCount)
+{
+    if (_trianglesRing)
+    {
+        // a single command may be bigger than the batch capacity
+        GLsizeiptr size = sizeof(_verts[0]) * vertexCount;
+        if (size > _trianglesRing->getSegmentSize())
+        {
+            _trianglesRing->resize(size);
+        }
+    }
+    else if (_filledVertex + vertexCount > (ssize_t)_verts.size())
+    {
+        _verts.resize(growStorage(_verts.size(), _filledVertex + vertexCount, VBO_SIZE));
+    }
+
+    if (_filledIndex + indexCount > (ssize_t)_indices.size())
+    {
+        _indices.resize(growStorage(_indices.size(), _filledIndex + indexCount, INDEX_VBO_SIZE));
+    }
+}
+
+void Renderer::reserveQuads(ssize_t quadCount)
+{
+    ssize_t vertexCount = (_numberQuads + quadCount) * 4;
+    if (_quadRing)
+    {
+        GLsizeiptr size = sizeof(_quadVerts[0]) * quadCount * 4;
+        if (size > _quadRing->getSegmentSize())
+        {
+            _quadRing->resize(size);
         }
     }
-    else if(RenderCommand::Type::GROUP_COMMAND == commandType)
+    else if (vertexCount > (ssize_t)_quadVerts.size())
     {
-        flush();
-        int renderQueueID = ((GroupCommand*) command)->getRenderQueueID();
-        visitRenderQueue(_renderGroups[renderQueueID]);
+        _quadVerts.resize(growStorage(_quadVerts.size(), vertexCount, VBO_SIZE));
     }
-    else if(RenderCommand::Type::CUSTOM_COMMAND == commandType)
+
+    auto quadIndices = QuadIndexBuffer::getInstance();
+    if (_numberQuads + quadCount > quadIndices->getCapacity())
     {
-        flush();
-        auto cmd = static_cast<CustomCommand*>(command);
-        cmd->execute();
+        quadIndices->reserve(_numberQuads + quadCount);
     }
-    else if(RenderCommand::Type::BATCH_COMMAND == commandType)
+}
+
+void Renderer::shrinkBuffers()
+{
+    ssize_t vertexCount = std::min(_batchCapacity, _peakBatchVertices);
+
+    if ((ssize_t)_verts.size() > vertexCount)
     {
-        flush();
-        auto cmd = static_cast<BatchCommand*>(command);
-        cmd->execute();
+        std::vector<V3F_C4B_T2F>(_verts.begin(), _verts.begin() + vertexCount).swap(_verts);
     }
-    else if(RenderCommand::Type::PRIMITIVE_COMMAND == commandType)
+    if ((ssize_t)_indices.size() > vertexCount * 6 / 4)
     {
-        flush();
-        auto cmd = static_cast<PrimitiveCommand*>(command);
-        cmd->execute();
+        std::vector<GLushort>(_indices.begin(), _indices.begin() + vertexCount * 6 / 4).swap(_indices);
     }
-    else
+    if ((ssize_t)_quadVerts.size() > vertexCount)
     {
-        CCLOGERROR("Unknown commands in renderQueue");
+        std::vector<V3F_C4B_T2F>(_quadVerts.begin(), _quadVerts.begin() + vertexCount).swap(_quadVerts);
     }
-}
-
-void Renderer::visitRenderQueue(RenderQueue& queue)
-{
-    queue.saveRenderState();
 
-    //
-    //Process Global-Z < 0 Objects
-    //
-    const auto& zNegQueue = queue.getSubQueue(RenderQueue::QUEUE_GROUP::GLOBALZ_NEG);
-    if (!zNegQueue.empty())
+    if (_quadRing)
     {
-        if(_isDepthTestFor2D)
-        {
-            glEnable(GL_DEPTH_TEST);
-            glDepthMask(true);
-            glEnable(GL_BLEND);
-            RenderState::StateBlock::_defaultState->setDepthTest(true);
-            RenderState::StateBlock::_defaultState->setDepthWrite(true);
-            RenderState::StateBlock::_defaultState->setBlend(true);
-        }
-        else
+        GLsizeiptr size = sizeof(_verts[0]) * _batchCapacity;
+        if (_trianglesRing->getSegmentSize() > size)
         {
-            glDisable(GL_DEPTH_TEST);
-            glDepthMask(false);
-            glEnable(GL_BLEND);
-            RenderState::StateBlock::_defaultState->setDepthTest(false);
-            RenderState::StateBlock::_defaultState->setDepthWrite(false);
-            RenderState::StateBlock::_defaultState->setBlend(true);
+            _trianglesRing->resize(size);
         }
-        for (auto it = zNegQueue.cbegin(); it != zNegQueue.cend(); ++it)
+        if (_quadRing->getSegmentSize() > size)
         {
-            processRenderCommand(*it);
+            _quadRing->resize(size);
         }
-        flush();
     }
 
-    //
-    //Process Global-Z = 0 Queue
-    //
-    const auto& zZeroQueue = queue.getSubQueue(RenderQueue::QUEUE_GROUP::GLOBALZ_ZERO);
-    if (!zZeroQueue.empty())
+    _peakBatchVertices = 0;
+}
+
+void* Renderer::getTrianglesWriteBuffer(ssize_t count)
+{
+    const GLsizeiptr offset = getTrianglesVertexSize() * _filledVertex;
+    if (_trianglesRing && count > 0)
     {
-        if(_isDepthTestFor2D)
+        if (_trianglesRing->getMapped() == nullptr && _trianglesRing->map(getTrianglesVertexSize() * count) == nullptr)
         {
-            glEnable(GL_DEPTH_TEST);
-            glDepthMask(true);
-            glEnable(GL_BLEND);
-
-            RenderState::StateBlock::_defaultState->setDepthTest(true);
-            RenderState::StateBlock::_defaultState->setDepthWrite(true);
-            RenderState::StateBlock::_defaultState->setBlend(true);
-
+            CCLOGERROR("Renderer: glMapBufferRange failed, disable the ring buffer");
+            _ringBufferRequested = false;
+            releaseRingBuffers();
+            reserveTriangles(count, 0);
+            return (char*)_verts.data() + offset;
         }
-        else
-        {
-            glDisable(GL_DEPTH_TEST);
-            glDepthMask(false);
-            glEnable(GL_BLEND);
-
-            RenderState::StateBlock::_defaultState->setDepthTest(false);
-            RenderState::StateBlock::_defaultState->setDepthWrite(false);
-            RenderState::StateBlock::_defaultState->setBlend(true);
+        return static_cast<char*>(_trianglesRing->getMapped()) + offset;
+    }
+    return (char*)_verts.data() + offset;
+}
 
-        }
-        for (auto it = zZeroQueue.cbegin(); it != zZeroQueue.cend(); ++it)
+void* Renderer::getQuadsWriteBuffer(ssize_t count)
+{
+    const GLsizeiptr offset = getQuadsVertexSize() * _numberQuads * 4;
+    if (_quadRing && count > 0)
+    {
+        if (_quadRing->getMapped() == nullptr && _quadRing->map(getQuadsVertexSize() * count) == nullptr)
         {
-            processRenderCommand(*it);
+            CCLOGERROR("Renderer: glMapBufferRange failed, disable the ring buffer");
+            _ringBufferRequested = false;
+            releaseRingBuffers();
+            reserveQuads(count / 4);
+            return (char*)_quadVerts.data() + offset;
         }
-        flush();
+        return static_cast<char*>(_quadRing->getMapped()) + offset;
     }
+    return (char*)_quadVerts.data() + offset;
+}
+
+void Renderer::fillVerticesAndIndices(const TrianglesCommand* cmd)
+{
+    const Mat4& modelView = cmd->getModelView();
+    const V3F_C4B_T2F* vertices = cmd->getVertices();
+    // the destination may be write-combined GPU memory: write it once, never read it back
+    void* dst = getTrianglesWriteBuffer(cmd->getVertexCount());
+
+    if (_trianglesCompact)
+        transformVerticesCompact(modelView, vertices, (V2F_C4B_T2US*)dst, cmd->getVertexCount());
+    else if (TransformIsAffine2D(modelView))
+        modelView.transformVerticesAffine2D((const float*)vertices, (float*)dst, (int)cmd->getVertexCount());
+    else
+        modelView.transformVertices((const float*)vertices, (float*)dst, (int)cmd->getVertexCount());
 
-    //
-    //Process Global-Z > 0 Queue
-    //
-    const auto& zPosQueue = queue.getSubQueue(RenderQueue::QUEUE_GROUP::GLOBALZ_POS);
-    if (!zPosQueue.empty())
+    const unsigned short* indices = cmd->getIndices();
+    //fill index
+    for(ssize_t i=0; i< cmd->getIndexCount(); ++i)
     {
-        if(_isDepthTestFor2D)
-        {
-            glEnable(GL_DEPTH_TEST);
-            glDepthMask(true);
-            glEnable(GL_BLEND);
+        _indices[_filledIndex + i] = _filledVertex + indices[i];
+    }
 
-            RenderState::StateBlock::_defaultState->setDepthTest(true);
-            RenderState::StateBlock::_defaultState->setDepthWrite(true);
-            RenderState::StateBlock::_defaultState->setBlend(true);
+    _filledVertex += cmd->getVertexCount();
+    _filledIndex += cmd->getIndexCount();
+}
 
-        }
-        else
-        {
-            glDisable(GL_DEPTH_TEST);
-            glDepthMask(false);
-            glEnable(GL_BLEND);
+void Renderer::fillQuads(const QuadCommand *cmd)
+{
+    const Mat4& modelView = cmd->getModelView();
+    const V3F_C4B_T2F* quads =  (V3F_C4B_T2F*)cmd->getQuads();
+    void* dst = getQuadsWriteBuffer(cmd->getQuadCount() * 4);
+    if (_quadsCompact)
+        transformVerticesCompact(modelView, quads, (V2F_C4B_T2US*)dst, cmd->getQuadCount() * 4);
+    else if (TransformIsAffine2D(modelView))
+        modelView.transformVerticesAffine2D((const float*)quads, (float*)dst, (int)cmd->getQuadCount() * 4);
+    else
+        modelView.transformVertices((const float*)quads, (float*)dst, (int)cmd->getQuadCount() * 4);
 
-            RenderState::StateBlock::_defaultState->setDepthTest(false);
-            RenderState::StateBlock::_defaultState->setDepthWrite(false);
-            RenderState::StateBlock::_defaultState->setBlend(true);
+    _numberQuads += cmd->getQuadCount();
+}
 
-        }
+bool Renderer::canDrawInstanced(const TrianglesCommand* cmd) const
+{
+    if (!_isInstancingEnabled || _instancedProgram == nullptr || _debugMode != DebugMode::NONE)
+        return false;
+
+    if (cmd->isSkipBatching() || cmd->getMaterialID() == MATERIAL_ID_DO_NOT_BATCH
+        || cmd->getGLProgramState()->getGLProgram() != _instanceSourceProgram)
+        return false;
+
+    if (cmd->getVertexCount() != 4 || cmd->getIndexCount() != 6
+        || memcmp(cmd->getIndices(), s_instanceQuadIndices, sizeof(s_instanceQuadIndices)) != 0)
+        return false;
+
+    // tl, bl, tr, br: the local quad must be an axis aligned rectangle with a single color
+    const V3F_C4B_T2F* v = cmd->getVertices();
+    return v[0].vertices.x == v[1].vertices.x && v[2].vertices.x == v[3].vertices.x
+        && v[0].vertices.y == v[2].vertices.y && v[1].vertices.y == v[3].vertices.y
+        && v[0].vertices.z == v[1].vertices.z && v[0].vertices.z == v[2].vertices.z && v[0].vertices.z == v[3].vertices.z
+        && v[0].colors == v[1].colors && v[0].colors == v[2].colors && v[0].colors == v[3].colors;
+}
 
-        for (auto it = zPosQueue.cbegin(); it != zPosQueue.cend(); ++it)
-        {
-            processRenderCommand(*it);
-        }
-        flush();
+void Renderer::fillInstance(const TrianglesCommand* cmd)
+{
+    const Mat4& mv = cmd->getModelView();
+    const V3F_C4B_T2F* v = cmd->getVertices();
+
+    _instances.emplace_back();
+    InstanceData& instance = _instances.back();
+
+    Vec3 origin;
+    mv.transformPoint(v[1].vertices, &origin);
+    instance.origin[0] = origin.x;
+    instance.origin[1] = origin.y;
+    instance.origin[2] = origin.z;
+
+    // the edges of the quad are the scaled first two columns of the model view
+    const float width = v[3].vertices.x - v[1].vertices.x;
+    const float height = v[0].vertices.y - v[1].vertices.y;
+    for (int i = 0; i < 3; ++i)
+    {
+        instance.axisX[i] = mv.m[i] * width;
+        instance.axisY[i] = mv.m[4 + i] * height;
     }
 
-    queue.restoreRenderState();
+    for (int i = 0; i < 4; ++i)
+    {
+        instance.texCoords[i] = v[i].texCoords;
+    }
+    instance.color = v[0].colors;
 }
 
-void Renderer::render()
+void Renderer::drawBatchedInstances()
 {
-    //Uncomment this once everything is rendered by new renderer
-    //glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    if (_instances.empty())
+        return;
 
-    //TODO: setup MVP
-    _isRendering = true;
+    SubmitTimer timer(_isTimingsEnabled, _submitTime);
 
-    if (_glViewAssigned)
+    const GLsizei stride = sizeof(InstanceData);
+
+    // orphan the instance buffer, the previous batch may still be in flight
+    GL::bindBuffer(GL_ARRAY_BUFFER, _instanceVBO[1]);
+    GL::bufferData(GL_ARRAY_BUFFER, stride * _instances.size(), _instances.data(), GL_STREAM_DRAW);
+
+    // binds VAO 0, the pointers are set per material below
+    GL::enableVertexAttribs((1 << (GLProgram::VERTEX_ATTRIB_NORMAL + 1)) - 1);
+
+    GL::bindBuffer(GL_ARRAY_BUFFER, _instanceVBO[0]);
+    GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, (GLvoid*)0);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, QuadIndexBuffer::getInstance()->reserve(1));
+
+    for (int attrib = GLProgram::VERTEX_ATTRIB_COLOR; attrib <= GLProgram::VERTEX_ATTRIB_NORMAL; ++attrib)
+    {
+        glVertexAttribDivisor(attrib, 1);
+    }
+
+    GL::bindBuffer(GL_ARRAY_BUFFER, _instanceVBO[1]);
+
+    // draw the runs of instances that share a material
+    const Mat4& identity = Mat4::IDENTITY;
+    size_t runStart = 0;
+    while (runStart < _instances.size())
     {
-        //Process render commands
-        //1. Sort render commands based on ID
-        for (auto &renderqueue : _renderGroups)
+        const TrianglesCommand* first = _batchInstanceCommands[runStart];
+        const uint32_t materialID = first->getMaterialID();
+        size_t runEnd = runStart + 1;
+        while (runEnd < _instances.size() && _batchInstanceCommands[runEnd]->getMaterialID() == materialID)
         {
-            renderqueue.sort();
+            ++runEnd;
         }
-        visitRenderQueue(_renderGroups[0]);
+
+        GL::bindTexture2D(first->getTextureID());
+        GL::blendFunc(first->getBlendType().src, first->getBlendType().dst);
+        _instancedProgram->use();
+        _instancedProgram->setUniformsForBuiltins(identity);
+
+        const GLintptr offset = stride * runStart;
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD2, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid*) (offset + offsetof(InstanceData, origin)));
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD3, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid*) (offset + offsetof(InstanceData, axisX)));
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_NORMAL, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid*) (offset + offsetof(InstanceData, axisY)));
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 4, GL_FLOAT, GL_FALSE, stride, (GLvoid*) (offset + offsetof(InstanceData, texCoords)));
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD1, 4, GL_FLOAT, GL_FALSE, stride, (GLvoid*) (offset + offsetof(InstanceData, texCoords) + sizeof(Tex2F) * 2));
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (GLvoid*) (offset + offsetof(InstanceData, color)));
+
+        const GLsizei count = (GLsizei)(runEnd - runStart);
+        glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (GLvoid*)0, count);
+        _drawnBatches++;
+        _drawnVertices += count * 6;
+
+        runStart = runEnd;
     }
-    clean();
-    _isRendering = false;
-}
 
-void Renderer::clean()
-{
-    // Clear render group
-    for (size_t j = 0 ; j < _renderGroups.size(); j++)
+    // VAO 0 is shared with every non VAO draw, restore the per vertex attributes
+    for (int attrib = GLProgram::VERTEX_ATTRIB_COLOR; attrib <= GLProgram::VERTEX_ATTRIB_NORMAL; ++attrib)
     {
-        //commands are owned by nodes
-        // for (const auto &cmd : _renderGroups[j])
-        // {
-        //     cmd->releaseToCommandPool();
-        // }
-        _renderGroups[j].clear();
+        glVertexAttribDivisor(attrib, 0);
     }
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
-    // Clear batch commands
-    _batchedCommands.clear();
-    _batchQuadCommands.clear();
-    _filledVertex = 0;
-    _filledIndex = 0;
-    _numberQuads = 0;
+    // the program state of the next batch must be applied again
     _lastMaterialID = 0;
+
+    _peakBatchVertices = std::max(_peakBatchVertices, (int)_instances.size() * 4);
+    _batchInstanceCommands.clear();
+    _instances.clear();
 }
 
-void Renderer::clear()
+bool Renderer::canDrawMultiTexture(const TrianglesCommand* cmd) const
 {
-    //Enable Depth mask to make sure glClear clear the depth buffer correctly
-    glDepthMask(true);
-    glClearColor(_clearColor.r, _clearColor.g, _clearColor.b, _clearColor.a);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glDepthMask(false);
+    if (!_isMultiTextureEnabled || _multiTextureProgram == nullptr || _debugMode != DebugMode::NONE)
+        return false;
 
-    RenderState::StateBlock::_defaultState->setDepthWrite(false);
+    return !cmd->isSkipBatching() && cmd->getMaterialID() != MATERIAL_ID_DO_NOT_BATCH
+        && cmd->getGLProgramState()->getGLProgram() == _instanceSourceProgram;
 }
 
-void Renderer::setDepthTest(bool enable)
+void Renderer::fillMultiTexture(const TrianglesCommand* cmd)
 {
-    if (enable)
-    {
-        glClearDepth(1.0f);
-        glEnable(GL_DEPTH_TEST);
-        glDepthFunc(GL_LEQUAL);
+    const ssize_t vertexCount = cmd->getVertexCount();
+    const ssize_t indexCount = cmd->getIndexCount();
+    CCASSERT(vertexCount >= 0 && vertexCount < VBO_SIZE, "VBO for vertex is not big enough, please break the data down or use customized render command");
 
-        RenderState::StateBlock::_defaultState->setDepthTest(true);
-        RenderState::StateBlock::_defaultState->setDepthFunction(RenderState::DEPTH_LEQUAL);
+    const BlendFunc& blend = cmd->getBlendType();
+    const GLuint textureID = cmd->getTextureID();
+    auto slot = std::find(_batchTextures.begin(), _batchTextures.end(), textureID);
 
-//        glHint(GL_PERSPECTIVE_CORRECTION_HINT, GL_NICEST);
-    }
-    else
+    //Draw the batch if the command doesn't fit, its texture needs a unit or its blend is different
+    if (!_multiTextureIndices.empty())
     {
-        glDisable(GL_DEPTH_TEST);
-
-        RenderState::StateBlock::_defaultState->setDepthTest(false);
+        const bool full = (ssize_t)_multiTextureVerts.size() + vertexCount > _batchCapacity
+            || (ssize_t)_multiTextureIndices.size() + indexCount > _batchCapacity * 6 / 4;
+        if (full || (slot == _batchTextures.end() && (int)_batchTextures.size() == _maxBatchTextures)
+            || _multiTextureBlend != blend)
+        {
+            if (full)
+            {
+                ++_capacityBreaks;
+            }
+            drawBatchedMultiTextures();
+            slot = _batchTextures.end();
+        }
     }
 
-    _isDepthTestFor2D = enable;
-    CHECK_GL_ERROR_DEBUG();
-}
+    if (slot == _batchTextures.end())
+    {
+        _batchTextures.push_back(textureID);
+        slot = _batchTextures.end() - 1;
+    }
+    _multiTextureBlend = blend;
 
-void Renderer::fillVerticesAndIndices(const TrianglesCommand* cmd)
-{
-    memcpy(_verts + _filledVertex, cmd->getVertices(), sizeof(V3F_C4B_T2F) * cmd->getVertexCount());
+    const float textureSlot = (float)(slot - _batchTextures.begin());
+    const GLushort firstVertex = (GLushort)_multiTextureVerts.size();
     const Mat4& modelView = cmd->getModelView();
-
-    for(ssize_t i=0; i< cmd->getVertexCount(); ++i)
+    const V3F_C4B_T2F* vertices = cmd->getVertices();
+    for (ssize_t i = 0; i < vertexCount; ++i)
     {
-        V3F_C4B_T2F *q = &_verts[i + _filledVertex];
-        Vec3 *vec1 = (Vec3*)&q->vertices;
-        modelView.transformPoint(vec1);
+        _multiTextureVerts.emplace_back();
+        MultiTextureVertex& vertex = _multiTextureVerts.back();
+        modelView.transformPoint(vertices[i].vertices, &vertex.vertices);
+        vertex.colors = vertices[i].colors;
+        vertex.texCoords = vertices[i].texCoords;
+        vertex.textureSlot = textureSlot;
     }
 
     const unsigned short* indices = cmd->getIndices();
-    //fill index
-    for(ssize_t i=0; i< cmd->getIndexCount(); ++i)
+    for (ssize_t i = 0; i < indexCount; ++i)
     {
-        _indices[_filledIndex + i] = _filledVertex + indices[i];
+        _multiTextureIndices.push_back(firstVertex + indices[i]);
     }
-
-    _filledVertex += cmd->getVertexCount();
-    _filledIndex += cmd->getIndexCount();
 }
 
-void Renderer::fillQuads(const QuadCommand *cmd)
+void Renderer::drawBatchedMultiTextures()
 {
-    const Mat4& modelView = cmd->getModelView();
-    const V3F_C4B_T2F* quads =  (V3F_C4B_T2F*)cmd->getQuads();
-    for(ssize_t i=0; i< cmd->getQuadCount() * 4; ++i)
+    if (_multiTextureIndices.empty())
+        return;
+
+    SubmitTimer timer(_isTimingsEnabled, _submitTime);
+
+    const GLsizei stride = sizeof(MultiTextureVertex);
+
+    // binds VAO 0, a_texCoord1 is the texture unit
+    GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX | (1 << GLProgram::VERTEX_ATTRIB_TEX_COORD1));
+
+    // orphan the buffers, the previous batch may still be in flight
+    GL::bindBuffer(GL_ARRAY_BUFFER, _multiTextureVBO[0]);
+    GL::bufferData(GL_ARRAY_BUFFER, stride * _multiTextureVerts.size(), _multiTextureVerts.data(), GL_STREAM_DRAW);
+    GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid*) offsetof(MultiTextureVertex, vertices));
+    GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (GLvoid*) offsetof(MultiTextureVertex, colors));
+    GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, stride, (GLvoid*) offsetof(MultiTextureVertex, texCoords));
+    GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD1, 1, GL_FLOAT, GL_FALSE, stride, (GLvoid*) offsetof(MultiTextureVertex, textureSlot));
+
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _multiTextureVBO[1]);
+    GL::bufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_multiTextureIndices[0]) * _multiTextureIndices.size(), _multiTextureIndices.data(), GL_STREAM_DRAW);
+
+    // unit 0 last, the rest of the engine binds its textures there
+    for (int i = (int)_batchTextures.size() - 1; i >= 0; --i)
     {
-        _quadVerts[i + _numberQuads * 4] = quads[i];
-        modelView.transformPoint(quads[i].vertices,&(_quadVerts[i + _numberQuads * 4].vertices));
+        GL::bindTexture2DN(i, _batchTextures[i]);
     }
+    GL::activeTexture(GL_TEXTURE0);
+    GL::blendFunc(_multiTextureBlend.src, _multiTextureBlend.dst);
 
-    _numberQuads += cmd->getQuadCount();
+    _multiTextureProgram->use();
+    _multiTextureProgram->setUniformsForBuiltins(Mat4::IDENTITY);
+    for (int i = 0; i < _maxBatchTextures; ++i)
+    {
+        _multiTextureProgram->setUniformLocationWith1i(_multiTextureSamplers[i], i);
+    }
+
+    glDrawElements(GL_TRIANGLES, (GLsizei)_multiTextureIndices.size(), GL_UNSIGNED_SHORT, (GLvoid*)0);
+    _drawnBatches++;
+    _drawnVertices += _multiTextureIndices.size();
+
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    // the program state of the next batch must be applied again
+    _lastMaterialID = 0;
+
+    _peakBatchVertices = std::max(_peakBatchVertices, (int)_multiTextureVerts.size());
+    _batchTextures.clear();
+    _multiTextureVerts.clear();
+    _multiTextureIndices.clear();
 }
 
 void Renderer::drawBatchedTriangles()
 {
     //TODO: we can improve the draw performance by insert material switching command before hand.
+    SubmitTimer timer(_isTimingsEnabled, _submitTime);
 
     int indexToDraw = 0;
     int startIndex = 0;
@@ -707,53 +2641,75 @@ void Renderer::drawBatchedTriangles()
     //Upload buffer to VBO
     if(_filledVertex <= 0 || _filledIndex <= 0 || _batchedCommands.empty())
     {
+        if (_trianglesRing && _trianglesRing->getMapped())
+        {
+            _trianglesRing->unmap(0);
+        }
         return;
     }
 
+    _peakBatchVertices = std::max(_peakBatchVertices, _filledVertex);
+
+    GLintptr vertexOffset = 0;
+    if (_trianglesRing)
+    {
+        //The vertices are already in the VBO, leaves it bound
+        vertexOffset = _trianglesRing->unmap(getTrianglesVertexSize() * _filledVertex);
+    }
+
     if (Configuration::getInstance()->supportsShareableVAO())
     {
         //Bind VAO
         GL::bindVAO(_buffersVAO);
-        //Set VBO data
-        glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
 
-        // option 1: subdata
-//        glBufferSubData(GL_ARRAY_BUFFER, sizeof(_quads[0])*start, sizeof(_quads[0]) * n , &_quads[start] );
+        if (_trianglesRing)
+        {
+            setVertexAttribPointers(vertexOffset, _trianglesCompact);
+            _trianglesVAOCompact = _trianglesCompact;
+        }
+        else
+        {
+            //Set VBO data
+            GL::bindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+
+            // option 1: subdata
+//            glBufferSubData(GL_ARRAY_BUFFER, sizeof(_quads[0])*start, sizeof(_quads[0]) * n , &_quads[start] );
 
-        // option 2: data
-//        glBufferData(GL_ARRAY_BUFFER, sizeof(quads_[0]) * (n-start), &quads_[start], GL_DYNAMIC_DRAW);
+            // option 2: data
+//            glBufferData(GL_ARRAY_BUFFER, sizeof(quads_[0]) * (n-start), &quads_[start], GL_DYNAMIC_DRAW);
 
-        // option 3: orphaning + glMapBuffer
-        glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * _filledVertex, nullptr, GL_DYNAMIC_DRAW);
-        void *buf = glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
-        memcpy(buf, _verts, sizeof(_verts[0])* _filledVertex);
-        glUnmapBuffer(GL_ARRAY_BUFFER);
+            // option 3: orphaning + glMapBuffer
+            GL::bufferData(GL_ARRAY_BUFFER, getTrianglesVertexSize() * _filledVertex, nullptr, GL_DYNAMIC_DRAW);
+            void *buf = glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
+            memcpy(buf, _verts.data(), getTrianglesVertexSize() * _filledVertex);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+
+            //the VAO keeps the pointers of the last format
+            if (_trianglesVAOCompact != _trianglesCompact)
+            {
+                setVertexAttribPointers(0, _trianglesCompact);
+                _trianglesVAOCompact = _trianglesCompact;
+            }
+        }
 
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        GL::bindBuffer(GL_ARRAY_BUFFER, 0);
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _filledIndex, _indices, GL_STATIC_DRAW);
+        GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+        GL::bufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _filledIndex, _indices.data(), GL_STATIC_DRAW);
     }
     else
     {
-#define kQuadSize sizeof(_verts[0])
-        glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-
-        glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * _filledVertex , _verts, GL_DYNAMIC_DRAW);
+        if (!_trianglesRing)
+        {
+            GL::bindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+            GL::bufferData(GL_ARRAY_BUFFER, getTrianglesVertexSize() * _filledVertex , _verts.data(), GL_DYNAMIC_DRAW);
+        }
 
         GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX);
+        setVertexAttribPointers(vertexOffset, _trianglesCompact);
 
-        // vertices
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, vertices));
-
-        // colors
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, colors));
-
-        // tex coords
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, texCoords));
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _filledIndex, _indices, GL_STATIC_DRAW);
+        GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+        GL::bufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _filledIndex, _indices.data(), GL_STATIC_DRAW);
     }
 
     //Start drawing verties in batch
@@ -765,6 +2721,7 @@ void Renderer::drawBatchedTriangles()
             //Draw quads
             if(indexToDraw > 0)
             {
+                applyDebugMode(indexToDraw, BatchBreak::MATERIAL, cmd);
                 glDrawElements(GL_TRIANGLES, (GLsizei) indexToDraw, GL_UNSIGNED_SHORT, (GLvoid*) (startIndex*sizeof(_indices[0])) );
                 _drawnBatches++;
                 _drawnVertices += indexToDraw;
@@ -784,6 +2741,7 @@ void Renderer::drawBatchedTriangles()
     //Draw any remaining triangles
     if(indexToDraw > 0)
     {
+        applyDebugMode(indexToDraw, _batchBreak, _batchBreakCommand);
         glDrawElements(GL_TRIANGLES, (GLsizei) indexToDraw, GL_UNSIGNED_SHORT, (GLvoid*) (startIndex*sizeof(_indices[0])) );
         _drawnBatches++;
         _drawnVertices += indexToDraw;
@@ -796,8 +2754,8 @@ void Renderer::drawBatchedTriangles()
     }
     else
     {
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        GL::bindBuffer(GL_ARRAY_BUFFER, 0);
+        GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     }
 
     _batchedCommands.clear();
@@ -808,55 +2766,78 @@ void Renderer::drawBatchedTriangles()
 void Renderer::drawBatchedQuads()
 {
     //TODO: we can improve the draw performance by insert material switching command before hand.
+    SubmitTimer timer(_isTimingsEnabled, _submitTime);
 
     //Upload buffer to VBO
     if(_numberQuads <= 0 || _batchQuadCommands.empty())
     {
+        if (_quadRing && _quadRing->getMapped())
+        {
+            _quadRing->unmap(0);
+        }
         return;
     }
 
+    _peakBatchVertices = std::max(_peakBatchVertices, _numberQuads * 4);
+
+    GLintptr vertexOffset = 0;
+    if (_quadRing)
+    {
+        //The vertices are already in the VBO, leaves it bound
+        vertexOffset = _quadRing->unmap(getQuadsVertexSize() * _numberQuads * 4);
+    }
+
     if (Configuration::getInstance()->supportsShareableVAO())
     {
         //Bind VAO
         GL::bindVAO(_quadVAO);
-        //Set VBO data
-        glBindBuffer(GL_ARRAY_BUFFER, _quadbuffersVBO[0]);
 
-        // option 1: subdata
-        //  glBufferSubData(GL_ARRAY_BUFFER, sizeof(_quads[0])*start, sizeof(_quads[0]) * n , &_quads[start] );
+        if (_quadRing)
+        {
+            setVertexAttribPointers(vertexOffset, _quadsCompact);
+            _quadVAOCompact = _quadsCompact;
+        }
+        else
+        {
+            //Set VBO data
+            GL::bindBuffer(GL_ARRAY_BUFFER, _quadbuffersVBO[0]);
+
+            // option 1: subdata
+            //  glBufferSubData(GL_ARRAY_BUFFER, sizeof(_quads[0])*start, sizeof(_quads[0]) * n , &_quads[start] );
+
+            // option 2: data
+            //  glBufferData(GL_ARRAY_BUFFER, sizeof(quads_[0]) * (n-start), &quads_[start], GL_DYNAMIC_DRAW);
 
-        // option 2: data
-        //  glBufferData(GL_ARRAY_BUFFER, sizeof(quads_[0]) * (n-start), &quads_[start], GL_DYNAMIC_DRAW);
+            // option 3: orphaning + glMapBuffer
+            GL::bufferData(GL_ARRAY_BUFFER, getQuadsVertexSize() * _numberQuads * 4, nullptr, GL_DYNAMIC_DRAW);
+            void *buf = glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
+            memcpy(buf, _quadVerts.data(), getQuadsVertexSize() * _numberQuads * 4);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
 
-        // option 3: orphaning + glMapBuffer
-        glBufferData(GL_ARRAY_BUFFER, sizeof(_quadVerts[0]) * _numberQuads * 4, nullptr, GL_DYNAMIC_DRAW);
-        void *buf = glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
-        memcpy(buf, _quadVerts, sizeof(_quadVerts[0])* _numberQuads * 4);
-        glUnmapBuffer(GL_ARRAY_BUFFER);
+            //the VAO keeps the pointers of the last format
+            if (_quadVAOCompact != _quadsCompact)
+            {
+                setVertexAttribPointers(0, _quadsCompact);
+                _quadVAOCompact = _quadsCompact;
+            }
+        }
 
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        GL::bindBuffer(GL_ARRAY_BUFFER, 0);
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _quadbuffersVBO[1]);
+        GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, QuadIndexBuffer::getInstance()->getVBO());
     }
     else
     {
-#define kQuadSize sizeof(_verts[0])
-        glBindBuffer(GL_ARRAY_BUFFER, _quadbuffersVBO[0]);
-
-        glBufferData(GL_ARRAY_BUFFER, sizeof(_quadVerts[0]) * _numberQuads * 4 , _quadVerts, GL_DYNAMIC_DRAW);
+        if (!_quadRing)
+        {
+            GL::bindBuffer(GL_ARRAY_BUFFER, _quadbuffersVBO[0]);
+            GL::bufferData(GL_ARRAY_BUFFER, getQuadsVertexSize() * _numberQuads * 4 , _quadVerts.data(), GL_DYNAMIC_DRAW);
+        }
 
         GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX);
+        setVertexAttribPointers(vertexOffset, _quadsCompact);
 
-        // vertices
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, vertices));
-
-        // colors
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, colors));
-
-        // tex coords
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, texCoords));
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _quadbuffersVBO[1]);
+        GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, QuadIndexBuffer::getInstance()->getVBO());
     }
 
     ssize_t indexToDraw = 0;
@@ -875,6 +2856,7 @@ void Renderer::drawBatchedQuads()
             // flush buffer
             if(indexToDraw > 0)
             {
+                applyDebugMode(indexToDraw, BatchBreak::MATERIAL, cmd);
                 glDrawElements(GL_TRIANGLES, (GLsizei) indexToDraw, GL_UNSIGNED_SHORT, (GLvoid*) (startIndex*sizeof(_indices[0])) );
                 _drawnBatches++;
                 _drawnVertices += indexToDraw;
@@ -898,6 +2880,7 @@ void Renderer::drawBatchedQuads()
     //Draw any remaining quad
     if(indexToDraw > 0)
     {
+        applyDebugMode(indexToDraw, _batchBreak, _batchBreakCommand);
         glDrawElements(GL_TRIANGLES, (GLsizei) indexToDraw, GL_UNSIGNED_SHORT, (GLvoid*) (startIndex*sizeof(_indices[0])) );
         _drawnBatches++;
         _drawnVertices += indexToDraw;
@@ -910,20 +2893,106 @@ void Renderer::drawBatchedQuads()
     }
     else
     {
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        GL::bindBuffer(GL_ARRAY_BUFFER, 0);
+        GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     }
 
     _batchQuadCommands.clear();
     _numberQuads = 0;
 }
 
+void Renderer::applyDebugMode(ssize_t indexCount, BatchBreak reason, RenderCommand* command)
+{
+    if (_debugMode == DebugMode::NONE || _debugProgram == nullptr)
+        return;
+
+    //the material of the batch is applied, its texture is bound to the unit 0
+    _debugProgram->use();
+    _debugProgram->setUniformsForBuiltins();
+
+    if (_debugMode == DebugMode::OVERDRAW)
+    {
+        //8 layers saturate the red, 16 the green and 32 the blue
+        GL::blendFunc(GL_ONE, GL_ONE);
+        _debugProgram->setUniformLocationWith4f(_debugColorLocation, 1.0f / 8, 1.0f / 16, 1.0f / 32, 1.0f);
+        _debugProgram->setUniformLocationWith1f(_debugTextureAlphaLocation, 0.0f);
+        return;
+    }
+
+    static const Color4F colors[] = {
+        Color4F::RED, Color4F::GREEN, Color4F::BLUE, Color4F::YELLOW,
+        Color4F::MAGENTA, Color4F::ORANGE, Color4F(0, 1, 1, 1), Color4F(0.5f, 0, 1, 1)
+    };
+    const Color4F& color = colors[_debugBatches.size() % (sizeof(colors) / sizeof(colors[0]))];
+    GL::blendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    _debugProgram->setUniformLocationWith4f(_debugColorLocation, color.r, color.g, color.b, 1.0f);
+    _debugProgram->setUniformLocationWith1f(_debugTextureAlphaLocation, 1.0f);
+
+    DebugBatch batch;
+    batch.reason = reason;
+    batch.indexCount = indexCount;
+    Node* owner = command ? command->getDebugOwner() : nullptr;
+    if (owner)
+    {
+        batch.owner = owner->getDescription();
+        if (!owner->getName().empty())
+        {
+            batch.owner += " \"" + owner->getName() + "\"";
+        }
+    }
+    _debugBatches.push_back(batch);
+}
+
+void Renderer::logDebugBatches()
+{
+    //logs the batches once, until they change
+    bool changed = _debugBatches.size() != _loggedDebugBatches.size();
+    for (size_t i = 0; !changed && i < _debugBatches.size(); ++i)
+    {
+        changed = _debugBatches[i].reason != _loggedDebugBatches[i].reason || _debugBatches[i].owner != _loggedDebugBatches[i].owner;
+    }
+    if (!changed)
+        return;
+
+    static const char* colorNames[] = { "red", "green", "blue", "yellow", "magenta", "orange", "cyan", "purple" };
+    static const char* reasons[] = { "material change", "custom command", "group command", "batch full", "state change", "end of queue" };
+
+    log("Renderer: %d batches", (int)_debugBatches.size());
+    for (size_t i = 0; i < _debugBatches.size(); ++i)
+    {
+        const auto& batch = _debugBatches[i];
+        log("  #%d %s, %d vertices, drawn on %s%s%s", (int)i, colorNames[i % 8], (int)batch.indexCount,
+            reasons[(int)batch.reason], batch.owner.empty() ? "" : " by ", batch.owner.c_str());
+    }
+    _loggedDebugBatches.swap(_debugBatches);
+}
+
 void Renderer::flush()
 {
+    flushInstances();
+    flushMultiTextures();
     flushQuads();
     flushTriangles();
 }
 
+void Renderer::flushInstances()
+{
+    if(!_instances.empty())
+    {
+        drawBatchedInstances();
+        _lastMaterialID = 0;
+    }
+}
+
+void Renderer::flushMultiTextures()
+{
+    if(!_multiTextureIndices.empty())
+    {
+        drawBatchedMultiTextures();
+        _lastMaterialID = 0;
+    }
+}
+
 void Renderer::flushQuads()
 {
     if(_numberQuads > 0)
@@ -945,6 +3014,11 @@ void Renderer::flushTriangles()
 // helpers
 bool Renderer::checkVisibility(const Mat4 &transform, const Size &size)
 {
+    if (s_commandList && !s_commandList->cullingEnabled)
+    {
+        return true;
+    }
+
     // half size of the screen
     Size screen_half = Director::DirectorInstance->getWinSize();
     screen_half.width /= 2;
@@ -953,13 +3027,13 @@ bool Renderer::checkVisibility(const Mat4 &transform, const Size &size)
     float hSizeX = size.width/2;
     float hSizeY = size.height/2;
 
-    Vec4 v4world, v4local;
-    v4local.set(hSizeX, hSizeY, 0, 1);
-    transform.transformVector(v4local, &v4world);
+    // the center of the node in world coordinates, z and w of the local point are 0 and 1
+    Vec2 world(hSizeX * transform.m[0] + hSizeY * transform.m[4] + transform.m[12],
+               hSizeX * transform.m[1] + hSizeY * transform.m[5] + transform.m[13]);
 
     // center of screen is (0,0)
-    v4world.x -= screen_half.width;
-    v4world.y -= screen_half.height;
+    world.x -= screen_half.width;
+    world.y -= screen_half.height;
 
 
     // convert content size to world coordinates
@@ -967,8 +3041,8 @@ bool Renderer::checkVisibility(const Mat4 &transform, const Size &size)
     float wshh = std::max(fabsf(hSizeX * transform.m[1] + hSizeY * transform.m[5]), fabsf(hSizeX * transform.m[1] - hSizeY * transform.m[5]));
 
     // compare if it in the positive quadrant of the screen
-    float tmpx = (fabsf(v4world.x)-wshw);
-    float tmpy = (fabsf(v4world.y)-wshh);
+    float tmpx = (fabsf(world.x)-wshw);
+    float tmpy = (fabsf(world.y)-wshh);
     bool ret = (tmpx < screen_half.width && tmpy < screen_half.height);
 
     return  ret;
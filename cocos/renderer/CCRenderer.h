@@ -26,11 +26,14 @@
 #ifndef __CC_RENDERER_H_
 #define __CC_RENDERER_H_
 
+#include <algorithm>
 #include <vector>
 #include <stack>
+#include <mutex>
 
 #include "platform/CCPlatformMacros.h"
 #include "renderer/CCRenderCommand.h"
+#include "renderer/CCFrameArena.h"
 #include "renderer/CCGLProgram.h"
 #include "platform/CCGL.h"
 
@@ -44,7 +47,9 @@ NS_CC_BEGIN
 class EventListenerCustom;
 class QuadCommand;
 class TrianglesCommand;
+class CustomCommand;
 class MeshCommand;
+class StreamBuffer;
 
 /** Class that knows how to sort `RenderCommand` objects.
  Since the commands that have `z == 0` are "pushed back" in
@@ -78,7 +83,12 @@ public:
     void push_back(RenderCommand* command);
     /**Return the number of render commands.*/
     ssize_t size() const;
-    /**Sort the render commands.*/
+    /**
+     Sort the render commands.
+     The commands with a negative or positive global z are sorted by it with a stable radix sort of 64 bit keys,
+     the global z in the high 32 bits and the order of arrival in the low ones, built by push_back(). The commands
+     of the same global z keep the order they were added in.
+     */
     void sort();
     /**Treat sorted commands as an array, access them one by one.*/
     RenderCommand* operator[](ssize_t index) const;
@@ -95,10 +105,44 @@ public:
     void saveRenderState();
     /**Restore the saved DepthState, CullState, DepthWriteState render state.*/
     void restoreRenderState();
+    /**Whether restoreRenderState() would change the current render state.*/
+    bool isRenderStateChanged() const;
+
+    /**
+     Enable/Disable the reordering of the 2D commands by material in sort().
+     A QuadCommand or TrianglesCommand is moved back next to the last command with the same material,
+     as long as it doesn't overlap any command it jumps over, so interleaved nodes of two atlases still batch.
+     Other commands, and commands that aren't flat on the z = 0 plane, are never jumped over.
+     It's reset by clear(), so it must be set for every frame.
+     */
+    void setReorderEnabled(bool enabled) { _isReorderEnabled = enabled; }
+    /**Whether or not the commands are reordered by material.*/
+    bool isReorderEnabled() const { return _isReorderEnabled; }
 
 protected:
+    /**A command of reorderByMaterial() with its bounds in world coordinates.*/
+    struct ReorderEntry
+    {
+        RenderCommand* command;
+        uint32_t materialID;
+        float minX, minY, maxX, maxY;
+    };
+
+    void reorderByMaterial(std::vector<RenderCommand*>& commands);
+    /**Sorts the commands of a group by their sort keys.*/
+    void sortByKey(QUEUE_GROUP group);
+
     /**The commands in the render queue.*/
     std::vector<RenderCommand*> _commands[QUEUE_COUNT];
+    /**Scratch storage of reorderByMaterial().*/
+    std::vector<ReorderEntry> _reorderEntries;
+    /**The sort keys of the commands of GLOBALZ_NEG and GLOBALZ_POS, in the order of _commands.*/
+    std::vector<uint64_t> _sortKeys[QUEUE_COUNT];
+    /**Whether the keys of a group were pushed in ascending order already.*/
+    bool _isSorted[QUEUE_COUNT];
+    /**Scratch storage of sortByKey().*/
+    std::vector<uint64_t> _sortScratch;
+    std::vector<RenderCommand*> _sortedCommands;
 
     /**Cull state.*/
     bool _isCullEnabled;
@@ -106,6 +150,8 @@ protected:
     bool _isDepthEnabled;
     /**Depth buffer write state.*/
     GLboolean _isDepthWrite;
+    /**Reorder the commands by material.*/
+    bool _isReorderEnabled;
 };
 
 //the struct is not used outside.
@@ -124,7 +170,7 @@ Whenever possible prefer to use `QuadCommand` objects since the renderer will au
 class CC_DLL Renderer
 {
 public:
-    /**The max number of vertices in a vertex buffer object.*/
+    /**The max number of vertices in a vertex buffer object, the indices are GLushort.*/
     static const int VBO_SIZE = 65536;
     /**The max number of indices in a index buffer.*/
     static const int INDEX_VBO_SIZE = VBO_SIZE * 6 / 4;
@@ -132,6 +178,21 @@ public:
     static const int BATCH_QUADCOMMAND_RESEVER_SIZE = 64;
     /**Reserved for material id, which means that the command could not be batched.*/
     static const int MATERIAL_ID_DO_NOT_BATCH = 0;
+
+    /**
+     The commands added by one thread during a parallel visit, see beginCommandList().
+     The commands keep the render queue they were added to, submitCommandList() adds them in the same order.
+     */
+    struct CommandList
+    {
+        std::vector<std::pair<int, RenderCommand*>> commands;
+        std::stack<int> groupStack;
+        //false when the commands are recorded out of the window space, checkVisibility() keeps everything then
+        bool cullingEnabled;
+
+        CommandList() : cullingEnabled(true) {}
+    };
+
     /**Constructor.*/
     Renderer();
     /**Destructor.*/
@@ -152,9 +213,52 @@ public:
     /** Pops a group from the render queue */
     void popGroup();
 
-    /** Creates a render queue and returns its Id */
+    /** Gets the render queue the commands are added to, on the main thread. */
+    int getCurrentRenderQueueID() const { return _commandGroupStack.top(); }
+
+    /** Creates a render queue and returns its Id. It can be called by the workers of a parallel visit. */
     int createRenderQueue();
 
+    /**
+     * Makes the calling thread record the commands it adds into `list` instead of the render queues,
+     * pushGroup() and popGroup() only change the group stack of the list.
+     * It is used by the parallel visit of Scene, the lists are submitted on the main thread once every worker is done.
+     * It must be called while the main thread isn't adding commands.
+     */
+    void beginCommandList(CommandList* list);
+    /** Stops recording the commands of the calling thread. */
+    void endCommandList();
+    /** Adds the commands recorded in `list` to their render queues, on the main thread. The list is emptied. */
+    void submitCommandList(CommandList& list);
+    /** Whether the calling thread records its commands into a command list. */
+    static bool isRecordingCommandList();
+
+    /**
+     * Creates a render command that lives until the frame it's added to is drawn, instead of a member of the node.
+     * The commands and their payloads come from the arena of the frame, see getFrameArena(), which keeps its memory
+     * from frame to frame. It can be called by the workers of a parallel visit.
+     * @code
+     * auto command = renderer->createFrameCommand<QuadCommand>();
+     * command->init(_globalZOrder, textureID, getGLProgramState(), _blendFunc,
+     *               renderer->copyFrameData(_quads.data(), _quads.size()), _quads.size(), transform, flags);
+     * renderer->addCommand(command);
+     * @endcode
+     * @since v3.11
+     */
+    template <class T, class... Args>
+    T* createFrameCommand(Args&&... args) { return getFrameArena()->create<T>(std::forward<Args>(args)...); }
+    /** Copies the payload of a command created by createFrameCommand(), e.g. its vertices, into the frame arena. */
+    template <class T>
+    T* copyFrameData(const T* data, size_t count) { return getFrameArena()->copy(data, count); }
+    /**
+     * Returns the arena of the frame being recorded. It's reset once the frame is drawn, or once the render thread
+     * is done with it, the render thread draws from the arena of the previous frame meanwhile.
+     */
+    FrameArena* getFrameArena() { return &_frameArenas[_frameArenaIndex]; }
+
+    /** Enables the reordering of the commands of a render queue by material for the current frame, see RenderQueue::setReorderEnabled() */
+    void setRenderQueueReorderEnabled(int renderQueueID, bool enabled);
+
     /** Renders into the GLView all the queued `RenderCommand` objects */
     void render();
 
@@ -166,6 +270,8 @@ public:
 
     /** set color for clear screen */
     void setClearColor(const Color4F& clearColor);
+    /** returns the color the screen is cleared with */
+    const Color4F& getClearColor() const { return _clearColor; }
     /* returns the number of drawn batches in the last frame */
     ssize_t getDrawnBatches() const { return _drawnBatches; }
     /* RenderCommands (except) QuadCommand should update this value */
@@ -174,8 +280,37 @@ public:
     ssize_t getDrawnVertices() const { return _drawnVertices; }
     /* RenderCommands (except) QuadCommand should update this value */
     void addDrawnVertices(ssize_t number) { _drawnVertices += number; };
+    /* returns the number of batches that were broken in the last frame because the batch capacity was reached */
+    ssize_t getCapacityBreaks() const { return _capacityBreaks; }
+    /* returns the number of render commands added in the last frame, groups included */
+    ssize_t getCommandCount() const { return _commandCount; }
+    /* returns the most render commands added in a frame so far */
+    ssize_t getPeakCommandCount() const { return _peakCommandCount; }
+    /* returns the most bytes the commands created for a frame took since the last shrinkToFit(), see createFrameCommand() */
+    size_t getPeakFrameArenaSize() const { return std::max(_frameArenas[0].getPeakSize(), _frameArenas[1].getPeakSize()); }
     /* clear draw stats */
-    void clearDrawStats() { _drawnBatches = _drawnVertices = 0; }
+    void clearDrawStats() { _drawnBatches = _drawnVertices = _capacityBreaks = 0; }
+    /* returns the number of GL state calls of the last frame that reached GL, see GL::getStateCacheStats() */
+    unsigned int getIssuedStateCalls() const { return _issuedStateCalls; }
+    /* returns the number of redundant GL state calls of the last frame that the GL state cache dropped */
+    unsigned int getSkippedStateCalls() const { return _skippedStateCalls; }
+
+    /**
+     * Sets the max number of vertices of a batch of quads or triangles.
+     * The batch buffers grow on demand up to this size, a batch is drawn as soon as it's full.
+     * Smaller values save memory, bigger values break batches less often.
+     * The capacity is clamped to [4, VBO_SIZE]. A single command bigger than the capacity is still drawn on its own.
+     * The default value is VBO_SIZE, it can be changed with the "cocos2d.x.renderer.batch_capacity" configuration key.
+     */
+    void setBatchCapacity(int vertexCount);
+    /** Returns the max number of vertices of a batch. */
+    int getBatchCapacity() const { return _batchCapacity; }
+
+    /**
+     * Releases the batch memory that isn't needed anymore, e.g. after a scene change.
+     * The buffers are shrunk at the end of the next frame, to the size of the biggest batch of that frame.
+     */
+    void shrinkToFit();
 
     /**
      * Enable/Disable depth test
@@ -190,7 +325,199 @@ public:
     /** returns whether or not a rectangle is visible or not */
     bool checkVisibility(const Mat4& transform, const Size& size);
 
+    /**
+     * Clips the next commands to a rect in normalized device coordinates, intersected with the current scissor box.
+     * It's called while rendering, from a CustomCommand. The rect is mapped with the viewport of that moment,
+     * so it works in a RenderTexture too. popScissor() restores the previous scissor state.
+     */
+    void pushScissor(const Rect& ndcRect);
+    /** Restores the scissor state saved by the matching pushScissor(). */
+    void popScissor();
+    /**
+     * Projects a rect of a node into normalized device coordinates for pushScissor(), with the projection of the Director.
+     * It's called while visiting. ndcRect gets the bounds of the projected rect, axisAligned whether they match it exactly,
+     * they don't when the rect is rotated or in perspective. Returns false if the rect is behind the eye.
+     */
+    static bool projectScissorRect(const Rect& rect, const Mat4& transform, Rect* ndcRect, bool* axisAligned = nullptr);
+
+    /**
+     * Enable/Disable streaming of batched vertices through a triple-buffered ring buffer.
+     * Vertices are written straight into VBO memory mapped with glMapBufferRange, instead of being
+     * copied into a client side array and uploaded after orphaning the VBO on every flush.
+     * It is ignored if the GPU doesn't support map_buffer_range.
+     * Enabled by default when CC_RENDERER_USE_RING_BUFFER is 1.
+     */
+    void setRingBufferEnabled(bool enabled);
+    /** Whether or not batched vertices are streamed through the ring buffer. */
+    bool isRingBufferEnabled() const { return _quadRing != nullptr; }
+
+    /**
+     * Enable/Disable drawing of plain sprite quads with glDrawElementsInstanced.
+     * A TrianglesCommand qualifies when it is an axis aligned quad with a single color that uses
+     * the SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP program and can be batched. Its transform, uvs and color
+     * are uploaded once per quad, the vertices are computed by the GPU. Every other command is drawn as usual.
+     * It is ignored if the GPU doesn't support instanced arrays, e.g. on most GLES2 devices.
+     * Enabled by default when CC_RENDERER_USE_INSTANCING is 1.
+     */
+    void setInstancingEnabled(bool enabled);
+    /** Whether or not plain sprite quads are drawn with instancing. */
+    bool isInstancingEnabled() const { return _isInstancingEnabled && _instancedProgram != nullptr; }
+
+    /**
+     * Enable/Disable the compact vertices of the triangles and quads batches.
+     * The vertices of a command are packed as V2F_C4B_T2US when it's transformed in the z = 0 plane and its uvs are
+     * in [0, 1], which is the case of nearly every 2D node. The batches upload 16 bytes per vertex instead of 24.
+     * The other commands keep V3F_C4B_T2F, a batch breaks when the format changes. The shaders don't change:
+     * GL expands the 2 components of the position to (x, y, 0, 1) and normalizes the uvs.
+     * Enabled by default when CC_RENDERER_USE_COMPACT_VERTICES is 1.
+     */
+    void setCompactVerticesEnabled(bool enabled);
+    /** Whether or not the 2D vertices are batched in the compact format. */
+    bool isCompactVerticesEnabled() const { return _isCompactVerticesEnabled; }
+
+    /**
+     * Enable/Disable the opaque pass of the render queues.
+     * The opaque TrianglesCommands a render queue starts with, the back of its painter's order, are drawn first and
+     * front to back, with depth testing and writing and without blending. Each gets a depth from its place in the
+     * painter's order, the pixels hidden by the commands in front are rejected before shading, cutting the overdraw of
+     * layered backgrounds. The rest of the queue is then drawn back to front as usual, on top of them.
+     * A command qualifies when it isn't transparent, see Sprite::setOpaque(), lies in the z = 0 plane and uses the
+     * SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP program. The pass is skipped when the framebuffer has no depth buffer
+     * or the 2D depth test is on.
+     * Enabled by default when CC_RENDERER_USE_OPAQUE_PASS is 1.
+     */
+    void setOpaquePassEnabled(bool enabled);
+    /** Whether or not the opaque commands at the back of the render queues are drawn front to back. */
+    bool isOpaquePassEnabled() const { return _isOpaquePassEnabled && _opaqueProgram != nullptr; }
+
+    /**
+     * Enable/Disable the batching across the group commands, e.g. of ClippingNode, RenderTexture or NodeGrid.
+     * The commands of the render queue of a group are drawn in the batch of the commands before it, and the ones after
+     * it go on with its last batch. A group boundary only draws the batch when the depth, depth write, cull or blend
+     * state of the queue differs. The render targets and the stencil are changed by custom commands, which still
+     * draw the batch before they execute. When disabled, the batch is drawn at each group and at the end of each
+     * global z group of a queue.
+     * Enabled by default when CC_RENDERER_BATCH_ACROSS_GROUPS is 1.
+     */
+    void setGroupBatchingEnabled(bool enabled);
+    /** Whether or not the batches go on across the group commands. */
+    bool isGroupBatchingEnabled() const { return _isGroupBatchingEnabled; }
+
+    /**
+     * Enable/Disable the batching of sprites with different textures.
+     * A TrianglesCommand qualifies when it uses the SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP program and can be batched.
+     * Up to CC_RENDERER_MAX_BATCH_TEXTURES textures are bound to their own units and each vertex carries the unit of its
+     * texture, so sprites from different atlases share a draw call. A batch only breaks on a blend change or when the
+     * units run out. Instanced quads are still drawn with instancing, see setInstancingEnabled().
+     * Enabled by default when CC_RENDERER_USE_MULTI_TEXTURE is 1.
+     */
+    void setMultiTextureBatchingEnabled(bool enabled);
+    /** Whether or not sprites with different textures are batched together. */
+    bool isMultiTextureBatchingEnabled() const { return _isMultiTextureEnabled && _multiTextureProgram != nullptr; }
+
+    /**
+     * Enable/Disable the render thread.
+     * When enabled, render() hands the frame over to a thread that owns the context of the GLView, which draws
+     * and swaps it while the main thread updates and visits the next one.
+     * The triangles, quads and groups of the frame are copied with their vertices, so the nodes can change right away.
+     * Frames with custom, batch or primitive commands, or with GLProgramState uniforms, are drawn while
+     * the main thread waits, since those read their nodes when they are executed.
+     * The main thread switches to a context in the share group of the view, to keep creating textures and shaders.
+     * VAOs aren't shared between contexts: the "cocos2d.x.renderer.render_thread" configuration key turns them off
+     * when the GPU info is gathered and makes the Director enable the thread. The thread can't be enabled with VAOs on.
+     * It is ignored if the GLView doesn't support it, see GLView::isRenderThreadSupported().
+     */
+    void setRenderThreadEnabled(bool enabled);
+    /** Whether or not the frames are drawn by the render thread. */
+    bool isRenderThreadEnabled() const { return _renderThread != nullptr; }
+    /** Blocks until the render thread is done with the frame it draws. It returns at once if the thread isn't enabled. */
+    void waitForRenderThread();
+    /** Deletes a texture for the main thread. The frame drawn by the render thread may still sample it,
+     * it is then deleted when the next frame is handed over. It's deleted at once if the thread isn't enabled.
+     * @since v3.11
+     * @js NA
+     * @lua NA
+     */
+    void deleteTexture(GLuint name);
+
+    /**
+     * Enable/Disable the measure of the sort, batch fill, submit and GPU times of the frames.
+     * They are added to the frames of Director::getFrameTimings(), the Director enables them with its frame timings.
+     * The GPU time is measured with a GL_TIME_ELAPSED_EXT query per frame, read back a few frames later without stalling.
+     * It is skipped if the GPU doesn't support timer queries.
+     */
+    void setTimingsEnabled(bool enabled);
+    /** Whether or not the timings of the frames are measured. */
+    bool isTimingsEnabled() const { return _isTimingsEnabled; }
+
+    /** The debug views of the Renderer, see setDebugMode(). */
+    enum class DebugMode
+    {
+        /** Draws the frame as usual. */
+        NONE,
+        /** Draws an overdraw heatmap. */
+        OVERDRAW,
+        /** Draws each batch in its own color and logs why it was drawn. */
+        BATCHES
+    };
+
+    /** Why a batch was drawn, logged in DebugMode::BATCHES. */
+    enum class BatchBreak
+    {
+        /** The next command has another texture, program or blend function. */
+        MATERIAL,
+        /** A custom, batch or primitive command draws itself. */
+        CUSTOM_COMMAND,
+        /** A group command draws its render queue. */
+        GROUP_COMMAND,
+        /** The batch is full, see setBatchCapacity(). */
+        CAPACITY,
+        /** The next command goes to another kind of batch, needs another vertex format or skips batching. */
+        STATE,
+        /** A global z group of the render queue ends. */
+        END_OF_QUEUE
+    };
+
+    /**
+     * Sets the debug view of the Renderer.
+     * OVERDRAW fills every fragment of the triangles and quads batches with an additive color, the screen goes from
+     * black to red after 8 layers, to yellow after 16 and to white after 32, transparent pixels included.
+     * BATCHES tints the texture of each draw call of the triangles and quads batches with a color of its own, and logs
+     * the batches of a frame whenever they change: the reason each was drawn, see BatchBreak, and the node of the
+     * command that caused it, see setDebugOwner().
+     * The instanced, multi texture and opaque paths are skipped, their commands go to the triangles batches.
+     * Custom commands are drawn as usual. The clear color is black in OVERDRAW.
+     */
+    void setDebugMode(DebugMode mode);
+    /** The debug view of the Renderer. */
+    DebugMode getDebugMode() const { return _debugMode; }
+    /**
+     * Sets the node the commands added next on the calling thread come from, the nodes set it before they draw.
+     * The commands only keep it in DebugMode::BATCHES.
+     */
+    static void setDebugOwner(Node* node);
+
 protected:
+    struct RenderThread;
+
+    //The per quad data of the instanced path, a_texCoord2/a_texCoord3/a_normal/a_texCoord/a_texCoord1/a_color in the shader
+    struct InstanceData
+    {
+        float origin[3];     //world position of the bottom-left corner
+        float axisX[3];      //bottom-left to bottom-right
+        float axisY[3];      //bottom-left to top-left
+        Tex2F texCoords[4];  //tl, bl, tr, br
+        Color4B color;
+    };
+
+    //The vertex of the multi texture path, textureSlot is a_texCoord1 in the shader
+    struct MultiTextureVertex
+    {
+        Vec3 vertices;
+        Color4B colors;
+        Tex2F texCoords;
+        float textureSlot;   //the unit of the texture in _batchTextures
+    };
 
     //Setup VBO or VAO based on OpenGL extensions
     void setupBuffer();
@@ -199,34 +526,107 @@ protected:
     void mapBuffers();
     void drawBatchedTriangles();
     void drawBatchedQuads();
+    void drawBatchedInstances();
+    void drawBatchedMultiTextures();
 
     //Draw the previews queued quads and flush previous context
     void flush();
 
     void flushQuads();
     void flushTriangles();
+    void flushInstances();
+    void flushMultiTextures();
 
     void processRenderCommand(RenderCommand* command);
     void visitRenderQueue(RenderQueue& queue);
+    //Sets the depth and blend state of the 2D commands, the batch is drawn first if the state changes
+    void apply2DState();
+    //Sort and draw the render queues of a frame
+    void drawFrame(std::vector<RenderQueue>& renderGroups);
+    void clearBuffers(const Color4F& clearColor);
+    void applyDepthTest();
+    void resetBatches();
+
+    //the render thread, see setRenderThreadEnabled()
+    void runRenderThread();
+    void drawCapturedFrame();
+    void captureFrame();
+    void recycleFrame();
+
+    //the timings of the frames, see setTimingsEnabled()
+    void beginTimerQuery();
+    void endTimerQuery();
+    void collectTimerQueries();
+    void deleteTimerQueries();
+    void reportTimings();
 
     void fillVerticesAndIndices(const TrianglesCommand* cmd);
     void fillQuads(const QuadCommand* cmd);
 
+    //the debug modes, see setDebugMode()
+    //A batch drawn from now on is drawn because of `reason`, caused by `command`
+    void breakBatch(BatchBreak reason, RenderCommand* command) { _batchBreak = reason; _batchBreakCommand = command; }
+    //Called before each draw call of the triangles and quads batches, applies the debug program
+    void applyDebugMode(ssize_t indexCount, BatchBreak reason, RenderCommand* command);
+    void logDebugBatches();
+
+    void setupInstancing();
+    bool canDrawInstanced(const TrianglesCommand* cmd) const;
+    void fillInstance(const TrianglesCommand* cmd);
+
+    void setupMultiTexture();
+
+    void setupOpaquePass();
+    bool canDrawOpaque(const RenderCommand* command) const;
+    //Draws the opaque commands the queue starts with, returns how many
+    size_t drawOpaqueCommands(RenderQueue& queue);
+    void drawBatchedOpaque();
+    bool canDrawMultiTexture(const TrianglesCommand* cmd) const;
+    void fillMultiTexture(const TrianglesCommand* cmd);
+
+    void setupRingBuffers();
+    void releaseRingBuffers();
+    //Returns where the next `count` vertices of the current batch must be written
+    //They are V2F_C4B_T2US when the batch is compact, V3F_C4B_T2F otherwise
+    void* getTrianglesWriteBuffer(ssize_t count);
+    void* getQuadsWriteBuffer(ssize_t count);
+    //The size of a vertex of the current triangles/quads batch
+    GLsizeiptr getTrianglesVertexSize() const { return _trianglesCompact ? sizeof(V2F_C4B_T2US) : sizeof(V3F_C4B_T2F); }
+    GLsizeiptr getQuadsVertexSize() const { return _quadsCompact ? sizeof(V2F_C4B_T2US) : sizeof(V3F_C4B_T2F); }
+
+    //Updates the command counts at the end of a frame
+    void recordCommandCount();
+    //Whether a custom command of the frame only reads the arena, see CustomCommand::setCallback()
+    bool isFrameCustomCommand(CustomCommand* command);
+
+    //Grow the batch storage so that the next command fits
+    void reserveTriangles(ssize_t vertexCount, ssize_t indexCount);
+    void reserveQuads(ssize_t quadCount);
+    void shrinkBuffers();
+
     /* clear color set outside be used in setGLDefaultValues() */
     Color4F _clearColor;
 
     std::stack<int> _commandGroupStack;
 
     std::vector<RenderQueue> _renderGroups;
+    //the render queues the groups refer to while drawing, the ones of the captured frame on the render thread
+    std::vector<RenderQueue>* _drawnGroups;
 
     uint32_t _lastMaterialID;
 
     std::vector<TrianglesCommand*> _batchedCommands;
     std::vector<QuadCommand*> _batchQuadCommands;
 
+    //the max number of vertices of a batch, see setBatchCapacity()
+    int _batchCapacity;
+    //the biggest batch drawn since the last shrinkToFit()
+    int _peakBatchVertices;
+    bool _shrinkRequested;
+
     //for TrianglesCommand
-    V3F_C4B_T2F _verts[VBO_SIZE];
-    GLushort _indices[INDEX_VBO_SIZE];
+    std::vector<V3F_C4B_T2F> _verts;
+    std::vector<GLushort> _indices;
     GLuint _buffersVAO;
     GLuint _buffersVBO[2]; //0: vertex  1: indices
 
@@ -234,23 +634,128 @@ protected:
     int _filledIndex;
 
     //for QuadCommand
-    V3F_C4B_T2F _quadVerts[VBO_SIZE];
-    GLushort _quadIndices[INDEX_VBO_SIZE];
+    std::vector<V3F_C4B_T2F> _quadVerts;
     GLuint _quadVAO;
-    GLuint _quadbuffersVBO[2]; //0: vertex  1: indices
+    GLuint _quadbuffersVBO[1]; //0: vertex, the indices are in the shared QuadIndexBuffer
     int _numberQuads;
 
+    //the format of the vertices of the current batches and of the pointers of their VAOs, see setCompactVerticesEnabled()
+    //compact vertices are packed at the start of _verts/_quadVerts, they are smaller
+    bool _isCompactVerticesEnabled;
+    bool _trianglesCompact;
+    bool _quadsCompact;
+    bool _trianglesVAOCompact;
+    bool _quadVAOCompact;
+
+    //streaming buffers, nullptr when the vertices are copied from _verts/_quadVerts
+    StreamBuffer* _trianglesRing;
+    StreamBuffer* _quadRing;
+    bool _ringBufferRequested;
+
+    //for the instanced path, see setInstancingEnabled()
+    std::vector<InstanceData> _instances;
+    std::vector<TrianglesCommand*> _batchInstanceCommands;
+    GLuint _instanceVBO[2]; //0: unit quad  1: instances
+    GLProgram* _instancedProgram;
+    //the program of the commands the instanced and multi texture paths draw
+    GLProgram* _instanceSourceProgram;
+    bool _isInstancingEnabled;
+
+    //for the multi texture path, see setMultiTextureBatchingEnabled()
+    std::vector<MultiTextureVertex> _multiTextureVerts;
+    std::vector<GLushort> _multiTextureIndices;
+    std::vector<GLuint> _batchTextures;
+    BlendFunc _multiTextureBlend;
+    GLuint _multiTextureVBO[2]; //0: vertex  1: indices
+    GLint _multiTextureSamplers[CC_RENDERER_MAX_BATCH_TEXTURES];
+    int _maxBatchTextures;
+    GLProgram* _multiTextureProgram;
+    bool _isMultiTextureEnabled;
+
+    //for the opaque pass, see setOpaquePassEnabled()
+    std::vector<TrianglesCommand*> _opaqueCommands;
+    std::vector<V3F_C4B_T2F> _opaqueVerts;
+    std::vector<GLushort> _opaqueIndices;
+    GLuint _opaqueTexture;
+    GLuint _opaqueVBO[2]; //0: vertex  1: indices
+    GLProgram* _opaqueProgram;
+    bool _isOpaquePassEnabled;
+
+    //see setGroupBatchingEnabled()
+    bool _isGroupBatchingEnabled;
+
     bool _glViewAssigned;
 
+    //the storage of the commands created for a frame, the render thread draws from one while the other is recorded
+    FrameArena _frameArenas[2];
+    int _frameArenaIndex;
+
     // stats
+    ssize_t _commandCount;
+    ssize_t _peakCommandCount;
+    //the commands added since the last frame
+    ssize_t _frameCommandCount;
     ssize_t _drawnBatches;
     ssize_t _drawnVertices;
+    ssize_t _capacityBreaks;
+    unsigned int _issuedStateCalls;
+    unsigned int _skippedStateCalls;
     //the flag for checking whether renderer is rendering
     bool _isRendering;
 
     bool _isDepthTestFor2D;
 
+    //the scissor states saved by pushScissor()
+    struct ScissorState
+    {
+        bool enabled;
+        GLint box[4];
+    };
+    std::vector<ScissorState> _scissorStates;
+
     GroupCommandManager* _groupCommandManager;
+    //guards _renderGroups when queues are created by a parallel visit
+    std::mutex _renderGroupsMutex;
+
+    //the captured frame and the thread that draws it, nullptr when render() draws
+    RenderThread* _renderThread;
+    //clear() and setDepthTest() are applied by the render thread at the start of the next frame
+    bool _clearRequested;
+    bool _depthTestChanged;
+
+    //the timings of the drawn frame, written by the thread that draws and reported by the main thread
+    static const int TIMER_QUERY_COUNT = 4;
+    bool _isTimingsEnabled;
+    unsigned int _timedFrame;
+    float _renderTime; //negative once reported
+    float _sortTime;
+    float _submitTime;
+    float _swapTime;
+    //the queries of the context that draws, the pending ones start at _timerQueryFirst
+    GLuint _timerQueries[TIMER_QUERY_COUNT];
+    unsigned int _timerQueryFrames[TIMER_QUERY_COUNT];
+    int _timerQueryFirst;
+    int _timerQueryCount;
+    bool _isTimerQueryActive;
+    //the GPU times read back, by frame number
+    std::vector<std::pair<unsigned int, float>> _gpuTimes;
+
+    //the debug modes, see setDebugMode()
+    struct DebugBatch
+    {
+        BatchBreak reason;
+        ssize_t indexCount;
+        std::string owner;
+    };
+    DebugMode _debugMode;
+    GLProgram* _debugProgram;
+    GLint _debugColorLocation;
+    GLint _debugTextureAlphaLocation;
+    BatchBreak _batchBreak;
+    RenderCommand* _batchBreakCommand;
+    //the batches of the frame being drawn, and of the last frame logged
+    std::vector<DebugBatch> _debugBatches;
+    std::vector<DebugBatch> _loggedDebugBatches;
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     EventListenerCustom* _cacheTextureListener;
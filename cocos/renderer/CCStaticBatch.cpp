@@ -0,0 +1,249 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "renderer/CCStaticBatch.h"
+
+#include "renderer/CCTrianglesCommand.h"
+#include "renderer/CCQuadCommand.h"
+#include "renderer/CCGLProgramCache.h"
+#include "renderer/CCGLProgramState.h"
+#include "renderer/ccGLStateCache.h"
+#include "base/ccMacros.h"
+#include "base/CCDirector.h"
+#include "base/CCEventType.h"
+#include "base/CCEventListenerCustom.h"
+#include "base/CCEventDispatcher.h"
+
+NS_CC_BEGIN
+
+// the indices of a run of vertices are GLushort
+static const ssize_t MAX_CHUNK_VERTICES = 65536;
+
+StaticBatch::StaticBatch()
+: _vertexCount(0)
+, _indexCount(0)
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+, _rendererRecreatedListener(nullptr)
+#endif
+{
+    _buffersVBO[0] = _buffersVBO[1] = 0;
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    /** listen the event that renderer was recreated on Android/WP8 */
+    _rendererRecreatedListener = EventListenerCustom::create(EVENT_RENDERER_RECREATED, CC_CALLBACK_1(StaticBatch::listenRendererRecreated, this));
+    Director::getInstance()->getEventDispatcher()->addEventListenerWithFixedPriority(_rendererRecreatedListener, -1);
+#endif
+}
+
+StaticBatch::~StaticBatch()
+{
+    releaseBuffers();
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    Director::getInstance()->getEventDispatcher()->removeEventListener(_rendererRecreatedListener);
+#endif
+}
+
+void StaticBatch::releaseBuffers()
+{
+    if (_buffersVBO[0])
+    {
+        GL::deleteBuffers(2, _buffersVBO);
+        _buffersVBO[0] = _buffersVBO[1] = 0;
+    }
+    _segments.clear();
+    _vertexCount = _indexCount = 0;
+}
+
+bool StaticBatch::record(const Renderer::CommandList& list, float globalZOrder)
+{
+    releaseBuffers();
+
+    auto program = GLProgramCache::getInstance()->getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP);
+    std::vector<V3F_C4B_T2F> vertices;
+    std::vector<GLushort> indices;
+    std::vector<Segment> segments;
+    size_t chunkStart = 0;
+
+    for (const auto& entry : list.commands)
+    {
+        RenderCommand* command = entry.second;
+        if (command->getGlobalOrder() != globalZOrder)
+        {
+            return false;
+        }
+
+        const V3F_C4B_T2F* commandVertices = nullptr;
+        const unsigned short* commandIndices = nullptr;
+        ssize_t vertexCount = 0;
+        ssize_t indexCount = 0;
+        GLuint textureID = 0;
+        BlendFunc blendFunc;
+        GLProgramState* glProgramState = nullptr;
+        const Mat4* modelView = nullptr;
+
+        if (command->getType() == RenderCommand::Type::TRIANGLES_COMMAND)
+        {
+            auto cmd = static_cast<TrianglesCommand*>(command);
+            commandVertices = cmd->getVertices();
+            commandIndices = cmd->getIndices();
+            vertexCount = cmd->getVertexCount();
+            indexCount = cmd->getIndexCount();
+            textureID = cmd->getTextureID();
+            blendFunc = cmd->getBlendType();
+            glProgramState = cmd->getGLProgramState();
+            modelView = &cmd->getModelView();
+        }
+        else if (command->getType() == RenderCommand::Type::QUAD_COMMAND)
+        {
+            auto cmd = static_cast<QuadCommand*>(command);
+            commandVertices = reinterpret_cast<const V3F_C4B_T2F*>(cmd->getQuads());
+            vertexCount = cmd->getQuadCount() * 4;
+            indexCount = cmd->getQuadCount() * 6;
+            textureID = cmd->getTextureID();
+            blendFunc = cmd->getBlendType();
+            glProgramState = cmd->getGLProgramState();
+            modelView = &cmd->getModelView();
+        }
+        else
+        {
+            return false;
+        }
+
+        if (glProgramState->getGLProgram() != program || glProgramState->getUniformCount() > 0 || vertexCount > MAX_CHUNK_VERTICES)
+        {
+            return false;
+        }
+
+        // a new run of vertices when the indices would overflow
+        bool newSegment = segments.empty() || segments.back().textureID != textureID || segments.back().blendFunc != blendFunc;
+        if (vertices.size() - chunkStart + vertexCount > (size_t)MAX_CHUNK_VERTICES)
+        {
+            chunkStart = vertices.size();
+            newSegment = true;
+        }
+        if (newSegment)
+        {
+            Segment segment = { textureID, blendFunc, (GLintptr)(chunkStart * sizeof(V3F_C4B_T2F)), (GLintptr)(indices.size() * sizeof(GLushort)), 0 };
+            segments.push_back(segment);
+        }
+        segments.back().indexCount += (GLsizei)indexCount;
+
+        const GLushort base = (GLushort)(vertices.size() - chunkStart);
+        for (ssize_t i = 0; i < vertexCount; ++i)
+        {
+            V3F_C4B_T2F vertex = commandVertices[i];
+            modelView->transformPoint(&vertex.vertices);
+            vertices.push_back(vertex);
+        }
+        if (commandIndices)
+        {
+            for (ssize_t i = 0; i < indexCount; ++i)
+            {
+                indices.push_back(base + commandIndices[i]);
+            }
+        }
+        else
+        {
+            // the 0-1-2, 3-2-1 pattern of the quads
+            for (ssize_t i = 0; i < vertexCount; i += 4)
+            {
+                const GLushort quad = (GLushort)(base + i);
+                const GLushort quadIndices[6] = { quad, (GLushort)(quad + 1), (GLushort)(quad + 2), (GLushort)(quad + 3), (GLushort)(quad + 2), (GLushort)(quad + 1) };
+                indices.insert(indices.end(), quadIndices, quadIndices + 6);
+            }
+        }
+    }
+
+    glGenBuffers(2, &_buffersVBO[0]);
+    // Avoid changing the element buffer for whatever VAO might be bound.
+    GL::bindVAO(0);
+    GL::bindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+    GL::bufferData(GL_ARRAY_BUFFER, sizeof(V3F_C4B_T2F) * vertices.size(), vertices.data(), GL_STATIC_DRAW);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+    GL::bufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLushort) * indices.size(), indices.data(), GL_STATIC_DRAW);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    CHECK_GL_ERROR_DEBUG();
+
+    _segments.swap(segments);
+    _vertexCount = (ssize_t)vertices.size();
+    _indexCount = (ssize_t)indices.size();
+    return true;
+}
+
+void StaticBatch::draw(Renderer* renderer, const Mat4& transform, uint32_t flags, float globalZOrder)
+{
+    if (_segments.empty())
+    {
+        return;
+    }
+
+    _customCommand.init(globalZOrder, transform, flags);
+    _customCommand.func = CC_CALLBACK_0(StaticBatch::onDraw, this, transform);
+    renderer->addCommand(&_customCommand);
+}
+
+void StaticBatch::onDraw(const Mat4& transform)
+{
+    // the vertices are in the space of the subtree root, the program with the model view transforms them
+    auto glProgram = GLProgramCache::getInstance()->getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR);
+    glProgram->use();
+    glProgram->setUniformsForBuiltins(transform);
+
+    GL::bindVAO(0);
+    GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX);
+    GL::bindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+
+    GLintptr vertexOffset = -1;
+    for (const auto& segment : _segments)
+    {
+        if (segment.vertexOffset != vertexOffset)
+        {
+            vertexOffset = segment.vertexOffset;
+            GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*)(vertexOffset + offsetof(V3F_C4B_T2F, vertices)));
+            GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V3F_C4B_T2F), (GLvoid*)(vertexOffset + offsetof(V3F_C4B_T2F, colors)));
+            GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*)(vertexOffset + offsetof(V3F_C4B_T2F, texCoords)));
+        }
+        GL::bindTexture2D(segment.textureID);
+        GL::blendFunc(segment.blendFunc.src, segment.blendFunc.dst);
+        glDrawElements(GL_TRIANGLES, segment.indexCount, GL_UNSIGNED_SHORT, (GLvoid*)segment.indexOffset);
+    }
+
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    CC_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(_segments.size(), _indexCount);
+    CHECK_GL_ERROR_DEBUG();
+}
+
+void StaticBatch::listenRendererRecreated(EventCustom* event)
+{
+    // the names went away with the context, the owner records the batch again
+    _buffersVBO[0] = _buffersVBO[1] = 0;
+    _segments.clear();
+}
+
+NS_CC_END
@@ -0,0 +1,104 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_STATIC_BATCH_H__
+#define __CC_STATIC_BATCH_H__
+
+#include <vector>
+
+#include "renderer/CCRenderer.h"
+#include "renderer/CCCustomCommand.h"
+
+/**
+ * @addtogroup renderer
+ * @{
+ */
+
+NS_CC_BEGIN
+
+class EventCustom;
+class EventListenerCustom;
+
+/**
+ StaticBatch holds the triangles and quads commands of a subtree, recorded once and drawn every frame without
+ visiting or filling them again. Their vertices are transformed into the space of the subtree root and uploaded
+ to a static VBO. It draws them with a CustomCommand and the transform of the root, one draw call per run of
+ commands with the same texture and blend function. Used by Node::setCacheAsGeometry().
+ @js NA
+ */
+class CC_DLL StaticBatch
+{
+public:
+    StaticBatch();
+    ~StaticBatch();
+
+    /**
+     Builds the batch from the commands of a subtree recorded with an identity transform at its root.
+     It returns false, and the batch is empty, when a command can't be part of it: it isn't a TrianglesCommand or
+     a QuadCommand, its program isn't SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP or has uniforms, or its global z order
+     isn't `globalZOrder`.
+     */
+    bool record(const Renderer::CommandList& list, float globalZOrder);
+
+    /** Whether the vertices are in GL, they are lost with the GL context and must be recorded again. */
+    bool isValid() const { return _buffersVBO[0] != 0; }
+
+    /** Adds the command that draws the batch with the transform of the subtree root. */
+    void draw(Renderer* renderer, const Mat4& transform, uint32_t flags, float globalZOrder);
+
+    /** Gets the number of vertices of the batch. */
+    ssize_t getVertexCount() const { return _vertexCount; }
+
+protected:
+    //The commands of a draw call, its indices address the vertices from vertexOffset
+    struct Segment
+    {
+        GLuint textureID;
+        BlendFunc blendFunc;
+        GLintptr vertexOffset;
+        GLintptr indexOffset;
+        GLsizei indexCount;
+    };
+
+    void onDraw(const Mat4& transform);
+    void releaseBuffers();
+    void listenRendererRecreated(EventCustom* event);
+
+    std::vector<Segment> _segments;
+    GLuint _buffersVBO[2]; //0: vertex  1: indices
+    ssize_t _vertexCount;
+    ssize_t _indexCount;
+    CustomCommand _customCommand;
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    EventListenerCustom* _rendererRecreatedListener;
+#endif
+};
+
+NS_CC_END
+
+/**
+ end of support group
+ @}
+ */
+#endif //__CC_STATIC_BATCH_H__
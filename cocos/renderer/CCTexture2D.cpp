@@ -32,6 +32,7 @@ THE SOFTWARE.
 */
 
 #include "renderer/CCTexture2D.h"
+#include <cmath>
 #include <unordered_set>
 
 #include "platform/CCGL.h"
@@ -46,6 +47,8 @@ THE SOFTWARE.
 #include "renderer/CCGLProgram.h"
 #include "renderer/ccGLStateCache.h"
 #include "renderer/CCGLProgramCache.h"
+#include "renderer/CCRenderer.h"
+#include "renderer/ccPixelConversion.h"
 #include "base/CCNinePatchImageParser.h"
 #include "base/CCString.h"
 
@@ -53,6 +56,23 @@ THE SOFTWARE.
     #include "renderer/CCTextureCache.h"
 #endif
 
+// GLES 3.0, GL 4.3 and KHR_texture_compression_astc_ldr share these values, the GLES2 headers don't have them
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2                 0x9274
+#endif
+#ifndef GL_COMPRESSED_RGBA8_ETC2_EAC
+#define GL_COMPRESSED_RGBA8_ETC2_EAC            0x9278
+#endif
+#ifndef GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+#define GL_COMPRESSED_RGBA_ASTC_4x4_KHR         0x93B0
+#endif
+#ifndef GL_COMPRESSED_RGBA_ASTC_6x6_KHR
+#define GL_COMPRESSED_RGBA_ASTC_6x6_KHR         0x93B4
+#endif
+#ifndef GL_COMPRESSED_RGBA_ASTC_8x8_KHR
+#define GL_COMPRESSED_RGBA_ASTC_8x8_KHR         0x93B7
+#endif
+
 NS_CC_BEGIN
 
 namespace {
@@ -80,6 +100,14 @@ namespace {
         PixelFormatInfoMapValue(Texture2D::PixelFormat::ETC, Texture2D::PixelFormatInfo(GL_ETC1_RGB8_OES, 0xFFFFFFFF, 0xFFFFFFFF, 4, true, false)),
 #endif
 
+        PixelFormatInfoMapValue(Texture2D::PixelFormat::ETC2_RGB, Texture2D::PixelFormatInfo(GL_COMPRESSED_RGB8_ETC2, 0xFFFFFFFF, 0xFFFFFFFF, 4, true, false)),
+        PixelFormatInfoMapValue(Texture2D::PixelFormat::ETC2_RGBA, Texture2D::PixelFormatInfo(GL_COMPRESSED_RGBA8_ETC2_EAC, 0xFFFFFFFF, 0xFFFFFFFF, 8, true, true)),
+
+        // bpp is rounded for the block sizes that don't give a whole number of bits
+        PixelFormatInfoMapValue(Texture2D::PixelFormat::ASTC_4x4, Texture2D::PixelFormatInfo(GL_COMPRESSED_RGBA_ASTC_4x4_KHR, 0xFFFFFFFF, 0xFFFFFFFF, 8, true, true)),
+        PixelFormatInfoMapValue(Texture2D::PixelFormat::ASTC_6x6, Texture2D::PixelFormatInfo(GL_COMPRESSED_RGBA_ASTC_6x6_KHR, 0xFFFFFFFF, 0xFFFFFFFF, 4, true, true)),
+        PixelFormatInfoMapValue(Texture2D::PixelFormat::ASTC_8x8, Texture2D::PixelFormatInfo(GL_COMPRESSED_RGBA_ASTC_8x8_KHR, 0xFFFFFFFF, 0xFFFFFFFF, 2, true, true)),
+
 #ifdef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
         PixelFormatInfoMapValue(Texture2D::PixelFormat::S3TC_DXT1, Texture2D::PixelFormatInfo(GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, 0xFFFFFFFF, 0xFFFFFFFF, 4, true, false)),
 #endif
@@ -119,6 +147,20 @@ const Texture2D::PixelFormatInfoMap Texture2D::_pixelFormatInfoTables(TexturePix
 // Default is: RGBA8888 (32-bit textures)
 static Texture2D::PixelFormat g_defaultAlphaPixelFormat = Texture2D::PixelFormat::DEFAULT;
 
+// the render thread may still sample the texture in the frame it draws, the renderer deletes it once it's drawn
+static void deleteDrawnTexture(GLuint name)
+{
+    auto director = Director::DirectorInstance;
+    if (director && director->getRenderer())
+    {
+        director->getRenderer()->deleteTexture(name);
+    }
+    else
+    {
+        GL::deleteTexture(name);
+    }
+}
+
 //////////////////////////////////////////////////////////////////////////
 //convertor function
 
@@ -311,13 +353,7 @@ void Texture2D::convertRGB888ToRGB565(const unsigned char* data, ssize_t dataLen
 // RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRRGGGGGGBBBBB
 void Texture2D::convertRGBA8888ToRGB565(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
-    unsigned short* out16 = (unsigned short*)outData;
-    for (ssize_t i = 0, l = dataLen - 3; i < l; i += 4)
-    {
-        *out16++ = (data[i] & 0x00F8) << 8    //R
-            | (data[i + 1] & 0x00FC) << 3     //G
-            | (data[i + 2] & 0x00F8) >> 3;    //B
-    }
+    pixel::convertRGBA8888ToRGB565(data, dataLen, outData);
 }
 
 // RRRRRRRRGGGGGGGGBBBBBBBB -> IIIIIIII
@@ -341,10 +377,7 @@ void Texture2D::convertRGBA8888ToI8(const unsigned char* data, ssize_t dataLen,
 // RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> AAAAAAAA
 void Texture2D::convertRGBA8888ToA8(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
-    for (ssize_t i = 0, l = dataLen -3; i < l; i += 4)
-    {
-        *outData++ = data[i + 3]; //A
-    }
+    pixel::convertRGBA8888ToA8(data, dataLen, outData);
 }
 
 // RRRRRRRRGGGGGGGGBBBBBBBB -> IIIIIIIIAAAAAAAA
@@ -384,14 +417,7 @@ void Texture2D::convertRGB888ToRGBA4444(const unsigned char* data, ssize_t dataL
 // RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRGGGGBBBBAAAA
 void Texture2D::convertRGBA8888ToRGBA4444(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
-    unsigned short* out16 = (unsigned short*)outData;
-    for (ssize_t i = 0, l = dataLen - 3; i < l; i += 4)
-    {
-        *out16++ = (data[i] & 0x00F0) << 8    //R
-        | (data[i + 1] & 0x00F0) << 4         //G
-        | (data[i + 2] & 0xF0)                //B
-        |  (data[i + 3] & 0xF0) >> 4;         //A
-    }
+    pixel::convertRGBA8888ToRGBA4444(data, dataLen, outData);
 }
 
 // RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRRGGGGGBBBBBA
@@ -423,6 +449,11 @@ void Texture2D::convertRGBA8888ToRGB5A1(const unsigned char* data, ssize_t dataL
 //////////////////////////////////////////////////////////////////////////
 static std::unordered_set<Texture2D*> s_allGLTexture2D;
 
+std::vector<Texture2D*> Texture2D::getAllTextures()
+{
+    return std::vector<Texture2D*>(s_allGLTexture2D.begin(), s_allGLTexture2D.end());
+}
+
 void Texture2D::fouceDeleteALLTexture2D()
 {
     auto copyMap = s_allGLTexture2D;
@@ -444,6 +475,10 @@ Texture2D::Texture2D()
 , _shaderProgram(nullptr)
 , _antialiasEnabled(true)
 , _ninePatchInfo(nullptr)
+, _streamedLevels(0)
+, _residentLevel(0)
+, _requestedLevel(0)
+, _requestedFrame(0)
 {
     s_allGLTexture2D.insert(this);
 }
@@ -464,7 +499,7 @@ Texture2D::~Texture2D()
 
     if(_name)
     {
-        GL::deleteTexture(_name);
+        deleteDrawnTexture(_name);
     }
 }
 
@@ -472,7 +507,7 @@ void Texture2D::releaseGLTexture()
 {
     if(_name)
     {
-        GL::deleteTexture(_name);
+        deleteDrawnTexture(_name);
     }
     _name = 0;
 }
@@ -578,17 +613,45 @@ bool Texture2D::initWithMipmaps(MipmapInfo* mipmaps, int mipmapsNum, PixelFormat
         return false;
     }
 
-    const PixelFormatInfo& info = _pixelFormatInfoTables.at(pixelFormat);
+    if (!isPixelFormatSupported(pixelFormat))
+    {
+        CCLOG("cocos2d: WARNING: the compressed pixelformat %lx isn't supported by the GPU", (unsigned long)pixelFormat);
+        return false;
+    }
 
-    if (info.compressed && !Configuration::getInstance()->supportsPVRTC()
-                        && !Configuration::getInstance()->supportsETC())
-//                        && !Configuration::getInstance()->supportsS3TC()
-//                        && !Configuration::getInstance()->supportsATITC())
+    if(_name != 0)
+    {
+        deleteDrawnTexture(_name);
+        _name = 0;
+    }
+
+    GLuint name = createGLTexture(mipmaps, mipmapsNum, pixelFormat, pixelsWide, pixelsHigh, _antialiasEnabled);
+    if (name == 0)
     {
-        CCLOG("cocos2d: WARNING: PVRTC/ETC images are not supported");
         return false;
     }
 
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    if (_antialiasEnabled)
+    {
+        TexParams texParams = {(GLuint)(_hasMipmaps?GL_LINEAR_MIPMAP_NEAREST:GL_LINEAR),GL_LINEAR,GL_NONE,GL_NONE};
+        VolatileTextureMgr::setTexParameters(this, texParams);
+    }
+    else
+    {
+        TexParams texParams = {(GLuint)(_hasMipmaps?GL_NEAREST_MIPMAP_NEAREST:GL_NEAREST),GL_NEAREST,GL_NONE,GL_NONE};
+        VolatileTextureMgr::setTexParameters(this, texParams);
+    }
+#endif
+
+    initWithGLTexture(name, pixelFormat, pixelsWide, pixelsHigh, mipmapsNum > 1);
+    return true;
+}
+
+GLuint Texture2D::createGLTexture(const MipmapInfo* mipmaps, int mipmapsNum, PixelFormat pixelFormat, int pixelsWide, int pixelsHigh, bool antialias)
+{
+    const PixelFormatInfo& info = _pixelFormatInfoTables.at(pixelFormat);
+
     //Set the row align only when mipmapsNum == 1 and the data is uncompressed
     if (mipmapsNum == 1 && !info.compressed)
     {
@@ -615,40 +678,22 @@ bool Texture2D::initWithMipmaps(MipmapInfo* mipmaps, int mipmapsNum, PixelFormat
         glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     }
 
-    if(_name != 0)
-    {
-        GL::deleteTexture(_name);
-        _name = 0;
-    }
-
-    glGenTextures(1, &_name);
-    GL::bindTexture2D(_name);
+    GLuint name = 0;
+    glGenTextures(1, &name);
+    GL::bindTexture2D(name);
 
     if (mipmapsNum == 1)
     {
-        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, _antialiasEnabled ? GL_LINEAR : GL_NEAREST);
+        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, antialias ? GL_LINEAR : GL_NEAREST);
     }else
     {
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, _antialiasEnabled ? GL_LINEAR_MIPMAP_NEAREST : GL_NEAREST_MIPMAP_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, antialias ? GL_LINEAR_MIPMAP_NEAREST : GL_NEAREST_MIPMAP_NEAREST);
     }
 
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, _antialiasEnabled ? GL_LINEAR : GL_NEAREST );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, antialias ? GL_LINEAR : GL_NEAREST );
     glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
     glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
 
-#if CC_ENABLE_CACHE_TEXTURE_DATA
-    if (_antialiasEnabled)
-    {
-        TexParams texParams = {(GLuint)(_hasMipmaps?GL_LINEAR_MIPMAP_NEAREST:GL_LINEAR),GL_LINEAR,GL_NONE,GL_NONE};
-        VolatileTextureMgr::setTexParameters(this, texParams);
-    }
-    else
-    {
-        TexParams texParams = {(GLuint)(_hasMipmaps?GL_NEAREST_MIPMAP_NEAREST:GL_NEAREST),GL_NEAREST,GL_NONE,GL_NONE};
-        VolatileTextureMgr::setTexParameters(this, texParams);
-    }
-#endif
-
     // clean possible GL error
     GLenum err = glGetError();
     if (err != GL_NO_ERROR)
@@ -683,13 +728,25 @@ bool Texture2D::initWithMipmaps(MipmapInfo* mipmaps, int mipmapsNum, PixelFormat
         if (err != GL_NO_ERROR)
         {
             CCLOG("cocos2d: Texture2D: Error uploading compressed texture level: %u . glError: 0x%04X", i, err);
-            return false;
+            GL::deleteTexture(name);
+            return 0;
         }
 
         width = MAX(width >> 1, 1);
         height = MAX(height >> 1, 1);
     }
 
+    return name;
+}
+
+void Texture2D::initWithGLTexture(GLuint name, PixelFormat pixelFormat, int pixelsWide, int pixelsHigh, bool hasMipmaps)
+{
+    if(_name != 0)
+    {
+        deleteDrawnTexture(_name);
+    }
+    _name = name;
+
     _contentSize = Size((float)pixelsWide, (float)pixelsHigh);
     _pixelsWide = pixelsWide;
     _pixelsHigh = pixelsHigh;
@@ -698,11 +755,12 @@ bool Texture2D::initWithMipmaps(MipmapInfo* mipmaps, int mipmapsNum, PixelFormat
     _maxT = 1;
 
     _hasPremultipliedAlpha = false;
-    _hasMipmaps = mipmapsNum > 1;
+    _hasMipmaps = hasMipmaps;
+    _streamedLevels = 0;
+    _residentLevel = 0;
 
     // shader
     setGLProgram(GLProgramCache::getInstance()->getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE));
-    return true;
 }
 
 bool Texture2D::updateWithData(const void *data,int offsetX,int offsetY,int width,int height)
@@ -1079,7 +1137,35 @@ bool Texture2D::initWithString(const std::string& text, const FontDefinition& te
     VolatileTextureMgr::addStringTexture(this, text, textDefinition);
 #endif
 
-    bool ret = false;
+    PixelFormat      pixelFormat = g_defaultAlphaPixelFormat;
+    unsigned char* outTempData = nullptr;
+    ssize_t outTempDataLen = 0;
+
+    int imageWidth;
+    int imageHeight;
+    bool hasPremultipliedAlpha;
+    Data outData = getStringData(text, textDefinition, imageWidth, imageHeight, hasPremultipliedAlpha);
+    if(outData.isNull())
+    {
+        return false;
+    }
+
+    Size  imageSize = Size((float)imageWidth, (float)imageHeight);
+    pixelFormat = convertDataToFormat(outData.getBytes(), imageWidth*imageHeight*4, PixelFormat::RGBA8888, pixelFormat, &outTempData, &outTempDataLen);
+
+    bool ret = initWithData(outTempData, outTempDataLen, pixelFormat, imageWidth, imageHeight, imageSize);
+
+    if (outTempData != nullptr && outTempData != outData.getBytes())
+    {
+        free(outTempData);
+    }
+    _hasPremultipliedAlpha = hasPremultipliedAlpha;
+
+    return ret;
+}
+
+Data Texture2D::getStringData(const std::string& text, const FontDefinition& textDefinition, int& width, int& height, bool& hasPremultipliedAlpha)
+{
     Device::TextAlign align;
 
     if (TextVAlignment::TOP == textDefinition._vertAlignment)
@@ -1100,19 +1186,13 @@ bool Texture2D::initWithString(const std::string& text, const FontDefinition& te
     else
     {
         CCASSERT(false, "Not supported alignment format!");
-        return false;
+        return Data::Null;
     }
 
 #if (CC_TARGET_PLATFORM != CC_PLATFORM_ANDROID) && (CC_TARGET_PLATFORM != CC_PLATFORM_IOS)
     CCASSERT(textDefinition._stroke._strokeEnabled == false, "Currently stroke only supported on iOS and Android!");
 #endif
 
-    PixelFormat      pixelFormat = g_defaultAlphaPixelFormat;
-    unsigned char* outTempData = nullptr;
-    ssize_t outTempDataLen = 0;
-
-    int imageWidth;
-    int imageHeight;
     auto textDef = textDefinition;
     auto contentScaleFactor = CC_CONTENT_SCALE_FACTOR();
     textDef._fontSize *= contentScaleFactor;
@@ -1121,25 +1201,7 @@ bool Texture2D::initWithString(const std::string& text, const FontDefinition& te
     textDef._stroke._strokeSize *= contentScaleFactor;
     textDef._shadow._shadowEnabled = false;
 
-    bool hasPremultipliedAlpha;
-    Data outData = Device::getTextureDataForText(text, textDef, align, imageWidth, imageHeight, hasPremultipliedAlpha);
-    if(outData.isNull())
-    {
-        return false;
-    }
-
-    Size  imageSize = Size((float)imageWidth, (float)imageHeight);
-    pixelFormat = convertDataToFormat(outData.getBytes(), imageWidth*imageHeight*4, PixelFormat::RGBA8888, pixelFormat, &outTempData, &outTempDataLen);
-
-    ret = initWithData(outTempData, outTempDataLen, pixelFormat, imageWidth, imageHeight, imageSize);
-
-    if (outTempData != nullptr && outTempData != outData.getBytes())
-    {
-        free(outTempData);
-    }
-    _hasPremultipliedAlpha = hasPremultipliedAlpha;
-
-    return ret;
+    return Device::getTextureDataForText(text, textDef, align, width, height, hasPremultipliedAlpha);
 }
 
 
@@ -1168,8 +1230,8 @@ void Texture2D::drawAtPoint(const Vec2& point)
 
     GL::bindTexture2D( _name );
 
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, vertices);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, 0, coordinates);
+    GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, vertices);
+    GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, 0, coordinates);
 
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 }
@@ -1193,8 +1255,8 @@ void Texture2D::drawInRect(const Rect& rect)
 
     GL::bindTexture2D( _name );
 
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, vertices);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, 0, coordinates);
+    GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, vertices);
+    GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, 0, coordinates);
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 }
 
@@ -1219,6 +1281,97 @@ bool Texture2D::hasMipmaps() const
     return _hasMipmaps;
 }
 
+// the bytes of a level, the compressed formats take whole blocks
+static size_t getLevelBytes(Texture2D::PixelFormat format, unsigned int bitsPerPixel, int width, int height)
+{
+    int blockWidth = 4;
+    int blockHeight = 4;
+    int minBlocks = 1;
+    size_t blockBytes = 0;
+    switch (format)
+    {
+        case Texture2D::PixelFormat::PVRTC4:
+        case Texture2D::PixelFormat::PVRTC4A:
+            blockBytes = 8;
+            minBlocks = 2;
+            break;
+        case Texture2D::PixelFormat::PVRTC2:
+        case Texture2D::PixelFormat::PVRTC2A:
+            blockWidth = 8;
+            blockBytes = 8;
+            minBlocks = 2;
+            break;
+        case Texture2D::PixelFormat::ETC:
+        case Texture2D::PixelFormat::ETC2_RGB:
+        case Texture2D::PixelFormat::S3TC_DXT1:
+        case Texture2D::PixelFormat::ATC_RGB:
+            blockBytes = 8;
+            break;
+        case Texture2D::PixelFormat::ETC2_RGBA:
+        case Texture2D::PixelFormat::S3TC_DXT3:
+        case Texture2D::PixelFormat::S3TC_DXT5:
+        case Texture2D::PixelFormat::ATC_EXPLICIT_ALPHA:
+        case Texture2D::PixelFormat::ATC_INTERPOLATED_ALPHA:
+        case Texture2D::PixelFormat::ASTC_4x4:
+            blockBytes = 16;
+            break;
+        case Texture2D::PixelFormat::ASTC_6x6:
+            blockWidth = blockHeight = 6;
+            blockBytes = 16;
+            break;
+        case Texture2D::PixelFormat::ASTC_8x8:
+            blockWidth = blockHeight = 8;
+            blockBytes = 16;
+            break;
+        default:
+            return (size_t)width * height * bitsPerPixel / 8;
+    }
+    size_t columns = std::max((width + blockWidth - 1) / blockWidth, minBlocks);
+    size_t rows = std::max((height + blockHeight - 1) / blockHeight, minBlocks);
+    return columns * rows * blockBytes;
+}
+
+size_t Texture2D::getMemoryBytes() const
+{
+    auto info = _pixelFormatInfoTables.find(_pixelFormat);
+    if (_name == 0 || info == _pixelFormatInfoTables.end())
+    {
+        return 0;
+    }
+
+    size_t bytes = 0;
+    int width = std::max(_pixelsWide >> _residentLevel, 1);
+    int height = std::max(_pixelsHigh >> _residentLevel, 1);
+    while (true)
+    {
+        bytes += getLevelBytes(_pixelFormat, info->second.bpp, width, height);
+        if (!_hasMipmaps || (width == 1 && height == 1))
+        {
+            break;
+        }
+        width = std::max(width >> 1, 1);
+        height = std::max(height >> 1, 1);
+    }
+    return bytes;
+}
+
+void Texture2D::requestTexelDensity(float texelsPerPixel)
+{
+    if (_streamedLevels == 0)
+    {
+        return;
+    }
+
+    // the coarsest level that still has a texel per pixel
+    int level = texelsPerPixel > 1 ? std::min((int)std::log2(texelsPerPixel), _streamedLevels - 1) : 0;
+    unsigned int frame = Director::getInstance()->getTotalFrames();
+    if (_requestedFrame != frame || level < _requestedLevel)
+    {
+        _requestedLevel = level;
+        _requestedFrame = frame;
+    }
+}
+
 void Texture2D::setTexParameters(const TexParams &texParams)
 {
     CCASSERT((_pixelsWide == ccNextPOT(_pixelsWide) || texParams.wrapS == GL_CLAMP_TO_EDGE) &&
@@ -1378,6 +1531,37 @@ const Texture2D::PixelFormatInfoMap& Texture2D::getPixelFormatInfoMap()
     return _pixelFormatInfoTables;
 }
 
+bool Texture2D::isPixelFormatSupported(PixelFormat format)
+{
+    Configuration* conf = Configuration::getInstance();
+    switch (format)
+    {
+        case PixelFormat::PVRTC4:
+        case PixelFormat::PVRTC4A:
+        case PixelFormat::PVRTC2:
+        case PixelFormat::PVRTC2A:
+            return conf->supportsPVRTC();
+        case PixelFormat::ETC:
+            return conf->supportsETC();
+        case PixelFormat::ETC2_RGB:
+        case PixelFormat::ETC2_RGBA:
+            return conf->supportsETC2();
+        case PixelFormat::ASTC_4x4:
+        case PixelFormat::ASTC_6x6:
+        case PixelFormat::ASTC_8x8:
+            return conf->supportsASTC();
+        case PixelFormat::S3TC_DXT1:
+        case PixelFormat::S3TC_DXT3:
+        case PixelFormat::S3TC_DXT5:
+        case PixelFormat::ATC_RGB:
+        case PixelFormat::ATC_EXPLICIT_ALPHA:
+        case PixelFormat::ATC_INTERPOLATED_ALPHA:
+            return false;
+        default:
+            return true;
+    }
+}
+
 void Texture2D::addSpriteFrameCapInset(SpriteFrame* spritframe, const Rect& capInsets)
 {
     if(nullptr == _ninePatchInfo)
@@ -37,6 +37,7 @@ THE SOFTWARE.
 
 NS_CC_BEGIN
 
+class Data;
 class Image;
 class NinePatchInfo;
 class SpriteFrame;
@@ -114,6 +115,16 @@ public:
         ATC_EXPLICIT_ALPHA,
         //! ATITC-compressed texture: ATC_INTERPOLATED_ALPHA
         ATC_INTERPOLATED_ALPHA,
+        //! 4-bit ETC2-compressed texture: ETC2_RGB8
+        ETC2_RGB,
+        //! 8-bit ETC2/EAC-compressed texture (has alpha channel): ETC2_RGBA8_EAC
+        ETC2_RGBA,
+        //! 8-bit ASTC-compressed texture, 4x4 blocks
+        ASTC_4x4,
+        //! 3.56-bit ASTC-compressed texture, 6x6 blocks
+        ASTC_6x6,
+        //! 2-bit ASTC-compressed texture, 8x8 blocks
+        ASTC_8x8,
         //! Default texture format: AUTO
         DEFAULT = AUTO,
 
@@ -285,6 +296,18 @@ public:
      */
     bool initWithString(const std::string& text, const FontDefinition& textDefinition);
 
+    /** Renders a string with the platform's text renderer, at the content scale factor, as initWithString does.
+
+     @param text A null terminated string.
+     @param textDefinition A FontDefinition object contains font attributes.
+     @param width Set to the width of the RGBA8888 pixels.
+     @param height Set to the height of the RGBA8888 pixels.
+     @param hasPremultipliedAlpha Set to whether or not the pixels have their alpha premultiplied.
+     @return The pixels, null if the string can't be rendered.
+     @since v3.11
+     */
+    static Data getStringData(const std::string& text, const FontDefinition& textDefinition, int& width, int& height, bool& hasPremultipliedAlpha);
+
     /** Sets the min filter, mag filter, wrap s and wrap t texture parameters.
     If the texture size is NPOT (non power of 2), then in can only use GL_CLAMP_TO_EDGE in GL_TEXTURE_WRAP_{S,T}.
 
@@ -350,6 +373,38 @@ public:
     /** Whether or not the texture has mip maps.*/
     bool hasMipmaps() const;
 
+    /** Whether the TextureCache streams the mip levels of the texture, see TextureCache::setTextureStreamingEnabled().
+     * A streamed texture keeps the size of its full resolution, while its GL texture holds the levels from
+     * getResidentLevel() on. It isn't streamed anymore once it is initialized again, e.g. reloaded after a context loss.
+     * @since v3.11
+     */
+    bool isStreamed() const { return _streamedLevels > 0; }
+
+    /** The finest mip level in video memory, 0 for the full resolution.
+     * @since v3.11
+     */
+    int getResidentLevel() const { return _residentLevel; }
+
+    /** The bytes the texture takes in video memory: its resident levels in its pixel format, the compressed
+     * formats by whole blocks.
+     * @since v3.11
+     */
+    size_t getMemoryBytes() const;
+
+    /** Names what owns a texture outside of the TextureCache in the memory reports, e.g. "FontAtlas".
+     * @since v3.11
+     */
+    void setOwner(const std::string& owner) { _owner = owner; }
+    /** What owns the texture, empty when nothing said. */
+    const std::string& getOwner() const { return _owner; }
+
+    /** Tells a streamed texture how many of its texels are drawn per pixel of the screen this frame, the nodes
+     * that draw it call it, e.g. Sprite. The finest level a frame needs is streamed in, the finer ones are dropped
+     * once no frame needs them for a while. It does nothing for the other textures.
+     * @since v3.11
+     */
+    void requestTexelDensity(float texelsPerPixel);
+
     /** Gets the pixel format of the texture. */
     Texture2D::PixelFormat getPixelFormat() const;
 
@@ -389,6 +444,16 @@ public:
     /** Get pixel info map, the key-value pairs is PixelFormat and PixelFormatInfo.*/
     static const PixelFormatInfoMap& getPixelFormatInfoMap();
 
+    /** Returns the textures alive, for the memory reports, see VideoMemory.
+     * @since v3.11
+     */
+    static std::vector<Texture2D*> getAllTextures();
+
+    /** Whether the GPU can sample a pixel format, the uncompressed formats are always supported.
+     * @since v3.11
+     */
+    static bool isPixelFormatSupported(PixelFormat format);
+
 private:
     /**
     * A struct for storing 9-patch image capInsets.
@@ -480,6 +545,12 @@ private:
     static void convertRGBA8888ToRGBA4444(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
     static void convertRGBA8888ToRGB5A1(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
 
+    /* The GL part of initWithMipmaps(). It touches nothing but GL and the state cache of the calling thread,
+       the upload thread of TextureCache calls it with its own context. Returns 0 when it fails. */
+    static GLuint createGLTexture(const MipmapInfo* mipmaps, int mipmapsNum, PixelFormat pixelFormat, int pixelsWide, int pixelsHigh, bool antialias);
+    /* The rest of initWithMipmaps(), the texture takes over a name returned by createGLTexture(). */
+    void initWithGLTexture(GLuint name, PixelFormat pixelFormat, int pixelsWide, int pixelsHigh, bool hasMipmaps);
+
 protected:
     /** pixel format of the texture */
     Texture2D::PixelFormat _pixelFormat;
@@ -515,6 +586,14 @@ protected:
 
     bool _antialiasEnabled;
     NinePatchInfo* _ninePatchInfo;
+
+    // the levels of the full mipmap chain of a streamed texture, 0 when it isn't streamed
+    int _streamedLevels;
+    int _residentLevel;
+    // the finest level requested by requestTexelDensity() during _requestedFrame
+    int _requestedLevel;
+    unsigned int _requestedFrame;
+    std::string _owner;
     friend class SpriteFrameCache;
     friend class TextureCache;
     friend class ui::Scale9Sprite;
@@ -39,6 +39,7 @@ THE SOFTWARE.
 #include "renderer/CCGLProgram.h"
 #include "renderer/ccGLStateCache.h"
 #include "renderer/CCRenderer.h"
+#include "renderer/CCQuadIndexBuffer.h"
 #include "renderer/CCTexture2D.h"
 #include "platform/CCGL.h"
 #include "base/CCString.h"
@@ -50,27 +51,32 @@ THE SOFTWARE.
 NS_CC_BEGIN
 
 TextureAtlas::TextureAtlas()
-    :_indices(nullptr)
+    :_VAOname(0)
     ,_dirty(false)
+    ,_dirtyBegin(0)
+    ,_dirtyEnd(0)
     ,_texture(nullptr)
     ,_quads(nullptr)
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     ,_rendererRecreatedListener(nullptr)
 #endif
-{}
+{
+    _buffersVBO[0] = 0;
+}
 
 TextureAtlas::~TextureAtlas()
 {
     CCLOGINFO("deallocing TextureAtlas: %p", this);
 
     CC_SAFE_FREE(_quads);
-    CC_SAFE_FREE(_indices);
-
-    glDeleteBuffers(2, _buffersVBO);
 
-    if (Configuration::getInstance()->supportsShareableVAO())
+    if (_buffersVBO[0])
+    {
+        GL::deleteBuffers(1, _buffersVBO);
+    }
+    if (_VAOname)
     {
-        glDeleteVertexArrays(1, &_VAOname);
+        GL::deleteVAO(_VAOname);
         GL::bindVAO(0);
     }
     CC_SAFE_RELEASE(_texture);
@@ -105,7 +111,7 @@ void TextureAtlas::setTexture(Texture2D * var)
 V3F_C4B_T2F_Quad* TextureAtlas::getQuads()
 {
     //if someone accesses the quads directly, presume that changes will be made
-    _dirty = true;
+    setDirty(true);
     return _quads;
 }
 
@@ -169,16 +175,14 @@ bool TextureAtlas::initWithTexture(Texture2D *texture, ssize_t capacity)
     CC_SAFE_RETAIN(_texture);
 
     // Re-initialization is not allowed
-    CCASSERT(_quads == nullptr && _indices == nullptr, "_quads and _indices should be nullptr.");
+    CCASSERT(_quads == nullptr, "_quads should be nullptr.");
+    CCASSERT(_capacity <= QuadIndexBuffer::MAX_QUADS, "TextureAtlas: capacity exceeds the quad index buffer");
 
     _quads = (V3F_C4B_T2F_Quad*)malloc( _capacity * sizeof(V3F_C4B_T2F_Quad) );
-    _indices = (GLushort *)malloc( _capacity * 6 * sizeof(GLushort) );
 
-    if( ! ( _quads && _indices) && _capacity > 0)
+    if( ! _quads && _capacity > 0)
     {
         //CCLOG("cocos2d: TextureAtlas: not enough memory");
-        CC_SAFE_FREE(_quads);
-        CC_SAFE_FREE(_indices);
 
         // release texture, should set it to null, because the destruction will
         // release it too. see cocos2d-x issue #484
@@ -187,7 +191,6 @@ bool TextureAtlas::initWithTexture(Texture2D *texture, ssize_t capacity)
     }
 
     memset( _quads, 0, _capacity * sizeof(V3F_C4B_T2F_Quad) );
-    memset( _indices, 0, _capacity * 6 * sizeof(GLushort) );
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     /** listen the event that renderer was recreated on Android/WP8 */
@@ -195,35 +198,21 @@ bool TextureAtlas::initWithTexture(Texture2D *texture, ssize_t capacity)
     Director::getInstance()->getEventDispatcher()->addEventListenerWithFixedPriority(_rendererRecreatedListener, -1);
 #endif
 
-    this->setupIndices();
-
-    if (Configuration::getInstance()->supportsShareableVAO())
-    {
-        setupVBOandVAO();
-    }
-    else
-    {
-        setupVBO();
-    }
-
-    _dirty = true;
+    // the buffers are created by the first draw, the atlases whose quads are drawn with a QuadCommand,
+    // e.g. the ones of AtlasNode, never create them
+    setDirty(true);
 
     return true;
 }
 
 void TextureAtlas::listenRendererRecreated(EventCustom* event)
 {
-    if (Configuration::getInstance()->supportsShareableVAO())
-    {
-        setupVBOandVAO();
-    }
-    else
-    {
-        setupVBO();
-    }
+    // the buffers were lost with the context, the next draw creates them again
+    _buffersVBO[0] = 0;
+    _VAOname = 0;
 
     // set _dirty to true to force it rebinding buffer
-    _dirty = true;
+    setDirty(true);
 }
 
 std::string TextureAtlas::getDescription() const
@@ -232,80 +221,62 @@ std::string TextureAtlas::getDescription() const
 }
 
 
-void TextureAtlas::setupIndices()
-{
-    if (_capacity == 0)
-        return;
-
-    for( int i=0; i < _capacity; i++)
-    {
-        _indices[i*6+0] = i*4+0;
-        _indices[i*6+1] = i*4+1;
-        _indices[i*6+2] = i*4+2;
-
-        // inverted index. issue #179
-        _indices[i*6+3] = i*4+3;
-        _indices[i*6+4] = i*4+2;
-        _indices[i*6+5] = i*4+1;
-    }
-}
-
 //TextureAtlas - VAO / VBO specific
 
 void TextureAtlas::setupVBOandVAO()
 {
+    // the indices are shared by all the atlases, only make sure there are enough of them
+    GLuint indicesVBO = QuadIndexBuffer::getInstance()->reserve(_capacity);
+
     glGenVertexArrays(1, &_VAOname);
     GL::bindVAO(_VAOname);
 
 #define kQuadSize sizeof(_quads[0].bl)
 
-    glGenBuffers(2, &_buffersVBO[0]);
+    glGenBuffers(1, &_buffersVBO[0]);
 
-    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * _capacity, _quads, GL_DYNAMIC_DRAW);
+    GL::bindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+    // the quads are uploaded by the first draw, the atlas is dirty
+    GL::bufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * _capacity, nullptr, GL_DYNAMIC_DRAW);
 
     // vertices
     glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_POSITION);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, vertices));
+    GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, vertices));
 
     // colors
     glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_COLOR);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, colors));
+    GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, colors));
 
     // tex coords
     glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_TEX_COORD);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, texCoords));
+    GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, texCoords));
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _capacity * 6, _indices, GL_STATIC_DRAW);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indicesVBO);
 
     // Must unbind the VAO before changing the element buffer.
     GL::bindVAO(0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
 
     CHECK_GL_ERROR_DEBUG();
 }
 
 void TextureAtlas::setupVBO()
 {
-    glGenBuffers(2, &_buffersVBO[0]);
+    glGenBuffers(1, &_buffersVBO[0]);
 
     mapBuffers();
 }
 
 void TextureAtlas::mapBuffers()
 {
-    // Avoid changing the element buffer for whatever VAO might be bound.
-    GL::bindVAO(0);
-
-    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * _capacity, _quads, GL_DYNAMIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    // Grows the shared indices if needed, VAOs keep pointing at them.
+    QuadIndexBuffer::getInstance()->reserve(_capacity);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _capacity * 6, _indices, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    // Only allocates, the next draw uploads the quads in use since the atlas is dirty.
+    GL::bindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+    GL::bufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * _capacity, nullptr, GL_DYNAMIC_DRAW);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
 
     CHECK_GL_ERROR_DEBUG();
 }
@@ -320,9 +291,7 @@ void TextureAtlas::updateQuad(V3F_C4B_T2F_Quad *quad, ssize_t index)
 
     _quads[index] = *quad;
 
-
-    _dirty = true;
-
+    setDirtyRange(index, 1);
 }
 
 void TextureAtlas::insertQuad(V3F_C4B_T2F_Quad *quad, ssize_t index)
@@ -344,9 +313,8 @@ void TextureAtlas::insertQuad(V3F_C4B_T2F_Quad *quad, ssize_t index)
 
     _quads[index] = *quad;
 
-
-    _dirty = true;
-
+    // the quads after it moved
+    setDirtyRange(index, MAX(_totalQuads - index, 1));
 }
 
 void TextureAtlas::insertQuads(V3F_C4B_T2F_Quad* quads, ssize_t index, ssize_t amount)
@@ -368,6 +336,8 @@ void TextureAtlas::insertQuads(V3F_C4B_T2F_Quad* quads, ssize_t index, ssize_t a
     }
 
 
+    setDirtyRange(index, MAX(_totalQuads - index, amount));
+
     auto max = index + amount;
     int j = 0;
     for (ssize_t i = index; i < max ; i++)
@@ -376,8 +346,6 @@ void TextureAtlas::insertQuads(V3F_C4B_T2F_Quad* quads, ssize_t index, ssize_t a
         index++;
         j++;
     }
-
-    _dirty = true;
 }
 
 void TextureAtlas::insertQuadFromIndex(ssize_t oldIndex, ssize_t newIndex)
@@ -405,8 +373,7 @@ void TextureAtlas::insertQuadFromIndex(ssize_t oldIndex, ssize_t newIndex)
     memmove( &_quads[dst],&_quads[src], sizeof(_quads[0]) * howMany );
     _quads[newIndex] = quadsBackup;
 
-
-    _dirty = true;
+    setDirtyRange(MIN(oldIndex, newIndex), howMany + 1);
 }
 
 void TextureAtlas::removeQuadAtIndex(ssize_t index)
@@ -424,8 +391,7 @@ void TextureAtlas::removeQuadAtIndex(ssize_t index)
 
     _totalQuads--;
 
-
-    _dirty = true;
+    setDirtyRange(index, _totalQuads - index);
 }
 
 void TextureAtlas::removeQuadsAtIndex(ssize_t index, ssize_t amount)
@@ -441,7 +407,7 @@ void TextureAtlas::removeQuadsAtIndex(ssize_t index, ssize_t amount)
         memmove( &_quads[index], &_quads[index+amount], sizeof(_quads[0]) * remaining );
     }
 
-    _dirty = true;
+    setDirtyRange(index, _totalQuads - index);
 }
 
 void TextureAtlas::removeAllQuads()
@@ -453,6 +419,7 @@ void TextureAtlas::removeAllQuads()
 bool TextureAtlas::resizeCapacity(ssize_t newCapacity)
 {
     CCASSERT(newCapacity>=0, "capacity >= 0");
+    CCASSERT(newCapacity <= QuadIndexBuffer::MAX_QUADS, "TextureAtlas: capacity exceeds the quad index buffer");
     if( newCapacity == _capacity )
     {
         return true;
@@ -463,10 +430,9 @@ bool TextureAtlas::resizeCapacity(ssize_t newCapacity)
     _capacity = newCapacity;
 
     V3F_C4B_T2F_Quad* tmpQuads = nullptr;
-    GLushort* tmpIndices = nullptr;
 
     // when calling initWithTexture(fileName, 0) on bada device, calloc(0, 1) will fail and return nullptr,
-    // so here must judge whether _quads and _indices is nullptr.
+    // so here must judge whether _quads is nullptr.
     if (_quads == nullptr)
     {
         tmpQuads = (V3F_C4B_T2F_Quad*)malloc( _capacity * sizeof(_quads[0]) );
@@ -485,42 +451,22 @@ bool TextureAtlas::resizeCapacity(ssize_t newCapacity)
         _quads = nullptr;
     }
 
-    if (_indices == nullptr)
-    {
-        tmpIndices = (GLushort*)malloc( _capacity * 6 * sizeof(_indices[0]) );
-        if (tmpIndices != nullptr)
-        {
-            memset( tmpIndices, 0, _capacity * 6 * sizeof(_indices[0]) );
-        }
-    }
-    else
-    {
-        tmpIndices = (GLushort*)realloc( _indices, sizeof(_indices[0]) * _capacity * 6 );
-        if (tmpIndices != nullptr && _capacity > oldCapactiy)
-        {
-            memset( tmpIndices+oldCapactiy, 0, (_capacity-oldCapactiy) * 6 * sizeof(_indices[0]) );
-        }
-        _indices = nullptr;
-    }
-
-    if( ! ( tmpQuads && tmpIndices) ) {
+    if( ! tmpQuads ) {
         CCLOG("cocos2d: TextureAtlas: not enough memory");
-        CC_SAFE_FREE(tmpQuads);
-        CC_SAFE_FREE(tmpIndices);
         CC_SAFE_FREE(_quads);
-        CC_SAFE_FREE(_indices);
         _capacity = _totalQuads = 0;
         return false;
     }
 
     _quads = tmpQuads;
-    _indices = tmpIndices;
 
+    // the buffer is reallocated, its quads are uploaded by the next draw
+    if (_buffersVBO[0])
+    {
+        mapBuffers();
+    }
 
-    setupIndices();
-    mapBuffers();
-
-    _dirty = true;
+    setDirty(true);
 
     return true;
 }
@@ -560,7 +506,7 @@ void TextureAtlas::moveQuadsFromIndex(ssize_t oldIndex, ssize_t amount, ssize_t
 
     free(tempQuads);
 
-    _dirty = true;
+    setDirtyRange(MIN(oldIndex, newIndex), (oldIndex > newIndex ? oldIndex - newIndex : newIndex - oldIndex) + amount);
 }
 
 void TextureAtlas::moveQuadsFromIndex(ssize_t index, ssize_t newIndex)
@@ -586,6 +532,25 @@ void TextureAtlas::fillWithEmptyQuadsFromIndex(ssize_t index, ssize_t amount)
 
 // TextureAtlas - Drawing
 
+void TextureAtlas::uploadDirtyQuads()
+{
+    ssize_t begin = _dirtyBegin;
+    ssize_t end = MIN(_dirtyEnd, _totalQuads);
+
+    if (begin == 0 && end == _totalQuads)
+    {
+        // all of them changed: orphans the buffer, the draws still using it don't stall
+        GL::bufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * _capacity, nullptr, GL_DYNAMIC_DRAW);
+    }
+    if (begin < end)
+    {
+        glBufferSubData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * begin, sizeof(_quads[0]) * (end - begin), &_quads[begin]);
+    }
+
+    _dirty = false;
+    _dirtyBegin = _dirtyEnd = 0;
+}
+
 void TextureAtlas::drawQuads()
 {
     this->drawNumberOfQuads(_totalQuads, 0);
@@ -606,6 +571,19 @@ void TextureAtlas::drawNumberOfQuads(ssize_t numberOfQuads, ssize_t start)
 
     GL::bindTexture2D(_texture->getName());
 
+    if (_buffersVBO[0] == 0)
+    {
+        if (Configuration::getInstance()->supportsShareableVAO())
+        {
+            setupVBOandVAO();
+        }
+        else
+        {
+            setupVBO();
+        }
+        setDirty(true);
+    }
+
     if (Configuration::getInstance()->supportsShareableVAO())
     {
         //
@@ -615,36 +593,23 @@ void TextureAtlas::drawNumberOfQuads(ssize_t numberOfQuads, ssize_t start)
         // FIXME:: update is done in draw... perhaps it should be done in a timer
         if (_dirty)
         {
-            glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-            // option 1: subdata
-//            glBufferSubData(GL_ARRAY_BUFFER, sizeof(_quads[0])*start, sizeof(_quads[0]) * n , &_quads[start] );
-
-            // option 2: data
-//            glBufferData(GL_ARRAY_BUFFER, sizeof(quads_[0]) * (n-start), &quads_[start], GL_DYNAMIC_DRAW);
-
-            // option 3: orphaning + glMapBuffer
-            glBufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * _capacity, nullptr, GL_DYNAMIC_DRAW);
-            void *buf = glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
-            memcpy(buf, _quads, sizeof(_quads[0])* _totalQuads);
-            glUnmapBuffer(GL_ARRAY_BUFFER);
-
-            glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-            _dirty = false;
+            GL::bindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+            uploadDirtyQuads();
+            GL::bindBuffer(GL_ARRAY_BUFFER, 0);
         }
 
         GL::bindVAO(_VAOname);
 
 #if CC_REBIND_INDICES_BUFFER
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+        GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, QuadIndexBuffer::getInstance()->getVBO());
 #endif
 
-        glDrawElements(GL_TRIANGLES, (GLsizei) numberOfQuads*6, GL_UNSIGNED_SHORT, (GLvoid*) (start*6*sizeof(_indices[0])) );
+        glDrawElements(GL_TRIANGLES, (GLsizei) numberOfQuads*6, GL_UNSIGNED_SHORT, (GLvoid*) (start*6*sizeof(GLushort)) );
 
         GL::bindVAO(0);
 
 #if CC_REBIND_INDICES_BUFFER
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 #endif
 
 //    glBindVertexArray(0);
@@ -656,32 +621,31 @@ void TextureAtlas::drawNumberOfQuads(ssize_t numberOfQuads, ssize_t start)
         //
 
 #define kQuadSize sizeof(_quads[0].bl)
-        glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+        GL::bindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
 
         // FIXME:: update is done in draw... perhaps it should be done in a timer
         if (_dirty)
         {
-            glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(_quads[0]) * _totalQuads , &_quads[0] );
-            _dirty = false;
+            uploadDirtyQuads();
         }
 
         GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX);
 
         // vertices
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, vertices));
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, vertices));
 
         // colors
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, colors));
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, colors));
 
         // tex coords
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, texCoords));
+        GL::vertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, texCoords));
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+        GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, QuadIndexBuffer::getInstance()->getVBO());
 
-        glDrawElements(GL_TRIANGLES, (GLsizei)numberOfQuads*6, GL_UNSIGNED_SHORT, (GLvoid*) (start*6*sizeof(_indices[0])));
+        glDrawElements(GL_TRIANGLES, (GLsizei)numberOfQuads*6, GL_UNSIGNED_SHORT, (GLvoid*) (start*6*sizeof(GLushort)));
 
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        GL::bindBuffer(GL_ARRAY_BUFFER, 0);
+        GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     }
 
     CC_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(1,numberOfQuads*6);
@@ -210,8 +210,31 @@ public:
 
     /** Whether or not the array buffer of the VBO needs to be updated.*/
     inline bool isDirty() { return _dirty; }
-    /** Specify if the array buffer of the VBO needs to be updated. */
-    inline void setDirty(bool bDirty) { _dirty = bDirty; }
+    /** Specify if the array buffer of the VBO needs to be updated, all the quads are uploaded then. */
+    inline void setDirty(bool bDirty)
+    {
+        if (bDirty)
+        {
+            setDirtyRange(0, _capacity);
+        }
+        else
+        {
+            _dirty = false;
+            _dirtyBegin = _dirtyEnd = 0;
+        }
+    }
+    /**
+     * Specify that the quads from `start` to `start + amount` changed.
+     * The next draw uploads the union of the ranges changed since the last one, instead of all the quads.
+     */
+    inline void setDirtyRange(ssize_t start, ssize_t amount)
+    {
+        if (!_dirty || start < _dirtyBegin)
+            _dirtyBegin = start;
+        if (!_dirty || start + amount > _dirtyEnd)
+            _dirtyEnd = start + amount;
+        _dirty = true;
+    }
 
     /**Get quads total amount.
      * @js NA
@@ -240,16 +263,18 @@ public:
 private:
     void renderCommand();
 
-    void setupIndices();
     void mapBuffers();
     void setupVBOandVAO();
     void setupVBO();
+    void uploadDirtyQuads();
 
 protected:
-    GLushort*           _indices;
     GLuint              _VAOname;
-    GLuint              _buffersVBO[2]; //0: vertex  1: indices
+    GLuint              _buffersVBO[1]; //0: vertex, the indices are in the shared QuadIndexBuffer
     bool                _dirty; //indicates whether or not the array buffer of the VBO needs to be updated
+    /** the quads to upload when _dirty, from _dirtyBegin to _dirtyEnd */
+    ssize_t _dirtyBegin;
+    ssize_t _dirtyEnd;
     /** quantity of quads that are going to be drawn */
     ssize_t _totalQuads;
     /** quantity of quads that can be stored with the current texture atlas size */
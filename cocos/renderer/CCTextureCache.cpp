@@ -31,16 +31,28 @@ THE SOFTWARE.
 #include <stack>
 #include <cctype>
 #include <list>
+#include <algorithm>
+#include <chrono>
 
 #include "renderer/CCTexture2D.h"
+#include "renderer/ccGLStateCache.h"
 #include "base/ccMacros.h"
 #include "base/CCDirector.h"
 #include "base/CCScheduler.h"
+#include "base/CCConfiguration.h"
+#include "platform/CCGLView.h"
 #include "platform/CCFileUtils.h"
 #include "base/ccUtils.h"
 #include "base/CCString.h"
 
 #include "base/CCNinePatchImageParser.h"
+#include "base/CCTracer.h"
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+#include <unordered_set>
+#include "2d/CCScene.h"
+#include "base/CCProtocols.h"
+#endif
 
 
 
@@ -55,11 +67,84 @@ TextureCache* TextureCache::getInstance()
     return Director::getInstance()->getTextureCache();
 }
 
+// the default milliseconds per frame spent creating the textures of addImageAsync()
+static const float DEFAULT_ASYNC_UPLOAD_BUDGET = 4.0f;
+
+// the uncompressed images from which the main thread fills the texture by bands of rows, and the bytes of a band
+static const size_t SLICED_UPLOAD_MIN_BYTES = 1024 * 1024;
+static const size_t SLICED_UPLOAD_BAND_BYTES = 256 * 1024;
+
+// the streamed textures keep their levels of at most this many pixels resident, and a copy of them in memory
+static const int STREAMING_TAIL_SIZE = 128;
+// the frames the levels of a streamed texture stay resident once they're finer than the frames need
+static const unsigned int STREAMING_IDLE_FRAMES = 300;
+
+struct TextureCache::AsyncStruct
+{
+public:
+    AsyncStruct(const std::string& fn, std::function<void(Texture2D*)> f, AsyncPriority p)
+    : filename(fn), callback(f), pixelFormat(Texture2D::getDefaultAlphaPixelFormat())
+    , loadSuccess(false), loaded(false), cancelled(false), priority(p)
+    , uploadedName(0), uploadedFormat(Texture2D::PixelFormat::NONE), slicedTexture(nullptr), slicedRows(0)
+    , generateMipmaps(false), streamable(false), streamTexture(nullptr), streamLevel(0) {}
+
+    ~AsyncStruct()
+    {
+        CC_SAFE_RELEASE(streamTexture);
+    }
+
+    std::string filename;
+    std::function<void(Texture2D*)> callback;
+    // the format of the texture, the image is decoded into it when it can
+    Texture2D::PixelFormat pixelFormat;
+    Image image;
+    bool loadSuccess;
+    // set by the load thread once the image is decoded
+    bool loaded;
+    // cancelled while it was decoded, the image is dropped
+    bool cancelled;
+    AsyncPriority priority;
+    // the texture created by the upload thread, 0 when the main thread creates it
+    GLuint uploadedName;
+    Texture2D::PixelFormat uploadedFormat;
+    // the texture the main thread fills by bands of rows, and the rows filled so far
+    Texture2D* slicedTexture;
+    int slicedRows;
+    // whether the load thread builds the mipmaps, and whether the texture may be streamed
+    bool generateMipmaps;
+    bool streamable;
+    // the streamed texture whose levels from streamLevel on are loaded, null for the requests of addImageAsync()
+    Texture2D* streamTexture;
+    int streamLevel;
+};
+
 TextureCache::TextureCache()
-: _loadingThread(nullptr)
+: _asyncThreadCount(1)
+, _asyncUploadBudget(DEFAULT_ASYNC_UPLOAD_BUDGET)
 , _needQuit(false)
+, _uploadThreadEnabled(false)
+, _uploadThread(nullptr)
+, _uploadQuit(false)
+, _slicedStruct(nullptr)
 , _asyncRefCount(0)
+, _asyncMipmapsEnabled(false)
+, _streamingEnabled(false)
+, _cachedBytes(0)
+, _memoryBudget(0)
+, _cacheHits(0)
+, _cacheMisses(0)
+, _evictions(0)
 {
+    int budget = Configuration::getInstance()->getValue("cocos2d.x.texture.memory_budget", Value(0)).asInt();
+    _memoryBudget = (size_t)std::max(budget, 0) * 1024 * 1024;
+
+    int cores = (int)std::thread::hardware_concurrency();
+    int threads = std::min(std::max(cores - 1, 1), CC_TEXTURE_CACHE_MAX_ASYNC_THREADS);
+    setAsyncThreadCount(Configuration::getInstance()->getValue("cocos2d.x.texture.async_threads", Value(threads)).asInt());
+    _asyncUploadBudget = Configuration::getInstance()->getValue("cocos2d.x.texture.async_upload_budget", Value(DEFAULT_ASYNC_UPLOAD_BUDGET)).asFloat();
+    _uploadThreadEnabled = Configuration::getInstance()->getValue("cocos2d.x.texture.upload_thread", Value(false)).asBool();
+    _asyncMipmapsEnabled = Configuration::getInstance()->getValue("cocos2d.x.texture.async_mipmaps", Value(false)).asBool();
+    _streamingEnabled = Configuration::getInstance()->getValue("cocos2d.x.texture.streaming", Value(false)).asBool();
 }
 
 TextureCache::~TextureCache()
@@ -69,7 +154,17 @@ TextureCache::~TextureCache()
     for( auto it=_textures.begin(); it!=_textures.end(); ++it)
         (it->second)->release();
 
-    CC_SAFE_DELETE(_loadingThread);
+    for (auto thread : _loadingThreads)
+    {
+        delete thread;
+    }
+    delete _uploadThread;
+
+    if (_slicedStruct)
+    {
+        _slicedStruct->slicedTexture->release();
+        delete _slicedStruct;
+    }
 }
 
 void TextureCache::destroyInstance()
@@ -81,26 +176,22 @@ std::string TextureCache::getDescription() const
     return StringUtils::format("<TextureCache | Number of textures = %d>", static_cast<int>(_textures.size()));
 }
 
-struct TextureCache::AsyncStruct
-{
-public:
-    AsyncStruct(const std::string& fn, std::function<void(Texture2D*)> f) : filename(fn), callback(f), loadSuccess(false) {}
-
-    std::string filename;
-    std::function<void(Texture2D*)> callback;
-    Image image;
-    bool loadSuccess;
-};
-
 /**
  The addImageAsync logic follow the steps:
- - find the image has been add or not, if not add an AsyncStruct to _requestQueue  (GL thread)
- - get AsyncStruct from _requestQueue, load res and fill image data to AsyncStruct.image, then add AsyncStruct to _responseQueue (Load thread)
- - on schedule callback, get AsyncStruct from _responseQueue, convert image to texture, then delete AsyncStruct (GL thread)
+ - find the image has been add or not, if not add an AsyncStruct to the _requestQueues of its priority and _asyncStructQueue (GL thread)
+ - get AsyncStruct from the most urgent _requestQueues, load res and fill image data to AsyncStruct.image, then mark it loaded
+   (Load threads, in parallel)
+ - with the upload thread, the load threads pass the decoded AsyncStruct to _uploadQueue instead, the upload thread creates
+   its GL texture with its own context, waits for it with glFinish(), then marks it loaded (Upload thread)
+ - on schedule callback, pop the loaded AsyncStructs of _asyncStructQueue, the most urgent first, convert their image to texture,
+   then delete them (GL thread). The callbacks of a priority keep the order of the requests even if the images are decoded out of order.
+   The texture of a big image is filled by bands of rows over several frames in _slicedStruct, the next ones wait for it.
+ - a request that is still in _requestQueues can be cancelled or moved to another priority (GL thread)
 
  the Critical Area include these members:
- - _requestQueue: locked by _requestMutex
- - _responseQueue: locked by _responseMutex
+ - _requestQueues and _needQuit: locked by _requestMutex
+ - AsyncStruct::loaded: locked by _responseMutex
+ - _uploadQueue and _uploadQuit: locked by _uploadMutex
 
  the object's life time:
  - AsyncStruct: construct and destruct in GL thread
@@ -116,17 +207,21 @@ public:
  - In addImageAsyncCallback, will deduplicate the request to ensure only create one texture.
 
  Does process all response in addImageAsyncCallback consume more time?
- - Convert image to texture faster than load image from disk, so this isn't a problem.
+ - Uploading many big textures in one frame does, the callback stops once the upload budget of the frame is spent.
+ - Uploading one big texture does too, unless the upload thread creates it: it's filled by bands within the budget.
  */
 void TextureCache::addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback)
+{
+    addImageAsync(path, callback, AsyncPriority::VISIBLE);
+}
+
+void TextureCache::addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, AsyncPriority priority)
 {
     Texture2D *texture = nullptr;
 
-    std::string fullpath = FileUtils::getInstance()->fullPathForFilename(path);
+    std::string fullpath = FileUtils::getInstance()->fullPathForTextureFilename(path);
 
-    auto it = _textures.find(fullpath);
-    if( it != _textures.end() )
-        texture = it->second;
+    texture = findTexture(fullpath);
 
     if (texture != nullptr)
     {
@@ -140,12 +235,32 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
         return;
     }
 
+    // generate async struct
+    AsyncStruct *data = new (std::nothrow) AsyncStruct(fullpath, callback, priority);
+    data->generateMipmaps = _asyncMipmapsEnabled;
+    data->streamable = _streamingEnabled;
+    enqueueAsyncStruct(data);
+}
+
+void TextureCache::enqueueAsyncStruct(AsyncStruct* data)
+{
     // lazy init
-    if (_loadingThread == nullptr)
+    if (_loadingThreads.empty())
     {
-        // create a new thread to load images
-        _loadingThread = new (std::nothrow) std::thread(&TextureCache::loadImage, this);
+        // create the threads that load images
         _needQuit = false;
+        for (int i = 0; i < _asyncThreadCount; ++i)
+        {
+            _loadingThreads.push_back(new (std::nothrow) std::thread(&TextureCache::loadImage, this));
+        }
+
+        // the context is created on the main thread, some platforms require it
+        auto glview = Director::DirectorInstance->getOpenGLView();
+        if (_uploadThreadEnabled && !_uploadThread && glview && glview->createUploadContext())
+        {
+            _uploadQuit = false;
+            _uploadThread = new (std::nothrow) std::thread(&TextureCache::uploadImages, this);
+        }
     }
 
     if (0 == _asyncRefCount)
@@ -155,13 +270,10 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
 
     ++_asyncRefCount;
 
-    // generate async struct
-    AsyncStruct *data = new (std::nothrow) AsyncStruct(fullpath, callback);
-
     // add async struct into queue
     _asyncStructQueue.push_back(data);
     _requestMutex.lock();
-    _requestQueue.push_back(data);
+    _requestQueues[(int)data->priority].push_back(data);
     _requestMutex.unlock();
 
     _sleepCondition.notify_one();
@@ -169,11 +281,15 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
 
 void TextureCache::unbindImageAsync(const std::string& filename)
 {
-    if (_asyncStructQueue.empty())
+    if (_asyncStructQueue.empty() && !_slicedStruct)
     {
         return;
     }
-    std::string fullpath = FileUtils::getInstance()->fullPathForFilename(filename);
+    std::string fullpath = FileUtils::getInstance()->fullPathForTextureFilename(filename);
+    if (_slicedStruct && _slicedStruct->filename == fullpath)
+    {
+        _slicedStruct->callback = nullptr;
+    }
     for (auto it = _asyncStructQueue.begin(); it != _asyncStructQueue.end(); ++it)
     {
         if ((*it)->filename == fullpath)
@@ -185,6 +301,10 @@ void TextureCache::unbindImageAsync(const std::string& filename)
 
 void TextureCache::unbindAllImageAsync()
 {
+    if (_slicedStruct)
+    {
+        _slicedStruct->callback = nullptr;
+    }
     if (_asyncStructQueue.empty())
     {
         return;
@@ -196,108 +316,326 @@ void TextureCache::unbindAllImageAsync()
     }
 }
 
-void TextureCache::loadImage()
+void TextureCache::setImageAsyncPriority(const std::string& filename, AsyncPriority priority)
 {
-    AsyncStruct *asyncStruct = nullptr;
-    std::mutex signalMutex;
-    std::unique_lock<std::mutex> signal(signalMutex);
-    while (!_needQuit)
+    std::string fullpath = FileUtils::getInstance()->fullPathForTextureFilename(filename);
+
+    std::lock_guard<std::mutex> lock(_requestMutex);
+    for (auto asyncStruct : _asyncStructQueue)
     {
-        // pop an AsyncStruct from request queue
-        _requestMutex.lock();
-        if(_requestQueue.empty())
+        if (asyncStruct->filename != fullpath || asyncStruct->priority == priority)
+            continue;
+
+        // move it to the queue of its new priority unless a thread is decoding it
+        auto& queue = _requestQueues[(int)asyncStruct->priority];
+        auto it = std::find(queue.begin(), queue.end(), asyncStruct);
+        if (it != queue.end())
         {
-            asyncStruct = nullptr;
-        }else
+            queue.erase(it);
+            _requestQueues[(int)priority].push_back(asyncStruct);
+        }
+        asyncStruct->priority = priority;
+    }
+}
+
+void TextureCache::cancelImageAsync(const std::string& filename)
+{
+    std::string fullpath = FileUtils::getInstance()->fullPathForTextureFilename(filename);
+    std::vector<AsyncStruct*> cancelled;
+    if (_slicedStruct && _slicedStruct->filename == fullpath)
+    {
+        // its texture is dropped once it's complete
+        _slicedStruct->callback = nullptr;
+        _slicedStruct->cancelled = true;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_requestMutex);
+        for (auto it = _asyncStructQueue.begin(); it != _asyncStructQueue.end(); /* nothing */)
         {
-            asyncStruct = _requestQueue.front();
-            _requestQueue.pop_front();
+            auto asyncStruct = *it;
+            // the streamed levels aren't requested by the caller
+            if (asyncStruct->filename != fullpath || asyncStruct->streamTexture)
+            {
+                ++it;
+                continue;
+            }
+
+            asyncStruct->callback = nullptr;
+            auto& queue = _requestQueues[(int)asyncStruct->priority];
+            auto request = std::find(queue.begin(), queue.end(), asyncStruct);
+            if (request != queue.end())
+            {
+                // no thread has it, it's never decoded
+                queue.erase(request);
+                cancelled.push_back(asyncStruct);
+                it = _asyncStructQueue.erase(it);
+            }
+            else
+            {
+                // a thread is decoding it, the image is dropped once it's done
+                asyncStruct->cancelled = true;
+                ++it;
+            }
         }
-        _requestMutex.unlock();
+    }
 
-        if (nullptr == asyncStruct) {
-            _sleepCondition.wait(signal);
-            continue;
+    for (auto asyncStruct : cancelled)
+    {
+        delete asyncStruct;
+        --_asyncRefCount;
+    }
+    if (!cancelled.empty() && 0 == _asyncRefCount)
+    {
+        Director::DirectorInstance->getScheduler()->unschedule(CC_SCHEDULE_SELECTOR(TextureCache::addImageAsyncCallBack), this);
+    }
+}
+
+void TextureCache::cancelAllImageAsync()
+{
+    std::vector<std::string> filenames;
+    for (auto asyncStruct : _asyncStructQueue)
+    {
+        filenames.push_back(asyncStruct->filename);
+    }
+    if (_slicedStruct)
+    {
+        filenames.push_back(_slicedStruct->filename);
+    }
+    std::sort(filenames.begin(), filenames.end());
+    filenames.erase(std::unique(filenames.begin(), filenames.end()), filenames.end());
+
+    for (const auto& filename : filenames)
+    {
+        cancelImageAsync(filename);
+    }
+}
+
+void TextureCache::setAsyncThreadCount(int count)
+{
+    if (!_loadingThreads.empty())
+    {
+        CCLOG("cocos2d: TextureCache: the async threads are already running, the count can't change");
+        return;
+    }
+    _asyncThreadCount = std::min(std::max(count, 1), CC_TEXTURE_CACHE_MAX_ASYNC_THREADS);
+}
+
+void TextureCache::loadImage()
+{
+    Tracer::setThreadName("texture loader");
+
+    while (true)
+    {
+        // pop an AsyncStruct from request queue
+        AsyncStruct *asyncStruct = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(_requestMutex);
+            _sleepCondition.wait(lock, [this]{
+                return _needQuit || std::any_of(std::begin(_requestQueues), std::end(_requestQueues),
+                                                [](const std::deque<AsyncStruct*>& queue){ return !queue.empty(); });
+            });
+            if (_needQuit)
+                break;
+
+            // the most urgent request first
+            for (auto& queue : _requestQueues)
+            {
+                if (!queue.empty())
+                {
+                    asyncStruct = queue.front();
+                    queue.pop_front();
+                    break;
+                }
+            }
         }
 
         // load image
+        CC_TRACE_ZONE("texture", "TextureCache::loadImage");
+        asyncStruct->image.setDecodePixelFormat(asyncStruct->pixelFormat);
         asyncStruct->loadSuccess = asyncStruct->image.initWithImageFileThreadSafe(asyncStruct->filename);
 
-        // push the asyncStruct to response queue
-        _responseMutex.lock();
-        _responseQueue.push_back(asyncStruct);
-        _responseMutex.unlock();
+        auto format = asyncStruct->pixelFormat;
+        if (asyncStruct->loadSuccess && asyncStruct->generateMipmaps
+            && (format == Texture2D::PixelFormat::NONE || format == Texture2D::PixelFormat::AUTO || format == asyncStruct->image.getRenderFormat()))
+        {
+            CC_TRACE_ZONE("texture", "Image::generateMipmaps");
+            asyncStruct->image.generateMipmaps();
+        }
+
+        // the main thread creates the streamed textures, they start with some of the levels
+        bool streamed = asyncStruct->streamTexture || (asyncStruct->streamable && asyncStruct->image.getNumberOfMipmaps() > 1);
+        if (asyncStruct->loadSuccess && _uploadThread && !streamed)
+        {
+            std::lock_guard<std::mutex> lock(_uploadMutex);
+            _uploadQueue.push_back(asyncStruct);
+            _uploadCondition.notify_one();
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(_responseMutex);
+        asyncStruct->loaded = true;
     }
 }
 
-void TextureCache::addImageAsyncCallBack(float dt)
+void TextureCache::uploadImages()
 {
-    Texture2D *texture = nullptr;
-    AsyncStruct *asyncStruct = nullptr;
+    Tracer::setThreadName("texture upload");
+
+    auto glview = Director::DirectorInstance->getOpenGLView();
+    glview->makeUploadContextCurrent(true);
+
     while (true)
     {
-        // pop an AsyncStruct from response queue
-        _responseMutex.lock();
-        if(_responseQueue.empty())
+        AsyncStruct *asyncStruct = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(_uploadMutex);
+            _uploadCondition.wait(lock, [this]{ return _uploadQuit || !_uploadQueue.empty(); });
+            if (_uploadQuit)
+                break;
+
+            asyncStruct = _uploadQueue.front();
+            _uploadQueue.pop_front();
+        }
+
+        {
+            CC_TRACE_ZONE("texture", "TextureCache::uploadImages");
+            asyncStruct->uploadedName = uploadImage(&asyncStruct->image, asyncStruct->pixelFormat, &asyncStruct->uploadedFormat);
+            // the texture must be complete before the context of the main thread uses it, GLES 2.0 has no fence sync
+            glFinish();
+        }
+
+        std::lock_guard<std::mutex> lock(_responseMutex);
+        asyncStruct->loaded = true;
+    }
+
+    glview->makeUploadContextCurrent(false);
+}
+
+GLuint TextureCache::uploadImage(Image* image, Texture2D::PixelFormat format, Texture2D::PixelFormat* outFormat)
+{
+    // the same choices as Texture2D::initWithImage(), the main thread creates the texture again with it if this fails
+    int width = image->getWidth();
+    int height = image->getHeight();
+    int maxTextureSize = Configuration::getInstance()->getMaxTextureSize();
+    if (width > maxTextureSize || height > maxTextureSize)
+    {
+        return 0;
+    }
+
+    Texture2D::PixelFormat renderFormat = image->getRenderFormat();
+    if (image->getNumberOfMipmaps() > 1 || image->isCompressed())
+    {
+        if (!Texture2D::isPixelFormatSupported(renderFormat))
+        {
+            return 0;
+        }
+        *outFormat = renderFormat;
+        if (image->getNumberOfMipmaps() > 1)
         {
-            asyncStruct = nullptr;
-        }else
+            return Texture2D::createGLTexture(image->getMipmaps(), image->getNumberOfMipmaps(), renderFormat, width, height, true);
+        }
+        MipmapInfo mipmap;
+        mipmap.address = image->getData();
+        mipmap.len = static_cast<int>(image->getDataLen());
+        return Texture2D::createGLTexture(&mipmap, 1, renderFormat, width, height, true);
+    }
+
+    if (format == Texture2D::PixelFormat::NONE || format == Texture2D::PixelFormat::AUTO)
+    {
+        format = renderFormat;
+    }
+    unsigned char* data = nullptr;
+    ssize_t dataLen = 0;
+    *outFormat = Texture2D::convertDataToFormat(image->getData(), image->getDataLen(), renderFormat, format, &data, &dataLen);
+
+    MipmapInfo mipmap;
+    mipmap.address = data;
+    mipmap.len = static_cast<int>(dataLen);
+    GLuint name = Texture2D::createGLTexture(&mipmap, 1, *outFormat, width, height, true);
+
+    if (data != nullptr && data != image->getData())
+    {
+        free(data);
+    }
+    return name;
+}
+
+void TextureCache::addImageAsyncCallBack(float dt)
+{
+    auto start = std::chrono::steady_clock::now();
+    bool uploaded = false;
+
+    if (_slicedStruct)
+    {
+        // the callbacks after it wait until its texture is complete
+        if (!fillSlicedTexture(start))
         {
-            asyncStruct = _responseQueue.front();
-            _responseQueue.pop_front();
+            return;
+        }
+        auto asyncStruct = _slicedStruct;
+        _slicedStruct = nullptr;
+        finishAsyncStruct(asyncStruct, asyncStruct->slicedTexture, true);
+        uploaded = true;
+    }
 
-            // the asyncStruct's sequence order in _asyncStructQueue must equal to the order in _responseQueue
-            CC_ASSERT(asyncStruct == _asyncStructQueue.front());
-            _asyncStructQueue.pop_front();
+    while (true)
+    {
+        // the budget of the frame is spent, at least one texture is created per frame
+        if (uploaded && isUploadBudgetSpent(start))
+        {
+            break;
         }
-        _responseMutex.unlock();
 
+        AsyncStruct *asyncStruct = popLoadedAsyncStruct();
         if (nullptr == asyncStruct) {
             break;
         }
 
-        // check the image has been convert to texture or not
-        auto it = _textures.find(asyncStruct->filename);
-        if(it != _textures.end())
+        if (asyncStruct->streamTexture)
         {
-            texture = it->second;
+            finishStreamedLevel(asyncStruct);
+            uploaded = true;
+            continue;
         }
-        else
+
+        if (asyncStruct->cancelled)
         {
-            // convert image to texture
-            if (asyncStruct->loadSuccess)
+            if (asyncStruct->uploadedName != 0)
             {
-                Image* image = &(asyncStruct->image);
-                // generate texture in render thread
-                texture = new (std::nothrow) Texture2D();
-
-                texture->initWithImage(image);
-                //parse 9-patch info
-                this->parseNinePatchImage(image, texture, asyncStruct->filename);
-#if CC_ENABLE_CACHE_TEXTURE_DATA
-                // cache the texture file name
-                VolatileTextureMgr::addImageTexture(texture, asyncStruct->filename);
-#endif
-                // cache the texture. retain it, since it is added in the map
-                _textures.insert( std::make_pair(asyncStruct->filename, texture) );
-                texture->retain();
-
-                texture->autorelease();
-            } else {
-                texture = nullptr;
-                CCLOG("cocos2d: failed to call TextureCache::addImageAsync(%s)", asyncStruct->filename.c_str());
+                GL::deleteTexture(asyncStruct->uploadedName);
             }
+            delete asyncStruct;
+            --_asyncRefCount;
+            continue;
         }
+        uploaded = true;
 
-        // call callback function
-        if (asyncStruct->callback)
+        // check the image has been convert to texture or not
+        Texture2D *texture = findTexture(asyncStruct->filename);
+        bool created = false;
+        if (texture != nullptr)
+        {
+            if (asyncStruct->uploadedName != 0)
+            {
+                GL::deleteTexture(asyncStruct->uploadedName);
+            }
+        }
+        else if (asyncStruct->loadSuccess)
+        {
+            texture = createAsyncTexture(asyncStruct, start);
+            if (_slicedStruct)
+            {
+                // filled in the next frames
+                return;
+            }
+            created = true;
+        }
+        else
         {
-            (asyncStruct->callback)(texture);
+            CCLOG("cocos2d: failed to call TextureCache::addImageAsync(%s)", asyncStruct->filename.c_str());
         }
 
-        // release the asyncStruct
-        delete asyncStruct;
-        --_asyncRefCount;
+        finishAsyncStruct(asyncStruct, texture, created);
     }
 
     if (0 == _asyncRefCount)
@@ -306,13 +644,140 @@ void TextureCache::addImageAsyncCallBack(float dt)
     }
 }
 
+bool TextureCache::isUploadBudgetSpent(const std::chrono::steady_clock::time_point& start) const
+{
+    return _asyncUploadBudget > 0 &&
+        std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() >= _asyncUploadBudget;
+}
+
+Texture2D* TextureCache::createAsyncTexture(AsyncStruct* asyncStruct, const std::chrono::steady_clock::time_point& start)
+{
+    Image* image = &(asyncStruct->image);
+    // generate texture in render thread
+    Texture2D* texture = new (std::nothrow) Texture2D();
+
+    if (asyncStruct->uploadedName != 0)
+    {
+        // the upload thread created it
+        texture->initWithGLTexture(asyncStruct->uploadedName, asyncStruct->uploadedFormat, image->getWidth(), image->getHeight(),
+                                   image->getNumberOfMipmaps() > 1);
+        texture->_hasPremultipliedAlpha = image->hasPremultipliedAlpha();
+        asyncStruct->uploadedName = 0;
+        return texture;
+    }
+
+    if (asyncStruct->streamable && initStreamedTexture(texture, image, asyncStruct->filename))
+    {
+        return texture;
+    }
+
+    auto format = asyncStruct->pixelFormat;
+    bool sameFormat = format == Texture2D::PixelFormat::NONE || format == Texture2D::PixelFormat::AUTO || format == image->getRenderFormat();
+    if (sameFormat && image->getNumberOfMipmaps() <= 1 && !image->isCompressed() && (size_t)image->getDataLen() >= SLICED_UPLOAD_MIN_BYTES
+        && texture->initWithData(nullptr, image->getDataLen(), image->getRenderFormat(), image->getWidth(), image->getHeight(),
+                                 Size((float)image->getWidth(), (float)image->getHeight())))
+    {
+        // the storage is allocated, the rows are filled in bands so that a big image doesn't stall the frame
+        texture->_hasPremultipliedAlpha = image->hasPremultipliedAlpha();
+        asyncStruct->slicedTexture = texture;
+        _slicedStruct = asyncStruct;
+        if (!fillSlicedTexture(start))
+        {
+            return nullptr;
+        }
+        _slicedStruct = nullptr;
+        return texture;
+    }
+
+    texture->initWithImage(image, format);
+    return texture;
+}
+
+bool TextureCache::fillSlicedTexture(const std::chrono::steady_clock::time_point& start)
+{
+    auto asyncStruct = _slicedStruct;
+    Image* image = &(asyncStruct->image);
+    int width = image->getWidth();
+    int height = image->getHeight();
+    size_t bytesPerRow = (size_t)image->getDataLen() / height;
+    int bandRows = std::max((int)(SLICED_UPLOAD_BAND_BYTES / bytesPerRow), 1);
+
+    // the rows are tightly packed
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    do
+    {
+        int rows = std::min(bandRows, height - asyncStruct->slicedRows);
+        asyncStruct->slicedTexture->updateWithData(image->getData() + asyncStruct->slicedRows * bytesPerRow, 0, asyncStruct->slicedRows, width, rows);
+        asyncStruct->slicedRows += rows;
+    }
+    while (asyncStruct->slicedRows < height && !isUploadBudgetSpent(start));
+
+    return asyncStruct->slicedRows == height;
+}
+
+void TextureCache::finishAsyncStruct(AsyncStruct* asyncStruct, Texture2D* texture, bool created)
+{
+    if (created && asyncStruct->cancelled)
+    {
+        // cancelled while its texture was filled
+        _streamedTextures.erase(texture);
+        texture->release();
+        texture = nullptr;
+    }
+    else if (created)
+    {
+        //parse 9-patch info
+        this->parseNinePatchImage(&asyncStruct->image, texture, asyncStruct->filename);
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+        // cache the texture file name
+        VolatileTextureMgr::addImageTexture(texture, asyncStruct->filename);
+#endif
+        // cache the texture. retain it, since it is added in the map
+        texture->retain();
+        cacheTexture(asyncStruct->filename, texture);
+
+        texture->autorelease();
+    }
+
+    // call callback function
+    if (asyncStruct->callback)
+    {
+        (asyncStruct->callback)(texture);
+    }
+
+    // release the asyncStruct
+    delete asyncStruct;
+    --_asyncRefCount;
+}
+
+TextureCache::AsyncStruct* TextureCache::popLoadedAsyncStruct()
+{
+    std::lock_guard<std::mutex> lock(_responseMutex);
+    for (int priority = 0; priority < ASYNC_PRIORITY_COUNT; ++priority)
+    {
+        for (auto it = _asyncStructQueue.begin(); it != _asyncStructQueue.end(); ++it)
+        {
+            auto asyncStruct = *it;
+            if ((int)asyncStruct->priority != priority)
+                continue;
+            // the callbacks of a priority keep the order of the requests
+            if (!asyncStruct->loaded)
+                break;
+
+            _asyncStructQueue.erase(it);
+            return asyncStruct;
+        }
+    }
+    return nullptr;
+}
+
 Texture2D * TextureCache::addImage(const std::string &path)
 {
     // Split up directory and filename
     // MUTEX:
     // Needed since addImageAsync calls this method from a different thread
 
-    std::string fullpath = FileUtils::getInstance()->fullPathForFilename(path);
+    std::string fullpath = FileUtils::getInstance()->fullPathForTextureFilename(path);
     if (fullpath.empty())
     {
         return nullptr;
@@ -320,9 +785,7 @@ Texture2D * TextureCache::addImage(const std::string &path)
 
     Texture2D * texture = nullptr;
     Image* image = nullptr;
-    auto it = _textures.find(fullpath);
-    if( it != _textures.end() )
-        texture = it->second;
+    texture = findTexture(fullpath);
 
     if (! texture)
     {
@@ -332,19 +795,20 @@ Texture2D * TextureCache::addImage(const std::string &path)
             image = new (std::nothrow) Image();
             CC_BREAK_IF(nullptr == image);
 
+            image->setDecodePixelFormat(Texture2D::getDefaultAlphaPixelFormat());
             bool bRet = image->initWithImageFile(fullpath);
             CC_BREAK_IF(!bRet);
 
             texture = new (std::nothrow) Texture2D();
 
-            if( texture && texture->initWithImage(image) )
+            if( texture && ((_streamingEnabled && initStreamedTexture(texture, image, fullpath)) || texture->initWithImage(image)) )
             {
 #if CC_ENABLE_CACHE_TEXTURE_DATA
                 // cache the texture file name
                 VolatileTextureMgr::addImageTexture(texture, fullpath);
 #endif
                 // texture already retained, no need to re-retain it
-                _textures.insert( std::make_pair(fullpath, texture) );
+                cacheTexture(fullpath, texture);
 
                 //parse 9-patch info
                 this->parseNinePatchImage(image, texture, path);
@@ -382,9 +846,8 @@ Texture2D* TextureCache::addImage(Image *image, const std::string &key)
 
     do
     {
-        auto it = _textures.find(key);
-        if( it != _textures.end() ) {
-            texture = it->second;
+        texture = findTexture(key);
+        if (texture) {
             break;
         }
 
@@ -392,8 +855,8 @@ Texture2D* TextureCache::addImage(Image *image, const std::string &key)
         texture = new (std::nothrow) Texture2D();
         if(texture && texture->initWithImage(image))
         {
-            _textures.insert( std::make_pair(key, texture) );
             texture->retain();
+            cacheTexture(key, texture);
 
             texture->autorelease();
         }
@@ -421,7 +884,7 @@ bool TextureCache::reloadTexture(const std::string& fileName)
     Texture2D * texture = nullptr;
     Image * image = nullptr;
 
-    std::string fullpath = FileUtils::getInstance()->fullPathForFilename(fileName);
+    std::string fullpath = FileUtils::getInstance()->fullPathForTextureFilename(fileName);
     if (fullpath.empty())
     {
         return false;
@@ -443,10 +906,12 @@ bool TextureCache::reloadTexture(const std::string& fileName)
             image = new (std::nothrow) Image();
             CC_BREAK_IF(nullptr == image);
 
+            image->setDecodePixelFormat(Texture2D::getDefaultAlphaPixelFormat());
             bool bRet = image->initWithImageFile(fullpath);
             CC_BREAK_IF(!bRet);
 
             ret = texture->initWithImage(image);
+            updateCachedBytes(texture);
         } while (0);
     }
 
@@ -463,6 +928,9 @@ void TextureCache::removeAllTextures()
         (it->second)->release();
     }
     _textures.clear();
+    _cacheEntries.clear();
+    _streamedTextures.clear();
+    _cachedBytes = 0;
 }
 
 void TextureCache::removeUnusedTextures()
@@ -472,6 +940,7 @@ void TextureCache::removeUnusedTextures()
         if( tex->getReferenceCount() == 1 ) {
             CCLOG("cocos2d: TextureCache: removing unused texture: %s", it->first.c_str());
 
+            uncacheTexture(tex);
             tex->release();
             it = _textures.erase(it);
         } else {
@@ -490,6 +959,7 @@ void TextureCache::removeTexture(Texture2D* texture)
 
     for( auto it=_textures.cbegin(); it!=_textures.cend(); /* nothing */ ) {
         if( it->second == texture ) {
+            uncacheTexture(texture);
             texture->release();
             it = _textures.erase(it);
             break;
@@ -504,11 +974,12 @@ void TextureCache::removeTextureForKey(const std::string &textureKeyName)
     auto it = _textures.find(key);
 
     if( it == _textures.end() ) {
-        key = FileUtils::getInstance()->fullPathForFilename(textureKeyName);
+        key = FileUtils::getInstance()->fullPathForTextureFilename(textureKeyName);
         it = _textures.find(key);
     }
 
     if( it != _textures.end() ) {
+        uncacheTexture(it->second);
         (it->second)->release();
         _textures.erase(it);
     }
@@ -520,7 +991,7 @@ Texture2D* TextureCache::getTextureForKey(const std::string &textureKeyName) con
     auto it = _textures.find(key);
 
     if( it == _textures.end() ) {
-        key = FileUtils::getInstance()->fullPathForFilename(textureKeyName);
+        key = FileUtils::getInstance()->fullPathForTextureFilename(textureKeyName);
         if (key.empty()) {
             return nullptr;
         }
@@ -554,10 +1025,28 @@ std::string TextureCache::getTextureFilePath( cocos2d::Texture2D *texture )const
 
 void TextureCache::waitForQuit()
 {
-    // notify sub thread to quick
-    _needQuit = true;
-    _sleepCondition.notify_one();
-    if (_loadingThread) _loadingThread->join();
+    // notify sub threads to quit
+    {
+        std::lock_guard<std::mutex> lock(_requestMutex);
+        _needQuit = true;
+    }
+    _sleepCondition.notify_all();
+    for (auto thread : _loadingThreads)
+    {
+        if (thread && thread->joinable())
+            thread->join();
+    }
+
+    if (_uploadThread)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_uploadMutex);
+            _uploadQuit = true;
+        }
+        _uploadCondition.notify_all();
+        if (_uploadThread->joinable())
+            _uploadThread->join();
+    }
 }
 
 std::string TextureCache::getCachedTextureInfo() const
@@ -566,7 +1055,7 @@ std::string TextureCache::getCachedTextureInfo() const
     char buftmp[4096];
 
     unsigned int count = 0;
-    unsigned int totalBytes = 0;
+    size_t totalBytes = 0;
 
     for( auto it = _textures.begin(); it != _textures.end(); ++it ) {
 
@@ -575,8 +1064,7 @@ std::string TextureCache::getCachedTextureInfo() const
 
         Texture2D* tex = it->second;
         unsigned int bpp = tex->getBitsPerPixelForFormat();
-        // Each texture takes up width * height * bytesPerPixel bytes.
-        auto bytes = tex->getPixelsWide() * tex->getPixelsHigh() * bpp / 8;
+        auto bytes = tex->getMemoryBytes();
         totalBytes += bytes;
         count++;
         snprintf(buftmp,sizeof(buftmp)-1,"\"%s\" rc=%lu id=%lu %lu x %lu @ %ld bpp => %lu KB\n",
@@ -593,21 +1081,388 @@ std::string TextureCache::getCachedTextureInfo() const
 
     snprintf(buftmp, sizeof(buftmp)-1, "TextureCache dumpDebugInfo: %ld textures, for %lu KB (%.2f MB)\n", (long)count, (long)totalBytes / 1024, totalBytes / (1024.0f*1024.0f));
     buffer += buftmp;
+    snprintf(buftmp, sizeof(buftmp)-1, "TextureCache budget: %lu KB, hits: %u, misses: %u, evictions: %u\n", (unsigned long)(_memoryBudget / 1024), _cacheHits, _cacheMisses, _evictions);
+    buffer += buftmp;
 
     return buffer;
 }
 
-#if CC_ENABLE_CACHE_TEXTURE_DATA
-
-std::list<VolatileTexture*> VolatileTextureMgr::_textures;
+bool TextureCache::initStreamedTexture(Texture2D* texture, Image* image, const std::string& path)
+{
+    const int levels = image->getNumberOfMipmaps();
+    const int width = image->getWidth();
+    const int height = image->getHeight();
+    auto format = image->getRenderFormat();
+    if (levels <= 1 || ccNextPOT(width) != width || ccNextPOT(height) != height || !Texture2D::isPixelFormatSupported(format)
+        || width > Configuration::getInstance()->getMaxTextureSize() || height > Configuration::getInstance()->getMaxTextureSize())
+    {
+        return false;
+    }
+
+    // the coarse levels, a small texture isn't worth streaming
+    int tailLevel = 0;
+    while (tailLevel < levels - 1 && std::max(width >> tailLevel, height >> tailLevel) > STREAMING_TAIL_SIZE)
+    {
+        ++tailLevel;
+    }
+    if (tailLevel == 0)
+    {
+        return false;
+    }
+
+    texture->_pixelsWide = width;
+    texture->_pixelsHigh = height;
+    texture->_pixelFormat = format;
+    texture->_streamedLevels = levels;
+    if (!uploadStreamedLevels(texture, image->getMipmaps(), tailLevel))
+    {
+        return false;
+    }
+    texture->_hasPremultipliedAlpha = image->hasPremultipliedAlpha();
+
+    StreamedTexture& stream = _streamedTextures[texture];
+    stream.path = path;
+    stream.tailLevel = tailLevel;
+    stream.tail.clear();
+    stream.tailLengths.clear();
+    for (int level = tailLevel; level < levels; ++level)
+    {
+        const MipmapInfo& mipmap = image->getMipmaps()[level];
+        stream.tail.insert(stream.tail.end(), mipmap.address, mipmap.address + mipmap.len);
+        stream.tailLengths.push_back(mipmap.len);
+    }
+    stream.loadingLevel = -1;
+    stream.neededFrame = Director::getInstance()->getTotalFrames();
+    // not requested until a node draws it
+    texture->_requestedFrame = stream.neededFrame - 2;
+
+    if (_streamedTextures.size() == 1)
+    {
+        Director::DirectorInstance->getScheduler()->schedule(CC_SCHEDULE_SELECTOR(TextureCache::updateStreaming), this, 0, false);
+    }
+    return true;
+}
+
+bool TextureCache::uploadStreamedLevels(Texture2D* texture, const MipmapInfo* mipmaps, int first)
+{
+    const int levels = texture->_streamedLevels;
+    const int width = texture->_pixelsWide;
+    const int height = texture->_pixelsHigh;
+    const auto format = texture->_pixelFormat;
+    GLuint name = Texture2D::createGLTexture(mipmaps + first, levels - first, format,
+                                             std::max(width >> first, 1), std::max(height >> first, 1), texture->_antialiasEnabled);
+    if (name == 0)
+    {
+        return false;
+    }
+
+    // the parameters set on the previous levels, e.g. a repeated wrap
+    if (texture->_name != 0)
+    {
+        static const GLenum parameters[] = { GL_TEXTURE_MIN_FILTER, GL_TEXTURE_MAG_FILTER, GL_TEXTURE_WRAP_S, GL_TEXTURE_WRAP_T };
+        GLint values[4];
+        GL::bindTexture2D(texture->_name);
+        for (int i = 0; i < 4; ++i)
+        {
+            glGetTexParameteriv(GL_TEXTURE_2D, parameters[i], &values[i]);
+        }
+        GL::bindTexture2D(name);
+        for (int i = 0; i < 4; ++i)
+        {
+            glTexParameteri(GL_TEXTURE_2D, parameters[i], values[i]);
+        }
+    }
+
+    // the size stays the one of the full resolution, the texture coordinates don't change
+    bool premultiplied = texture->_hasPremultipliedAlpha;
+    texture->initWithGLTexture(name, format, width, height, true);
+    texture->_hasPremultipliedAlpha = premultiplied;
+    texture->_streamedLevels = levels;
+    texture->_residentLevel = first;
+    return true;
+}
+
+void TextureCache::requestStreamedLevel(Texture2D* texture, StreamedTexture& stream, int level)
+{
+    AsyncStruct* asyncStruct = new (std::nothrow) AsyncStruct(stream.path, nullptr, AsyncPriority::PREFETCH);
+    asyncStruct->pixelFormat = texture->getPixelFormat();
+    asyncStruct->generateMipmaps = true;
+    asyncStruct->streamTexture = texture;
+    asyncStruct->streamLevel = level;
+    texture->retain();
+    stream.loadingLevel = level;
+    enqueueAsyncStruct(asyncStruct);
+}
+
+void TextureCache::finishStreamedLevel(AsyncStruct* asyncStruct)
+{
+    Texture2D* texture = asyncStruct->streamTexture;
+    Image& image = asyncStruct->image;
+    auto it = _streamedTextures.find(texture);
+    // removed from the cache, initialized again or the file changed in the meantime
+    if (it != _streamedTextures.end() && asyncStruct->loadSuccess && texture->isStreamed()
+        && image.getNumberOfMipmaps() == texture->_streamedLevels && image.getRenderFormat() == texture->getPixelFormat()
+        && image.getWidth() == texture->getPixelsWide() && image.getHeight() == texture->getPixelsHigh())
+    {
+        CC_TRACE_ZONE("texture", "TextureCache::finishStreamedLevel");
+        it->second.loadingLevel = -1;
+        it->second.neededFrame = Director::getInstance()->getTotalFrames();
+        if (uploadStreamedLevels(texture, image.getMipmaps(), asyncStruct->streamLevel))
+        {
+            updateCachedBytes(texture);
+            evictToBudget(texture);
+        }
+    }
+    else if (it != _streamedTextures.end())
+    {
+        CCLOG("cocos2d: TextureCache: can't stream the levels of %s", asyncStruct->filename.c_str());
+        _streamedTextures.erase(it);
+    }
+
+    delete asyncStruct;
+    --_asyncRefCount;
+}
+
+void TextureCache::dropStreamedLevels(Texture2D* texture, StreamedTexture& stream)
+{
+    std::vector<MipmapInfo> mipmaps(texture->_streamedLevels);
+    unsigned char* data = stream.tail.data();
+    for (size_t i = 0; i < stream.tailLengths.size(); ++i)
+    {
+        mipmaps[stream.tailLevel + i].address = data;
+        mipmaps[stream.tailLevel + i].len = stream.tailLengths[i];
+        data += stream.tailLengths[i];
+    }
+    if (uploadStreamedLevels(texture, mipmaps.data(), stream.tailLevel))
+    {
+        updateCachedBytes(texture);
+    }
+}
+
+void TextureCache::shrinkStreamedTextures(size_t targetBytes, Texture2D* keep)
+{
+    unsigned int frame = Director::getInstance()->getTotalFrames();
+    std::vector<Texture2D*> candidates;
+    for (const auto& it : _streamedTextures)
+    {
+        auto texture = it.first;
+        bool requested = frame - texture->_requestedFrame <= 1;
+        if (texture != keep && texture->isStreamed() && texture->_residentLevel < it.second.tailLevel
+            && (!requested || texture->_requestedLevel > texture->_residentLevel))
+        {
+            candidates.push_back(texture);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [this](Texture2D* a, Texture2D* b) {
+        return _streamedTextures[a].neededFrame < _streamedTextures[b].neededFrame;
+    });
+
+    for (auto texture : candidates)
+    {
+        if (_cachedBytes <= targetBytes)
+            break;
+
+        // the level the frames need, if any, streams in again
+        dropStreamedLevels(texture, _streamedTextures[texture]);
+    }
+}
+
+void TextureCache::updateStreaming(float dt)
+{
+    unsigned int frame = Director::getInstance()->getTotalFrames();
+    for (auto it = _streamedTextures.begin(); it != _streamedTextures.end(); /* nothing */)
+    {
+        auto texture = it->first;
+        StreamedTexture& stream = it->second;
+        if (!texture->isStreamed())
+        {
+            // initialized again, e.g. reloaded at full resolution
+            it = _streamedTextures.erase(it);
+            continue;
+        }
+        ++it;
+
+        // the levels the last frame drew it with, the coarse ones when it wasn't drawn
+        bool requested = frame - texture->_requestedFrame <= 1;
+        int needed = requested ? texture->_requestedLevel : stream.tailLevel;
+        int resident = texture->_residentLevel;
+        if (needed <= resident)
+        {
+            stream.neededFrame = frame;
+            if (needed < resident && stream.loadingLevel < 0)
+            {
+                requestStreamedLevel(texture, stream, needed);
+            }
+        }
+        else if (frame - stream.neededFrame > STREAMING_IDLE_FRAMES && stream.loadingLevel < 0)
+        {
+            if (needed >= stream.tailLevel)
+            {
+                dropStreamedLevels(texture, stream);
+            }
+            else
+            {
+                // the file is decoded again for the levels between the needed one and the copy
+                requestStreamedLevel(texture, stream, needed);
+            }
+        }
+    }
+
+    if (_streamedTextures.empty())
+    {
+        Director::DirectorInstance->getScheduler()->unschedule(CC_SCHEDULE_SELECTOR(TextureCache::updateStreaming), this);
+    }
+}
+
+void TextureCache::setMemoryBudget(size_t bytes)
+{
+    _memoryBudget = bytes;
+    evictToBudget(nullptr);
+}
+
+void TextureCache::cacheTexture(const std::string& key, Texture2D* texture)
+{
+    _textures.insert(std::make_pair(key, texture));
+
+    CacheEntry entry = { texture->getMemoryBytes(), Director::getInstance()->getTotalFrames() };
+    _cacheEntries[texture] = entry;
+    _cachedBytes += entry.bytes;
+    ++_cacheMisses;
+
+    evictToBudget(texture);
+}
+
+void TextureCache::uncacheTexture(Texture2D* texture)
+{
+    auto it = _cacheEntries.find(texture);
+    if (it != _cacheEntries.end())
+    {
+        _cachedBytes -= it->second.bytes;
+        _cacheEntries.erase(it);
+    }
+    _streamedTextures.erase(texture);
+}
+
+Texture2D* TextureCache::findTexture(const std::string& key)
+{
+    auto it = _textures.find(key);
+    if (it == _textures.end())
+        return nullptr;
+
+    auto entry = _cacheEntries.find(it->second);
+    if (entry != _cacheEntries.end())
+    {
+        entry->second.lastUsedFrame = Director::getInstance()->getTotalFrames();
+    }
+    ++_cacheHits;
+    return it->second;
+}
+
+void TextureCache::updateCachedBytes(Texture2D* texture)
+{
+    auto it = _cacheEntries.find(texture);
+    if (it != _cacheEntries.end())
+    {
+        _cachedBytes -= it->second.bytes;
+        it->second.bytes = texture->getMemoryBytes();
+        _cachedBytes += it->second.bytes;
+    }
+}
+
+size_t TextureCache::trimUnusedTextures(float fraction)
+{
+    unsigned int frame = Director::getInstance()->getTotalFrames();
+    size_t unusedBytes = 0;
+    for (const auto& it : _textures)
+    {
+        auto texture = it.second;
+        const auto& entry = _cacheEntries[texture];
+        if (texture->getReferenceCount() == 1 && entry.lastUsedFrame != frame)
+        {
+            unusedBytes += entry.bytes;
+        }
+    }
+
+    const size_t before = _cachedBytes;
+    const size_t trimmed = (size_t)(unusedBytes * std::min(std::max(fraction, 0.0f), 1.0f));
+    // the levels the frames don't need go first, whatever the fraction
+    shrinkStreamedTextures(0, nullptr);
+    evictUnused(std::min(_cachedBytes, before - trimmed), nullptr);
+    return before - _cachedBytes;
+}
+
+void TextureCache::evictToBudget(Texture2D* keep)
+{
+    if (_memoryBudget == 0 || _cachedBytes <= _memoryBudget)
+        return;
+
+    evictUnused(_memoryBudget, keep);
+}
+
+void TextureCache::evictUnused(size_t targetBytes, Texture2D* keep)
+{
+    // the levels finer than the frames need can stream in again, they go before the textures
+    shrinkStreamedTextures(targetBytes, keep);
+    if (_cachedBytes <= targetBytes)
+        return;
+
+    unsigned int frame = Director::getInstance()->getTotalFrames();
+    std::vector<std::unordered_map<std::string, Texture2D*>::iterator> candidates;
+    for (auto it = _textures.begin(); it != _textures.end(); ++it)
+    {
+        auto texture = it->second;
+        if (texture != keep && texture->getReferenceCount() == 1 && _cacheEntries[texture].lastUsedFrame != frame)
+        {
+            candidates.push_back(it);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [this](const std::unordered_map<std::string, Texture2D*>::iterator& a,
+                                                           const std::unordered_map<std::string, Texture2D*>::iterator& b) {
+        return _cacheEntries[a->second].lastUsedFrame < _cacheEntries[b->second].lastUsedFrame;
+    });
+
+    for (auto& it : candidates)
+    {
+        if (_cachedBytes <= targetBytes)
+            break;
+
+        CCLOGINFO("cocos2d: TextureCache: evicting texture: %s", it->first.c_str());
+        auto texture = it->second;
+        uncacheTexture(texture);
+        texture->release();
+        _textures.erase(it);
+        ++_evictions;
+    }
+}
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+
+std::list<VolatileTexture*> VolatileTextureMgr::_textures;
 bool VolatileTextureMgr::_isReloading = false;
 
+// the image files of the reload, those of the visible nodes first, then those in use by a node, then the others
+static std::vector<VolatileTexture*> s_reloadQueue;
+// the next file handed over to a worker, guarded by s_reloadMutex with the ReloadState of the files
+static size_t s_reloadNextDecode = 0;
+// the next file whose texture is created, main thread only
+static size_t s_reloadNextUpload = 0;
+static std::mutex s_reloadMutex;
+static std::condition_variable s_reloadCondition;
+static std::vector<std::thread*> s_reloadThreads;
+static const std::string RELOAD_SCHEDULE_KEY = "VolatileTextureMgr::reload";
+
+static size_t s_residentSize = CC_VOLATILE_TEXTURE_RESIDENT_SIZE;
+static size_t s_residentBytes = 0;
+
 VolatileTexture::VolatileTexture(Texture2D *t)
 : _texture(t)
 , _cashedImageType(kInvalid)
 , _textureData(nullptr)
 , _pixelFormat(Texture2D::PixelFormat::RGBA8888)
 , _fileName("")
+, _reloadState(ReloadState::NONE)
+, _reloadImage(nullptr)
+, _reloadStale(false)
 , _text("")
 , _uiImage(nullptr)
 , _hasMipmaps(false)
@@ -621,6 +1476,17 @@ VolatileTexture::VolatileTexture(Texture2D *t)
 VolatileTexture::~VolatileTexture()
 {
     CC_SAFE_RELEASE(_uiImage);
+    CC_SAFE_RELEASE(_reloadImage);
+    s_residentBytes -= _fileData.getSize();
+}
+
+void VolatileTexture::markReloadStale()
+{
+    if (_reloadState != ReloadState::NONE)
+    {
+        std::lock_guard<std::mutex> lock(s_reloadMutex);
+        _reloadStale = true;
+    }
 }
 
 void VolatileTextureMgr::addImageTexture(Texture2D *tt, const std::string& imageFileName)
@@ -631,15 +1497,33 @@ void VolatileTextureMgr::addImageTexture(Texture2D *tt, const std::string& image
     }
 
     VolatileTexture *vt = findVolotileTexture(tt);
+    vt->markReloadStale();
 
     vt->_cashedImageType = VolatileTexture::kImageFile;
     vt->_fileName = imageFileName;
     vt->_pixelFormat = tt->getPixelFormat();
+
+    // a compressed file is about the size of its texture and needs no decoding, it's kept while the size allows it
+    s_residentBytes -= vt->_fileData.getSize();
+    vt->_fileData.clear();
+    const auto& formats = Texture2D::getPixelFormatInfoMap();
+    auto format = formats.find(vt->_pixelFormat);
+    if (format != formats.end() && format->second.compressed)
+    {
+        auto fileUtils = FileUtils::getInstance();
+        long size = fileUtils->getFileSize(imageFileName);
+        if (size > 0 && s_residentBytes + size <= s_residentSize)
+        {
+            vt->_fileData = fileUtils->getDataFromFile(imageFileName);
+            s_residentBytes += vt->_fileData.getSize();
+        }
+    }
 }
 
 void VolatileTextureMgr::addImage(Texture2D *tt, Image *image)
 {
     VolatileTexture *vt = findVolotileTexture(tt);
+    vt->markReloadStale();
     image->retain();
     vt->_uiImage = image;
     vt->_cashedImageType = VolatileTexture::kImage;
@@ -676,6 +1560,7 @@ void VolatileTextureMgr::addDataTexture(Texture2D *tt, void* data, int dataLen,
     }
 
     VolatileTexture *vt = findVolotileTexture(tt);
+    vt->markReloadStale();
 
     vt->_cashedImageType = VolatileTexture::kImageData;
     vt->_textureData = data;
@@ -692,6 +1577,7 @@ void VolatileTextureMgr::addStringTexture(Texture2D *tt, const std::string& text
     }
 
     VolatileTexture *vt = findVolotileTexture(tt);
+    vt->markReloadStale();
 
     vt->_cashedImageType = VolatileTexture::kString;
     vt->_text     = text;
@@ -727,15 +1613,59 @@ void VolatileTextureMgr::removeTexture(Texture2D *t)
         if (vt->_texture == t)
         {
             _textures.remove(vt);
-            delete vt;
+            if (vt->_reloadState != VolatileTexture::ReloadState::NONE)
+            {
+                // it is in the reload, deleted once its file is decoded
+                std::lock_guard<std::mutex> lock(s_reloadMutex);
+                vt->_texture = nullptr;
+            }
+            else
+            {
+                delete vt;
+            }
             break;
         }
     }
 }
 
+void VolatileTextureMgr::setResidentCompressedSize(size_t bytes)
+{
+    s_residentSize = bytes;
+}
+
+size_t VolatileTextureMgr::getResidentCompressedSize()
+{
+    return s_residentSize;
+}
+
+bool VolatileTextureMgr::isReloadingInBackground()
+{
+    return !s_reloadQueue.empty();
+}
+
+static void collectVisibleTextures(Node* node, std::unordered_set<Texture2D*>& textures)
+{
+    if (!node->isVisible())
+    {
+        return;
+    }
+
+    auto textureProtocol = dynamic_cast<TextureProtocol*>(node);
+    if (textureProtocol && textureProtocol->getTexture())
+    {
+        textures.insert(textureProtocol->getTexture());
+    }
+
+    for (auto child : node->getChildren())
+    {
+        collectVisibleTextures(child, textures);
+    }
+}
+
 void VolatileTextureMgr::reloadAllTextures()
 {
-    _isReloading = true;
+    // a reload in progress starts over, the textures it created were lost with the context too
+    endReload();
 
     // we need to release all of the glTextures to avoid collisions of texture id's when reloading the textures onto the GPU
     for(auto iter = _textures.begin(); iter != _textures.end(); ++iter)
@@ -744,59 +1674,246 @@ void VolatileTextureMgr::reloadAllTextures()
     }
 
     CCLOG("reload all texture");
-    auto iter = _textures.begin();
 
-    while (iter != _textures.end())
+    std::unordered_set<Texture2D*> visibleTextures;
+    auto scene = Director::DirectorInstance->getRunningScene();
+    if (scene)
     {
-        VolatileTexture *vt = *iter++;
+        collectVisibleTextures(scene, visibleTextures);
+    }
 
-        switch (vt->_cashedImageType)
+    // data, strings, images and resident compressed files are created at once, they need no decoding.
+    // the image files are decoded in parallel, the visible ones, then the ones in use by a node, then the ones only cached
+    std::vector<VolatileTexture*> imageFiles[3];
+    for (auto vt : _textures)
+    {
+        if (vt->_cashedImageType != VolatileTexture::kImageFile || !vt->_fileData.isNull())
         {
-        case VolatileTexture::kImageFile:
-            {
-                Image* image = new (std::nothrow) Image();
+            reloadTexture(vt, nullptr);
+            continue;
+        }
 
-                Data data = FileUtils::getInstance()->getDataFromFile(vt->_fileName);
+        int priority = visibleTextures.count(vt->_texture) ? 0 : (vt->_texture->getReferenceCount() > 1 ? 1 : 2);
+        imageFiles[priority].push_back(vt);
+    }
 
-                if (image && image->initWithImageData(data.getBytes(), data.getSize()))
-                {
-                    Texture2D::PixelFormat oldPixelFormat = Texture2D::getDefaultAlphaPixelFormat();
-                    Texture2D::setDefaultAlphaPixelFormat(vt->_pixelFormat);
-                    vt->_texture->initWithImage(image);
-                    Texture2D::setDefaultAlphaPixelFormat(oldPixelFormat);
-                }
+    for (const auto& files : imageFiles)
+    {
+        for (auto vt : files)
+        {
+            vt->_reloadState = VolatileTexture::ReloadState::QUEUED;
+            vt->_reloadStale = false;
+            vt->_reloadImage = new (std::nothrow) Image();
+            s_reloadQueue.push_back(vt);
+        }
+    }
+    if (s_reloadQueue.empty())
+    {
+        return;
+    }
 
-                CC_SAFE_RELEASE(image);
+    int threadCount = std::min(std::max((int)std::thread::hardware_concurrency() - 1, 1), CC_TEXTURE_CACHE_MAX_ASYNC_THREADS);
+    for (int i = 0; i < threadCount; ++i)
+    {
+        s_reloadThreads.push_back(new (std::nothrow) std::thread([]() {
+            Tracer::setThreadName("texture reloader");
+            decodeReloadImages(s_reloadQueue.size());
+        }));
+    }
+
+    // the main thread decodes the visible ones with the workers, and creates them before the next frame
+    const size_t visibleCount = imageFiles[0].size();
+    decodeReloadImages(visibleCount);
+    {
+        std::unique_lock<std::mutex> lock(s_reloadMutex);
+        s_reloadCondition.wait(lock, [visibleCount]() {
+            return std::all_of(s_reloadQueue.begin(), s_reloadQueue.begin() + visibleCount, [](VolatileTexture* vt) {
+                return vt->_reloadState == VolatileTexture::ReloadState::DECODED;
+            });
+        });
+    }
+    uploadReloadImages(visibleCount, 0);
+
+    if (!s_reloadQueue.empty())
+    {
+        Director::DirectorInstance->getScheduler()->schedule([](float) {
+            uploadReloadImages(s_reloadQueue.size(), Director::DirectorInstance->getTextureCache()->getAsyncUploadBudget());
+        }, &s_reloadQueue, 0, false, RELOAD_SCHEDULE_KEY);
+    }
+}
+
+void VolatileTextureMgr::decodeReloadImages(size_t end)
+{
+    while (true)
+    {
+        VolatileTexture *vt = nullptr;
+        Image *image = nullptr;
+        std::string fileName;
+        {
+            std::lock_guard<std::mutex> lock(s_reloadMutex);
+            if (s_reloadNextDecode >= end)
+            {
+                break;
             }
-            break;
-        case VolatileTexture::kImageData:
+
+            vt = s_reloadQueue[s_reloadNextDecode++];
+            if (vt->_texture == nullptr || vt->_reloadStale)
             {
-                vt->_texture->initWithData(vt->_textureData,
-                                           vt->_dataLen,
-                                          vt->_pixelFormat,
-                                          vt->_textureSize.width,
-                                          vt->_textureSize.height,
-                                          vt->_textureSize);
+                vt->_reloadState = VolatileTexture::ReloadState::DECODED;
+                s_reloadCondition.notify_all();
+                continue;
             }
+            vt->_reloadState = VolatileTexture::ReloadState::DECODING;
+            fileName = vt->_fileName;
+            image = vt->_reloadImage;
+            image->setDecodePixelFormat(vt->_pixelFormat);
+        }
+
+        CC_TRACE_ZONE("texture", "VolatileTextureMgr::decodeReloadImages");
+        image->initWithImageFileThreadSafe(fileName);
+
+        std::lock_guard<std::mutex> lock(s_reloadMutex);
+        vt->_reloadState = VolatileTexture::ReloadState::DECODED;
+        s_reloadCondition.notify_all();
+    }
+}
+
+void VolatileTextureMgr::uploadReloadImages(size_t end, float budget)
+{
+    auto start = std::chrono::steady_clock::now();
+    bool uploaded = false;
+    while (s_reloadNextUpload < end)
+    {
+        // at least one texture is created per frame
+        if (uploaded && budget > 0 &&
+            std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() >= budget)
+        {
             break;
-        case VolatileTexture::kString:
+        }
+
+        VolatileTexture *vt = s_reloadQueue[s_reloadNextUpload];
+        {
+            std::lock_guard<std::mutex> lock(s_reloadMutex);
+            if (vt->_reloadState != VolatileTexture::ReloadState::DECODED)
             {
-                vt->_texture->initWithString(vt->_text.c_str(), vt->_fontDefinition);
+                break;
             }
-            break;
-        case VolatileTexture::kImage:
+        }
+        ++s_reloadNextUpload;
+
+        // no worker has it anymore
+        Image *image = vt->_reloadImage;
+        vt->_reloadImage = nullptr;
+        vt->_reloadState = VolatileTexture::ReloadState::NONE;
+        if (vt->_texture == nullptr)
+        {
+            delete vt;
+        }
+        else if (!vt->_reloadStale)
+        {
+            reloadTexture(vt, image);
+            uploaded = true;
+        }
+        CC_SAFE_RELEASE(image);
+    }
+
+    if (s_reloadNextUpload == s_reloadQueue.size())
+    {
+        endReload();
+    }
+}
+
+void VolatileTextureMgr::endReload()
+{
+    if (s_reloadQueue.empty())
+    {
+        return;
+    }
+
+    {
+        // the workers stop after the file they decode
+        std::lock_guard<std::mutex> lock(s_reloadMutex);
+        s_reloadNextDecode = s_reloadQueue.size();
+    }
+    for (auto thread : s_reloadThreads)
+    {
+        thread->join();
+        delete thread;
+    }
+    s_reloadThreads.clear();
+
+    Director::DirectorInstance->getScheduler()->unschedule(RELOAD_SCHEDULE_KEY, &s_reloadQueue);
+
+    for (size_t i = s_reloadNextUpload; i < s_reloadQueue.size(); ++i)
+    {
+        VolatileTexture *vt = s_reloadQueue[i];
+        vt->_reloadState = VolatileTexture::ReloadState::NONE;
+        CC_SAFE_RELEASE_NULL(vt->_reloadImage);
+        if (vt->_texture == nullptr)
+        {
+            delete vt;
+        }
+    }
+    s_reloadQueue.clear();
+    s_reloadNextDecode = 0;
+    s_reloadNextUpload = 0;
+}
+
+void VolatileTextureMgr::reloadTexture(VolatileTexture *vt, Image *image)
+{
+    _isReloading = true;
+
+    switch (vt->_cashedImageType)
+    {
+    case VolatileTexture::kImageFile:
+        {
+            bool loaded = image && image->getData();
+            if (!image)
             {
-                vt->_texture->initWithImage(vt->_uiImage);
+                // a resident compressed file, or a file the workers didn't get to
+                image = new (std::nothrow) Image();
+                image->setDecodePixelFormat(vt->_pixelFormat);
+                loaded = vt->_fileData.isNull() ? image->initWithImageFile(vt->_fileName)
+                                                : image->initWithImageData(vt->_fileData.getBytes(), vt->_fileData.getSize());
+                image->autorelease();
             }
-            break;
-        default:
-            break;
+
+            if (loaded)
+            {
+                Texture2D::PixelFormat oldPixelFormat = Texture2D::getDefaultAlphaPixelFormat();
+                Texture2D::setDefaultAlphaPixelFormat(vt->_pixelFormat);
+                vt->_texture->initWithImage(image);
+                Texture2D::setDefaultAlphaPixelFormat(oldPixelFormat);
+            }
+        }
+        break;
+    case VolatileTexture::kImageData:
+        {
+            vt->_texture->initWithData(vt->_textureData,
+                                       vt->_dataLen,
+                                      vt->_pixelFormat,
+                                      vt->_textureSize.width,
+                                      vt->_textureSize.height,
+                                      vt->_textureSize);
         }
-        if (vt->_hasMipmaps) {
-            vt->_texture->generateMipmap();
+        break;
+    case VolatileTexture::kString:
+        {
+            vt->_texture->initWithString(vt->_text.c_str(), vt->_fontDefinition);
+        }
+        break;
+    case VolatileTexture::kImage:
+        {
+            vt->_texture->initWithImage(vt->_uiImage);
         }
-        vt->_texture->setTexParameters(vt->_texParams);
+        break;
+    default:
+        break;
+    }
+    if (vt->_hasMipmaps) {
+        vt->_texture->generateMipmap();
     }
+    vt->_texture->setTexParameters(vt->_texParams);
 
     _isReloading = false;
 }
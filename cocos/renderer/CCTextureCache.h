@@ -32,10 +32,12 @@ THE SOFTWARE.
 #include <mutex>
 #include <thread>
 #include <condition_variable>
+#include <chrono>
 #include <queue>
 #include <string>
 #include <unordered_map>
 #include <functional>
+#include <vector>
 
 #include "base/CCRef.h"
 #include "renderer/CCTexture2D.h"
@@ -43,6 +45,7 @@ THE SOFTWARE.
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     #include "platform/CCImage.h"
+    #include "base/CCData.h"
     #include <list>
 #endif
 
@@ -64,6 +67,19 @@ NS_CC_BEGIN
 class CC_DLL TextureCache : public Ref
 {
 public:
+    /** The priority of an addImageAsync() request, the most urgent requests are decoded and created first. */
+    enum class AsyncPriority
+    {
+        /** Needed by the current frame. */
+        CRITICAL,
+        /** On screen soon, the default. */
+        VISIBLE,
+        /** The assets of what comes next, e.g. the next level. */
+        PREFETCH,
+    };
+    /** The number of priorities of the requests. */
+    static const int ASYNC_PRIORITY_COUNT = 3;
+
     /** Returns the shared instance of the cache. */
     CC_DEPRECATED_ATTRIBUTE static TextureCache * getInstance();
 
@@ -116,6 +132,31 @@ public:
     */
     virtual void addImageAsync(const std::string &filepath, const std::function<void(Texture2D*)>& callback);
 
+    /** Same as addImageAsync() with an explicit priority, AsyncPriority::VISIBLE is the default.
+     * The callbacks of the requests of one priority are called in the order of the requests,
+     * the more urgent ones may overtake them.
+     * @since v3.11
+     */
+    void addImageAsync(const std::string &filepath, const std::function<void(Texture2D*)>& callback, AsyncPriority priority);
+
+    /** Changes the priority of the pending requests of a file image, e.g. a prefetched texture that is needed now.
+     * @param filename It's the related/absolute path of the file image.
+     * @since v3.11
+     */
+    void setImageAsyncPriority(const std::string &filename, AsyncPriority priority);
+
+    /** Cancels the pending requests of a file image, unlike unbindImageAsync() the image isn't decoded if it hasn't started yet.
+     * The callbacks aren't called, the images that are already decoded aren't turned into textures.
+     * @param filename It's the related/absolute path of the file image.
+     * @since v3.11
+     */
+    void cancelImageAsync(const std::string &filename);
+
+    /** Cancels all the pending requests, see cancelImageAsync().
+     * @since v3.11
+     */
+    void cancelAllImageAsync();
+
     /** Unbind a specified bound image asynchronous callback.
      * In the case an object who was bound to an image asynchronous callback was destroyed before the callback is invoked,
      * the object always need to unbind this callback manually.
@@ -129,6 +170,65 @@ public:
      */
     virtual void unbindAllImageAsync();
 
+    /**
+     * Sets the number of threads that decode the images of addImageAsync() in parallel.
+     * The callbacks are still called in the order of the requests. The threads start with the first addImageAsync(),
+     * the count can't change afterwards. By default it's one thread per core but one, up to CC_TEXTURE_CACHE_MAX_ASYNC_THREADS,
+     * the "cocos2d.x.texture.async_threads" configuration key overrides it.
+     */
+    void setAsyncThreadCount(int count);
+    /** Gets the number of threads that decode the images of addImageAsync(). */
+    int getAsyncThreadCount() const { return _asyncThreadCount; }
+
+    /**
+     * Sets the milliseconds per frame the main thread may spend creating the textures of addImageAsync().
+     * At least one texture is created per frame, the others wait for the next frames once the budget is spent.
+     * 4 ms by default, the "cocos2d.x.texture.async_upload_budget" configuration key overrides it. 0 means no limit.
+     */
+    void setAsyncUploadBudget(float milliseconds) { _asyncUploadBudget = milliseconds; }
+    /** Gets the milliseconds per frame the main thread may spend creating the textures of addImageAsync(). */
+    float getAsyncUploadBudget() const { return _asyncUploadBudget; }
+
+    /**
+     * Enable/Disable the upload thread of addImageAsync().
+     * When enabled, the decoded images are turned into GL textures by a thread with its own context in the share group
+     * of the view, see GLView::createUploadContext(), and the main thread only wraps them into a Texture2D.
+     * Without it, or when the view has no such context, the main thread creates the textures: the ones of big
+     * uncompressed images are filled a band of rows at a time within the upload budget, over several frames if needed.
+     * Disabled by default, the "cocos2d.x.texture.upload_thread" configuration key overrides it.
+     * It applies when the threads of addImageAsync() start.
+     */
+    void setUploadThreadEnabled(bool enabled) { _uploadThreadEnabled = enabled; }
+    /** Whether or not the textures of addImageAsync() are created by the upload thread when the view supports it. */
+    bool isUploadThreadEnabled() const { return _uploadThreadEnabled; }
+
+    /**
+     * Enable/Disable building the mipmaps of the images of addImageAsync() on the loader threads.
+     * The power of two I8, AI88, RGB888 and RGBA8888 images get a full mipmap chain, see Image::generateMipmaps(),
+     * instead of calling Texture2D::generateMipmap() on the main thread. It doesn't apply when the image is decoded
+     * into another pixel format. Disabled by default, the "cocos2d.x.texture.async_mipmaps" configuration key overrides it.
+     * @since v3.11
+     */
+    void setAsyncMipmapsEnabled(bool enabled) { _asyncMipmapsEnabled = enabled; }
+    /** Whether or not addImageAsync() builds the mipmaps of the images on the loader threads. */
+    bool isAsyncMipmapsEnabled() const { return _asyncMipmapsEnabled; }
+
+    /**
+     * Enable/Disable streaming the mip levels of the textures loaded from files with a full mipmap chain: the PVR
+     * and KTX files that ship one, and the images of addImageAsync() when setAsyncMipmapsEnabled() is on.
+     * Such a texture is created with its levels of 128 pixels or less only, a copy of which is kept in memory.
+     * Its finer levels are decoded again from the file in the background, with the PREFETCH priority, once the
+     * nodes that draw it need them, see Texture2D::requestTexelDensity(). The levels finer than the frames need
+     * are dropped after 300 frames, or at once when the memory budget or trimUnusedTextures() need room, before
+     * any texture is removed.
+     * Only the nodes that call Texture2D::requestTexelDensity(), like Sprite, get the finer levels: ship mipmap
+     * chains for the textures only they draw. Disabled by default, the "cocos2d.x.texture.streaming" configuration key overrides it.
+     * @since v3.11
+     */
+    void setTextureStreamingEnabled(bool enabled) { _streamingEnabled = enabled; }
+    /** Whether or not the mip levels of the textures with a mipmap chain are streamed. */
+    bool isTextureStreamingEnabled() const { return _streamingEnabled; }
+
     /** Returns a Texture2D object given an Image.
     * If the image was not previously loaded, it will create a new Texture2D object and it will return it.
     * Otherwise it will return a reference of a previously loaded image.
@@ -166,6 +266,16 @@ public:
     */
     void removeUnusedTextures();
 
+    /**
+     * Removes the least recently looked up part of the unused textures, like the memory budget does.
+     * The textures looked up during the current frame are kept. See MemoryPressure.
+     *
+     * @param fraction The part of the bytes of the unused textures to remove, from 0 to 1.
+     * @return The number of bytes removed.
+     * @since v3.11
+     */
+    size_t trimUnusedTextures(float fraction);
+
     /** Deletes a texture from the cache given a texture.
     */
     void removeTexture(Texture2D* texture);
@@ -183,6 +293,27 @@ public:
     */
     std::string getCachedTextureInfo() const;
 
+    /** Returns the number of bytes the cached textures take, their mipmaps included. */
+    size_t getTotalTextureBytes() const { return _cachedBytes; }
+
+    /**
+     * Sets the number of bytes the cached textures may take, 0 means no limit.
+     * When a new texture takes the cache over the budget, the unused textures (a reference count of 1, held by
+     * the cache only) are removed, the least recently looked up first, until it fits again.
+     * The textures looked up during the current frame are kept, since their callers may not have retained them yet.
+     * The "cocos2d.x.texture.memory_budget" configuration key sets it in MB. No limit by default.
+     */
+    void setMemoryBudget(size_t bytes);
+    /** Gets the number of bytes the cached textures may take, 0 when there is no limit. */
+    size_t getMemoryBudget() const { return _memoryBudget; }
+
+    /** Gets the number of addImage() and addImageAsync() calls that found their texture in the cache. */
+    unsigned int getCacheHits() const { return _cacheHits; }
+    /** Gets the number of addImage() and addImageAsync() calls that had to load their texture. */
+    unsigned int getCacheMisses() const { return _cacheMisses; }
+    /** Gets the number of textures removed because of the memory budget or by trimUnusedTextures(). */
+    unsigned int getEvictions() const { return _evictions; }
+
     //Wait for texture cache to quit before destroy instance.
     /**Called by director, please do not called outside.*/
     void waitForQuit();
@@ -198,28 +329,112 @@ public:
 
 private:
     void addImageAsyncCallBack(float dt);
+    void updateStreaming(float dt);
     void loadImage();
+    void uploadImages();
     void parseNinePatchImage(Image* image, Texture2D* texture, const std::string& path);
 public:
 protected:
     struct AsyncStruct;
 
-    std::thread* _loadingThread;
-
+    //the next request to turn into a texture: the first loaded one of the most urgent priority
+    AsyncStruct* popLoadedAsyncStruct();
+    //creates the texture of a loaded request on the main thread, or starts filling it by bands of rows in _slicedStruct
+    Texture2D* createAsyncTexture(AsyncStruct* asyncStruct, const std::chrono::steady_clock::time_point& start);
+    //fills the next bands of rows of _slicedStruct within the budget of the frame, returns true once it's complete
+    bool fillSlicedTexture(const std::chrono::steady_clock::time_point& start);
+    //caches the texture of a request, calls its callback then deletes it
+    void finishAsyncStruct(AsyncStruct* asyncStruct, Texture2D* texture, bool created);
+    bool isUploadBudgetSpent(const std::chrono::steady_clock::time_point& start) const;
+    //starts the loader threads and the callbacks if needed, then queues a request
+    void enqueueAsyncStruct(AsyncStruct* asyncStruct);
+    //the GL texture of an image, like Texture2D::initWithImage() but on the upload thread. Returns 0 when it fails
+    static GLuint uploadImage(Image* image, Texture2D::PixelFormat format, Texture2D::PixelFormat* outFormat);
+
+    //the memory accounting of a cached texture
+    struct CacheEntry
+    {
+        size_t bytes;
+        unsigned int lastUsedFrame;
+    };
+
+    //every insertion and removal of _textures goes through these, the texture is retained by the caller of cacheTexture()
+    void cacheTexture(const std::string& key, Texture2D* texture);
+    void uncacheTexture(Texture2D* texture);
+    Texture2D* findTexture(const std::string& key);
+    void updateCachedBytes(Texture2D* texture);
+    void evictToBudget(Texture2D* keep);
+    // removes the unused textures, the least recently looked up first, until the cache takes `targetBytes` at most
+    void evictUnused(size_t targetBytes, Texture2D* keep);
+
+    std::vector<std::thread*> _loadingThreads;
+    int _asyncThreadCount;
+    float _asyncUploadBudget;
+
+    //the requests in their order, the front ones are turned into textures once they're decoded
     std::deque<AsyncStruct*> _asyncStructQueue;
-    std::deque<AsyncStruct*> _requestQueue;
-    std::deque<AsyncStruct*> _responseQueue;
+    //the requests that aren't decoded yet, by priority
+    std::deque<AsyncStruct*> _requestQueues[ASYNC_PRIORITY_COUNT];
 
     std::mutex _requestMutex;
+    //guards AsyncStruct::loaded
     std::mutex _responseMutex;
 
     std::condition_variable _sleepCondition;
 
     bool _needQuit;
 
+    bool _uploadThreadEnabled;
+    std::thread* _uploadThread;
+    //the decoded requests waiting for the upload thread, and its quit flag: locked by _uploadMutex
+    std::deque<AsyncStruct*> _uploadQueue;
+    bool _uploadQuit;
+    std::mutex _uploadMutex;
+    std::condition_variable _uploadCondition;
+
+    //the request whose texture is filled by bands of rows over several frames, the callbacks after it wait for it
+    AsyncStruct* _slicedStruct;
+
     int _asyncRefCount;
 
     std::unordered_map<std::string, Texture2D*> _textures;
+
+    //the file and the coarse levels of a streamed texture
+    struct StreamedTexture
+    {
+        std::string path;
+        // the first level of the copy, the levels up to it are always resident
+        int tailLevel;
+        std::vector<unsigned char> tail;
+        std::vector<int> tailLengths;
+        // the level a request is loading, -1 when none
+        int loadingLevel;
+        // the last frame its resident levels were all needed
+        unsigned int neededFrame;
+    };
+
+    //creates a streamed texture from the levels of an image, returns false when it can't be streamed
+    bool initStreamedTexture(Texture2D* texture, Image* image, const std::string& path);
+    //makes the levels from `first` on resident, `mipmaps` has every level of the chain
+    static bool uploadStreamedLevels(Texture2D* texture, const MipmapInfo* mipmaps, int first);
+    void requestStreamedLevel(Texture2D* texture, StreamedTexture& stream, int level);
+    void finishStreamedLevel(AsyncStruct* asyncStruct);
+    void dropStreamedLevels(Texture2D* texture, StreamedTexture& stream);
+    // drops the levels finer than the frames need, the least recently needed first, until the cache takes `targetBytes` at most
+    void shrinkStreamedTextures(size_t targetBytes, Texture2D* keep);
+
+    bool _asyncMipmapsEnabled;
+    bool _streamingEnabled;
+    std::unordered_map<Texture2D*, StreamedTexture> _streamedTextures;
+
+    std::unordered_map<Texture2D*, CacheEntry> _cacheEntries;
+    size_t _cachedBytes;
+    size_t _memoryBudget;
+    unsigned int _cacheHits;
+    unsigned int _cacheMisses;
+    unsigned int _evictions;
+
+    friend class VideoMemory;
 };
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
@@ -234,6 +449,14 @@ class VolatileTexture
         kImage,
     }ccCachedImageType;
 
+    // an image file reloaded by the workers of VolatileTextureMgr::reloadAllTextures()
+    enum class ReloadState {
+        NONE,
+        QUEUED,
+        DECODING,
+        DECODED,
+    };
+
 private:
     VolatileTexture(Texture2D *t);
     /**
@@ -256,6 +479,16 @@ protected:
     Texture2D::PixelFormat _pixelFormat;
 
     std::string _fileName;
+    // the file of a compressed texture, kept while VolatileTextureMgr::setResidentCompressedSize() allows it
+    Data _fileData;
+
+    ReloadState _reloadState;
+    // decoded by a worker, created and released by the main thread
+    Image *_reloadImage;
+    // the texture was created again from another source during the reload
+    bool _reloadStale;
+    // called when the texture is given another source, a reload in progress leaves it alone
+    void markReloadStale();
 
     bool                      _hasMipmaps;
     Texture2D::TexParams      _texParams;
@@ -274,7 +507,25 @@ public:
     static void setHasMipmaps(Texture2D *t, bool hasMipmaps);
     static void setTexParameters(Texture2D *t, const Texture2D::TexParams &texParams);
     static void removeTexture(Texture2D *t);
+    /**
+     * Reloads the textures after the GL context was recreated.
+     * The textures of data, strings, images and resident compressed files are created again at once.
+     * The image files used by the visible nodes of the running scene are decoded in parallel, and created before it returns.
+     * The other image files are decoded by worker threads, those in use by a node first, and created in the next frames
+     * within the upload budget of TextureCache::setAsyncUploadBudget().
+     */
     static void reloadAllTextures();
+    /** Whether image files of reloadAllTextures() are still decoded or created in the background. */
+    static bool isReloadingInBackground();
+
+    /**
+     * Sets the bytes of compressed image files (PVRTC, ETC, S3TC, ATITC, ASTC) kept in memory, at most.
+     * Those files are reloaded without reading them again, and don't need decoding.
+     * CC_VOLATILE_TEXTURE_RESIDENT_SIZE by default, a smaller size only applies to the textures added later.
+     */
+    static void setResidentCompressedSize(size_t bytes);
+    /** Gets the bytes of compressed image files kept in memory, at most. */
+    static size_t getResidentCompressedSize();
 public:
     static std::list<VolatileTexture*> _textures;
     static bool _isReloading;
@@ -282,6 +533,16 @@ private:
     // find VolatileTexture by Texture2D*
     // if not found, create a new one
     static VolatileTexture* findVolotileTexture(Texture2D *tt);
+
+    // creates the texture of vt again from what it was created with, image is the decoded file of a kImageFile
+    static void reloadTexture(VolatileTexture *vt, Image *image);
+    // the loop of the reload workers, decodes the queued files before end
+    // the main thread joins it for the textures of the visible nodes
+    static void decodeReloadImages(size_t end);
+    // creates the textures of the decoded files before end, in the order of the reload, for budget ms at most (0: no limit)
+    static void uploadReloadImages(size_t end, float budget);
+    // stops the workers of the reload and drops the files whose texture isn't created yet
+    static void endReload();
 };
 
 #endif
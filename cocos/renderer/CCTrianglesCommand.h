@@ -94,6 +94,9 @@ public:
     inline const Mat4& getModelView() const { return _mv; }
 
 protected:
+    //the render thread of the Renderer draws copies pointing to vertices it owns
+    friend class Renderer;
+
     /**Generate the material ID by textureID, glProgramState, and blend function.*/
     void generateMaterialID();
 
@@ -61,7 +61,7 @@ VertexAttribBinding::~VertexAttribBinding()
 
     if (_handle)
     {
-        glDeleteVertexArrays(1, &_handle);
+        GL::deleteVAO(_handle);
         _handle = 0;
     }
 }
@@ -80,8 +80,8 @@ void VertexAttribBinding::unbind()
     else
     {
         // Software
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        GL::bindBuffer(GL_ARRAY_BUFFER, 0);
+        GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     }
 }
 
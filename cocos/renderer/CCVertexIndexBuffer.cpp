@@ -27,16 +27,18 @@
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventDispatcher.h"
 #include "base/CCDirector.h"
+#include "base/CCConfiguration.h"
+#include "renderer/ccGLStateCache.h"
 
 NS_CC_BEGIN
 
-#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID || CC_TARGET_PLATFORM == CC_PLATFORM_WINRT)
+#if CC_ENABLE_CACHE_TEXTURE_DATA
 bool VertexBuffer::_enableShadowCopy = true;
 #else
 bool VertexBuffer::_enableShadowCopy = false;
 #endif
 
-#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID || CC_TARGET_PLATFORM == CC_PLATFORM_WINRT)
+#if CC_ENABLE_CACHE_TEXTURE_DATA
 bool IndexBuffer::_enableShadowCopy = true;
 #else
 bool IndexBuffer::_enableShadowCopy = false;
@@ -62,7 +64,7 @@ VertexBuffer::VertexBuffer()
 , _vertexNumber(0)
 {
 
-#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID || CC_TARGET_PLATFORM == CC_PLATFORM_WINRT)
+#if CC_ENABLE_CACHE_TEXTURE_DATA
     auto callBack = [this](EventCustom* event)
     {
         this->recreateVBO();
@@ -77,10 +79,10 @@ VertexBuffer::~VertexBuffer()
 {
     if(glIsBuffer(_vbo))
     {
-        glDeleteBuffers(1, &_vbo);
+        GL::deleteBuffers(1, &_vbo);
         _vbo = 0;
     }
-#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID || CC_TARGET_PLATFORM == CC_PLATFORM_WINRT)
+#if CC_ENABLE_CACHE_TEXTURE_DATA
     Director::getInstance()->getEventDispatcher()->removeEventListener(_recreateVBOEventListener);
 #endif
 }
@@ -99,9 +101,9 @@ bool VertexBuffer::init(int sizePerVertex, int vertexNumber, GLenum usage/* = GL
     }
 
     glGenBuffers(1, &_vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-    glBufferData(GL_ARRAY_BUFFER, getSize(), nullptr, _usage);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ARRAY_BUFFER, _vbo);
+    GL::bufferData(GL_ARRAY_BUFFER, getSize(), nullptr, _usage);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
     return true;
 }
 
@@ -136,9 +138,9 @@ bool VertexBuffer::updateVertices(const void* verts, int count, int begin)
         memcpy(&_shadowCopy[begin * _sizePerVertex], verts, count * _sizePerVertex);
     }
 
-    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+    GL::bindBuffer(GL_ARRAY_BUFFER, _vbo);
     glBufferSubData(GL_ARRAY_BUFFER, begin * _sizePerVertex, count * _sizePerVertex, verts);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
 
     return true;
 }
@@ -152,15 +154,15 @@ void VertexBuffer::recreateVBO() const
 {
     CCLOG("come to foreground of VertexBuffer");
     glGenBuffers(1, &_vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+    GL::bindBuffer(GL_ARRAY_BUFFER, _vbo);
     const void* buffer = nullptr;
     if(isShadowCopyEnabled())
     {
         buffer = &_shadowCopy[0];
     }
     CCLOG("recreate IndexBuffer with size %d %d", getSizePerVertex(), _vertexNumber);
-    glBufferData(GL_ARRAY_BUFFER, _sizePerVertex * _vertexNumber, buffer, _usage);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GL::bufferData(GL_ARRAY_BUFFER, _sizePerVertex * _vertexNumber, buffer, _usage);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
     if(!glIsBuffer(_vbo))
     {
         CCLOGERROR("recreate VertexBuffer Error");
@@ -190,7 +192,7 @@ IndexBuffer::IndexBuffer()
 , _indexNumber(0)
 , _recreateVBOEventListener(nullptr)
 {
-#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID || CC_TARGET_PLATFORM == CC_PLATFORM_WINRT)
+#if CC_ENABLE_CACHE_TEXTURE_DATA
     auto callBack = [this](EventCustom* event)
     {
         this->recreateVBO();
@@ -204,10 +206,10 @@ IndexBuffer::~IndexBuffer()
 {
     if(glIsBuffer(_vbo))
     {
-        glDeleteBuffers(1, &_vbo);
+        GL::deleteBuffers(1, &_vbo);
         _vbo = 0;
     }
-#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID || CC_TARGET_PLATFORM == CC_PLATFORM_WINRT)
+#if CC_ENABLE_CACHE_TEXTURE_DATA
     Director::getInstance()->getEventDispatcher()->removeEventListener(_recreateVBOEventListener);
 #endif
 }
@@ -221,9 +223,9 @@ bool IndexBuffer::init(IndexBuffer::IndexType type, int number, GLenum usage/* =
     _usage = usage;
 
     glGenBuffers(1, &_vbo);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _vbo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, getSize(), nullptr, _usage);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _vbo);
+    GL::bufferData(GL_ELEMENT_ARRAY_BUFFER, getSize(), nullptr, _usage);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
     if(isShadowCopyEnabled())
     {
@@ -264,9 +266,9 @@ bool IndexBuffer::updateIndices(const void* indices, int count, int begin)
         count = _indexNumber - begin;
     }
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _vbo);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _vbo);
     glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, begin * getSizePerIndex(), count * getSizePerIndex(), indices);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
     if(isShadowCopyEnabled())
     {
@@ -290,20 +292,269 @@ void IndexBuffer::recreateVBO() const
 {
     CCLOG("come to foreground of IndexBuffer");
     glGenBuffers(1, &_vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+    GL::bindBuffer(GL_ARRAY_BUFFER, _vbo);
     const void* buffer = nullptr;
     if(isShadowCopyEnabled())
     {
         buffer = &_shadowCopy[0];
     }
     CCLOG("recreate IndexBuffer with size %d %d ", getSizePerIndex(), _indexNumber);
-    glBufferData(GL_ARRAY_BUFFER, getSize(), buffer, _usage);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GL::bufferData(GL_ARRAY_BUFFER, getSize(), buffer, _usage);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
     if(!glIsBuffer(_vbo))
     {
         CCLOGERROR("recreate IndexBuffer Error");
     }
 }
 
-NS_CC_END
+StreamBuffer* StreamBuffer::create(GLenum target, GLsizeiptr sizePerFrame)
+{
+    return createWithBuffer(target, 0, sizePerFrame);
+}
+
+StreamBuffer* StreamBuffer::createWithBuffer(GLenum target, GLuint buffer, GLsizeiptr sizePerFrame)
+{
+    auto result = new (std::nothrow) StreamBuffer();
+    if(result && result->init(target, buffer, sizePerFrame))
+    {
+        result->autorelease();
+        return result;
+    }
+    CC_SAFE_DELETE(result);
+    return nullptr;
+}
+
+StreamBuffer::StreamBuffer()
+: _target(GL_ARRAY_BUFFER)
+, _vbo(0)
+, _ownsBuffer(false)
+, _segmentSize(0)
+, _segmentCount(1)
+, _segment(0)
+, _cursor(0)
+, _mapped(nullptr)
+, _mappedSize(0)
+, _needsOrphan(true)
+, _useMapping(false)
+, _recreateVBOEventListener(nullptr)
+{
+#if CC_GL_SYNC_OBJECTS
+    memset(_fences, 0, sizeof(_fences));
+#endif
+}
+
+StreamBuffer::~StreamBuffer()
+{
+    releaseFences();
+    if (_ownsBuffer && _vbo)
+    {
+        GL::deleteBuffers(1, &_vbo);
+    }
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    Director::getInstance()->getEventDispatcher()->removeEventListener(_recreateVBOEventListener);
+#endif
+}
+
+bool StreamBuffer::init(GLenum target, GLuint buffer, GLsizeiptr sizePerFrame)
+{
+    auto conf = Configuration::getInstance();
+    _target = target;
+    _segmentCount = conf->supportsSyncObjects() ? SEGMENT_COUNT : 1;
+    _useMapping = conf->supportsMapBufferRange();
+    resize(sizePerFrame);
+
+    _ownsBuffer = buffer == 0;
+    if (_ownsBuffer)
+    {
+        glGenBuffers(1, &_vbo);
+    }
+    else
+    {
+        _vbo = buffer;
+    }
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    // the content is written again by the next frame
+    _recreateVBOEventListener = Director::getInstance()->getEventDispatcher()->addCustomEventListener(EVENT_RENDERER_RECREATED, [this](EventCustom*){
+        bool ownsBuffer = _ownsBuffer;
+        abandon();
+        if (ownsBuffer)
+        {
+            glGenBuffers(1, &_vbo);
+        }
+    });
+#endif
+    return _vbo != 0;
+}
+
+void StreamBuffer::releaseFences()
+{
+#if CC_GL_SYNC_OBJECTS
+    for (auto& fence : _fences)
+    {
+        if (fence)
+        {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+#endif
+}
+
+void StreamBuffer::abandon()
+{
+#if CC_GL_SYNC_OBJECTS
+    memset(_fences, 0, sizeof(_fences));
+#endif
+    if (_ownsBuffer)
+    {
+        _vbo = 0;
+    }
+    _mapped = nullptr;
+    _mappedSize = 0;
+    _cursor = 0;
+    _needsOrphan = true;
+}
+
+void StreamBuffer::beginFrame()
+{
+    _cursor = 0;
+    if (_segmentCount == 1)
+    {
+        _needsOrphan = true;
+        return;
+    }
+#if CC_GL_SYNC_OBJECTS
+    if (_fences[_segment])
+    {
+        // only blocks when the CPU is SEGMENT_COUNT frames ahead of the GPU
+        glClientWaitSync(_fences[_segment], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+        glDeleteSync(_fences[_segment]);
+        _fences[_segment] = nullptr;
+    }
+#endif
+}
+
+void StreamBuffer::endFrame()
+{
+    if (_segmentCount == 1)
+        return;
+#if CC_GL_SYNC_OBJECTS
+    if (_cursor > 0)
+    {
+        _fences[_segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+#endif
+    _segment = (_segment + 1) % _segmentCount;
+}
+
+void StreamBuffer::resize(GLsizeiptr sizePerFrame)
+{
+    CCASSERT(_mapped == nullptr, "Cannot resize a mapped StreamBuffer");
+    // the segments start on 16 bytes, like the data appended in them
+    _segmentSize = (sizePerFrame + 15) & ~(GLsizeiptr)15;
+    _cursor = 0;
+    _needsOrphan = true;
+}
+
+void StreamBuffer::orphan()
+{
+    GL::bufferData(_target, _segmentSize * _segmentCount, nullptr, GL_DYNAMIC_DRAW);
+    // the fences of the old storage don't guard anything anymore
+    releaseFences();
+    _needsOrphan = false;
+}
 
+void* StreamBuffer::map(GLsizeiptr minSize)
+{
+    CCASSERT(_mapped == nullptr, "StreamBuffer is already mapped");
+    if (!_useMapping)
+        return nullptr;
+
+    if (minSize > _segmentSize)
+    {
+        resize(minSize);
+    }
+    else if (_cursor + minSize > _segmentSize)
+    {
+        // the frame overflowed its segment: get fresh storage from the driver
+        _needsOrphan = true;
+        _cursor = 0;
+    }
+
+    GL::bindBuffer(_target, _vbo);
+    if (_needsOrphan)
+    {
+        orphan();
+    }
+
+    _mappedSize = _segmentSize - _cursor;
+    _mapped = glMapBufferRange(_target, _segment * _segmentSize + _cursor, _mappedSize,
+                               GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (_mapped == nullptr)
+    {
+        _mappedSize = 0;
+    }
+    return _mapped;
+}
+
+GLintptr StreamBuffer::unmap(GLsizeiptr usedSize)
+{
+    GLintptr offset = _segment * _segmentSize + _cursor;
+
+    GL::bindBuffer(_target, _vbo);
+    if (usedSize > 0)
+    {
+        glFlushMappedBufferRange(_target, 0, usedSize);
+    }
+    if (glUnmapBuffer(_target) == GL_FALSE)
+    {
+        CCLOGERROR("StreamBuffer: the content of the buffer was lost");
+    }
+
+    _cursor += usedSize;
+    _mapped = nullptr;
+    _mappedSize = 0;
+    return offset;
+}
+
+GLintptr StreamBuffer::append(const void* data, GLsizeiptr size, GLsizeiptr alignment)
+{
+    CCASSERT(_mapped == nullptr, "Cannot append to a mapped StreamBuffer");
+    _cursor = (_cursor + alignment - 1) & ~(GLintptr)(alignment - 1);
+
+    if (_useMapping)
+    {
+        void* memory = map(size);
+        if (memory)
+        {
+            memcpy(memory, data, size);
+            return unmap(size);
+        }
+        // the writes go through glBufferSubData from now on
+        _useMapping = false;
+    }
+
+    if (size > _segmentSize)
+    {
+        resize(size);
+    }
+    else if (_cursor + size > _segmentSize)
+    {
+        _needsOrphan = true;
+        _cursor = 0;
+    }
+
+    GL::bindBuffer(_target, _vbo);
+    if (_needsOrphan)
+    {
+        orphan();
+    }
+
+    GLintptr offset = _segment * _segmentSize + _cursor;
+    glBufferSubData(_target, offset, size, data);
+    _cursor += size;
+    return offset;
+}
+
+NS_CC_END
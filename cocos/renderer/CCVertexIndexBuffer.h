@@ -255,6 +255,96 @@ public:
     static void enableShadowCopy(bool enabled) { _enableShadowCopy = enabled; }
 };
 
+/**
+StreamBuffer is a buffer object for the data that is written again every frame, e.g. the vertices of a batch.
+A frame sub-allocates from its own segment of the buffer, so it never writes to the storage the GPU may still read
+for the previous frames:
+ - with sync objects, there is a segment per frame in flight, guarded by a fence until the GPU is done with it.
+   beginFrame() only waits when the CPU is SEGMENT_COUNT frames ahead.
+ - without them, there is a single segment whose storage is orphaned once per frame, instead of once per upload.
+The writes go through glMapBufferRange when it's supported, glBufferSubData otherwise.
+The content only lives for a frame, so no shadow copy is kept: the buffer is recreated empty when the context is lost.
+@since v3.11
+@js NA
+@lua NA
+*/
+class CC_DLL StreamBuffer : public Ref
+{
+public:
+    /** The number of segments when the GPU supports sync objects. */
+    static const int SEGMENT_COUNT = 3;
+
+    /**
+    Create a StreamBuffer with a buffer object of its own.
+    @param target GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER.
+    @param sizePerFrame The size in bytes of a segment. A frame that writes more orphans the storage.
+    */
+    static StreamBuffer* create(GLenum target, GLsizeiptr sizePerFrame);
+    /**
+    Create a StreamBuffer that streams through an existing buffer object, which it doesn't delete.
+    */
+    static StreamBuffer* createWithBuffer(GLenum target, GLuint buffer, GLsizeiptr sizePerFrame);
+
+    /** Moves to the segment of the frame, called once per frame before the first write. */
+    void beginFrame();
+    /** Guards the segment of the frame until the GPU is done with it, called once the frame is drawn. */
+    void endFrame();
+
+    /**
+    Copies data after the previous writes of the frame.
+    @param alignment The alignment of the data in the buffer, a power of 2 up to 16, e.g. the size of an index.
+    @return The offset of the data in the buffer, which is left bound to its target.
+    */
+    GLintptr append(const void* data, GLsizeiptr size, GLsizeiptr alignment = 4);
+
+    /**
+    Maps the rest of the segment of the frame to write in place, at least minSize bytes, the storage is orphaned
+    if they don't fit. Returns nullptr if glMapBufferRange isn't supported or fails.
+    */
+    void* map(GLsizeiptr minSize);
+    /** Unmaps the buffer, usedSize bytes were written. Returns their offset in the buffer, which is left bound to its target. */
+    GLintptr unmap(GLsizeiptr usedSize);
+    /** The mapped memory, nullptr when the buffer isn't mapped. */
+    void* getMapped() const { return _mapped; }
+    /** Whether size bytes fit in the mapped memory, true when the buffer isn't mapped. */
+    bool fits(GLsizeiptr size) const { return _mapped == nullptr || size <= _mappedSize; }
+
+    /** Sets the size of the segments, the storage is orphaned by the next write. The buffer must not be mapped. */
+    void resize(GLsizeiptr sizePerFrame);
+    /** The size in bytes of a segment. */
+    GLsizeiptr getSegmentSize() const { return _segmentSize; }
+    /** The buffer object. */
+    GLuint getVBO() const { return _vbo; }
+
+    /** Forgets the buffer object and the fences without deleting them, once the context they belong to is lost. */
+    void abandon();
+
+protected:
+    StreamBuffer();
+    virtual ~StreamBuffer();
+
+    bool init(GLenum target, GLuint buffer, GLsizeiptr sizePerFrame);
+    void releaseFences();
+    void orphan();
+
+    GLenum _target;
+    GLuint _vbo;
+    bool _ownsBuffer;
+    GLsizeiptr _segmentSize;
+    int _segmentCount;
+    int _segment;
+    // next free byte in the current segment
+    GLintptr _cursor;
+    void* _mapped;
+    GLsizeiptr _mappedSize;
+    bool _needsOrphan;
+    bool _useMapping;
+#if CC_GL_SYNC_OBJECTS
+    GLsync _fences[SEGMENT_COUNT];
+#endif
+    EventListenerCustom* _recreateVBOEventListener;
+};
+
 
 NS_CC_END
 
@@ -133,15 +133,15 @@ void VertexData::use()
         // don't call glBindBuffer() if not needed. Expensive operation.
         int vbo = vertexBuffer->getVBO();
         if (vbo != lastVBO) {
-            glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer->getVBO());
+            GL::bindBuffer(GL_ARRAY_BUFFER, vertexBuffer->getVBO());
             lastVBO = vbo;
         }
-        glVertexAttribPointer(GLint(vertexStreamAttrib._semantic),
-                              vertexStreamAttrib._size,
-                              vertexStreamAttrib._type,
-                              vertexStreamAttrib._normalize,
-                              vertexBuffer->getSizePerVertex(),
-                              (GLvoid*)((long)vertexStreamAttrib._offset));
+        GL::vertexAttribPointer(GLint(vertexStreamAttrib._semantic),
+                                vertexStreamAttrib._size,
+                                vertexStreamAttrib._type,
+                                vertexStreamAttrib._normalize,
+                                vertexBuffer->getSizePerVertex(),
+                                (GLvoid*)((long)vertexStreamAttrib._offset));
     }
 }
 
@@ -0,0 +1,211 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "renderer/CCVideoMemory.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "2d/CCFontAtlas.h"
+#include "2d/CCLabel.h"
+#include "2d/CCScene.h"
+#include "base/CCDirector.h"
+#include "base/CCProtocols.h"
+#include "base/CCString.h"
+#include "renderer/CCRenderTargetPool.h"
+#include "renderer/CCTextureCache.h"
+#include "renderer/ccGLStateCache.h"
+
+NS_CC_BEGIN
+
+// the textures the visible nodes draw, a label draws the pages of its font atlas
+static void collectSceneTextures(Node* node, std::unordered_set<Texture2D*>& textures)
+{
+    if (!node->isVisible())
+    {
+        return;
+    }
+
+    auto label = dynamic_cast<Label*>(node);
+    if (label && label->getFontAtlas())
+    {
+        for (auto& page : label->getFontAtlas()->getTextures())
+        {
+            textures.insert(page.second);
+        }
+    }
+    else
+    {
+        auto textureProtocol = dynamic_cast<TextureProtocol*>(node);
+        if (textureProtocol && textureProtocol->getTexture())
+        {
+            textures.insert(textureProtocol->getTexture());
+        }
+    }
+
+    for (auto child : node->getChildren())
+    {
+        collectSceneTextures(child, textures);
+    }
+}
+
+VideoMemory::Report VideoMemory::getReport()
+{
+    auto director = Director::getInstance();
+    auto textureCache = director->getTextureCache();
+
+    Report report;
+    report.textureBytes = 0;
+    report.sceneTextureBytes = 0;
+    report.sceneTextureCount = 0;
+    report.renderTargetBytes = RenderTargetPool::getInstance()->getTotalBytes();
+    report.bufferBytes = GL::getBufferBytes(&report.bufferCount);
+    report.frame = director->getTotalFrames();
+
+    std::unordered_map<Texture2D*, const std::string*> cacheKeys;
+    for (auto& entry : textureCache->_textures)
+    {
+        cacheKeys[entry.second] = &entry.first;
+    }
+
+    std::unordered_set<Texture2D*> sceneTextures;
+    if (director->getRunningScene())
+    {
+        collectSceneTextures(director->getRunningScene(), sceneTextures);
+    }
+
+    std::unordered_map<std::string, size_t> ownerIndices;
+    for (auto texture : Texture2D::getAllTextures())
+    {
+        TextureInfo info;
+        auto cacheKey = cacheKeys.find(texture);
+        if (cacheKey != cacheKeys.end())
+        {
+            info.owner = "TextureCache";
+            info.name = *cacheKey->second;
+        }
+        else
+        {
+            info.owner = texture->getOwner().empty() ? "other" : texture->getOwner();
+            info.name = info.owner;
+        }
+        info.glName = texture->getName();
+        info.pixelsWide = texture->getPixelsWide();
+        info.pixelsHigh = texture->getPixelsHigh();
+        info.pixelFormat = texture->getPixelFormat();
+        auto formatInfo = Texture2D::getPixelFormatInfoMap().find(info.pixelFormat);
+        info.compressed = formatInfo != Texture2D::getPixelFormatInfoMap().end() && formatInfo->second.compressed;
+        info.mipmaps = texture->hasMipmaps();
+        info.residentLevel = texture->getResidentLevel();
+        info.bytes = texture->getMemoryBytes();
+        info.referenceCount = texture->getReferenceCount();
+        auto cacheEntry = textureCache->_cacheEntries.find(texture);
+        info.lastUsedFrame = cacheEntry != textureCache->_cacheEntries.end() ? cacheEntry->second.lastUsedFrame : 0;
+        info.inScene = sceneTextures.count(texture) > 0;
+
+        report.textureBytes += info.bytes;
+        if (info.inScene)
+        {
+            report.sceneTextureBytes += info.bytes;
+            ++report.sceneTextureCount;
+        }
+
+        auto ownerIndex = ownerIndices.find(info.owner);
+        if (ownerIndex == ownerIndices.end())
+        {
+            ownerIndex = ownerIndices.emplace(info.owner, report.owners.size()).first;
+            OwnerInfo owner = { info.owner, 0, 0 };
+            report.owners.push_back(owner);
+        }
+        ++report.owners[ownerIndex->second].textureCount;
+        report.owners[ownerIndex->second].bytes += info.bytes;
+
+        report.textures.push_back(std::move(info));
+    }
+
+    std::sort(report.textures.begin(), report.textures.end(), [](const TextureInfo& a, const TextureInfo& b) {
+        return a.bytes > b.bytes;
+    });
+    std::sort(report.owners.begin(), report.owners.end(), [](const OwnerInfo& a, const OwnerInfo& b) {
+        return a.bytes > b.bytes;
+    });
+    return report;
+}
+
+std::string VideoMemory::getDescription(const Report& report, bool sceneOnly, size_t limit)
+{
+    std::string description = StringUtils::format("VideoMemory at frame %u: textures %.2f KB (%u), scene %.2f KB (%u), render targets %.2f KB, buffers %.2f KB (%u)\n",
+                                                  report.frame,
+                                                  report.textureBytes / 1024.0f, (unsigned int)report.textures.size(),
+                                                  report.sceneTextureBytes / 1024.0f, report.sceneTextureCount,
+                                                  report.renderTargetBytes / 1024.0f,
+                                                  report.bufferBytes / 1024.0f, report.bufferCount);
+    for (auto& owner : report.owners)
+    {
+        description += StringUtils::format("  %s: %u textures for %.2f KB\n", owner.owner.c_str(), owner.textureCount, owner.bytes / 1024.0f);
+    }
+
+    size_t listed = 0;
+    for (auto& texture : report.textures)
+    {
+        if (sceneOnly && !texture.inScene)
+        {
+            continue;
+        }
+        if (limit > 0 && listed == limit)
+        {
+            description += "  ...\n";
+            break;
+        }
+        ++listed;
+
+        std::string flags;
+        if (texture.compressed)
+        {
+            flags += " compressed";
+        }
+        if (texture.mipmaps)
+        {
+            flags += " mipmaps";
+        }
+        if (texture.residentLevel > 0)
+        {
+            flags += StringUtils::format(" resident=%d", texture.residentLevel);
+        }
+        if (texture.inScene)
+        {
+            flags += " scene";
+        }
+        auto formatInfo = Texture2D::getPixelFormatInfoMap().find(texture.pixelFormat);
+        int bpp = formatInfo != Texture2D::getPixelFormatInfoMap().end() ? formatInfo->second.bpp : 0;
+        description += StringUtils::format("\"%s\" id=%u %dx%d @ %d bpp rc=%u frame=%u => %.2f KB%s\n",
+                                           texture.name.c_str(), texture.glName, texture.pixelsWide, texture.pixelsHigh,
+                                           bpp, texture.referenceCount, texture.lastUsedFrame, texture.bytes / 1024.0f,
+                                           flags.c_str());
+    }
+    return description;
+}
+
+NS_CC_END
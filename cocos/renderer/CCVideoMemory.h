@@ -0,0 +1,124 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_VIDEO_MEMORY_H__
+#define __CC_VIDEO_MEMORY_H__
+
+#include <string>
+#include <vector>
+
+#include "renderer/CCTexture2D.h"
+
+/**
+ * @addtogroup renderer
+ * @{
+ */
+
+NS_CC_BEGIN
+
+/**
+ VideoMemory reports what the textures and the buffers take in video memory, to check a scene against a budget.
+
+ Every texture alive is reported with its bytes in its pixel format, counting its mipmaps and the whole blocks of
+ the compressed formats, and with who owns it: "TextureCache" for the cached ones, the owner set with
+ Texture2D::setOwner() such as "FontAtlas", "RenderTexture" or "RenderTargetPool", "other" for the rest. The
+ textures drawn by the running scene, from the nodes with a texture and the font atlases of the labels, are its
+ share. The buffers are the ones filled through GL::bufferData().
+
+ It walks every texture and the scene, meant for the tools: the console command "vram" and cc.getVideoMemory() in Lua.
+ @since v3.11
+ @js NA
+ */
+class CC_DLL VideoMemory
+{
+public:
+    /** A texture of the report. */
+    struct TextureInfo
+    {
+        /** The key in the TextureCache, otherwise the owner. */
+        std::string name;
+        std::string owner;
+        GLuint glName;
+        int pixelsWide;
+        int pixelsHigh;
+        Texture2D::PixelFormat pixelFormat;
+        bool compressed;
+        bool mipmaps;
+        /** The finest level in memory, above 0 when a streamed texture dropped its finest levels. */
+        int residentLevel;
+        size_t bytes;
+        unsigned int referenceCount;
+        /** The frame the TextureCache last gave the texture out, 0 when it isn't cached. */
+        unsigned int lastUsedFrame;
+        /** Whether the running scene draws it. */
+        bool inScene;
+    };
+
+    /** The bytes of the textures of an owner. */
+    struct OwnerInfo
+    {
+        std::string owner;
+        unsigned int textureCount;
+        size_t bytes;
+    };
+
+    struct Report
+    {
+        /** The textures, the largest first. */
+        std::vector<TextureInfo> textures;
+        /** The owners, the largest first. */
+        std::vector<OwnerInfo> owners;
+        size_t textureBytes;
+        /** The bytes of the textures the running scene draws. */
+        size_t sceneTextureBytes;
+        unsigned int sceneTextureCount;
+        /** The textures and renderbuffers of the RenderTargetPool, borrowed or not. */
+        size_t renderTargetBytes;
+        /** The vertex and index buffers. */
+        size_t bufferBytes;
+        unsigned int bufferCount;
+        /** The frame the report was made in. */
+        unsigned int frame;
+    };
+
+    /** Makes a report, on the main thread. */
+    static Report getReport();
+
+    /**
+     Describes a report for the console: the totals and the owners, then the textures.
+     @param report The report.
+     @param sceneOnly Whether only the textures of the running scene are listed.
+     @param limit The most textures listed, the largest, 0 for all of them.
+     */
+    static std::string getDescription(const Report& report, bool sceneOnly = false, size_t limit = 0);
+};
+
+NS_CC_END
+
+/**
+ end of support group
+ @}
+ */
+
+#endif // __CC_VIDEO_MEMORY_H__
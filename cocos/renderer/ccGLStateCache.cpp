@@ -27,6 +27,10 @@ THE SOFTWARE.
 
 #include "renderer/ccGLStateCache.h"
 
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+
 #include "renderer/CCGLProgram.h"
 #include "renderer/CCRenderState.h"
 #include "base/CCDirector.h"
@@ -38,31 +42,114 @@ NS_CC_BEGIN
 static const int MAX_ATTRIBUTES = 16;
 static const int MAX_ACTIVE_TEXTURE = 16;
 
+// The cache is per thread: with the render thread the main thread uses a context of its own,
+// see Renderer::setRenderThreadEnabled().
 namespace
 {
-    static GLuint s_currentProjectionMatrix = -1;
-    static uint32_t s_attributeFlags = 0;  // 32 attributes max
+    static thread_local GLuint s_currentProjectionMatrix = -1;
+    static thread_local uint32_t s_attributeFlags = 0;  // 32 attributes max
+    static thread_local GL::StateCacheStats s_stats = { 0, 0 };
 
 #if CC_ENABLE_GL_STATE_CACHE
 
-    static GLuint    s_currentShaderProgram = -1;
-    static GLuint    s_currentBoundTexture[MAX_ACTIVE_TEXTURE] =  {(GLuint)-1,(GLuint)-1,(GLuint)-1,(GLuint)-1, (GLuint)-1,(GLuint)-1,(GLuint)-1,(GLuint)-1, (GLuint)-1,(GLuint)-1,(GLuint)-1,(GLuint)-1, (GLuint)-1,(GLuint)-1,(GLuint)-1,(GLuint)-1, };
-    static GLenum    s_blendingSource = -1;
-    static GLenum    s_blendingDest = -1;
-    static int       s_GLServerState = 0;
-    static GLuint    s_VAO = 0;
-    static GLenum    s_activeTexture = -1;
+    // the cached capabilities, a bit each in s_capabilitiesKnown and s_capabilitiesEnabled
+    enum
+    {
+        CAP_BLEND           = 1 << 0,
+        CAP_CULL_FACE       = 1 << 1,
+        CAP_DEPTH_TEST      = 1 << 2,
+        CAP_SCISSOR_TEST    = 1 << 3,
+        CAP_STENCIL_TEST    = 1 << 4,
+    };
+
+    // a vertex attrib pointer of the default vertex array, size is 0 when it isn't known
+    struct VertexAttribPointer
+    {
+        GLuint buffer;
+        GLint size;
+        GLenum type;
+        GLboolean normalized;
+        GLsizei stride;
+        const GLvoid* pointer;
+    };
+
+    static thread_local GLuint    s_currentShaderProgram = -1;
+    static thread_local GLuint    s_currentBoundTexture[MAX_ACTIVE_TEXTURE] =  {(GLuint)-1,(GLuint)-1,(GLuint)-1,(GLuint)-1, (GLuint)-1,(GLuint)-1,(GLuint)-1,(GLuint)-1, (GLuint)-1,(GLuint)-1,(GLuint)-1,(GLuint)-1, (GLuint)-1,(GLuint)-1,(GLuint)-1,(GLuint)-1, };
+    static thread_local GLenum    s_blendingSource = -1;
+    static thread_local GLenum    s_blendingDest = -1;
+    // the blend func set in GL, blendFunc(GL_ONE, GL_ZERO) disables the blending without setting it
+    static thread_local GLenum    s_blendFuncSource = -1;
+    static thread_local GLenum    s_blendFuncDest = -1;
+    static thread_local GLuint    s_VAO = 0;
+    static thread_local GLenum    s_activeTexture = -1;
+    static thread_local GLuint    s_arrayBuffer = -1;
+    static thread_local GLuint    s_elementArrayBuffer = -1;
+    static thread_local VertexAttribPointer s_attribPointers[MAX_ATTRIBUTES];
+    static thread_local unsigned int s_capabilitiesKnown = 0;
+    static thread_local unsigned int s_capabilitiesEnabled = 0;
+    static thread_local GLint     s_depthMask = -1;
+    static thread_local GLenum    s_depthFunc = -1;
+    static thread_local GLenum    s_cullFace = -1;
+    static thread_local GLenum    s_frontFace = -1;
+    static thread_local GLenum    s_stencilFunc = -1;
+    static thread_local GLint     s_stencilRef = 0;
+    static thread_local GLuint    s_stencilValueMask = 0;
+    static thread_local GLenum    s_stencilFail = -1;
+    static thread_local GLenum    s_stencilPassDepthFail = -1;
+    static thread_local GLenum    s_stencilPassDepthPass = -1;
+    static thread_local bool      s_stencilMaskKnown = false;
+    static thread_local GLuint    s_stencilMask = 0;
+    static thread_local GLint     s_viewport[4] = { 0, 0, -1, -1 };
+    static thread_local GLint     s_scissorBox[4] = { 0, 0, -1, -1 };
+
+    unsigned int capabilityBit(GLenum cap)
+    {
+        switch (cap)
+        {
+            case GL_BLEND:          return CAP_BLEND;
+            case GL_CULL_FACE:      return CAP_CULL_FACE;
+            case GL_DEPTH_TEST:     return CAP_DEPTH_TEST;
+            case GL_SCISSOR_TEST:   return CAP_SCISSOR_TEST;
+            case GL_STENCIL_TEST:   return CAP_STENCIL_TEST;
+            default:                return 0;
+        }
+    }
 
 #endif // CC_ENABLE_GL_STATE_CACHE
+
+    inline void issued()
+    {
+        ++s_stats.issued;
+    }
+
+    inline void skipped()
+    {
+        ++s_stats.skipped;
+    }
 }
 
 // GL State Cache functions
 
 namespace GL {
 
+// the bytes of the buffers filled by bufferData(), by name. The buffers are shared by the contexts of the threads
+static std::mutex s_bufferMutex;
+static std::unordered_map<GLuint, size_t> s_bufferBytes;
+static size_t s_totalBufferBytes = 0;
+
 void invalidateStateCache( void )
 {
     Director::DirectorInstance->resetMatrixStack();
+    invalidateContextStateCache();
+
+    // the context was lost or the director is reset, every buffer is gone
+    std::lock_guard<std::mutex> lock(s_bufferMutex);
+    s_bufferBytes.clear();
+    s_totalBufferBytes = 0;
+}
+
+void invalidateContextStateCache()
+{
     s_currentProjectionMatrix = -1;
     s_attributeFlags = 0;
 
@@ -75,12 +162,50 @@ void invalidateStateCache( void )
 
     s_blendingSource = -1;
     s_blendingDest = -1;
-    s_GLServerState = 0;
+    s_blendFuncSource = -1;
+    s_blendFuncDest = -1;
     s_VAO = 0;
+    s_activeTexture = -1;
+
+    s_arrayBuffer = -1;
+    s_elementArrayBuffer = -1;
+    for (int i = 0; i < MAX_ATTRIBUTES; i++)
+    {
+        s_attribPointers[i].size = 0;
+    }
+
+    s_capabilitiesKnown = 0;
+    s_depthMask = -1;
+    s_depthFunc = -1;
+    s_cullFace = -1;
+    s_frontFace = -1;
+    s_stencilFunc = -1;
+    s_stencilFail = -1;
+    s_stencilMaskKnown = false;
+    s_viewport[2] = s_viewport[3] = -1;
+    s_scissorBox[2] = s_scissorBox[3] = -1;
 
 #endif // CC_ENABLE_GL_STATE_CACHE
 }
 
+void invalidateSharedObjectBindings()
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    s_currentShaderProgram = -1;
+    for (int i = 0; i < MAX_ACTIVE_TEXTURE; i++)
+    {
+        s_currentBoundTexture[i] = -1;
+    }
+
+    s_arrayBuffer = -1;
+    s_elementArrayBuffer = -1;
+    for (int i = 0; i < MAX_ATTRIBUTES; i++)
+    {
+        s_attribPointers[i].size = 0;
+    }
+#endif // CC_ENABLE_GL_STATE_CACHE
+}
+
 void deleteProgram( GLuint program )
 {
 #if CC_ENABLE_GL_STATE_CACHE
@@ -96,26 +221,44 @@ void deleteProgram( GLuint program )
 void useProgram( GLuint program )
 {
 #if CC_ENABLE_GL_STATE_CACHE
-    if( program != s_currentShaderProgram ) {
-        s_currentShaderProgram = program;
-        glUseProgram(program);
+    if (program == s_currentShaderProgram)
+    {
+        skipped();
+        return;
     }
-#else
-    glUseProgram(program);
+    s_currentShaderProgram = program;
 #endif // CC_ENABLE_GL_STATE_CACHE
+
+    issued();
+    glUseProgram(program);
 }
 
 static void SetBlending(GLenum sfactor, GLenum dfactor)
 {
     if (sfactor == GL_ONE && dfactor == GL_ZERO)
     {
-        glDisable(GL_BLEND);
+        disable(GL_BLEND);
         RenderState::StateBlock::_defaultState->setBlend(false);
     }
     else
     {
-        glEnable(GL_BLEND);
+        enable(GL_BLEND);
+#if CC_ENABLE_GL_STATE_CACHE
+        if (sfactor == s_blendFuncSource && dfactor == s_blendFuncDest)
+        {
+            skipped();
+        }
+        else
+        {
+            s_blendFuncSource = sfactor;
+            s_blendFuncDest = dfactor;
+            issued();
+            glBlendFunc(sfactor, dfactor);
+        }
+#else
+        issued();
         glBlendFunc(sfactor, dfactor);
+#endif // CC_ENABLE_GL_STATE_CACHE
 
         RenderState::StateBlock::_defaultState->setBlend(true);
         RenderState::StateBlock::_defaultState->setBlendSrc((RenderState::Blend)sfactor);
@@ -126,21 +269,26 @@ static void SetBlending(GLenum sfactor, GLenum dfactor)
 void blendFunc(GLenum sfactor, GLenum dfactor)
 {
 #if CC_ENABLE_GL_STATE_CACHE
-    if (sfactor != s_blendingSource || dfactor != s_blendingDest)
+    if (sfactor == s_blendingSource && dfactor == s_blendingDest)
     {
-        s_blendingSource = sfactor;
-        s_blendingDest = dfactor;
-        SetBlending(sfactor, dfactor);
+        skipped();
+        return;
     }
-#else
-    SetBlending( sfactor, dfactor );
+    s_blendingSource = sfactor;
+    s_blendingDest = dfactor;
 #endif // CC_ENABLE_GL_STATE_CACHE
+
+    SetBlending(sfactor, dfactor);
 }
 
 void blendResetToCache()
 {
+    issued();
     glBlendEquation(GL_FUNC_ADD);
 #if CC_ENABLE_GL_STATE_CACHE
+    // the blend func was changed around the cache, glBlendFuncSeparate() for instance
+    s_blendFuncSource = -1;
+    s_blendFuncDest = -1;
     SetBlending(s_blendingSource, s_blendingDest);
 #else
     SetBlending(CC_BLEND_SRC, CC_BLEND_DST);
@@ -154,34 +302,24 @@ void bindTexture2D(GLuint textureId)
 
 void bindTexture2DN(GLuint textureUnit, GLuint textureId)
 {
-#if CC_ENABLE_GL_STATE_CACHE
-    CCASSERT(textureUnit < MAX_ACTIVE_TEXTURE, "textureUnit is too big");
-    if (s_currentBoundTexture[textureUnit] != textureId)
-    {
-        s_currentBoundTexture[textureUnit] = textureId;
-        activeTexture(GL_TEXTURE0 + textureUnit);
-        glBindTexture(GL_TEXTURE_2D, textureId);
-    }
-#else
-    glActiveTexture(GL_TEXTURE0 + textureUnit);
-    glBindTexture(GL_TEXTURE_2D, textureId);
-#endif
+    bindTextureN(textureUnit, textureId, GL_TEXTURE_2D);
 }
 
 void bindTextureN(GLuint textureUnit, GLuint textureId, GLuint textureType/* = GL_TEXTURE_2D*/)
 {
 #if CC_ENABLE_GL_STATE_CACHE
     CCASSERT(textureUnit < MAX_ACTIVE_TEXTURE, "textureUnit is too big");
-    if (s_currentBoundTexture[textureUnit] != textureId)
+    if (s_currentBoundTexture[textureUnit] == textureId)
     {
-        s_currentBoundTexture[textureUnit] = textureId;
-        activeTexture(GL_TEXTURE0 + textureUnit);
-        glBindTexture(textureType, textureId);
+        skipped();
+        return;
     }
-#else
-    glActiveTexture(GL_TEXTURE0 + textureUnit);
+    s_currentBoundTexture[textureUnit] = textureId;
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    activeTexture(GL_TEXTURE0 + textureUnit);
+    issued();
     glBindTexture(textureType, textureId);
-#endif
 }
 
 
@@ -208,35 +346,186 @@ void deleteTextureN(GLuint textureUnit, GLuint textureId)
 void activeTexture(GLenum texture)
 {
 #if CC_ENABLE_GL_STATE_CACHE
-    if(s_activeTexture != texture) {
-        s_activeTexture = texture;
-        glActiveTexture(s_activeTexture);
+    if (s_activeTexture == texture)
+    {
+        skipped();
+        return;
     }
-#else
+    s_activeTexture = texture;
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    issued();
     glActiveTexture(texture);
-#endif
 }
 
 void bindVAO(GLuint vaoId)
 {
-    if (Configuration::getInstance()->supportsShareableVAO())
+    if (!Configuration::getInstance()->supportsShareableVAO())
     {
+        return;
+    }
 
 #if CC_ENABLE_GL_STATE_CACHE
-        if (s_VAO != vaoId)
+    if (s_VAO == vaoId)
+    {
+        skipped();
+        return;
+    }
+    s_VAO = vaoId;
+    // the element array buffer binding belongs to the vertex array
+    s_elementArrayBuffer = -1;
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    issued();
+    glBindVertexArray(vaoId);
+}
+
+void deleteVAO(GLuint vaoId)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    if (vaoId == s_VAO)
+    {
+        // GL binds the default vertex array back
+        s_VAO = 0;
+        s_elementArrayBuffer = -1;
+    }
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    glDeleteVertexArrays(1, &vaoId);
+}
+
+// GL Buffer functions
+
+void bindBuffer(GLenum target, GLuint buffer)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    GLuint* binding = nullptr;
+    if (target == GL_ARRAY_BUFFER)
+    {
+        binding = &s_arrayBuffer;
+    }
+    else if (target == GL_ELEMENT_ARRAY_BUFFER)
+    {
+        binding = &s_elementArrayBuffer;
+    }
+
+    if (binding)
+    {
+        if (*binding == buffer)
         {
-            s_VAO = vaoId;
-            glBindVertexArray(vaoId);
+            skipped();
+            return;
         }
-#else
-        glBindVertexArray(vaoId);
+        *binding = buffer;
+    }
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    issued();
+    glBindBuffer(target, buffer);
+}
+
+void deleteBuffers(GLsizei n, const GLuint* buffers)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    // GL unbinds the deleted buffers, and a new buffer can get the same name
+    for (GLsizei i = 0; i < n; ++i)
+    {
+        if (s_arrayBuffer == buffers[i])
+        {
+            s_arrayBuffer = 0;
+        }
+        if (s_elementArrayBuffer == buffers[i])
+        {
+            s_elementArrayBuffer = 0;
+        }
+        for (int j = 0; j < MAX_ATTRIBUTES; j++)
+        {
+            if (s_attribPointers[j].buffer == buffers[i])
+            {
+                s_attribPointers[j].size = 0;
+            }
+        }
+    }
 #endif // CC_ENABLE_GL_STATE_CACHE
 
+    {
+        std::lock_guard<std::mutex> lock(s_bufferMutex);
+        for (GLsizei i = 0; i < n; ++i)
+        {
+            auto it = s_bufferBytes.find(buffers[i]);
+            if (it != s_bufferBytes.end())
+            {
+                s_totalBufferBytes -= it->second;
+                s_bufferBytes.erase(it);
+            }
+        }
+    }
+
+    glDeleteBuffers(n, buffers);
+}
+
+void bufferData(GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    GLuint buffer = target == GL_ARRAY_BUFFER ? s_arrayBuffer : target == GL_ELEMENT_ARRAY_BUFFER ? s_elementArrayBuffer : (GLuint)-1;
+    if (buffer != 0 && buffer != (GLuint)-1)
+    {
+        std::lock_guard<std::mutex> lock(s_bufferMutex);
+        size_t& bytes = s_bufferBytes[buffer];
+        s_totalBufferBytes = s_totalBufferBytes - bytes + (size_t)size;
+        bytes = (size_t)size;
     }
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    glBufferData(target, size, data, usage);
+}
+
+size_t getBufferBytes(unsigned int* count)
+{
+    std::lock_guard<std::mutex> lock(s_bufferMutex);
+    if (count)
+    {
+        *count = (unsigned int)s_bufferBytes.size();
+    }
+    return s_totalBufferBytes;
 }
 
 // GL Vertex Attrib functions
 
+void vertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    // the pointers of the other vertex arrays are set once, when they are created
+    if (s_VAO == 0 && index < MAX_ATTRIBUTES)
+    {
+        auto& current = s_attribPointers[index];
+        if (s_arrayBuffer == (GLuint)-1)
+        {
+            // the buffer the pointer refers to isn't known
+            current.size = 0;
+        }
+        else if (current.size == size && current.buffer == s_arrayBuffer && current.type == type &&
+                 current.normalized == normalized && current.stride == stride && current.pointer == pointer)
+        {
+            skipped();
+            return;
+        }
+        else
+        {
+            current.buffer = s_arrayBuffer;
+            current.size = size;
+            current.type = type;
+            current.normalized = normalized;
+            current.stride = stride;
+            current.pointer = pointer;
+        }
+    }
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    issued();
+    glVertexAttribPointer(index, size, type, normalized, stride, pointer);
+}
+
 void enableVertexAttribs(uint32_t flags)
 {
     bindVAO(0);
@@ -249,6 +538,7 @@ void enableVertexAttribs(uint32_t flags)
         bool enabledBefore = (s_attributeFlags & bit) != 0;
         if(enabled != enabledBefore)
         {
+            issued();
             if( enabled )
                 glEnableVertexAttribArray(i);
             else
@@ -258,6 +548,509 @@ void enableVertexAttribs(uint32_t flags)
     s_attributeFlags = flags;
 }
 
+// GL Server State functions
+
+void setEnabled(GLenum cap, bool enabled)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    unsigned int bit = capabilityBit(cap);
+    if (bit)
+    {
+        if ((s_capabilitiesKnown & bit) && ((s_capabilitiesEnabled & bit) != 0) == enabled)
+        {
+            skipped();
+            return;
+        }
+        s_capabilitiesKnown |= bit;
+        if (enabled)
+            s_capabilitiesEnabled |= bit;
+        else
+            s_capabilitiesEnabled &= ~bit;
+    }
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    issued();
+    if (enabled)
+        glEnable(cap);
+    else
+        glDisable(cap);
+}
+
+void enable(GLenum cap)
+{
+    setEnabled(cap, true);
+}
+
+void disable(GLenum cap)
+{
+    setEnabled(cap, false);
+}
+
+bool isEnabled(GLenum cap)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    unsigned int bit = capabilityBit(cap);
+    if (s_capabilitiesKnown & bit)
+    {
+        skipped();
+        return (s_capabilitiesEnabled & bit) != 0;
+    }
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    issued();
+    bool enabled = glIsEnabled(cap) != GL_FALSE;
+
+#if CC_ENABLE_GL_STATE_CACHE
+    if (bit)
+    {
+        s_capabilitiesKnown |= bit;
+        if (enabled)
+            s_capabilitiesEnabled |= bit;
+        else
+            s_capabilitiesEnabled &= ~bit;
+    }
+#endif // CC_ENABLE_GL_STATE_CACHE
+    return enabled;
+}
+
+void depthMask(GLboolean flag)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_depthMask == flag)
+    {
+        skipped();
+        return;
+    }
+    s_depthMask = flag;
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    issued();
+    glDepthMask(flag);
+}
+
+GLboolean getDepthMask()
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_depthMask != -1)
+    {
+        skipped();
+        return (GLboolean)s_depthMask;
+    }
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    GLboolean flag = GL_TRUE;
+    issued();
+    glGetBooleanv(GL_DEPTH_WRITEMASK, &flag);
+#if CC_ENABLE_GL_STATE_CACHE
+    s_depthMask = flag;
+#endif // CC_ENABLE_GL_STATE_CACHE
+    return flag;
+}
+
+void depthFunc(GLenum func)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_depthFunc == func)
+    {
+        skipped();
+        return;
+    }
+    s_depthFunc = func;
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    issued();
+    glDepthFunc(func);
+}
+
+void cullFace(GLenum mode)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_cullFace == mode)
+    {
+        skipped();
+        return;
+    }
+    s_cullFace = mode;
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    issued();
+    glCullFace(mode);
+}
+
+void frontFace(GLenum mode)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_frontFace == mode)
+    {
+        skipped();
+        return;
+    }
+    s_frontFace = mode;
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    issued();
+    glFrontFace(mode);
+}
+
+void stencilFunc(GLenum func, GLint ref, GLuint mask)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_stencilFunc == func && s_stencilRef == ref && s_stencilValueMask == mask)
+    {
+        skipped();
+        return;
+    }
+    s_stencilFunc = func;
+    s_stencilRef = ref;
+    s_stencilValueMask = mask;
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    issued();
+    glStencilFunc(func, ref, mask);
+}
+
+void getStencilFunc(GLenum* func, GLint* ref, GLuint* mask)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_stencilFunc != (GLenum)-1)
+    {
+        skipped();
+        *func = s_stencilFunc;
+        *ref = s_stencilRef;
+        *mask = s_stencilValueMask;
+        return;
+    }
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    issued();
+    glGetIntegerv(GL_STENCIL_FUNC, (GLint*)func);
+    glGetIntegerv(GL_STENCIL_REF, ref);
+    glGetIntegerv(GL_STENCIL_VALUE_MASK, (GLint*)mask);
+#if CC_ENABLE_GL_STATE_CACHE
+    s_stencilFunc = *func;
+    s_stencilRef = *ref;
+    s_stencilValueMask = *mask;
+#endif // CC_ENABLE_GL_STATE_CACHE
+}
+
+void stencilOp(GLenum sfail, GLenum dpfail, GLenum dppass)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_stencilFail == sfail && s_stencilPassDepthFail == dpfail && s_stencilPassDepthPass == dppass)
+    {
+        skipped();
+        return;
+    }
+    s_stencilFail = sfail;
+    s_stencilPassDepthFail = dpfail;
+    s_stencilPassDepthPass = dppass;
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    issued();
+    glStencilOp(sfail, dpfail, dppass);
+}
+
+void getStencilOp(GLenum* sfail, GLenum* dpfail, GLenum* dppass)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_stencilFail != (GLenum)-1)
+    {
+        skipped();
+        *sfail = s_stencilFail;
+        *dpfail = s_stencilPassDepthFail;
+        *dppass = s_stencilPassDepthPass;
+        return;
+    }
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    issued();
+    glGetIntegerv(GL_STENCIL_FAIL, (GLint*)sfail);
+    glGetIntegerv(GL_STENCIL_PASS_DEPTH_FAIL, (GLint*)dpfail);
+    glGetIntegerv(GL_STENCIL_PASS_DEPTH_PASS, (GLint*)dppass);
+#if CC_ENABLE_GL_STATE_CACHE
+    s_stencilFail = *sfail;
+    s_stencilPassDepthFail = *dpfail;
+    s_stencilPassDepthPass = *dppass;
+#endif // CC_ENABLE_GL_STATE_CACHE
+}
+
+void stencilMask(GLuint mask)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_stencilMaskKnown && s_stencilMask == mask)
+    {
+        skipped();
+        return;
+    }
+    s_stencilMaskKnown = true;
+    s_stencilMask = mask;
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    issued();
+    glStencilMask(mask);
+}
+
+GLuint getStencilMask()
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_stencilMaskKnown)
+    {
+        skipped();
+        return s_stencilMask;
+    }
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    GLuint mask = 0;
+    issued();
+    glGetIntegerv(GL_STENCIL_WRITEMASK, (GLint*)&mask);
+#if CC_ENABLE_GL_STATE_CACHE
+    s_stencilMaskKnown = true;
+    s_stencilMask = mask;
+#endif // CC_ENABLE_GL_STATE_CACHE
+    return mask;
+}
+
+void viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_viewport[0] == x && s_viewport[1] == y && s_viewport[2] == width && s_viewport[3] == height)
+    {
+        skipped();
+        return;
+    }
+    s_viewport[0] = x;
+    s_viewport[1] = y;
+    s_viewport[2] = width;
+    s_viewport[3] = height;
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    issued();
+    glViewport(x, y, width, height);
+}
+
+void getViewport(GLint viewport[4])
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_viewport[2] >= 0)
+    {
+        skipped();
+        for (int i = 0; i < 4; i++)
+        {
+            viewport[i] = s_viewport[i];
+        }
+        return;
+    }
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    issued();
+    glGetIntegerv(GL_VIEWPORT, viewport);
+#if CC_ENABLE_GL_STATE_CACHE
+    for (int i = 0; i < 4; i++)
+    {
+        s_viewport[i] = viewport[i];
+    }
+#endif // CC_ENABLE_GL_STATE_CACHE
+}
+
+void scissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_scissorBox[0] == x && s_scissorBox[1] == y && s_scissorBox[2] == width && s_scissorBox[3] == height)
+    {
+        skipped();
+        return;
+    }
+    s_scissorBox[0] = x;
+    s_scissorBox[1] = y;
+    s_scissorBox[2] = width;
+    s_scissorBox[3] = height;
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    issued();
+    glScissor(x, y, width, height);
+}
+
+void getScissorBox(GLint box[4])
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_scissorBox[2] >= 0)
+    {
+        skipped();
+        for (int i = 0; i < 4; i++)
+        {
+            box[i] = s_scissorBox[i];
+        }
+        return;
+    }
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    issued();
+    glGetIntegerv(GL_SCISSOR_BOX, box);
+#if CC_ENABLE_GL_STATE_CACHE
+    for (int i = 0; i < 4; i++)
+    {
+        s_scissorBox[i] = box[i];
+    }
+#endif // CC_ENABLE_GL_STATE_CACHE
+}
+
+// GL State Cache stats
+
+StateCacheStats getStateCacheStats()
+{
+    return s_stats;
+}
+
+void resetStateCacheStats()
+{
+    s_stats.issued = 0;
+    s_stats.skipped = 0;
+}
+
+#if CC_ENABLE_GL_STATE_CACHE
+
+static void checkState(bool matches, const char* name)
+{
+    if (!matches)
+    {
+        CCLOGERROR("GL state cache: %s differs from the GL state, a GL call bypassed the cache", name);
+        CCASSERT(false, "The GL state cache is out of sync, see GL::validateStateCache()");
+    }
+}
+
+static GLint getInteger(GLenum name)
+{
+    GLint value = 0;
+    glGetIntegerv(name, &value);
+    return value;
+}
+
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+void validateStateCache()
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_currentShaderProgram != (GLuint)-1)
+    {
+        checkState((GLuint)getInteger(GL_CURRENT_PROGRAM) == s_currentShaderProgram, "the program");
+    }
+    if (s_activeTexture != (GLenum)-1)
+    {
+        checkState((GLenum)getInteger(GL_ACTIVE_TEXTURE) == s_activeTexture, "the active texture unit");
+    }
+    if (s_blendFuncSource != (GLenum)-1)
+    {
+        checkState((GLenum)getInteger(GL_BLEND_SRC_RGB) == s_blendFuncSource &&
+                   (GLenum)getInteger(GL_BLEND_DST_RGB) == s_blendFuncDest, "the blend func");
+    }
+
+    static const struct { GLenum cap; unsigned int bit; const char* name; } capabilities[] = {
+        { GL_BLEND, CAP_BLEND, "GL_BLEND" },
+        { GL_CULL_FACE, CAP_CULL_FACE, "GL_CULL_FACE" },
+        { GL_DEPTH_TEST, CAP_DEPTH_TEST, "GL_DEPTH_TEST" },
+        { GL_SCISSOR_TEST, CAP_SCISSOR_TEST, "GL_SCISSOR_TEST" },
+        { GL_STENCIL_TEST, CAP_STENCIL_TEST, "GL_STENCIL_TEST" },
+    };
+    for (const auto& capability : capabilities)
+    {
+        if (s_capabilitiesKnown & capability.bit)
+        {
+            checkState((glIsEnabled(capability.cap) != GL_FALSE) == ((s_capabilitiesEnabled & capability.bit) != 0), capability.name);
+        }
+    }
+
+    if (s_depthMask != -1)
+    {
+        GLboolean flag = GL_TRUE;
+        glGetBooleanv(GL_DEPTH_WRITEMASK, &flag);
+        checkState(flag == s_depthMask, "the depth mask");
+    }
+    if (s_depthFunc != (GLenum)-1)
+    {
+        checkState((GLenum)getInteger(GL_DEPTH_FUNC) == s_depthFunc, "the depth func");
+    }
+    if (s_cullFace != (GLenum)-1)
+    {
+        checkState((GLenum)getInteger(GL_CULL_FACE_MODE) == s_cullFace, "the cull face");
+    }
+    if (s_frontFace != (GLenum)-1)
+    {
+        checkState((GLenum)getInteger(GL_FRONT_FACE) == s_frontFace, "the front face");
+    }
+
+    // GL may keep only the bits of the stencil buffer of the masks
+    GLuint stencilBits = (GLuint)getInteger(GL_STENCIL_BITS);
+    GLuint stencilMask = stencilBits >= 32 ? 0xffffffff : (1u << stencilBits) - 1;
+    if (s_stencilFunc != (GLenum)-1)
+    {
+        checkState((GLenum)getInteger(GL_STENCIL_FUNC) == s_stencilFunc &&
+                   getInteger(GL_STENCIL_REF) == s_stencilRef &&
+                   ((GLuint)getInteger(GL_STENCIL_VALUE_MASK) & stencilMask) == (s_stencilValueMask & stencilMask), "the stencil func");
+    }
+    if (s_stencilFail != (GLenum)-1)
+    {
+        checkState((GLenum)getInteger(GL_STENCIL_FAIL) == s_stencilFail &&
+                   (GLenum)getInteger(GL_STENCIL_PASS_DEPTH_FAIL) == s_stencilPassDepthFail &&
+                   (GLenum)getInteger(GL_STENCIL_PASS_DEPTH_PASS) == s_stencilPassDepthPass, "the stencil op");
+    }
+    if (s_stencilMaskKnown)
+    {
+        checkState(((GLuint)getInteger(GL_STENCIL_WRITEMASK) & stencilMask) == (s_stencilMask & stencilMask), "the stencil mask");
+    }
+
+    GLint box[4];
+    if (s_viewport[2] >= 0)
+    {
+        glGetIntegerv(GL_VIEWPORT, box);
+        checkState(box[0] == s_viewport[0] && box[1] == s_viewport[1] && box[2] == s_viewport[2] && box[3] == s_viewport[3], "the viewport");
+    }
+    if (s_scissorBox[2] >= 0)
+    {
+        glGetIntegerv(GL_SCISSOR_BOX, box);
+        checkState(box[0] == s_scissorBox[0] && box[1] == s_scissorBox[1] && box[2] == s_scissorBox[2] && box[3] == s_scissorBox[3], "the scissor box");
+    }
+
+    if (s_arrayBuffer != (GLuint)-1)
+    {
+        checkState((GLuint)getInteger(GL_ARRAY_BUFFER_BINDING) == s_arrayBuffer, "the array buffer");
+    }
+    if (s_elementArrayBuffer != (GLuint)-1)
+    {
+        checkState((GLuint)getInteger(GL_ELEMENT_ARRAY_BUFFER_BINDING) == s_elementArrayBuffer, "the element array buffer");
+    }
+
+    // the attribs of another vertex array are not the cached ones
+    if (s_VAO != 0)
+    {
+        return;
+    }
+    int attribCount = std::min(getInteger(GL_MAX_VERTEX_ATTRIBS), (GLint)MAX_ATTRIBUTES);
+    for (int i = 0; i < attribCount; i++)
+    {
+        GLint enabled = GL_FALSE;
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &enabled);
+        checkState((enabled != GL_FALSE) == ((s_attributeFlags & (1 << i)) != 0), "a vertex attrib array enable");
+
+        const auto& current = s_attribPointers[i];
+        if (current.size == 0)
+        {
+            continue;
+        }
+        GLint buffer = 0, size = 0, type = 0, normalized = 0, stride = 0;
+        GLvoid* pointer = nullptr;
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &buffer);
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_SIZE, &size);
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_TYPE, &type);
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_NORMALIZED, &normalized);
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_STRIDE, &stride);
+        glGetVertexAttribPointerv(i, GL_VERTEX_ATTRIB_ARRAY_POINTER, &pointer);
+        checkState((GLuint)buffer == current.buffer && size == current.size && (GLenum)type == current.type &&
+                   (normalized != GL_FALSE) == (current.normalized != GL_FALSE) && stride == current.stride &&
+                   pointer == current.pointer, "a vertex attrib pointer");
+    }
+#endif // CC_ENABLE_GL_STATE_CACHE
+}
+
 // GL Uniforms functions
 
 void setProjectionMatrixDirty( void )
@@ -268,4 +1061,3 @@ void setProjectionMatrixDirty( void )
 } // Namespace GL
 
 NS_CC_END
-
@@ -66,6 +66,20 @@ enum {
  */
 void CC_DLL invalidateStateCache();
 
+/**
+ * Invalidates the GL state cache of the calling thread, without resetting the matrix stacks.
+ * It's used when the thread makes another context current, the vertex attribs must be disabled
+ * in the previous one with enableVertexAttribs(0) first.
+ */
+void CC_DLL invalidateContextStateCache();
+
+/**
+ * Invalidates the cached bindings of the objects shared between the contexts: the program, the textures,
+ * the buffers and the vertex attrib pointers. An object deleted by another context stays bound in this one
+ * and its name can be reused, the render thread calls it before each frame.
+ */
+void CC_DLL invalidateSharedObjectBindings();
+
 /**
  * Uses the GL program in case program is different than the current one.
 
@@ -164,6 +178,186 @@ void CC_DLL activeTexture(GLenum texture);
  */
 void CC_DLL bindVAO(GLuint vaoId);
 
+/**
+ * Deletes the vertex array. If it is the one that is bound, it invalidates it.
+ *
+ * If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glDeleteVertexArrays() directly.
+ */
+void CC_DLL deleteVAO(GLuint vaoId);
+
+/**
+ * If the buffer is not already bound to the target, it binds it.
+ * GL_ARRAY_BUFFER and GL_ELEMENT_ARRAY_BUFFER are cached, the other targets call glBindBuffer() directly.
+ * The element array buffer belongs to the vertex array, its binding is invalidated when bindVAO() changes it.
+ *
+ * If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glBindBuffer() directly.
+ */
+void CC_DLL bindBuffer(GLenum target, GLuint buffer);
+
+/**
+ * Deletes the buffers. The bindings and the vertex attrib pointers that use them are invalidated.
+ *
+ * If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glDeleteBuffers() directly.
+ */
+void CC_DLL deleteBuffers(GLsizei n, const GLuint* buffers);
+
+/**
+ * Calls glBufferData() and accounts for the size of the buffer bound to the target by bindBuffer(), see getBufferBytes().
+ * The size of a buffer bound otherwise isn't known.
+ *
+ * If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glBufferData() directly.
+ * @since v3.11
+ */
+void CC_DLL bufferData(GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage);
+
+/**
+ * Returns the bytes of the buffers filled by bufferData() and not deleted yet, the vertices and indices of the
+ * renderer, the texture atlases, the draw nodes and the particles. Sets `count` to the number of buffers.
+ * @since v3.11
+ */
+size_t CC_DLL getBufferBytes(unsigned int* count = nullptr);
+
+/**
+ * Sets the vertex attrib pointer in case it differs from the one set with the same buffer bound.
+ * Only the pointers of the default vertex array are cached, they are set directly while another one is bound.
+ *
+ * If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glVertexAttribPointer() directly.
+ */
+void CC_DLL vertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer);
+
+/**
+ * Enables the capability in case it is not already enabled.
+ * GL_BLEND, GL_CULL_FACE, GL_DEPTH_TEST, GL_SCISSOR_TEST and GL_STENCIL_TEST are cached,
+ * the other capabilities call glEnable() directly.
+ *
+ * If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glEnable() directly.
+ */
+void CC_DLL enable(GLenum cap);
+
+/**
+ * Disables the capability in case it is not already disabled, see enable().
+ *
+ * If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glDisable() directly.
+ */
+void CC_DLL disable(GLenum cap);
+
+/** Calls enable() or disable(). */
+void CC_DLL setEnabled(GLenum cap, bool enabled);
+
+/**
+ * Returns whether the capability is enabled, from the cache when it's known.
+ * It calls glIsEnabled() the first time, for the capabilities that aren't cached or if CC_ENABLE_GL_STATE_CACHE is disabled.
+ */
+bool CC_DLL isEnabled(GLenum cap);
+
+/**
+ * Sets the depth write mask in case it differs from the current one.
+ *
+ * If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glDepthMask() directly.
+ */
+void CC_DLL depthMask(GLboolean flag);
+
+/** Returns the depth write mask, it calls glGetBooleanv() when it isn't known. */
+GLboolean CC_DLL getDepthMask();
+
+/**
+ * Sets the depth function in case it differs from the current one.
+ *
+ * If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glDepthFunc() directly.
+ */
+void CC_DLL depthFunc(GLenum func);
+
+/**
+ * Sets the culled faces in case they differ from the current ones.
+ *
+ * If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glCullFace() directly.
+ */
+void CC_DLL cullFace(GLenum mode);
+
+/**
+ * Sets the front face winding in case it differs from the current one.
+ *
+ * If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glFrontFace() directly.
+ */
+void CC_DLL frontFace(GLenum mode);
+
+/**
+ * Sets the stencil function of both faces in case it differs from the current one.
+ *
+ * If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glStencilFunc() directly.
+ */
+void CC_DLL stencilFunc(GLenum func, GLint ref, GLuint mask);
+
+/** Gets the stencil function, it calls glGetIntegerv() when it isn't known. */
+void CC_DLL getStencilFunc(GLenum* func, GLint* ref, GLuint* mask);
+
+/**
+ * Sets the stencil operations of both faces in case they differ from the current ones.
+ *
+ * If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glStencilOp() directly.
+ */
+void CC_DLL stencilOp(GLenum sfail, GLenum dpfail, GLenum dppass);
+
+/** Gets the stencil operations, it calls glGetIntegerv() when they aren't known. */
+void CC_DLL getStencilOp(GLenum* sfail, GLenum* dpfail, GLenum* dppass);
+
+/**
+ * Sets the stencil write mask of both faces in case it differs from the current one.
+ *
+ * If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glStencilMask() directly.
+ */
+void CC_DLL stencilMask(GLuint mask);
+
+/** Gets the stencil write mask, it calls glGetIntegerv() when it isn't known. */
+GLuint CC_DLL getStencilMask();
+
+/**
+ * Sets the viewport in case it differs from the current one.
+ *
+ * If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glViewport() directly.
+ */
+void CC_DLL viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+/** Gets the viewport as x, y, width and height, it calls glGetIntegerv() when it isn't known. */
+void CC_DLL getViewport(GLint viewport[4]);
+
+/**
+ * Sets the scissor box in case it differs from the current one.
+ *
+ * If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glScissor() directly.
+ */
+void CC_DLL scissor(GLint x, GLint y, GLsizei width, GLsizei height);
+
+/** Gets the scissor box as x, y, width and height, it calls glGetIntegerv() when it isn't known. */
+void CC_DLL getScissorBox(GLint box[4]);
+
+/** The GL calls made through the cache by a thread. */
+struct StateCacheStats
+{
+    /** The calls that reached GL, the queries of unknown state included. */
+    unsigned int issued;
+    /** The redundant calls that were dropped. */
+    unsigned int skipped;
+};
+
+/**
+ * Returns the calls counted on the calling thread since resetStateCacheStats().
+ * The renderer resets them after each frame, see Renderer::getIssuedStateCalls().
+ */
+StateCacheStats CC_DLL getStateCacheStats();
+
+/** Resets the counters of the calling thread. */
+void CC_DLL resetStateCacheStats();
+
+/**
+ * Compares the cached state with the GL state read back with glGet*() and asserts on the first one that differs,
+ * which means that a GL call bypassed the cache. It stalls the pipeline, the renderer calls it after each frame
+ * if CC_GL_STATE_CACHE_VALIDATION is enabled.
+ *
+ * It does nothing if CC_ENABLE_GL_STATE_CACHE is disabled.
+ */
+void CC_DLL validateStateCache();
+
 // end of support group
 /// @}
 
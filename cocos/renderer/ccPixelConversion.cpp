@@ -0,0 +1,286 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "renderer/ccPixelConversion.h"
+
+#include "math/MathUtil.h"
+
+// the same rules as MathUtil: NEON is always there on arm64, armv7 checks the cpu at runtime on android
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_IOS) || (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+    #if defined (__arm64__) || defined (__aarch64__) || defined (__ARM_NEON__)
+    #define INCLUDE_NEON
+    #include <arm_neon.h>
+    #endif
+#endif
+
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#define INCLUDE_SSE2
+#include <emmintrin.h>
+#endif
+
+NS_CC_BEGIN
+
+namespace pixel
+{
+
+namespace
+{
+    // the pixels converted per iteration of the vector loops
+    static const ssize_t BATCH = 16;
+
+#ifdef INCLUDE_NEON
+    static bool useNeon()
+    {
+        static const bool neon = MathUtil::isNeon32Enabled() || MathUtil::isNeon64Enabled();
+        return neon;
+    }
+#endif
+
+    // the vector loops convert the whole batches and return the number of pixels they did, the scalar code does the rest
+    static ssize_t convertRGBA8888ToRGBA4444Vector(const unsigned char* data, ssize_t pixels, unsigned short* out16)
+    {
+        ssize_t count = pixels - pixels % BATCH;
+#if defined (INCLUDE_NEON)
+        if (!useNeon())
+            return 0;
+        const uint8x16_t mask = vdupq_n_u8(0xF0);
+        for (ssize_t i = 0; i < count; i += BATCH)
+        {
+            uint8x16x4_t rgba = vld4q_u8(data + i * 4);
+            uint8x16x2_t result;
+            // little endian: the low byte is BBBBAAAA, the high byte RRRRGGGG
+            result.val[0] = vorrq_u8(vandq_u8(rgba.val[2], mask), vshrq_n_u8(rgba.val[3], 4));
+            result.val[1] = vorrq_u8(vandq_u8(rgba.val[0], mask), vshrq_n_u8(rgba.val[1], 4));
+            vst2q_u8((uint8_t*)(out16 + i), result);
+        }
+        return count;
+#elif defined (INCLUDE_SSE2)
+        const __m128i maskR = _mm_set1_epi32(0xF0);
+        const __m128i maskG = _mm_set1_epi32(0xF000);
+        const __m128i maskB = _mm_set1_epi32(0xF00000);
+        for (ssize_t i = 0; i < count; i += 8)
+        {
+            __m128i result[2];
+            for (int j = 0; j < 2; ++j)
+            {
+                // one pixel per 32 bit lane, AAAAAAAABBBBBBBBGGGGGGGGRRRRRRRR
+                __m128i p = _mm_loadu_si128((const __m128i*)(data + (i + j * 4) * 4));
+                __m128i value = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(p, maskR), 8),
+                                                          _mm_srli_epi32(_mm_and_si128(p, maskG), 4)),
+                                             _mm_or_si128(_mm_srli_epi32(_mm_and_si128(p, maskB), 16),
+                                                          _mm_srli_epi32(p, 28)));
+                // sign extend the 16 bits so the saturating pack keeps them
+                result[j] = _mm_srai_epi32(_mm_slli_epi32(value, 16), 16);
+            }
+            _mm_storeu_si128((__m128i*)(out16 + i), _mm_packs_epi32(result[0], result[1]));
+        }
+        return count;
+#else
+        return 0;
+#endif
+    }
+
+    static ssize_t convertRGBA8888ToRGB565Vector(const unsigned char* data, ssize_t pixels, unsigned short* out16)
+    {
+        ssize_t count = pixels - pixels % BATCH;
+#if defined (INCLUDE_NEON)
+        if (!useNeon())
+            return 0;
+        const uint8x16_t maskRB = vdupq_n_u8(0xF8);
+        const uint8x16_t maskG = vdupq_n_u8(0x1C);
+        for (ssize_t i = 0; i < count; i += BATCH)
+        {
+            uint8x16x4_t rgba = vld4q_u8(data + i * 4);
+            uint8x16x2_t result;
+            // little endian: the low byte is GGGBBBBB, the high byte RRRRRGGG
+            result.val[0] = vorrq_u8(vshlq_n_u8(vandq_u8(rgba.val[1], maskG), 3), vshrq_n_u8(rgba.val[2], 3));
+            result.val[1] = vorrq_u8(vandq_u8(rgba.val[0], maskRB), vshrq_n_u8(rgba.val[1], 5));
+            vst2q_u8((uint8_t*)(out16 + i), result);
+        }
+        return count;
+#elif defined (INCLUDE_SSE2)
+        const __m128i maskR = _mm_set1_epi32(0xF8);
+        const __m128i maskG = _mm_set1_epi32(0xFC00);
+        const __m128i maskB = _mm_set1_epi32(0xF80000);
+        for (ssize_t i = 0; i < count; i += 8)
+        {
+            __m128i result[2];
+            for (int j = 0; j < 2; ++j)
+            {
+                __m128i p = _mm_loadu_si128((const __m128i*)(data + (i + j * 4) * 4));
+                __m128i value = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(p, maskR), 8),
+                                                          _mm_srli_epi32(_mm_and_si128(p, maskG), 5)),
+                                             _mm_srli_epi32(_mm_and_si128(p, maskB), 19));
+                result[j] = _mm_srai_epi32(_mm_slli_epi32(value, 16), 16);
+            }
+            _mm_storeu_si128((__m128i*)(out16 + i), _mm_packs_epi32(result[0], result[1]));
+        }
+        return count;
+#else
+        return 0;
+#endif
+    }
+
+    static ssize_t convertRGBA8888ToA8Vector(const unsigned char* data, ssize_t pixels, unsigned char* out)
+    {
+        ssize_t count = pixels - pixels % BATCH;
+#if defined (INCLUDE_NEON)
+        if (!useNeon())
+            return 0;
+        for (ssize_t i = 0; i < count; i += BATCH)
+        {
+            uint8x16x4_t rgba = vld4q_u8(data + i * 4);
+            vst1q_u8(out + i, rgba.val[3]);
+        }
+        return count;
+#elif defined (INCLUDE_SSE2)
+        for (ssize_t i = 0; i < count; i += BATCH)
+        {
+            __m128i alpha[4];
+            for (int j = 0; j < 4; ++j)
+            {
+                alpha[j] = _mm_srli_epi32(_mm_loadu_si128((const __m128i*)(data + (i + j * 4) * 4)), 24);
+            }
+            __m128i alpha16 = _mm_packs_epi32(alpha[0], alpha[1]);
+            __m128i alpha16b = _mm_packs_epi32(alpha[2], alpha[3]);
+            _mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi16(alpha16, alpha16b));
+        }
+        return count;
+#else
+        return 0;
+#endif
+    }
+
+    static ssize_t premultiplyAlphaVector(unsigned char* data, ssize_t pixels)
+    {
+        ssize_t count = pixels - pixels % BATCH;
+#if defined (INCLUDE_NEON)
+        if (!useNeon())
+            return 0;
+        const uint16x8_t one = vdupq_n_u16(1);
+        for (ssize_t i = 0; i < count; i += BATCH)
+        {
+            uint8x16x4_t rgba = vld4q_u8(data + i * 4);
+            // c * (a + 1) >> 8, a + 1 needs 16 bits
+            uint16x8_t alphaLow = vaddq_u16(vmovl_u8(vget_low_u8(rgba.val[3])), one);
+            uint16x8_t alphaHigh = vaddq_u16(vmovl_u8(vget_high_u8(rgba.val[3])), one);
+            for (int c = 0; c < 3; ++c)
+            {
+                uint16x8_t low = vmulq_u16(vmovl_u8(vget_low_u8(rgba.val[c])), alphaLow);
+                uint16x8_t high = vmulq_u16(vmovl_u8(vget_high_u8(rgba.val[c])), alphaHigh);
+                rgba.val[c] = vcombine_u8(vshrn_n_u16(low, 8), vshrn_n_u16(high, 8));
+            }
+            vst4q_u8(data + i * 4, rgba);
+        }
+        return count;
+#elif defined (INCLUDE_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i one = _mm_set1_epi16(1);
+        // the alpha lanes are multiplied by 256, so they keep their value
+        const __m128i alphaLanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+        const __m128i alphaFactor = _mm_set_epi16(256, 0, 0, 0, 256, 0, 0, 0);
+        for (ssize_t i = 0; i < count; i += 4)
+        {
+            __m128i p = _mm_loadu_si128((const __m128i*)(data + i * 4));
+            __m128i result[2];
+            for (int j = 0; j < 2; ++j)
+            {
+                // two pixels of 16 bit channels
+                __m128i c = j == 0 ? _mm_unpacklo_epi8(p, zero) : _mm_unpackhi_epi8(p, zero);
+                __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(c, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+                __m128i factor = _mm_or_si128(_mm_andnot_si128(alphaLanes, _mm_add_epi16(a, one)), alphaFactor);
+                result[j] = _mm_srli_epi16(_mm_mullo_epi16(c, factor), 8);
+            }
+            _mm_storeu_si128((__m128i*)(data + i * 4), _mm_packus_epi16(result[0], result[1]));
+        }
+        return count;
+#else
+        return 0;
+#endif
+    }
+}
+
+void convertRGBA8888ToRGBA4444(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+{
+    unsigned short* out16 = (unsigned short*)outData;
+    ssize_t done = convertRGBA8888ToRGBA4444Vector(data, dataLen / 4, out16);
+    out16 += done;
+    for (ssize_t i = done * 4, l = dataLen - 3; i < l; i += 4)
+    {
+        *out16++ = (data[i] & 0x00F0) << 8    //R
+        | (data[i + 1] & 0x00F0) << 4         //G
+        | (data[i + 2] & 0xF0)                //B
+        |  (data[i + 3] & 0xF0) >> 4;         //A
+    }
+}
+
+void convertRGBA8888ToRGB565(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+{
+    unsigned short* out16 = (unsigned short*)outData;
+    ssize_t done = convertRGBA8888ToRGB565Vector(data, dataLen / 4, out16);
+    out16 += done;
+    for (ssize_t i = done * 4, l = dataLen - 3; i < l; i += 4)
+    {
+        *out16++ = (data[i] & 0x00F8) << 8    //R
+            | (data[i + 1] & 0x00FC) << 3     //G
+            | (data[i + 2] & 0x00F8) >> 3;    //B
+    }
+}
+
+void convertRGBA8888ToA8(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+{
+    ssize_t done = convertRGBA8888ToA8Vector(data, dataLen / 4, outData);
+    outData += done;
+    for (ssize_t i = done * 4, l = dataLen - 3; i < l; i += 4)
+    {
+        *outData++ = data[i + 3]; //A
+    }
+}
+
+void premultiplyAlpha(unsigned char* data, ssize_t pixelCount)
+{
+    for (ssize_t i = premultiplyAlphaVector(data, pixelCount); i < pixelCount; ++i)
+    {
+        unsigned char* p = data + i * 4;
+        unsigned int alpha = p[3] + 1;
+        p[0] = (unsigned char)((p[0] * alpha) >> 8);
+        p[1] = (unsigned char)((p[1] * alpha) >> 8);
+        p[2] = (unsigned char)((p[2] * alpha) >> 8);
+    }
+}
+
+bool isVectorized()
+{
+#if defined (INCLUDE_NEON)
+    return useNeon();
+#elif defined (INCLUDE_SSE2)
+    return true;
+#else
+    return false;
+#endif
+}
+
+} // namespace pixel
+
+NS_CC_END
@@ -0,0 +1,67 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_PIXEL_CONVERSION_H__
+#define __CC_PIXEL_CONVERSION_H__
+
+#include "platform/CCPlatformMacros.h"
+#include "platform/CCStdC.h"
+
+/**
+ * @addtogroup renderer
+ * @{
+ */
+
+NS_CC_BEGIN
+
+/**
+ The RGBA8888 conversions of the texture loading paths.
+ They use NEON or SSE2 when the CPU has it, the result is the same as the scalar code.
+ @js NA
+ */
+namespace pixel
+{
+    /** RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRGGGGBBBBAAAA, `dataLen` is in bytes. */
+    void CC_DLL convertRGBA8888ToRGBA4444(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
+
+    /** RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRRGGGGGGBBBBB, `dataLen` is in bytes. */
+    void CC_DLL convertRGBA8888ToRGB565(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
+
+    /** RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> AAAAAAAA, `dataLen` is in bytes. */
+    void CC_DLL convertRGBA8888ToA8(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
+
+    /** Premultiplies the RGBA8888 pixels in place, like CC_RGB_PREMULTIPLY_ALPHA. */
+    void CC_DLL premultiplyAlpha(unsigned char* data, ssize_t pixelCount);
+
+    /** Whether the conversions use NEON or SSE2 on this CPU. */
+    bool CC_DLL isVectorized();
+}
+
+NS_CC_END
+
+/**
+ end of support group
+ @}
+ */
+#endif //__CC_PIXEL_CONVERSION_H__
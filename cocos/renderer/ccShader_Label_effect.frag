@@ -0,0 +1,45 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+const char* ccLabelEffect_frag = STRINGIFY(
+\n#ifdef GL_ES\n
+precision lowp float;
+\n#endif\n
+
+varying vec4 v_fragmentColor;
+varying vec2 v_texCoord;
+
+// The shadow, the outline and the text of a label in one draw, each layer is a copy of the quads with its color.
+// The vertex alpha from 0 to 126 draws the letters, from 129 to 255 the letters with their outline,
+// see Label::updateEffectQuads()
+void main()
+{
+    vec4 sample = texture2D(CC_Texture0, v_texCoord);
+    float silhouette = step(0.5, v_fragmentColor.a);
+    float alpha = (v_fragmentColor.a - silhouette * (129.0 / 255.0)) * (255.0 / 126.0);
+    float coverage = mix(sample.a, max(sample.a, sample.r), silhouette);
+    gl_FragColor = vec4(v_fragmentColor.rgb, alpha * coverage);
+}
+);
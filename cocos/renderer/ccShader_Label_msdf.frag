@@ -0,0 +1,54 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+const char* ccLabelMSDF_frag = STRINGIFY(
+
+\n#ifdef GL_ES\n
+precision mediump float;
+\n#endif\n
+
+varying vec4 v_fragmentColor;
+varying vec2 v_texCoord;
+
+uniform vec4 u_textColor;
+uniform vec4 u_effectColor;
+// the screen pixels per unit of the field, and the outline width in units of the field
+uniform float u_distanceScale;
+uniform float u_outlineWidth;
+
+float median(vec3 c)
+{
+    return max(min(c.r, c.g), min(max(c.r, c.g), c.b));
+}
+
+void main()
+{
+    float dist = median(texture2D(CC_Texture0, v_texCoord).rgb) - 0.5;
+    float fontAlpha = clamp(dist * u_distanceScale + 0.5, 0.0, 1.0);
+    float outlineAlpha = clamp((dist + u_outlineWidth) * u_distanceScale + 0.5, 0.0, 1.0);
+    vec4 color = u_textColor * fontAlpha + u_effectColor * (1.0 - fontAlpha);
+    gl_FragColor = v_fragmentColor * vec4(color.rgb, max(fontAlpha, outlineAlpha) * color.a);
+}
+);
@@ -0,0 +1,129 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+// Every particle is evaluated in closed form from its spawn time, nothing is stored between frames.
+// a_position is the corner of the unit quad, the slot of the particle and its seed.
+// Slot i spawns at i / emissionRate, then once per period, a particle never outlives its period.
+const char* ccParticleGPU_vert = STRINGIFY(
+attribute vec4 a_position;
+
+uniform vec4 u_emission;     // period, 1 / emission rate, time, stop time
+uniform vec4 u_life;         // life, life variance, y flip, premultiplied alpha
+uniform vec4 u_source;       // source position, position variance
+uniform vec4 u_startColor;
+uniform vec4 u_startColorVar;
+uniform vec4 u_endColor;
+uniform vec4 u_endColorVar;
+uniform vec4 u_size;         // start size, start size variance, end size, end size variance
+uniform vec4 u_spin;         // start spin, start spin variance, end spin, end spin variance
+uniform vec4 u_angle;        // angle, angle variance, speed or degrees per second, its variance
+uniform vec4 u_radius;       // gravity, or start radius, start radius variance, end radius, end radius variance
+uniform vec4 u_flags;        // end size is start size, end radius is start radius, rotation is dir, radius mode
+uniform vec4 u_texRect;      // left, bottom, right, top
+
+\n#ifdef GL_ES\n
+varying lowp vec4 v_fragmentColor;
+varying mediump vec2 v_texCoord;
+\n#else\n
+varying vec4 v_fragmentColor;
+varying vec2 v_texCoord;
+\n#endif\n
+
+// [-1, 1], the same for a slot and a cycle
+float random(float cycle, float n)
+{
+    return fract(sin(dot(vec2(a_position.w + n * 0.0731, cycle * 0.6180339), vec2(12.9898, 78.233))) * 43758.5453) * 2.0 - 1.0;
+}
+
+vec4 random4(float cycle, float n)
+{
+    return vec4(random(cycle, n), random(cycle, n + 1.0), random(cycle, n + 2.0), random(cycle, n + 3.0));
+}
+
+void main()
+{
+    float spawn = a_position.z * u_emission.y;
+    float cycle = floor((u_emission.z - spawn) / u_emission.x);
+    spawn += cycle * u_emission.x;
+    // spawned after the emitter stopped, the particle of the previous cycle may still be alive
+    if (spawn >= u_emission.w)
+    {
+        cycle -= 1.0;
+        spawn -= u_emission.x;
+    }
+    float age = u_emission.z - spawn;
+    float seed = mod(cycle, 64.0);
+    float life = min(max(0.0, u_life.x + u_life.y * random(seed, 0.0)), u_emission.x);
+    if (cycle < 0.0 || age >= life)
+    {
+        gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+        v_fragmentColor = vec4(0.0);
+        v_texCoord = vec2(0.0);
+        return;
+    }
+    float t = age / life;
+
+    vec4 color = mix(clamp(u_startColor + u_startColorVar * random4(seed, 1.0), 0.0, 1.0),
+                     clamp(u_endColor + u_endColorVar * random4(seed, 5.0), 0.0, 1.0), t);
+    if (u_life.w > 0.5)
+    {
+        color.rgb *= color.a;
+    }
+
+    float startSize = max(0.0, u_size.x + u_size.y * random(seed, 9.0));
+    float endSize = u_flags.x > 0.5 ? startSize : max(0.0, u_size.z + u_size.w * random(seed, 10.0));
+    float size = max(0.0, mix(startSize, endSize, t));
+
+    float startSpin = u_spin.x + u_spin.y * random(seed, 11.0);
+    float rotation = mix(startSpin, u_spin.z + u_spin.w * random(seed, 12.0), t) - startSpin;
+
+    vec2 position;
+    if (u_flags.w > 0.5)
+    {
+        float startRadius = u_radius.x + u_radius.y * random(seed, 13.0);
+        float endRadius = u_flags.y > 0.5 ? startRadius : u_radius.z + u_radius.w * random(seed, 14.0);
+        float radius = mix(startRadius, endRadius, t);
+        float angle = radians(u_angle.x + u_angle.y * random(seed, 15.0) + (u_angle.z + u_angle.w * random(seed, 16.0)) * age);
+        position = vec2(-cos(angle) * radius, -sin(angle) * radius * u_life.z);
+        rotation += startSpin;
+    }
+    else
+    {
+        float angle = radians(u_angle.x + u_angle.y * random(seed, 15.0));
+        vec2 dir = vec2(cos(angle), sin(angle)) * (u_angle.z + u_angle.w * random(seed, 16.0));
+        position = u_source.xy + u_source.zw * random4(seed, 17.0).xy;
+        position += (dir * age + 0.5 * u_radius.xy * age * age) * u_life.z;
+        rotation += u_flags.z > 0.5 ? -degrees(atan(dir.y, dir.x)) : startSpin;
+    }
+
+    float r = -radians(rotation);
+    vec2 corner = a_position.xy * size;
+    position += vec2(corner.x * cos(r) - corner.y * sin(r), corner.x * sin(r) + corner.y * cos(r));
+
+    gl_Position = CC_MVPMatrix * vec4(position, 0.0, 1.0);
+    v_fragmentColor = color;
+    v_texCoord = mix(u_texRect.xy, u_texRect.zw, a_position.xy + 0.5);
+}
+);
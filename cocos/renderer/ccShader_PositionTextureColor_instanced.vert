@@ -0,0 +1,54 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+// a_position is the corner of the unit quad, every other attribute is per instance:
+// a_texCoord holds the top-left and bottom-left uvs, a_texCoord1 the top-right and bottom-right ones,
+// a_texCoord2 is the world position of the bottom-left corner, a_texCoord3 and a_normal the quad edges.
+const char* ccPositionTextureColor_instanced_vert = STRINGIFY(
+attribute vec2 a_position;
+attribute vec4 a_texCoord;
+attribute vec4 a_texCoord1;
+attribute vec3 a_texCoord2;
+attribute vec3 a_texCoord3;
+attribute vec3 a_normal;
+attribute vec4 a_color;
+
+\n#ifdef GL_ES\n
+varying lowp vec4 v_fragmentColor;
+varying mediump vec2 v_texCoord;
+\n#else\n
+varying vec4 v_fragmentColor;
+varying vec2 v_texCoord;
+\n#endif\n
+
+void main()
+{
+    vec3 position = a_texCoord2 + a_position.x * a_texCoord3 + a_position.y * a_normal;
+    gl_Position = CC_PMatrix * vec4(position, 1.0);
+    v_fragmentColor = a_color;
+    v_texCoord = mix(mix(a_texCoord.zw, a_texCoord.xy, a_position.y),
+                     mix(a_texCoord1.zw, a_texCoord1.xy, a_position.y),
+                     a_position.x);
+}
+);
@@ -0,0 +1,61 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+// GLES2 can only index an array of samplers with a constant, the unit is picked by comparisons.
+// u_textures[i] is bound to the texture unit i, there are CC_RENDERER_MAX_BATCH_TEXTURES of them.
+const char* ccPositionTextureColor_multiTexture_frag = STRINGIFY(
+\n#ifdef GL_ES\n
+precision lowp float;
+varying mediump float v_textureSlot;
+\n#else\n
+varying float v_textureSlot;
+\n#endif\n
+
+varying vec4 v_fragmentColor;
+varying vec2 v_texCoord;
+
+uniform sampler2D u_textures[8];
+
+void main()
+{
+    vec4 texColor;
+    if (v_textureSlot < 0.5)
+        texColor = texture2D(u_textures[0], v_texCoord);
+    else if (v_textureSlot < 1.5)
+        texColor = texture2D(u_textures[1], v_texCoord);
+    else if (v_textureSlot < 2.5)
+        texColor = texture2D(u_textures[2], v_texCoord);
+    else if (v_textureSlot < 3.5)
+        texColor = texture2D(u_textures[3], v_texCoord);
+    else if (v_textureSlot < 4.5)
+        texColor = texture2D(u_textures[4], v_texCoord);
+    else if (v_textureSlot < 5.5)
+        texColor = texture2D(u_textures[5], v_texCoord);
+    else if (v_textureSlot < 6.5)
+        texColor = texture2D(u_textures[6], v_texCoord);
+    else
+        texColor = texture2D(u_textures[7], v_texCoord);
+    gl_FragColor = v_fragmentColor * texColor;
+}
+);
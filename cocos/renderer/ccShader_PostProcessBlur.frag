@@ -0,0 +1,46 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+const char* ccPostProcessBlur_frag = STRINGIFY(
+
+\n#ifdef GL_ES\n
+precision mediump float;
+\n#endif\n
+
+varying vec2 v_texCoord;
+
+// the offset between two taps, in texture coordinates, along the direction of the pass
+uniform vec2 u_direction;
+
+void main()
+{
+    // 9 tap gaussian in 5 fetches, the linear filtering blends the pairs of taps
+    vec2 offset1 = u_direction * 1.3846153846;
+    vec2 offset2 = u_direction * 3.2307692308;
+    vec4 color = texture2D(CC_Texture0, v_texCoord) * 0.2270270270;
+    color += (texture2D(CC_Texture0, v_texCoord + offset1) + texture2D(CC_Texture0, v_texCoord - offset1)) * 0.3162162162;
+    color += (texture2D(CC_Texture0, v_texCoord + offset2) + texture2D(CC_Texture0, v_texCoord - offset2)) * 0.0702702703;
+    gl_FragColor = color;
+}
+);
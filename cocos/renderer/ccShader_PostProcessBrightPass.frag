@@ -0,0 +1,45 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+const char* ccPostProcessBrightPass_frag = STRINGIFY(
+
+\n#ifdef GL_ES\n
+precision mediump float;
+\n#endif\n
+
+varying vec2 v_texCoord;
+
+// x: the brightness the bloom starts at, y: the soft knee below it
+uniform vec2 u_threshold;
+
+void main()
+{
+    vec3 color = texture2D(CC_Texture0, v_texCoord).rgb;
+    float brightness = max(color.r, max(color.g, color.b));
+    float soft = clamp(brightness - u_threshold.x + u_threshold.y, 0.0, 2.0 * u_threshold.y);
+    soft = soft * soft / (4.0 * u_threshold.y + 0.0001);
+    float contribution = max(soft, brightness - u_threshold.x) / max(brightness, 0.0001);
+    gl_FragColor = vec4(color * contribution, 1.0);
+}
+);
@@ -0,0 +1,72 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+const char* ccPostProcessComposite_frag = STRINGIFY(
+
+\n#ifdef GL_ES\n
+precision mediump float;
+\n#endif\n
+
+varying vec2 v_texCoord;
+
+// CC_Texture0 is the image, CC_Texture1 the bloom and CC_Texture2 the color lookup strip
+uniform float u_bloomIntensity;
+uniform mat4 u_colorMatrix;
+uniform vec4 u_colorOffset;
+uniform float u_lookupIntensity;
+// x: intensity, y: radius, z: softness, w: aspect ratio of the screen
+uniform vec4 u_vignette;
+
+void main()
+{
+    vec4 color = texture2D(CC_Texture0, v_texCoord);
+
+    if (u_bloomIntensity > 0.0)
+    {
+        color.rgb += texture2D(CC_Texture1, v_texCoord).rgb * u_bloomIntensity;
+    }
+
+    color = clamp(u_colorMatrix * color + u_colorOffset, 0.0, 1.0);
+
+    if (u_lookupIntensity > 0.0)
+    {
+        // 16 cells of 16x16 side by side, the blue picks the cell, the red and green the texel in it
+        float blue = color.b * 15.0;
+        float cell = floor(blue);
+        vec2 uv = vec2((color.r * 15.0 + 0.5) / 256.0, (color.g * 15.0 + 0.5) / 16.0);
+        vec3 graded0 = texture2D(CC_Texture2, uv + vec2(cell / 16.0, 0.0)).rgb;
+        vec3 graded1 = texture2D(CC_Texture2, uv + vec2(min(cell + 1.0, 15.0) / 16.0, 0.0)).rgb;
+        color.rgb = mix(color.rgb, mix(graded0, graded1, blue - cell), u_lookupIntensity);
+    }
+
+    if (u_vignette.x > 0.0)
+    {
+        vec2 position = (v_texCoord - 0.5) * vec2(u_vignette.w, 1.0);
+        float shade = smoothstep(u_vignette.y, u_vignette.y - u_vignette.z, length(position));
+        color.rgb *= mix(1.0, shade, u_vignette.x);
+    }
+
+    gl_FragColor = color;
+}
+);
@@ -58,6 +58,28 @@ NS_CC_BEGIN
 #include "ccShader_PositionTextureColor_noMVP.frag"
 #include "ccShader_PositionTextureColor_noMVP.vert"
 
+//
+#include "ccShader_PositionTextureColor_instanced.vert"
+
+//
+#include "ccShader_PositionTextureColor_multiTexture.frag"
+#include "ccShader_PositionTextureColor_multiTexture.vert"
+
+//
+#include "ccShader_PositionTextureColor_opaque.vert"
+
+//
+#include "ccShader_PositionTextureColor_debug.frag"
+
+//
+#include "ccShader_ParticleGPU.vert"
+
+//
+#include "ccShader_PostProcess.vert"
+#include "ccShader_PostProcessBlur.frag"
+#include "ccShader_PostProcessBrightPass.frag"
+#include "ccShader_PostProcessComposite.frag"
+
 //
 #include "ccShader_PositionTextureColorAlphaTest.frag"
 
@@ -67,14 +89,18 @@ NS_CC_BEGIN
 
 #include "ccShader_PositionColorLengthTexture.frag"
 #include "ccShader_PositionColorLengthTexture.vert"
+#include "ccShader_PositionColorLengthTexture_noMVP.vert"
 
 #include "ccShader_UI_Gray.frag"
 //
 #include "ccShader_Label.vert"
 #include "ccShader_Label_df.frag"
 #include "ccShader_Label_df_glow.frag"
+#include "ccShader_Label_msdf.frag"
+#include "ccShader_Label_msdf_glow.frag"
 #include "ccShader_Label_normal.frag"
 #include "ccShader_Label_outline.frag"
+#include "ccShader_Label_effect.frag"
 
 //
 #include "ccShader_CameraClear.vert"
@@ -58,6 +58,22 @@ extern CC_DLL const GLchar * ccPositionTextureColor_vert;
 extern CC_DLL const GLchar * ccPositionTextureColor_noMVP_frag;
 extern CC_DLL const GLchar * ccPositionTextureColor_noMVP_vert;
 
+extern CC_DLL const GLchar * ccPositionTextureColor_instanced_vert;
+
+extern CC_DLL const GLchar * ccPositionTextureColor_multiTexture_frag;
+extern CC_DLL const GLchar * ccPositionTextureColor_multiTexture_vert;
+
+extern CC_DLL const GLchar * ccPositionTextureColor_opaque_vert;
+
+extern CC_DLL const GLchar * ccPositionTextureColor_debug_frag;
+
+extern CC_DLL const GLchar * ccParticleGPU_vert;
+
+extern CC_DLL const GLchar * ccPostProcess_vert;
+extern CC_DLL const GLchar * ccPostProcessBlur_frag;
+extern CC_DLL const GLchar * ccPostProcessBrightPass_frag;
+extern CC_DLL const GLchar * ccPostProcessComposite_frag;
+
 extern CC_DLL const GLchar * ccPositionTextureColorAlphaTest_frag;
 
 extern CC_DLL const GLchar * ccPositionTexture_uColor_frag;
@@ -65,13 +81,17 @@ extern CC_DLL const GLchar * ccPositionTexture_uColor_vert;
 
 extern CC_DLL const GLchar * ccPositionColorLengthTexture_frag;
 extern CC_DLL const GLchar * ccPositionColorLengthTexture_vert;
+extern CC_DLL const GLchar * ccPositionColorLengthTexture_noMVP_vert;
 
 extern CC_DLL const GLchar * ccPositionTexture_GrayScale_frag;
 
 extern CC_DLL const GLchar * ccLabelDistanceFieldNormal_frag;
 extern CC_DLL const GLchar * ccLabelDistanceFieldGlow_frag;
+extern CC_DLL const GLchar * ccLabelMSDF_frag;
+extern CC_DLL const GLchar * ccLabelMSDFGlow_frag;
 extern CC_DLL const GLchar * ccLabelNormal_frag;
 extern CC_DLL const GLchar * ccLabelOutline_frag;
+extern CC_DLL const GLchar * ccLabelEffect_frag;
 
 extern CC_DLL const GLchar * ccLabel_vert;
 
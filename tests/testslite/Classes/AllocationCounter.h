@@ -0,0 +1,14 @@
+#ifndef __ALLOCATION_COUNTER_H__
+#define __ALLOCATION_COUNTER_H__
+
+/**
+ Counts the calls of the global operator new, which AllocationCounter.cpp replaces for the whole app.
+ BenchmarkRunner takes the difference over a frame for the allocation budgets of the scenarios.
+ The malloc() calls of the C code and of the Lua allocator aren't counted.
+ */
+namespace AllocationCounter
+{
+    unsigned long long getCount();
+}
+
+#endif // __ALLOCATION_COUNTER_H__
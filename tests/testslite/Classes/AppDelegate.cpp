@@ -1,6 +1,7 @@
 
 #include "AppDelegate.h"
 #include "WelcomeScene.h"
+#include "BenchmarkRunner.h"
 
 USING_NS_CC;
 
@@ -27,9 +28,17 @@ bool AppDelegate::applicationDidFinishLaunching()
     // initialize director
     auto director = Director::getInstance();
     auto glview = director->getOpenGLView();
+    auto benchmark = BenchmarkRunner::getInstance();
     if(!glview) {
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32) || (CC_TARGET_PLATFORM == CC_PLATFORM_MAC) || (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
+        if (benchmark->isOffscreen()) {
+            // a hidden window still has its default framebuffer
+            glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+        }
         glview = GLViewImpl::createWithRect("HelloCpp", Rect(0, 0, 960, 640));
+        if (benchmark->isOffscreen()) {
+            glfwSwapInterval(0);
+        }
 #else
         glview = GLViewImpl::create("HelloCpp");
 #endif
@@ -43,7 +52,20 @@ bool AppDelegate::applicationDidFinishLaunching()
     director->setDisplayStats(true);
 
     // set FPS. the default value is 1.0/60 if you don't call this
-    director->setAnimationInterval(1.0 / 60);
+    // offscreen, the frames aren't paced, the benchmark measures their cost
+    director->setAnimationInterval(benchmark->isOffscreen() ? 1.0 / 1000 : 1.0 / 60);
+
+#if CC_ENABLE_FILE_WATCHER
+    // the edited resources are reloaded while the app runs, not while it's measured
+    if (!benchmark->isAutoRun() && !benchmark->isMicroBenchmark()) {
+        auto fileUtils = FileUtils::getInstance();
+        for (const auto& path : fileUtils->getSearchPaths()) {
+            if (fileUtils->isDirectoryExist(path)) {
+                FileWatcher::getInstance()->addDirectory(path);
+            }
+        }
+    }
+#endif
 
     // create a scene. it's an autorelease object
     auto scene = Welcome::createScene();
@@ -51,6 +73,12 @@ bool AppDelegate::applicationDidFinishLaunching()
     // run
     director->runWithScene(scene);
 
+    if (benchmark->isMicroBenchmark()) {
+        benchmark->runMicroBenchmarks();
+    } else if (benchmark->isAutoRun()) {
+        benchmark->start();
+    }
+
     return true;
 }
 
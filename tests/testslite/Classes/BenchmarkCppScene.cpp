@@ -13,6 +13,11 @@ Scene* BenchmarkCpp::createScene()
     return scene;
 }
 
+BenchmarkCpp::BenchmarkCpp()
+: _starPool([]() { return Sprite::create("star.png"); })
+{
+}
+
 bool BenchmarkCpp::init()
 {
     if (!Layer::init()) {
@@ -51,8 +56,12 @@ bool BenchmarkCpp::init()
     _maxStars = 30000;
     _starsCountOffset = 1000;
     _steps = _stepsCount = 180;
+    // the removed stars come back with the next _addStars()
+    _starPool.setMaxIdle(_maxStars);
 
     this->scheduleUpdate();
+    // a fixed 1 s interval, the timer comes back to the level 0 slot of the timing wheel it fired from
+    this->schedule(CC_SCHEDULE_SELECTOR(BenchmarkCpp::_updateStarsLabel), 1.0f);
 
     return true;
 }
@@ -67,7 +76,6 @@ void BenchmarkCpp::update(float dt)
             _removeStars(- _starsCountOffset);
         }
         _steps = 0;
-        _starsLabel->setString(std::to_string(_stars.size()));
     }
 
     for (auto it = _stars.begin(); it != _stars.end(); ++it) {
@@ -75,23 +83,31 @@ void BenchmarkCpp::update(float dt)
     }
 }
 
+void BenchmarkCpp::_updateStarsLabel(float dt)
+{
+    _starsLabel->setString(std::to_string(_stars.size()));
+}
+
 void BenchmarkCpp::_addStars(int count)
 {
+    auto &random = RandomGenerator::getInstance();
+    Vector<Node*> sprites(count);
     for (int i = 0; i < count; ++i) {
         Star star;
-        star.sprite = Sprite::create("star.png");
-        star.pos = Vec2(random<float>(0, _viewsize.width), random<float>(0, _viewsize.height));
-        int index = random<int>(0, _offsetCount);
+        star.sprite = _starPool.acquire();
+        star.pos = Vec2(random.nextFloat(0, _viewsize.width), random.nextFloat(0, _viewsize.height));
+        int index = (int)random.nextBounded(_offsetCount);
         star.offsetIndex = index;
-        star.opacity = random<GLubyte>(0, 255);
+        star.opacity = (GLubyte)random.nextBounded(255);
         star.opacityOffset = 1;
 
         star.sprite->setPosition(star.pos + _offsets[index]);
         star.sprite->setOpacity(star.opacity);
-        _starsLayer->addChild(star.sprite);
+        sprites.pushBack(star.sprite);
 
         _stars.push_back(star);
     }
+    _starsLayer->addChildren(sprites);
 
     if (_stars.size() >= _maxStars) {
         _starsCountOffset = -_starsCountOffset;
@@ -100,10 +116,15 @@ void BenchmarkCpp::_addStars(int count)
 
 void BenchmarkCpp::_removeStars(int count)
 {
-    while (count > 0 && _stars.size() > 0) {
-        (*_stars.rbegin()).sprite->removeFromParentAndCleanup(true);
+    Vector<Node*> sprites(count);
+    for (auto it = _stars.rbegin(); it != _stars.rend() && sprites.size() < count; ++it) {
+        sprites.pushBack(it->sprite);
+    }
+    // removed together, then recycled without a parent
+    _starsLayer->removeChildren(sprites);
+    for (auto sprite : sprites) {
+        _starPool.recycle(static_cast<Sprite*>(sprite));
         _stars.pop_back();
-        count--;
     }
 
     if (_stars.size() <= 0) {
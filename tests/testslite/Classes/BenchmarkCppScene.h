@@ -20,6 +20,8 @@ class BenchmarkCpp : public Layer
 public:
     static Scene *createScene();
 
+    BenchmarkCpp();
+
     virtual bool init();
     CREATE_FUNC(BenchmarkCpp);
 
@@ -38,7 +40,9 @@ private:
     int _stepsCount;
     int _steps;
     std::vector<Star> _stars;
+    NodePool<Sprite> _starPool;
 
+    void _updateStarsLabel(float dt);
     void _addStars(int count);
     void _removeStars(int count);
     void _updateStar(Star &star);
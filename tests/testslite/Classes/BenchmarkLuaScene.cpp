@@ -5,6 +5,8 @@
 
 #include "lua.hpp"
 #include "Luabinding.hpp"
+#include "LuaGCScheduler.h"
+#include "LuaProfiler.h"
 
 USING_NS_CC;
 
@@ -17,6 +19,8 @@ Scene* BenchmarkLua::createScene()
 
 BenchmarkLua::~BenchmarkLua()
 {
+    delete _profiler;
+    delete _gcScheduler;
     lua_close(_luaState);
 }
 
@@ -37,6 +41,11 @@ bool BenchmarkLua::init()
 
     _luaState = luaL_newstate();
     luaL_openlibs(_luaState);
+    // the garbage is collected in the idle time of the frames
+    _gcScheduler = new LuaGCScheduler(_luaState);
+    // sampled into the trace with the luaprofile console command
+    _profiler = new LuaProfiler(_luaState);
+    LuaProfiler::addConsoleCommand();
     l_create_namespace_cc(_luaState);
 
     Size viewsize = Director::getInstance()->getOpenGLView()->getFrameSize();
@@ -46,11 +55,33 @@ bool BenchmarkLua::init()
     lua_pushnumber(_luaState, viewsize.height);
     lua_setglobal(_luaState, "g_viewsize_height");
 
-    l_push_userdata(_luaState, this, "cc.Layer");
+    l_push_ref(_luaState, this, "cc.Layer");
     lua_setglobal(_luaState, "g_layer");
 
-    const std::string path = FileUtils::getInstance()->fullPathForFilename("main.lua");
-    luaL_dofile(_luaState, path.c_str());
+    // the scripts are precompiled into scripts.ccpk by tools/packlua.py,
+    // without the bundle require() looks for the sources next to main.lua
+    if (!l_add_bundle_loader(_luaState, "scripts.ccpk")) {
+        const std::string path = FileUtils::getInstance()->fullPathForFilename("main.lua");
+        const std::string dir = path.substr(0, path.find_last_of('/') + 1);
+        lua_getglobal(_luaState, "package");
+        lua_getfield(_luaState, -1, "path");
+        const std::string packagePath = dir + "?.lua;" + lua_tostring(_luaState, -1);
+        lua_pop(_luaState, 1);
+        lua_pushstring(_luaState, packagePath.c_str());
+        lua_setfield(_luaState, -2, "path");
+        lua_pop(_luaState, 1);
+    }
+
+    l_require(_luaState, "main");
+
+#if CC_ENABLE_FILE_WATCHER
+    // the edited scripts are required again, see AppDelegate for the watched directories
+    auto listener = EventListenerCustom::create(FileWatcher::EVENT_FILE_CHANGED, [this](EventCustom* event) {
+        auto path = static_cast<std::string*>(event->getUserData());
+        l_reload_module(_luaState, *path);
+    });
+    _eventDispatcher->addEventListenerWithSceneGraphPriority(listener, this);
+#endif
 
     //    _lua["g_viewsize"] =
     //    _lua["g_layer"] = this;
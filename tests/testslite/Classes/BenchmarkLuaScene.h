@@ -5,6 +5,9 @@
 //#include "kaguya/kaguya.hpp"
 #include "lua.hpp"
 
+class LuaGCScheduler;
+class LuaProfiler;
+
 USING_NS_CC;
 
 class BenchmarkLua : public Layer
@@ -19,6 +22,8 @@ public:
 private:
 //    kaguya::State _lua;
     lua_State *_luaState;
+    LuaGCScheduler *_gcScheduler;
+    LuaProfiler *_profiler;
 };
 
 #endif // __BENCHMARK_LUA_SCENE_H__
@@ -0,0 +1,528 @@
+
+#include "BenchmarkRunner.h"
+#include "AllocationCounter.h"
+#include "BenchmarkScenarios.h"
+#include "MicroBenchmarks.h"
+#include "WelcomeScene.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_IOS) || (CC_TARGET_PLATFORM == CC_PLATFORM_MAC)
+#include <mach/mach.h>
+#elif (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID) || (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
+#include <unistd.h>
+#endif
+
+USING_NS_CC;
+
+// the renderer and GPU timings of a frame arrive a few frames later
+static const unsigned int kTimingLatency = 4;
+
+BenchmarkRunner* BenchmarkRunner::getInstance()
+{
+    static BenchmarkRunner instance;
+    return &instance;
+}
+
+BenchmarkRunner::BenchmarkRunner()
+: _autoRun(false)
+, _offscreen(false)
+, _warmup(2)
+, _duration(10)
+, _tolerance(10)
+, _microBenchmark(false)
+, _running(false)
+, _current(0)
+, _measuring(false)
+, _elapsed(0)
+, _sinceSample(0)
+, _nextFrame(0)
+, _allocationCount(0)
+, _peakResidentBytes(0)
+, _peakTextureBytes(0)
+{
+}
+
+void BenchmarkRunner::parseArguments(int argc, const char * const *argv)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        std::string value;
+        size_t equal = arg.find('=');
+        if (equal != std::string::npos) {
+            value = arg.substr(equal + 1);
+            arg = arg.substr(0, equal);
+        }
+
+        if (arg == "--benchmark" || arg == "--micro-benchmark") {
+            bool micro = arg == "--micro-benchmark";
+            if (micro) {
+                _microBenchmark = true;
+            } else {
+                _autoRun = true;
+            }
+            auto& selected = micro ? _microSelected : _selected;
+            size_t start = 0;
+            while (start < value.size()) {
+                size_t comma = value.find(',', start);
+                if (comma == std::string::npos) {
+                    comma = value.size();
+                }
+                selected.push_back(value.substr(start, comma - start));
+                start = comma + 1;
+            }
+        } else if (arg == "--offscreen") {
+            _offscreen = true;
+        } else if (arg == "--warmup") {
+            _warmup = std::max(0.0f, (float)atof(value.c_str()));
+        } else if (arg == "--duration") {
+            _duration = std::max(1.0f, (float)atof(value.c_str()));
+        } else if (arg == "--output") {
+            _output = value;
+        } else if (arg == "--baseline") {
+            _baselinePath = value;
+        } else if (arg == "--tolerance") {
+            _tolerance = std::max(0.0f, (float)atof(value.c_str()));
+        }
+    }
+}
+
+void BenchmarkRunner::start()
+{
+    if (_running) {
+        return;
+    }
+
+    const auto& scenarios = getBenchmarkScenarios();
+    _queue.clear();
+    for (size_t i = 0; i < scenarios.size(); ++i) {
+        if (_selected.empty() || std::find(_selected.begin(), _selected.end(), scenarios[i].name) != _selected.end()) {
+            _queue.push_back(i);
+        }
+    }
+    for (const auto& name : _selected) {
+        auto found = std::find_if(scenarios.begin(), scenarios.end(), [&name](const BenchmarkScenario& scenario) {
+            return scenario.name == name;
+        });
+        if (found == scenarios.end()) {
+            CCLOG("BenchmarkRunner: unknown scenario %s", name.c_str());
+        }
+    }
+
+    _baselines.clear();
+    if (!_baselinePath.empty() && !loadBaseline()) {
+        CCLOG("BenchmarkRunner: can't read the baseline %s", _baselinePath.c_str());
+    }
+
+    auto director = Director::getInstance();
+    director->setFrameTimingsEnabled(true);
+    director->setDisplayStats(false);
+
+    _running = true;
+    _results.clear();
+    _current = 0;
+    director->getScheduler()->schedule(CC_CALLBACK_1(BenchmarkRunner::tick, this), this, 0, false, "BenchmarkRunner");
+    startScenario();
+}
+
+void BenchmarkRunner::startScenario()
+{
+    if (_current >= _queue.size()) {
+        finish();
+        return;
+    }
+
+    const auto& scenario = getBenchmarkScenarios()[_queue[_current]];
+    CCLOG("BenchmarkRunner: %s", scenario.name.c_str());
+
+    auto scene = Scene::create();
+    scene->addChild(scenario.create());
+    Director::getInstance()->replaceScene(scene);
+
+    _measuring = false;
+    _elapsed = 0;
+}
+
+void BenchmarkRunner::tick(float dt)
+{
+    auto director = Director::getInstance();
+    _elapsed += dt;
+
+    if (!_measuring) {
+        if (_elapsed >= _warmup) {
+            _measuring = true;
+            _elapsed = 0;
+            _sinceSample = 0;
+            _nextFrame = director->getTotalFrames();
+            // the previous scene is gone by now, its textures aren't counted in this one
+            director->getTextureCache()->removeUnusedTextures();
+            _total.clear();
+            _cpu.clear();
+            _gpu.clear();
+            _drawnBatches.clear();
+            _drawnVertices.clear();
+            _issuedStateCalls.clear();
+            _skippedStateCalls.clear();
+            _allocations.clear();
+            _allocationCount = AllocationCounter::getCount();
+            _peakResidentBytes = 0;
+            _peakTextureBytes = 0;
+            sampleMemory();
+#if CC_ENABLE_ALLOCATION_PROFILER
+            AllocationProfiler::getInstance()->setEnabled(true);
+#endif
+        }
+        return;
+    }
+
+    // the ticks are a frame apart
+    unsigned long long allocationCount = AllocationCounter::getCount();
+    _allocations.push_back((float)(allocationCount - _allocationCount));
+    _allocationCount = allocationCount;
+
+    unsigned int frame = director->getTotalFrames();
+    if (frame > kTimingLatency) {
+        collectFrames(frame - kTimingLatency);
+    }
+
+    _sinceSample += dt;
+    if (_sinceSample >= 1) {
+        _sinceSample = 0;
+        sampleMemory();
+    }
+
+    if (_elapsed >= _duration) {
+        // the frames still in flight are dropped rather than waited for
+        finishScenario();
+        ++_current;
+        startScenario();
+    }
+}
+
+void BenchmarkRunner::collectFrames(unsigned int lastFrame)
+{
+    auto timings = Director::getInstance()->getFrameTimings();
+    for (; _nextFrame <= lastFrame; ++_nextFrame) {
+        const FrameTiming *timing = timings->find(_nextFrame);
+        if (!timing) {
+            continue;
+        }
+        _total.push_back(timing->total);
+        _cpu.push_back(timing->total - timing->swap);
+        if (timing->gpu >= 0) {
+            _gpu.push_back(timing->gpu);
+        }
+        _drawnBatches.push_back(timing->drawnBatches);
+        _drawnVertices.push_back(timing->drawnVertices);
+        _issuedStateCalls.push_back(timing->issuedStateCalls);
+        _skippedStateCalls.push_back(timing->skippedStateCalls);
+    }
+}
+
+void BenchmarkRunner::sampleMemory()
+{
+    _peakResidentBytes = std::max(_peakResidentBytes, getResidentBytes());
+    _peakTextureBytes = std::max(_peakTextureBytes, Director::getInstance()->getTextureCache()->getTotalTextureBytes());
+}
+
+void BenchmarkRunner::finishScenario()
+{
+    sampleMemory();
+
+    Result result;
+    result.name = getBenchmarkScenarios()[_queue[_current]].name;
+    result.frames = (int)_total.size();
+    result.total = computeStats(_total);
+    result.cpu = computeStats(_cpu);
+    result.gpu = computeStats(_gpu);
+    result.drawnBatches = computeStats(_drawnBatches);
+    result.drawnVertices = computeStats(_drawnVertices);
+    result.issuedStateCalls = computeStats(_issuedStateCalls);
+    result.skippedStateCalls = computeStats(_skippedStateCalls);
+    result.allocations = computeStats(_allocations);
+    result.peakResidentBytes = _peakResidentBytes;
+    result.peakTextureBytes = _peakTextureBytes;
+    result.allocationSiteFrames = 0;
+#if CC_ENABLE_ALLOCATION_PROFILER
+    auto profiler = AllocationProfiler::getInstance();
+    profiler->setEnabled(false);
+    result.allocationSiteFrames = profiler->getFrameCount();
+    result.allocationSites = profiler->getTotals();
+    if (result.allocationSites.size() > 10) {
+        result.allocationSites.resize(10);
+    }
+#endif
+    checkResult(result);
+    _results.push_back(result);
+
+    CCLOG("BenchmarkRunner: %s, %d frames, p50 %.2f ms, p99 %.2f ms, %.0f draw calls",
+          result.name.c_str(), result.frames, result.total.p50, result.total.p99, result.drawnBatches.p50);
+    // the failures are reported by the release builds too
+    for (const auto& failure : result.failures) {
+        log("BenchmarkRunner: %s FAILED, %s", result.name.c_str(), failure.c_str());
+    }
+}
+
+void BenchmarkRunner::checkResult(Result &result) const
+{
+    const BenchmarkBudget &budget = getBenchmarkScenarios()[_queue[_current]].budget;
+    if (budget.p95FrameMs > 0 && result.total.p95 > budget.p95FrameMs) {
+        result.failures.push_back(StringUtils::format("p95 frame time %.2f ms over the budget of %.2f ms",
+                                                      result.total.p95, budget.p95FrameMs));
+    }
+    if (budget.maxDrawCalls > 0 && result.drawnBatches.max > budget.maxDrawCalls) {
+        result.failures.push_back(StringUtils::format("%.0f draw calls over the budget of %d",
+                                                      result.drawnBatches.max, budget.maxDrawCalls));
+    }
+    if (budget.maxAllocationsPerFrame > 0 && result.allocations.max > budget.maxAllocationsPerFrame) {
+        result.failures.push_back(StringUtils::format("%.0f allocations in a frame over the budget of %d",
+                                                      result.allocations.max, budget.maxAllocationsPerFrame));
+    }
+
+    auto found = _baselines.find(result.name);
+    result.hasBaseline = found != _baselines.end();
+    if (!result.hasBaseline) {
+        return;
+    }
+    result.baseline = found->second;
+    const float growth = 1 + _tolerance / 100;
+    if (result.total.p95 > result.baseline.p95FrameMs * growth) {
+        result.failures.push_back(StringUtils::format("p95 frame time %.2f ms, %.2f ms in the baseline",
+                                                      result.total.p95, result.baseline.p95FrameMs));
+    }
+    // the same frames draw with the same batches, any new draw call is a regression
+    if (result.drawnBatches.max > result.baseline.maxDrawCalls) {
+        result.failures.push_back(StringUtils::format("%.0f draw calls, %.0f in the baseline",
+                                                      result.drawnBatches.max, result.baseline.maxDrawCalls));
+    }
+    if (result.allocations.max > result.baseline.maxAllocations * growth) {
+        result.failures.push_back(StringUtils::format("%.0f allocations in a frame, %.0f in the baseline",
+                                                      result.allocations.max, result.baseline.maxAllocations));
+    }
+}
+
+int BenchmarkRunner::getExitCode() const
+{
+    for (const auto& result : _results) {
+        if (!result.failures.empty()) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// the number after `"key": ` in the object `"object": {...}` between `from` and `to`, -1 when it's not there
+static float findNumber(const std::string &json, size_t from, size_t to, const char *object, const char *key)
+{
+    size_t start = json.find(StringUtils::format("\"%s\": {", object), from);
+    if (start == std::string::npos || start >= to) {
+        return -1;
+    }
+    size_t end = json.find('}', start);
+    std::string prefix = StringUtils::format("\"%s\": ", key);
+    size_t position = json.find(prefix, start);
+    if (position == std::string::npos || position >= end) {
+        return -1;
+    }
+    return (float)atof(json.c_str() + position + prefix.size());
+}
+
+bool BenchmarkRunner::loadBaseline()
+{
+    // the JSON written by toJSON(), not any JSON
+    std::string json = FileUtils::getInstance()->getStringFromFile(_baselinePath);
+    const std::string nameKey = "\"name\": \"";
+    size_t position = json.find(nameKey);
+    while (position != std::string::npos) {
+        size_t nameStart = position + nameKey.size();
+        size_t nameEnd = json.find('"', nameStart);
+        if (nameEnd == std::string::npos) {
+            break;
+        }
+        size_t next = json.find(nameKey, nameEnd);
+        size_t end = next == std::string::npos ? json.size() : next;
+
+        Baseline baseline;
+        baseline.p95FrameMs = findNumber(json, nameEnd, end, "frameMs", "p95");
+        baseline.maxDrawCalls = findNumber(json, nameEnd, end, "drawCalls", "max");
+        baseline.maxAllocations = findNumber(json, nameEnd, end, "allocations", "max");
+        if (baseline.p95FrameMs >= 0 && baseline.maxDrawCalls >= 0 && baseline.maxAllocations >= 0) {
+            _baselines[json.substr(nameStart, nameEnd - nameStart)] = baseline;
+        }
+        position = next;
+    }
+    return !_baselines.empty();
+}
+
+void BenchmarkRunner::finish()
+{
+    auto director = Director::getInstance();
+    director->getScheduler()->unschedule("BenchmarkRunner", this);
+    director->setFrameTimingsEnabled(false);
+    _running = false;
+
+    writeResults(toJSON(), "benchmark.json");
+    CCLOG("BenchmarkRunner: %s", getExitCode() == 0 ? "passed" : "FAILED");
+
+    if (_autoRun) {
+        director->end();
+    } else {
+        director->setDisplayStats(true);
+        director->replaceScene(Welcome::createScene());
+    }
+}
+
+void BenchmarkRunner::runMicroBenchmarks()
+{
+    if (_running) {
+        return;
+    }
+
+    CCLOG("BenchmarkRunner: micro benchmarks, %s math", MicroBenchmarks::getSIMDPath());
+    auto results = MicroBenchmarks::run(_microSelected);
+    writeResults(MicroBenchmarks::toJSON(results), "micro-benchmark.json");
+
+    if (_microBenchmark) {
+        Director::getInstance()->end();
+    }
+}
+
+void BenchmarkRunner::writeResults(const std::string& json, const std::string& defaultName)
+{
+    std::string path = _output.empty() ? FileUtils::getInstance()->getWritablePath() + defaultName : _output;
+    if (FileUtils::getInstance()->writeStringToFile(json, path)) {
+        CCLOG("BenchmarkRunner: results written to %s", path.c_str());
+    } else {
+        CCLOG("BenchmarkRunner: can't write %s", path.c_str());
+    }
+}
+
+BenchmarkRunner::Stats BenchmarkRunner::computeStats(std::vector<float> &values)
+{
+    Stats stats = {0, 0, 0, 0, 0, 0};
+    if (values.empty()) {
+        return stats;
+    }
+
+    std::sort(values.begin(), values.end());
+    // nearest rank
+    auto percentile = [&values](float p) {
+        size_t rank = (size_t)ceilf(p / 100 * values.size());
+        return values[std::max<size_t>(rank, 1) - 1];
+    };
+    stats.p50 = percentile(50);
+    stats.p90 = percentile(90);
+    stats.p95 = percentile(95);
+    stats.p99 = percentile(99);
+    stats.max = values.back();
+    double sum = 0;
+    for (float value : values) {
+        sum += value;
+    }
+    stats.mean = (float)(sum / values.size());
+    return stats;
+}
+
+size_t BenchmarkRunner::getResidentBytes()
+{
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_IOS) || (CC_TARGET_PLATFORM == CC_PLATFORM_MAC)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) == KERN_SUCCESS) {
+        return (size_t)info.resident_size;
+    }
+#elif (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID) || (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
+    FILE *file = fopen("/proc/self/statm", "r");
+    if (file) {
+        long size = 0, resident = 0;
+        int read = fscanf(file, "%ld %ld", &size, &resident);
+        fclose(file);
+        if (read == 2) {
+            return (size_t)resident * (size_t)sysconf(_SC_PAGESIZE);
+        }
+    }
+#endif
+    return 0;
+}
+
+static std::string statsToJSON(const char *name, const BenchmarkRunner::Stats &stats)
+{
+    return StringUtils::format("\"%s\": {\"p50\": %.3f, \"p90\": %.3f, \"p95\": %.3f, \"p99\": %.3f, \"max\": %.3f, \"mean\": %.3f}",
+                               name, stats.p50, stats.p90, stats.p95, stats.p99, stats.max, stats.mean);
+}
+
+static std::string escapeJSON(const std::string &text)
+{
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if ((unsigned char)c < 0x20) {
+            escaped += ' ';
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+std::string BenchmarkRunner::toJSON() const
+{
+    auto size = Director::getInstance()->getOpenGLView()->getFrameSize();
+    std::string json = "{\n";
+    json += StringUtils::format("  \"engine\": \"%s\",\n", escapeJSON(cocos2dVersion()).c_str());
+    json += StringUtils::format("  \"renderer\": \"%s\",\n",
+                                escapeJSON(Configuration::getInstance()->getValue("gl.renderer").asString()).c_str());
+    json += StringUtils::format("  \"width\": %d,\n  \"height\": %d,\n", (int)size.width, (int)size.height);
+    json += StringUtils::format("  \"offscreen\": %s,\n", _offscreen ? "true" : "false");
+    json += StringUtils::format("  \"warmup\": %.1f,\n  \"duration\": %.1f,\n", _warmup, _duration);
+    json += StringUtils::format("  \"passed\": %s,\n", getExitCode() == 0 ? "true" : "false");
+    json += "  \"scenarios\": [";
+    for (size_t i = 0; i < _results.size(); ++i) {
+        const Result &result = _results[i];
+        json += i == 0 ? "\n" : ",\n";
+        json += "    {\n";
+        json += StringUtils::format("      \"name\": \"%s\",\n", escapeJSON(result.name).c_str());
+        json += StringUtils::format("      \"frames\": %d,\n", result.frames);
+        json += "      " + statsToJSON("frameMs", result.total) + ",\n";
+        json += "      " + statsToJSON("cpuMs", result.cpu) + ",\n";
+        json += "      " + statsToJSON("gpuMs", result.gpu) + ",\n";
+        json += "      " + statsToJSON("drawCalls", result.drawnBatches) + ",\n";
+        json += "      " + statsToJSON("vertices", result.drawnVertices) + ",\n";
+        json += "      " + statsToJSON("stateCalls", result.issuedStateCalls) + ",\n";
+        json += "      " + statsToJSON("skippedStateCalls", result.skippedStateCalls) + ",\n";
+        json += "      " + statsToJSON("allocations", result.allocations) + ",\n";
+        json += StringUtils::format("      \"peakResidentBytes\": %zu,\n", result.peakResidentBytes);
+        json += StringUtils::format("      \"peakTextureBytes\": %zu,\n", result.peakTextureBytes);
+        const BenchmarkBudget &budget = getBenchmarkScenarios()[_queue[i]].budget;
+        json += StringUtils::format("      \"budget\": {\"p95FrameMs\": %.2f, \"maxDrawCalls\": %d, \"maxAllocationsPerFrame\": %d},\n",
+                                    budget.p95FrameMs, budget.maxDrawCalls, budget.maxAllocationsPerFrame);
+        if (result.hasBaseline) {
+            json += StringUtils::format("      \"baseline\": {\"p95FrameMs\": %.3f, \"maxDrawCalls\": %.0f, \"maxAllocationsPerFrame\": %.0f},\n",
+                                        result.baseline.p95FrameMs, result.baseline.maxDrawCalls, result.baseline.maxAllocations);
+        }
+        if (result.allocationSiteFrames > 0) {
+            json += "      \"allocationSites\": [";
+            for (size_t j = 0; j < result.allocationSites.size(); ++j) {
+                const auto &site = result.allocationSites[j];
+                json += StringUtils::format("%s{\"name\": \"%s\", \"perFrame\": %.2f, \"bytesPerFrame\": %.0f}",
+                                            j == 0 ? "" : ", ", escapeJSON(site.name).c_str(),
+                                            (double)site.count / result.allocationSiteFrames,
+                                            (double)site.bytes / result.allocationSiteFrames);
+            }
+            json += "],\n";
+        }
+        json += "      \"failures\": [";
+        for (size_t j = 0; j < result.failures.size(); ++j) {
+            json += StringUtils::format("%s\"%s\"", j == 0 ? "" : ", ", escapeJSON(result.failures[j]).c_str());
+        }
+        json += "]\n";
+        json += "    }";
+    }
+    json += "\n  ]\n}\n";
+    return json;
+}
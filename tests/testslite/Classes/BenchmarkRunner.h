@@ -0,0 +1,137 @@
+#ifndef __BENCHMARK_RUNNER_H__
+#define __BENCHMARK_RUNNER_H__
+
+#include "cocos2d.h"
+#include "base/CCAllocationProfiler.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ Runs the scenarios of getBenchmarkScenarios() one after the other and writes their results as JSON.
+
+ Each scenario is shown for `warmup` seconds, then its frames are measured for `duration` seconds from
+ Director::getFrameTimings(): the frame time percentiles (total, CPU without the swap, GPU when the driver
+ has timer queries), the draw calls, the vertices, the GL state calls, the operator new calls and the peak of
+ the resident and texture memory. With CC_ENABLE_ALLOCATION_PROFILER, the classes and sites the allocations come
+ from as well.
+
+ A scenario fails when it goes over its BenchmarkBudget, or when it regresses against a baseline, the JSON of an
+ earlier run: the p95 frame time or the most allocations of a frame by more than the tolerance, the most draw
+ calls of a frame at all. The failures are in the JSON and in the exit code of the desktop builds.
+
+ The command line options, see parseArguments():
+   --benchmark           runs all the scenarios at launch and quits when done
+   --benchmark=a,b       runs the given scenarios only
+   --offscreen           hidden window without vsync, desktop only
+   --warmup=seconds      2 by default
+   --duration=seconds    10 by default
+   --output=path         benchmark.json in the writable path by default
+   --baseline=path       the results to compare with
+   --tolerance=percent   the frame time and allocation growth allowed over the baseline, 10 by default
+   --micro-benchmark     runs MicroBenchmarks at launch instead of the scenarios and quits when done
+   --micro-benchmark=a,b runs the micro benchmarks whose name starts with a or b only
+                         micro-benchmark.json in the writable path by default
+ */
+class BenchmarkRunner
+{
+public:
+    static BenchmarkRunner* getInstance();
+
+    void parseArguments(int argc, const char * const *argv);
+
+    /** Whether --benchmark was given, AppDelegate starts the run at launch then. */
+    bool isAutoRun() const { return _autoRun; }
+    bool isOffscreen() const { return _offscreen; }
+    bool isRunning() const { return _running; }
+    /** Whether --micro-benchmark was given. */
+    bool isMicroBenchmark() const { return _microBenchmark; }
+
+    /** Runs the selected scenarios, or all of them. Returns to the Welcome scene when done, or quits with --benchmark. */
+    void start();
+
+    /** Runs MicroBenchmarks and writes their results, it blocks until they are done. Quits with --micro-benchmark. */
+    void runMicroBenchmarks();
+
+    /** 1 when a scenario of the last run failed, 0 otherwise. */
+    int getExitCode() const;
+
+    struct Stats
+    {
+        float p50, p90, p95, p99, max, mean;
+    };
+
+private:
+    // the numbers of a scenario the baseline is compared on
+    struct Baseline
+    {
+        float p95FrameMs;
+        float maxDrawCalls;
+        float maxAllocations;
+    };
+
+    struct Result
+    {
+        std::string name;
+        int frames;
+        Stats total, cpu, gpu;
+        Stats drawnBatches, drawnVertices, issuedStateCalls, skippedStateCalls, allocations;
+        size_t peakResidentBytes;
+        size_t peakTextureBytes;
+        bool hasBaseline;
+        Baseline baseline;
+        std::vector<std::string> failures;
+        // the most frequent AllocationProfiler entries, per frame
+        std::vector<cocos2d::AllocationProfiler::Entry> allocationSites;
+        unsigned int allocationSiteFrames;
+    };
+
+    BenchmarkRunner();
+
+    void tick(float dt);
+    void startScenario();
+    void finishScenario();
+    void collectFrames(unsigned int lastFrame);
+    void sampleMemory();
+    void checkResult(Result &result) const;
+    void finish();
+    bool loadBaseline();
+    std::string toJSON() const;
+    void writeResults(const std::string& json, const std::string& defaultName);
+
+    static Stats computeStats(std::vector<float> &values);
+    static size_t getResidentBytes();
+
+    bool _autoRun;
+    bool _offscreen;
+    float _warmup;
+    float _duration;
+    std::string _output;
+    std::string _baselinePath;
+    float _tolerance;
+    std::vector<std::string> _selected;
+    bool _microBenchmark;
+    std::vector<std::string> _microSelected;
+
+    bool _running;
+    std::vector<size_t> _queue;
+    size_t _current;
+    bool _measuring;
+    float _elapsed;
+    float _sinceSample;
+    // the next frame to collect
+    unsigned int _nextFrame;
+
+    std::vector<float> _total, _cpu, _gpu;
+    std::vector<float> _drawnBatches, _drawnVertices, _issuedStateCalls, _skippedStateCalls;
+    std::vector<float> _allocations;
+    unsigned long long _allocationCount;
+    size_t _peakResidentBytes;
+    size_t _peakTextureBytes;
+
+    std::map<std::string, Baseline> _baselines;
+    std::vector<Result> _results;
+};
+
+#endif // __BENCHMARK_RUNNER_H__
@@ -0,0 +1,337 @@
+
+#include "BenchmarkScenarios.h"
+#include "BenchmarkLuaScene.h"
+#include "base/base64.h"
+
+#include <math.h>
+
+USING_NS_CC;
+
+const std::vector<BenchmarkScenario>& getBenchmarkScenarios()
+{
+    // the draw calls sit a little above what the scenes need, the frame times are for a mid-range phone and the
+    // allocations leave room for the engine internals, but a doubled count fails
+    static const std::vector<BenchmarkScenario> scenarios = {
+        {"sprites", {33.3f, 4, 50}, []() -> Node* { return BenchmarkSprites::create(); }},
+        // every label has its own texture, 20 of them are rebuilt each frame
+        {"labels", {33.3f, 210, 2000}, []() -> Node* { return BenchmarkLabels::create(); }},
+        {"particles", {33.3f, 24, 50}, []() -> Node* { return BenchmarkParticles::create(); }},
+        {"tmx", {33.3f, 8, 50}, []() -> Node* { return BenchmarkTMX::create(); }},
+        {"actions", {33.3f, 4, 100}, []() -> Node* { return BenchmarkActions::create(); }},
+        {"drawnode", {33.3f, 8, 100}, []() -> Node* { return BenchmarkDrawNode::create(); }},
+        // a stencil panel takes 4 draw calls, a scissored one 1
+        {"clipping", {33.3f, 220, 100}, []() -> Node* { return BenchmarkClipping::create(); }},
+        // the stars of main.lua, updated from Lua through the bindings
+        {"lua", {33.3f, 8, 200}, []() -> Node* { return BenchmarkLua::create(); }},
+    };
+    return scenarios;
+}
+
+// ----
+
+BenchmarkScenarioLayer::BenchmarkScenarioLayer()
+: _frame(0)
+, _generator(20160627)
+{
+}
+
+bool BenchmarkScenarioLayer::init()
+{
+    if (!Layer::init()) {
+        return false;
+    }
+
+    _viewsize = Director::getInstance()->getOpenGLView()->getFrameSize();
+    this->scheduleUpdate();
+
+    return true;
+}
+
+void BenchmarkScenarioLayer::update(float dt)
+{
+    step(_frame++);
+}
+
+float BenchmarkScenarioLayer::_random(float min, float max)
+{
+    return std::uniform_real_distribution<float>(min, max)(_generator);
+}
+
+// ----
+
+bool BenchmarkSprites::init()
+{
+    if (!BenchmarkScenarioLayer::init()) {
+        return false;
+    }
+
+    const int count = 10000;
+    for (int i = 0; i < count; ++i) {
+        auto sprite = Sprite::create("star.png");
+        this->addChild(sprite);
+        _sprites.push_back(sprite);
+        _centers.push_back(Vec2(_random(0, _viewsize.width), _random(0, _viewsize.height)));
+    }
+
+    return true;
+}
+
+void BenchmarkSprites::step(int frame)
+{
+    for (size_t i = 0; i < _sprites.size(); ++i) {
+        float angle = (frame + i) * 6.0f * M_PI / 180.0f;
+        _sprites[i]->setPosition(_centers[i] + Vec2(sinf(angle) * 4.0f, cosf(angle) * 4.0f));
+        _sprites[i]->setOpacity((frame + i * 7) % 256);
+    }
+}
+
+// ----
+
+bool BenchmarkLabels::init()
+{
+    if (!BenchmarkScenarioLayer::init()) {
+        return false;
+    }
+
+    const int count = 200;
+    for (int i = 0; i < count; ++i) {
+        auto label = Label::createWithSystemFont(StringUtils::format("label %d", i), "sans", 16);
+        label->setPosition(_random(0, _viewsize.width), _random(0, _viewsize.height));
+        label->setColor(Color3B(_random(64, 255), _random(64, 255), _random(64, 255)));
+        this->addChild(label);
+        _labels.push_back(label);
+    }
+
+    return true;
+}
+
+void BenchmarkLabels::step(int frame)
+{
+    // a score or a timer, the others stay still
+    for (size_t i = 0; i < 20; ++i) {
+        _labels[(frame + i * 10) % _labels.size()]->setString(StringUtils::format("%d", frame * 31 + (int)i));
+    }
+}
+
+// ----
+
+bool BenchmarkParticles::init()
+{
+    if (!BenchmarkScenarioLayer::init()) {
+        return false;
+    }
+
+    auto texture = Director::getInstance()->getTextureCache()->addImage("star.png");
+    const int count = 20;
+    for (int i = 0; i < count; ++i) {
+        auto emitter = ParticleSystemQuad::createWithTotalParticles(500);
+        emitter->setTexture(texture);
+        emitter->setEmitterMode(ParticleSystem::Mode::GRAVITY);
+        emitter->setDuration(ParticleSystem::DURATION_INFINITY);
+        emitter->setGravity(Vec2(0, -60));
+        emitter->setSpeed(120);
+        emitter->setSpeedVar(40);
+        emitter->setAngle(90);
+        emitter->setAngleVar(30);
+        emitter->setLife(3);
+        emitter->setLifeVar(1);
+        emitter->setEmissionRate(500 / 3.0f);
+        emitter->setStartSize(16);
+        emitter->setEndSize(4);
+        emitter->setStartColor(Color4F(1, 0.8f, 0.3f, 1));
+        emitter->setEndColor(Color4F(1, 0.2f, 0.1f, 0));
+        emitter->setPosVar(Vec2(10, 10));
+        emitter->setPosition(_viewsize.width * (i + 0.5f) / count, _viewsize.height / 3);
+        this->addChild(emitter);
+        _emitters.push_back(emitter);
+    }
+
+    return true;
+}
+
+void BenchmarkParticles::step(int frame)
+{
+    for (size_t i = 0; i < _emitters.size(); ++i) {
+        float angle = (frame + i * 20) * 2.0f * M_PI / 180.0f;
+        _emitters[i]->setRotation(sinf(angle) * 30.0f);
+    }
+}
+
+// ----
+
+bool BenchmarkTMX::init()
+{
+    if (!BenchmarkScenarioLayer::init()) {
+        return false;
+    }
+
+    // HelloWorld.png cut in 32x32 tiles, 6 by 8
+    const int width = 256, height = 256, tileCount = 48;
+    std::string xml = StringUtils::format(
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+        "<map version=\"1.0\" orientation=\"orthogonal\" width=\"%d\" height=\"%d\" tilewidth=\"32\" tileheight=\"32\">"
+        "<tileset firstgid=\"1\" name=\"tiles\" tilewidth=\"32\" tileheight=\"32\">"
+        "<image source=\"HelloWorld.png\" width=\"195\" height=\"270\"/>"
+        "</tileset>", width, height);
+    std::vector<uint32_t> tiles(width * height);
+    for (int layer = 0; layer < 2; ++layer) {
+        for (auto& tile : tiles) {
+            // the second layer is sparse, like decorations over a ground
+            tile = (layer == 0 || _random(0, 1) < 0.2f) ? 1 + (uint32_t)_random(0, tileCount) % tileCount : 0;
+        }
+        char *encoded = nullptr;
+        base64Encode((const unsigned char*)tiles.data(), (unsigned int)(tiles.size() * sizeof(uint32_t)), &encoded);
+        xml += StringUtils::format("<layer name=\"layer%d\" width=\"%d\" height=\"%d\"><data encoding=\"base64\">",
+                                   layer, width, height);
+        xml += encoded;
+        xml += "</data></layer>";
+        free(encoded);
+    }
+    xml += "</map>";
+
+    const std::string path = FileUtils::getInstance()->fullPathForFilename("HelloWorld.png");
+    auto map = TMXTiledMap::createWithXML(xml, path.substr(0, path.find_last_of('/')));
+    if (!map) {
+        return false;
+    }
+    _map = map;
+    _mapSize = map->getContentSize();
+    this->addChild(map);
+
+    return true;
+}
+
+void BenchmarkTMX::step(int frame)
+{
+    // crosses the whole map in about a minute
+    float t = frame / 60.0f;
+    float rangeX = (_mapSize.width - _viewsize.width) / 2;
+    float rangeY = (_mapSize.height - _viewsize.height) / 2;
+    _map->setPosition(-rangeX * (1 + sinf(t * 0.11f)), -rangeY * (1 + sinf(t * 0.07f)));
+}
+
+// ----
+
+bool BenchmarkActions::init()
+{
+    if (!BenchmarkScenarioLayer::init()) {
+        return false;
+    }
+
+    const int count = 3000;
+    for (int i = 0; i < count; ++i) {
+        auto sprite = Sprite::create("star.png");
+        sprite->setPosition(_random(0, _viewsize.width), _random(0, _viewsize.height));
+        this->addChild(sprite);
+
+        float duration = _random(0.5f, 2.0f);
+        Vec2 offset(_random(-50, 50), _random(-50, 50));
+        auto move = Sequence::create(EaseSineInOut::create(MoveBy::create(duration, offset)),
+                                     EaseSineInOut::create(MoveBy::create(duration, -offset)), nullptr);
+        auto fade = Sequence::create(FadeTo::create(duration * 0.7f, 64), FadeTo::create(duration * 0.7f, 255), nullptr);
+        auto scale = Sequence::create(ScaleTo::create(duration * 1.3f, 1.5f), ScaleTo::create(duration * 1.3f, 1.0f), nullptr);
+        sprite->runAction(RepeatForever::create(move));
+        sprite->runAction(RepeatForever::create(fade));
+        sprite->runAction(RepeatForever::create(scale));
+        sprite->runAction(RepeatForever::create(RotateBy::create(duration, 360)));
+    }
+
+    return true;
+}
+
+// ----
+
+bool BenchmarkDrawNode::init()
+{
+    if (!BenchmarkScenarioLayer::init()) {
+        return false;
+    }
+
+    for (int i = 0; i < 4; ++i) {
+        auto drawNode = DrawNode::create();
+        drawNode->setBatchingEnabled(true);
+        this->addChild(drawNode);
+        _drawNodes.push_back(drawNode);
+    }
+
+    return true;
+}
+
+void BenchmarkDrawNode::step(int frame)
+{
+    // a debug overlay redrawn from scratch every frame
+    std::mt19937 generator(frame % 120);
+    std::uniform_real_distribution<float> x(0, _viewsize.width), y(0, _viewsize.height), unit(0, 1);
+    for (auto drawNode : _drawNodes) {
+        drawNode->clear();
+        for (int i = 0; i < 400; ++i) {
+            drawNode->drawDot(Vec2(x(generator), y(generator)), 3, Color4F(unit(generator), unit(generator), 1, 1));
+        }
+        for (int i = 0; i < 400; ++i) {
+            Vec2 from(x(generator), y(generator));
+            drawNode->drawSegment(from, from + Vec2(40 * unit(generator), 40 * unit(generator)), 1, Color4F(1, unit(generator), 0, 1));
+        }
+        for (int i = 0; i < 200; ++i) {
+            Vec2 origin(x(generator), y(generator));
+            Vec2 corners[] = {origin, origin + Vec2(20, 0), origin + Vec2(20, 20), origin + Vec2(0, 20)};
+            drawNode->drawPolygon(corners, 4, Color4F(0, 1, unit(generator), 0.5f), 1, Color4F(1, 1, 1, 1));
+        }
+    }
+}
+
+// ----
+
+bool BenchmarkClipping::init()
+{
+    if (!BenchmarkScenarioLayer::init()) {
+        return false;
+    }
+
+    const Size size(96, 96);
+    const int columns = 10;
+    for (int i = 0; i < 80; ++i) {
+        auto stencil = DrawNode::create();
+        if (i % 2 == 0) {
+            stencil->drawSolidRect(Vec2::ZERO, Vec2(size.width, size.height), Color4F::WHITE);
+        } else {
+            stencil->drawSolidCircle(Vec2(size.width / 2, size.height / 2), size.width / 2, 0, 32, Color4F::WHITE);
+        }
+        auto clipper = ClippingNode::create(stencil);
+        clipper->setPosition((i % columns) * _viewsize.width / columns, (i / columns) * _viewsize.height / 8);
+        _fillPanel(clipper, size);
+        this->addChild(clipper);
+        _panels.push_back(clipper);
+    }
+
+    // a scroll view in a scroll view
+    auto outer = ClippingRectangleNode::create(Rect(0, 0, _viewsize.width / 2, _viewsize.height / 2));
+    outer->setPosition(_viewsize.width / 4, _viewsize.height / 4);
+    auto inner = ClippingRectangleNode::create(Rect(0, 0, _viewsize.width / 4, _viewsize.height / 4));
+    inner->setPosition(_viewsize.width / 8, _viewsize.height / 8);
+    _fillPanel(outer, Size(_viewsize.width / 2, _viewsize.height / 2));
+    _fillPanel(inner, Size(_viewsize.width / 4, _viewsize.height / 4));
+    outer->addChild(inner);
+    this->addChild(outer);
+
+    return true;
+}
+
+void BenchmarkClipping::_fillPanel(Node *panel, const Size &size)
+{
+    for (int i = 0; i < 20; ++i) {
+        auto sprite = Sprite::create("star.png");
+        sprite->setPosition(_random(0, size.width), _random(0, size.height));
+        panel->addChild(sprite);
+        _sprites.push_back(sprite);
+    }
+}
+
+void BenchmarkClipping::step(int frame)
+{
+    // the sprites cross the edges of their panels
+    for (size_t i = 0; i < _sprites.size(); ++i) {
+        float angle = (frame + i * 13) * 3.0f * M_PI / 180.0f;
+        Vec2 position = _sprites[i]->getPosition();
+        _sprites[i]->setPosition(position + Vec2(cosf(angle), sinf(angle)));
+    }
+}
@@ -0,0 +1,147 @@
+#ifndef __BENCHMARK_SCENARIOS_H__
+#define __BENCHMARK_SCENARIOS_H__
+
+#include "cocos2d.h"
+
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+USING_NS_CC;
+
+// The ceilings of a scenario, BenchmarkRunner fails the run when one is exceeded. 0 isn't checked.
+struct BenchmarkBudget
+{
+    // the 95th percentile of the frame time, in milliseconds
+    float p95FrameMs;
+    // the most draw calls of a frame
+    int maxDrawCalls;
+    // the most calls of operator new in a frame, see AllocationCounter
+    int maxAllocationsPerFrame;
+};
+
+// A fixed workload run by BenchmarkRunner for a fixed duration. The layers move their nodes from the number of
+// frames elapsed and draw their random numbers from a fixed seed, so every run draws the same frames.
+struct BenchmarkScenario
+{
+    std::string name;
+    BenchmarkBudget budget;
+    std::function<Node*()> create;
+};
+
+// the scenarios in the order they run: sprites, labels, particles, tmx, actions, drawnode, clipping, lua
+const std::vector<BenchmarkScenario>& getBenchmarkScenarios();
+
+class BenchmarkScenarioLayer : public Layer
+{
+public:
+    BenchmarkScenarioLayer();
+
+    virtual bool init();
+    virtual void update(float dt);
+
+protected:
+    // moves the nodes for the frame, counted from 0
+    virtual void step(int frame) {}
+
+    float _random(float min, float max);
+
+    Size _viewsize;
+    int _frame;
+    std::mt19937 _generator;
+};
+
+// 10000 stars moving on circles with a changing opacity
+class BenchmarkSprites : public BenchmarkScenarioLayer
+{
+public:
+    virtual bool init();
+    CREATE_FUNC(BenchmarkSprites);
+
+protected:
+    virtual void step(int frame);
+
+    std::vector<Sprite*> _sprites;
+    std::vector<Vec2> _centers;
+};
+
+// 200 system font labels, 20 of them change their string every frame
+class BenchmarkLabels : public BenchmarkScenarioLayer
+{
+public:
+    virtual bool init();
+    CREATE_FUNC(BenchmarkLabels);
+
+protected:
+    virtual void step(int frame);
+
+    std::vector<Label*> _labels;
+};
+
+// 20 emitters of 500 particles
+class BenchmarkParticles : public BenchmarkScenarioLayer
+{
+public:
+    virtual bool init();
+    CREATE_FUNC(BenchmarkParticles);
+
+protected:
+    virtual void step(int frame);
+
+    std::vector<ParticleSystemQuad*> _emitters;
+};
+
+// a 256x256 tile map of two layers scrolled on a Lissajous curve
+class BenchmarkTMX : public BenchmarkScenarioLayer
+{
+public:
+    virtual bool init();
+    CREATE_FUNC(BenchmarkTMX);
+
+protected:
+    virtual void step(int frame);
+
+    Node *_map;
+    Size _mapSize;
+};
+
+// 3000 sprites running move, rotate, scale and fade sequences
+class BenchmarkActions : public BenchmarkScenarioLayer
+{
+public:
+    virtual bool init();
+    CREATE_FUNC(BenchmarkActions);
+};
+
+// 4 batched DrawNodes cleared and redrawn every frame with 1000 dots, segments and polygons each
+class BenchmarkDrawNode : public BenchmarkScenarioLayer
+{
+public:
+    virtual bool init();
+    CREATE_FUNC(BenchmarkDrawNode);
+
+protected:
+    virtual void step(int frame);
+
+    std::vector<DrawNode*> _drawNodes;
+};
+
+// 40 rect clipped panels on the scissor path, 40 circle clipped ones on the stencil path and
+// nested ClippingRectangleNodes, 20 moving sprites in each
+class BenchmarkClipping : public BenchmarkScenarioLayer
+{
+public:
+    virtual bool init();
+    CREATE_FUNC(BenchmarkClipping);
+
+protected:
+    virtual void step(int frame);
+
+    void _fillPanel(Node *panel, const Size &size);
+
+    std::vector<Node*> _panels;
+    std::vector<Sprite*> _sprites;
+};
+
+#endif // __BENCHMARK_SCENARIOS_H__
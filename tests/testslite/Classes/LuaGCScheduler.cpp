@@ -0,0 +1,68 @@
+
+#include "LuaGCScheduler.h"
+
+USING_NS_CC;
+
+LuaGCScheduler::LuaGCScheduler(lua_State *L)
+: _L(L)
+, _listener(nullptr)
+, _scene(nullptr)
+, _collecting(false)
+, _threshold(0)
+, _stepSize(16)
+, _pause(200)
+, _margin(0.001f)
+{
+    lua_gc(_L, LUA_GCSTOP, 0);
+    finishCycle();
+
+    Director *director = Director::getInstance();
+    _scene = director->getRunningScene();
+    _listener = director->getEventDispatcher()->addCustomEventListener(Director::EVENT_AFTER_FRAME, [this](EventCustom*) {
+        onFrameEnd();
+    });
+}
+
+LuaGCScheduler::~LuaGCScheduler()
+{
+    Director::getInstance()->getEventDispatcher()->removeEventListener(_listener);
+    lua_gc(_L, LUA_GCRESTART, 0);
+}
+
+void LuaGCScheduler::finishCycle()
+{
+    _collecting = false;
+    _threshold = lua_gc(_L, LUA_GCCOUNT, 0) * _pause / 100;
+}
+
+void LuaGCScheduler::onFrameEnd()
+{
+    Director *director = Director::getInstance();
+
+    // the previous scene is gone, its garbage is collected at once while the new one starts
+    Scene *scene = director->getRunningScene();
+    if (scene != _scene) {
+        _scene = scene;
+        lua_gc(_L, LUA_GCCOLLECT, 0);
+        lua_gc(_L, LUA_GCSTOP, 0);
+        finishCycle();
+        return;
+    }
+
+    if (!_collecting) {
+        if (lua_gc(_L, LUA_GCCOUNT, 0) < _threshold) {
+            return;
+        }
+        _collecting = true;
+    }
+
+    do {
+        if (lua_gc(_L, LUA_GCSTEP, _stepSize)) {
+            finishCycle();
+            break;
+        }
+    } while (director->getFrameTimeLeft() > _margin);
+
+    // a step sets the threshold of the automatic collection again
+    lua_gc(_L, LUA_GCSTOP, 0);
+}
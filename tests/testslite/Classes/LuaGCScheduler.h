@@ -0,0 +1,47 @@
+#ifndef __LUA_GC_SCHEDULER_H__
+#define __LUA_GC_SCHEDULER_H__
+
+#include "cocos2d.h"
+#include "lua.hpp"
+
+/**
+ Runs the garbage collector of a Lua state in the idle time of the frames instead of in the middle of them.
+
+ The automatic collection is stopped. At the end of each frame (Director::EVENT_AFTER_FRAME) the collector is
+ stepped until the time left in the frame runs out, at least one step per frame while a cycle is in progress
+ so it still finishes under load. A new cycle starts when the memory grows by `pause` percent after the last one,
+ like the pause of the automatic collector. The first frame of a new scene does a full collection.
+ */
+class LuaGCScheduler
+{
+public:
+    explicit LuaGCScheduler(lua_State *L);
+    /** Restarts the automatic collection, call it before closing the state. */
+    ~LuaGCScheduler();
+
+    /** The size of one step in KB, as for lua_gc(LUA_GCSTEP). */
+    void setStepSize(int kilobytes) { _stepSize = kilobytes; }
+    /** The memory growth in percent that starts a new cycle. */
+    void setPause(int percent) { _pause = percent; }
+    /** The time in seconds kept at the end of the frame, the steps stop before it. */
+    void setMargin(float seconds) { _margin = seconds; }
+
+private:
+    LuaGCScheduler(const LuaGCScheduler&) = delete;
+    LuaGCScheduler& operator= (const LuaGCScheduler&) = delete;
+
+    void onFrameEnd();
+    void finishCycle();
+
+    lua_State *_L;
+    cocos2d::EventListenerCustom *_listener;
+    // compared only, the scene of the last frame
+    cocos2d::Scene *_scene;
+    bool _collecting;
+    int _threshold;
+    int _stepSize;
+    int _pause;
+    float _margin;
+};
+
+#endif // __LUA_GC_SCHEDULER_H__
@@ -0,0 +1,223 @@
+
+#include "LuaProfiler.h"
+
+#include <sys/socket.h>
+#include <unordered_map>
+
+USING_NS_CC;
+
+// the deepest Lua frames sampled, the outermost ones are kept
+static const int MAX_SAMPLED_DEPTH = 64;
+#ifndef LUAJIT_VERSION
+// the instructions between two checks of the interval
+static const int HOOK_INSTRUCTIONS = 1000;
+#endif
+
+LuaProfiler *LuaProfiler::s_current = nullptr;
+
+LuaProfiler::LuaProfiler(lua_State *L)
+: _L(L)
+, _running(false)
+, _interval(0)
+, _lastSample(0)
+{
+    s_current = this;
+}
+
+LuaProfiler::~LuaProfiler()
+{
+    stop();
+    if (s_current == this) {
+        s_current = nullptr;
+    }
+}
+
+void LuaProfiler::start(int interval)
+{
+    if (_running) {
+        return;
+    }
+    _running = true;
+    _interval = std::max(interval, 1) * 1000000LL;
+    _lastSample = Tracer::now();
+
+    if (!Tracer::isRecording()) {
+        Tracer::start();
+    }
+
+#ifdef LUAJIT_VERSION
+    char mode[16];
+    snprintf(mode, sizeof(mode), "fi%d", std::max(interval, 1));
+    luaJIT_profile_start(_L, mode, onSample, this);
+#else
+    lua_sethook(_L, onHook, LUA_MASKCOUNT, HOOK_INSTRUCTIONS);
+#endif
+}
+
+void LuaProfiler::stop()
+{
+    if (!_running) {
+        return;
+    }
+    _running = false;
+
+#ifdef LUAJIT_VERSION
+    luaJIT_profile_stop(_L);
+#else
+    lua_sethook(_L, nullptr, 0, 0);
+#endif
+    closeFrames(0, std::min(_lastSample + _interval, Tracer::now()));
+}
+
+int LuaProfiler::getZone(const char *name, size_t length)
+{
+    // never freed, the Tracer keeps the names of the zones
+    static auto zones = new std::unordered_map<std::string, int>();
+
+    std::string key(name, length);
+    auto iter = zones->find(key);
+    if (iter == zones->end()) {
+        iter = zones->emplace(key, 0).first;
+        iter->second = Tracer::registerZone("lua", iter->first.c_str());
+    }
+    return iter->second;
+}
+
+void LuaProfiler::closeFrames(size_t count, int64_t end)
+{
+    while (_frames.size() > count) {
+        const Frame &frame = _frames.back();
+        Tracer::record(frame.zone, frame.start, std::max(end, frame.start));
+        _frames.pop_back();
+    }
+}
+
+void LuaProfiler::sample(const std::vector<int> &zones)
+{
+    int64_t time = Tracer::now();
+
+    // the script didn't run since the last sample, its functions returned in between
+    if (time - _lastSample > _interval * 2) {
+        closeFrames(0, _lastSample + _interval);
+    }
+
+    size_t common = 0;
+    while (common < _frames.size() && common < zones.size() && _frames[common].zone == zones[common]) {
+        ++common;
+    }
+    closeFrames(common, time);
+    for (size_t i = common; i < zones.size(); ++i) {
+        Frame frame = { zones[i], time };
+        _frames.push_back(frame);
+    }
+    _lastSample = time;
+}
+
+#ifdef LUAJIT_VERSION
+
+void LuaProfiler::onSample(void *data, lua_State *L, int samples, int vmstate)
+{
+    auto profiler = static_cast<LuaProfiler*>(data);
+
+    // the function names, outermost first and separated by ';'
+    size_t length = 0;
+    const char *stack = luaJIT_profile_dumpstack(L, "FZ;", -MAX_SAMPLED_DEPTH, &length);
+
+    profiler->_stack.clear();
+    size_t begin = 0;
+    for (size_t i = 0; i <= length; ++i) {
+        if (i == length || stack[i] == ';') {
+            if (i > begin) {
+                profiler->_stack.push_back(getZone(stack + begin, i - begin));
+            }
+            begin = i + 1;
+        }
+    }
+
+    // the time the VM spent outside of the script
+    if (vmstate == 'G') {
+        profiler->_stack.push_back(getZone("(garbage collector)", 19));
+    } else if (vmstate == 'J') {
+        profiler->_stack.push_back(getZone("(jit compiler)", 14));
+    }
+
+    profiler->sample(profiler->_stack);
+}
+
+#else
+
+void LuaProfiler::onHook(lua_State *L, lua_Debug * /*ar*/)
+{
+    auto profiler = s_current;
+    if (profiler == nullptr || profiler->_L != L || Tracer::now() - profiler->_lastSample < profiler->_interval) {
+        return;
+    }
+
+    // lua_getstack counts from the running function
+    int depth = 0;
+    lua_Debug info;
+    while (depth < MAX_SAMPLED_DEPTH && lua_getstack(L, depth, &info)) {
+        ++depth;
+    }
+
+    profiler->_stack.clear();
+    char name[256];
+    for (int level = depth - 1; level >= 0; --level) {
+        lua_getstack(L, level, &info);
+        lua_getinfo(L, "Sn", &info);
+        int length = info.name
+            ? snprintf(name, sizeof(name), "%s:%s", info.short_src, info.name)
+            : snprintf(name, sizeof(name), "%s:%d", info.short_src, info.linedefined);
+        length = std::min(length, (int)sizeof(name) - 1);
+        profiler->_stack.push_back(getZone(name, std::max(length, 0)));
+    }
+
+    profiler->sample(profiler->_stack);
+}
+
+#endif
+
+// dprintf() is not defined on every platform
+static void sendText(int fd, const std::string &text)
+{
+    send(fd, text.c_str(), text.length(), 0);
+}
+
+void LuaProfiler::addConsoleCommand()
+{
+    static bool added = false;
+    if (added) {
+        return;
+    }
+    added = true;
+
+    Console::Command command = { "luaprofile", "Sample the Lua stack into the trace, see the trace command. Args: [start [interval ms] | stop | ]",
+        [](int fd, const std::string &args) {
+            Scheduler *scheduler = Director::getInstance()->getScheduler();
+            if (args.compare(0, 5, "start") == 0) {
+                int interval = args.length() > 6 ? atoi(args.c_str() + 6) : 1;
+                scheduler->performFunctionInCocosThread([=]() {
+                    if (s_current) {
+                        s_current->start(interval);
+                        sendText(fd, "Lua profiler started, write the trace with: trace stop [file]\n> ");
+                    } else {
+                        sendText(fd, "No Lua state to profile\n> ");
+                    }
+                });
+            } else if (args.compare("stop") == 0) {
+                scheduler->performFunctionInCocosThread([=]() {
+                    if (s_current) {
+                        s_current->stop();
+                    }
+                });
+            } else if (args.empty()) {
+                scheduler->performFunctionInCocosThread([=]() {
+                    sendText(fd, s_current && s_current->isRunning() ? "Lua profiler is: running\n> " : "Lua profiler is: stopped\n> ");
+                });
+            } else {
+                sendText(fd, "Unsupported argument: '" + args + "'. Supported arguments: 'start [interval ms]', 'stop' or nothing\n");
+            }
+        }
+    };
+    Director::getInstance()->getConsole()->addCommand(command);
+}
@@ -0,0 +1,72 @@
+#ifndef __LUA_PROFILER_H__
+#define __LUA_PROFILER_H__
+
+#include "cocos2d.h"
+#include "lua.hpp"
+
+#include <string>
+#include <vector>
+
+/**
+ Samples the Lua stack of a state and records its functions as zones of the engine trace (cocos2d::Tracer).
+
+ With LuaJIT the samples come from its profiler (jit.profile), on plain Lua from a count hook that takes a sample
+ when the interval has passed. Each function of the sampled stack is a zone of the "lua" category, open from the
+ first sample it is on the stack to the first one it isn't, on the thread that runs the script. The Lua callbacks
+ are then nested in the Scheduler::update and EventDispatcher zones of the same timeline. A zone ends one interval
+ after its last sample when the script stopped running in between.
+
+ The console command "luaprofile" starts and stops the profiler of the current state, the trace is written with
+ the "trace stop [file]" command. Only one state is profiled at a time.
+ */
+class LuaProfiler
+{
+public:
+    explicit LuaProfiler(lua_State *L);
+    /** Stops sampling, call it before closing the state. */
+    ~LuaProfiler();
+
+    /** Starts sampling every `interval` milliseconds, and the Tracer if it isn't recording. */
+    void start(int interval = 1);
+    /** Stops sampling and closes the zones that are still open. */
+    void stop();
+    bool isRunning() const { return _running; }
+
+    /** The profiler of the "luaprofile" console command, the last one created. */
+    static LuaProfiler* getCurrent() { return s_current; }
+    /** Adds the "luaprofile" command to the console of the Director, once. */
+    static void addConsoleCommand();
+
+private:
+    LuaProfiler(const LuaProfiler&) = delete;
+    LuaProfiler& operator= (const LuaProfiler&) = delete;
+
+    // a function of the stack, the zone is recorded when it leaves the stack
+    struct Frame
+    {
+        int zone;
+        int64_t start;
+    };
+
+    void sample(const std::vector<int>& zones);
+    void closeFrames(size_t count, int64_t end);
+
+#ifdef LUAJIT_VERSION
+    static void onSample(void *data, lua_State *L, int samples, int vmstate);
+#else
+    static void onHook(lua_State *L, lua_Debug *ar);
+#endif
+    static int getZone(const char *name, size_t length);
+
+    lua_State *_L;
+    bool _running;
+    int64_t _interval;
+    int64_t _lastSample;
+    std::vector<Frame> _frames;
+    // the zones of the current sample, reused
+    std::vector<int> _stack;
+
+    static LuaProfiler *s_current;
+};
+
+#endif // __LUA_PROFILER_H__
@@ -7,9 +7,16 @@
 //
 
 #include <string.h>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
 
 #include "Luabinding.hpp"
+#include "LuabindingAsync.hpp"
+#include "LuabindingFFI.hpp"
+#include "LuabindingTemplates.hpp"
 #include "cocos2d.h"
+#include "base/CCAssetPack.h"
 
 extern "C" {
 #include "lua.h"
@@ -26,6 +33,208 @@ static int l_get_class(lua_State *L, const char *name)
     return 1;
 }
 
+// the proxies of the Refs, reg["cc.ubox"][lightuserdata] = userdata, with weak values
+static const char *UBOX = "cc.ubox";
+static lua_State *s_ubox_L = NULL;
+
+static void l_updates_remove(lua_State *L, Ref *ref);
+static void l_updates_close(lua_State *L);
+
+static int l_ubox_meta_gc(lua_State *L)
+{
+    // the state is closed, the Refs left have no proxy to drop
+    s_ubox_L = NULL;
+    l_updates_close(L);
+    l_async_close(L);
+    return 0;
+}
+
+static void l_ubox_remove(Ref *ref)
+{
+    lua_State *L = s_ubox_L;
+    if (L == NULL || ref->getScriptObject() != L) {
+        return;
+    }
+
+    lua_getfield(L, LUA_REGISTRYINDEX, UBOX);   // L: ubox
+    lua_pushlightuserdata(L, ref);
+    lua_rawget(L, -2);                          // L: ubox ud
+    void **ud = static_cast<void**>(lua_touserdata(L, -1));
+    if (ud && *ud == ref) {
+        *ud = NULL;                             // the proxy outlives the Ref, it points to nothing now
+    }
+    lua_pop(L, 1);                              // L: ubox
+    lua_pushlightuserdata(L, ref);
+    lua_pushnil(L);
+    lua_rawset(L, -3);                          // ubox[ref] = nil
+    lua_pop(L, 1);
+
+    l_updates_remove(L, ref);
+}
+
+// the nodes updated from Lua, one scheduler callback per frame calls all their functions from a Lua loop,
+// reg["cc.updates"][slot] = function of s_update_nodes[slot - 1], false once unscheduled
+static const char *UPDATES = "cc.updates";
+static const char *UPDATES_LIST = "cc.updates.list";
+static const char *UPDATES_DISPATCH = "cc.updates.dispatch";
+static std::vector<Node*> s_update_nodes;
+static std::unordered_map<Ref*, int> s_update_slots;
+static int s_update_holes = 0;
+
+// L: funcs list, returns the loop over the slots written in list
+static const char *UPDATES_DISPATCH_SOURCE =
+    "local funcs, list = ...\n"
+    "return function(dt, n)\n"
+    "    for i = 1, n do\n"
+    "        local f = funcs[list[i]]\n"
+    "        if f then f(dt) end\n"
+    "    end\n"
+    "end\n";
+
+static void l_updates_compact(lua_State *L)
+{
+    lua_getfield(L, LUA_REGISTRYINDEX, UPDATES);    // L: funcs
+    int count = 0;
+    for (int i = 0, n = (int)s_update_nodes.size(); i < n; ++i) {
+        Node *node = s_update_nodes[i];
+        if (node == nullptr) {
+            continue;
+        }
+        if (count != i) {
+            s_update_nodes[count] = node;
+            s_update_slots[node] = count + 1;
+            lua_rawgeti(L, -1, i + 1);
+            lua_rawseti(L, -2, count + 1);
+        }
+        ++count;
+    }
+    for (int i = count, n = (int)s_update_nodes.size(); i < n; ++i) {
+        lua_pushnil(L);
+        lua_rawseti(L, -2, i + 1);
+    }
+    lua_pop(L, 1);
+    s_update_nodes.resize(count);
+    s_update_holes = 0;
+}
+
+static void l_updates_dispatch(lua_State *L, float dt)
+{
+    // the slots only move between the calls of the Lua loop
+    if (s_update_holes > 0) {
+        l_updates_compact(L);
+    }
+
+    // the slots of the running nodes that aren't paused, in the order they were scheduled
+    Scheduler *scheduler = Director::getInstance()->getScheduler();
+    lua_getfield(L, LUA_REGISTRYINDEX, UPDATES_DISPATCH);  // L: dispatch
+    lua_getfield(L, LUA_REGISTRYINDEX, UPDATES_LIST);      // L: dispatch list
+    int count = 0;
+    for (int i = 0, n = (int)s_update_nodes.size(); i < n; ++i) {
+        Node *node = s_update_nodes[i];
+        if (node && node->isRunning() && !scheduler->isTargetPaused(node)) {
+            lua_pushinteger(L, i + 1);
+            lua_rawseti(L, -2, ++count);
+        }
+    }
+    lua_pop(L, 1);                                          // L: dispatch
+
+    lua_pushnumber(L, dt);
+    lua_pushinteger(L, count);
+    if (lua_pcall(L, 2, 0, 0) != 0) {
+        CCLOG("l_updates_dispatch: %s", lua_tostring(L, -1));
+        lua_pop(L, 1);
+    }
+}
+
+static void l_updates_add(lua_State *L, Node *node, int idx)
+{
+    // L: ... func at idx
+    lua_getfield(L, LUA_REGISTRYINDEX, UPDATES);    // L: funcs
+    lua_pushvalue(L, idx);
+    auto it = s_update_slots.find(node);
+    if (it != s_update_slots.end()) {
+        lua_rawseti(L, -2, it->second);             // funcs[slot] = func, scheduled again
+        lua_pop(L, 1);
+        return;
+    }
+    s_update_nodes.push_back(node);
+    s_update_slots[node] = (int)s_update_nodes.size();
+    lua_rawseti(L, -2, (int)s_update_nodes.size());
+    lua_pop(L, 1);
+
+    Scheduler *scheduler = Director::getInstance()->getScheduler();
+    if (!scheduler->isScheduled(UPDATES, L)) {
+        scheduler->schedule([L](float dt) {
+            l_updates_dispatch(L, dt);
+        }, L, 0, false, UPDATES);
+    }
+}
+
+static void l_updates_remove(lua_State *L, Ref *ref)
+{
+    auto it = s_update_slots.find(ref);
+    if (it == s_update_slots.end()) {
+        return;
+    }
+    const int slot = it->second;
+    s_update_slots.erase(it);
+    s_update_nodes[slot - 1] = nullptr;
+    ++s_update_holes;
+
+    lua_getfield(L, LUA_REGISTRYINDEX, UPDATES);    // L: funcs
+    lua_pushboolean(L, 0);
+    lua_rawseti(L, -2, slot);                       // funcs[slot] = false, skipped if the loop is running
+    lua_pop(L, 1);
+}
+
+static void l_create_updates(lua_State *L)
+{
+    lua_newtable(L);                                // L: funcs
+    lua_pushvalue(L, -1);
+    lua_setfield(L, LUA_REGISTRYINDEX, UPDATES);
+    lua_newtable(L);                                // L: funcs list
+    lua_pushvalue(L, -1);
+    lua_setfield(L, LUA_REGISTRYINDEX, UPDATES_LIST);
+
+    luaL_loadstring(L, UPDATES_DISPATCH_SOURCE);    // L: funcs list chunk
+    lua_insert(L, -3);                              // L: chunk funcs list
+    lua_call(L, 2, 1);                              // L: dispatch
+    lua_setfield(L, LUA_REGISTRYINDEX, UPDATES_DISPATCH);
+
+    s_update_nodes.clear();
+    s_update_slots.clear();
+    s_update_holes = 0;
+}
+
+static void l_updates_close(lua_State *L)
+{
+    Director::getInstance()->getScheduler()->unschedule(UPDATES, L);
+    s_update_nodes.clear();
+    s_update_slots.clear();
+    s_update_holes = 0;
+}
+
+static void l_create_ubox(lua_State *L)
+{
+    lua_newtable(L);                            // L: ubox
+    lua_newtable(L);                            // L: ubox mt
+    lua_pushstring(L, "v");
+    lua_setfield(L, -2, "__mode");
+    lua_setmetatable(L, -2);                    // setmetatable(ubox, {__mode = "v"})
+    lua_setfield(L, LUA_REGISTRYINDEX, UBOX);
+
+    // a sentinel finalized by lua_close()
+    lua_newuserdata(L, 1);                      // L: sentinel
+    lua_newtable(L);                            // L: sentinel mt
+    lua_pushcfunction(L, l_ubox_meta_gc);
+    lua_setfield(L, -2, "__gc");
+    lua_setmetatable(L, -2);
+    lua_setfield(L, LUA_REGISTRYINDEX, "cc.ubox.sentinel");
+
+    s_ubox_L = L;
+    Ref::setScriptObjectRemover(l_ubox_remove);
+}
+
 static int l_register_class(lua_State *L, const char *name, lua_CFunction f)
 {
     lua_newtable(L);                            // L: cls
@@ -105,6 +314,80 @@ static int l_meta_newindex(lua_State *L)
     return (*setter)(L);
 }
 
+// value types, passed as numbers or as tables {x = , y = } and so on, without allocating,
+// the cc.Vec2.new() userdata are still read
+
+static float l_get_number_field(lua_State *L, int idx, const char *key, int i, float def)
+{
+    lua_getfield(L, idx, key);
+    if (lua_isnil(L, -1)) {
+        lua_pop(L, 1);
+        lua_rawgeti(L, idx, i);                 // {x, y} works too
+    }
+    float value = lua_isnumber(L, -1) ? (float)lua_tonumber(L, -1) : def;
+    lua_pop(L, 1);
+    return value;
+}
+
+bool l_to_vec2(lua_State *L, int idx, Vec2 *out)
+{
+    if (lua_istable(L, idx)) {
+        out->x = l_get_number_field(L, idx, "x", 1, 0);
+        out->y = l_get_number_field(L, idx, "y", 2, 0);
+        return true;
+    }
+    Vec2 *vec2 = static_cast<Vec2*>(l_to_userdata(L, idx));
+    if (vec2) {
+        *out = *vec2;
+    }
+    return vec2 != NULL;
+}
+
+bool l_to_size(lua_State *L, int idx, Size *out)
+{
+    if (lua_istable(L, idx)) {
+        out->width = l_get_number_field(L, idx, "width", 1, 0);
+        out->height = l_get_number_field(L, idx, "height", 2, 0);
+        return true;
+    }
+    Size *size = static_cast<Size*>(l_to_userdata(L, idx));
+    if (size) {
+        *out = *size;
+    }
+    return size != NULL;
+}
+
+bool l_to_color3b(lua_State *L, int idx, Color3B *out)
+{
+    if (lua_istable(L, idx)) {
+        out->r = (GLubyte)l_get_number_field(L, idx, "r", 1, 0);
+        out->g = (GLubyte)l_get_number_field(L, idx, "g", 2, 0);
+        out->b = (GLubyte)l_get_number_field(L, idx, "b", 3, 0);
+        return true;
+    }
+    Color3B *color = static_cast<Color3B*>(l_to_userdata(L, idx));
+    if (color) {
+        *out = *color;
+    }
+    return color != NULL;
+}
+
+bool l_to_color4b(lua_State *L, int idx, Color4B *out)
+{
+    if (lua_istable(L, idx)) {
+        out->r = (GLubyte)l_get_number_field(L, idx, "r", 1, 0);
+        out->g = (GLubyte)l_get_number_field(L, idx, "g", 2, 0);
+        out->b = (GLubyte)l_get_number_field(L, idx, "b", 3, 0);
+        out->a = (GLubyte)l_get_number_field(L, idx, "a", 4, 255);
+        return true;
+    }
+    Color4B *color = static_cast<Color4B*>(l_to_userdata(L, idx));
+    if (color) {
+        *out = *color;
+    }
+    return color != NULL;
+}
+
 // Ref
 
 static int l_Ref_retain(lua_State *L)
@@ -150,7 +433,7 @@ static int l_create_class_Ref(lua_State *L)
 static int l_Node_static_create(lua_State *L)
 {
     Node *node = Node::create();
-    return l_push_userdata(L, node, "cc.Node");
+    return l_push_ref(L, node, "cc.Node");
 }
 
 static int l_Node_addChild(lua_State *L)
@@ -169,6 +452,25 @@ static int l_Node_removeChild(lua_State *L)
     return 0;
 }
 
+static int l_Node_getParent(lua_State *L)
+{
+    Node *self = static_cast<Node*>(l_to_userdata(L, 1));
+    return l_push_ref(L, self->getParent(), "cc.Node");
+}
+
+static int l_Node_getChildren(lua_State *L)
+{
+    Node *self = static_cast<Node*>(l_to_userdata(L, 1));
+    const auto& children = self->getChildren();
+    lua_createtable(L, (int)children.size(), 0);
+    int i = 1;
+    for (const auto& child : children) {
+        l_push_ref(L, child, "cc.Node");
+        lua_rawseti(L, -2, i++);
+    }
+    return 1;
+}
+
 static int l_Node_setPosition(lua_State *L)
 {
     Node *node = static_cast<Node*>(l_to_userdata(L, 1));
@@ -184,22 +486,71 @@ static int l_Node_setPosition(lua_State *L)
 
         case 2:
         {
-            Vec2 *vec2 = static_cast<Vec2*>(l_to_userdata(L, 2));
-            node->setPosition(*vec2);
+            Vec2 vec2;
+            if (l_to_vec2(L, 2, &vec2)) {
+                node->setPosition(vec2);
+            }
             break;
         }
     }
     return 0;
 }
 
+static int l_Node_getPosition(lua_State *L)
+{
+    // returns x, y
+    Node *node = static_cast<Node*>(l_to_userdata(L, 1));
+    const Vec2& position = node->getPosition();
+    lua_pushnumber(L, position.x);
+    lua_pushnumber(L, position.y);
+    return 2;
+}
+
+static int l_Node_setContentSize(lua_State *L)
+{
+    Node *node = static_cast<Node*>(l_to_userdata(L, 1));
+    Size size;
+    if (lua_gettop(L) == 3) {
+        node->setContentSize(Size(lua_tonumber(L, 2), lua_tonumber(L, 3)));
+    } else if (l_to_size(L, 2, &size)) {
+        node->setContentSize(size);
+    }
+    return 0;
+}
+
+static int l_Node_getContentSize(lua_State *L)
+{
+    // returns width, height
+    Node *node = static_cast<Node*>(l_to_userdata(L, 1));
+    const Size& size = node->getContentSize();
+    lua_pushnumber(L, size.width);
+    lua_pushnumber(L, size.height);
+    return 2;
+}
+
 static int l_Node_setColor(lua_State *L)
 {
     Node *self = static_cast<Node*>(l_to_userdata(L, 1));
-    Color3B *color = static_cast<Color3B*>(l_to_userdata(L, 2));
-    self->setColor(*color);
+    Color3B color;
+    if (lua_gettop(L) == 4) {
+        self->setColor(Color3B(lua_tointeger(L, 2), lua_tointeger(L, 3), lua_tointeger(L, 4)));
+    } else if (l_to_color3b(L, 2, &color)) {
+        self->setColor(color);
+    }
     return 0;
 }
 
+static int l_Node_getColor(lua_State *L)
+{
+    // returns r, g, b
+    Node *self = static_cast<Node*>(l_to_userdata(L, 1));
+    const Color3B& color = self->getColor();
+    lua_pushinteger(L, color.r);
+    lua_pushinteger(L, color.g);
+    lua_pushinteger(L, color.b);
+    return 3;
+}
+
 static int l_Node_setOpacity(lua_State *L)
 {
     Node *node = static_cast<Node*>(l_to_userdata(L, 1));
@@ -209,13 +560,48 @@ static int l_Node_setOpacity(lua_State *L)
 
 static int l_Node_scheduleUpdate(lua_State *L)
 {
+    // L: node func, called every frame while the node is running
     Node *node = static_cast<Node*>(l_to_userdata(L, 1));
-    int ref = luaL_ref(L, LUA_REGISTRYINDEX);
-    node->schedule([L, ref](float dt) {
-        lua_rawgeti(L, LUA_REGISTRYINDEX, ref);
-        lua_pushnumber(L, dt);
-        lua_call(L, 1, 0);
-    }, 1.0f / 60.0f, "update");
+    luaL_checktype(L, 2, LUA_TFUNCTION);
+    if (node) {
+        l_updates_add(L, node, 2);
+    }
+    return 0;
+}
+
+static int l_Node_unscheduleUpdate(lua_State *L)
+{
+    Node *node = static_cast<Node*>(l_to_userdata(L, 1));
+    if (node) {
+        l_updates_remove(L, node);
+    }
+    return 0;
+}
+
+static int l_Node_static_updateNodes(lua_State *L)
+{
+    // L: nodes values fields, the fields of all the nodes set in one call, see ccffi_Nodes_update()
+    luaL_checktype(L, 1, LUA_TTABLE);
+    luaL_checktype(L, 2, LUA_TTABLE);
+    int fields = luaL_checkint(L, 3);
+    int count = (int)lua_objlen(L, 1);
+    int stride = ccffi_Nodes_stride(fields);
+
+    static std::vector<void*> nodes;
+    static std::vector<float> values;
+    nodes.resize(count);
+    values.resize(count * stride);
+    for (int i = 0; i < count; ++i) {
+        lua_rawgeti(L, 1, i + 1);
+        nodes[i] = l_to_userdata(L, -1);
+        lua_pop(L, 1);
+    }
+    for (int i = 0, n = count * stride; i < n; ++i) {
+        lua_rawgeti(L, 2, i + 1);
+        values[i] = lua_tonumber(L, -1);
+        lua_pop(L, 1);
+    }
+    ccffi_Nodes_update(nodes.data(), values.data(), count, fields);
     return 0;
 }
 
@@ -223,6 +609,20 @@ static int l_create_class_Node(lua_State *L)
 {
     lua_newtable(L);
 
+    lua_pushcfunction(L, l_Node_static_updateNodes);
+    lua_setfield(L, -2, "updateNodes");
+
+    lua_pushinteger(L, CCFFI_POSITION);
+    lua_setfield(L, -2, "UPDATE_POSITION");
+    lua_pushinteger(L, CCFFI_OPACITY);
+    lua_setfield(L, -2, "UPDATE_OPACITY");
+    lua_pushinteger(L, CCFFI_COLOR);
+    lua_setfield(L, -2, "UPDATE_COLOR");
+    lua_pushinteger(L, CCFFI_SCALE);
+    lua_setfield(L, -2, "UPDATE_SCALE");
+    lua_pushinteger(L, CCFFI_ROTATION);
+    lua_setfield(L, -2, "UPDATE_ROTATION");
+
     lua_pushcfunction(L, l_Node_static_create);
     lua_setfield(L, -2, "create");
 
@@ -232,17 +632,37 @@ static int l_create_class_Node(lua_State *L)
     lua_pushcfunction(L, l_Node_removeChild);
     lua_setfield(L, -2, "removeChild");
 
+    lua_pushcfunction(L, l_Node_getParent);
+    lua_setfield(L, -2, "getParent");
+
+    lua_pushcfunction(L, l_Node_getChildren);
+    lua_setfield(L, -2, "getChildren");
+
     lua_pushcfunction(L, l_Node_setPosition);
     lua_setfield(L, -2, "setPosition");
 
+    lua_pushcfunction(L, l_Node_getPosition);
+    lua_setfield(L, -2, "getPosition");
+
+    lua_pushcfunction(L, l_Node_setContentSize);
+    lua_setfield(L, -2, "setContentSize");
+
+    lua_pushcfunction(L, l_Node_getContentSize);
+    lua_setfield(L, -2, "getContentSize");
+
     lua_pushcfunction(L, l_Node_setColor);
     lua_setfield(L, -2, "setColor");
 
+    lua_pushcfunction(L, l_Node_getColor);
+    lua_setfield(L, -2, "getColor");
+
     lua_pushcfunction(L, l_Node_setOpacity);
     lua_setfield(L, -2, "setOpacity");
 
     lua_pushcfunction(L, l_Node_scheduleUpdate);
     lua_setfield(L, -2, "scheduleUpdate");
+    lua_pushcfunction(L, l_Node_unscheduleUpdate);
+    lua_setfield(L, -2, "unscheduleUpdate");
 
     return 1;
 }
@@ -253,7 +673,7 @@ static int l_Sprite_static_create(lua_State *L)
 {
     const char *filename = lua_tostring(L, 1);
     Sprite *sprite = Sprite::create(filename);
-    return l_push_userdata(L, sprite, "cc.Sprite");
+    return l_push_ref(L, sprite, "cc.Sprite");
 }
 
 static int l_create_class_Sprite(lua_State *L)
@@ -271,7 +691,7 @@ static int l_create_class_Sprite(lua_State *L)
 static int l_Layer_static_create(lua_State *L)
 {
     Layer *layer = Layer::create();
-    return l_push_userdata(L, layer, "cc.Layer");
+    return l_push_ref(L, layer, "cc.Layer");
 }
 
 static int l_create_class_Layer(lua_State *L)
@@ -287,28 +707,20 @@ static int l_create_class_Layer(lua_State *L)
 static int l_LayerColor_static_create(lua_State *L)
 {
     LayerColor *layer;
+    Color4B color;
     int top = lua_gettop(L);
-    switch (top) {
-        case 3:
-        {
-            Color4B *color = static_cast<Color4B*>(l_to_userdata(L, 1));
+    if (top >= 1 && l_to_color4b(L, 1, &color)) {
+        if (top == 3) {
             float width = lua_tonumber(L, 2);
             float height = lua_tonumber(L, 3);
-            layer = LayerColor::create(*color, width, height);
-            break;
-        }
-
-        case 1:
-        {
-            Color4B *color = static_cast<Color4B*>(l_to_userdata(L, 1));
-            layer = LayerColor::create(*color);
-            break;
+            layer = LayerColor::create(color, width, height);
+        } else {
+            layer = LayerColor::create(color);
         }
-
-        default:
-            layer = LayerColor::create();
+    } else {
+        layer = LayerColor::create();
     }
-    return l_push_userdata(L, layer, "cc.LayerColor");
+    return l_push_ref(L, layer, "cc.LayerColor");
 }
 
 static int l_create_class_LayerColor(lua_State *L)
@@ -329,7 +741,7 @@ static int l_Label_static_createWithSystemFont(lua_State *L)
     const char *font = lua_tostring(L, 2);
     float fontsize = lua_tonumber(L, 3);
     Label *label = Label::createWithSystemFont(text, font, fontsize);
-    return l_push_userdata(L, label, "cc.Label");
+    return l_push_ref(L, label, "cc.Label");
 }
 
 static int l_Label_setString(lua_State *L)
@@ -859,6 +1271,65 @@ static int l_create_class_Color3B(lua_State *L)
     return 1;
 }
 
+// cc.getVideoMemory(): { textureBytes, sceneTextureBytes, renderTargetBytes, bufferBytes, bufferCount, frame,
+//     owners = { [owner] = { count, bytes } }, textures = { { name, owner, width, height, bytes, ... }, ... } }
+// the textures are the largest first
+static void l_set_number_field(lua_State *L, const char *name, double value)
+{
+    lua_pushnumber(L, value);
+    lua_setfield(L, -2, name);
+}
+
+static int l_getVideoMemory(lua_State *L)
+{
+    VideoMemory::Report report = VideoMemory::getReport();
+
+    lua_newtable(L);                                // L: report
+    l_set_number_field(L, "textureBytes", (double)report.textureBytes);
+    l_set_number_field(L, "sceneTextureBytes", (double)report.sceneTextureBytes);
+    l_set_number_field(L, "sceneTextureCount", report.sceneTextureCount);
+    l_set_number_field(L, "renderTargetBytes", (double)report.renderTargetBytes);
+    l_set_number_field(L, "bufferBytes", (double)report.bufferBytes);
+    l_set_number_field(L, "bufferCount", report.bufferCount);
+    l_set_number_field(L, "frame", report.frame);
+
+    lua_newtable(L);                                // L: report owners
+    for (auto &owner : report.owners) {
+        lua_newtable(L);                            // L: report owners owner
+        l_set_number_field(L, "count", owner.textureCount);
+        l_set_number_field(L, "bytes", (double)owner.bytes);
+        lua_setfield(L, -2, owner.owner.c_str());
+    }
+    lua_setfield(L, -2, "owners");
+
+    lua_createtable(L, (int)report.textures.size(), 0);  // L: report textures
+    int index = 0;
+    for (auto &texture : report.textures) {
+        lua_createtable(L, 0, 12);                  // L: report textures texture
+        lua_pushstring(L, texture.name.c_str());
+        lua_setfield(L, -2, "name");
+        lua_pushstring(L, texture.owner.c_str());
+        lua_setfield(L, -2, "owner");
+        l_set_number_field(L, "id", texture.glName);
+        l_set_number_field(L, "width", texture.pixelsWide);
+        l_set_number_field(L, "height", texture.pixelsHigh);
+        l_set_number_field(L, "format", (int)texture.pixelFormat);
+        lua_pushboolean(L, texture.compressed);
+        lua_setfield(L, -2, "compressed");
+        lua_pushboolean(L, texture.mipmaps);
+        lua_setfield(L, -2, "mipmaps");
+        l_set_number_field(L, "residentLevel", texture.residentLevel);
+        l_set_number_field(L, "bytes", (double)texture.bytes);
+        l_set_number_field(L, "referenceCount", texture.referenceCount);
+        l_set_number_field(L, "lastUsedFrame", texture.lastUsedFrame);
+        lua_pushboolean(L, texture.inScene);
+        lua_setfield(L, -2, "inScene");
+        lua_rawseti(L, -2, ++index);
+    }
+    lua_setfield(L, -2, "textures");
+    return 1;
+}
+
 //
 
 int l_create_namespace_cc(lua_State *L)
@@ -868,6 +1339,18 @@ int l_create_namespace_cc(lua_State *L)
     lua_pushvalue(L, -1);
     lua_setglobal(L, "cc");
 
+    l_create_ubox(L);
+    l_create_updates(L);
+
+    l_push_ffi_api(L);
+    lua_setfield(L, -2, "ffi_api");
+
+    l_create_async(L);
+    lua_setfield(L, -2, "async");
+
+    lua_pushcfunction(L, l_getVideoMemory);
+    lua_setfield(L, -2, "getVideoMemory");
+
     // add classes
     l_register_class(L, "cc.Ref", &l_create_class_Ref);
     lua_setfield(L, -2, "Ref");
@@ -899,6 +1382,9 @@ int l_create_namespace_cc(lua_State *L)
     l_register_class(L, "cc.Color3B", &l_create_class_Color3B);
     lua_setfield(L, -2, "Color3B");
 
+    // add the generated classes, and the methods of the classes above that aren't bound by hand
+    l_register_auto_classes(L);
+
     // set base classes
     l_set_base_class(L, "cc.Node", "cc.Ref");
     l_set_base_class(L, "cc.Sprite", "cc.Node");
@@ -920,8 +1406,252 @@ int l_push_userdata(lua_State *L, void *p, const char *name)
     return 1;
 }
 
+static int l_create_class_auto(lua_State *L)
+{
+    lua_newtable(L);
+    return 1;
+}
+
+void l_register_auto_classes(lua_State *L)
+{
+    // L: cc
+    std::vector<const l_auto_class*> created;
+    for (const l_auto_class *c = l_auto_classes; c->name; ++c) {
+        l_get_class(L, c->name);                    // L: cc cls
+        if (lua_isnil(L, -1)) {
+            lua_pop(L, 1);
+            l_register_class(L, c->name, &l_create_class_auto);
+            lua_pushvalue(L, -1);
+            lua_setfield(L, -3, c->field);          // cc[field] = cls
+            created.push_back(c);
+        }
+        lua_getfield(L, -1, "__index");             // L: cc cls __index
+        for (const luaL_Reg *r = c->methods; r->name; ++r) {
+            lua_pushstring(L, r->name);
+            lua_rawget(L, -2);
+            if (lua_isnil(L, -1)) {
+                lua_pushcfunction(L, r->func);
+                lua_setfield(L, -3, r->name);
+            }
+            lua_pop(L, 1);
+        }
+        lua_pop(L, 2);                              // L: cc
+    }
+
+    // the bases are complete now, the ones of the classes bound by hand are set by the caller
+    for (auto c : created) {
+        if (c->base) {
+            l_set_base_class(L, c->name, c->base);
+        }
+    }
+}
+
+int l_push_ref(lua_State *L, Ref *ref, const char *name)
+{
+    if (ref == NULL) {
+        lua_pushnil(L);
+        return 1;
+    }
+
+    lua_getfield(L, LUA_REGISTRYINDEX, UBOX);   // L: ubox
+    lua_pushlightuserdata(L, ref);
+    lua_rawget(L, -2);                          // L: ubox ud
+    if (lua_isuserdata(L, -1)) {
+        lua_remove(L, -2);                      // L: ud
+        return 1;
+    }
+    lua_pop(L, 1);                              // L: ubox
+
+    void *p = ref;
+    l_push_userdata(L, p, name);                // L: ubox ud
+    lua_pushlightuserdata(L, ref);
+    lua_pushvalue(L, -2);                       // L: ubox ud key ud
+    lua_rawset(L, -4);                          // ubox[ref] = ud
+    lua_remove(L, -2);                          // L: ud
+    ref->setScriptObject(L);
+    return 1;
+}
+
 void *l_to_userdata(lua_State *L, int idx)
 {
     void **ud = static_cast<void**>(lua_touserdata(L, idx));
     return ud ? *ud : NULL;
 }
+
+// the bundles of precompiled scripts, AssetPacks written by tools/packlua.py
+
+static const char *BUNDLE = "cc.bundle";
+
+struct l_bundle
+{
+    std::shared_ptr<AssetPack> pack;
+};
+
+static int l_bundle_meta_gc(lua_State *L)
+{
+    l_bundle *bundle = static_cast<l_bundle*>(lua_touserdata(L, 1));
+    bundle->~l_bundle();
+    return 0;
+}
+
+static int l_bundle_searcher(lua_State *L)
+{
+    // L: name, the bundle is the upvalue
+    const char *name = luaL_checkstring(L, 1);
+    l_bundle *bundle = static_cast<l_bundle*>(lua_touserdata(L, lua_upvalueindex(1)));
+
+    std::string filename(name);
+    std::replace(filename.begin(), filename.end(), '.', '/');
+    filename += ".lua";
+
+    AssetPack::Entry entry;
+    if (!bundle->pack->findEntry(filename, &entry)) {
+        lua_pushfstring(L, "\n\tno script '%s' in the bundle", filename.c_str());
+        return 1;
+    }
+
+    // the bytecode is copied into the prototypes, the view can go
+    FileView view = bundle->pack->getFileView(entry);
+    const std::string chunkname = "@" + filename;
+    if (view.isNull() || luaL_loadbuffer(L, (const char*)view.getBytes(), view.getSize(), chunkname.c_str()) != 0) {
+        return luaL_error(L, "error loading module '%s' from the bundle:\n\t%s", name,
+                          view.isNull() ? "can't read the script" : lua_tostring(L, -1));
+    }
+    return 1;
+}
+
+bool l_add_bundle_loader(lua_State *L, const std::string &filename)
+{
+    FileUtils *fileUtils = FileUtils::getInstance();
+    const std::string path = fileUtils->fullPathForFilename(filename);
+    if (path.empty()) {
+        return false;
+    }
+    std::shared_ptr<AssetPack> pack = AssetPack::create(fileUtils->getFileView(path));
+    if (!pack) {
+        return false;
+    }
+
+    lua_getglobal(L, "package");
+    lua_getfield(L, -1, "searchers");
+    if (lua_isnil(L, -1)) {
+        // Lua 5.1 and LuaJIT
+        lua_pop(L, 1);
+        lua_getfield(L, -1, "loaders");
+    }
+    if (!lua_istable(L, -1)) {
+        lua_pop(L, 2);
+        return false;
+    }
+    // L: package searchers
+
+    l_bundle *bundle = static_cast<l_bundle*>(lua_newuserdata(L, sizeof(l_bundle)));
+    new (bundle) l_bundle();
+    bundle->pack = pack;
+    if (luaL_newmetatable(L, BUNDLE)) {
+        lua_pushcfunction(L, l_bundle_meta_gc);
+        lua_setfield(L, -2, "__gc");
+    }
+    lua_setmetatable(L, -2);
+    lua_pushcclosure(L, l_bundle_searcher, 1);
+    // L: package searchers searcher
+
+    // after package.preload, before the scripts of package.path
+    for (int i = (int)lua_objlen(L, -2); i >= 2; --i) {
+        lua_rawgeti(L, -2, i);
+        lua_rawseti(L, -3, i + 1);
+    }
+    lua_rawseti(L, -2, 2);
+    lua_pop(L, 2);
+    return true;
+}
+
+int l_require(lua_State *L, const char *name)
+{
+    lua_getglobal(L, "require");
+    lua_pushstring(L, name);
+    int status = lua_pcall(L, 1, 0, 0);
+    if (status != 0) {
+        CCLOG("l_require: %s", lua_tostring(L, -1));
+        lua_pop(L, 1);
+    }
+    return status;
+}
+
+// whether a template of package.path gives fullPath for the module name
+static bool l_module_matches(const std::string &packagePath, std::string name, const std::string &fullPath)
+{
+    std::replace(name.begin(), name.end(), '.', '/');
+    size_t start = 0;
+    while (start <= packagePath.size()) {
+        size_t end = packagePath.find(';', start);
+        if (end == std::string::npos) {
+            end = packagePath.size();
+        }
+        std::string file = packagePath.substr(start, end - start);
+        for (size_t pos = file.find('?'); pos != std::string::npos; pos = file.find('?', pos + name.size())) {
+            file.replace(pos, 1, name);
+        }
+        if (!file.empty() && file == fullPath) {
+            return true;
+        }
+        start = end + 1;
+    }
+    return false;
+}
+
+bool l_reload_module(lua_State *L, const std::string &fullPath)
+{
+    lua_getglobal(L, "package");
+    lua_getfield(L, -1, "path");
+    const std::string packagePath = lua_isstring(L, -1) ? lua_tostring(L, -1) : "";
+    lua_pop(L, 1);
+    lua_getfield(L, -1, "loaded");
+    // L: package loaded
+
+    std::vector<std::string> names;
+    lua_pushnil(L);
+    while (lua_next(L, -2) != 0) {
+        if (lua_type(L, -2) == LUA_TSTRING) {
+            const char *name = lua_tostring(L, -2);
+            if (l_module_matches(packagePath, name, fullPath)) {
+                names.push_back(name);
+            }
+        }
+        lua_pop(L, 1);
+    }
+
+    for (const auto &name : names) {
+        lua_getfield(L, -1, name.c_str());
+        // L: package loaded old
+        lua_pushnil(L);
+        lua_setfield(L, -3, name.c_str());
+
+        lua_getglobal(L, "require");
+        lua_pushstring(L, name.c_str());
+        if (lua_pcall(L, 1, 1, 0) != 0) {
+            CCLOG("l_reload_module: %s", lua_tostring(L, -1));
+            lua_pop(L, 1);
+            lua_setfield(L, -2, name.c_str());
+            continue;
+        }
+        // L: package loaded old new
+
+        if (lua_istable(L, -2) && lua_istable(L, -1) && !lua_rawequal(L, -2, -1)) {
+            lua_pushnil(L);
+            while (lua_next(L, -2) != 0) {
+                lua_pushvalue(L, -2);
+                lua_insert(L, -2);
+                lua_rawset(L, -5);
+            }
+            lua_pop(L, 1);
+            lua_setfield(L, -2, name.c_str());
+        } else {
+            lua_setfield(L, -3, name.c_str());
+            lua_pop(L, 1);
+        }
+        CCLOG("l_reload_module: reloaded %s", name.c_str());
+    }
+    lua_pop(L, 2);
+    return !names.empty();
+}
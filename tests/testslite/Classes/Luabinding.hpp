@@ -10,12 +10,47 @@
 #define Luabinding_hpp
 
 #include <stdio.h>
+#include <string>
 #include "lua.hpp"
 
+namespace cocos2d {
+    class Ref;
+    class Vec2;
+    class Size;
+    struct Color3B;
+    struct Color4B;
+}
+
 extern "C" {
     int l_create_namespace_cc(lua_State *L);
     int l_push_userdata(lua_State *L, void *p, const char *name);
     void *l_to_userdata(lua_State *L, int idx);
 }
 
+// pushes the one proxy of a Ref, it's reused until the Ref is destroyed
+int l_push_ref(lua_State *L, cocos2d::Ref *ref, const char *name);
+
+// read the value types passed as tables, or as the userdata of cc.Vec2.new() and so on
+bool l_to_vec2(lua_State *L, int idx, cocos2d::Vec2 *out);
+bool l_to_size(lua_State *L, int idx, cocos2d::Size *out);
+bool l_to_color3b(lua_State *L, int idx, cocos2d::Color3B *out);
+bool l_to_color4b(lua_State *L, int idx, cocos2d::Color4B *out);
+
+// adds the classes of LuabindingAuto.cpp to the cc namespace on the top of the stack,
+// the methods bound by hand are kept
+void l_register_auto_classes(lua_State *L);
+
+// makes require() look the modules up in a bundle of precompiled scripts, see tools/packlua.py,
+// before package.path. The bundle is mapped and the scripts are only loaded when required,
+// returns false if the bundle can't be read
+bool l_add_bundle_loader(lua_State *L, const std::string &filename);
+
+// calls require(name), logs the error and returns a non-zero status when it fails
+int l_require(lua_State *L, const char *name);
+
+// requires again the loaded modules whose package.path file is fullPath. When the old and the new module are
+// tables, the new fields are copied into the old table so the references kept to it see the new functions,
+// the old module is kept when the script fails. Returns false when no loaded module comes from fullPath
+bool l_reload_module(lua_State *L, const std::string &fullPath);
+
 #endif /* Luabinding_hpp */
@@ -0,0 +1,255 @@
+//
+//  LuabindingAsync.cpp
+//  testslite
+//
+//  Copyright © 2016 cocos2d. All rights reserved.
+//
+
+#include <deque>
+#include <memory>
+#include <new>
+#include <string>
+
+#include "LuabindingAsync.hpp"
+#include "Luabinding.hpp"
+#include "cocos2d.h"
+#include "audio/include/AudioEngine.h"
+
+extern "C" {
+#include "lua.h"
+#include "lauxlib.h"
+}
+
+USING_NS_CC;
+
+static const char *ASYNC = "cc.async";
+static const char *ASYNC_JOB = "cc.async.job";
+
+// a load started from Lua, the userdata of the job holds a shared_ptr to it and so do the engine callbacks
+struct l_async_job
+{
+    bool done;
+    // the registry ref of the coroutine waiting in await(), LUA_NOREF when none
+    int waiting;
+    // the results, a Ref is pushed with its class, otherwise the boolean
+    Ref *ref;
+    const char *refClass;
+    bool success;
+    // the callback of a pending delay, 0 when none
+    ccSchedulerHandle delay;
+
+    l_async_job()
+    : done(false)
+    , waiting(LUA_NOREF)
+    , ref(nullptr)
+    , refClass(nullptr)
+    , success(false)
+    , delay(0)
+    {
+    }
+
+    ~l_async_job()
+    {
+        CC_SAFE_RELEASE(ref);
+    }
+};
+
+typedef std::shared_ptr<l_async_job> l_async_job_ptr;
+
+static lua_State *s_async_L = NULL;
+// the callbacks of the jobs started before the state was closed compare it
+static unsigned int s_async_generation = 0;
+static std::deque<l_async_job_ptr> s_async_ready;
+static double s_async_budget = 0.002;
+
+static int l_async_push_results(lua_State *L, const l_async_job &job)
+{
+    if (job.refClass) {
+        return l_push_ref(L, job.ref, job.refClass);
+    }
+    lua_pushboolean(L, job.success);
+    return 1;
+}
+
+static void l_async_finish(const l_async_job_ptr &job, unsigned int generation)
+{
+    job->done = true;
+    if (generation == s_async_generation && job->waiting != LUA_NOREF) {
+        s_async_ready.push_back(job);
+    }
+}
+
+static void l_async_resume(lua_State *L, l_async_job &job)
+{
+    lua_rawgeti(L, LUA_REGISTRYINDEX, job.waiting);     // L: co
+    luaL_unref(L, LUA_REGISTRYINDEX, job.waiting);
+    job.waiting = LUA_NOREF;
+    lua_State *co = lua_tothread(L, -1);
+
+    int count = l_async_push_results(co, job);
+    int status = lua_resume(co, count);
+    if (status != 0 && status != LUA_YIELD) {
+        CCLOG("cc.async: %s", lua_tostring(co, -1));
+    }
+    lua_pop(L, 1);
+}
+
+static void l_async_dispatch(lua_State *L)
+{
+    // the coroutines resumed below may finish jobs too, they wait for the next frame
+    size_t count = s_async_ready.size();
+    double start = utils::gettime();
+    for (size_t i = 0; i < count && !s_async_ready.empty(); ++i) {
+        if (i > 0 && utils::gettime() - start > s_async_budget) {
+            break;
+        }
+        l_async_job_ptr job = s_async_ready.front();
+        s_async_ready.pop_front();
+        l_async_resume(L, *job);
+    }
+}
+
+static int l_async_job_meta_gc(lua_State *L)
+{
+    auto job = static_cast<l_async_job_ptr*>(luaL_checkudata(L, 1, ASYNC_JOB));
+    // nothing can await a delay anymore, its callback holds the last reference to the job
+    if ((*job)->delay) {
+        Director::getInstance()->getScheduler()->unschedule((*job)->delay);
+    }
+    job->~l_async_job_ptr();
+    return 0;
+}
+
+// L: pushes a new job
+static l_async_job_ptr l_async_new_job(lua_State *L)
+{
+    void *ud = lua_newuserdata(L, sizeof(l_async_job_ptr));
+    auto job = new (ud) l_async_job_ptr(std::make_shared<l_async_job>());
+    luaL_getmetatable(L, ASYNC_JOB);
+    lua_setmetatable(L, -2);
+    return *job;
+}
+
+static int l_async_loadTexture(lua_State *L)
+{
+    const char *path = luaL_checkstring(L, 1);
+    l_async_job_ptr job = l_async_new_job(L);
+    job->refClass = "cc.Texture2D";
+
+    unsigned int generation = s_async_generation;
+    Director::getInstance()->getTextureCache()->addImageAsync(path, [job, generation](Texture2D *texture) {
+        CC_SAFE_RETAIN(texture);
+        job->ref = texture;
+        l_async_finish(job, generation);
+    });
+    return 1;
+}
+
+static int l_async_preloadAudio(lua_State *L)
+{
+    const char *path = luaL_checkstring(L, 1);
+    l_async_job_ptr job = l_async_new_job(L);
+
+    unsigned int generation = s_async_generation;
+    experimental::AudioEngine::preload(path, [job, generation](bool isSuccess) {
+        job->success = isSuccess;
+        l_async_finish(job, generation);
+    });
+    return 1;
+}
+
+static int l_async_delay(lua_State *L)
+{
+    float seconds = (float)luaL_checknumber(L, 1);
+    l_async_job_ptr job = l_async_new_job(L);
+    job->success = true;
+
+    unsigned int generation = s_async_generation;
+    job->delay = Director::getInstance()->getScheduler()->scheduleOnce([job, generation](float) {
+        job->delay = 0;
+        l_async_finish(job, generation);
+    }, L, seconds, false);
+    return 1;
+}
+
+static int l_async_await(lua_State *L)
+{
+    l_async_job &job = **static_cast<l_async_job_ptr*>(luaL_checkudata(L, 1, ASYNC_JOB));
+    if (job.done) {
+        return l_async_push_results(L, job);
+    }
+
+    if (lua_pushthread(L)) {
+        return luaL_error(L, "cc.async.await: the job isn't done, await it from a coroutine, e.g. cc.async.run()");
+    }
+    if (job.waiting != LUA_NOREF) {
+        return luaL_error(L, "cc.async.await: a coroutine already awaits the job");
+    }
+    job.waiting = luaL_ref(L, LUA_REGISTRYINDEX);   // resumed with the results by l_async_dispatch()
+    return lua_yield(L, 0);
+}
+
+static int l_async_run(lua_State *L)
+{
+    // L: func args...
+    luaL_checktype(L, 1, LUA_TFUNCTION);
+    int count = lua_gettop(L);
+    lua_State *co = lua_newthread(L);               // L: func args... co
+    lua_insert(L, 1);                               // L: co func args...
+    lua_xmove(L, co, count);                        // L: co, co: func args...
+
+    int status = lua_resume(co, count - 1);
+    if (status != 0 && status != LUA_YIELD) {
+        CCLOG("cc.async: %s", lua_tostring(co, -1));
+    }
+    return 1;
+}
+
+static int l_async_setBudget(lua_State *L)
+{
+    s_async_budget = luaL_checknumber(L, 1) / 1000.0;
+    return 0;
+}
+
+void l_create_async(lua_State *L)
+{
+    luaL_newmetatable(L, ASYNC_JOB);                // L: mt
+    lua_pushcfunction(L, l_async_job_meta_gc);
+    lua_setfield(L, -2, "__gc");
+    lua_pop(L, 1);
+
+    lua_newtable(L);                                // L: async
+    lua_pushcfunction(L, l_async_loadTexture);
+    lua_setfield(L, -2, "loadTexture");
+    lua_pushcfunction(L, l_async_preloadAudio);
+    lua_setfield(L, -2, "preloadAudio");
+    lua_pushcfunction(L, l_async_delay);
+    lua_setfield(L, -2, "delay");
+    lua_pushcfunction(L, l_async_await);
+    lua_setfield(L, -2, "await");
+    lua_pushcfunction(L, l_async_run);
+    lua_setfield(L, -2, "run");
+    lua_pushcfunction(L, l_async_setBudget);
+    lua_setfield(L, -2, "setBudget");
+
+    s_async_L = L;
+    s_async_ready.clear();
+    Director::getInstance()->getScheduler()->schedule([L](float) {
+        l_async_dispatch(L);
+    }, L, 0, false, ASYNC);
+}
+
+void l_async_close(lua_State *L)
+{
+    if (s_async_L != L) {
+        return;
+    }
+    s_async_L = NULL;
+    ++s_async_generation;
+    s_async_ready.clear();
+
+    Scheduler *scheduler = Director::getInstance()->getScheduler();
+    scheduler->unschedule(ASYNC, L);
+    // the delays left
+    scheduler->unscheduleAllForTarget(L);
+}
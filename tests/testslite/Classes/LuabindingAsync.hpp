@@ -0,0 +1,33 @@
+//
+//  LuabindingAsync.hpp
+//  testslite
+//
+//  Copyright © 2016 cocos2d. All rights reserved.
+//
+
+#ifndef LuabindingAsync_hpp
+#define LuabindingAsync_hpp
+
+#include "lua.hpp"
+
+// cc.async, the asynchronous loads of the engine as jobs a coroutine awaits:
+//
+//     cc.async.run(function()
+//         local texture = cc.async.await(cc.async.loadTexture("background.png"))
+//         local ok = cc.async.await(cc.async.preloadAudio("music.mp3"))
+//         cc.async.await(cc.async.delay(0.5))
+//     end)
+//
+// loadTexture(path), preloadAudio(path) and delay(seconds) start a job and return it. await(job) returns the
+// results of a finished job at once, otherwise it yields the running coroutine until the job finishes.
+// run(func, ...) calls func in a new coroutine and returns it, the errors are logged.
+// The coroutines whose jobs finished are resumed once per frame, in the order the jobs finished, until
+// setBudget(milliseconds) runs out, 2 by default. At least one is resumed per frame.
+
+// pushes the cc.async table
+void l_create_async(lua_State *L);
+
+// drops the coroutines waiting on jobs, the jobs that finish later are ignored, called when the state is closed
+void l_async_close(lua_State *L);
+
+#endif /* LuabindingAsync_hpp */
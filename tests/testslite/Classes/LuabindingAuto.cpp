@@ -0,0 +1,1282 @@
+//
+//  LuabindingAuto.cpp
+//  testslite
+//
+//  Generated by tools/genbindings.py, do not edit.
+//
+
+#include "LuabindingTemplates.hpp"
+
+USING_NS_CC;
+
+template<> const char *l_class<Ref>::name() { return "cc.Ref"; }
+template<> const char *l_class<Node>::name() { return "cc.Node"; }
+template<> const char *l_class<Scene>::name() { return "cc.Scene"; }
+template<> const char *l_class<Layer>::name() { return "cc.Layer"; }
+template<> const char *l_class<LayerColor>::name() { return "cc.LayerColor"; }
+template<> const char *l_class<Sprite>::name() { return "cc.Sprite"; }
+template<> const char *l_class<Label>::name() { return "cc.Label"; }
+template<> const char *l_class<Action>::name() { return "cc.Action"; }
+template<> const char *l_class<FiniteTimeAction>::name() { return "cc.FiniteTimeAction"; }
+template<> const char *l_class<ActionInterval>::name() { return "cc.ActionInterval"; }
+template<> const char *l_class<ActionInstant>::name() { return "cc.ActionInstant"; }
+template<> const char *l_class<Speed>::name() { return "cc.Speed"; }
+template<> const char *l_class<Follow>::name() { return "cc.Follow"; }
+template<> const char *l_class<RotateTo>::name() { return "cc.RotateTo"; }
+template<> const char *l_class<RotateBy>::name() { return "cc.RotateBy"; }
+template<> const char *l_class<MoveBy>::name() { return "cc.MoveBy"; }
+template<> const char *l_class<MoveTo>::name() { return "cc.MoveTo"; }
+template<> const char *l_class<SkewTo>::name() { return "cc.SkewTo"; }
+template<> const char *l_class<SkewBy>::name() { return "cc.SkewBy"; }
+template<> const char *l_class<JumpBy>::name() { return "cc.JumpBy"; }
+template<> const char *l_class<JumpTo>::name() { return "cc.JumpTo"; }
+template<> const char *l_class<ScaleTo>::name() { return "cc.ScaleTo"; }
+template<> const char *l_class<ScaleBy>::name() { return "cc.ScaleBy"; }
+template<> const char *l_class<Blink>::name() { return "cc.Blink"; }
+template<> const char *l_class<FadeTo>::name() { return "cc.FadeTo"; }
+template<> const char *l_class<FadeIn>::name() { return "cc.FadeIn"; }
+template<> const char *l_class<FadeOut>::name() { return "cc.FadeOut"; }
+template<> const char *l_class<TintTo>::name() { return "cc.TintTo"; }
+template<> const char *l_class<TintBy>::name() { return "cc.TintBy"; }
+template<> const char *l_class<DelayTime>::name() { return "cc.DelayTime"; }
+template<> const char *l_class<Repeat>::name() { return "cc.Repeat"; }
+template<> const char *l_class<RepeatForever>::name() { return "cc.RepeatForever"; }
+template<> const char *l_class<ReverseTime>::name() { return "cc.ReverseTime"; }
+template<> const char *l_class<Show>::name() { return "cc.Show"; }
+template<> const char *l_class<Hide>::name() { return "cc.Hide"; }
+template<> const char *l_class<ToggleVisibility>::name() { return "cc.ToggleVisibility"; }
+template<> const char *l_class<RemoveSelf>::name() { return "cc.RemoveSelf"; }
+template<> const char *l_class<FlipX>::name() { return "cc.FlipX"; }
+template<> const char *l_class<FlipY>::name() { return "cc.FlipY"; }
+template<> const char *l_class<Place>::name() { return "cc.Place"; }
+template<> const char *l_class<ActionEase>::name() { return "cc.ActionEase"; }
+template<> const char *l_class<EaseRateAction>::name() { return "cc.EaseRateAction"; }
+template<> const char *l_class<EaseIn>::name() { return "cc.EaseIn"; }
+template<> const char *l_class<EaseOut>::name() { return "cc.EaseOut"; }
+template<> const char *l_class<EaseInOut>::name() { return "cc.EaseInOut"; }
+template<> const char *l_class<EaseSineIn>::name() { return "cc.EaseSineIn"; }
+template<> const char *l_class<EaseSineOut>::name() { return "cc.EaseSineOut"; }
+template<> const char *l_class<EaseSineInOut>::name() { return "cc.EaseSineInOut"; }
+template<> const char *l_class<EaseBackIn>::name() { return "cc.EaseBackIn"; }
+template<> const char *l_class<EaseBackOut>::name() { return "cc.EaseBackOut"; }
+template<> const char *l_class<EaseBackInOut>::name() { return "cc.EaseBackInOut"; }
+template<> const char *l_class<EaseElasticIn>::name() { return "cc.EaseElasticIn"; }
+template<> const char *l_class<EaseElasticOut>::name() { return "cc.EaseElasticOut"; }
+template<> const char *l_class<EaseElasticInOut>::name() { return "cc.EaseElasticInOut"; }
+template<> const char *l_class<EaseBounceIn>::name() { return "cc.EaseBounceIn"; }
+template<> const char *l_class<EaseBounceOut>::name() { return "cc.EaseBounceOut"; }
+template<> const char *l_class<EaseBounceInOut>::name() { return "cc.EaseBounceInOut"; }
+template<> const char *l_class<Director>::name() { return "cc.Director"; }
+template<> const char *l_class<Scheduler>::name() { return "cc.Scheduler"; }
+template<> const char *l_class<EventListener>::name() { return "cc.EventListener"; }
+template<> const char *l_class<EventDispatcher>::name() { return "cc.EventDispatcher"; }
+template<> const char *l_class<FileUtils>::name() { return "cc.FileUtils"; }
+template<> const char *l_class<Texture2D>::name() { return "cc.Texture2D"; }
+template<> const char *l_class<TextureCache>::name() { return "cc.TextureCache"; }
+
+// Ref
+
+static const luaL_Reg l_auto_Ref[] = {
+    {"getReferenceCount", &l_method<unsigned int (Ref::*)() const, &Ref::getReferenceCount>::call},
+    {"release", &l_method<void (Ref::*)(), &Ref::release>::call},
+    {"retain", &l_method<void (Ref::*)(), &Ref::retain>::call},
+    {NULL, NULL}
+};
+
+// Node
+
+static void l_Node_removeChild_1(Node *self, Node* a0)
+{
+    return self->removeChild(a0);
+}
+
+static void l_Node_removeChildByTag_1(Node *self, int a0)
+{
+    return self->removeChildByTag(a0);
+}
+
+static void l_Node_removeChildByName_1(Node *self, const std::string& a0)
+{
+    return self->removeChildByName(a0);
+}
+
+static void l_Node_setCameraMask_1(Node *self, unsigned short a0)
+{
+    return self->setCameraMask(a0);
+}
+
+static const luaL_Reg l_auto_Node[] = {
+    {"addChild", &l_overload<
+        l_method<void (Node::*)(Node*), &Node::addChild>,
+        l_method<void (Node::*)(Node*, int), &Node::addChild>,
+        l_method<void (Node::*)(Node*, int, int), &Node::addChild>,
+        l_method<void (Node::*)(Node*, int, const std::string&), &Node::addChild>
+    >::call},
+    {"cleanup", &l_method<void (Node::*)(), &Node::cleanup>::call},
+    {"convertToNodeSpace", &l_method<Vec2 (Node::*)(const Vec2&) const, &Node::convertToNodeSpace>::call},
+    {"convertToNodeSpaceAR", &l_method<Vec2 (Node::*)(const Vec2&) const, &Node::convertToNodeSpaceAR>::call},
+    {"convertToWorldSpace", &l_method<Vec2 (Node::*)(const Vec2&) const, &Node::convertToWorldSpace>::call},
+    {"convertToWorldSpaceAR", &l_method<Vec2 (Node::*)(const Vec2&) const, &Node::convertToWorldSpaceAR>::call},
+    {"create", &l_method<Node* (*)(), &Node::create>::call},
+    {"getActionByTag", &l_method<Action* (Node::*)(int), &Node::getActionByTag>::call},
+    {"getAnchorPoint", &l_method<const Vec2& (Node::*)() const, &Node::getAnchorPoint>::call},
+    {"getAnchorPointInPoints", &l_method<const Vec2& (Node::*)() const, &Node::getAnchorPointInPoints>::call},
+    {"getBoundingBox", &l_method<Rect (Node::*)() const, &Node::getBoundingBox>::call},
+    {"getCameraMask", &l_method<unsigned short (Node::*)() const, &Node::getCameraMask>::call},
+    {"getChildByTag", &l_method<Node* (Node::*)(int) const, &Node::getChildByTag>::call},
+    {"getChildOrder", &l_method<Node::ChildOrder (Node::*)() const, &Node::getChildOrder>::call},
+    {"getChildrenCount", &l_method<ssize_t (Node::*)() const, &Node::getChildrenCount>::call},
+    {"getColor", &l_method<const Color3B& (Node::*)() const, &Node::getColor>::call},
+    {"getContentSize", &l_method<const Size& (Node::*)() const, &Node::getContentSize>::call},
+    {"getDescription", &l_method<std::string (Node::*)() const, &Node::getDescription>::call},
+    {"getDisplayedColor", &l_method<const Color3B& (Node::*)() const, &Node::getDisplayedColor>::call},
+    {"getDisplayedOpacity", &l_method<GLubyte (Node::*)() const, &Node::getDisplayedOpacity>::call},
+    {"getEventDispatcher", &l_method<EventDispatcher* (Node::*)() const, &Node::getEventDispatcher>::call},
+    {"getGlobalZOrder", &l_method<float (Node::*)() const, &Node::getGlobalZOrder>::call},
+    {"getLocalZOrder", &l_method<int (Node::*)() const, &Node::getLocalZOrder>::call},
+    {"getName", &l_method<const std::string& (Node::*)() const, &Node::getName>::call},
+    {"getNormalizedPosition", &l_method<const Vec2& (Node::*)() const, &Node::getNormalizedPosition>::call},
+    {"getNumberOfRunningActions", &l_method<ssize_t (Node::*)() const, &Node::getNumberOfRunningActions>::call},
+    {"getOpacity", &l_method<GLubyte (Node::*)() const, &Node::getOpacity>::call},
+    {"getOrderOfArrival", &l_method<int (Node::*)() const, &Node::getOrderOfArrival>::call},
+    {"getParent", &l_overload<
+        l_method<Node* (Node::*)(), &Node::getParent>,
+        l_method<const Node* (Node::*)() const, &Node::getParent>
+    >::call},
+    {"getPosition", &l_method<const Vec2& (Node::*)() const, &Node::getPosition>::call},
+    {"getPositionX", &l_method<float (Node::*)() const, &Node::getPositionX>::call},
+    {"getPositionY", &l_method<float (Node::*)() const, &Node::getPositionY>::call},
+    {"getPositionZ", &l_method<float (Node::*)() const, &Node::getPositionZ>::call},
+    {"getRotation", &l_method<float (Node::*)() const, &Node::getRotation>::call},
+    {"getRotationSkewX", &l_method<float (Node::*)() const, &Node::getRotationSkewX>::call},
+    {"getRotationSkewY", &l_method<float (Node::*)() const, &Node::getRotationSkewY>::call},
+    {"getScale", &l_method<float (Node::*)() const, &Node::getScale>::call},
+    {"getScaleX", &l_method<float (Node::*)() const, &Node::getScaleX>::call},
+    {"getScaleY", &l_method<float (Node::*)() const, &Node::getScaleY>::call},
+    {"getScaleZ", &l_method<float (Node::*)() const, &Node::getScaleZ>::call},
+    {"getScene", &l_method<Scene* (Node::*)() const, &Node::getScene>::call},
+    {"getScheduler", &l_overload<
+        l_method<Scheduler* (Node::*)(), &Node::getScheduler>,
+        l_method<const Scheduler* (Node::*)() const, &Node::getScheduler>
+    >::call},
+    {"getSkewX", &l_method<float (Node::*)() const, &Node::getSkewX>::call},
+    {"getSkewY", &l_method<float (Node::*)() const, &Node::getSkewY>::call},
+    {"getTag", &l_method<int (Node::*)() const, &Node::getTag>::call},
+    {"ignoreAnchorPointForPosition", &l_method<void (Node::*)(bool), &Node::ignoreAnchorPointForPosition>::call},
+    {"isCascadeColorEnabled", &l_method<bool (Node::*)() const, &Node::isCascadeColorEnabled>::call},
+    {"isCascadeOpacityEnabled", &l_method<bool (Node::*)() const, &Node::isCascadeOpacityEnabled>::call},
+    {"isCullingEnabled", &l_method<bool (Node::*)() const, &Node::isCullingEnabled>::call},
+    {"isIgnoreAnchorPointForPosition", &l_method<bool (Node::*)() const, &Node::isIgnoreAnchorPointForPosition>::call},
+    {"isOpacityModifyRGB", &l_method<bool (Node::*)() const, &Node::isOpacityModifyRGB>::call},
+    {"isParallelVisitEnabled", &l_method<bool (Node::*)() const, &Node::isParallelVisitEnabled>::call},
+    {"isRunning", &l_method<bool (Node::*)() const, &Node::isRunning>::call},
+    {"isScheduled", &l_method<bool (Node::*)(const std::string&), &Node::isScheduled>::call},
+    {"isVisible", &l_method<bool (Node::*)() const, &Node::isVisible>::call},
+    {"onEnter", &l_method<void (Node::*)(), &Node::onEnter>::call},
+    {"onEnterTransitionDidFinish", &l_method<void (Node::*)(), &Node::onEnterTransitionDidFinish>::call},
+    {"onExit", &l_method<void (Node::*)(), &Node::onExit>::call},
+    {"onExitTransitionDidStart", &l_method<void (Node::*)(), &Node::onExitTransitionDidStart>::call},
+    {"pause", &l_method<void (Node::*)(), &Node::pause>::call},
+    {"removeAllChildren", &l_method<void (Node::*)(), &Node::removeAllChildren>::call},
+    {"removeAllChildrenWithCleanup", &l_method<void (Node::*)(bool), &Node::removeAllChildrenWithCleanup>::call},
+    {"removeChild", &l_overload<
+        l_method<void (*)(Node*, Node*), &l_Node_removeChild_1>,
+        l_method<void (Node::*)(Node*, bool), &Node::removeChild>
+    >::call},
+    {"removeChildByName", &l_overload<
+        l_method<void (*)(Node*, const std::string&), &l_Node_removeChildByName_1>,
+        l_method<void (Node::*)(const std::string&, bool), &Node::removeChildByName>
+    >::call},
+    {"removeChildByTag", &l_overload<
+        l_method<void (*)(Node*, int), &l_Node_removeChildByTag_1>,
+        l_method<void (Node::*)(int, bool), &Node::removeChildByTag>
+    >::call},
+    {"removeFromParent", &l_method<void (Node::*)(), &Node::removeFromParent>::call},
+    {"removeFromParentAndCleanup", &l_method<void (Node::*)(bool), &Node::removeFromParentAndCleanup>::call},
+    {"reorderChild", &l_method<void (Node::*)(Node*, int), &Node::reorderChild>::call},
+    {"resume", &l_method<void (Node::*)(), &Node::resume>::call},
+    {"runAction", &l_method<Action* (Node::*)(Action*), &Node::runAction>::call},
+    {"scheduleUpdate", &l_method<void (Node::*)(), &Node::scheduleUpdate>::call},
+    {"scheduleUpdateWithPriority", &l_method<void (Node::*)(int), &Node::scheduleUpdateWithPriority>::call},
+    {"setAnchorPoint", &l_method<void (Node::*)(const Vec2&), &Node::setAnchorPoint>::call},
+    {"setCameraMask", &l_overload<
+        l_method<void (*)(Node*, unsigned short), &l_Node_setCameraMask_1>,
+        l_method<void (Node::*)(unsigned short, bool), &Node::setCameraMask>
+    >::call},
+    {"setCascadeColorEnabled", &l_method<void (Node::*)(bool), &Node::setCascadeColorEnabled>::call},
+    {"setCascadeOpacityEnabled", &l_method<void (Node::*)(bool), &Node::setCascadeOpacityEnabled>::call},
+    {"setChildOrder", &l_method<void (Node::*)(Node::ChildOrder), &Node::setChildOrder>::call},
+    {"setColor", &l_method<void (Node::*)(const Color3B&), &Node::setColor>::call},
+    {"setContentSize", &l_method<void (Node::*)(const Size&), &Node::setContentSize>::call},
+    {"setCullingEnabled", &l_method<void (Node::*)(bool), &Node::setCullingEnabled>::call},
+    {"setEventDispatcher", &l_method<void (Node::*)(EventDispatcher*), &Node::setEventDispatcher>::call},
+    {"setGlobalZOrder", &l_method<void (Node::*)(float), &Node::setGlobalZOrder>::call},
+    {"setLocalZOrder", &l_method<void (Node::*)(int), &Node::setLocalZOrder>::call},
+    {"setName", &l_method<void (Node::*)(const std::string&), &Node::setName>::call},
+    {"setNormalizedPosition", &l_method<void (Node::*)(const Vec2&), &Node::setNormalizedPosition>::call},
+    {"setOpacity", &l_method<void (Node::*)(GLubyte), &Node::setOpacity>::call},
+    {"setOpacityModifyRGB", &l_method<void (Node::*)(bool), &Node::setOpacityModifyRGB>::call},
+    {"setOrderOfArrival", &l_method<void (Node::*)(int), &Node::setOrderOfArrival>::call},
+    {"setParallelVisitEnabled", &l_method<void (Node::*)(bool), &Node::setParallelVisitEnabled>::call},
+    {"setParent", &l_method<void (Node::*)(Node*), &Node::setParent>::call},
+    {"setPosition", &l_overload<
+        l_method<void (Node::*)(const Vec2&), &Node::setPosition>,
+        l_method<void (Node::*)(float, float), &Node::setPosition>
+    >::call},
+    {"setPositionX", &l_method<void (Node::*)(float), &Node::setPositionX>::call},
+    {"setPositionY", &l_method<void (Node::*)(float), &Node::setPositionY>::call},
+    {"setPositionZ", &l_method<void (Node::*)(float), &Node::setPositionZ>::call},
+    {"setRotation", &l_method<void (Node::*)(float), &Node::setRotation>::call},
+    {"setRotationSkewX", &l_method<void (Node::*)(float), &Node::setRotationSkewX>::call},
+    {"setRotationSkewY", &l_method<void (Node::*)(float), &Node::setRotationSkewY>::call},
+    {"setScale", &l_overload<
+        l_method<void (Node::*)(float), &Node::setScale>,
+        l_method<void (Node::*)(float, float), &Node::setScale>
+    >::call},
+    {"setScaleX", &l_method<void (Node::*)(float), &Node::setScaleX>::call},
+    {"setScaleY", &l_method<void (Node::*)(float), &Node::setScaleY>::call},
+    {"setScaleZ", &l_method<void (Node::*)(float), &Node::setScaleZ>::call},
+    {"setScheduler", &l_method<void (Node::*)(Scheduler*), &Node::setScheduler>::call},
+    {"setSkewX", &l_method<void (Node::*)(float), &Node::setSkewX>::call},
+    {"setSkewY", &l_method<void (Node::*)(float), &Node::setSkewY>::call},
+    {"setTag", &l_method<void (Node::*)(int), &Node::setTag>::call},
+    {"setVisible", &l_method<void (Node::*)(bool), &Node::setVisible>::call},
+    {"sortAllChildren", &l_method<void (Node::*)(), &Node::sortAllChildren>::call},
+    {"stopAction", &l_method<void (Node::*)(Action*), &Node::stopAction>::call},
+    {"stopActionByTag", &l_method<void (Node::*)(int), &Node::stopActionByTag>::call},
+    {"stopActionsByFlags", &l_method<void (Node::*)(unsigned int), &Node::stopActionsByFlags>::call},
+    {"stopAllActions", &l_method<void (Node::*)(), &Node::stopAllActions>::call},
+    {"stopAllActionsByTag", &l_method<void (Node::*)(int), &Node::stopAllActionsByTag>::call},
+    {"unschedule", &l_overload<
+        l_method<void (Node::*)(const std::string&), &Node::unschedule>,
+        l_method<void (Node::*)(ccSchedulerHandle), &Node::unschedule>
+    >::call},
+    {"unscheduleAllCallbacks", &l_method<void (Node::*)(), &Node::unscheduleAllCallbacks>::call},
+    {"unscheduleUpdate", &l_method<void (Node::*)(), &Node::unscheduleUpdate>::call},
+    {"update", &l_method<void (Node::*)(float), &Node::update>::call},
+    {"updateDisplayedColor", &l_method<void (Node::*)(const Color3B&), &Node::updateDisplayedColor>::call},
+    {"updateDisplayedOpacity", &l_method<void (Node::*)(GLubyte), &Node::updateDisplayedOpacity>::call},
+    {"updateTransform", &l_method<void (Node::*)(), &Node::updateTransform>::call},
+    {NULL, NULL}
+};
+
+// Scene
+
+static const luaL_Reg l_auto_Scene[] = {
+    {"create", &l_method<Scene* (*)(), &Scene::create>::call},
+    {"createWithSize", &l_method<Scene* (*)(const Size&), &Scene::createWithSize>::call},
+    {"getDescription", &l_method<std::string (Scene::*)() const, &Scene::getDescription>::call},
+    {"isCommandReorderEnabled", &l_method<bool (Scene::*)() const, &Scene::isCommandReorderEnabled>::call},
+    {"isTransformSystemEnabled", &l_method<bool (Scene::*)() const, &Scene::isTransformSystemEnabled>::call},
+    {"removeAllChildren", &l_method<void (Scene::*)(), &Scene::removeAllChildren>::call},
+    {"setCommandReorderEnabled", &l_method<void (Scene::*)(bool), &Scene::setCommandReorderEnabled>::call},
+    {"setTransformSystemEnabled", &l_method<void (Scene::*)(bool), &Scene::setTransformSystemEnabled>::call},
+    {NULL, NULL}
+};
+
+// Layer
+
+static const luaL_Reg l_auto_Layer[] = {
+    {"create", &l_method<Layer* (*)(), &Layer::create>::call},
+    {"getDescription", &l_method<std::string (Layer::*)() const, &Layer::getDescription>::call},
+    {NULL, NULL}
+};
+
+// LayerColor
+
+static const luaL_Reg l_auto_LayerColor[] = {
+    {"changeHeight", &l_method<void (LayerColor::*)(GLfloat), &LayerColor::changeHeight>::call},
+    {"changeWidth", &l_method<void (LayerColor::*)(GLfloat), &LayerColor::changeWidth>::call},
+    {"changeWidthAndHeight", &l_method<void (LayerColor::*)(GLfloat, GLfloat), &LayerColor::changeWidthAndHeight>::call},
+    {"create", &l_overload<
+        l_method<LayerColor* (*)(), &LayerColor::create>,
+        l_method<LayerColor* (*)(const Color4B&, GLfloat, GLfloat), &LayerColor::create>,
+        l_method<LayerColor* (*)(const Color4B&), &LayerColor::create>
+    >::call},
+    {"getDescription", &l_method<std::string (LayerColor::*)() const, &LayerColor::getDescription>::call},
+    {"setContentSize", &l_method<void (LayerColor::*)(const Size&), &LayerColor::setContentSize>::call},
+    {NULL, NULL}
+};
+
+// Sprite
+
+static Sprite* l_Sprite_createWithTexture_2(Texture2D* a0, const Rect& a1)
+{
+    return Sprite::createWithTexture(a0, a1);
+}
+
+static const luaL_Reg l_auto_Sprite[] = {
+    {"addChild", &l_overload<
+        l_method<void (Sprite::*)(Node*, int, int), &Sprite::addChild>,
+        l_method<void (Sprite::*)(Node*, int, const std::string&), &Sprite::addChild>,
+        l_method<void (Node::*)(Node*), &Node::addChild>,
+        l_method<void (Node::*)(Node*, int), &Node::addChild>
+    >::call},
+    {"create", &l_overload<
+        l_method<Sprite* (*)(), &Sprite::create>,
+        l_method<Sprite* (*)(const std::string&), &Sprite::create>,
+        l_method<Sprite* (*)(const std::string&, const Rect&), &Sprite::create>
+    >::call},
+    {"createWithSpriteFrameName", &l_method<Sprite* (*)(const std::string&), &Sprite::createWithSpriteFrameName>::call},
+    {"createWithTexture", &l_overload<
+        l_method<Sprite* (*)(Texture2D*), &Sprite::createWithTexture>,
+        l_method<Sprite* (*)(Texture2D*, const Rect&), &l_Sprite_createWithTexture_2>,
+        l_method<Sprite* (*)(Texture2D*, const Rect&, bool), &Sprite::createWithTexture>
+    >::call},
+    {"getAtlasIndex", &l_method<ssize_t (Sprite::*)() const, &Sprite::getAtlasIndex>::call},
+    {"getDescription", &l_method<std::string (Sprite::*)() const, &Sprite::getDescription>::call},
+    {"getOffsetPosition", &l_method<const Vec2& (Sprite::*)() const, &Sprite::getOffsetPosition>::call},
+    {"getTexture", &l_method<Texture2D* (Sprite::*)() const, &Sprite::getTexture>::call},
+    {"getTextureRect", &l_method<const Rect& (Sprite::*)() const, &Sprite::getTextureRect>::call},
+    {"ignoreAnchorPointForPosition", &l_method<void (Sprite::*)(bool), &Sprite::ignoreAnchorPointForPosition>::call},
+    {"isDirty", &l_method<bool (Sprite::*)() const, &Sprite::isDirty>::call},
+    {"isFlippedX", &l_method<bool (Sprite::*)() const, &Sprite::isFlippedX>::call},
+    {"isFlippedY", &l_method<bool (Sprite::*)() const, &Sprite::isFlippedY>::call},
+    {"isOpacityModifyRGB", &l_method<bool (Sprite::*)() const, &Sprite::isOpacityModifyRGB>::call},
+    {"isTextureRectRotated", &l_method<bool (Sprite::*)() const, &Sprite::isTextureRectRotated>::call},
+    {"removeAllChildrenWithCleanup", &l_method<void (Sprite::*)(bool), &Sprite::removeAllChildrenWithCleanup>::call},
+    {"removeChild", &l_method<void (Sprite::*)(Node*, bool), &Sprite::removeChild>::call},
+    {"reorderChild", &l_method<void (Sprite::*)(Node*, int), &Sprite::reorderChild>::call},
+    {"setAnchorPoint", &l_method<void (Sprite::*)(const Vec2&), &Sprite::setAnchorPoint>::call},
+    {"setAtlasIndex", &l_method<void (Sprite::*)(ssize_t), &Sprite::setAtlasIndex>::call},
+    {"setDirty", &l_method<void (Sprite::*)(bool), &Sprite::setDirty>::call},
+    {"setDisplayFrameWithAnimationName", &l_method<void (Sprite::*)(const std::string&, ssize_t), &Sprite::setDisplayFrameWithAnimationName>::call},
+    {"setFlippedX", &l_method<void (Sprite::*)(bool), &Sprite::setFlippedX>::call},
+    {"setFlippedY", &l_method<void (Sprite::*)(bool), &Sprite::setFlippedY>::call},
+    {"setOpacityModifyRGB", &l_method<void (Sprite::*)(bool), &Sprite::setOpacityModifyRGB>::call},
+    {"setPosition", &l_overload<
+        l_method<void (Sprite::*)(const Vec2&), &Sprite::setPosition>,
+        l_method<void (Sprite::*)(float, float), &Sprite::setPosition>
+    >::call},
+    {"setPositionZ", &l_method<void (Sprite::*)(float), &Sprite::setPositionZ>::call},
+    {"setRotation", &l_method<void (Sprite::*)(float), &Sprite::setRotation>::call},
+    {"setRotationSkewX", &l_method<void (Sprite::*)(float), &Sprite::setRotationSkewX>::call},
+    {"setRotationSkewY", &l_method<void (Sprite::*)(float), &Sprite::setRotationSkewY>::call},
+    {"setScale", &l_overload<
+        l_method<void (Sprite::*)(float, float), &Sprite::setScale>,
+        l_method<void (Sprite::*)(float), &Sprite::setScale>
+    >::call},
+    {"setScaleX", &l_method<void (Sprite::*)(float), &Sprite::setScaleX>::call},
+    {"setScaleY", &l_method<void (Sprite::*)(float), &Sprite::setScaleY>::call},
+    {"setSkewX", &l_method<void (Sprite::*)(float), &Sprite::setSkewX>::call},
+    {"setSkewY", &l_method<void (Sprite::*)(float), &Sprite::setSkewY>::call},
+    {"setSpriteFrame", &l_method<void (Sprite::*)(const std::string&), &Sprite::setSpriteFrame>::call},
+    {"setTexture", &l_overload<
+        l_method<void (Sprite::*)(const std::string&), &Sprite::setTexture>,
+        l_method<void (Sprite::*)(Texture2D*), &Sprite::setTexture>
+    >::call},
+    {"setTextureRect", &l_overload<
+        l_method<void (Sprite::*)(const Rect&), &Sprite::setTextureRect>,
+        l_method<void (Sprite::*)(const Rect&, bool, const Size&), &Sprite::setTextureRect>
+    >::call},
+    {"setVertexRect", &l_method<void (Sprite::*)(const Rect&), &Sprite::setVertexRect>::call},
+    {"setVisible", &l_method<void (Sprite::*)(bool), &Sprite::setVisible>::call},
+    {"sortAllChildren", &l_method<void (Sprite::*)(), &Sprite::sortAllChildren>::call},
+    {"updateTransform", &l_method<void (Sprite::*)(), &Sprite::updateTransform>::call},
+    {NULL, NULL}
+};
+
+// Label
+
+static bool l_Label_setBMFontFilePath_1(Label *self, const std::string& a0)
+{
+    return self->setBMFontFilePath(a0);
+}
+
+static bool l_Label_setBMFontFilePath_2(Label *self, const std::string& a0, const Vec2& a1)
+{
+    return self->setBMFontFilePath(a0, a1);
+}
+
+static void l_Label_enableShadow_0(Label *self)
+{
+    return self->enableShadow();
+}
+
+static void l_Label_enableShadow_1(Label *self, const Color4B& a0)
+{
+    return self->enableShadow(a0);
+}
+
+static void l_Label_enableShadow_2(Label *self, const Color4B& a0, const Size& a1)
+{
+    return self->enableShadow(a0, a1);
+}
+
+static void l_Label_enableOutline_1(Label *self, const Color4B& a0)
+{
+    return self->enableOutline(a0);
+}
+
+static void l_Label_removeChild_1(Label *self, Node* a0)
+{
+    return self->removeChild(a0);
+}
+
+static const luaL_Reg l_auto_Label[] = {
+    {"create", &l_method<Label* (*)(), &Label::create>::call},
+    {"createWithCharMap", &l_overload<
+        l_method<Label* (*)(const std::string&, int, int, int), &Label::createWithCharMap>,
+        l_method<Label* (*)(Texture2D*, int, int, int), &Label::createWithCharMap>,
+        l_method<Label* (*)(const std::string&), &Label::createWithCharMap>
+    >::call},
+    {"disableEffect", &l_method<void (Label::*)(), &Label::disableEffect>::call},
+    {"enableBold", &l_method<void (Label::*)(), &Label::enableBold>::call},
+    {"enableGlow", &l_method<void (Label::*)(const Color4B&), &Label::enableGlow>::call},
+    {"enableItalics", &l_method<void (Label::*)(), &Label::enableItalics>::call},
+    {"enableOutline", &l_overload<
+        l_method<void (*)(Label*, const Color4B&), &l_Label_enableOutline_1>,
+        l_method<void (Label::*)(const Color4B&, int), &Label::enableOutline>
+    >::call},
+    {"enableShadow", &l_overload<
+        l_method<void (*)(Label*), &l_Label_enableShadow_0>,
+        l_method<void (*)(Label*, const Color4B&), &l_Label_enableShadow_1>,
+        l_method<void (*)(Label*, const Color4B&, const Size&), &l_Label_enableShadow_2>,
+        l_method<void (Label::*)(const Color4B&, const Size&, int), &Label::enableShadow>
+    >::call},
+    {"enableStrikethrough", &l_method<void (Label::*)(), &Label::enableStrikethrough>::call},
+    {"enableUnderline", &l_method<void (Label::*)(), &Label::enableUnderline>::call},
+    {"enableWrap", &l_method<void (Label::*)(bool), &Label::enableWrap>::call},
+    {"getAdditionalKerning", &l_method<float (Label::*)() const, &Label::getAdditionalKerning>::call},
+    {"getBMFontFilePath", &l_method<const std::string& (Label::*)() const, &Label::getBMFontFilePath>::call},
+    {"getBMFontSize", &l_method<float (Label::*)() const, &Label::getBMFontSize>::call},
+    {"getBoundingBox", &l_method<Rect (Label::*)() const, &Label::getBoundingBox>::call},
+    {"getContentSize", &l_method<const Size& (Label::*)() const, &Label::getContentSize>::call},
+    {"getDescription", &l_method<std::string (Label::*)() const, &Label::getDescription>::call},
+    {"getDimensions", &l_method<const Size& (Label::*)() const, &Label::getDimensions>::call},
+    {"getHeight", &l_method<float (Label::*)() const, &Label::getHeight>::call},
+    {"getLetter", &l_method<Sprite* (Label::*)(int), &Label::getLetter>::call},
+    {"getLineHeight", &l_method<float (Label::*)() const, &Label::getLineHeight>::call},
+    {"getLineSpacing", &l_method<float (Label::*)() const, &Label::getLineSpacing>::call},
+    {"getMaxLineWidth", &l_method<float (Label::*)(), &Label::getMaxLineWidth>::call},
+    {"getOutlineSize", &l_method<int (Label::*)() const, &Label::getOutlineSize>::call},
+    {"getOverflow", &l_method<Label::Overflow (Label::*)() const, &Label::getOverflow>::call},
+    {"getShadowBlurRadius", &l_method<float (Label::*)() const, &Label::getShadowBlurRadius>::call},
+    {"getShadowOffset", &l_method<Size (Label::*)() const, &Label::getShadowOffset>::call},
+    {"getString", &l_method<const std::string& (Label::*)() const, &Label::getString>::call},
+    {"getStringLength", &l_method<int (Label::*)(), &Label::getStringLength>::call},
+    {"getStringNumLines", &l_method<int (Label::*)(), &Label::getStringNumLines>::call},
+    {"getSystemFontName", &l_method<const std::string& (Label::*)() const, &Label::getSystemFontName>::call},
+    {"getSystemFontSize", &l_method<float (Label::*)() const, &Label::getSystemFontSize>::call},
+    {"getTextColor", &l_method<const Color4B& (Label::*)() const, &Label::getTextColor>::call},
+    {"getWidth", &l_method<float (Label::*)() const, &Label::getWidth>::call},
+    {"isClipMarginEnabled", &l_method<bool (Label::*)() const, &Label::isClipMarginEnabled>::call},
+    {"isOpacityModifyRGB", &l_method<bool (Label::*)() const, &Label::isOpacityModifyRGB>::call},
+    {"isShadowEnabled", &l_method<bool (Label::*)() const, &Label::isShadowEnabled>::call},
+    {"isWrapEnabled", &l_method<bool (Label::*)() const, &Label::isWrapEnabled>::call},
+    {"removeAllChildrenWithCleanup", &l_method<void (Label::*)(bool), &Label::removeAllChildrenWithCleanup>::call},
+    {"removeChild", &l_overload<
+        l_method<void (*)(Label*, Node*), &l_Label_removeChild_1>,
+        l_method<void (Label::*)(Node*, bool), &Label::removeChild>
+    >::call},
+    {"requestSystemFontRefresh", &l_method<void (Label::*)(), &Label::requestSystemFontRefresh>::call},
+    {"setAdditionalKerning", &l_method<void (Label::*)(float), &Label::setAdditionalKerning>::call},
+    {"setBMFontFilePath", &l_overload<
+        l_method<bool (*)(Label*, const std::string&), &l_Label_setBMFontFilePath_1>,
+        l_method<bool (*)(Label*, const std::string&, const Vec2&), &l_Label_setBMFontFilePath_2>,
+        l_method<bool (Label::*)(const std::string&, const Vec2&, float), &Label::setBMFontFilePath>
+    >::call},
+    {"setBMFontSize", &l_method<void (Label::*)(float), &Label::setBMFontSize>::call},
+    {"setCharMap", &l_overload<
+        l_method<bool (Label::*)(const std::string&, int, int, int), &Label::setCharMap>,
+        l_method<bool (Label::*)(Texture2D*, int, int, int), &Label::setCharMap>,
+        l_method<bool (Label::*)(const std::string&), &Label::setCharMap>
+    >::call},
+    {"setClipMarginEnabled", &l_method<void (Label::*)(bool), &Label::setClipMarginEnabled>::call},
+    {"setDimensions", &l_method<void (Label::*)(float, float), &Label::setDimensions>::call},
+    {"setGlobalZOrder", &l_method<void (Label::*)(float), &Label::setGlobalZOrder>::call},
+    {"setHeight", &l_method<void (Label::*)(float), &Label::setHeight>::call},
+    {"setLineBreakWithoutSpace", &l_method<void (Label::*)(bool), &Label::setLineBreakWithoutSpace>::call},
+    {"setLineHeight", &l_method<void (Label::*)(float), &Label::setLineHeight>::call},
+    {"setLineSpacing", &l_method<void (Label::*)(float), &Label::setLineSpacing>::call},
+    {"setMaxLineWidth", &l_method<void (Label::*)(float), &Label::setMaxLineWidth>::call},
+    {"setOpacityModifyRGB", &l_method<void (Label::*)(bool), &Label::setOpacityModifyRGB>::call},
+    {"setOverflow", &l_method<void (Label::*)(Label::Overflow), &Label::setOverflow>::call},
+    {"setString", &l_method<void (Label::*)(const std::string&), &Label::setString>::call},
+    {"setSystemFontName", &l_method<void (Label::*)(const std::string&), &Label::setSystemFontName>::call},
+    {"setSystemFontSize", &l_method<void (Label::*)(float), &Label::setSystemFontSize>::call},
+    {"setTextColor", &l_method<void (Label::*)(const Color4B&), &Label::setTextColor>::call},
+    {"setWidth", &l_method<void (Label::*)(float), &Label::setWidth>::call},
+    {"updateContent", &l_method<void (Label::*)(), &Label::updateContent>::call},
+    {"updateDisplayedColor", &l_method<void (Label::*)(const Color3B&), &Label::updateDisplayedColor>::call},
+    {"updateDisplayedOpacity", &l_method<void (Label::*)(GLubyte), &Label::updateDisplayedOpacity>::call},
+    {NULL, NULL}
+};
+
+// Action
+
+static const luaL_Reg l_auto_Action[] = {
+    {"clone", &l_method<Action* (Action::*)() const, &Action::clone>::call},
+    {"description", &l_method<std::string (Action::*)() const, &Action::description>::call},
+    {"getFlags", &l_method<unsigned int (Action::*)() const, &Action::getFlags>::call},
+    {"getOriginalTarget", &l_method<Node* (Action::*)() const, &Action::getOriginalTarget>::call},
+    {"getTag", &l_method<int (Action::*)() const, &Action::getTag>::call},
+    {"getTarget", &l_method<Node* (Action::*)() const, &Action::getTarget>::call},
+    {"isDone", &l_method<bool (Action::*)() const, &Action::isDone>::call},
+    {"reverse", &l_method<Action* (Action::*)() const, &Action::reverse>::call},
+    {"setFlags", &l_method<void (Action::*)(unsigned int), &Action::setFlags>::call},
+    {"setOriginalTarget", &l_method<void (Action::*)(Node*), &Action::setOriginalTarget>::call},
+    {"setTag", &l_method<void (Action::*)(int), &Action::setTag>::call},
+    {"setTarget", &l_method<void (Action::*)(Node*), &Action::setTarget>::call},
+    {"startWithTarget", &l_method<void (Action::*)(Node*), &Action::startWithTarget>::call},
+    {"step", &l_method<void (Action::*)(float), &Action::step>::call},
+    {"stop", &l_method<void (Action::*)(), &Action::stop>::call},
+    {"update", &l_method<void (Action::*)(float), &Action::update>::call},
+    {NULL, NULL}
+};
+
+// FiniteTimeAction
+
+static const luaL_Reg l_auto_FiniteTimeAction[] = {
+    {"clone", &l_method<FiniteTimeAction* (FiniteTimeAction::*)() const, &FiniteTimeAction::clone>::call},
+    {"getDuration", &l_method<float (FiniteTimeAction::*)() const, &FiniteTimeAction::getDuration>::call},
+    {"reverse", &l_method<FiniteTimeAction* (FiniteTimeAction::*)() const, &FiniteTimeAction::reverse>::call},
+    {"setDuration", &l_method<void (FiniteTimeAction::*)(float), &FiniteTimeAction::setDuration>::call},
+    {NULL, NULL}
+};
+
+// ActionInterval
+
+static const luaL_Reg l_auto_ActionInterval[] = {
+    {"clone", &l_method<ActionInterval* (ActionInterval::*)() const, &ActionInterval::clone>::call},
+    {"getAmplitudeRate", &l_method<float (ActionInterval::*)(), &ActionInterval::getAmplitudeRate>::call},
+    {"getElapsed", &l_method<float (ActionInterval::*)(), &ActionInterval::getElapsed>::call},
+    {"isDone", &l_method<bool (ActionInterval::*)() const, &ActionInterval::isDone>::call},
+    {"reverse", &l_method<ActionInterval* (ActionInterval::*)() const, &ActionInterval::reverse>::call},
+    {"setAmplitudeRate", &l_method<void (ActionInterval::*)(float), &ActionInterval::setAmplitudeRate>::call},
+    {"startWithTarget", &l_method<void (ActionInterval::*)(Node*), &ActionInterval::startWithTarget>::call},
+    {"step", &l_method<void (ActionInterval::*)(float), &ActionInterval::step>::call},
+    {NULL, NULL}
+};
+
+// ActionInstant
+
+static const luaL_Reg l_auto_ActionInstant[] = {
+    {"clone", &l_method<ActionInstant* (ActionInstant::*)() const, &ActionInstant::clone>::call},
+    {"isDone", &l_method<bool (ActionInstant::*)() const, &ActionInstant::isDone>::call},
+    {"reverse", &l_method<ActionInstant* (ActionInstant::*)() const, &ActionInstant::reverse>::call},
+    {"step", &l_method<void (ActionInstant::*)(float), &ActionInstant::step>::call},
+    {"update", &l_method<void (ActionInstant::*)(float), &ActionInstant::update>::call},
+    {NULL, NULL}
+};
+
+// Speed
+
+static const luaL_Reg l_auto_Speed[] = {
+    {"clone", &l_method<Speed* (Speed::*)() const, &Speed::clone>::call},
+    {"create", &l_method<Speed* (*)(ActionInterval*, float), &Speed::create>::call},
+    {"getInnerAction", &l_method<ActionInterval* (Speed::*)() const, &Speed::getInnerAction>::call},
+    {"getSpeed", &l_method<float (Speed::*)() const, &Speed::getSpeed>::call},
+    {"isDone", &l_method<bool (Speed::*)() const, &Speed::isDone>::call},
+    {"reverse", &l_method<Speed* (Speed::*)() const, &Speed::reverse>::call},
+    {"setInnerAction", &l_method<void (Speed::*)(ActionInterval*), &Speed::setInnerAction>::call},
+    {"setSpeed", &l_method<void (Speed::*)(float), &Speed::setSpeed>::call},
+    {"startWithTarget", &l_method<void (Speed::*)(Node*), &Speed::startWithTarget>::call},
+    {"step", &l_method<void (Speed::*)(float), &Speed::step>::call},
+    {"stop", &l_method<void (Speed::*)(), &Speed::stop>::call},
+    {NULL, NULL}
+};
+
+// Follow
+
+static Follow* l_Follow_create_1(Node* a0)
+{
+    return Follow::create(a0);
+}
+
+static const luaL_Reg l_auto_Follow[] = {
+    {"clone", &l_method<Follow* (Follow::*)() const, &Follow::clone>::call},
+    {"create", &l_overload<
+        l_method<Follow* (*)(Node*), &l_Follow_create_1>,
+        l_method<Follow* (*)(Node*, const Rect&), &Follow::create>
+    >::call},
+    {"isBoundarySet", &l_method<bool (Follow::*)() const, &Follow::isBoundarySet>::call},
+    {"isDone", &l_method<bool (Follow::*)() const, &Follow::isDone>::call},
+    {"reverse", &l_method<Follow* (Follow::*)() const, &Follow::reverse>::call},
+    {"setBoundarySet", &l_method<void (Follow::*)(bool), &Follow::setBoundarySet>::call},
+    {"step", &l_method<void (Follow::*)(float), &Follow::step>::call},
+    {"stop", &l_method<void (Follow::*)(), &Follow::stop>::call},
+    {NULL, NULL}
+};
+
+// RotateTo
+
+static const luaL_Reg l_auto_RotateTo[] = {
+    {NULL, NULL}
+};
+
+// RotateBy
+
+static const luaL_Reg l_auto_RotateBy[] = {
+    {NULL, NULL}
+};
+
+// MoveBy
+
+static const luaL_Reg l_auto_MoveBy[] = {
+    {NULL, NULL}
+};
+
+// MoveTo
+
+static const luaL_Reg l_auto_MoveTo[] = {
+    {NULL, NULL}
+};
+
+// SkewTo
+
+static const luaL_Reg l_auto_SkewTo[] = {
+    {NULL, NULL}
+};
+
+// SkewBy
+
+static const luaL_Reg l_auto_SkewBy[] = {
+    {NULL, NULL}
+};
+
+// JumpBy
+
+static const luaL_Reg l_auto_JumpBy[] = {
+    {NULL, NULL}
+};
+
+// JumpTo
+
+static const luaL_Reg l_auto_JumpTo[] = {
+    {NULL, NULL}
+};
+
+// ScaleTo
+
+static const luaL_Reg l_auto_ScaleTo[] = {
+    {NULL, NULL}
+};
+
+// ScaleBy
+
+static const luaL_Reg l_auto_ScaleBy[] = {
+    {NULL, NULL}
+};
+
+// Blink
+
+static const luaL_Reg l_auto_Blink[] = {
+    {NULL, NULL}
+};
+
+// FadeTo
+
+static const luaL_Reg l_auto_FadeTo[] = {
+    {NULL, NULL}
+};
+
+// FadeIn
+
+static const luaL_Reg l_auto_FadeIn[] = {
+    {NULL, NULL}
+};
+
+// FadeOut
+
+static const luaL_Reg l_auto_FadeOut[] = {
+    {NULL, NULL}
+};
+
+// TintTo
+
+static const luaL_Reg l_auto_TintTo[] = {
+    {NULL, NULL}
+};
+
+// TintBy
+
+static const luaL_Reg l_auto_TintBy[] = {
+    {NULL, NULL}
+};
+
+// DelayTime
+
+static const luaL_Reg l_auto_DelayTime[] = {
+    {NULL, NULL}
+};
+
+// Repeat
+
+static const luaL_Reg l_auto_Repeat[] = {
+    {NULL, NULL}
+};
+
+// RepeatForever
+
+static const luaL_Reg l_auto_RepeatForever[] = {
+    {NULL, NULL}
+};
+
+// ReverseTime
+
+static const luaL_Reg l_auto_ReverseTime[] = {
+    {NULL, NULL}
+};
+
+// Show
+
+static const luaL_Reg l_auto_Show[] = {
+    {NULL, NULL}
+};
+
+// Hide
+
+static const luaL_Reg l_auto_Hide[] = {
+    {NULL, NULL}
+};
+
+// ToggleVisibility
+
+static const luaL_Reg l_auto_ToggleVisibility[] = {
+    {NULL, NULL}
+};
+
+// RemoveSelf
+
+static const luaL_Reg l_auto_RemoveSelf[] = {
+    {NULL, NULL}
+};
+
+// FlipX
+
+static const luaL_Reg l_auto_FlipX[] = {
+    {NULL, NULL}
+};
+
+// FlipY
+
+static const luaL_Reg l_auto_FlipY[] = {
+    {NULL, NULL}
+};
+
+// Place
+
+static const luaL_Reg l_auto_Place[] = {
+    {NULL, NULL}
+};
+
+// ActionEase
+
+static const luaL_Reg l_auto_ActionEase[] = {
+    {"clone", &l_method<ActionEase* (ActionEase::*)() const, &ActionEase::clone>::call},
+    {"getInnerAction", &l_method<ActionInterval* (ActionEase::*)(), &ActionEase::getInnerAction>::call},
+    {"reverse", &l_method<ActionEase* (ActionEase::*)() const, &ActionEase::reverse>::call},
+    {"startWithTarget", &l_method<void (ActionEase::*)(Node*), &ActionEase::startWithTarget>::call},
+    {"stop", &l_method<void (ActionEase::*)(), &ActionEase::stop>::call},
+    {"update", &l_method<void (ActionEase::*)(float), &ActionEase::update>::call},
+    {NULL, NULL}
+};
+
+// EaseRateAction
+
+static const luaL_Reg l_auto_EaseRateAction[] = {
+    {"clone", &l_method<EaseRateAction* (EaseRateAction::*)() const, &EaseRateAction::clone>::call},
+    {"create", &l_method<EaseRateAction* (*)(ActionInterval*, float), &EaseRateAction::create>::call},
+    {"getRate", &l_method<float (EaseRateAction::*)() const, &EaseRateAction::getRate>::call},
+    {"reverse", &l_method<EaseRateAction* (EaseRateAction::*)() const, &EaseRateAction::reverse>::call},
+    {"setRate", &l_method<void (EaseRateAction::*)(float), &EaseRateAction::setRate>::call},
+    {NULL, NULL}
+};
+
+// EaseIn
+
+static const luaL_Reg l_auto_EaseIn[] = {
+    {"clone", &l_method<EaseIn* (EaseIn::*)() const, &EaseIn::clone>::call},
+    {"create", &l_method<EaseIn* (*)(ActionInterval*, float), &EaseIn::create>::call},
+    {"reverse", &l_method<EaseIn* (EaseIn::*)() const, &EaseIn::reverse>::call},
+    {"update", &l_method<void (EaseIn::*)(float), &EaseIn::update>::call},
+    {NULL, NULL}
+};
+
+// EaseOut
+
+static const luaL_Reg l_auto_EaseOut[] = {
+    {"clone", &l_method<EaseOut* (EaseOut::*)() const, &EaseOut::clone>::call},
+    {"create", &l_method<EaseOut* (*)(ActionInterval*, float), &EaseOut::create>::call},
+    {"reverse", &l_method<EaseOut* (EaseOut::*)() const, &EaseOut::reverse>::call},
+    {"update", &l_method<void (EaseOut::*)(float), &EaseOut::update>::call},
+    {NULL, NULL}
+};
+
+// EaseInOut
+
+static const luaL_Reg l_auto_EaseInOut[] = {
+    {"clone", &l_method<EaseInOut* (EaseInOut::*)() const, &EaseInOut::clone>::call},
+    {"create", &l_method<EaseInOut* (*)(ActionInterval*, float), &EaseInOut::create>::call},
+    {"reverse", &l_method<EaseInOut* (EaseInOut::*)() const, &EaseInOut::reverse>::call},
+    {"update", &l_method<void (EaseInOut::*)(float), &EaseInOut::update>::call},
+    {NULL, NULL}
+};
+
+// EaseSineIn
+
+static const luaL_Reg l_auto_EaseSineIn[] = {
+    {"clone", &l_method<EaseSineIn* (EaseSineIn::*)() const, &EaseSineIn::clone>::call},
+    {"create", &l_method<EaseSineIn* (*)(ActionInterval*), &EaseSineIn::create>::call},
+    {"reverse", &l_method<ActionEase* (EaseSineIn::*)() const, &EaseSineIn::reverse>::call},
+    {"update", &l_method<void (EaseSineIn::*)(float), &EaseSineIn::update>::call},
+    {NULL, NULL}
+};
+
+// EaseSineOut
+
+static const luaL_Reg l_auto_EaseSineOut[] = {
+    {"clone", &l_method<EaseSineOut* (EaseSineOut::*)() const, &EaseSineOut::clone>::call},
+    {"create", &l_method<EaseSineOut* (*)(ActionInterval*), &EaseSineOut::create>::call},
+    {"reverse", &l_method<ActionEase* (EaseSineOut::*)() const, &EaseSineOut::reverse>::call},
+    {"update", &l_method<void (EaseSineOut::*)(float), &EaseSineOut::update>::call},
+    {NULL, NULL}
+};
+
+// EaseSineInOut
+
+static const luaL_Reg l_auto_EaseSineInOut[] = {
+    {"clone", &l_method<EaseSineInOut* (EaseSineInOut::*)() const, &EaseSineInOut::clone>::call},
+    {"create", &l_method<EaseSineInOut* (*)(ActionInterval*), &EaseSineInOut::create>::call},
+    {"reverse", &l_method<EaseSineInOut* (EaseSineInOut::*)() const, &EaseSineInOut::reverse>::call},
+    {"update", &l_method<void (EaseSineInOut::*)(float), &EaseSineInOut::update>::call},
+    {NULL, NULL}
+};
+
+// EaseBackIn
+
+static const luaL_Reg l_auto_EaseBackIn[] = {
+    {"clone", &l_method<EaseBackIn* (EaseBackIn::*)() const, &EaseBackIn::clone>::call},
+    {"create", &l_method<EaseBackIn* (*)(ActionInterval*), &EaseBackIn::create>::call},
+    {"reverse", &l_method<ActionEase* (EaseBackIn::*)() const, &EaseBackIn::reverse>::call},
+    {"update", &l_method<void (EaseBackIn::*)(float), &EaseBackIn::update>::call},
+    {NULL, NULL}
+};
+
+// EaseBackOut
+
+static const luaL_Reg l_auto_EaseBackOut[] = {
+    {"clone", &l_method<EaseBackOut* (EaseBackOut::*)() const, &EaseBackOut::clone>::call},
+    {"create", &l_method<EaseBackOut* (*)(ActionInterval*), &EaseBackOut::create>::call},
+    {"reverse", &l_method<ActionEase* (EaseBackOut::*)() const, &EaseBackOut::reverse>::call},
+    {"update", &l_method<void (EaseBackOut::*)(float), &EaseBackOut::update>::call},
+    {NULL, NULL}
+};
+
+// EaseBackInOut
+
+static const luaL_Reg l_auto_EaseBackInOut[] = {
+    {"clone", &l_method<EaseBackInOut* (EaseBackInOut::*)() const, &EaseBackInOut::clone>::call},
+    {"create", &l_method<EaseBackInOut* (*)(ActionInterval*), &EaseBackInOut::create>::call},
+    {"reverse", &l_method<EaseBackInOut* (EaseBackInOut::*)() const, &EaseBackInOut::reverse>::call},
+    {"update", &l_method<void (EaseBackInOut::*)(float), &EaseBackInOut::update>::call},
+    {NULL, NULL}
+};
+
+// EaseElasticIn
+
+static const luaL_Reg l_auto_EaseElasticIn[] = {
+    {"clone", &l_method<EaseElasticIn* (EaseElasticIn::*)() const, &EaseElasticIn::clone>::call},
+    {"create", &l_overload<
+        l_method<EaseElasticIn* (*)(ActionInterval*, float), &EaseElasticIn::create>,
+        l_method<EaseElasticIn* (*)(ActionInterval*), &EaseElasticIn::create>
+    >::call},
+    {"update", &l_method<void (EaseElasticIn::*)(float), &EaseElasticIn::update>::call},
+    {NULL, NULL}
+};
+
+// EaseElasticOut
+
+static const luaL_Reg l_auto_EaseElasticOut[] = {
+    {"clone", &l_method<EaseElasticOut* (EaseElasticOut::*)() const, &EaseElasticOut::clone>::call},
+    {"create", &l_overload<
+        l_method<EaseElasticOut* (*)(ActionInterval*, float), &EaseElasticOut::create>,
+        l_method<EaseElasticOut* (*)(ActionInterval*), &EaseElasticOut::create>
+    >::call},
+    {"update", &l_method<void (EaseElasticOut::*)(float), &EaseElasticOut::update>::call},
+    {NULL, NULL}
+};
+
+// EaseElasticInOut
+
+static const luaL_Reg l_auto_EaseElasticInOut[] = {
+    {"clone", &l_method<EaseElasticInOut* (EaseElasticInOut::*)() const, &EaseElasticInOut::clone>::call},
+    {"create", &l_overload<
+        l_method<EaseElasticInOut* (*)(ActionInterval*, float), &EaseElasticInOut::create>,
+        l_method<EaseElasticInOut* (*)(ActionInterval*), &EaseElasticInOut::create>
+    >::call},
+    {"reverse", &l_method<EaseElasticInOut* (EaseElasticInOut::*)() const, &EaseElasticInOut::reverse>::call},
+    {"update", &l_method<void (EaseElasticInOut::*)(float), &EaseElasticInOut::update>::call},
+    {NULL, NULL}
+};
+
+// EaseBounceIn
+
+static const luaL_Reg l_auto_EaseBounceIn[] = {
+    {"clone", &l_method<EaseBounceIn* (EaseBounceIn::*)() const, &EaseBounceIn::clone>::call},
+    {"create", &l_method<EaseBounceIn* (*)(ActionInterval*), &EaseBounceIn::create>::call},
+    {"update", &l_method<void (EaseBounceIn::*)(float), &EaseBounceIn::update>::call},
+    {NULL, NULL}
+};
+
+// EaseBounceOut
+
+static const luaL_Reg l_auto_EaseBounceOut[] = {
+    {"clone", &l_method<EaseBounceOut* (EaseBounceOut::*)() const, &EaseBounceOut::clone>::call},
+    {"create", &l_method<EaseBounceOut* (*)(ActionInterval*), &EaseBounceOut::create>::call},
+    {"update", &l_method<void (EaseBounceOut::*)(float), &EaseBounceOut::update>::call},
+    {NULL, NULL}
+};
+
+// EaseBounceInOut
+
+static const luaL_Reg l_auto_EaseBounceInOut[] = {
+    {"clone", &l_method<EaseBounceInOut* (EaseBounceInOut::*)() const, &EaseBounceInOut::clone>::call},
+    {"create", &l_method<EaseBounceInOut* (*)(ActionInterval*), &EaseBounceInOut::create>::call},
+    {"reverse", &l_method<EaseBounceInOut* (EaseBounceInOut::*)() const, &EaseBounceInOut::reverse>::call},
+    {"update", &l_method<void (EaseBounceInOut::*)(float), &EaseBounceInOut::update>::call},
+    {NULL, NULL}
+};
+
+// Director
+
+static const luaL_Reg l_auto_Director[] = {
+    {"convertToGL", &l_method<Vec2 (Director::*)(const Vec2&), &Director::convertToGL>::call},
+    {"convertToUI", &l_method<Vec2 (Director::*)(const Vec2&), &Director::convertToUI>::call},
+    {"drawScene", &l_method<void (Director::*)(), &Director::drawScene>::call},
+    {"end", &l_method<void (Director::*)(), &Director::end>::call},
+    {"getAnimationInterval", &l_method<float (Director::*)(), &Director::getAnimationInterval>::call},
+    {"getContentScaleFactor", &l_method<float (Director::*)() const, &Director::getContentScaleFactor>::call},
+    {"getDeltaTime", &l_method<float (Director::*)() const, &Director::getDeltaTime>::call},
+    {"getEventDispatcher", &l_method<EventDispatcher* (Director::*)() const, &Director::getEventDispatcher>::call},
+    {"getFrameRate", &l_method<float (Director::*)() const, &Director::getFrameRate>::call},
+    {"getInstance", &l_method<Director *(*)(), &Director::getInstance>::call},
+    {"getNotificationNode", &l_method<Node* (Director::*)() const, &Director::getNotificationNode>::call},
+    {"getProjection", &l_method<Director::Projection (Director::*)(), &Director::getProjection>::call},
+    {"getRunningScene", &l_method<Scene* (Director::*)(), &Director::getRunningScene>::call},
+    {"getScheduler", &l_method<Scheduler* (Director::*)() const, &Director::getScheduler>::call},
+    {"getSecondsPerFrame", &l_method<float (Director::*)(), &Director::getSecondsPerFrame>::call},
+    {"getTextureCache", &l_method<TextureCache* (Director::*)() const, &Director::getTextureCache>::call},
+    {"getTotalFrames", &l_method<unsigned int (Director::*)(), &Director::getTotalFrames>::call},
+    {"getVisibleOrigin", &l_method<Vec2 (Director::*)() const, &Director::getVisibleOrigin>::call},
+    {"getVisibleSize", &l_method<Size (Director::*)() const, &Director::getVisibleSize>::call},
+    {"getWinSize", &l_method<const Size& (Director::*)() const, &Director::getWinSize>::call},
+    {"getWinSizeInPixels", &l_method<Size (Director::*)() const, &Director::getWinSizeInPixels>::call},
+    {"getZEye", &l_method<float (Director::*)() const, &Director::getZEye>::call},
+    {"init", &l_method<bool (Director::*)(), &Director::init>::call},
+    {"isCullingEnabled", &l_method<bool (Director::*)() const, &Director::isCullingEnabled>::call},
+    {"isDisplayStats", &l_method<bool (Director::*)(), &Director::isDisplayStats>::call},
+    {"isFrameTimingsEnabled", &l_method<bool (Director::*)() const, &Director::isFrameTimingsEnabled>::call},
+    {"isNextDeltaTimeZero", &l_method<bool (Director::*)(), &Director::isNextDeltaTimeZero>::call},
+    {"isPaused", &l_method<bool (Director::*)(), &Director::isPaused>::call},
+    {"isPurgeDirectorInNextLoop", &l_method<bool (Director::*)() const, &Director::isPurgeDirectorInNextLoop>::call},
+    {"isSendCleanupToScene", &l_method<bool (Director::*)(), &Director::isSendCleanupToScene>::call},
+    {"loadIdentityMatrix", &l_method<void (Director::*)(MATRIX_STACK_TYPE), &Director::loadIdentityMatrix>::call},
+    {"pause", &l_method<void (Director::*)(), &Director::pause>::call},
+    {"popMatrix", &l_method<void (Director::*)(MATRIX_STACK_TYPE), &Director::popMatrix>::call},
+    {"popScene", &l_method<void (Director::*)(), &Director::popScene>::call},
+    {"popToRootScene", &l_method<void (Director::*)(), &Director::popToRootScene>::call},
+    {"popToSceneStackLevel", &l_method<void (Director::*)(int), &Director::popToSceneStackLevel>::call},
+    {"purgeCachedData", &l_method<void (Director::*)(), &Director::purgeCachedData>::call},
+    {"purgeDirector", &l_method<void (Director::*)(), &Director::purgeDirector>::call},
+    {"pushMatrix", &l_method<void (Director::*)(MATRIX_STACK_TYPE), &Director::pushMatrix>::call},
+    {"pushScene", &l_method<void (Director::*)(Scene*), &Director::pushScene>::call},
+    {"replaceScene", &l_method<void (Director::*)(Scene*), &Director::replaceScene>::call},
+    {"resetMatrixStack", &l_method<void (Director::*)(), &Director::resetMatrixStack>::call},
+    {"restart", &l_method<void (Director::*)(), &Director::restart>::call},
+    {"resume", &l_method<void (Director::*)(), &Director::resume>::call},
+    {"runWithScene", &l_method<void (Director::*)(Scene*), &Director::runWithScene>::call},
+    {"setAlphaBlending", &l_method<void (Director::*)(bool), &Director::setAlphaBlending>::call},
+    {"setAnimationInterval", &l_method<void (Director::*)(float), &Director::setAnimationInterval>::call},
+    {"setContentScaleFactor", &l_method<void (Director::*)(float), &Director::setContentScaleFactor>::call},
+    {"setCullingEnabled", &l_method<void (Director::*)(bool), &Director::setCullingEnabled>::call},
+    {"setDefaultValues", &l_method<void (Director::*)(), &Director::setDefaultValues>::call},
+    {"setDepthTest", &l_method<void (Director::*)(bool), &Director::setDepthTest>::call},
+    {"setDisplayStats", &l_method<void (Director::*)(bool), &Director::setDisplayStats>::call},
+    {"setEventDispatcher", &l_method<void (Director::*)(EventDispatcher*), &Director::setEventDispatcher>::call},
+    {"setFrameTimingsEnabled", &l_method<void (Director::*)(bool), &Director::setFrameTimingsEnabled>::call},
+    {"setGLDefaultValues", &l_method<void (Director::*)(), &Director::setGLDefaultValues>::call},
+    {"setNextDeltaTimeZero", &l_method<void (Director::*)(bool), &Director::setNextDeltaTimeZero>::call},
+    {"setNotificationNode", &l_method<void (Director::*)(Node*), &Director::setNotificationNode>::call},
+    {"setProjection", &l_method<void (Director::*)(Director::Projection), &Director::setProjection>::call},
+    {"setScheduler", &l_method<void (Director::*)(Scheduler*), &Director::setScheduler>::call},
+    {"setViewport", &l_method<void (Director::*)(), &Director::setViewport>::call},
+    {"startAnimation", &l_method<void (Director::*)(), &Director::startAnimation>::call},
+    {"stopAnimation", &l_method<void (Director::*)(), &Director::stopAnimation>::call},
+    {NULL, NULL}
+};
+
+// Scheduler
+
+static const luaL_Reg l_auto_Scheduler[] = {
+    {"getDeferredTaskBudget", &l_method<float (Scheduler::*)() const, &Scheduler::getDeferredTaskBudget>::call},
+    {"getTimeScale", &l_method<float (Scheduler::*)(), &Scheduler::getTimeScale>::call},
+    {"isScheduled", &l_method<bool (Scheduler::*)(ccSchedulerHandle) const, &Scheduler::isScheduled>::call},
+    {"setDeferredTaskBudget", &l_method<void (Scheduler::*)(float), &Scheduler::setDeferredTaskBudget>::call},
+    {"setTimeScale", &l_method<void (Scheduler::*)(float), &Scheduler::setTimeScale>::call},
+    {"unschedule", &l_method<void (Scheduler::*)(ccSchedulerHandle), &Scheduler::unschedule>::call},
+    {"unscheduleAll", &l_method<void (Scheduler::*)(), &Scheduler::unscheduleAll>::call},
+    {"unscheduleAllWithMinPriority", &l_method<void (Scheduler::*)(int), &Scheduler::unscheduleAllWithMinPriority>::call},
+    {"update", &l_method<void (Scheduler::*)(float), &Scheduler::update>::call},
+    {NULL, NULL}
+};
+
+// EventListener
+
+static const luaL_Reg l_auto_EventListener[] = {
+    {"checkAvailable", &l_method<bool (EventListener::*)(), &EventListener::checkAvailable>::call},
+    {"clone", &l_method<EventListener* (EventListener::*)(), &EventListener::clone>::call},
+    {"getHashCode", &l_method<size_t (*)(const std::string&), &EventListener::getHashCode>::call},
+    {"isEnabled", &l_method<bool (EventListener::*)() const, &EventListener::isEnabled>::call},
+    {"setEnabled", &l_method<void (EventListener::*)(bool), &EventListener::setEnabled>::call},
+    {NULL, NULL}
+};
+
+// EventDispatcher
+
+static void l_EventDispatcher_removeEventListenersForTarget_1(EventDispatcher *self, Node* a0)
+{
+    return self->removeEventListenersForTarget(a0);
+}
+
+static void l_EventDispatcher_pauseEventListenersForTarget_1(EventDispatcher *self, Node* a0)
+{
+    return self->pauseEventListenersForTarget(a0);
+}
+
+static void l_EventDispatcher_resumeEventListenersForTarget_1(EventDispatcher *self, Node* a0)
+{
+    return self->resumeEventListenersForTarget(a0);
+}
+
+static void l_EventDispatcher_setTouchSpatialIndexEnabled_1(EventDispatcher *self, bool a0)
+{
+    return self->setTouchSpatialIndexEnabled(a0);
+}
+
+static const luaL_Reg l_auto_EventDispatcher[] = {
+    {"addEventListenerWithFixedPriority", &l_method<void (EventDispatcher::*)(EventListener*, int), &EventDispatcher::addEventListenerWithFixedPriority>::call},
+    {"addEventListenerWithSceneGraphPriority", &l_method<void (EventDispatcher::*)(EventListener*, Node*), &EventDispatcher::addEventListenerWithSceneGraphPriority>::call},
+    {"isEnabled", &l_method<bool (EventDispatcher::*)() const, &EventDispatcher::isEnabled>::call},
+    {"isTouchSpatialIndexEnabled", &l_method<bool (EventDispatcher::*)() const, &EventDispatcher::isTouchSpatialIndexEnabled>::call},
+    {"pauseEventListenersForTarget", &l_overload<
+        l_method<void (*)(EventDispatcher*, Node*), &l_EventDispatcher_pauseEventListenersForTarget_1>,
+        l_method<void (EventDispatcher::*)(Node*, bool), &EventDispatcher::pauseEventListenersForTarget>
+    >::call},
+    {"removeAllEventListeners", &l_method<void (EventDispatcher::*)(), &EventDispatcher::removeAllEventListeners>::call},
+    {"removeCustomEventListeners", &l_method<void (EventDispatcher::*)(const std::string&), &EventDispatcher::removeCustomEventListeners>::call},
+    {"removeEventListener", &l_method<void (EventDispatcher::*)(EventListener*), &EventDispatcher::removeEventListener>::call},
+    {"removeEventListenersForTarget", &l_overload<
+        l_method<void (*)(EventDispatcher*, Node*), &l_EventDispatcher_removeEventListenersForTarget_1>,
+        l_method<void (EventDispatcher::*)(Node*, bool), &EventDispatcher::removeEventListenersForTarget>
+    >::call},
+    {"removeEventListenersForType", &l_method<void (EventDispatcher::*)(EventListener::Type), &EventDispatcher::removeEventListenersForType>::call},
+    {"resumeEventListenersForTarget", &l_overload<
+        l_method<void (*)(EventDispatcher*, Node*), &l_EventDispatcher_resumeEventListenersForTarget_1>,
+        l_method<void (EventDispatcher::*)(Node*, bool), &EventDispatcher::resumeEventListenersForTarget>
+    >::call},
+    {"setEnabled", &l_method<void (EventDispatcher::*)(bool), &EventDispatcher::setEnabled>::call},
+    {"setPriority", &l_method<void (EventDispatcher::*)(EventListener*, int), &EventDispatcher::setPriority>::call},
+    {"setTouchSpatialIndexEnabled", &l_overload<
+        l_method<void (*)(EventDispatcher*, bool), &l_EventDispatcher_setTouchSpatialIndexEnabled_1>,
+        l_method<void (EventDispatcher::*)(bool, float), &EventDispatcher::setTouchSpatialIndexEnabled>
+    >::call},
+    {NULL, NULL}
+};
+
+// FileUtils
+
+static void l_FileUtils_addSearchResolutionsOrder_1(FileUtils *self, const std::string& a0)
+{
+    return self->addSearchResolutionsOrder(a0);
+}
+
+static void l_FileUtils_addSearchPath_1(FileUtils *self, const std::string& a0)
+{
+    return self->addSearchPath(a0);
+}
+
+static bool l_FileUtils_mountAssetPack_1(FileUtils *self, const std::string& a0)
+{
+    return self->mountAssetPack(a0);
+}
+
+static const luaL_Reg l_auto_FileUtils[] = {
+    {"addSearchPath", &l_overload<
+        l_method<void (*)(FileUtils*, const std::string&), &l_FileUtils_addSearchPath_1>,
+        l_method<void (FileUtils::*)(const std::string&, const bool), &FileUtils::addSearchPath>
+    >::call},
+    {"addSearchResolutionsOrder", &l_overload<
+        l_method<void (*)(FileUtils*, const std::string&), &l_FileUtils_addSearchResolutionsOrder_1>,
+        l_method<void (FileUtils::*)(const std::string&, const bool), &FileUtils::addSearchResolutionsOrder>
+    >::call},
+    {"clearFileManifest", &l_method<void (FileUtils::*)(), &FileUtils::clearFileManifest>::call},
+    {"createDirectory", &l_method<bool (FileUtils::*)(const std::string&), &FileUtils::createDirectory>::call},
+    {"fullPathForFilename", &l_method<std::string (FileUtils::*)(const std::string&) const, &FileUtils::fullPathForFilename>::call},
+    {"fullPathForTextureFilename", &l_method<std::string (FileUtils::*)(const std::string&) const, &FileUtils::fullPathForTextureFilename>::call},
+    {"fullPathFromRelativeFile", &l_method<std::string (FileUtils::*)(const std::string&, const std::string&), &FileUtils::fullPathFromRelativeFile>::call},
+    {"getFileExtension", &l_method<std::string (FileUtils::*)(const std::string&) const, &FileUtils::getFileExtension>::call},
+    {"getFileSize", &l_method<long (FileUtils::*)(const std::string&), &FileUtils::getFileSize>::call},
+    {"getInstance", &l_method<FileUtils *(*)(), &FileUtils::getInstance>::call},
+    {"getStringFromFile", &l_method<std::string (FileUtils::*)(const std::string&), &FileUtils::getStringFromFile>::call},
+    {"getSuitableFOpen", &l_method<std::string (FileUtils::*)(const std::string&) const, &FileUtils::getSuitableFOpen>::call},
+    {"getWritablePath", &l_method<std::string (FileUtils::*)() const, &FileUtils::getWritablePath>::call},
+    {"isAbsolutePath", &l_method<bool (FileUtils::*)(const std::string&) const, &FileUtils::isAbsolutePath>::call},
+    {"isDirectoryExist", &l_method<bool (FileUtils::*)(const std::string&) const, &FileUtils::isDirectoryExist>::call},
+    {"isFileExist", &l_method<bool (FileUtils::*)(const std::string&) const, &FileUtils::isFileExist>::call},
+    {"isPopupNotify", &l_method<bool (FileUtils::*)() const, &FileUtils::isPopupNotify>::call},
+    {"loadFileManifest", &l_method<bool (FileUtils::*)(const std::string&), &FileUtils::loadFileManifest>::call},
+    {"loadFilenameLookupDictionaryFromFile", &l_method<void (FileUtils::*)(const std::string&), &FileUtils::loadFilenameLookupDictionaryFromFile>::call},
+    {"mountAssetPack", &l_overload<
+        l_method<bool (*)(FileUtils*, const std::string&), &l_FileUtils_mountAssetPack_1>,
+        l_method<bool (FileUtils::*)(const std::string&, bool), &FileUtils::mountAssetPack>
+    >::call},
+    {"purgeCachedEntries", &l_method<void (FileUtils::*)(), &FileUtils::purgeCachedEntries>::call},
+    {"removeDirectory", &l_method<bool (FileUtils::*)(const std::string&), &FileUtils::removeDirectory>::call},
+    {"removeFile", &l_method<bool (FileUtils::*)(const std::string&), &FileUtils::removeFile>::call},
+    {"renameFile", &l_overload<
+        l_method<bool (FileUtils::*)(const std::string&, const std::string&, const std::string&), &FileUtils::renameFile>,
+        l_method<bool (FileUtils::*)(const std::string&, const std::string&), &FileUtils::renameFile>
+    >::call},
+    {"setDefaultResourceRootPath", &l_method<void (FileUtils::*)(const std::string&), &FileUtils::setDefaultResourceRootPath>::call},
+    {"setPopupNotify", &l_method<void (FileUtils::*)(bool), &FileUtils::setPopupNotify>::call},
+    {"setWritablePath", &l_method<void (FileUtils::*)(const std::string&), &FileUtils::setWritablePath>::call},
+    {"unmountAssetPack", &l_method<void (FileUtils::*)(const std::string&), &FileUtils::unmountAssetPack>::call},
+    {"writeStringToFile", &l_method<bool (FileUtils::*)(const std::string&, const std::string&), &FileUtils::writeStringToFile>::call},
+    {NULL, NULL}
+};
+
+// Texture2D
+
+static const luaL_Reg l_auto_Texture2D[] = {
+    {"drawAtPoint", &l_method<void (Texture2D::*)(const Vec2&), &Texture2D::drawAtPoint>::call},
+    {"drawInRect", &l_method<void (Texture2D::*)(const Rect&), &Texture2D::drawInRect>::call},
+    {"fouceDeleteALLTexture2D", &l_method<void (*)(), &Texture2D::fouceDeleteALLTexture2D>::call},
+    {"generateMipmap", &l_method<void (Texture2D::*)(), &Texture2D::generateMipmap>::call},
+    {"getBitsPerPixelForFormat", &l_overload<
+        l_method<unsigned int (Texture2D::*)() const, &Texture2D::getBitsPerPixelForFormat>,
+        l_method<unsigned int (Texture2D::*)(Texture2D::PixelFormat) const, &Texture2D::getBitsPerPixelForFormat>
+    >::call},
+    {"getContentSize", &l_method<Size (Texture2D::*)() const, &Texture2D::getContentSize>::call},
+    {"getContentSizeInPixels", &l_method<const Size& (Texture2D::*)(), &Texture2D::getContentSizeInPixels>::call},
+    {"getDefaultAlphaPixelFormat", &l_method<Texture2D::PixelFormat (*)(), &Texture2D::getDefaultAlphaPixelFormat>::call},
+    {"getDescription", &l_method<std::string (Texture2D::*)() const, &Texture2D::getDescription>::call},
+    {"getMaxS", &l_method<GLfloat (Texture2D::*)() const, &Texture2D::getMaxS>::call},
+    {"getMaxT", &l_method<GLfloat (Texture2D::*)() const, &Texture2D::getMaxT>::call},
+    {"getName", &l_method<GLuint (Texture2D::*)() const, &Texture2D::getName>::call},
+    {"getPixelFormat", &l_method<Texture2D::PixelFormat (Texture2D::*)() const, &Texture2D::getPixelFormat>::call},
+    {"getPixelsHigh", &l_method<int (Texture2D::*)() const, &Texture2D::getPixelsHigh>::call},
+    {"getPixelsWide", &l_method<int (Texture2D::*)() const, &Texture2D::getPixelsWide>::call},
+    {"getStringForFormat", &l_method<const char* (Texture2D::*)() const, &Texture2D::getStringForFormat>::call},
+    {"hasMipmaps", &l_method<bool (Texture2D::*)() const, &Texture2D::hasMipmaps>::call},
+    {"hasPremultipliedAlpha", &l_method<bool (Texture2D::*)() const, &Texture2D::hasPremultipliedAlpha>::call},
+    {"isPixelFormatSupported", &l_method<bool (*)(Texture2D::PixelFormat), &Texture2D::isPixelFormatSupported>::call},
+    {"releaseGLTexture", &l_method<void (Texture2D::*)(), &Texture2D::releaseGLTexture>::call},
+    {"setAliasTexParameters", &l_method<void (Texture2D::*)(), &Texture2D::setAliasTexParameters>::call},
+    {"setAntiAliasTexParameters", &l_method<void (Texture2D::*)(), &Texture2D::setAntiAliasTexParameters>::call},
+    {"setDefaultAlphaPixelFormat", &l_method<void (*)(Texture2D::PixelFormat), &Texture2D::setDefaultAlphaPixelFormat>::call},
+    {"setMaxS", &l_method<void (Texture2D::*)(GLfloat), &Texture2D::setMaxS>::call},
+    {"setMaxT", &l_method<void (Texture2D::*)(GLfloat), &Texture2D::setMaxT>::call},
+    {NULL, NULL}
+};
+
+// TextureCache
+
+static const luaL_Reg l_auto_TextureCache[] = {
+    {"addImage", &l_method<Texture2D* (TextureCache::*)(const std::string&), &TextureCache::addImage>::call},
+    {"cancelAllImageAsync", &l_method<void (TextureCache::*)(), &TextureCache::cancelAllImageAsync>::call},
+    {"cancelImageAsync", &l_method<void (TextureCache::*)(const std::string&), &TextureCache::cancelImageAsync>::call},
+    {"getAsyncThreadCount", &l_method<int (TextureCache::*)() const, &TextureCache::getAsyncThreadCount>::call},
+    {"getAsyncUploadBudget", &l_method<float (TextureCache::*)() const, &TextureCache::getAsyncUploadBudget>::call},
+    {"getCacheHits", &l_method<unsigned int (TextureCache::*)() const, &TextureCache::getCacheHits>::call},
+    {"getCacheMisses", &l_method<unsigned int (TextureCache::*)() const, &TextureCache::getCacheMisses>::call},
+    {"getCachedTextureInfo", &l_method<std::string (TextureCache::*)() const, &TextureCache::getCachedTextureInfo>::call},
+    {"getDescription", &l_method<std::string (TextureCache::*)() const, &TextureCache::getDescription>::call},
+    {"getEvictions", &l_method<unsigned int (TextureCache::*)() const, &TextureCache::getEvictions>::call},
+    {"getMemoryBudget", &l_method<size_t (TextureCache::*)() const, &TextureCache::getMemoryBudget>::call},
+    {"getTextureFilePath", &l_method<std::string (TextureCache::*)(Texture2D*) const, &TextureCache::getTextureFilePath>::call},
+    {"getTextureForKey", &l_method<Texture2D* (TextureCache::*)(const std::string&) const, &TextureCache::getTextureForKey>::call},
+    {"getTotalTextureBytes", &l_method<size_t (TextureCache::*)() const, &TextureCache::getTotalTextureBytes>::call},
+    {"reloadTexture", &l_method<bool (TextureCache::*)(const std::string&), &TextureCache::reloadTexture>::call},
+    {"removeAllTextures", &l_method<void (TextureCache::*)(), &TextureCache::removeAllTextures>::call},
+    {"removeTexture", &l_method<void (TextureCache::*)(Texture2D*), &TextureCache::removeTexture>::call},
+    {"removeTextureForKey", &l_method<void (TextureCache::*)(const std::string&), &TextureCache::removeTextureForKey>::call},
+    {"removeUnusedTextures", &l_method<void (TextureCache::*)(), &TextureCache::removeUnusedTextures>::call},
+    {"setAsyncThreadCount", &l_method<void (TextureCache::*)(int), &TextureCache::setAsyncThreadCount>::call},
+    {"setAsyncUploadBudget", &l_method<void (TextureCache::*)(float), &TextureCache::setAsyncUploadBudget>::call},
+    {"setImageAsyncPriority", &l_method<void (TextureCache::*)(const std::string&, TextureCache::AsyncPriority), &TextureCache::setImageAsyncPriority>::call},
+    {"setMemoryBudget", &l_method<void (TextureCache::*)(size_t), &TextureCache::setMemoryBudget>::call},
+    {"unbindAllImageAsync", &l_method<void (TextureCache::*)(), &TextureCache::unbindAllImageAsync>::call},
+    {"unbindImageAsync", &l_method<void (TextureCache::*)(const std::string&), &TextureCache::unbindImageAsync>::call},
+    {"waitForQuit", &l_method<void (TextureCache::*)(), &TextureCache::waitForQuit>::call},
+    {NULL, NULL}
+};
+
+const l_auto_class l_auto_classes[] = {
+    {"cc.Ref", "Ref", NULL, l_auto_Ref},
+    {"cc.Node", "Node", "cc.Ref", l_auto_Node},
+    {"cc.Scene", "Scene", "cc.Node", l_auto_Scene},
+    {"cc.Layer", "Layer", "cc.Node", l_auto_Layer},
+    {"cc.LayerColor", "LayerColor", "cc.Layer", l_auto_LayerColor},
+    {"cc.Sprite", "Sprite", "cc.Node", l_auto_Sprite},
+    {"cc.Label", "Label", "cc.Node", l_auto_Label},
+    {"cc.Action", "Action", "cc.Ref", l_auto_Action},
+    {"cc.FiniteTimeAction", "FiniteTimeAction", "cc.Action", l_auto_FiniteTimeAction},
+    {"cc.ActionInterval", "ActionInterval", "cc.FiniteTimeAction", l_auto_ActionInterval},
+    {"cc.ActionInstant", "ActionInstant", "cc.FiniteTimeAction", l_auto_ActionInstant},
+    {"cc.Speed", "Speed", "cc.Action", l_auto_Speed},
+    {"cc.Follow", "Follow", "cc.Action", l_auto_Follow},
+    {"cc.RotateTo", "RotateTo", "cc.ActionInterval", l_auto_RotateTo},
+    {"cc.RotateBy", "RotateBy", "cc.ActionInterval", l_auto_RotateBy},
+    {"cc.MoveBy", "MoveBy", "cc.ActionInterval", l_auto_MoveBy},
+    {"cc.MoveTo", "MoveTo", "cc.MoveBy", l_auto_MoveTo},
+    {"cc.SkewTo", "SkewTo", "cc.ActionInterval", l_auto_SkewTo},
+    {"cc.SkewBy", "SkewBy", "cc.SkewTo", l_auto_SkewBy},
+    {"cc.JumpBy", "JumpBy", "cc.ActionInterval", l_auto_JumpBy},
+    {"cc.JumpTo", "JumpTo", "cc.JumpBy", l_auto_JumpTo},
+    {"cc.ScaleTo", "ScaleTo", "cc.ActionInterval", l_auto_ScaleTo},
+    {"cc.ScaleBy", "ScaleBy", "cc.ScaleTo", l_auto_ScaleBy},
+    {"cc.Blink", "Blink", "cc.ActionInterval", l_auto_Blink},
+    {"cc.FadeTo", "FadeTo", "cc.ActionInterval", l_auto_FadeTo},
+    {"cc.FadeIn", "FadeIn", "cc.FadeTo", l_auto_FadeIn},
+    {"cc.FadeOut", "FadeOut", "cc.FadeTo", l_auto_FadeOut},
+    {"cc.TintTo", "TintTo", "cc.ActionInterval", l_auto_TintTo},
+    {"cc.TintBy", "TintBy", "cc.ActionInterval", l_auto_TintBy},
+    {"cc.DelayTime", "DelayTime", "cc.ActionInterval", l_auto_DelayTime},
+    {"cc.Repeat", "Repeat", "cc.ActionInterval", l_auto_Repeat},
+    {"cc.RepeatForever", "RepeatForever", "cc.ActionInterval", l_auto_RepeatForever},
+    {"cc.ReverseTime", "ReverseTime", "cc.ActionInterval", l_auto_ReverseTime},
+    {"cc.Show", "Show", "cc.ActionInstant", l_auto_Show},
+    {"cc.Hide", "Hide", "cc.ActionInstant", l_auto_Hide},
+    {"cc.ToggleVisibility", "ToggleVisibility", "cc.ActionInstant", l_auto_ToggleVisibility},
+    {"cc.RemoveSelf", "RemoveSelf", "cc.ActionInstant", l_auto_RemoveSelf},
+    {"cc.FlipX", "FlipX", "cc.ActionInstant", l_auto_FlipX},
+    {"cc.FlipY", "FlipY", "cc.ActionInstant", l_auto_FlipY},
+    {"cc.Place", "Place", "cc.ActionInstant", l_auto_Place},
+    {"cc.ActionEase", "ActionEase", "cc.ActionInterval", l_auto_ActionEase},
+    {"cc.EaseRateAction", "EaseRateAction", "cc.ActionEase", l_auto_EaseRateAction},
+    {"cc.EaseIn", "EaseIn", "cc.EaseRateAction", l_auto_EaseIn},
+    {"cc.EaseOut", "EaseOut", "cc.EaseRateAction", l_auto_EaseOut},
+    {"cc.EaseInOut", "EaseInOut", "cc.EaseRateAction", l_auto_EaseInOut},
+    {"cc.EaseSineIn", "EaseSineIn", "cc.ActionEase", l_auto_EaseSineIn},
+    {"cc.EaseSineOut", "EaseSineOut", "cc.ActionEase", l_auto_EaseSineOut},
+    {"cc.EaseSineInOut", "EaseSineInOut", "cc.ActionEase", l_auto_EaseSineInOut},
+    {"cc.EaseBackIn", "EaseBackIn", "cc.ActionEase", l_auto_EaseBackIn},
+    {"cc.EaseBackOut", "EaseBackOut", "cc.ActionEase", l_auto_EaseBackOut},
+    {"cc.EaseBackInOut", "EaseBackInOut", "cc.ActionEase", l_auto_EaseBackInOut},
+    {"cc.EaseElasticIn", "EaseElasticIn", NULL, l_auto_EaseElasticIn},
+    {"cc.EaseElasticOut", "EaseElasticOut", NULL, l_auto_EaseElasticOut},
+    {"cc.EaseElasticInOut", "EaseElasticInOut", NULL, l_auto_EaseElasticInOut},
+    {"cc.EaseBounceIn", "EaseBounceIn", NULL, l_auto_EaseBounceIn},
+    {"cc.EaseBounceOut", "EaseBounceOut", NULL, l_auto_EaseBounceOut},
+    {"cc.EaseBounceInOut", "EaseBounceInOut", NULL, l_auto_EaseBounceInOut},
+    {"cc.Director", "Director", "cc.Ref", l_auto_Director},
+    {"cc.Scheduler", "Scheduler", "cc.Ref", l_auto_Scheduler},
+    {"cc.EventListener", "EventListener", "cc.Ref", l_auto_EventListener},
+    {"cc.EventDispatcher", "EventDispatcher", "cc.Ref", l_auto_EventDispatcher},
+    {"cc.FileUtils", "FileUtils", NULL, l_auto_FileUtils},
+    {"cc.Texture2D", "Texture2D", "cc.Ref", l_auto_Texture2D},
+    {"cc.TextureCache", "TextureCache", "cc.Ref", l_auto_TextureCache},
+    {NULL, NULL, NULL, NULL}
+};
@@ -0,0 +1,182 @@
+//
+//  LuabindingFFI.cpp
+//  testslite
+//
+//  Copyright © 2016 cocos2d. All rights reserved.
+//
+
+#include "LuabindingFFI.hpp"
+#include "cocos2d.h"
+
+USING_NS_CC;
+
+// the proxies hold the Ref pointer
+static inline Node *l_ffi_to_node(void *p)
+{
+    return static_cast<Node*>(static_cast<Ref*>(p));
+}
+
+// Node
+
+void ccffi_Node_setPosition(void *node, float x, float y)
+{
+    if (node) {
+        l_ffi_to_node(node)->setPosition(x, y);
+    }
+}
+
+float ccffi_Node_getPositionX(void *node)
+{
+    return node ? l_ffi_to_node(node)->getPositionX() : 0;
+}
+
+float ccffi_Node_getPositionY(void *node)
+{
+    return node ? l_ffi_to_node(node)->getPositionY() : 0;
+}
+
+void ccffi_Node_setOpacity(void *node, int opacity)
+{
+    if (node) {
+        l_ffi_to_node(node)->setOpacity((GLubyte)clampf(opacity, 0, 255));
+    }
+}
+
+int ccffi_Node_getOpacity(void *node)
+{
+    return node ? l_ffi_to_node(node)->getOpacity() : 0;
+}
+
+void ccffi_Node_setColor(void *node, int r, int g, int b)
+{
+    if (node) {
+        l_ffi_to_node(node)->setColor(Color3B((GLubyte)clampf(r, 0, 255), (GLubyte)clampf(g, 0, 255), (GLubyte)clampf(b, 0, 255)));
+    }
+}
+
+void ccffi_Node_setScale(void *node, float scaleX, float scaleY)
+{
+    if (node) {
+        l_ffi_to_node(node)->setScale(scaleX, scaleY);
+    }
+}
+
+float ccffi_Node_getScaleX(void *node)
+{
+    return node ? l_ffi_to_node(node)->getScaleX() : 0;
+}
+
+float ccffi_Node_getScaleY(void *node)
+{
+    return node ? l_ffi_to_node(node)->getScaleY() : 0;
+}
+
+void ccffi_Node_setRotation(void *node, float rotation)
+{
+    if (node) {
+        l_ffi_to_node(node)->setRotation(rotation);
+    }
+}
+
+float ccffi_Node_getRotation(void *node)
+{
+    return node ? l_ffi_to_node(node)->getRotation() : 0;
+}
+
+void ccffi_Node_setVisible(void *node, bool visible)
+{
+    if (node) {
+        l_ffi_to_node(node)->setVisible(visible);
+    }
+}
+
+bool ccffi_Node_isVisible(void *node)
+{
+    return node ? l_ffi_to_node(node)->isVisible() : false;
+}
+
+// Sprite
+
+void ccffi_Sprite_setFlippedX(void *sprite, bool flippedX)
+{
+    if (sprite) {
+        static_cast<Sprite*>(l_ffi_to_node(sprite))->setFlippedX(flippedX);
+    }
+}
+
+void ccffi_Sprite_setFlippedY(void *sprite, bool flippedY)
+{
+    if (sprite) {
+        static_cast<Sprite*>(l_ffi_to_node(sprite))->setFlippedY(flippedY);
+    }
+}
+
+// Nodes
+
+int ccffi_Nodes_stride(int fields)
+{
+    return ((fields & CCFFI_POSITION) ? 2 : 0)
+        + ((fields & CCFFI_OPACITY) ? 1 : 0)
+        + ((fields & CCFFI_COLOR) ? 3 : 0)
+        + ((fields & CCFFI_SCALE) ? 2 : 0)
+        + ((fields & CCFFI_ROTATION) ? 1 : 0);
+}
+
+void ccffi_Nodes_update(void **nodes, const float *values, int count, int fields)
+{
+    const int stride = ccffi_Nodes_stride(fields);
+    for (int i = 0; i < count; ++i, values += stride) {
+        if (nodes[i] == NULL) {
+            continue;
+        }
+        Node *node = l_ffi_to_node(nodes[i]);
+        const float *v = values;
+        if (fields & CCFFI_POSITION) {
+            node->setPosition(v[0], v[1]);
+            v += 2;
+        }
+        if (fields & CCFFI_OPACITY) {
+            node->setOpacity((GLubyte)clampf(v[0], 0, 255));
+            v += 1;
+        }
+        if (fields & CCFFI_COLOR) {
+            node->setColor(Color3B((GLubyte)clampf(v[0], 0, 255), (GLubyte)clampf(v[1], 0, 255), (GLubyte)clampf(v[2], 0, 255)));
+            v += 3;
+        }
+        if (fields & CCFFI_SCALE) {
+            node->setScale(v[0], v[1]);
+            v += 2;
+        }
+        if (fields & CCFFI_ROTATION) {
+            node->setRotation(v[0]);
+        }
+    }
+}
+
+//
+
+static ccffi_api s_ffi_api = {
+    ccffi_Node_setPosition,
+    ccffi_Node_getPositionX,
+    ccffi_Node_getPositionY,
+    ccffi_Node_setOpacity,
+    ccffi_Node_getOpacity,
+    ccffi_Node_setColor,
+    ccffi_Node_setScale,
+    ccffi_Node_getScaleX,
+    ccffi_Node_getScaleY,
+    ccffi_Node_setRotation,
+    ccffi_Node_getRotation,
+    ccffi_Node_setVisible,
+    ccffi_Node_isVisible,
+    ccffi_Sprite_setFlippedX,
+    ccffi_Sprite_setFlippedY,
+    ccffi_Nodes_stride,
+    ccffi_Nodes_update,
+};
+
+int l_push_ffi_api(lua_State *L)
+{
+    lua_pushlightuserdata(L, &s_ffi_api);
+    return 1;
+}
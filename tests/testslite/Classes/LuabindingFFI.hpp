@@ -0,0 +1,74 @@
+//
+//  LuabindingFFI.hpp
+//  testslite
+//
+//  Copyright © 2016 cocos2d. All rights reserved.
+//
+
+#ifndef LuabindingFFI_hpp
+#define LuabindingFFI_hpp
+
+#include <stdbool.h>
+#include "lua.hpp"
+
+// flat entry points for the hot Node and Sprite properties, called from LuaJIT through the FFI,
+// node is the native pointer held by a proxy, they do nothing for NULL
+extern "C" {
+    void ccffi_Node_setPosition(void *node, float x, float y);
+    float ccffi_Node_getPositionX(void *node);
+    float ccffi_Node_getPositionY(void *node);
+    void ccffi_Node_setOpacity(void *node, int opacity);
+    int ccffi_Node_getOpacity(void *node);
+    void ccffi_Node_setColor(void *node, int r, int g, int b);
+    void ccffi_Node_setScale(void *node, float scaleX, float scaleY);
+    float ccffi_Node_getScaleX(void *node);
+    float ccffi_Node_getScaleY(void *node);
+    void ccffi_Node_setRotation(void *node, float rotation);
+    float ccffi_Node_getRotation(void *node);
+    void ccffi_Node_setVisible(void *node, bool visible);
+    bool ccffi_Node_isVisible(void *node);
+    void ccffi_Sprite_setFlippedX(void *sprite, bool flippedX);
+    void ccffi_Sprite_setFlippedY(void *sprite, bool flippedY);
+
+    // the properties ccffi_Nodes_update() sets, each node has its values in this order
+    enum {
+        CCFFI_POSITION = 1 << 0,    // x, y
+        CCFFI_OPACITY = 1 << 1,     // opacity
+        CCFFI_COLOR = 1 << 2,       // r, g, b
+        CCFFI_SCALE = 1 << 3,       // scaleX, scaleY
+        CCFFI_ROTATION = 1 << 4,    // rotation
+    };
+
+    // the number of values per node for fields
+    int ccffi_Nodes_stride(int fields);
+
+    // sets the fields of count nodes in one call, values holds ccffi_Nodes_stride(fields) floats per node
+    void ccffi_Nodes_update(void **nodes, const float *values, int count, int fields);
+
+    // the entry points, as declared by the cdef of Resources/ccffi.lua, keep both in the same order
+    typedef struct ccffi_api {
+        void (*Node_setPosition)(void *node, float x, float y);
+        float (*Node_getPositionX)(void *node);
+        float (*Node_getPositionY)(void *node);
+        void (*Node_setOpacity)(void *node, int opacity);
+        int (*Node_getOpacity)(void *node);
+        void (*Node_setColor)(void *node, int r, int g, int b);
+        void (*Node_setScale)(void *node, float scaleX, float scaleY);
+        float (*Node_getScaleX)(void *node);
+        float (*Node_getScaleY)(void *node);
+        void (*Node_setRotation)(void *node, float rotation);
+        float (*Node_getRotation)(void *node);
+        void (*Node_setVisible)(void *node, bool visible);
+        bool (*Node_isVisible)(void *node);
+        void (*Sprite_setFlippedX)(void *sprite, bool flippedX);
+        void (*Sprite_setFlippedY)(void *sprite, bool flippedY);
+        int (*Nodes_stride)(int fields);
+        void (*Nodes_update)(void **nodes, const float *values, int count, int fields);
+    } ccffi_api;
+
+    // pushes the entry points as a light userdata, ccffi.lua casts it to a ccffi_api pointer,
+    // so the FFI doesn't depend on the symbols exported by the executable
+    int l_push_ffi_api(lua_State *L);
+}
+
+#endif /* LuabindingFFI_hpp */
@@ -0,0 +1,377 @@
+//
+//  LuabindingTemplates.hpp
+//  testslite
+//
+//  Copyright © 2016 cocos2d. All rights reserved.
+//
+
+#ifndef LuabindingTemplates_hpp
+#define LuabindingTemplates_hpp
+
+#include <string>
+#include <type_traits>
+
+#include "cocos2d.h"
+#include "Luabinding.hpp"
+
+// The templates LuabindingAuto.cpp binds the engine with. The argument conversions and the call
+// are resolved at compile time from the signature of each function, only the overloads of a
+// name are told apart at runtime, by argument count then by type.
+
+// l_class<T>::name(), the registry name of a bound class, specialized by LuabindingAuto.cpp
+
+template<typename T>
+struct l_class
+{
+    static const char *name();
+};
+
+// l_value<T>, check(), get() and push() of an argument or return type
+
+template<typename T, typename Enable = void>
+struct l_value;
+
+template<typename T>
+struct l_value<T, typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, bool>::value>::type>
+{
+    static bool check(lua_State *L, int idx) { return lua_isnumber(L, idx) != 0; }
+    static T get(lua_State *L, int idx) { return static_cast<T>(lua_tonumber(L, idx)); }
+    static void push(lua_State *L, T value) { lua_pushnumber(L, static_cast<lua_Number>(value)); }
+};
+
+template<typename T>
+struct l_value<T, typename std::enable_if<std::is_enum<T>::value>::type>
+{
+    static bool check(lua_State *L, int idx) { return lua_isnumber(L, idx) != 0; }
+    static T get(lua_State *L, int idx) { return static_cast<T>(lua_tointeger(L, idx)); }
+    static void push(lua_State *L, T value) { lua_pushinteger(L, static_cast<lua_Integer>(value)); }
+};
+
+template<>
+struct l_value<bool>
+{
+    static bool check(lua_State *L, int idx) { return lua_isboolean(L, idx) || lua_isnil(L, idx); }
+    static bool get(lua_State *L, int idx) { return lua_toboolean(L, idx) != 0; }
+    static void push(lua_State *L, bool value) { lua_pushboolean(L, value); }
+};
+
+template<>
+struct l_value<std::string>
+{
+    static bool check(lua_State *L, int idx) { return lua_type(L, idx) == LUA_TSTRING; }
+    static std::string get(lua_State *L, int idx)
+    {
+        size_t len = 0;
+        const char *s = lua_tolstring(L, idx, &len);
+        return s ? std::string(s, len) : std::string();
+    }
+    static void push(lua_State *L, const std::string& value) { lua_pushlstring(L, value.c_str(), value.size()); }
+};
+
+template<>
+struct l_value<const char*>
+{
+    static bool check(lua_State *L, int idx) { return lua_type(L, idx) == LUA_TSTRING; }
+    static const char *get(lua_State *L, int idx) { return lua_tostring(L, idx); }
+    static void push(lua_State *L, const char *value) { lua_pushstring(L, value); }
+};
+
+// the objects are the proxies of l_push_ref(), nil is nullptr
+template<typename T>
+struct l_value<T*, typename std::enable_if<std::is_base_of<cocos2d::Ref, typename std::remove_const<T>::type>::value>::type>
+{
+    typedef typename std::remove_const<T>::type Type;
+    static bool check(lua_State *L, int idx) { return lua_isuserdata(L, idx) || lua_isnil(L, idx); }
+    static T *get(lua_State *L, int idx) { return static_cast<Type*>(static_cast<cocos2d::Ref*>(l_to_userdata(L, idx))); }
+    static void push(lua_State *L, T *value) { l_push_ref(L, const_cast<Type*>(value), l_class<Type>::name()); }
+};
+
+// the other bound classes, such as FileUtils, get a userdata per push
+template<typename T>
+struct l_value<T*, typename std::enable_if<std::is_class<T>::value && !std::is_base_of<cocos2d::Ref, typename std::remove_const<T>::type>::value>::type>
+{
+    typedef typename std::remove_const<T>::type Type;
+    static bool check(lua_State *L, int idx) { return lua_isuserdata(L, idx) || lua_isnil(L, idx); }
+    static T *get(lua_State *L, int idx) { return static_cast<Type*>(l_to_userdata(L, idx)); }
+    static void push(lua_State *L, T *value)
+    {
+        if (value) {
+            l_push_userdata(L, const_cast<Type*>(value), l_class<Type>::name());
+        } else {
+            lua_pushnil(L);
+        }
+    }
+};
+
+// the value types are read as in Luabinding.cpp, and returned as tables
+
+template<>
+struct l_value<cocos2d::Vec2>
+{
+    static bool check(lua_State *L, int idx) { return lua_istable(L, idx) || lua_isuserdata(L, idx); }
+    static cocos2d::Vec2 get(lua_State *L, int idx) { cocos2d::Vec2 v; l_to_vec2(L, idx, &v); return v; }
+    static void push(lua_State *L, const cocos2d::Vec2& v)
+    {
+        lua_createtable(L, 0, 2);
+        lua_pushnumber(L, v.x);
+        lua_setfield(L, -2, "x");
+        lua_pushnumber(L, v.y);
+        lua_setfield(L, -2, "y");
+    }
+};
+
+template<>
+struct l_value<cocos2d::Size>
+{
+    static bool check(lua_State *L, int idx) { return lua_istable(L, idx) || lua_isuserdata(L, idx); }
+    static cocos2d::Size get(lua_State *L, int idx) { cocos2d::Size s; l_to_size(L, idx, &s); return s; }
+    static void push(lua_State *L, const cocos2d::Size& s)
+    {
+        lua_createtable(L, 0, 2);
+        lua_pushnumber(L, s.width);
+        lua_setfield(L, -2, "width");
+        lua_pushnumber(L, s.height);
+        lua_setfield(L, -2, "height");
+    }
+};
+
+template<>
+struct l_value<cocos2d::Rect>
+{
+    static bool check(lua_State *L, int idx) { return lua_istable(L, idx); }
+    static cocos2d::Rect get(lua_State *L, int idx)
+    {
+        cocos2d::Vec2 origin;
+        cocos2d::Size size;
+        l_to_vec2(L, idx, &origin);
+        lua_getfield(L, idx, "width");
+        size.width = lua_tonumber(L, -1);
+        lua_getfield(L, idx, "height");
+        size.height = lua_tonumber(L, -1);
+        lua_pop(L, 2);
+        return cocos2d::Rect(origin, size);
+    }
+    static void push(lua_State *L, const cocos2d::Rect& r)
+    {
+        lua_createtable(L, 0, 4);
+        lua_pushnumber(L, r.origin.x);
+        lua_setfield(L, -2, "x");
+        lua_pushnumber(L, r.origin.y);
+        lua_setfield(L, -2, "y");
+        lua_pushnumber(L, r.size.width);
+        lua_setfield(L, -2, "width");
+        lua_pushnumber(L, r.size.height);
+        lua_setfield(L, -2, "height");
+    }
+};
+
+template<>
+struct l_value<cocos2d::Color3B>
+{
+    static bool check(lua_State *L, int idx) { return lua_istable(L, idx) || lua_isuserdata(L, idx); }
+    static cocos2d::Color3B get(lua_State *L, int idx) { cocos2d::Color3B c; l_to_color3b(L, idx, &c); return c; }
+    static void push(lua_State *L, const cocos2d::Color3B& c)
+    {
+        lua_createtable(L, 0, 3);
+        lua_pushinteger(L, c.r);
+        lua_setfield(L, -2, "r");
+        lua_pushinteger(L, c.g);
+        lua_setfield(L, -2, "g");
+        lua_pushinteger(L, c.b);
+        lua_setfield(L, -2, "b");
+    }
+};
+
+template<>
+struct l_value<cocos2d::Color4B>
+{
+    static bool check(lua_State *L, int idx) { return lua_istable(L, idx) || lua_isuserdata(L, idx); }
+    static cocos2d::Color4B get(lua_State *L, int idx) { cocos2d::Color4B c; l_to_color4b(L, idx, &c); return c; }
+    static void push(lua_State *L, const cocos2d::Color4B& c)
+    {
+        lua_createtable(L, 0, 4);
+        lua_pushinteger(L, c.r);
+        lua_setfield(L, -2, "r");
+        lua_pushinteger(L, c.g);
+        lua_setfield(L, -2, "g");
+        lua_pushinteger(L, c.b);
+        lua_setfield(L, -2, "b");
+        lua_pushinteger(L, c.a);
+        lua_setfield(L, -2, "a");
+    }
+};
+
+// argument lists
+
+template<int...>
+struct l_indices {};
+
+template<int N, int... I>
+struct l_make_indices : l_make_indices<N - 1, N - 1, I...> {};
+
+template<int... I>
+struct l_make_indices<0, I...>
+{
+    typedef l_indices<I...> type;
+};
+
+template<typename T>
+struct l_arg
+{
+    typedef l_value<typename std::decay<T>::type> value;
+};
+
+template<typename... A>
+struct l_args
+{
+    static bool check(lua_State *L, int first) { return check(L, first, typename l_make_indices<sizeof...(A)>::type()); }
+
+    template<int... I>
+    static bool check(lua_State *L, int first, l_indices<I...>)
+    {
+        const bool checks[] = { true, l_arg<A>::value::check(L, first + I)... };
+        for (bool ok : checks) {
+            if (!ok) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// the call and the push of the result, nothing is pushed for void
+
+template<typename R>
+struct l_return
+{
+    template<typename C, typename F, typename... V>
+    static int member(lua_State *L, C *self, F f, V&&... v)
+    {
+        l_arg<R>::value::push(L, (self->*f)(std::forward<V>(v)...));
+        return 1;
+    }
+
+    template<typename F, typename... V>
+    static int function(lua_State *L, F f, V&&... v)
+    {
+        l_arg<R>::value::push(L, (*f)(std::forward<V>(v)...));
+        return 1;
+    }
+};
+
+template<>
+struct l_return<void>
+{
+    template<typename C, typename F, typename... V>
+    static int member(lua_State *L, C *self, F f, V&&... v)
+    {
+        (self->*f)(std::forward<V>(v)...);
+        return 0;
+    }
+
+    template<typename F, typename... V>
+    static int function(lua_State *L, F f, V&&... v)
+    {
+        (*f)(std::forward<V>(v)...);
+        return 0;
+    }
+};
+
+// l_method<F, f>::call, a lua_CFunction calling f, self is the first argument
+
+template<typename F, F f>
+struct l_method;
+
+template<typename R, typename C, typename... A, R (C::*f)(A...)>
+struct l_method<R (C::*)(A...), f>
+{
+    static const int arity = sizeof...(A) + 1;
+
+    static bool check(lua_State *L) { return l_value<C*>::get(L, 1) != nullptr && l_args<A...>::check(L, 2); }
+
+    static int call(lua_State *L) { return call(L, typename l_make_indices<sizeof...(A)>::type()); }
+
+    template<int... I>
+    static int call(lua_State *L, l_indices<I...>)
+    {
+        C *self = l_value<C*>::get(L, 1);
+        if (self == nullptr) {
+            return luaL_error(L, "invalid 'self' for %s", l_class<C>::name());
+        }
+        return l_return<R>::member(L, self, f, l_arg<A>::value::get(L, I + 2)...);
+    }
+};
+
+template<typename R, typename C, typename... A, R (C::*f)(A...) const>
+struct l_method<R (C::*)(A...) const, f>
+{
+    static const int arity = sizeof...(A) + 1;
+
+    static bool check(lua_State *L) { return l_value<C*>::get(L, 1) != nullptr && l_args<A...>::check(L, 2); }
+
+    static int call(lua_State *L) { return call(L, typename l_make_indices<sizeof...(A)>::type()); }
+
+    template<int... I>
+    static int call(lua_State *L, l_indices<I...>)
+    {
+        const C *self = l_value<C*>::get(L, 1);
+        if (self == nullptr) {
+            return luaL_error(L, "invalid 'self' for %s", l_class<C>::name());
+        }
+        return l_return<R>::member(L, self, f, l_arg<A>::value::get(L, I + 2)...);
+    }
+};
+
+template<typename R, typename... A, R (*f)(A...)>
+struct l_method<R (*)(A...), f>
+{
+    static const int arity = sizeof...(A);
+
+    static bool check(lua_State *L) { return l_args<A...>::check(L, 1); }
+
+    static int call(lua_State *L) { return call(L, typename l_make_indices<sizeof...(A)>::type()); }
+
+    template<int... I>
+    static int call(lua_State *L, l_indices<I...>)
+    {
+        return l_return<R>::function(L, f, l_arg<A>::value::get(L, I + 1)...);
+    }
+};
+
+// l_overload<M...>::call, the first method whose arity and argument types match is called
+
+template<typename... M>
+struct l_overload;
+
+template<>
+struct l_overload<>
+{
+    static int call(lua_State *L, int top) { return luaL_error(L, "no overload takes these %d arguments", top); }
+};
+
+template<typename M, typename... Rest>
+struct l_overload<M, Rest...>
+{
+    static int call(lua_State *L) { return call(L, lua_gettop(L)); }
+
+    static int call(lua_State *L, int top)
+    {
+        if (top == M::arity && M::check(L)) {
+            return M::call(L);
+        }
+        return l_overload<Rest...>::call(L, top);
+    }
+};
+
+// the generated classes, registered by l_register_auto_classes()
+struct l_auto_class
+{
+    const char *name;           // "cc.Node"
+    const char *field;          // "Node", in the cc namespace
+    const char *base;           // "cc.Ref", NULL for none
+    const luaL_Reg *methods;
+};
+
+extern const l_auto_class l_auto_classes[];
+
+#endif /* LuabindingTemplates_hpp */
@@ -0,0 +1,478 @@
+
+#include "MicroBenchmarks.h"
+#include "cocos2d.h"
+#include "base/base64.h"
+#include "base/ZipUtils.h"
+#include "platform/CCSAXParser.h"
+#include "renderer/CCRenderer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <random>
+
+#include "zlib.h"
+
+// the kernels of MathUtil.cpp, the same ones it includes for the architecture
+#include "math/MathUtil.inl"
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_IOS) || (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+    #if defined (__arm64__) || defined (__aarch64__)
+    #define MICRO_BENCHMARK_NEON64
+    #include "math/MathUtilNeon64.inl"
+    #elif defined (__ARM_NEON__)
+    #define MICRO_BENCHMARK_NEON32
+    #include "math/MathUtilNeon.inl"
+    #endif
+#endif
+
+USING_NS_CC;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// keeps the compiler from dropping the work whose result isn't used
+#if defined(__GNUC__) || defined(__clang__)
+inline void consume(const void *p) { __asm__ __volatile__("" : : "g"(p) : "memory"); }
+#else
+const void * volatile s_sink;
+inline void consume(const void *p) { s_sink = p; }
+#endif
+
+struct MicroBenchmark
+{
+    std::string name;
+    // runs the kernel `iterations` times
+    std::function<void(long long iterations)> run;
+};
+
+double measure(const std::function<void(long long)>& run, long long iterations)
+{
+    auto start = Clock::now();
+    run(iterations);
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+MicroBenchmarks::Result runBenchmark(const MicroBenchmark& benchmark)
+{
+    const double minSample = 5e6;
+    const int samples = 11;
+
+    // doubles the iterations until a sample is long enough to time
+    long long iterations = 1;
+    while (measure(benchmark.run, iterations) < minSample && iterations < (1LL << 40)) {
+        iterations *= 2;
+    }
+
+    std::vector<double> times;
+    for (int i = 0; i < samples; ++i) {
+        times.push_back(measure(benchmark.run, iterations) / iterations);
+    }
+    std::sort(times.begin(), times.end());
+
+    MicroBenchmarks::Result result;
+    result.name = benchmark.name;
+    result.iterations = iterations;
+    result.nsPerOp = times[samples / 2];
+    result.minNsPerOp = times[0];
+    return result;
+}
+
+Mat4 randomMat4(std::mt19937& generator)
+{
+    std::uniform_real_distribution<float> value(-2, 2);
+    Mat4 m;
+    for (int i = 0; i < 16; ++i) {
+        m.m[i] = value(generator);
+    }
+    return m;
+}
+
+// the matrix kernels of one implementation, MathUtilC or a NEON one
+template <typename Impl>
+void addMathVariant(std::vector<MicroBenchmark>& benchmarks, const std::string& variant)
+{
+    auto matrices = std::make_shared<std::vector<Mat4>>();
+    auto vertices = std::make_shared<std::vector<V3F_C4B_T2F>>(1024);
+    std::mt19937 generator(1);
+    for (int i = 0; i < 64; ++i) {
+        matrices->push_back(randomMat4(generator));
+    }
+
+    benchmarks.push_back({"mat4.multiply/" + variant, [matrices](long long iterations) {
+        Mat4 dst;
+        const auto& m = *matrices;
+        for (long long i = 0; i < iterations; ++i) {
+            Impl::multiplyMatrix(m[i & 63].m, m[(i + 1) & 63].m, dst.m);
+            consume(&dst);
+        }
+    }});
+    benchmarks.push_back({"mat4.transformVec4/" + variant, [matrices](long long iterations) {
+        float v[4] = {1, 2, 3, 1};
+        float dst[4];
+        const auto& m = *matrices;
+        for (long long i = 0; i < iterations; ++i) {
+            Impl::transformVec4(m[i & 63].m, v, dst);
+            consume(dst);
+        }
+    }});
+    benchmarks.push_back({"mat4.transformVertices1024/" + variant, [matrices, vertices](long long iterations) {
+        std::vector<V3F_C4B_T2F> dst(vertices->size());
+        const auto& m = *matrices;
+        for (long long i = 0; i < iterations; ++i) {
+            Impl::transformVertices(m[i & 63].m, (const float*)vertices->data(), (float*)dst.data(), (int)dst.size());
+            consume(dst.data());
+        }
+    }});
+}
+
+void addMathBenchmarks(std::vector<MicroBenchmark>& benchmarks)
+{
+    addMathVariant<MathUtilC>(benchmarks, "c");
+#if defined(MICRO_BENCHMARK_NEON64)
+    addMathVariant<MathUtilNeon64>(benchmarks, "neon64");
+#elif defined(MICRO_BENCHMARK_NEON32)
+    if (MathUtil::isNeon32Enabled()) {
+        addMathVariant<MathUtilNeon>(benchmarks, "neon");
+    }
+#endif
+
+    auto matrices = std::make_shared<std::vector<Mat4>>();
+    auto vertices = std::make_shared<std::vector<V3F_C4B_T2F>>(1024);
+    std::mt19937 generator(1);
+    for (int i = 0; i < 64; ++i) {
+        matrices->push_back(randomMat4(generator));
+    }
+
+    benchmarks.push_back({"mat4.multiply/engine", [matrices](long long iterations) {
+        Mat4 dst;
+        const auto& m = *matrices;
+        for (long long i = 0; i < iterations; ++i) {
+            Mat4::multiply(m[i & 63], m[(i + 1) & 63], &dst);
+            consume(&dst);
+        }
+    }});
+    benchmarks.push_back({"mat4.transformVec4/engine", [matrices](long long iterations) {
+        Vec4 v(1, 2, 3, 1), dst;
+        const auto& m = *matrices;
+        for (long long i = 0; i < iterations; ++i) {
+            m[i & 63].transformVector(v, &dst);
+            consume(&dst);
+        }
+    }});
+    benchmarks.push_back({"mat4.transformVertices1024/engine", [matrices, vertices](long long iterations) {
+        std::vector<V3F_C4B_T2F> dst(vertices->size());
+        const auto& m = *matrices;
+        for (long long i = 0; i < iterations; ++i) {
+            m[i & 63].transformVertices((const float*)vertices->data(), (float*)dst.data(), (int)dst.size());
+            consume(dst.data());
+        }
+    }});
+    benchmarks.push_back({"mat4.transformVerticesAffine2D1024/engine", [vertices](long long iterations) {
+        std::vector<V3F_C4B_T2F> dst(vertices->size());
+        Mat4 m;
+        Mat4::createRotationZ(0.3f, &m);
+        m.scale(1.5f);
+        m.translate(10, 20, 0);
+        for (long long i = 0; i < iterations; ++i) {
+            m.transformVerticesAffine2D((const float*)vertices->data(), (float*)dst.data(), (int)dst.size());
+            consume(dst.data());
+        }
+    }});
+    benchmarks.push_back({"mat4.inverse/engine", [matrices](long long iterations) {
+        const auto& m = *matrices;
+        for (long long i = 0; i < iterations; ++i) {
+            Mat4 inverse = m[i & 63].getInversed();
+            consume(&inverse);
+        }
+    }});
+
+    auto points = std::make_shared<std::vector<Vec2>>();
+    std::uniform_real_distribution<float> value(-100, 100);
+    for (int i = 0; i < 1024; ++i) {
+        points->push_back(Vec2(value(generator), value(generator)));
+    }
+    benchmarks.push_back({"vec2.arithmetic1024", [points](long long iterations) {
+        const auto& p = *points;
+        for (long long i = 0; i < iterations; ++i) {
+            Vec2 sum;
+            for (size_t j = 1; j < p.size(); ++j) {
+                sum += (p[j] - p[j - 1]) * 0.5f + p[j].lerp(p[j - 1], 0.25f);
+            }
+            consume(&sum);
+        }
+    }});
+    benchmarks.push_back({"vec2.normalizeRotate1024", [points](long long iterations) {
+        const auto& p = *points;
+        for (long long i = 0; i < iterations; ++i) {
+            float total = 0;
+            for (size_t j = 1; j < p.size(); ++j) {
+                Vec2 v = p[j].getNormalized().rotateByAngle(Vec2::ZERO, 0.5f);
+                total += v.getAngle(p[j - 1]) + p[j].distance(p[j - 1]);
+            }
+            consume(&total);
+        }
+    }});
+}
+
+void addRendererBenchmarks(std::vector<MicroBenchmark>& benchmarks)
+{
+    // 1000 sprites of an atlas, the quads are owned by the lambdas
+    const int count = 1000;
+    auto quads = std::make_shared<std::vector<V3F_C4B_T2F_Quad>>(count);
+    auto commands = std::make_shared<std::vector<QuadCommand>>(count);
+    auto state = GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP);
+    std::mt19937 generator(2);
+    std::uniform_real_distribution<float> position(0, 960), order(-10, 10);
+    std::uniform_int_distribution<int> texture(1, 4);
+    for (int i = 0; i < count; ++i) {
+        auto& quad = (*quads)[i];
+        quad.bl.vertices.set(0, 0, 0);
+        quad.br.vertices.set(32, 0, 0);
+        quad.tl.vertices.set(0, 32, 0);
+        quad.tr.vertices.set(32, 32, 0);
+        Mat4 mv;
+        Mat4::createTranslation(position(generator), position(generator), 0, &mv);
+        float z = (i % 3 == 0) ? 0 : order(generator);
+        (*commands)[i].init(z, texture(generator), state, BlendFunc::ALPHA_PREMULTIPLIED, &quad, 1, mv, 0);
+    }
+
+    // the body of Renderer::fillQuads, which is protected and writes into the live batch buffers
+    benchmarks.push_back({"renderer.fillQuads1000", [commands](long long iterations) {
+        std::vector<V3F_C4B_T2F> dst(commands->size() * 4);
+        for (long long i = 0; i < iterations; ++i) {
+            V3F_C4B_T2F *out = dst.data();
+            for (const auto& cmd : *commands) {
+                const Mat4& modelView = cmd.getModelView();
+                const V3F_C4B_T2F *src = (const V3F_C4B_T2F*)cmd.getQuads();
+                if (TransformIsAffine2D(modelView))
+                    modelView.transformVerticesAffine2D((const float*)src, (float*)out, (int)cmd.getQuadCount() * 4);
+                else
+                    modelView.transformVertices((const float*)src, (float*)out, (int)cmd.getQuadCount() * 4);
+                out += cmd.getQuadCount() * 4;
+            }
+            consume(dst.data());
+        }
+    }});
+
+    auto queued = std::make_shared<std::vector<RenderCommand*>>();
+    for (auto& cmd : *commands) {
+        queued->push_back(&cmd);
+    }
+    std::shuffle(queued->begin(), queued->end(), generator);
+    auto sortQueue = [queued](long long iterations, bool reorder) {
+        RenderQueue queue;
+        for (long long i = 0; i < iterations; ++i) {
+            queue.clear();
+            for (auto cmd : *queued) {
+                queue.push_back(cmd);
+            }
+            queue.setReorderEnabled(reorder);
+            queue.sort();
+            consume(&queue);
+        }
+    };
+    benchmarks.push_back({"renderqueue.sort1000", [sortQueue](long long iterations) {
+        sortQueue(iterations, false);
+    }});
+    benchmarks.push_back({"renderqueue.sort1000/reorder", [sortQueue](long long iterations) {
+        sortQueue(iterations, true);
+    }});
+}
+
+class NullSAXDelegator : public SAXDelegator
+{
+public:
+    NullSAXDelegator() : elements(0) {}
+    virtual void startElement(void *ctx, const char *name, const char **atts) override { ++elements; }
+    virtual void endElement(void *ctx, const char *name) override {}
+    virtual void textHandler(void *ctx, const char *s, int len) override {}
+    int elements;
+};
+
+void addParserBenchmarks(std::vector<MicroBenchmark>& benchmarks)
+{
+    // a plist of a sprite sheet, the common XML of a game
+    auto xml = std::make_shared<std::string>(
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<plist version=\"1.0\">\n<dict>\n<key>frames</key>\n<dict>\n");
+    for (int i = 0; i < 500; ++i) {
+        *xml += StringUtils::format(
+            "<key>frame_%d.png</key>\n<dict>\n<key>frame</key>\n<string>{{%d,%d},{32,32}}</string>\n"
+            "<key>offset</key>\n<string>{0,0}</string>\n<key>rotated</key>\n<false/>\n"
+            "<key>sourceSize</key>\n<string>{32,32}</string>\n</dict>\n", i, (i % 32) * 32, (i / 32) * 32);
+    }
+    *xml += "</dict>\n</dict>\n</plist>\n";
+
+    benchmarks.push_back({"saxparser.parse", [xml](long long iterations) {
+        for (long long i = 0; i < iterations; ++i) {
+            NullSAXDelegator delegator;
+            SAXParser parser;
+            parser.init("UTF-8");
+            parser.setDelegator(&delegator);
+            parser.parse(xml->c_str(), xml->size());
+            consume(&delegator);
+        }
+    }});
+    benchmarks.push_back({"saxparser.parseInSitu", [xml](long long iterations) {
+        std::vector<char> buffer(xml->size());
+        for (long long i = 0; i < iterations; ++i) {
+            std::copy(xml->begin(), xml->end(), buffer.begin());
+            NullSAXDelegator delegator;
+            SAXParser parser;
+            parser.init("UTF-8");
+            parser.setDelegator(&delegator);
+            parser.parseInSitu(buffer.data(), buffer.size());
+            consume(&delegator);
+        }
+    }});
+
+    // the same data compressed and encoded, like the layers of a TMX map
+    auto compressed = std::make_shared<std::vector<unsigned char>>(compressBound((uLong)xml->size()));
+    uLongf compressedLength = (uLongf)compressed->size();
+    compress2(compressed->data(), &compressedLength, (const Bytef*)xml->data(), (uLong)xml->size(), Z_DEFAULT_COMPRESSION);
+    compressed->resize(compressedLength);
+    benchmarks.push_back({"zip.inflateMemory", [compressed](long long iterations) {
+        for (long long i = 0; i < iterations; ++i) {
+            unsigned char *out = nullptr;
+            ZipUtils::inflateMemory(compressed->data(), compressed->size(), &out);
+            consume(out);
+            free(out);
+        }
+    }});
+
+    auto encoded = std::make_shared<std::string>();
+    char *buffer = nullptr;
+    base64Encode((const unsigned char*)xml->data(), (unsigned int)xml->size(), &buffer);
+    if (buffer) {
+        *encoded = buffer;
+        free(buffer);
+    }
+    benchmarks.push_back({"base64.decode", [encoded](long long iterations) {
+        for (long long i = 0; i < iterations; ++i) {
+            unsigned char *out = nullptr;
+            base64Decode((const unsigned char*)encoded->data(), (unsigned int)encoded->size(), &out);
+            consume(out);
+            free(out);
+        }
+    }});
+}
+
+void addBaseBenchmarks(std::vector<MicroBenchmark>& benchmarks)
+{
+    auto fileUtils = FileUtils::getInstance();
+    benchmarks.push_back({"fileutils.fullPathForFilename/hit", [fileUtils](long long iterations) {
+        static const std::string names[] = {"star.png", "HelloWorld.png", "main.lua", "ccffi.lua"};
+        for (long long i = 0; i < iterations; ++i) {
+            std::string path = fileUtils->fullPathForFilename(names[i & 3]);
+            consume(&path);
+        }
+    }});
+    benchmarks.push_back({"fileutils.fullPathForFilename/miss", [fileUtils](long long iterations) {
+        static const std::string names[] = {"missing0.png", "missing1.png", "missing2.png", "missing3.png"};
+        bool notify = fileUtils->isPopupNotify();
+        fileUtils->setPopupNotify(false);
+        for (long long i = 0; i < iterations; ++i) {
+            std::string path = fileUtils->fullPathForFilename(names[i & 3]);
+            consume(&path);
+        }
+        fileUtils->setPopupNotify(notify);
+    }});
+
+    // latin text with a few CJK characters, like a localized dialog
+    auto utf8 = std::make_shared<std::string>();
+    for (int i = 0; i < 64; ++i) {
+        *utf8 += "The quick brown fox jumps over the lazy dog. \xe4\xbd\xa0\xe5\xa5\xbd ";
+    }
+    auto utf16 = std::make_shared<std::u16string>();
+    StringUtils::UTF8ToUTF16(*utf8, *utf16);
+    benchmarks.push_back({"stringutils.UTF8ToUTF16", [utf8](long long iterations) {
+        std::u16string out;
+        for (long long i = 0; i < iterations; ++i) {
+            StringUtils::UTF8ToUTF16(*utf8, out);
+            consume(out.data());
+        }
+    }});
+    benchmarks.push_back({"stringutils.UTF16ToUTF8", [utf16](long long iterations) {
+        std::string out;
+        for (long long i = 0; i < iterations; ++i) {
+            StringUtils::UTF16ToUTF8(*utf16, out);
+            consume(out.data());
+        }
+    }});
+
+    benchmarks.push_back({"value.construct", [](long long iterations) {
+        for (long long i = 0; i < iterations; ++i) {
+            Value values[] = {Value((int)i), Value(0.5f * i), Value(true), Value("name"), Value(std::string("a longer string value"))};
+            consume(values);
+        }
+    }});
+    benchmarks.push_back({"value.valueMap16", [](long long iterations) {
+        static const std::string keys[] = {"x", "y", "width", "height", "name", "type", "visible", "rotation",
+                                           "gid", "opacity", "id", "points", "scale", "anchor", "color", "tag"};
+        for (long long i = 0; i < iterations; ++i) {
+            ValueMap map;
+            for (int k = 0; k < 16; ++k) {
+                map[keys[k]] = Value(k);
+            }
+            Value value(std::move(map));
+            consume(&value);
+        }
+    }});
+}
+
+} // namespace
+
+const char* MicroBenchmarks::getSIMDPath()
+{
+#ifdef __SSE__
+    return "sse";
+#else
+    if (MathUtil::isNeon64Enabled()) {
+        return "neon64";
+    }
+    if (MathUtil::isNeon32Enabled()) {
+        return "neon32";
+    }
+    return "c";
+#endif
+}
+
+std::vector<MicroBenchmarks::Result> MicroBenchmarks::run(const std::vector<std::string>& prefixes)
+{
+    std::vector<MicroBenchmark> benchmarks;
+    addMathBenchmarks(benchmarks);
+    addRendererBenchmarks(benchmarks);
+    addParserBenchmarks(benchmarks);
+    addBaseBenchmarks(benchmarks);
+
+    std::vector<Result> results;
+    for (const auto& benchmark : benchmarks) {
+        bool selected = prefixes.empty();
+        for (const auto& prefix : prefixes) {
+            selected = selected || benchmark.name.compare(0, prefix.size(), prefix) == 0;
+        }
+        if (!selected) {
+            continue;
+        }
+        results.push_back(runBenchmark(benchmark));
+        CCLOG("MicroBenchmarks: %-40s %12.1f ns/op", benchmark.name.c_str(), results.back().nsPerOp);
+    }
+    return results;
+}
+
+std::string MicroBenchmarks::toJSON(const std::vector<Result>& results)
+{
+    std::string json = "{\n";
+    json += StringUtils::format("  \"engine\": \"%s\",\n", cocos2dVersion());
+    json += StringUtils::format("  \"simd\": \"%s\",\n", getSIMDPath());
+    json += "  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result &result = results[i];
+        json += i == 0 ? "\n" : ",\n";
+        json += StringUtils::format("    {\"name\": \"%s\", \"iterations\": %lld, \"nsPerOp\": %.2f, \"minNsPerOp\": %.2f}",
+                                    result.name.c_str(), result.iterations, result.nsPerOp, result.minNsPerOp);
+    }
+    json += "\n  ]\n}\n";
+    return json;
+}
@@ -0,0 +1,39 @@
+#ifndef __MICRO_BENCHMARKS_H__
+#define __MICRO_BENCHMARKS_H__
+
+#include <string>
+#include <vector>
+
+/**
+ Times engine kernels in isolation, away from the scenes of BenchmarkRunner: Mat4 and Vec2 math, the vertex
+ transform of Renderer::fillQuads, RenderQueue::sort, SAXParser, FileUtils::fullPathForFilename,
+ ZipUtils::inflateMemory, base64Decode, the StringUtils UTF conversions and Value construction.
+
+ The math kernels have a variant per implementation compiled for the architecture: "c" for MathUtilC,
+ "neon"/"neon64" for the NEON ones on ARM, and "engine" for the public Mat4 API, which goes through the SSE
+ or NEON path the engine was built with, see getSIMDPath().
+
+ Each benchmark is calibrated to run for at least 5 ms per sample, the median and the best of 11 samples are kept.
+ It runs on the GL thread, after the Director is set up: some kernels need a GLProgramState.
+ */
+class MicroBenchmarks
+{
+public:
+    struct Result
+    {
+        std::string name;
+        long long iterations;
+        double nsPerOp;
+        double minNsPerOp;
+    };
+
+    /** The vector path of the engine math: "sse", "neon32", "neon64" or "c". */
+    static const char* getSIMDPath();
+
+    /** Runs the benchmarks whose name starts with one of `prefixes`, all of them when it's empty. */
+    static std::vector<Result> run(const std::vector<std::string>& prefixes);
+
+    static std::string toJSON(const std::vector<Result>& results);
+};
+
+#endif // __MICRO_BENCHMARKS_H__
@@ -2,6 +2,7 @@
 #include "WelcomeScene.h"
 #include "BenchmarkCppScene.h"
 #include "BenchmarkLuaScene.h"
+#include "BenchmarkRunner.h"
 
 USING_NS_CC;
 
@@ -28,6 +29,14 @@ bool Welcome::init()
         Director::getInstance()->replaceScene(BenchmarkLua::createScene());
     }));
 
+    menu->addChild(MenuItemLabel::create(Label::createWithSystemFont("Benchmark Suite", "sans", 32), [](Ref*) {
+        BenchmarkRunner::getInstance()->start();
+    }));
+
+    menu->addChild(MenuItemLabel::create(Label::createWithSystemFont("Micro Benchmarks", "sans", 32), [](Ref*) {
+        BenchmarkRunner::getInstance()->runMicroBenchmarks();
+    }));
+
     auto size = Director::getInstance()->getOpenGLView()->getFrameSize();
     menu->setPosition(Vec2(size.width / 2, size.height / 2));
     menu->alignItemsVertically();
@@ -0,0 +1,145 @@
+
+-- LuaJIT FFI calls of the hot Node and Sprite properties, traces compile through them
+-- unlike the lua_CFunction bindings, see Classes/LuabindingFFI.hpp
+
+local ffi = require("ffi")
+
+-- keep in the order of ccffi_api in LuabindingFFI.hpp
+ffi.cdef[[
+typedef struct ccffi_api {
+    void (*Node_setPosition)(void *node, float x, float y);
+    float (*Node_getPositionX)(void *node);
+    float (*Node_getPositionY)(void *node);
+    void (*Node_setOpacity)(void *node, int opacity);
+    int (*Node_getOpacity)(void *node);
+    void (*Node_setColor)(void *node, int r, int g, int b);
+    void (*Node_setScale)(void *node, float scaleX, float scaleY);
+    float (*Node_getScaleX)(void *node);
+    float (*Node_getScaleY)(void *node);
+    void (*Node_setRotation)(void *node, float rotation);
+    float (*Node_getRotation)(void *node);
+    void (*Node_setVisible)(void *node, bool visible);
+    bool (*Node_isVisible)(void *node);
+    void (*Sprite_setFlippedX)(void *sprite, bool flippedX);
+    void (*Sprite_setFlippedY)(void *sprite, bool flippedY);
+    int (*Nodes_stride)(int fields);
+    void (*Nodes_update)(void **nodes, const float *values, int count, int fields);
+} ccffi_api;
+
+typedef struct ccVec2 { float x, y; } ccVec2;
+typedef struct ccSize { float width, height; } ccSize;
+typedef struct ccColor3B { uint8_t r, g, b; } ccColor3B;
+typedef struct ccColor4B { uint8_t r, g, b, a; } ccColor4B;
+]]
+
+local api = ffi.cast("ccffi_api *", cc.ffi_api)
+local cast = ffi.cast
+local voidpp = ffi.typeof("void **")
+
+-- a proxy is a userdata holding the native pointer, NULL once the Ref is destroyed
+local function ptr(node)
+    return cast(voidpp, node)[0]
+end
+
+local ccffi = {ptr = ptr, api = api}
+
+-- value types, the traces sink the ones that don't escape, so they allocate nothing
+ccffi.Vec2 = ffi.typeof("ccVec2")
+ccffi.Size = ffi.typeof("ccSize")
+ccffi.Color3B = ffi.typeof("ccColor3B")
+ccffi.Color4B = ffi.typeof("ccColor4B")
+
+-- the setters take numbers, or one value as a ccffi struct or a table with the same fields
+
+function ccffi.setPosition(node, x, y)
+    if y == nil then
+        x, y = x.x, x.y
+    end
+    api.Node_setPosition(cast(voidpp, node)[0], x, y)
+end
+
+function ccffi.getPosition(node)
+    local p = cast(voidpp, node)[0]
+    return api.Node_getPositionX(p), api.Node_getPositionY(p)
+end
+
+function ccffi.setOpacity(node, opacity)
+    api.Node_setOpacity(cast(voidpp, node)[0], opacity)
+end
+
+function ccffi.getOpacity(node)
+    return api.Node_getOpacity(cast(voidpp, node)[0])
+end
+
+function ccffi.setColor(node, r, g, b)
+    if g == nil then
+        r, g, b = r.r, r.g, r.b
+    end
+    api.Node_setColor(cast(voidpp, node)[0], r, g, b)
+end
+
+function ccffi.setScale(node, scaleX, scaleY)
+    api.Node_setScale(cast(voidpp, node)[0], scaleX, scaleY or scaleX)
+end
+
+function ccffi.getScale(node)
+    local p = cast(voidpp, node)[0]
+    return api.Node_getScaleX(p), api.Node_getScaleY(p)
+end
+
+function ccffi.setRotation(node, rotation)
+    api.Node_setRotation(cast(voidpp, node)[0], rotation)
+end
+
+function ccffi.getRotation(node)
+    return api.Node_getRotation(cast(voidpp, node)[0])
+end
+
+function ccffi.setVisible(node, visible)
+    api.Node_setVisible(cast(voidpp, node)[0], visible)
+end
+
+function ccffi.isVisible(node)
+    return api.Node_isVisible(cast(voidpp, node)[0])
+end
+
+function ccffi.setFlippedX(sprite, flippedX)
+    api.Sprite_setFlippedX(cast(voidpp, sprite)[0], flippedX)
+end
+
+function ccffi.setFlippedY(sprite, flippedY)
+    api.Sprite_setFlippedY(cast(voidpp, sprite)[0], flippedY)
+end
+
+-- bulk updates, the values of the fields of count nodes set in one call:
+--   local nodes = ccffi.newNodes(n)                    -- nodes[i - 1] = ccffi.ptr(sprite)
+--   local values = ccffi.newValues(n, fields)          -- ccffi.stride(fields) floats per node
+--   ccffi.updateNodes(nodes, values, count, fields)
+-- the nodes must stay alive while in the array
+
+ccffi.POSITION = 1      -- x, y
+ccffi.OPACITY = 2       -- opacity
+ccffi.COLOR = 4         -- r, g, b
+ccffi.SCALE = 8         -- scaleX, scaleY
+ccffi.ROTATION = 16     -- rotation
+
+local nodesType = ffi.typeof("void *[?]")
+local valuesType = ffi.typeof("float [?]")
+
+function ccffi.stride(fields)
+    return api.Nodes_stride(fields)
+end
+
+function ccffi.newNodes(count)
+    return nodesType(count)
+end
+
+function ccffi.newValues(count, fields)
+    return valuesType(count * api.Nodes_stride(fields))
+end
+
+function ccffi.updateNodes(nodes, values, count, fields)
+    api.Nodes_update(nodes, values, count, fields)
+end
+
+return ccffi
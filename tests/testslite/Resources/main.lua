@@ -25,21 +25,24 @@ local function main()
     local centerx = g_viewsize_width / 2
     local centery = g_viewsize_height / 2
 
-    -- cache C++ methods
-    local setPosition = cc.Node.setPosition
-    local setOpacity = cc.Node.setOpacity
+    -- the stars are written into one packed buffer and updated in one call per frame,
+    -- under LuaJIT the buffer is an FFI array which lets the update loop compile
+    local hasffi, ccffi = pcall(require, "ccffi")
+    local fields = cc.Node.UPDATE_POSITION + cc.Node.UPDATE_OPACITY
+    local stride = 3
+    local firstIndex = hasffi and 0 or 1
 
     function HelloWorldLayer:ctor(parent)
         self.parent = parent
         self.starsLayer = cc.Node.create()
         self.parent:addChild(self.starsLayer)
 
-        local layerColor = cc.LayerColor.create(cc.Color4B.new(200, 200, 200, 200), 200, 40)
-        layerColor:setPosition(cc.Vec2.new(centerx - 100, g_viewsize_height - 40))
+        local layerColor = cc.LayerColor.create({r = 200, g = 200, b = 200, a = 200}, 200, 40)
+        layerColor:setPosition(centerx - 100, g_viewsize_height - 40)
         self.parent:addChild(layerColor)
 
         self.starsLabel = cc.Label.createWithSystemFont("0 stars", "sans", 24)
-        self.starsLabel:setColor(cc.Color3B.new(0, 0, 0))
+        self.starsLabel:setColor(0, 0, 0)
         self.starsLabel:setPosition(100, 20)
         layerColor:addChild(self.starsLabel)
 
@@ -55,6 +58,14 @@ local function main()
         self.maxStars = 20000
         self.starsCountOffset = 100
         self.stars = {}
+        local capacity = self.maxStars + self.starsCountOffset
+        if hasffi then
+            self.nodes = ccffi.newNodes(capacity)
+            self.values = ccffi.newValues(capacity, fields)
+        else
+            self.nodes = {}
+            self.values = {}
+        end
         self.stepsCount = 3000
         self.steps = self.stepsCount
         self.starsLayer:scheduleUpdate(function(dt)
@@ -82,6 +93,11 @@ local function main()
             self.starsLayer:addChild(star.sprite)
 
             self.stars[#self.stars + 1] = star
+            if hasffi then
+                self.nodes[#self.stars - 1] = ccffi.ptr(star.sprite)
+            else
+                self.nodes[#self.stars] = star.sprite
+            end
         end
 
         if #self.stars >= self.maxStars then
@@ -91,6 +107,11 @@ local function main()
 
     function HelloWorldLayer:removeStars(count)
         while count > 0 and #self.stars > 0 do
+            if hasffi then
+                self.nodes[#self.stars - 1] = nil
+            else
+                self.nodes[#self.stars] = nil
+            end
             local star = table.remove(self.stars)
             self.starsLayer:removeChild(star.sprite)
             count = count - 1
@@ -114,17 +135,22 @@ local function main()
         end
 
         local updateStar = self.updateStar
-        for i = 1, #self.stars do
-            updateStar(self, self.stars[i])
+        local values = self.values
+        local count = #self.stars
+        for i = 1, count do
+            updateStar(self, self.stars[i], values, (i - 1) * stride + firstIndex)
         end
-    end
 
-    local lsetPosition = lsetPosition
-    local lsetOpacity = lsetOpacity
+        if hasffi then
+            ccffi.updateNodes(self.nodes, values, count, fields)
+        else
+            cc.Node.updateNodes(self.nodes, values, fields)
+        end
+    end
 
-    local pos, offset, offsetCount, sprite
+    local pos, offset, offsetCount
 
-    function HelloWorldLayer:updateStar(star)
+    function HelloWorldLayer:updateStar(star, values, index)
         pos = star.pos
         offset = self.offsets[pos.i]
         offsetCount = self.offsetCount
@@ -140,13 +166,11 @@ local function main()
             pos.oi = -pos.oi
         end
 
-        sprite = star.sprite
-        setPosition(sprite, pos.x + offset.x, pos.y + offset.y)
-        setOpacity(sprite, pos.o)
+        values[index] = pos.x + offset.x
+        values[index + 1] = pos.y + offset.y
+        values[index + 2] = pos.o
     end
 
-    collectgarbage("stop")
-
     local layer = {}
     setmetatable(layer, {__index = HelloWorldLayer})
     layer:ctor(g_layer)
@@ -26,6 +26,7 @@
 #import "platform/ios/CCEAGLView-ios.h"
 #import "cocos2d.h"
 #import "AppDelegate.h"
+#import "BenchmarkRunner.h"
 #import "RootViewController.h"
 
 @implementation AppController
@@ -38,6 +39,14 @@ static AppDelegate s_sharedApplication;
 
 - (BOOL)application:(UIApplication *)application didFinishLaunchingWithOptions:(NSDictionary *)launchOptions {    
 
+    // the launch arguments of the scheme or of xcrun simctl launch
+    NSArray *arguments = [[NSProcessInfo processInfo] arguments];
+    std::vector<const char*> argv;
+    for (NSString *argument in arguments) {
+        argv.push_back([argument UTF8String]);
+    }
+    BenchmarkRunner::getInstance()->parseArguments((int)argv.size(), argv.data());
+
     cocos2d::Application *app = cocos2d::Application::getInstance();
     app->initGLContextAttrs();
     cocos2d::GLViewImpl::convertAttrs();
@@ -137,6 +146,7 @@ static AppDelegate s_sharedApplication;
     /*
      Free up as much memory as possible by purging cached data objects that can be recreated (or reloaded from disk) later.
      */
+    cocos2d::MemoryPressure::getInstance()->signal(cocos2d::MemoryPressure::Level::MEDIUM);
 }
 
 
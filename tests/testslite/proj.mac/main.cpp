@@ -23,6 +23,7 @@
  ****************************************************************************/
 
 #include "AppDelegate.h"
+#include "BenchmarkRunner.h"
 #include "cocos2d.h"
 
 USING_NS_CC;
@@ -30,5 +31,8 @@ USING_NS_CC;
 int main(int argc, char *argv[])
 {
     AppDelegate app;
-    return Application::getInstance()->run();
+    BenchmarkRunner::getInstance()->parseArguments(argc, argv);
+    int result = Application::getInstance()->run();
+    // a failed benchmark fails the CI job
+    return result != 0 ? result : BenchmarkRunner::getInstance()->getExitCode();
 }
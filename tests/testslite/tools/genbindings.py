@@ -0,0 +1,369 @@
+#!/usr/bin/env python
+#
+# Generates Classes/LuabindingAuto.cpp, the Lua bindings of the engine classes listed below.
+#
+# The public methods are read from the headers. Their parameter and return types must be ones
+# LuabindingTemplates.hpp converts: numbers, bool, strings, Vec2, Size, Rect, colors, the enums
+# of the headers and pointers to the bound classes. The others are skipped. The overloads of a
+# name are bound together, and the default arguments as shorter overloads.
+#
+# usage: python tools/genbindings.py, from tests/testslite, then commit LuabindingAuto.cpp
+
+from __future__ import print_function
+
+import os
+import re
+import sys
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), '..', '..', '..'))
+OUTPUT = os.path.join(ROOT, 'tests', 'testslite', 'Classes', 'LuabindingAuto.cpp')
+
+HEADERS = [
+    'cocos/base/CCRef.h',
+    'cocos/2d/CCNode.h',
+    'cocos/2d/CCScene.h',
+    'cocos/2d/CCLayer.h',
+    'cocos/2d/CCSprite.h',
+    'cocos/2d/CCLabel.h',
+    'cocos/2d/CCAction.h',
+    'cocos/2d/CCActionInterval.h',
+    'cocos/2d/CCActionInstant.h',
+    'cocos/2d/CCActionEase.h',
+    'cocos/base/CCDirector.h',
+    'cocos/base/CCScheduler.h',
+    'cocos/base/CCEventDispatcher.h',
+    'cocos/base/CCEventListener.h',
+    'cocos/platform/CCFileUtils.h',
+    'cocos/renderer/CCTexture2D.h',
+    'cocos/renderer/CCTextureCache.h',
+]
+
+# the bound classes, the bases before the derived ones
+CLASSES = [
+    'Ref', 'Node', 'Scene', 'Layer', 'LayerColor', 'Sprite', 'Label',
+    'Action', 'FiniteTimeAction', 'ActionInterval', 'ActionInstant', 'Speed', 'Follow',
+    'RotateTo', 'RotateBy', 'MoveBy', 'MoveTo', 'SkewTo', 'SkewBy', 'JumpBy', 'JumpTo',
+    'ScaleTo', 'ScaleBy', 'Blink', 'FadeTo', 'FadeIn', 'FadeOut', 'TintTo', 'TintBy', 'DelayTime',
+    'Repeat', 'RepeatForever', 'ReverseTime',
+    'Show', 'Hide', 'ToggleVisibility', 'RemoveSelf', 'FlipX', 'FlipY', 'Place',
+    'ActionEase', 'EaseRateAction', 'EaseIn', 'EaseOut', 'EaseInOut', 'EaseSineIn', 'EaseSineOut', 'EaseSineInOut',
+    'EaseBackIn', 'EaseBackOut', 'EaseBackInOut', 'EaseElasticIn', 'EaseElasticOut', 'EaseElasticInOut',
+    'EaseBounceIn', 'EaseBounceOut', 'EaseBounceInOut',
+    'Director', 'Scheduler', 'EventListener', 'EventDispatcher',
+    'FileUtils', 'Texture2D', 'TextureCache',
+]
+
+# methods left out: the ones declared without a definition, or not for scripts
+SKIP = {
+    'Ref': ['autorelease'],
+    'Node': ['setUserData', 'getUserData', 'setUserObject', 'getUserObject', 'draw', 'visit',
+             'setChildOrderKey', 'enumerateChildren', 'getChildByName'],
+    'Director': ['getOpenGLView', 'setOpenGLView', 'mainLoop', 'getInstance'],
+    'FileUtils': ['getInstance', 'destroyInstance', 'setDelegate', 'getDataFromFile'],
+    'Texture2D': ['initWithData', 'initWithMipmaps', 'updateWithData'],
+}
+
+# singletons bound by their getInstance()
+SINGLETONS = {
+    'Director': 'Director::getInstance',
+    'FileUtils': 'FileUtils::getInstance',
+}
+
+SCALARS = set('''bool int unsigned short long float double char ssize_t size_t
+GLubyte GLbyte GLfloat GLint GLuint GLenum GLshort GLushort GLsizei GLboolean
+uint8_t uint16_t uint32_t int8_t int16_t int32_t int64_t uint64_t ccSchedulerHandle'''.split())
+VALUES = set(['Vec2', 'Size', 'Rect', 'Color3B', 'Color4B'])
+
+
+def strip_comments(text):
+    text = re.sub(r'/\*.*?\*/', ' ', text, flags=re.S)
+    return re.sub(r'//[^\n]*', '', text)
+
+
+def strip_conditionals(text):
+    # keeps the header guard, drops the code under any other #if, its branches may be disabled
+    out = []
+    stack = []
+    guarded = False
+    for line in text.split('\n'):
+        s = line.strip()
+        if s.startswith('#'):
+            d = s[1:].strip()
+            if d.startswith('if'):
+                guard = d.startswith('ifndef') and not stack and not guarded
+                guarded = guarded or guard
+                stack.append(guard)
+            elif d.startswith('endif'):
+                if stack:
+                    stack.pop()
+            continue
+        if all(stack):
+            out.append(line)
+    return '\n'.join(out)
+
+
+def matching(text, i, open_c, close_c):
+    depth = 0
+    while i < len(text):
+        if text[i] == open_c:
+            depth += 1
+        elif text[i] == close_c:
+            depth -= 1
+            if depth == 0:
+                return i
+        i += 1
+    return -1
+
+
+def split_params(params):
+    out, depth, cur = [], 0, ''
+    for c in params:
+        if c in '<(':
+            depth += 1
+        elif c in '>)':
+            depth -= 1
+        if c == ',' and depth == 0:
+            out.append(cur)
+            cur = ''
+        else:
+            cur += c
+    if cur.strip():
+        out.append(cur)
+    return [p.strip() for p in out]
+
+
+def normalize(t):
+    t = re.sub(r'\s+', ' ', t.strip())
+    t = re.sub(r'\s*([*&])\s*', r'\1', t)
+    t = re.sub(r'([*&])(?=\w)', r'\1 ', t)
+    return t.replace(' *', '*').replace(' &', '&')
+
+
+class Method(object):
+    def __init__(self, cls, name, ret, params, const, static):
+        self.cls, self.name, self.ret, self.params, self.const, self.static = cls, name, ret, params, const, static
+
+    def key(self):
+        return (self.name, tuple(t for t, d in self.params), self.static)
+
+
+class Class(object):
+    def __init__(self, name, bases):
+        self.name, self.bases, self.methods, self.enums = name, bases, [], set()
+
+
+def parse_header(path, classes, enums):
+    text = strip_conditionals(strip_comments(open(os.path.join(ROOT, path)).read()))
+    for m in re.finditer(r'\bclass\s+(?:CC_DLL\s+)?(\w+)\s*(?::([^{;]*))?\{', text):
+        name = m.group(1)
+        end = matching(text, m.end() - 1, '{', '}')
+        bases = [b.split()[-1] for b in (m.group(2) or '').split(',') if b.strip()]
+        cls = classes.setdefault(name, Class(name, bases))
+        parse_body(cls, text[m.end():end], enums)
+    for m in re.finditer(r'^\s*enum\s+(?:class\s+)?(\w+)', text, re.M):
+        enums.add(m.group(1))
+
+
+def parse_body(cls, body, enums):
+    access = 'private'
+    i, stmt = 0, ''
+    while i < len(body):
+        c = body[i]
+        if c == '{':
+            end = matching(body, i, '{', '}')
+            head = stmt.strip()
+            if re.match(r'(?:enum|struct|class|union)\b', head):
+                e = re.match(r'enum\s+(?:class\s+)?(\w+)', head)
+                if e:
+                    cls.enums.add(e.group(1))
+                    enums.add(e.group(1))
+            elif access == 'public':
+                parse_method(cls, head)
+            i = end + 1
+            stmt = ''
+            continue
+        if c == ';':
+            if access == 'public':
+                parse_method(cls, stmt.strip())
+            stmt = ''
+        elif c == ':' and re.match(r'^\s*(public|protected|private|CC_CONSTRUCTOR_ACCESS)\s*$', stmt) and body[i + 1] != ':':
+            access = stmt.strip()
+            stmt = ''
+        else:
+            stmt += c
+        i += 1
+
+
+def parse_method(cls, stmt):
+    if not stmt or re.search(r'\b(operator|template|friend|typedef|using|CC_DEPRECATED\w*|std::function)\b', stmt):
+        return
+    m = re.match(r'^(?P<pre>.*?)\b(?P<name>~?\w+)\s*\((?P<params>.*)\)(?P<post>[^()]*)$', stmt, re.S)
+    if not m:
+        return
+    name = m.group('name')
+    if name == cls.name or name.startswith('~'):
+        return
+    pre = ' ' + m.group('pre') + ' '
+    post = m.group('post')
+    static = ' static ' in pre
+    ret = re.sub(r'\b(virtual|static|inline|explicit|CC_DLL)\b', ' ', pre)
+    ret = normalize(ret)
+    if not ret or re.search(r'\b(public|protected|private)\b', ret):
+        return
+    const = re.search(r'\bconst\b', post) is not None
+    params = []
+    for p in split_params(m.group('params')):
+        if p == 'void':
+            continue
+        default = '=' in p
+        p = p.split('=')[0].strip()
+        t = normalize(p)
+        words = re.match(r'^(.*?[\s*&>])(\w+)$', t)
+        if words and words.group(2) not in SCALARS and words.group(2) not in ('const',):
+            base = words.group(1).strip()
+            if base and base not in ('const', 'unsigned', 'signed', 'long', 'short'):
+                t = normalize(base)
+        params.append((t, default))
+    cls.methods.append(Method(cls.name, name, ret, params, const, static))
+
+
+def base_type(t):
+    t = re.sub(r'\bconst\b', '', t).replace('&', '').strip()
+    return t
+
+
+def supported(t, bound, enums, ret=False):
+    if t == 'void':
+        return ret
+    if re.search(r'(?<!const )\b\w+&$', t) and not t.startswith('const '):
+        return False          # an out parameter
+    b = base_type(t)
+    if b.endswith('*'):
+        inner = b[:-1].strip()
+        return inner in bound or (inner == 'char' and 'const' in t)
+    b = b.replace('unsigned ', '').replace('signed ', '').strip() or 'int'
+    b = b.replace('std::string', 'string')
+    return b in SCALARS or b == 'string' or b in VALUES or b in enums or b.split('::')[-1] in enums
+
+
+def spell(t, cls):
+    # qualifies the nested enums of the class
+    for e in cls.enums:
+        t = re.sub(r'(?<![:\w])%s\b' % e, '%s::%s' % (cls.name, e), t)
+    return t
+
+
+def signature(m, owner, params):
+    ret = spell(m.ret, owner)
+    args = ', '.join(spell(t, owner) for t in params)
+    if m.static:
+        return '%s (*)(%s)' % (ret, args)
+    return '%s (%s::*)(%s)%s' % (ret, m.cls, args, ' const' if m.const else '')
+
+
+def main():
+    classes, enums = {}, set()
+    for h in HEADERS:
+        parse_header(h, classes, enums)
+
+    bound = [c for c in CLASSES if c in classes]
+    missing = [c for c in CLASSES if c not in classes]
+    if missing:
+        print('not found: %s' % ', '.join(missing), file=sys.stderr)
+
+    out = []
+    w = out.append
+    w('//')
+    w('//  LuabindingAuto.cpp')
+    w('//  testslite')
+    w('//')
+    w('//  Generated by tools/genbindings.py, do not edit.')
+    w('//')
+    w('')
+    w('#include "LuabindingTemplates.hpp"')
+    w('')
+    w('USING_NS_CC;')
+    w('')
+    for c in bound:
+        w('template<> const char *l_class<%s>::name() { return "cc.%s"; }' % (c, c))
+    w('')
+
+    all_enums = set(enums)
+    total = 0
+    regs = []
+    for c in bound:
+        cls = classes[c]
+        skip = set(SKIP.get(c, []))
+        # the own methods, then the overloads of the same names inherited from the bound bases
+        methods = [m for m in cls.methods if m.name not in skip]
+        own = set(m.key() for m in methods)
+        names = set(m.name for m in methods if not m.static)
+        base = next((b for b in cls.bases if b in bound), None)
+        b = base
+        while b:
+            for m in classes[b].methods:
+                if m.name in names and not m.static and m.key() not in own and m.name not in SKIP.get(b, []):
+                    methods.append(m)
+                    own.add(m.key())
+            b = next((x for x in classes[b].bases if x in bound), None)
+
+        entries = {}
+        wrappers = []
+        for m in methods:
+            owner = classes[m.cls]
+            types = [t for t, d in m.params]
+            if not supported(m.ret, bound, all_enums, True) or not all(supported(t, bound, all_enums) for t in types):
+                continue
+            ndefaults = len([d for t, d in m.params if d])
+            for n in range(len(types) - ndefaults, len(types) + 1):
+                if n == len(types):
+                    sig = signature(m, owner, types)
+                    entries.setdefault(m.name, []).append('l_method<%s, &%s::%s>' % (sig, m.cls, m.name))
+                    continue
+                # the default arguments are left to the C++ declaration
+                fn = 'l_%s_%s_%d' % (c, m.name, n)
+                args = ['%s a%d' % (spell(t, owner), i) for i, t in enumerate(types[:n])]
+                call = ', '.join('a%d' % i for i in range(n))
+                ret = spell(m.ret, owner)
+                if m.static:
+                    wrappers.append('static %s %s(%s)\n{\n    return %s::%s(%s);\n}\n' % (ret, fn, ', '.join(args), m.cls, m.name, call))
+                    sig = '%s (*)(%s)' % (ret, ', '.join(spell(t, owner) for t in types[:n]))
+                else:
+                    self_t = 'const %s' % m.cls if m.const else m.cls
+                    args.insert(0, '%s *self' % self_t)
+                    wrappers.append('static %s %s(%s)\n{\n    return self->%s(%s);\n}\n' % (ret, fn, ', '.join(args), m.name, call))
+                    sig = '%s (*)(%s)' % (ret, ', '.join(['%s*' % self_t] + [spell(t, owner) for t in types[:n]]))
+                if fn not in [e.split('&')[-1][:-1] for e in entries.get(m.name, [])]:
+                    entries.setdefault(m.name, []).append('l_method<%s, &%s>' % (sig, fn))
+
+        if c in SINGLETONS:
+            entries.setdefault('getInstance', []).append('l_method<%s *(*)(), &%s>' % (c, SINGLETONS[c]))
+
+        w('// %s' % c)
+        w('')
+        for wr in wrappers:
+            w(wr)
+        w('static const luaL_Reg l_auto_%s[] = {' % c)
+        for name in sorted(entries):
+            ms = entries[name]
+            if len(ms) == 1:
+                w('    {"%s", &%s::call},' % (name, ms[0]))
+            else:
+                w('    {"%s", &l_overload<' % name)
+                w('        %s\n    >::call},' % ',\n        '.join(ms))
+            total += 1
+        w('    {NULL, NULL}')
+        w('};')
+        w('')
+        regs.append('    {"cc.%s", "%s", %s, l_auto_%s},' % (c, c, '"cc.%s"' % base if base else 'NULL', c))
+
+    w('const l_auto_class l_auto_classes[] = {')
+    out.extend(regs)
+    w('    {NULL, NULL, NULL, NULL}')
+    w('};')
+    open(OUTPUT, 'w').write('\n'.join(out) + '\n')
+    print('%d classes, %d functions' % (len(bound), total))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,118 @@
+#!/usr/bin/env python
+#
+# Precompiles the Lua scripts of Resources to LuaJIT bytecode into one AssetPack, Resources/scripts.ccpk.
+#
+# The entries keep the paths of the scripts ("main.lua", "ui/menu.lua"), stored uncompressed so the
+# bundle is read from the memory mapping. l_add_bundle_loader() makes require() load them from it.
+# The bytecode depends on the LuaJIT version and on its GC64 mode, so compile with the luajit the
+# game links, built for the same bitness.
+#
+# usage: python tools/packlua.py [--luajit path] [--debug], from tests/testslite
+#        --debug keeps the line numbers and the local names in the bytecode
+
+from __future__ import print_function
+
+import argparse
+import os
+import struct
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), '..'))
+RESOURCES = os.path.join(ROOT, 'Resources')
+OUTPUT = os.path.join(RESOURCES, 'scripts.ccpk')
+
+# see cocos/base/CCAssetPack.h
+HEADER_SIZE = 32
+ENTRY_SIZE = 32
+PACK_VERSION = 1
+CODEC_STORED = 0
+
+
+def fnv1a(data):
+    h = 2166136261
+    for c in bytearray(data):
+        h ^= c
+        h = (h * 16777619) & 0xffffffff
+    return h
+
+
+def find_scripts():
+    scripts = []
+    for dirpath, dirnames, filenames in os.walk(RESOURCES):
+        dirnames.sort()
+        for filename in sorted(filenames):
+            if filename.endswith('.lua'):
+                path = os.path.join(dirpath, filename)
+                scripts.append(os.path.relpath(path, RESOURCES).replace(os.sep, '/'))
+    return scripts
+
+
+def compile_script(luajit, name, debug):
+    fd, tmp = tempfile.mkstemp(suffix='.luac')
+    os.close(fd)
+    try:
+        # compiled from Resources, so the chunk names of the debug info are the entry names
+        args = [luajit, '-b']
+        if debug:
+            args.append('-g')
+        args += [name, tmp]
+        subprocess.check_call(args, cwd=RESOURCES)
+        with open(tmp, 'rb') as f:
+            return f.read()
+    finally:
+        os.remove(tmp)
+
+
+def write_pack(path, files):
+    count = len(files)
+    bucket_count = 1
+    while bucket_count < count:
+        bucket_count *= 2
+
+    buckets_offset = HEADER_SIZE
+    entries_offset = buckets_offset + bucket_count * 4
+    names_offset = entries_offset + count * ENTRY_SIZE
+    names = b''.join(name.encode('utf-8') for name, _ in files)
+    data_offset = names_offset + len(names)
+
+    buckets = [0] * bucket_count
+    entries = []
+    name_offset = 0
+    for index, (name, data) in enumerate(files):
+        encoded = name.encode('utf-8')
+        h = fnv1a(encoded)
+        bucket = h & (bucket_count - 1)
+        # chained at the front of its bucket
+        entries.append(struct.pack('<8I', h, buckets[bucket], name_offset, len(encoded),
+                                   data_offset, len(data), len(data), CODEC_STORED))
+        buckets[bucket] = index + 1
+        name_offset += len(encoded)
+        data_offset += len(data)
+
+    with open(path, 'wb') as f:
+        f.write(b'CCPK')
+        f.write(struct.pack('<7I', PACK_VERSION, count, bucket_count,
+                            buckets_offset, entries_offset, names_offset, 0))
+        f.write(struct.pack('<%dI' % bucket_count, *buckets))
+        f.write(b''.join(entries))
+        f.write(names)
+        for _, data in files:
+            f.write(data)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Precompiles the Lua scripts into ' + OUTPUT)
+    parser.add_argument('--luajit', default='luajit')
+    parser.add_argument('--debug', action='store_true')
+    args = parser.parse_args()
+
+    files = [(name, compile_script(args.luajit, name, args.debug)) for name in find_scripts()]
+    write_pack(OUTPUT, files)
+    print('%d scripts, %d bytes in %s' % (len(files), os.path.getsize(OUTPUT), OUTPUT))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())